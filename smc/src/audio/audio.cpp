@@ -16,10 +16,24 @@
 #include "../audio/audio.h"
 #include "../core/game_core.h"
 #include "../level/level.h"
+#include "../level/level_manifest.h"
 #include "../overworld/overworld.h"
 #include "../user/preferences.h"
 #include "../core/i18n.h"
 #include "../core/filesystem/filesystem.h"
+#include "../core/filesystem/resource_manager.h"
+#include "../core/update_workers.h"
+#include "../core/benchmark.h"
+// boost
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace SMC
 {
@@ -28,25 +42,107 @@ namespace SMC
 
 void Finished_Sound( const int channel )
 {
-	// find the finished sound and free the data
-	for( AudioSoundList::iterator itr = pAudio->m_active_sounds.begin(); itr != pAudio->m_active_sounds.end(); ++itr )
+	// channels removed while changing the maximum sounds
+	if( channel < 0 || static_cast<unsigned int>(channel) >= pAudio->m_active_sounds.size() )
 	{
-		cAudio_Sound *obj = (*itr);
+		return;
+	}
 
-		if( obj->m_channel == channel )
-		{
-			obj->Finished();
-		}
+	// handled by the next audio update
+	cChannel_Finished item;
+	item.m_channel = channel;
+	item.m_serial = pAudio->m_active_sounds[channel]->m_play_serial;
+
+	/* if full it stays as playing until the channel is taken by another sound
+	 * which can only happen with much more finished sounds than channels in a frame
+	*/
+	pAudio->m_finished_channels.Push( item );
+}
+
+void Mixed_Audio( void *audio_data, Uint8 *stream, int len )
+{
+	cAudio *audio = static_cast<cAudio *>(audio_data);
+	const Uint32 ticks = SDL_GetTicks();
+
+	// the next buffer was not ready in time
+	if( audio->m_mix_count && ticks - audio->m_mix_time > audio->m_mix_period * 2 + 1 )
+	{
+		audio->m_mix_underruns++;
 	}
+
+	audio->m_mix_time = ticks;
+	audio->m_mix_count++;
+}
+
+/* *** *** *** *** *** *** *** *** Channel finished queue *** *** *** *** *** *** *** *** *** */
+
+// Orders the queue item and index accesses between the audio and the main thread
+static inline void Audio_Memory_Barrier( void )
+{
+#ifdef _MSC_VER
+	// volatile accesses already have acquire and release semantics
+	_ReadWriteBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+cChannel_Finished_Queue :: cChannel_Finished_Queue( void )
+{
+	m_write = 0;
+	m_read = 0;
+}
+
+bool cChannel_Finished_Queue :: Push( const cChannel_Finished &item )
+{
+	const unsigned int write = m_write;
+
+	// full
+	if( write - m_read >= m_capacity )
+	{
+		return 0;
+	}
+
+	m_items[write & ( m_capacity - 1 )] = item;
+	// the item must be written before it can be read
+	Audio_Memory_Barrier();
+	m_write = write + 1;
+
+	return 1;
+}
+
+bool cChannel_Finished_Queue :: Pop( cChannel_Finished &item )
+{
+	const unsigned int read = m_read;
+
+	// empty
+	if( read == m_write )
+	{
+		return 0;
+	}
+
+	Audio_Memory_Barrier();
+	item = m_items[read & ( m_capacity - 1 )];
+	// the item must be read before it can be overwritten
+	Audio_Memory_Barrier();
+	m_read = read + 1;
+
+	return 1;
 }
 
 /* *** *** *** *** *** *** *** *** Audio Sound *** *** *** *** *** *** *** *** *** */
 
-cAudio_Sound :: cAudio_Sound( void )
+cAudio_Sound :: cAudio_Sound( int index )
 {
 	m_data = NULL;
+	m_index = index;
 	m_channel = -1;
+	m_play_serial = 0;
+	m_free = 0;
 	m_resource_id = -1;
+	m_volume = 0;
+	m_start_time = 0;
+	m_emitter = NULL;
 }
 
 cAudio_Sound :: ~cAudio_Sound( void )
@@ -59,6 +155,11 @@ void cAudio_Sound :: Load( cSound *data )
 	Free();
 	
 	m_data = data;
+
+	if( m_data )
+	{
+		m_data->m_audio_sounds.push_back( this );
+	}
 }
 
 void cAudio_Sound :: Free( void )
@@ -67,16 +168,31 @@ void cAudio_Sound :: Free( void )
 
 	if( m_data )
 	{
+		m_data->m_audio_sounds.erase( std::remove( m_data->m_audio_sounds.begin(), m_data->m_audio_sounds.end(), this ), m_data->m_audio_sounds.end() );
 		m_data = NULL;
 	}
 	
 	m_channel = -1;
 	m_resource_id = -1;
+
+	// taken from the emitter
+	if( m_emitter )
+	{
+		m_emitter->m_channel = -1;
+		m_emitter = NULL;
+	}
 }
 
 void cAudio_Sound :: Finished( void )
 {
 	m_channel = -1;
+
+	// notify the emitter so it does not need to check the channel
+	if( m_emitter )
+	{
+		m_emitter->m_channel = -1;
+		m_emitter = NULL;
+	}
 }
 
 int cAudio_Sound :: Play( int use_res_id /* = -1 */, int loops /* = 0 */ )
@@ -108,8 +224,11 @@ int cAudio_Sound :: Play( int use_res_id /* = -1 */, int loops /* = 0 */ )
 	}
 
 	m_resource_id = use_res_id;
+	m_start_time = SDL_GetTicks();
+	// a finished callback of the last play is now outdated
+	m_play_serial++;
 	// play sound
-	m_channel = Mix_PlayChannel( -1, m_data->m_chunk, loops );
+	m_channel = Mix_PlayChannel( m_index, m_data->m_chunk, loops );
 	// add callback if sound finished playing
 	Mix_ChannelFinished( &Finished_Sound );
 
@@ -128,8 +247,44 @@ void cAudio_Sound :: Stop( void )
 	m_channel = -1;
 }
 
+/* *** *** *** *** *** *** *** *** Sound emitter *** *** *** *** *** *** *** *** *** */
+
+cSound_Emitter :: cSound_Emitter( void )
+{
+	m_pos_x = 0.0f;
+	m_pos_y = 0.0f;
+	m_volume_reduction_begin = 0.0f;
+	m_volume_reduction_end = 1.0f;
+	m_continuous = 0;
+	m_volume = 1.0f;
+
+	m_active = 0;
+	m_play_volume = -1.0f;
+	m_distance_mod = 0.0f;
+
+	m_channel = -1;
+	m_mixer_volume = 0;
+	m_index = -1;
+}
+
 /* *** *** *** *** *** *** *** *** Audio *** *** *** *** *** *** *** *** *** */
 
+// mixer buffer size in samples if not in the low latency mode as below 2048 can be choppy
+static const int audio_default_buffer = 4096;
+// underruns per second in the low latency mode after which a larger buffer is used
+static const Uint32 audio_underrun_limit = 3;
+
+// time a play request waits for a sound still decoding
+static const Uint32 audio_sound_defer_time = 100;
+// mixer volume below which an emitter sound is not played as it would only take a channel
+static const int audio_emitter_min_volume = 4;
+// mixer volume change of an emitter sound needed to set it
+static const int audio_emitter_volume_step = 2;
+
+// overloaded play functions for deferring
+typedef bool (cAudio::*Play_Sound_Filename_Func)( std::string, int, int, int );
+typedef bool (cAudio::*Play_Sound_Handle_Func)( const cSound_Handle &, int, int, int );
+
 cAudio :: cAudio( void )
 {
 	m_initialised = 0;
@@ -142,11 +297,25 @@ cAudio :: cAudio( void )
 	m_music_volume = cPreferences::m_music_volume_default;
 
 	m_music = NULL;
-	m_music_old = NULL;
+	m_music_next = NULL;
+	m_music_loader = NULL;
 
 	m_max_sounds = 0;
 
-	m_audio_buffer = 4096; // below 2048 can be choppy
+	m_sound_loader = NULL;
+	m_sound_defer_time = audio_sound_defer_time;
+
+	m_audio_buffer = audio_default_buffer;
+	m_audio_buffer_fallback = 0;
+
+	m_mix_count = 0;
+	m_mix_time = 0;
+	m_mix_period = 0;
+	m_mix_underruns = 0;
+	m_latency = 0.0f;
+	m_latency_check_time = 0;
+	m_latency_check_count = 0;
+	m_latency_check_underruns = 0;
 	m_audio_channels = MIX_DEFAULT_CHANNELS; // 1 = Mono, 2 = Stereo
 }
 
@@ -166,8 +335,16 @@ bool cAudio :: Init( void )
 	bool sound = pPreferences->m_audio_sound;
 	bool music = pPreferences->m_audio_music;
 
+	// mixer buffer size
+	int buffer = audio_default_buffer;
+
+	if( pPreferences->m_audio_low_latency )
+	{
+		buffer = m_audio_buffer_fallback ? m_audio_buffer_fallback : pPreferences->m_audio_latency_buffer;
+	}
+
 	// if no change
-	if( numtimesopened && m_music_enabled == music && m_sound_enabled == sound && dev_frequency == pPreferences->m_audio_hz )
+	if( numtimesopened && m_music_enabled == music && m_sound_enabled == sound && dev_frequency == pPreferences->m_audio_hz && m_audio_buffer == buffer )
 	{
 		return 1;
 	}
@@ -183,6 +360,8 @@ bool cAudio :: Init( void )
 	// if audio system is not initialized
 	if( !m_initialised )
 	{
+		m_audio_buffer = buffer;
+
 		if( m_debug )
 		{
 			printf( "Initializing Audio System - Buffer %i, Frequency %i, Speaker Channels %i\n", m_audio_buffer, pPreferences->m_audio_hz, m_audio_channels );
@@ -256,6 +435,17 @@ bool cAudio :: Init( void )
 			}
 		}
 
+		// measure the mixing
+		m_mix_period = ( m_audio_buffer * 1000 ) / ( dev_frequency > 0 ? dev_frequency : pPreferences->m_audio_hz );
+		m_mix_count = 0;
+		m_mix_time = 0;
+		m_mix_underruns = 0;
+		m_latency = 0.0f;
+		m_latency_check_time = SDL_GetTicks();
+		m_latency_check_count = 0;
+		m_latency_check_underruns = 0;
+		Mix_SetPostMix( &Mixed_Audio, this );
+
 		m_initialised = 1;
 	}
 
@@ -269,6 +459,7 @@ bool cAudio :: Init( void )
 	if( music && !m_music_enabled )
 	{
 		m_music_enabled = 1;
+		m_music_loader = new cMusic_Loader();
 
 		// set music volume
 		Set_Music_Volume( m_music_volume );
@@ -278,6 +469,9 @@ bool cAudio :: Init( void )
 	{
 		Halt_Music();
 
+		delete m_music_loader;
+		m_music_loader = NULL;
+
 		m_music_enabled = 0;
 	}
 
@@ -290,12 +484,18 @@ bool cAudio :: Init( void )
 		Set_Max_Sounds();
 		// set sound volume
 		Set_Sound_Volume( m_sound_volume );
+
+		m_sound_loader = new cSound_Loader();
 	}
 	// sound de-initialization
 	else if( !sound && m_sound_enabled )
 	{
 		Stop_Sounds();
 
+		delete m_sound_loader;
+		m_sound_loader = NULL;
+		m_deferred_sounds.clear();
+
 		m_sound_enabled = 0;
 	}
 
@@ -315,13 +515,27 @@ void cAudio :: Close( void )
 		{
 			Stop_Sounds();
 
+			// waits for the sound being decoded
+			delete m_sound_loader;
+			m_sound_loader = NULL;
+			m_deferred_sounds.clear();
+
 			// clear sounds
 			for( AudioSoundList::iterator itr = m_active_sounds.begin(); itr != m_active_sounds.end(); ++itr )
 			{
 				delete *itr;
 			}
 
+			// the finished callbacks of the stopped sounds are ignored
+			cChannel_Finished item;
+
+			while( m_finished_channels.Pop( item ) )
+			{
+				// nothing
+			}
+
 			m_active_sounds.clear();
+			m_free_channels.clear();
 
 			Mix_AllocateChannels( 0 );
 			m_max_sounds = 0;
@@ -332,21 +546,26 @@ void cAudio :: Close( void )
 		{
 			Halt_Music();
 
+			// waits for the music being loaded
+			delete m_music_loader;
+			m_music_loader = NULL;
+
 			if( m_music )
 			{
-				Mix_FreeMusic( m_music );
+				delete m_music;
 				m_music = NULL;
 			}
 
-			if( m_music_old )
+			if( m_music_next )
 			{
-				Mix_FreeMusic( m_music_old );
-				m_music_old = NULL;
+				delete m_music_next;
+				m_music_next = NULL;
 			}
 
 			m_music_enabled = 0;
 		}
 
+		Mix_SetPostMix( NULL, NULL );
 		Mix_CloseAudio();
 
 		m_initialised = 0;
@@ -368,6 +587,9 @@ void cAudio :: Set_Max_Sounds( unsigned int limit /* = 10 */ )
 
 	m_max_sounds = limit;
 
+	// the finished channels are for the current sounds
+	Update_Finished_Channels();
+
 	// remove exceeding sounds
 	AudioSoundList::iterator last_itr;
 
@@ -377,12 +599,35 @@ void cAudio :: Set_Max_Sounds( unsigned int limit /* = 10 */ )
 
 		// delete data
 		delete *(last_itr);
-		// erase from list
+		// erase from list while the finished callback can not read it
+		SDL_LockAudio();
 		m_active_sounds.erase( last_itr );
+		SDL_UnlockAudio();
+	}
+
+	// add a sound for every channel
+	while( m_active_sounds.size() < m_max_sounds )
+	{
+		m_active_sounds.push_back( new cAudio_Sound( m_active_sounds.size() ) );
 	}
 
 	// change channels managed by the mixer
 	Mix_AllocateChannels( m_max_sounds );
+	Mix_ChannelFinished( &Finished_Sound );
+
+	// the removed channels were also added
+	m_free_channels.clear();
+
+	for( AudioSoundList::reverse_iterator itr = m_active_sounds.rbegin(); itr != m_active_sounds.rend(); ++itr )
+	{
+		cAudio_Sound *sound = (*itr);
+		sound->m_free = 0;
+
+		if( sound->m_channel < 0 )
+		{
+			Add_Free_Channel( sound->m_index );
+		}
+	}
 
 	if( m_debug )
 	{
@@ -397,25 +642,30 @@ cSound *cAudio :: Get_Sound_File( std::string filename ) const
 		return NULL;
 	}
 
-	// not available
-	if( !File_Exists( filename ) )
-	{
-		// add sound directory
-		if( filename.find( DATA_DIR "/" GAME_SOUNDS_DIR "/" ) == std::string::npos )
-		{
-			filename.insert( 0, DATA_DIR "/" GAME_SOUNDS_DIR "/" );
-		}
-	}
+	Get_Sound_Path( filename );
+
+	// preloaded the next time the level is loaded
+	cLevel_Manifest::Record_Sound( filename );
 
 	cSound *sound = pSound_Manager->Get_Pointer( filename );
 
 	// if not already cached
 	if( !sound )
 	{
+		cLoad_Profiler_Scope profile_scope( "sound load" );
 		sound = new cSound();
 
+		// take it from the background decoding
+		Mix_Chunk *chunk = m_sound_loader ? m_sound_loader->Take( filename ) : NULL;
+
+		if( chunk )
+		{
+			sound->m_filename = filename;
+			sound->m_chunk = chunk;
+			pSound_Manager->Add( sound );
+		}
 		// loaded sound
-		if( sound->Load( filename ) )
+		else if( sound->Load( filename ) )
 		{
 			pSound_Manager->Add( sound );
 
@@ -437,6 +687,97 @@ cSound *cAudio :: Get_Sound_File( std::string filename ) const
 	return sound;
 }
 
+void cAudio :: Preload_Sound( std::string filename )
+{
+	if( !m_initialised || !m_sound_enabled || !m_sound_loader )
+	{
+		return;
+	}
+
+	// not available
+	if( !pResource_Manager->File_Exists( filename ) )
+	{
+		// add sound directory
+		if( filename.find( DATA_DIR "/" GAME_SOUNDS_DIR "/" ) == std::string::npos )
+		{
+			filename.insert( 0, DATA_DIR "/" GAME_SOUNDS_DIR "/" );
+		}
+
+		// no error as the level could have stopped using it
+		if( !pResource_Manager->File_Exists( filename ) )
+		{
+			return;
+		}
+	}
+
+	m_sound_loader->Add( filename );
+}
+
+bool cAudio :: Defer_Sound( const std::string &filename, int res_id, int volume, int loops )
+{
+	if( !m_sound_loader || pSound_Manager->Get_Pointer( filename ) || !m_sound_loader->Is_Pending( filename ) )
+	{
+		return 0;
+	}
+
+	// skip it
+	if( !m_sound_defer_time )
+	{
+		return 1;
+	}
+
+	cDeferred_Sound deferred;
+	deferred.m_filename = filename;
+	deferred.m_res_id = res_id;
+	deferred.m_volume = volume;
+	deferred.m_loops = loops;
+	deferred.m_deadline = SDL_GetTicks() + m_sound_defer_time;
+	m_deferred_sounds.push_back( deferred );
+
+	return 1;
+}
+
+void cAudio :: Get_Sound_Path( std::string &filename ) const
+{
+	// not available
+	if( !pResource_Manager->File_Exists( filename ) )
+	{
+		// add sound directory
+		if( filename.find( DATA_DIR "/" GAME_SOUNDS_DIR "/" ) == std::string::npos )
+		{
+			filename.insert( 0, DATA_DIR "/" GAME_SOUNDS_DIR "/" );
+		}
+	}
+}
+
+bool cAudio :: Resolve_Sound_Handle( const cSound_Handle &handle )
+{
+	if( handle.m_generation == pSound_Manager->Get_Generation() )
+	{
+		return 1;
+	}
+
+	std::string filename = handle.m_filename;
+	Get_Sound_Path( filename );
+
+	// still decoding
+	if( m_sound_loader && !pSound_Manager->Get_Pointer( filename ) && m_sound_loader->Is_Pending( filename ) )
+	{
+		return 0;
+	}
+
+	handle.m_sound = Get_Sound_File( filename );
+	handle.m_generation = pSound_Manager->Get_Generation();
+
+	// not tried again until the sounds are reloaded
+	if( !handle.m_sound )
+	{
+		printf( "Warning : Could not load sound file : %s\n", filename.c_str() );
+	}
+
+	return 1;
+}
+
 bool cAudio :: Play_Sound( std::string filename, int res_id /* = -1 */, int volume /* = -1 */, int loops /* = 0 */ )
 {
 	if( !m_initialised || !m_sound_enabled )
@@ -444,8 +785,14 @@ bool cAudio :: Play_Sound( std::string filename, int res_id /* = -1 */, int volu
 		return 0;
 	}
 
+	// played after the parallel update
+	if( pUpdate_Workers && pUpdate_Workers->Defer( boost::bind( static_cast<Play_Sound_Filename_Func>(&cAudio::Play_Sound), this, filename, res_id, volume, loops ) ) )
+	{
+		return 1;
+	}
+
 	// not available
-	if( !File_Exists( filename ) )
+	if( !pResource_Manager->File_Exists( filename ) )
 	{
 		// add sound directory
 		if( filename.find( DATA_DIR "/" GAME_SOUNDS_DIR "/" ) == std::string::npos )
@@ -454,13 +801,19 @@ bool cAudio :: Play_Sound( std::string filename, int res_id /* = -1 */, int volu
 		}
 
 		// not found
-		if( !File_Exists( filename ) )
+		if( !pResource_Manager->File_Exists( filename ) )
 		{
 			printf( "Could not find sound file : %s\n", filename.c_str() );
 			return 0;
 		}
 	}
 
+	// still decoding
+	if( Defer_Sound( filename, res_id, volume, loops ) )
+	{
+		return 1;
+	}
+
 	cSound *sound_data = Get_Sound_File( filename );
 
 	// failed loading
@@ -470,13 +823,73 @@ bool cAudio :: Play_Sound( std::string filename, int res_id /* = -1 */, int volu
 		return 0;
 	}
 
+	return Play_Sound_Data( sound_data, res_id, volume, loops ) != NULL;
+}
+
+bool cAudio :: Play_Sound( const cSound_Handle &handle, int res_id /* = -1 */, int volume /* = -1 */, int loops /* = 0 */ )
+{
+	if( !m_initialised || !m_sound_enabled )
+	{
+		return 0;
+	}
+
+	// played after the parallel update
+	if( pUpdate_Workers && pUpdate_Workers->Defer( boost::bind( static_cast<Play_Sound_Handle_Func>(&cAudio::Play_Sound), this, boost::cref( handle ), res_id, volume, loops ) ) )
+	{
+		return 1;
+	}
+
+	// resolve
+	if( handle.m_generation != pSound_Manager->Get_Generation() )
+	{
+		std::string filename = handle.m_filename;
+		Get_Sound_Path( filename );
+
+		// resolved when played again after the decoding
+		if( Defer_Sound( filename, res_id, volume, loops ) )
+		{
+			return 1;
+		}
+
+		handle.m_sound = Get_Sound_File( filename );
+		handle.m_generation = pSound_Manager->Get_Generation();
+
+		// not tried again until the sounds are reloaded
+		if( !handle.m_sound )
+		{
+			printf( "Warning : Could not load sound file : %s\n", filename.c_str() );
+		}
+	}
+
+	if( !handle.m_sound )
+	{
+		return 0;
+	}
+
+	return Play_Sound_Data( handle.m_sound, res_id, volume, loops ) != NULL;
+}
+
+cAudio_Sound *cAudio :: Play_Sound_Data( cSound *sound_data, int res_id /* = -1 */, int volume /* = -1 */, int loops /* = 0 */ )
+{
+	// volume is out of range
+	if( volume > MIX_MAX_VOLUME )
+	{
+		printf( "PlaySound Volume is out of range : %d\n", volume );
+		volume = m_sound_volume;
+	}
+	// no volume is given
+	else if( volume < 0 )
+	{
+		volume = m_sound_volume;
+	}
+
 	// create channel
-	cAudio_Sound *sound = Create_Sound_Channel();
+	cAudio_Sound *sound = Create_Sound_Channel( sound_data, volume );
 
 	if( !sound )
 	{
 		// no free channel available
-		return 0;
+		return NULL;
 	}
 
 	// load data
@@ -489,31 +902,18 @@ bool cAudio :: Play_Sound( std::string filename, int res_id /* = -1 */, int volu
 	{
 		if( m_debug )
 		{
-			printf( "Could not play sound file : %s\n", filename.c_str() );
+			printf( "Could not play sound file : %s\n", sound_data->m_filename.c_str() );
 		}
 
-		return 0;
+		Add_Free_Channel( sound->m_index );
+		return NULL;
 	}
-	// playing successfully
-	else
-	{
-		// volume is out of range
-		if( volume > MIX_MAX_VOLUME )
-		{
-			printf( "PlaySound Volume is out of range : %d\n", volume );
-			volume = m_sound_volume;
-		}
-		// no volume is given
-		else if( volume < 0 )
-		{
-			volume = m_sound_volume;
-		}
 
-		// set volume
-		Mix_Volume( sound->m_channel, volume );
-	}
+	// set volume
+	sound->m_volume = volume;
+	Mix_Volume( sound->m_channel, volume );
 
-	return 1;
+	return sound;
 }
 
 bool cAudio :: Play_Music( std::string filename, int loops /* = 0 */, bool force /* = 1 */, unsigned int fadein_ms /* = 0 */ )
@@ -541,76 +941,53 @@ bool cAudio :: Play_Music( std::string filename, int loops /* = 0 */, bool force
 	// if music is stopped resume it
 	Resume_Music();
 
-	// if no music is playing or force to play the given music
-	if( !Is_Music_Playing() || force ) 
+	// replaces the music not yet playing
+	if( force )
 	{
-		// stop and free current music
-		if( m_music )
-		{
-			Halt_Music();
-			Mix_FreeMusic( m_music );
-		}
-		// free old music
-		if( m_music_old )
+		m_music_loader->Clear();
+
+		if( m_music_next )
 		{
-			Mix_FreeMusic( m_music_old );
-			m_music_old = NULL;
+			delete m_music_next;
+			m_music_next = NULL;
 		}
+	}
 
-		// load the given music
-		m_music = Mix_LoadMUS( filename.c_str() );
+	// started in the update when loaded
+	m_music_loader->Load( filename, loops, force, fadein_ms );
 
-		// loaded
-		if( m_music )
-		{
-			// no fade in
-			if( !fadein_ms )
-			{
-				Mix_PlayMusic( m_music, loops );
-			}
-			// fade in
-			else
-			{
-				Mix_FadeInMusic( m_music, loops, fadein_ms );
-			}
-		}
-		// not loaded
-		else 
-		{
-			if( m_debug )
-			{
-				printf( "Couldn't load music file : %s\n", filename.c_str() );
-			}
+	return 1;
+}
 
-			// failed to play
-			return 0;
-		}
+void cAudio :: Set_Next_Music( cMusic_Data *music )
+{
+	// failed to load
+	if( !music->m_music )
+	{
+		delete music;
+		return;
+	}
+
+	// replace the wanted next playing music
+	if( m_music_next )
+	{
+		delete m_music_next;
 	}
-	// music is playing and is not forced
-	else
+
+	m_music_next = music;
+
+	// started in the update when the current music stopped
+	if( m_music_next->m_force && Is_Music_Playing() && Mix_FadingMusic() != MIX_FADING_OUT )
 	{
-		// if music is loaded
-		if( m_music )
+		if( m_music_next->m_fadein_ms )
 		{
-			// if old music is loaded free the wanted next playing music data
-			if( m_music_old )
-			{
-				Mix_FreeMusic( m_music );
-				m_music = NULL;
-			}
-			// if no old music move current to old music
-			else
-			{
-				m_music_old = m_music;
-				m_music = NULL;
-			}
+			Mix_FadeOutMusic( m_music_next->m_fadein_ms );
+		}
+		else
+		{
+			Halt_Music();
 		}
-
-		// load the wanted next playing music
-		m_music = Mix_LoadMUS( filename.c_str() );
 	}
-	
-	return 1;
 }
 
 cAudio_Sound *cAudio :: Get_Playing_Sound( std::string filename )
@@ -626,8 +1003,16 @@ cAudio_Sound *cAudio :: Get_Playing_Sound( std::string filename )
 		filename.insert( 0, DATA_DIR "/" GAME_SOUNDS_DIR "/" );
 	}
 
-	// get all sounds
-	for( AudioSoundList::const_iterator itr = m_active_sounds.begin(); itr != m_active_sounds.end(); ++itr )
+	const cSound *sound_data = pSound_Manager->Get_Pointer( filename );
+
+	// never loaded
+	if( !sound_data )
+	{
+		return NULL;
+	}
+
+	// get the sounds with this data
+	for( AudioSoundList::const_iterator itr = sound_data->m_audio_sounds.begin(); itr != sound_data->m_audio_sounds.end(); ++itr )
 	{
 		// get object pointer
 		cAudio_Sound *obj = (*itr);
@@ -638,45 +1023,139 @@ cAudio_Sound *cAudio :: Get_Playing_Sound( std::string filename )
 			continue;
 		}
 
-		// found it
-		if( obj->m_data->m_filename.compare( filename ) == 0 )
-		{
-			// return first found
-			return obj;
-		}
+		// return first found
+		return obj;
 	}
 
 	// not found
 	return NULL;
 }
 
-cAudio_Sound *cAudio :: Create_Sound_Channel( void )
+cAudio_Sound *cAudio :: Create_Sound_Channel( cSound *sound_data, int volume )
 {
-	// get all sounds
-	for( AudioSoundList::iterator itr = m_active_sounds.begin(); itr != m_active_sounds.end(); ++itr )
+	cAudio_Sound *steal = NULL;
+
+	// if playing too often take its oldest channel
+	unsigned int instances = 0;
+
+	for( vector<cAudio_Sound *>::const_iterator itr = sound_data->m_audio_sounds.begin(); itr != sound_data->m_audio_sounds.end(); ++itr )
 	{
-		// get object pointer
 		cAudio_Sound *obj = (*itr);
 
-		// if not playing
 		if( obj->m_channel < 0 )
 		{
-			// found a free channel
+			continue;
+		}
+
+		instances++;
+
+		if( !steal || static_cast<Sint32>(obj->m_start_time - steal->m_start_time) < 0 )
+		{
+			steal = obj;
+		}
+	}
+
+	if( instances < sound_data->m_max_instances )
+	{
+		steal = NULL;
+	}
+
+	if( !steal )
+	{
+		// channels stopped since the last update
+		Update_Finished_Channels();
+
+		// found a free channel
+		if( !m_free_channels.empty() )
+		{
+			const int channel = m_free_channels.back();
+			m_free_channels.pop_back();
+
+			cAudio_Sound *obj = m_active_sounds[channel];
+			obj->m_free = 0;
 			obj->Free();
 			return obj;
 		}
+
+		// take the least important channel
+		for( AudioSoundList::iterator itr = m_active_sounds.begin(); itr != m_active_sounds.end(); ++itr )
+		{
+			cAudio_Sound *obj = (*itr);
+
+			// only a higher priority can take it
+			if( obj->m_channel < 0 || !obj->m_data || obj->m_data->m_priority > sound_data->m_priority )
+			{
+				continue;
+			}
+
+			if( !steal || obj->m_data->m_priority < steal->m_data->m_priority ||
+				( obj->m_data->m_priority == steal->m_data->m_priority && ( obj->m_volume < steal->m_volume ||
+				( obj->m_volume == steal->m_volume && static_cast<Sint32>(obj->m_start_time - steal->m_start_time) < 0 ) ) ) )
+			{
+				steal = obj;
+			}
+		}
+
+		// none found
+		if( !steal )
+		{
+			return NULL;
+		}
+
+		// keep a louder sound with the same priority
+		if( steal->m_data->m_priority == sound_data->m_priority && steal->m_volume > volume )
+		{
+			return NULL;
+		}
 	}
 
-	// if not maximum sounds
-	if( m_active_sounds.size() < m_max_sounds )
+	if( m_debug )
 	{
-		cAudio_Sound *sound = new cAudio_Sound();
-		m_active_sounds.push_back( sound );
-		return sound;
+		printf( "Audio channel %d taken from %s\n", steal->m_index, steal->m_data->m_filename.c_str() );
 	}
 
-	// none found
-	return NULL;
+	// its finished callback is outdated when played again
+	steal->Free();
+
+	return steal;
+}
+
+void cAudio :: Add_Free_Channel( int channel )
+{
+	cAudio_Sound *sound = m_active_sounds[channel];
+
+	if( sound->m_free )
+	{
+		return;
+	}
+
+	sound->m_free = 1;
+	m_free_channels.push_back( channel );
+}
+
+void cAudio :: Update_Finished_Channels( void )
+{
+	cChannel_Finished item;
+
+	while( m_finished_channels.Pop( item ) )
+	{
+		// removed
+		if( static_cast<unsigned int>(item.m_channel) >= m_active_sounds.size() )
+		{
+			continue;
+		}
+
+		cAudio_Sound *sound = m_active_sounds[item.m_channel];
+
+		// played again since
+		if( sound->m_play_serial != item.m_serial )
+		{
+			continue;
+		}
+
+		sound->Finished();
+		Add_Free_Channel( item.m_channel );
+	}
 }
 
 void cAudio :: Toggle_Music( void )
@@ -777,14 +1256,22 @@ void cAudio :: Fadeout_Sounds( unsigned int ms, std::string filename, bool overw
 		filename.insert( 0, DATA_DIR "/" GAME_SOUNDS_DIR "/" );
 	}
 
-	// get all sounds
-	for( AudioSoundList::const_iterator itr = m_active_sounds.begin(); itr != m_active_sounds.end(); ++itr )
+	const cSound *sound_data = pSound_Manager->Get_Pointer( filename );
+
+	// never loaded
+	if( !sound_data )
+	{
+		return;
+	}
+
+	// get the sounds with this data
+	for( AudioSoundList::const_iterator itr = sound_data->m_audio_sounds.begin(); itr != sound_data->m_audio_sounds.end(); ++itr )
 	{
 		// get object pointer
 		const cAudio_Sound *obj = (*itr);
 
-		// filename does not match
-		if( obj->m_data->m_filename.compare( filename ) != 0 )
+		// not playing
+		if( obj->m_channel < 0 )
 		{
 			continue;
 		}
@@ -981,20 +1468,298 @@ void cAudio :: Update( void )
 		return;
 	}
 
+	Update_Latency();
+
+	if( m_sound_enabled )
+	{
+		Update_Finished_Channels();
+	}
+
+	// add the decoded sounds
+	if( m_sound_loader )
+	{
+		m_sound_loader->Update();
+
+		// play the deferred sounds if decoded or skip them if too late
+		if( !m_deferred_sounds.empty() )
+		{
+			DeferredSoundList deferred_sounds;
+			deferred_sounds.swap( m_deferred_sounds );
+
+			const Uint32 ticks = SDL_GetTicks();
+
+			for( DeferredSoundList::const_iterator itr = deferred_sounds.begin(); itr != deferred_sounds.end(); ++itr )
+			{
+				const cDeferred_Sound &deferred = (*itr);
+				cSound *sound_data = pSound_Manager->Get_Pointer( deferred.m_filename );
+
+				if( sound_data )
+				{
+					Play_Sound_Data( sound_data, deferred.m_res_id, deferred.m_volume, deferred.m_loops );
+				}
+				// still decoding
+				else if( m_sound_loader->Is_Pending( deferred.m_filename ) && static_cast<Sint32>(ticks - deferred.m_deadline) < 0 )
+				{
+					m_deferred_sounds.push_back( deferred );
+				}
+				else if( m_debug )
+				{
+					printf( "Skipped sound still decoding : %s\n", deferred.m_filename.c_str() );
+				}
+			}
+		}
+	}
+
 	// if music is enabled
 	if( m_music_enabled )
 	{
+		// loaded music until a forced one waits for the current music to fade out
+		while( !m_music_next || !m_music_next->m_force )
+		{
+			cMusic_Data *music = m_music_loader->Take();
+
+			if( !music )
+			{
+				break;
+			}
+
+			Set_Next_Music( music );
+		}
+
 		// if no music is playing
-		if( !Mix_PlayingMusic() && m_music ) 
+		if( !Mix_PlayingMusic() )
+		{
+			// switch to the next music
+			if( m_music_next )
+			{
+				if( m_music )
+				{
+					delete m_music;
+				}
+
+				m_music = m_music_next;
+				m_music_next = NULL;
+
+				// no fade in
+				if( !m_music->m_fadein_ms )
+				{
+					Mix_PlayMusic( m_music->m_music, m_music->m_loops );
+				}
+				// fade in
+				else
+				{
+					Mix_FadeInMusic( m_music->m_music, m_music->m_loops, m_music->m_fadein_ms );
+				}
+			}
+			// play the current music again
+			else if( m_music )
+			{
+				Mix_PlayMusic( m_music->m_music, 0 );
+			}
+		}
+	}
+}
+
+void cAudio :: Update_Latency( void )
+{
+	const Uint32 ticks = SDL_GetTicks();
+
+	// every second
+	if( ticks - m_latency_check_time < 1000 )
+	{
+		return;
+	}
+
+	SDL_LockAudio();
+	const Uint32 mix_count = m_mix_count;
+	const Uint32 mix_underruns = m_mix_underruns;
+	SDL_UnlockAudio();
+
+	const Uint32 count = mix_count - m_latency_check_count;
+	const Uint32 underruns = mix_underruns - m_latency_check_underruns;
+
+	// time between the mixed buffers
+	if( count )
+	{
+		m_latency = static_cast<float>(ticks - m_latency_check_time) / static_cast<float>(count);
+	}
+
+	m_latency_check_time = ticks;
+	m_latency_check_count = mix_count;
+	m_latency_check_underruns = mix_underruns;
+
+	// use a larger buffer
+	if( pPreferences->m_audio_low_latency && underruns >= audio_underrun_limit && m_audio_buffer < audio_default_buffer )
+	{
+		printf( "Warning : %d audio underruns with a buffer of %d, using %d\n", underruns, m_audio_buffer, m_audio_buffer * 2 );
+
+		m_audio_buffer_fallback = m_audio_buffer * 2;
+
+		Close();
+		Init();
+
+		if( m_music_enabled && !m_music_filename.empty() )
+		{
+			Play_Music( m_music_filename, -1, 1 );
+		}
+	}
+}
+
+void cAudio :: Add_Sound_Emitter( cSound_Emitter *emitter )
+{
+	emitter->m_index = m_sound_emitters.size();
+	m_sound_emitters.push_back( emitter );
+}
+
+void cAudio :: Remove_Sound_Emitter( cSound_Emitter *emitter )
+{
+	if( emitter->m_index < 0 )
+	{
+		return;
+	}
+
+	Stop_Sound_Emitter( emitter, 200 );
+
+	// move the last one into its place
+	cSound_Emitter *last = m_sound_emitters.back();
+	m_sound_emitters[emitter->m_index] = last;
+	last->m_index = emitter->m_index;
+	m_sound_emitters.pop_back();
+
+	emitter->m_index = -1;
+}
+
+void cAudio :: Stop_Sound_Emitter( cSound_Emitter *emitter, unsigned int fadeout_ms /* = 0 */ )
+{
+	if( emitter->m_channel < 0 )
+	{
+		return;
+	}
+
+	// only if not taken by another sound
+	if( static_cast<unsigned int>(emitter->m_channel) < m_active_sounds.size() )
+	{
+		cAudio_Sound *sound = m_active_sounds[emitter->m_channel];
+
+		if( sound->m_emitter == emitter )
+		{
+			sound->m_emitter = NULL;
+
+			if( fadeout_ms )
+			{
+				Fadeout_Sounds( fadeout_ms, sound->m_channel );
+			}
+			else
+			{
+				sound->Stop();
+			}
+		}
+	}
+
+	emitter->m_channel = -1;
+}
+
+void cAudio :: Update_Sound_Emitters( float listener_x, float listener_y )
+{
+	const unsigned int count = m_sound_emitters.size();
+
+	if( !count )
+	{
+		return;
+	}
+
+	m_emitter_x.resize( count );
+	m_emitter_y.resize( count );
+	m_emitter_begin.resize( count );
+	m_emitter_range.resize( count );
+	m_emitter_mod.resize( count );
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		const cSound_Emitter *emitter = m_sound_emitters[i];
+
+		m_emitter_x[i] = emitter->m_pos_x - listener_x;
+		m_emitter_y[i] = emitter->m_pos_y - listener_y;
+		m_emitter_begin[i] = emitter->m_volume_reduction_begin;
+		m_emitter_range[i] = 1.0f / ( emitter->m_volume_reduction_end - emitter->m_volume_reduction_begin );
+	}
+
+	// distance volume of all emitters in a loop without branches
+	const float *x = &m_emitter_x[0];
+	const float *y = &m_emitter_y[0];
+	const float *begin = &m_emitter_begin[0];
+	const float *range = &m_emitter_range[0];
+	float *mod = &m_emitter_mod[0];
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		const float distance = sqrtf( x[i] * x[i] + y[i] * y[i] );
+		const float value = 1.0f - ( distance - begin[i] ) * range[i];
+		mod[i] = value < 0.0f ? 0.0f : ( value > 1.0f ? 1.0f : value );
+	}
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		cSound_Emitter *emitter = m_sound_emitters[i];
+		emitter->m_distance_mod = mod[i];
+
+		const float play_volume = emitter->m_play_volume;
+		emitter->m_play_volume = -1.0f;
+
+		// not updated since the last pass
+		if( !emitter->m_active || !m_sound_enabled )
+		{
+			Stop_Sound_Emitter( emitter, 500 );
+			continue;
+		}
+
+		emitter->m_active = 0;
+
+		if( emitter->m_continuous )
+		{
+			const int volume = static_cast<int>(emitter->m_volume * mod[i] * static_cast<float>(MIX_MAX_VOLUME));
+
+			// still playing as the sound resets it when finished or taken
+			if( emitter->m_channel >= 0 )
+			{
+				// only if the change can be heard
+				if( abs( volume - emitter->m_mixer_volume ) >= audio_emitter_volume_step )
+				{
+					Mix_Volume( emitter->m_channel, volume );
+					emitter->m_mixer_volume = volume;
+				}
+
+				continue;
+			}
+
+			Stop_Sound_Emitter( emitter );
+
+			// too far away to be heard
+			if( volume < audio_emitter_min_volume || !Resolve_Sound_Handle( emitter->m_sound ) || !emitter->m_sound.m_sound )
+			{
+				continue;
+			}
+
+			cAudio_Sound *sound = Play_Sound_Data( emitter->m_sound.m_sound, -1, volume, -1 );
+
+			if( sound )
+			{
+				sound->m_emitter = emitter;
+				emitter->m_channel = sound->m_index;
+				emitter->m_mixer_volume = volume;
+			}
+		}
+		else if( play_volume >= 0.0f )
 		{
-			Mix_PlayMusic( m_music, 0 );
+			const int volume = static_cast<int>(play_volume * mod[i] * static_cast<float>(MIX_MAX_VOLUME));
 
-			// delete old music if available
-			if( m_music_old )
+			// too far away to be heard
+			if( volume < audio_emitter_min_volume || !Resolve_Sound_Handle( emitter->m_sound ) || !emitter->m_sound.m_sound )
 			{
-				Mix_FreeMusic( m_music_old );
-				m_music_old = NULL;
+				continue;
 			}
+
+			Play_Sound_Data( emitter->m_sound.m_sound, -1, volume );
 		}
 	}
 }
@@ -18,6 +18,8 @@
 
 #include "../core/global_basic.h"
 #include "../audio/sound_manager.h"
+#include "../audio/sound_loader.h"
+#include "../audio/music_loader.h"
 
 namespace SMC
 {
@@ -44,22 +46,31 @@ enum AudioChannel
 	RID_MOON			= 7
 };
 
+/* Callback after the mixer filled a buffer
+ * called from the audio thread with the audio locked
+*/
+void Mixed_Audio( void *audio_data, Uint8 *stream, int len );
+
 /* *** *** *** *** *** *** *** Audio Sound object *** *** *** *** *** *** *** *** *** *** */
 	
-// Callback for a sound finished playing 
+/* Callback for a sound finished playing
+ * called with the audio locked
+*/
 void Finished_Sound( const int channel );
 
+class cSound_Emitter;
+
 class cAudio_Sound
 {
 public:
-	cAudio_Sound( void );
+	cAudio_Sound( int index );
 	virtual ~cAudio_Sound( void );
 	
 	// Load the data
 	void Load( cSound *data );
 	// Free the data
 	void Free( void );
-	// Finished playing
+	// Finished playing which is only called by the audio update
 	void Finished( void );
 
 	/* Play the Sound
@@ -73,14 +84,116 @@ public:
 	// sound object
 	cSound *m_data;
 
-	// channel if playing else -1
+	// mixer channel used for playing which is also the index in the active sounds
+	int m_index;
+	// channel if playing else -1 which is only changed by the main thread
 	int m_channel;
+	/* increased every time it is played
+	 * read by the finished callback to detect when an earlier play of the channel finished
+	*/
+	Uint32 m_play_serial;
+	// if in the free channels
+	bool m_free;
 	// the last used resource id
 	int m_resource_id;
+	// volume and time when it was played for choosing the channel to take
+	int m_volume;
+	Uint32 m_start_time;
+	// emitter which plays it continuously or NULL
+	cSound_Emitter *m_emitter;
 };
 
 typedef vector<cAudio_Sound *> AudioSoundList;
 
+/* *** *** *** *** *** *** *** Channel finished queue *** *** *** *** *** *** *** *** *** *** */
+
+// Channel which finished playing
+struct cChannel_Finished
+{
+	int m_channel;
+	// play serial of the channel sound when it finished
+	Uint32 m_serial;
+};
+
+/* Lock-free queue of the finished channels from the mixer callback to the audio update
+ * the callback is called from the audio thread or with the audio locked when halting a channel
+ * so there is only one writer at a time and the audio update is the only reader
+*/
+class cChannel_Finished_Queue
+{
+public:
+	cChannel_Finished_Queue( void );
+
+	// Add from the mixer callback and returns false if full
+	bool Push( const cChannel_Finished &item );
+	// Take the oldest and returns false if empty
+	bool Pop( cChannel_Finished &item );
+
+	// must be a power of two
+	static const unsigned int m_capacity = 256;
+
+private:
+	cChannel_Finished m_items[m_capacity];
+	// only changed by the writer
+	volatile unsigned int m_write;
+	// only changed by the reader
+	volatile unsigned int m_read;
+};
+
+/* *** *** *** *** *** *** *** Sound emitter *** *** *** *** *** *** *** *** *** *** */
+
+/* Positioned sound source updated by the emitter pass of the audio
+ * the owner sets the settings and requests the sounds
+ * the audio calculates the distance volume and plays them
+*/
+class cSound_Emitter
+{
+public:
+	cSound_Emitter( void );
+
+	// position
+	float m_pos_x, m_pos_y;
+	// the volume is reduced from the beginning distance until it is silent at the end distance
+	float m_volume_reduction_begin, m_volume_reduction_end;
+	// sound
+	cSound_Handle m_sound;
+	// if set the sound loops while the emitter is active
+	bool m_continuous;
+	// volume of the continuous sound from 0 to 1
+	float m_volume;
+
+	// set by the owner for every frame it is updated in the active level
+	bool m_active;
+	// volume from 0 to 1 of a single play requested by the owner or negative if none
+	float m_play_volume;
+	// distance volume modifier from 0 to 1 calculated by the last emitter pass
+	float m_distance_mod;
+
+	// channel of the continuous sound if it is playing else -1 which is reset by the sound when finished or taken
+	int m_channel;
+	// mixer volume last set for the continuous sound
+	int m_mixer_volume;
+	// index in the audio emitters
+	int m_index;
+};
+
+typedef vector<cSound_Emitter *> SoundEmitterList;
+
+/* *** *** *** *** *** *** *** Deferred sound *** *** *** *** *** *** *** *** *** *** */
+
+// Sound play request waiting for the background decoding
+struct cDeferred_Sound
+{
+	std::string m_filename;
+	int m_res_id;
+	int m_volume;
+	int m_loops;
+	// skipped if not decoded until this time
+	Uint32 m_deadline;
+};
+
+typedef vector<cDeferred_Sound> DeferredSoundList;
+
 /* *** *** *** *** *** *** *** Audio class *** *** *** *** *** *** *** *** *** *** */
 
 class cAudio
@@ -101,10 +214,22 @@ public:
 	 * The returned sound should not be deleted or modified.
 	 */
 	cSound *Get_Sound_File( std::string filename ) const;
+	/* Decode the sound in the background if not already loaded
+	 * used to load the sounds a level can play while it is loaded
+	*/
+	void Preload_Sound( std::string filename );
 
 	// Play the given sound
 	bool Play_Sound( std::string filename, int res_id = -1, int volume = -1, int loops = 0 );
-	// If no forcing it will be played after the current music
+	/* Play the sound of the handle
+	 * it is resolved the first time and playing it again needs no filename or file lookup
+	 * the handle must exist until the end of the frame
+	*/
+	bool Play_Sound( const cSound_Handle &handle, int res_id = -1, int volume = -1, int loops = 0 );
+	/* Load the music in the background and play it when loaded
+	 * if forced the current music is faded out over the fade in time and earlier requests are dropped
+	 * if not forced it is played after the current music
+	*/
 	bool Play_Music( std::string filename, int loops = 0, bool force = 1, unsigned int fadein_ms = 0 ); 
 
 	/* Returns a pointer to the sound if it is active.
@@ -112,9 +237,22 @@ public:
 	 */
 	cAudio_Sound *Get_Playing_Sound( std::string filename );
 
-	/* Returns true if a free channel for the sound is available
+	/* Returns a free channel for the sound or NULL if none is available
+	 * if the sound is playing too often its oldest channel is taken
+	 * if no channel is free the one with the lowest priority, volume and the oldest is taken
+	 * if its priority is not higher than the given sound
+	*/
+	cAudio_Sound *Create_Sound_Channel( cSound *sound_data, int volume );
+	// Add the channel to the free channels if not already added
+	void Add_Free_Channel( int channel );
+	/* Handle the channels the mixer callback reported as finished
+	 * their sounds are set as not playing and notify their emitter and the channels are added to the free channels
+	*/
+	void Update_Finished_Channels( void );
+	/* Play the loaded sound on a free channel which is only allowed outside of the parallel update
+	 * returns the playing sound or NULL if it could not be played
 	*/
-	cAudio_Sound *Create_Sound_Channel( void );
+	cAudio_Sound *Play_Sound_Data( cSound *sound_data, int res_id = -1, int volume = -1, int loops = 0 );
 
 	// Toggle Music on/off
 	void Toggle_Music( void );
@@ -185,6 +323,29 @@ public:
 
 	// Update
 	void Update( void );
+	// Measure the latency and use a larger buffer if too many underruns are detected in the low latency mode
+	void Update_Latency( void );
+
+	// Add the emitter to the emitter pass until removed
+	void Add_Sound_Emitter( cSound_Emitter *emitter );
+	// Remove the emitter and fade out its continuous sound
+	void Remove_Sound_Emitter( cSound_Emitter *emitter );
+	// Stop the continuous sound of the emitter
+	void Stop_Sound_Emitter( cSound_Emitter *emitter, unsigned int fadeout_ms = 0 );
+	/* Calculate the distance volume of all emitters to the listener position
+	 * and play the sounds of the active emitters, update their volume or fade out the sounds of the inactive emitters
+	*/
+	void Update_Sound_Emitters( float listener_x, float listener_y );
+	// Set the loaded music as the next one and fade out the current music if forced
+	void Set_Next_Music( cMusic_Data *music );
+	// Play the sound later if it is still decoding and returns true if deferred or skipped
+	bool Defer_Sound( const std::string &filename, int res_id, int volume, int loops );
+	// Add the sound directory if the file is not found
+	void Get_Sound_Path( std::string &filename ) const;
+	/* Resolve the handle if the sounds were deleted
+	 * returns false if it is still decoding and should be tried again later
+	*/
+	bool Resolve_Sound_Handle( const cSound_Handle &handle );
 
 	// is the audio engine initialized
 	bool m_initialised;
@@ -201,18 +362,49 @@ public:
 	// current playing music filename
 	std::string m_music_filename;
 	// current playing music pointer
-	Mix_Music *m_music;
-	// if new music should play after the current this is the old data
-	Mix_Music *m_music_old;
+	cMusic_Data *m_music;
+	// loaded music which plays when the current stopped
+	cMusic_Data *m_music_next;
+	// background music loading or NULL if music is disabled
+	cMusic_Loader *m_music_loader;
 
-	// The current sounds pointer array
+	// The current sounds pointer array with one sound for every channel
 	AudioSoundList m_active_sounds;
+	// channels not playing which are only changed by the main thread
+	vector<int> m_free_channels;
+	// channels finished in the audio thread until the next audio update
+	cChannel_Finished_Queue m_finished_channels;
 
 	// maximum sounds allowed at once
 	unsigned int m_max_sounds;
 
+	// sound emitters
+	SoundEmitterList m_sound_emitters;
+	// emitter pass data
+	vector<float> m_emitter_x, m_emitter_y, m_emitter_begin, m_emitter_range, m_emitter_mod;
+
+	// background sound decoding or NULL if sound is disabled
+	cSound_Loader *m_sound_loader;
+	// play requests of sounds still decoding
+	DeferredSoundList m_deferred_sounds;
+	/* time in milliseconds a sound still decoding is waited for before it gets skipped
+	 * if 0 the sound is skipped at once
+	*/
+	Uint32 m_sound_defer_time;
+
 	// initialization information
 	int m_audio_buffer, m_audio_channels;
+	// buffer size used in the low latency mode after underruns or 0
+	int m_audio_buffer_fallback;
+
+	/* mixer callback count, last time, expected time between calls and detected underruns
+	 * only used with the audio locked
+	*/
+	Uint32 m_mix_count, m_mix_time, m_mix_period, m_mix_underruns;
+	// measured time in milliseconds between the mixed buffers
+	float m_latency;
+	// last latency measuring time and mixer values
+	Uint32 m_latency_check_time, m_latency_check_count, m_latency_check_underruns;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
@@ -0,0 +1,283 @@
+/***************************************************************************
+ * music_loader.cpp  -  background music loading
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../audio/music_loader.h"
+#include "../core/game_core.h"
+#include "../core/property_helper.h"
+#include "../core/filesystem/filesystem.h"
+#include "../core/task_pool.h"
+#include <cstdio>
+#include <algorithm>
+// boost
+#include <boost/bind.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cMusic_Data *** *** *** *** *** *** *** *** *** *** */
+
+cMusic_Data :: cMusic_Data( void )
+{
+	m_music = NULL;
+	m_rw = NULL;
+
+	m_loops = 0;
+	m_force = 0;
+	m_fadein_ms = 0;
+}
+
+cMusic_Data :: ~cMusic_Data( void )
+{
+	if( m_music )
+	{
+		Mix_FreeMusic( m_music );
+	}
+
+	if( m_rw )
+	{
+		SDL_FreeRW( m_rw );
+	}
+}
+
+bool cMusic_Data :: Load( const std::string &filename )
+{
+	m_filename = filename;
+
+	// also reads from the resource archive
+	cMapped_File file;
+
+	if( !file.Open( filename ) )
+	{
+		return 0;
+	}
+
+	m_data.assign( file.Get_Data(), file.Get_Data() + file.Get_Size() );
+	file.Close();
+
+	return Open();
+}
+
+bool cMusic_Data :: Load( const std::string &filename, const vector<Uint8> &data )
+{
+	m_filename = filename;
+	m_data = data;
+
+	return Open();
+}
+
+bool cMusic_Data :: Open( void )
+{
+	if( m_data.empty() )
+	{
+		return 0;
+	}
+
+	// the mixer does not free it
+	m_rw = SDL_RWFromConstMem( &m_data[0], m_data.size() );
+
+	if( !m_rw )
+	{
+		return 0;
+	}
+
+	m_music = Mix_LoadMUS_RW( m_rw );
+
+	return m_music != NULL;
+}
+
+/* *** *** *** *** *** *** *** cMusic_Loader *** *** *** *** *** *** *** *** *** *** */
+
+cMusic_Loader :: cMusic_Loader( void )
+{
+	m_generation = 0;
+	m_task_running = 0;
+	m_cache_size = 0;
+	m_cache_use = 0;
+
+	// jingles played over and over
+	m_pinned.push_back( DATA_DIR "/" GAME_MUSIC_DIR "/game/star.ogg" );
+	m_pinned.push_back( DATA_DIR "/" GAME_MUSIC_DIR "/game/courseclear.ogg" );
+	m_pinned.push_back( DATA_DIR "/" GAME_MUSIC_DIR "/game/menu.ogg" );
+
+	m_task_group = pTask_Pool->Create_Group();
+}
+
+cMusic_Loader :: ~cMusic_Loader( void )
+{
+	pTask_Pool->Cancel( m_task_group );
+
+	Clear();
+}
+
+void cMusic_Loader :: Load( const std::string &filename, int loops, bool force, unsigned int fadein_ms )
+{
+	cMusic_Data *music = new cMusic_Data();
+	music->m_filename = filename;
+	music->m_loops = loops;
+	music->m_force = force;
+	music->m_fadein_ms = fadein_ms;
+
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+		m_requests.push_back( music );
+
+		// the running task also loads this music
+		if( m_task_running )
+		{
+			return;
+		}
+
+		m_task_running = 1;
+	}
+
+	// one task at a time keeps the request order and the cache to itself
+	pTask_Pool->Add( boost::bind( &cMusic_Loader::Load_Task, this ), TASK_PRIORITY_BACKGROUND, m_task_group, "music load" );
+}
+
+cMusic_Data *cMusic_Loader :: Take( void )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	if( m_loaded.empty() )
+	{
+		return NULL;
+	}
+
+	cMusic_Data *music = m_loaded.front();
+	m_loaded.pop_front();
+
+	return music;
+}
+
+void cMusic_Loader :: Clear( void )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	for( std::deque<cMusic_Data *>::iterator itr = m_requests.begin(); itr != m_requests.end(); ++itr )
+	{
+		delete *itr;
+	}
+
+	for( std::deque<cMusic_Data *>::iterator itr = m_loaded.begin(); itr != m_loaded.end(); ++itr )
+	{
+		delete *itr;
+	}
+
+	m_requests.clear();
+	m_loaded.clear();
+	m_generation++;
+}
+
+void cMusic_Loader :: Load_Task( void )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	while( !m_requests.empty() && !pTask_Pool->Is_Cancelled( m_task_group ) )
+	{
+		cMusic_Data *music = m_requests.front();
+		m_requests.pop_front();
+		const unsigned int generation = m_generation;
+		lock.unlock();
+
+		if( !Load_Music( music ) )
+		{
+			printf( "Couldn't load music file : %s\n", music->m_filename.c_str() );
+		}
+
+		lock.lock();
+
+		// cleared in the meantime
+		if( generation != m_generation )
+		{
+			delete music;
+			continue;
+		}
+
+		m_loaded.push_back( music );
+	}
+
+	m_task_running = 0;
+}
+
+bool cMusic_Loader :: Load_Music( cMusic_Data *music )
+{
+	m_cache_use++;
+
+	Music_Cache::iterator itr = m_cache.find( music->m_filename );
+
+	// already in memory
+	if( itr != m_cache.end() )
+	{
+		(*itr).second.m_last_use = m_cache_use;
+		return music->Load( music->m_filename, (*itr).second.m_data );
+	}
+
+	if( !music->Load( music->m_filename ) )
+	{
+		return 0;
+	}
+
+	Cache_Music( music->m_filename, music->Get_Data() );
+	return 1;
+}
+
+void cMusic_Loader :: Cache_Music( const std::string &filename, const vector<Uint8> &data )
+{
+	const bool pinned = std::find( m_pinned.begin(), m_pinned.end(), filename ) != m_pinned.end();
+
+	// long music is streamed from its own copy only
+	if( !pinned && data.size() > m_max_cached_file_size )
+	{
+		return;
+	}
+
+	Cached_Music &cached = m_cache[filename];
+	cached.m_data = data;
+	cached.m_last_use = m_cache_use;
+	cached.m_pinned = pinned;
+	m_cache_size += static_cast<unsigned int>(data.size());
+
+	// remove the least recently used
+	while( m_cache_size > m_max_cache_size )
+	{
+		Music_Cache::iterator oldest = m_cache.end();
+
+		for( Music_Cache::iterator itr = m_cache.begin(); itr != m_cache.end(); ++itr )
+		{
+			if( (*itr).second.m_pinned || (*itr).first == filename )
+			{
+				continue;
+			}
+
+			if( oldest == m_cache.end() || (*itr).second.m_last_use < (*oldest).second.m_last_use )
+			{
+				oldest = itr;
+			}
+		}
+
+		// only pinned music left
+		if( oldest == m_cache.end() )
+		{
+			break;
+		}
+
+		m_cache_size -= static_cast<unsigned int>((*oldest).second.m_data.size());
+		m_cache.erase( oldest );
+	}
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,152 @@
+/***************************************************************************
+ * music_loader.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_MUSIC_LOADER_H
+#define SMC_MUSIC_LOADER_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL_mixer.h"
+// boost thread
+#include <boost/thread/mutex.hpp>
+// std
+#include <deque>
+#include <map>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cMusic_Data *** *** *** *** *** *** *** *** *** *** */
+
+/* Music file read completely into memory
+ * which lets it stream without reading from the disk
+*/
+class cMusic_Data
+{
+public:
+	cMusic_Data( void );
+	// the music must not be playing
+	~cMusic_Data( void );
+
+	// Read and open the music file
+	bool Load( const std::string &filename );
+	// Open a copy of the already read music file
+	bool Load( const std::string &filename, const vector<Uint8> &data );
+
+	// Returns the file data
+	inline const vector<Uint8> &Get_Data( void ) const
+	{
+		return m_data;
+	}
+
+	// full filename
+	std::string m_filename;
+	// opened music or NULL if it could not be loaded
+	Mix_Music *m_music;
+
+	// play settings as requested
+	int m_loops;
+	bool m_force;
+	unsigned int m_fadein_ms;
+
+private:
+	// Open the music from the file data
+	bool Open( void );
+
+	// file data which is used by the music while it exists
+	vector<Uint8> m_data;
+	SDL_RWops *m_rw;
+};
+
+/* *** *** *** *** *** *** *** cMusic_Loader *** *** *** *** *** *** *** *** *** *** */
+
+/* Loads music as task pool background task
+ * in the order requested
+ * the files of short music are kept in memory as repeatedly played jingles
+ * would else be read again from the disk every time
+*/
+class cMusic_Loader
+{
+public:
+	cMusic_Loader( void );
+	// waits for the current music and deletes the loaded music not taken
+	~cMusic_Loader( void );
+
+	// Add the full music filename with its play settings for loading
+	void Load( const std::string &filename, int loops, bool force, unsigned int fadein_ms );
+	/* Returns the next requested music if loaded else NULL
+	 * the caller gets ownership
+	*/
+	cMusic_Data *Take( void );
+	// Delete all requests and the loaded music not taken
+	void Clear( void );
+
+	// total size of the cached music files
+	static const unsigned int m_max_cache_size = 8 * 1024 * 1024;
+	// music files larger than this are not cached if not pinned
+	static const unsigned int m_max_cached_file_size = 1024 * 1024;
+
+private:
+	// music file kept in memory
+	struct Cached_Music
+	{
+		vector<Uint8> m_data;
+		// use counter value of the last use
+		unsigned int m_last_use;
+		// never removed from the cache
+		bool m_pinned;
+	};
+
+	typedef std::map<std::string, Cached_Music> Music_Cache;
+
+	// Load the requested music until none is left or cancelled
+	void Load_Task( void );
+	/* Load the music from the cache or from the file
+	 * only called from the task
+	*/
+	bool Load_Music( cMusic_Data *music );
+	/* Add the music file data to the cache
+	 * and remove the least recently used unpinned files over the size limit
+	 * only called from the task
+	*/
+	void Cache_Music( const std::string &filename, const vector<Uint8> &data );
+
+	// requested music not yet loaded
+	std::deque<cMusic_Data *> m_requests;
+	// loaded music not yet taken
+	std::deque<cMusic_Data *> m_loaded;
+	// increased when cleared to drop the music being loaded
+	unsigned int m_generation;
+
+	// task pool group of the loading
+	unsigned int m_task_group;
+	// protects the request and loaded music
+	boost::mutex m_mutex;
+	// if the task is added and not finished
+	bool m_task_running;
+
+	// music files used by the task only
+	Music_Cache m_cache;
+	// filenames of the short music which is always kept when loaded once
+	vector<std::string> m_pinned;
+	unsigned int m_cache_size;
+	unsigned int m_cache_use;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -37,6 +37,7 @@ cRandom_Sound :: cRandom_Sound( cSprite_Manager *sprite_manager )
 {
 	// Set defaults
 	cRandom_Sound::Init();
+	pAudio->Add_Sound_Emitter( &m_emitter );
 }
 
 cRandom_Sound :: cRandom_Sound( CEGUI::XMLAttributes &attributes, cSprite_Manager *sprite_manager )
@@ -44,11 +45,16 @@ cRandom_Sound :: cRandom_Sound( CEGUI::XMLAttributes &attributes, cSprite_Manage
 {
 	cRandom_Sound::Init();
 	cRandom_Sound::Load_From_XML( attributes );
+	pAudio->Add_Sound_Emitter( &m_emitter );
 }
 
 cRandom_Sound :: ~cRandom_Sound( void )
 {
-
+	// deleted before the levels on exit
+	if( pAudio )
+	{
+		pAudio->Remove_Sound_Emitter( &m_emitter );
+	}
 }
 
 void cRandom_Sound :: Init( void )
@@ -75,10 +81,8 @@ void cRandom_Sound :: Init( void )
 	m_volume_max = 100.0f;
 	m_volume_reduction_begin = 400.0f;
 	m_volume_reduction_end = 1000.0f;
-	
-	m_distance_to_camera = 0.0f;
+
 	m_next_play_delay = 0.0f;
-	m_volume_update_counter = 0.0f;
 
 	m_editor_color_volume_reduction_begin = Color( 0.1f, 0.5f, 0.1f, 0.2f );
 	m_editor_color_volume_reduction_end = Color( 0.2f, 0.4f, 0.1f, 0.2f );
@@ -118,10 +122,10 @@ void cRandom_Sound :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Volume_Reduction_End( attributes.getValueAsFloat( "volume_reduction_end", m_volume_reduction_end ) );
 }
 
-void cRandom_Sound :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cRandom_Sound :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// filename
 	Write_Property( stream, "file", m_filename.c_str() );
@@ -141,25 +145,16 @@ void cRandom_Sound :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "volume_reduction_end", m_volume_reduction_end );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cRandom_Sound :: Set_Filename( const std::string &str )
 {
-	// stop playing sounds
-	for( unsigned int i = 0; i < 100; i++ )
-	{
-		cAudio_Sound *sound = pAudio->Get_Playing_Sound( m_filename );
-
-		if( !sound )
-		{
-			break;
-		}
-
-		sound->Stop();
-	}
+	// stop playing sound
+	pAudio->Stop_Sound_Emitter( &m_emitter );
 
 	m_filename = str;
+	m_emitter.m_sound = m_filename;
 }
 
 std::string cRandom_Sound :: Get_Filename( void ) const
@@ -292,15 +287,7 @@ float cRandom_Sound :: Get_Volume_Reduction_End( void ) const
 
 float cRandom_Sound :: Get_Distance_Volume_Mod( void ) const
 {
-	// if in volume reduction range
-	if( m_distance_to_camera > m_volume_reduction_begin )
-	{
-		const float distance = m_distance_to_camera - m_volume_reduction_begin;
-		return 1.0f - distance / ( m_volume_reduction_end - m_volume_reduction_begin );
-	}
-
-	// no reduction
-	return 1.0f;
+	return m_emitter.m_distance_mod;
 }
 
 void cRandom_Sound :: Update( void )
@@ -312,98 +299,39 @@ void cRandom_Sound :: Update( void )
 		return;
 	}
 
-	bool play = 0;
+	m_emitter.m_active = 1;
 
+	// played while active
 	if( m_continuous )
 	{
-		m_volume_update_counter -= pFramerate->m_elapsed_ticks;
-
-		// get the sound
-		cAudio_Sound *sound = pAudio->Get_Playing_Sound( m_filename );
-
-		// if not playing
-		if( !sound )
-		{
-			// play it
-			play = 1;
-		}
-		// update volume
-		else if( m_volume_update_counter <= 0.0f )
-		{
-			// volume based on maximum
-			float sound_volume = m_volume_max * 0.01f;
-			// apply distance modifier
-			sound_volume *= Get_Distance_Volume_Mod();
-			// set to mixer volume
-			sound_volume *= static_cast<float>(MIX_MAX_VOLUME);
-			// set volume
-			pAudio->Set_Sound_Volume( static_cast<Uint8>(sound_volume), sound->m_channel );
-
-			// update volume every 100 ms
-			m_volume_update_counter = 100.0f;
-		}
+		return;
 	}
-	else
+
+	// subtract duration of this frame in milliseconds
+	m_next_play_delay -= pFramerate->m_elapsed_ticks;
+
+	if( m_next_play_delay > 0.0f )
 	{
-		// subtract duration of this frame in milliseconds
-		m_next_play_delay -= pFramerate->m_elapsed_ticks;
-
-		// play it
-		if( m_next_play_delay <= 0.0f )
-		{
-			play = 1;
-
-			// set next delay
-			m_next_play_delay = static_cast<float>(m_delay_min);
-
-			if( m_delay_max > m_delay_min )
-			{
-				m_next_play_delay += Get_Random_Float( 0.0f, static_cast<float>(m_delay_max - m_delay_min) );
-			}
-		}
+		return;
 	}
 
-	if( play )
+	// set next delay
+	m_next_play_delay = static_cast<float>(m_delay_min);
+
+	if( m_delay_max > m_delay_min )
 	{
-		float sound_volume = 0.0f;
-
-		// always maximum volume
-		if( m_continuous )
-		{
-			sound_volume = m_volume_max;
-		}
-		// set random volume
-		else
-		{
-			// random
-			if( m_volume_max > m_volume_min )
-			{
-				sound_volume = Get_Random_Float( m_volume_min, m_volume_max );
-			}
-			// static
-			else
-			{
-				sound_volume = m_volume_max;
-			}
-		}
-
-		sound_volume *= 0.01f;
-
-		// adjust volume based on distance
-		sound_volume *= Get_Distance_Volume_Mod();
-
-		int loops = 0;
-
-		if( m_continuous )
-		{
-			// unlimited
-			loops = -1;
-		}
-
-		sound_volume *= static_cast<float>(MIX_MAX_VOLUME);
-
-		// play sound
-		pAudio->Play_Sound( m_filename, -1, static_cast<int>(sound_volume), loops );
+		m_next_play_delay += Get_Random_Float( 0.0f, static_cast<float>(m_delay_max - m_delay_min) );
+	}
+
+	// random volume
+	if( m_volume_max > m_volume_min )
+	{
+		m_emitter.m_play_volume = Get_Random_Float( m_volume_min, m_volume_max ) * 0.01f;
+	}
+	// static
+	else
+	{
+		m_emitter.m_play_volume = m_volume_max * 0.01f;
 	}
 }
 
@@ -438,16 +366,17 @@ bool cRandom_Sound :: Is_Update_Valid( void )
 		return 0;
 	}
 
-	// get distance from camera center position
-	float dx = fabs( pActive_Camera->m_x + (game_res_w * 0.5f) - m_pos_x );
-	float dy = fabs( pActive_Camera->m_y + (game_res_h * 0.5f) - m_pos_y );
-
-	m_distance_to_camera = sqrt( dx * dx + dy * dy );
+	// settings for the next audio emitter pass
+	m_emitter.m_pos_x = m_pos_x;
+	m_emitter.m_pos_y = m_pos_y;
+	m_emitter.m_volume_reduction_begin = m_volume_reduction_begin;
+	m_emitter.m_volume_reduction_end = m_volume_reduction_end;
+	m_emitter.m_continuous = m_continuous;
+	m_emitter.m_volume = m_volume_max * 0.01f;
 
-	// if outside the range
-	if( m_distance_to_camera >= m_volume_reduction_end )
+	// if outside the range of the last pass
+	if( m_emitter.m_distance_mod <= 0.0f )
 	{
-		Event_Out_Of_Range();
 		return 0;
 	}
 
@@ -471,12 +400,6 @@ bool cRandom_Sound :: Is_Draw_Valid( void )
 	return 1;
 }
 
-void cRandom_Sound :: Event_Out_Of_Range( void ) const
-{
-	// fade out sounds if out of range
-	pAudio->Fadeout_Sounds( 500, m_filename );
-}
-
 void cRandom_Sound :: Editor_Activate( void )
 {
 	CEGUI::WindowManager &wmgr = CEGUI::WindowManager::getSingleton();
@@ -18,6 +18,7 @@
 
 #include "../core/global_basic.h"
 #include "../objects/sprite.h"
+#include "../audio/audio.h"
 
 namespace SMC
 {
@@ -42,7 +43,7 @@ public:
 	// load from stream
 	virtual void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream );
+	virtual void Save_To_XML( cXml_Writer &stream );
 
 	// Set filename
 	void Set_Filename( const std::string &str );
@@ -78,7 +79,7 @@ public:
 	// Get end of gradual volume reduction
 	float Get_Volume_Reduction_End( void ) const;
 
-	// Returns the volume modifier (0.0 - 1.0) for the current distance
+	// Returns the volume modifier (0.0 - 1.0) for the distance of the last audio emitter pass
 	float Get_Distance_Volume_Mod( void ) const;
 
 	// update
@@ -91,9 +92,6 @@ public:
 	// if draw is valid for the current state and position
 	virtual bool Is_Draw_Valid( void );
 
-	// if camera went out of range
-	void Event_Out_Of_Range( void ) const;
-
 	// editor activation
 	virtual void Editor_Activate( void );
 	// editor filename text changed event
@@ -130,13 +128,11 @@ private:
 	// volume reduction end
 	float m_volume_reduction_end;
 
-	// distance to camera
-	float m_distance_to_camera;
+	// played by the audio emitter pass
+	cSound_Emitter m_emitter;
 
 	// time until next play
 	float m_next_play_delay;
-	// time until next volume update
-	float m_volume_update_counter;
 
 	// editor color volume reduction begin
 	Color m_editor_color_volume_reduction_begin;
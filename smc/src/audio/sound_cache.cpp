@@ -0,0 +1,170 @@
+/***************************************************************************
+ * sound_cache.cpp  -  decoded sounds in the mixer format
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../audio/sound_cache.h"
+#include "../core/game_core.h"
+#include "../core/filesystem/filesystem.h"
+#include "../core/filesystem/resource_manager.h"
+#include <cstring>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cSound_Cache *** *** *** *** *** *** *** *** *** *** */
+
+// file identification and version
+static const char sound_cache_magic[4] = { 'S', 'M', 'C', 'S' };
+static const Uint32 sound_cache_version = 1;
+
+struct Sound_Cache_Header
+{
+	char m_magic[4];
+	Uint32 m_version;
+	Uint64 m_source_hash;
+	// mixer settings of the samples
+	Uint32 m_frequency;
+	Uint32 m_format;
+	Uint32 m_channels;
+	// sample data size in bytes
+	Uint32 m_length;
+};
+
+Mix_Chunk *cSound_Cache :: Load( const std::string &filename )
+{
+	int frequency = 0;
+	Uint16 format = 0;
+	int channels = 0;
+
+	// the samples are converted to the opened mixer format
+	if( !Mix_QuerySpec( &frequency, &format, &channels ) )
+	{
+		return Mix_LoadWAV_RW( Open_File_RW( filename ), 1 );
+	}
+
+	const Uint64 source_hash = Get_File_Hash( filename );
+
+	if( !source_hash )
+	{
+		return NULL;
+	}
+
+	const std::string cache_filename = Get_Cache_Filename( filename );
+	Mix_Chunk *chunk = Load_Cache_File( cache_filename, source_hash, frequency, format, channels );
+
+	if( chunk )
+	{
+		return chunk;
+	}
+
+	chunk = Mix_LoadWAV_RW( Open_File_RW( filename ), 1 );
+
+	if( chunk )
+	{
+		Save_Cache_File( cache_filename, chunk, source_hash, frequency, format, channels );
+	}
+
+	return chunk;
+}
+
+std::string cSound_Cache :: Get_Cache_Filename( const std::string &filename )
+{
+	// sounds with the same name in different directories
+	const Uint64 path_hash = Get_Data_Hash( filename.c_str(), filename.length() );
+
+	char hash_str[20];
+	sprintf( hash_str, "%08x%08x", static_cast<unsigned int>(path_hash >> 32), static_cast<unsigned int>(path_hash & 0xFFFFFFFF) );
+
+	return pResource_Manager->user_data_dir + USER_SOUND_CACHE_DIR "/" + Trim_Filename( filename, 0, 0 ) + "_" + hash_str + ".pcm";
+}
+
+Mix_Chunk *cSound_Cache :: Load_Cache_File( const std::string &cache_filename, Uint64 source_hash, int frequency, Uint16 format, int channels )
+{
+	cMapped_File file;
+
+	if( !file.Open( cache_filename ) || file.Get_Size() < sizeof( Sound_Cache_Header ) )
+	{
+		return NULL;
+	}
+
+	Sound_Cache_Header header;
+	memcpy( &header, file.Get_Data(), sizeof( Sound_Cache_Header ) );
+
+	// changed source or mixer settings
+	if( memcmp( header.m_magic, sound_cache_magic, 4 ) != 0 || header.m_version != sound_cache_version || header.m_source_hash != source_hash ||
+		header.m_frequency != static_cast<Uint32>(frequency) || header.m_format != format || header.m_channels != static_cast<Uint32>(channels) ||
+		!header.m_length || file.Get_Size() != sizeof( Sound_Cache_Header ) + header.m_length )
+	{
+		return NULL;
+	}
+
+	// the chunk frees the samples with it
+	Uint8 *samples = static_cast<Uint8 *>(SDL_malloc( header.m_length ));
+
+	if( !samples )
+	{
+		return NULL;
+	}
+
+	memcpy( samples, file.Get_Data() + sizeof( Sound_Cache_Header ), header.m_length );
+
+	Mix_Chunk *chunk = Mix_QuickLoad_RAW( samples, header.m_length );
+
+	if( !chunk )
+	{
+		SDL_free( samples );
+		return NULL;
+	}
+
+	chunk->allocated = 1;
+
+	return chunk;
+}
+
+void cSound_Cache :: Save_Cache_File( const std::string &cache_filename, const Mix_Chunk *chunk, Uint64 source_hash, int frequency, Uint16 format, int channels )
+{
+	Sound_Cache_Header header;
+	memcpy( header.m_magic, sound_cache_magic, 4 );
+	header.m_version = sound_cache_version;
+	header.m_source_hash = source_hash;
+	header.m_frequency = frequency;
+	header.m_format = format;
+	header.m_channels = channels;
+	header.m_length = chunk->alen;
+
+#ifdef _WIN32
+	FILE *fp = _wfopen( utf8_to_ucs2( cache_filename ).c_str(), L"wb" );
+#else
+	FILE *fp = fopen( cache_filename.c_str(), "wb" );
+#endif
+
+	if( !fp )
+	{
+		debug_print( "Warning : cSound_Cache : could not create %s\n", cache_filename.c_str() );
+		return;
+	}
+
+	const bool success = fwrite( &header, sizeof( Sound_Cache_Header ), 1, fp ) == 1 && fwrite( chunk->abuf, chunk->alen, 1, fp ) == 1;
+	fclose( fp );
+
+	// don't keep a partial file
+	if( !success )
+	{
+		Delete_File( cache_filename );
+	}
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
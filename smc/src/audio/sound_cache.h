@@ -0,0 +1,55 @@
+/***************************************************************************
+ * sound_cache.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_SOUND_CACHE_H
+#define SMC_SOUND_CACHE_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL_mixer.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cSound_Cache *** *** *** *** *** *** *** *** *** *** */
+
+/* Sounds decoded and converted to the mixer format in the user cache directory
+ * loading a cached sound is a file read instead of decoding and resampling it
+ * a cache file is only used if the source file hash and the mixer settings match
+ * can be used from every thread
+*/
+class cSound_Cache
+{
+public:
+	/* Load the sound from the cache or decode it and save it in the cache
+	 * returns the chunk owned by the caller or NULL if it could not be loaded
+	*/
+	static Mix_Chunk *Load( const std::string &filename );
+
+	// Returns the cache filename of the sound file
+	static std::string Get_Cache_Filename( const std::string &filename );
+
+private:
+	// Returns the chunk of the valid cache file or NULL
+	static Mix_Chunk *Load_Cache_File( const std::string &cache_filename, Uint64 source_hash, int frequency, Uint16 format, int channels );
+	// Save the decoded chunk
+	static void Save_Cache_File( const std::string &cache_filename, const Mix_Chunk *chunk, Uint64 source_hash, int frequency, Uint16 format, int channels );
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -0,0 +1,183 @@
+/***************************************************************************
+ * sound_loader.cpp  -  background sound decoding
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../audio/sound_loader.h"
+#include "../audio/sound_manager.h"
+#include "../audio/sound_cache.h"
+#include "../core/game_core.h"
+#include "../core/filesystem/filesystem.h"
+#include "../core/task_pool.h"
+#include <algorithm>
+// boost
+#include <boost/bind.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cSound_Loader *** *** *** *** *** *** *** *** *** *** */
+
+cSound_Loader :: cSound_Loader( void )
+{
+	m_task_running = 0;
+	m_task_group = pTask_Pool->Create_Group();
+}
+
+cSound_Loader :: ~cSound_Loader( void )
+{
+	pTask_Pool->Cancel( m_task_group );
+
+	for( Chunk_Map::iterator itr = m_done.begin(); itr != m_done.end(); ++itr )
+	{
+		if( itr->second )
+		{
+			Mix_FreeChunk( itr->second );
+		}
+	}
+}
+
+void cSound_Loader :: Add( const std::string &filename )
+{
+	if( pSound_Manager->Get_Pointer( filename ) )
+	{
+		return;
+	}
+
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+
+		if( !m_pending.insert( filename ).second )
+		{
+			return;
+		}
+
+		m_queue.push_back( filename );
+
+		// the running task also decodes this file
+		if( m_task_running )
+		{
+			return;
+		}
+
+		m_task_running = 1;
+	}
+
+	pTask_Pool->Add( boost::bind( &cSound_Loader::Decode_Task, this ), TASK_PRIORITY_BACKGROUND, m_task_group, "sound decode" );
+}
+
+bool cSound_Loader :: Is_Pending( const std::string &filename )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+	return m_pending.find( filename ) != m_pending.end();
+}
+
+void cSound_Loader :: Update( void )
+{
+	Chunk_Map done;
+
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+
+		if( m_done.empty() )
+		{
+			return;
+		}
+
+		done.swap( m_done );
+
+		for( Chunk_Map::const_iterator itr = done.begin(); itr != done.end(); ++itr )
+		{
+			m_pending.erase( itr->first );
+		}
+	}
+
+	for( Chunk_Map::iterator itr = done.begin(); itr != done.end(); ++itr )
+	{
+		// loading it on use shows the error
+		if( !itr->second )
+		{
+			debug_print( "Warning : cSound_Loader : could not decode %s\n", itr->first.c_str() );
+			continue;
+		}
+
+		// loaded in the meantime
+		if( pSound_Manager->Get_Pointer( itr->first ) )
+		{
+			Mix_FreeChunk( itr->second );
+			continue;
+		}
+
+		cSound *sound = new cSound();
+		sound->m_filename = itr->first;
+		sound->m_chunk = itr->second;
+		pSound_Manager->Add( sound );
+	}
+}
+
+Mix_Chunk *cSound_Loader :: Take( const std::string &filename )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	if( m_pending.find( filename ) == m_pending.end() )
+	{
+		return NULL;
+	}
+
+	// not started
+	std::deque<std::string>::iterator queue_itr = std::find( m_queue.begin(), m_queue.end(), filename );
+
+	if( queue_itr != m_queue.end() )
+	{
+		m_queue.erase( queue_itr );
+		m_pending.erase( filename );
+		return NULL;
+	}
+
+	// wait for the decoding
+	while( m_done.find( filename ) == m_done.end() )
+	{
+		m_condition.wait( lock );
+	}
+
+	Chunk_Map::iterator itr = m_done.find( filename );
+	Mix_Chunk *chunk = itr->second;
+	m_done.erase( itr );
+	m_pending.erase( filename );
+
+	return chunk;
+}
+
+void cSound_Loader :: Decode_Task( void )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	while( !m_queue.empty() && !pTask_Pool->Is_Cancelled( m_task_group ) )
+	{
+		const std::string filename = m_queue.front();
+		m_queue.pop_front();
+		lock.unlock();
+
+		Mix_Chunk *chunk = cSound_Cache::Load( filename );
+
+		lock.lock();
+		m_done[filename] = chunk;
+		m_condition.notify_all();
+	}
+
+	m_task_running = 0;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
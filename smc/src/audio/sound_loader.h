@@ -0,0 +1,84 @@
+/***************************************************************************
+ * sound_loader.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_SOUND_LOADER_H
+#define SMC_SOUND_LOADER_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL_mixer.h"
+// boost thread
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+// std
+#include <deque>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cSound_Loader *** *** *** *** *** *** *** *** *** *** */
+
+/* Decodes sound files one after another as task pool background task
+ * the decoded sounds are added to the sound manager with the next update
+ * files can be added while it is running
+*/
+class cSound_Loader
+{
+public:
+	cSound_Loader( void );
+	// waits for the current file and deletes the sounds not taken
+	~cSound_Loader( void );
+
+	// Add the full sound filename if not already loaded or added
+	void Add( const std::string &filename );
+	// Returns true if the file is added and not yet taken
+	bool Is_Pending( const std::string &filename );
+	// Add the decoded sounds to the sound manager
+	void Update( void );
+	/* Take the file for loading it now
+	 * waits if it is being decoded or removes it from the queue
+	 * returns the decoded chunk owned by the caller or NULL if it was not decoded
+	*/
+	Mix_Chunk *Take( const std::string &filename );
+
+private:
+	// Decode the queued files until none is left or cancelled
+	void Decode_Task( void );
+
+	// files waiting for decoding
+	std::deque<std::string> m_queue;
+	// queued, decoding and decoded files not yet taken
+	boost::unordered_set<std::string> m_pending;
+	// decoded chunks or NULL if decoding failed
+	typedef boost::unordered_map<std::string, Mix_Chunk *> Chunk_Map;
+	Chunk_Map m_done;
+
+	// task pool group of the decoding
+	unsigned int m_task_group;
+	// protects the queue, pending and done files
+	boost::mutex m_mutex;
+	// notified if a file is decoded
+	boost::condition_variable m_condition;
+	// if the task is added and not finished
+	bool m_task_running;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
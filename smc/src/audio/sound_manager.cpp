@@ -14,6 +14,12 @@
 */
 
 #include "../audio/sound_manager.h"
+#include "../audio/audio.h"
+#include "../audio/sound_cache.h"
+#include "../core/global_game.h"
+#include "../core/filesystem/filesystem.h"
+#include "../core/string_table.h"
+#include <cstring>
 
 namespace SMC
 {
@@ -23,6 +29,8 @@ namespace SMC
 cSound :: cSound( void )
 {
 	m_chunk = NULL;
+	m_priority = SOUND_PRIORITY_NORMAL;
+	m_max_instances = 4;
 }
 
 cSound :: ~cSound( void )
@@ -34,7 +42,7 @@ bool cSound :: Load( const std::string &filename )
 {
 	Free();
 	
-	m_chunk = Mix_LoadWAV( filename.c_str() );
+	m_chunk = cSound_Cache::Load( filename );
 
 	if( m_chunk )
 	{
@@ -56,13 +64,69 @@ void cSound :: Free( void )
 	m_filename.clear();
 }
 
+bool cSound :: Reload( void )
+{
+	if( m_filename.empty() )
+	{
+		return 0;
+	}
+
+	Mix_Chunk *chunk = cSound_Cache::Load( m_filename );
+
+	if( !chunk )
+	{
+		printf( "Warning : cSound :: Reload %s loading failed\n", m_filename.c_str() );
+		return 0;
+	}
+
+	// the channels must not play the old data
+	for( vector<cAudio_Sound *>::iterator itr = m_audio_sounds.begin(); itr != m_audio_sounds.end(); ++itr )
+	{
+		(*itr)->Stop();
+	}
+
+	if( m_chunk )
+	{
+		Mix_FreeChunk( m_chunk );
+	}
+
+	m_chunk = chunk;
+
+	return 1;
+}
+
+/* *** *** *** *** *** *** *** *** Sound handle *** *** *** *** *** *** *** *** *** */
+
+cSound_Handle :: cSound_Handle( void )
+{
+	m_sound = NULL;
+	m_generation = 0;
+}
+
+cSound_Handle :: cSound_Handle( const std::string &filename )
+{
+	m_filename = filename;
+	m_sound = NULL;
+	m_generation = 0;
+}
+
+cSound_Handle &cSound_Handle :: operator = ( const std::string &filename )
+{
+	m_filename = filename;
+	m_sound = NULL;
+	m_generation = 0;
+
+	return *this;
+}
+
 
 /* *** *** *** *** *** *** cSound_Manager *** *** *** *** *** *** *** *** *** *** *** */
 
 cSound_Manager :: cSound_Manager( void )
-: cObject_Manager<cSound>()
+: cObject_Manager<cSound>(), m_memory( "Sounds" )
 {
 	m_load_count = 0;
+	m_generation = 1;
 }
 
 cSound_Manager :: ~cSound_Manager( void )
@@ -72,25 +136,91 @@ cSound_Manager :: ~cSound_Manager( void )
 
 cSound *cSound_Manager :: Get_Pointer( const std::string &path ) const
 {
-	for( SoundList::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
-	{
-		cSound *obj = (*itr);
+	Sound_Map::const_iterator itr = m_sound_map.find( cString_Table::Normalize_Path( path ) );
 
-		if( obj->m_filename.compare( path ) == 0 )
-		{
-			// return first found
-			return obj;
-		}
+	// not found
+	if( itr == m_sound_map.end() )
+	{
+		return NULL;
 	}
 
-	// not found
-	return NULL;
+	return itr->second;
 }
 
 void cSound_Manager :: Add( cSound *sound )
 {
 	m_load_count++;
+	m_memory.Count_Allocation();
 	cObject_Manager<cSound>::Add( sound );
+
+	const std::string path = cString_Table::Normalize_Path( sound->m_filename );
+	Set_Voice_Settings( sound, path );
+	// keep the first one
+	m_sound_map.insert( Sound_Map::value_type( path, sound ) );
+}
+
+void cSound_Manager :: Delete_All( void )
+{
+	cObject_Manager<cSound>::Delete_All();
+	m_sound_map.clear();
+	m_generation++;
+
+	// 0 is used for not resolved handles
+	if( !m_generation )
+	{
+		m_generation = 1;
+	}
+}
+
+// voice settings of the sounds starting with the path in the sounds directory
+struct Sound_Voice_Setting
+{
+	const char *m_path;
+	SoundPriority m_priority;
+	unsigned int m_max_instances;
+};
+
+static const Sound_Voice_Setting sound_voice_settings[] =
+{
+	// never lost
+	{ "player/", SOUND_PRIORITY_HIGH, 2 },
+	{ "editor/", SOUND_PRIORITY_HIGH, 1 },
+	{ "error.ogg", SOUND_PRIORITY_HIGH, 1 },
+	{ "savegame_", SOUND_PRIORITY_HIGH, 1 },
+	{ "item/live_up", SOUND_PRIORITY_HIGH, 2 },
+	// collected many at once
+	{ "item/goldpiece", SOUND_PRIORITY_NORMAL, 3 },
+	{ "enemy/", SOUND_PRIORITY_NORMAL, 3 },
+	{ "wall_hit.wav", SOUND_PRIORITY_LOW, 2 },
+	{ "sprout_1.ogg", SOUND_PRIORITY_LOW, 2 },
+	// level random sounds
+	{ "ambient/", SOUND_PRIORITY_LOW, 2 },
+	{ "babble/", SOUND_PRIORITY_LOW, 2 }
+};
+
+void cSound_Manager :: Set_Voice_Settings( cSound *sound, const std::string &normalized_path )
+{
+	const std::string sound_dir = GAME_SOUNDS_DIR "/";
+	const size_t pos = normalized_path.find( sound_dir );
+
+	if( pos == std::string::npos )
+	{
+		return;
+	}
+
+	const std::string path = normalized_path.substr( pos + sound_dir.length() );
+
+	for( unsigned int i = 0; i < sizeof( sound_voice_settings ) / sizeof( sound_voice_settings[0] ); i++ )
+	{
+		const Sound_Voice_Setting &setting = sound_voice_settings[i];
+
+		if( path.compare( 0, strlen( setting.m_path ), setting.m_path ) == 0 )
+		{
+			sound->m_priority = setting.m_priority;
+			sound->m_max_instances = setting.m_max_instances;
+			return;
+		}
+	}
 }
 
 void cSound_Manager :: Delete_Sounds( void )
@@ -104,6 +234,25 @@ void cSound_Manager :: Delete_Sounds( void )
 	}
 }
 
+void cSound_Manager :: Update_Memory_Counter( void )
+{
+	Uint64 bytes = 0;
+
+	for( SoundList::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	{
+		const cSound *obj = (*itr);
+
+		bytes += sizeof( cSound );
+
+		if( obj->m_chunk )
+		{
+			bytes += obj->m_chunk->alen;
+		}
+	}
+
+	m_memory.Set( bytes );
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 cSound_Manager *pSound_Manager = NULL;
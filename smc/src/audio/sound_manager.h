@@ -18,13 +18,26 @@
 
 #include "../core/global_basic.h"
 #include "../core/obj_manager.h"
+#include "../core/memory_pool.h"
 // SDL
 // also includes needed SDL headers
 #include "SDL_mixer.h"
+// boost
+#include <boost/unordered_map.hpp>
 
 namespace SMC
 {
 
+class cAudio_Sound;
+
+// Voice priority of a sound which can only take the channel of a sound with the same or a lower priority
+enum SoundPriority
+{
+	SOUND_PRIORITY_LOW = 0,
+	SOUND_PRIORITY_NORMAL = 1,
+	SOUND_PRIORITY_HIGH = 2
+};
+
 /* *** *** *** *** *** *** *** Sound object *** *** *** *** *** *** *** *** *** *** */
 
 class cSound
@@ -37,15 +50,50 @@ public:
 	bool Load( const std::string &filename );
 	// Free the data
 	void Free( void );
+	/* Load the data again from the file
+	 * stops the audio sounds playing it but they keep it loaded
+	 * returns false if it could not be loaded and keeps the old data then
+	*/
+	bool Reload( void );
 
 	// filename
 	std::string m_filename;
 	// data if loaded else null
 	Mix_Chunk *m_chunk;
+	// audio sounds which have this sound loaded
+	vector<cAudio_Sound *> m_audio_sounds;
+
+	// voice priority
+	SoundPriority m_priority;
+	// maximum number of channels playing it at once
+	unsigned int m_max_instances;
 };
 
 typedef vector<cSound *> SoundList;
 
+/* *** *** *** *** *** *** *** Sound handle *** *** *** *** *** *** *** *** *** *** */
+
+/* Sound which is resolved once when played the first time
+ * playing it again needs no filename or file lookup
+ * resolved again if the sounds were deleted
+*/
+class cSound_Handle
+{
+public:
+	cSound_Handle( void );
+	cSound_Handle( const std::string &filename );
+
+	// Set the filename which gets resolved when played
+	cSound_Handle &operator = ( const std::string &filename );
+
+	// filename as given to cAudio::Play_Sound
+	std::string m_filename;
+	// resolved sound or NULL if it could not be loaded
+	mutable cSound *m_sound;
+	// sound manager generation when resolved or 0 if not resolved
+	mutable unsigned int m_generation;
+};
+
 /* *** *** *** *** *** *** cSound_Manager *** *** *** *** *** *** *** *** *** *** *** */
 
 /*  Keeps track of all sounds in memory
@@ -60,13 +108,23 @@ public:
 	cSound_Manager( void );
 	virtual ~cSound_Manager( void );
 
-	// Return the Sound from Path
+	/* Return the Sound from Path
+	 * the path is compared normalized
+	*/
 	virtual cSound *Get_Pointer( const std::string &path ) const;
 
 	/* Add a Sound
 	 * Should always have the path set
 	 */
 	void Add( cSound *item );
+	// Delete all Sounds which makes the sound handles resolve again
+	virtual void Delete_All( void );
+
+	// Returns the generation which changes if sounds are deleted
+	inline unsigned int Get_Generation( void ) const
+	{
+		return m_generation;
+	}
 
 	cSound *operator [] ( unsigned int identifier ) const
 	{
@@ -81,9 +139,24 @@ public:
 	// Delete all Sounds, but keep object vector entries
 	void Delete_Sounds( void );
 
+	// Count the memory of the sounds for the memory counter
+	void Update_Memory_Counter( void );
+
+	// memory of the sounds
+	cMemory_Counter m_memory;
+
 private:
 	// sounds loaded since initialization
 	unsigned int m_load_count;
+	// never 0
+	unsigned int m_generation;
+
+	// Set the voice priority and instance limit of the sound based on its path
+	static void Set_Voice_Settings( cSound *sound, const std::string &normalized_path );
+
+	// sounds by normalized path
+	typedef boost::unordered_map<std::string, cSound *> Sound_Map;
+	Sound_Map m_sound_map;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
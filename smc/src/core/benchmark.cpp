@@ -0,0 +1,652 @@
+/***************************************************************************
+ * benchmark.cpp  -  measures the collision handling
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/benchmark.h"
+#include "../core/game_core.h"
+#include "../core/collision.h"
+#include "../core/camera.h"
+#include "../core/framerate.h"
+#include "../core/sprite_manager.h"
+#include "../level/level.h"
+#include "../level/level_player.h"
+#include "../enemies/furball.h"
+#include "../enemies/turtle.h"
+#include "../objects/ball.h"
+#include "../core/profiler.h"
+#include "../core/object_profiler.h"
+#include "../core/memory_pool.h"
+#include "../core/filesystem/filesystem.h"
+#include "../level/level_manager.h"
+#include "../level/level_generator.h"
+#include "../input/input_recorder.h"
+#include "../video/video.h"
+#include "../video/renderer.h"
+#include "../core/property_helper.h"
+// boost
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <algorithm>
+
+namespace SMC
+{
+
+// frames measured for every level size
+static const unsigned int benchmark_frames = 300;
+// massive tile counts
+static const unsigned int benchmark_sizes[] = { 250, 1000, 4000, 16000 };
+// object counts of the generated stress levels
+static const unsigned int scaling_benchmark_sizes[] = { 10000, 50000, 100000 };
+
+/* *** *** *** *** *** *** *** Benchmark *** *** *** *** *** *** *** *** *** *** */
+
+// Print the string as JSON string
+static void Profiler_Print_JSON_String( const std::string &str )
+{
+	putchar( '"' );
+
+	for( std::string::const_iterator itr = str.begin(); itr != str.end(); ++itr )
+	{
+		const unsigned char c = static_cast<unsigned char>(*itr);
+
+		if( c == '"' || c == '\\' )
+		{
+			printf( "\\%c", c );
+		}
+		else if( c < 0x20 )
+		{
+			printf( "\\u%04x", c );
+		}
+		else
+		{
+			putchar( c );
+		}
+	}
+
+	putchar( '"' );
+}
+
+
+// Fill the sprite manager with the generated objects and return their count
+static unsigned int Benchmark_Create_Objects( cSprite_Manager *sprite_manager, unsigned int tile_count )
+{
+	cGL_Surface *tile_image = pVideo->Get_Surface( "ground/green_1/slider/1/brown/middle.png" );
+	float tile_w = 64.0f;
+
+	// massive ground
+	for( unsigned int i = 0; i < tile_count; i++ )
+	{
+		cSprite *tile = new cSprite( sprite_manager );
+		tile->Set_Image( tile_image, 1 );
+		tile->Set_Massive_Type( MASS_MASSIVE );
+
+		if( tile->m_col_rect.m_w > 0.0f )
+		{
+			tile_w = tile->m_col_rect.m_w;
+		}
+
+		tile->Set_Pos( i * tile_w, 0.0f, 1 );
+		sprite_manager->Add( tile );
+	}
+
+	const float ground_w = tile_count * tile_w;
+	const unsigned int enemy_count = tile_count / 8;
+	const unsigned int shell_count = tile_count / 32;
+
+	// walking enemies
+	for( unsigned int i = 0; i < enemy_count; i++ )
+	{
+		cFurball *furball = new cFurball( sprite_manager );
+		furball->Set_Color( COL_BROWN );
+		furball->Set_Direction( i % 2 ? DIR_LEFT : DIR_RIGHT );
+		furball->Set_Pos( ( i + 0.5f ) * ground_w / enemy_count, -furball->m_col_rect.m_h, 1 );
+		sprite_manager->Add( furball );
+	}
+
+	// running shells and bouncing balls
+	for( unsigned int i = 0; i < shell_count; i++ )
+	{
+		const float pos_x = ( i + 0.25f ) * ground_w / shell_count;
+
+		cTurtle *turtle = new cTurtle( sprite_manager );
+		turtle->Set_Color( COL_RED );
+		turtle->Set_Direction( i % 2 ? DIR_LEFT : DIR_RIGHT, 1 );
+		turtle->Set_Turtle_Moving_State( TURTLE_SHELL_RUN );
+		turtle->Set_Pos( pos_x, -turtle->m_col_rect.m_h, 1 );
+		turtle->m_velx = i % 2 ? -10.0f : 10.0f;
+		sprite_manager->Add( turtle );
+
+		cBall *ball = new cBall( sprite_manager );
+		ball->Set_Pos( pos_x + 100.0f, -100.0f, 1 );
+		ball->Set_Origin( ARRAY_PLAYER, TYPE_PLAYER );
+		ball->Set_Ball_Type( FIREBALL_DEFAULT );
+		ball->Set_Velocity_From_Angle( i % 2 ? 135.0f : 45.0f, 10.0f );
+		ball->m_direction = ball->m_velx > 0.0f ? DIR_RIGHT : DIR_LEFT;
+		sprite_manager->Add( ball );
+	}
+
+	return tile_count + enemy_count + shell_count * 2;
+}
+
+void Collision_Benchmark( void )
+{
+	cSprite_Manager *sprite_manager = pActive_Level->m_sprite_manager;
+
+	// the player should not die
+	const bool god_mode = pLevel_Player->m_god_mode;
+	pLevel_Player->m_god_mode = 1;
+
+	// constant speed
+	pFramerate->m_speed_factor = 1.0f;
+
+	printf( "Collision benchmark with %d frames\n", benchmark_frames );
+	// the collision loops read the members at the start of each object
+	printf( "Sprite size %u bytes, moving sprite size %u bytes\n", static_cast<unsigned int>(sizeof(cSprite)), static_cast<unsigned int>(sizeof(cMovingSprite)) );
+
+	for( unsigned int size = 0; size < sizeof( benchmark_sizes ) / sizeof( benchmark_sizes[0] ); size++ )
+	{
+		sprite_manager->Delete_All();
+
+		const unsigned int object_count = Benchmark_Create_Objects( sprite_manager, benchmark_sizes[size] );
+
+		// player walking on the ground
+		pLevel_Player->Set_Pos( 100.0f, -pLevel_Player->m_col_rect.m_h, 1 );
+		pLevel_Player->m_velx = 5.0f;
+		pLevel_Player->m_vely = 0.0f;
+
+		const unsigned int collisions_start = Get_Collision_Created_Count();
+		const unsigned int allocations_start = Get_Collision_Allocation_Count();
+		Uint32 collision_ticks = 0;
+
+		for( unsigned int frame = 0; frame < benchmark_frames; frame++ )
+		{
+			pActive_Camera->Center();
+			// movement and gravity are not measured
+			sprite_manager->Update_Items();
+
+			const Uint32 start_ticks = SDL_GetTicks();
+
+			pLevel_Player->Collide_Move();
+			pLevel_Player->Handle_Collisions();
+			sprite_manager->Handle_Collision_Items();
+
+			collision_ticks += SDL_GetTicks() - start_ticks;
+		}
+
+		const double ns_per_object = ( static_cast<double>(collision_ticks) * 1000000.0 ) / ( static_cast<double>(object_count + 1) * benchmark_frames );
+
+		printf( "%d objects : %.1f ns per object and frame, %d ms, %d collisions, %d collision allocations\n", object_count, ns_per_object, collision_ticks,
+			Get_Collision_Created_Count() - collisions_start, Get_Collision_Allocation_Count() - allocations_start );
+	}
+
+	sprite_manager->Delete_All();
+	pLevel_Player->m_god_mode = god_mode;
+}
+
+// Print the mean, 95th percentile and maximum of the frame times in microseconds as JSON object
+static void Benchmark_Print_Times( const char *name, vector<Uint64> times )
+{
+	Uint64 total = 0;
+
+	for( vector<Uint64>::const_iterator itr = times.begin(); itr != times.end(); ++itr )
+	{
+		total += (*itr);
+	}
+
+	std::sort( times.begin(), times.end() );
+
+	const Uint64 mean = times.empty() ? 0 : total / times.size();
+	const Uint64 p95 = times.empty() ? 0 : times[( times.size() * 95 ) / 100 < times.size() ? ( times.size() * 95 ) / 100 : times.size() - 1];
+	const Uint64 max = times.empty() ? 0 : times.back();
+
+	printf( "\"%s\":{\"mean_us\":%u,\"p95_us\":%u,\"max_us\":%u}", name, static_cast<unsigned int>(mean), static_cast<unsigned int>(p95), static_cast<unsigned int>(max) );
+}
+
+// Returns the allocations of all memory pools which did not reuse a freed object
+static unsigned int Benchmark_Get_Pool_Allocations( void )
+{
+	unsigned int allocations = 0;
+	const Memory_Pool_List &pools = Get_Memory_Pools();
+
+	for( Memory_Pool_List::const_iterator itr = pools.begin(); itr != pools.end(); ++itr )
+	{
+		allocations += (*itr)->m_misses;
+	}
+
+	return allocations;
+}
+
+/* Print the live and peak bytes and the allocations per frame of the memory counters as JSON
+ * allocations : allocations of each counter in all frames
+*/
+static void Benchmark_Print_Memory( const vector<Uint64> &allocations, unsigned int frames )
+{
+	const Memory_Counter_List &counters = Get_Memory_Counters();
+
+	printf( ",\"memory\":{" );
+
+	for( unsigned int i = 0; i < counters.size(); i++ )
+	{
+		const cMemory_Counter *counter = counters[i];
+		const Uint64 counter_allocations = i < allocations.size() ? allocations[i] : 0;
+
+		if( i )
+		{
+			putchar( ',' );
+		}
+
+		Profiler_Print_JSON_String( counter->m_name );
+		printf( ":{\"live_bytes\":%.0f,\"peak_bytes\":%.0f,\"allocations_per_frame\":%.2f}", static_cast<double>(counter->m_bytes), static_cast<double>(counter->m_peak),
+			frames ? static_cast<double>(counter_allocations) / frames : 0.0 );
+	}
+
+	putchar( '}' );
+}
+
+// Print the most expensive object classes or sprite types as JSON array member
+static void Benchmark_Print_Object_Costs( const char *name, bool by_class )
+{
+	cObject_Profiler::Cost_List costs;
+	const unsigned int frames = pObject_Profiler->Get_Top_Costs( costs, by_class, 10 );
+
+	printf( ",\"%s\":[", name );
+
+	for( cObject_Profiler::Cost_List::const_iterator itr = costs.begin(); frames && itr != costs.end(); ++itr )
+	{
+		const cObject_Profiler::Cost &cost = (*itr);
+
+		if( itr != costs.begin() )
+		{
+			putchar( ',' );
+		}
+
+		printf( "{\"name\":" );
+		Profiler_Print_JSON_String( cost.m_name );
+		printf( ",\"us_per_frame\":%.1f,\"update\":%.1f,\"update_late\":%.1f,\"draw\":%.1f,\"collision\":%.1f,\"candidates_per_frame\":%.1f,\"collisions_per_frame\":%.1f}",
+			static_cast<double>(cost.Get_Time()) / frames, static_cast<double>(cost.m_time[cObject_Profiler::PHASE_UPDATE]) / frames,
+			static_cast<double>(cost.m_time[cObject_Profiler::PHASE_UPDATE_LATE]) / frames, static_cast<double>(cost.m_time[cObject_Profiler::PHASE_DRAW]) / frames,
+			static_cast<double>(cost.m_time[cObject_Profiler::PHASE_COLLISION]) / frames, static_cast<double>(cost.m_candidates) / frames, static_cast<double>(cost.m_collisions) / frames );
+	}
+
+	putchar( ']' );
+}
+
+// Measure the levels and print the results as JSON
+static bool Benchmark_Levels( const vector<std::string> &levels, unsigned int frames, bool render )
+{
+	// the same random numbers in every run
+	if( !level_random_seed )
+	{
+		level_random_seed = 1;
+	}
+
+	// constant speed
+	pFramerate->Set_Fixed_Speedfacor( 1.0f );
+	pProfiler->Set_Enabled( 1 );
+	// costs of all frames of a level
+	const unsigned int object_window_frames = pObject_Profiler->m_window_frames;
+	pObject_Profiler->Set_Enabled( 1 );
+	pObject_Profiler->m_window_frames = 0;
+
+	bool success = 1;
+
+	printf( "{\"frames\":%u,\"render\":%s,\"seed\":%u,\"levels\":[", frames, render ? "true" : "false", level_random_seed );
+
+	for( vector<std::string>::const_iterator itr = levels.begin(); itr != levels.end(); ++itr )
+	{
+		const std::string name = Trim_Filename( (*itr), 0, 0 );
+
+		if( itr != levels.begin() )
+		{
+			putchar( ',' );
+		}
+
+		printf( "\n{\"level\":" );
+		Profiler_Print_JSON_String( name );
+
+		pLevel_Manager->Unload();
+		const Uint64 load_start = Get_Microseconds();
+		cLevel *level = pLevel_Manager->Load( name );
+		const Uint64 load_time = Get_Microseconds() - load_start;
+
+		if( !level->Is_Loaded() )
+		{
+			printf( ",\"error\":\"load failed\"}" );
+			success = 0;
+			continue;
+		}
+
+		printf( ",\"objects\":%u,\"load_us\":%u", static_cast<unsigned int>(level->m_sprite_manager->size()), static_cast<unsigned int>(load_time) );
+
+		pLevel_Manager->Set_Active( level );
+		level->Init();
+		Leave_Game_Mode( MODE_LEVEL );
+		Enter_Game_Mode( MODE_LEVEL );
+
+		// the player should not die or leave the level
+		const bool god_mode = pLevel_Player->m_god_mode;
+		pLevel_Player->m_god_mode = 1;
+
+		vector<Uint64> update_times;
+		vector<Uint64> collision_times;
+		vector<Uint64> submit_times;
+		vector<Uint64> render_times;
+		vector<Uint64> frame_times;
+
+		// the first frame starts with empty section times
+		pProfiler->Frame_End();
+		pObject_Profiler->Clear();
+
+		const unsigned int collision_allocations_start = Get_Collision_Allocation_Count();
+		const unsigned int pool_allocations_start = Benchmark_Get_Pool_Allocations();
+		// allocations of each memory counter in all frames
+		vector<Uint64> memory_allocations( Get_Memory_Counters().size(), 0 );
+		Memory_Counters_Frame_End();
+
+		for( unsigned int frame = 0; frame < frames; frame++ )
+		{
+			{
+				cProfiler_Scope profile_scope( "benchmark frame" );
+
+				// recorded input
+				if( pInput_Recorder->Is_Replaying() )
+				{
+					pInput_Recorder->Update();
+				}
+
+				pLevel_Manager->Update();
+
+				if( render )
+				{
+					pLevel_Manager->Draw();
+					pVideo->Render();
+				}
+			}
+
+			// ignore level exits and game mode changes
+			Game_Action = GA_NONE;
+
+			pFramerate->Update();
+			pProfiler->Frame_End();
+			pObject_Profiler->Frame_End();
+			Update_Memory_Counters();
+			Memory_Counters_Frame_End();
+
+			update_times.push_back( pProfiler->Get_Last_Frame_Time( "level update" ) );
+			collision_times.push_back( pProfiler->Get_Last_Frame_Time( "player collisions" ) + pProfiler->Get_Last_Frame_Time( "level collisions" ) );
+			submit_times.push_back( pProfiler->Get_Last_Frame_Time( "level draw" ) );
+			render_times.push_back( pProfiler->Get_Last_Frame_Time( "render" ) );
+			frame_times.push_back( pProfiler->Get_Last_Frame_Time( "benchmark frame" ) );
+
+			const Memory_Counter_List &counters = Get_Memory_Counters();
+
+			for( unsigned int i = 0; i < counters.size() && i < memory_allocations.size(); i++ )
+			{
+				memory_allocations[i] += counters[i]->m_last_frame_allocations;
+			}
+		}
+
+		pLevel_Player->m_god_mode = god_mode;
+
+		putchar( ',' );
+		Benchmark_Print_Times( "update", update_times );
+		putchar( ',' );
+		Benchmark_Print_Times( "collision", collision_times );
+		putchar( ',' );
+		Benchmark_Print_Times( "render_submit", submit_times );
+		putchar( ',' );
+		Benchmark_Print_Times( "render", render_times );
+		putchar( ',' );
+		Benchmark_Print_Times( "frame", frame_times );
+		printf( ",\"collision_allocations\":%u,\"pool_allocations\":%u,\"draw_calls\":%u", Get_Collision_Allocation_Count() - collision_allocations_start,
+			Benchmark_Get_Pool_Allocations() - pool_allocations_start, render ? pRender_Stats->m_last.m_draw_calls : 0 );
+		Benchmark_Print_Memory( memory_allocations, frames );
+		Benchmark_Print_Object_Costs( "object_classes", 1 );
+		Benchmark_Print_Object_Costs( "object_types", 0 );
+		putchar( '}' );
+	}
+
+	printf( "\n],\"success\":%s}\n", success ? "true" : "false" );
+
+	pProfiler->Set_Enabled( 0 );
+	pObject_Profiler->Set_Enabled( 0 );
+	pObject_Profiler->m_window_frames = object_window_frames;
+	pFramerate->Set_Fixed_Speedfacor( 0.0f );
+
+	return success;
+}
+
+bool Level_Benchmark( const std::string &level_name, unsigned int frames, bool render )
+{
+	vector<std::string> levels;
+
+	// every game level
+	if( level_name == "all" )
+	{
+		levels = Get_Directory_Files( DATA_DIR "/" GAME_LEVEL_DIR, ".smclvl", 0, 0 );
+		std::sort( levels.begin(), levels.end() );
+	}
+	else
+	{
+		levels.push_back( level_name );
+	}
+
+	return Benchmark_Levels( levels, frames, render );
+}
+
+bool Scaling_Benchmark( const cStress_Level_Mix &mix, unsigned int frames, bool render )
+{
+	vector<std::string> levels;
+
+	for( unsigned int i = 0; i < sizeof( scaling_benchmark_sizes ) / sizeof( scaling_benchmark_sizes[0] ); i++ )
+	{
+		const std::string name = "stress_" + int_to_string( scaling_benchmark_sizes[i] );
+
+		if( !Generate_Stress_Level( name, scaling_benchmark_sizes[i], mix ) )
+		{
+			printf( "Error : Could not generate the stress level %s\n", name.c_str() );
+			return 0;
+		}
+
+		levels.push_back( name );
+	}
+
+	return Benchmark_Levels( levels, frames, render );
+}
+
+/* *** *** *** *** *** *** *** cLoad_Profiler *** *** *** *** *** *** *** *** *** *** */
+
+// Returns the current time in microseconds
+static Uint64 Profiler_Get_Time( void )
+{
+	static const boost::posix_time::ptime epoch = boost::posix_time::microsec_clock::universal_time();
+	return static_cast<Uint64>(( boost::posix_time::microsec_clock::universal_time() - epoch ).total_microseconds());
+}
+
+// phase with its name for sorting
+typedef std::pair<std::string, std::pair<Uint64, unsigned int> > Profiler_Phase_Entry;
+
+// sorts by time descending
+static bool Profiler_Phase_Sort( const Profiler_Phase_Entry &a, const Profiler_Phase_Entry &b )
+{
+	return a.second.first > b.second.first;
+}
+
+cLoad_Profiler :: cLoad_Profiler( void )
+{
+	m_active = 0;
+	m_start_time = 0;
+	m_total_time = 0;
+	m_phases_time = 0;
+}
+
+void cLoad_Profiler :: Start( const std::string &name )
+{
+	m_phases.clear();
+	m_open_phases.clear();
+	m_name = name;
+	m_active = 1;
+	m_thread_id = boost::this_thread::get_id();
+	m_total_time = 0;
+	m_phases_time = 0;
+	m_start_time = Profiler_Get_Time();
+}
+
+void cLoad_Profiler :: Stop( void )
+{
+	if( !m_active )
+	{
+		return;
+	}
+
+	while( !m_open_phases.empty() )
+	{
+		Leave();
+	}
+
+	m_total_time = Profiler_Get_Time() - m_start_time;
+	m_active = 0;
+}
+
+bool cLoad_Profiler :: Is_Active( void ) const
+{
+	return m_active && boost::this_thread::get_id() == m_thread_id;
+}
+
+void cLoad_Profiler :: Enter( const std::string &phase )
+{
+	Open_Phase open_phase;
+	open_phase.m_phase = &m_phases[phase];
+	open_phase.m_nested_time = 0;
+	open_phase.m_start_time = Profiler_Get_Time();
+
+	m_open_phases.push_back( open_phase );
+}
+
+void cLoad_Profiler :: Leave( void )
+{
+	if( m_open_phases.empty() )
+	{
+		return;
+	}
+
+	const Open_Phase &open_phase = m_open_phases.back();
+	const Uint64 time = Profiler_Get_Time() - open_phase.m_start_time;
+
+	open_phase.m_phase->m_time += time - open_phase.m_nested_time;
+	open_phase.m_phase->m_count++;
+
+	m_open_phases.pop_back();
+
+	if( m_open_phases.empty() )
+	{
+		m_phases_time += time;
+	}
+	else
+	{
+		m_open_phases.back().m_nested_time += time;
+	}
+}
+
+void cLoad_Profiler :: Print( bool json /* = 0 */ ) const
+{
+	vector<Profiler_Phase_Entry> entries;
+
+	for( Phase_Map::const_iterator itr = m_phases.begin(); itr != m_phases.end(); ++itr )
+	{
+		entries.push_back( Profiler_Phase_Entry( itr->first, std::make_pair( itr->second.m_time, itr->second.m_count ) ) );
+	}
+
+	// time not in a phase
+	if( m_total_time > m_phases_time )
+	{
+		entries.push_back( Profiler_Phase_Entry( "other", std::make_pair( m_total_time - m_phases_time, 1u ) ) );
+	}
+
+	std::stable_sort( entries.begin(), entries.end(), Profiler_Phase_Sort );
+
+	const double total_ms = m_total_time * 0.001;
+
+	if( json )
+	{
+		printf( "{\"level\":" );
+		Profiler_Print_JSON_String( m_name );
+		printf( ",\"total_ms\":%.3f,\"phases\":[", total_ms );
+
+		for( vector<Profiler_Phase_Entry>::const_iterator itr = entries.begin(); itr != entries.end(); ++itr )
+		{
+			if( itr != entries.begin() )
+			{
+				putchar( ',' );
+			}
+
+			printf( "{\"name\":" );
+			Profiler_Print_JSON_String( itr->first );
+			printf( ",\"count\":%u,\"ms\":%.3f}", itr->second.second, itr->second.first * 0.001 );
+		}
+
+		printf( "]}\n" );
+		return;
+	}
+
+	printf( "Level load profile of %s : %.2f ms\n", m_name.c_str(), total_ms );
+	printf( "%-48s %8s %10s %6s\n", "phase", "count", "ms", "%" );
+
+	for( vector<Profiler_Phase_Entry>::const_iterator itr = entries.begin(); itr != entries.end(); ++itr )
+	{
+		const double ms = itr->second.first * 0.001;
+		printf( "%-48s %8u %10.2f %5.1f%%\n", itr->first.c_str(), itr->second.second, ms, total_ms > 0.0 ? ( ms * 100.0 ) / total_ms : 0.0 );
+	}
+}
+
+cLoad_Profiler *pLoad_Profiler = NULL;
+
+/* *** *** *** *** *** *** *** cLoad_Profiler_Scope *** *** *** *** *** *** *** *** *** *** */
+
+cLoad_Profiler_Scope :: cLoad_Profiler_Scope( void )
+{
+	m_entered = 0;
+}
+
+cLoad_Profiler_Scope :: cLoad_Profiler_Scope( const char *phase )
+{
+	m_entered = 0;
+
+	if( pLoad_Profiler && pLoad_Profiler->Is_Active() )
+	{
+		Start( phase );
+	}
+}
+
+cLoad_Profiler_Scope :: ~cLoad_Profiler_Scope( void )
+{
+	if( m_entered && pLoad_Profiler )
+	{
+		pLoad_Profiler->Leave();
+	}
+}
+
+void cLoad_Profiler_Scope :: Start( const std::string &phase )
+{
+	if( m_entered || !pLoad_Profiler || !pLoad_Profiler->Is_Active() )
+	{
+		return;
+	}
+
+	pLoad_Profiler->Enter( phase );
+	m_entered = 1;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
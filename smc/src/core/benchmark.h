@@ -0,0 +1,146 @@
+/***************************************************************************
+ * benchmark.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_BENCHMARK_H
+#define SMC_BENCHMARK_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL.h"
+// boost thread
+#include <boost/thread/thread.hpp>
+#include <map>
+
+namespace SMC
+{
+
+class cStress_Level_Mix;
+
+/* *** *** *** *** *** *** *** Benchmark *** *** *** *** *** *** *** *** *** *** */
+
+/* Measure the collision handling with generated level objects
+ * fills the active level with massive tiles, walking enemies, running shells and balls
+ * runs the collision handling for a fixed number of frames without drawing
+ * and prints the results of each level size
+ * the active level is empty afterwards
+*/
+void Collision_Benchmark( void );
+
+/* Measure the level update and rendering of game levels
+ * runs the level manager update loop with a fixed speed factor and random seed
+ * and with the input of a replayed recording
+ * and prints the update, collision, render submit, render and frame times
+ * and the allocations of each level as JSON
+ * level_name : level to measure or "all" for every game level
+ * frames : frames measured in each level
+ * render : if set each frame is also drawn and rendered
+ * returns false if a level could not be loaded
+*/
+bool Level_Benchmark( const std::string &level_name, unsigned int frames, bool render );
+
+/* Measure how the level update scales with the object count
+ * generates stress levels with 10000, 50000 and 100000 objects of the mix
+ * and measures them like the level benchmark with their load time and object count
+ * returns false if a level could not be generated or loaded
+*/
+bool Scaling_Benchmark( const cStress_Level_Mix &mix, unsigned int frames, bool render );
+
+/* *** *** *** *** *** *** *** cLoad_Profiler *** *** *** *** *** *** *** *** *** *** */
+
+/* Measures the time of the level loading phases
+ * the time of a nested phase is not added to the outer phase
+ * only the thread which started the profiling is measured
+*/
+class cLoad_Profiler
+{
+public:
+	cLoad_Profiler( void );
+
+	// Start measuring the loading of the named level
+	void Start( const std::string &name );
+	// Stop measuring
+	void Stop( void );
+
+	// Returns true if the calling thread is measured
+	bool Is_Active( void ) const;
+	// Enter a phase
+	void Enter( const std::string &phase );
+	// Leave the last entered phase
+	void Leave( void );
+
+	// Print the phases sorted by time as text or JSON
+	void Print( bool json = 0 ) const;
+
+private:
+	// measured phase
+	struct Phase
+	{
+		Phase( void )
+		: m_time( 0 ), m_count( 0 ) {}
+
+		// time without nested phases in microseconds
+		Uint64 m_time;
+		// times entered
+		unsigned int m_count;
+	};
+
+	// entered phase
+	struct Open_Phase
+	{
+		Phase *m_phase;
+		Uint64 m_start_time;
+		// time of the nested phases
+		Uint64 m_nested_time;
+	};
+
+	typedef std::map<std::string, Phase> Phase_Map;
+	Phase_Map m_phases;
+	vector<Open_Phase> m_open_phases;
+
+	// measured level
+	std::string m_name;
+	bool m_active;
+	boost::thread::id m_thread_id;
+	Uint64 m_start_time;
+	Uint64 m_total_time;
+	// time of the phases entered directly
+	Uint64 m_phases_time;
+};
+
+/* Measures a phase until it is destroyed
+ * does nothing if no profiling is active
+*/
+class cLoad_Profiler_Scope
+{
+public:
+	cLoad_Profiler_Scope( void );
+	explicit cLoad_Profiler_Scope( const char *phase );
+	~cLoad_Profiler_Scope( void );
+
+	// Enter the phase if profiling is active and no phase was entered
+	void Start( const std::string &phase );
+
+private:
+	bool m_entered;
+};
+
+// Level load profiler or NULL if not profiling
+extern cLoad_Profiler *pLoad_Profiler;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -44,6 +44,8 @@ cCamera :: cCamera( cSprite_Manager *sprite_manager )
 	m_ver_offset_speed = 0.2f;
 
 	m_fixed_hor_vel = 0.0f;
+	m_velx = 0.0f;
+	m_vely = 0.0f;
 
 	// default camera limit
 	Reset_Limits();
@@ -281,6 +283,20 @@ GL_rect cCamera :: Get_Rect( void ) const
 	return GL_rect( m_x, m_y, static_cast<float>(game_res_w), static_cast<float>(game_res_h) );
 }
 
+GL_rect cCamera :: Get_Predicted_Rect( const float frames /* = camera_prediction_frames */ ) const
+{
+	float x = m_x + ( m_fixed_hor_vel ? m_fixed_hor_vel : m_velx ) * frames;
+	float y = m_y + m_vely * frames;
+
+	// level mode
+	if( ( Game_Mode == MODE_LEVEL || Game_Mode == MODE_OVERWORLD ) && !editor_enabled )
+	{
+		Update_Limit( x, y );
+	}
+
+	return GL_rect( x, y, static_cast<float>(game_res_w), static_cast<float>(game_res_h) );
+}
+
 void cCamera :: Set_Limits( const GL_rect &rect )
 {
 	m_limit_rect = rect;
@@ -326,6 +342,9 @@ void cCamera :: Update_Limit_Y( float &y ) const
 
 void cCamera :: Update( void ) 
 {
+	const float last_x = m_x;
+	const float last_y = m_y;
+
 	// level
 	if( Game_Mode == MODE_LEVEL )
 	{
@@ -434,6 +453,23 @@ void cCamera :: Update( void )
 			Set_Pos_Y( pActive_Player->m_pos_y - game_res_h * 0.6f );
 		}
 	}
+
+	Update_Velocity( m_x - last_x, m_y - last_y );
+}
+
+void cCamera :: Update_Velocity( const float move_x, const float move_y )
+{
+	// jumped to another position like a level exit
+	if( fabs( move_x ) > game_res_w * 0.5f || fabs( move_y ) > game_res_h * 0.5f || pFramerate->m_speed_factor <= 0.0f )
+	{
+		m_velx = 0.0f;
+		m_vely = 0.0f;
+		return;
+	}
+
+	// smoothed as following the player moves unevenly
+	m_velx += ( ( move_x / pFramerate->m_speed_factor ) - m_velx ) * 0.2f;
+	m_vely += ( ( move_y / pFramerate->m_speed_factor ) - m_vely ) * 0.2f;
 }
 
 void cCamera :: Update_Position( void ) const
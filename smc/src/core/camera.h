@@ -34,6 +34,9 @@ enum Camera_movement
 
 /* *** *** *** *** *** cCamera *** *** *** *** *** *** *** *** *** *** *** *** */
 
+// frames the content the camera moves to is prepared ahead
+static const float camera_prediction_frames = 45.0f;
+
 class cCamera
 {
 public:
@@ -71,6 +74,11 @@ public:
 	float Get_Center_Pos_Y( void ) const;
 	// get camera rect
 	GL_rect Get_Rect( void ) const;
+	/* Get the camera rect expected after the given frames
+	 * from the fixed scrolling or the measured camera motion and limited like the camera
+	 * used to load and wake up content before it becomes visible
+	*/
+	GL_rect Get_Predicted_Rect( const float frames = camera_prediction_frames ) const;
 
 	// reset limits
 	inline void Reset_Limits( void )
@@ -105,6 +113,8 @@ public:
 	void Update_Limit_Y( float &y ) const;
 	// update if position changed
 	void Update_Position( void ) const;
+	// Update the measured motion with the movement of the last update
+	void Update_Velocity( const float move_x, const float move_y );
 
 	// the parent sprite manager
 	cSprite_Manager *m_sprite_manager;
@@ -119,6 +129,8 @@ public:
 
 	// fixed horizontal scrolling velocity
 	float m_fixed_hor_vel;
+	// smoothed motion of the updates per speed factor
+	float m_velx, m_vely;
 
 	// default limits
 	static const GL_rect m_default_limits;
@@ -16,6 +16,7 @@
 #include "../core/campaign_manager.h"
 #include "../gui/hud.h"
 #include "../core/game_core.h"
+#include "../core/xml_reader.h"
 #include "../core/filesystem/filesystem.h"
 #include "../core/filesystem/resource_manager.h"
 #include "../core/i18n.h"
@@ -41,45 +42,35 @@ cCampaign :: ~cCampaign( void )
 
 bool cCampaign :: Save( const std::string &filename )
 {
-// fixme : Check if there is a more portable way f.e. with imbue()
-#ifdef _WIN32
-	ofstream file( utf8_to_ucs2( filename ).c_str(), ios::out | ios::trunc );
-#else
-	ofstream file( filename.c_str(), ios::out | ios::trunc );
-#endif
-
-	
-	if( !file.is_open() )
-	{
-		printf( "Error : Couldn't open campaign file for saving. Is the file read-only ?" );
-		pHud_Debug->Set_Text( _("Couldn't save campaign ") + filename, speedfactor_fps * 5.0f );
-		return 0;
-	}
-
-	CEGUI::XMLSerializer stream( file );
+	cXml_Writer stream;
 
 	// begin
-	stream.openTag( "campaign" );
+	stream.Open_Tag( "campaign" );
 
 	// begin
-	stream.openTag( "information" );
+	stream.Open_Tag( "information" );
 		Write_Property( stream, "name", m_name );
 		Write_Property( stream, "description", m_description );
 		Write_Property( stream, "save_time", static_cast<Uint64>( time( NULL ) ) );
 	// end information
-	stream.closeTag();
+	stream.Close_Tag();
 
 	// begin
-	stream.openTag( "target" );
+	stream.Open_Tag( "target" );
 		Write_Property( stream, "name", m_target );
 		Write_Property( stream, "is_level", m_is_target_level );
 	// end target
-	stream.closeTag();
+	stream.Close_Tag();
 
 	// end campaign
-	stream.closeTag();
+	stream.Close_Tag();
 
-	file.close();
+	if( !stream.Save( filename ) )
+	{
+		printf( "Error : Couldn't open campaign file for saving. Is the file read-only ?" );
+		pHud_Debug->Set_Text( _("Couldn't save campaign ") + filename, speedfactor_fps * 5.0f );
+		return 0;
+	}
 	
 	debug_print( "Saved campaign %s\n", filename.c_str() );
 	
@@ -192,12 +183,7 @@ cCampaign_XML_Handler :: cCampaign_XML_Handler( const CEGUI::String &filename )
 
 	try
 	{
-	// fixme : Workaround for std::string to CEGUI::String utf8 conversion. Check again if CEGUI 0.8 works with std::string utf8
-	#ifdef _WIN32
-		CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, (const CEGUI::utf8*)filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/" "Campaign.xsd", "" );
-	#else
-		CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/" "Campaign.xsd", "" );
-	#endif
+		Parse_XML_File( *this, filename.c_str(), "Campaign.xsd" );
 	}
 	// catch CEGUI Exceptions
 	catch( CEGUI::Exception &ex )
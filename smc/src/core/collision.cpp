@@ -20,23 +20,58 @@
 #include "../level/level_player.h"
 #include "../video/gl_surface.h"
 #include "../core/sprite_manager.h"
+#include "../core/memory_pool.h"
 // for binary_function and bind2nd
 #include <functional>
 
 namespace SMC
 {
 
+/* *** *** *** *** *** *** *** Collision memory *** *** *** *** *** *** *** *** *** *** */
+
+// deleted memory kept for reuse up to this count
+static const unsigned int collision_pool_size = 1000;
+// statistics
+static unsigned int collision_created_count = 0;
+
+static cMemory_Counter collision_memory( "Collisions" );
+static cMemory_Pool collision_pool( "Collision", sizeof( cObjectCollision ), 0, collision_pool_size, &collision_memory );
+static cMemory_Pool collision_list_pool( "Collision List", sizeof( cObjectCollisionType ), 0, collision_pool_size, &collision_memory );
+// object arrays of deleted lists with their capacity
+static vector<cObjectCollision_List> collision_list_arrays;
+
 /* *** *** *** *** *** *** *** cObjectCollisionType *** *** *** *** *** *** *** *** *** *** */
 
 cObjectCollisionType :: cObjectCollisionType( void )
 : cObject_Manager<cObjectCollision>()
 {
-
+	// reuse the array capacity
+	if( !collision_list_arrays.empty() )
+	{
+		objects.swap( collision_list_arrays.back() );
+		collision_list_arrays.pop_back();
+	}
 }
 
 cObjectCollisionType :: ~cObjectCollisionType( void )
 {
 	Delete_All();
+
+	if( collision_list_arrays.size() < collision_pool_size && objects.capacity() )
+	{
+		collision_list_arrays.push_back( cObjectCollision_List() );
+		collision_list_arrays.back().swap( objects );
+	}
+}
+
+void *cObjectCollisionType :: operator new( size_t size )
+{
+	return collision_list_pool.Get( size );
+}
+
+void cObjectCollisionType :: operator delete( void *ptr, size_t size )
+{
+	collision_list_pool.Release( ptr, size );
 }
 
 void cObjectCollisionType :: Add( cObjectCollision *obj )
@@ -128,6 +163,28 @@ cObjectCollision :: ~cObjectCollision( void )
 	//
 }
 
+cSprite *cObjectCollision :: Get_Object( void ) const
+{
+	if( !m_obj || Get_Sprite( m_obj_handle ) != m_obj )
+	{
+		return NULL;
+	}
+
+	return m_obj;
+}
+
+void *cObjectCollision :: operator new( size_t size )
+{
+	collision_created_count++;
+
+	return collision_pool.Get( size );
+}
+
+void cObjectCollision :: operator delete( void *ptr, size_t size )
+{
+	collision_pool.Release( ptr, size );
+}
+
 void cObjectCollision :: Set_Direction( const cSprite *base, const cSprite *col )
 {
 	m_direction = Get_Collision_Direction( base, col );
@@ -309,6 +366,16 @@ bool Col_Circle( cGL_Surface *a, float x1, float y1, cGL_Surface *b, float x2, f
 	return Col_Circle( x1, y1, r1, x2, y2, r2, offset );
 }
 
+unsigned int Get_Collision_Created_Count( void )
+{
+	return collision_created_count;
+}
+
+unsigned int Get_Collision_Allocation_Count( void )
+{
+	return collision_pool.m_misses + collision_list_pool.m_misses;
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 } // namespace SMC
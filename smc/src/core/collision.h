@@ -36,6 +36,10 @@ public:
 	cObjectCollision( void );
 	~cObjectCollision( void );
 
+	// memory is reused from deleted collisions
+	static void *operator new( size_t size );
+	static void operator delete( void *ptr, size_t size );
+
 	/* Set the collision direction
 	 * base - the base sprite
 	 * col - the colliding sprite
@@ -50,8 +54,15 @@ public:
 	*/
 	bool m_received;
 
+	/* Return the object colliding with
+	 * if it was deleted returns NULL
+	*/
+	cSprite *Get_Object( void ) const;
+
 	// the object colliding with (only use it in the same frame for now !)
 	cSprite *m_obj;
+	// handle of the object to check if it was deleted
+	cObject_Handle m_obj_handle;
 	// colliding object number
 	int m_number;
 
@@ -72,6 +83,10 @@ public:
 	cObjectCollisionType( void );
 	virtual ~cObjectCollisionType( void );
 
+	// memory and the list capacity are reused from deleted lists
+	static void *operator new( size_t size );
+	static void operator delete( void *ptr, size_t size );
+
 	// Add an object collision
 	virtual void Add( cObjectCollision *obj );
 
@@ -212,6 +227,11 @@ bool Col_Circle( float x1, float y1, float r1, float x2, float y2, float r2, int
 
 bool Col_Circle( cGL_Surface *a, float x1, float y1, cGL_Surface *b, float x2, float y2, int offset );
 
+// Returns the number of created collisions
+unsigned int Get_Collision_Created_Count( void );
+// Returns the number of collision and collision list memory blocks which were not reused
+unsigned int Get_Collision_Allocation_Count( void );
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 } // namespace SMC
@@ -0,0 +1,75 @@
+/***************************************************************************
+ * collision_workers.cpp  -  gathers collision objects with several threads
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/collision_workers.h"
+#include "../core/task_pool.h"
+#include <boost/bind.hpp>
+
+namespace SMC
+{
+
+// less jobs are gathered by the calling thread only
+static const unsigned int collision_workers_min_jobs = 64;
+// jobs gathered at least by a task
+static const unsigned int collision_workers_chunk_size = 16;
+
+/* *** *** *** *** *** *** *** cCollision_Workers *** *** *** *** *** *** *** *** *** *** */
+
+cCollision_Workers :: cCollision_Workers( void )
+{
+	//
+}
+
+cCollision_Workers :: ~cCollision_Workers( void )
+{
+	//
+}
+
+void cCollision_Workers :: Gather( const cSprite_Grid *grid, Job *jobs, unsigned int count )
+{
+	if( !count )
+	{
+		return;
+	}
+
+	// not worth waking up the workers
+	if( count < collision_workers_min_jobs )
+	{
+		Run_Jobs( grid, jobs, 0, count );
+		return;
+	}
+
+	pTask_Pool->Run_Parallel( boost::bind( &cCollision_Workers::Run_Jobs, grid, jobs, _1, _2 ), count, collision_workers_chunk_size, "collision gather" );
+}
+
+void cCollision_Workers :: Run_Jobs( const cSprite_Grid *grid, Job *jobs, unsigned int start, unsigned int end )
+{
+	// the jobs are only used by this thread until they are done
+	for( unsigned int i = start; i < end; i++ )
+	{
+		Job &job = jobs[i];
+
+		job.m_objects.clear();
+		grid->Get_Static_Objects( job.m_objects, job.m_rect, job.m_layer_mask );
+	}
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+cCollision_Workers *pCollision_Workers = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
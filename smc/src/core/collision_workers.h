@@ -0,0 +1,59 @@
+/***************************************************************************
+ * collision_workers.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_COLLISION_WORKERS_H
+#define SMC_COLLISION_WORKERS_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../core/sprite_grid.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cCollision_Workers *** *** *** *** *** *** *** *** *** *** */
+
+/* Gathers the static collision grid objects for many rects with the task pool
+ * the gathering only reads the grid and each job only writes its own object list
+*/
+class cCollision_Workers
+{
+public:
+	cCollision_Workers( void );
+	~cCollision_Workers( void );
+
+	typedef cSprite_Grid::Static_Gather Job;
+
+	/* Gather the static objects of the grid for the jobs
+	 * the grid static sprites must be updated before
+	 * uses the task pool if there are enough jobs and returns when all are done
+	*/
+	void Gather( const cSprite_Grid *grid, Job *jobs, unsigned int count );
+
+private:
+	// Gather the jobs from start to end
+	static void Run_Jobs( const cSprite_Grid *grid, Job *jobs, unsigned int start, unsigned int end );
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+// Collision Workers
+extern cCollision_Workers *pCollision_Workers;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -15,6 +15,7 @@
 
 #include "../core/editor.h"
 #include "../core/game_core.h"
+#include "../core/xml_reader.h"
 #include "../gui/generic.h"
 #include "../core/framerate.h"
 #include "../audio/audio.h"
@@ -32,6 +33,8 @@
 #include "../overworld/overworld.h"
 #include "../core/i18n.h"
 #include "../core/filesystem/filesystem.h"
+#include "../core/editor_catalogue.h"
+#include "../core/editor_history.h"
 // CEGUI
 #include "CEGUIXMLParser.h"
 #include "CEGUIWindowManager.h"
@@ -44,6 +47,25 @@
 namespace SMC
 {
 
+// Returns the massive type a sprite gets from the given type
+static MassiveType Get_Editor_Item_Massive_Type( int type )
+{
+	if( type == TYPE_MASSIVE )
+	{
+		return MASS_MASSIVE;
+	}
+	else if( type == TYPE_HALFMASSIVE )
+	{
+		return MASS_HALFMASSIVE;
+	}
+	else if( type == TYPE_CLIMBABLE )
+	{
+		return MASS_CLIMBABLE;
+	}
+
+	return MASS_PASSIVE;
+}
+
 /* *** *** *** *** *** *** *** cEditor_Object_Settings_Item *** *** *** *** *** *** *** *** *** *** */
 
 cEditor_Object_Settings_Item :: cEditor_Object_Settings_Item( void )
@@ -91,6 +113,9 @@ void cEditor_CEGUI_Texture :: cleanupOpenGLTexture( void )
 
 /* *** *** *** *** *** *** *** *** cEditor_Item_Object *** *** *** *** *** *** *** *** *** */
 
+// number of linked sprite preview images for unique imageset names
+static unsigned int editor_item_image_count = 0;
+
 cEditor_Item_Object :: cEditor_Item_Object( const std::string &text, const CEGUI::Listbox *parent )
 : CEGUI::ListboxItem( "" )
 {
@@ -101,14 +126,22 @@ cEditor_Item_Object :: cEditor_Item_Object( const std::string &text, const CEGUI
 
 	m_image = NULL;
 	sprite_obj = NULL;
+	m_catalogue_item = NULL;
+	m_preview_width = 0;
+	m_preview_height = 0;
 	preview_scale = 1;
+
+	m_editor = NULL;
+	m_image_created = 0;
+	m_pixel_size_valid = 0;
 }
 
 cEditor_Item_Object :: ~cEditor_Item_Object( void )
 {
 	delete list_text;
 
-	if( m_image )
+	// thumbnail pages are deleted by the editor
+	if( m_image && !m_catalogue_item )
 	{
 		delete m_image->getTexture();
 		CEGUI::ImagesetManager::getSingleton().destroy( *m_image );
@@ -123,9 +156,9 @@ cEditor_Item_Object :: ~cEditor_Item_Object( void )
 
 void cEditor_Item_Object :: Init( cSprite *sprite )
 {
-	if( m_image )
+	if( sprite_obj || m_catalogue_item )
 	{
-		printf( "cEditor_Item_Object::Init: Warning: Image is already set\n" );
+		printf( "cEditor_Item_Object::Init: Warning: Item is already set\n" );
 		return;
 	}
 
@@ -136,45 +169,132 @@ void cEditor_Item_Object :: Init( cSprite *sprite )
 
 	// CEGUI settings
 	list_text->setTextColours( Get_Massive_Type_Color( sprite_obj->m_massive_type ).Get_cegui_Color() );
+}
 
-	if( !sprite_obj->m_start_image || !pPreferences->m_editor_show_item_images )
+void cEditor_Item_Object :: Init( const cEditor_Catalogue_Item *item, cEditor *editor )
+{
+	if( sprite_obj || m_catalogue_item )
 	{
+		printf( "cEditor_Item_Object::Init: Warning: Item is already set\n" );
 		return;
 	}
 
-	// get scale
-	preview_scale = pVideo->Get_Scale( sprite_obj->m_start_image, static_cast<float>(pPreferences->m_editor_item_image_size) * 2.0f, static_cast<float>(pPreferences->m_editor_item_image_size) );
+	m_catalogue_item = item;
+	m_editor = editor;
 
-	// create CEGUI link
-	cEditor_CEGUI_Texture *texture = new cEditor_CEGUI_Texture( *pGuiRenderer, sprite_obj->m_start_image->m_image, CEGUI::Size( sprite_obj->m_start_image->m_tex_w, sprite_obj->m_start_image->m_tex_h ) );
-	CEGUI::String imageset_name = "editor_item " + list_text->getText() + " " + CEGUI::PropertyHelper::uintToString( m_parent->getItemCount() );
-	m_image = &CEGUI::ImagesetManager::getSingleton().create( imageset_name, *texture );
-	m_image->defineImage( "default", CEGUI::Point(0, 0), texture->getSize(), CEGUI::Point(0, 0) );
+	// CEGUI settings
+	list_text->setTextColours( Get_Massive_Type_Color( Get_Editor_Item_Massive_Type( item->m_type ) ).Get_cegui_Color() );
 }
 
 CEGUI::Size cEditor_Item_Object :: getPixelSize( void ) const
 {
-	CEGUI::Size tmp = list_text->getPixelSize();
-
-	if( pPreferences->m_editor_show_item_images )
+	if( !m_pixel_size_valid )
 	{
-		tmp.d_height += (pPreferences->m_editor_item_image_size + 10) * global_upscaley;
+		m_pixel_size = list_text->getPixelSize();
+
+		if( pPreferences->m_editor_show_item_images )
+		{
+			m_pixel_size.d_height += (pPreferences->m_editor_item_image_size + 10) * global_upscaley;
+		}
+
+		m_pixel_size_valid = 1;
 	}
 
-	return tmp;
+	return m_pixel_size;
 }
 
 void cEditor_Item_Object :: draw( CEGUI::GeometryBuffer &buffer, const CEGUI::Rect &targetRect, float alpha, const CEGUI::Rect *clipper ) const
 {
 	// image
-	if( m_image && pPreferences->m_editor_show_item_images )
+	if( pPreferences->m_editor_show_item_images )
 	{
-		m_image->draw( buffer, CEGUI::Rect(CEGUI::Point(0, 0), m_image->getTexture()->getSize()), CEGUI::Rect(targetRect.d_left + 15, targetRect.d_top + 22, targetRect.d_left + 15 + (sprite_obj->m_start_image->m_start_w * preview_scale * global_upscalex), targetRect.d_top + 22 + (sprite_obj->m_start_image->m_start_h * preview_scale * global_upscaley) ), clipper, CEGUI::ColourRect(CEGUI::colour(1.0f, 1.0f, 1.0f, alpha)), CEGUI::TopLeftToBottomRight );
+		Create_Image();
+
+		if( m_image )
+		{
+			m_image->draw( buffer, m_image_rect, CEGUI::Rect(targetRect.d_left + 15, targetRect.d_top + 22, targetRect.d_left + 15 + (m_preview_width * preview_scale * global_upscalex), targetRect.d_top + 22 + (m_preview_height * preview_scale * global_upscaley) ), clipper, CEGUI::ColourRect(CEGUI::colour(1.0f, 1.0f, 1.0f, alpha)), CEGUI::TopLeftToBottomRight );
+		}
 	}
 	// name text
 	list_text->draw( buffer, targetRect, alpha, clipper );
 }
 
+void cEditor_Item_Object :: Create_Image( void ) const
+{
+	if( m_image_created )
+	{
+		return;
+	}
+
+	m_image_created = 1;
+
+	// catalogue image item
+	if( m_catalogue_item )
+	{
+		unsigned int page_num;
+		GL_rect thumbnail_rect;
+
+		if( !m_editor || !pEditor_Catalogue->Get_Thumbnail( m_catalogue_item, page_num, thumbnail_rect ) )
+		{
+			return;
+		}
+
+		CEGUI::Imageset *page = m_editor->Get_Item_Page( page_num );
+
+		if( !page )
+		{
+			return;
+		}
+
+		m_image = page;
+		m_preview_width = static_cast<float>(m_catalogue_item->m_width);
+		m_preview_height = static_cast<float>(m_catalogue_item->m_height);
+
+		// get scale
+		const float width = static_cast<float>(pPreferences->m_editor_item_image_size) * 2.0f;
+		const float height = static_cast<float>(pPreferences->m_editor_item_image_size);
+
+		if( m_preview_width > width || m_preview_height > height )
+		{
+			preview_scale = std::min( width / m_preview_width, height / m_preview_height );
+		}
+
+		// thumbnail area in the page texture
+		const CEGUI::Size &texture_size = page->getTexture()->getSize();
+		const float page_size = static_cast<float>(pEditor_Catalogue->Get_Page_Size());
+		m_image_rect = CEGUI::Rect( thumbnail_rect.m_x / page_size * texture_size.d_width, thumbnail_rect.m_y / page_size * texture_size.d_height, ( thumbnail_rect.m_x + thumbnail_rect.m_w ) / page_size * texture_size.d_width, ( thumbnail_rect.m_y + thumbnail_rect.m_h ) / page_size * texture_size.d_height );
+		return;
+	}
+
+	if( !sprite_obj || !sprite_obj->m_start_image )
+	{
+		return;
+	}
+
+	// get scale
+	preview_scale = pVideo->Get_Scale( sprite_obj->m_start_image, static_cast<float>(pPreferences->m_editor_item_image_size) * 2.0f, static_cast<float>(pPreferences->m_editor_item_image_size) );
+
+	const cGL_Surface *start_image = sprite_obj->m_start_image;
+	m_preview_width = start_image->m_start_w;
+	m_preview_height = start_image->m_start_h;
+	// atlas images use the page texture
+	CEGUI::Size texture_size( start_image->m_tex_w, start_image->m_tex_h );
+
+	if( start_image->Is_In_Atlas() )
+	{
+		texture_size = CEGUI::Size( start_image->m_atlas_size, start_image->m_atlas_size );
+	}
+
+	// create CEGUI link
+	cEditor_CEGUI_Texture *texture = new cEditor_CEGUI_Texture( *pGuiRenderer, start_image->m_image, texture_size );
+	CEGUI::String imageset_name = "editor_item " + list_text->getText() + " " + CEGUI::PropertyHelper::uintToString( editor_item_image_count );
+	editor_item_image_count++;
+	m_image = &CEGUI::ImagesetManager::getSingleton().create( imageset_name, *texture );
+	m_image->defineImage( "default", CEGUI::Point(0, 0), texture->getSize(), CEGUI::Point(0, 0) );
+	// image area in the texture
+	m_image_rect = CEGUI::Rect( start_image->m_tex_x1 * texture_size.d_width, start_image->m_tex_y1 * texture_size.d_height, start_image->m_tex_x2 * texture_size.d_width, start_image->m_tex_y2 * texture_size.d_height );
+}
+
 /* *** *** *** *** *** *** *** *** cEditor_Menu_Object *** *** *** *** *** *** *** *** *** */
 
 cEditor_Menu_Object :: cEditor_Menu_Object( const std::string &text )
@@ -253,7 +373,7 @@ void cEditor :: Init( void )
 		return;
 	}
 	// Parse Items
-	CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, m_items_filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/Editor_Items.xsd", "" );
+	Parse_XML_File( *this, m_items_filename, "Editor_Items.xsd" );
 
 	// Get all image items
 	Load_Image_Items( DATA_DIR "/" GAME_PIXMAPS_DIR );
@@ -265,7 +385,7 @@ void cEditor :: Init( void )
 		return;
 	}
 	// Parse Menu
-	CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, m_menu_filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/Editor_Menu.xsd", "" );
+	Parse_XML_File( *this, m_menu_filename, "Editor_Menu.xsd" );
 }
 
 void cEditor :: Unload( void )
@@ -298,13 +418,7 @@ void cEditor :: Unload( void )
 
 	m_tagged_item_objects.clear();
 
-	// Tagged Image Settings
-	for( TaggedItemImageSettingsList::iterator itr = m_tagged_item_images.begin(); itr != m_tagged_item_images.end(); ++itr )
-	{
-		delete *itr;
-	}
-
-	m_tagged_item_images.clear();
+	Delete_Item_Pages();
 }
 
 void cEditor :: Toggle( void )
@@ -638,6 +752,22 @@ bool cEditor :: Key_Down( SDLKey key )
 	{
 		Function_Save_as();
 	}
+	// Redo
+	else if( ( key == SDLK_y || key == SDLK_z ) && pKeyboard->Is_Ctrl_Down() && ( key == SDLK_y || pKeyboard->Is_Shift_Down() ) )
+	{
+		if( !pMouseCursor->m_history->Redo( this ) )
+		{
+			pHud_Debug->Set_Text( _("Nothing to redo") );
+		}
+	}
+	// Undo
+	else if( key == SDLK_z && pKeyboard->Is_Ctrl_Down() )
+	{
+		if( !pMouseCursor->m_history->Undo( this ) )
+		{
+			pHud_Debug->Set_Text( _("Nothing to undo") );
+		}
+	}
 	// help
 	else if( key == SDLK_F1 )
 	{
@@ -678,6 +808,8 @@ bool cEditor :: Key_Down( SDLKey key )
 				"Ctrl + W - Load an Overworld\n"
 				"Ctrl + S - Save the current Level/World\n"
 				"Ctrl + Shift + S - Save the current Level/World under a new name\n"
+				"Ctrl + Z - Undo the last object change\n"
+				"Ctrl + Y or Ctrl + Shift + Z - Redo the last undone object change\n"
 				"Ctrl + D - Toggle debug mode\n"
 				"Ctrl + P - Toggle performance mode\n"
 				" \n"
@@ -740,6 +872,8 @@ bool cEditor :: Key_Down( SDLKey key )
 	// push selected objects into the front
 	else if( key == SDLK_KP_PLUS )
 	{
+		pMouseCursor->m_history->Begin_Step();
+
 		for( SelectedObjectList::iterator itr = pMouseCursor->m_selected_objects.begin(); itr != pMouseCursor->m_selected_objects.end(); ++itr )
 		{
 			cSelectedObject *sel_obj = (*itr);
@@ -750,12 +884,17 @@ bool cEditor :: Key_Down( SDLKey key )
 			}
 
 			// last object is in front of others
+			pMouseCursor->m_history->Add_Z_Change( sel_obj->m_obj, 0 );
 			m_sprite_manager->Move_To_Back( sel_obj->m_obj );
 		}
+
+		pMouseCursor->m_history->End_Step();
 	}
 	// push selected objects into the back
 	else if( key == SDLK_KP_MINUS )
 	{
+		pMouseCursor->m_history->Begin_Step();
+
 		for( SelectedObjectList::iterator itr = pMouseCursor->m_selected_objects.begin(); itr != pMouseCursor->m_selected_objects.end(); ++itr )
 		{
 			cSelectedObject *sel_obj = (*itr);
@@ -766,8 +905,11 @@ bool cEditor :: Key_Down( SDLKey key )
 			}
 
 			// first object is behind others
+			pMouseCursor->m_history->Add_Z_Change( sel_obj->m_obj, 1 );
 			m_sprite_manager->Move_To_Front( sel_obj->m_obj );
 		}
+
+		pMouseCursor->m_history->End_Step();
 	}
 	// copy into direction
 	else if( ( key == pPreferences->m_key_editor_fast_copy_up || key == pPreferences->m_key_editor_fast_copy_down || key == pPreferences->m_key_editor_fast_copy_left || key == pPreferences->m_key_editor_fast_copy_right ) && pMouseCursor->m_hovering_object->m_obj && pMouseCursor->m_fastcopy_mode )
@@ -796,13 +938,18 @@ bool cEditor :: Key_Down( SDLKey key )
 		// copy objects
 		cSprite_List new_objects = Copy_Direction( objects, dir );
 
+		pMouseCursor->m_history->Begin_Step();
+
 		// add new objects
 		for( cSprite_List::iterator itr = new_objects.begin(); itr != new_objects.end(); ++itr )
 		{
 			cSprite *obj = (*itr);
 
+			pMouseCursor->m_history->Add_Create( obj );
 			pMouseCursor->Add_Selected_Object( obj, 1 );
 		}
+
+		pMouseCursor->m_history->End_Step();
 		
 		// deselect old objects
 		for( cSprite_List::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
@@ -1138,35 +1285,25 @@ bool cEditor :: Load_Item_Menu( std::string item_tags )
 	}
 
 	unsigned int tag_pos = 0;
+	// images with the required editor tag
+	Editor_Catalogue_Item_List tagged_item_images;
+	pEditor_Catalogue->Get_Items( m_editor_item_tag, tagged_item_images );
 
 	// Get all Images with the Tags
-	for( TaggedItemImageSettingsList::const_iterator itr = m_tagged_item_images.begin(); itr != m_tagged_item_images.end(); ++itr )
+	for( Editor_Catalogue_Item_List::const_iterator itr = tagged_item_images.begin(); itr != tagged_item_images.end(); ++itr )
 	{
-		const cImage_Settings_Data *settings = (*itr);
+		const cEditor_Catalogue_Item *item = (*itr);
 
 		// search
-		while( Is_Tag_Available( settings->m_editor_tags, array_tags[tag_pos] ) )
+		while( Is_Tag_Available( item->m_editor_tags, array_tags[tag_pos] ) )
 		{
 			tag_pos++;
 
 			// found all tags
 			if( tag_pos >= array_tags.size() )
 			{
-				cGL_Surface *image = pVideo->Get_Surface( settings->m_base );
-
-				if( !image )
-				{
-					printf( "Warning : Could not load editor sprite image base : %s\n", settings->m_base.c_str() );
-					break;
-				}
-				
-				// Create sprite
-				cSprite *new_sprite = new cSprite( m_sprite_manager );
-				new_sprite->Set_Image( image );
-				// default massivetype
-				new_sprite->Set_Sprite_Type( static_cast<SpriteType>(image->m_type) );
-				// Add new Sprite
-				Add_Item_Object( new_sprite );
+				// the sprite is created when placed
+				Add_Image_Item( item );
 
 				break;
 			}
@@ -1214,6 +1351,9 @@ void cEditor :: Unload_Item_Menu( void )
 	{
 		m_listbox_items->resetList();
 	}
+
+	// not used by any item
+	Delete_Item_Pages();
 }
 
 
@@ -1226,47 +1366,7 @@ void cEditor :: Add_Item_Object( cSprite *sprite, std::string new_name /* = "" *
 		return;
 	}
 
-	// set correct array if not given
-	if( sprite->m_sprite_array == ARRAY_UNDEFINED )
-	{
-		printf( "Warning : Editor sprite %s array not set\n", sprite->m_name.c_str() );
-
-		if( sprite->m_massive_type == MASS_PASSIVE )
-		{
-			sprite->m_sprite_array = ARRAY_PASSIVE;
-		}
-		else if( sprite->m_massive_type == MASS_MASSIVE )
-		{
-			sprite->m_sprite_array = ARRAY_MASSIVE;
-		}
-		else if( sprite->m_massive_type == MASS_HALFMASSIVE )
-		{
-			sprite->m_sprite_array = ARRAY_ACTIVE;
-		}
-	}
-
-	// set correct type if not given
-	if( sprite->m_type == TYPE_UNDEFINED )
-	{
-		printf( "Warning : Editor sprite %s type not set\n", sprite->m_name.c_str() );
-
-		if( sprite->m_massive_type == MASS_PASSIVE )
-		{
-			sprite->m_type = TYPE_PASSIVE;
-		}
-		else if( sprite->m_massive_type == MASS_MASSIVE )
-		{
-			sprite->m_type = TYPE_MASSIVE;
-		}
-		else if( sprite->m_massive_type == MASS_HALFMASSIVE )
-		{
-			sprite->m_type = TYPE_HALFMASSIVE;
-		}
-		else if( sprite->m_massive_type == MASS_CLIMBABLE )
-		{
-			sprite->m_type = TYPE_CLIMBABLE;
-		}
-	}
+	Set_Item_Object_Defaults( sprite );
 
 	// if no image is given use the sprite start image
 	if( !image )
@@ -1312,32 +1412,32 @@ void cEditor :: Add_Item_Object( cSprite *sprite, std::string new_name /* = "" *
 	m_listbox_items->addItem( new_item );
 }
 
-void cEditor :: Load_Image_Items( std::string dir )
+void cEditor :: Add_Image_Item( const cEditor_Catalogue_Item *item )
 {
-	vector<std::string> image_files = Get_Directory_Files( dir, ".settings" );
+	std::string obj_name = item->m_name;
 
-	// load all available objects
-	for( vector<std::string>::const_iterator itr = image_files.begin(); itr != image_files.end(); ++itr )
+	// no object name available
+	if( obj_name.empty() )
 	{
-		// get filename
-		std::string filename = (*itr);
+		obj_name = Trim_Filename( item->m_filename, 0, 0 );
 
-		// load settings
-		cImage_Settings_Data *settings = pSettingsParser->Get( filename );
-
-		// if settings are available
-		if( settings )
-		{
-			// if required editor tag is available
-			if( settings->m_editor_tags.find( m_editor_item_tag ) != std::string::npos )
-			{
-				// set base to the filename
-				settings->m_base = filename;
-				// add real image
-				m_tagged_item_images.push_back( settings );
-			}
-		}
+		// Warn if using filename
+		printf( "Warning : editor object %s with no name given\n", obj_name.c_str() );
 	}
+
+	cEditor_Item_Object *new_item = new cEditor_Item_Object( obj_name, m_listbox_items );
+	// Initialize
+	new_item->Init( item, this );
+
+	// Add Item
+	m_listbox_items->addItem( new_item );
+}
+
+void cEditor :: Load_Image_Items( std::string dir )
+{
+	// only new or changed settings files are read
+	pEditor_Catalogue->Update( dir );
+	pEditor_Catalogue->Save_Index();
 }
 
 void cEditor :: Activate_Item( cEditor_Item_Object *entry )
@@ -1349,6 +1449,17 @@ void cEditor :: Activate_Item( cEditor_Item_Object *entry )
 		return;
 	}
 
+	// create the catalogue image item sprite with the first use
+	if( !entry->sprite_obj && entry->m_catalogue_item )
+	{
+		entry->sprite_obj = Create_Image_Item_Sprite( entry->m_catalogue_item );
+
+		if( !entry->sprite_obj )
+		{
+			return;
+		}
+	}
+
 	// create copy from editor item
 	cSprite *new_sprite = entry->sprite_obj->Copy();
 
@@ -1370,6 +1481,7 @@ void cEditor :: Activate_Item( cEditor_Item_Object *entry )
 
 	// add item
 	m_sprite_manager->Add( new_sprite );
+	pMouseCursor->m_history->Add_Create( new_sprite );
 
 	// Set mouse objects
 	pMouseCursor->m_left = 1;
@@ -1378,6 +1490,124 @@ void cEditor :: Activate_Item( cEditor_Item_Object *entry )
 	pMouseCursor->Set_Hovered_Object( new_sprite );
 }
 
+void cEditor :: Set_Item_Object_Defaults( cSprite *sprite ) const
+{
+	// set correct array if not given
+	if( sprite->m_sprite_array == ARRAY_UNDEFINED )
+	{
+		printf( "Warning : Editor sprite %s array not set\n", sprite->m_name.c_str() );
+
+		if( sprite->m_massive_type == MASS_PASSIVE )
+		{
+			sprite->m_sprite_array = ARRAY_PASSIVE;
+		}
+		else if( sprite->m_massive_type == MASS_MASSIVE )
+		{
+			sprite->m_sprite_array = ARRAY_MASSIVE;
+		}
+		else if( sprite->m_massive_type == MASS_HALFMASSIVE )
+		{
+			sprite->m_sprite_array = ARRAY_ACTIVE;
+		}
+	}
+
+	// set correct type if not given
+	if( sprite->m_type == TYPE_UNDEFINED )
+	{
+		printf( "Warning : Editor sprite %s type not set\n", sprite->m_name.c_str() );
+
+		if( sprite->m_massive_type == MASS_PASSIVE )
+		{
+			sprite->m_type = TYPE_PASSIVE;
+		}
+		else if( sprite->m_massive_type == MASS_MASSIVE )
+		{
+			sprite->m_type = TYPE_MASSIVE;
+		}
+		else if( sprite->m_massive_type == MASS_HALFMASSIVE )
+		{
+			sprite->m_type = TYPE_HALFMASSIVE;
+		}
+		else if( sprite->m_massive_type == MASS_CLIMBABLE )
+		{
+			sprite->m_type = TYPE_CLIMBABLE;
+		}
+	}
+}
+
+cSprite *cEditor :: Create_Image_Item_Sprite( const cEditor_Catalogue_Item *item ) const
+{
+	cGL_Surface *image = pVideo->Get_Surface( item->m_filename );
+
+	if( !image )
+	{
+		printf( "Warning : Could not load editor sprite image base : %s\n", item->m_filename.c_str() );
+		return NULL;
+	}
+
+	// Create sprite
+	cSprite *new_sprite = new cSprite( m_sprite_manager );
+	new_sprite->Set_Image( image );
+	// default massivetype
+	new_sprite->Set_Sprite_Type( static_cast<SpriteType>(image->m_type) );
+	Set_Item_Object_Defaults( new_sprite );
+
+	return new_sprite;
+}
+
+CEGUI::Imageset *cEditor :: Get_Item_Page( unsigned int page )
+{
+	if( page >= m_item_pages.size() )
+	{
+		m_item_pages.resize( page + 1, NULL );
+		m_item_page_images.resize( page + 1, NULL );
+	}
+
+	// already created
+	if( m_item_pages[page] )
+	{
+		return m_item_pages[page];
+	}
+
+	cGL_Surface *image = pVideo->Create_Texture( pEditor_Catalogue->Create_Page_Surface( page ) );
+
+	if( !image )
+	{
+		return NULL;
+	}
+
+	// create CEGUI link
+	cEditor_CEGUI_Texture *texture = new cEditor_CEGUI_Texture( *pGuiRenderer, image->m_image, CEGUI::Size( static_cast<float>(image->m_tex_w), static_cast<float>(image->m_tex_h) ) );
+	CEGUI::String imageset_name = "editor_item_page " + m_editor_item_tag + " " + CEGUI::PropertyHelper::uintToString( page );
+	CEGUI::Imageset *imageset = &CEGUI::ImagesetManager::getSingleton().create( imageset_name, *texture );
+	imageset->defineImage( "default", CEGUI::Point( 0, 0 ), texture->getSize(), CEGUI::Point( 0, 0 ) );
+
+	m_item_pages[page] = imageset;
+	m_item_page_images[page] = image;
+
+	return imageset;
+}
+
+void cEditor :: Delete_Item_Pages( void )
+{
+	for( unsigned int i = 0; i < m_item_pages.size(); i++ )
+	{
+		if( m_item_pages[i] )
+		{
+			delete m_item_pages[i]->getTexture();
+			CEGUI::ImagesetManager::getSingleton().destroy( *m_item_pages[i] );
+		}
+
+		if( m_item_page_images[i] )
+		{
+			delete m_item_page_images[i];
+		}
+	}
+
+	m_item_pages.clear();
+	m_item_page_images.clear();
+}
+
 cSprite *cEditor :: Get_Object( const CEGUI::String &element, CEGUI::XMLAttributes &attributes, int engine_version )
 {
 	// virtual
@@ -20,6 +20,7 @@
 #include "../objects/sprite.h"
 #include "../gui/hud.h"
 #include "../video/img_settings.h"
+#include "../core/editor_catalogue.h"
 // CEGUI
 #include "CEGUIXMLHandler.h"
 #include "CEGUIXMLAttributes.h"
@@ -61,6 +62,11 @@ public:
 
 /* *** *** *** *** *** *** *** *** cEditor_Item_Object *** *** *** *** *** *** *** *** *** */
 
+/* Entry of the item list
+ * the listbox only draws the visible entries
+ * so the preview image is linked when the entry is drawn the first time
+ * and the size is measured once as the listbox asks all entries for it whenever the list changes
+*/
 class cEditor_Item_Object : public CEGUI::ListboxItem
 {
 public:
@@ -69,6 +75,11 @@ public:
 
 	// Initialize
 	void Init( cSprite *sprite );
+	/* Initialize from a catalogue image item
+	 * the sprite is created when it is placed
+	 * editor : creates the thumbnail page when the entry gets visible
+	*/
+	void Init( const cEditor_Catalogue_Item *item, cEditor *editor );
 
 	// overridden from base class
 	virtual	CEGUI::Size getPixelSize( void ) const;
@@ -79,12 +90,31 @@ public:
 	const CEGUI::Listbox *m_parent;
 	// text
 	CEGUI::ListboxTextItem *list_text;
-	// cegui image
-	CEGUI::Imageset *m_image;
-	// sprite
+	// cegui image which is a shared thumbnail page if a catalogue item
+	mutable CEGUI::Imageset *m_image;
+	// image area in the imageset texture
+	mutable CEGUI::Rect m_image_rect;
+	// sprite or NULL if the catalogue item was not yet placed
 	cSprite *sprite_obj;
+	// catalogue image item or NULL
+	const cEditor_Catalogue_Item *m_catalogue_item;
+	// preview image size
+	mutable float m_preview_width;
+	mutable float m_preview_height;
 	// preview image scale
-	float preview_scale;
+	mutable float preview_scale;
+
+private:
+	// Link the preview image if not done yet
+	void Create_Image( void ) const;
+
+	// editor with the thumbnail pages of the catalogue item
+	cEditor *m_editor;
+	// if the preview image was linked
+	mutable bool m_image_created;
+	// measured size
+	mutable CEGUI::Size m_pixel_size;
+	mutable bool m_pixel_size_valid;
 };
 
 /* *** *** *** *** *** *** *** *** cEditor_Menu_Object *** *** *** *** *** *** *** *** *** */
@@ -174,10 +204,17 @@ public:
 	 * if image is set the default object image is not used
 	 */
 	void Add_Item_Object( cSprite *sprite, std::string new_name = "", cGL_Surface *image = NULL );
-	// Loads all Image Items
+	// Add a catalogue image item to the Item list
+	void Add_Image_Item( const cEditor_Catalogue_Item *item );
+	// Update the catalogue of all Image Items
 	void Load_Image_Items( std::string dir );
 	// Active Item Entry
 	virtual void Activate_Item( cEditor_Item_Object *entry );
+	/* Returns the imageset of the catalogue thumbnail page
+	 * the page texture is created with the first use
+	 * returns NULL if not available
+	*/
+	CEGUI::Imageset *Get_Item_Page( unsigned int page );
 	// return the sprite object
 	virtual cSprite *Get_Object( const CEGUI::String &element, CEGUI::XMLAttributes &attributes, int engine_version );
 
@@ -210,6 +247,28 @@ public:
 	virtual void Function_Reload( void ) {};
 	virtual void Function_Settings( void ) {};
 
+	// Autosave functions
+	/* Returns the autosave journal filename of the loaded level or world
+	 * returns an empty string if it can not be autosaved
+	*/
+	virtual std::string Get_Autosave_Filename( void ) const { return ""; };
+	/* Returns the full filename of the saved level or world
+	 * returns an empty string if it was not saved yet
+	*/
+	virtual std::string Get_Autosave_Base_Filename( void ) const { return ""; };
+	// Save the level or world without asking
+	virtual void Autosave_Save( void ) {};
+	// Returns true if the level or world is still written
+	virtual bool Is_Autosave_Saving( void ) const { return 0; };
+	/* Load the saved level or world again
+	 * returns true on success
+	*/
+	virtual bool Autosave_Reload( void ) { return 0; };
+	// Returns the serialized player start settings saved with the objects
+	virtual std::string Get_Autosave_Player_Data( void ) const { return ""; };
+	// Set the player start settings from the serialized data
+	virtual void Set_Autosave_Player_Data( const std::string &data ) {};
+
 	// the parent sprite manager
 	cSprite_Manager *m_sprite_manager;
 	// true if editor is active
@@ -228,8 +287,6 @@ public:
 	float m_menu_timer;
 
 	// Objects with tags
-	typedef vector<cImage_Settings_Data *> TaggedItemImageSettingsList;
-	TaggedItemImageSettingsList m_tagged_item_images;
 	typedef vector<cSprite *> TaggedItemObjectsList;
 	TaggedItemObjectsList m_tagged_item_objects;
 
@@ -247,6 +304,17 @@ protected:
 	bool Window_Help_Exit_Clicked( const CEGUI::EventArgs &event );
 
 private:
+	// Set the array and type from the massive type if not given
+	void Set_Item_Object_Defaults( cSprite *sprite ) const;
+	// Create the sprite of a catalogue image item
+	cSprite *Create_Image_Item_Sprite( const cEditor_Catalogue_Item *item ) const;
+	// Delete the thumbnail page imagesets and textures
+	void Delete_Item_Pages( void );
+
+	// thumbnail page imagesets and images of the item list indexed by the page
+	vector<CEGUI::Imageset *> m_item_pages;
+	vector<cGL_Surface *> m_item_page_images;
+
 	// XML element start
 	virtual void elementStart( const CEGUI::String &element, const CEGUI::XMLAttributes &attributes );
 	// XML element end
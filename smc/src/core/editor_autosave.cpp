@@ -0,0 +1,562 @@
+/***************************************************************************
+ * editor_autosave.cpp  -  incremental background autosave of the editor
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/editor_autosave.h"
+#include "../core/editor.h"
+#include "../core/editor_history.h"
+#include "../core/game_core.h"
+#include "../core/i18n.h"
+#include "../core/property_helper.h"
+#include "../core/sprite_manager.h"
+#include "../core/filesystem/filesystem.h"
+#include "../core/task_pool.h"
+#include "../level/level_editor.h"
+#include "../overworld/world_editor.h"
+#include "../input/mouse.h"
+#include "../gui/generic.h"
+#include "../gui/hud.h"
+#include "../user/preferences.h"
+#include "../objects/sprite.h"
+// SDL
+#include "SDL.h"
+// boost
+#include <boost/bind.hpp>
+#include <cstdio>
+
+namespace SMC
+{
+
+// journal file identification "SMCJ" and format version
+static const Uint32 editor_autosave_magic = 0x4A434D53;
+static const Uint32 editor_autosave_version = 1;
+// milliseconds between the journal writes
+static const Uint32 editor_autosave_write_interval = 5000;
+// milliseconds without changes until the full level or world is saved
+static const Uint32 editor_autosave_idle_time = 30000;
+
+static inline Uint64 Get_Handle_Key( const cObject_Handle &handle )
+{
+	return ( static_cast<Uint64>(handle.m_slot) << 32 ) | handle.m_generation;
+}
+
+// Returns true if the object is saved with the level or world
+static inline bool Is_Saved_Object( const cSprite *sprite )
+{
+	return !sprite->m_spawned && !sprite->m_auto_destroy;
+}
+
+/* *** *** *** *** *** *** cEditor_Autosave *** *** *** *** *** *** *** *** *** *** *** */
+
+cEditor_Autosave :: cEditor_Autosave( void )
+{
+	m_editor = NULL;
+	m_base_size = 0;
+	m_base_time = 0;
+	m_base_count = 0;
+	m_base_missing = 1;
+	m_compacting = 0;
+	m_journal_used = 0;
+	m_next_number = 0;
+	m_write_time = 0;
+	m_change_time = 0;
+	m_append = 0;
+	m_task_finished = 1;
+	m_task_group = pTask_Pool->Create_Group();
+}
+
+cEditor_Autosave :: ~cEditor_Autosave( void )
+{
+	// never lose a journal write
+	Wait();
+}
+
+void cEditor_Autosave :: Update( void )
+{
+	cEditor *editor = NULL;
+
+	if( pPreferences->m_editor_autosave )
+	{
+		if( editor_level_enabled && pLevel_Editor->m_enabled )
+		{
+			editor = pLevel_Editor;
+		}
+		else if( editor_world_enabled && pWorld_Editor->m_enabled )
+		{
+			editor = pWorld_Editor;
+		}
+	}
+
+	std::string filename;
+
+	if( editor )
+	{
+		filename = editor->Get_Autosave_Filename();
+	}
+
+	// editor disabled or another level or world loaded
+	if( editor != m_editor || filename != m_filename )
+	{
+		Stop();
+
+		if( editor && !filename.empty() )
+		{
+			Start( editor );
+		}
+	}
+
+	if( !m_editor )
+	{
+		return;
+	}
+
+	if( m_compacting )
+	{
+		// the full save or the last journal write is not finished
+		if( m_editor->Is_Autosave_Saving() || !Is_Task_Finished() )
+		{
+			return;
+		}
+
+		m_compacting = 0;
+		m_base_filename = m_editor->Get_Autosave_Base_Filename();
+
+		// could not be saved
+		if( m_base_filename.empty() )
+		{
+			m_base_missing = 1;
+			return;
+		}
+
+		m_base_size = Get_File_Size( m_base_filename );
+		m_base_time = Get_File_Modification_Time( m_base_filename );
+		// the journal entries are in the full save
+		Write( Get_Header(), 0 );
+		return;
+	}
+
+	// the entries written while the journal was busy
+	if( !m_pending.empty() && Is_Task_Finished() )
+	{
+		Write( m_pending, 1 );
+		m_pending.clear();
+	}
+
+	const Uint32 ticks = SDL_GetTicks();
+
+	if( ticks - m_write_time >= editor_autosave_write_interval )
+	{
+		m_write_time = ticks;
+
+		// saved by the user
+		if( !m_base_missing && !Is_Base_Valid() )
+		{
+			m_base_missing = 1;
+			m_journal_used = 0;
+		}
+
+		if( !m_base_missing )
+		{
+			Write_Changes();
+		}
+		// the journal needs a full save as base
+		else if( !m_changes.empty() || m_editor->Get_Autosave_Player_Data() != m_player_data )
+		{
+			Compact();
+			return;
+		}
+	}
+
+	// idle
+	if( m_journal_used && m_changes.empty() && ticks - m_change_time >= editor_autosave_idle_time )
+	{
+		Compact();
+	}
+}
+
+void cEditor_Autosave :: Set_Changed( cSprite *sprite )
+{
+	if( !m_editor || !sprite || sprite->m_sprite_manager != m_editor->m_sprite_manager || !sprite->Is_Sprite_Managed() || sprite->m_spawned )
+	{
+		return;
+	}
+
+	const Uint64 key = Get_Handle_Key( sprite->m_handle );
+	Number_Map::const_iterator itr = m_numbers.find( key );
+	unsigned int number;
+
+	// created after the last full save
+	if( itr == m_numbers.end() )
+	{
+		number = m_next_number++;
+		m_numbers[key] = number;
+	}
+	else
+	{
+		number = itr->second;
+	}
+
+	m_changes[number] = sprite->m_handle;
+	m_change_time = SDL_GetTicks();
+}
+
+void cEditor_Autosave :: Start( cEditor *editor )
+{
+	m_editor = editor;
+	m_filename = editor->Get_Autosave_Filename();
+	m_base_filename.clear();
+	m_base_size = 0;
+	m_base_time = 0;
+	m_base_count = 0;
+	m_base_missing = 1;
+	m_compacting = 0;
+	m_journal_used = 0;
+	m_numbers.clear();
+	m_next_number = 0;
+	m_changes.clear();
+	m_pending.clear();
+	m_player_data = editor->Get_Autosave_Player_Data();
+	m_write_time = SDL_GetTicks();
+	m_change_time = m_write_time;
+
+	if( !File_Exists( m_filename ) )
+	{
+		return;
+	}
+
+	// read the journal of the previous session
+#ifdef _WIN32
+	FILE *fp = _wfopen( utf8_to_ucs2( m_filename ).c_str(), L"rb" );
+#else
+	FILE *fp = fopen( m_filename.c_str(), "rb" );
+#endif
+
+	std::string data;
+
+	if( fp )
+	{
+		char buffer[4096];
+		size_t count;
+
+		while( ( count = fread( buffer, 1, sizeof(buffer), fp ) ) > 0 )
+		{
+			data.append( buffer, count );
+		}
+
+		fclose( fp );
+	}
+
+	if( !Recover( data ) )
+	{
+		Delete_File( m_filename );
+		return;
+	}
+
+	// the journal is replaced when the recovered level or world is saved
+	Compact();
+}
+
+void cEditor_Autosave :: Stop( void )
+{
+	if( !m_editor )
+	{
+		return;
+	}
+
+	// the objects are only available if still loaded and a full save would replace the journal
+	if( !m_compacting && !m_base_missing && m_editor->Get_Autosave_Filename() == m_filename && Is_Base_Valid() )
+	{
+		Write_Changes();
+	}
+
+	Wait();
+
+	if( !m_pending.empty() )
+	{
+		Write( m_pending, 1 );
+		m_pending.clear();
+		Wait();
+	}
+
+	m_editor = NULL;
+	m_filename.clear();
+	m_numbers.clear();
+	m_changes.clear();
+}
+
+bool cEditor_Autosave :: Recover( const std::string &data )
+{
+	cIndex_Reader reader( data.data(), data.size() );
+
+	if( reader.Read_Uint32() != editor_autosave_magic || reader.Read_Uint32() != editor_autosave_version )
+	{
+		return 0;
+	}
+
+	const Uint64 base_size = reader.Read_Uint64();
+	const Uint64 base_time = reader.Read_Uint64();
+	const unsigned int base_count = reader.Read_Uint32();
+	const std::string base_filename = m_editor->Get_Autosave_Base_Filename();
+
+	// no changes or saved after the journal was written
+	if( !reader.m_valid || reader.m_pos >= reader.m_size || base_filename.empty() || Get_File_Size( base_filename ) != base_size || static_cast<Uint64>(Get_File_Modification_Time( base_filename )) != base_time )
+	{
+		debug_print( "Editor autosave journal %s is not used\n", m_filename.c_str() );
+		return 0;
+	}
+
+	if( !Box_Question( _("Recover the unsaved editor changes of ") + Trim_Filename( base_filename, 0, 0 ) + " ?" ) )
+	{
+		return 0;
+	}
+
+	// the journal is based on the saved objects
+	if( !m_editor->Autosave_Reload() )
+	{
+		return 0;
+	}
+
+	vector<cObject_Handle> objects;
+
+	for( cSprite_List::iterator itr = m_editor->m_sprite_manager->objects.begin(); itr != m_editor->m_sprite_manager->objects.end(); ++itr )
+	{
+		if( !Is_Saved_Object( *itr ) )
+		{
+			continue;
+		}
+
+		objects.push_back( (*itr)->m_handle );
+	}
+
+	if( objects.size() != base_count )
+	{
+		printf( "Warning : Editor autosave journal %s does not match the saved objects\n", m_filename.c_str() );
+		pHud_Debug->Set_Text( _("Couldn't recover the editor changes"), speedfactor_fps * 5.0f );
+		return 0;
+	}
+
+	unsigned int entry_count = 0;
+
+	while( reader.m_pos < reader.m_size )
+	{
+		const Uint32 type = reader.Read_Uint32();
+		const unsigned int number = reader.Read_Uint32();
+		const std::string entry = reader.Read_String();
+
+		// the last entry was not completely written
+		if( !reader.m_valid )
+		{
+			break;
+		}
+
+		entry_count++;
+
+		if( type == ENTRY_PLAYER )
+		{
+			m_editor->Set_Autosave_Player_Data( entry );
+			continue;
+		}
+
+		// created after the full save
+		if( number >= objects.size() )
+		{
+			objects.resize( number + 1 );
+		}
+
+		cSprite *sprite = Get_Sprite( objects[number] );
+
+		// the settings can change the object type so it is created again
+		if( sprite )
+		{
+			pMouseCursor->Delete( sprite );
+		}
+
+		if( type == ENTRY_SET )
+		{
+			sprite = cEditor_History::Create_Object( entry, m_editor );
+			objects[number] = sprite ? sprite->m_handle : cObject_Handle();
+		}
+		else
+		{
+			objects[number] = cObject_Handle();
+		}
+	}
+
+	// the history can not undo the recovery
+	pMouseCursor->Reset( 0 );
+
+	pHud_Debug->Set_Text( _("Recovered ") + int_to_string( entry_count ) + _(" editor changes") );
+	return 1;
+}
+
+void cEditor_Autosave :: Compact( void )
+{
+	// serialized now and written in the background
+	m_editor->Autosave_Save();
+
+	m_numbers.clear();
+	m_changes.clear();
+	m_pending.clear();
+	m_next_number = 0;
+
+	// the object numbers in the full save
+	for( cSprite_List::iterator itr = m_editor->m_sprite_manager->objects.begin(); itr != m_editor->m_sprite_manager->objects.end(); ++itr )
+	{
+		cSprite *obj = (*itr);
+
+		if( !Is_Saved_Object( obj ) )
+		{
+			continue;
+		}
+
+		m_numbers[Get_Handle_Key( obj->m_handle )] = m_next_number++;
+	}
+
+	m_base_count = m_next_number;
+	m_player_data = m_editor->Get_Autosave_Player_Data();
+	m_base_missing = 0;
+	m_compacting = 1;
+	m_journal_used = 0;
+	m_change_time = SDL_GetTicks();
+}
+
+void cEditor_Autosave :: Write_Changes( void )
+{
+	cIndex_Writer writer;
+
+	for( Change_Map::iterator itr = m_changes.begin(); itr != m_changes.end(); ++itr )
+	{
+		cSprite *sprite = Get_Sprite( itr->second );
+
+		// deleted
+		if( !sprite || !Is_Saved_Object( sprite ) )
+		{
+			writer.Write_Uint32( ENTRY_REMOVE );
+			writer.Write_Uint32( itr->first );
+			writer.Write_String( "" );
+			continue;
+		}
+
+		writer.Write_Uint32( ENTRY_SET );
+		writer.Write_Uint32( itr->first );
+		writer.Write_String( cEditor_History::Serialize( sprite ) );
+	}
+
+	m_changes.clear();
+
+	const std::string player_data = m_editor->Get_Autosave_Player_Data();
+
+	if( player_data != m_player_data )
+	{
+		writer.Write_Uint32( ENTRY_PLAYER );
+		writer.Write_Uint32( 0 );
+		writer.Write_String( player_data );
+		m_player_data = player_data;
+	}
+
+	if( writer.m_data.empty() )
+	{
+		return;
+	}
+
+	m_journal_used = 1;
+	m_pending.append( writer.m_data );
+
+	// written with the next update if busy
+	if( Is_Task_Finished() )
+	{
+		Write( m_pending, 1 );
+		m_pending.clear();
+	}
+}
+
+void cEditor_Autosave :: Write( const std::string &data, bool append )
+{
+	Wait();
+
+	m_data = data;
+	m_append = append;
+	m_task_finished = 0;
+	pTask_Pool->Add( boost::bind( &cEditor_Autosave::Write_Task, this ), TASK_PRIORITY_BACKGROUND, m_task_group, "editor autosave" );
+}
+
+void cEditor_Autosave :: Wait( void )
+{
+	pTask_Pool->Wait( m_task_group );
+}
+
+void cEditor_Autosave :: Write_Task( void )
+{
+	// a replaced journal is only used if complete
+	const std::string filename = m_append ? m_filename : m_filename + ".tmp";
+
+#ifdef _WIN32
+	FILE *fp = _wfopen( utf8_to_ucs2( filename ).c_str(), m_append ? L"ab" : L"wb" );
+#else
+	FILE *fp = fopen( filename.c_str(), m_append ? "ab" : "wb" );
+#endif
+
+	bool success = 0;
+
+	if( fp )
+	{
+		success = fwrite( m_data.data(), m_data.size(), 1, fp ) == 1;
+		success = fflush( fp ) == 0 && success;
+		success = fclose( fp ) == 0 && success;
+
+		if( success && !m_append )
+		{
+			success = Rename_File( filename, m_filename );
+		}
+	}
+
+	if( !success )
+	{
+		printf( "Warning : Couldn't write editor autosave journal %s\n", m_filename.c_str() );
+	}
+
+	boost::mutex::scoped_lock lock( m_mutex );
+	m_data.clear();
+	m_task_finished = 1;
+}
+
+bool cEditor_Autosave :: Is_Task_Finished( void )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+	return m_task_finished;
+}
+
+std::string cEditor_Autosave :: Get_Header( void ) const
+{
+	cIndex_Writer writer;
+
+	writer.Write_Uint32( editor_autosave_magic );
+	writer.Write_Uint32( editor_autosave_version );
+	writer.Write_Uint64( m_base_size );
+	writer.Write_Uint64( m_base_time );
+	writer.Write_Uint32( m_base_count );
+
+	return writer.m_data;
+}
+
+bool cEditor_Autosave :: Is_Base_Valid( void ) const
+{
+	return !m_base_filename.empty() && Get_File_Size( m_base_filename ) == m_base_size && static_cast<Uint64>(Get_File_Modification_Time( m_base_filename )) == m_base_time;
+}
+
+cEditor_Autosave *pEditor_Autosave = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
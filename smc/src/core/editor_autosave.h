@@ -0,0 +1,157 @@
+/***************************************************************************
+ * editor_autosave.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_EDITOR_AUTOSAVE_H
+#define SMC_EDITOR_AUTOSAVE_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../core/obj_manager.h"
+// boost
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
+// std
+#include <map>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** cEditor_Autosave *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Autosave of the level and world editor
+ * the objects changed since the last full save are written as journal entries
+ * to a file next to the user level or world at short intervals
+ * and the full level or world is saved again if the editor was idle for a while
+ * journal entries use the object number in the last full save
+ * and new objects get the numbers after it
+ * after a crash the last full save is loaded with the journal entries applied
+ * the journal file is written as task pool background task
+*/
+class cEditor_Autosave
+{
+public:
+	cEditor_Autosave( void );
+	~cEditor_Autosave( void );
+
+	/* Start or stop the autosave of the enabled editor
+	 * checks for a journal of a previous session and asks to recover it
+	 * writes the journal entries at the intervals and saves the full level or world if idle
+	*/
+	void Update( void );
+
+	// Add that the object was created, changed or will be deleted
+	void Set_Changed( cSprite *sprite );
+
+	// Returns true if the editor changes are autosaved
+	inline bool Is_Active( void ) const
+	{
+		return m_editor != NULL;
+	}
+
+private:
+	enum Entry_Type
+	{
+		// object settings
+		ENTRY_SET = 1,
+		// deleted object
+		ENTRY_REMOVE = 2,
+		// player start settings
+		ENTRY_PLAYER = 3
+	};
+
+	/* Start the autosave of the editor
+	 * recovers the journal of a previous session if confirmed
+	*/
+	void Start( cEditor *editor );
+	// Stop the autosave and write the changes not yet in the journal
+	void Stop( void );
+
+	/* Recover the level or world from the journal
+	 * returns false if the journal is invalid or does not belong to the last full save
+	*/
+	bool Recover( const std::string &data );
+
+	// Save the full level or world and number the saved objects
+	void Compact( void );
+	// Write the changes since the last call to the journal
+	void Write_Changes( void );
+	// Start writing the data to the journal as task
+	void Write( const std::string &data, bool append );
+	// Wait until the task is finished
+	void Wait( void );
+	// Write the data as task
+	void Write_Task( void );
+	// Returns true if the task is finished
+	bool Is_Task_Finished( void );
+
+	// Returns the journal header for the last full save
+	std::string Get_Header( void ) const;
+	// Returns true if the last full save file was not changed by someone else
+	bool Is_Base_Valid( void ) const;
+
+	// editor with the autosave or NULL if not active
+	cEditor *m_editor;
+	// journal filename
+	std::string m_filename;
+
+	// last full save file and its size and modification time
+	std::string m_base_filename;
+	Uint64 m_base_size;
+	Uint64 m_base_time;
+	// number of objects in the last full save
+	unsigned int m_base_count;
+	// if no full save was done in this session
+	bool m_base_missing;
+	// if a full save is written
+	bool m_compacting;
+	// if the journal has entries since the last full save
+	bool m_journal_used;
+
+	// object numbers by handle
+	typedef boost::unordered_map<Uint64, unsigned int> Number_Map;
+	Number_Map m_numbers;
+	// next object number
+	unsigned int m_next_number;
+	// objects changed since the last journal write by number
+	typedef std::map<unsigned int, cObject_Handle> Change_Map;
+	Change_Map m_changes;
+	// player start settings of the last journal write
+	std::string m_player_data;
+
+	// entries not yet written because the journal is busy
+	std::string m_pending;
+	// time of the last journal write and change in milliseconds
+	Uint32 m_write_time;
+	Uint32 m_change_time;
+
+	// task pool group of the journal write
+	unsigned int m_task_group;
+	boost::mutex m_mutex;
+	// data written by the task
+	std::string m_data;
+	// if the task appends the data or replaces the journal
+	bool m_append;
+	// if the task is finished
+	bool m_task_finished;
+};
+
+// Editor autosave
+extern cEditor_Autosave *pEditor_Autosave;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -0,0 +1,616 @@
+/***************************************************************************
+ * editor_catalogue.cpp  -  cached names, tags and thumbnails of the editor image items
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/editor_catalogue.h"
+#include "../core/game_core.h"
+#include "../core/math/utilities.h"
+#include "../core/filesystem/filesystem.h"
+#include "../video/video.h"
+#include "../video/img_settings.h"
+#include <boost/unordered_set.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** Thumbnails *** *** *** *** *** *** *** *** *** *** */
+
+// page width and height
+static const unsigned int editor_catalogue_page_size = 1024;
+// thumbnail cell size which fits the default item list preview of 100x50
+static const unsigned int editor_catalogue_cell_width = 128;
+static const unsigned int editor_catalogue_cell_height = 64;
+// cells in a page row and in a page
+static const unsigned int editor_catalogue_page_columns = editor_catalogue_page_size / editor_catalogue_cell_width;
+static const unsigned int editor_catalogue_page_cells = editor_catalogue_page_columns * ( editor_catalogue_page_size / editor_catalogue_cell_height );
+// page bytes
+static const unsigned int editor_catalogue_page_bytes = editor_catalogue_page_size * editor_catalogue_page_size * 4;
+
+/* Scale the 32 bit RGBA image down into the destination RGBA pixels
+ * each destination pixel is the alpha weighted average of its source area
+*/
+static void Editor_Catalogue_Scale( const SDL_Surface *surface, unsigned char *dest, unsigned int dest_width, unsigned int dest_height, unsigned int dest_row_length )
+{
+	const unsigned char *src = static_cast<const unsigned char *>(surface->pixels);
+	const unsigned int src_width = surface->w;
+	const unsigned int src_height = surface->h;
+
+	for( unsigned int y = 0; y < dest_height; y++ )
+	{
+		const unsigned int src_y1 = y * src_height / dest_height;
+		const unsigned int src_y2 = Clamp( ( y + 1 ) * src_height / dest_height, src_y1 + 1, src_height );
+
+		for( unsigned int x = 0; x < dest_width; x++ )
+		{
+			const unsigned int src_x1 = x * src_width / dest_width;
+			const unsigned int src_x2 = Clamp( ( x + 1 ) * src_width / dest_width, src_x1 + 1, src_width );
+
+			unsigned int red = 0, green = 0, blue = 0, alpha = 0, count = 0;
+
+			for( unsigned int sy = src_y1; sy < src_y2; sy++ )
+			{
+				const unsigned char *pixel = src + sy * surface->pitch + src_x1 * 4;
+
+				for( unsigned int sx = src_x1; sx < src_x2; sx++ )
+				{
+					// transparent pixels do not add their color
+					red += pixel[0] * pixel[3];
+					green += pixel[1] * pixel[3];
+					blue += pixel[2] * pixel[3];
+					alpha += pixel[3];
+					count++;
+					pixel += 4;
+				}
+			}
+
+			unsigned char *dest_pixel = dest + ( y * dest_row_length + x ) * 4;
+
+			if( alpha )
+			{
+				dest_pixel[0] = static_cast<unsigned char>(red / alpha);
+				dest_pixel[1] = static_cast<unsigned char>(green / alpha);
+				dest_pixel[2] = static_cast<unsigned char>(blue / alpha);
+			}
+			else
+			{
+				dest_pixel[0] = 0;
+				dest_pixel[1] = 0;
+				dest_pixel[2] = 0;
+			}
+
+			dest_pixel[3] = static_cast<unsigned char>(alpha / count);
+		}
+	}
+}
+
+/* *** *** *** *** *** *** *** cEditor_Catalogue_Item *** *** *** *** *** *** *** *** *** *** */
+
+cEditor_Catalogue_Item :: cEditor_Catalogue_Item( void )
+{
+	m_settings_modified = 0;
+	m_image_modified = 0;
+	m_type = 0;
+	m_width = 0;
+	m_height = 0;
+	m_cell = -1;
+	m_thumb_width = 0;
+	m_thumb_height = 0;
+}
+
+/* *** *** *** *** *** *** *** cEditor_Catalogue *** *** *** *** *** *** *** *** *** *** */
+
+// index file identification "SMCE" and version
+static const Uint32 editor_catalogue_magic = 0x45434D53;
+static const Uint32 editor_catalogue_version = 1;
+
+// filename sort of the items
+struct editor_catalogue_filename_sort
+{
+	bool operator()( const cEditor_Catalogue_Item *a, const cEditor_Catalogue_Item *b ) const
+	{
+		return a->m_filename < b->m_filename;
+	}
+};
+
+cEditor_Catalogue :: cEditor_Catalogue( void )
+{
+	m_modified = 0;
+}
+
+cEditor_Catalogue :: ~cEditor_Catalogue( void )
+{
+	//
+}
+
+void cEditor_Catalogue :: Update( const std::string &dir )
+{
+	const vector<std::string> settings_files = Get_Directory_Files( dir, ".settings" );
+	boost::unordered_set<std::string> found;
+	vector<cEditor_Catalogue_Item *> changed;
+
+	for( vector<std::string>::const_iterator itr = settings_files.begin(); itr != settings_files.end(); ++itr )
+	{
+		const std::string &filename = (*itr);
+		found.insert( filename );
+
+		Item_Map::iterator item_itr = m_items.find( filename );
+
+		// unchanged
+		if( item_itr != m_items.end() && item_itr->second.m_settings_modified == Get_File_Modification_Time( filename ) &&
+			( item_itr->second.m_image_filename.empty() || item_itr->second.m_image_modified == Get_File_Modification_Time( item_itr->second.m_image_filename ) ) )
+		{
+			continue;
+		}
+
+		// read new or changed items
+		cEditor_Catalogue_Item &item = m_items[filename];
+		item.m_filename = filename;
+		item.m_cell = -1;
+		Read_Item( item );
+
+		changed.push_back( &item );
+		m_modified = 1;
+	}
+
+	// remove deleted items
+	const std::string dir_prefix = dir + "/";
+
+	for( Item_Map::iterator itr = m_items.begin(); itr != m_items.end(); )
+	{
+		if( itr->first.compare( 0, dir_prefix.length(), dir_prefix ) != 0 || found.find( itr->first ) != found.end() )
+		{
+			++itr;
+			continue;
+		}
+
+		itr = m_items.erase( itr );
+		m_modified = 1;
+	}
+
+	if( changed.empty() )
+	{
+		return;
+	}
+
+	// cells still used
+	vector<bool> used_cells( m_pages.size() * editor_catalogue_page_cells, 0 );
+
+	for( Item_Map::const_iterator itr = m_items.begin(); itr != m_items.end(); ++itr )
+	{
+		const int cell = itr->second.m_cell;
+
+		if( cell >= 0 && static_cast<unsigned int>(cell) < used_cells.size() )
+		{
+			used_cells[cell] = 1;
+		}
+	}
+
+	// unpacked pages are only needed if a thumbnail is added
+	vector<vector<unsigned char> > pages;
+	vector<bool> changed_pages;
+	unsigned int next_cell = 0;
+
+	for( vector<cEditor_Catalogue_Item *>::iterator itr = changed.begin(); itr != changed.end(); ++itr )
+	{
+		cEditor_Catalogue_Item *item = (*itr);
+
+		// not shown in the editor
+		if( item->m_image_filename.empty() || item->m_editor_tags.empty() )
+		{
+			continue;
+		}
+
+		if( pages.empty() )
+		{
+			for( unsigned int i = 0; i < m_pages.size(); i++ )
+			{
+				vector<char> data;
+				pages.push_back( vector<unsigned char>( editor_catalogue_page_bytes, 0 ) );
+
+				if( Decompress_Data( m_pages[i].data(), m_pages[i].size(), data ) && data.size() == editor_catalogue_page_bytes )
+				{
+					memcpy( &pages.back()[0], &data[0], editor_catalogue_page_bytes );
+				}
+			}
+
+			changed_pages.assign( pages.size(), 0 );
+		}
+
+		// find a free cell
+		while( next_cell < used_cells.size() && used_cells[next_cell] )
+		{
+			next_cell++;
+		}
+
+		// add a page
+		if( next_cell >= used_cells.size() )
+		{
+			pages.push_back( vector<unsigned char>( editor_catalogue_page_bytes, 0 ) );
+			changed_pages.push_back( 1 );
+			m_pages.push_back( "" );
+			used_cells.resize( m_pages.size() * editor_catalogue_page_cells, 0 );
+		}
+
+		const unsigned int page = next_cell / editor_catalogue_page_cells;
+		item->m_cell = next_cell;
+
+		if( !Create_Thumbnail( *item, &pages[page][0] ) )
+		{
+			item->m_cell = -1;
+			continue;
+		}
+
+		used_cells[next_cell] = 1;
+		changed_pages[page] = 1;
+	}
+
+	// pack the changed pages again
+	for( unsigned int i = 0; i < changed_pages.size(); i++ )
+	{
+		if( !changed_pages[i] )
+		{
+			continue;
+		}
+
+		vector<char> data;
+
+		if( !Compress_Data( reinterpret_cast<const char *>(&pages[i][0]), pages[i].size(), data ) )
+		{
+			printf( "Warning : could not compress editor item thumbnails\n" );
+			data.clear();
+		}
+
+		m_pages[i] = data.empty() ? std::string() : std::string( &data[0], data.size() );
+	}
+}
+
+void cEditor_Catalogue :: Get_Items( const std::string &editor_tag, Editor_Catalogue_Item_List &items ) const
+{
+	const size_t start = items.size();
+
+	for( Item_Map::const_iterator itr = m_items.begin(); itr != m_items.end(); ++itr )
+	{
+		const cEditor_Catalogue_Item &item = itr->second;
+
+		if( item.m_image_filename.empty() || item.m_editor_tags.find( editor_tag ) == std::string::npos )
+		{
+			continue;
+		}
+
+		items.push_back( &item );
+	}
+
+	// keep a stable order
+	std::sort( items.begin() + start, items.end(), editor_catalogue_filename_sort() );
+}
+
+unsigned int cEditor_Catalogue :: Get_Page_Size( void ) const
+{
+	return editor_catalogue_page_size;
+}
+
+SDL_Surface *cEditor_Catalogue :: Create_Page_Surface( unsigned int page ) const
+{
+	if( page >= m_pages.size() )
+	{
+		return NULL;
+	}
+
+	vector<char> data;
+
+	if( !Decompress_Data( m_pages[page].data(), m_pages[page].size(), data ) || data.size() != editor_catalogue_page_bytes )
+	{
+		printf( "Warning : editor item thumbnail page %d is invalid\n", page );
+		return NULL;
+	}
+
+	SDL_Surface *surface = SDL_CreateRGBSurface( SDL_SWSURFACE, editor_catalogue_page_size, editor_catalogue_page_size, 32,
+	#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+			0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff );
+	#else
+			0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000 );
+	#endif
+
+	if( !surface )
+	{
+		return NULL;
+	}
+
+	for( unsigned int y = 0; y < editor_catalogue_page_size; y++ )
+	{
+		memcpy( static_cast<char *>(surface->pixels) + y * surface->pitch, &data[y * editor_catalogue_page_size * 4], editor_catalogue_page_size * 4 );
+	}
+
+	return surface;
+}
+
+bool cEditor_Catalogue :: Get_Thumbnail( const cEditor_Catalogue_Item *item, unsigned int &page, GL_rect &rect ) const
+{
+	if( item->m_cell < 0 )
+	{
+		return 0;
+	}
+
+	const unsigned int cell = item->m_cell;
+	page = cell / editor_catalogue_page_cells;
+
+	if( page >= m_pages.size() || m_pages[page].empty() )
+	{
+		return 0;
+	}
+
+	const unsigned int page_cell = cell % editor_catalogue_page_cells;
+	rect.m_x = static_cast<float>(( page_cell % editor_catalogue_page_columns ) * editor_catalogue_cell_width);
+	rect.m_y = static_cast<float>(( page_cell / editor_catalogue_page_columns ) * editor_catalogue_cell_height);
+	rect.m_w = static_cast<float>(item->m_thumb_width);
+	rect.m_h = static_cast<float>(item->m_thumb_height);
+
+	return 1;
+}
+
+bool cEditor_Catalogue :: Load_Index( const std::string &filename )
+{
+	m_index_filename = filename;
+	// saved again if not loaded
+	m_modified = 1;
+
+	cMapped_File file;
+
+	if( !file.Open( filename ) )
+	{
+		return 0;
+	}
+
+	cIndex_Reader reader( file.Get_Data(), file.Get_Size() );
+
+	// check identification and version
+	if( reader.Read_Uint32() != editor_catalogue_magic || reader.Read_Uint32() != editor_catalogue_version )
+	{
+		debug_print( "Info : editor item index %s is outdated\n", filename.c_str() );
+		return 0;
+	}
+
+	const Uint32 count = reader.Read_Uint32();
+	Item_Map items;
+
+	for( Uint32 i = 0; i < count && reader.m_valid; i++ )
+	{
+		const std::string key = reader.Read_String();
+		cEditor_Catalogue_Item &item = items[key];
+
+		item.m_filename = key;
+		item.m_image_filename = reader.Read_String();
+		item.m_settings_modified = static_cast<time_t>(reader.Read_Uint64());
+		item.m_image_modified = static_cast<time_t>(reader.Read_Uint64());
+		item.m_name = reader.Read_String();
+		item.m_editor_tags = reader.Read_String();
+		item.m_type = static_cast<int>(reader.Read_Uint32());
+		item.m_width = static_cast<int>(reader.Read_Uint32());
+		item.m_height = static_cast<int>(reader.Read_Uint32());
+		item.m_cell = static_cast<int>(reader.Read_Uint32());
+		item.m_thumb_width = static_cast<int>(reader.Read_Uint32());
+		item.m_thumb_height = static_cast<int>(reader.Read_Uint32());
+	}
+
+	const Uint32 page_count = reader.Read_Uint32();
+	vector<std::string> pages;
+
+	for( Uint32 i = 0; i < page_count && reader.m_valid; i++ )
+	{
+		pages.push_back( reader.Read_String() );
+	}
+
+	if( !reader.m_valid )
+	{
+		printf( "Warning : editor item index %s is invalid\n", filename.c_str() );
+		return 0;
+	}
+
+	// the thumbnails belong to the pages
+	m_items.swap( items );
+	m_pages.swap( pages );
+
+	m_modified = 0;
+	return 1;
+}
+
+bool cEditor_Catalogue :: Save_Index( void )
+{
+	if( m_index_filename.empty() || !m_modified )
+	{
+		return 1;
+	}
+
+	cIndex_Writer writer;
+	writer.Write_Uint32( editor_catalogue_magic );
+	writer.Write_Uint32( editor_catalogue_version );
+	writer.Write_Uint32( m_items.size() );
+
+	for( Item_Map::const_iterator itr = m_items.begin(); itr != m_items.end(); ++itr )
+	{
+		const cEditor_Catalogue_Item &item = itr->second;
+
+		writer.Write_String( itr->first );
+		writer.Write_String( item.m_image_filename );
+		writer.Write_Uint64( static_cast<Uint64>(item.m_settings_modified) );
+		writer.Write_Uint64( static_cast<Uint64>(item.m_image_modified) );
+		writer.Write_String( item.m_name );
+		writer.Write_String( item.m_editor_tags );
+		writer.Write_Uint32( item.m_type );
+		writer.Write_Uint32( item.m_width );
+		writer.Write_Uint32( item.m_height );
+		writer.Write_Uint32( item.m_cell );
+		writer.Write_Uint32( item.m_thumb_width );
+		writer.Write_Uint32( item.m_thumb_height );
+	}
+
+	writer.Write_Uint32( m_pages.size() );
+
+	for( vector<std::string>::const_iterator itr = m_pages.begin(); itr != m_pages.end(); ++itr )
+	{
+		writer.Write_String( *itr );
+	}
+
+	FILE *fp = fopen( m_index_filename.c_str(), "wb" );
+
+	if( !fp )
+	{
+		printf( "Warning : could not save editor item index %s\n", m_index_filename.c_str() );
+		return 0;
+	}
+
+	const bool written = fwrite( writer.m_data.data(), writer.m_data.size(), 1, fp ) == 1;
+	fclose( fp );
+
+	if( !written )
+	{
+		printf( "Warning : could not save editor item index %s\n", m_index_filename.c_str() );
+		Delete_File( m_index_filename );
+		return 0;
+	}
+
+	m_modified = 0;
+	return 1;
+}
+
+void cEditor_Catalogue :: Read_Item( cEditor_Catalogue_Item &item ) const
+{
+	item.m_settings_modified = Get_File_Modification_Time( item.m_filename );
+	item.m_image_filename.clear();
+	item.m_image_modified = 0;
+	item.m_name.clear();
+	item.m_editor_tags.clear();
+	item.m_type = 0;
+	item.m_width = 0;
+	item.m_height = 0;
+
+	cImage_Settings_Data *settings = pSettingsParser->Get( item.m_filename );
+
+	if( !settings )
+	{
+		return;
+	}
+
+	// image given in base settings
+	if( !settings->m_base.empty() )
+	{
+		// use current directory
+		item.m_image_filename = item.m_filename.substr( 0, item.m_filename.rfind( "/" ) + 1 ) + settings->m_base;
+
+		// not found
+		if( !File_Exists( item.m_image_filename ) )
+		{
+			// use data dir
+			item.m_image_filename = settings->m_base;
+
+			// pixmaps dir must be given
+			if( item.m_image_filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/" ) == std::string::npos )
+			{
+				item.m_image_filename.insert( 0, DATA_DIR "/" GAME_PIXMAPS_DIR "/" );
+			}
+		}
+
+		item.m_image_modified = Get_File_Modification_Time( item.m_image_filename );
+	}
+
+	item.m_name = settings->m_name;
+	string_replace_all( item.m_name, "_", " " );
+	item.m_editor_tags = settings->m_editor_tags;
+	item.m_type = settings->m_type;
+	item.m_width = settings->m_width;
+	item.m_height = settings->m_height;
+
+	delete settings;
+}
+
+bool cEditor_Catalogue :: Create_Thumbnail( cEditor_Catalogue_Item &item, unsigned char *pixels ) const
+{
+	cVideo::cSoftware_Image software_image = pVideo->Load_Image( item.m_filename, 1, 0 );
+
+	if( software_image.m_settings )
+	{
+		delete software_image.m_settings;
+		software_image.m_settings = NULL;
+	}
+
+	if( !software_image.m_sdl_surface )
+	{
+		printf( "Warning : Could not load editor sprite image base : %s\n", item.m_filename.c_str() );
+		return 0;
+	}
+
+	SDL_Surface *image = SDL_CreateRGBSurface( SDL_SWSURFACE, software_image.m_sdl_surface->w, software_image.m_sdl_surface->h, 32,
+	#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+			0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff );
+	#else
+			0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000 );
+	#endif
+
+	if( !image )
+	{
+		SDL_FreeSurface( software_image.m_sdl_surface );
+		return 0;
+	}
+
+	// copy the alpha channel instead of blending
+	SDL_SetAlpha( software_image.m_sdl_surface, 0, SDL_ALPHA_TRANSPARENT );
+	SDL_BlitSurface( software_image.m_sdl_surface, NULL, image, NULL );
+	SDL_FreeSurface( software_image.m_sdl_surface );
+
+	// size not given in the settings
+	if( item.m_width <= 0 )
+	{
+		item.m_width = image->w;
+	}
+	if( item.m_height <= 0 )
+	{
+		item.m_height = image->h;
+	}
+
+	// only scale down into the cell
+	float scale = 1.0f;
+
+	if( image->w > static_cast<int>(editor_catalogue_cell_width) || image->h > static_cast<int>(editor_catalogue_cell_height) )
+	{
+		scale = std::min( static_cast<float>(editor_catalogue_cell_width) / image->w, static_cast<float>(editor_catalogue_cell_height) / image->h );
+	}
+
+	item.m_thumb_width = Clamp( static_cast<int>(image->w * scale), 1, static_cast<int>(editor_catalogue_cell_width) );
+	item.m_thumb_height = Clamp( static_cast<int>(image->h * scale), 1, static_cast<int>(editor_catalogue_cell_height) );
+
+	const unsigned int page_cell = item.m_cell % editor_catalogue_page_cells;
+	const unsigned int cell_x = ( page_cell % editor_catalogue_page_columns ) * editor_catalogue_cell_width;
+	const unsigned int cell_y = ( page_cell / editor_catalogue_page_columns ) * editor_catalogue_cell_height;
+	unsigned char *cell_pixels = pixels + ( cell_y * editor_catalogue_page_size + cell_x ) * 4;
+
+	// clear the cell of a previous thumbnail
+	for( unsigned int y = 0; y < editor_catalogue_cell_height; y++ )
+	{
+		memset( cell_pixels + y * editor_catalogue_page_size * 4, 0, editor_catalogue_cell_width * 4 );
+	}
+
+	Editor_Catalogue_Scale( image, cell_pixels, item.m_thumb_width, item.m_thumb_height, editor_catalogue_page_size );
+	SDL_FreeSurface( image );
+
+	return 1;
+}
+
+cEditor_Catalogue *pEditor_Catalogue = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
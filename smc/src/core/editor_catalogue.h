@@ -0,0 +1,135 @@
+/***************************************************************************
+ * editor_catalogue.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_EDITOR_CATALOGUE_H
+#define SMC_EDITOR_CATALOGUE_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../core/math/rect.h"
+// SDL
+#include "SDL.h"
+// boost
+#include <boost/unordered_map.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cEditor_Catalogue_Item *** *** *** *** *** *** *** *** *** *** */
+
+// Settings of an editor image item shown in the item list
+class cEditor_Catalogue_Item
+{
+public:
+	cEditor_Catalogue_Item( void );
+
+	// full settings filename
+	std::string m_filename;
+	// full image filename or empty if the settings have no image
+	std::string m_image_filename;
+	// modification time of the settings and image file when they were read
+	time_t m_settings_modified;
+	time_t m_image_modified;
+
+	std::string m_name;
+	std::string m_editor_tags;
+	// sprite type from the settings
+	int m_type;
+	// image size
+	int m_width;
+	int m_height;
+
+	// thumbnail cell in the pages or -1 if it has none
+	int m_cell;
+	// thumbnail size in the cell
+	int m_thumb_width;
+	int m_thumb_height;
+};
+
+typedef vector<const cEditor_Catalogue_Item *> Editor_Catalogue_Item_List;
+
+/* *** *** *** *** *** *** *** cEditor_Catalogue *** *** *** *** *** *** *** *** *** *** */
+
+/* Names, tags and small thumbnails of all editor image items
+ * kept in the user cache directory and only read again from a settings file if it or its image was modified
+ * the thumbnails are packed into a few pages so the item list does not need a texture of every image
+*/
+class cEditor_Catalogue
+{
+public:
+	cEditor_Catalogue( void );
+	~cEditor_Catalogue( void );
+
+	/* Update the items of the settings files in the directory
+	 * new or changed items are read and get a new thumbnail and the items of removed files are deleted
+	*/
+	void Update( const std::string &dir );
+	// Add the items with an image and the given editor tag to the list sorted by filename
+	void Get_Items( const std::string &editor_tag, Editor_Catalogue_Item_List &items ) const;
+
+	// Returns the number of thumbnail pages
+	inline unsigned int Get_Page_Count( void ) const
+	{
+		return m_pages.size();
+	}
+	// Returns the thumbnail page width and height
+	unsigned int Get_Page_Size( void ) const;
+	/* Create a software image of the thumbnail page
+	 * returns NULL if it could not be created
+	 * the returned image should be freed if not used anymore
+	*/
+	SDL_Surface *Create_Page_Surface( unsigned int page ) const;
+	/* Get the page and the area in the page of the item thumbnail
+	 * returns false if it has no thumbnail
+	*/
+	bool Get_Thumbnail( const cEditor_Catalogue_Item *item, unsigned int &page, GL_rect &rect ) const;
+
+	/* Add the items from the index file
+	 * the file is used for saving afterwards even if it could not be loaded
+	 * returns false if it could not be loaded
+	*/
+	bool Load_Index( const std::string &filename );
+	/* Save all items to the index file if changed since loading
+	 * returns false if it could not be saved
+	*/
+	bool Save_Index( void );
+
+private:
+	// Read the settings of the item
+	void Read_Item( cEditor_Catalogue_Item &item ) const;
+	/* Render the image of the item into its cell of the page pixels
+	 * returns false if the image could not be loaded
+	*/
+	bool Create_Thumbnail( cEditor_Catalogue_Item &item, unsigned char *pixels ) const;
+
+	typedef boost::unordered_map<std::string, cEditor_Catalogue_Item> Item_Map;
+	Item_Map m_items;
+	// compressed RGBA pixels of each page
+	vector<std::string> m_pages;
+
+	// index file or empty if not used
+	std::string m_index_filename;
+	// if items changed since the index was loaded
+	bool m_modified;
+};
+
+// Editor image item catalogue
+extern cEditor_Catalogue *pEditor_Catalogue;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
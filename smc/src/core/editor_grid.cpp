@@ -0,0 +1,267 @@
+/***************************************************************************
+ * editor_grid.cpp  -  uniform grid over the sprite editor rects
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/editor_grid.h"
+#include "../core/game_core.h"
+#include "../objects/sprite.h"
+#include "../core/math/utilities.h"
+#include <algorithm>
+#include <cmath>
+
+namespace SMC
+{
+
+// cell size in world coordinates
+static const float editor_grid_cell_size = 256.0f;
+// sprites touching more cells are kept in the large sprite list
+static const int editor_grid_max_cells = 64;
+// cell positions are limited to this against invalid positions
+static const float editor_grid_max_pos = 1000000.0f;
+
+/* *** *** *** *** *** *** cEditor_Grid *** *** *** *** *** *** *** *** *** *** *** */
+
+cEditor_Grid :: cEditor_Grid( void )
+{
+	m_valid = 0;
+}
+
+cEditor_Grid :: ~cEditor_Grid( void )
+{
+	Clear();
+}
+
+void cEditor_Grid :: Build( const Sprite_List &objects )
+{
+	if( m_valid )
+	{
+		return;
+	}
+
+	Clear();
+	m_valid = 1;
+
+	for( Sprite_List::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	{
+		Add( *itr );
+	}
+}
+
+void cEditor_Grid :: Add( cSprite *sprite )
+{
+	// added with the next build
+	if( !m_valid )
+	{
+		return;
+	}
+
+	// already added
+	if( sprite->m_editor_grid )
+	{
+		sprite->m_editor_grid->Remove( sprite );
+	}
+
+	sprite->m_editor_grid = this;
+
+	const Cell_Range range = Get_Range( sprite );
+	m_ranges[sprite] = range;
+	Insert( sprite, range );
+}
+
+void cEditor_Grid :: Remove( cSprite *sprite )
+{
+	if( sprite->m_editor_grid != this )
+	{
+		return;
+	}
+
+	sprite->m_editor_grid = NULL;
+
+	Range_Map::iterator itr = m_ranges.find( sprite );
+
+	if( itr == m_ranges.end() )
+	{
+		return;
+	}
+
+	Erase( sprite, itr->second );
+	m_ranges.erase( itr );
+}
+
+void cEditor_Grid :: Update( cSprite *sprite )
+{
+	if( !m_valid )
+	{
+		return;
+	}
+
+	// the game moves many sprites and the grid is only used by the editor
+	if( !editor_enabled )
+	{
+		m_valid = 0;
+		return;
+	}
+
+	Range_Map::iterator itr = m_ranges.find( sprite );
+
+	if( itr == m_ranges.end() )
+	{
+		return;
+	}
+
+	const Cell_Range range = Get_Range( sprite );
+	Cell_Range &old_range = itr->second;
+
+	// still in the same cells
+	if( range.m_x1 == old_range.m_x1 && range.m_y1 == old_range.m_y1 && range.m_x2 == old_range.m_x2 && range.m_y2 == old_range.m_y2 )
+	{
+		return;
+	}
+
+	Erase( sprite, old_range );
+	old_range = range;
+	Insert( sprite, range );
+}
+
+void cEditor_Grid :: Clear( void )
+{
+	for( Range_Map::iterator itr = m_ranges.begin(); itr != m_ranges.end(); ++itr )
+	{
+		itr->first->m_editor_grid = NULL;
+	}
+
+	m_ranges.clear();
+	m_cells.clear();
+	m_large_sprites.clear();
+	m_valid = 0;
+}
+
+void cEditor_Grid :: Get_Objects( Sprite_List &objects, const GL_rect &rect ) const
+{
+	const size_t start = objects.size();
+	const Cell_Range range = Get_Range( rect.m_x, rect.m_y, rect.m_x + rect.m_w, rect.m_y + rect.m_h );
+
+	objects.insert( objects.end(), m_large_sprites.begin(), m_large_sprites.end() );
+
+	for( int y = range.m_y1; y <= range.m_y2; y++ )
+	{
+		for( int x = range.m_x1; x <= range.m_x2; x++ )
+		{
+			Cell_Map::const_iterator itr = m_cells.find( Get_Key( x, y ) );
+
+			if( itr == m_cells.end() )
+			{
+				continue;
+			}
+
+			objects.insert( objects.end(), itr->second.begin(), itr->second.end() );
+		}
+	}
+
+	// sprites in several cells
+	std::sort( objects.begin() + start, objects.end() );
+	objects.erase( std::unique( objects.begin() + start, objects.end() ), objects.end() );
+}
+
+cEditor_Grid::Cell_Range cEditor_Grid :: Get_Range( const cSprite *sprite )
+{
+	// the mouse picks the start rect and the selection uses the rect
+	const GL_rect &start_rect = sprite->m_start_rect;
+	const GL_rect &rect = sprite->m_rect;
+
+	const float x1 = std::min( std::min( start_rect.m_x, start_rect.m_x + start_rect.m_w ), std::min( rect.m_x, rect.m_x + rect.m_w ) );
+	const float y1 = std::min( std::min( start_rect.m_y, start_rect.m_y + start_rect.m_h ), std::min( rect.m_y, rect.m_y + rect.m_h ) );
+	const float x2 = std::max( std::max( start_rect.m_x, start_rect.m_x + start_rect.m_w ), std::max( rect.m_x, rect.m_x + rect.m_w ) );
+	const float y2 = std::max( std::max( start_rect.m_y, start_rect.m_y + start_rect.m_h ), std::max( rect.m_y, rect.m_y + rect.m_h ) );
+
+	return Get_Range( x1, y1, x2, y2 );
+}
+
+cEditor_Grid::Cell_Range cEditor_Grid :: Get_Range( float x1, float y1, float x2, float y2 )
+{
+	// the rect size could be negative
+	if( x2 < x1 )
+	{
+		std::swap( x1, x2 );
+	}
+	if( y2 < y1 )
+	{
+		std::swap( y1, y2 );
+	}
+
+	Cell_Range range;
+	range.m_x1 = static_cast<int>(std::floor( Clamp( x1, -editor_grid_max_pos, editor_grid_max_pos ) / editor_grid_cell_size ));
+	range.m_y1 = static_cast<int>(std::floor( Clamp( y1, -editor_grid_max_pos, editor_grid_max_pos ) / editor_grid_cell_size ));
+	range.m_x2 = static_cast<int>(std::floor( Clamp( x2, -editor_grid_max_pos, editor_grid_max_pos ) / editor_grid_cell_size ));
+	range.m_y2 = static_cast<int>(std::floor( Clamp( y2, -editor_grid_max_pos, editor_grid_max_pos ) / editor_grid_cell_size ));
+	range.m_large = ( range.m_x2 - range.m_x1 + 1 ) * ( range.m_y2 - range.m_y1 + 1 ) > editor_grid_max_cells;
+
+	return range;
+}
+
+Uint64 cEditor_Grid :: Get_Key( int x, int y )
+{
+	return ( static_cast<Uint64>(static_cast<Uint32>(x)) << 32 ) | static_cast<Uint32>(y);
+}
+
+void cEditor_Grid :: Insert( cSprite *sprite, const Cell_Range &range )
+{
+	if( range.m_large )
+	{
+		m_large_sprites.push_back( sprite );
+		return;
+	}
+
+	for( int y = range.m_y1; y <= range.m_y2; y++ )
+	{
+		for( int x = range.m_x1; x <= range.m_x2; x++ )
+		{
+			m_cells[Get_Key( x, y )].push_back( sprite );
+		}
+	}
+}
+
+void cEditor_Grid :: Erase( cSprite *sprite, const Cell_Range &range )
+{
+	if( range.m_large )
+	{
+		m_large_sprites.erase( std::remove( m_large_sprites.begin(), m_large_sprites.end(), sprite ), m_large_sprites.end() );
+		return;
+	}
+
+	for( int y = range.m_y1; y <= range.m_y2; y++ )
+	{
+		for( int x = range.m_x1; x <= range.m_x2; x++ )
+		{
+			Cell_Map::iterator itr = m_cells.find( Get_Key( x, y ) );
+
+			if( itr == m_cells.end() )
+			{
+				continue;
+			}
+
+			Sprite_List &cell = itr->second;
+			cell.erase( std::remove( cell.begin(), cell.end(), sprite ), cell.end() );
+
+			if( cell.empty() )
+			{
+				m_cells.erase( itr );
+			}
+		}
+	}
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
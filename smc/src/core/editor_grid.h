@@ -0,0 +1,113 @@
+/***************************************************************************
+ * editor_grid.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_EDITOR_GRID_H
+#define SMC_EDITOR_GRID_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../core/math/rect.h"
+// SDL
+#include "SDL.h"
+// boost
+#include <boost/unordered_map.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** cEditor_Grid *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Uniform grid over the editor rects of sprites for mouse picking and selection
+ * separate from cSprite_Grid as the editor uses the start and image rects instead of the collision rect
+ * a sprite is in every cell the bounding box of its start rect and rect touches
+ * it is only maintained while the editor is enabled
+ * and built again with the first query after a sprite changed in the game
+*/
+class cEditor_Grid
+{
+public:
+	cEditor_Grid( void );
+	~cEditor_Grid( void );
+
+	// same as cSprite_List
+	typedef vector<cSprite *> Sprite_List;
+
+	// Build the grid from the sprites if not valid
+	void Build( const Sprite_List &objects );
+	// Add the sprite if valid
+	void Add( cSprite *sprite );
+	// Remove the sprite
+	void Remove( cSprite *sprite );
+	/* Move the sprite to the cells of its current rects
+	 * outside of the editor the grid only becomes invalid
+	*/
+	void Update( cSprite *sprite );
+	// Remove all sprites
+	void Clear( void );
+
+	// Returns true if the grid has the current sprite rects
+	inline bool Is_Valid( void ) const
+	{
+		return m_valid;
+	}
+
+	/* Add the sprites in the cells touched by the rect to the list
+	 * every sprite is only added once
+	 * the rects are not checked and the order is undefined
+	*/
+	void Get_Objects( Sprite_List &objects, const GL_rect &rect ) const;
+
+private:
+	// a cell position range
+	struct Cell_Range
+	{
+		int m_x1;
+		int m_y1;
+		int m_x2;
+		int m_y2;
+		// if touching too many cells
+		bool m_large;
+	};
+
+	// Returns the cells touched by the editor rects of the sprite
+	static Cell_Range Get_Range( const cSprite *sprite );
+	// Returns the cells touched by the rect
+	static Cell_Range Get_Range( float x1, float y1, float x2, float y2 );
+	// Returns the cell key
+	static Uint64 Get_Key( int x, int y );
+	// Add the sprite to the cells of the range
+	void Insert( cSprite *sprite, const Cell_Range &range );
+	// Remove the sprite from the cells of the range
+	void Erase( cSprite *sprite, const Cell_Range &range );
+
+	typedef boost::unordered_map<Uint64, Sprite_List> Cell_Map;
+	// cells with sprites
+	Cell_Map m_cells;
+	// sprites touching too many cells
+	Sprite_List m_large_sprites;
+
+	typedef boost::unordered_map<cSprite *, Cell_Range> Range_Map;
+	// cell range of every sprite
+	Range_Map m_ranges;
+
+	// if the sprite rects were not changed outside of the editor
+	bool m_valid;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
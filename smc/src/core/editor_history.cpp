@@ -0,0 +1,673 @@
+/***************************************************************************
+ * editor_history.cpp  -  editor undo and redo
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/editor_history.h"
+#include "../core/editor.h"
+#include "../core/editor_autosave.h"
+#include "../core/game_core.h"
+#include "../core/sprite_manager.h"
+#include "../core/xml_reader.h"
+#include "../input/mouse.h"
+#include "../objects/sprite.h"
+#include "../core/xml_writer.h"
+// std
+#include <sstream>
+
+namespace SMC
+{
+
+// maximum number of stored steps
+static const unsigned int editor_history_max_steps = 100;
+// maximum memory used by the stored records
+static const size_t editor_history_max_size = 4 * 1024 * 1024;
+
+/* *** *** *** *** *** *** Helpers *** *** *** *** *** *** *** *** *** *** *** */
+
+// Returns the key of the handle
+static inline Uint64 Get_Handle_Key( const cObject_Handle &handle )
+{
+	return ( static_cast<Uint64>(handle.m_slot) << 32 ) | handle.m_generation;
+}
+
+// Collects the element and properties of a serialized object
+class cEditor_History_Object_Reader : public cXML_Reader::Handler
+{
+public:
+	virtual void Element_Start( const cXML_Reader::View &name, const cXML_Reader::Attribute_List &attributes )
+	{
+		if( !name.Is( "property" ) )
+		{
+			// the object element
+			if( m_element.empty() )
+			{
+				m_element.assign( name.m_data, name.m_length );
+			}
+
+			return;
+		}
+
+		std::string property_name;
+		std::string property_value;
+
+		for( cXML_Reader::Attribute_List::const_iterator itr = attributes.begin(); itr != attributes.end(); ++itr )
+		{
+			if( itr->m_name.Is( "name" ) )
+			{
+				property_name = itr->Get_String();
+			}
+			else if( itr->m_name.Is( "value" ) )
+			{
+				property_value = itr->Get_String();
+			}
+		}
+
+		m_attributes.add( property_name, property_value );
+	}
+
+	virtual void Element_End( const cXML_Reader::View &name ) {}
+
+	std::string m_element;
+	CEGUI::XMLAttributes m_attributes;
+};
+
+/* *** *** *** *** *** *** cEditor_History *** *** *** *** *** *** *** *** *** *** *** */
+
+cEditor_History :: cEditor_History( void )
+{
+	m_sprite_manager = NULL;
+	m_position = 0;
+	m_size = 0;
+	m_step_depth = 0;
+	m_replaying = 0;
+	m_property_id = 0;
+	m_property_active = 0;
+	m_next_id = 1;
+}
+
+cEditor_History :: ~cEditor_History( void )
+{
+	Clear();
+}
+
+void cEditor_History :: Set_Sprite_Manager( cSprite_Manager *sprite_manager )
+{
+	if( m_sprite_manager == sprite_manager )
+	{
+		return;
+	}
+
+	// the records are only valid for the objects of the sprite manager
+	Clear();
+	m_sprite_manager = sprite_manager;
+}
+
+void cEditor_History :: Clear( void )
+{
+	m_steps.clear();
+	m_position = 0;
+	m_size = 0;
+
+	m_step.clear();
+	m_step_depth = 0;
+
+	m_moves.clear();
+	m_property_data.clear();
+	m_property_active = 0;
+
+	m_handles.clear();
+	m_ids.clear();
+	m_next_id = 1;
+}
+
+void cEditor_History :: Begin_Step( void )
+{
+	m_step_depth++;
+}
+
+void cEditor_History :: End_Step( void )
+{
+	if( !m_step_depth )
+	{
+		return;
+	}
+
+	m_step_depth--;
+
+	if( m_step_depth || m_step.empty() )
+	{
+		return;
+	}
+
+	// a new step removes the reverted steps
+	while( m_steps.size() > m_position )
+	{
+		m_size -= Get_Size( m_steps.back() );
+		m_steps.pop_back();
+	}
+
+	m_steps.push_back( Record_List() );
+	m_steps.back().swap( m_step );
+	m_size += Get_Size( m_steps.back() );
+	m_position++;
+
+	Limit();
+}
+
+void cEditor_History :: Add_Create( cSprite *sprite )
+{
+	if( m_replaying || !sprite || !sprite->Is_Sprite_Managed() )
+	{
+		return;
+	}
+
+	// the settings are only needed after it is undone
+	Record record;
+	record.m_type = RECORD_CREATE;
+	record.m_id = Get_Id( sprite );
+	Add( record );
+}
+
+void cEditor_History :: Add_Delete( cSprite *sprite )
+{
+	if( m_replaying || !sprite || !sprite->Is_Sprite_Managed() )
+	{
+		return;
+	}
+
+	Record record;
+	record.m_type = RECORD_DELETE;
+	record.m_data = Serialize( sprite );
+
+	// can not be created again
+	if( record.m_data.empty() )
+	{
+		debug_print( "Warning : Editor history could not save deleted object %s\n", sprite->m_name.c_str() );
+		return;
+	}
+
+	record.m_id = Get_Id( sprite );
+	Add( record );
+}
+
+void cEditor_History :: Add_Z_Change( cSprite *sprite, bool front )
+{
+	if( m_replaying || !sprite || !sprite->Is_Sprite_Managed() )
+	{
+		return;
+	}
+
+	Record record;
+	record.m_type = RECORD_Z_CHANGE;
+	record.m_id = Get_Id( sprite );
+	record.m_x = sprite->m_pos_z;
+	record.m_array_num = sprite->m_array_num;
+	record.m_front = front;
+	Add( record );
+}
+
+void cEditor_History :: Begin_Move( cSprite *sprite )
+{
+	if( m_replaying || !sprite )
+	{
+		return;
+	}
+
+	const unsigned int id = Get_Id( sprite );
+
+	// already moving
+	if( m_moves.find( id ) != m_moves.end() )
+	{
+		return;
+	}
+
+	// the settings changes before the move are a step of their own
+	if( m_property_active && m_property_id == id )
+	{
+		Update_Property( sprite );
+	}
+
+	m_moves[id] = GL_point( sprite->m_start_pos_x, sprite->m_start_pos_y );
+}
+
+void cEditor_History :: End_Move( void )
+{
+	if( m_moves.empty() )
+	{
+		return;
+	}
+
+	cSprite *property_sprite = NULL;
+
+	Begin_Step();
+
+	for( Move_Map::iterator itr = m_moves.begin(); itr != m_moves.end(); ++itr )
+	{
+		cSprite *sprite = Get_Sprite_By_Id( itr->first );
+
+		if( !sprite )
+		{
+			continue;
+		}
+
+		if( m_property_active && m_property_id == itr->first )
+		{
+			property_sprite = sprite;
+		}
+
+		Record record;
+		record.m_type = RECORD_MOVE;
+		record.m_id = itr->first;
+		record.m_x = sprite->m_start_pos_x - itr->second.m_x;
+		record.m_y = sprite->m_start_pos_y - itr->second.m_y;
+
+		// not moved
+		if( Is_Float_Equal( record.m_x, 0.0f ) && Is_Float_Equal( record.m_y, 0.0f ) )
+		{
+			continue;
+		}
+
+		Add( record );
+	}
+
+	End_Step();
+	m_moves.clear();
+
+	// the move is not a settings change
+	if( property_sprite )
+	{
+		m_property_data = Serialize( property_sprite );
+	}
+}
+
+void cEditor_History :: Begin_Property( cSprite *sprite )
+{
+	m_property_active = 0;
+	m_property_data.clear();
+
+	if( m_replaying || !sprite || !sprite->Is_Sprite_Managed() )
+	{
+		return;
+	}
+
+	m_property_data = Serialize( sprite );
+
+	if( m_property_data.empty() )
+	{
+		return;
+	}
+
+	m_property_id = Get_Id( sprite );
+	m_property_active = 1;
+}
+
+void cEditor_History :: End_Property( cSprite *sprite )
+{
+	if( !m_property_active )
+	{
+		return;
+	}
+
+	if( !m_replaying )
+	{
+		Update_Property( sprite );
+	}
+
+	m_property_active = 0;
+	m_property_data.clear();
+}
+
+bool cEditor_History :: Undo( cEditor *editor )
+{
+	Prepare_Replay();
+
+	if( !Can_Undo() )
+	{
+		return 0;
+	}
+
+	Record_List &step = m_steps[m_position - 1];
+	m_size -= Get_Size( step );
+	m_replaying = 1;
+
+	for( Record_List::reverse_iterator itr = step.rbegin(); itr != step.rend(); ++itr )
+	{
+		Replay( *itr, 1, editor );
+	}
+
+	m_replaying = 0;
+	m_size += Get_Size( step );
+	m_position--;
+
+	Limit();
+	return 1;
+}
+
+bool cEditor_History :: Redo( cEditor *editor )
+{
+	Prepare_Replay();
+
+	if( !Can_Redo() )
+	{
+		return 0;
+	}
+
+	Record_List &step = m_steps[m_position];
+	m_size -= Get_Size( step );
+	m_replaying = 1;
+
+	for( Record_List::iterator itr = step.begin(); itr != step.end(); ++itr )
+	{
+		Replay( *itr, 0, editor );
+	}
+
+	m_replaying = 0;
+	m_size += Get_Size( step );
+	m_position++;
+
+	Limit();
+	return 1;
+}
+
+void cEditor_History :: Add( const Record &record )
+{
+	pEditor_Autosave->Set_Changed( Get_Sprite_By_Id( record.m_id ) );
+
+	Begin_Step();
+	m_step.push_back( record );
+	End_Step();
+}
+
+void cEditor_History :: Limit( void )
+{
+	/* a single step over the memory limit is also removed
+	 * as the undone steps are removed from the end they are kept if possible
+	*/
+	while( !m_steps.empty() && ( m_steps.size() > editor_history_max_steps || m_size > editor_history_max_size ) )
+	{
+		// remove the oldest step
+		if( m_position > 0 )
+		{
+			m_size -= Get_Size( m_steps.front() );
+			m_steps.pop_front();
+			m_position--;
+		}
+		// remove the last undone step
+		else
+		{
+			m_size -= Get_Size( m_steps.back() );
+			m_steps.pop_back();
+		}
+	}
+}
+
+size_t cEditor_History :: Get_Size( const Record &record )
+{
+	return sizeof( Record ) + record.m_data.size() + record.m_new_data.size();
+}
+
+size_t cEditor_History :: Get_Size( const Record_List &records )
+{
+	size_t size = 0;
+
+	for( Record_List::const_iterator itr = records.begin(); itr != records.end(); ++itr )
+	{
+		size += Get_Size( *itr );
+	}
+
+	return size;
+}
+
+void cEditor_History :: Update_Property( cSprite *sprite )
+{
+	// the object was replaced
+	if( Get_Sprite_By_Id( m_property_id ) != sprite )
+	{
+		return;
+	}
+
+	std::string data = Serialize( sprite );
+
+	// not changed
+	if( data == m_property_data )
+	{
+		return;
+	}
+
+	Record record;
+	record.m_type = RECORD_PROPERTY;
+	record.m_id = m_property_id;
+	record.m_data = m_property_data;
+	record.m_new_data = data;
+	Add( record );
+
+	m_property_data.swap( data );
+}
+
+void cEditor_History :: Prepare_Replay( void )
+{
+	// add the pending settings change and move
+	pMouseCursor->Clear_Active_Object();
+	End_Move();
+
+	// the objects could be deleted
+	pMouseCursor->Clear_Hovered_Object();
+	pMouseCursor->Clear_Selected_Objects();
+}
+
+void cEditor_History :: Replay( Record &record, bool undo, cEditor *editor )
+{
+	// the replaced or deleted object
+	pEditor_Autosave->Set_Changed( Get_Sprite_By_Id( record.m_id ) );
+
+	switch( record.m_type )
+	{
+		case RECORD_CREATE:
+		case RECORD_DELETE:
+		{
+			// undo a create or redo a delete
+			if( ( record.m_type == RECORD_CREATE ) == undo )
+			{
+				cSprite *sprite = Get_Sprite_By_Id( record.m_id );
+
+				if( !sprite )
+				{
+					break;
+				}
+
+				// save it for the redo
+				if( record.m_type == RECORD_CREATE )
+				{
+					record.m_data = Serialize( sprite );
+				}
+
+				Delete( sprite );
+			}
+			else
+			{
+				Create( record.m_id, record.m_data, editor );
+
+				// not needed until it is undone again
+				if( record.m_type == RECORD_CREATE )
+				{
+					std::string().swap( record.m_data );
+				}
+			}
+			break;
+		}
+		case RECORD_MOVE:
+		{
+			cSprite *sprite = Get_Sprite_By_Id( record.m_id );
+
+			if( !sprite )
+			{
+				break;
+			}
+
+			if( undo )
+			{
+				sprite->Set_Pos( sprite->m_start_pos_x - record.m_x, sprite->m_start_pos_y - record.m_y, 1 );
+			}
+			else
+			{
+				sprite->Set_Pos( sprite->m_start_pos_x + record.m_x, sprite->m_start_pos_y + record.m_y, 1 );
+			}
+			break;
+		}
+		case RECORD_PROPERTY:
+		{
+			cSprite *sprite = Get_Sprite_By_Id( record.m_id );
+
+			if( !sprite )
+			{
+				break;
+			}
+
+			// the settings can change the object type so it is created again
+			Delete( sprite );
+			Create( record.m_id, undo ? record.m_data : record.m_new_data, editor );
+			break;
+		}
+		case RECORD_Z_CHANGE:
+		{
+			cSprite *sprite = Get_Sprite_By_Id( record.m_id );
+
+			if( !sprite || !sprite->Is_Sprite_Managed() )
+			{
+				break;
+			}
+
+			if( undo )
+			{
+				editor->m_sprite_manager->Move_To_Array_Num( sprite, record.m_array_num, record.m_x );
+			}
+			else if( record.m_front )
+			{
+				editor->m_sprite_manager->Move_To_Front( sprite );
+			}
+			else
+			{
+				editor->m_sprite_manager->Move_To_Back( sprite );
+			}
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+
+	// the changed or created object
+	pEditor_Autosave->Set_Changed( Get_Sprite_By_Id( record.m_id ) );
+}
+
+unsigned int cEditor_History :: Get_Id( const cSprite *sprite )
+{
+	const Uint64 key = Get_Handle_Key( sprite->m_handle );
+	Id_Map::const_iterator itr = m_ids.find( key );
+
+	if( itr != m_ids.end() )
+	{
+		return itr->second;
+	}
+
+	const unsigned int id = m_next_id++;
+	m_ids[key] = id;
+	m_handles[id] = sprite->m_handle;
+
+	return id;
+}
+
+cSprite *cEditor_History :: Get_Sprite_By_Id( unsigned int id ) const
+{
+	Handle_Map::const_iterator itr = m_handles.find( id );
+
+	if( itr == m_handles.end() )
+	{
+		return NULL;
+	}
+
+	cSprite *sprite = Get_Sprite( itr->second );
+
+	// deleted at the end of the frame
+	if( !sprite || sprite->m_auto_destroy )
+	{
+		return NULL;
+	}
+
+	return sprite;
+}
+
+std::string cEditor_History :: Serialize( cSprite *sprite )
+{
+	cXml_Writer stream;
+	sprite->Save_To_XML( stream );
+
+	return stream.Get_Data();
+}
+
+cSprite *cEditor_History :: Create_Object( const std::string &data, cEditor *editor )
+{
+	cEditor_History_Object_Reader handler;
+	cXML_Reader reader;
+
+	if( data.empty() || !reader.Parse( data.data(), data.length(), "editor history object", handler ) || handler.m_element.empty() )
+	{
+		return NULL;
+	}
+
+	cSprite *sprite = editor->Get_Object( handler.m_element, handler.m_attributes, level_engine_version );
+
+	if( !sprite )
+	{
+		printf( "Warning : Editor history could not create object %s\n", handler.m_element.c_str() );
+		return NULL;
+	}
+
+	editor->m_sprite_manager->Add( sprite );
+
+	return sprite;
+}
+
+cSprite *cEditor_History :: Create( unsigned int id, const std::string &data, cEditor *editor )
+{
+	cSprite *sprite = Create_Object( data, editor );
+
+	if( !sprite )
+	{
+		return NULL;
+	}
+
+	// the records of the previous object now use the new one
+	Handle_Map::iterator itr = m_handles.find( id );
+
+	if( itr != m_handles.end() )
+	{
+		m_ids.erase( Get_Handle_Key( itr->second ) );
+	}
+
+	m_handles[id] = sprite->m_handle;
+	m_ids[Get_Handle_Key( sprite->m_handle )] = id;
+
+	return sprite;
+}
+
+void cEditor_History :: Delete( cSprite *sprite )
+{
+	pMouseCursor->Delete( sprite );
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,218 @@
+/***************************************************************************
+ * editor_history.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_EDITOR_HISTORY_H
+#define SMC_EDITOR_HISTORY_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../core/obj_manager.h"
+#include "../core/math/point.h"
+// boost
+#include <boost/unordered_map.hpp>
+// std
+#include <deque>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** cEditor_History *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Undo and redo of the editor object changes
+ * every change is stored as a small operation record which is reverted or applied again
+ * instead of saving the level state :
+ * created, deleted and changed objects store their serialized settings
+ * and moved and z order changed objects only their position change
+ * records use their own object numbers which stay valid when an object is created again
+ * the oldest steps are removed if too many are stored or they use too much memory
+*/
+class cEditor_History
+{
+public:
+	cEditor_History( void );
+	~cEditor_History( void );
+
+	// Set the sprite manager of the objects and clear the steps if it changed
+	void Set_Sprite_Manager( cSprite_Manager *sprite_manager );
+	// Remove all steps
+	void Clear( void );
+
+	/* Start a step which combines all following records until it is ended
+	 * steps can be nested and records outside of a step are a step of their own
+	*/
+	void Begin_Step( void );
+	// End the step
+	void End_Step( void );
+
+	// Add that the object was created
+	void Add_Create( cSprite *sprite );
+	// Add that the object will be deleted
+	void Add_Delete( cSprite *sprite );
+	// Add that the object will be moved to the front or back of the sprite manager array
+	void Add_Z_Change( cSprite *sprite, bool front );
+
+	/* Remember the start position of an object moved by the mouse
+	 * only the first call before End_Move is used
+	*/
+	void Begin_Move( cSprite *sprite );
+	// Add the moved objects as one step
+	void End_Move( void );
+
+	// Remember the object settings when its settings are activated
+	void Begin_Property( cSprite *sprite );
+	// Add the changed settings when its settings are deactivated
+	void End_Property( cSprite *sprite );
+
+	/* Revert the last step
+	 * editor : creates the deleted objects again
+	 * returns false if nothing could be undone
+	*/
+	bool Undo( cEditor *editor );
+	/* Apply the last reverted step again
+	 * editor : creates the deleted objects again
+	 * returns false if nothing could be redone
+	*/
+	bool Redo( cEditor *editor );
+
+	// Returns true if a step can be reverted
+	inline bool Can_Undo( void ) const
+	{
+		return m_position > 0;
+	}
+	// Returns true if a reverted step can be applied again
+	inline bool Can_Redo( void ) const
+	{
+		return m_position < m_steps.size();
+	}
+
+	// Returns the serialized object settings or an empty string if it has none
+	static std::string Serialize( cSprite *sprite );
+	/* Create the object from the serialized settings and add it to the editor sprite manager
+	 * returns NULL if it could not be created
+	*/
+	static cSprite *Create_Object( const std::string &data, cEditor *editor );
+
+private:
+	enum Record_Type
+	{
+		RECORD_CREATE,
+		RECORD_DELETE,
+		RECORD_MOVE,
+		RECORD_PROPERTY,
+		RECORD_Z_CHANGE
+	};
+
+	// a single object change
+	struct Record
+	{
+		Record( void )
+		{
+			m_type = RECORD_CREATE;
+			m_id = 0;
+			m_x = 0.0f;
+			m_y = 0.0f;
+			m_array_num = 0;
+			m_front = 0;
+		}
+
+		Record_Type m_type;
+		// history object number
+		unsigned int m_id;
+		// moved distance or the previous z position in m_x
+		float m_x;
+		float m_y;
+		// previous array number of a z change
+		int m_array_num;
+		// if a z change moved to the front
+		bool m_front;
+		// object settings of a created or deleted object or the previous settings
+		std::string m_data;
+		// changed settings
+		std::string m_new_data;
+	};
+
+	typedef vector<Record> Record_List;
+
+	// Add the record to the current step
+	void Add( const Record &record );
+	// Remove the oldest steps while over the limits
+	void Limit( void );
+	// Returns the memory used by the record
+	static size_t Get_Size( const Record &record );
+	// Returns the memory used by the records
+	static size_t Get_Size( const Record_List &records );
+	// Add the settings changed since they were remembered and remember the current settings
+	void Update_Property( cSprite *sprite );
+
+	// Finish the pending user changes and clear the mouse selection before replaying records
+	void Prepare_Replay( void );
+	// Revert or apply the record again
+	void Replay( Record &record, bool undo, cEditor *editor );
+
+	// Returns the history number of the object
+	unsigned int Get_Id( const cSprite *sprite );
+	/* Returns the object with the history number
+	 * returns NULL if it was deleted
+	*/
+	cSprite *Get_Sprite_By_Id( unsigned int id ) const;
+	/* Create the object from the serialized settings and give it the history number
+	 * returns NULL if it could not be created
+	*/
+	cSprite *Create( unsigned int id, const std::string &data, cEditor *editor );
+	// Delete the object like the editor
+	void Delete( cSprite *sprite );
+
+	// sprite manager of the objects
+	cSprite_Manager *m_sprite_manager;
+
+	// stored steps with the reverted steps after the position
+	std::deque<Record_List> m_steps;
+	// number of steps which can be reverted
+	unsigned int m_position;
+	// memory used by all records
+	size_t m_size;
+
+	// records of the current step
+	Record_List m_step;
+	// nesting depth of the current step
+	unsigned int m_step_depth;
+	// if records are replayed and changes are not recorded
+	bool m_replaying;
+
+	// start positions of the objects moved by the mouse
+	typedef boost::unordered_map<unsigned int, GL_point> Move_Map;
+	Move_Map m_moves;
+
+	// settings of the object with activated settings
+	std::string m_property_data;
+	// history number of the object with activated settings
+	unsigned int m_property_id;
+	bool m_property_active;
+
+	// object handles by history number
+	typedef boost::unordered_map<unsigned int, cObject_Handle> Handle_Map;
+	Handle_Map m_handles;
+	// history numbers by handle
+	typedef boost::unordered_map<Uint64, unsigned int> Id_Map;
+	Id_Map m_ids;
+	// next history number
+	unsigned int m_next_id;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
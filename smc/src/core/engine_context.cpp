@@ -0,0 +1,42 @@
+/***************************************************************************
+ * engine_context.cpp  -  objects used by a level simulation
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/engine_context.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cEngine_Context *** *** *** *** *** *** *** *** *** *** */
+
+cEngine_Context :: cEngine_Context( void )
+{
+	m_level = NULL;
+	m_camera = NULL;
+	m_player = NULL;
+	m_level_player = NULL;
+	m_renderer = NULL;
+	m_framerate = NULL;
+	m_animation_manager = NULL;
+	m_hud_manager = NULL;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+static cEngine_Context default_engine_context;
+cEngine_Context *pDefault_Engine_Context = &default_engine_context;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,112 @@
+/***************************************************************************
+ * engine_context.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_ENGINE_CONTEXT_H
+#define SMC_ENGINE_CONTEXT_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** Globals *** *** *** *** *** *** *** *** *** *** */
+
+// the objects of the default context declared with their classes
+extern cLevel *pActive_Level;
+extern cCamera *pActive_Camera;
+extern cSprite *pActive_Player;
+extern cLevel_Player *pLevel_Player;
+extern cRenderQueue *pRenderer;
+extern cFramerate *pFramerate;
+extern cAnimation_Manager *pActive_Animation_Manager;
+extern cHud_Manager *pHud_Manager;
+
+/* *** *** *** *** *** *** *** cEngine_Context *** *** *** *** *** *** *** *** *** *** */
+
+/* The objects a level simulation uses
+ * every sprite manager has a context which its sprites get with Get_Context
+ * an unset object falls back to the global object
+ * so the default context with nothing set is the same as using the globals
+ * and a simulation can set its own objects to run besides others
+*/
+class cEngine_Context
+{
+public:
+	cEngine_Context( void );
+
+	// Returns the level
+	inline cLevel *Get_Level( void ) const
+	{
+		return m_level ? m_level : pActive_Level;
+	}
+	// Returns the camera
+	inline cCamera *Get_Camera( void ) const
+	{
+		return m_camera ? m_camera : pActive_Camera;
+	}
+	// Returns the player sprite
+	inline cSprite *Get_Player( void ) const
+	{
+		return m_player ? m_player : pActive_Player;
+	}
+	// Returns the level player
+	inline cLevel_Player *Get_Level_Player( void ) const
+	{
+		return m_level_player ? m_level_player : pLevel_Player;
+	}
+	// Returns the render queue
+	inline cRenderQueue *Get_Renderer( void ) const
+	{
+		return m_renderer ? m_renderer : pRenderer;
+	}
+	// Returns the framerate
+	inline cFramerate *Get_Framerate( void ) const
+	{
+		return m_framerate ? m_framerate : pFramerate;
+	}
+	// Returns the animation manager
+	inline cAnimation_Manager *Get_Animation_Manager( void ) const
+	{
+		return m_animation_manager ? m_animation_manager : pActive_Animation_Manager;
+	}
+	// Returns the hud manager
+	inline cHud_Manager *Get_Hud_Manager( void ) const
+	{
+		return m_hud_manager ? m_hud_manager : pHud_Manager;
+	}
+
+	/* own objects of the context
+	 * if not set the global object is used
+	 * the context does not delete them
+	*/
+	cLevel *m_level;
+	cCamera *m_camera;
+	cSprite *m_player;
+	cLevel_Player *m_level_player;
+	cRenderQueue *m_renderer;
+	cFramerate *m_framerate;
+	cAnimation_Manager *m_animation_manager;
+	cHud_Manager *m_hud_manager;
+};
+
+// The default context using the global objects
+extern cEngine_Context *pDefault_Engine_Context;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
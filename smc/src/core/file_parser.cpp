@@ -16,11 +16,110 @@
 #include "../core/global_basic.h"
 #include "../core/file_parser.h"
 #include "../core/game_core.h"
+#include "../core/filesystem/filesystem.h"
 #include <cstdio>
+#include <cstring>
+#include <cmath>
 
 namespace SMC
 {
 
+/* *** *** *** *** *** *** *** *** cFile_Token *** *** *** *** *** *** *** *** *** */
+
+bool cFile_Token :: Equals( const char *str ) const
+{
+	return strncmp( m_data, str, m_length ) == 0 && str[m_length] == '\0';
+}
+
+bool cFile_Token :: Is_Number( void ) const
+{
+	unsigned int pos = 0;
+
+	// accept negative numbers
+	if( m_length && m_data[0] == '-' )
+	{
+		pos++;
+	}
+
+	bool point = 0;
+
+	for( ; pos < m_length; pos++ )
+	{
+		// accept one point
+		if( m_data[pos] == '.' && !point )
+		{
+			point = 1;
+		}
+		else if( m_data[pos] < '0' || m_data[pos] > '9' )
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+int cFile_Token :: To_Int( void ) const
+{
+	unsigned int pos = 0;
+	bool negative = 0;
+
+	if( m_length && ( m_data[0] == '-' || m_data[0] == '+' ) )
+	{
+		negative = m_data[0] == '-';
+		pos++;
+	}
+
+	int num = 0;
+
+	for( ; pos < m_length && m_data[pos] >= '0' && m_data[pos] <= '9'; pos++ )
+	{
+		num = num * 10 + ( m_data[pos] - '0' );
+	}
+
+	return negative ? -num : num;
+}
+
+float cFile_Token :: To_Float( void ) const
+{
+	unsigned int pos = 0;
+	bool negative = 0;
+
+	if( m_length && ( m_data[0] == '-' || m_data[0] == '+' ) )
+	{
+		negative = m_data[0] == '-';
+		pos++;
+	}
+
+	double num = 0.0;
+
+	for( ; pos < m_length && m_data[pos] >= '0' && m_data[pos] <= '9'; pos++ )
+	{
+		num = num * 10.0 + ( m_data[pos] - '0' );
+	}
+
+	// fraction
+	if( pos < m_length && m_data[pos] == '.' )
+	{
+		double scale = 0.1;
+
+		for( pos++; pos < m_length && m_data[pos] >= '0' && m_data[pos] <= '9'; pos++ )
+		{
+			num += ( m_data[pos] - '0' ) * scale;
+			scale *= 0.1;
+		}
+	}
+
+	// exponent
+	if( pos + 1 < m_length && ( m_data[pos] == 'e' || m_data[pos] == 'E' ) )
+	{
+		const int exponent = cFile_Token( m_data + pos + 1, m_length - pos - 1 ).To_Int();
+		num *= pow( 10.0, exponent );
+	}
+
+	return static_cast<float>( negative ? -num : num );
+}
+
 /* *** *** *** *** *** *** *** *** cFile_parser *** *** *** *** *** *** *** *** *** */
 
 cFile_parser :: cFile_parser( void )
@@ -35,89 +134,104 @@ cFile_parser :: ~cFile_parser( void )
 
 bool cFile_parser :: Parse( const std::string &filename )
 {
-	ifstream ifs( filename.c_str(), ios::in );
-	
-	if( !ifs )
+	// also reads from the resource archive
+	cMapped_File file;
+
+	if( !file.Open( filename ) )
 	{
+		// empty files are valid
+		if( File_Exists( filename ) )
+		{
+			data_file = filename;
+			return 1;
+		}
+
 		printf( "Could not load data file : %s\n", filename.c_str() );
 		return 0;
 	}
 
 	data_file = filename;
 
-	std::string line;
+	const char *pos = file.Get_Data();
+	const char *end = pos + file.Get_Size();
 	unsigned int line_num = 0;
 
-	while( std::getline( ifs, line ) )
+	while( pos < end )
 	{
+		const char *line_end = static_cast<const char *>(memchr( pos, '\n', end - pos ));
+
+		if( !line_end )
+		{
+			line_end = end;
+		}
+
 		line_num++;
-		Parse_Line( line, line_num );
+		Tokenize_Line( pos, line_end, line_num );
+
+		pos = line_end + 1;
 	}
 
 	return 1;
 }
 
-bool cFile_parser :: Parse_Line( std::string str_line, int line_num )
+bool cFile_parser :: Parse_Line( const std::string &str_line, int line_num )
+{
+	return Tokenize_Line( str_line.data(), str_line.data() + str_line.length(), line_num );
+}
+
+bool cFile_parser :: Tokenize_Line( const char *start, const char *end, unsigned int line_num )
 {
-	if( str_line.empty() )
+	// remove beginning and trailing spaces, tabs and windows line ends
+	while( start < end && ( *start == ' ' || *start == '\t' || *start == '\r' ) )
 	{
-		return 1;
+		start++;
+	}
+	while( end > start && ( *( end - 1 ) == ' ' || *( end - 1 ) == '\t' || *( end - 1 ) == '\r' ) )
+	{
+		end--;
 	}
-
-	// linux support
-	string_erase_all( str_line, '\r' );
-	// no tabs
-	string_replace_all( str_line, "\t", " " );
-	// remove beginning spaces
-	string_trim_from_begin( str_line, ' ' );
-	// remove trailing spaces
-	string_trim_from_end( str_line, ' ' );
 
 	// ignore empty lines and comments
-	if( str_line.empty() || *str_line.begin() == '#' )
+	if( start == end || *start == '#' )
 	{
 		// no error
 		return 1;
 	}
 
-	std::string tempstr = str_line;
-	int count = 1;
+	m_tokens.clear();
+
+	// every space or tab separates a token
+	const char *token_start = start;
 
-	// count spaces
-	while( tempstr.find( ' ' ) != std::string::npos  )
+	for( const char *pos = start; pos < end; pos++ )
 	{
-		tempstr.erase( tempstr.find( ' ' ) , 1 );
-		count++;
+		if( *pos == ' ' || *pos == '\t' )
+		{
+			m_tokens.push_back( cFile_Token( token_start, static_cast<unsigned int>( pos - token_start ) ) );
+			token_start = pos + 1;
+		}
 	}
 
-	tempstr = str_line;
-	
-	std::string *parts = new std::string[ count + 1 ];
-	
-	std::string::size_type len;
-	int part_count = 0;
+	m_tokens.push_back( cFile_Token( token_start, static_cast<unsigned int>( end - token_start ) ) );
 
-	while( count > 0 )
-	{
-		// get length of the part
-		len = tempstr.find_first_of( ' ' );
-		// create part
-		parts[part_count] = tempstr.substr( 0, len );
-		// remove part from temp string
-		tempstr.erase( 0, len + 1 );
-
-		part_count++;
-		count--;
-	}
+	const unsigned int count = m_tokens.size();
+	// empty last token
+	m_tokens.push_back( cFile_Token( end, 0 ) );
 
-	parts[part_count] = tempstr;
+	return Handle_Tokens( &m_tokens[0], count, line_num );
+}
 
-	// Message handler
-	bool success = HandleMessage( parts, part_count, line_num );
+bool cFile_parser :: Handle_Tokens( const cFile_Token *tokens, unsigned int count, unsigned int line )
+{
+	// the strings keep their memory for the next lines
+	m_parts.resize( count + 1 );
 
-	delete []parts;
+	for( unsigned int i = 0; i <= count; i++ )
+	{
+		m_parts[i].assign( tokens[i].m_data, tokens[i].m_length );
+	}
 
-	return success;
+	return HandleMessage( &m_parts[0], count, line );
 }
 
 bool cFile_parser :: HandleMessage( const std::string *parts, unsigned int count, unsigned int line )
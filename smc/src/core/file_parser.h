@@ -21,9 +21,45 @@
 namespace SMC
 {
 
+/* *** *** *** *** *** *** *** *** cFile_Token *** *** *** *** *** *** *** *** *** */
+
+/* Part of a tokenized line pointing into the line data
+ * it is not null-terminated and only valid while the line is handled
+*/
+class cFile_Token
+{
+public:
+	cFile_Token( void )
+	: m_data( NULL ), m_length( 0 ) {}
+	cFile_Token( const char *data, unsigned int length )
+	: m_data( data ), m_length( length ) {}
+
+	// Returns true if the token is the given string
+	bool Equals( const char *str ) const;
+	// Returns true if the token is a valid number like Is_Valid_Number
+	bool Is_Number( void ) const;
+	// Returns the leading integer like string_to_int
+	int To_Int( void ) const;
+	// Returns the leading number like string_to_float
+	float To_Float( void ) const;
+
+	// Returns the token as string
+	inline std::string To_String( void ) const
+	{
+		return std::string( m_data, m_length );
+	}
+
+	const char *m_data;
+	unsigned int m_length;
+};
+
 /* *** *** *** *** *** *** *** *** cFile_parser *** *** *** *** *** *** *** *** *** */
 
-// Base class for parsing text files
+/* Base class for parsing text files
+ * the file is mapped and each line is split into tokens pointing into the file data
+ * a parser can handle the tokens directly without creating strings
+ * or the strings of the tokens with HandleMessage
+*/
 class cFile_parser
 {
 public:
@@ -34,13 +70,27 @@ public:
 	bool Parse( const std::string &filename );
 
 	// Tokenize a line
-	bool Parse_Line( std::string str_line, int line_num );
+	bool Parse_Line( const std::string &str_line, int line_num );
 
+	/* Handle one tokenized line
+	 * tokens[count] is an empty token
+	 * calls HandleMessage with the token strings if not overridden
+	*/
+	virtual bool Handle_Tokens( const cFile_Token *tokens, unsigned int count, unsigned int line );
 	// Handle one tokenized line
 	virtual bool HandleMessage( const std::string *parts, unsigned int count, unsigned int line );
 
 	// data filename
 	std::string data_file;
+
+private:
+	// Tokenize the line from start to end
+	bool Tokenize_Line( const char *start, const char *end, unsigned int line_num );
+
+	// tokens of the current line which are reused for every line
+	vector<cFile_Token> m_tokens;
+	// token strings for HandleMessage
+	vector<std::string> m_parts;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
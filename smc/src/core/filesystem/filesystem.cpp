@@ -14,16 +14,28 @@
 */
 
 #include "../../core/filesystem/filesystem.h"
+#include "../../core/filesystem/resource_manager.h"
+#include "../../core/filesystem/resource_archive.h"
 #include "../../core/game_core.h"
 // boost filesystem
 #include "boost/filesystem/convenience.hpp"
 namespace fs = boost::filesystem;
+// boost
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
+// zlib
+#include <zlib.h>
 // needed for the stat function and to get the user directory on unix
 #include <sys/stat.h>
 #include <sys/types.h>
 #if _WIN32
 	// needed to get the user directory (SHGetFolderPath)
 	#include <shlobj.h>
+#else
+	// needed to map files
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
 #endif
 
 namespace SMC
@@ -40,7 +52,16 @@ std::string Trim_Filename( std::string filename, bool keep_dir /* = 1 */, bool k
 
 	if( !keep_end && filename.rfind( "." ) != std::string::npos ) 
 	{
-		filename.erase( filename.rfind( "." ) );
+		// the compressed file type belongs to the file type
+		if( Is_Compressed_File( filename ) )
+		{
+			filename.erase( filename.length() - strlen( COMPRESSED_FILE_TYPE ) );
+		}
+
+		if( filename.rfind( "." ) != std::string::npos )
+		{
+			filename.erase( filename.rfind( "." ) );
+		}
 	}
 
 	return filename;
@@ -48,6 +69,11 @@ std::string Trim_Filename( std::string filename, bool keep_dir /* = 1 */, bool k
 
 bool File_Exists( const std::string &filename )
 {
+	if( pResource_Archive && pResource_Archive->Exists( filename ) )
+	{
+		return 1;
+	}
+
 // fixme : boost should use a codecvt_facet but for now we convert to UCS-2
 #ifdef _WIN32
 	fs::file_type type = fs::status( fs::path( utf8_to_ucs2( filename ) ) ).type();
@@ -60,6 +86,11 @@ bool File_Exists( const std::string &filename )
 
 bool Dir_Exists( const std::string &dir )
 {
+	if( pResource_Archive && pResource_Archive->Dir_Exists( dir ) )
+	{
+		return 1;
+	}
+
 // fixme : boost should use a codecvt_facet but for now we convert to UCS-2
 #ifdef _WIN32
 	fs::file_type type = fs::status( fs::path( utf8_to_ucs2( dir ) ) ).type();
@@ -74,10 +105,18 @@ bool Delete_File( const std::string &filename )
 {
 // fixme : boost should use a codecvt_facet but for now we convert to UCS-2
 #ifdef _WIN32
-	return DeleteFile( utf8_to_ucs2( filename ).c_str() ) != 0;
+	const bool success = DeleteFile( utf8_to_ucs2( filename ).c_str() ) != 0;
 #else
-	return remove( filename.c_str() ) == 0;
+	const bool success = remove( filename.c_str() ) == 0;
 #endif
+
+	// the cached file existence is outdated
+	if( pResource_Manager )
+	{
+		pResource_Manager->Reset_File_Cache( filename );
+	}
+
+	return success;
 }
 
 bool Delete_Dir( const std::string &dir )
@@ -104,10 +143,19 @@ bool Rename_File( const std::string &old_filename, const std::string &new_filena
 {
 // fixme : boost should use a codecvt_facet but for now we convert to UCS-2
 #ifdef _WIN32
-	return MoveFileEx( utf8_to_ucs2( old_filename ).c_str(), utf8_to_ucs2( new_filename ).c_str(), MOVEFILE_REPLACE_EXISTING ) != 0;
+	const bool success = MoveFileEx( utf8_to_ucs2( old_filename ).c_str(), utf8_to_ucs2( new_filename ).c_str(), MOVEFILE_REPLACE_EXISTING ) != 0;
 #else
-	return rename( old_filename.c_str(), new_filename.c_str() ) == 0;
+	const bool success = rename( old_filename.c_str(), new_filename.c_str() ) == 0;
 #endif
+
+	// the cached file existence is outdated
+	if( pResource_Manager )
+	{
+		pResource_Manager->Reset_File_Cache( old_filename );
+		pResource_Manager->Reset_File_Cache( new_filename );
+	}
+
+	return success;
 }
 
 bool Create_Directory( const std::string &dir )
@@ -137,6 +185,14 @@ bool Create_Directories( const std::string &dir )
 
 size_t Get_File_Size( const std::string &filename )
 {
+	const char *data;
+	size_t size;
+
+	if( pResource_Archive && pResource_Archive->Get_File( filename, data, size ) )
+	{
+		return size;
+	}
+
 	struct stat file_info; 
 
 	// if file exists
@@ -157,6 +213,24 @@ size_t Get_File_Size( const std::string &filename )
 	return 0;
 }
 
+time_t Get_File_Modification_Time( const std::string &filename )
+{
+	if( pResource_Archive && pResource_Archive->Exists( filename ) )
+	{
+		return pResource_Archive->Get_Modification_Time();
+	}
+
+	struct stat file_info;
+
+	// if file exists
+	if( stat( filename.c_str(), &file_info ) == 0 )
+	{
+		return file_info.st_mtime;
+	}
+
+	return 0;
+}
+
 void Convert_Path_Separators( std::string &str )
 {
 	for( std::string::iterator itr = str.begin(); itr != str.end(); ++itr )
@@ -169,9 +243,44 @@ void Convert_Path_Separators( std::string &str )
 	}
 }
 
-vector<std::string> Get_Directory_Files( const std::string &dir, const std::string &file_type /* = "" */, bool with_directories /* = 0 */, bool search_in_sub_directories /* = 1 */ )
+// Cached entries of a loose directory
+struct Directory_Listing
 {
-	vector<std::string> valid_files;
+	// modification time of the directory when it was read
+	time_t m_modified;
+	// entry names and if they are directories
+	vector<std::pair<std::string, bool> > m_entries;
+};
+
+typedef boost::unordered_map<std::string, Directory_Listing> Directory_Listing_Map;
+// listings by directory
+static Directory_Listing_Map directory_listings;
+// protects the listings as directories are scanned from the init tasks
+static boost::mutex directory_listings_mutex;
+
+/* Get the cached entries of the directory
+ * adding or removing an entry changes the directory modification time which invalidates it
+ * the listings mutex must be locked
+*/
+static const Directory_Listing &Get_Directory_Listing( const std::string &dir )
+{
+	struct stat dir_info;
+	const time_t modified = stat( dir.c_str(), &dir_info ) == 0 ? dir_info.st_mtime : 0;
+
+	Directory_Listing_Map::iterator itr = directory_listings.find( dir );
+
+	if( itr != directory_listings.end() && itr->second.m_modified == modified && modified )
+	{
+		return itr->second;
+	}
+
+	Directory_Listing &listing = directory_listings[dir];
+	listing.m_entries.clear();
+
+	/* a directory changed in the same second could change again unnoticed
+	 * so it is read again the next time
+	*/
+	listing.m_modified = modified < time( NULL ) ? modified : 0;
 
 // fixme : boost should use a codecvt_facet but for now we convert to UCS-2
 #ifdef _WIN32
@@ -181,49 +290,98 @@ vector<std::string> Get_Directory_Files( const std::string &dir, const std::stri
 #endif
 	fs::directory_iterator end_iter;
 
-	// load all available objects
 	for( fs::directory_iterator dir_itr( full_path ); dir_itr != end_iter; ++dir_itr )
 	{
 		try
 		{
-			const std::string filename_str = dir_itr->path().filename().string();
+			listing.m_entries.push_back( std::make_pair( dir_itr->path().filename().string(), fs::is_directory( *dir_itr ) ) );
+		}
+		catch( const std::exception &ex )
+		{
+			printf( "%s %s\n", dir_itr->path().string().c_str(), ex.what() );
+		}
+	}
+
+	return listing;
+}
+
+// Get the loose files from the directory
+static void Get_Loose_Directory_Files( const std::string &dir, const std::string &file_type, bool with_directories, bool search_in_sub_directories, vector<std::string> &valid_files )
+{
+	// copied as reading a sub-directory can rehash the listings
+	const vector<std::pair<std::string, bool> > entries = Get_Directory_Listing( dir ).m_entries;
 
-			// if directory
-			if( fs::is_directory( *dir_itr ) )
+	for( vector<std::pair<std::string, bool> >::const_iterator itr = entries.begin(); itr != entries.end(); ++itr )
+	{
+		const std::string &filename_str = itr->first;
+
+		// if directory
+		if( itr->second )
+		{
+			// ignore hidden directories
+			if( filename_str.find( "." ) == 0 )
 			{
-				// ignore hidden directories
-				if( filename_str.find( "." ) == 0 )
-				{
-					continue;
-				}
-
-				if( with_directories )
-				{
-					valid_files.push_back( dir + "/" + filename_str );
-				}
-
-				// load all items from the sub-directory
-				if( search_in_sub_directories )
-				{
-					vector<std::string> new_valid_files = Get_Directory_Files( dir + "/" + filename_str, file_type, with_directories );
-					valid_files.insert( valid_files.end(), new_valid_files.begin(), new_valid_files.end() );
-				}
+				continue;
 			}
-			// valid file
-			else if( file_type.empty() || filename_str.rfind( file_type ) != std::string::npos )
+
+			if( with_directories )
 			{
 				valid_files.push_back( dir + "/" + filename_str );
 			}
+
+			// load all items from the sub-directory
+			if( search_in_sub_directories )
+			{
+				Get_Loose_Directory_Files( dir + "/" + filename_str, file_type, with_directories, 1, valid_files );
+			}
 		}
-		catch( const std::exception &ex )
+		// valid file
+		else if( file_type.empty() || filename_str.rfind( file_type ) != std::string::npos )
 		{
-			printf( "%s %s\n", dir_itr->path().string().c_str(), ex.what() );
+			valid_files.push_back( dir + "/" + filename_str );
 		}
 	}
+}
+
+vector<std::string> Get_Directory_Files( const std::string &dir, const std::string &file_type /* = "" */, bool with_directories /* = 0 */, bool search_in_sub_directories /* = 1 */ )
+{
+	vector<std::string> valid_files;
+
+// fixme : boost should use a codecvt_facet but for now we convert to UCS-2
+#ifdef _WIN32
+	const bool loose_dir = fs::is_directory( fs::path( utf8_to_ucs2( dir ) ) );
+#else
+	const bool loose_dir = fs::is_directory( fs::path( dir ) );
+#endif
+
+	// the data directory can be only packed
+	if( loose_dir )
+	{
+		boost::mutex::scoped_lock lock( directory_listings_mutex );
+		Get_Loose_Directory_Files( dir, file_type, with_directories, search_in_sub_directories, valid_files );
+	}
+
+	if( pResource_Archive )
+	{
+		pResource_Archive->Get_Directory_Files( dir, file_type, with_directories, search_in_sub_directories, valid_files );
+	}
 
 	return valid_files;
 }
 
+SDL_RWops *Open_File_RW( const std::string &filename )
+{
+	const char *data;
+	size_t size;
+
+	if( pResource_Archive && pResource_Archive->Get_File( filename, data, size ) )
+	{
+		return SDL_RWFromConstMem( data, static_cast<int>(size) );
+	}
+
+	return SDL_RWFromFile( filename.c_str(), "rb" );
+}
+
 std::string Get_Temp_Directory( void )
 {
 #ifdef _WIN32
@@ -276,6 +434,400 @@ std::string Get_User_Directory( void )
 #endif
 }
 
+Uint64 Get_Data_Hash( const char *data, size_t size, Uint64 hash /* = 0 */ )
+{
+	if( !hash )
+	{
+		hash = 14695981039346656037ULL;
+	}
+
+	for( size_t i = 0; i < size; i++ )
+	{
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 1099511628211ULL;
+	}
+
+	if( !hash )
+	{
+		hash = 1;
+	}
+
+	return hash;
+}
+
+Uint64 Get_File_Hash( const std::string &filename )
+{
+	cMapped_File file;
+
+	if( !file.Open( filename ) )
+	{
+		return 0;
+	}
+
+	return Get_Data_Hash( file.Get_Data(), file.Get_Size() );
+}
+
+bool Is_Compressed_File( const std::string &filename )
+{
+	const size_t type_length = strlen( COMPRESSED_FILE_TYPE );
+
+	return filename.length() > type_length && filename.compare( filename.length() - type_length, type_length, COMPRESSED_FILE_TYPE ) == 0;
+}
+
+bool Find_File( std::string &filename )
+{
+	if( File_Exists( filename ) )
+	{
+		return 1;
+	}
+
+	const std::string compressed_filename = filename + COMPRESSED_FILE_TYPE;
+
+	if( !File_Exists( compressed_filename ) )
+	{
+		return 0;
+	}
+
+	filename = compressed_filename;
+	return 1;
+}
+
+bool Compress_Data( const char *data, size_t size, vector<char> &compressed )
+{
+	z_stream stream;
+	memset( &stream, 0, sizeof( stream ) );
+
+	// gzip header
+	if( deflateInit2( &stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+	{
+		return 0;
+	}
+
+	compressed.resize( deflateBound( &stream, static_cast<uLong>(size) ) );
+
+	stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+	stream.avail_in = static_cast<uInt>(size);
+	stream.next_out = reinterpret_cast<Bytef *>(&compressed[0]);
+	stream.avail_out = static_cast<uInt>(compressed.size());
+
+	const int result = deflate( &stream, Z_FINISH );
+	compressed.resize( stream.total_out );
+	deflateEnd( &stream );
+
+	return result == Z_STREAM_END;
+}
+
+bool Decompress_Data( const char *data, size_t size, vector<char> &decompressed )
+{
+	decompressed.clear();
+
+	z_stream stream;
+	memset( &stream, 0, sizeof( stream ) );
+
+	// detect gzip or zlib header
+	if( inflateInit2( &stream, MAX_WBITS + 32 ) != Z_OK )
+	{
+		return 0;
+	}
+
+	// the gzip trailer ends with the decompressed size
+	size_t buffer_size = 65536;
+
+	if( size > 18 )
+	{
+		const unsigned char *trailer = reinterpret_cast<const unsigned char *>(data + size - 4);
+		const size_t stored_size = trailer[0] | ( trailer[1] << 8 ) | ( trailer[2] << 16 ) | ( static_cast<size_t>(trailer[3]) << 24 );
+
+		// ignore a wrong size from zlib data
+		if( stored_size > buffer_size && stored_size < size * 100 )
+		{
+			buffer_size = stored_size + 1;
+		}
+	}
+
+	decompressed.resize( buffer_size );
+
+	stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+	stream.avail_in = static_cast<uInt>(size);
+
+	size_t used = 0;
+	int result;
+
+	// decompress in parts and grow the buffer if needed
+	do
+	{
+		if( used == decompressed.size() )
+		{
+			decompressed.resize( decompressed.size() * 2 );
+		}
+
+		stream.next_out = reinterpret_cast<Bytef *>(&decompressed[used]);
+		stream.avail_out = static_cast<uInt>(decompressed.size() - used);
+
+		result = inflate( &stream, Z_NO_FLUSH );
+		used = decompressed.size() - stream.avail_out;
+	}
+	while( result == Z_OK );
+
+	inflateEnd( &stream );
+	decompressed.resize( used );
+
+	return result == Z_STREAM_END;
+}
+
+/* *** *** *** *** *** *** cIndex_Reader *** *** *** *** *** *** *** *** *** *** *** */
+
+cIndex_Reader :: cIndex_Reader( const char *data, size_t size )
+: m_data( reinterpret_cast<const unsigned char *>(data) ), m_size( size ), m_pos( 0 ), m_valid( 1 )
+{
+	//
+}
+
+Uint32 cIndex_Reader :: Read_Uint32( void )
+{
+	if( m_pos + 4 > m_size )
+	{
+		m_valid = 0;
+		return 0;
+	}
+
+	const Uint32 val = m_data[m_pos] | ( m_data[m_pos + 1] << 8 ) | ( m_data[m_pos + 2] << 16 ) | ( static_cast<Uint32>(m_data[m_pos + 3]) << 24 );
+	m_pos += 4;
+	return val;
+}
+
+Uint64 cIndex_Reader :: Read_Uint64( void )
+{
+	const Uint64 low = Read_Uint32();
+	const Uint64 high = Read_Uint32();
+	return low | ( high << 32 );
+}
+
+std::string cIndex_Reader :: Read_String( void )
+{
+	const Uint32 length = Read_Uint32();
+
+	if( !m_valid || m_pos + length > m_size )
+	{
+		m_valid = 0;
+		return "";
+	}
+
+	std::string str( reinterpret_cast<const char *>(m_data + m_pos), length );
+	m_pos += length;
+	return str;
+}
+
+/* *** *** *** *** *** *** cIndex_Writer *** *** *** *** *** *** *** *** *** *** *** */
+
+void cIndex_Writer :: Write_Uint32( Uint32 val )
+{
+	m_data.push_back( static_cast<char>(val & 0xFF) );
+	m_data.push_back( static_cast<char>(( val >> 8 ) & 0xFF) );
+	m_data.push_back( static_cast<char>(( val >> 16 ) & 0xFF) );
+	m_data.push_back( static_cast<char>(( val >> 24 ) & 0xFF) );
+}
+
+void cIndex_Writer :: Write_Uint64( Uint64 val )
+{
+	Write_Uint32( static_cast<Uint32>(val & 0xFFFFFFFF) );
+	Write_Uint32( static_cast<Uint32>(val >> 32) );
+}
+
+void cIndex_Writer :: Write_String( const std::string &str )
+{
+	Write_Uint32( str.length() );
+	m_data.append( str );
+}
+
+/* *** *** *** *** *** *** cMapped_File *** *** *** *** *** *** *** *** *** *** *** */
+
+cMapped_File :: cMapped_File( void )
+{
+	m_data = NULL;
+	m_size = 0;
+	m_archived = 0;
+
+#ifdef _WIN32
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = NULL;
+#else
+	m_file = -1;
+#endif
+}
+
+cMapped_File :: ~cMapped_File( void )
+{
+	Close();
+}
+
+bool cMapped_File :: Open( const std::string &filename )
+{
+	Close();
+
+	if( !Map( filename ) )
+	{
+		return 0;
+	}
+
+	if( !Is_Compressed_File( filename ) )
+	{
+		return 1;
+	}
+
+	vector<char> buffer;
+	const bool decompressed = Decompress_Data( m_data, m_size, buffer );
+
+	// unmap the compressed data
+	Close();
+
+	if( !decompressed || buffer.empty() )
+	{
+		printf( "Warning : Could not decompress %s\n", filename.c_str() );
+		return 0;
+	}
+
+	m_buffer.swap( buffer );
+	m_data = &m_buffer[0];
+	m_size = m_buffer.size();
+
+	return 1;
+}
+
+bool cMapped_File :: Map( const std::string &filename )
+{
+	// the archive stays mapped
+	if( pResource_Archive && pResource_Archive->Get_File( filename, m_data, m_size ) )
+	{
+		m_archived = 1;
+
+		if( !m_size )
+		{
+			Close();
+			return 0;
+		}
+
+		return 1;
+	}
+
+#ifdef _WIN32
+	m_file = CreateFileW( utf8_to_ucs2( filename ).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+
+	if( m_file == INVALID_HANDLE_VALUE )
+	{
+		return 0;
+	}
+
+	LARGE_INTEGER size;
+
+	if( !GetFileSizeEx( m_file, &size ) || size.QuadPart <= 0 )
+	{
+		Close();
+		return 0;
+	}
+
+	m_mapping = CreateFileMappingW( m_file, NULL, PAGE_READONLY, 0, 0, NULL );
+
+	if( !m_mapping )
+	{
+		Close();
+		return 0;
+	}
+
+	m_data = static_cast<const char *>(MapViewOfFile( m_mapping, FILE_MAP_READ, 0, 0, 0 ));
+	m_size = static_cast<size_t>(size.QuadPart);
+#else
+	m_file = open( filename.c_str(), O_RDONLY );
+
+	if( m_file < 0 )
+	{
+		return 0;
+	}
+
+	struct stat file_info;
+
+	if( fstat( m_file, &file_info ) != 0 || file_info.st_size <= 0 )
+	{
+		Close();
+		return 0;
+	}
+
+	m_size = static_cast<size_t>(file_info.st_size);
+	void *data = mmap( NULL, m_size, PROT_READ, MAP_PRIVATE, m_file, 0 );
+
+	if( data == MAP_FAILED )
+	{
+		m_size = 0;
+		Close();
+		return 0;
+	}
+
+	m_data = static_cast<const char *>(data);
+#endif
+
+	if( !m_data )
+	{
+		Close();
+		return 0;
+	}
+
+	return 1;
+}
+
+void cMapped_File :: Close( void )
+{
+	// decompressed into memory
+	if( !m_buffer.empty() )
+	{
+		vector<char>().swap( m_buffer );
+		m_data = NULL;
+		m_size = 0;
+		return;
+	}
+
+	// only points into the resource archive
+	if( m_archived )
+	{
+		m_data = NULL;
+		m_size = 0;
+		m_archived = 0;
+		return;
+	}
+
+#ifdef _WIN32
+	if( m_data )
+	{
+		UnmapViewOfFile( m_data );
+	}
+
+	if( m_mapping )
+	{
+		CloseHandle( m_mapping );
+		m_mapping = NULL;
+	}
+
+	if( m_file != INVALID_HANDLE_VALUE )
+	{
+		CloseHandle( m_file );
+		m_file = INVALID_HANDLE_VALUE;
+	}
+#else
+	if( m_data )
+	{
+		munmap( const_cast<char *>(m_data), m_size );
+	}
+
+	if( m_file >= 0 )
+	{
+		close( m_file );
+		m_file = -1;
+	}
+#endif
+
+	m_data = NULL;
+	m_size = 0;
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 } // namespace SMC
@@ -17,6 +17,8 @@
 #define SMC_FILESYSTEM_H
 
 #include "../../core/global_basic.h"
+// SDL
+#include "SDL.h"
 
 namespace SMC
 {
@@ -64,6 +66,11 @@ bool Create_Directories( const std::string &dir );
 */
 size_t Get_File_Size( const std::string &filename );
 
+/* Get the last modification time of the file.
+* returns 0 if the file does not exist
+*/
+time_t Get_File_Modification_Time( const std::string &filename );
+
 // Converts "\" and "!" to "/"
 void Convert_Path_Separators( std::string &str );
 
@@ -72,14 +79,130 @@ void Convert_Path_Separators( std::string &str );
  * file_type : if set only this file type is returned
  * with_directories : if set adds directories to the returned objects
  * search_in_sub_directories : searches in every sub-directory
+ * directory entries are cached until the directory modification time changes
 */
 vector<std::string> Get_Directory_Files( const std::string &dir, const std::string &file_type = "", bool with_directories = 0, bool search_in_sub_directories = 1 );
 
+/* Open the file for reading with SDL
+ * files in the resource archive are read from its memory
+ * returns NULL if the file could not be opened
+*/
+SDL_RWops *Open_File_RW( const std::string &filename );
+
 // Return the operating system temporary files directory
 std::string Get_Temp_Directory( void );
 // Return the default smc user directory in the operating system application/home directory
 std::string Get_User_Directory( void );
 
+/* Returns the FNV-1a hash of the data which is never 0
+ * hash : continue the hash of previous data
+*/
+Uint64 Get_Data_Hash( const char *data, size_t size, Uint64 hash = 0 );
+/* Returns the hash of the file content
+ * returns 0 if the file could not be read
+*/
+Uint64 Get_File_Hash( const std::string &filename );
+
+// file type of gzip compressed files
+#define COMPRESSED_FILE_TYPE ".gz"
+
+// Returns true if the filename has the compressed file type
+bool Is_Compressed_File( const std::string &filename );
+/* Returns true if the file or the compressed file with the added compressed file type exists
+ * filename : set to the compressed filename if only it exists
+*/
+bool Find_File( std::string &filename );
+/* Compress the data with gzip
+ * returns false if it failed
+*/
+bool Compress_Data( const char *data, size_t size, vector<char> &compressed );
+/* Decompress gzip or zlib data
+ * returns false if the data is invalid
+*/
+bool Decompress_Data( const char *data, size_t size, vector<char> &decompressed );
+
+/* *** *** *** *** *** cIndex_Reader *** *** *** *** *** *** *** *** *** *** *** *** */
+
+// Reads little endian values from index file data
+class cIndex_Reader
+{
+public:
+	cIndex_Reader( const char *data, size_t size );
+
+	Uint32 Read_Uint32( void );
+	Uint64 Read_Uint64( void );
+	std::string Read_String( void );
+
+	const unsigned char *m_data;
+	size_t m_size;
+	size_t m_pos;
+	// set to false if reading past the end
+	bool m_valid;
+};
+
+/* *** *** *** *** *** cIndex_Writer *** *** *** *** *** *** *** *** *** *** *** *** */
+
+// Writes little endian values for index file data
+class cIndex_Writer
+{
+public:
+	void Write_Uint32( Uint32 val );
+	void Write_Uint64( Uint64 val );
+	void Write_String( const std::string &str );
+
+	std::string m_data;
+};
+
+/* *** *** *** *** *** cMapped_File *** *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Read-only memory mapping of a file
+ * the file content is read by the operating system when it is accessed
+ * compressed files are decompressed into memory
+ * files in the resource archive use the archive mapping
+*/
+class cMapped_File
+{
+public:
+	cMapped_File( void );
+	~cMapped_File( void );
+
+	/* Map the file into memory
+	 * returns false if the file could not be opened or is empty
+	*/
+	bool Open( const std::string &filename );
+	// Unmap the file
+	void Close( void );
+
+	// Returns the file content or NULL if not opened
+	inline const char *Get_Data( void ) const
+	{
+		return m_data;
+	}
+	// Returns the file size in bytes
+	inline size_t Get_Size( void ) const
+	{
+		return m_size;
+	}
+
+private:
+	// Map the file content without decompressing it
+	bool Map( const std::string &filename );
+
+	const char *m_data;
+	size_t m_size;
+	// decompressed file content
+	vector<char> m_buffer;
+	// if the content is in the resource archive
+	bool m_archived;
+
+#ifdef _WIN32
+	void *m_file;
+	void *m_mapping;
+#else
+	int m_file;
+#endif
+};
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 } // namespace SMC
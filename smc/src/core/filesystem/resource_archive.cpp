@@ -0,0 +1,396 @@
+/***************************************************************************
+ * resource_archive.cpp  -  packed data directory files
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../../core/filesystem/resource_archive.h"
+#include "../../core/game_core.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+namespace SMC
+{
+
+// file identification "SMCA" and format version
+static const Uint32 resource_archive_magic = 0x41434D53;
+static const Uint32 resource_archive_version = 1;
+
+/* *** *** *** *** *** cResource_Archive *** *** *** *** *** *** *** *** *** *** *** *** */
+
+cResource_Archive :: cResource_Archive( void )
+{
+	m_modified = 0;
+}
+
+cResource_Archive :: ~cResource_Archive( void )
+{
+	Close();
+}
+
+bool cResource_Archive :: Open( const std::string &filename )
+{
+	Close();
+
+	if( !m_file.Open( filename ) )
+	{
+		return 0;
+	}
+
+	cIndex_Reader reader( m_file.Get_Data(), m_file.Get_Size() );
+
+	if( reader.Read_Uint32() != resource_archive_magic || reader.Read_Uint32() != resource_archive_version )
+	{
+		printf( "Warning : Invalid resource archive %s\n", filename.c_str() );
+		Close();
+		return 0;
+	}
+
+	const Uint32 count = reader.Read_Uint32();
+
+	for( Uint32 i = 0; i < count && reader.m_valid; i++ )
+	{
+		const std::string path = reader.Read_String();
+		Entry entry;
+		entry.m_offset = static_cast<size_t>(reader.Read_Uint64());
+		entry.m_size = static_cast<size_t>(reader.Read_Uint64());
+
+		if( entry.m_offset > m_file.Get_Size() || entry.m_size > m_file.Get_Size() - entry.m_offset )
+		{
+			reader.m_valid = 0;
+			break;
+		}
+
+		m_entries[path] = entry;
+
+		// add all parent directories
+		std::string::size_type pos = path.rfind( '/' );
+
+		while( pos != std::string::npos && pos > 0 )
+		{
+			m_dirs.insert( path.substr( 0, pos ) );
+			pos = path.rfind( '/', pos - 1 );
+		}
+	}
+
+	if( !reader.m_valid )
+	{
+		printf( "Warning : Invalid resource archive %s\n", filename.c_str() );
+		Close();
+		return 0;
+	}
+
+	// sorted to list a directory without going through all entries
+	m_paths.reserve( m_entries.size() );
+
+	for( Entry_Map::const_iterator itr = m_entries.begin(); itr != m_entries.end(); ++itr )
+	{
+		m_paths.push_back( itr->first );
+	}
+
+	std::sort( m_paths.begin(), m_paths.end() );
+
+	m_modified = Get_File_Modification_Time( filename );
+
+	return 1;
+}
+
+void cResource_Archive :: Close( void )
+{
+	m_entries.clear();
+	m_paths.clear();
+	m_dirs.clear();
+	m_file.Close();
+	m_modified = 0;
+}
+
+bool cResource_Archive :: Exists( const std::string &filename ) const
+{
+	std::string path;
+
+	if( !Get_Relative_Path( filename, path ) )
+	{
+		return 0;
+	}
+
+	return m_entries.find( path ) != m_entries.end();
+}
+
+bool cResource_Archive :: Dir_Exists( const std::string &dir ) const
+{
+	std::string path;
+
+	if( !Get_Relative_Path( dir, path ) )
+	{
+		return 0;
+	}
+
+	// the data directory itself
+	if( path.empty() )
+	{
+		return !m_entries.empty();
+	}
+
+	return m_dirs.find( path ) != m_dirs.end();
+}
+
+bool cResource_Archive :: Get_File( const std::string &filename, const char *&data, size_t &size ) const
+{
+	std::string path;
+
+	if( !Get_Relative_Path( filename, path ) )
+	{
+		return 0;
+	}
+
+	Entry_Map::const_iterator itr = m_entries.find( path );
+
+	if( itr == m_entries.end() )
+	{
+		return 0;
+	}
+
+	data = m_file.Get_Data() + itr->second.m_offset;
+	size = itr->second.m_size;
+
+	return 1;
+}
+
+void cResource_Archive :: Get_Directory_Files( const std::string &dir, const std::string &file_type, bool with_directories, bool search_in_sub_directories, vector<std::string> &files ) const
+{
+	std::string path;
+
+	if( !Get_Relative_Path( dir, path ) )
+	{
+		return;
+	}
+
+	if( !path.empty() )
+	{
+		path += "/";
+	}
+
+	// loose files are not added again
+	boost::unordered_set<std::string> added( files.begin(), files.end() );
+
+	// the directory entries follow each other in the sorted paths
+	for( vector<std::string>::const_iterator itr = std::lower_bound( m_paths.begin(), m_paths.end(), path ); itr != m_paths.end(); ++itr )
+	{
+		const std::string &entry_path = (*itr);
+
+		if( entry_path.compare( 0, path.length(), path ) != 0 )
+		{
+			break;
+		}
+
+		const std::string name = entry_path.substr( path.length() );
+		std::string::size_type pos = name.find( '/' );
+
+		// in a sub-directory
+		if( pos != std::string::npos )
+		{
+			if( with_directories )
+			{
+				// every sub-directory level
+				while( pos != std::string::npos )
+				{
+					const std::string sub_dir = dir + "/" + name.substr( 0, pos );
+
+					if( added.insert( sub_dir ).second )
+					{
+						files.push_back( sub_dir );
+					}
+
+					if( !search_in_sub_directories )
+					{
+						break;
+					}
+
+					pos = name.find( '/', pos + 1 );
+				}
+			}
+
+			if( !search_in_sub_directories )
+			{
+				continue;
+			}
+		}
+
+		const std::string filename = name.substr( name.rfind( '/' ) == std::string::npos ? 0 : name.rfind( '/' ) + 1 );
+
+		if( !file_type.empty() && filename.rfind( file_type ) == std::string::npos )
+		{
+			continue;
+		}
+
+		const std::string full_filename = dir + "/" + name;
+
+		if( added.insert( full_filename ).second )
+		{
+			files.push_back( full_filename );
+		}
+	}
+}
+
+bool cResource_Archive :: Pack( const std::string &data_dir, const std::string &filename )
+{
+	vector<std::string> files = SMC::Get_Directory_Files( data_dir );
+	vector<std::string> paths;
+
+	for( vector<std::string>::iterator itr = files.begin(); itr != files.end(); )
+	{
+		// never pack an old archive
+		if( (*itr).compare( filename ) == 0 || Trim_Filename( (*itr), 0 ).compare( DATA_ARCHIVE_FILE ) == 0 )
+		{
+			itr = files.erase( itr );
+			continue;
+		}
+
+		paths.push_back( (*itr).substr( data_dir.length() + 1 ) );
+		++itr;
+	}
+
+	// the file contents follow the index
+	size_t offset = 3 * sizeof(Uint32);
+
+	for( vector<std::string>::iterator itr = paths.begin(); itr != paths.end(); ++itr )
+	{
+		offset += sizeof(Uint32) + (*itr).length() + 2 * sizeof(Uint64);
+	}
+
+	cIndex_Writer index;
+	index.Write_Uint32( resource_archive_magic );
+	index.Write_Uint32( resource_archive_version );
+	index.Write_Uint32( files.size() );
+
+	for( unsigned int i = 0; i < files.size(); i++ )
+	{
+		const size_t size = Get_File_Size( files[i] );
+
+		index.Write_String( paths[i] );
+		index.Write_Uint64( offset );
+		index.Write_Uint64( size );
+
+		offset += size;
+	}
+
+#ifdef _WIN32
+	FILE *fp = _wfopen( utf8_to_ucs2( filename ).c_str(), L"wb" );
+#else
+	FILE *fp = fopen( filename.c_str(), "wb" );
+#endif
+
+	if( !fp )
+	{
+		printf( "Error : Couldn't create resource archive %s\n", filename.c_str() );
+		return 0;
+	}
+
+	bool success = fwrite( index.m_data.data(), index.m_data.size(), 1, fp ) == 1;
+
+	for( vector<std::string>::iterator itr = files.begin(); success && itr != files.end(); ++itr )
+	{
+	#ifdef _WIN32
+		FILE *file = _wfopen( utf8_to_ucs2( (*itr) ).c_str(), L"rb" );
+	#else
+		FILE *file = fopen( (*itr).c_str(), "rb" );
+	#endif
+
+		if( !file )
+		{
+			printf( "Error : Couldn't read %s\n", (*itr).c_str() );
+			success = 0;
+			break;
+		}
+
+		// the size must match the index
+		const size_t size = Get_File_Size( (*itr) );
+		size_t written = 0;
+		char buffer[65536];
+		size_t count;
+
+		while( written < size && ( count = fread( buffer, 1, sizeof(buffer) < size - written ? sizeof(buffer) : size - written, file ) ) > 0 )
+		{
+			if( fwrite( buffer, count, 1, fp ) != 1 )
+			{
+				break;
+			}
+
+			written += count;
+		}
+
+		fclose( file );
+
+		if( written != size )
+		{
+			printf( "Error : Couldn't pack %s\n", (*itr).c_str() );
+			success = 0;
+		}
+	}
+
+	success = fclose( fp ) == 0 && success;
+
+	if( !success )
+	{
+		Delete_File( filename );
+		return 0;
+	}
+
+	printf( "Packed %u files into %s\n", static_cast<unsigned int>(files.size()), filename.c_str() );
+
+	return 1;
+}
+
+bool cResource_Archive :: Get_Relative_Path( const std::string &filename, std::string &path )
+{
+	static const std::string data_dir = DATA_DIR "/";
+
+	if( filename.compare( DATA_DIR ) == 0 )
+	{
+		path.clear();
+		return 1;
+	}
+
+	if( filename.compare( 0, data_dir.length(), data_dir ) != 0 )
+	{
+		return 0;
+	}
+
+	path = filename.substr( data_dir.length() );
+
+	// remove repeated separators
+	std::string::size_type pos;
+
+	while( ( pos = path.find( "//" ) ) != std::string::npos )
+	{
+		path.erase( pos, 1 );
+	}
+
+	while( !path.empty() && *path.begin() == '/' )
+	{
+		path.erase( 0, 1 );
+	}
+
+	while( !path.empty() && *path.rbegin() == '/' )
+	{
+		path.erase( path.length() - 1 );
+	}
+
+	return 1;
+}
+
+cResource_Archive *pResource_Archive = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,108 @@
+/***************************************************************************
+ * resource_archive.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_RESOURCE_ARCHIVE_H
+#define SMC_RESOURCE_ARCHIVE_H
+
+#include "../../core/global_basic.h"
+#include "../../core/filesystem/filesystem.h"
+// boost
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** cResource_Archive *** *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Packed data directory files in one memory mapped archive
+ * the archive starts with an index of the relative filenames with their offset and size
+ * followed by the unchanged file contents
+ * the filesystem functions look into the archive first for files in the data directory
+ * and use the loose files for anything not packed like the user data
+ * can be used from several threads after opening
+*/
+class cResource_Archive
+{
+public:
+	cResource_Archive( void );
+	~cResource_Archive( void );
+
+	/* Map the archive and read its index
+	 * returns false if it could not be opened or is invalid
+	*/
+	bool Open( const std::string &filename );
+	// Unmap the archive
+	void Close( void );
+
+	// Returns true if the data directory file is packed
+	bool Exists( const std::string &filename ) const;
+	// Returns true if the data directory contains packed files
+	bool Dir_Exists( const std::string &dir ) const;
+	/* Get the packed content of the data directory file
+	 * the data stays valid until the archive is closed
+	 * returns false if the file is not packed
+	*/
+	bool Get_File( const std::string &filename, const char *&data, size_t &size ) const;
+	/* Add the packed files of the directory not already in the list
+	 * uses the same options as Get_Directory_Files
+	*/
+	void Get_Directory_Files( const std::string &dir, const std::string &file_type, bool with_directories, bool search_in_sub_directories, vector<std::string> &files ) const;
+
+	// Returns the modification time of the archive used for all packed files
+	inline time_t Get_Modification_Time( void ) const
+	{
+		return m_modified;
+	}
+
+	/* Pack all files of the data directory into the archive
+	 * returns false if it could not be written
+	*/
+	static bool Pack( const std::string &data_dir, const std::string &filename );
+
+private:
+	/* Get the filename relative to the data directory
+	 * returns false if it is not in the data directory
+	*/
+	static bool Get_Relative_Path( const std::string &filename, std::string &path );
+
+	struct Entry
+	{
+		size_t m_offset;
+		size_t m_size;
+	};
+
+	typedef boost::unordered_map<std::string, Entry> Entry_Map;
+	// files by relative filename
+	Entry_Map m_entries;
+	// sorted relative filenames
+	vector<std::string> m_paths;
+	// relative directories containing packed files
+	boost::unordered_set<std::string> m_dirs;
+
+	cMapped_File m_file;
+	time_t m_modified;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+// Resource archive or NULL if the data directory is not packed
+extern cResource_Archive *pResource_Archive;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
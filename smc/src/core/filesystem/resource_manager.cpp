@@ -23,6 +23,9 @@ namespace SMC
 
 /* *** *** *** *** *** *** cResource_Manager *** *** *** *** *** *** *** *** *** *** *** */
 
+// milliseconds between checking a directory for added or removed files
+static const Uint32 resource_file_check_interval = 1000;
+
 cResource_Manager :: cResource_Manager( void )
 {
 	user_data_dir = "";
@@ -71,6 +74,21 @@ void cResource_Manager :: Init_User_Directory( void )
 	{
 		Create_Directory( user_data_dir + USER_IMGCACHE_DIR );
 	}
+	// Create compiled level cache directory
+	if( !Dir_Exists( user_data_dir + USER_LEVEL_CACHE_DIR ) )
+	{
+		Create_Directory( user_data_dir + USER_LEVEL_CACHE_DIR );
+	}
+	// Create level preview cache directory
+	if( !Dir_Exists( user_data_dir + USER_PREVIEW_CACHE_DIR ) )
+	{
+		Create_Directory( user_data_dir + USER_PREVIEW_CACHE_DIR );
+	}
+	// Create decoded sound cache directory
+	if( !Dir_Exists( user_data_dir + USER_SOUND_CACHE_DIR ) )
+	{
+		Create_Directory( user_data_dir + USER_SOUND_CACHE_DIR );
+	}
 }
 
 bool cResource_Manager :: Set_User_Directory( const std::string &dir )
@@ -80,6 +98,92 @@ bool cResource_Manager :: Set_User_Directory( const std::string &dir )
 	return 1;
 }
 
+bool cResource_Manager :: File_Exists( const std::string &filename )
+{
+	const std::string dir = Get_File_Dir( filename );
+	const Uint32 ticks = SDL_GetTicks();
+
+	boost::mutex::scoped_lock lock( m_file_mutex );
+
+	File_Dir_Map::iterator dir_itr = m_file_dirs.find( dir );
+
+	if( dir_itr == m_file_dirs.end() )
+	{
+		File_Dir &file_dir = m_file_dirs[dir];
+		file_dir.m_modified = Get_File_Modification_Time( dir );
+		file_dir.m_checked = ticks;
+		dir_itr = m_file_dirs.find( dir );
+	}
+	// files were added or removed
+	else if( ticks - dir_itr->second.m_checked >= resource_file_check_interval )
+	{
+		File_Dir &file_dir = dir_itr->second;
+		const time_t modified = Get_File_Modification_Time( dir );
+		file_dir.m_checked = ticks;
+
+		if( modified != file_dir.m_modified )
+		{
+			file_dir.m_modified = modified;
+			file_dir.m_files.clear();
+		}
+	}
+
+	boost::unordered_map<std::string, bool> &files = dir_itr->second.m_files;
+	boost::unordered_map<std::string, bool>::const_iterator itr = files.find( filename );
+
+	if( itr != files.end() )
+	{
+		return itr->second;
+	}
+
+	const bool exists = SMC::File_Exists( filename );
+	files[filename] = exists;
+
+	return exists;
+}
+
+bool cResource_Manager :: Find_File( std::string &filename )
+{
+	if( File_Exists( filename ) )
+	{
+		return 1;
+	}
+
+	const std::string compressed_filename = filename + COMPRESSED_FILE_TYPE;
+
+	if( !File_Exists( compressed_filename ) )
+	{
+		return 0;
+	}
+
+	filename = compressed_filename;
+	return 1;
+}
+
+void cResource_Manager :: Reset_File_Cache( const std::string &filename )
+{
+	boost::mutex::scoped_lock lock( m_file_mutex );
+	m_file_dirs.erase( Get_File_Dir( filename ) );
+}
+
+void cResource_Manager :: Clear_File_Cache( void )
+{
+	boost::mutex::scoped_lock lock( m_file_mutex );
+	m_file_dirs.clear();
+}
+
+std::string cResource_Manager :: Get_File_Dir( const std::string &filename )
+{
+	const size_t pos = filename.rfind( '/' );
+
+	if( pos == std::string::npos )
+	{
+		return ".";
+	}
+
+	return filename.substr( 0, pos );
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 cResource_Manager *pResource_Manager = NULL;
@@ -18,6 +18,11 @@
 
 #include "../../core/global_basic.h"
 #include "../../core/global_game.h"
+// SDL
+#include "SDL.h"
+// boost
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
 
 namespace SMC
 {
@@ -35,8 +40,44 @@ public:
 	// Create the necessary folders in the user directory
 	void Init_User_Directory( void );
 
+	/* Check if the file exists
+	 * the result is cached for each directory until the directory modification time changes
+	 * which is checked at most every second
+	 * can be used from several threads
+	*/
+	bool File_Exists( const std::string &filename );
+	/* Returns true if the file or the compressed file with the added compressed file type exists
+	 * uses the cached file existence
+	 * filename : set to the compressed filename if only it exists
+	*/
+	bool Find_File( std::string &filename );
+	// Forget the cached file existence of the directory of the file
+	void Reset_File_Cache( const std::string &filename );
+	// Forget all cached file existence
+	void Clear_File_Cache( void );
+
 	// user data directory
 	std::string user_data_dir;
+
+private:
+	// Returns the directory of the filename
+	static std::string Get_File_Dir( const std::string &filename );
+
+	// cached file existence of a directory
+	struct File_Dir
+	{
+		// directory modification time
+		time_t m_modified;
+		// ticks of the last modification time check
+		Uint32 m_checked;
+		// existence by filename
+		boost::unordered_map<std::string, bool> m_files;
+	};
+
+	typedef boost::unordered_map<std::string, File_Dir> File_Dir_Map;
+	File_Dir_Map m_file_dirs;
+	// protects the file directories
+	boost::mutex m_file_mutex;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
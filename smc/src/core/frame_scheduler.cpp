@@ -0,0 +1,172 @@
+/***************************************************************************
+ * frame_scheduler.cpp  -  deferrable main thread jobs run with the frame time left
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/frame_scheduler.h"
+#include "../core/framerate.h"
+#include "../core/profiler.h"
+#include "../user/preferences.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cFrame_Scheduler *** *** *** *** *** *** *** *** *** *** */
+
+const float cFrame_Scheduler :: m_budget_part = 0.75f;
+
+cFrame_Scheduler :: cFrame_Scheduler( void )
+{
+	m_frame = 0;
+	m_frame_start = Get_Microseconds();
+
+	m_last_run = 0;
+	m_last_forced = 0;
+	m_last_deferred = 0;
+	m_last_time = 0;
+	m_last_left = 0;
+}
+
+cFrame_Scheduler :: ~cFrame_Scheduler( void )
+{
+	Clear();
+}
+
+void cFrame_Scheduler :: Add( const Job_Func &func, const char *name, const void *id /* = NULL */ )
+{
+	if( id )
+	{
+		for( Job_List::iterator itr = m_jobs.begin(); itr != m_jobs.end(); ++itr )
+		{
+			Job &job = (*itr);
+
+			if( job.m_id == id )
+			{
+				job.m_func = func;
+				job.m_name = name;
+				return;
+			}
+		}
+	}
+
+	Job job;
+	job.m_func = func;
+	job.m_name = name;
+	job.m_id = id;
+	job.m_frame = m_frame;
+
+	m_jobs.push_back( job );
+}
+
+void cFrame_Scheduler :: Remove( const void *id )
+{
+	Job_List::iterator itr = m_jobs.begin();
+
+	while( itr != m_jobs.end() )
+	{
+		if( (*itr).m_id == id )
+		{
+			itr = m_jobs.erase( itr );
+		}
+		else
+		{
+			++itr;
+		}
+	}
+}
+
+void cFrame_Scheduler :: Clear( void )
+{
+	m_jobs.clear();
+}
+
+void cFrame_Scheduler :: Frame_Start( void )
+{
+	m_frame++;
+	m_frame_start = Get_Microseconds();
+}
+
+void cFrame_Scheduler :: Run( void )
+{
+	cProfiler_Scope scope( "deferred jobs" );
+
+	const Uint64 budget = Get_Budget();
+	const Uint64 jobs_start = Get_Microseconds();
+
+	m_last_run = 0;
+	m_last_forced = 0;
+
+	// jobs added by the jobs wait for the next frame
+	unsigned int count = static_cast<unsigned int>(m_jobs.size());
+	Uint64 elapsed = jobs_start - m_frame_start;
+
+	while( count > 0 )
+	{
+		count--;
+
+		// the oldest job is first as replaced jobs keep their place
+		const bool forced = m_frame - m_jobs.front().m_frame >= m_max_wait_frames;
+
+		if( elapsed >= budget && !forced )
+		{
+			break;
+		}
+
+		Job job = m_jobs.front();
+		m_jobs.pop_front();
+
+		{
+			cProfiler_Scope job_scope( job.m_name );
+			job.m_func();
+		}
+
+		m_last_run++;
+
+		if( forced && elapsed >= budget )
+		{
+			m_last_forced++;
+		}
+
+		elapsed = Get_Microseconds() - m_frame_start;
+	}
+
+	m_last_deferred = static_cast<unsigned int>(m_jobs.size());
+	m_last_time = Get_Microseconds() - jobs_start;
+	m_last_left = elapsed < budget ? budget - elapsed : 0;
+
+	if( pProfiler->Is_Capturing() )
+	{
+		pProfiler->Add_Counter( "deferred jobs run", m_last_run );
+		pProfiler->Add_Counter( "deferred jobs queued", m_last_deferred );
+	}
+}
+
+Uint64 cFrame_Scheduler :: Get_Budget( void ) const
+{
+	unsigned int target_fps = pPreferences->m_video_fps_limit;
+
+	if( !target_fps || target_fps < pFramerate->m_fps_target )
+	{
+		target_fps = static_cast<unsigned int>(pFramerate->m_fps_target);
+	}
+
+	return static_cast<Uint64>( ( 1000000.0f / target_fps ) * m_budget_part );
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+cFrame_Scheduler *pFrame_Scheduler = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,119 @@
+/***************************************************************************
+ * frame_scheduler.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_FRAME_SCHEDULER_H
+#define SMC_FRAME_SCHEDULER_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL.h"
+// boost
+#include <boost/function.hpp>
+// std
+#include <deque>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cFrame_Scheduler *** *** *** *** *** *** *** *** *** *** */
+
+/* Runs deferrable main thread jobs with the time left in the frame
+ * the jobs are run after the frame is drawn while the frame time is under the budget
+ * of the target frame time and the others are kept for the next frames
+ * a job waiting too long is run even if over the budget so nothing is starved
+ * every job is measured as a profiler section with its name
+*/
+class cFrame_Scheduler
+{
+public:
+	cFrame_Scheduler( void );
+	~cFrame_Scheduler( void );
+
+	typedef boost::function<void ( void )> Job_Func;
+
+	/* Add a job for the next Run
+	 * name : profiler section which must stay valid as it is not copied
+	 * id : if not NULL a queued job with the same id is replaced and keeps its waiting time
+	 * which allows adding a polling job every frame
+	*/
+	void Add( const Job_Func &func, const char *name, const void *id = NULL );
+	// Remove the queued jobs with the id
+	void Remove( const void *id );
+	// Remove all queued jobs without running them
+	void Clear( void );
+
+	/* Start measuring the frame time
+	 * must be called from the main thread at the start of the frame
+	*/
+	void Frame_Start( void );
+	/* Run the queued jobs which fit into the frame budget
+	 * must be called from the main thread after the frame is drawn
+	*/
+	void Run( void );
+
+	// Returns the frame budget in microseconds
+	Uint64 Get_Budget( void ) const;
+
+	// Returns the number of queued jobs
+	inline unsigned int Get_Size( void ) const
+	{
+		return static_cast<unsigned int>(m_jobs.size());
+	}
+
+	// part of the target frame time used by the frame and the jobs
+	static const float m_budget_part;
+	// frames a job can wait before it is run over the budget
+	static const unsigned int m_max_wait_frames = 30;
+
+	// last frame
+	// jobs run
+	unsigned int m_last_run;
+	// jobs run over the budget because they waited too long
+	unsigned int m_last_forced;
+	// jobs kept for the next frame
+	unsigned int m_last_deferred;
+	// microseconds used by the jobs
+	Uint64 m_last_time;
+	// microseconds left of the budget or 0 if over it
+	Uint64 m_last_left;
+
+private:
+	struct Job
+	{
+		Job_Func m_func;
+		const char *m_name;
+		const void *m_id;
+		// frame the job was first added
+		Uint32 m_frame;
+	};
+
+	typedef std::deque<Job> Job_List;
+
+	// jobs in the order they were added
+	Job_List m_jobs;
+	// current frame number
+	Uint32 m_frame;
+	// microseconds at the frame start
+	Uint64 m_frame_start;
+};
+
+// Deferrable main thread jobs
+extern cFrame_Scheduler *pFrame_Scheduler;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -18,7 +18,11 @@
 #include "../core/math/utilities.h"
 // SDL
 #include "SDL.h"
-
+// std
+#include <algorithm>
+// boost
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/thread.hpp>
 
 namespace SMC
 {
@@ -40,17 +44,28 @@ void cPerformance_Timer :: Reset( void )
 	frame_counter = 0;
 	ms_counter = 0;
 	ms = 0;
+
+	m_history_pos = 0;
+	m_history_count = 0;
+	m_p50 = 0;
+	m_p95 = 0;
+	m_p99 = 0;
+	m_max = 0;
 }
 
-void cPerformance_Timer :: Update( void )
+void cPerformance_Timer :: Add_Time( Uint32 time )
 {
 	// count frame
 	frame_counter++;
+	ms_counter += time;
+
+	m_history[m_history_pos] = time;
+	m_history_pos = ( m_history_pos + 1 ) % perf_history_size;
 
-	// add milliseconds
-	Uint32 new_ticks = SDL_GetTicks();
-	ms_counter += new_ticks - pFramerate->m_perf_last_ticks;
-	pFramerate->m_perf_last_ticks = new_ticks;
+	if( m_history_count < perf_history_size )
+	{
+		m_history_count++;
+	}
 
 	// counted 100 frames
 	if( frame_counter >= 100 )
@@ -58,9 +73,34 @@ void cPerformance_Timer :: Update( void )
 		ms = ms_counter;
 		frame_counter = 0;
 		ms_counter = 0;
+
+		Update_Percentiles();
 	}
 }
 
+Uint32 cPerformance_Timer :: Get_History( unsigned int age ) const
+{
+	return m_history[( m_history_pos + perf_history_size - 1 - age ) % perf_history_size];
+}
+
+void cPerformance_Timer :: Update_Percentiles( void )
+{
+	if( !m_history_count )
+	{
+		return;
+	}
+
+	vector<Uint32> sorted( m_history, m_history + m_history_count );
+	std::sort( sorted.begin(), sorted.end() );
+
+	const unsigned int last = m_history_count - 1;
+
+	m_p50 = sorted[last * 50 / 100];
+	m_p95 = sorted[last * 95 / 100];
+	m_p99 = sorted[last * 99 / 100];
+	m_max = sorted[last];
+}
+
 
 /* *** *** *** *** *** *** cFramerate *** *** *** *** *** *** *** *** *** *** *** */
 
@@ -78,23 +118,15 @@ cFramerate :: cFramerate( void )
 	m_max_elapsed_ticks = 100;
 	m_speed_factor = 0.1f;
 	m_force_speed_factor = 0.0f;
-
-	// create performance timers
-	for( unsigned int i = 0; i < 24; i++ )
-	{
-		m_perf_timer.push_back( new cPerformance_Timer() );
-	}
+	m_fixed_time = 0.0f;
+	m_fixed_tick = 0;
+	m_interpolation = 1.0f;
+	m_input_time = 0;
 }
 
 cFramerate :: ~cFramerate( void )
 {
-	// clear performance timer
-	for( Performance_Timer_List::iterator itr = m_perf_timer.begin(); itr != m_perf_timer.end(); ++itr )
-	{
-		delete *itr;
-	}
 
-	m_perf_timer.clear();
 }
 
 void cFramerate :: Init( const float target_fps /* = speedfactor_fps */ )
@@ -171,6 +203,19 @@ void cFramerate :: Update( void )
 		m_fps_worst = m_fps;
 	}
 
+	// real frame time for the debug statistics
+	m_frame_timer.Add_Time( current_ticks - m_last_ticks );
+
+	// time for the fixed timestep ticks of the next frame
+	m_fixed_time += static_cast<float>(m_elapsed_ticks);
+
+	if( m_fixed_time > m_max_elapsed_ticks )
+	{
+		m_fixed_time = static_cast<float>(m_max_elapsed_ticks);
+	}
+
+	m_interpolation = 1.0f;
+
 	m_last_ticks = current_ticks;
 }
 
@@ -179,17 +224,15 @@ void cFramerate :: Reset( void )
 	m_last_ticks = SDL_GetTicks();
 	m_elapsed_ticks = 1;
 	m_speed_factor = 0.001f;
+	m_fixed_time = 0.0f;
+	m_interpolation = 1.0f;
 	m_fps_best = 0;
 	m_fps_worst = 100000.0f;
 	m_fps_average = 0;
 	m_fps_average_framedelay = m_last_ticks;
 	m_frames_counted = 0;
 
-	// reset performance timer
-	for( Performance_Timer_List::iterator itr = m_perf_timer.begin(); itr != m_perf_timer.end(); ++itr )
-	{
-		(*itr)->Reset();
-	}
+	m_frame_timer.Reset();
 }
 
 void cFramerate :: Set_Max_Elapsed_Ticks( const Uint32 ticks )
@@ -202,29 +245,115 @@ void cFramerate :: Set_Fixed_Speedfacor( const float val )
 	m_force_speed_factor = val;
 }
 
-/* *** *** *** *** *** *** *** helper functions *** *** *** *** *** *** *** *** *** *** */
+unsigned int cFramerate :: Update_Fixed_Ticks( void )
+{
+	const float tick_time = 1000.0f / fixed_timestep_fps;
+	unsigned int ticks = 0;
 
-void Correct_Frame_Time( const unsigned int fps )
+	// the time is limited to the maximum elapsed ticks
+	while( m_fixed_time >= tick_time )
+	{
+		m_fixed_time -= tick_time;
+		ticks++;
+	}
+
+	m_interpolation = m_fixed_time / tick_time;
+
+	return ticks;
+}
+
+/* *** *** *** *** *** *** *** cFrame_Pacer *** *** *** *** *** *** *** *** *** *** */
+
+// microseconds before the due time to stop sleeping as the system may wake up later
+static const Uint64 frame_pacer_spin_time = 2000;
+
+cFrame_Pacer :: cFrame_Pacer( void )
+{
+	m_fps = 0;
+	m_next_time = 0;
+	m_frame_time = 0;
+}
+
+cFrame_Pacer :: ~cFrame_Pacer( void )
 {
-	while( !Is_Frame_Time( fps ) )
+	//
+}
+
+void cFrame_Pacer :: Wait( const unsigned int fps )
+{
+	Uint64 time = Get_Microseconds();
+	Update_Schedule( fps, time );
+
+	// already due
+	if( time >= m_next_time )
 	{
-		SDL_Delay( 1 );
+		m_next_time += m_frame_time;
+		return;
 	}
+
+	// sleep
+	if( m_next_time - time > frame_pacer_spin_time )
+	{
+		SDL_Delay( static_cast<Uint32>(( m_next_time - time - frame_pacer_spin_time ) / 1000) );
+	}
+
+	// wait the rest actively
+	while( ( time = Get_Microseconds() ) < m_next_time )
+	{
+		boost::this_thread::yield();
+	}
+
+	m_jitter_timer.Add_Time( static_cast<Uint32>(time - m_next_time) );
+	m_next_time += m_frame_time;
 }
 
-bool Is_Frame_Time( const unsigned int fps )
+bool cFrame_Pacer :: Is_Due( const unsigned int fps )
 {
-	static Uint32 static_time = 0;
+	const Uint64 time = Get_Microseconds();
+	Update_Schedule( fps, time );
 
-	if( SDL_GetTicks() - static_time < 1000 / fps )
+	if( time < m_next_time )
 	{
 		return 0;
 	}
 
-	static_time = SDL_GetTicks();
+	m_next_time += m_frame_time;
 	return 1;
 }
 
+void cFrame_Pacer :: Update_Schedule( const unsigned int fps, const Uint64 time )
+{
+	if( fps != m_fps )
+	{
+		m_fps = fps;
+		m_frame_time = fps ? 1000000 / fps : 0;
+		m_next_time = time;
+	}
+	// too late to catch up
+	else if( time > m_next_time + m_frame_time )
+	{
+		m_next_time = time;
+	}
+}
+
+/* *** *** *** *** *** *** *** helper functions *** *** *** *** *** *** *** *** *** *** */
+
+Uint64 Get_Microseconds( void )
+{
+	static const boost::posix_time::ptime epoch = boost::posix_time::microsec_clock::universal_time();
+	return static_cast<Uint64>(( boost::posix_time::microsec_clock::universal_time() - epoch ).total_microseconds());
+}
+
+void Correct_Frame_Time( const unsigned int fps )
+{
+	pFramerate->m_pacer.Wait( fps );
+}
+
+bool Is_Frame_Time( const unsigned int fps )
+{
+	return pFramerate->m_pacer.Is_Due( fps );
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 cFramerate *pFramerate = NULL;
@@ -24,7 +24,16 @@ namespace SMC
 
 /* *** *** *** *** *** *** *** cPerformance_Timer *** *** *** *** *** *** *** *** *** *** */
 
-// counts milliseconds for 100 frames and sets them to ms
+// frames kept in the timing history
+static const unsigned int perf_history_size = 300;
+// updates per second in the fixed timestep mode
+static const float fixed_timestep_fps = 64.0f;
+
+/* counts the time for 100 frames and sets it to ms
+ * also keeps the time of each of the last frames
+ * and calculates the percentiles of them every 100 frames
+ * the time is in milliseconds for the frame timer and in microseconds for the profiler sections
+*/
 class cPerformance_Timer
 {
 public:
@@ -34,15 +43,74 @@ public:
 	// reset
 	void Reset( void );
 
-	// Update and set new framerate ticks
-	void Update( void );
+	// Add the time of a frame
+	void Add_Time( Uint32 time );
+
+	/* Return the time of a frame from the history
+	 * age : 0 is the last frame and must be lower than m_history_count
+	*/
+	Uint32 Get_History( unsigned int age ) const;
 
 	// current frame counter
 	Uint32 frame_counter;
-	// current milliseconds per frames counted
+	// current time per frames counted
 	Uint32 ms_counter;
-	// milliseconds per 100 frames
+	// time per 100 frames
 	Uint32 ms;
+
+	// time of the last frames as ring buffer
+	Uint32 m_history[perf_history_size];
+	// next position in the history
+	unsigned int m_history_pos;
+	// frames in the history
+	unsigned int m_history_count;
+
+	// frame time percentiles of the history
+	Uint32 m_p50;
+	Uint32 m_p95;
+	Uint32 m_p99;
+	Uint32 m_max;
+
+private:
+	// Calculate the percentiles from the history
+	void Update_Percentiles( void );
+};
+
+/* *** *** *** *** *** *** *** cFrame_Pacer *** *** *** *** *** *** *** *** *** *** */
+
+/* Starts the frames at a fixed framerate using a microsecond clock
+ * every frame is due one frame time after the due time of the last frame
+ * so a frame started late or early is corrected by the next frame
+ * if more than a frame late or the framerate changes it starts again from the current time
+*/
+class cFrame_Pacer
+{
+public:
+	cFrame_Pacer( void );
+	~cFrame_Pacer( void );
+
+	/* Wait until the next frame is due
+	 * sleeps until shortly before and waits the rest actively
+	*/
+	void Wait( const unsigned int fps );
+	/* Returns true and starts the next frame if it is due
+	 * returns false without waiting if not
+	*/
+	bool Is_Due( const unsigned int fps );
+
+	// microseconds the waited frames started after their due time
+	cPerformance_Timer m_jitter_timer;
+
+private:
+	// Set the framerate and start again from the time if changed or too late
+	void Update_Schedule( const unsigned int fps, const Uint64 time );
+
+	// current framerate
+	unsigned int m_fps;
+	// due time of the next frame in microseconds
+	Uint64 m_next_time;
+	// frame time in microseconds
+	Uint64 m_frame_time;
 };
 
 /* *** *** *** *** *** *** *** cFramerate *** *** *** *** *** *** *** *** *** *** */
@@ -72,6 +140,16 @@ public:
 	*/
 	void Set_Fixed_Speedfacor( const float val );
 
+	/* Returns the number of fixed timestep ticks to update for the time since the last call
+	 * and sets the interpolation of the drawing between the last two ticks
+	*/
+	unsigned int Update_Fixed_Ticks( void );
+	// Returns the speed factor of a fixed timestep tick
+	inline float Get_Fixed_Tick_Speed_Factor( void ) const
+	{
+		return m_fps_target / fixed_timestep_fps;
+	}
+
 	// target fps for speed factor calculations
 	float m_fps_target;
 	// current fps
@@ -103,16 +181,31 @@ public:
 	// fixed speed factor value
 	float m_force_speed_factor;
 
-	// ## performance values ##
-	// ticks since last section
-	Uint32 m_perf_last_ticks;
-
-	typedef vector<cPerformance_Timer *> Performance_Timer_List;
-	Performance_Timer_List m_perf_timer;
+	// milliseconds not yet updated with fixed timestep ticks
+	float m_fixed_time;
+	// number of the last fixed timestep tick
+	Uint32 m_fixed_tick;
+	/* drawing position between the previous and the last fixed timestep tick
+	 * 1 draws the current positions
+	 * reset to 1 every frame
+	*/
+	float m_interpolation;
+
+	// real milliseconds of each frame
+	cPerformance_Timer m_frame_timer;
+	// microseconds from the input sampling to the finished buffer swap of the frame
+	cPerformance_Timer m_input_latency_timer;
+	// time the input of the current frame was sampled in microseconds
+	Uint64 m_input_time;
+	// fixed framerate limit
+	cFrame_Pacer m_pacer;
 };
 
 /* *** *** *** *** *** *** *** helper functions *** *** *** *** *** *** *** *** *** *** */
 
+// Returns the microseconds of a high resolution clock
+Uint64 Get_Microseconds( void );
+
 /* Fixed framerate method
  * if next frame is not ready wait until it is
 */
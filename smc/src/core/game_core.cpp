@@ -21,7 +21,12 @@
 #include "../level/level_editor.h"
 #include "../level/level_player.h"
 #include "../video/renderer.h"
+#include "../video/image_loader.h"
+#include "../video/img_manager.h"
+#include "../video/font.h"
+#include "../video/screen_transition.h"
 #include "../level/level.h"
+#include "../level/level_prefetch.h"
 #include "../core/sprite_manager.h"
 #include "../overworld/overworld.h"
 #include "../gui/menu.h"
@@ -54,6 +59,8 @@ int game_res_h = 600;
 
 bool game_debug = 0;
 bool game_debug_performance = 0;
+bool game_debug_collision_steps = 0;
+bool game_debug_overdraw = 0;
 
 SDL_Event input_event;
 
@@ -72,14 +79,100 @@ cSprite *pActive_Player = NULL;
 
 /* *** *** *** *** *** *** *** Functions *** *** *** *** *** *** *** *** *** *** */
 
+// game action continued when the screen fadeout is finished
+static GameAction pending_game_action = GA_NONE;
+static CEGUI::XMLAttributes pending_game_action_data_middle;
+static CEGUI::XMLAttributes pending_game_action_data_end;
+static void *pending_game_action_ptr = NULL;
+
+// Handle the game action after the start events
+static void Finish_Game_Action( const GameAction game_action, const CEGUI::XMLAttributes &action_data_middle, const CEGUI::XMLAttributes &action_data_end, void *action_ptr )
+{
+	pVideo->Render_Finish();
+
+	// handle player downgrade
+	if( game_action == GA_DOWNGRADE_PLAYER )
+	{
+		pLevel_Player->DownGrade_Player( 0, action_data_middle.getValueAsBool( "downgrade_force" ) );
+		Handle_Generic_Game_Events( action_data_middle );
+		Handle_Generic_Game_Events( action_data_end );
+	}
+	// activate level exit
+	else if( game_action == GA_ACTIVATE_LEVEL_EXIT )
+	{
+		cLevel_Exit *level_exit = static_cast<cLevel_Exit *>(action_ptr);
+		level_exit->Activate();
+		Handle_Generic_Game_Events( action_data_middle );
+		Handle_Generic_Game_Events( action_data_end );
+	}
+	// full events
+	else
+	{
+		GameMode new_mode = MODE_NOTHING;
+
+		if( game_action == GA_ENTER_LEVEL )
+		{
+			new_mode = MODE_LEVEL;
+		}
+		else if( game_action == GA_ENTER_WORLD )
+		{
+			new_mode = MODE_OVERWORLD;
+		}
+		else if( game_action == GA_ENTER_MENU )
+		{
+			new_mode = MODE_MENU;
+		}
+		else if( game_action == GA_ENTER_LEVEL_SETTINGS )
+		{
+			new_mode = MODE_LEVEL_SETTINGS;
+		}
+
+		Leave_Game_Mode( new_mode );
+		Handle_Generic_Game_Events( action_data_middle );
+		Enter_Game_Mode( new_mode );
+		Handle_Generic_Game_Events( action_data_end );
+	}
+
+	// no fadein was started
+	if( pScreen_Transition->Is_Covered() )
+	{
+		pScreen_Transition->Clear();
+	}
+}
+
 void Handle_Game_Events( void )
 {
+	// waiting for the screen fadeout
+	if( pending_game_action != GA_NONE )
+	{
+		if( pScreen_Transition->Is_Fading_Out() && !pScreen_Transition->Is_Covered() )
+		{
+			return;
+		}
+
+		// the next level is still read in the background
+		if( pending_game_action_data_middle.exists( "load_level" ) && pLevel_Preloader->Is_Reading( pending_game_action_data_middle.getValueAsString( "load_level" ).c_str() ) )
+		{
+			return;
+		}
+
+		const GameAction game_action = pending_game_action;
+		const CEGUI::XMLAttributes action_data_middle = pending_game_action_data_middle;
+		const CEGUI::XMLAttributes action_data_end = pending_game_action_data_end;
+		void *action_ptr = pending_game_action_ptr;
+		// clear
+		pending_game_action = GA_NONE;
+		pending_game_action_data_middle = CEGUI::XMLAttributes();
+		pending_game_action_data_end = CEGUI::XMLAttributes();
+		pending_game_action_ptr = NULL;
+
+		Finish_Game_Action( game_action, action_data_middle, action_data_end, action_ptr );
+	}
+
 	// if game action is set
 	while( Game_Action != GA_NONE )
 	{
 		// get current data
-		const GameMode current_game_mode = Game_Mode;
-		const GameModeType current_game_mode_type = Game_Mode_Type;
 		const GameAction current_game_action = Game_Action;
 		const CEGUI::XMLAttributes current_game_action_data_start = Game_Action_Data_Start;
 		const CEGUI::XMLAttributes current_game_action_data_middle = Game_Action_Data_Middle;
@@ -92,51 +185,27 @@ void Handle_Game_Events( void )
 		Game_Action_Data_End = CEGUI::XMLAttributes();
 		Game_Action_ptr = NULL;
 
-		// handle player downgrade
-		if( current_game_action == GA_DOWNGRADE_PLAYER )
-		{
-			Handle_Generic_Game_Events( current_game_action_data_start );
-			pLevel_Player->DownGrade_Player( 0, current_game_action_data_middle.getValueAsBool( "downgrade_force" ) );
-			Handle_Generic_Game_Events( current_game_action_data_middle );
-			Handle_Generic_Game_Events( current_game_action_data_end );
-		}
-		// activate level exit
-		else if( current_game_action == GA_ACTIVATE_LEVEL_EXIT )
-		{
-			Handle_Generic_Game_Events( current_game_action_data_start );
-			cLevel_Exit *level_exit = static_cast<cLevel_Exit *>(current_game_action_ptr);
-			level_exit->Activate();
-			Handle_Generic_Game_Events( current_game_action_data_middle );
-			Handle_Generic_Game_Events( current_game_action_data_end );
-		}
-		// full events
-		else
+		Handle_Generic_Game_Events( current_game_action_data_start );
+
+		/* continue when the screen is covered
+		 * the game keeps drawing the fadeout while the next level is read in the background
+		*/
+		if( pScreen_Transition->Is_Fading_Out() )
 		{
-			GameMode new_mode = MODE_NOTHING;
+			pending_game_action = current_game_action;
+			pending_game_action_data_middle = current_game_action_data_middle;
+			pending_game_action_data_end = current_game_action_data_end;
+			pending_game_action_ptr = current_game_action_ptr;
 
-			if( current_game_action == GA_ENTER_LEVEL )
-			{
-				new_mode = MODE_LEVEL;
-			}
-			else if( current_game_action == GA_ENTER_WORLD )
-			{
-				new_mode = MODE_OVERWORLD;
-			}
-			else if( current_game_action == GA_ENTER_MENU )
-			{
-				new_mode = MODE_MENU;
-			}
-			else if( current_game_action == GA_ENTER_LEVEL_SETTINGS )
+			if( current_game_action_data_middle.exists( "load_level" ) )
 			{
-				new_mode = MODE_LEVEL_SETTINGS;
+				pLevel_Preloader->Start( current_game_action_data_middle.getValueAsString( "load_level" ).c_str() );
 			}
 
-			Handle_Generic_Game_Events( current_game_action_data_start );
-			Leave_Game_Mode( new_mode );
-			Handle_Generic_Game_Events( current_game_action_data_middle );
-			Enter_Game_Mode( new_mode );
-			Handle_Generic_Game_Events( current_game_action_data_end );
+			return;
 		}
+
+		Finish_Game_Action( current_game_action, current_game_action_data_middle, current_game_action_data_end, current_game_action_ptr );
 	}
 }
 
@@ -251,11 +320,11 @@ void Handle_Generic_Game_Events( const CEGUI::XMLAttributes &action_data )
 	}
 	if( action_data.exists( "screen_fadeout" ) )
 	{
-		Draw_Effect_Out( static_cast<Effect_Fadeout>(action_data.getValueAsInteger( "screen_fadeout" )), action_data.getValueAsFloat( "screen_fadeout_speed", 1 ) );
+		pScreen_Transition->Start_Out( static_cast<Effect_Fadeout>(action_data.getValueAsInteger( "screen_fadeout" )), action_data.getValueAsFloat( "screen_fadeout_speed", 1 ) );
 	}
 	if( action_data.exists( "screen_fadein" ) )
 	{
-		Draw_Effect_In( static_cast<Effect_Fadein>(action_data.getValueAsInteger( "screen_fadein" )), action_data.getValueAsFloat( "screen_fadein_speed", 1 ) );
+		pScreen_Transition->Start_In( static_cast<Effect_Fadein>(action_data.getValueAsInteger( "screen_fadein" )), action_data.getValueAsFloat( "screen_fadein_speed", 1 ) );
 	}
 	if( action_data.exists( "activate_level_entry" ) )
 	{
@@ -345,14 +414,9 @@ void Clear_Input_Events( void )
 
 void Preload_Images( bool draw_gui /* = 0 */ )
 {
-	// progress bar
-	CEGUI::ProgressBar *progress_bar = NULL;
-
 	if( draw_gui )
 	{
-		// get progress bar
-		progress_bar = static_cast<CEGUI::ProgressBar *>(CEGUI::WindowManager::getSingleton().getWindow( "progress_bar" ));
-		progress_bar->setProgress( 0 );
+		Loading_Screen_Set_Progress( 0, 0 );
 		// set loading screen text
 		Loading_Screen_Draw_Text( _("Loading Images") );
 	}
@@ -461,14 +525,81 @@ void Preload_Images( bool draw_gui /* = 0 */ )
 	unsigned int loaded_files = 0;
 	unsigned int file_count = image_files.size();
 
-	// load images
+	// image loader for the files not loaded yet
+	cImage_Loader loader( cImage_Loader::JOB_LOAD );
+
 	for( vector<std::string>::iterator itr = image_files.begin(); itr != image_files.end(); ++itr )
 	{
 		// get filename
 		std::string filename = (*itr);
 
-		// preload image
-		pVideo->Get_Surface( filename );
+		// pixmaps dir must be given
+		if( filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/" ) == std::string::npos )
+		{
+			filename.insert( 0, DATA_DIR "/" GAME_PIXMAPS_DIR "/" );
+		}
+
+		// already loaded
+		if( pImage_Manager->Get_Pointer( filename ) )
+		{
+			loaded_files++;
+			continue;
+		}
+
+		// cached images are not decoded
+		if( pVideo->m_compressed_cache )
+		{
+			cGL_Surface *image = pVideo->Load_Compressed_GL_Surface( filename );
+
+			if( image )
+			{
+				pImage_Manager->Add( image );
+				loaded_files++;
+				continue;
+			}
+		}
+
+		loader.Add( filename );
+	}
+
+	// decode the images in the background
+	loader.Start();
+
+	// create the textures
+	for( unsigned int i = 0; i < loader.Get_Count(); i++ )
+	{
+		const std::string &filename = loader.Get_Filename( i );
+
+		// keep the loading screen drawn while the workers decode
+		while( draw_gui && !loader.Wait_Done( i, 10 ) )
+		{
+			Loading_Screen_Draw();
+		}
+
+		cVideo::cSoftware_Image software_image = loader.Wait( i );
+
+		// added twice
+		if( pImage_Manager->Get_Pointer( filename ) )
+		{
+			if( software_image.m_sdl_surface )
+			{
+				SDL_FreeSurface( software_image.m_sdl_surface );
+			}
+			if( software_image.m_settings )
+			{
+				delete software_image.m_settings;
+			}
+		}
+		else if( software_image.m_sdl_surface )
+		{
+			// not found in the compressed image cache
+			cGL_Surface *image = pVideo->Create_GL_Surface( filename, software_image, 1, pVideo->m_compressed_cache != NULL );
+
+			if( image )
+			{
+				pImage_Manager->Add( image );
+			}
+		}
 
 		// count files
 		loaded_files++;
@@ -476,11 +607,13 @@ void Preload_Images( bool draw_gui /* = 0 */ )
 		if( draw_gui )
 		{
 			// update progress
-			progress_bar->setProgress( static_cast<float>(loaded_files) / static_cast<float>(file_count) );
-
+			Loading_Screen_Set_Progress( loaded_files, file_count );
 			Loading_Screen_Draw();
 		}
 	}
+
+	// powerup changes only use the resolved player images
+	cLevel_Player::Build_Image_Sets();
 }
 
 void Preload_Sounds( bool draw_gui /* = 0 */ )
@@ -491,14 +624,9 @@ void Preload_Sounds( bool draw_gui /* = 0 */ )
 		return;
 	}
 
-	// progress bar
-	CEGUI::ProgressBar *progress_bar = NULL;
-
 	if( draw_gui )
 	{
-		// get progress bar
-		progress_bar = static_cast<CEGUI::ProgressBar *>(CEGUI::WindowManager::getSingleton().getWindow( "progress_bar" ));
-		progress_bar->setProgress( 0 );
+		Loading_Screen_Set_Progress( 0, 0 );
 		// set loading screen text
 		Loading_Screen_Draw_Text( _("Loading Sounds") );
 	}
@@ -599,6 +727,13 @@ void Preload_Sounds( bool draw_gui /* = 0 */ )
 		// get filename
 		std::string filename = (*itr);
 
+		// decode it in the background and add it with the next audio update
+		if( !draw_gui )
+		{
+			pAudio->Preload_Sound( filename );
+			continue;
+		}
+
 		// preload it
 		pAudio->Get_Sound_File( filename );
 
@@ -608,22 +743,36 @@ void Preload_Sounds( bool draw_gui /* = 0 */ )
 		if( draw_gui )
 		{
 			// update progress
-			progress_bar->setProgress( static_cast<float>(loaded_files) / static_cast<float>(file_count) );
-
+			Loading_Screen_Set_Progress( loaded_files, file_count );
 			Loading_Screen_Draw();
 		}
 	}
 }
 
-void Write_Property( CEGUI::XMLSerializer &stream, const CEGUI::String &name, CEGUI::String val )
+void Update_Memory_Counters( void )
+{
+	pImage_Manager->Update_Memory_Counters();
+	pSound_Manager->Update_Memory_Counter();
+	pFont->Update_Memory_Counter();
+}
+
+void Write_Property( cXml_Writer &stream, const char *name, const char *val, size_t length )
 {
+	stream.Open_Tag( "property" ).Attribute( "name", name );
+
 	// CEGUI doesn't handle line breaks
-	cegui_string_replace_all( val, "\n", "<br/>" );
+	if( memchr( val, '\n', length ) )
+	{
+		std::string str( val, length );
+		string_replace_all( str, "\n", "<br/>" );
+		stream.Attribute( "value", str );
+	}
+	else
+	{
+		stream.Attribute( "value", val, length );
+	}
 
-	stream.openTag( "property" )
-		.attribute( "name", name )
-		.attribute( "value", val )
-		.closeTag();
+	stream.Close_Tag();
 }
 
 void Relocate_Image( CEGUI::XMLAttributes &xml_attributes, const std::string &filename_old, const std::string &filename_new, const CEGUI::String &attribute_name /* = "image" */ )
@@ -49,6 +49,10 @@ extern int game_res_h;
 // global debugging
 extern bool game_debug;
 extern bool game_debug_performance;
+// if set moving sprites check every step for collisions
+extern bool game_debug_collision_steps;
+// if set the number of drawn fragments of every pixel is shown as heatmap
+extern bool game_debug_overdraw;
 
 // Game Input event
 extern SDL_Event input_event;
@@ -99,30 +103,48 @@ void Preload_Images( bool draw_gui = 0 );
 
 /* Preload the common sounds into the sound manager
  * draw_gui : if set use the loading screen gui for drawing
+ * if not set the sounds are only queued for the background decoding
  */
 void Preload_Sounds( bool draw_gui = 0 );
 
-// Write a property line to the serializer
-void Write_Property( CEGUI::XMLSerializer &stream, const CEGUI::String &name, CEGUI::String val );
-inline void Write_Property( CEGUI::XMLSerializer &stream, const CEGUI::String &name, int val )
+/* Count the memory of the images, sounds and fonts for their memory counters
+ * the other memory counters are counted with every allocation
+ */
+void Update_Memory_Counters( void );
+
+// Write a property line to the xml writer
+void Write_Property( cXml_Writer &stream, const char *name, const char *val, size_t length );
+inline void Write_Property( cXml_Writer &stream, const char *name, const char *val )
+{
+	Write_Property( stream, name, val, strlen( val ) );
+};
+inline void Write_Property( cXml_Writer &stream, const char *name, const std::string &val )
+{
+	Write_Property( stream, name, val.data(), val.length() );
+};
+inline void Write_Property( cXml_Writer &stream, const char *name, const CEGUI::String &val )
+{
+	Write_Property( stream, name, val.c_str() );
+};
+inline void Write_Property( cXml_Writer &stream, const char *name, int val )
 {
-	Write_Property( stream, name, CEGUI::PropertyHelper::intToString( val ) );
+	stream.Open_Tag( "property" ).Attribute( "name", name ).Attribute( "value", val ).Close_Tag();
 };
-inline void Write_Property( CEGUI::XMLSerializer &stream, const CEGUI::String &name, unsigned int val )
+inline void Write_Property( cXml_Writer &stream, const char *name, unsigned int val )
 {
-	Write_Property( stream, name, CEGUI::PropertyHelper::uintToString( val ) );
+	stream.Open_Tag( "property" ).Attribute( "name", name ).Attribute( "value", val ).Close_Tag();
 };
-inline void Write_Property( CEGUI::XMLSerializer &stream, const CEGUI::String &name, Uint64 val )
+inline void Write_Property( cXml_Writer &stream, const char *name, Uint64 val )
 {
-	Write_Property( stream, name, int64_to_string( val ) );
+	stream.Open_Tag( "property" ).Attribute( "name", name ).Attribute( "value", val ).Close_Tag();
 };
-inline void Write_Property( CEGUI::XMLSerializer &stream, const CEGUI::String &name, long val )
+inline void Write_Property( cXml_Writer &stream, const char *name, long val )
 {
-	Write_Property( stream, name, long_to_string( val ) );
+	stream.Open_Tag( "property" ).Attribute( "name", name ).Attribute( "value", val ).Close_Tag();
 };
-inline void Write_Property( CEGUI::XMLSerializer &stream, const CEGUI::String &name, float val )
+inline void Write_Property( cXml_Writer &stream, const char *name, float val )
 {
-	Write_Property( stream, name, CEGUI::PropertyHelper::floatToString( val ) );
+	stream.Open_Tag( "property" ).Attribute( "name", name ).Attribute( "value", val ).Close_Tag();
 };
 
 // Changes the image path in the given xml attributes to the new one
@@ -16,11 +16,6 @@
 #ifndef SMC_GLOBAL_BASIC_H
 #define SMC_GLOBAL_BASIC_H
 
-/* uncomment to enable experimental rendering in a thread
-* still randomly crashes because gl functions are called while the render thread is active
-*/
-//#define SMC_RENDER_THREAD_TEST
-
 /* *** *** *** *** *** *** *** Debugging *** *** *** *** *** *** *** *** *** *** */
 
 #ifdef _WIN32
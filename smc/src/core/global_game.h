@@ -188,6 +188,8 @@ enum LevelLandType
 #define GAME_ICON_DIR "icon"
 #define GAME_SCHEMA_DIR "schema"
 #define GAME_TRANSLATION_DIR "translations"
+// packed data directory files in the data directory
+#define DATA_ARCHIVE_FILE "data.smcpak"
 // GUI
 #define GUI_SCHEME_DIR "gui/schemes"
 #define GUI_IMAGESET_DIR "gui/imagesets"
@@ -201,6 +203,15 @@ enum LevelLandType
 #define USER_WORLD_DIR "worlds"
 #define USER_CAMPAIGN_DIR "campaign"
 #define USER_IMGCACHE_DIR "cache"
+#define USER_IMGCACHE_IMAGES_DIR "images"
+#define USER_IMGCACHE_SETTINGS_INDEX "image_settings.idx"
+#define USER_IMGCACHE_MANIFEST "image_cache.idx"
+#define USER_LEVEL_CACHE_DIR "cache/levels"
+#define USER_PREVIEW_CACHE_DIR "cache/previews"
+#define USER_SOUND_CACHE_DIR "cache/sounds"
+#define USER_XML_VALIDATION_INDEX "validated_xml.idx"
+#define USER_LEVEL_INDEX "levels.idx"
+#define USER_EDITOR_CATALOGUE "editor_items.idx"
 
 /* *** *** *** *** *** *** *** forward declarations *** *** *** *** *** *** *** *** *** *** */
 
@@ -344,6 +355,46 @@ enum Col_Valid_Type
 	COL_VTYPE_NOT_POSSIBLE = 3
 };
 
+/* *** collision massive type masks *** */
+
+enum Col_Massive_Mask
+{
+	COL_MASK_NONE = 0,
+	COL_MASK_PASSIVE = 1 << MASS_PASSIVE,
+	COL_MASK_MASSIVE = 1 << MASS_MASSIVE,
+	COL_MASK_HALFMASSIVE = 1 << MASS_HALFMASSIVE,
+	COL_MASK_CLIMBABLE = 1 << MASS_CLIMBABLE,
+	COL_MASK_ALL = COL_MASK_PASSIVE | COL_MASK_MASSIVE | COL_MASK_HALFMASSIVE | COL_MASK_CLIMBABLE
+};
+
+/* *** collision layers ***
+ * every sprite is in one layer
+ * and moving sprites only query the layers in their collision layer mask
+*/
+
+enum Col_Layer
+{
+	// hud, animations and undefined sprites never collide
+	COL_LAYER_NONE = 0,
+	// passive decoration
+	COL_LAYER_DECORATION = 1 << 0,
+	// other basic sprites
+	COL_LAYER_SOLID = 1 << 1,
+	// special objects like boxes, level exits and moving platforms
+	COL_LAYER_ACTIVE = 1 << 2,
+	// powerups and goldpieces
+	COL_LAYER_ITEM = 1 << 3,
+	// fireballs and iceballs
+	COL_LAYER_PROJECTILE = 1 << 4,
+	// enemies
+	COL_LAYER_ENEMY = 1 << 5,
+	// player
+	COL_LAYER_PLAYER = 1 << 6,
+	// every layer which can collide with a moving sprite
+	COL_LAYER_OBJECTS = COL_LAYER_SOLID | COL_LAYER_ACTIVE | COL_LAYER_ITEM | COL_LAYER_PROJECTILE | COL_LAYER_ENEMY | COL_LAYER_PLAYER,
+	COL_LAYER_ALL = COL_LAYER_DECORATION | COL_LAYER_OBJECTS
+};
+
 /* *** Input identifier *** */
 
 enum input_identifier
@@ -385,56 +436,33 @@ enum ball_effect
 	ICEBALL_EXPLOSION = 4
 };
 
-/* *** Performance timer types *** */
-
-enum performance_timer_type
-{
-	// update
-	PERF_UPDATE_PROCESS_INPUT = 0,
-	PERF_UPDATE_LEVEL = 1,
-	PERF_UPDATE_LEVEL_EDITOR = 2,
-	PERF_UPDATE_HUD = 3,
-	PERF_UPDATE_PLAYER = 4,
-	PERF_UPDATE_PLAYER_COLLISIONS = 23,
-	PERF_UPDATE_LATE_LEVEL = 22,
-	PERF_UPDATE_LEVEL_COLLISIONS = 5,
-	PERF_UPDATE_CAMERA = 6,
-	// update overworld
-	PERF_UPDATE_OVERWORLD = 17,
-	// update menu
-	PERF_UPDATE_MENU = 18,
-	// update level settings
-	PERF_UPDATE_LEVEL_SETTINGS = 19,
-	// draw level
-	PERF_DRAW_LEVEL_LAYER1 = 7,
-	PERF_DRAW_LEVEL_PLAYER = 8,
-	PERF_DRAW_LEVEL_LAYER2 = 9,
-	PERF_DRAW_LEVEL_HUD = 10,
-	PERF_DRAW_LEVEL_EDITOR = 11,
-	// draw overworld
-	PERF_DRAW_OVERWORLD = 16,
-	// draw menu
-	PERF_DRAW_MENU = 14,
-	// draw level settings
-	PERF_DRAW_LEVEL_SETTINGS = 15,
-	// draw
-	PERF_DRAW_MOUSE = 12,
-	// rendering
-	PERF_RENDER_GAME = 13,
-	PERF_RENDER_GUI = 20,
-	PERF_RENDER_BUFFER = 21
-};
-
 /* *** Classes *** */
 
+class cAnimation_Manager;
 class cCamera;
 class cCircle_Request;
+class cCollision_Workers;
+class cCompressed_Image_Cache;
+class cEditor;
+class cEngine_Context;
+class cEditor_Catalogue;
+class cEditor_Catalogue_Item;
+class cEditor_Grid;
+class cEditor_History;
 class cEditor_Object_Settings_Item;
+class cFramerate;
 class cGL_Surface;
 class cGradient_Request;
+class cHud_Manager;
+class cImage_Loader;
 class cImage_Settings_Data;
+class cImage_Settings_Parser;
 class cLayer_Line_Point_Start;
 class cLevel;
+class cLevel_Binary;
+class cLevel_Lint;
+class cLevel_Player;
+class cLevel_Preview;
 class cLine_collision;
 class cLine_Request;
 class cLevel_Settings;
@@ -444,16 +472,30 @@ class cObjectCollision;
 class cOverworld;
 class cOverworld_Player;
 class cParticle_Emitter;
+class cParticle_Seed_Buffer;
+class cParticle_Shader;
 class cPath;
 class cPath_State;
 class cRect_Request;
+class cRenderQueue;
+class cRender_Request_Advanced;
+class cRender_Target;
+class cSave;
+class cSave_Info;
 class cSave_Level_Object;
+class cSavegame_Writer;
 class cSaved_Texture;
 class cSize_Float;
 class cSize_Int;
+class cSprite_Grid;
 class cSprite_Manager;
+class cSprite_Shader;
 class cSurface_Request;
 class cSprite;
+class cTexture_Upload;
+class cGPU_Timer;
+class cScreenshot_Writer;
+class cImage_Cache_Updater;
 class cWorld_Sprite_Manager;
 class Color;
 class GL_rect;
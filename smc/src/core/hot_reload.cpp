@@ -0,0 +1,302 @@
+/***************************************************************************
+ * hot_reload.cpp  -  reloads changed files while running
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/hot_reload.h"
+#include "../core/game_core.h"
+#include "../core/camera.h"
+#include "../core/filesystem/filesystem.h"
+#include "../user/preferences.h"
+#include "../video/video.h"
+#include "../video/img_manager.h"
+#include "../video/img_settings.h"
+#include "../video/image_cache.h"
+#include "../audio/sound_manager.h"
+#include "../level/level.h"
+#include "../level/level_player.h"
+// std
+#include <algorithm>
+#include <cstdio>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cHot_Reload *** *** *** *** *** *** *** *** *** *** */
+
+cHot_Reload :: cHot_Reload( void )
+{
+	m_next = 0;
+	m_image_count = 0;
+	m_sound_count = 0;
+}
+
+cHot_Reload :: ~cHot_Reload( void )
+{
+	//
+}
+
+void cHot_Reload :: Update( void )
+{
+	if( !pPreferences->m_hot_reload )
+	{
+		// start again with the current times if enabled
+		if( !m_files.empty() )
+		{
+			m_files.clear();
+			m_times.clear();
+			m_next = 0;
+			m_image_count = 0;
+			m_sound_count = 0;
+			m_level_filename.clear();
+		}
+
+		return;
+	}
+
+	// a new pass
+	if( m_next >= m_files.size() )
+	{
+		m_next = 0;
+		Update_Watches();
+	}
+
+	const unsigned int end = std::min( m_next + m_checks_per_frame, static_cast<unsigned int>(m_files.size()) );
+	vector<std::string> changed;
+
+	for( ; m_next < end; m_next++ )
+	{
+		const std::string &filename = m_files[m_next];
+		const time_t time = Get_File_Modification_Time( filename );
+		time_t &last_time = m_times[filename];
+
+		// removed or not changed
+		if( !time || time == last_time )
+		{
+			continue;
+		}
+
+		last_time = time;
+		changed.push_back( filename );
+	}
+
+	// reloading can change the watched files
+	for( vector<std::string>::iterator itr = changed.begin(); itr != changed.end(); ++itr )
+	{
+		Reload_File( *itr );
+	}
+}
+
+void cHot_Reload :: Reload_File( const std::string &filename )
+{
+	debug_print( "Info : hot reloading %s\n", filename.c_str() );
+
+	// image cache files created from it
+	if( pVideo->m_image_cache_updater )
+	{
+		pVideo->m_image_cache_updater->Invalidate( filename );
+	}
+
+	Reload_Images( filename );
+	Reload_Sounds( filename );
+
+	if( !m_level_filename.empty() && filename == m_level_filename )
+	{
+		Reload_Level();
+	}
+}
+
+void cHot_Reload :: Update_Watches( void )
+{
+	std::string level_filename;
+
+	if( Game_Mode == MODE_LEVEL && pActive_Level->Is_Loaded() )
+	{
+		level_filename = pActive_Level->m_level_filename;
+	}
+
+	// nothing loaded or unloaded
+	if( !m_files.empty() && pImage_Manager->size() == m_image_count && pSound_Manager->size() == m_sound_count && level_filename == m_level_filename )
+	{
+		return;
+	}
+
+	m_image_count = pImage_Manager->size();
+	m_sound_count = pSound_Manager->size();
+	m_level_filename = level_filename;
+
+	vector<std::string> files;
+
+	for( GL_Surface_List::const_iterator itr = pImage_Manager->objects.begin(); itr != pImage_Manager->objects.end(); ++itr )
+	{
+		Get_Image_Files( *itr, files );
+	}
+
+	for( SoundList::const_iterator itr = pSound_Manager->objects.begin(); itr != pSound_Manager->objects.end(); ++itr )
+	{
+		if( !(*itr)->m_filename.empty() )
+		{
+			files.push_back( (*itr)->m_filename );
+		}
+	}
+
+	if( !m_level_filename.empty() )
+	{
+		files.push_back( m_level_filename );
+	}
+
+	// images often share settings files
+	std::sort( files.begin(), files.end() );
+	files.erase( std::unique( files.begin(), files.end() ), files.end() );
+
+	// keep the times of the already watched files to not miss a change
+	Time_Map times;
+
+	for( vector<std::string>::const_iterator itr = files.begin(); itr != files.end(); ++itr )
+	{
+		Time_Map::const_iterator found = m_times.find( *itr );
+
+		if( found != m_times.end() )
+		{
+			times[*itr] = found->second;
+		}
+		else
+		{
+			times[*itr] = Get_File_Modification_Time( *itr );
+		}
+	}
+
+	m_files.swap( files );
+	m_times.swap( times );
+}
+
+void cHot_Reload :: Get_Image_Files( const cGL_Surface *image, vector<std::string> &files )
+{
+	if( !image || image->m_filename.empty() )
+	{
+		return;
+	}
+
+	std::string image_filename = image->m_filename;
+	std::string settings_filename = image->m_filename;
+
+	if( settings_filename.rfind( ".settings" ) == std::string::npos )
+	{
+		settings_filename.erase( settings_filename.rfind( "." ) + 1 );
+		settings_filename.insert( settings_filename.rfind( "." ) + 1, "settings" );
+	}
+	else
+	{
+		image_filename = settings_filename.substr( 0, settings_filename.rfind( ".settings" ) ) + ".png";
+	}
+
+	if( File_Exists( settings_filename ) )
+	{
+		// the settings file and its base settings files
+		vector<std::string> settings_files;
+		cImage_Settings_Data *settings = pImage_Settings_Cache->Get( settings_filename, &settings_files );
+
+		if( settings )
+		{
+			if( !settings->m_base.empty() )
+			{
+				image_filename = pVideo->Get_Base_Image_Filename( image_filename, settings->m_base );
+			}
+
+			delete settings;
+			files.insert( files.end(), settings_files.begin(), settings_files.end() );
+		}
+		else
+		{
+			files.push_back( settings_filename );
+		}
+	}
+
+	files.push_back( image_filename );
+}
+
+void cHot_Reload :: Reload_Images( const std::string &filename )
+{
+	bool reloaded = 0;
+	vector<std::string> files;
+
+	for( GL_Surface_List::iterator itr = pImage_Manager->objects.begin(); itr != pImage_Manager->objects.end(); ++itr )
+	{
+		cGL_Surface *image = (*itr);
+
+		files.clear();
+		Get_Image_Files( image, files );
+
+		if( std::find( files.begin(), files.end(), filename ) == files.end() )
+		{
+			continue;
+		}
+
+		if( image->Reload() )
+		{
+			reloaded = 1;
+		}
+	}
+
+	// texture ids and coordinates changed
+	if( reloaded )
+	{
+		pImage_Manager->m_texture_generation++;
+	}
+}
+
+void cHot_Reload :: Reload_Sounds( const std::string &filename )
+{
+	for( SoundList::iterator itr = pSound_Manager->objects.begin(); itr != pSound_Manager->objects.end(); ++itr )
+	{
+		cSound *sound = (*itr);
+
+		if( sound->m_filename == filename )
+		{
+			sound->Reload();
+		}
+	}
+}
+
+void cHot_Reload :: Reload_Level( void )
+{
+	// the editor saves the level itself and its changes would be lost
+	if( !pPreferences->m_hot_reload_level || editor_enabled || Game_Mode != MODE_LEVEL )
+	{
+		return;
+	}
+
+	const float player_x = pLevel_Player->m_pos_x;
+	const float player_y = pLevel_Player->m_pos_y;
+	const float camera_x = pActive_Camera->m_x;
+	const float camera_y = pActive_Camera->m_y;
+
+	if( !pActive_Level->Load( Trim_Filename( pActive_Level->m_level_filename, 0 ) ) )
+	{
+		printf( "Warning : Hot reload of level %s failed\n", m_level_filename.c_str() );
+		return;
+	}
+
+	pActive_Level->Init();
+
+	pLevel_Player->Set_Pos( player_x, player_y );
+	pActive_Camera->Set_Pos( camera_x, camera_y );
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+cHot_Reload *pHot_Reload = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,88 @@
+/***************************************************************************
+ * hot_reload.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_HOT_RELOAD_H
+#define SMC_HOT_RELOAD_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+// boost
+#include <boost/unordered_map.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cHot_Reload *** *** *** *** *** *** *** *** *** *** */
+
+/* Reloads changed files while the game is running
+ * the modification times of the files used by the loaded images and sounds
+ * and of the active level are checked with a few files every frame
+ * a changed image or image settings file removes the image cache files using it
+ * and loads the images using it again in place
+ * a changed sound file is loaded again in place
+ * a changed level file loads the level again and keeps the player and camera position
+ * only active with the hot reload preference
+*/
+class cHot_Reload
+{
+public:
+	cHot_Reload( void );
+	~cHot_Reload( void );
+
+	// Check the next watched files and reload the changed ones
+	void Update( void );
+	// Reload everything using the file
+	void Reload_File( const std::string &filename );
+
+	// files checked every frame
+	static const unsigned int m_checks_per_frame = 64;
+
+private:
+	// Create the watched files again if the loaded images, sounds or the active level changed
+	void Update_Watches( void );
+	// Add the image and image settings files used by the image
+	static void Get_Image_Files( const cGL_Surface *image, vector<std::string> &files );
+
+	// Reload the images using the file
+	void Reload_Images( const std::string &filename );
+	// Reload the sounds loaded from the file
+	void Reload_Sounds( const std::string &filename );
+	// Reload the active level keeping the player and camera position
+	void Reload_Level( void );
+
+	// watched files
+	vector<std::string> m_files;
+	// last modification time of the watched files
+	typedef boost::unordered_map<std::string, time_t> Time_Map;
+	Time_Map m_times;
+	// next checked file
+	unsigned int m_next;
+
+	// image and sound count and level file of the watched files
+	unsigned int m_image_count;
+	unsigned int m_sound_count;
+	std::string m_level_filename;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+// Hot Reload
+extern cHot_Reload *pHot_Reload;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
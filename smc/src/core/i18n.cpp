@@ -17,12 +17,18 @@
 #include "../core/i18n.h"
 #include "SDL.h"
 #include "SDL_opengl.h"
+// boost
+#include <boost/unordered_map.hpp>
 
 namespace SMC
 {
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
+// translations by string literal address
+typedef boost::unordered_map<const char *, std::string> Cached_Translation_Map;
+static Cached_Translation_Map cached_translations;
+
 void I18N_Init( void )
 {
 	const char *sys_locale = setlocale( LC_ALL, "" );
@@ -148,6 +154,21 @@ void I18N_Set_Language( const std::string &language )
 #else
 	setenv( "LANGUAGE", language.c_str(), 1 );
 #endif
+
+	// translated again in the new language
+	cached_translations.clear();
+}
+
+const std::string &I18N_Get_Cached_Translation( const char *str )
+{
+	Cached_Translation_Map::iterator itr = cached_translations.find( str );
+
+	if( itr != cached_translations.end() )
+	{
+		return itr->second;
+	}
+
+	return cached_translations[str] = gettext( str );
 }
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
@@ -30,12 +30,21 @@ namespace SMC
 #define UTF8_(String) reinterpret_cast<CEGUI::utf8*>(gettext(String))
 // not translated and only for gettext detection
 #define N_(String) String
+// translates the constant string once per language and returns the cached std::string
+#define C_(String) I18N_Get_Cached_Translation(String)
 
 // init internationalization
 void I18N_Init( void );
 // set language
 void I18N_Set_Language( const std::string &default_language );
 
+/* Returns the cached translation of the string literal
+ * the translations are cached by the string address and cleared if the language changes
+ * for text built every frame which would otherwise translate and allocate each time
+ * only use it from the main thread
+*/
+const std::string &I18N_Get_Cached_Translation( const char *str );
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 } // namespace SMC
@@ -0,0 +1,161 @@
+/***************************************************************************
+ * init_tasks.cpp  -  runs the startup as a graph of tasks
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/init_tasks.h"
+#include "../core/framerate.h"
+#include "../core/task_pool.h"
+#include <boost/bind.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cInit_Tasks *** *** *** *** *** *** *** *** *** *** */
+
+cInit_Tasks :: cInit_Tasks( void )
+{
+	m_finished = 0;
+	m_start_time = 0;
+	m_task_group = pTask_Pool->Create_Group();
+}
+
+cInit_Tasks :: ~cInit_Tasks( void )
+{
+	pTask_Pool->Wait( m_task_group );
+}
+
+unsigned int cInit_Tasks :: Add( const char *name, Task_Function function, bool main_thread )
+{
+	Task task;
+	task.m_name = name;
+	task.m_function = function;
+	task.m_main_thread = main_thread;
+	task.m_waiting = 0;
+	task.m_started = 0;
+	task.m_start_time = 0;
+	task.m_end_time = 0;
+
+	m_tasks.push_back( task );
+
+	return m_tasks.size() - 1;
+}
+
+void cInit_Tasks :: Depends( unsigned int task, unsigned int dependency )
+{
+	m_tasks[dependency].m_dependents.push_back( task );
+	m_tasks[task].m_waiting++;
+}
+
+void cInit_Tasks :: Run( void )
+{
+	m_start_time = Get_Microseconds();
+	m_finished = 0;
+
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	Start_Pool_Tasks();
+
+	while( m_finished < m_tasks.size() )
+	{
+		const int num = Get_Ready_Task();
+
+		if( num < 0 )
+		{
+			m_condition.wait( lock );
+			continue;
+		}
+
+		Run_Task( num, lock );
+	}
+
+	lock.unlock();
+	// the last pool task can still be returning
+	pTask_Pool->Wait( m_task_group );
+}
+
+void cInit_Tasks :: Print_Times( void ) const
+{
+	for( Task_List::const_iterator itr = m_tasks.begin(); itr != m_tasks.end(); ++itr )
+	{
+		const Task &task = (*itr);
+
+		printf( "Init task %s : %.1f ms at %.1f ms%s\n", task.m_name, ( task.m_end_time - task.m_start_time ) / 1000.0, task.m_start_time / 1000.0, task.m_main_thread ? "" : " (worker)" );
+	}
+
+	printf( "Init took %.1f ms\n", ( Get_Microseconds() - m_start_time ) / 1000.0 );
+}
+
+void cInit_Tasks :: Pool_Task( unsigned int num )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+	Run_Task( num, lock );
+}
+
+void cInit_Tasks :: Start_Pool_Tasks( void )
+{
+	for( unsigned int i = 0; i < m_tasks.size(); i++ )
+	{
+		Task &task = m_tasks[i];
+
+		if( task.m_main_thread || task.m_started || task.m_waiting )
+		{
+			continue;
+		}
+
+		task.m_started = 1;
+		pTask_Pool->Add( boost::bind( &cInit_Tasks::Pool_Task, this, i ), TASK_PRIORITY_BACKGROUND, m_task_group, task.m_name );
+	}
+}
+
+int cInit_Tasks :: Get_Ready_Task( void ) const
+{
+	for( unsigned int i = 0; i < m_tasks.size(); i++ )
+	{
+		const Task &task = m_tasks[i];
+
+		if( task.m_main_thread && !task.m_started && !task.m_waiting )
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+void cInit_Tasks :: Run_Task( unsigned int num, boost::mutex::scoped_lock &lock )
+{
+	m_tasks[num].m_started = 1;
+	m_tasks[num].m_start_time = Get_Microseconds() - m_start_time;
+
+	// the task is only used by this thread until it is finished
+	lock.unlock();
+	m_tasks[num].m_function();
+	lock.lock();
+
+	Task &task = m_tasks[num];
+	task.m_end_time = Get_Microseconds() - m_start_time;
+
+	for( vector<unsigned int>::iterator itr = task.m_dependents.begin(); itr != task.m_dependents.end(); ++itr )
+	{
+		m_tasks[(*itr)].m_waiting--;
+	}
+
+	m_finished++;
+	Start_Pool_Tasks();
+	m_condition.notify_all();
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
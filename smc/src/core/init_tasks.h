@@ -0,0 +1,110 @@
+/***************************************************************************
+ * init_tasks.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_INIT_TASKS_H
+#define SMC_INIT_TASKS_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL.h"
+// boost
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cInit_Tasks *** *** *** *** *** *** *** *** *** *** */
+
+/* Runs the startup as a graph of tasks
+ * a task starts when all its dependencies are finished
+ * main thread tasks are run by the calling thread and the others as task pool background tasks
+ * tasks using opengl, CEGUI or the loading screen must be main thread tasks
+*/
+class cInit_Tasks
+{
+public:
+	typedef boost::function<void ( void )> Task_Function;
+
+	cInit_Tasks( void );
+	~cInit_Tasks( void );
+
+	/* Add a task and return its number
+	 * name : must stay valid as it is not copied
+	 * main_thread : if set it is run by the thread calling Run
+	*/
+	unsigned int Add( const char *name, Task_Function function, bool main_thread );
+	// The task is only started after the dependency is finished
+	void Depends( unsigned int task, unsigned int dependency );
+
+	/* Run all tasks and wait until they are finished
+	 * the dependencies must not be circular
+	*/
+	void Run( void );
+
+	// Print the time of each task and of the whole startup
+	void Print_Times( void ) const;
+
+private:
+	// Task pool function running the task
+	void Pool_Task( unsigned int num );
+	/* Add the ready tasks which are not main thread tasks to the task pool
+	 * must be called with the mutex locked
+	*/
+	void Start_Pool_Tasks( void );
+	/* Returns the next ready main thread task or -1 if none
+	 * must be called with the mutex locked
+	*/
+	int Get_Ready_Task( void ) const;
+	/* Run the task with the mutex unlocked and start its dependents
+	 * must be called with the lock held
+	*/
+	void Run_Task( unsigned int num, boost::mutex::scoped_lock &lock );
+
+	struct Task
+	{
+		const char *m_name;
+		Task_Function m_function;
+		bool m_main_thread;
+		// tasks waiting for this one
+		vector<unsigned int> m_dependents;
+		// unfinished dependencies
+		unsigned int m_waiting;
+		bool m_started;
+		// microseconds from the start of Run until started and finished
+		Uint64 m_start_time;
+		Uint64 m_end_time;
+	};
+
+	typedef vector<Task> Task_List;
+	Task_List m_tasks;
+
+	// task pool group of the tasks which are not main thread tasks
+	unsigned int m_task_group;
+	// protects the task states and the finished count
+	boost::mutex m_mutex;
+	// notified if a task is finished
+	boost::condition_variable m_condition;
+	unsigned int m_finished;
+	// start of Run
+	Uint64 m_start_time;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -18,15 +18,26 @@
 #include "../core/main.h"
 #include "../core/filesystem/resource_manager.h"
 #include "../core/filesystem/filesystem.h"
+#include "../core/filesystem/resource_archive.h"
 #include "../level/level.h"
+#include "../level/level_binary.h"
+#include "../level/level_prefetch.h"
+#include "../level/level_saver.h"
+#include "../level/level_index.h"
 #include "../gui/menu.h"
 #include "../core/framerate.h"
+#include "../core/profiler.h"
+#include "../core/object_profiler.h"
+#include "../core/memory_pool.h"
 #include "../video/font.h"
 #include "../user/preferences.h"
 #include "../audio/sound_manager.h"
 #include "../audio/audio.h"
 #include "../level/level_editor.h"
 #include "../overworld/world_editor.h"
+#include "../core/editor_catalogue.h"
+#include "../core/editor_autosave.h"
+#include "../core/hot_reload.h"
 #include "../input/joystick.h"
 #include "../overworld/world_manager.h"
 #include "../overworld/overworld.h"
@@ -34,9 +45,27 @@
 #include "../input/mouse.h"
 #include "../user/savegame.h"
 #include "../input/keyboard.h"
+#include "../input/input_recorder.h"
 #include "../video/renderer.h"
+#include "../video/texture_atlas.h"
+#include "../video/gl_state.h"
+#include "../video/screen_transition.h"
+#include "../core/frame_scheduler.h"
 #include "../core/i18n.h"
+#include "../core/collision_workers.h"
+#include "../core/update_workers.h"
+#include "../video/animation.h"
+#include "../core/benchmark.h"
+#include "../level/level_generator.h"
+#include "../core/init_tasks.h"
+#include "../core/math/random.h"
+#include "../core/property_helper.h"
 #include "../gui/generic.h"
+#include "../gui/resource_provider.h"
+#include "../core/task_pool.h"
+#ifdef SMC_MICRO_BENCHMARK
+#include "../core/micro_benchmark.h"
+#endif
 
 #ifdef __APPLE__
 // needed for datapath detection
@@ -46,6 +75,8 @@
 
 // CEGUI
 #include "CEGUIDefaultLogger.h"
+// boost
+#include <boost/bind.hpp>
 
 // SMC namespace is set later to exclude main() from it
 using namespace SMC;
@@ -104,6 +135,35 @@ int main( int argc, char **argv )
 
 	// convert arguments to a vector string
 	vector<std::string> arguments( argv, argv + argc );
+	// run the collision benchmark instead of the game
+	bool benchmark = 0;
+	// run the level benchmark with this level or all game levels instead of the collision benchmark
+	std::string benchmark_level;
+	unsigned int benchmark_frames = 1000;
+	bool benchmark_render = 0;
+	// generate a stress level with this object count instead of running the game
+	unsigned int generate_level_objects = 0;
+	// run the level benchmark with generated stress levels of increasing size
+	bool scaling_benchmark = 0;
+	// object mix of the generated stress levels
+	cStress_Level_Mix stress_level_mix;
+	// pack the data directory into the resource archive instead of running the game
+	bool pack_data = 0;
+	std::string pack_data_filename = DATA_DIR "/" DATA_ARCHIVE_FILE;
+	// compile this level into the level cache instead of running the game
+	std::string compile_level;
+	// save this compiled level as XML level file instead of running the game
+	std::string decompile_level;
+	std::string decompile_level_xml;
+	// profile the loading of the command line level instead of running the game
+	bool profile_load = 0;
+	bool profile_load_json = 0;
+	// capture the given number of frames as trace events
+	unsigned int trace_frames = 0;
+	std::string trace_filename;
+	// record the input to this file or replay it
+	std::string record_filename;
+	std::string replay_filename;
 
 	if( argc >= 2 )
 	{
@@ -116,9 +176,22 @@ int main( int argc, char **argv )
 				printf( "Where OPTIONS is one of the following:\n" );
 				printf( "-h, --help\tDisplay this message\n" );
 				printf( "-v, --version\tShow the version of %s\n", CAPTION );
-				printf( "-d, --debug\tEnable debug modes with the options : game performance\n" );
+				printf( "-d, --debug\tEnable debug modes with the options : game performance collision_steps\n" );
 				printf( "-l, --level\tLoad the given level\n" );
 				printf( "-w, --world\tLoad the given world\n" );
+				printf( "-b, --benchmark\tMeasure the collision handling and exit. With a level or all for every game level measure the level update and print JSON results\n" );
+				printf( "-f, --frames\tNumber of frames for the level benchmark. Default is 1000\n" );
+				printf( "--render\tAlso draw and render the level benchmark frames\n" );
+				printf( "-g, --generate-level\tGenerate the level stress_<count> with the given object count in the user level directory and exit. The optional mix sets the amount of each kind like massive=60,enemies=20,platforms=10,emitters=5,boxes=5\n" );
+				printf( "--scaling-benchmark\tGenerate stress levels with 10000, 50000 and 100000 objects of the optional mix, measure them like the level benchmark and exit\n" );
+				printf( "-s, --seed\tLoad every level with the given random seed\n" );
+				printf( "-c, --compile-level\tCompile the given level into the level cache and exit\n" );
+				printf( "-x, --decompile-level\tSave the given compiled level as the given XML level file and exit\n" );
+				printf( "-p, --profile-load\tPrint the load time of each phase of the --level level and exit. Use the option json for JSON output\n" );
+				printf( "-t, --trace\tWrite the given number of frames as Chrome trace events to the optional JSON file\n" );
+				printf( "-r, --record\tRecord the input to the given file\n" );
+				printf( "--replay\tReplay the input of the given recording and exit when finished\n" );
+				printf( "--pack-data\tPack the data directory into the resource archive or the optional file and exit\n" );
 				return EXIT_SUCCESS;
 			}
 			// version
@@ -151,6 +224,10 @@ int main( int argc, char **argv )
 						{
 							game_debug_performance = 1;
 						}
+						else if( option_str == "collision_steps" )
+						{
+							game_debug_collision_steps = 1;
+						}
 						else
 						{
 							printf( "Unknown debug option %s\n", option_str.c_str() );
@@ -159,11 +236,186 @@ int main( int argc, char **argv )
 					}
 				}
 			}
+			// benchmark
+			else if( arguments[i] == "--benchmark" || arguments[i] == "-b" )
+			{
+				benchmark = 1;
+
+				// optional level
+				if( i + 1 < arguments.size() && arguments[i + 1].substr( 0, 1 ) != "-" )
+				{
+					i++;
+					benchmark_level = arguments[i];
+				}
+			}
+			// benchmark frames
+			else if( arguments[i] == "--frames" || arguments[i] == "-f" )
+			{
+				// no value
+				if( i + 1 >= arguments.size() )
+				{
+					printf( "%s requires a value\n", arguments[i].c_str() );
+					return EXIT_FAILURE;
+				}
+
+				i++;
+				benchmark_frames = string_to_int( arguments[i] );
+			}
+			// benchmark rendering
+			else if( arguments[i] == "--render" )
+			{
+				benchmark_render = 1;
+			}
+			// generate stress level
+			else if( arguments[i] == "--generate-level" || arguments[i] == "-g" )
+			{
+				// no value
+				if( i + 1 >= arguments.size() || string_to_int( arguments[i + 1] ) <= 0 )
+				{
+					printf( "%s requires an object count\n", arguments[i].c_str() );
+					return EXIT_FAILURE;
+				}
+
+				i++;
+				generate_level_objects = string_to_int( arguments[i] );
+
+				// optional object mix
+				if( i + 1 < arguments.size() && arguments[i + 1].substr( 0, 1 ) != "-" )
+				{
+					i++;
+
+					if( !stress_level_mix.Parse( arguments[i] ) )
+					{
+						return EXIT_FAILURE;
+					}
+				}
+			}
+			// scaling benchmark
+			else if( arguments[i] == "--scaling-benchmark" )
+			{
+				scaling_benchmark = 1;
+
+				// optional object mix
+				if( i + 1 < arguments.size() && arguments[i + 1].substr( 0, 1 ) != "-" )
+				{
+					i++;
+
+					if( !stress_level_mix.Parse( arguments[i] ) )
+					{
+						return EXIT_FAILURE;
+					}
+				}
+			}
+			// random seed
+			else if( arguments[i] == "--seed" || arguments[i] == "-s" )
+			{
+				// no value
+				if( i + 1 >= arguments.size() )
+				{
+					printf( "%s requires a value\n", arguments[i].c_str() );
+					return EXIT_FAILURE;
+				}
+
+				i++;
+				level_random_seed = static_cast<Uint32>(string_to_int( arguments[i] ));
+			}
+			// compile level
+			else if( arguments[i] == "--compile-level" || arguments[i] == "-c" )
+			{
+				// no value
+				if( i + 1 >= arguments.size() )
+				{
+					printf( "%s requires a value\n", arguments[i].c_str() );
+					return EXIT_FAILURE;
+				}
+
+				i++;
+				compile_level = arguments[i];
+			}
+			// decompile level
+			else if( arguments[i] == "--decompile-level" || arguments[i] == "-x" )
+			{
+				// no values
+				if( i + 2 >= arguments.size() )
+				{
+					printf( "%s requires the compiled level and the XML level file\n", arguments[i].c_str() );
+					return EXIT_FAILURE;
+				}
+
+				decompile_level = arguments[i + 1];
+				decompile_level_xml = arguments[i + 2];
+				i += 2;
+			}
+			// profile level loading
+			else if( arguments[i] == "--profile-load" || arguments[i] == "-p" )
+			{
+				profile_load = 1;
+
+				// optional output format
+				if( i + 1 < arguments.size() && ( arguments[i + 1] == "json" || arguments[i + 1] == "text" ) )
+				{
+					i++;
+					profile_load_json = arguments[i] == "json";
+				}
+			}
+			// trace capture
+			else if( arguments[i] == "--trace" || arguments[i] == "-t" )
+			{
+				// no value
+				if( i + 1 >= arguments.size() )
+				{
+					printf( "%s requires a value\n", arguments[i].c_str() );
+					return EXIT_FAILURE;
+				}
+
+				i++;
+				trace_frames = string_to_int( arguments[i] );
+
+				// optional filename
+				if( i + 1 < arguments.size() && arguments[i + 1].substr( 0, 1 ) != "-" )
+				{
+					i++;
+					trace_filename = arguments[i];
+				}
+			}
+			// input recording and replay
+			else if( arguments[i] == "--record" || arguments[i] == "-r" || arguments[i] == "--replay" )
+			{
+				// no value
+				if( i + 1 >= arguments.size() )
+				{
+					printf( "%s requires a value\n", arguments[i].c_str() );
+					return EXIT_FAILURE;
+				}
+
+				if( arguments[i] == "--replay" )
+				{
+					replay_filename = arguments[i + 1];
+				}
+				else
+				{
+					record_filename = arguments[i + 1];
+				}
+
+				i++;
+			}
 			// level loading is handled later
 			else if( arguments[i] == "--level" || arguments[i] == "-l" )
 			{
 				// skip
 			}
+			// pack data directory
+			else if( arguments[i] == "--pack-data" )
+			{
+				pack_data = 1;
+
+				// optional archive file
+				if( i + 1 < arguments.size() && arguments[i + 1].substr( 0, 1 ) != "-" )
+				{
+					i++;
+					pack_data_filename = arguments[i];
+				}
+			}
 			// world loading is handled later
 			else if( arguments[1] == "--world" || arguments[1] == "-w" )
 			{
@@ -178,6 +430,12 @@ int main( int argc, char **argv )
 		}
 	}
 
+	// only needs the loose data files
+	if( pack_data )
+	{
+		return cResource_Archive::Pack( DATA_DIR, pack_data_filename ) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
 	try
 	{
 		// initialize everything
@@ -189,12 +447,150 @@ int main( int argc, char **argv )
 		return EXIT_FAILURE;
 	}
 
-	// command line level entering
-	if( argc > 2 && ( arguments[1] == "--level" || arguments[1] == "-l" ) && !arguments[2].empty() )
+#ifdef SMC_MICRO_BENCHMARK
+	// the benchmark program only runs the micro benchmarks and writes the results to the optional file
+	{
+		const bool success = Micro_Benchmark( argc >= 2 ? arguments[1] : std::string() );
+
+		Exit_Game();
+		return success ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+#endif
+
+	// input replay with the recorded level
+	std::string start_level;
+
+	if( argc > 2 && ( arguments[1] == "--level" || arguments[1] == "-l" ) )
+	{
+		start_level = arguments[2];
+	}
+
+	if( !replay_filename.empty() )
+	{
+		if( !pInput_Recorder->Start_Replay( replay_filename ) )
+		{
+			Exit_Game();
+			return EXIT_FAILURE;
+		}
+
+		if( !pInput_Recorder->Get_Level().empty() )
+		{
+			start_level = pInput_Recorder->Get_Level();
+		}
+	}
+	else if( !record_filename.empty() && !pInput_Recorder->Start_Recording( record_filename, start_level ) )
+	{
+		Exit_Game();
+		return EXIT_FAILURE;
+	}
+
+	if( generate_level_objects )
+	{
+		const bool success = Generate_Stress_Level( "stress_" + int_to_string( generate_level_objects ), generate_level_objects, stress_level_mix );
+
+		Exit_Game();
+		return success ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if( scaling_benchmark )
+	{
+		const bool success = Scaling_Benchmark( stress_level_mix, benchmark_frames, benchmark_render );
+
+		Exit_Game();
+		return success ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if( benchmark )
+	{
+		bool success = 1;
+
+		if( benchmark_level.empty() )
+		{
+			Collision_Benchmark();
+		}
+		else
+		{
+			success = Level_Benchmark( benchmark_level, benchmark_frames, benchmark_render );
+		}
+
+		Exit_Game();
+		return success ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// compiled level tools
+	if( !compile_level.empty() || !decompile_level.empty() )
+	{
+		cLevel_Binary binary;
+		bool success = 0;
+
+		if( !compile_level.empty() )
+		{
+			if( pLevel_Manager->Get_Path( compile_level ) && binary.Compile( compile_level ) )
+			{
+				const std::string cache_filename = cLevel_Binary::Get_Cache_Filename( compile_level );
+				success = binary.Save( cache_filename );
+
+				if( success )
+				{
+					printf( "Compiled level %s to %s\n", compile_level.c_str(), cache_filename.c_str() );
+				}
+			}
+		}
+		else if( binary.Load_Compiled( decompile_level ) )
+		{
+			success = binary.Save_XML( decompile_level_xml );
+		}
+
+		if( !success )
+		{
+			printf( "Error : Level conversion failed\n" );
+		}
+
+		Exit_Game();
+		return success ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// level load profiling
+	if( profile_load )
+	{
+		if( argc <= 2 || ( arguments[1] != "--level" && arguments[1] != "-l" ) || arguments[2].empty() )
+		{
+			printf( "--profile-load requires a level given with --level\n" );
+			Exit_Game();
+			return EXIT_FAILURE;
+		}
+
+		cLoad_Profiler profiler;
+		pLoad_Profiler = &profiler;
+		profiler.Start( arguments[2] );
+
+		cLevel *level = pLevel_Manager->Load( arguments[2] );
+		const bool success = level->Is_Loaded();
+
+		if( success )
+		{
+			pLevel_Manager->Set_Active( level );
+			level->Init();
+		}
+
+		profiler.Stop();
+		pLoad_Profiler = NULL;
+
+		if( success )
+		{
+			profiler.Print( profile_load_json );
+		}
+
+		Exit_Game();
+		return success ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// command line or replay level entering
+	if( !start_level.empty() )
 	{
 		Game_Action = GA_ENTER_LEVEL;
 		Game_Mode_Type = MODE_TYPE_LEVEL_CUSTOM;
-		Game_Action_Data_Middle.add( "load_level", arguments[2] );
+		Game_Action_Data_Middle.add( "load_level", start_level );
 	}
 	// command line world entering
 	else if( argc > 2 && ( arguments[1] == "--world" || arguments[1] == "-w" ) && !arguments[2].empty() )
@@ -214,23 +610,62 @@ int main( int argc, char **argv )
 	Game_Action_Data_End.add( "screen_fadein", CEGUI::PropertyHelper::intToString( EFFECT_IN_BLACK ) );
 	Game_Action_Data_End.add( "screen_fadein_speed", "3" );
 
+	// command line trace capture including the first level or world load
+	if( trace_frames )
+	{
+		pProfiler->Start_Capture( trace_frames, trace_filename );
+	}
+
 	// game loop
 	while( !game_exit )
 	{
+		// the GUI is rendered in the render thread
+		pVideo->Lock_GUI();
 		// update
 		Update_Game();
-		// draw
-		Draw_Game();
-
-		// render
-#ifdef SMC_RENDER_THREAD_TEST
-		pVideo->Render( 1 );
-#else
-		pVideo->Render();
-#endif
+
+		// nothing changed on the screen
+		if( Is_Idle_Frame() )
+		{
+			// deferred jobs with the free frame
+			pFrame_Scheduler->Run();
+			pVideo->Unlock_GUI();
+			// sleep until the next input or the timeout for gui timers
+			Wait_For_Input( 100 );
+		}
+		else
+		{
+			// draw
+			Draw_Game();
+			// deferred jobs with the frame time left
+			pFrame_Scheduler->Run();
+			pVideo->Unlock_GUI();
+
+			// render
+			pVideo->Render( 1 );
+			// sleep if only the active menu item pulses
+			Wait_For_Pulse_Frame();
+		}
 
 		// update speedfactor
 		pFramerate->Update();
+
+		// add the section times of the frame
+		if( pProfiler->Is_Capturing() )
+		{
+			pProfiler->Add_Counter( "render requests", pRender_Stats->Get_Request_Count() );
+			pProfiler->Add_Counter( "draw calls", pRender_Stats->m_last.m_draw_calls );
+			pProfiler->Add_Counter( "vertices", pRender_Stats->m_last.m_vertices );
+			pProfiler->Add_Counter( "texture binds", pRender_Stats->m_last.m_texture_binds );
+			pProfiler->Add_Counter( "gl state changes", pRender_Stats->m_last.m_state_changes );
+			pProfiler->Add_Counter( "texture MB", pImage_Manager->m_resident_bytes / 1048576.0 );
+		}
+
+		pProfiler->Set_Enabled( game_debug_performance );
+		pProfiler->Frame_End();
+		pObject_Profiler->Set_Enabled( game_debug_performance );
+		pObject_Profiler->Frame_End();
+		Memory_Counters_Frame_End();
 	}
 
 	Exit_Game();
@@ -241,25 +676,18 @@ int main( int argc, char **argv )
 namespace SMC
 {
 
-void Init_Game( void )
+// if set the last update handled input events
+static bool update_had_input = 0;
+// if set the last update found nothing changing the screen
+static bool update_was_idle = 0;
+// if set the last update found only the active menu item pulsing
+static bool update_only_pulse = 0;
+// milliseconds between the frames of a menu where only the active item pulses
+static const Uint32 menu_pulse_frame_time = 33;
+
+// Load the preferences and init the translation and the user directory
+static void Init_Task_Preferences( void )
 {
-	// init random number generator
-	srand( static_cast<unsigned int>(time( NULL )) );
-
-	// Init Stage 1 - core classes
-	pResource_Manager = new cResource_Manager();
-	pVideo = new cVideo();
-	pAudio = new cAudio();
-	pFont = new cFont_Manager();
-	pFramerate = new cFramerate();
-	pRenderer = new cRenderQueue( 200 );
-	pRenderer_current = new cRenderQueue( 200 );
-	pPreferences = new cPreferences();
-	pImage_Manager = new cImage_Manager();
-	pSound_Manager = new cSound_Manager();
-	pSettingsParser = new cImage_Settings_Parser();
-
-	// Init Stage 2 - set preferences and init audio and the video screen
 	/* Set default user directory
 	 * can get overridden later from the preferences
 	*/
@@ -284,23 +712,34 @@ void Init_Game( void )
 
 	// init user dir directory
 	pResource_Manager->Init_User_Directory();
-	// video init
-	pVideo->Init_SDL();
-	pVideo->Init_Video();
-	pVideo->Init_CEGUI();
-	pVideo->Init_CEGUI_Data();
-	pFont->Init();
-	// framerate init ( must be after SDL init because of SDL_GetTicks() )
-	pFramerate->Init();
-	// audio init
-	pAudio->Init();
+}
+
+static void Init_Task_Level_Index( void )
+{
+	pLevel_Index = new cLevel_Index();
+	pLevel_Index->Load_Index( pResource_Manager->user_data_dir + USER_IMGCACHE_DIR "/" USER_LEVEL_INDEX );
+}
 
+static void Init_Task_Editor_Catalogue( void )
+{
+	pEditor_Catalogue = new cEditor_Catalogue();
+	pEditor_Catalogue->Load_Index( pResource_Manager->user_data_dir + USER_IMGCACHE_DIR "/" USER_EDITOR_CATALOGUE );
+}
+
+// Create the campaign, level and editor managers
+static void Init_Task_Managers( void )
+{
 	pCampaign_Manager = new cCampaign_Manager();
 	pLevel_Player = new cLevel_Player( NULL );
 	pLevel_Player->m_disallow_managed_delete = 1;
 	// set the first active player available
 	pActive_Player = pLevel_Player;
+	pLevel_Object_Factory = new cLevel_Object_Factory();
 	pLevel_Manager = new cLevel_Manager();
+	pLevel_Preloader = new cLevel_Preloader();
+	pLevel_Saver = new cLevel_Saver();
+	pEditor_Autosave = new cEditor_Autosave();
+	pHot_Reload = new cHot_Reload();
 	// set the first animation manager available
 	pActive_Animation_Manager = pActive_Level->m_animation_manager;
 	// set the first active sprite manager available
@@ -308,13 +747,19 @@ void Init_Game( void )
 
 	// apply preferences
 	pPreferences->Apply();
+}
 
+static void Init_Task_Loading_Screen( void )
+{
 	// draw generic loading screen
 	Loading_Screen_Init();
 	// initialize image cache
 	pVideo->Init_Image_Cache( 0, 1 );
+}
 
-	// Init Stage 3 - game classes
+// Create the game classes
+static void Init_Task_Game( void )
+{
 	// note : set any sprite manager as it is set again on game mode switch
 	pHud_Manager = new cHud_Manager( pActive_Level->m_sprite_manager );
 	pLevel_Player->Init();
@@ -336,23 +781,173 @@ void Init_Game( void )
 	pHud_Manager->Load();
 	pMenuCore = new cMenuCore();
 	pSavegame = new cSavegame();
+}
+
+void Init_Game( void )
+{
+	// init random number generator
+	srand( static_cast<unsigned int>(time( NULL )) );
+	game_random.Seed( static_cast<Uint32>(time( NULL )) );
+
+	// Init Stage 1 - core classes
+	// packed data directory if available
+	cResource_Archive *archive = new cResource_Archive();
+
+	if( archive->Open( DATA_DIR "/" DATA_ARCHIVE_FILE ) )
+	{
+		pResource_Archive = archive;
+	}
+	else
+	{
+		delete archive;
+	}
+
+	pResource_Manager = new cResource_Manager();
+	pVideo = new cVideo();
+	pAudio = new cAudio();
+	pFont = new cFont_Manager();
+	pFramerate = new cFramerate();
+	pProfiler = new cProfiler();
+	pObject_Profiler = new cObject_Profiler();
+	pScreen_Transition = new cScreen_Transition();
+	pFrame_Scheduler = new cFrame_Scheduler();
+	pTask_Pool = new cTask_Pool();
+	pRenderer = new cRenderQueue( 200 );
+	pRenderer_current = new cRenderQueue( 200 );
+	pGL_State = new cGL_State();
+	pRender_Stats = new cRender_Stats();
+	pPreferences = new cPreferences();
+	pImage_Manager = new cImage_Manager();
+	pTexture_Atlas = new cTexture_Atlas();
+	pSound_Manager = new cSound_Manager();
+	pSettingsParser = new cImage_Settings_Parser();
+	pImage_Settings_Cache = new cImage_Settings_Cache();
+	pCollision_Workers = new cCollision_Workers();
+	pUpdate_Workers = new cUpdate_Workers();
+	pParticle_Budget = new cParticle_Budget();
+	pInput_Recorder = new cInput_Recorder();
+
+	/* Init Stage 2 - preferences, video, audio and the game classes
+	 * run as tasks with their dependencies
+	 * the tasks without opengl, CEGUI or the loading screen run on worker threads
+	*/
+	cInit_Tasks tasks;
+
+	const unsigned int task_preferences = tasks.Add( "preferences", &Init_Task_Preferences, 1 );
+	const unsigned int task_sdl = tasks.Add( "sdl", boost::bind( &cVideo::Init_SDL, pVideo ), 1 );
+	const unsigned int task_video = tasks.Add( "video", boost::bind( &cVideo::Init_Video, pVideo, 0, 1 ), 1 );
+	const unsigned int task_cegui = tasks.Add( "cegui", boost::bind( &cVideo::Init_CEGUI, pVideo ), 1 );
+	const unsigned int task_cegui_data = tasks.Add( "cegui data", boost::bind( &cVideo::Init_CEGUI_Data, pVideo ), 1 );
+	// framerate init ( must be after SDL init because of SDL_GetTicks() )
+	const unsigned int task_framerate = tasks.Add( "framerate", boost::bind( &cFramerate::Init, pFramerate, speedfactor_fps ), 1 );
+	// only opens the font files
+	const unsigned int task_fonts = tasks.Add( "fonts", boost::bind( &cFont_Manager::Init, pFont ), 0 );
+	// opening the audio device can take long
+	const unsigned int task_audio = tasks.Add( "audio", boost::bind( &cAudio::Init, pAudio ), 0 );
+	const unsigned int task_level_index = tasks.Add( "level index", &Init_Task_Level_Index, 0 );
+	const unsigned int task_editor_catalogue = tasks.Add( "editor catalogue", &Init_Task_Editor_Catalogue, 0 );
+	// the campaigns are parsed with CEGUI and the level player loads its images
+	const unsigned int task_managers = tasks.Add( "managers", &Init_Task_Managers, 1 );
+	const unsigned int task_loading_screen = tasks.Add( "loading screen", &Init_Task_Loading_Screen, 1 );
+	const unsigned int task_game = tasks.Add( "game classes", &Init_Task_Game, 1 );
+	// decoded by the sound loader while the images are loaded
+	const unsigned int task_sounds = tasks.Add( "sounds", boost::bind( &Preload_Sounds, 0 ), 1 );
+	const unsigned int task_images = tasks.Add( "images", boost::bind( &Preload_Images, 1 ), 1 );
+
+	tasks.Depends( task_sdl, task_preferences );
+	tasks.Depends( task_video, task_sdl );
+	tasks.Depends( task_cegui, task_video );
+	tasks.Depends( task_cegui_data, task_cegui );
+	tasks.Depends( task_framerate, task_sdl );
+	// the audio subsystem is initialized with SDL
+	tasks.Depends( task_audio, task_sdl );
+	// the user directory is set from the preferences
+	tasks.Depends( task_level_index, task_preferences );
+	tasks.Depends( task_editor_catalogue, task_preferences );
+	tasks.Depends( task_managers, task_cegui_data );
+	tasks.Depends( task_managers, task_framerate );
+	tasks.Depends( task_managers, task_level_index );
+	tasks.Depends( task_managers, task_editor_catalogue );
+	tasks.Depends( task_loading_screen, task_managers );
+	tasks.Depends( task_game, task_loading_screen );
+	tasks.Depends( task_game, task_fonts );
+	tasks.Depends( task_game, task_audio );
+	tasks.Depends( task_sounds, task_audio );
+	tasks.Depends( task_images, task_game );
+
+	tasks.Run();
 
-	// cache
-	Preload_Images( 1 );
-	Preload_Sounds( 1 );
 	Loading_Screen_Exit();
+
+	if( game_debug )
+	{
+		tasks.Print_Times();
+	}
 }
 
 void Exit_Game( void )
 {
+	// objects using opengl are deleted
+	if( pVideo )
+	{
+		pVideo->Exit_Render_Thread();
+	}
+
 	if( pPreferences )
 	{
 		pPreferences->Save();
 	}
 
+	// writes the last recorded frame
+	if( pInput_Recorder )
+	{
+		delete pInput_Recorder;
+		pInput_Recorder = NULL;
+	}
+
 	pLevel_Manager->Unload();
 	pMenuCore->m_handler->m_level->Unload();
 
+	if( pLevel_Preloader )
+	{
+		delete pLevel_Preloader;
+		pLevel_Preloader = NULL;
+	}
+
+	if( pHot_Reload )
+	{
+		delete pHot_Reload;
+		pHot_Reload = NULL;
+	}
+
+	// waits for the journal being written
+	if( pEditor_Autosave )
+	{
+		delete pEditor_Autosave;
+		pEditor_Autosave = NULL;
+	}
+
+	// waits for the level being saved
+	if( pLevel_Saver )
+	{
+		delete pLevel_Saver;
+		pLevel_Saver = NULL;
+	}
+
+	if( pLevel_Index )
+	{
+		pLevel_Index->Save_Index();
+		delete pLevel_Index;
+		pLevel_Index = NULL;
+	}
+
+	if( pEditor_Catalogue )
+	{
+		pEditor_Catalogue->Save_Index();
+		delete pEditor_Catalogue;
+		pEditor_Catalogue = NULL;
+	}
+
 	if( pAudio )
 	{
 		delete pAudio;
@@ -443,6 +1038,12 @@ void Exit_Game( void )
 		pLevel_Manager = NULL;
 	}
 
+	if( pLevel_Object_Factory )
+	{
+		delete pLevel_Object_Factory;
+		pLevel_Object_Factory = NULL;
+	}
+
 	if( pMenuCore )
 	{
 		delete pMenuCore;
@@ -461,6 +1062,18 @@ void Exit_Game( void )
 		pRenderer_current = NULL;
 	}
 
+	if( pGL_State )
+	{
+		delete pGL_State;
+		pGL_State = NULL;
+	}
+
+	if( pRender_Stats )
+	{
+		delete pRender_Stats;
+		pRender_Stats = NULL;
+	}
+
 	if( pGuiSystem )
 	{
 		CEGUI::ResourceProvider* rp = pGuiSystem->getResourceProvider();
@@ -468,6 +1081,7 @@ void Exit_Game( void )
 		pGuiSystem->destroy();
 		pGuiSystem = NULL;
 		delete rp;
+		pGuiResourceProvider = NULL;
 		delete logger;
 	}
 
@@ -489,12 +1103,26 @@ void Exit_Game( void )
 		pImage_Manager = NULL;
 	}
 
+	if( pTexture_Atlas )
+	{
+		delete pTexture_Atlas;
+		pTexture_Atlas = NULL;
+	}
+
 	if( pSettingsParser )
 	{
 		delete pSettingsParser;
 		pSettingsParser = NULL;
 	}
 
+	if( pImage_Settings_Cache )
+	{
+		// keep the settings resolved since the start
+		pImage_Settings_Cache->Save_Index();
+		delete pImage_Settings_Cache;
+		pImage_Settings_Cache = NULL;
+	}
+
 	if( pFont )
 	{
 		delete pFont;
@@ -507,6 +1135,63 @@ void Exit_Game( void )
 		pResource_Manager = NULL;
 	}
 
+	if( pCollision_Workers )
+	{
+		delete pCollision_Workers;
+		pCollision_Workers = NULL;
+	}
+
+	if( pUpdate_Workers )
+	{
+		delete pUpdate_Workers;
+		pUpdate_Workers = NULL;
+	}
+
+	if( pParticle_Budget )
+	{
+		delete pParticle_Budget;
+		pParticle_Budget = NULL;
+	}
+
+	// after everything using it and runs the queued tasks
+	if( pTask_Pool )
+	{
+		delete pTask_Pool;
+		pTask_Pool = NULL;
+	}
+
+	// after the worker threads exited
+	if( pProfiler )
+	{
+		delete pProfiler;
+		pProfiler = NULL;
+	}
+
+	if( pObject_Profiler )
+	{
+		delete pObject_Profiler;
+		pObject_Profiler = NULL;
+	}
+
+	if( pScreen_Transition )
+	{
+		delete pScreen_Transition;
+		pScreen_Transition = NULL;
+	}
+
+	if( pFrame_Scheduler )
+	{
+		delete pFrame_Scheduler;
+		pFrame_Scheduler = NULL;
+	}
+
+	// after everything reading the packed files
+	if( pResource_Archive )
+	{
+		delete pResource_Archive;
+		pResource_Archive = NULL;
+	}
+
 	char *last_sdl_error = SDL_GetError();
 	if( strlen( last_sdl_error ) > 0 )
 	{
@@ -663,35 +1348,89 @@ void Update_Game( void )
 	{
 		Correct_Frame_Time( pPreferences->m_video_fps_limit );
 	}
+
+	// the frame budget starts after waiting for the frame limit
+	pFrame_Scheduler->Frame_Start();
 	
 	if( Game_Action != GA_NONE )
 	{
 		pVideo->Render_Finish();
 	}
 	
+	// ## screen fadeout and fadein
+	pScreen_Transition->Update();
+
 	// ## game events
 	Handle_Game_Events();
 
-	// ## input
+	// ## audio
+	pAudio->Resume_Music();
+	pAudio->Update();
+
+	// ## main thread continuations of the worker tasks
+	pTask_Pool->Run_Main_Thread_Tasks();
+
+	// ## background level loading and saving
+	pLevel_Preloader->Update();
+	pLevel_Saver->Update();
+	pSavegame->Update();
+
+	// ## editor autosave and changed images, sounds and level files with the frame time left
+	pFrame_Scheduler->Add( boost::bind( &cEditor_Autosave::Update, pEditor_Autosave ), "editor autosave", pEditor_Autosave );
+	pFrame_Scheduler->Add( boost::bind( &cHot_Reload::Update, pHot_Reload ), "hot reload", pHot_Reload );
+
+	// ## particle budget with the particles of the last frame
+	pParticle_Budget->Update();
+
+	// the game waits until the screen is covered and the game action is finished
+	if( pScreen_Transition->Is_Fading_Out() )
+	{
+		Gui_Handle_Time();
+		return;
+	}
+
+	/* ## input
+	 * sampled as late as possible before the update which uses it
+	*/
+	update_had_input = 0;
+	pFramerate->m_input_time = Get_Microseconds();
+
+	// recorded frame start or replayed input
+	pInput_Recorder->Update();
+
 	while( SDL_PollEvent( &input_event ) )
 	{
+		// only the replayed input is used
+		if( pInput_Recorder->Is_Replaying() && cInput_Recorder::Is_Input_Event( &input_event ) )
+		{
+			continue;
+		}
+
+		// analog noise
+		if( pJoystick->Is_Unchanged_Event( &input_event ) )
+		{
+			continue;
+		}
+
+		pInput_Recorder->Record_Event( &input_event );
 		// handle
 		Handle_Input_Global( &input_event );
+		update_had_input = 1;
 	}
 
 	pMouseCursor->Update();
 
-	// ## audio
-	pAudio->Resume_Music();
-	pAudio->Update();
-
-	// performance measuring
-	pFramerate->m_perf_last_ticks = SDL_GetTicks();
-
 	// ## update
 	if( Game_Mode == MODE_LEVEL )
 	{
-		pLevel_Manager->Update();
+		if( pPreferences->m_fixed_timestep )
+		{
+			pLevel_Manager->Update_Fixed_Timestep();
+		}
+		else
+		{
+			pLevel_Manager->Update();
+		}
 	}
 	else if( Game_Mode == MODE_OVERWORLD )
 	{
@@ -718,8 +1457,8 @@ void Draw_Game( void )
 		return;
 	}
 
-	// performance measuring
-	pFramerate->m_perf_last_ticks = SDL_GetTicks();
+	// unload unused textures before the next ones are used
+	pImage_Manager->Update_Texture_Budget();
 
 	if( Game_Mode == MODE_LEVEL )
 	{
@@ -738,11 +1477,98 @@ void Draw_Game( void )
 		pLevel_Editor->m_settings_screen->Draw();
 	}
 
+	// screen fadeout and fadein
+	pScreen_Transition->Draw();
+
 	// Mouse
-	pMouseCursor->Draw();
+	{
+		cProfiler_Scope profile_scope( "mouse draw" );
+		pMouseCursor->Draw();
+	}
+}
+
+bool Is_Idle_Frame( void )
+{
+	bool idle = 1;
+
+	if( !pPreferences->m_video_menu_idle || game_exit )
+	{
+		idle = 0;
+	}
+	// only static menus
+	else if( Game_Mode != MODE_MENU || Game_Action != GA_NONE || update_had_input )
+	{
+		idle = 0;
+	}
+	// screen fadeout and fadein
+	else if( pScreen_Transition->Is_Active() )
+	{
+		idle = 0;
+	}
+	// debug info changes every frame
+	else if( game_debug || game_debug_performance )
+	{
+		idle = 0;
+	}
+	else if( pMenuCore->Is_Animated() )
+	{
+		idle = 0;
+	}
+	// a gui window changed
+	else if( pGuiSystem->isRedrawRequested() )
+	{
+		idle = 0;
+	}
+
+	// the pulse of the active item is drawn with a lower frame rate
+	update_only_pulse = idle && pMenuCore->Is_Item_Pulsing();
+
+	if( update_only_pulse )
+	{
+		idle = 0;
+	}
+
+	// draw once more after a change to show the state of the last update
+	const bool skip = idle && update_was_idle;
+	update_was_idle = idle;
+
+	return skip;
+}
+
+void Wait_For_Input( Uint32 timeout )
+{
+	const Uint32 start_ticks = SDL_GetTicks();
+	SDL_Event event;
+
+	while( SDL_GetTicks() - start_ticks < timeout )
+	{
+		SDL_PumpEvents();
+
+		// keep the event for the next update
+		if( SDL_PeepEvents( &event, 1, SDL_PEEKEVENT, SDL_ALLEVENTS ) > 0 )
+		{
+			return;
+		}
+
+		SDL_Delay( 10 );
+	}
+}
+
+void Wait_For_Pulse_Frame( void )
+{
+	static Uint32 last_ticks = 0;
+
+	if( update_only_pulse )
+	{
+		const Uint32 elapsed = SDL_GetTicks() - last_ticks;
+
+		if( elapsed < menu_pulse_frame_time )
+		{
+			Wait_For_Input( menu_pulse_frame_time - elapsed );
+		}
+	}
 
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_DRAW_MOUSE]->Update();
+	last_ticks = SDL_GetTicks();
 }
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
@@ -46,6 +46,22 @@ void Update_Game( void );
 */
 void Draw_Game( void );
 
+/* Returns true if the frame does not need to be drawn
+ * only in static menus where nothing changed since the last drawn frame
+ * enabled with the menu idle preference
+*/
+bool Is_Idle_Frame( void );
+
+/* Sleep until an input event is available or the timeout in milliseconds is reached
+ * the event is not removed from the queue
+*/
+void Wait_For_Input( Uint32 timeout );
+
+/* Sleep until the next pulse frame if only the active menu item pulses
+ * an input event ends the sleep
+*/
+void Wait_For_Pulse_Frame( void );
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 } // namespace SMC
@@ -0,0 +1,103 @@
+/***************************************************************************
+ * random.cpp  -  fast random number generator
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../../core/math/random.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cRandom *** *** *** *** *** *** *** *** *** *** */
+
+cRandom :: cRandom( Uint32 seed /* = 1 */ )
+{
+	Seed( seed );
+}
+
+cRandom :: ~cRandom( void )
+{
+
+}
+
+void cRandom :: Seed( Uint32 seed )
+{
+	/* spread the seed bits over the state
+	 * with the murmur hash finalizer
+	*/
+	Uint32 state[4];
+
+	for( unsigned int i = 0; i < 4; i++ )
+	{
+		Uint32 value = seed + ( i + 1 ) * 0x9E3779B9;
+		value ^= value >> 16;
+		value *= 0x85EBCA6B;
+		value ^= value >> 13;
+		value *= 0xC2B2AE35;
+		value ^= value >> 16;
+
+		state[i] = value;
+	}
+
+	// the state must not be all zero
+	if( !state[0] && !state[1] && !state[2] && !state[3] )
+	{
+		state[0] = 1;
+	}
+
+	m_x = state[0];
+	m_y = state[1];
+	m_z = state[2];
+	m_w = state[3];
+}
+
+void cRandom :: Get_Floats( float *values, unsigned int count, float min, float max )
+{
+	const float range = ( max - min ) * ( 1.0f / 16777216.0f );
+
+	// state in local variables for the loop
+	Uint32 x = m_x;
+	Uint32 y = m_y;
+	Uint32 z = m_z;
+	Uint32 w = m_w;
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		const Uint32 t = x ^ ( x << 11 );
+
+		x = y;
+		y = z;
+		z = w;
+		w = w ^ ( w >> 19 ) ^ ( t ^ ( t >> 8 ) );
+
+		values[i] = min + static_cast<float>( w >> 8 ) * range;
+	}
+
+	m_x = x;
+	m_y = y;
+	m_z = z;
+	m_w = w;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+cRandom game_random;
+
+Uint32 Get_Random_Seed( void )
+{
+	return game_random.Get();
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,99 @@
+/***************************************************************************
+ * random.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+   
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_RANDOM_H
+#define SMC_RANDOM_H
+
+#include "../../core/global_basic.h"
+// SDL
+#include "SDL.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cRandom *** *** *** *** *** *** *** *** *** *** */
+
+/* Xorshift random number generator
+ * the same seed always returns the same numbers
+ * an instance must only be used by one thread at a time
+*/
+class cRandom
+{
+public:
+	cRandom( Uint32 seed = 1 );
+	~cRandom( void );
+
+	// Set the seed which defines all following numbers
+	void Seed( Uint32 seed );
+
+	// Returns the next number
+	inline Uint32 Get( void )
+	{
+		const Uint32 t = m_x ^ ( m_x << 11 );
+
+		m_x = m_y;
+		m_y = m_z;
+		m_z = m_w;
+		m_w = m_w ^ ( m_w >> 19 ) ^ ( t ^ ( t >> 8 ) );
+
+		return m_w;
+	};
+	// Returns a number from 0 to count - 1 or 0 if count is 0
+	inline unsigned int Get_Int( unsigned int count )
+	{
+		if( !count )
+		{
+			return 0;
+		}
+
+		return Get() % count;
+	};
+	// Returns a floating point value from 0 to below 1
+	inline float Get_Float( void )
+	{
+		// the upper 24 bits fit exactly into a float
+		return static_cast<float>( Get() >> 8 ) * ( 1.0f / 16777216.0f );
+	};
+	// Returns a floating point value between the given values
+	inline float Get_Float( float min, float max )
+	{
+		return min + ( max - min ) * Get_Float();
+	};
+	// Set count floating point values between the given values
+	void Get_Floats( float *values, unsigned int count, float min, float max );
+
+private:
+	// state
+	Uint32 m_x;
+	Uint32 m_y;
+	Uint32 m_z;
+	Uint32 m_w;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Random numbers for everything without its own generator
+ * must only be used by the main thread
+*/
+extern cRandom game_random;
+
+// Returns a new seed for a generator from the game generator
+Uint32 Get_Random_Seed( void );
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
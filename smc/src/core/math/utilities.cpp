@@ -37,6 +37,36 @@ namespace SMC
 
 /* *** *** *** *** *** *** *** *** Math utility functions *** *** *** *** *** *** *** *** *** */
 
+// sine table entries for a full turn
+static const int sin_table_size = 4096;
+
+/* Sine of a full turn
+ * filled before main so the drawing threads can use it
+*/
+class cSin_Table
+{
+public:
+	cSin_Table( void )
+	{
+		for( int i = 0; i < sin_table_size; i++ )
+		{
+			float value = static_cast<float>( sin( i * ( 6.283185307179586 / sin_table_size ) ) );
+
+			// exact for the right angles
+			if( fabs( value ) < 0.000001f )
+			{
+				value = 0.0f;
+			}
+
+			m_values[i] = value;
+		}
+	}
+
+	float m_values[sin_table_size];
+};
+
+static const cSin_Table sin_table;
+
 bool Is_Valid_Number( std::string num, bool accept_floating_point /* = 1 */ )
 {
 	// accept negative numbers
@@ -64,6 +94,42 @@ bool Is_Valid_Number( std::string num, bool accept_floating_point /* = 1 */ )
 	return 0;
 }
 
+void Get_Sin_Cos( float degrees, float &sin_value, float &cos_value )
+{
+	const float steps = degrees * ( sin_table_size / 360.0f );
+	// the table size is a power of two and the mask also wraps negative angles
+	const int num = static_cast<int>( steps < 0.0f ? steps - 0.5f : steps + 0.5f ) & ( sin_table_size - 1 );
+
+	sin_value = sin_table.m_values[num];
+	// a quarter turn ahead
+	cos_value = sin_table.m_values[( num + sin_table_size / 4 ) & ( sin_table_size - 1 )];
+}
+
+void Get_Rotated_Quad( float half_w, float half_h, float rot_x, float rot_y, float rot_z, float corners[12] )
+{
+	float sin_x, cos_x, sin_y, cos_y, sin_z, cos_z;
+	Get_Sin_Cos( rot_x, sin_x, cos_x );
+	Get_Sin_Cos( rot_y, sin_y, cos_y );
+	Get_Sin_Cos( rot_z, sin_z, cos_z );
+
+	const float corner_x[4] = { -half_w, half_w, half_w, -half_w };
+	const float corner_y[4] = { -half_h, -half_h, half_h, half_h };
+
+	for( unsigned int c = 0; c < 4; c++ )
+	{
+		// z axis
+		const float x1 = corner_x[c] * cos_z - corner_y[c] * sin_z;
+		const float y1 = corner_x[c] * sin_z + corner_y[c] * cos_z;
+		// y axis
+		const float x2 = x1 * cos_y;
+		const float z2 = -x1 * sin_y;
+		// x axis
+		corners[c * 3] = x2;
+		corners[c * 3 + 1] = y1 * cos_x - z2 * sin_x;
+		corners[c * 3 + 2] = y1 * sin_x + z2 * cos_x;
+	}
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 } // namespace SMC
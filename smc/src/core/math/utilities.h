@@ -18,6 +18,7 @@
 
 #include "../../core/global_basic.h"
 #include "../../core/global_game.h"
+#include "../../core/math/random.h"
 // for rand()
 #include <cstdlib>
 
@@ -43,7 +44,7 @@ template<class T> inline T Clamp( const T &v, const T &min, const T &max )
 // return a random floating point value between the given values
 inline float Get_Random_Float( float min, float max )
 {
-	return min + (max - min) * static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+	return game_random.Get_Float( min, max );
 }
 
 // Checks if number is power of 2 and if not returns the next power of two size
@@ -75,6 +76,17 @@ inline bool Is_Float_Equal( float a, float b, float tolerance = 0.0001f )
 	return 0;
 }
 
+/* Get the sine and cosine of the angle in degrees
+ * uses a lookup table with a precision of 1/4096 turn
+*/
+void Get_Sin_Cos( float degrees, float &sin_value, float &cos_value );
+
+/* Rotate the corners of a quad around its center in the same order as glRotatef with x, y and z
+ * half_w, half_h : half the quad size
+ * corners : x, y and z offset from the center of the top left, top right, bottom right and bottom left corner
+*/
+void Get_Rotated_Quad( float half_w, float half_h, float rot_x, float rot_y, float rot_z, float corners[12] );
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 } // namespace SMC
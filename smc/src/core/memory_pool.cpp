@@ -0,0 +1,374 @@
+/***************************************************************************
+ * memory_pool.cpp  -  memory blocks kept for reuse
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/memory_pool.h"
+// std
+#include <algorithm>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cMemory_Counter *** *** *** *** *** *** *** *** *** *** */
+
+cMemory_Counter :: cMemory_Counter( const std::string &name )
+{
+	m_name = name;
+	m_bytes = 0;
+	m_peak = 0;
+	m_frame_allocations = 0;
+	m_last_frame_allocations = 0;
+
+	Get_Memory_Counters().push_back( this );
+}
+
+cMemory_Counter :: ~cMemory_Counter( void )
+{
+	Memory_Counter_List &counters = Get_Memory_Counters();
+	Memory_Counter_List::iterator itr = std::find( counters.begin(), counters.end(), this );
+
+	if( itr != counters.end() )
+	{
+		counters.erase( itr );
+	}
+}
+
+void cMemory_Counter :: Add( size_t size )
+{
+	m_bytes += size;
+	m_frame_allocations++;
+
+	if( m_bytes > m_peak )
+	{
+		m_peak = m_bytes;
+	}
+}
+
+void cMemory_Counter :: Remove( size_t size )
+{
+	m_bytes = m_bytes > size ? m_bytes - size : 0;
+}
+
+void cMemory_Counter :: Set( Uint64 bytes )
+{
+	m_bytes = bytes;
+
+	if( m_bytes > m_peak )
+	{
+		m_peak = m_bytes;
+	}
+}
+
+void cMemory_Counter :: Frame_End( void )
+{
+	m_last_frame_allocations = m_frame_allocations;
+	m_frame_allocations = 0;
+}
+
+Memory_Counter_List &Get_Memory_Counters( void )
+{
+	// created with the first use to not depend on the static initialization order
+	static Memory_Counter_List counters;
+	return counters;
+}
+
+void Memory_Counters_Frame_End( void )
+{
+	Memory_Counter_List &counters = Get_Memory_Counters();
+
+	for( Memory_Counter_List::iterator itr = counters.begin(); itr != counters.end(); ++itr )
+	{
+		(*itr)->Frame_End();
+	}
+}
+
+/* *** *** *** *** *** *** *** cMemory_Pool *** *** *** *** *** *** *** *** *** *** */
+
+cMemory_Pool :: cMemory_Pool( const std::string &name, size_t block_size, unsigned int reserve_count, unsigned int max_free, cMemory_Counter *counter /* = NULL */ )
+{
+	m_name = name;
+	m_block_size = block_size;
+	m_reserve_count = reserve_count;
+	m_max_free = max_free;
+	m_counter = counter;
+
+	m_hits = 0;
+	m_misses = 0;
+
+	Get_Memory_Pools().push_back( this );
+}
+
+cMemory_Pool :: ~cMemory_Pool( void )
+{
+	for( vector<void *>::iterator itr = m_free.begin(); itr != m_free.end(); ++itr )
+	{
+		::operator delete( *itr );
+	}
+
+	m_free.clear();
+	// blocks released after this are deleted directly
+	m_max_free = 0;
+}
+
+void *cMemory_Pool :: Get( size_t size )
+{
+	if( m_counter )
+	{
+		m_counter->Add( size );
+	}
+
+	// derived class
+	if( size != m_block_size )
+	{
+		return ::operator new( size );
+	}
+
+	// first use
+	if( m_reserve_count )
+	{
+		Reserve( m_reserve_count );
+		m_reserve_count = 0;
+	}
+
+	if( m_free.empty() )
+	{
+		m_misses++;
+		return ::operator new( size );
+	}
+
+	m_hits++;
+
+	void *ptr = m_free.back();
+	m_free.pop_back();
+	return ptr;
+}
+
+void cMemory_Pool :: Release( void *ptr, size_t size )
+{
+	if( !ptr )
+	{
+		return;
+	}
+
+	if( m_counter )
+	{
+		m_counter->Remove( size );
+	}
+
+	// derived class or full
+	if( size != m_block_size || m_free.size() >= m_max_free )
+	{
+		::operator delete( ptr );
+		return;
+	}
+
+	m_free.push_back( ptr );
+}
+
+void cMemory_Pool :: Reserve( unsigned int count )
+{
+	if( count > m_max_free )
+	{
+		count = m_max_free;
+	}
+
+	m_free.reserve( m_max_free );
+
+	while( m_free.size() < count )
+	{
+		m_free.push_back( ::operator new( m_block_size ) );
+	}
+}
+
+float cMemory_Pool :: Get_Hit_Rate( void ) const
+{
+	const unsigned int total = m_hits + m_misses;
+
+	if( !total )
+	{
+		return 100.0f;
+	}
+
+	return ( static_cast<float>(m_hits) * 100.0f ) / static_cast<float>(total);
+}
+
+Memory_Pool_List &Get_Memory_Pools( void )
+{
+	// created with the first use to not depend on the static initialization order
+	static Memory_Pool_List pools;
+	return pools;
+}
+
+/* *** *** *** *** *** *** *** cMemory_Arena *** *** *** *** *** *** *** *** *** *** */
+
+// size of the chunks the blocks are taken from
+static const size_t arena_chunk_size = 256 * 1024;
+// block sizes are rounded up to this alignment
+static const size_t arena_alignment = 16;
+// larger blocks are allocated from the heap
+static const size_t arena_max_block_size = 4096;
+
+// stored in front of each block
+struct Arena_Block_Header
+{
+	// arena or NULL if from the heap
+	cMemory_Arena *m_arena;
+	unsigned int m_size_class;
+};
+
+// the header keeps the alignment of the block
+static const size_t arena_header_size = ( ( sizeof(Arena_Block_Header) + arena_alignment - 1 ) / arena_alignment ) * arena_alignment;
+
+cMemory_Arena :: cMemory_Arena( void )
+{
+	m_used = 0;
+	m_chunk_bytes = 0;
+	m_chunk_pos = NULL;
+	m_chunk_left = 0;
+	m_free.resize( ( arena_header_size + arena_max_block_size ) / arena_alignment + 1 );
+	m_closed = 0;
+}
+
+cMemory_Arena :: ~cMemory_Arena( void )
+{
+	for( vector<char *>::iterator itr = m_chunks.begin(); itr != m_chunks.end(); ++itr )
+	{
+		::operator delete( *itr );
+	}
+}
+
+void *cMemory_Arena :: Get( cMemory_Arena *arena, size_t size )
+{
+	Arena_Block_Header *header;
+
+	if( arena && size <= arena_max_block_size )
+	{
+		const unsigned int size_class = static_cast<unsigned int>( ( arena_header_size + size + arena_alignment - 1 ) / arena_alignment );
+
+		header = static_cast<Arena_Block_Header *>(arena->Get_Block( size_class ));
+		header->m_arena = arena;
+		header->m_size_class = size_class;
+	}
+	else
+	{
+		header = static_cast<Arena_Block_Header *>(::operator new( arena_header_size + size ));
+		header->m_arena = NULL;
+		header->m_size_class = 0;
+	}
+
+	return reinterpret_cast<char *>(header) + arena_header_size;
+}
+
+void cMemory_Arena :: Release( void *ptr )
+{
+	if( !ptr )
+	{
+		return;
+	}
+
+	Arena_Block_Header *header = reinterpret_cast<Arena_Block_Header *>(static_cast<char *>(ptr) - arena_header_size);
+
+	if( !header->m_arena )
+	{
+		::operator delete( header );
+		return;
+	}
+
+	header->m_arena->Release_Block( header, header->m_size_class );
+}
+
+void cMemory_Arena :: Release_Unused( void )
+{
+	if( m_used )
+	{
+		return;
+	}
+
+	for( vector<char *>::iterator itr = m_chunks.begin(); itr != m_chunks.end(); ++itr )
+	{
+		::operator delete( *itr );
+	}
+
+	m_chunks.clear();
+	m_chunk_bytes = 0;
+	m_chunk_pos = NULL;
+	m_chunk_left = 0;
+
+	for( vector<vector<void *> >::iterator itr = m_free.begin(); itr != m_free.end(); ++itr )
+	{
+		vector<void *>().swap( *itr );
+	}
+}
+
+void cMemory_Arena :: Close( void )
+{
+	if( !m_used )
+	{
+		delete this;
+		return;
+	}
+
+	m_closed = 1;
+}
+
+void *cMemory_Arena :: Get_Block( unsigned int size_class )
+{
+	m_used++;
+
+	vector<void *> &free_blocks = m_free[size_class];
+
+	if( !free_blocks.empty() )
+	{
+		void *ptr = free_blocks.back();
+		free_blocks.pop_back();
+		return ptr;
+	}
+
+	const size_t size = size_class * arena_alignment;
+
+	// new chunk
+	if( m_chunk_left < size )
+	{
+		m_chunk_pos = static_cast<char *>(::operator new( arena_chunk_size ));
+		m_chunk_left = arena_chunk_size;
+		m_chunks.push_back( m_chunk_pos );
+		m_chunk_bytes += arena_chunk_size;
+	}
+
+	void *ptr = m_chunk_pos;
+	m_chunk_pos += size;
+	m_chunk_left -= size;
+	return ptr;
+}
+
+void cMemory_Arena :: Release_Block( void *ptr, unsigned int size_class )
+{
+	m_used--;
+
+	if( m_closed )
+	{
+		if( !m_used )
+		{
+			delete this;
+		}
+
+		return;
+	}
+
+	m_free[size_class].push_back( ptr );
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
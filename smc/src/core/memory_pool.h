@@ -0,0 +1,183 @@
+/***************************************************************************
+ * memory_pool.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_MEMORY_POOL_H
+#define SMC_MEMORY_POOL_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cMemory_Counter *** *** *** *** *** *** *** *** *** *** */
+
+/* Counts the memory used by a subsystem
+ * shown in the debug display and the benchmark output
+ * not thread safe
+*/
+class cMemory_Counter
+{
+public:
+	// name : shown in the debug display
+	cMemory_Counter( const std::string &name );
+	~cMemory_Counter( void );
+
+	// Add an allocation of the size
+	void Add( size_t size );
+	// Remove an allocation of the size
+	void Remove( size_t size );
+	// Count an allocation without changing the bytes
+	inline void Count_Allocation( void )
+	{
+		m_frame_allocations++;
+	}
+	// Set the bytes counted from the objects of the subsystem
+	void Set( Uint64 bytes );
+	// Keep the allocations of the frame and start the next frame
+	void Frame_End( void );
+
+	// name
+	std::string m_name;
+	// used bytes
+	Uint64 m_bytes;
+	// highest used bytes
+	Uint64 m_peak;
+	// allocations of the current and the last frame
+	unsigned int m_frame_allocations;
+	unsigned int m_last_frame_allocations;
+};
+
+typedef vector<cMemory_Counter *> Memory_Counter_List;
+
+// Returns all created memory counters
+Memory_Counter_List &Get_Memory_Counters( void );
+// Start the next frame of all memory counters
+void Memory_Counters_Frame_End( void );
+
+/* *** *** *** *** *** *** *** cMemory_Pool *** *** *** *** *** *** *** *** *** *** */
+
+/* Memory blocks of one size kept for reuse
+ * used by the operator new and delete of often created classes
+ * a different size is from a derived class and not kept
+ * not thread safe
+*/
+class cMemory_Pool
+{
+public:
+	/* name : shown in the debug display
+	 * block_size : size of the pooled class
+	 * reserve_count : blocks allocated with the first use
+	 * max_free : deleted blocks kept for reuse up to this count
+	 * counter : if set counts the used blocks
+	*/
+	cMemory_Pool( const std::string &name, size_t block_size, unsigned int reserve_count, unsigned int max_free, cMemory_Counter *counter = NULL );
+	~cMemory_Pool( void );
+
+	// Returns a block of the size
+	void *Get( size_t size );
+	// Release the block of the size
+	void Release( void *ptr, size_t size );
+	// Allocate free blocks until the count is available
+	void Reserve( unsigned int count );
+
+	// Returns the percentage of the blocks taken from the free blocks
+	float Get_Hit_Rate( void ) const;
+
+	// name
+	std::string m_name;
+	// pooled class size
+	size_t m_block_size;
+	// blocks allocated with the first use
+	unsigned int m_reserve_count;
+	// maximum free blocks
+	unsigned int m_max_free;
+	// counts the used blocks if set
+	cMemory_Counter *m_counter;
+
+	// statistics
+	// blocks taken from the free blocks
+	unsigned int m_hits;
+	// blocks allocated because no free block was available
+	unsigned int m_misses;
+
+	// free blocks
+	vector<void *> m_free;
+};
+
+typedef vector<cMemory_Pool *> Memory_Pool_List;
+
+// Returns all created memory pools
+Memory_Pool_List &Get_Memory_Pools( void );
+
+/* *** *** *** *** *** *** *** cMemory_Arena *** *** *** *** *** *** *** *** *** *** */
+
+/* Memory of the objects of one level
+ * the blocks are taken from large chunks and deleted blocks are kept for blocks of the same size
+ * the chunks are freed together once no block is used anymore
+ * which keeps the many small objects of a level from fragmenting the heap
+ * each block remembers its arena and can still be released after the arena was closed
+ * not thread safe
+*/
+class cMemory_Arena
+{
+public:
+	cMemory_Arena( void );
+
+	/* Returns a block of the size from the arena
+	 * if the arena is NULL or the size is too large it is allocated from the heap
+	*/
+	static void *Get( cMemory_Arena *arena, size_t size );
+	// Release the block to the arena or heap it was allocated from
+	static void Release( void *ptr );
+
+	// Free all chunks if no block is used
+	void Release_Unused( void );
+	/* Delete the arena
+	 * at once if no block is used or else with the last released block
+	*/
+	void Close( void );
+
+	// used blocks
+	unsigned int m_used;
+	// allocated chunk memory in bytes
+	size_t m_chunk_bytes;
+
+private:
+	// only deleted with Close
+	~cMemory_Arena( void );
+
+	// Returns a block of the size class
+	void *Get_Block( unsigned int size_class );
+	// Keep the block of the size class for reuse
+	void Release_Block( void *ptr, unsigned int size_class );
+
+	// allocated chunks
+	vector<char *> m_chunks;
+	// unused part of the last chunk
+	char *m_chunk_pos;
+	size_t m_chunk_left;
+	// released blocks by size class
+	vector<vector<void *> > m_free;
+	// if set it is deleted with the last released block
+	bool m_closed;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -0,0 +1,416 @@
+/***************************************************************************
+ * micro_benchmark.cpp  -  measures the core containers and helpers
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/micro_benchmark.h"
+#include "../core/game_core.h"
+#include "../core/framerate.h"
+#include "../core/sprite_manager.h"
+#include "../core/file_parser.h"
+#include "../core/property_helper.h"
+#include "../core/main.h"
+#include "../video/video.h"
+#include "../video/renderer.h"
+#include "../video/img_manager.h"
+#include "../video/animation.h"
+#include "../audio/sound_manager.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** Micro Benchmark *** *** *** *** *** *** *** *** *** *** */
+
+// repetitions of each micro benchmark
+static const unsigned int micro_benchmark_rounds = 200;
+// objects or values used in each round
+static const unsigned int micro_benchmark_count = 1000;
+
+// result of a micro benchmark
+struct Micro_Benchmark_Result
+{
+	std::string m_name;
+	// measured operations
+	Uint64 m_operations;
+	// total microseconds
+	Uint64 m_time;
+};
+
+typedef vector<Micro_Benchmark_Result> Micro_Benchmark_Result_List;
+
+// keeps the results from being optimized away
+static volatile unsigned int micro_benchmark_sink = 0;
+
+// Add the time of the operations to the result with the name
+static void Micro_Benchmark_Add( Micro_Benchmark_Result_List &results, const std::string &name, Uint64 time, Uint64 operations )
+{
+	for( Micro_Benchmark_Result_List::iterator itr = results.begin(); itr != results.end(); ++itr )
+	{
+		if( itr->m_name == name )
+		{
+			itr->m_time += time;
+			itr->m_operations += operations;
+			return;
+		}
+	}
+
+	Micro_Benchmark_Result result;
+	result.m_name = name;
+	result.m_operations = operations;
+	result.m_time = time;
+	results.push_back( result );
+}
+
+// Returns a random float from 0 to max
+static float Micro_Benchmark_Random( float max )
+{
+	return ( static_cast<float>(rand()) / static_cast<float>(RAND_MAX) ) * max;
+}
+
+// Measure adding, culling, sorting and clearing render requests without drawing
+static void Micro_Benchmark_Render_Queue( Micro_Benchmark_Result_List &results )
+{
+	// requests of the loading screen
+	pRenderer->Clear();
+
+	for( unsigned int round = 0; round < micro_benchmark_rounds; round++ )
+	{
+		Uint64 time = Get_Microseconds();
+
+		for( unsigned int i = 0; i < micro_benchmark_count; i++ )
+		{
+			cRect_Request *request = new cRect_Request();
+			request->m_rect.m_x = Micro_Benchmark_Random( static_cast<float>(game_res_w) * 2.0f ) - game_res_w * 0.5f;
+			request->m_rect.m_y = Micro_Benchmark_Random( static_cast<float>(game_res_h) * 2.0f ) - game_res_h * 0.5f;
+			request->m_rect.m_w = 32.0f;
+			request->m_rect.m_h = 32.0f;
+			request->m_pos_z = 0.01f + static_cast<float>(rand() % 64) * 0.001f;
+			pRenderer->Add( request );
+		}
+
+		Micro_Benchmark_Add( results, "render_queue_add", Get_Microseconds() - time, micro_benchmark_count );
+
+		time = Get_Microseconds();
+		pRenderer->Prepare_Commands();
+		pRenderer->Cull();
+		Micro_Benchmark_Add( results, "render_queue_cull", Get_Microseconds() - time, micro_benchmark_count );
+
+		const unsigned int sorted_count = pRenderer->m_commands.size();
+
+		time = Get_Microseconds();
+		pRenderer->Sort();
+		Micro_Benchmark_Add( results, "render_queue_sort", Get_Microseconds() - time, sorted_count );
+
+		time = Get_Microseconds();
+		pRenderer->Fake_Render();
+		Micro_Benchmark_Add( results, "render_queue_clear", Get_Microseconds() - time, micro_benchmark_count );
+	}
+}
+
+// Measure the rect intersection tests
+static void Micro_Benchmark_Rect( Micro_Benchmark_Result_List &results )
+{
+	vector<GL_rect> rects( micro_benchmark_count );
+
+	for( unsigned int i = 0; i < micro_benchmark_count; i++ )
+	{
+		rects[i] = GL_rect( Micro_Benchmark_Random( 2000.0f ), Micro_Benchmark_Random( 2000.0f ), Micro_Benchmark_Random( 200.0f ), Micro_Benchmark_Random( 200.0f ) );
+	}
+
+	for( unsigned int round = 0; round < micro_benchmark_rounds; round++ )
+	{
+		const GL_rect &rect = rects[round % micro_benchmark_count];
+		unsigned int hits = 0;
+
+		const Uint64 time = Get_Microseconds();
+
+		for( unsigned int i = 0; i < micro_benchmark_count; i++ )
+		{
+			if( rect.Intersects( rects[i] ) )
+			{
+				hits++;
+			}
+		}
+
+		Micro_Benchmark_Add( results, "rect_intersects", Get_Microseconds() - time, micro_benchmark_count );
+		micro_benchmark_sink += hits;
+	}
+}
+
+// Measure adding, getting and deleting objects of an object manager
+static void Micro_Benchmark_Object_Manager( Micro_Benchmark_Result_List &results )
+{
+	cObject_Manager<GL_rect> manager;
+	vector<GL_rect *> objects( micro_benchmark_count );
+
+	// fewer rounds as deleting by pointer is linear
+	for( unsigned int round = 0; round < micro_benchmark_rounds / 10; round++ )
+	{
+		for( unsigned int i = 0; i < micro_benchmark_count; i++ )
+		{
+			objects[i] = new GL_rect();
+		}
+
+		Uint64 time = Get_Microseconds();
+
+		for( unsigned int i = 0; i < micro_benchmark_count; i++ )
+		{
+			manager.Add( objects[i] );
+		}
+
+		Micro_Benchmark_Add( results, "object_manager_add", Get_Microseconds() - time, micro_benchmark_count );
+
+		time = Get_Microseconds();
+		unsigned int found = 0;
+
+		for( unsigned int i = 0; i < micro_benchmark_count; i++ )
+		{
+			if( manager.Get_Pointer( ( i * 7919 ) % micro_benchmark_count ) )
+			{
+				found++;
+			}
+		}
+
+		Micro_Benchmark_Add( results, "object_manager_get", Get_Microseconds() - time, micro_benchmark_count );
+		micro_benchmark_sink += found;
+
+		time = Get_Microseconds();
+
+		// in random order
+		for( unsigned int i = 0; i < micro_benchmark_count; i++ )
+		{
+			manager.Delete( objects[( i * 7919 ) % micro_benchmark_count] );
+		}
+
+		Micro_Benchmark_Add( results, "object_manager_delete", Get_Microseconds() - time, micro_benchmark_count );
+	}
+}
+
+// Measure the path lookups of the image and sound managers
+static void Micro_Benchmark_Manager_Lookup( Micro_Benchmark_Result_List &results )
+{
+	vector<std::string> image_paths;
+	vector<std::string> sound_paths;
+
+	for( unsigned int i = 0; i < pImage_Manager->size(); i++ )
+	{
+		image_paths.push_back( (*pImage_Manager)[i]->m_filename );
+	}
+
+	for( unsigned int i = 0; i < pSound_Manager->size(); i++ )
+	{
+		sound_paths.push_back( (*pSound_Manager)[i]->m_filename );
+	}
+
+	// also missing paths
+	image_paths.push_back( "missing/image.png" );
+	sound_paths.push_back( "missing/sound.ogg" );
+
+	for( unsigned int round = 0; round < micro_benchmark_rounds; round++ )
+	{
+		unsigned int found = 0;
+		Uint64 time = Get_Microseconds();
+
+		for( unsigned int i = 0; i < micro_benchmark_count; i++ )
+		{
+			if( pImage_Manager->Get_Pointer( image_paths[( round + i ) % image_paths.size()] ) )
+			{
+				found++;
+			}
+		}
+
+		Micro_Benchmark_Add( results, "image_manager_lookup", Get_Microseconds() - time, micro_benchmark_count );
+
+		time = Get_Microseconds();
+
+		for( unsigned int i = 0; i < micro_benchmark_count; i++ )
+		{
+			if( pSound_Manager->Get_Pointer( sound_paths[( round + i ) % sound_paths.size()] ) )
+			{
+				found++;
+			}
+		}
+
+		Micro_Benchmark_Add( results, "sound_manager_lookup", Get_Microseconds() - time, micro_benchmark_count );
+		micro_benchmark_sink += found;
+	}
+}
+
+// parser which only counts the lines
+class cMicro_Benchmark_Parser : public cFile_parser
+{
+public:
+	cMicro_Benchmark_Parser( void )
+	: m_parts( 0 ) {}
+
+	virtual bool Handle_Tokens( const cFile_Token *tokens, unsigned int count, unsigned int line )
+	{
+		m_parts += count;
+		return 1;
+	}
+
+	unsigned int m_parts;
+};
+
+// Measure tokenizing image settings lines
+static void Micro_Benchmark_File_Parser( Micro_Benchmark_Result_List &results )
+{
+	static const char *lines[] = { "type massive", "col_rect 2 4 60 58", "rotation 0 0 90 1", "ground_type ice", "# comment line", "width 64" };
+	const unsigned int line_count = sizeof( lines ) / sizeof( lines[0] );
+	cMicro_Benchmark_Parser parser;
+
+	for( unsigned int round = 0; round < micro_benchmark_rounds; round++ )
+	{
+		const Uint64 time = Get_Microseconds();
+
+		for( unsigned int i = 0; i < micro_benchmark_count; i++ )
+		{
+			parser.Parse_Line( lines[i % line_count], i );
+		}
+
+		Micro_Benchmark_Add( results, "file_parser_parse_line", Get_Microseconds() - time, micro_benchmark_count );
+	}
+
+	micro_benchmark_sink += parser.m_parts;
+}
+
+// Measure the number conversions used by the level loading and saving
+static void Micro_Benchmark_Property_Helper( Micro_Benchmark_Result_List &results )
+{
+	vector<std::string> strings( micro_benchmark_count );
+
+	for( unsigned int i = 0; i < micro_benchmark_count; i++ )
+	{
+		strings[i] = float_to_string( Micro_Benchmark_Random( 10000.0f ) - 5000.0f, 6, 0 );
+	}
+
+	for( unsigned int round = 0; round < micro_benchmark_rounds; round++ )
+	{
+		float total = 0.0f;
+		Uint64 time = Get_Microseconds();
+
+		for( unsigned int i = 0; i < micro_benchmark_count; i++ )
+		{
+			total += string_to_float( strings[i] );
+		}
+
+		Micro_Benchmark_Add( results, "string_to_float", Get_Microseconds() - time, micro_benchmark_count );
+
+		unsigned int length = 0;
+		time = Get_Microseconds();
+
+		for( unsigned int i = 0; i < micro_benchmark_count; i++ )
+		{
+			length += float_to_string( total + i * 0.25f, 6, 0 ).length();
+		}
+
+		Micro_Benchmark_Add( results, "float_to_string", Get_Microseconds() - time, micro_benchmark_count );
+		micro_benchmark_sink += length;
+	}
+}
+
+// Measure updating the particles of an emitter
+static void Micro_Benchmark_Particles( Micro_Benchmark_Result_List &results )
+{
+	cSprite_Manager sprite_manager;
+	cParticle_Emitter *emitter = new cParticle_Emitter( &sprite_manager );
+	emitter->Set_Image( pVideo->Get_Surface( "animation/particles/light.png" ) );
+	emitter->Set_Emitter_Rect( 0.0f, 0.0f, 400.0f, 10.0f );
+	emitter->Set_Emitter_Time_to_Live( -1.0f );
+	emitter->Set_Emitter_Iteration_Interval( 0.01f );
+	emitter->Set_Quota( 20 );
+	emitter->Set_Time_to_Live( 2.0f );
+	emitter->Set_Speed( 3.0f, 1.0f );
+	emitter->Set_Direction_Range( 180.0f, 180.0f );
+	emitter->Set_Fading_Alpha( 1 );
+
+	// constant speed
+	const float speed_factor = pFramerate->m_speed_factor;
+	pFramerate->m_speed_factor = 1.0f;
+
+	// fill up
+	for( unsigned int i = 0; i < 200; i++ )
+	{
+		emitter->Update_Particles();
+	}
+
+	for( unsigned int round = 0; round < micro_benchmark_rounds; round++ )
+	{
+		const unsigned int particle_count = emitter->m_particles.m_count;
+		const Uint64 time = Get_Microseconds();
+
+		emitter->Update_Particles();
+
+		Micro_Benchmark_Add( results, "particle_emitter_update", Get_Microseconds() - time, particle_count ? particle_count : 1 );
+	}
+
+	pFramerate->m_speed_factor = speed_factor;
+	delete emitter;
+}
+
+bool Micro_Benchmark( const std::string &filename )
+{
+	// the same values in every run
+	srand( 1 );
+
+	Micro_Benchmark_Result_List results;
+
+	Micro_Benchmark_Render_Queue( results );
+	Micro_Benchmark_Rect( results );
+	Micro_Benchmark_Object_Manager( results );
+	Micro_Benchmark_Manager_Lookup( results );
+	Micro_Benchmark_File_Parser( results );
+	Micro_Benchmark_Property_Helper( results );
+	Micro_Benchmark_Particles( results );
+
+	std::string json = "{\"version\":\"" + int_to_string( SMC_VERSION_MAJOR ) + "." + int_to_string( SMC_VERSION_MINOR ) + "." + int_to_string( SMC_VERSION_PATCH ) + "\",\"benchmarks\":[";
+
+	for( Micro_Benchmark_Result_List::const_iterator itr = results.begin(); itr != results.end(); ++itr )
+	{
+		const Micro_Benchmark_Result &result = (*itr);
+		const double ns_per_op = result.m_operations ? ( static_cast<double>(result.m_time) * 1000.0 ) / static_cast<double>(result.m_operations) : 0.0;
+
+		if( itr != results.begin() )
+		{
+			json += ",";
+		}
+
+		json += "\n{\"name\":\"" + result.m_name + "\",\"operations\":" + int64_to_string( result.m_operations ) + ",\"ns_per_op\":" + float_to_string( ns_per_op, 2 ) + "}";
+	}
+
+	json += "\n]}\n";
+
+	printf( "%s", json.c_str() );
+
+	if( filename.empty() )
+	{
+		return 1;
+	}
+
+	FILE *file = fopen( filename.c_str(), "w" );
+
+	if( !file )
+	{
+		printf( "Error : Couldn't create micro benchmark result %s\n", filename.c_str() );
+		return 0;
+	}
+
+	fputs( json.c_str(), file );
+	fclose( file );
+
+	return 1;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
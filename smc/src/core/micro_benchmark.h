@@ -0,0 +1,40 @@
+/***************************************************************************
+ * micro_benchmark.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_MICRO_BENCHMARK_H
+#define SMC_MICRO_BENCHMARK_H
+
+#include "../core/global_basic.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** Micro Benchmark *** *** *** *** *** *** *** *** *** *** */
+
+/* Measure the core containers and helpers used every frame
+ * render queue, rect intersection, object manager, image and sound lookups,
+ * file parser lines, number conversions and particle updates
+ * and print the nanoseconds per operation as JSON
+ * only built into the benchmark program of "make bench"
+ * filename : if set the JSON is also written to this file
+ * returns false if the file could not be written
+*/
+bool Micro_Benchmark( const std::string &filename );
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -18,6 +18,8 @@
 
 #include "../core/global_basic.h"
 #include <algorithm>
+// boost
+#include <boost/thread/mutex.hpp>
 
 namespace SMC
 {
@@ -39,15 +41,18 @@ public:
 	// Delete the object from given array number
 	virtual bool Delete( size_t array_num, bool delete_data = 1 )
 	{
-		// if in vector
-		if( array_num < objects.size() )
+		// not in vector
+		if( array_num >= objects.size() )
 		{
-			objects.erase( objects.begin() + array_num );
+			return 0;
 		}
 
+		T *obj = objects[array_num];
+		objects.erase( objects.begin() + array_num );
+
 		if( delete_data )
 		{
-			delete objects[array_num];
+			delete obj;
 		}
 
 		return 1;
@@ -181,6 +186,116 @@ public:
 	vector<T*> objects;
 };
 
+/* *** *** *** *** *** cObject_Handle *** *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Reference to an object which can be checked if the object still exists
+ * stays invalid after the object is deleted even if a new object gets the same memory
+*/
+struct cObject_Handle
+{
+	cObject_Handle( void )
+	: m_slot( 0 ), m_generation( 0 ) {};
+
+	unsigned int m_slot;
+	// never 0 for a valid handle
+	unsigned int m_generation;
+};
+
+/* *** *** *** *** *** cObject_Handle_Table *** *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Gives out the handles for objects
+ * the slot of a released handle is reused with a new generation
+ * objects can be created and deleted in several threads at once
+*/
+template<class T> class cObject_Handle_Table
+{
+public:
+	cObject_Handle_Table( void ) {};
+	~cObject_Handle_Table( void ) {};
+
+	// Return a new handle for the object
+	cObject_Handle Acquire( T *obj )
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+		cObject_Handle handle;
+
+		if( m_free_slots.empty() )
+		{
+			Slot slot;
+			slot.m_obj = obj;
+			slot.m_generation = 1;
+			m_slots.push_back( slot );
+
+			handle.m_slot = m_slots.size() - 1;
+		}
+		else
+		{
+			handle.m_slot = m_free_slots.back();
+			m_free_slots.pop_back();
+			m_slots[handle.m_slot].m_obj = obj;
+		}
+
+		handle.m_generation = m_slots[handle.m_slot].m_generation;
+		return handle;
+	}
+
+	// Invalidate the handle and all of its copies
+	void Release( const cObject_Handle &handle )
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+
+		if( !Get_Unlocked( handle ) )
+		{
+			return;
+		}
+
+		Slot &slot = m_slots[handle.m_slot];
+		slot.m_obj = NULL;
+		slot.m_generation++;
+
+		// skip the invalid generation
+		if( !slot.m_generation )
+		{
+			slot.m_generation = 1;
+		}
+
+		m_free_slots.push_back( handle.m_slot );
+	}
+
+	/* Return the object of the handle
+	 * if released returns NULL
+	*/
+	T *Get( const cObject_Handle &handle ) const
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+
+		return Get_Unlocked( handle );
+	}
+
+private:
+	// Return the object of the handle with the mutex locked
+	T *Get_Unlocked( const cObject_Handle &handle ) const
+	{
+		if( handle.m_slot >= m_slots.size() || m_slots[handle.m_slot].m_generation != handle.m_generation )
+		{
+			return NULL;
+		}
+
+		return m_slots[handle.m_slot].m_obj;
+	}
+
+	struct Slot
+	{
+		T *m_obj;
+		unsigned int m_generation;
+	};
+
+	vector<Slot> m_slots;
+	vector<unsigned int> m_free_slots;
+	// locked while using the slots
+	mutable boost::mutex m_mutex;
+};
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 } // namespace SMC
@@ -0,0 +1,349 @@
+/***************************************************************************
+ * object_profiler.cpp  -  update and collision costs of the object types
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/object_profiler.h"
+#include "../core/framerate.h"
+#include "../core/collision.h"
+#include "../core/property_helper.h"
+#include "../objects/sprite.h"
+// STL
+#include <algorithm>
+#include <typeinfo>
+#include <cstdlib>
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cObject_Profiler *** *** *** *** *** *** *** *** *** *** */
+
+// frames of a window if not set
+static const unsigned int object_profiler_window_frames = 100;
+
+// Returns the readable class name of the type info without the namespace
+static std::string Object_Profiler_Class_Name( const std::type_info &info )
+{
+	std::string name = info.name();
+
+#ifdef __GNUC__
+	int status = 0;
+	char *demangled = abi::__cxa_demangle( info.name(), NULL, NULL, &status );
+
+	if( demangled )
+	{
+		name = demangled;
+		free( demangled );
+	}
+#endif
+
+	// msvc adds the class keyword
+	if( name.compare( 0, 6, "class " ) == 0 )
+	{
+		name.erase( 0, 6 );
+	}
+
+	if( name.compare( 0, 5, "SMC::" ) == 0 )
+	{
+		name.erase( 0, 5 );
+	}
+
+	return name;
+}
+
+// sorts costs by the most time first
+struct object_cost_time_sort
+{
+	bool operator()( const cObject_Profiler::Cost &a, const cObject_Profiler::Cost &b ) const
+	{
+		return a.Get_Time() > b.Get_Time();
+	}
+};
+
+cObject_Profiler::Cost :: Cost( void )
+{
+	for( unsigned int i = 0; i < PHASE_COUNT; i++ )
+	{
+		m_time[i] = 0;
+		m_calls[i] = 0;
+	}
+
+	m_candidates = 0;
+	m_collisions = 0;
+}
+
+Uint64 cObject_Profiler::Cost :: Get_Time( void ) const
+{
+	Uint64 time = 0;
+
+	for( unsigned int i = 0; i < PHASE_COUNT; i++ )
+	{
+		time += m_time[i];
+	}
+
+	return time;
+}
+
+cObject_Profiler :: cObject_Profiler( void )
+{
+	m_window_frames = object_profiler_window_frames;
+	m_enabled = 0;
+	m_frames = 0;
+	m_last_frames = 0;
+	m_current_type = -1;
+	m_current_class = -1;
+	m_current_phase = PHASE_UPDATE;
+	m_start_time = 0;
+	m_start_collisions = 0;
+	m_depth = 0;
+}
+
+cObject_Profiler :: ~cObject_Profiler( void )
+{
+	//
+}
+
+void cObject_Profiler :: Set_Enabled( bool enable )
+{
+	if( m_enabled == enable )
+	{
+		return;
+	}
+
+	m_enabled = enable;
+
+	// start with new costs
+	if( m_enabled )
+	{
+		Clear();
+	}
+}
+
+void cObject_Profiler :: Clear( void )
+{
+	m_types.clear();
+	m_classes.clear();
+	m_last_types.clear();
+	m_last_classes.clear();
+	m_class_map.clear();
+	m_frames = 0;
+	m_last_frames = 0;
+	m_current_type = -1;
+	m_current_class = -1;
+	m_depth = 0;
+}
+
+void cObject_Profiler :: Begin( const cSprite *sprite, Phase phase )
+{
+	m_depth++;
+
+	// part of the measured phase
+	if( m_depth > 1 )
+	{
+		return;
+	}
+
+	m_current_type = Get_Type_Cost( sprite );
+	m_current_class = Get_Class_Cost( sprite );
+	m_current_phase = phase;
+	m_start_collisions = Get_Collision_Created_Count();
+	m_start_time = Get_Microseconds();
+}
+
+void cObject_Profiler :: End( void )
+{
+	if( !m_depth )
+	{
+		return;
+	}
+
+	m_depth--;
+
+	if( m_depth || m_current_type < 0 )
+	{
+		return;
+	}
+
+	const Uint64 time = Get_Microseconds() - m_start_time;
+	const unsigned int collisions = Get_Collision_Created_Count() - m_start_collisions;
+
+	Cost &type_cost = m_types[m_current_type];
+	type_cost.m_time[m_current_phase] += time;
+	type_cost.m_calls[m_current_phase]++;
+	type_cost.m_collisions += collisions;
+
+	Cost &class_cost = m_classes[m_current_class];
+	class_cost.m_time[m_current_phase] += time;
+	class_cost.m_calls[m_current_phase]++;
+	class_cost.m_collisions += collisions;
+
+	m_current_type = -1;
+	m_current_class = -1;
+}
+
+void cObject_Profiler :: Add_Candidates( unsigned int count )
+{
+	if( m_current_type < 0 )
+	{
+		return;
+	}
+
+	m_types[m_current_type].m_candidates += count;
+	m_classes[m_current_class].m_candidates += count;
+}
+
+void cObject_Profiler :: Frame_End( void )
+{
+	if( !m_enabled )
+	{
+		return;
+	}
+
+	m_frames++;
+
+	if( !m_window_frames || m_frames < m_window_frames )
+	{
+		return;
+	}
+
+	m_last_types.swap( m_types );
+	m_last_classes.swap( m_classes );
+	m_last_frames = m_frames;
+
+	// keep the names and indexes for the next window
+	m_types = m_last_types;
+	m_classes = m_last_classes;
+	m_frames = 0;
+
+	for( Cost_List::iterator itr = m_types.begin(); itr != m_types.end(); ++itr )
+	{
+		const std::string name = itr->m_name;
+		*itr = Cost();
+		itr->m_name = name;
+	}
+
+	for( Cost_List::iterator itr = m_classes.begin(); itr != m_classes.end(); ++itr )
+	{
+		const std::string name = itr->m_name;
+		*itr = Cost();
+		itr->m_name = name;
+	}
+}
+
+unsigned int cObject_Profiler :: Get_Top_Costs( Cost_List &costs, bool by_class, unsigned int count ) const
+{
+	// the current window until the first one is full
+	const bool last = m_last_frames > 0;
+
+	costs = by_class ? ( last ? m_last_classes : m_classes ) : ( last ? m_last_types : m_types );
+
+	// not used in the window
+	Cost_List::iterator kept_itr = costs.begin();
+
+	for( Cost_List::iterator itr = costs.begin(); itr != costs.end(); ++itr )
+	{
+		if( itr->Get_Time() == 0 && itr->m_candidates == 0 )
+		{
+			continue;
+		}
+
+		*kept_itr = *itr;
+		++kept_itr;
+	}
+
+	costs.erase( kept_itr, costs.end() );
+	std::sort( costs.begin(), costs.end(), object_cost_time_sort() );
+
+	if( costs.size() > count )
+	{
+		costs.resize( count );
+	}
+
+	return last ? m_last_frames : m_frames;
+}
+
+bool cObject_Profiler :: Get_Object_Time( SpriteType type, float &time ) const
+{
+	const Cost_List &costs = m_last_frames > 0 ? m_last_types : m_types;
+	const unsigned int num = static_cast<unsigned int>(type);
+
+	if( num >= costs.size() )
+	{
+		return 0;
+	}
+
+	const Cost &cost = costs[num];
+	// every object is updated once a frame
+	unsigned int calls = cost.m_calls[PHASE_UPDATE];
+
+	for( unsigned int i = 0; i < PHASE_COUNT; i++ )
+	{
+		calls = std::max( calls, cost.m_calls[i] );
+	}
+
+	if( !calls )
+	{
+		return 0;
+	}
+
+	time = static_cast<float>(cost.Get_Time()) / static_cast<float>(calls);
+	return 1;
+}
+
+unsigned int cObject_Profiler :: Get_Type_Cost( const cSprite *sprite )
+{
+	const unsigned int type = static_cast<unsigned int>(sprite->m_type);
+
+	if( type >= m_types.size() )
+	{
+		m_types.resize( type + 1 );
+	}
+
+	Cost &cost = m_types[type];
+
+	if( cost.m_name.empty() )
+	{
+		cost.m_name = sprite->m_type_name + " (" + int_to_string( type ) + ")";
+	}
+
+	return type;
+}
+
+unsigned int cObject_Profiler :: Get_Class_Cost( const cSprite *sprite )
+{
+	const std::type_info &info = typeid( *sprite );
+	Class_Map::const_iterator itr = m_class_map.find( info.name() );
+
+	if( itr != m_class_map.end() )
+	{
+		return itr->second;
+	}
+
+	Cost cost;
+	cost.m_name = Object_Profiler_Class_Name( info );
+	m_classes.push_back( cost );
+
+	const unsigned int num = m_classes.size() - 1;
+	m_class_map[info.name()] = num;
+
+	return num;
+}
+
+cObject_Profiler *pObject_Profiler = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
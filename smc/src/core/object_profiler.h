@@ -0,0 +1,183 @@
+/***************************************************************************
+ * object_profiler.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_OBJECT_PROFILER_H
+#define SMC_OBJECT_PROFILER_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+// SDL
+#include "SDL.h"
+// STL
+#include <map>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cObject_Profiler *** *** *** *** *** *** *** *** *** *** */
+
+/* Attributes the update, draw and collision time of the sprite manager objects
+ * to their sprite type and class to find the objects which make a level slow
+ * also counts the tested collision candidates and created collisions
+ * the costs are added up over a window of frames and the last full window is shown
+ * only measures the main thread and does nothing if not enabled
+*/
+class cObject_Profiler
+{
+public:
+	cObject_Profiler( void );
+	~cObject_Profiler( void );
+
+	// measured object functions
+	enum Phase
+	{
+		PHASE_UPDATE = 0,
+		PHASE_UPDATE_LATE = 1,
+		PHASE_DRAW = 2,
+		PHASE_COLLISION = 3,
+		PHASE_COUNT = 4
+	};
+
+	// costs of a sprite type or class
+	struct Cost
+	{
+		Cost( void );
+
+		// Returns the microseconds of all phases
+		Uint64 Get_Time( void ) const;
+
+		std::string m_name;
+		// microseconds and calls of each phase
+		Uint64 m_time[PHASE_COUNT];
+		unsigned int m_calls[PHASE_COUNT];
+		// tested collision candidates
+		unsigned int m_candidates;
+		// created collisions
+		unsigned int m_collisions;
+	};
+
+	typedef vector<Cost> Cost_List;
+
+	// Enable or disable measuring and clear the costs if enabled
+	void Set_Enabled( bool enable );
+	// Returns true if measuring
+	inline bool Is_Enabled( void ) const
+	{
+		return m_enabled;
+	}
+	// Clear the costs of all windows
+	void Clear( void );
+
+	/* Start measuring the phase of the object
+	 * a phase started while measuring is part of the first one
+	*/
+	void Begin( const cSprite *sprite, Phase phase );
+	// Stop measuring the last started phase
+	void End( void );
+	// Add tested collision candidates to the measured object
+	void Add_Candidates( unsigned int count );
+
+	/* Finish the window if it has enough frames
+	 * must be called at the end of the frame
+	*/
+	void Frame_End( void );
+
+	/* Get the costs with the most time first
+	 * by_class : if set by class instead of sprite type
+	 * count : maximum number of costs
+	 * returns the number of frames of the costs
+	*/
+	unsigned int Get_Top_Costs( Cost_List &costs, bool by_class, unsigned int count ) const;
+	/* Get the measured microseconds of one object of the sprite type in a frame
+	 * from the last full window or the current one
+	 * returns false if the type was not measured
+	*/
+	bool Get_Object_Time( SpriteType type, float &time ) const;
+
+	/* frames of a window
+	 * if 0 the costs are added up until cleared
+	*/
+	unsigned int m_window_frames;
+
+private:
+	// Returns the cost of the sprite type
+	unsigned int Get_Type_Cost( const cSprite *sprite );
+	// Returns the cost of the sprite class
+	unsigned int Get_Class_Cost( const cSprite *sprite );
+
+	// if measuring
+	bool m_enabled;
+
+	// costs of the current window by sprite type and class
+	Cost_List m_types;
+	Cost_List m_classes;
+	// frames of the current window
+	unsigned int m_frames;
+	// costs and frames of the last full window
+	Cost_List m_last_types;
+	Cost_List m_last_classes;
+	unsigned int m_last_frames;
+
+	// class cost of each class type info name
+	typedef std::map<const char *, unsigned int> Class_Map;
+	Class_Map m_class_map;
+
+	// measured object costs and phase or -1
+	int m_current_type;
+	int m_current_class;
+	Phase m_current_phase;
+	// start of the measured phase
+	Uint64 m_start_time;
+	unsigned int m_start_collisions;
+	// phases started while measuring
+	unsigned int m_depth;
+};
+
+// Object cost profiler
+extern cObject_Profiler *pObject_Profiler;
+
+/* Measures a phase of an object until it is destroyed
+ * only checks if the profiler is enabled if not
+*/
+class cObject_Profiler_Scope
+{
+public:
+	cObject_Profiler_Scope( const cSprite *sprite, cObject_Profiler::Phase phase )
+	{
+		m_entered = pObject_Profiler && pObject_Profiler->Is_Enabled();
+
+		if( m_entered )
+		{
+			pObject_Profiler->Begin( sprite, phase );
+		}
+	}
+
+	~cObject_Profiler_Scope( void )
+	{
+		if( m_entered && pObject_Profiler )
+		{
+			pObject_Profiler->End();
+		}
+	}
+
+private:
+	bool m_entered;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -0,0 +1,507 @@
+/***************************************************************************
+ * profiler.cpp  -  nested section times of each frame
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/profiler.h"
+#include "../core/game_core.h"
+#include "../core/filesystem/filesystem.h"
+#include "../core/filesystem/resource_manager.h"
+// boost
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <cstring>
+#include <fstream>
+
+namespace SMC
+{
+
+// Returns the current time in microseconds
+static Uint64 Profiler_Get_Time( void )
+{
+	static const boost::posix_time::ptime epoch = boost::posix_time::microsec_clock::universal_time();
+	return static_cast<Uint64>(( boost::posix_time::microsec_clock::universal_time() - epoch ).total_microseconds());
+}
+
+// Returns the string as JSON string
+static std::string Profiler_JSON_String( const char *str )
+{
+	std::string json = "\"";
+
+	for( const char *c = str; *c; c++ )
+	{
+		if( *c == '"' || *c == '\\' )
+		{
+			json += '\\';
+			json += *c;
+		}
+		else if( static_cast<unsigned char>(*c) < 0x20 )
+		{
+			json += ' ';
+		}
+		else
+		{
+			json += *c;
+		}
+	}
+
+	return json + "\"";
+}
+
+/* *** *** *** *** *** *** *** cProfiler *** *** *** *** *** *** *** *** *** *** */
+
+cProfiler :: cProfiler( void )
+: m_thread_data( &cProfiler::Thread_Exit )
+{
+	m_enabled = 0;
+	m_capture_frames = 0;
+	m_capture_frame_start = 0;
+	m_main_thread_id = boost::this_thread::get_id();
+
+	Section main_root;
+	main_root.m_name = "main thread";
+	m_sections.push_back( main_root );
+
+	Section worker_root;
+	worker_root.m_name = "worker threads";
+	m_sections.push_back( worker_root );
+}
+
+cProfiler :: ~cProfiler( void )
+{
+	// exited before all frames were captured
+	if( Is_Capturing() )
+	{
+		Write_Capture();
+	}
+
+	// the call tree of this thread is deleted with the others
+	m_thread_data.release();
+
+	for( Thread_Data_List::iterator itr = m_threads.begin(); itr != m_threads.end(); ++itr )
+	{
+		delete *itr;
+	}
+
+	m_threads.clear();
+}
+
+void cProfiler :: Set_Enabled( bool enable )
+{
+	// measuring is needed for the capture
+	if( Is_Capturing() )
+	{
+		enable = 1;
+	}
+
+	if( m_enabled == enable )
+	{
+		return;
+	}
+
+	m_enabled = enable;
+
+	if( !m_enabled )
+	{
+		return;
+	}
+
+	// start with new times
+	for( Section_List::iterator itr = m_sections.begin(); itr != m_sections.end(); ++itr )
+	{
+		itr->m_timer.Reset();
+		itr->m_frame_time = 0;
+		itr->m_frame_count = 0;
+		itr->m_active = 0;
+	}
+
+	boost::mutex::scoped_lock lock( m_threads_mutex );
+
+	for( Thread_Data_List::iterator itr = m_threads.begin(); itr != m_threads.end(); ++itr )
+	{
+		Thread_Data *data = (*itr);
+		boost::mutex::scoped_lock data_lock( data->m_mutex );
+
+		for( Node_List::iterator node_itr = data->m_nodes.begin(); node_itr != data->m_nodes.end(); ++node_itr )
+		{
+			node_itr->m_time = 0;
+			node_itr->m_count = 0;
+		}
+	}
+}
+
+void cProfiler :: Enter( const char *name )
+{
+	Thread_Data *data = Get_Thread_Data();
+	const Uint64 start_time = Profiler_Get_Time();
+
+	boost::mutex::scoped_lock lock( data->m_mutex );
+
+	Node_List &nodes = data->m_nodes;
+	int child = nodes[data->m_current].m_child;
+	int last_child = -1;
+
+	// the same name can have another address in other files
+	while( child >= 0 && nodes[child].m_name != name && strcmp( nodes[child].m_name, name ) != 0 )
+	{
+		last_child = child;
+		child = nodes[child].m_sibling;
+	}
+
+	// entered the first time
+	if( child < 0 )
+	{
+		Node node;
+		node.m_name = name;
+		node.m_parent = data->m_current;
+
+		child = nodes.size();
+		nodes.push_back( node );
+
+		if( last_child < 0 )
+		{
+			nodes[data->m_current].m_child = child;
+		}
+		else
+		{
+			nodes[last_child].m_sibling = child;
+		}
+	}
+
+	data->m_current = child;
+	data->m_start_times.push_back( start_time );
+}
+
+void cProfiler :: Leave( void )
+{
+	Thread_Data *data = m_thread_data.get();
+
+	if( !data )
+	{
+		return;
+	}
+
+	const Uint64 end_time = Profiler_Get_Time();
+
+	boost::mutex::scoped_lock lock( data->m_mutex );
+
+	if( data->m_start_times.empty() )
+	{
+		return;
+	}
+
+	Node &node = data->m_nodes[data->m_current];
+	node.m_time += end_time - data->m_start_times.back();
+	node.m_count++;
+
+	if( m_capture_frames )
+	{
+		Event event;
+		event.m_name = node.m_name;
+		event.m_thread = data->m_number;
+		event.m_start = data->m_start_times.back();
+		event.m_duration = end_time - event.m_start;
+		data->m_events.push_back( event );
+	}
+
+	data->m_start_times.pop_back();
+	data->m_current = node.m_parent;
+}
+
+void cProfiler :: Frame_End( void )
+{
+	if( !m_enabled )
+	{
+		return;
+	}
+
+	{
+		boost::mutex::scoped_lock lock( m_threads_mutex );
+
+		for( Thread_Data_List::iterator itr = m_threads.begin(); itr != m_threads.end(); )
+		{
+			Thread_Data *data = (*itr);
+
+			{
+				boost::mutex::scoped_lock data_lock( data->m_mutex );
+				Add_Node( data->m_nodes, 0, data->m_main ? m_main_root : m_worker_root );
+			}
+
+			if( data->m_exited )
+			{
+				delete data;
+				itr = m_threads.erase( itr );
+				continue;
+			}
+
+			++itr;
+		}
+	}
+
+	Finish_Sections();
+
+	if( m_capture_frames )
+	{
+		const Uint64 time = Profiler_Get_Time();
+
+		Event event;
+		event.m_name = "frame";
+		event.m_thread = 0;
+		event.m_start = m_capture_frame_start;
+		event.m_duration = time - m_capture_frame_start;
+		m_capture_events.push_back( event );
+
+		m_capture_frame_start = time;
+		m_capture_frames--;
+
+		if( !m_capture_frames )
+		{
+			Write_Capture();
+		}
+	}
+}
+
+void cProfiler :: Start_Capture( unsigned int frames, const std::string &filename /* = "" */ )
+{
+	if( Is_Capturing() || !frames )
+	{
+		return;
+	}
+
+	m_capture_filename = filename;
+
+	// next free trace file
+	if( m_capture_filename.empty() )
+	{
+		for( unsigned int i = 1; i < 1000; i++ )
+		{
+			m_capture_filename = pResource_Manager->user_data_dir + "trace_" + int_to_string( i ) + ".json";
+
+			if( !File_Exists( m_capture_filename ) )
+			{
+				break;
+			}
+		}
+	}
+
+	Set_Enabled( 1 );
+
+	// only sections left from now on
+	{
+		boost::mutex::scoped_lock lock( m_threads_mutex );
+
+		for( Thread_Data_List::iterator itr = m_threads.begin(); itr != m_threads.end(); ++itr )
+		{
+			boost::mutex::scoped_lock data_lock( (*itr)->m_mutex );
+			(*itr)->m_events.clear();
+		}
+	}
+
+	m_capture_events.clear();
+	m_capture_counters.clear();
+	m_capture_frame_start = Profiler_Get_Time();
+	m_capture_frames = frames;
+}
+
+void cProfiler :: Add_Counter( const char *name, double value )
+{
+	if( !m_capture_frames )
+	{
+		return;
+	}
+
+	Counter counter;
+	counter.m_name = name;
+	counter.m_time = Profiler_Get_Time();
+	counter.m_value = value;
+	m_capture_counters.push_back( counter );
+}
+
+Uint64 cProfiler :: Get_Last_Frame_Time( const char *name ) const
+{
+	Uint64 time = 0;
+
+	for( unsigned int i = m_worker_root + 1; i < m_sections.size(); i++ )
+	{
+		const Section &obj = m_sections[i];
+
+		if( obj.m_active && strcmp( obj.m_name, name ) == 0 )
+		{
+			time += obj.m_timer.Get_History( 0 );
+		}
+	}
+
+	return time;
+}
+
+cProfiler::Thread_Data *cProfiler :: Get_Thread_Data( void )
+{
+	Thread_Data *data = m_thread_data.get();
+
+	if( data )
+	{
+		return data;
+	}
+
+	data = new Thread_Data();
+	data->m_main = boost::this_thread::get_id() == m_main_thread_id;
+	// root
+	data->m_nodes.push_back( Node() );
+
+	boost::mutex::scoped_lock lock( m_threads_mutex );
+	data->m_number = m_capture_threads.size();
+	m_capture_threads.push_back( data->m_main );
+	m_threads.push_back( data );
+	m_thread_data.reset( data );
+
+	return data;
+}
+
+void cProfiler :: Thread_Exit( Thread_Data *data )
+{
+	// deleted with the profiler
+	if( !pProfiler )
+	{
+		return;
+	}
+
+	// deleted with the next frame end after its times are added
+	boost::mutex::scoped_lock lock( pProfiler->m_threads_mutex );
+	data->m_exited = 1;
+}
+
+void cProfiler :: Add_Node( Node_List &nodes, int node, int section )
+{
+	for( int child = nodes[node].m_child; child >= 0; child = nodes[child].m_sibling )
+	{
+		const int child_section = Get_Section_Child( section, nodes[child].m_name );
+		Section &obj = m_sections[child_section];
+
+		obj.m_frame_time += nodes[child].m_time;
+		obj.m_frame_count += nodes[child].m_count;
+		nodes[child].m_time = 0;
+		nodes[child].m_count = 0;
+
+		Add_Node( nodes, child, child_section );
+	}
+}
+
+int cProfiler :: Get_Section_Child( int section, const char *name )
+{
+	int child = m_sections[section].m_child;
+	int last_child = -1;
+
+	while( child >= 0 && m_sections[child].m_name != name && strcmp( m_sections[child].m_name, name ) != 0 )
+	{
+		last_child = child;
+		child = m_sections[child].m_sibling;
+	}
+
+	if( child >= 0 )
+	{
+		return child;
+	}
+
+	Section obj;
+	obj.m_name = name;
+	obj.m_parent = section;
+	obj.m_depth = m_sections[section].m_depth + 1;
+
+	child = m_sections.size();
+	m_sections.push_back( obj );
+
+	if( last_child < 0 )
+	{
+		m_sections[section].m_child = child;
+	}
+	else
+	{
+		m_sections[last_child].m_sibling = child;
+	}
+
+	return child;
+}
+
+void cProfiler :: Finish_Sections( void )
+{
+	m_sections[m_main_root].m_active = 0;
+	m_sections[m_worker_root].m_active = 0;
+
+	for( unsigned int i = m_worker_root + 1; i < m_sections.size(); i++ )
+	{
+		Section &obj = m_sections[i];
+
+		obj.m_active = obj.m_frame_count > 0;
+
+		if( obj.m_active )
+		{
+			obj.m_timer.Add_Time( obj.m_frame_time < 0xFFFFFFFF ? static_cast<Uint32>(obj.m_frame_time) : 0xFFFFFFFF );
+
+			// a thread root is shown if one of its sections was entered
+			if( obj.m_depth == 1 )
+			{
+				m_sections[obj.m_parent].m_active = 1;
+			}
+		}
+
+		obj.m_frame_time = 0;
+		obj.m_frame_count = 0;
+	}
+}
+
+void cProfiler :: Write_Capture( void )
+{
+	m_capture_frames = 0;
+
+	std::ofstream file( m_capture_filename.c_str(), std::ios::out | std::ios::trunc );
+
+	if( !file )
+	{
+		printf( "Error : Couldn't open trace file for saving. Is the file read-only ? %s\n", m_capture_filename.c_str() );
+		m_capture_events.clear();
+		m_capture_counters.clear();
+		return;
+	}
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":" << Profiler_JSON_String( CAPTION ) << "}}";
+
+	for( unsigned int i = 0; i < m_capture_threads.size(); i++ )
+	{
+		const std::string name = m_capture_threads[i] ? "main thread" : "worker thread " + int_to_string( i );
+		file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":" << Profiler_JSON_String( name.c_str() ) << "}}";
+	}
+
+	for( Event_List::const_iterator itr = m_capture_events.begin(); itr != m_capture_events.end(); ++itr )
+	{
+		file << ",\n{\"name\":" << Profiler_JSON_String( itr->m_name ) << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << itr->m_thread << ",\"ts\":" << itr->m_start << ",\"dur\":" << itr->m_duration << "}";
+	}
+
+	for( Counter_List::const_iterator itr = m_capture_counters.begin(); itr != m_capture_counters.end(); ++itr )
+	{
+		file << ",\n{\"name\":" << Profiler_JSON_String( itr->m_name ) << ",\"ph\":\"C\",\"pid\":1,\"ts\":" << itr->m_time << ",\"args\":{\"value\":" << itr->m_value << "}}";
+	}
+
+	file << "\n]}\n";
+	file.close();
+
+	printf( "Trace of %u events written to %s\n", static_cast<unsigned int>( m_capture_events.size() ), m_capture_filename.c_str() );
+
+	m_capture_events.clear();
+	m_capture_counters.clear();
+}
+
+cProfiler *pProfiler = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,269 @@
+/***************************************************************************
+ * profiler.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_PROFILER_H
+#define SMC_PROFILER_H
+
+#include "../core/global_basic.h"
+#include "../core/framerate.h"
+// SDL
+#include "SDL.h"
+// boost thread
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cProfiler *** *** *** *** *** *** *** *** *** *** */
+
+/* Measures the nested sections of each frame in microseconds
+ * every thread records its own call tree of the entered sections
+ * and the trees of all threads are added to the sections at the end of the frame
+ * the sections of the worker threads are combined under their own root
+ * the sections of a number of frames can be captured as Chrome trace events
+ * does nothing if not enabled
+*/
+class cProfiler
+{
+public:
+	cProfiler( void );
+	~cProfiler( void );
+
+	// Enable or disable measuring and clear the sections if enabled
+	void Set_Enabled( bool enable );
+	// Returns true if measuring
+	inline bool Is_Enabled( void ) const
+	{
+		return m_enabled;
+	}
+
+	/* Enter a section in the current section of the calling thread
+	 * name : must stay valid as it is not copied
+	*/
+	void Enter( const char *name );
+	// Leave the last entered section of the calling thread
+	void Leave( void );
+
+	/* Add the section times of all threads to the sections
+	 * must be called from the main thread at the end of the frame
+	*/
+	void Frame_End( void );
+
+	/* Capture the sections entered in the next frames as trace events
+	 * enables measuring until finished
+	 * frames : number of frames
+	 * filename : Chrome trace event JSON file written when finished
+	 * or if empty the next free trace file in the user data directory
+	*/
+	void Start_Capture( unsigned int frames, const std::string &filename = "" );
+	// Returns true if capturing trace events
+	inline bool Is_Capturing( void ) const
+	{
+		return m_capture_frames > 0;
+	}
+	/* Add a counter value of the current frame to the capture
+	 * name : must stay valid as it is not copied
+	*/
+	void Add_Counter( const char *name, double value );
+
+	// section with the times of all frames
+	struct Section
+	{
+		Section( void )
+		: m_name( NULL ), m_parent( -1 ), m_child( -1 ), m_sibling( -1 ), m_depth( 0 ), m_frame_time( 0 ), m_frame_count( 0 ), m_active( 0 ) {}
+
+		const char *m_name;
+		// parent, first child and next sibling section or -1
+		int m_parent;
+		int m_child;
+		int m_sibling;
+		// nesting depth with 0 for the thread roots
+		unsigned int m_depth;
+		// microseconds of the frames
+		cPerformance_Timer m_timer;
+		// microseconds and times entered in the current frame
+		Uint64 m_frame_time;
+		unsigned int m_frame_count;
+		// if entered in the last frame
+		bool m_active;
+	};
+
+	typedef vector<Section> Section_List;
+
+	/* Returns the sections with the main and worker thread roots first
+	 * the children of a section are in the order they were first entered
+	*/
+	inline const Section_List &Get_Sections( void ) const
+	{
+		return m_sections;
+	}
+
+	/* Returns the microseconds of the sections with the name in the last frame
+	 * sections with the name in several places are added
+	*/
+	Uint64 Get_Last_Frame_Time( const char *name ) const;
+
+	// section root of the main thread
+	static const int m_main_root = 0;
+	// section root of the worker threads
+	static const int m_worker_root = 1;
+
+private:
+	// entered section of a thread
+	struct Node
+	{
+		Node( void )
+		: m_name( NULL ), m_parent( -1 ), m_child( -1 ), m_sibling( -1 ), m_time( 0 ), m_count( 0 ) {}
+
+		const char *m_name;
+		// parent, first child and next sibling node or -1
+		int m_parent;
+		int m_child;
+		int m_sibling;
+		// microseconds and times entered since the last frame end
+		Uint64 m_time;
+		unsigned int m_count;
+	};
+
+	typedef vector<Node> Node_List;
+
+	// left section in a capture
+	struct Event
+	{
+		const char *m_name;
+		// thread number
+		unsigned int m_thread;
+		// start and duration in microseconds
+		Uint64 m_start;
+		Uint64 m_duration;
+	};
+
+	typedef vector<Event> Event_List;
+
+	// counter value in a capture
+	struct Counter
+	{
+		const char *m_name;
+		Uint64 m_time;
+		double m_value;
+	};
+
+	typedef vector<Counter> Counter_List;
+
+	// call tree of a thread
+	struct Thread_Data
+	{
+		Thread_Data( void )
+		: m_current( 0 ), m_number( 0 ), m_main( 0 ), m_exited( 0 ) {}
+
+		// locked by the thread while changing the tree and by the main thread at the frame end
+		boost::mutex m_mutex;
+		// nodes with the root first
+		Node_List m_nodes;
+		// start time of each entered node
+		vector<Uint64> m_start_times;
+		// current node
+		int m_current;
+		// left sections if capturing
+		Event_List m_events;
+		// number in the capture
+		unsigned int m_number;
+		// if it is the main thread
+		bool m_main;
+		// if the thread has exited
+		bool m_exited;
+	};
+
+	typedef vector<Thread_Data *> Thread_Data_List;
+
+	// Returns the call tree of the calling thread
+	Thread_Data *Get_Thread_Data( void );
+	// Called when a thread with a call tree exits
+	static void Thread_Exit( Thread_Data *data );
+
+	/* Add the node times and its children to the section
+	 * and clear them for the next frame
+	*/
+	void Add_Node( Node_List &nodes, int node, int section );
+	/* Returns the child of the section with the name
+	 * the child is created if not found
+	*/
+	int Get_Section_Child( int section, const char *name );
+	// Add the frame times of the sections to their timers
+	void Finish_Sections( void );
+	// Write the captured events to the capture file and stop capturing
+	void Write_Capture( void );
+
+	// if measuring
+	bool m_enabled;
+
+	// frames left to capture
+	unsigned int m_capture_frames;
+	std::string m_capture_filename;
+	// start of the current frame
+	Uint64 m_capture_frame_start;
+	Event_List m_capture_events;
+	Counter_List m_capture_counters;
+	// if each captured thread number is the main thread
+	vector<bool> m_capture_threads;
+
+	Section_List m_sections;
+
+	// call trees of all threads
+	Thread_Data_List m_threads;
+	boost::mutex m_threads_mutex;
+	boost::thread_specific_ptr<Thread_Data> m_thread_data;
+	boost::thread::id m_main_thread_id;
+};
+
+// Frame profiler
+extern cProfiler *pProfiler;
+
+/* Measures a section until it is destroyed
+ * only checks if the profiler is enabled if not
+*/
+class cProfiler_Scope
+{
+public:
+	// name : must stay valid as it is not copied
+	explicit cProfiler_Scope( const char *name )
+	{
+		m_entered = pProfiler && pProfiler->Is_Enabled();
+
+		if( m_entered )
+		{
+			pProfiler->Enter( name );
+		}
+	}
+
+	~cProfiler_Scope( void )
+	{
+		if( m_entered && pProfiler )
+		{
+			pProfiler->Leave();
+		}
+	}
+
+private:
+	bool m_entered;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
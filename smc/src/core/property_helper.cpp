@@ -465,112 +465,86 @@ std::string Get_Direction_Name( const ObjectDirection dir )
 	return "";
 }
 
-ObjectDirection Get_Direction_Id( const std::string &str_direction )
+/* FNV-1a hash with the seed as offset basis
+ * the seeds and slot counts of the tables below were searched so every name has its own slot
+ * if a name is added a new seed must be searched
+*/
+static inline Uint32 Perfect_Hash( const char *str, size_t length, Uint32 seed )
 {
-	if( str_direction.compare( "undefined" ) == 0 )
-	{
-		return DIR_UNDEFINED;
-	}
-	else if( str_direction.compare( "left" ) == 0 )
-	{
-		return DIR_LEFT;
-	}
-	else if( str_direction.compare( "right" ) == 0 )
-	{
-		return DIR_RIGHT;
-	}
-	else if( str_direction.compare( "up" ) == 0 )
-	{
-		return DIR_UP;
-	}
-	else if( str_direction.compare( "down" ) == 0 )
-	{
-		return DIR_DOWN;
-	}
-	else if( str_direction.compare( "top_left" ) == 0 )
-	{
-		return DIR_TOP_LEFT;
-	}
-	else if( str_direction.compare( "top_right" ) == 0 )
-	{
-		return DIR_TOP_RIGHT;
-	}
-	else if( str_direction.compare( "bottom_left" ) == 0 )
-	{
-		return DIR_BOTTOM_LEFT;
-	}
-	else if( str_direction.compare( "bottom_right" ) == 0 )
-	{
-		return DIR_BOTTOM_RIGHT;
-	}
-	else if( str_direction.compare( "left_top" ) == 0 )
-	{
-		return DIR_LEFT_TOP;
-	}
-	else if( str_direction.compare( "left_bottom" ) == 0 )
-	{
-		return DIR_LEFT_BOTTOM;
-	}
-	else if( str_direction.compare( "right_top" ) == 0 )
-	{
-		return DIR_RIGHT_TOP;
-	}
-	else if( str_direction.compare( "right_bottom" ) == 0 )
-	{
-		return DIR_RIGHT_BOTTOM;
-	}
-	else if( str_direction.compare( "horizontal" ) == 0 )
-	{
-		return DIR_HORIZONTAL;
-	}
-	else if( str_direction.compare( "vertical" ) == 0 )
-	{
-		return DIR_VERTICAL;
-	}
-	else if( str_direction.compare( "all" ) == 0 )
-	{
-		return DIR_ALL;
-	}
-	else if( str_direction.compare( "first" ) == 0 )
-	{
-		return DIR_FIRST;
-	}
-	else if( str_direction.compare( "last" ) == 0 )
+	Uint32 hash = seed;
+
+	for( size_t i = 0; i < length; i++ )
 	{
-		return DIR_LAST;
+		hash = ( hash ^ static_cast<Uint8>(str[i]) ) * 16777619;
 	}
 
-	return DIR_UNDEFINED;
+	return hash;
 }
 
-SpriteType Get_Sprite_Type_Id( const std::string &str_type )
+int Perfect_Hash_Find( const Perfect_Hash_Slot *slots, unsigned int count, Uint32 seed, const char *str, size_t length, int default_value )
 {
-	if( str_type.compare( "massive" ) == 0 )
-	{
-		return TYPE_MASSIVE;
-	}
-	else if( str_type.compare( "passive" ) == 0 )
-	{
-		return TYPE_PASSIVE;
-	}
-	else if( str_type.compare( "front_passive" ) == 0 )
-	{
-		return TYPE_FRONT_PASSIVE;
-	}
-	else if( str_type.compare( "halfmassive" ) == 0 )
-	{
-		return TYPE_HALFMASSIVE;
-	}
-	else if( str_type.compare( "climbable" ) == 0 )
+	const Perfect_Hash_Slot &slot = slots[Perfect_Hash( str, length, seed ) % count];
+
+	// unused slot or another name
+	if( !slot.m_name || strncmp( slot.m_name, str, length ) != 0 || slot.m_name[length] != '\0' )
 	{
-		return TYPE_CLIMBABLE;
+		return default_value;
 	}
-	else
+
+	return slot.m_value;
+}
+
+static const unsigned int direction_seed = 93373;
+static const Perfect_Hash_Slot direction_slots[21] =
+{
+	{ "down", DIR_DOWN },
+	{ "left_top", DIR_LEFT_TOP },
+	{ "top_right", DIR_TOP_RIGHT },
+	{ "vertical", DIR_VERTICAL },
+	{ NULL, 0 },
+	{ "right_top", DIR_RIGHT_TOP },
+	{ "right_bottom", DIR_RIGHT_BOTTOM },
+	{ "left", DIR_LEFT },
+	{ "bottom_left", DIR_BOTTOM_LEFT },
+	{ "right", DIR_RIGHT },
+	{ NULL, 0 },
+	{ "undefined", DIR_UNDEFINED },
+	{ "all", DIR_ALL },
+	{ "left_bottom", DIR_LEFT_BOTTOM },
+	{ "top_left", DIR_TOP_LEFT },
+	{ "last", DIR_LAST },
+	{ NULL, 0 },
+	{ "horizontal", DIR_HORIZONTAL },
+	{ "first", DIR_FIRST },
+	{ "up", DIR_UP },
+	{ "bottom_right", DIR_BOTTOM_RIGHT }
+};
+
+ObjectDirection Get_Direction_Id( const char *str, size_t length )
+{
+	return static_cast<ObjectDirection>(Perfect_Hash_Find( direction_slots, sizeof( direction_slots ) / sizeof( direction_slots[0] ), direction_seed, str, length, DIR_UNDEFINED ));
+}
+
+static const unsigned int sprite_type_seed = 41;
+static const Perfect_Hash_Slot sprite_type_slots[5] =
+{
+	{ "climbable", TYPE_CLIMBABLE },
+	{ "passive", TYPE_PASSIVE },
+	{ "front_passive", TYPE_FRONT_PASSIVE },
+	{ "massive", TYPE_MASSIVE },
+	{ "halfmassive", TYPE_HALFMASSIVE }
+};
+
+SpriteType Get_Sprite_Type_Id( const char *str, size_t length )
+{
+	const SpriteType type = static_cast<SpriteType>(Perfect_Hash_Find( sprite_type_slots, sizeof( sprite_type_slots ) / sizeof( sprite_type_slots[0] ), sprite_type_seed, str, length, TYPE_UNDEFINED ));
+
+	if( type == TYPE_UNDEFINED )
 	{
-		printf( "Warning : Unknown Sprite Type String %s\n", str_type.c_str() );
+		printf( "Warning : Unknown Sprite Type String %.*s\n", static_cast<int>(length), str );
 	}
 	
-	return TYPE_UNDEFINED;
+	return type;
 }
 
 Color Get_Sprite_Color( const cSprite *sprite )
@@ -630,26 +604,19 @@ std::string Get_Massive_Type_Name( const MassiveType mtype )
 	return "";
 }
 
-MassiveType Get_Massive_Type_Id( const std::string &str_massivetype )
+static const unsigned int massive_type_seed = 2;
+static const Perfect_Hash_Slot massive_type_slots[5] =
 {
-	if( str_massivetype.compare( "passive" ) == 0 )
-	{
-		return MASS_PASSIVE;
-	}
-	else if( str_massivetype.compare( "massive" ) == 0 )
-	{
-		return MASS_MASSIVE;
-	}
-	else if( str_massivetype.compare( "halfmassive" ) == 0 )
-	{
-		return MASS_HALFMASSIVE;
-	}
-	else if( str_massivetype.compare( "climbable" ) == 0 )
-	{
-		return MASS_CLIMBABLE;
-	}
+	{ "climbable", MASS_CLIMBABLE },
+	{ "passive", MASS_PASSIVE },
+	{ NULL, 0 },
+	{ "halfmassive", MASS_HALFMASSIVE },
+	{ "massive", MASS_MASSIVE }
+};
 
-	return MASS_PASSIVE;
+MassiveType Get_Massive_Type_Id( const char *str, size_t length )
+{
+	return static_cast<MassiveType>(Perfect_Hash_Find( massive_type_slots, sizeof( massive_type_slots ) / sizeof( massive_type_slots[0] ), massive_type_seed, str, length, MASS_PASSIVE ));
 }
 
 Color Get_Massive_Type_Color( MassiveType mtype )
@@ -682,34 +649,20 @@ std::string Get_Ground_Type_Name( const GroundType gtype )
 	return "";
 }
 
-GroundType Get_Ground_Type_Id( const std::string &str_groundtype )
+static const unsigned int ground_type_seed = 10;
+static const Perfect_Hash_Slot ground_type_slots[6] =
 {
-	if( str_groundtype.compare( "normal" ) == 0 )
-	{
-		return GROUND_NORMAL;
-	}
-	else if( str_groundtype.compare( "earth" ) == 0 )
-	{
-		return GROUND_EARTH;
-	}
-	else if( str_groundtype.compare( "ice" ) == 0 )
-	{
-		return GROUND_ICE;
-	}
-	else if( str_groundtype.compare( "sand" ) == 0 )
-	{
-		return GROUND_SAND;
-	}
-	else if( str_groundtype.compare( "stone" ) == 0 )
-	{
-		return GROUND_STONE;
-	}
-	else if( str_groundtype.compare( "plastic" ) == 0 )
-	{
-		return GROUND_PLASTIC;
-	}
+	{ "plastic", GROUND_PLASTIC },
+	{ "ice", GROUND_ICE },
+	{ "earth", GROUND_EARTH },
+	{ "normal", GROUND_NORMAL },
+	{ "sand", GROUND_SAND },
+	{ "stone", GROUND_STONE }
+};
 
-	return GROUND_NORMAL;
+GroundType Get_Ground_Type_Id( const char *str, size_t length )
+{
+	return static_cast<GroundType>(Perfect_Hash_Find( ground_type_slots, sizeof( ground_type_slots ) / sizeof( ground_type_slots[0] ), ground_type_seed, str, length, GROUND_NORMAL ));
 }
 
 std::string Get_Level_Land_Type_Name( const LevelLandType land_type )
@@ -738,74 +691,31 @@ std::string Get_Level_Land_Type_Name( const LevelLandType land_type )
 	return "";
 }
 
-LevelLandType Get_Level_Land_Type_Id( const std::string &str_type )
+static const unsigned int land_type_seed = 220153;
+static const Perfect_Hash_Slot land_type_slots[17] =
 {
-	if( str_type.compare( "undefined" ) == 0 )
-	{
-		return LLT_UNDEFINED;
-	}
-	else if( str_type.compare( "green" ) == 0 )
-	{
-		return LLT_GREEN;
-	}
-	else if( str_type.compare( "jungle" ) == 0 )
-	{
-		return LLT_JUNGLE;
-	}
-	else if( str_type.compare( "ice" ) == 0 )
-	{
-		return LLT_ICE;
-	}
-	else if( str_type.compare( "snow" ) == 0 )
-	{
-		return LLT_SNOW;
-	}
-	else if( str_type.compare( "water" ) == 0 )
-	{
-		return LLT_WATER;
-	}
-	else if( str_type.compare( "candy" ) == 0 )
-	{
-		return LLT_CANDY;
-	}
-	else if( str_type.compare( "desert" ) == 0 )
-	{
-		return LLT_DESERT;
-	}
-	else if( str_type.compare( "sand" ) == 0 )
-	{
-		return LLT_SAND;
-	}
-	else if( str_type.compare( "castle" ) == 0 )
-	{
-		return LLT_CASTLE;
-	}
-	else if( str_type.compare( "underground" ) == 0 )
-	{
-		return LLT_UNDERGROUND;
-	}
-	else if( str_type.compare( "crystal" ) == 0 )
-	{
-		return LLT_CRYSTAL;
-	}
-	else if( str_type.compare( "ghost" ) == 0 )
-	{
-		return LLT_GHOST;
-	}
-	else if( str_type.compare( "mushroom" ) == 0 )
-	{
-		return LLT_MUSHROOM;
-	}
-	else if( str_type.compare( "sky" ) == 0 )
-	{
-		return LLT_SKY;
-	}
-	else if( str_type.compare( "plastic" ) == 0 )
-	{
-		return LLT_PLASTIC;
-	}
+	{ "water", LLT_WATER },
+	{ "green", LLT_GREEN },
+	{ "undefined", LLT_UNDEFINED },
+	{ "candy", LLT_CANDY },
+	{ "snow", LLT_SNOW },
+	{ "jungle", LLT_JUNGLE },
+	{ "sand", LLT_SAND },
+	{ "ghost", LLT_GHOST },
+	{ "crystal", LLT_CRYSTAL },
+	{ NULL, 0 },
+	{ "underground", LLT_UNDERGROUND },
+	{ "plastic", LLT_PLASTIC },
+	{ "desert", LLT_DESERT },
+	{ "ice", LLT_ICE },
+	{ "castle", LLT_CASTLE },
+	{ "sky", LLT_SKY },
+	{ "mushroom", LLT_MUSHROOM }
+};
 
-	return LLT_UNDEFINED;
+LevelLandType Get_Level_Land_Type_Id( const char *str, size_t length )
+{
+	return static_cast<LevelLandType>(Perfect_Hash_Find( land_type_slots, sizeof( land_type_slots ) / sizeof( land_type_slots[0] ), land_type_seed, str, length, LLT_UNDEFINED ));
 }
 
 std::string Get_Color_Name( const DefaultColor color )
@@ -828,46 +738,23 @@ std::string Get_Color_Name( const DefaultColor color )
 	return "";
 }
 
-DefaultColor Get_Color_Id( const std::string &str_color )
+static const unsigned int color_seed = 48;
+static const Perfect_Hash_Slot color_slots[9] =
 {
-	if( str_color.compare( "white" ) == 0 )
-	{
-		return COL_WHITE;
-	}
-	else if( str_color.compare( "black" ) == 0 )
-	{
-		return COL_BLACK;
-	}
-	else if( str_color.compare( "red" ) == 0 )
-	{
-		return COL_RED;
-	}
-	else if( str_color.compare( "orange" ) == 0 )
-	{
-		return COL_ORANGE;
-	}
-	else if( str_color.compare( "yellow" ) == 0 )
-	{
-		return COL_YELLOW;
-	}
-	else if( str_color.compare( "green" ) == 0 )
-	{
-		return COL_GREEN;
-	}
-	else if( str_color.compare( "blue" ) == 0 )
-	{
-		return COL_BLUE;
-	}
-	else if( str_color.compare( "brown" ) == 0 )
-	{
-		return COL_BROWN;
-	}
-	else if( str_color.compare( "grey" ) == 0 )
-	{
-		return COL_GREY;
-	}
+	{ "green", COL_GREEN },
+	{ "blue", COL_BLUE },
+	{ "grey", COL_GREY },
+	{ "white", COL_WHITE },
+	{ "brown", COL_BROWN },
+	{ "red", COL_RED },
+	{ "yellow", COL_YELLOW },
+	{ "black", COL_BLACK },
+	{ "orange", COL_ORANGE }
+};
 
-	return COL_DEFAULT;
+DefaultColor Get_Color_Id( const char *str, size_t length )
+{
+	return static_cast<DefaultColor>(Perfect_Hash_Find( color_slots, sizeof( color_slots ) / sizeof( color_slots[0] ), color_seed, str, length, COL_DEFAULT ));
 }
 
 std::string Get_Difficulty_Name( Uint8 difficulty )
@@ -20,6 +20,7 @@
 #include "../core/global_game.h"
 #include "SDL.h"
 #include <algorithm>
+#include <cstring>
 // CEGUI
 #include "CEGUIString.h"
 
@@ -91,15 +92,49 @@ std::wstring utf8_to_ucs2( const std::string &str );
 // Return the given time as string
 std::string Time_to_String( time_t t, const char *format );
 
+/* Slot of a perfect hash table from names to values
+ * every name is in the slot of its hash and unused slots have no name
+*/
+struct Perfect_Hash_Slot
+{
+	const char *m_name;
+	int m_value;
+};
+
+/* Return the value of the name in the perfect hash table or the default value if not found
+ * only one name is compared and the string does not need to be null-terminated
+*/
+int Perfect_Hash_Find( const Perfect_Hash_Slot *slots, unsigned int count, Uint32 seed, const char *str, size_t length, int default_value );
+
+/* The identifier functions below take the raw string with its length
+ * or a null-terminated string like the xml attribute buffer without creating a std::string
+*/
+
 // Return the opposite Direction
 ObjectDirection Get_Opposite_Direction( const ObjectDirection direction );
 // Return the Direction Name
 std::string Get_Direction_Name( const ObjectDirection dir );
 // Return the Direction identifier
-ObjectDirection Get_Direction_Id( const std::string &str_direction );
+ObjectDirection Get_Direction_Id( const char *str, size_t length );
+inline ObjectDirection Get_Direction_Id( const char *str )
+{
+	return Get_Direction_Id( str, strlen( str ) );
+}
+inline ObjectDirection Get_Direction_Id( const std::string &str )
+{
+	return Get_Direction_Id( str.data(), str.length() );
+}
 
 // Return the SpriteType identifier
-SpriteType Get_Sprite_Type_Id( const std::string &str_type );
+SpriteType Get_Sprite_Type_Id( const char *str, size_t length );
+inline SpriteType Get_Sprite_Type_Id( const char *str )
+{
+	return Get_Sprite_Type_Id( str, strlen( str ) );
+}
+inline SpriteType Get_Sprite_Type_Id( const std::string &str )
+{
+	return Get_Sprite_Type_Id( str.data(), str.length() );
+}
 /* Return the Color of the given Sprite
  * based mostly on sprite array
 */
@@ -108,24 +143,56 @@ Color Get_Sprite_Color( const cSprite *sprite );
 // Return the massive type Name
 std::string Get_Massive_Type_Name( const MassiveType mtype );
 // Return the massive type identifier
-MassiveType Get_Massive_Type_Id( const std::string &str_massivetype );
+MassiveType Get_Massive_Type_Id( const char *str, size_t length );
+inline MassiveType Get_Massive_Type_Id( const char *str )
+{
+	return Get_Massive_Type_Id( str, strlen( str ) );
+}
+inline MassiveType Get_Massive_Type_Id( const std::string &str )
+{
+	return Get_Massive_Type_Id( str.data(), str.length() );
+}
 // Return the Color of the given Massivetype
 Color Get_Massive_Type_Color( const MassiveType mtype );
 
 // Return the ground type name
 std::string Get_Ground_Type_Name( const GroundType gtype );
 // Return the ground type identifier
-GroundType Get_Ground_Type_Id( const std::string &str_groundtype );
+GroundType Get_Ground_Type_Id( const char *str, size_t length );
+inline GroundType Get_Ground_Type_Id( const char *str )
+{
+	return Get_Ground_Type_Id( str, strlen( str ) );
+}
+inline GroundType Get_Ground_Type_Id( const std::string &str )
+{
+	return Get_Ground_Type_Id( str.data(), str.length() );
+}
 
 // Return the level land type name
 std::string Get_Level_Land_Type_Name( const LevelLandType land_type );
 // Return the level land type identifier
-LevelLandType Get_Level_Land_Type_Id( const std::string &str_type );
+LevelLandType Get_Level_Land_Type_Id( const char *str, size_t length );
+inline LevelLandType Get_Level_Land_Type_Id( const char *str )
+{
+	return Get_Level_Land_Type_Id( str, strlen( str ) );
+}
+inline LevelLandType Get_Level_Land_Type_Id( const std::string &str )
+{
+	return Get_Level_Land_Type_Id( str.data(), str.length() );
+}
 
 // Return the Color Name
 std::string Get_Color_Name( const DefaultColor color );
 // Return the Color identifier
-DefaultColor Get_Color_Id( const std::string &str_color );
+DefaultColor Get_Color_Id( const char *str, size_t length );
+inline DefaultColor Get_Color_Id( const char *str )
+{
+	return Get_Color_Id( str, strlen( str ) );
+}
+inline DefaultColor Get_Color_Id( const std::string &str )
+{
+	return Get_Color_Id( str.data(), str.length() );
+}
 
 // Return the Difficulty name
 std::string Get_Difficulty_Name( Uint8 difficulty );
@@ -0,0 +1,581 @@
+/***************************************************************************
+ * sprite_grid.cpp  -  uniform grid over the sprite collision rects
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/sprite_grid.h"
+#include "../objects/sprite.h"
+#include "../core/math/utilities.h"
+#include <algorithm>
+#include <cmath>
+// SIMD
+#if defined(__SSE__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 1 )
+	#define SMC_SPRITE_GRID_SSE
+	#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+	#define SMC_SPRITE_GRID_NEON
+	#include <arm_neon.h>
+#endif
+
+namespace SMC
+{
+
+// cell size in world coordinates
+static const float sprite_grid_cell_size = 128.0f;
+// sprites touching more cells are kept in the large sprite list
+static const int sprite_grid_max_cells = 64;
+// cell positions are limited to this against invalid positions
+static const float sprite_grid_max_pos = 1000000.0f;
+// wider static sprites are not in the static sprites to keep the search range small
+static const float sprite_grid_max_static_w = 1024.0f;
+
+/* Returns a bit for each of the 4 packed rects touching the query rect
+ * uses the same inclusive sides as GL_rect::Intersects
+*/
+static inline unsigned int Sprite_Grid_Touch_Mask_4( const float *x1, const float *x2, const float *y1, const float *y2, const float qx1, const float qx2, const float qy1, const float qy2 )
+{
+#if defined(SMC_SPRITE_GRID_SSE)
+	__m128 outside = _mm_cmplt_ps( _mm_loadu_ps( x2 ), _mm_set1_ps( qx1 ) );
+	outside = _mm_or_ps( outside, _mm_cmpgt_ps( _mm_loadu_ps( x1 ), _mm_set1_ps( qx2 ) ) );
+	outside = _mm_or_ps( outside, _mm_cmplt_ps( _mm_loadu_ps( y2 ), _mm_set1_ps( qy1 ) ) );
+	outside = _mm_or_ps( outside, _mm_cmpgt_ps( _mm_loadu_ps( y1 ), _mm_set1_ps( qy2 ) ) );
+
+	return ~static_cast<unsigned int>(_mm_movemask_ps( outside )) & 0xF;
+#elif defined(SMC_SPRITE_GRID_NEON)
+	uint32x4_t outside = vcltq_f32( vld1q_f32( x2 ), vdupq_n_f32( qx1 ) );
+	outside = vorrq_u32( outside, vcgtq_f32( vld1q_f32( x1 ), vdupq_n_f32( qx2 ) ) );
+	outside = vorrq_u32( outside, vcltq_f32( vld1q_f32( y2 ), vdupq_n_f32( qy1 ) ) );
+	outside = vorrq_u32( outside, vcgtq_f32( vld1q_f32( y1 ), vdupq_n_f32( qy2 ) ) );
+
+	unsigned int mask = 0;
+
+	if( !vgetq_lane_u32( outside, 0 ) )
+	{
+		mask |= 1;
+	}
+	if( !vgetq_lane_u32( outside, 1 ) )
+	{
+		mask |= 2;
+	}
+	if( !vgetq_lane_u32( outside, 2 ) )
+	{
+		mask |= 4;
+	}
+	if( !vgetq_lane_u32( outside, 3 ) )
+	{
+		mask |= 8;
+	}
+
+	return mask;
+#else
+	unsigned int mask = 0;
+
+	for( unsigned int i = 0; i < 4; i++ )
+	{
+		if( x2[i] < qx1 || x1[i] > qx2 || y2[i] < qy1 || y1[i] > qy2 )
+		{
+			continue;
+		}
+
+		mask |= 1 << i;
+	}
+
+	return mask;
+#endif
+}
+
+/* *** *** *** *** *** *** cSprite_Grid *** *** *** *** *** *** *** *** *** *** *** */
+
+cSprite_Grid :: cSprite_Grid( void )
+{
+	m_query = 0;
+	m_static_max_w = 0.0f;
+	m_static_changed = 0;
+	m_static_version = 0;
+	m_sprites_version = 0;
+}
+
+cSprite_Grid :: ~cSprite_Grid( void )
+{
+	Clear();
+}
+
+void cSprite_Grid :: Add( cSprite *sprite )
+{
+	// already added
+	if( sprite->m_grid )
+	{
+		sprite->m_grid->Remove( sprite );
+	}
+
+	sprite->m_grid = this;
+	sprite->m_grid_layer = sprite->Get_Col_Layer();
+	m_sprites_version++;
+
+	// static
+	if( Is_Static_Sprite( sprite ) )
+	{
+		sprite->m_grid_static = 1;
+		sprite->m_grid_large = 0;
+
+		Static_Sprite static_sprite;
+		static_sprite.m_x1 = 0.0f;
+		static_sprite.m_x2 = 0.0f;
+		static_sprite.m_sprite = sprite;
+		m_static_sprites.push_back( static_sprite );
+		m_static_changed = 1;
+		m_static_version++;
+		return;
+	}
+
+	sprite->m_grid_static = 0;
+
+	const Cell_Range range = Get_Range( sprite->m_col_rect );
+	sprite->m_grid_x1 = range.m_x1;
+	sprite->m_grid_y1 = range.m_y1;
+	sprite->m_grid_x2 = range.m_x2;
+	sprite->m_grid_y2 = range.m_y2;
+
+	// too big
+	if( ( range.m_x2 - range.m_x1 + 1 ) * ( range.m_y2 - range.m_y1 + 1 ) > sprite_grid_max_cells )
+	{
+		sprite->m_grid_large = 1;
+		m_large_sprites.push_back( sprite );
+		return;
+	}
+
+	sprite->m_grid_large = 0;
+
+	for( int y = range.m_y1; y <= range.m_y2; y++ )
+	{
+		for( int x = range.m_x1; x <= range.m_x2; x++ )
+		{
+			Cell &cell = m_cells[Get_Key( x, y )];
+			cell.m_x = x;
+			cell.m_y = y;
+			cell.m_sprites.push_back( sprite );
+			cell.m_layers.push_back( sprite->m_grid_layer );
+		}
+	}
+}
+
+void cSprite_Grid :: Remove( cSprite *sprite )
+{
+	if( sprite->m_grid != this )
+	{
+		return;
+	}
+
+	sprite->m_grid = NULL;
+	m_sprites_version++;
+
+	if( sprite->m_grid_static )
+	{
+		for( Static_Sprite_List::iterator itr = m_static_sprites.begin(); itr != m_static_sprites.end(); ++itr )
+		{
+			if( (*itr).m_sprite == sprite )
+			{
+				// the packed rects are in the same order if not changed
+				if( !m_static_changed )
+				{
+					const unsigned int num = itr - m_static_sprites.begin();
+
+					m_static_x1.erase( m_static_x1.begin() + num );
+					m_static_x2.erase( m_static_x2.begin() + num );
+					m_static_y1.erase( m_static_y1.begin() + num );
+					m_static_y2.erase( m_static_y2.begin() + num );
+					m_static_layers.erase( m_static_layers.begin() + num );
+				}
+
+				// keeps the order
+				m_static_sprites.erase( itr );
+				m_static_version++;
+				break;
+			}
+		}
+
+		return;
+	}
+
+	if( sprite->m_grid_large )
+	{
+		Sprite_List::iterator itr = std::find( m_large_sprites.begin(), m_large_sprites.end(), sprite );
+
+		if( itr != m_large_sprites.end() )
+		{
+			m_large_sprites.erase( itr );
+		}
+
+		return;
+	}
+
+	for( int y = sprite->m_grid_y1; y <= sprite->m_grid_y2; y++ )
+	{
+		for( int x = sprite->m_grid_x1; x <= sprite->m_grid_x2; x++ )
+		{
+			Cell_Map::iterator cell_itr = m_cells.find( Get_Key( x, y ) );
+
+			if( cell_itr == m_cells.end() )
+			{
+				continue;
+			}
+
+			Sprite_List &sprites = cell_itr->second.m_sprites;
+			vector<Uint32> &layers = cell_itr->second.m_layers;
+			Sprite_List::iterator itr = std::find( sprites.begin(), sprites.end(), sprite );
+
+			if( itr != sprites.end() )
+			{
+				// order in a cell is not needed
+				const unsigned int num = itr - sprites.begin();
+
+				*itr = sprites.back();
+				sprites.pop_back();
+				layers[num] = layers.back();
+				layers.pop_back();
+			}
+
+			if( sprites.empty() )
+			{
+				m_cells.erase( cell_itr );
+			}
+		}
+	}
+}
+
+void cSprite_Grid :: Update( cSprite *sprite )
+{
+	// sorted again with the next query
+	const bool layer_changed = sprite->Get_Col_Layer() != sprite->m_grid_layer;
+
+	if( sprite->m_grid_static )
+	{
+		m_static_changed = 1;
+		m_static_version++;
+
+		// the layer is set again with the sorting
+		if( layer_changed )
+		{
+			m_sprites_version++;
+		}
+		return;
+	}
+
+	const Cell_Range range = Get_Range( sprite->m_col_rect );
+
+	// still in the same cells and layer
+	if( range.m_x1 == sprite->m_grid_x1 && range.m_y1 == sprite->m_grid_y1 && range.m_x2 == sprite->m_grid_x2 && range.m_y2 == sprite->m_grid_y2 && !layer_changed )
+	{
+		return;
+	}
+
+	const unsigned int sprites_version = m_sprites_version;
+
+	Remove( sprite );
+	Add( sprite );
+
+	// only moved to other cells
+	if( !layer_changed )
+	{
+		m_sprites_version = sprites_version;
+	}
+}
+
+void cSprite_Grid :: Clear( void )
+{
+	for( Cell_Map::iterator itr = m_cells.begin(); itr != m_cells.end(); ++itr )
+	{
+		Sprite_List &sprites = itr->second.m_sprites;
+
+		for( Sprite_List::iterator sprite_itr = sprites.begin(); sprite_itr != sprites.end(); ++sprite_itr )
+		{
+			(*sprite_itr)->m_grid = NULL;
+		}
+	}
+
+	for( Sprite_List::iterator itr = m_large_sprites.begin(); itr != m_large_sprites.end(); ++itr )
+	{
+		(*itr)->m_grid = NULL;
+	}
+
+	for( Static_Sprite_List::iterator itr = m_static_sprites.begin(); itr != m_static_sprites.end(); ++itr )
+	{
+		(*itr).m_sprite->m_grid = NULL;
+	}
+
+	m_cells.clear();
+	m_large_sprites.clear();
+	m_static_sprites.clear();
+	m_static_x1.clear();
+	m_static_x2.clear();
+	m_static_y1.clear();
+	m_static_y2.clear();
+	m_static_layers.clear();
+	m_static_max_w = 0.0f;
+	m_static_changed = 0;
+	m_static_version++;
+	m_sprites_version++;
+}
+
+void cSprite_Grid :: Get_Objects( Sprite_List &objects, const GL_rect &rect, Uint32 layer_mask /* = COL_LAYER_ALL */ )
+{
+	Update_Static_Sprites();
+	Get_Static_Objects( objects, rect, layer_mask );
+	Get_Dynamic_Objects( objects, rect, layer_mask );
+}
+
+void cSprite_Grid :: Get_Dynamic_Objects( Sprite_List &objects, const GL_rect &rect, Uint32 layer_mask /* = COL_LAYER_ALL */ )
+{
+	m_query++;
+
+	Add_Large_Objects( objects, layer_mask );
+
+	const Cell_Range range = Get_Range( rect );
+	const Uint64 cell_count = static_cast<Uint64>( range.m_x2 - range.m_x1 + 1 ) * static_cast<Uint64>( range.m_y2 - range.m_y1 + 1 );
+
+	// check the used cells if the rect is bigger
+	if( cell_count > m_cells.size() )
+	{
+		for( Cell_Map::const_iterator itr = m_cells.begin(); itr != m_cells.end(); ++itr )
+		{
+			const Cell &cell = itr->second;
+
+			if( cell.m_x < range.m_x1 || cell.m_x > range.m_x2 || cell.m_y < range.m_y1 || cell.m_y > range.m_y2 )
+			{
+				continue;
+			}
+
+			Add_Cell_Objects( objects, cell, layer_mask );
+		}
+
+		return;
+	}
+
+	for( int y = range.m_y1; y <= range.m_y2; y++ )
+	{
+		for( int x = range.m_x1; x <= range.m_x2; x++ )
+		{
+			Cell_Map::const_iterator itr = m_cells.find( Get_Key( x, y ) );
+
+			if( itr == m_cells.end() )
+			{
+				continue;
+			}
+
+			Add_Cell_Objects( objects, itr->second, layer_mask );
+		}
+	}
+}
+
+bool cSprite_Grid :: Is_Static_Sprite( const cSprite *sprite )
+{
+	// only basic sprites are never moved by the game
+	if( !sprite->Is_Basic_Sprite() || sprite->m_spawned )
+	{
+		return 0;
+	}
+
+	// too wide
+	if( sprite->m_col_rect.m_w > sprite_grid_max_static_w || sprite->m_col_rect.m_w < -sprite_grid_max_static_w )
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+void cSprite_Grid :: Update_Static_Sprites( void )
+{
+	if( !m_static_changed )
+	{
+		return;
+	}
+
+	m_static_changed = 0;
+	m_static_max_w = 0.0f;
+
+	for( Static_Sprite_List::iterator itr = m_static_sprites.begin(); itr != m_static_sprites.end(); ++itr )
+	{
+		Static_Sprite &static_sprite = (*itr);
+		const GL_rect &col_rect = static_sprite.m_sprite->m_col_rect;
+
+		// the rect size could be negative
+		static_sprite.m_x1 = col_rect.m_w < 0.0f ? col_rect.m_x + col_rect.m_w : col_rect.m_x;
+		static_sprite.m_x2 = col_rect.m_w < 0.0f ? col_rect.m_x : col_rect.m_x + col_rect.m_w;
+
+		if( static_sprite.m_x2 - static_sprite.m_x1 > m_static_max_w )
+		{
+			m_static_max_w = static_sprite.m_x2 - static_sprite.m_x1;
+		}
+	}
+
+	// mostly still sorted after an editor change
+	std::stable_sort( m_static_sprites.begin(), m_static_sprites.end(), static_x_sort() );
+
+	// pack the rects in the sorted order
+	const unsigned int count = m_static_sprites.size();
+	m_static_x1.resize( count );
+	m_static_x2.resize( count );
+	m_static_y1.resize( count );
+	m_static_y2.resize( count );
+	m_static_layers.resize( count );
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		const Static_Sprite &static_sprite = m_static_sprites[i];
+		const GL_rect &col_rect = static_sprite.m_sprite->m_col_rect;
+
+		// the massive type could have changed
+		static_sprite.m_sprite->m_grid_layer = static_sprite.m_sprite->Get_Col_Layer();
+		m_static_layers[i] = static_sprite.m_sprite->m_grid_layer;
+
+		m_static_x1[i] = static_sprite.m_x1;
+		m_static_x2[i] = static_sprite.m_x2;
+		m_static_y1[i] = col_rect.m_h < 0.0f ? col_rect.m_y + col_rect.m_h : col_rect.m_y;
+		m_static_y2[i] = col_rect.m_h < 0.0f ? col_rect.m_y : col_rect.m_y + col_rect.m_h;
+	}
+}
+
+void cSprite_Grid :: Get_Static_Objects( Sprite_List &objects, const GL_rect &rect, Uint32 layer_mask /* = COL_LAYER_ALL */ ) const
+{
+	if( m_static_x1.empty() || !layer_mask )
+	{
+		return;
+	}
+
+	const float x1 = rect.m_w < 0.0f ? rect.m_x + rect.m_w : rect.m_x;
+	const float x2 = rect.m_w < 0.0f ? rect.m_x : rect.m_x + rect.m_w;
+	const float y1 = rect.m_h < 0.0f ? rect.m_y + rect.m_h : rect.m_y;
+	const float y2 = rect.m_h < 0.0f ? rect.m_y : rect.m_y + rect.m_h;
+
+	// sprites starting left of this can not reach the rect
+	const unsigned int start = std::lower_bound( m_static_x1.begin(), m_static_x1.end(), x1 - m_static_max_w ) - m_static_x1.begin();
+	// first sprite starting right of the rect
+	const unsigned int end = std::upper_bound( m_static_x1.begin() + start, m_static_x1.end(), x2 ) - m_static_x1.begin();
+
+	unsigned int i = start;
+
+	// test 4 rects at once
+	for( ; i + 4 <= end; i += 4 )
+	{
+		// none of them in the layers
+		if( !( ( m_static_layers[i] | m_static_layers[i + 1] | m_static_layers[i + 2] | m_static_layers[i + 3] ) & layer_mask ) )
+		{
+			continue;
+		}
+
+		const unsigned int mask = Sprite_Grid_Touch_Mask_4( &m_static_x1[i], &m_static_x2[i], &m_static_y1[i], &m_static_y2[i], x1, x2, y1, y2 );
+
+		if( !mask )
+		{
+			continue;
+		}
+
+		for( unsigned int j = 0; j < 4; j++ )
+		{
+			// only in the static sprites and not checked for duplicates
+			if( ( mask & ( 1 << j ) ) && ( m_static_layers[i + j] & layer_mask ) )
+			{
+				objects.push_back( m_static_sprites[i + j].m_sprite );
+			}
+		}
+	}
+
+	// remaining rects
+	for( ; i < end; i++ )
+	{
+		if( !( m_static_layers[i] & layer_mask ) || m_static_x2[i] < x1 || m_static_y2[i] < y1 || m_static_y1[i] > y2 )
+		{
+			continue;
+		}
+
+		objects.push_back( m_static_sprites[i].m_sprite );
+	}
+}
+
+cSprite_Grid::Cell_Range cSprite_Grid :: Get_Range( const GL_rect &rect )
+{
+	// the rect size could be negative
+	float x1 = rect.m_x;
+	float x2 = rect.m_x + rect.m_w;
+	float y1 = rect.m_y;
+	float y2 = rect.m_y + rect.m_h;
+
+	if( x2 < x1 )
+	{
+		std::swap( x1, x2 );
+	}
+	if( y2 < y1 )
+	{
+		std::swap( y1, y2 );
+	}
+
+	Cell_Range range;
+	range.m_x1 = static_cast<int>(std::floor( Clamp( x1, -sprite_grid_max_pos, sprite_grid_max_pos ) / sprite_grid_cell_size ));
+	range.m_y1 = static_cast<int>(std::floor( Clamp( y1, -sprite_grid_max_pos, sprite_grid_max_pos ) / sprite_grid_cell_size ));
+	range.m_x2 = static_cast<int>(std::floor( Clamp( x2, -sprite_grid_max_pos, sprite_grid_max_pos ) / sprite_grid_cell_size ));
+	range.m_y2 = static_cast<int>(std::floor( Clamp( y2, -sprite_grid_max_pos, sprite_grid_max_pos ) / sprite_grid_cell_size ));
+
+	return range;
+}
+
+Uint64 cSprite_Grid :: Get_Key( int x, int y )
+{
+	return ( static_cast<Uint64>(static_cast<Uint32>(x)) << 32 ) | static_cast<Uint32>(y);
+}
+
+void cSprite_Grid :: Add_Cell_Objects( Sprite_List &objects, const Cell &cell, Uint32 layer_mask )
+{
+	const unsigned int count = cell.m_sprites.size();
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		// not in the layers
+		if( !( cell.m_layers[i] & layer_mask ) )
+		{
+			continue;
+		}
+
+		cSprite *obj = cell.m_sprites[i];
+
+		// already added from another cell
+		if( obj->m_grid_query == m_query )
+		{
+			continue;
+		}
+
+		obj->m_grid_query = m_query;
+		objects.push_back( obj );
+	}
+}
+
+void cSprite_Grid :: Add_Large_Objects( Sprite_List &objects, Uint32 layer_mask )
+{
+	for( Sprite_List::const_iterator itr = m_large_sprites.begin(); itr != m_large_sprites.end(); ++itr )
+	{
+		cSprite *obj = (*itr);
+
+		// not in the layers
+		if( !( obj->m_grid_layer & layer_mask ) )
+		{
+			continue;
+		}
+
+		obj->m_grid_query = m_query;
+		objects.push_back( obj );
+	}
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
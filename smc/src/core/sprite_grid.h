@@ -0,0 +1,190 @@
+/***************************************************************************
+ * sprite_grid.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_SPRITE_GRID_H
+#define SMC_SPRITE_GRID_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../core/math/rect.h"
+// SDL
+#include "SDL.h"
+// boost
+#include <boost/unordered_map.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** cSprite_Grid *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Uniform grid over the collision rects of sprites
+ * returns the sprites near a rect without checking every sprite
+ * a sprite is in every cell its collision rect touches
+ * and must be updated with Update if its collision rect changed
+ * sprites touching too many cells are kept in a separate list
+ * basic sprites which are never moved by the game are not in the cells
+ * but in a list sorted by their left collision rect side
+ * which is sorted again after the editor changed one of them
+ * their collision rects are also packed in separate arrays
+ * to test several of them at once without reading the sprites
+ * the collision layer of every sprite is stored next to it
+ * and the queries skip the sprites of layers not in the given layer mask
+*/
+class cSprite_Grid
+{
+public:
+	cSprite_Grid( void );
+	~cSprite_Grid( void );
+
+	// same as cSprite_List
+	typedef vector<cSprite *> Sprite_List;
+
+	// static sprites gathered for a rect
+	struct Static_Gather
+	{
+		// sprite the rect is gathered for
+		cSprite *m_sprite;
+		GL_rect m_rect;
+		// collision layers the sprite queries
+		Uint32 m_layer_mask;
+		// static sprites touching the rect
+		Sprite_List m_objects;
+	};
+
+	// Add the sprite
+	void Add( cSprite *sprite );
+	// Remove the sprite
+	void Remove( cSprite *sprite );
+	// Move the sprite to the cells of its current collision rect
+	void Update( cSprite *sprite );
+	// Remove all sprites
+	void Clear( void );
+
+	/* Add the sprites in the cells touched by the rect to the list
+	 * every sprite is only added once
+	 * the collision rects are not checked and the order is undefined
+	 * layer_mask : only sprites in these collision layers are added
+	*/
+	void Get_Objects( Sprite_List &objects, const GL_rect &rect, Uint32 layer_mask = COL_LAYER_ALL );
+	/* Add the sprites of Get_Objects without the static sprites to the list
+	 * used together with Get_Static_Objects
+	*/
+	void Get_Dynamic_Objects( Sprite_List &objects, const GL_rect &rect, Uint32 layer_mask = COL_LAYER_ALL );
+
+	// Sort the static sprites if changed
+	void Update_Static_Sprites( void );
+	/* Add the static sprites touching the rect to the list
+	 * Update_Static_Sprites must be called after static sprite changes
+	 * does not change anything and can be used from several threads
+	*/
+	void Get_Static_Objects( Sprite_List &objects, const GL_rect &rect, Uint32 layer_mask = COL_LAYER_ALL ) const;
+	// Returns the static sprites version which changes with every static sprite change
+	inline unsigned int Get_Static_Version( void ) const
+	{
+		return m_static_version;
+	}
+	/* Returns the sprites version which changes if a sprite is added or removed or changes its collision layer
+	 * but not if a sprite only moves
+	*/
+	inline unsigned int Get_Sprites_Version( void ) const
+	{
+		return m_sprites_version;
+	}
+
+private:
+	// a cell position range
+	struct Cell_Range
+	{
+		int m_x1;
+		int m_y1;
+		int m_x2;
+		int m_y2;
+	};
+
+	// Returns true if the sprite is added to the static sprites
+	static bool Is_Static_Sprite( const cSprite *sprite );
+
+	// Returns the cells touched by the rect
+	static Cell_Range Get_Range( const GL_rect &rect );
+	// Returns the cell key
+	static Uint64 Get_Key( int x, int y );
+	// sprites in a cell
+	struct Cell
+	{
+		int m_x;
+		int m_y;
+		Sprite_List m_sprites;
+		// collision layer of the sprite at the same position
+		vector<Uint32> m_layers;
+	};
+
+	// Add the sprites of the cell in the layers to the list
+	void Add_Cell_Objects( Sprite_List &objects, const Cell &cell, Uint32 layer_mask );
+	// Add the large sprites in the layers to the list
+	void Add_Large_Objects( Sprite_List &objects, Uint32 layer_mask );
+
+	typedef boost::unordered_map<Uint64, Cell> Cell_Map;
+	// cells with sprites
+	Cell_Map m_cells;
+	// sprites touching too many cells
+	Sprite_List m_large_sprites;
+
+	// a static sprite with its horizontal collision rect range
+	struct Static_Sprite
+	{
+		float m_x1;
+		float m_x2;
+		cSprite *m_sprite;
+	};
+
+	// sorts static sprites by the left side
+	struct static_x_sort
+	{
+		bool operator()( const Static_Sprite &a, const Static_Sprite &b ) const
+		{
+			return a.m_x1 < b.m_x1;
+		}
+	};
+
+	typedef vector<Static_Sprite> Static_Sprite_List;
+	// static sprites sorted by the left side
+	Static_Sprite_List m_static_sprites;
+	/* collision rect sides of the static sprites in the same order
+	 * the rect size could be negative and is already turned around
+	*/
+	typedef vector<float> Float_List;
+	Float_List m_static_x1;
+	Float_List m_static_x2;
+	Float_List m_static_y1;
+	Float_List m_static_y2;
+	// collision layers of the static sprites in the same order
+	vector<Uint32> m_static_layers;
+	// widest static sprite collision rect
+	float m_static_max_w;
+	// if set a static sprite changed and the list needs to be sorted again
+	bool m_static_changed;
+	// increased with every static sprite change
+	unsigned int m_static_version;
+	// increased with every added or removed sprite and collision layer change
+	unsigned int m_sprites_version;
+	// counter to add every sprite only once to a query result
+	unsigned int m_query;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -15,28 +15,194 @@
 
 #include "../core/sprite_manager.h"
 #include "../core/game_core.h"
+#include "../core/framerate.h"
 #include "../level/level_player.h"
 #include "../input/mouse.h"
 #include "../overworld/world_player.h"
+#include "../core/collision_workers.h"
+#include "../core/update_workers.h"
+#include "../objects/movingsprite.h"
+#include "../objects/path.h"
+#include "../enemies/enemy.h"
+#include "../core/camera.h"
+#include "../core/engine_context.h"
+#include "../core/string_table.h"
+#include "../core/task_pool.h"
+#include "../video/renderer.h"
 #include <algorithm>
+// boost
+#include <boost/bind.hpp>
 
 namespace SMC
 {
 
+// initial capacity of the spawn and destroy queues
+static const unsigned int spawn_queue_reserve = 256;
+
+// minimum number of following objects drawn with the task pool
+static const unsigned int draw_parallel_min = 64;
+
+// Draw the sprites with their requests kept by the capture
+static void Draw_Sprites( cRender_Capture *capture, cRenderQueue *renderer, cSprite **sprites, unsigned int count )
+{
+	capture->Begin( renderer );
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		sprites[i]->Draw();
+	}
+
+	capture->End();
+}
+
+// Add the sprite to the list of the key and set its position in it
+static void Sprite_Index_Add( vector<cSprite_List> &lists, unsigned int key, cSprite *sprite, int &num )
+{
+	if( key >= lists.size() )
+	{
+		lists.resize( key + 1 );
+	}
+
+	num = lists[key].size();
+	lists[key].push_back( sprite );
+}
+
+// Remove the sprite from the list of the key by moving the last one to its position
+static void Sprite_Index_Remove( vector<cSprite_List> &lists, unsigned int key, int &num, int cSprite::*list_num )
+{
+	cSprite_List &list = lists[key];
+
+	cSprite *last = list.back();
+	list[num] = last;
+	last->*list_num = num;
+	list.pop_back();
+
+	num = -1;
+}
+
+// Returns true if the sprite is at the position it has stored for the list
+static inline bool Sprite_List_Is_At( const cSprite_List &list, const cSprite *sprite, int cSprite::*list_num )
+{
+	const int num = sprite->*list_num;
+
+	return num >= 0 && static_cast<size_t>(num) < list.size() && list[num] == sprite;
+}
+
+// Add the sprite at the end of the list and store its position
+static inline void Sprite_List_Push( cSprite_List &list, cSprite *sprite, int cSprite::*list_num )
+{
+	sprite->*list_num = list.size();
+	list.push_back( sprite );
+}
+
+// Store the positions of the sprites in the list from the given position
+static void Sprite_List_Set_Nums( cSprite_List &list, int cSprite::*list_num, size_t start = 0 )
+{
+	for( size_t i = start; i < list.size(); i++ )
+	{
+		if( list[i] )
+		{
+			list[i]->*list_num = i;
+		}
+	}
+}
+
+// Insert the sprite behind the sprites sorted in front of or equal to it
+template<class T> static void Sprite_Sorted_Insert( cSprite_List &list, cSprite *sprite, const T &comp )
+{
+	list.insert( std::upper_bound( list.begin(), list.end(), sprite, comp ), sprite );
+}
+
+/* Sort the list again after z positions were changed directly
+ * only moves the changed sprites and does nothing if still sorted
+*/
+template<class T> static void Sprite_Sorted_Repair( cSprite_List &list, const T &comp )
+{
+	unsigned int unsorted = 0;
+
+	for( size_t i = 1; i < list.size(); i++ )
+	{
+		if( comp( list[i], list[i - 1] ) )
+		{
+			unsorted++;
+		}
+	}
+
+	if( !unsorted )
+	{
+		return;
+	}
+
+	// many changes
+	if( unsorted > 32 )
+	{
+		std::sort( list.begin(), list.end(), comp );
+		return;
+	}
+
+	// the sprites in front are already sorted
+	for( size_t i = 1; i < list.size(); i++ )
+	{
+		cSprite *sprite = list[i];
+
+		if( !comp( sprite, list[i - 1] ) )
+		{
+			continue;
+		}
+
+		cSprite_List::iterator itr = std::upper_bound( list.begin(), list.begin() + i, sprite, comp );
+		std::copy_backward( itr, list.begin() + i, list.begin() + i + 1 );
+		*itr = sprite;
+	}
+}
+
 /* *** *** *** *** *** *** cSprite_Manager *** *** *** *** *** *** *** *** *** *** *** */
 
 cSprite_Manager :: cSprite_Manager( unsigned int reserve_items /* = 2000 */, unsigned int zpos_items /* = 100 */ )
 : cObject_Manager<cSprite>()
 {
 	objects.reserve( reserve_items );
+	m_destroyed_objects.reserve( spawn_queue_reserve );
+	m_spawn_queue.reserve( spawn_queue_reserve );
 
 	m_z_pos_data.assign( zpos_items, 0.0f );
 	m_z_pos_data_editor.assign( zpos_items,0.0f );
+
+	m_static_chunks = NULL;
+	m_awake_changed = 0;
+	m_has_destroyed = 0;
+	m_zpos_used = 0;
+	m_editor_zpos_used = 0;
+	m_draw_state_valid = 0;
+	m_draw_margin = 0.0f;
+	m_visible_changed = 0;
+	m_batch_depth = 0;
+	m_animation_time = 0;
+	m_update_count = 0;
+	m_static_gather_count = 0;
+	m_static_gather_version = 0;
+	m_static_gather_valid = 0;
+	m_context = pDefault_Engine_Context;
+	m_draw_task_group = 0;
+	m_defer_spawns = 0;
 }
 
 cSprite_Manager :: ~cSprite_Manager( void )
 {
 	Delete_All();
+
+	if( m_static_chunks )
+	{
+		delete m_static_chunks;
+		m_static_chunks = NULL;
+	}
+
+	for( vector<cRender_Capture *>::iterator itr = m_draw_captures.begin(); itr != m_draw_captures.end(); ++itr )
+	{
+		delete *itr;
+	}
+
+	m_draw_captures.clear();
 }
 
 void cSprite_Manager :: Add( cSprite *sprite )
@@ -47,27 +213,287 @@ void cSprite_Manager :: Add( cSprite *sprite )
 		return;
 	}
 
+	// added after the parallel update
+	if( pUpdate_Workers && pUpdate_Workers->Defer( boost::bind( &cSprite_Manager::Add, this, sprite ) ) )
+	{
+		return;
+	}
+
+	// added after the pass
+	if( m_defer_spawns )
+	{
+		m_spawn_queue.push_back( sprite );
+		return;
+	}
+
 	Set_Pos_Z( sprite );
 
 	// Check if an destroyed object can be replaced
-	for( cSprite_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	while( !m_destroyed_objects.empty() )
+	{
+		cSprite *obj = m_destroyed_objects.back();
+		m_destroyed_objects.pop_back();
+
+		// already replaced or removed
+		if( !obj->m_auto_destroy || obj->m_array_num < 0 || static_cast<size_t>(obj->m_array_num) >= objects.size() || objects[obj->m_array_num] != obj )
+		{
+			continue;
+		}
+
+		// set new object
+		objects[obj->m_array_num] = sprite;
+		sprite->m_array_num = obj->m_array_num;
+		obj->m_array_num = -1;
+		m_grid.Remove( obj );
+		m_grid.Add( sprite );
+		m_editor_grid.Remove( obj );
+		m_editor_grid.Add( sprite );
+		// the lists are changed at the stored positions
+		Remove_Awake( obj );
+		Remove_Type( obj );
+		Add_Type( sprite );
+		Replace_Zpos( obj, sprite );
+		Remove_Draw_Dirty( obj );
+		Remove_Visible( obj );
+		Set_Draw_Dirty( sprite );
+		// keep the array order with the list update
+		sprite->m_sleeping = 0;
+		Sprite_List_Push( m_awake_objects, sprite, &cSprite::m_awake_num );
+		m_awake_changed = 1;
+		// delete old
+		delete obj;
+
+		return;
+	}
+
+	cObject_Manager<cSprite>::Add( sprite );
+	sprite->m_array_num = objects.size() - 1;
+	m_grid.Add( sprite );
+	m_editor_grid.Add( sprite );
+	Add_Type( sprite );
+	Add_Zpos( sprite );
+	Set_Draw_Dirty( sprite );
+	// at the end of the array
+	sprite->m_sleeping = 0;
+	Sprite_List_Push( m_awake_objects, sprite, &cSprite::m_awake_num );
+}
+
+bool cSprite_Manager :: Delete( size_t array_num, bool delete_data /* = 1 */ )
+{
+	if( array_num >= objects.size() )
+	{
+		return 0;
+	}
+
+	return Delete( objects[array_num], delete_data );
+}
+
+bool cSprite_Manager :: Delete( cSprite *obj, bool delete_data /* = 1 */ )
+{
+	// empty object
+	if( !obj )
+	{
+		return 0;
+	}
+
+	// not added yet
+	if( obj->m_array_num < 0 && !m_spawn_queue.empty() )
+	{
+		cSprite_List::iterator itr = std::find( m_spawn_queue.begin(), m_spawn_queue.end(), obj );
+
+		if( itr != m_spawn_queue.end() )
+		{
+			m_spawn_queue.erase( itr );
+
+			if( delete_data )
+			{
+				delete obj;
+			}
+
+			return 1;
+		}
+	}
+
+	// available in vector
+	if( obj->m_array_num >= 0 && static_cast<size_t>(obj->m_array_num) < objects.size() && objects[obj->m_array_num] == obj )
+	{
+		const unsigned int array_num = obj->m_array_num;
+		objects.erase( objects.begin() + array_num );
+		Update_Array_Nums( array_num );
+	}
+
+	obj->m_array_num = -1;
+	m_grid.Remove( obj );
+	m_editor_grid.Remove( obj );
+	Remove_Awake( obj );
+	Remove_Type( obj );
+	Remove_Zpos( obj );
+	Remove_Draw_Dirty( obj );
+	Remove_Visible( obj );
+
+	if( obj->m_auto_destroy )
+	{
+		m_destroyed_objects.erase( std::remove( m_destroyed_objects.begin(), m_destroyed_objects.end(), obj ), m_destroyed_objects.end() );
+	}
+
+	if( delete_data )
+	{
+		delete obj;
+	}
+
+	return 1;
+}
+
+void cSprite_Manager :: Add_Objects( const cSprite_List &sprites )
+{
+	// added after the pass
+	if( m_defer_spawns )
+	{
+		for( cSprite_List::const_iterator itr = sprites.begin(); itr != sprites.end(); ++itr )
+		{
+			Add( *itr );
+		}
+
+		return;
+	}
+
+	objects.reserve( objects.size() + sprites.size() );
+	m_awake_objects.reserve( m_awake_objects.size() + sprites.size() );
+
+	for( cSprite_List::const_iterator itr = sprites.begin(); itr != sprites.end(); ++itr )
+	{
+		cSprite *sprite = (*itr);
+
+		if( !sprite )
+		{
+			continue;
+		}
+
+		Set_Pos_Z( sprite );
+		objects.push_back( sprite );
+		sprite->m_array_num = objects.size() - 1;
+		m_grid.Add( sprite );
+		m_editor_grid.Add( sprite );
+		Add_Type( sprite );
+		Set_Draw_Dirty( sprite );
+		// at the end of the array
+		sprite->m_sleeping = 0;
+		Sprite_List_Push( m_awake_objects, sprite, &cSprite::m_awake_num );
+	}
+
+	// sorted again when used instead of inserting every object
+	m_zpos_used = 0;
+	m_editor_zpos_used = 0;
+	m_zpos_objects.clear();
+	m_editor_zpos_objects.clear();
+}
+
+void cSprite_Manager :: Delete_Objects( const cSprite_List &sprites, bool delete_data /* = 1 */ )
+{
+	// the lists could be in use
+	if( m_defer_spawns )
+	{
+		for( cSprite_List::const_iterator itr = sprites.begin(); itr != sprites.end(); ++itr )
+		{
+			Delete( *itr, delete_data );
+		}
+
+		return;
+	}
+
+	cSprite_List removed;
+	removed.reserve( sprites.size() );
+	// the first changed array number
+	unsigned int first_num = objects.size();
+
+	for( cSprite_List::const_iterator itr = sprites.begin(); itr != sprites.end(); ++itr )
 	{
-		// get object pointer
 		cSprite *obj = (*itr);
+		const int array_num = Get_Array_Num( obj );
 
-		// if destroy is set
-		if( obj->m_auto_destroy )
+		// not in the array
+		if( array_num < 0 )
 		{
-			// set new object
-			*itr = sprite;
-			// delete old
-			delete obj;
+			Delete( obj, delete_data );
+			continue;
+		}
 
-			return;
+		if( static_cast<unsigned int>(array_num) < first_num )
+		{
+			first_num = array_num;
+		}
+
+		objects[array_num] = NULL;
+		removed.push_back( obj );
+	}
+
+	if( removed.empty() )
+	{
+		return;
+	}
+
+	// keep the order of the other objects
+	objects.erase( std::remove( objects.begin() + first_num, objects.end(), static_cast<cSprite *>(NULL) ), objects.end() );
+	Update_Array_Nums( first_num );
+
+	bool static_chunk = 0;
+
+	for( cSprite_List::iterator itr = removed.begin(); itr != removed.end(); ++itr )
+	{
+		cSprite *obj = (*itr);
+
+		obj->m_array_num = -1;
+		obj->m_draw_dirty = 0;
+		obj->m_draw_listed = 0;
+		m_grid.Remove( obj );
+		m_editor_grid.Remove( obj );
+		Remove_Type( obj );
+
+		if( obj->m_static_chunk )
+		{
+			static_chunk = 1;
 		}
 	}
 
-	cObject_Manager<cSprite>::Add( sprite );
+	// remove from all lists at once
+	m_awake_objects.erase( std::remove_if( m_awake_objects.begin(), m_awake_objects.end(), not_in_array() ), m_awake_objects.end() );
+	m_sleeping_objects.erase( std::remove_if( m_sleeping_objects.begin(), m_sleeping_objects.end(), not_in_array() ), m_sleeping_objects.end() );
+	m_zpos_objects.erase( std::remove_if( m_zpos_objects.begin(), m_zpos_objects.end(), not_in_array() ), m_zpos_objects.end() );
+	m_editor_zpos_objects.erase( std::remove_if( m_editor_zpos_objects.begin(), m_editor_zpos_objects.end(), not_in_array() ), m_editor_zpos_objects.end() );
+	m_draw_dirty_objects.erase( std::remove_if( m_draw_dirty_objects.begin(), m_draw_dirty_objects.end(), not_in_array() ), m_draw_dirty_objects.end() );
+	m_visible_objects.erase( std::remove_if( m_visible_objects.begin(), m_visible_objects.end(), not_in_array() ), m_visible_objects.end() );
+	m_destroyed_objects.erase( std::remove_if( m_destroyed_objects.begin(), m_destroyed_objects.end(), not_in_array() ), m_destroyed_objects.end() );
+	Update_List_Nums();
+
+	if( delete_data )
+	{
+		for( cSprite_List::iterator itr = removed.begin(); itr != removed.end(); ++itr )
+		{
+			delete *itr;
+		}
+	}
+
+	if( static_chunk )
+	{
+		Invalidate_Static_Chunks();
+	}
+}
+
+int cSprite_Manager :: Get_Array_Num( cSprite *obj ) const
+{
+	// invalid
+	if( !obj )
+	{
+		return -1;
+	}
+
+	if( obj->m_array_num >= 0 && static_cast<size_t>(obj->m_array_num) < objects.size() && objects[obj->m_array_num] == obj )
+	{
+		return obj->m_array_num;
+	}
+
+	// array changed without updating the number
+	return cObject_Manager<cSprite>::Get_Array_Num( obj );
 }
 
 cSprite *cSprite_Manager :: Copy( unsigned int identifier )
@@ -88,6 +514,12 @@ void cSprite_Manager :: Set_Pos_Z( cSprite *sprite )
 		return;
 	}
 
+	// only the drawing order of the chunks may change
+	if( m_static_chunks && ( sprite->m_static_chunk || m_static_chunks->Is_Static_Sprite( sprite ) ) )
+	{
+		m_static_chunks->Invalidate();
+	}
+
 	// set new z position if unset
 	if( sprite->m_pos_z <= m_z_pos_data[sprite->m_type] )
 	{
@@ -147,9 +579,15 @@ void cSprite_Manager :: Move_To_Front( cSprite *sprite )
 	objects.erase( itr );
 	objects.front() = sprite;
 	objects.insert( objects.begin() + 1, first );
+	Update_Array_Nums();
+	m_awake_changed = 1;
 
 	// make it the first z position
+	Remove_Zpos( sprite );
 	sprite->m_pos_z = Get_First( sprite->m_type )->m_pos_z - 0.000001f;
+	Add_Zpos( sprite );
+
+	Invalidate_Static_Chunks();
 }
 
 void cSprite_Manager :: Move_To_Back( cSprite *sprite )
@@ -181,13 +619,58 @@ void cSprite_Manager :: Move_To_Back( cSprite *sprite )
 	objects.erase( itr );
 	objects.back() = sprite;
 	objects.insert( objects.end() - 1, last );
+	Update_Array_Nums();
+	m_awake_changed = 1;
 
 	// make it the last z position
+	Remove_Zpos( sprite );
 	sprite->m_pos_z = Get_Last( sprite->m_type )->m_pos_z + 0.000001f;
+	Add_Zpos( sprite );
+
+	Invalidate_Static_Chunks();
+}
+
+void cSprite_Manager :: Move_To_Array_Num( cSprite *sprite, unsigned int array_num, float pos_z )
+{
+	// get iterator
+	cSprite_List::iterator itr = std::find( objects.begin(), objects.end(), sprite );
+
+	// not available
+	if( itr == objects.end() )
+	{
+		return;
+	}
+
+	const unsigned int old_array_num = itr - objects.begin();
+
+	objects.erase( itr );
+
+	if( array_num > objects.size() )
+	{
+		array_num = objects.size();
+	}
+
+	objects.insert( objects.begin() + array_num, sprite );
+	Update_Array_Nums( std::min( old_array_num, array_num ) );
+	m_awake_changed = 1;
+
+	Remove_Zpos( sprite );
+	sprite->m_pos_z = pos_z;
+	Add_Zpos( sprite );
+
+	Invalidate_Static_Chunks();
 }
 
 void cSprite_Manager :: Delete_All( bool delayed /* = 0 */ )
 {
+	// never added
+	for( cSprite_List::iterator itr = m_spawn_queue.begin(); itr != m_spawn_queue.end(); ++itr )
+	{
+		delete *itr;
+	}
+
+	m_spawn_queue.clear();
+
 	// delayed
 	if( delayed )
 	{
@@ -202,6 +685,52 @@ void cSprite_Manager :: Delete_All( bool delayed /* = 0 */ )
 	// instant
 	else
 	{
+		m_grid.Clear();
+		m_editor_grid.Clear();
+
+		for( cSprite_List::iterator itr = m_sleeping_objects.begin(); itr != m_sleeping_objects.end(); ++itr )
+		{
+			(*itr)->m_sleeping = 0;
+		}
+
+		m_awake_objects.clear();
+		m_sleeping_objects.clear();
+		m_awake_changed = 0;
+		m_has_destroyed = 0;
+		m_destroyed_objects.clear();
+
+		for( cSprite_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+		{
+			(*itr)->m_type_num = -1;
+			(*itr)->m_array_type_num = -1;
+			(*itr)->m_index_name_id = 0;
+		}
+
+		m_type_objects.clear();
+		m_array_objects.clear();
+		m_identifiers.clear();
+		m_zpos_objects.clear();
+		m_editor_zpos_objects.clear();
+
+		for( cSprite_List::iterator itr = m_draw_dirty_objects.begin(); itr != m_draw_dirty_objects.end(); ++itr )
+		{
+			(*itr)->m_draw_dirty = 0;
+		}
+
+		m_draw_dirty_objects.clear();
+		m_draw_margin = 0.0f;
+
+		for( cSprite_List::iterator itr = m_visible_objects.begin(); itr != m_visible_objects.end(); ++itr )
+		{
+			if( *itr )
+			{
+				(*itr)->m_draw_listed = 0;
+			}
+		}
+
+		m_visible_objects.clear();
+		m_visible_changed = 0;
+
 		// remove objects that can not be auto-deleted
 		for( cSprite_List::iterator itr = objects.begin(); itr != objects.end(); )
 		{
@@ -210,6 +739,7 @@ void cSprite_Manager :: Delete_All( bool delayed /* = 0 */ )
 
 			if( obj->m_disallow_managed_delete )
 			{
+				obj->m_array_num = -1;
 				itr = objects.erase( itr );
 			}
 			// increment
@@ -222,35 +752,368 @@ void cSprite_Manager :: Delete_All( bool delayed /* = 0 */ )
 		cObject_Manager<cSprite>::Delete_All();
 	}
 
+	if( m_static_chunks )
+	{
+		m_static_chunks->Clear();
+	}
+
 	// clear z position data
 	std::fill( m_z_pos_data.begin(), m_z_pos_data.end(), 0.0f );
 	std::fill( m_z_pos_data_editor.begin(), m_z_pos_data_editor.end(), 0.0f );
 }
 
-cSprite *cSprite_Manager :: Get_First( const SpriteType type ) const
+void cSprite_Manager :: Add_Spawned( void )
 {
-	cSprite *first = NULL;
+	m_defer_spawns = 0;
 
-	for( cSprite_List::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	// sprites added by the added sprites are added directly
+	for( unsigned int i = 0; i < m_spawn_queue.size(); i++ )
 	{
-		// get object pointer
-		cSprite *obj = (*itr);
-
-		if( obj->m_type == type && ( !first || obj->m_pos_z < first->m_pos_z ) )
-		{
-			first = obj;
-		}
+		Add( m_spawn_queue[i] );
 	}
 
-	// return result
-	return first;
+	m_spawn_queue.clear();
 }
 
-cSprite *cSprite_Manager :: Get_Last( const SpriteType type ) const
+void cSprite_Manager :: Delete_Destroyed( void )
+{
+	if( !m_has_destroyed )
+	{
+		return;
+	}
+
+	m_has_destroyed = 0;
+	// the kept objects are not replaced anymore
+	m_destroyed_objects.clear();
+
+	cSprite_List destroyed;
+	cSprite_List::iterator kept_itr = objects.begin();
+
+	// keep the order of the other objects
+	for( cSprite_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	{
+		cSprite *obj = (*itr);
+
+		if( obj->m_auto_destroy && !obj->m_disallow_managed_delete )
+		{
+			destroyed.push_back( obj );
+			continue;
+		}
+
+		*kept_itr = obj;
+		++kept_itr;
+	}
+
+	if( destroyed.empty() )
+	{
+		return;
+	}
+
+	// the first changed array number
+	const unsigned int first_num = destroyed.front()->m_array_num;
+
+	objects.erase( kept_itr, objects.end() );
+	Update_Array_Nums( first_num );
+
+	bool static_chunk = 0;
+
+	for( cSprite_List::iterator itr = destroyed.begin(); itr != destroyed.end(); ++itr )
+	{
+		cSprite *obj = (*itr);
+
+		obj->m_array_num = -1;
+		m_grid.Remove( obj );
+		m_editor_grid.Remove( obj );
+		Remove_Type( obj );
+
+		if( obj->m_static_chunk )
+		{
+			static_chunk = 1;
+		}
+	}
+
+	// remove from the awake and sleeping objects at once
+	m_awake_objects.erase( std::remove_if( m_awake_objects.begin(), m_awake_objects.end(), not_in_array() ), m_awake_objects.end() );
+	m_sleeping_objects.erase( std::remove_if( m_sleeping_objects.begin(), m_sleeping_objects.end(), not_in_array() ), m_sleeping_objects.end() );
+	m_zpos_objects.erase( std::remove_if( m_zpos_objects.begin(), m_zpos_objects.end(), not_in_array() ), m_zpos_objects.end() );
+	m_editor_zpos_objects.erase( std::remove_if( m_editor_zpos_objects.begin(), m_editor_zpos_objects.end(), not_in_array() ), m_editor_zpos_objects.end() );
+	m_draw_dirty_objects.erase( std::remove_if( m_draw_dirty_objects.begin(), m_draw_dirty_objects.end(), not_in_array() ), m_draw_dirty_objects.end() );
+	m_visible_objects.erase( std::remove_if( m_visible_objects.begin(), m_visible_objects.end(), not_in_array() ), m_visible_objects.end() );
+	Update_List_Nums();
+
+	for( cSprite_List::iterator itr = destroyed.begin(); itr != destroyed.end(); ++itr )
+	{
+		delete *itr;
+	}
+
+	// sleeping objects have no collisions
+	for( cSprite_List::iterator itr = m_awake_objects.begin(); itr != m_awake_objects.end(); ++itr )
+	{
+		if( *itr )
+		{
+			(*itr)->Delete_Invalid_Collisions();
+		}
+	}
+
+	cSprite *player = m_context->Get_Player();
+
+	if( player )
+	{
+		player->Delete_Invalid_Collisions();
+	}
+
+	if( static_chunk )
+	{
+		Invalidate_Static_Chunks();
+	}
+}
+
+void cSprite_Manager :: Set_Context( cEngine_Context *context )
+{
+	if( !context )
+	{
+		context = pDefault_Engine_Context;
+	}
+
+	m_context = context;
+}
+
+void cSprite_Manager :: Set_Static_Chunks( bool enable )
+{
+	// already set
+	if( enable == ( m_static_chunks != NULL ) )
+	{
+		return;
+	}
+
+	if( enable )
+	{
+		m_static_chunks = new cStatic_Chunk_Cache( this );
+	}
+	else
+	{
+		delete m_static_chunks;
+		m_static_chunks = NULL;
+
+		for( cSprite_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+		{
+			(*itr)->m_static_chunk = 0;
+		}
+	}
+}
+
+const cSprite_List &cSprite_Manager :: Get_Type_Objects( const SpriteType type ) const
+{
+	if( type < 0 || static_cast<unsigned int>(type) >= m_type_objects.size() )
+	{
+		return m_no_objects;
+	}
+
+	return m_type_objects[type];
+}
+
+const cSprite_List &cSprite_Manager :: Get_Array_Objects( const ArrayType sprite_array ) const
+{
+	if( sprite_array < 0 || static_cast<unsigned int>(sprite_array) >= m_array_objects.size() )
+	{
+		return m_no_objects;
+	}
+
+	return m_array_objects[sprite_array];
+}
+
+void cSprite_Manager :: Update_Type( cSprite *sprite )
+{
+	// not changed
+	if( sprite->m_type == sprite->m_index_type && sprite->m_sprite_array == sprite->m_index_array )
+	{
+		return;
+	}
+
+	// not in this manager
+	if( !Is_Type_Indexed( sprite ) )
+	{
+		return;
+	}
+
+	Remove_Type( sprite );
+	Add_Type( sprite );
+
+	// could be in another collision layer
+	if( sprite->m_grid == &m_grid )
+	{
+		m_grid.Update( sprite );
+	}
+}
+
+cSprite *cSprite_Manager :: Get_Named_Object( const SpriteType type, const std::string &identifier ) const
+{
+	if( identifier.empty() )
+	{
+		return NULL;
+	}
+
+	// not used by any object if never added to the string table
+	const unsigned int identifier_id = Get_String_Table().Find_Id( identifier );
+
+	if( !identifier_id )
+	{
+		return NULL;
+	}
+
+	Identifier_Map::const_iterator found = m_identifiers.find( Identifier_Key( type, identifier_id ) );
+
+	if( found == m_identifiers.end() )
+	{
+		return NULL;
+	}
+
+	const cSprite_List &named_objects = found->second;
+	cSprite *first = NULL;
+
+	for( cSprite_List::const_iterator itr = named_objects.begin(); itr != named_objects.end(); ++itr )
+	{
+		cSprite *obj = (*itr);
+
+		if( obj->m_auto_destroy )
+		{
+			continue;
+		}
+
+		// the first one in the array if the identifier is used more than once
+		if( !first || obj->m_array_num < first->m_array_num )
+		{
+			first = obj;
+		}
+	}
+
+	return first;
+}
+
+void cSprite_Manager :: Update_Identifier( cSprite *sprite )
+{
+	// not in this manager
+	if( !Is_Type_Indexed( sprite ) )
+	{
+		return;
+	}
+
+	// not changed
+	if( Get_String_Table().Get_Id( sprite->Get_Identifier() ) == sprite->m_index_name_id )
+	{
+		return;
+	}
+
+	Remove_Identifier( sprite );
+	Add_Identifier( sprite );
+}
+
+void cSprite_Manager :: Add_Waiting_Path_State( cPath_State *path_state )
+{
+	if( path_state->m_path_identifier.empty() )
+	{
+		return;
+	}
+
+	vector<cPath_State *> &path_states = m_waiting_path_states[path_state->m_path_identifier];
+
+	if( std::find( path_states.begin(), path_states.end(), path_state ) == path_states.end() )
+	{
+		path_states.push_back( path_state );
+	}
+}
+
+void cSprite_Manager :: Remove_Waiting_Path_State( cPath_State *path_state )
+{
+	Path_State_Map::iterator found = m_waiting_path_states.find( path_state->m_path_identifier );
+
+	if( found == m_waiting_path_states.end() )
+	{
+		return;
+	}
+
+	vector<cPath_State *> &path_states = found->second;
+	vector<cPath_State *>::iterator itr = std::find( path_states.begin(), path_states.end(), path_state );
+
+	if( itr != path_states.end() )
+	{
+		path_states.erase( itr );
+	}
+
+	if( path_states.empty() )
+	{
+		m_waiting_path_states.erase( found );
+	}
+}
+
+void cSprite_Manager :: Get_Waiting_Path_States( const std::string &identifier, vector<cPath_State *> &path_states ) const
+{
+	Path_State_Map::const_iterator found = m_waiting_path_states.find( identifier );
+
+	if( found != m_waiting_path_states.end() )
+	{
+		path_states = found->second;
+	}
+}
+
+void cSprite_Manager :: Set_Trigger( cSprite *sprite, const GL_rect &rect )
+{
+	for( Trigger_List::iterator itr = m_triggers.begin(); itr != m_triggers.end(); ++itr )
+	{
+		if( (*itr).m_sprite == sprite )
+		{
+			// the player state is checked again with the next update
+			(*itr).m_rect = rect;
+			return;
+		}
+	}
+
+	Trigger trigger;
+	trigger.m_sprite = sprite;
+	trigger.m_rect = rect;
+	trigger.m_inside = 0;
+
+	m_triggers.push_back( trigger );
+}
+
+void cSprite_Manager :: Remove_Trigger( const cSprite *sprite )
+{
+	for( Trigger_List::iterator itr = m_triggers.begin(); itr != m_triggers.end(); ++itr )
+	{
+		if( (*itr).m_sprite == sprite )
+		{
+			m_triggers.erase( itr );
+			return;
+		}
+	}
+}
+
+cSprite *cSprite_Manager :: Get_First( const SpriteType type ) const
+{
+	cSprite *first = NULL;
+	const cSprite_List &type_objects = Get_Type_Objects( type );
+
+	for( cSprite_List::const_iterator itr = type_objects.begin(); itr != type_objects.end(); ++itr )
+	{
+		// get object pointer
+		cSprite *obj = (*itr);
+
+		if( obj->m_type == type && ( !first || obj->m_pos_z < first->m_pos_z ) )
+		{
+			first = obj;
+		}
+	}
+
+	// return result
+	return first;
+}
+
+cSprite *cSprite_Manager :: Get_Last( const SpriteType type ) const
 {
 	cSprite *last = NULL;
+	const cSprite_List &type_objects = Get_Type_Objects( type );
 
-	for( cSprite_List::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	for( cSprite_List::const_iterator itr = type_objects.begin(); itr != type_objects.end(); ++itr )
 	{
 		// get object pointer
 		cSprite *obj = (*itr);
@@ -303,32 +1166,66 @@ cSprite *cSprite_Manager :: Get_from_Position( int start_pos_x, int start_pos_y,
 	return NULL;
 }
 
-void cSprite_Manager :: Get_Objects_sorted( cSprite_List &new_objects, bool editor_sort /* = 0 */, bool with_player /* = 0 */ ) const
+const cSprite_List &cSprite_Manager :: Get_Objects_sorted( bool editor_sort /* = 0 */ )
 {
-	new_objects = objects;
-
-	if( with_player )
+	// default
+	if( !editor_sort )
 	{
-		new_objects.push_back( pActive_Player );
+		if( !m_zpos_used )
+		{
+			m_zpos_objects = objects;
+			std::sort( m_zpos_objects.begin(), m_zpos_objects.end(), zpos_sort() );
+			m_zpos_used = 1;
+		}
+		// z positions can be set directly
+		else
+		{
+			Sprite_Sorted_Repair( m_zpos_objects, zpos_sort() );
+		}
+
+		Sprite_List_Set_Nums( m_zpos_objects, &cSprite::m_zpos_num );
+
+		return m_zpos_objects;
 	}
 
-	// z position sort
-	if( !editor_sort )
+	// editor
+	if( !m_editor_zpos_used )
 	{
-		// default
-		std::sort( new_objects.begin(), new_objects.end(), zpos_sort() );
+		m_editor_zpos_objects = objects;
+		std::sort( m_editor_zpos_objects.begin(), m_editor_zpos_objects.end(), editor_zpos_sort() );
+		m_editor_zpos_used = 1;
 	}
+	// z positions can be set directly
 	else
 	{
-		// editor
-		std::sort( new_objects.begin(), new_objects.end(), editor_zpos_sort() );
+		Sprite_Sorted_Repair( m_editor_zpos_objects, editor_zpos_sort() );
 	}
+
+	Sprite_List_Set_Nums( m_editor_zpos_objects, &cSprite::m_editor_zpos_num );
+
+	return m_editor_zpos_objects;
 }
 
-void cSprite_Manager :: Get_Colliding_Objects( cSprite_List &col_objects, const GL_rect &rect, bool with_player /* = 0 */, const cSprite *exclude_sprite /* = NULL */ ) const
+void cSprite_Manager :: Get_Colliding_Objects( cSprite_List &col_objects, const GL_rect &rect, bool with_player /* = 0 */, const cSprite *exclude_sprite /* = NULL */, Uint32 layer_mask /* = COL_LAYER_ALL */ ) const
 {
+	cSprite_List grid_objects;
+	const cSprite_Grid::Static_Gather *static_gather = Get_Static_Gather( exclude_sprite, rect );
+
+	// static objects are already gathered
+	if( static_gather && static_gather->m_layer_mask == layer_mask )
+	{
+		grid_objects = static_gather->m_objects;
+		m_grid.Get_Dynamic_Objects( grid_objects, rect, layer_mask );
+		// keep the order of checking all objects
+		std::sort( grid_objects.begin(), grid_objects.end(), array_num_sort() );
+	}
+	else
+	{
+		Get_Grid_Objects( grid_objects, rect, layer_mask );
+	}
+
 	// Check objects
-	for( cSprite_List::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	for( cSprite_List::const_iterator itr = grid_objects.begin(); itr != grid_objects.end(); ++itr )
 	{
 		// get object pointer
 		cSprite *obj = (*itr);
@@ -348,53 +1245,943 @@ void cSprite_Manager :: Get_Colliding_Objects( cSprite_List &col_objects, const
 		col_objects.push_back( obj );
 	}
 
-	if( with_player && pActive_Player != exclude_sprite )
+	cSprite *player = m_context->Get_Player();
+
+	if( with_player && player != exclude_sprite && ( layer_mask & COL_LAYER_PLAYER ) )
 	{
-		if( rect.Intersects( pActive_Player->m_col_rect ) )
+		if( rect.Intersects( player->m_col_rect ) )
 		{
-			col_objects.push_back( pActive_Player );
+			col_objects.push_back( player );
 		}
 	}
 }
 
-void cSprite_Manager :: Handle_Collision_Items( void )
+void cSprite_Manager :: Get_Grid_Objects( cSprite_List &grid_objects, const GL_rect &rect, Uint32 layer_mask /* = COL_LAYER_ALL */ ) const
 {
-	for( cSprite_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
-	{
-		cSprite *obj = (*itr);
+	m_grid.Get_Objects( grid_objects, rect, layer_mask );
 
-		// invalid
-		if( obj->m_auto_destroy )
-		{
-			if( obj->m_collisions.size() )
-			{
-				debug_print( "Collision with a destroyed object (%s)\n", obj->m_name.c_str() );
-				obj->Clear_Collisions();
-			}
+	// keep the order of checking all objects
+	std::sort( grid_objects.begin(), grid_objects.end(), array_num_sort() );
+}
 
-			continue;
-		}
+void cSprite_Manager :: Get_Editor_Objects( cSprite_List &editor_objects, const GL_rect &rect )
+{
+	m_editor_grid.Build( objects );
+	m_editor_grid.Get_Objects( editor_objects, rect );
 
-		// collision and movement handling
-		obj->Collide_Move();
-		// handle found collisions
-		obj->Handle_Collisions();
-	}
+	// keep the order of checking all objects
+	std::sort( editor_objects.begin(), editor_objects.end(), array_num_sort() );
 }
 
-unsigned int cSprite_Manager :: Get_Size_Array( const ArrayType sprite_array )
+void cSprite_Manager :: Begin_Batch_Update( void )
 {
-	unsigned int count = 0;
+	m_batch_depth++;
+}
 
-	for( cSprite_List::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
+void cSprite_Manager :: End_Batch_Update( void )
+{
+	if( !m_batch_depth )
 	{
-		if( (*itr)->m_sprite_array == sprite_array )
-		{
-			count++;
-		}
+		return;
+	}
+
+	m_batch_depth--;
+
+	if( m_batch_depth || m_batch_objects.empty() )
+	{
+		return;
+	}
+
+	// objects moved more than once are only updated once
+	std::sort( m_batch_objects.begin(), m_batch_objects.end() );
+	m_batch_objects.erase( std::unique( m_batch_objects.begin(), m_batch_objects.end() ), m_batch_objects.end() );
+
+	cSprite_List batch_objects;
+	batch_objects.swap( m_batch_objects );
+
+	for( cSprite_List::iterator itr = batch_objects.begin(); itr != batch_objects.end(); ++itr )
+	{
+		(*itr)->Update_Grid();
+	}
+}
+
+bool cSprite_Manager :: Defer_Grid_Update( cSprite *sprite )
+{
+	if( !m_batch_depth )
+	{
+		return 0;
+	}
+
+	m_batch_objects.push_back( sprite );
+	return 1;
+}
+
+void cSprite_Manager :: Handle_Collision_Items( void )
+{
+	Gather_Static_Objects();
+	m_defer_spawns = 1;
+
+	for( unsigned int i = 0; i < m_awake_objects.size(); i++ )
+	{
+		cSprite *obj = m_awake_objects[i];
+
+		// deleted
+		if( !obj )
+		{
+			continue;
+		}
+
+		// invalid
+		if( obj->m_auto_destroy )
+		{
+			if( obj->m_collisions.size() )
+			{
+				debug_print( "Collision with a destroyed object (%s)\n", obj->m_name.c_str() );
+				obj->Clear_Collisions();
+			}
+
+			continue;
+		}
+
+		cObject_Profiler_Scope profile_scope( obj, cObject_Profiler::PHASE_COLLISION );
+		// collision and movement handling
+		obj->Collide_Move();
+		// handle found collisions
+		obj->Handle_Collisions();
+	}
+
+	m_static_gather_valid = 0;
+
+	Add_Spawned();
+	Update_Awake();
+}
+
+void cSprite_Manager :: Update_Items( void )
+{
+	m_animation_time += m_context->Get_Framerate()->m_elapsed_ticks;
+	m_update_count++;
+
+	Update_Sleeping();
+	Update_Triggers();
+
+	// distant enemies update at a reduced rate
+	const cCamera *camera = m_context->Get_Camera();
+
+	if( camera )
+	{
+		const GL_rect camera_rect = camera->Get_Rect();
+
+		for( cSprite_List::iterator itr = m_awake_objects.begin(); itr != m_awake_objects.end(); ++itr )
+		{
+			if( *itr && (*itr)->m_sprite_array == ARRAY_ENEMY )
+			{
+				static_cast<cEnemy *>(*itr)->Update_LOD( camera_rect );
+			}
+		}
+	}
+
+	// objects added while updating are kept until all are updated
+	m_defer_spawns = 1;
+
+	for( unsigned int i = 0; i < m_awake_objects.size(); )
+	{
+		cSprite *obj = m_awake_objects[i];
+
+		// deleted
+		if( !obj )
+		{
+			i++;
+			continue;
+		}
+
+		if( obj->m_sprite_array == ARRAY_ENEMY )
+		{
+			cEnemy *enemy = static_cast<cEnemy *>(obj);
+
+			// skipped
+			if( enemy->m_lod_skip )
+			{
+				i++;
+				continue;
+			}
+
+			// with the speed factor of the skipped updates
+			if( enemy->m_lod_accumulated )
+			{
+				cObject_Profiler_Scope profile_scope( enemy, cObject_Profiler::PHASE_UPDATE );
+				enemy->Update_Accumulated();
+				i++;
+				continue;
+			}
+		}
+
+		// measured objects are updated one after another
+		if( !pUpdate_Workers || !obj->Is_Update_Parallel() || ( pObject_Profiler && pObject_Profiler->Is_Enabled() ) )
+		{
+			cObject_Profiler_Scope profile_scope( obj, cObject_Profiler::PHASE_UPDATE );
+			obj->Update();
+			i++;
+			continue;
+		}
+
+		/* the following parallel objects
+		 * a not parallel object could depend on their updates and is updated after them
+		*/
+		m_parallel_objects.clear();
+
+		for( ; i < m_awake_objects.size(); i++ )
+		{
+			obj = m_awake_objects[i];
+
+			// deleted
+			if( !obj )
+			{
+				continue;
+			}
+
+			// skipped distant enemy
+			if( obj->m_sprite_array == ARRAY_ENEMY && static_cast<cEnemy *>(obj)->m_lod_skip )
+			{
+				continue;
+			}
+
+			if( !obj->Is_Update_Parallel() )
+			{
+				break;
+			}
+
+			m_parallel_objects.push_back( obj );
+		}
+
+		pUpdate_Workers->Update( &m_parallel_objects[0], m_parallel_objects.size() );
+	}
+
+	Add_Spawned();
+}
+
+unsigned int cSprite_Manager :: Draw_Parallel( unsigned int start, bool static_chunks )
+{
+	m_parallel_objects.clear();
+
+	unsigned int i = start;
+
+	for( ; i < m_visible_objects.size(); i++ )
+	{
+		cSprite *obj = m_visible_objects[i];
+
+		if( !obj || ( static_chunks && obj->m_static_chunk ) )
+		{
+			continue;
+		}
+
+		if( !obj->Is_Draw_Parallel() )
+		{
+			break;
+		}
+
+		m_parallel_objects.push_back( obj );
+	}
+
+	const unsigned int count = m_parallel_objects.size();
+	// the calling thread draws the last part
+	const unsigned int task_count = pTask_Pool ? pTask_Pool->Get_Thread_Count() + 1 : 1;
+
+	// measured objects are drawn one after another and few objects are faster without the tasks
+	if( task_count == 1 || count < draw_parallel_min || ( pObject_Profiler && pObject_Profiler->Is_Enabled() ) )
+	{
+		for( unsigned int j = 0; j < count; j++ )
+		{
+			cSprite *obj = m_parallel_objects[j];
+
+			cObject_Profiler_Scope profile_scope( obj, cObject_Profiler::PHASE_DRAW );
+			obj->Draw();
+		}
+
+		return i;
+	}
+
+	if( !m_draw_task_group )
+	{
+		m_draw_task_group = pTask_Pool->Create_Group();
+	}
+
+	while( m_draw_captures.size() < task_count )
+	{
+		m_draw_captures.push_back( new cRender_Capture() );
+	}
+
+	cRenderQueue *renderer = m_context->Get_Renderer();
+	cSprite **sprites = &m_parallel_objects[0];
+	const unsigned int part_size = ( count + task_count - 1 ) / task_count;
+	unsigned int used_captures = 1;
+
+	// a contiguous part of the objects for every task
+	for( unsigned int pos = part_size; pos < count; pos += part_size )
+	{
+		const unsigned int part_count = pos + part_size > count ? count - pos : part_size;
+		pTask_Pool->Add( boost::bind( &Draw_Sprites, m_draw_captures[used_captures], renderer, sprites + pos, part_count ), TASK_PRIORITY_FRAME, m_draw_task_group, "draw sprites" );
+		used_captures++;
+	}
+
+	// the first part
+	Draw_Sprites( m_draw_captures[0], renderer, sprites, part_size );
+
+	pTask_Pool->Wait( m_draw_task_group );
+
+	// in the object order
+	for( unsigned int j = 0; j < used_captures; j++ )
+	{
+		m_draw_captures[j]->Submit();
+	}
+
+	return i;
+}
+
+void cSprite_Manager :: Wake_Up( cSprite *sprite )
+{
+	if( !sprite->m_sleeping )
+	{
+		return;
+	}
+
+	// not in this manager
+	if( Get_Array_Num( sprite ) < 0 )
+	{
+		return;
+	}
+
+	Remove_Awake( sprite );
+	sprite->m_sleeping = 0;
+	// keep the array order with the list update
+	Sprite_List_Push( m_awake_objects, sprite, &cSprite::m_awake_num );
+	m_awake_changed = 1;
+}
+
+void cSprite_Manager :: Warm_Up( const GL_rect &rect )
+{
+	cSprite_List grid_objects;
+	m_grid.Get_Objects( grid_objects, rect );
+
+	for( cSprite_List::iterator itr = grid_objects.begin(); itr != grid_objects.end(); ++itr )
+	{
+		cSprite *obj = (*itr);
+
+		if( obj->m_image && !obj->m_auto_destroy )
+		{
+			obj->m_image->Use();
+		}
+	}
+}
+
+void cSprite_Manager :: Save_Tick_Positions( Uint32 tick )
+{
+	for( cSprite_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	{
+		cSprite *obj = (*itr);
+
+		obj->m_tick_pos_x = obj->m_pos_x;
+		obj->m_tick_pos_y = obj->m_pos_y;
+		obj->m_tick = tick;
+	}
+}
+
+void cSprite_Manager :: Update_Triggers( void )
+{
+	if( m_triggers.empty() )
+	{
+		return;
+	}
+
+	const GL_rect &player_rect = m_context->Get_Level_Player()->m_col_rect;
+
+	for( Trigger_List::iterator itr = m_triggers.begin(); itr != m_triggers.end(); ++itr )
+	{
+		Trigger &trigger = (*itr);
+		const bool inside = player_rect.Intersects( trigger.m_rect );
+
+		if( inside == trigger.m_inside )
+		{
+			continue;
+		}
+
+		trigger.m_inside = inside;
+
+		if( inside )
+		{
+			trigger.m_sprite->Handle_Trigger_Enter();
+		}
+		else
+		{
+			trigger.m_sprite->Handle_Trigger_Leave();
+		}
+	}
+}
+
+void cSprite_Manager :: Update_Items_Valid_Draw( void )
+{
+	const cCamera *camera = m_context->Get_Camera();
+
+	Draw_State state;
+	state.m_camera_x = camera->m_x;
+	state.m_camera_y = camera->m_y;
+	state.m_res_w = game_res_w;
+	state.m_res_h = game_res_h;
+	state.m_editor = editor_enabled;
+	state.m_debug = game_debug;
+	state.m_mouse_object = pMouseCursor->m_active_object;
+	state.m_ghost = m_context->Get_Level_Player()->m_maryo_type == MARYO_GHOST;
+
+	// update all objects
+	if( !m_draw_state_valid || state.m_res_w != m_draw_state.m_res_w || state.m_res_h != m_draw_state.m_res_h || state.m_editor != m_draw_state.m_editor ||
+		state.m_debug != m_draw_state.m_debug || state.m_mouse_object != m_draw_state.m_mouse_object || state.m_ghost != m_draw_state.m_ghost )
+	{
+		for( cSprite_List::iterator itr = m_draw_dirty_objects.begin(); itr != m_draw_dirty_objects.end(); ++itr )
+		{
+			(*itr)->m_draw_dirty = 0;
+		}
+
+		m_draw_dirty_objects.clear();
+		m_draw_state = state;
+		m_draw_state_valid = 1;
+
+		for( cSprite_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+		{
+			Update_Valid_Draw( *itr );
+		}
+
+		return;
+	}
+
+	// changed objects
+	// updating can change an object again
+	for( unsigned int i = 0; i < m_draw_dirty_objects.size(); i++ )
+	{
+		cSprite *obj = m_draw_dirty_objects[i];
+
+		obj->m_draw_dirty = 0;
+		Update_Valid_Draw( obj );
+	}
+
+	m_draw_dirty_objects.clear();
+
+	// particle emitters use the camera range
+	const cSprite_List &emitters = Get_Type_Objects( TYPE_PARTICLE_EMITTER );
+
+	for( cSprite_List::const_iterator itr = emitters.begin(); itr != emitters.end(); ++itr )
+	{
+		Update_Valid_Draw( *itr );
+	}
+
+	// camera moved
+	if( state.m_camera_x != m_draw_state.m_camera_x || state.m_camera_y != m_draw_state.m_camera_y )
+	{
+		/* only objects visible on the last or the new screen can change
+		 * their image rect is in the margin around their collision rect in the grid
+		*/
+		cSprite_List screen_objects;
+		GL_rect screen_rect( m_draw_state.m_camera_x - m_draw_margin, m_draw_state.m_camera_y - m_draw_margin, static_cast<float>(state.m_res_w) + m_draw_margin * 2.0f, static_cast<float>(state.m_res_h) + m_draw_margin * 2.0f );
+		m_grid.Get_Objects( screen_objects, screen_rect );
+
+		screen_rect.m_x = state.m_camera_x - m_draw_margin;
+		screen_rect.m_y = state.m_camera_y - m_draw_margin;
+		m_grid.Get_Objects( screen_objects, screen_rect );
+
+		for( cSprite_List::iterator itr = screen_objects.begin(); itr != screen_objects.end(); ++itr )
+		{
+			Update_Valid_Draw( *itr );
+		}
+	}
+
+	m_draw_state = state;
+}
+
+bool cSprite_Manager :: Set_Draw_Dirty( cSprite *sprite )
+{
+	// not in the objects
+	if( sprite->m_array_num < 0 || static_cast<size_t>(sprite->m_array_num) >= objects.size() || objects[sprite->m_array_num] != sprite )
+	{
+		return 0;
+	}
+
+	if( !sprite->m_draw_dirty )
+	{
+		sprite->m_draw_dirty = 1;
+		Sprite_List_Push( m_draw_dirty_objects, sprite, &cSprite::m_draw_dirty_num );
+	}
+
+	return 1;
+}
+
+unsigned int cSprite_Manager :: Get_Size_Array( const ArrayType sprite_array ) const
+{
+	return Get_Array_Objects( sprite_array ).size();
+}
+
+void cSprite_Manager :: Update_Sleeping( void )
+{
+	size_t sleeping_count = 0;
+
+	for( size_t i = 0; i < m_sleeping_objects.size(); i++ )
+	{
+		cSprite *obj = m_sleeping_objects[i];
+
+		// still sleeping
+		if( obj->Is_Sleep_Valid() )
+		{
+			obj->m_awake_num = sleeping_count;
+			m_sleeping_objects[sleeping_count++] = obj;
+			continue;
+		}
+
+		obj->m_sleeping = 0;
+		// keep the array order with the list update
+		Sprite_List_Push( m_awake_objects, obj, &cSprite::m_awake_num );
+		m_awake_changed = 1;
+	}
+
+	m_sleeping_objects.resize( sleeping_count );
+
+	if( m_awake_changed )
+	{
+		Update_Awake_Objects();
+	}
+}
+
+void cSprite_Manager :: Update_Awake( void )
+{
+	for( cSprite_List::iterator itr = m_awake_objects.begin(); itr != m_awake_objects.end(); ++itr )
+	{
+		cSprite *obj = (*itr);
+
+		// deleted or would do nothing
+		if( !obj || !obj->Is_Sleep_Valid() )
+		{
+			continue;
+		}
+
+		obj->m_sleeping = 1;
+		m_awake_changed = 1;
+
+		// basic sprites only wake up from a collision or a type change
+		if( !obj->Is_Basic_Sprite() )
+		{
+			Sprite_List_Push( m_sleeping_objects, obj, &cSprite::m_awake_num );
+		}
+	}
+
+	if( m_awake_changed )
+	{
+		Update_Awake_Objects();
+	}
+}
+
+// deleted or sleeping
+static bool Is_Awake_Removed( const cSprite *obj )
+{
+	return !obj || obj->m_sleeping;
+}
+
+void cSprite_Manager :: Update_Awake_Objects( void )
+{
+	m_awake_objects.erase( std::remove_if( m_awake_objects.begin(), m_awake_objects.end(), Is_Awake_Removed ), m_awake_objects.end() );
+	// woken up and moved objects
+	std::sort( m_awake_objects.begin(), m_awake_objects.end(), array_num_sort() );
+	Sprite_List_Set_Nums( m_awake_objects, &cSprite::m_awake_num );
+
+	m_awake_changed = 0;
+}
+
+void cSprite_Manager :: Remove_Awake( cSprite *sprite )
+{
+	if( sprite->m_sleeping )
+	{
+		// move the last one to its position
+		if( Sprite_List_Is_At( m_sleeping_objects, sprite, &cSprite::m_awake_num ) )
+		{
+			cSprite *last = m_sleeping_objects.back();
+			m_sleeping_objects[sprite->m_awake_num] = last;
+			last->m_awake_num = sprite->m_awake_num;
+			m_sleeping_objects.pop_back();
+		}
+
+		sprite->m_awake_num = -1;
+		return;
+	}
+
+	// set to NULL as the list could be in use
+	if( Sprite_List_Is_At( m_awake_objects, sprite, &cSprite::m_awake_num ) )
+	{
+		m_awake_objects[sprite->m_awake_num] = NULL;
+		m_awake_changed = 1;
+	}
+
+	sprite->m_awake_num = -1;
+}
+
+void cSprite_Manager :: Update_List_Nums( void )
+{
+	Sprite_List_Set_Nums( m_awake_objects, &cSprite::m_awake_num );
+	Sprite_List_Set_Nums( m_sleeping_objects, &cSprite::m_awake_num );
+	Sprite_List_Set_Nums( m_zpos_objects, &cSprite::m_zpos_num );
+	Sprite_List_Set_Nums( m_editor_zpos_objects, &cSprite::m_editor_zpos_num );
+	Sprite_List_Set_Nums( m_draw_dirty_objects, &cSprite::m_draw_dirty_num );
+	Sprite_List_Set_Nums( m_visible_objects, &cSprite::m_visible_num );
+}
+
+bool cSprite_Manager :: Is_Type_Indexed( const cSprite *sprite ) const
+{
+	if( sprite->m_type_num < 0 || static_cast<unsigned int>(sprite->m_index_type) >= m_type_objects.size() )
+	{
+		return 0;
+	}
+
+	const cSprite_List &type_objects = m_type_objects[sprite->m_index_type];
+
+	return static_cast<unsigned int>(sprite->m_type_num) < type_objects.size() && type_objects[sprite->m_type_num] == sprite;
+}
+
+void cSprite_Manager :: Add_Type( cSprite *sprite )
+{
+	sprite->m_index_type = sprite->m_type;
+	sprite->m_index_array = sprite->m_sprite_array;
+	Sprite_Index_Add( m_type_objects, sprite->m_index_type, sprite, sprite->m_type_num );
+	Sprite_Index_Add( m_array_objects, sprite->m_index_array, sprite, sprite->m_array_type_num );
+	Add_Identifier( sprite );
+}
+
+void cSprite_Manager :: Remove_Type( cSprite *sprite )
+{
+	// not in the lists of this manager
+	if( !Is_Type_Indexed( sprite ) )
+	{
+		return;
+	}
+
+	Remove_Identifier( sprite );
+	Sprite_Index_Remove( m_type_objects, sprite->m_index_type, sprite->m_type_num, &cSprite::m_type_num );
+	Sprite_Index_Remove( m_array_objects, sprite->m_index_array, sprite->m_array_type_num, &cSprite::m_array_type_num );
+}
+
+void cSprite_Manager :: Add_Zpos( cSprite *sprite )
+{
+	if( m_zpos_used )
+	{
+		Sprite_Sorted_Repair( m_zpos_objects, zpos_sort() );
+		Sprite_Sorted_Insert( m_zpos_objects, sprite, zpos_sort() );
+		Sprite_List_Set_Nums( m_zpos_objects, &cSprite::m_zpos_num );
+	}
+	if( m_editor_zpos_used )
+	{
+		Sprite_Sorted_Repair( m_editor_zpos_objects, editor_zpos_sort() );
+		Sprite_Sorted_Insert( m_editor_zpos_objects, sprite, editor_zpos_sort() );
+		Sprite_List_Set_Nums( m_editor_zpos_objects, &cSprite::m_editor_zpos_num );
+	}
+}
+
+void cSprite_Manager :: Remove_Zpos( cSprite *sprite )
+{
+	if( m_zpos_used && Sprite_List_Is_At( m_zpos_objects, sprite, &cSprite::m_zpos_num ) )
+	{
+		m_zpos_objects.erase( m_zpos_objects.begin() + sprite->m_zpos_num );
+		Sprite_List_Set_Nums( m_zpos_objects, &cSprite::m_zpos_num, sprite->m_zpos_num );
+	}
+	if( m_editor_zpos_used && Sprite_List_Is_At( m_editor_zpos_objects, sprite, &cSprite::m_editor_zpos_num ) )
+	{
+		m_editor_zpos_objects.erase( m_editor_zpos_objects.begin() + sprite->m_editor_zpos_num );
+		Sprite_List_Set_Nums( m_editor_zpos_objects, &cSprite::m_editor_zpos_num, sprite->m_editor_zpos_num );
+	}
+
+	sprite->m_zpos_num = -1;
+	sprite->m_editor_zpos_num = -1;
+}
+
+void cSprite_Manager :: Replace_Zpos( cSprite *old_sprite, cSprite *sprite )
+{
+	if( m_zpos_used )
+	{
+		if( Sprite_List_Is_At( m_zpos_objects, old_sprite, &cSprite::m_zpos_num ) )
+		{
+			m_zpos_objects[old_sprite->m_zpos_num] = sprite;
+			sprite->m_zpos_num = old_sprite->m_zpos_num;
+		}
+		// not listed
+		else
+		{
+			Sprite_List_Push( m_zpos_objects, sprite, &cSprite::m_zpos_num );
+		}
+	}
+	if( m_editor_zpos_used )
+	{
+		if( Sprite_List_Is_At( m_editor_zpos_objects, old_sprite, &cSprite::m_editor_zpos_num ) )
+		{
+			m_editor_zpos_objects[old_sprite->m_editor_zpos_num] = sprite;
+			sprite->m_editor_zpos_num = old_sprite->m_editor_zpos_num;
+		}
+		else
+		{
+			Sprite_List_Push( m_editor_zpos_objects, sprite, &cSprite::m_editor_zpos_num );
+		}
+	}
+
+	old_sprite->m_zpos_num = -1;
+	old_sprite->m_editor_zpos_num = -1;
+}
+
+void cSprite_Manager :: Remove_Draw_Dirty( cSprite *sprite )
+{
+	if( !sprite->m_draw_dirty )
+	{
+		return;
+	}
+
+	sprite->m_draw_dirty = 0;
+
+	// move the last one to its position
+	if( Sprite_List_Is_At( m_draw_dirty_objects, sprite, &cSprite::m_draw_dirty_num ) )
+	{
+		cSprite *last = m_draw_dirty_objects.back();
+		m_draw_dirty_objects[sprite->m_draw_dirty_num] = last;
+		last->m_draw_dirty_num = sprite->m_draw_dirty_num;
+		m_draw_dirty_objects.pop_back();
+	}
+
+	sprite->m_draw_dirty_num = -1;
+}
+
+void cSprite_Manager :: Update_Valid_Draw( cSprite *sprite )
+{
+	sprite->m_valid_draw = sprite->Is_Draw_Valid();
+
+	if( sprite->m_valid_draw != sprite->m_draw_listed )
+	{
+		// removed with the next visible objects update
+		if( sprite->m_valid_draw )
+		{
+			sprite->m_draw_listed = 1;
+			Sprite_List_Push( m_visible_objects, sprite, &cSprite::m_visible_num );
+		}
+
+		m_visible_changed = 1;
+	}
+
+	// the rect sizes could be negative
+	const GL_rect &rect = sprite->m_rect;
+	const GL_rect &col_rect = sprite->m_col_rect;
+	const float x1 = rect.m_w < 0.0f ? rect.m_x + rect.m_w : rect.m_x;
+	const float x2 = rect.m_w < 0.0f ? rect.m_x : rect.m_x + rect.m_w;
+	const float y1 = rect.m_h < 0.0f ? rect.m_y + rect.m_h : rect.m_y;
+	const float y2 = rect.m_h < 0.0f ? rect.m_y : rect.m_y + rect.m_h;
+	const float col_x1 = col_rect.m_w < 0.0f ? col_rect.m_x + col_rect.m_w : col_rect.m_x;
+	const float col_x2 = col_rect.m_w < 0.0f ? col_rect.m_x : col_rect.m_x + col_rect.m_w;
+	const float col_y1 = col_rect.m_h < 0.0f ? col_rect.m_y + col_rect.m_h : col_rect.m_y;
+	const float col_y2 = col_rect.m_h < 0.0f ? col_rect.m_y : col_rect.m_y + col_rect.m_h;
+
+	// not reduced again until all objects are deleted
+	m_draw_margin = std::max( m_draw_margin, std::max( std::max( col_x1 - x1, x2 - col_x2 ), std::max( col_y1 - y1, y2 - col_y2 ) ) );
+}
+
+// removed or not valid for drawing
+static bool Is_Visible_Removed( cSprite *obj )
+{
+	if( !obj )
+	{
+		return 1;
+	}
+
+	if( !obj->m_valid_draw )
+	{
+		obj->m_draw_listed = 0;
+		return 1;
+	}
+
+	return 0;
+}
+
+void cSprite_Manager :: Update_Visible_Objects( void )
+{
+	// changed since the last drawing validation update
+	for( unsigned int i = 0; i < m_draw_dirty_objects.size(); i++ )
+	{
+		cSprite *obj = m_draw_dirty_objects[i];
+
+		obj->m_draw_dirty = 0;
+		Update_Valid_Draw( obj );
+	}
+
+	m_draw_dirty_objects.clear();
+
+	if( !m_visible_changed )
+	{
+		return;
+	}
+
+	m_visible_objects.erase( std::remove_if( m_visible_objects.begin(), m_visible_objects.end(), Is_Visible_Removed ), m_visible_objects.end() );
+	// added and moved objects
+	std::sort( m_visible_objects.begin(), m_visible_objects.end(), array_num_sort() );
+	Sprite_List_Set_Nums( m_visible_objects, &cSprite::m_visible_num );
+
+	m_visible_changed = 0;
+}
+
+void cSprite_Manager :: Remove_Visible( cSprite *sprite )
+{
+	if( !sprite->m_draw_listed )
+	{
+		return;
+	}
+
+	sprite->m_draw_listed = 0;
+
+	// set to NULL as the list could be in use
+	if( Sprite_List_Is_At( m_visible_objects, sprite, &cSprite::m_visible_num ) )
+	{
+		m_visible_objects[sprite->m_visible_num] = NULL;
+		m_visible_changed = 1;
+	}
+
+	sprite->m_visible_num = -1;
+}
+
+void cSprite_Manager :: Add_Identifier( cSprite *sprite )
+{
+	sprite->m_index_name_id = Get_String_Table().Get_Id( sprite->Get_Identifier() );
+
+	if( !sprite->m_index_name_id )
+	{
+		return;
+	}
+
+	m_identifiers[Identifier_Key( sprite->m_index_type, sprite->m_index_name_id )].push_back( sprite );
+}
+
+void cSprite_Manager :: Remove_Identifier( cSprite *sprite )
+{
+	if( !sprite->m_index_name_id )
+	{
+		return;
+	}
+
+	Identifier_Map::iterator found = m_identifiers.find( Identifier_Key( sprite->m_index_type, sprite->m_index_name_id ) );
+	sprite->m_index_name_id = 0;
+
+	if( found == m_identifiers.end() )
+	{
+		return;
+	}
+
+	cSprite_List &named_objects = found->second;
+	cSprite_List::iterator itr = std::find( named_objects.begin(), named_objects.end(), sprite );
+
+	if( itr != named_objects.end() )
+	{
+		named_objects.erase( itr );
+	}
+
+	if( named_objects.empty() )
+	{
+		m_identifiers.erase( found );
+	}
+}
+
+void cSprite_Manager :: Gather_Static_Objects( void )
+{
+	m_static_gather_count = 0;
+	m_static_gather_valid = 0;
+
+	if( !pCollision_Workers )
+	{
+		return;
+	}
+
+	// needed before gathering
+	m_grid.Update_Static_Sprites();
+
+	for( cSprite_List::const_iterator itr = m_awake_objects.begin(); itr != m_awake_objects.end(); ++itr )
+	{
+		cSprite *obj = (*itr);
+
+		// deleted or destroyed
+		if( !obj || obj->m_auto_destroy )
+		{
+			continue;
+		}
+
+		cMovingSprite *moving_sprite = dynamic_cast<cMovingSprite *>(obj);
+
+		// not moving
+		if( !moving_sprite )
+		{
+			continue;
+		}
+
+		GL_rect rect;
+
+		if( !moving_sprite->Get_Collide_Move_Rect( rect ) )
+		{
+			continue;
+		}
+
+		// keeps the object lists capacity
+		if( m_static_gather_count >= m_static_gathers.size() )
+		{
+			m_static_gathers.push_back( cSprite_Grid::Static_Gather() );
+		}
+
+		cSprite_Grid::Static_Gather &static_gather = m_static_gathers[m_static_gather_count];
+		static_gather.m_sprite = obj;
+		static_gather.m_rect = rect;
+		static_gather.m_layer_mask = moving_sprite->m_col_layer_mask;
+		obj->m_static_gather_num = m_static_gather_count;
+		m_static_gather_count++;
+	}
+
+	if( !m_static_gather_count )
+	{
+		return;
+	}
+
+	pCollision_Workers->Gather( &m_grid, &m_static_gathers[0], m_static_gather_count );
+
+	m_static_gather_version = m_grid.Get_Static_Version();
+	m_static_gather_valid = 1;
+}
+
+const cSprite_Grid::Static_Gather *cSprite_Manager :: Get_Static_Gather( const cSprite *sprite, const GL_rect &rect ) const
+{
+	// not gathered or a static sprite changed
+	if( !m_static_gather_valid || !sprite || m_static_gather_version != m_grid.Get_Static_Version() )
+	{
+		return NULL;
+	}
+
+	const int num = sprite->m_static_gather_num;
+
+	if( num < 0 || static_cast<unsigned int>(num) >= m_static_gather_count || m_static_gathers[num].m_sprite != sprite )
+	{
+		return NULL;
+	}
+
+	const cSprite_Grid::Static_Gather &static_gather = m_static_gathers[num];
+	const GL_rect &gather_rect = static_gather.m_rect;
+
+	// not inside
+	if( rect.m_x < gather_rect.m_x || rect.m_y < gather_rect.m_y || rect.m_x + rect.m_w > gather_rect.m_x + gather_rect.m_w || rect.m_y + rect.m_h > gather_rect.m_y + gather_rect.m_h )
+	{
+		return NULL;
+	}
+
+	return &static_gather;
+}
+
+void cSprite_Manager :: Update_Array_Nums( unsigned int start /* = 0 */ )
+{
+	for( unsigned int i = start; i < objects.size(); i++ )
+	{
+		objects[i]->m_array_num = i;
 	}
 
-	return count;
+	// the visible objects are drawn in the array order
+	m_visible_changed = 1;
 }
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
@@ -19,10 +19,19 @@
 #include "../core/global_game.h"
 #include "../core/obj_manager.h"
 #include "../objects/movingsprite.h"
+#include "../core/static_chunk_cache.h"
+#include "../core/sprite_grid.h"
+#include "../core/editor_grid.h"
+#include "../core/object_profiler.h"
+// boost
+#include <boost/unordered_map.hpp>
 
 namespace SMC
 {
 
+class cPath_State;
+class cRender_Capture;
+
 /* *** *** *** *** *** cSprite_Manager *** *** *** *** *** *** *** *** *** *** *** *** */
 
 class cSprite_Manager : public cObject_Manager<cSprite>
@@ -32,8 +41,28 @@ public:
 	virtual ~cSprite_Manager( void );
 
 	/* Add a sprite
+	 * sprites added while the objects are updated or their collisions handled
+	 * are kept in the spawn queue and added after the pass
 	 */
 	virtual void Add( cSprite *sprite );
+	// Delete the object from given array number
+	virtual bool Delete( size_t array_num, bool delete_data = 1 );
+	// Delete the given object
+	virtual bool Delete( cSprite *obj, bool delete_data = 1 );
+	/* Add the sprites at the end of the array in the list order
+	 * the indexes are updated in one pass and destroyed objects are not replaced
+	*/
+	void Add_Objects( const cSprite_List &sprites );
+	/* Delete the given objects which must be in the list only once
+	 * the array and the lists are compacted once for all objects
+	*/
+	void Delete_Objects( const cSprite_List &sprites, bool delete_data = 1 );
+
+	/* Return the object array number
+	 * uses the array number stored in the sprite
+	 * if not found returns -1
+	*/
+	int Get_Array_Num( cSprite *obj ) const;
 
 	// Return a sprite copy
 	cSprite *Copy( unsigned int identifier );
@@ -51,12 +80,74 @@ public:
 	 * this also sets the z position
 	*/
 	void Move_To_Back( cSprite *sprite );
+	/* Move the sprite to the array number and set the z position
+	 * restores the position from before Move_To_Front or Move_To_Back
+	*/
+	void Move_To_Array_Num( cSprite *sprite, unsigned int array_num, float pos_z );
 
 	/* Delete all objects
 	 * if delayed is set deletion will only occur if replaced
 	 */
 	virtual void Delete_All( bool delayed = 0 );
 
+	/* Set that an object was destroyed and can be deleted
+	 * its array position can be reused by the next added object
+	*/
+	inline void Set_Has_Destroyed( cSprite *sprite )
+	{
+		m_has_destroyed = 1;
+		m_destroyed_objects.push_back( sprite );
+	}
+	/* Delete the destroyed objects in one pass if any
+	 * and the collisions of the other objects with them
+	 * must not be called while the objects are updated or their collisions handled
+	*/
+	void Delete_Destroyed( void );
+	/* Add the sprites kept in the spawn queue in the order they were added
+	 * called after the update and collision passes
+	*/
+	void Add_Spawned( void );
+
+	/* Return the objects of the given type
+	 * the order is undefined and destroyed objects are included
+	*/
+	const cSprite_List &Get_Type_Objects( const SpriteType type ) const;
+	/* Return the objects of the given array
+	 * the order is undefined and destroyed objects are included
+	*/
+	const cSprite_List &Get_Array_Objects( const ArrayType sprite_array ) const;
+	/* Update the type and array lists of the sprite
+	 * must be called if the type or array changed after it was added
+	*/
+	void Update_Type( cSprite *sprite );
+
+	/* Return the first object in array order with the given type and identifier
+	 * destroyed objects are ignored and if not found returns NULL
+	*/
+	cSprite *Get_Named_Object( const SpriteType type, const std::string &identifier ) const;
+	/* Update the identifier registry with the current identifier of the sprite
+	 * must be called if the identifier changed after it was added
+	*/
+	void Update_Identifier( cSprite *sprite );
+
+	/* Add a path state waiting for a not existing path with its path identifier
+	 * the path links it when it gets the identifier
+	*/
+	void Add_Waiting_Path_State( cPath_State *path_state );
+	// Remove the path state from the waiting path states
+	void Remove_Waiting_Path_State( cPath_State *path_state );
+	// Get the path states waiting for a path with the given identifier
+	void Get_Waiting_Path_States( const std::string &identifier, vector<cPath_State *> &path_states ) const;
+
+	/* Set the player detection rect of the sprite
+	 * all rects are checked against the player in one pass with every Update_Items
+	 * and the sprite gets Handle_Trigger_Enter and Handle_Trigger_Leave if the player entered or left it
+	 * the sprite must remove it before it is deleted
+	*/
+	void Set_Trigger( cSprite *sprite, const GL_rect &rect );
+	// Remove the player detection rect of the sprite
+	void Remove_Trigger( const cSprite *sprite );
+
 	// Return the first z position object from the given type
 	cSprite *Get_First( const SpriteType type ) const;
 	// Return the last z position object from the given type
@@ -68,47 +159,142 @@ public:
 	*/
 	cSprite *Get_from_Position( int start_pos_x, int start_pos_y, const SpriteType type = TYPE_UNDEFINED, int check_pos = 0 ) const;
 
-	/* Get a sorted Objects Array
+	/* Get the objects sorted by the z position
 	 * editor_sort : if set sorts from editor z pos
-	 * with_player : include player
+	 * the list is created with the first use and then only updated with the changes
+	 * and is valid until the objects change
 	*/
-	void Get_Objects_sorted( cSprite_List &new_objects, bool editor_sort = 0, bool with_player = 0 ) const;
+	const cSprite_List &Get_Objects_sorted( bool editor_sort = 0 );
 	/* Get objects colliding with the given rectangle
 	 * with_player : include player in check
 	 * exclude_sprite : exclude the given sprite from check
+	 * layer_mask : only objects in these collision layers are checked
 	*/
-	void Get_Colliding_Objects( cSprite_List &col_objects, const GL_rect &rect, bool with_player = 0, const cSprite *exclude_sprite = NULL ) const;
-
-	// Update items drawing validation
-	inline void Update_Items_Valid_Draw( void )
+	void Get_Colliding_Objects( cSprite_List &col_objects, const GL_rect &rect, bool with_player = 0, const cSprite *exclude_sprite = NULL, Uint32 layer_mask = COL_LAYER_ALL ) const;
+	/* Get the objects near the given rectangle from the collision grid
+	 * in array order but the collision rects are not checked
+	 * layer_mask : only objects in these collision layers are added
+	*/
+	void Get_Grid_Objects( cSprite_List &grid_objects, const GL_rect &rect, Uint32 layer_mask = COL_LAYER_ALL ) const;
+	/* Returns the collision query version
+	 * changes with every Update_Items and if an object is added, removed or changes its collision layer
+	 * grid objects gathered with the same version are still the valid candidates of their rect
+	*/
+	inline Uint64 Get_Query_Version( void ) const
 	{
-		for( cSprite_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
-		{
-			(*itr)->Update_Valid_Draw();
-		}
+		return ( static_cast<Uint64>(m_update_count) << 32 ) | m_grid.Get_Sprites_Version();
 	}
-	// Update items
-	inline void Update_Items( void )
+	/* Get the objects near the given rectangle from the editor grid
+	 * in array order but the start rects and rects are not checked
+	 * the grid is built again if sprites changed outside of the editor
+	*/
+	void Get_Editor_Objects( cSprite_List &editor_objects, const GL_rect &rect );
+
+	/* Start moving many objects at once
+	 * the grid updates of the moved objects are delayed until the batch update ends
+	 * no objects should be deleted until then
+	*/
+	void Begin_Batch_Update( void );
+	// End moving many objects and update the grids of every moved object once
+	void End_Batch_Update( void );
+	/* Add the object to the grid updates of the batch update
+	 * returns false if no batch update is active
+	*/
+	bool Defer_Grid_Update( cSprite *sprite );
+
+	/* Update the given sleeping sprite again
+	 * used if something changed that could need an update
+	*/
+	void Wake_Up( cSprite *sprite );
+	/* Load the unloaded textures of the objects in the rect and mark them as used
+	 * used with the predicted camera rect so they are ready when they become visible
+	*/
+	void Warm_Up( const GL_rect &rect );
+
+	/* Update items drawing validation
+	 * only checks the changed objects and the objects near the screen edges if the camera moved
+	 * and all objects if the editor, debug, mouse object or ghost state changed
+	*/
+	void Update_Items_Valid_Draw( void );
+	/* Set the object drawing validation to be updated with the next Update_Items_Valid_Draw
+	 * returns false if it is not in the objects
+	*/
+	bool Set_Draw_Dirty( cSprite *sprite );
+	/* Update items
+	 * following objects which can be updated in parallel are updated with the update workers
+	 * except if the object costs are measured
+	*/
+	void Update_Items( void );
+	/* Save the positions of all objects before the fixed timestep tick
+	 * sleeping objects are included as they can be woken up in the tick
+	*/
+	void Save_Tick_Positions( Uint32 tick );
+	// Update_Late items
+	inline void Update_Items_Late( void )
 	{
-		for( cSprite_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+		for( unsigned int i = 0; i < m_awake_objects.size(); i++ )
 		{
-			(*itr)->Update();
+			cSprite *obj = m_awake_objects[i];
+
+			// deleted
+			if( !obj )
+			{
+				continue;
+			}
+
+			cObject_Profiler_Scope profile_scope( obj, cObject_Profiler::PHASE_UPDATE_LATE );
+			obj->Update_Late();
 		}
 	}
-	// Update_Late items
-	inline void Update_Items_Late( void )
+	/* Draw items
+	 * only the visible objects are drawn in the array order
+	 * following objects which can be drawn in parallel are drawn with the task pool
+	*/
+	inline void Draw_Items( void )
 	{
-		for( cSprite_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+		Update_Visible_Objects();
+
+		// static sprites are drawn from chunks
+		const bool static_chunks = m_static_chunks && m_static_chunks->Draw();
+
+		// objects removed while drawing are set to NULL
+		for( unsigned int i = 0; i < m_visible_objects.size(); )
 		{
-			(*itr)->Update_Late();
+			cSprite *obj = m_visible_objects[i];
+
+			if( !obj || ( static_chunks && obj->m_static_chunk ) )
+			{
+				i++;
+				continue;
+			}
+
+			if( obj->Is_Draw_Parallel() )
+			{
+				i = Draw_Parallel( i, static_chunks );
+				continue;
+			}
+
+			cObject_Profiler_Scope profile_scope( obj, cObject_Profiler::PHASE_DRAW );
+			obj->Draw();
+			i++;
 		}
 	}
-	// Draw items
-	inline void Draw_Items( void )
+
+	/* Set the engine context used by the objects
+	 * if NULL the default context with the global objects is used
+	*/
+	void Set_Context( cEngine_Context *context );
+
+	/* Enable drawing the static sprites from pre-built chunks
+	 * speeds up the drawing of levels with many sprites
+	*/
+	void Set_Static_Chunks( bool enable );
+	// Check the static sprites for changes before the next drawing
+	inline void Invalidate_Static_Chunks( void )
 	{
-		for( cSprite_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+		if( m_static_chunks )
 		{
-			(*itr)->Draw();
+			m_static_chunks->Invalidate();
 		}
 	}
 
@@ -119,7 +305,7 @@ public:
 	/* Return the current size
 	 * of the specified sprite array
 	 */
-	unsigned int Get_Size_Array( const ArrayType sprite_array );
+	unsigned int Get_Size_Array( const ArrayType sprite_array ) const;
 
 	// Return object pointer if found
 	cSprite *operator [] ( unsigned int identifier )
@@ -127,6 +313,124 @@ public:
 		return Get_Pointer( identifier );
 	}
 
+	// engine context of the objects
+	cEngine_Context *m_context;
+	// static sprite chunks or NULL if disabled
+	cStatic_Chunk_Cache *m_static_chunks;
+	/* time in milliseconds of the shared sprite animations
+	 * advanced once with every Update_Items
+	*/
+	Uint32 m_animation_time;
+	// increased with every Update_Items
+	Uint32 m_update_count;
+	/* objects which are not sleeping in array order
+	 * deleted objects are set to NULL until the list is created again
+	*/
+	cSprite_List m_awake_objects;
+	// sleeping objects which are checked every frame if they need to wake up
+	cSprite_List m_sleeping_objects;
+	// if set the awake objects need to be created again
+	bool m_awake_changed;
+	// if set objects may be destroyed
+	bool m_has_destroyed;
+	/* destroyed objects which can be replaced by an added object
+	 * could also be replaced or removed already
+	*/
+	cSprite_List m_destroyed_objects;
+	/* sprites added while a pass iterates the objects
+	 * the capacity is kept so adding does not allocate in a frame
+	*/
+	cSprite_List m_spawn_queue;
+	// if set added sprites are kept in the spawn queue
+	bool m_defer_spawns;
+	/* static objects near the moving objects
+	 * gathered with several threads before the collision handling
+	*/
+	vector<cSprite_Grid::Static_Gather> m_static_gathers;
+	// used static gathers
+	unsigned int m_static_gather_count;
+	// grid static version of the gathering
+	unsigned int m_static_gather_version;
+	// if set the static gathers can be used
+	bool m_static_gather_valid;
+	// collision grid with all objects
+	mutable cSprite_Grid m_grid;
+	// editor picking grid with all objects
+	cEditor_Grid m_editor_grid;
+	// objects of every type and array indexed by the type or array
+	vector<cSprite_List> m_type_objects;
+	vector<cSprite_List> m_array_objects;
+	// returned for types without objects
+	cSprite_List m_no_objects;
+	// objects of the current parallel update
+	cSprite_List m_parallel_objects;
+	/* requests of the parallel drawing tasks
+	 * kept to reuse their command memory
+	*/
+	vector<cRender_Capture *> m_draw_captures;
+	// task group of the parallel drawing or 0 if not created yet
+	unsigned int m_draw_task_group;
+
+	/* Draw the visible objects from the given one which can be drawn in parallel
+	 * their requests are added in the array order so the rendering is the same as drawing them one after another
+	 * returns the next not drawn visible object
+	*/
+	unsigned int Draw_Parallel( unsigned int start, bool static_chunks );
+	// objects in z position and editor z position order if used
+	cSprite_List m_zpos_objects;
+	cSprite_List m_editor_zpos_objects;
+	bool m_zpos_used;
+	bool m_editor_zpos_used;
+
+	// state the drawing validation of all objects depends on
+	struct Draw_State
+	{
+		float m_camera_x;
+		float m_camera_y;
+		int m_res_w;
+		int m_res_h;
+		bool m_editor;
+		bool m_debug;
+		const cSprite *m_mouse_object;
+		bool m_ghost;
+	};
+	// state of the last drawing validation update
+	Draw_State m_draw_state;
+	// if set the draw state is from an update
+	bool m_draw_state_valid;
+	// objects with a changed drawing validation
+	cSprite_List m_draw_dirty_objects;
+	/* objects valid for drawing in the array order
+	 * can contain objects which became invalid since the last drawing
+	*/
+	cSprite_List m_visible_objects;
+	// if the visible objects need to be sorted or contain invalid objects
+	bool m_visible_changed;
+	// nesting depth of the batch update
+	unsigned int m_batch_depth;
+	// objects moved in the batch update which can be added more than once
+	cSprite_List m_batch_objects;
+	// maximum distance of an image rect outside of the collision rect
+	float m_draw_margin;
+	// objects with an identifier by type and string table number of the identifier
+	typedef std::pair<int, unsigned int> Identifier_Key;
+	typedef boost::unordered_map<Identifier_Key, cSprite_List> Identifier_Map;
+	Identifier_Map m_identifiers;
+	// path states by the path identifier they wait for
+	typedef boost::unordered_map<std::string, vector<cPath_State *> > Path_State_Map;
+	Path_State_Map m_waiting_path_states;
+
+	// player detection rect of a sprite
+	struct Trigger
+	{
+		cSprite *m_sprite;
+		GL_rect m_rect;
+		// if the player was inside with the last check
+		bool m_inside;
+	};
+	typedef vector<Trigger> Trigger_List;
+	Trigger_List m_triggers;
+
 	typedef vector<float> ZposList;
 	// biggest type z position
 	ZposList m_z_pos_data;
@@ -142,6 +446,24 @@ public:
 		}
 	};
 
+	// objects removed from the array
+	struct not_in_array
+	{
+		bool operator()( const cSprite *obj ) const
+		{
+			return obj && obj->m_array_num < 0;
+		}
+	};
+
+	// array number sort
+	struct array_num_sort
+	{
+		bool operator()( const cSprite *a, const cSprite *b ) const
+		{
+			return a->m_array_num < b->m_array_num;
+		}
+	};
+
 	// Editor Z position sort
 	struct editor_zpos_sort
 	{
@@ -171,6 +493,58 @@ public:
 			return a->m_editor_pos_z < b->m_editor_pos_z;
 		}
 	};
+
+private:
+	// Set the array number of the objects from the given position
+	void Update_Array_Nums( unsigned int start = 0 );
+	// Wake up the sleeping objects if needed and create the awake objects list again if changed
+	void Update_Sleeping( void );
+	// Put the awake objects to sleep if valid
+	void Update_Awake( void );
+	/* Check the player against the detection rects and send the enter and leave events
+	 * the event handlers must not set or remove detection rects
+	*/
+	void Update_Triggers( void );
+	// Remove the deleted and sleeping objects from the awake objects list and sort it in array order
+	void Update_Awake_Objects( void );
+	// Remove the object from the awake or sleeping objects list
+	void Remove_Awake( cSprite *sprite );
+	// Set the list positions of all objects after lists were changed at once
+	void Update_List_Nums( void );
+	// Returns true if the object is in the type and array lists
+	bool Is_Type_Indexed( const cSprite *sprite ) const;
+	// Add the object to the type and array lists
+	void Add_Type( cSprite *sprite );
+	// Remove the object from the type and array lists
+	void Remove_Type( cSprite *sprite );
+	// Add the object to the used z position order lists
+	void Add_Zpos( cSprite *sprite );
+	// Remove the object from the used z position order lists
+	void Remove_Zpos( cSprite *sprite );
+	/* Put the object at the position of the replaced one in the used z position order lists
+	 * the order is repaired when the list is used
+	*/
+	void Replace_Zpos( cSprite *old_sprite, cSprite *sprite );
+	// Remove the object from the changed drawing validation objects
+	void Remove_Draw_Dirty( cSprite *sprite );
+	// Update the drawing validation of the object and add it to the visible objects if valid
+	void Update_Valid_Draw( cSprite *sprite );
+	/* Update the drawing validation of the changed objects
+	 * and remove the invalid objects from the visible objects
+	*/
+	void Update_Visible_Objects( void );
+	// Remove the object from the visible objects
+	void Remove_Visible( cSprite *sprite );
+	// Add the object to the identifier registry if it has an identifier
+	void Add_Identifier( cSprite *sprite );
+	// Remove the object from the identifier registry
+	void Remove_Identifier( cSprite *sprite );
+	// Gather the static objects for the collision handling of the moving objects
+	void Gather_Static_Objects( void );
+	/* Returns the static objects gathered for the sprite
+	 * if not available or the rect is not inside the gathered rect returns NULL
+	*/
+	const cSprite_Grid::Static_Gather *Get_Static_Gather( const cSprite *sprite, const GL_rect &rect ) const;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
@@ -0,0 +1,572 @@
+/***************************************************************************
+ * static_chunk_cache.cpp  -  pre-built drawing data of non-moving sprites
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/static_chunk_cache.h"
+#include "../core/sprite_manager.h"
+#include "../core/game_core.h"
+#include "../core/camera.h"
+#include "../core/math/utilities.h"
+#include "../video/img_manager.h"
+#include "../video/video.h"
+#include <algorithm>
+
+namespace SMC
+{
+
+// passive, halfmassive, climbable, massive and front passive
+static const unsigned int static_chunk_layers = 5;
+
+/* *** *** *** *** *** *** cStatic_Chunk *** *** *** *** *** *** *** *** *** *** *** */
+
+cStatic_Chunk :: cStatic_Chunk( void )
+{
+	m_layers.assign( static_chunk_layers, NULL );
+	m_dirty = 1;
+}
+
+cStatic_Chunk :: ~cStatic_Chunk( void )
+{
+	// geometry is deleted by the cache
+}
+
+/* *** *** *** *** *** *** cStatic_Chunk_Cache *** *** *** *** *** *** *** *** *** *** *** */
+
+cStatic_Chunk_Cache :: cStatic_Chunk_Cache( cSprite_Manager *sprite_manager )
+{
+	m_sprite_manager = sprite_manager;
+
+	m_drawn_chunks = 0;
+	m_built_chunks = 0;
+
+	m_check = 1;
+	m_editor_enabled = 0;
+	m_texture_generation = 0;
+
+	m_grid_x = 0;
+	m_grid_y = 0;
+	m_grid_w = 0;
+	m_grid_h = 0;
+	m_chunk_w = 0.0f;
+	m_chunk_h = 0.0f;
+}
+
+cStatic_Chunk_Cache :: ~cStatic_Chunk_Cache( void )
+{
+	Clear();
+}
+
+bool cStatic_Chunk_Cache :: Draw( void )
+{
+	m_drawn_chunks = 0;
+
+	// collision rects are drawn with each sprite
+	if( game_debug )
+	{
+		return 0;
+	}
+
+	// the render thread finished using these
+	for( Geometry_List::iterator itr = m_retired_old.begin(); itr != m_retired_old.end(); ++itr )
+	{
+		delete (*itr);
+	}
+
+	m_retired_old.clear();
+	m_retired_old.swap( m_retired );
+
+	// the editor can change everything
+	if( m_check || editor_enabled || m_editor_enabled != editor_enabled || m_texture_generation != pImage_Manager->m_texture_generation ||
+		!Is_Float_Equal( m_chunk_w, static_cast<float>(game_res_w) ) || !Is_Float_Equal( m_chunk_h, static_cast<float>(game_res_h) ) )
+	{
+		m_editor_enabled = editor_enabled;
+		m_texture_generation = pImage_Manager->m_texture_generation;
+		Update();
+	}
+
+	// the cached geometry keeps using the textures
+	for( Static_Sprite_List::const_iterator itr = m_sprites.begin(); itr != m_sprites.end(); ++itr )
+	{
+		if( (*itr).m_visible )
+		{
+			(*itr).m_surface->m_last_use = pImage_Manager->m_frame;
+		}
+	}
+
+	// visible area
+	const GL_rect camera_rect( pActive_Camera->m_x, pActive_Camera->m_y, static_cast<float>(game_res_w), static_cast<float>(game_res_h) );
+
+	for( Static_Chunk_List::iterator itr = m_chunks.begin(); itr != m_chunks.end(); ++itr )
+	{
+		cStatic_Chunk *chunk = (*itr);
+
+		if( !chunk )
+		{
+			continue;
+		}
+
+		bool drawn = 0;
+
+		for( cStatic_Chunk::Geometry_List::iterator layer_itr = chunk->m_layers.begin(); layer_itr != chunk->m_layers.end(); ++layer_itr )
+		{
+			cStatic_Geometry *geometry = (*layer_itr);
+
+			if( !geometry || !geometry->m_quad_count || !camera_rect.Intersects( geometry->m_rect ) )
+			{
+				continue;
+			}
+
+			// create request
+			cStatic_Geometry_Request *request = new cStatic_Geometry_Request();
+			request->m_geometry = geometry;
+			request->m_pos_z = geometry->m_pos_z;
+			// add request
+			pRenderer->Add( request );
+
+			drawn = 1;
+		}
+
+		if( drawn )
+		{
+			m_drawn_chunks++;
+		}
+	}
+
+	return 1;
+}
+
+void cStatic_Chunk_Cache :: Invalidate( void )
+{
+	m_check = 1;
+}
+
+void cStatic_Chunk_Cache :: Clear( void )
+{
+	// geometry could still be used by the render thread
+	if( pVideo )
+	{
+		pVideo->Render_Finish();
+	}
+
+	Clear_Grid();
+
+	for( Geometry_List::iterator itr = m_retired.begin(); itr != m_retired.end(); ++itr )
+	{
+		delete (*itr);
+	}
+
+	m_retired.clear();
+
+	for( Geometry_List::iterator itr = m_retired_old.begin(); itr != m_retired_old.end(); ++itr )
+	{
+		delete (*itr);
+	}
+
+	m_retired_old.clear();
+
+	m_sprites.clear();
+	m_sprites_new.clear();
+	m_check = 1;
+}
+
+bool cStatic_Chunk_Cache :: Is_Static_Sprite( const cSprite *obj ) const
+{
+	// only basic sprites are never moved by the game
+	if( !obj->Is_Basic_Sprite() )
+	{
+		return 0;
+	}
+
+	// not in the world
+	if( obj->m_no_camera )
+	{
+		return 0;
+	}
+
+	// removed again
+	if( obj->m_spawned )
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+void cStatic_Chunk_Cache :: Update( void )
+{
+	m_check = 0;
+
+	// the chunks are screen sized
+	bool rebuild_all = !Is_Float_Equal( m_chunk_w, static_cast<float>(game_res_w) ) || !Is_Float_Equal( m_chunk_h, static_cast<float>(game_res_h) );
+
+	// get the current drawing data
+	m_sprites_new.clear();
+
+	for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+	{
+		cSprite *obj = (*itr);
+
+		obj->m_static_chunk = 0;
+
+		if( !Is_Static_Sprite( obj ) )
+		{
+			continue;
+		}
+
+		Static_Sprite data;
+		data.m_sprite = obj;
+		data.m_surface = editor_enabled ? obj->m_start_image : obj->m_image;
+		data.m_visible = Get_Request( obj, data.m_request );
+
+		// rotation and shadow need the normal drawing
+		if( data.m_visible && ( !data.m_request.m_texture_id || !data.m_request.Is_Batchable() ) )
+		{
+			continue;
+		}
+
+		data.m_layer = Get_Layer( obj->m_type );
+		data.m_chunk = -1;
+
+		obj->m_static_chunk = 1;
+		m_sprites_new.push_back( data );
+	}
+
+	// sprites were added or removed
+	if( m_sprites_new.size() != m_sprites.size() )
+	{
+		rebuild_all = 1;
+	}
+
+	// find the changed chunks
+	if( !rebuild_all )
+	{
+		for( unsigned int i = 0; i < m_sprites_new.size(); i++ )
+		{
+			Static_Sprite &data = m_sprites_new[i];
+			const Static_Sprite &old_data = m_sprites[i];
+
+			// different order
+			if( data.m_sprite != old_data.m_sprite )
+			{
+				rebuild_all = 1;
+				break;
+			}
+
+			// unchanged
+			if( data.m_visible == old_data.m_visible && ( !data.m_visible || Is_Same_Request( data.m_request, old_data.m_request ) ) )
+			{
+				data.m_chunk = old_data.m_chunk;
+				continue;
+			}
+
+			// remove from the old chunk
+			if( old_data.m_visible )
+			{
+				m_chunks[old_data.m_chunk]->m_dirty = 1;
+			}
+
+			// add to the new chunk
+			if( data.m_visible )
+			{
+				data.m_chunk = Get_Chunk_Num( data.m_request );
+
+				// moved outside of the grid
+				if( data.m_chunk < 0 )
+				{
+					rebuild_all = 1;
+					break;
+				}
+
+				if( !m_chunks[data.m_chunk] )
+				{
+					m_chunks[data.m_chunk] = new cStatic_Chunk();
+				}
+
+				m_chunks[data.m_chunk]->m_dirty = 1;
+			}
+		}
+	}
+
+	// create a new grid
+	if( rebuild_all )
+	{
+		Clear_Grid();
+
+		m_chunk_w = static_cast<float>(game_res_w);
+		m_chunk_h = static_cast<float>(game_res_h);
+
+		bool first = 1;
+		int max_x = 0;
+		int max_y = 0;
+
+		for( Static_Sprite_List::iterator itr = m_sprites_new.begin(); itr != m_sprites_new.end(); ++itr )
+		{
+			const Static_Sprite &data = (*itr);
+
+			if( !data.m_visible )
+			{
+				continue;
+			}
+
+			const int x = static_cast<int>(floor( data.m_request.m_pos_x / m_chunk_w ));
+			const int y = static_cast<int>(floor( data.m_request.m_pos_y / m_chunk_h ));
+
+			if( first )
+			{
+				m_grid_x = x;
+				m_grid_y = y;
+				max_x = x;
+				max_y = y;
+				first = 0;
+				continue;
+			}
+
+			if( x < m_grid_x )
+			{
+				m_grid_x = x;
+			}
+			else if( x > max_x )
+			{
+				max_x = x;
+			}
+
+			if( y < m_grid_y )
+			{
+				m_grid_y = y;
+			}
+			else if( y > max_y )
+			{
+				max_y = y;
+			}
+		}
+
+		// no visible sprites
+		if( first )
+		{
+			m_grid_w = 0;
+			m_grid_h = 0;
+		}
+		else
+		{
+			m_grid_w = max_x - m_grid_x + 1;
+			m_grid_h = max_y - m_grid_y + 1;
+		}
+
+		m_chunks.assign( m_grid_w * m_grid_h, NULL );
+
+		for( Static_Sprite_List::iterator itr = m_sprites_new.begin(); itr != m_sprites_new.end(); ++itr )
+		{
+			Static_Sprite &data = (*itr);
+
+			if( !data.m_visible )
+			{
+				continue;
+			}
+
+			data.m_chunk = Get_Chunk_Num( data.m_request );
+
+			if( !m_chunks[data.m_chunk] )
+			{
+				m_chunks[data.m_chunk] = new cStatic_Chunk();
+			}
+		}
+	}
+
+	m_sprites.swap( m_sprites_new );
+	m_sprites_new.clear();
+
+	// collect the sprites of the changed chunks
+	for( unsigned int i = 0; i < m_sprites.size(); i++ )
+	{
+		const Static_Sprite &data = m_sprites[i];
+
+		if( !data.m_visible )
+		{
+			continue;
+		}
+
+		cStatic_Chunk *chunk = m_chunks[data.m_chunk];
+
+		if( chunk->m_dirty )
+		{
+			chunk->m_build_sprites.push_back( i );
+		}
+	}
+
+	// rebuild
+	for( Static_Chunk_List::iterator itr = m_chunks.begin(); itr != m_chunks.end(); ++itr )
+	{
+		cStatic_Chunk *chunk = (*itr);
+
+		if( chunk && chunk->m_dirty )
+		{
+			Build_Chunk( chunk );
+		}
+	}
+}
+
+void cStatic_Chunk_Cache :: Build_Chunk( cStatic_Chunk *chunk )
+{
+	Clear_Chunk( chunk );
+
+	// drawing order
+	std::sort( chunk->m_build_sprites.begin(), chunk->m_build_sprites.end(), zpos_sort( &m_sprites ) );
+
+	for( vector<unsigned int>::const_iterator itr = chunk->m_build_sprites.begin(); itr != chunk->m_build_sprites.end(); ++itr )
+	{
+		const Static_Sprite &data = m_sprites[(*itr)];
+		cStatic_Geometry *&geometry = chunk->m_layers[data.m_layer];
+
+		if( !geometry )
+		{
+			geometry = new cStatic_Geometry();
+		}
+
+		geometry->Add( &data.m_request );
+	}
+
+	chunk->m_build_sprites.clear();
+	chunk->m_dirty = 0;
+	m_built_chunks++;
+}
+
+void cStatic_Chunk_Cache :: Clear_Chunk( cStatic_Chunk *chunk )
+{
+	for( cStatic_Chunk::Geometry_List::iterator itr = chunk->m_layers.begin(); itr != chunk->m_layers.end(); ++itr )
+	{
+		if( (*itr) )
+		{
+			m_retired.push_back( (*itr) );
+			(*itr) = NULL;
+		}
+	}
+}
+
+void cStatic_Chunk_Cache :: Clear_Grid( void )
+{
+	for( Static_Chunk_List::iterator itr = m_chunks.begin(); itr != m_chunks.end(); ++itr )
+	{
+		cStatic_Chunk *chunk = (*itr);
+
+		if( !chunk )
+		{
+			continue;
+		}
+
+		Clear_Chunk( chunk );
+		delete chunk;
+	}
+
+	m_chunks.clear();
+	m_grid_x = 0;
+	m_grid_y = 0;
+	m_grid_w = 0;
+	m_grid_h = 0;
+}
+
+bool cStatic_Chunk_Cache :: Get_Request( const cSprite *obj, cSurface_Request &request ) const
+{
+	// same validation as the normal drawing without the screen check
+	if( editor_enabled )
+	{
+		if( obj->m_auto_destroy || !obj->m_start_image )
+		{
+			return 0;
+		}
+
+		obj->Draw_Image_Editor( &request );
+	}
+	else
+	{
+		if( !obj->m_active || !obj->m_image )
+		{
+			return 0;
+		}
+
+		obj->Draw_Image_Normal( &request );
+	}
+
+	// world coordinates
+	request.m_no_camera = 1;
+	request.m_global_scale = 0;
+
+	return 1;
+}
+
+bool cStatic_Chunk_Cache :: Is_Same_Request( const cSurface_Request &a, const cSurface_Request &b )
+{
+	if( a.m_texture_id != b.m_texture_id || a.m_tex_x1 != b.m_tex_x1 || a.m_tex_y1 != b.m_tex_y1 || a.m_tex_x2 != b.m_tex_x2 || a.m_tex_y2 != b.m_tex_y2 )
+	{
+		return 0;
+	}
+
+	if( a.m_pos_x != b.m_pos_x || a.m_pos_y != b.m_pos_y || a.m_pos_z != b.m_pos_z || a.m_w != b.m_w || a.m_h != b.m_h ||
+		a.m_scale_x != b.m_scale_x || a.m_scale_y != b.m_scale_y )
+	{
+		return 0;
+	}
+
+	if( a.m_rot_x != b.m_rot_x || a.m_rot_y != b.m_rot_y || a.m_rot_z != b.m_rot_z || a.m_shadow_pos != b.m_shadow_pos )
+	{
+		return 0;
+	}
+
+	if( a.m_color != b.m_color || a.m_blend_sfactor != b.m_blend_sfactor || a.m_blend_dfactor != b.m_blend_dfactor || a.m_combine_type != b.m_combine_type ||
+		a.m_combine_color[0] != b.m_combine_color[0] || a.m_combine_color[1] != b.m_combine_color[1] || a.m_combine_color[2] != b.m_combine_color[2] )
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+unsigned int cStatic_Chunk_Cache :: Get_Layer( SpriteType type )
+{
+	if( type == TYPE_PASSIVE )
+	{
+		return 0;
+	}
+	else if( type == TYPE_HALFMASSIVE )
+	{
+		return 1;
+	}
+	else if( type == TYPE_CLIMBABLE )
+	{
+		return 2;
+	}
+	else if( type == TYPE_MASSIVE )
+	{
+		return 3;
+	}
+
+	// front passive
+	return 4;
+}
+
+int cStatic_Chunk_Cache :: Get_Chunk_Num( const cSurface_Request &request ) const
+{
+	const int x = static_cast<int>(floor( request.m_pos_x / m_chunk_w )) - m_grid_x;
+	const int y = static_cast<int>(floor( request.m_pos_y / m_chunk_h )) - m_grid_y;
+
+	if( x < 0 || y < 0 || x >= m_grid_w || y >= m_grid_h )
+	{
+		return -1;
+	}
+
+	return y * m_grid_w + x;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,171 @@
+/***************************************************************************
+ * static_chunk_cache.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_STATIC_CHUNK_CACHE_H
+#define SMC_STATIC_CHUNK_CACHE_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../video/renderer.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** cStatic_Chunk *** *** *** *** *** *** *** *** *** *** *** */
+
+// A screen sized world area with the geometry of its static sprites
+class cStatic_Chunk
+{
+public:
+	cStatic_Chunk( void );
+	~cStatic_Chunk( void );
+
+	typedef vector<cStatic_Geometry *> Geometry_List;
+	// geometry for each sprite type layer
+	Geometry_List m_layers;
+	// if set the geometry needs to be rebuilt
+	bool m_dirty;
+	// static sprite numbers for the rebuild
+	vector<unsigned int> m_build_sprites;
+};
+
+typedef vector<cStatic_Chunk *> Static_Chunk_List;
+
+/* *** *** *** *** *** *** cStatic_Chunk_Cache *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Draws the non-moving basic sprites of a sprite manager from pre-built chunks
+ * instead of creating a request for every sprite each frame
+ * a chunk is only rebuilt if the drawing data of one of its sprites changed
+ * each sprite type is a separate layer to keep the z order with other objects
+*/
+class cStatic_Chunk_Cache
+{
+public:
+	cStatic_Chunk_Cache( cSprite_Manager *sprite_manager );
+	~cStatic_Chunk_Cache( void );
+
+	/* Add the requests of the visible chunks
+	 * updates the changed chunks first
+	 * returns false if the cache can not be used and all sprites need to be drawn normally
+	*/
+	bool Draw( void );
+
+	// Check the sprites for changes before the next drawing
+	void Invalidate( void );
+	// Delete all chunks
+	void Clear( void );
+
+	// Returns true if the sprite type never moves and is not animated
+	bool Is_Static_Sprite( const cSprite *obj ) const;
+
+	// chunks drawn in the last frame
+	unsigned int m_drawn_chunks;
+	// chunks rebuilt since the creation
+	unsigned int m_built_chunks;
+
+private:
+	// Check the sprites for changes and rebuild the changed chunks
+	void Update( void );
+	// Build the chunk geometry from its sprite list
+	void Build_Chunk( cStatic_Chunk *chunk );
+	// Retire the chunk geometry
+	void Clear_Chunk( cStatic_Chunk *chunk );
+	// Delete the chunks and retire their geometry
+	void Clear_Grid( void );
+
+	/* Set the sprite drawing data in world coordinates
+	 * returns false if the sprite is not drawn
+	*/
+	bool Get_Request( const cSprite *obj, cSurface_Request &request ) const;
+	// Returns true if the drawing data is the same
+	static bool Is_Same_Request( const cSurface_Request &a, const cSurface_Request &b );
+	// Returns the layer number for the sprite type
+	static unsigned int Get_Layer( SpriteType type );
+	/* Returns the grid chunk number for the request position
+	 * or -1 if outside of the grid
+	*/
+	int Get_Chunk_Num( const cSurface_Request &request ) const;
+
+	// sprite manager with the sprites
+	cSprite_Manager *m_sprite_manager;
+
+	// if set the sprites are checked for changes with the next drawing
+	bool m_check;
+	// editor state of the last update
+	bool m_editor_enabled;
+	// image manager texture generation of the last update
+	unsigned int m_texture_generation;
+
+	// a static sprite with its last drawing data
+	struct Static_Sprite
+	{
+		// only used for comparing
+		const cSprite *m_sprite;
+		// drawn image
+		const cGL_Surface *m_surface;
+		// drawing data in world coordinates
+		cSurface_Request m_request;
+		// if set the sprite is drawn
+		bool m_visible;
+		// sprite type layer
+		unsigned int m_layer;
+		// grid chunk number if visible
+		int m_chunk;
+	};
+
+	typedef vector<Static_Sprite> Static_Sprite_List;
+	// static sprites in sprite manager order
+	Static_Sprite_List m_sprites;
+	// buffer for the update
+	Static_Sprite_List m_sprites_new;
+
+	// chunk grid with NULL for empty areas
+	Static_Chunk_List m_chunks;
+	// first chunk position and grid size in chunks
+	int m_grid_x;
+	int m_grid_y;
+	int m_grid_w;
+	int m_grid_h;
+	// chunk size in world coordinates
+	float m_chunk_w;
+	float m_chunk_h;
+
+	typedef vector<cStatic_Geometry *> Geometry_List;
+	/* replaced geometry which could still be used by the render thread
+	 * it gets deleted after two more drawings
+	*/
+	Geometry_List m_retired;
+	Geometry_List m_retired_old;
+
+	// sorts static sprite numbers by z position
+	struct zpos_sort
+	{
+		zpos_sort( const Static_Sprite_List *sprites )
+		: m_sprites( sprites ) {};
+
+		bool operator()( unsigned int a, unsigned int b ) const
+		{
+			return (*m_sprites)[a].m_request.m_pos_z < (*m_sprites)[b].m_request.m_pos_z;
+		}
+
+		const Static_Sprite_List *m_sprites;
+	};
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
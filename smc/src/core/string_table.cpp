@@ -0,0 +1,115 @@
+/***************************************************************************
+ * string_table.cpp  -  strings stored once with a number
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/string_table.h"
+#include "../core/filesystem/filesystem.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cString_Table *** *** *** *** *** *** *** *** *** *** */
+
+cString_Table :: cString_Table( void )
+{
+	// the empty string is always 0
+	m_strings.push_back( std::string() );
+	m_ids[std::string()] = 0;
+}
+
+unsigned int cString_Table :: Get_Id( const std::string &str )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	Id_Map::const_iterator found = m_ids.find( str );
+
+	if( found != m_ids.end() )
+	{
+		return found->second;
+	}
+
+	const unsigned int id = static_cast<unsigned int>(m_strings.size());
+	m_strings.push_back( str );
+	m_ids[str] = id;
+
+	return id;
+}
+
+unsigned int cString_Table :: Get_Path_Id( const std::string &path )
+{
+	return Get_Id( Normalize_Path( path ) );
+}
+
+unsigned int cString_Table :: Find_Id( const std::string &str ) const
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	Id_Map::const_iterator found = m_ids.find( str );
+
+	if( found == m_ids.end() )
+	{
+		return 0;
+	}
+
+	return found->second;
+}
+
+const std::string &cString_Table :: Get_String( unsigned int id ) const
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	return m_strings[id];
+}
+
+std::string cString_Table :: Normalize_Path( const std::string &path )
+{
+	// usually already normalized
+	if( path.find( '\\' ) == std::string::npos && path.find( "//" ) == std::string::npos && path.find( "./" ) == std::string::npos )
+	{
+		return path;
+	}
+
+	std::string normalized = path;
+	Convert_Path_Separators( normalized );
+
+	std::string::size_type pos;
+
+	while( ( pos = normalized.find( "//" ) ) != std::string::npos )
+	{
+		normalized.erase( pos, 1 );
+	}
+
+	while( ( pos = normalized.find( "/./" ) ) != std::string::npos )
+	{
+		normalized.erase( pos, 2 );
+	}
+
+	if( normalized.compare( 0, 2, "./" ) == 0 )
+	{
+		normalized.erase( 0, 2 );
+	}
+
+	return normalized;
+}
+
+cString_Table &Get_String_Table( void )
+{
+	// created with the first use to not depend on the static initialization order
+	static cString_Table table;
+	return table;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,81 @@
+/***************************************************************************
+ * string_table.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_STRING_TABLE_H
+#define SMC_STRING_TABLE_H
+
+#include "../core/global_basic.h"
+// boost
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
+// std
+#include <deque>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cString_Table *** *** *** *** *** *** *** *** *** *** */
+
+/* Stores each distinct string once and gives it a number
+ * the numbers and stored strings stay valid until the program exits
+ * so equal strings can be compared by their number
+ * the empty string has the number 0
+ * can be used from several threads
+*/
+class cString_Table
+{
+public:
+	cString_Table( void );
+
+	// Returns the number of the string and adds it if new
+	unsigned int Get_Id( const std::string &str );
+	// Returns the number of the normalized path and adds it if new
+	unsigned int Get_Path_Id( const std::string &path );
+	/* Returns the number of the string
+	 * returns 0 if it was never added and no object can be using it
+	*/
+	unsigned int Find_Id( const std::string &str ) const;
+	// Returns the stored string of the number
+	const std::string &Get_String( unsigned int id ) const;
+	// Returns the stored string equal to the given string and adds it if new
+	inline const std::string &Intern( const std::string &str )
+	{
+		return Get_String( Get_Id( str ) );
+	}
+
+	/* Returns the path with "/" separators and without empty or "." directories
+	 * the case is kept as the file systems can be case sensitive
+	*/
+	static std::string Normalize_Path( const std::string &path );
+
+private:
+	typedef boost::unordered_map<std::string, unsigned int> Id_Map;
+	// numbers by string
+	Id_Map m_ids;
+	// strings by number which are never moved
+	std::deque<std::string> m_strings;
+
+	// protects the strings
+	mutable boost::mutex m_mutex;
+};
+
+// Returns the string table which is created with the first use
+cString_Table &Get_String_Table( void );
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -0,0 +1,456 @@
+/***************************************************************************
+ * task_pool.cpp  -  worker threads shared by the subsystems
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/task_pool.h"
+#include "../core/profiler.h"
+// boost
+#include <boost/bind.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cTask_Pool *** *** *** *** *** *** *** *** *** *** */
+
+// more parts than threads so a slow part is balanced by the others
+static const unsigned int task_pool_parts_per_thread = 4;
+
+cTask_Pool :: cTask_Pool( void )
+: m_current_worker( &cTask_Pool::No_Cleanup )
+{
+	m_next_worker = 0;
+	m_queued = 0;
+	m_last_group = 0;
+	m_exit = 0;
+
+	// the main thread is busy with the frame
+	unsigned int thread_count = boost::thread::hardware_concurrency();
+
+	if( thread_count > 1 )
+	{
+		thread_count--;
+	}
+
+	// background tasks must also run on a single core
+	if( thread_count < 1 )
+	{
+		thread_count = 1;
+	}
+	else if( thread_count > 7 )
+	{
+		thread_count = 7;
+	}
+
+	m_thread_count = thread_count;
+
+	// all queues must exist before a worker can steal
+	for( unsigned int i = 0; i < thread_count; i++ )
+	{
+		m_workers.push_back( new Worker() );
+	}
+
+	for( unsigned int i = 0; i < thread_count; i++ )
+	{
+		m_threads.create_thread( boost::bind( &cTask_Pool::Worker_Loop, this, i ) );
+	}
+}
+
+cTask_Pool :: ~cTask_Pool( void )
+{
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+		m_exit = 1;
+	}
+
+	m_task_condition.notify_all();
+	m_threads.join_all();
+
+	for( vector<Worker *>::iterator itr = m_workers.begin(); itr != m_workers.end(); ++itr )
+	{
+		delete *itr;
+	}
+
+	m_workers.clear();
+}
+
+unsigned int cTask_Pool :: Create_Group( void )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	m_last_group++;
+
+	// overflow
+	if( !m_last_group )
+	{
+		m_last_group = 1;
+	}
+
+	return m_last_group;
+}
+
+void cTask_Pool :: Add( const Task_Func &func, Task_Priority priority /* = TASK_PRIORITY_BACKGROUND */, unsigned int group /* = 0 */, const char *name /* = "task" */ )
+{
+	Task task;
+	task.m_func = func;
+	task.m_group = group;
+	task.m_name = name;
+
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+
+		if( group )
+		{
+			Group &group_state = m_groups[group];
+
+			if( group_state.m_cancelled )
+			{
+				return;
+			}
+
+			group_state.m_tasks++;
+		}
+
+		// a worker keeps its own tasks as they likely use the same data
+		Worker *worker = m_current_worker.get();
+
+		if( !worker )
+		{
+			worker = m_workers[m_next_worker];
+			m_next_worker = ( m_next_worker + 1 ) % m_thread_count;
+		}
+
+		{
+			boost::mutex::scoped_lock queue_lock( worker->m_mutex );
+			worker->m_queues[priority].push_back( task );
+		}
+
+		m_queued++;
+	}
+
+	m_task_condition.notify_one();
+}
+
+void cTask_Pool :: Add_Main_Thread( const Task_Func &func, unsigned int group /* = 0 */ )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	if( group )
+	{
+		Group_Map::const_iterator found = m_groups.find( group );
+
+		if( found != m_groups.end() && found->second.m_cancelled )
+		{
+			return;
+		}
+	}
+
+	Task task;
+	task.m_func = func;
+	task.m_group = group;
+	task.m_name = NULL;
+
+	m_main_tasks.push_back( task );
+}
+
+void cTask_Pool :: Run_Main_Thread_Tasks( void )
+{
+	vector<Task> tasks;
+
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+
+		if( m_main_tasks.empty() )
+		{
+			return;
+		}
+
+		// functions added by these are run with the next frame
+		tasks.swap( m_main_tasks );
+	}
+
+	for( vector<Task>::iterator itr = tasks.begin(); itr != tasks.end(); ++itr )
+	{
+		(*itr).m_func();
+	}
+}
+
+void cTask_Pool :: Run_Parallel( const Range_Func &func, unsigned int count, unsigned int min_part, const char *name )
+{
+	if( !count )
+	{
+		return;
+	}
+
+	if( !min_part )
+	{
+		min_part = 1;
+	}
+
+	const unsigned int max_parts = ( m_thread_count + 1 ) * task_pool_parts_per_thread;
+	unsigned int part_size = ( count + max_parts - 1 ) / max_parts;
+
+	if( part_size < min_part )
+	{
+		part_size = min_part;
+	}
+
+	// not worth waking up the workers
+	if( part_size >= count )
+	{
+		cProfiler_Scope profile_scope( name );
+		func( 0, count );
+		return;
+	}
+
+	const unsigned int group = Create_Group();
+
+	for( unsigned int start = part_size; start < count; start += part_size )
+	{
+		const unsigned int end = start + part_size < count ? start + part_size : count;
+
+		Add( boost::bind( func, start, end ), TASK_PRIORITY_FRAME, group, name );
+	}
+
+	{
+		cProfiler_Scope profile_scope( name );
+		func( 0, part_size );
+	}
+
+	Wait( group );
+}
+
+void cTask_Pool :: Wait( unsigned int group )
+{
+	if( !group )
+	{
+		return;
+	}
+
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	while( m_groups.find( group ) != m_groups.end() )
+	{
+		Task task;
+
+		// help instead of waiting for a worker
+		if( Take_Group_Task( task, group ) )
+		{
+			lock.unlock();
+			Run_Task( task );
+			lock.lock();
+			continue;
+		}
+
+		m_done_condition.wait( lock );
+	}
+}
+
+void cTask_Pool :: Cancel( unsigned int group )
+{
+	if( !group )
+	{
+		return;
+	}
+
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+
+		for( vector<Task>::iterator itr = m_main_tasks.begin(); itr != m_main_tasks.end(); )
+		{
+			if( (*itr).m_group == group )
+			{
+				itr = m_main_tasks.erase( itr );
+			}
+			else
+			{
+				++itr;
+			}
+		}
+
+		Group_Map::iterator found = m_groups.find( group );
+
+		if( found == m_groups.end() )
+		{
+			return;
+		}
+
+		found->second.m_cancelled = 1;
+	}
+
+	// the queued tasks are dropped when taken and the group is removed with its last task
+	Wait( group );
+}
+
+bool cTask_Pool :: Is_Cancelled( unsigned int group ) const
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	Group_Map::const_iterator found = m_groups.find( group );
+
+	return found != m_groups.end() && found->second.m_cancelled;
+}
+
+void cTask_Pool :: No_Cleanup( Worker *worker )
+{
+	// nothing
+}
+
+void cTask_Pool :: Worker_Loop( unsigned int num )
+{
+	m_current_worker.reset( m_workers[num] );
+
+	while( 1 )
+	{
+		// reserve a task
+		{
+			boost::mutex::scoped_lock lock( m_mutex );
+
+			while( !m_queued )
+			{
+				if( m_exit )
+				{
+					return;
+				}
+
+				m_task_condition.wait( lock );
+			}
+
+			m_queued--;
+		}
+
+		Task task;
+
+		/* the reserved task is in one of the queues
+		 * but another reserving thread could have taken it while searching
+		*/
+		while( !Take_Task( task, num ) )
+		{
+			boost::this_thread::yield();
+		}
+
+		Run_Task( task );
+	}
+}
+
+void cTask_Pool :: Run_Task( const Task &task )
+{
+	if( !task.m_group )
+	{
+		cProfiler_Scope profile_scope( task.m_name );
+		task.m_func();
+		return;
+	}
+
+	if( !Is_Cancelled( task.m_group ) )
+	{
+		cProfiler_Scope profile_scope( task.m_name );
+		task.m_func();
+	}
+
+	bool group_done = 0;
+
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+
+		Group_Map::iterator found = m_groups.find( task.m_group );
+
+		if( found != m_groups.end() && --found->second.m_tasks == 0 )
+		{
+			m_groups.erase( found );
+			group_done = 1;
+		}
+	}
+
+	if( group_done )
+	{
+		m_done_condition.notify_all();
+	}
+}
+
+bool cTask_Pool :: Take_Task( Task &task, unsigned int own )
+{
+	for( unsigned int i = 0; i < 2; i++ )
+	{
+		// the newest own task
+		{
+			Worker *worker = m_workers[own];
+			boost::mutex::scoped_lock queue_lock( worker->m_mutex );
+			Task_Queue &queue = worker->m_queues[i];
+
+			if( !queue.empty() )
+			{
+				task = queue.back();
+				queue.pop_back();
+				return 1;
+			}
+		}
+
+		// steal the oldest task of the next workers
+		for( unsigned int j = 1; j < m_thread_count; j++ )
+		{
+			Worker *worker = m_workers[( own + j ) % m_thread_count];
+			boost::mutex::scoped_lock queue_lock( worker->m_mutex );
+			Task_Queue &queue = worker->m_queues[i];
+
+			if( !queue.empty() )
+			{
+				task = queue.front();
+				queue.pop_front();
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+bool cTask_Pool :: Take_Group_Task( Task &task, unsigned int group )
+{
+	// every queued task is reserved by a worker which will run it
+	if( !m_queued )
+	{
+		return 0;
+	}
+
+	for( unsigned int i = 0; i < 2; i++ )
+	{
+		for( vector<Worker *>::iterator worker_itr = m_workers.begin(); worker_itr != m_workers.end(); ++worker_itr )
+		{
+			Worker *worker = *worker_itr;
+			boost::mutex::scoped_lock queue_lock( worker->m_mutex );
+			Task_Queue &queue = worker->m_queues[i];
+
+			for( Task_Queue::iterator itr = queue.begin(); itr != queue.end(); ++itr )
+			{
+				if( (*itr).m_group != group )
+				{
+					continue;
+				}
+
+				task = (*itr);
+				queue.erase( itr );
+				m_queued--;
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+cTask_Pool *pTask_Pool = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,195 @@
+/***************************************************************************
+ * task_pool.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_TASK_POOL_H
+#define SMC_TASK_POOL_H
+
+#include "../core/global_basic.h"
+// boost
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/unordered_map.hpp>
+// std
+#include <deque>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cTask_Pool *** *** *** *** *** *** *** *** *** *** */
+
+enum Task_Priority
+{
+	// needed in the current frame and taken first
+	TASK_PRIORITY_FRAME = 0,
+	// loading, saving and everything else which can take longer
+	TASK_PRIORITY_BACKGROUND = 1
+};
+
+/* Runs tasks of all subsystems on one set of worker threads
+ * every worker has its own queues and takes the newest task of it
+ * if these are empty it steals the oldest task of another worker
+ * the workers take the frame tasks before the background tasks
+ * tasks added by a worker are queued for itself and the others round-robin
+ * tasks can be put into a group to wait for them or cancel them together
+ * functions using opengl or CEGUI can be added for the main thread
+ * every task is measured as a profiler section with its name
+ * the queued tasks are still run when the pool is deleted
+*/
+class cTask_Pool
+{
+public:
+	cTask_Pool( void );
+	~cTask_Pool( void );
+
+	typedef boost::function<void ( void )> Task_Func;
+	// function for the part from start to end of a range
+	typedef boost::function<void ( unsigned int, unsigned int )> Range_Func;
+
+	// Returns a new group number which is never 0
+	unsigned int Create_Group( void );
+
+	/* Run the function on a worker thread
+	 * group : 0 if not in a group
+	 * if the group is being cancelled the task is not added
+	 * name : profiler section which must stay valid as it is not copied
+	*/
+	void Add( const Task_Func &func, Task_Priority priority = TASK_PRIORITY_BACKGROUND, unsigned int group = 0, const char *name = "task" );
+	/* Run the function on the main thread with the next Run_Main_Thread_Tasks
+	 * can be called from any thread to continue a task with opengl or CEGUI
+	 * group : 0 if not in a group
+	*/
+	void Add_Main_Thread( const Task_Func &func, unsigned int group = 0 );
+	/* Run the main thread functions added until now
+	 * must be called from the main thread once in every frame
+	*/
+	void Run_Main_Thread_Tasks( void );
+
+	/* Run the function for parts of the range from 0 to count as frame tasks
+	 * the first part is run on the calling thread and it helps with the others
+	 * returns when all parts are done
+	 * min_part : a part is never smaller and a smaller range is run directly
+	 * name : profiler section of the parts
+	*/
+	void Run_Parallel( const Range_Func &func, unsigned int count, unsigned int min_part, const char *name );
+	/* Wait until the tasks of the group are done
+	 * the queued tasks of the group are run on the calling thread while waiting
+	 * the main thread functions of the group are not waited for
+	*/
+	void Wait( unsigned int group );
+	/* Drop the queued tasks and main thread functions of the group
+	 * and wait until its running tasks are done
+	 * the running tasks can check Is_Cancelled to finish early
+	*/
+	void Cancel( unsigned int group );
+	// Returns true if the group is being cancelled
+	bool Is_Cancelled( unsigned int group ) const;
+
+	// Returns the number of worker threads
+	inline unsigned int Get_Thread_Count( void ) const
+	{
+		return m_thread_count;
+	}
+
+private:
+	struct Task
+	{
+		Task_Func m_func;
+		unsigned int m_group;
+		const char *m_name;
+	};
+
+	typedef std::deque<Task> Task_Queue;
+
+	// queues of a worker thread
+	struct Worker
+	{
+		// protects the queues
+		boost::mutex m_mutex;
+		// queued tasks by priority
+		Task_Queue m_queues[2];
+	};
+
+	// queued and running tasks of a group
+	struct Group
+	{
+		Group( void )
+		: m_tasks( 0 ), m_cancelled( 0 ) {}
+
+		unsigned int m_tasks;
+		bool m_cancelled;
+	};
+
+	typedef boost::unordered_map<unsigned int, Group> Group_Map;
+
+	// does nothing as the workers are owned by the pool
+	static void No_Cleanup( Worker *worker );
+
+	// Worker thread function
+	void Worker_Loop( unsigned int num );
+	// Run the task if its group is not cancelled and count it as done
+	void Run_Task( const Task &task );
+	/* Take a queued task with the own queues first and steal from the others
+	 * the task must be reserved from the queued count
+	 * returns false if another thread took it first
+	*/
+	bool Take_Task( Task &task, unsigned int own );
+	/* Take the next queued task of the group
+	 * must be called with the mutex locked
+	 * returns false if none is queued or all are reserved
+	*/
+	bool Take_Group_Task( Task &task, unsigned int group );
+
+	boost::thread_group m_threads;
+	unsigned int m_thread_count;
+	// queues by worker thread
+	vector<Worker *> m_workers;
+	// worker of the current thread or NULL if not a worker
+	boost::thread_specific_ptr<Worker> m_current_worker;
+	// worker for the next task added by another thread
+	unsigned int m_next_worker;
+
+	// protects the groups, the queued count and the main thread functions
+	// locked before the worker queues
+	mutable boost::mutex m_mutex;
+	// notified if a task was added or the threads should exit
+	boost::condition_variable m_task_condition;
+	// notified if the last task of a group is done
+	boost::condition_variable m_done_condition;
+
+	// queued tasks not yet reserved by a thread
+	unsigned int m_queued;
+	// functions for the main thread
+	vector<Task> m_main_tasks;
+	// groups with queued or running tasks
+	Group_Map m_groups;
+	// last created group number
+	unsigned int m_last_group;
+	// if set the threads exit when no task is queued
+	bool m_exit;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+// Task Pool
+extern cTask_Pool *pTask_Pool;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
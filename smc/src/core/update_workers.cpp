@@ -0,0 +1,174 @@
+/***************************************************************************
+ * update_workers.cpp  -  updates sprites with several threads
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/update_workers.h"
+#include "../objects/sprite.h"
+#include "../core/task_pool.h"
+#include <boost/bind.hpp>
+
+namespace SMC
+{
+
+// less sprites are updated by the calling thread only
+static const unsigned int update_workers_min_jobs = 32;
+// sprites updated at least by a task
+static const unsigned int update_workers_chunk_size = 8;
+
+/* *** *** *** *** *** *** *** cUpdate_Workers *** *** *** *** *** *** *** *** *** *** */
+
+cUpdate_Workers :: cUpdate_Workers( void )
+: m_current_job( &cUpdate_Workers::No_Cleanup )
+{
+	m_running = 0;
+}
+
+cUpdate_Workers :: ~cUpdate_Workers( void )
+{
+	//
+}
+
+void cUpdate_Workers :: Update( cSprite **sprites, unsigned int count )
+{
+	if( !count )
+	{
+		return;
+	}
+
+	// not worth waking up the workers
+	if( count < update_workers_min_jobs )
+	{
+		for( unsigned int i = 0; i < count; i++ )
+		{
+			sprites[i]->Update();
+		}
+
+		return;
+	}
+
+	if( m_jobs.size() < count )
+	{
+		m_jobs.resize( count );
+	}
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		Job &job = m_jobs[i];
+
+		job.m_sprite = sprites[i];
+		job.m_sync = 0;
+	}
+
+	// set before the tasks are added which synchronizes it with the workers
+	m_running = 1;
+	pTask_Pool->Run_Parallel( boost::bind( &cUpdate_Workers::Run_Jobs, this, _1, _2 ), count, update_workers_chunk_size, "sprite update" );
+	m_running = 0;
+
+	// shared changes in the sprite order
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		Job &job = m_jobs[i];
+
+		if( job.m_sync )
+		{
+			Sync_Sprite( job.m_sprite );
+		}
+
+		for( vector<Deferred_Call>::iterator itr = job.m_calls.begin(); itr != job.m_calls.end(); ++itr )
+		{
+			(*itr)();
+		}
+
+		job.m_calls.clear();
+		job.m_sprite = NULL;
+	}
+}
+
+bool cUpdate_Workers :: Defer( const Deferred_Call &call )
+{
+	// only changed by the calling thread while no job runs
+	if( !m_running )
+	{
+		return 0;
+	}
+
+	Job *job = m_current_job.get();
+
+	// not from a sprite update
+	if( !job )
+	{
+		return 0;
+	}
+
+	job->m_calls.push_back( call );
+	return 1;
+}
+
+bool cUpdate_Workers :: Defer_Sync( cSprite *sprite )
+{
+	if( !m_running )
+	{
+		return 0;
+	}
+
+	Job *job = m_current_job.get();
+
+	// not from a sprite update
+	if( !job )
+	{
+		return 0;
+	}
+
+	// the updated sprite
+	if( job->m_sprite == sprite )
+	{
+		job->m_sync = 1;
+		return 1;
+	}
+
+	job->m_calls.push_back( boost::bind( &cUpdate_Workers::Sync_Sprite, sprite ) );
+	return 1;
+}
+
+void cUpdate_Workers :: Sync_Sprite( cSprite *sprite )
+{
+	sprite->Update_Grid();
+	sprite->Update_Valid_Draw();
+}
+
+void cUpdate_Workers :: No_Cleanup( Job *job )
+{
+	// nothing
+}
+
+void cUpdate_Workers :: Run_Jobs( unsigned int start, unsigned int end )
+{
+	// the jobs are only used by this thread until they are done
+	for( unsigned int i = start; i < end; i++ )
+	{
+		Job &job = m_jobs[i];
+
+		m_current_job.reset( &job );
+		job.m_sprite->Update();
+		m_current_job.reset( NULL );
+	}
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+cUpdate_Workers *pUpdate_Workers = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
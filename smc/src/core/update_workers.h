@@ -0,0 +1,94 @@
+/***************************************************************************
+ * update_workers.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_UPDATE_WORKERS_H
+#define SMC_UPDATE_WORKERS_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+// boost
+#include <boost/function.hpp>
+#include <boost/thread/tss.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cUpdate_Workers *** *** *** *** *** *** *** *** *** *** */
+
+/* Updates sprites with the task pool
+ * only used for sprites which return true in Is_Update_Parallel
+ * these only read the other objects and only change their own state
+ * changes of shared data like sounds, spawned objects and points are deferred with Defer
+ * and run after all updates in the order of the sprites
+*/
+class cUpdate_Workers
+{
+public:
+	cUpdate_Workers( void );
+	~cUpdate_Workers( void );
+
+	typedef boost::function<void ( void )> Deferred_Call;
+
+	/* Update the sprites and run the deferred calls after all are updated
+	 * uses the task pool if there are enough sprites and returns when all are done
+	*/
+	void Update( cSprite **sprites, unsigned int count );
+
+	/* Keep the call for after the updates if called from a sprite update
+	 * returns false if not called from a sprite update and the call must be done directly
+	*/
+	bool Defer( const Deferred_Call &call );
+	/* Update the collision grid and the drawing validation of the sprite after the updates
+	 * if called from a sprite update
+	 * returns false if not called from a sprite update
+	*/
+	bool Defer_Sync( cSprite *sprite );
+
+private:
+	// a sprite update with the calls to do after it
+	struct Job
+	{
+		cSprite *m_sprite;
+		// if set the sprite needs to be synchronized
+		bool m_sync;
+		vector<Deferred_Call> m_calls;
+	};
+
+	// Update the collision grid and the drawing validation of the sprite
+	static void Sync_Sprite( cSprite *sprite );
+	// does nothing as the jobs are not owned by the threads
+	static void No_Cleanup( Job *job );
+
+	// Update the sprites of the jobs from start to end
+	void Run_Jobs( unsigned int start, unsigned int end );
+
+	// jobs of the current update with their capacity kept
+	vector<Job> m_jobs;
+	// if set sprites are updated by the jobs
+	bool m_running;
+	// job updated by the current thread
+	boost::thread_specific_ptr<Job> m_current_job;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+// Update Workers
+extern cUpdate_Workers *pUpdate_Workers;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -0,0 +1,711 @@
+/***************************************************************************
+ * xml_reader.cpp  -  fast XML reader for trusted files
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/xml_reader.h"
+#include "../core/global_game.h"
+#include "../core/filesystem/resource_manager.h"
+// CEGUI
+#include "CEGUIXMLAttributes.h"
+#include "CEGUIXMLParser.h"
+#include "CEGUIExceptions.h"
+#include "CEGUISystem.h"
+#include "CEGUIDataContainer.h"
+// Boost
+#include <boost/thread/mutex.hpp>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <set>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** XML syntax *** *** *** *** *** *** *** *** *** *** */
+
+static inline bool Is_XML_Space( const char c )
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool Is_XML_Name_End( const char c )
+{
+	return Is_XML_Space( c ) || c == '>' || c == '/' || c == '=';
+}
+
+// Returns the position after the string or NULL if not found
+static const char *XML_Skip_Past( const char *pos, const char *end, const char *str )
+{
+	const size_t length = strlen( str );
+	const char *found = std::search( pos, end, str, str + length );
+
+	if( found == end )
+	{
+		return NULL;
+	}
+
+	return found + length;
+}
+
+// Returns the position of the first character which is not a space
+static inline const char *XML_Skip_Spaces( const char *pos, const char *end )
+{
+	while( pos < end && Is_XML_Space( *pos ) )
+	{
+		pos++;
+	}
+
+	return pos;
+}
+
+// Returns the end of the name
+static inline const char *XML_Skip_Name( const char *pos, const char *end )
+{
+	while( pos < end && !Is_XML_Name_End( *pos ) )
+	{
+		pos++;
+	}
+
+	return pos;
+}
+
+// Append the unicode character as UTF-8
+static void XML_Append_UTF8( std::string &str, unsigned long code )
+{
+	if( code < 0x80 )
+	{
+		str += static_cast<char>(code);
+	}
+	else if( code < 0x800 )
+	{
+		str += static_cast<char>(0xC0 | ( code >> 6 ));
+		str += static_cast<char>(0x80 | ( code & 0x3F ));
+	}
+	else if( code < 0x10000 )
+	{
+		str += static_cast<char>(0xE0 | ( code >> 12 ));
+		str += static_cast<char>(0x80 | ( ( code >> 6 ) & 0x3F ));
+		str += static_cast<char>(0x80 | ( code & 0x3F ));
+	}
+	else if( code < 0x110000 )
+	{
+		str += static_cast<char>(0xF0 | ( code >> 18 ));
+		str += static_cast<char>(0x80 | ( ( code >> 12 ) & 0x3F ));
+		str += static_cast<char>(0x80 | ( ( code >> 6 ) & 0x3F ));
+		str += static_cast<char>(0x80 | ( code & 0x3F ));
+	}
+}
+
+/* *** *** *** *** *** *** *** cXML_Reader *** *** *** *** *** *** *** *** *** *** */
+
+bool cXML_Reader :: View :: Is( const char *str ) const
+{
+	return strlen( str ) == m_length && memcmp( m_data, str, m_length ) == 0;
+}
+
+std::string cXML_Reader :: Attribute :: Get_String( void ) const
+{
+	if( !m_escaped )
+	{
+		return std::string( m_value.m_data, m_value.m_length );
+	}
+
+	std::string str;
+	str.reserve( m_value.m_length );
+
+	const char *pos = m_value.m_data;
+	const char *end = pos + m_value.m_length;
+
+	while( pos < end )
+	{
+		const char c = *pos;
+
+		// whitespace is normalized to a space
+		if( c == '\r' )
+		{
+			str += ' ';
+			pos++;
+
+			// a line break is one space
+			if( pos < end && *pos == '\n' )
+			{
+				pos++;
+			}
+
+			continue;
+		}
+		else if( c == '\t' || c == '\n' )
+		{
+			str += ' ';
+			pos++;
+			continue;
+		}
+		else if( c != '&' )
+		{
+			str += c;
+			pos++;
+			continue;
+		}
+
+		const char *entity_end = static_cast<const char *>(memchr( pos, ';', end - pos ));
+
+		// not an entity
+		if( !entity_end )
+		{
+			str.append( pos, end - pos );
+			break;
+		}
+
+		View entity;
+		entity.m_data = pos + 1;
+		entity.m_length = entity_end - entity.m_data;
+
+		if( entity.Is( "lt" ) )
+		{
+			str += '<';
+		}
+		else if( entity.Is( "gt" ) )
+		{
+			str += '>';
+		}
+		else if( entity.Is( "amp" ) )
+		{
+			str += '&';
+		}
+		else if( entity.Is( "quot" ) )
+		{
+			str += '"';
+		}
+		else if( entity.Is( "apos" ) )
+		{
+			str += '\'';
+		}
+		// character reference
+		else if( entity.m_length > 1 && entity.m_data[0] == '#' )
+		{
+			if( entity.m_data[1] == 'x' || entity.m_data[1] == 'X' )
+			{
+				XML_Append_UTF8( str, strtoul( entity.m_data + 2, NULL, 16 ) );
+			}
+			else
+			{
+				XML_Append_UTF8( str, strtoul( entity.m_data + 1, NULL, 10 ) );
+			}
+		}
+		// unknown entities are kept
+		else
+		{
+			str.append( pos, entity_end + 1 - pos );
+		}
+
+		pos = entity_end + 1;
+	}
+
+	return str;
+}
+
+int cXML_Reader :: Attribute :: Get_Int( int default_value /* = 0 */ ) const
+{
+	if( m_escaped )
+	{
+		const std::string str = Get_String();
+		char *number_end = NULL;
+		const long value = strtol( str.c_str(), &number_end, 10 );
+
+		return number_end == str.c_str() ? default_value : static_cast<int>(value);
+	}
+
+	// the quote ends the number
+	char *number_end = NULL;
+	const long value = strtol( m_value.m_data, &number_end, 10 );
+
+	if( number_end == m_value.m_data || number_end > m_value.m_data + m_value.m_length )
+	{
+		return default_value;
+	}
+
+	return static_cast<int>(value);
+}
+
+float cXML_Reader :: Attribute :: Get_Float( float default_value /* = 0.0f */ ) const
+{
+	if( m_escaped )
+	{
+		const std::string str = Get_String();
+		char *number_end = NULL;
+		const double value = strtod( str.c_str(), &number_end );
+
+		return number_end == str.c_str() ? default_value : static_cast<float>(value);
+	}
+
+	// the quote ends the number
+	char *number_end = NULL;
+	const double value = strtod( m_value.m_data, &number_end );
+
+	if( number_end == m_value.m_data || number_end > m_value.m_data + m_value.m_length )
+	{
+		return default_value;
+	}
+
+	return static_cast<float>(value);
+}
+
+/* Passes the elements to a CEGUI XML handler
+ * the strings are only copied here
+*/
+class cXML_Reader_CEGUI_Handler : public cXML_Reader::Handler
+{
+public:
+	cXML_Reader_CEGUI_Handler( CEGUI::XMLHandler &handler )
+	: m_handler( handler )
+	{
+		//
+	}
+
+	virtual void Element_Start( const cXML_Reader::View &name, const cXML_Reader::Attribute_List &attributes )
+	{
+		CEGUI::XMLAttributes xml_attributes;
+
+		for( cXML_Reader::Attribute_List::const_iterator itr = attributes.begin(); itr != attributes.end(); ++itr )
+		{
+			const cXML_Reader::Attribute &attribute = (*itr);
+			const CEGUI::String attribute_name( reinterpret_cast<const CEGUI::utf8 *>(attribute.m_name.m_data), attribute.m_name.m_length );
+
+			if( attribute.m_escaped )
+			{
+				xml_attributes.add( attribute_name, reinterpret_cast<const CEGUI::utf8 *>(attribute.Get_String().c_str()) );
+			}
+			else
+			{
+				xml_attributes.add( attribute_name, CEGUI::String( reinterpret_cast<const CEGUI::utf8 *>(attribute.m_value.m_data), attribute.m_value.m_length ) );
+			}
+		}
+
+		m_handler.elementStart( CEGUI::String( reinterpret_cast<const CEGUI::utf8 *>(name.m_data), name.m_length ), xml_attributes );
+	}
+
+	virtual void Element_End( const cXML_Reader::View &name )
+	{
+		m_handler.elementEnd( CEGUI::String( reinterpret_cast<const CEGUI::utf8 *>(name.m_data), name.m_length ) );
+	}
+
+private:
+	CEGUI::XMLHandler &m_handler;
+};
+
+cXML_Reader :: cXML_Reader( void )
+{
+	m_data = NULL;
+}
+
+cXML_Reader :: ~cXML_Reader( void )
+{
+	//
+}
+
+bool cXML_Reader :: Parse( const std::string &filename, Handler &handler )
+{
+	if( !m_file.Open( filename ) )
+	{
+		printf( "Warning : cXML_Reader : could not open %s\n", filename.c_str() );
+		return 0;
+	}
+
+	const bool success = Parse( m_file.Get_Data(), m_file.Get_Size(), filename, handler );
+	m_file.Close();
+
+	return success;
+}
+
+bool cXML_Reader :: Parse( const char *data, size_t size, const std::string &name, Handler &handler )
+{
+	m_filename = name;
+	m_data = data;
+	m_open_elements.clear();
+
+	const char *pos = data;
+	const char *end = pos + size;
+	bool success = 1;
+
+	while( success && pos < end )
+	{
+		// text is ignored
+		pos = static_cast<const char *>(memchr( pos, '<', end - pos ));
+
+		if( !pos )
+		{
+			break;
+		}
+
+		const char *markup_start = pos;
+
+		if( end - pos < 2 )
+		{
+			Error( "unexpected end of file", markup_start );
+			success = 0;
+		}
+		// processing instruction
+		else if( pos[1] == '?' )
+		{
+			pos = XML_Skip_Past( pos + 2, end, "?>" );
+		}
+		// comment
+		else if( end - pos >= 4 && memcmp( pos, "<!--", 4 ) == 0 )
+		{
+			pos = XML_Skip_Past( pos + 4, end, "-->" );
+		}
+		// CDATA section
+		else if( end - pos >= 9 && memcmp( pos, "<![CDATA[", 9 ) == 0 )
+		{
+			pos = XML_Skip_Past( pos + 9, end, "]]>" );
+		}
+		// doctype
+		else if( pos[1] == '!' )
+		{
+			pos = XML_Skip_Past( pos + 2, end, ">" );
+		}
+		// element end
+		else if( pos[1] == '/' )
+		{
+			View name;
+			name.m_data = pos + 2;
+			pos = XML_Skip_Name( name.m_data, end );
+			name.m_length = pos - name.m_data;
+			pos = XML_Skip_Spaces( pos, end );
+
+			if( pos >= end || *pos != '>' )
+			{
+				Error( "invalid element end", markup_start );
+				success = 0;
+			}
+			else if( m_open_elements.empty() || m_open_elements.back().m_length != name.m_length || memcmp( m_open_elements.back().m_data, name.m_data, name.m_length ) != 0 )
+			{
+				Error( "element end does not match the element start", markup_start );
+				success = 0;
+			}
+			else
+			{
+				m_open_elements.pop_back();
+				handler.Element_End( name );
+				pos++;
+			}
+		}
+		// element start
+		else
+		{
+			View name;
+			name.m_data = pos + 1;
+			pos = XML_Skip_Name( name.m_data, end );
+			name.m_length = pos - name.m_data;
+
+			m_attributes.clear();
+			bool empty_element = 0;
+
+			if( !name.m_length )
+			{
+				Error( "invalid element name", markup_start );
+				success = 0;
+			}
+
+			while( success )
+			{
+				pos = XML_Skip_Spaces( pos, end );
+
+				if( pos >= end )
+				{
+					Error( "unexpected end of file", markup_start );
+					success = 0;
+					break;
+				}
+
+				if( *pos == '>' )
+				{
+					pos++;
+					break;
+				}
+
+				if( *pos == '/' )
+				{
+					if( pos + 1 < end && pos[1] == '>' )
+					{
+						empty_element = 1;
+						pos += 2;
+						break;
+					}
+
+					Error( "invalid element start", markup_start );
+					success = 0;
+					break;
+				}
+
+				Attribute attribute;
+				attribute.m_name.m_data = pos;
+				pos = XML_Skip_Name( pos, end );
+				attribute.m_name.m_length = pos - attribute.m_name.m_data;
+				pos = XML_Skip_Spaces( pos, end );
+
+				if( !attribute.m_name.m_length || pos >= end || *pos != '=' )
+				{
+					Error( "invalid attribute", markup_start );
+					success = 0;
+					break;
+				}
+
+				pos = XML_Skip_Spaces( pos + 1, end );
+
+				if( pos >= end || ( *pos != '"' && *pos != '\'' ) )
+				{
+					Error( "attribute value without quotes", markup_start );
+					success = 0;
+					break;
+				}
+
+				const char quote = *pos;
+				attribute.m_value.m_data = pos + 1;
+				const char *value_end = static_cast<const char *>(memchr( attribute.m_value.m_data, quote, end - attribute.m_value.m_data ));
+
+				if( !value_end )
+				{
+					Error( "unterminated attribute value", markup_start );
+					success = 0;
+					break;
+				}
+
+				attribute.m_value.m_length = value_end - attribute.m_value.m_data;
+				attribute.m_escaped = 0;
+
+				for( const char *c = attribute.m_value.m_data; c < value_end; c++ )
+				{
+					if( *c == '&' || *c == '\t' || *c == '\n' || *c == '\r' )
+					{
+						attribute.m_escaped = 1;
+						break;
+					}
+				}
+
+				m_attributes.push_back( attribute );
+				pos = value_end + 1;
+			}
+
+			if( success )
+			{
+				handler.Element_Start( name, m_attributes );
+
+				if( empty_element )
+				{
+					handler.Element_End( name );
+				}
+				else
+				{
+					m_open_elements.push_back( name );
+				}
+			}
+		}
+
+		if( success && !pos )
+		{
+			Error( "unterminated markup", markup_start );
+			success = 0;
+		}
+	}
+
+	if( success && !m_open_elements.empty() )
+	{
+		Error( "element is not closed", m_open_elements.back().m_data );
+		success = 0;
+	}
+
+	m_attributes.clear();
+	m_open_elements.clear();
+	m_data = NULL;
+
+	return success;
+}
+
+bool cXML_Reader :: Parse( const std::string &filename, CEGUI::XMLHandler &handler )
+{
+	cXML_Reader_CEGUI_Handler cegui_handler( handler );
+
+	return Parse( filename, cegui_handler );
+}
+
+void cXML_Reader :: Error( const char *message, const char *pos ) const
+{
+	const int line = static_cast<int>(std::count( m_data, pos, '\n' )) + 1;
+
+	printf( "Warning : cXML_Reader : %s in %s line %d\n", message, m_filename.c_str(), line );
+}
+
+/* *** *** *** *** *** *** *** Parse_XML_File *** *** *** *** *** *** *** *** *** *** */
+
+// hashes of the user files and their schema which passed the validation
+static std::set<Uint64> xml_validated_files;
+static bool xml_validated_files_loaded = 0;
+static boost::mutex xml_validated_mutex;
+
+static std::string XML_Validation_Index_Filename( void )
+{
+	return pResource_Manager->user_data_dir + USER_IMGCACHE_DIR "/" USER_XML_VALIDATION_INDEX;
+}
+
+// Returns true if the hash was validated before
+static bool XML_Is_Validated( Uint64 hash )
+{
+	boost::mutex::scoped_lock lock( xml_validated_mutex );
+
+	if( !xml_validated_files_loaded )
+	{
+		xml_validated_files_loaded = 1;
+
+		FILE *fp = fopen( XML_Validation_Index_Filename().c_str(), "r" );
+
+		if( fp )
+		{
+			unsigned int hash_high = 0;
+			unsigned int hash_low = 0;
+
+			while( fscanf( fp, "%8x%8x", &hash_high, &hash_low ) == 2 )
+			{
+				xml_validated_files.insert( ( static_cast<Uint64>(hash_high) << 32 ) | hash_low );
+			}
+
+			fclose( fp );
+		}
+	}
+
+	return xml_validated_files.find( hash ) != xml_validated_files.end();
+}
+
+// Remember the validated hash
+static void XML_Add_Validated( Uint64 hash )
+{
+	boost::mutex::scoped_lock lock( xml_validated_mutex );
+
+	if( !xml_validated_files.insert( hash ).second )
+	{
+		return;
+	}
+
+	FILE *fp = fopen( XML_Validation_Index_Filename().c_str(), "a" );
+
+	if( !fp )
+	{
+		return;
+	}
+
+	fprintf( fp, "%08x%08x\n", static_cast<unsigned int>(hash >> 32), static_cast<unsigned int>(hash & 0xFFFFFFFF) );
+	fclose( fp );
+}
+
+bool Is_XML_File_Trusted( const std::string &filename, const std::string &schema, Uint64 *validation_hash /* = NULL */ )
+{
+	if( validation_hash )
+	{
+		*validation_hash = 0;
+	}
+
+	// shipped game data
+	if( filename.compare( 0, strlen( DATA_DIR "/" ), DATA_DIR "/" ) == 0 )
+	{
+		return 1;
+	}
+
+	if( !pResource_Manager )
+	{
+		return 0;
+	}
+
+	// hash of the user file content and the schema
+	Uint64 hash = Get_File_Hash( filename );
+
+	if( !hash )
+	{
+		return 0;
+	}
+
+	hash = Get_Data_Hash( schema.c_str(), schema.length(), hash );
+
+	if( XML_Is_Validated( hash ) )
+	{
+		return 1;
+	}
+
+	if( validation_hash )
+	{
+		*validation_hash = hash;
+	}
+
+	return 0;
+}
+
+void Parse_XML_File( CEGUI::XMLHandler &handler, const std::string &filename, const std::string &schema )
+{
+	// hash of the user file content and the schema if it needs validation
+	Uint64 validation_hash = 0;
+
+	if( Is_XML_File_Trusted( filename, schema, &validation_hash ) )
+	{
+		cXML_Reader reader;
+
+		if( !reader.Parse( filename, handler ) )
+		{
+			throw CEGUI::InvalidRequestException( "cXML_Reader : could not parse " + filename );
+		}
+
+		return;
+	}
+
+	// the CEGUI resource provider can not decompress
+	if( Is_Compressed_File( filename ) )
+	{
+		cMapped_File file;
+
+		if( !file.Open( filename ) )
+		{
+			throw CEGUI::InvalidRequestException( "Could not read " + filename );
+		}
+
+		// the container deletes the data
+		const size_t size = file.Get_Size();
+		CEGUI::uint8 *data = new CEGUI::uint8[size];
+		memcpy( data, file.Get_Data(), size );
+		file.Close();
+
+		CEGUI::RawDataContainer source;
+		source.setData( data );
+		source.setSize( size );
+
+		CEGUI::System::getSingleton().getXMLParser()->parseXML( handler, source, DATA_DIR "/" GAME_SCHEMA_DIR "/" + schema );
+	}
+	else
+	{
+// fixme : Workaround for std::string to CEGUI::String utf8 conversion. Check again if CEGUI 0.8 works with std::string utf8
+#ifdef _WIN32
+		CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( handler, (const CEGUI::utf8*)filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/" + schema, "" );
+#else
+		CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( handler, filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/" + schema, "" );
+#endif
+	}
+
+	// an invalid file throws an exception before
+	if( validation_hash )
+	{
+		XML_Add_Validated( validation_hash );
+	}
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,125 @@
+/***************************************************************************
+ * xml_reader.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_XML_READER_H
+#define SMC_XML_READER_H
+
+#include "../core/global_basic.h"
+#include "../core/filesystem/filesystem.h"
+// CEGUI
+#include "CEGUIXMLHandler.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cXML_Reader *** *** *** *** *** *** *** *** *** *** */
+
+/* Fast XML reader for trusted files without schema validation
+ * the file is memory mapped and the element and attribute names and values point into it
+ * only the XML used by the game data is supported :
+ * elements, attributes, comments, processing instructions, doctype and CDATA sections without text events
+ * and the predefined and numeric character entities
+*/
+class cXML_Reader
+{
+public:
+	cXML_Reader( void );
+	~cXML_Reader( void );
+
+	// text in the file
+	struct View
+	{
+		const char *m_data;
+		size_t m_length;
+
+		// Returns true if the text is equal to the string
+		bool Is( const char *str ) const;
+	};
+
+	// attribute of an element
+	struct Attribute
+	{
+		View m_name;
+		View m_value;
+		// if the value has entities or whitespace to replace
+		bool m_escaped;
+
+		// Returns the value with the entities replaced
+		std::string Get_String( void ) const;
+		// Returns the value as integer or the default if it is not a number
+		int Get_Int( int default_value = 0 ) const;
+		// Returns the value as float or the default if it is not a number
+		float Get_Float( float default_value = 0.0f ) const;
+	};
+
+	typedef vector<Attribute> Attribute_List;
+
+	// Receives the elements
+	class Handler
+	{
+	public:
+		virtual ~Handler( void ) {}
+
+		// element start with its attributes which are only valid in this call
+		virtual void Element_Start( const View &name, const Attribute_List &attributes ) = 0;
+		// element end
+		virtual void Element_End( const View &name ) = 0;
+	};
+
+	/* Parse the file with the handler
+	 * returns false and prints the error if the file could not be read or is not well-formed
+	*/
+	bool Parse( const std::string &filename, Handler &handler );
+	/* Parse the data in memory with the handler
+	 * name : shown in the errors
+	*/
+	bool Parse( const char *data, size_t size, const std::string &name, Handler &handler );
+	// Parse the file with a CEGUI XML handler
+	bool Parse( const std::string &filename, CEGUI::XMLHandler &handler );
+
+private:
+	// Print the error with the line of the position
+	void Error( const char *message, const char *pos ) const;
+
+	cMapped_File m_file;
+	std::string m_filename;
+	// start of the parsed data
+	const char *m_data;
+	// attributes of the current element
+	Attribute_List m_attributes;
+	// names of the open elements
+	vector<View> m_open_elements;
+};
+
+/* Returns true if the file can be read without schema validation
+ * validation_hash : set to the hash of the user file content and the schema if it needs validation
+ * thread safe
+*/
+bool Is_XML_File_Trusted( const std::string &filename, const std::string &schema, Uint64 *validation_hash = NULL );
+
+/* Parse the file like the CEGUI XML parser
+ * trusted files are read with cXML_Reader and other files are validated with the schema :
+ * files in the game data directory are trusted
+ * and user files are trusted if the same content was validated with the schema before
+ * compressed files are decompressed into memory
+ * throws a CEGUI::Exception if the file could not be parsed
+*/
+void Parse_XML_File( CEGUI::XMLHandler &handler, const std::string &filename, const std::string &schema );
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
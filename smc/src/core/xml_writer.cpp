@@ -0,0 +1,244 @@
+/***************************************************************************
+ * xml_writer.cpp  -  buffered XML output
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../core/xml_writer.h"
+#include "../core/property_helper.h"
+#include <cstdio>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cXml_Writer *** *** *** *** *** *** *** *** *** *** */
+
+cXml_Writer :: cXml_Writer( void )
+{
+	m_tag_open = 0;
+	// most saved files are larger
+	m_data.reserve( 16384 );
+	m_data.append( "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" );
+}
+
+cXml_Writer &cXml_Writer :: Open_Tag( const char *name )
+{
+	if( m_tag_open )
+	{
+		m_data.push_back( '>' );
+	}
+
+	Write_Line_Start();
+	m_data.push_back( '<' );
+
+	const size_t length = strlen( name );
+	m_tags.push_back( m_data.length() );
+	m_tags.push_back( length );
+	m_data.append( name, length );
+	m_tag_open = 1;
+
+	return *this;
+}
+
+cXml_Writer &cXml_Writer :: Close_Tag( void )
+{
+	if( m_tags.empty() )
+	{
+		printf( "Warning : XML writer has no element to close\n" );
+		return *this;
+	}
+
+	const size_t length = m_tags.back();
+	m_tags.pop_back();
+	const size_t offset = m_tags.back();
+	m_tags.pop_back();
+
+	// empty element
+	if( m_tag_open )
+	{
+		m_data.append( " />" );
+		m_tag_open = 0;
+		return *this;
+	}
+
+	Write_Line_Start();
+	m_data.append( "</" );
+	// the name is copied from its start tag
+	m_data.append( m_data, offset, length );
+	m_data.push_back( '>' );
+
+	return *this;
+}
+
+cXml_Writer &cXml_Writer :: Attribute( const char *name, const char *value, size_t length )
+{
+	Write_Attribute_Name( name );
+	Write_Escaped( value, length );
+	m_data.push_back( '"' );
+
+	return *this;
+}
+
+cXml_Writer &cXml_Writer :: Attribute( const char *name, int value )
+{
+	Write_Attribute_Name( name );
+	// the smallest value can not be negated
+	Write_Number( value < 0 ? static_cast<Uint64>(-( value + 1 )) + 1 : static_cast<Uint64>(value), value < 0 );
+
+	return *this;
+}
+
+cXml_Writer &cXml_Writer :: Attribute( const char *name, unsigned int value )
+{
+	Write_Attribute_Name( name );
+	Write_Number( value, 0 );
+
+	return *this;
+}
+
+cXml_Writer &cXml_Writer :: Attribute( const char *name, Uint64 value )
+{
+	Write_Attribute_Name( name );
+	Write_Number( value, 0 );
+
+	return *this;
+}
+
+cXml_Writer &cXml_Writer :: Attribute( const char *name, long value )
+{
+	Write_Attribute_Name( name );
+	Write_Number( value < 0 ? static_cast<Uint64>(-( value + 1 )) + 1 : static_cast<Uint64>(value), value < 0 );
+
+	return *this;
+}
+
+cXml_Writer &cXml_Writer :: Attribute( const char *name, float value )
+{
+	// %g has at most 6 digits and a short exponent
+	char buffer[32];
+	const int length = sprintf( buffer, "%g", value );
+
+	return Attribute( name, buffer, length > 0 ? static_cast<size_t>(length) : 0 );
+}
+
+std::string &cXml_Writer :: Get_Data( void )
+{
+	while( !m_tags.empty() )
+	{
+		Close_Tag();
+	}
+
+	if( m_data.empty() || m_data[m_data.length() - 1] != '\n' )
+	{
+		m_data.push_back( '\n' );
+	}
+
+	return m_data;
+}
+
+bool cXml_Writer :: Save( const std::string &filename )
+{
+	const std::string &data = Get_Data();
+
+#ifdef _WIN32
+	FILE *fp = _wfopen( utf8_to_ucs2( filename ).c_str(), L"wb" );
+#else
+	FILE *fp = fopen( filename.c_str(), "wb" );
+#endif
+
+	if( !fp )
+	{
+		return 0;
+	}
+
+	bool success = fwrite( data.data(), data.size(), 1, fp ) == 1;
+	success = fclose( fp ) == 0 && success;
+
+	return success;
+}
+
+void cXml_Writer :: Write_Attribute_Name( const char *name )
+{
+	if( !m_tag_open )
+	{
+		printf( "Warning : XML writer attribute %s is not in a start tag\n", name );
+	}
+
+	m_data.push_back( ' ' );
+	m_data.append( name );
+	m_data.append( "=\"" );
+}
+
+void cXml_Writer :: Write_Number( Uint64 value, bool negative )
+{
+	// digits in reverse order
+	char digits[24];
+	unsigned int count = 0;
+
+	do
+	{
+		digits[count++] = static_cast<char>( '0' + value % 10 );
+		value /= 10;
+	}
+	while( value );
+
+	if( negative )
+	{
+		m_data.push_back( '-' );
+	}
+
+	while( count )
+	{
+		m_data.push_back( digits[--count] );
+	}
+
+	m_data.push_back( '"' );
+}
+
+void cXml_Writer :: Write_Escaped( const char *str, size_t length )
+{
+	const char *end = str + length;
+	// the text between the entities is appended at once
+	const char *start = str;
+
+	for( ; str < end; str++ )
+	{
+		const char *entity;
+
+		switch( *str )
+		{
+			case '<':	entity = "&lt;"; break;
+			case '>':	entity = "&gt;"; break;
+			case '&':	entity = "&amp;"; break;
+			case '\'':	entity = "&apos;"; break;
+			case '"':	entity = "&quot;"; break;
+			default:	continue;
+		}
+
+		m_data.append( start, str - start );
+		m_data.append( entity );
+		start = str + 1;
+	}
+
+	m_data.append( start, end - start );
+}
+
+void cXml_Writer :: Write_Line_Start( void )
+{
+	m_data.push_back( '\n' );
+	// one tab for each open element
+	m_data.append( m_tags.size() / 2, '\t' );
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
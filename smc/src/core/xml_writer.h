@@ -0,0 +1,94 @@
+/***************************************************************************
+ * xml_writer.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_XML_WRITER_H
+#define SMC_XML_WRITER_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL.h"
+#include <cstring>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cXml_Writer *** *** *** *** *** *** *** *** *** *** */
+
+/* Writes XML into a growing buffer
+ * strings are written as UTF-8 and numbers are converted directly into the buffer
+ * the output has the same elements and attributes as the CEGUI serializer
+ * and the whole buffer is written to the file at once
+*/
+class cXml_Writer
+{
+public:
+	// starts with the XML declaration
+	cXml_Writer( void );
+
+	// Open an element which gets the following attributes and elements
+	cXml_Writer &Open_Tag( const char *name );
+	inline cXml_Writer &Open_Tag( const std::string &name )
+	{
+		return Open_Tag( name.c_str() );
+	}
+	// Close the last opened element
+	cXml_Writer &Close_Tag( void );
+
+	// Add an attribute to the opened element
+	cXml_Writer &Attribute( const char *name, const char *value, size_t length );
+	inline cXml_Writer &Attribute( const char *name, const char *value )
+	{
+		return Attribute( name, value, strlen( value ) );
+	}
+	inline cXml_Writer &Attribute( const char *name, const std::string &value )
+	{
+		return Attribute( name, value.data(), value.length() );
+	}
+	cXml_Writer &Attribute( const char *name, int value );
+	cXml_Writer &Attribute( const char *name, unsigned int value );
+	cXml_Writer &Attribute( const char *name, Uint64 value );
+	cXml_Writer &Attribute( const char *name, long value );
+	// written like the CEGUI float conversion
+	cXml_Writer &Attribute( const char *name, float value );
+
+	// Close all elements and return the data
+	std::string &Get_Data( void );
+	/* Close all elements and write the data to the file
+	 * returns false if the file could not be written
+	*/
+	bool Save( const std::string &filename );
+
+private:
+	// Write the start of an attribute
+	void Write_Attribute_Name( const char *name );
+	// Write the number digits followed by the attribute end
+	void Write_Number( Uint64 value, bool negative );
+	// Write the text with the XML entities
+	void Write_Escaped( const char *str, size_t length );
+	// Start a new line with the indentation of the element depth
+	void Write_Line_Start( void );
+
+	std::string m_data;
+	// offset and length of the open element names in the data
+	vector<size_t> m_tags;
+	// if the start tag of the last element is not yet closed
+	bool m_tag_open;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -56,6 +56,7 @@ cTurtleBoss :: ~cTurtleBoss( void )
 void cTurtleBoss :: Init( void )
 {
 	m_type = TYPE_TURTLE_BOSS;
+	m_col_valid_massive = COL_MASK_MASSIVE | COL_MASK_HALFMASSIVE | COL_MASK_PASSIVE;
 	m_pos_z = 0.092f;
 	m_gravity_max = 19.0f;
 
@@ -114,10 +115,10 @@ void cTurtleBoss :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Level_Ends_If_Killed( attributes.getValueAsBool( "level_ends_if_killed", m_level_ends_if_killed ) );
 }
 
-void cTurtleBoss :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cTurtleBoss :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// name
 	Write_Property( stream, "type", "turtleboss" );
@@ -138,7 +139,7 @@ void cTurtleBoss :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "level_ends_if_killed", m_level_ends_if_killed );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cTurtleBoss :: Set_Max_Hits( int nmax_hits )
@@ -706,10 +707,7 @@ void cTurtleBoss :: Throw_Fireballs( unsigned int amount /* = 6 */ )
 		m_sprite_manager->Add( ball );
 	}
 
-	cAnimation_Fireball *anim = new cAnimation_Fireball( m_sprite_manager, m_pos_x + ( m_col_rect.m_w / 2 ), m_pos_y + ( m_col_rect.m_h / 3 ), 10 );
-	anim->Set_Fading_Speed( 0.15f );
-	anim->Set_Pos_Z( m_pos_z + 0.000001f );
-	pActive_Animation_Manager->Add( anim );
+	pActive_Animation_Manager->Add_Fireball( m_pos_x + ( m_col_rect.m_w / 2 ), m_pos_y + ( m_col_rect.m_h / 3 ), 10, 0.15f, m_pos_z + 0.000001f );
 }
 
 void cTurtleBoss :: Generate_Stars( unsigned int amount /* = 1 */, float particle_scale /* = 0.4f */ ) const
@@ -55,7 +55,7 @@ public:
 	// load from stream
 	virtual void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream );
+	virtual void Save_To_XML( cXml_Writer &stream );
 
 	// maximum hits until downgrade
 	void Set_Max_Hits( int nmax_hits );
@@ -20,6 +20,7 @@
 #include "../video/gl_surface.h"
 #include "../core/i18n.h"
 #include "../core/filesystem/filesystem.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -53,6 +54,7 @@ cEato :: ~cEato( void )
 void cEato :: Init( void )
 {
 	m_type = TYPE_EATO;
+	m_col_valid_massive = COL_MASK_MASSIVE;
 	m_camera_range = 1000;
 	m_pos_z = 0.087f;
 	m_can_be_on_ground = 0;
@@ -86,10 +88,10 @@ void cEato :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Direction( Get_Direction_Id( attributes.getValueAsString( "direction", Get_Direction_Name( m_start_direction ) ).c_str() ) );
 }
 
-void cEato :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cEato :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// name
 	Write_Property( stream, "type", "eato" );
@@ -103,7 +105,7 @@ void cEato :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "direction", Get_Direction_Name( m_start_direction ) );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cEato :: Set_Image_Dir( std::string dir )
@@ -307,6 +309,8 @@ Col_Valid_Type cEato :: Validate_Collision( cSprite *obj )
 
 void cEato :: Handle_Collision_Player( cObjectCollision *collision )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	// unknown direction
 	if( collision->m_direction == DIR_UNDEFINED )
 	{
@@ -314,17 +318,17 @@ void cEato :: Handle_Collision_Player( cObjectCollision *collision )
 	}
 
 	// only if not invincible
-	if( pLevel_Player->m_invincible <= 0.0f )
+	if( level_player->m_invincible <= 0.0f )
 	{
 		// if player is big and not a bottom collision
-		if( pLevel_Player->m_maryo_type != MARYO_SMALL && ( collision->m_direction != DIR_BOTTOM ) )
+		if( level_player->m_maryo_type != MARYO_SMALL && ( collision->m_direction != DIR_BOTTOM ) )
 		{
 			// todo : create again
 			//pAudio->PlaySound( "player/maryo_au.ogg", RID_MARYO_AU );
-			pLevel_Player->Action_Jump( 1 );
+			level_player->Action_Jump( 1 );
 		}
 
-		pLevel_Player->DownGrade_Player();
+		level_player->DownGrade_Player();
 	}
 }
 
@@ -43,7 +43,7 @@ public:
 	// load from stream
 	virtual void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream );
+	virtual void Save_To_XML( cXml_Writer &stream );
 
 	// Set the image directory
 	void Set_Image_Dir( std::string dir );
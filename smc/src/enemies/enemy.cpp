@@ -20,10 +20,19 @@
 #include "../core/game_core.h"
 #include "../level/level_player.h"
 #include "../level/level_manager.h"
+#include "../core/update_workers.h"
+#include "../core/engine_context.h"
+// boost
+#include <boost/bind.hpp>
 
 namespace SMC
 {
 
+// distance from the camera from which the update rate is halved
+static const float enemy_lod_near_distance = 300.0f;
+// distance from the camera from which only every fourth frame is updated
+static const float enemy_lod_far_distance = 800.0f;
+
 /* *** *** *** *** *** *** cEnemy *** *** *** *** *** *** *** *** *** *** *** */
 
 cEnemy :: cEnemy( cSprite_Manager *sprite_manager )
@@ -48,11 +57,29 @@ cEnemy :: cEnemy( cSprite_Manager *sprite_manager )
 
 	m_fire_resistant = 0;
 	m_can_be_hit_from_shell = 1;
+
+	m_random.Seed( Get_Random_Seed() );
+
+	m_lod_skip = 0;
+	m_lod_accumulated = 0;
+	m_lod_frames = 0;
+	m_lod_speed_factor = 0.0f;
+	m_lod_elapsed_ticks = 0;
+
+	m_player_in_trigger = 0;
+	m_trigger_set = 0;
 }
 
 cEnemy :: ~cEnemy( void )
 {
+	Remove_Trigger_Rect();
+}
 
+void cEnemy :: Set_Sprite_Manager( cSprite_Manager *sprite_manager )
+{
+	// the detection rect is set again with the next update
+	Remove_Trigger_Rect();
+	cAnimated_Sprite::Set_Sprite_Manager( sprite_manager );
 }
 
 void cEnemy :: Load_From_Savegame( cSave_Level_Object *save_object )
@@ -112,8 +139,8 @@ cSave_Level_Object *cEnemy :: Save_To_Savegame( void )
 
 	// default values
 	save_object->m_type = m_type;
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posx", int_to_string( static_cast<int>(m_start_pos_x) ) ) );
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posy", int_to_string( static_cast<int>(m_start_pos_y) ) ) );
+	save_object->m_posx = static_cast<int>(m_start_pos_x);
+	save_object->m_posy = static_cast<int>(m_start_pos_y);
 
 
 
@@ -187,11 +214,13 @@ void cEnemy :: Update( void )
 
 void cEnemy :: Update_Late( void )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	// another object controls me
 	if( m_state == STA_OBJ_LINKED )
 	{
 		// todo: have a parent pointer and use that instead of always the player
-		Move( pLevel_Player->m_velx, pLevel_Player->m_vely );
+		Move( level_player->m_velx, level_player->m_vely );
 
 		// handle collisions manually
 		m_massive_type = MASS_MASSIVE;
@@ -203,6 +232,108 @@ void cEnemy :: Update_Late( void )
 	}
 }
 
+bool cEnemy :: Is_Sleep_Valid( void ) const
+{
+	// collisions need to be handled
+	if( !m_collisions.empty() )
+	{
+		return 0;
+	}
+
+	// if destroyed
+	if( m_auto_destroy )
+	{
+		return 1;
+	}
+
+	// dying animation
+	if( m_dead )
+	{
+		return !m_active;
+	}
+
+	// frozen or another object controls me
+	if( m_freeze_counter > 0.0f || m_state == STA_OBJ_LINKED )
+	{
+		return 0;
+	}
+
+	// enemies are only updated in range
+	return !Is_In_Range();
+}
+
+bool cEnemy :: Is_Enemy_Update_Parallel( void ) const
+{
+	if( m_dead || m_freeze_counter > 0.0f || m_lod_accumulated )
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+void cEnemy :: Update_LOD( const GL_rect &camera_rect )
+{
+	m_lod_frames++;
+	m_lod_speed_factor += pFramerate->m_speed_factor;
+	m_lod_elapsed_ticks += pFramerate->m_elapsed_ticks;
+
+	unsigned int interval = 1;
+
+	// dying, frozen or linked enemies always update
+	if( !m_dead && m_freeze_counter <= 0.0f && m_state != STA_OBJ_LINKED )
+	{
+		const float dist_x = std::max( camera_rect.m_x - ( m_col_rect.m_x + m_col_rect.m_w ), m_col_rect.m_x - ( camera_rect.m_x + camera_rect.m_w ) );
+		const float dist_y = std::max( camera_rect.m_y - ( m_col_rect.m_y + m_col_rect.m_h ), m_col_rect.m_y - ( camera_rect.m_y + camera_rect.m_h ) );
+		const float dist = std::max( dist_x, dist_y );
+
+		if( dist > enemy_lod_far_distance )
+		{
+			interval = 4;
+		}
+		else if( dist > enemy_lod_near_distance )
+		{
+			interval = 2;
+		}
+	}
+
+	m_lod_skip = m_lod_frames < interval;
+
+	if( m_lod_skip )
+	{
+		return;
+	}
+
+	m_lod_accumulated = m_lod_frames > 1;
+
+	// updated with the current speed factor
+	if( !m_lod_accumulated )
+	{
+		m_lod_frames = 0;
+		m_lod_speed_factor = 0.0f;
+		m_lod_elapsed_ticks = 0;
+	}
+}
+
+void cEnemy :: Update_Accumulated( void )
+{
+	const float speed_factor = pFramerate->m_speed_factor;
+	const Uint32 elapsed_ticks = pFramerate->m_elapsed_ticks;
+
+	pFramerate->m_speed_factor = m_lod_speed_factor;
+	pFramerate->m_elapsed_ticks = m_lod_elapsed_ticks;
+
+	Update();
+
+	pFramerate->m_speed_factor = speed_factor;
+	pFramerate->m_elapsed_ticks = elapsed_ticks;
+
+	m_lod_accumulated = 0;
+	m_lod_frames = 0;
+	m_lod_speed_factor = 0.0f;
+	m_lod_elapsed_ticks = 0;
+}
+
 void cEnemy :: Update_Velocity( void )
 {
 	// note: this is currently only useful for walker enemy types
@@ -245,7 +376,11 @@ void cEnemy :: Update_Gravity( void )
 		// below ground
 		if( m_col_rect.m_y > pActive_Camera->m_limit_rect.m_y )
 		{
-			DownGrade( 1 );
+			// dies after the parallel update
+			if( !pUpdate_Workers || !pUpdate_Workers->Defer( boost::bind( &cMovingSprite::DownGrade, this, 1 ) ) )
+			{
+				DownGrade( 1 );
+			}
 		}
 	}
 	// has ground object
@@ -275,7 +410,7 @@ void cEnemy :: Generate_Hit_Animation( cParticle_Emitter *anim /* = NULL */ ) co
 	anim->Set_Quota( 4 );
 	anim->Set_Pos_Z( m_pos_z - 0.000001f );
 	anim->Set_Time_to_Live( 0.3f );
-	Color col_rand = Color( static_cast<Uint8>( rand() % 5 ), rand() % 5, rand() % 100, 0 );
+	Color col_rand = Color( static_cast<Uint8>( anim->m_random.Get_Int( 5 ) ), anim->m_random.Get_Int( 5 ), anim->m_random.Get_Int( 100 ), 0 );
 	// not bright enough
 	/*if( col_rand.red + col_rand.green + col_rand.blue < 250 )
 	{
@@ -324,6 +459,30 @@ void cEnemy :: Handle_Collision( cObjectCollision *collision )
 	cAnimated_Sprite::Handle_Collision( collision );
 }
 
+void cEnemy :: Set_Trigger_Rect( const GL_rect &rect )
+{
+	if( m_trigger_set && m_trigger_rect.m_x == rect.m_x && m_trigger_rect.m_y == rect.m_y && m_trigger_rect.m_w == rect.m_w && m_trigger_rect.m_h == rect.m_h )
+	{
+		return;
+	}
+
+	m_trigger_rect = rect;
+	m_trigger_set = 1;
+	m_sprite_manager->Set_Trigger( this, rect );
+}
+
+void cEnemy :: Remove_Trigger_Rect( void )
+{
+	if( !m_trigger_set )
+	{
+		return;
+	}
+
+	m_sprite_manager->Remove_Trigger( this );
+	m_trigger_set = 0;
+	m_player_in_trigger = 0;
+}
+
 void cEnemy :: Handle_out_of_Level( ObjectDirection dir )
 {
 	if( dir == DIR_LEFT )
@@ -341,6 +500,16 @@ void cEnemy :: Handle_out_of_Level( ObjectDirection dir )
 	}
 }
 
+void cEnemy :: Handle_Trigger_Enter( void )
+{
+	m_player_in_trigger = 1;
+}
+
+void cEnemy :: Handle_Trigger_Leave( void )
+{
+	m_player_in_trigger = 0;
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 } // namespace SMC
@@ -19,6 +19,7 @@
 #include "../objects/animated_sprite.h"
 #include "../core/framerate.h"
 #include "../audio/audio.h"
+#include "../core/math/random.h"
 
 namespace SMC
 {
@@ -33,6 +34,9 @@ public:
 	// destructor
 	virtual ~cEnemy( void );
 
+	// Set the parent sprite manager
+	virtual void Set_Sprite_Manager( cSprite_Manager *sprite_manager );
+
 	// load from savegame
 	virtual void Load_From_Savegame( cSave_Level_Object *save_object );
 	// save to savegame
@@ -49,10 +53,31 @@ public:
 	 * use if it is needed that other objects are already updated
 	*/
 	virtual void Update_Late( void );
+	// if the update and collision handling would do nothing
+	virtual bool Is_Sleep_Valid( void ) const;
+	/* if the basic enemy update can run in parallel
+	 * dying or frozen enemies move with collision checks
+	 * and an update with the accumulated speed factor changes the framerate values
+	*/
+	bool Is_Enemy_Update_Parallel( void ) const;
+	/* Set the update rate for the distance to the camera
+	 * called by the sprite manager once in each update before the objects are updated
+	 * only the update decisions are reduced and the movement is still handled every frame
+	*/
+	void Update_LOD( const GL_rect &camera_rect );
+	// Update with the speed factor and elapsed time of the skipped updates
+	void Update_Accumulated( void );
 	// update current velocity if needed
 	void Update_Velocity( void );
 	// update gravity velocity
 	virtual void Update_Gravity( void );
+
+	/* Set the player detection rect
+	 * only passed to the sprite manager if it changed
+	*/
+	void Set_Trigger_Rect( const GL_rect &rect );
+	// Remove the player detection rect
+	void Remove_Trigger_Rect( void );
 	
 	// Generates the default Hit Animation Particles
 	void Generate_Hit_Animation( cParticle_Emitter *anim = NULL ) const;
@@ -61,6 +86,10 @@ public:
 	virtual void Handle_Collision( cObjectCollision *collision );
 	// handle moved out of Level event
 	virtual void Handle_out_of_Level( ObjectDirection dir );
+	// player entered the detection rect
+	virtual void Handle_Trigger_Enter( void );
+	// player left the detection rect
+	virtual void Handle_Trigger_Leave( void );
 
 	// if dead
 	bool m_dead;
@@ -68,8 +97,8 @@ public:
 	// default counter for animations
 	float m_counter;
 
-	// sound filename if got killed
-	std::string m_kill_sound;
+	// sound if got killed
+	cSound_Handle m_kill_sound;
 	// points if enemy got killed
 	unsigned int m_kill_points;
 
@@ -86,6 +115,28 @@ public:
 	bool m_can_be_hit_from_shell;
 	// if this moves into an abyss
 	//bool m_moves_into_abyss;
+
+	/* random numbers for the behavior
+	 * seeded while the level is loaded to repeat with the same level seed
+	*/
+	cRandom m_random;
+
+	// if the update is skipped in this frame
+	bool m_lod_skip;
+	// if the update needs the accumulated speed factor
+	bool m_lod_accumulated;
+	// frames since the last update
+	unsigned int m_lod_frames;
+	// speed factor and elapsed ticks since the last update
+	float m_lod_speed_factor;
+	Uint32 m_lod_elapsed_ticks;
+
+	// if the player is in the detection rect
+	bool m_player_in_trigger;
+	// if the detection rect is set
+	bool m_trigger_set;
+	// the detection rect set in the sprite manager
+	GL_rect m_trigger_rect;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
@@ -23,6 +23,7 @@
 #include "../video/gl_surface.h"
 #include "../core/i18n.h"
 #include "../core/filesystem/filesystem.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -56,6 +57,7 @@ cFlyon :: ~cFlyon( void )
 void cFlyon :: Init( void  )
 {
 	m_type = TYPE_FLYON;
+	m_col_valid_massive = COL_MASK_MASSIVE;
 	m_pos_z = 0.06f;
 	Set_Rotation_Affects_Rect( 1 );
 	m_editor_pos_z = 0.089f;
@@ -72,7 +74,7 @@ void cFlyon :: Init( void  )
 	m_kill_sound = "enemy/flyon/die.ogg";
 	m_kill_points = 100;
 
-	m_wait_time = Get_Random_Float( 0.0f, 70.0f );
+	m_wait_time = m_random.Get_Float( 0.0f, 70.0f );
 	m_move_back = 0;
 }
 
@@ -101,10 +103,10 @@ void cFlyon :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Speed( attributes.getValueAsFloat( "speed", m_speed ) );
 }
 
-void cFlyon :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cFlyon :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// name
 	Write_Property( stream, "type", "flyon" );
@@ -121,7 +123,7 @@ void cFlyon :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "speed", m_speed );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cFlyon :: Load_From_Savegame( cSave_Level_Object *save_object )
@@ -344,6 +346,8 @@ void cFlyon :: Set_Moving_State( Moving_state new_state )
 
 void cFlyon :: Update( void )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	cEnemy::Update();
 
 	if( !m_valid_update || !Is_In_Range() )
@@ -393,7 +397,7 @@ void cFlyon :: Update( void )
 			}
 
 			// if player is in front: wait again
-			if( pLevel_Player->m_maryo_type != MARYO_GHOST && pLevel_Player->m_col_rect.Intersects( rect1 ) )
+			if( level_player->m_maryo_type != MARYO_GHOST && level_player->m_col_rect.Intersects( rect1 ) )
 			{
 				m_wait_time = speedfactor_fps * 2;
 			}
@@ -611,6 +615,11 @@ bool cFlyon :: Is_Update_Valid( void )
 	return 1;
 }
 
+bool cFlyon :: Is_Update_Parallel( void ) const
+{
+	return Is_Enemy_Update_Parallel();
+}
+
 bool cFlyon :: Is_Draw_Valid( void )
 {
 	bool valid = cEnemy::Is_Draw_Valid();
@@ -649,20 +658,22 @@ Col_Valid_Type cFlyon :: Validate_Collision( cSprite *obj )
 
 void cFlyon :: Handle_Collision_Player( cObjectCollision *collision )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	// unknown direction
 	if( collision->m_direction == DIR_UNDEFINED )
 	{
 		return;
 	}
 
-	if( pLevel_Player->m_maryo_type != MARYO_SMALL && !pLevel_Player->m_invincible && collision->m_direction == m_direction )
+	if( level_player->m_maryo_type != MARYO_SMALL && !level_player->m_invincible && collision->m_direction == m_direction )
 	{
 		// todo : create again
 		//pAudio->PlaySound( "player/maryo_au.ogg", RID_MARYO_AU );
-		pLevel_Player->Action_Jump( 1 );
+		level_player->Action_Jump( 1 );
 	}
 
-	pLevel_Player->DownGrade_Player();
+	level_player->DownGrade_Player();
 }
 
 void cFlyon :: Editor_Activate( void )
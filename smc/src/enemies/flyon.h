@@ -42,7 +42,7 @@ public:
 	// load from stream
 	virtual void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream );
+	virtual void Save_To_XML( cXml_Writer &stream );
 
 	// load from savegame
 	virtual void Load_From_Savegame( cSave_Level_Object *save_object );
@@ -80,6 +80,8 @@ public:
 
 	// if update is valid for the current state
 	virtual bool Is_Update_Valid( void );
+	// if the update can run in parallel
+	virtual bool Is_Update_Parallel( void ) const;
 	// if draw is valid for the current state and position
 	virtual bool Is_Draw_Valid( void );
 
@@ -21,6 +21,7 @@
 #include "../video/animation.h"
 #include "../level/level_manager.h"
 #include "../core/sprite_manager.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -54,6 +55,7 @@ cFurball :: ~cFurball( void )
 void cFurball :: Init( void )
 {
 	m_type = TYPE_FURBALL;
+	m_col_valid_massive = COL_MASK_MASSIVE | COL_MASK_HALFMASSIVE | COL_MASK_PASSIVE;
 	m_pos_z = 0.09f;
 	m_gravity_max = 19.0f;
 
@@ -102,10 +104,10 @@ void cFurball :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	}
 }
 
-void cFurball :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cFurball :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// name
 	Write_Property( stream, "type", "furball" );
@@ -125,7 +127,7 @@ void cFurball :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	}
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cFurball :: Load_From_Savegame( cSave_Level_Object *save_object )
@@ -237,6 +239,12 @@ void cFurball :: Set_Color( const DefaultColor &col )
 
 	Set_Image_Num( 0, 1 );
 	Create_Name();
+
+	// the boss has its own type
+	if( m_sprite_manager )
+	{
+		m_sprite_manager->Update_Type( this );
+	}
 }
 
 void cFurball :: Turn_Around( ObjectDirection col_dir /* = DIR_UNDEFINED */ )
@@ -697,6 +705,17 @@ bool cFurball :: Is_Update_Valid( void )
 	return 1;
 }
 
+bool cFurball :: Is_Update_Parallel( void ) const
+{
+	// running creates particles
+	if( m_state == STA_RUN )
+	{
+		return 0;
+	}
+
+	return Is_Enemy_Update_Parallel();
+}
+
 Col_Valid_Type cFurball :: Validate_Collision( cSprite *obj )
 {
 	// basic validation checking
@@ -717,7 +736,7 @@ Col_Valid_Type cFurball :: Validate_Collision( cSprite *obj )
 				if( m_type == TYPE_FURBALL_BOSS )
 				{
 					// player is invincible
-					if( pLevel_Player->m_invincible > 0.0f )
+					if( Get_Context()->Get_Level_Player()->m_invincible > 0.0f )
 					{
 						return COL_VTYPE_NOT_VALID;
 					}
@@ -803,13 +822,15 @@ Col_Valid_Type cFurball :: Validate_Collision( cSprite *obj )
 
 void cFurball :: Handle_Collision_Player( cObjectCollision *collision )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	// invalid
 	if( collision->m_direction == DIR_UNDEFINED )
 	{
 		return;
 	}
 
-	if( collision->m_direction == DIR_TOP && pLevel_Player->m_state != STA_FLY )
+	if( collision->m_direction == DIR_TOP && level_player->m_state != STA_FLY )
 	{
 		if( m_type == TYPE_FURBALL_BOSS )
 		{
@@ -828,17 +849,17 @@ void cFurball :: Handle_Collision_Player( cObjectCollision *collision )
 		}
 
 		DownGrade();
-		pLevel_Player->Action_Jump( 1 );
+		level_player->Action_Jump( 1 );
 
 		if( m_dead )
 		{
 			pHud_Points->Add_Points( m_kill_points, m_pos_x, m_pos_y - 5.0f, "", static_cast<Uint8>(255), 1 );
-			pLevel_Player->Add_Kill_Multiplier();
+			level_player->Add_Kill_Multiplier();
 		}
 	}
 	else
 	{
-		pLevel_Player->DownGrade_Player();
+		level_player->DownGrade_Player();
 
 		if( collision->m_direction == DIR_RIGHT || collision->m_direction == DIR_LEFT )
 		{
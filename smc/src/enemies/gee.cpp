@@ -20,6 +20,7 @@
 #include "../gui/hud.h"
 #include "../input/mouse.h"
 #include "../core/i18n.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -53,6 +54,7 @@ cGee :: ~cGee( void )
 void cGee :: Init( void  )
 {
 	m_type = TYPE_GEE;
+	m_col_valid_massive = COL_MASK_MASSIVE;
 	m_camera_range = 1000;
 	m_pos_z = 0.088f;
 	m_can_be_on_ground = 0;
@@ -106,10 +108,10 @@ void cGee :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Color( static_cast<DefaultColor>(Get_Color_Id( attributes.getValueAsString( "color", Get_Color_Name( m_color_type ) ).c_str() )) );
 }
 
-void cGee :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cGee :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// name
 	Write_Property( stream, "type", "gee" );
@@ -130,7 +132,7 @@ void cGee :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "color", Get_Color_Name( m_color_type ) );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cGee :: Load_From_Savegame( cSave_Level_Object *save_object )
@@ -341,7 +343,7 @@ void cGee :: Set_Moving_State( Moving_state new_state )
 		if( m_start_direction == DIR_HORIZONTAL )
 		{
 			// randomize direction
-			if( rand() % 2 != 1 )
+			if( m_random.Get_Int( 2 ) != 1 )
 			{
 				m_direction = DIR_RIGHT;
 				m_velx = m_speed_fly;
@@ -359,7 +361,7 @@ void cGee :: Set_Moving_State( Moving_state new_state )
 			m_velx = 0.0f;
 			
 			// randomize direction
-			if( rand() % 2 != 1 )
+			if( m_random.Get_Int( 2 ) != 1 )
 			{
 				m_direction = DIR_DOWN;
 				m_vely = m_speed_fly;
@@ -621,44 +623,46 @@ Col_Valid_Type cGee :: Validate_Collision( cSprite *obj )
 
 void cGee :: Handle_Collision_Player( cObjectCollision *collision )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	// unknown direction
 	if( collision->m_direction == DIR_UNDEFINED )
 	{
 		return;
 	}
 
-	if( collision->m_direction == DIR_TOP && pLevel_Player->m_state != STA_FLY )
+	if( collision->m_direction == DIR_TOP && level_player->m_state != STA_FLY )
 	{
 		pAudio->Play_Sound( m_kill_sound );
 
 		DownGrade();
-		pLevel_Player->Action_Jump( 1 );
+		level_player->Action_Jump( 1 );
 
 		pHud_Points->Add_Points( m_kill_points, m_pos_x, m_pos_y - 5.0f, "", static_cast<Uint8>(255), 1 );
-		pLevel_Player->Add_Kill_Multiplier();
+		level_player->Add_Kill_Multiplier();
 	}
-	else if( !pLevel_Player->m_invincible )
+	else if( !level_player->m_invincible )
 	{
-		if( pLevel_Player->m_maryo_type != MARYO_SMALL )
+		if( level_player->m_maryo_type != MARYO_SMALL )
 		{
 			// todo : create again
 			//pAudio->PlaySound( "player/maryo_au.ogg", RID_MARYO_AU );
 
 			if( collision->m_direction == DIR_BOTTOM  )
 			{
-				pLevel_Player->Action_Jump( 1 );
+				level_player->Action_Jump( 1 );
 			}
 			else if( collision->m_direction == DIR_LEFT )
 			{
-				pLevel_Player->m_velx = -7.0f;
+				level_player->m_velx = -7.0f;
 			}
 			else if( collision->m_direction == DIR_RIGHT )
 			{
-				pLevel_Player->m_velx = 7.0f;
+				level_player->m_velx = 7.0f;
 			}
 		}
 
-		pLevel_Player->DownGrade_Player();
+		level_player->DownGrade_Player();
 
 		if( collision->m_direction == DIR_RIGHT || collision->m_direction == DIR_LEFT )
 		{
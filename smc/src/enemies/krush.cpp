@@ -22,6 +22,7 @@
 #include "../user/savegame.h"
 #include "../core/i18n.h"
 #include "../core/sprite_manager.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -54,6 +55,7 @@ cKrush :: ~cKrush( void )
 void cKrush :: Init( void  )
 {
 	m_type = TYPE_KRUSH;
+	m_col_valid_massive = COL_MASK_MASSIVE | COL_MASK_HALFMASSIVE | COL_MASK_PASSIVE;
 	m_pos_z = 0.093f;
 	m_gravity_max = 27.0f;
 
@@ -89,10 +91,10 @@ void cKrush :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Direction( Get_Direction_Id( attributes.getValueAsString( "direction", Get_Direction_Name( m_start_direction ) ).c_str() ) );
 }
 
-void cKrush :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cKrush :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// name
 	Write_Property( stream, "type", "krush" );
@@ -103,7 +105,7 @@ void cKrush :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "direction", Get_Direction_Name( m_start_direction ) );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cKrush :: Load_From_Savegame( cSave_Level_Object *save_object )
@@ -312,6 +314,11 @@ bool cKrush :: Is_Update_Valid( void )
 	return 1;
 }
 
+bool cKrush :: Is_Update_Parallel( void ) const
+{
+	return Is_Enemy_Update_Parallel();
+}
+
 Col_Valid_Type cKrush :: Validate_Collision( cSprite *obj )
 {
 	// basic validation checking
@@ -375,13 +382,15 @@ Col_Valid_Type cKrush :: Validate_Collision( cSprite *obj )
 
 void cKrush :: Handle_Collision_Player( cObjectCollision *collision )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	// invalid
 	if( collision->m_direction == DIR_UNDEFINED )
 	{
 		return;
 	}
 
-	if( collision->m_direction == DIR_TOP && pLevel_Player->m_state != STA_FLY )
+	if( collision->m_direction == DIR_TOP && level_player->m_state != STA_FLY )
 	{
 		pHud_Points->Add_Points( m_kill_points, m_pos_x, m_pos_y - 5.0f, "", static_cast<Uint8>(255), 1 );
 		pAudio->Play_Sound( m_kill_sound );
@@ -395,14 +404,14 @@ void cKrush :: Handle_Collision_Player( cObjectCollision *collision )
 		else if( m_state == STA_RUN )
 		{
 			DownGrade();
-			pLevel_Player->Add_Kill_Multiplier();
+			level_player->Add_Kill_Multiplier();
 		}
 
-		pLevel_Player->Action_Jump( 1 );
+		level_player->Action_Jump( 1 );
 	}
 	else
 	{
-		pLevel_Player->DownGrade_Player();
+		level_player->DownGrade_Player();
 		Turn_Around( collision->m_direction );
 	}
 }
@@ -22,6 +22,7 @@
 #include "../video/renderer.h"
 #include "../input/mouse.h"
 #include "../core/i18n.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -56,6 +57,7 @@ void cRokko :: Init( void  )
 {
 	m_type = TYPE_ROKKO;
 	m_massive_type = MASS_PASSIVE;
+	m_col_valid_massive = COL_MASK_MASSIVE;
 	m_pos_z = 0.03f;
 	m_gravity_max = 26.0f;
 	m_editor_pos_z = 0.09f;
@@ -100,10 +102,10 @@ void cRokko :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Speed( attributes.getValueAsFloat( "speed", m_speed ) );
 }
 
-void cRokko :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cRokko :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// name
 	Write_Property( stream, "type", "rokko" );
@@ -116,7 +118,7 @@ void cRokko :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "speed", m_speed );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cRokko :: Load_From_Savegame( cSave_Level_Object *save_object )
@@ -221,6 +223,8 @@ void cRokko :: Activate( bool with_sound /* = 1 */ )
 	m_state = STA_FLY;
 	m_massive_type = MASS_MASSIVE;
 	Set_Active( 1 );
+	// flies until it is destroyed
+	Remove_Trigger_Rect();
 
 	if( m_direction == DIR_LEFT )
 	{
@@ -305,10 +309,11 @@ void cRokko :: Update( void )
 	// if not active
 	if( m_state != STA_FLY )
 	{
-		GL_rect final_distance = Get_Final_Distance_Rect();
+		// the player is checked by the sprite manager
+		Set_Trigger_Rect( Get_Final_Distance_Rect() );
 
 		// if player is in front then activate
-		if( pLevel_Player->m_maryo_type != MARYO_GHOST && pLevel_Player->m_col_rect.Intersects( final_distance ) )
+		if( m_player_in_trigger && Get_Context()->Get_Level_Player()->m_maryo_type != MARYO_GHOST )
 		{
 			Activate();
 		}
@@ -554,6 +559,8 @@ Col_Valid_Type cRokko :: Validate_Collision( cSprite *obj )
 
 void cRokko :: Handle_Collision_Player( cObjectCollision *collision )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	// if invalid
 	if( collision->m_direction == DIR_UNDEFINED )
 	{
@@ -563,38 +570,38 @@ void cRokko :: Handle_Collision_Player( cObjectCollision *collision )
 	if( m_direction == DIR_LEFT || m_direction == DIR_RIGHT )
 	{
 		// if invincible
-		if( pLevel_Player->m_invincible > 0.0f )
+		if( level_player->m_invincible > 0.0f )
 		{
 			return;
 		}
 
-		if( collision->m_direction == DIR_TOP && pLevel_Player->m_state != STA_FLY )
+		if( collision->m_direction == DIR_TOP && level_player->m_state != STA_FLY )
 		{
 			pHud_Points->Add_Points( m_kill_points, m_pos_x + m_rect.m_w / 3, m_pos_y - 10.0f, "", static_cast<Uint8>(255), 1 );
 			pAudio->Play_Sound( m_kill_sound );
-			pLevel_Player->Action_Jump( 1 );
+			level_player->Action_Jump( 1 );
 
-			pLevel_Player->Add_Kill_Multiplier();
+			level_player->Add_Kill_Multiplier();
 			DownGrade();
 		}
 		else
 		{
-			pLevel_Player->DownGrade_Player();
+			level_player->DownGrade_Player();
 		}
 	}
 	else if( m_direction == DIR_UP || m_direction == DIR_DOWN )
 	{
-		if( ( collision->m_direction == DIR_LEFT || collision->m_direction == DIR_LEFT ) && pLevel_Player->m_state == STA_FLY )
+		if( ( collision->m_direction == DIR_LEFT || collision->m_direction == DIR_LEFT ) && level_player->m_state == STA_FLY )
 		{
 			pHud_Points->Add_Points( m_kill_points, m_pos_x, m_pos_y - 5.0f, "", static_cast<Uint8>(255), 1 );
 			pAudio->Play_Sound( m_kill_sound );
 
-			pLevel_Player->Add_Kill_Multiplier();
+			level_player->Add_Kill_Multiplier();
 			DownGrade();
 		}
 		else
 		{
-			pLevel_Player->DownGrade_Player();
+			level_player->DownGrade_Player();
 		}
 	}
 }
@@ -21,6 +21,7 @@
 #include "../video/gl_surface.h"
 #include "../core/sprite_manager.h"
 #include "../core/i18n.h"
+#include "../core/engine_context.h"
 #include "../enemies/bosses/turtle_boss.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
@@ -51,6 +52,7 @@ cSpika :: ~cSpika( void )
 void cSpika :: Init( void )
 {
 	m_type = TYPE_SPIKA;
+	m_col_valid_massive = COL_MASK_MASSIVE | COL_MASK_HALFMASSIVE | COL_MASK_PASSIVE;
 	m_pos_z = 0.09f;
 	m_gravity_max = 25.0f;
 
@@ -78,10 +80,10 @@ void cSpika :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Color( static_cast<DefaultColor>(Get_Color_Id( attributes.getValueAsString( "color", Get_Color_Name( m_color_type ) ).c_str() )) );
 }
 
-void cSpika :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cSpika :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// name
 	Write_Property( stream, "type", "spika" );
@@ -92,7 +94,7 @@ void cSpika :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "color", Get_Color_Name( m_color_type ) );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cSpika :: Set_Color( DefaultColor col )
@@ -201,6 +203,8 @@ void cSpika :: Update_Dying( void )
 
 void cSpika :: Update( void )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	cEnemy::Update();
 
 	if( !m_valid_update || !Is_In_Range() )
@@ -215,8 +219,8 @@ void cSpika :: Update( void )
 	}
 
 	// check for player
-	GL_rect player_rect = pLevel_Player->m_col_rect;
-	player_rect.m_x += ( pLevel_Player->m_col_rect.m_w / 2 );
+	GL_rect player_rect = level_player->m_col_rect;
+	player_rect.m_x += ( level_player->m_col_rect.m_w / 2 );
 	player_rect.m_w = 1;
 
 	// rect
@@ -234,7 +238,7 @@ void cSpika :: Update( void )
 
 
 	// if player is left
-	if( pLevel_Player->m_maryo_type != MARYO_GHOST && player_rect.Intersects( rect_left ) )
+	if( level_player->m_maryo_type != MARYO_GHOST && player_rect.Intersects( rect_left ) )
 	{
 		if( m_velx > -m_speed )
 		{
@@ -247,7 +251,7 @@ void cSpika :: Update( void )
 		}
 	}
 	// if player is right
-	else if( pLevel_Player->m_maryo_type != MARYO_GHOST && player_rect.Intersects( rect_right ) )
+	else if( level_player->m_maryo_type != MARYO_GHOST && player_rect.Intersects( rect_right ) )
 	{
 		if( m_velx < m_speed )
 		{
@@ -287,6 +291,11 @@ bool cSpika :: Is_Update_Valid( void )
 	return 1;
 }
 
+bool cSpika :: Is_Update_Parallel( void ) const
+{
+	return Is_Enemy_Update_Parallel();
+}
+
 Col_Valid_Type cSpika :: Validate_Collision( cSprite *obj )
 {
 	// basic validation checking
@@ -361,7 +370,7 @@ Col_Valid_Type cSpika :: Validate_Collision( cSprite *obj )
 
 void cSpika :: Handle_Collision_Player( cObjectCollision *collision )
 {
-	pLevel_Player->DownGrade_Player();
+	Get_Context()->Get_Level_Player()->DownGrade_Player();
 
 	if( collision->m_direction == DIR_LEFT || collision->m_direction == DIR_RIGHT )
 	{
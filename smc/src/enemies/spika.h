@@ -44,7 +44,7 @@ public:
 	// load from stream
 	virtual void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream );
+	virtual void Save_To_XML( cXml_Writer &stream );
 
 	// set color
 	void Set_Color( DefaultColor col );
@@ -61,6 +61,8 @@ public:
 
 	// if update is valid for the current state
 	virtual bool Is_Update_Valid( void );
+	// if the update can run in parallel
+	virtual bool Is_Update_Parallel( void ) const;
 
 	/* Validate the given collision object
 	 * returns 0 if not valid
@@ -20,6 +20,7 @@
 #include "../core/i18n.h"
 #include "../video/animation.h"
 #include "../core/sprite_manager.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -52,6 +53,7 @@ cSpikeball :: ~cSpikeball( void )
 void cSpikeball :: Init( void )
 {
 	m_type = TYPE_SPIKEBALL;
+	m_col_valid_massive = COL_MASK_MASSIVE | COL_MASK_HALFMASSIVE | COL_MASK_PASSIVE;
 	m_pos_z = 0.09f;
 	m_gravity_max = 29.0f;
 
@@ -86,10 +88,10 @@ void cSpikeball :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Direction( Get_Direction_Id( attributes.getValueAsString( "direction", Get_Direction_Name( m_start_direction ) ).c_str() ) );
 }
 
-void cSpikeball :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cSpikeball :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// name
 	Write_Property( stream, "type", "spikeball" );
@@ -102,7 +104,7 @@ void cSpikeball :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "direction", Get_Direction_Name( m_start_direction ) );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cSpikeball :: Load_From_Savegame( cSave_Level_Object *save_object )
@@ -278,7 +280,7 @@ void cSpikeball :: Set_Moving_State( Moving_state new_state )
 	else if( new_state == STA_WALK )
 	{
 		m_counter_running = 0.0f;
-		m_counter_walk = Get_Random_Float( 0.0f, 80.0f );
+		m_counter_walk = m_random.Get_Float( 0.0f, 80.0f );
 
 		Set_Animation( 1 );
 		Set_Animation_Image_Range( 0, 7 );
@@ -334,7 +336,7 @@ void cSpikeball :: Update( void )
 			Set_Image_Num( 8 );
 
 			// random direction
-			if( ( rand() % 2 ) == 1 )
+			if( m_random.Get_Int( 2 ) == 1 )
 			{
 				// turn around
 				m_direction = Get_Opposite_Direction( m_direction );
@@ -554,7 +556,7 @@ void cSpikeball :: Handle_Collision_Player( cObjectCollision *collision )
 		return;
 	}
 
-	pLevel_Player->DownGrade_Player();
+	Get_Context()->Get_Level_Player()->DownGrade_Player();
 
 	if( collision->m_direction == DIR_RIGHT || collision->m_direction == DIR_LEFT )
 	{
@@ -23,6 +23,7 @@
 #include "../core/i18n.h"
 #include "../objects/path.h"
 #include "../core/filesystem/filesystem.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -56,6 +57,7 @@ cStaticEnemy :: ~cStaticEnemy( void )
 void cStaticEnemy :: Init( void )
 {
 	m_type = TYPE_STATIC_ENEMY;
+	m_col_valid_massive = COL_MASK_MASSIVE;
 	m_pos_z = 0.094f;
 	m_can_be_on_ground = 0;
 	m_can_be_hit_from_shell = 0;
@@ -103,10 +105,10 @@ void cStaticEnemy :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	m_ice_resistance = static_cast<float>( attributes.getValueAsFloat( "ice_resistance", m_ice_resistance ) );
 }
 
-void cStaticEnemy :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cStaticEnemy :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// name
 	Write_Property( stream, "type", "static" );
@@ -127,12 +129,12 @@ void cStaticEnemy :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "ice_resistance", m_ice_resistance );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cStaticEnemy :: Set_Sprite_Manager( cSprite_Manager *sprite_manager )
 {
-	cSprite::Set_Sprite_Manager( sprite_manager );
+	cEnemy::Set_Sprite_Manager( sprite_manager );
 	m_path_state.Set_Sprite_Manager( sprite_manager );
 }
 
@@ -339,7 +341,7 @@ Col_Valid_Type cStaticEnemy :: Validate_Collision( cSprite *obj )
 
 void cStaticEnemy :: Handle_Collision_Player( cObjectCollision *collision )
 {
-	pLevel_Player->DownGrade_Player();
+	Get_Context()->Get_Level_Player()->DownGrade_Player();
 }
 
 void cStaticEnemy :: Handle_Collision_Enemy( cObjectCollision *collision )
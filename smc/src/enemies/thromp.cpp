@@ -25,6 +25,7 @@
 #include "../input/mouse.h"
 #include "../core/i18n.h"
 #include "../core/filesystem/filesystem.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -58,6 +59,7 @@ cThromp :: ~cThromp( void )
 void cThromp :: Init( void  )
 {
 	m_type = TYPE_THROMP;
+	m_col_valid_massive = COL_MASK_ALL;
 	m_pos_z = 0.093f;
 	m_camera_range = 1000;
 	m_can_be_on_ground = 0;
@@ -101,10 +103,10 @@ void cThromp :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Speed( attributes.getValueAsFloat( "speed", m_speed ) );
 }
 
-void cThromp :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cThromp :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// name
 	Write_Property( stream, "type", "thromp" );
@@ -121,7 +123,7 @@ void cThromp :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "speed", m_speed );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cThromp :: Load_From_Savegame( cSave_Level_Object *save_object )
@@ -327,10 +329,11 @@ void cThromp :: Update( void )
 	// standing ( waiting )
 	if( m_state == STA_STAY )
 	{
-		GL_rect final_distance = Get_Final_Distance_Rect();
+		// the player is checked by the sprite manager
+		Set_Trigger_Rect( Get_Final_Distance_Rect() );
 
 		// if player is in front then activate
-		if( pLevel_Player->m_maryo_type != MARYO_GHOST && pLevel_Player->m_col_rect.Intersects( final_distance ) )
+		if( m_player_in_trigger && Get_Context()->Get_Level_Player()->m_maryo_type != MARYO_GHOST )
 		{
 			Activate();
 		}
@@ -696,7 +699,7 @@ void cThromp :: Handle_Collision_Player( cObjectCollision *collision )
 	// front
 	if( collision->m_direction == m_direction )
 	{
-		pLevel_Player->DownGrade_Player();
+		Get_Context()->Get_Level_Player()->DownGrade_Player();
 
 		if( Move_Back() )
 		{
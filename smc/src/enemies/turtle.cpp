@@ -24,6 +24,7 @@
 #include "../user/savegame.h"
 #include "../core/sprite_manager.h"
 #include "../core/i18n.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -56,6 +57,9 @@ cTurtle :: ~cTurtle( void )
 void cTurtle :: Init( void )
 {
 	m_type = TYPE_TURTLE;
+	m_col_valid_massive = COL_MASK_MASSIVE | COL_MASK_HALFMASSIVE | COL_MASK_PASSIVE;
+	// items are passive and only passive enemy stoppers and boxes are accepted
+	m_col_layer_mask = COL_LAYER_SOLID | COL_LAYER_ACTIVE | COL_LAYER_PROJECTILE | COL_LAYER_ENEMY | COL_LAYER_PLAYER;
 	m_pos_z = 0.091f;
 	m_gravity_max = 24.0f;
 
@@ -89,10 +93,10 @@ void cTurtle :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Color( static_cast<DefaultColor>(Get_Color_Id( attributes.getValueAsString( "color", Get_Color_Name( m_color_type ) ).c_str() )) );
 }
 
-void cTurtle :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cTurtle :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// name
 	Write_Property( stream, "type", "turtle" );
@@ -105,7 +109,7 @@ void cTurtle :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "direction", Get_Direction_Name( m_start_direction ) );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cTurtle :: Load_From_Savegame( cSave_Level_Object *save_object )
@@ -467,7 +471,7 @@ void cTurtle :: Update( void )
 		if( m_player_counter <= 0.0f )
 		{
 			// do not start collision detection if colliding with maryo
-			if( pLevel_Player->m_col_rect.Intersects( m_col_rect ) )
+			if( Get_Context()->Get_Level_Player()->m_col_rect.Intersects( m_col_rect ) )
 			{
 				m_player_counter = 5.0f;
 			}
@@ -548,7 +552,7 @@ bool cTurtle :: Hit_Enemy( cEnemy *enemy )
 	pAudio->Play_Sound( enemy->m_kill_sound );
 	pHud_Points->Add_Points( enemy->m_kill_points, m_pos_x + m_image->m_w / 3, m_pos_y - 5.0f, "", static_cast<Uint8>(255), 1 );
 	enemy->DownGrade( 1 );
-	pLevel_Player->Add_Kill_Multiplier();
+	Get_Context()->Get_Level_Player()->Add_Kill_Multiplier();
 
 	// enemies that also hit us
 	if( enemy->m_type == TYPE_SPIKA )
@@ -622,7 +626,7 @@ Col_Valid_Type cTurtle :: Validate_Collision( cSprite *obj )
 			case TYPE_PLAYER:
 			{
 				// player is invincible
-				if( pLevel_Player->m_invincible )
+				if( Get_Context()->Get_Level_Player()->m_invincible )
 				{
 					return COL_VTYPE_NOT_VALID;
 				}
@@ -738,6 +742,8 @@ Col_Valid_Type cTurtle :: Validate_Collision( cSprite *obj )
 
 void cTurtle :: Handle_Collision_Player( cObjectCollision *collision )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	if( collision->m_direction == DIR_UNDEFINED || ( m_turtle_state == TURTLE_SHELL_RUN && m_player_counter > 0.0f ) )
 	{
 		return;
@@ -754,7 +760,7 @@ void cTurtle :: Handle_Collision_Player( cObjectCollision *collision )
 	}
 	
 
-	if( collision->m_direction == DIR_TOP && pLevel_Player->m_state != STA_FLY )
+	if( collision->m_direction == DIR_TOP && level_player->m_state != STA_FLY )
 	{
 		if( m_turtle_state == TURTLE_WALK )
 		{
@@ -786,7 +792,7 @@ void cTurtle :: Handle_Collision_Player( cObjectCollision *collision )
 		if( m_turtle_state == TURTLE_SHELL_RUN )
 		{
 			// if player is on the left side
-			if( ( pLevel_Player->m_col_rect.m_w / 2 ) + pLevel_Player->m_pos_x < ( m_col_rect.m_w / 2 ) + m_pos_x )
+			if( ( level_player->m_col_rect.m_w / 2 ) + level_player->m_pos_x < ( m_col_rect.m_w / 2 ) + m_pos_x )
 			{
 				Set_Direction( DIR_RIGHT );
 				m_velx = m_velx_max;
@@ -799,13 +805,13 @@ void cTurtle :: Handle_Collision_Player( cObjectCollision *collision )
 			}
 		}
 
-		pLevel_Player->Action_Jump( 1 );
+		level_player->Action_Jump( 1 );
 	}
 	else
 	{
 		if( m_turtle_state == TURTLE_WALK )
 		{
-			pLevel_Player->DownGrade_Player();
+			level_player->DownGrade_Player();
 
 			if( collision->m_direction == DIR_RIGHT || collision->m_direction == DIR_LEFT )
 			{
@@ -847,7 +853,7 @@ void cTurtle :: Handle_Collision_Player( cObjectCollision *collision )
 				anim->Set_Direction_Range( 180.0f, 180.0f );
 
 				// if player is on the left side
-				if( ( pLevel_Player->m_col_rect.m_w / 2 ) + pLevel_Player->m_pos_x < ( m_col_rect.m_w / 2 ) + m_pos_x )
+				if( ( level_player->m_col_rect.m_w / 2 ) + level_player->m_pos_x < ( m_col_rect.m_w / 2 ) + m_pos_x )
 				{
 					Set_Direction( DIR_RIGHT );
 					m_velx = m_velx_max;
@@ -862,7 +868,7 @@ void cTurtle :: Handle_Collision_Player( cObjectCollision *collision )
 				// small upwards kick
 				if( collision->m_direction == DIR_BOTTOM )
 				{
-					m_vely = -5.0f + (pLevel_Player->m_vely * 0.3f);
+					m_vely = -5.0f + (level_player->m_vely * 0.3f);
 				}
 			}
 
@@ -876,12 +882,12 @@ void cTurtle :: Handle_Collision_Player( cObjectCollision *collision )
 			if( collision->m_direction == DIR_BOTTOM )
 			{
 				// small upwards kick
-				m_vely = -5.0f + (pLevel_Player->m_vely * 0.3f);
+				m_vely = -5.0f + (level_player->m_vely * 0.3f);
 			}
 			// other directions downgrade
 			else
 			{
-				pLevel_Player->DownGrade_Player();
+				level_player->DownGrade_Player();
 
 				if( collision->m_direction == DIR_RIGHT || collision->m_direction == DIR_LEFT )
 				{
@@ -19,19 +19,89 @@
 #include "../audio/audio.h"
 #include "../video/font.h"
 #include "../core/framerate.h"
+#include "../core/profiler.h"
+#include "../core/object_profiler.h"
+#include "../core/frame_scheduler.h"
+#include "../video/gpu_timer.h"
 #include "../level/level.h"
 #include "../core/sprite_manager.h"
 #include "../objects/bonusbox.h"
 #include "../video/renderer.h"
+#include "../video/img_manager.h"
 #include "../core/i18n.h"
 #include "../core/filesystem/filesystem.h"
+#include "../core/memory_pool.h"
+#include "../core/update_workers.h"
+#include "../video/animation.h"
+#include "../video/render_layer.h"
+#include "../video/video.h"
+#include "../user/preferences.h"
 // CEGUI
 #include "CEGUIWindowManager.h"
 #include "CEGUIFontManager.h"
+// boost
+#include <boost/bind.hpp>
 
 namespace SMC
 {
 
+/* Return the milliseconds per 100 frames and the frame percentiles of the timer
+*/
+static std::string Get_Performance_Text( const cPerformance_Timer *timer )
+{
+	return int_to_string( timer->ms ) + "  " + int_to_string( timer->m_p50 ) + " / " + int_to_string( timer->m_p95 ) + " / " + int_to_string( timer->m_p99 ) + " / " + int_to_string( timer->m_max );
+}
+
+/* Return the milliseconds per 100 frames and the frame percentiles of the profiler section timer
+ * which measures in microseconds
+*/
+static std::string Get_Profiler_Text( const cPerformance_Timer *timer )
+{
+	return float_to_string( timer->ms * 0.001f, 1 ) + "  " + float_to_string( timer->m_p50 * 0.001f, 2 ) + " / " + float_to_string( timer->m_p95 * 0.001f, 2 ) + " / " + float_to_string( timer->m_p99 * 0.001f, 2 ) + " / " + float_to_string( timer->m_max * 0.001f, 2 );
+}
+
+// Returns the object cost as milliseconds per frame of all phases and update, late update, draw and collision with the candidates and collisions per frame
+static std::string Get_Object_Cost_Text( const cObject_Profiler::Cost &cost, unsigned int frames )
+{
+	const float scale = 0.001f / frames;
+
+	return cost.m_name + " : " + float_to_string( cost.Get_Time() * scale, 2 ) + "  " + float_to_string( cost.m_time[cObject_Profiler::PHASE_UPDATE] * scale, 2 ) + " / " +
+		float_to_string( cost.m_time[cObject_Profiler::PHASE_UPDATE_LATE] * scale, 2 ) + " / " + float_to_string( cost.m_time[cObject_Profiler::PHASE_DRAW] * scale, 2 ) + " / " +
+		float_to_string( cost.m_time[cObject_Profiler::PHASE_COLLISION] * scale, 2 ) + "  " + int_to_string( cost.m_candidates / frames ) + " / " + int_to_string( cost.m_collisions / frames );
+}
+
+/* Add a group header line to the debug text
+ * the lines added before without a header flag and indentation are indented once
+*/
+static void Add_Debug_Header( vector<std::string> &text_strings, vector<bool> &text_headers, vector<unsigned int> &text_indents, const std::string &text )
+{
+	text_headers.resize( text_strings.size(), 0 );
+	text_indents.resize( text_strings.size(), 1 );
+
+	text_strings.push_back( text );
+	text_headers.push_back( 1 );
+	text_indents.push_back( 0 );
+}
+
+// Add the most expensive object classes or sprite types with a header to the debug text
+static void Add_Object_Costs( vector<std::string> &text_strings, vector<bool> &text_headers, vector<unsigned int> &text_indents, bool by_class, const std::string &header )
+{
+	cObject_Profiler::Cost_List costs;
+	const unsigned int frames = pObject_Profiler->Get_Top_Costs( costs, by_class, 5 );
+
+	if( !frames || costs.empty() )
+	{
+		return;
+	}
+
+	Add_Debug_Header( text_strings, text_headers, text_indents, header );
+
+	for( cObject_Profiler::Cost_List::const_iterator itr = costs.begin(); itr != costs.end(); ++itr )
+	{
+		text_strings.push_back( Get_Object_Cost_Text( *itr, frames ) );
+	}
+}
+
 /* *** *** *** *** *** *** *** cHudSprite *** *** *** *** *** *** *** *** *** *** */
 
 cHudSprite :: cHudSprite( cSprite_Manager *sprite_manager )
@@ -40,6 +110,9 @@ cHudSprite :: cHudSprite( cSprite_Manager *sprite_manager )
 	m_camera_range = 0;
 	m_pos_z = 0.13f;
 
+	m_text_font = NULL;
+	m_font_text_color = white;
+
 	Set_Ignore_Camera( 1 );
 }
 
@@ -59,9 +132,83 @@ cHudSprite *cHudSprite :: Copy( void ) const
 	hud_sprite->Set_Ignore_Camera( m_no_camera );
 	hud_sprite->Set_Shadow_Pos( m_shadow_pos );
 	hud_sprite->Set_Shadow_Color( m_shadow_color );
+	if( !m_font_text.empty() )
+	{
+		hud_sprite->Set_Font_Text( m_text_font, m_font_text, m_font_text_color );
+	}
 	return hud_sprite;
 }
 
+void cHudSprite :: Set_Font_Text( TTF_Font *font, const char *text, const Color &color )
+{
+	// the debug texts are set every frame but rarely change
+	if( !m_image && m_text_font == font && m_font_text_color == color && m_font_text.compare( text ) == 0 )
+	{
+		return;
+	}
+
+	Set_Image( NULL );
+
+	m_text_font = font;
+	m_font_text = text;
+	m_font_text_color = color;
+
+	if( m_font_text.empty() || !m_text_font )
+	{
+		m_font_text.clear();
+		return;
+	}
+
+	int text_w = 0;
+	int text_h = 0;
+	TTF_SizeUTF8( m_text_font, m_font_text.c_str(), &text_w, &text_h );
+
+	m_rect.m_w = static_cast<float>(text_w);
+	m_rect.m_h = static_cast<float>(text_h);
+	m_col_rect.m_w = m_rect.m_w;
+	m_col_rect.m_h = m_rect.m_h;
+}
+
+void cHudSprite :: Draw_Font_Text( float x, float y, const Color &color ) const
+{
+	cSurface_Request request;
+	request.m_pos_x = x;
+	request.m_pos_y = y;
+	request.m_pos_z = m_pos_z;
+	request.m_no_camera = m_no_camera;
+	request.m_color = Color( static_cast<Uint8>( m_font_text_color.red * color.red / 255 ), static_cast<Uint8>( m_font_text_color.green * color.green / 255 ), static_cast<Uint8>( m_font_text_color.blue * color.blue / 255 ), static_cast<Uint8>( m_font_text_color.alpha * color.alpha / 255 ) );
+	request.m_shadow_pos = m_shadow_pos;
+	request.m_shadow_color = m_shadow_color;
+
+	pFont->Draw_Text( m_text_font, m_font_text, request );
+}
+
+void cHudSprite :: Draw( cSurface_Request *request /* = NULL */ )
+{
+	if( m_font_text.empty() )
+	{
+		cSprite::Draw( request );
+		return;
+	}
+
+	if( !m_active )
+	{
+		return;
+	}
+
+	Draw_Font_Text( m_pos_x, m_pos_y, m_color );
+}
+
+void cHudSprite :: Draw_Static( void )
+{
+	Draw();
+}
+
+void cHudSprite :: Draw_Animated( void )
+{
+	// virtual
+}
+
 /* *** *** *** *** *** *** *** cHud_Manager *** *** *** *** *** *** *** *** *** *** */
 
 cHud_Manager :: cHud_Manager( cSprite_Manager *sprite_manager )
@@ -69,11 +216,24 @@ cHud_Manager :: cHud_Manager( cSprite_Manager *sprite_manager )
 {
 	m_sprite_manager = sprite_manager;
 	m_loaded = 0;
+
+	m_layer = NULL;
+	m_layer_changed = 1;
+	m_layer_game_mode = MODE_NOTHING;
+	m_layer_editor_enabled = 0;
+	m_layer_texture_generation = 0;
 }
 
 cHud_Manager :: ~cHud_Manager( void )
 {
 	Unload();
+
+	if( m_layer )
+	{
+		// the render thread could use it
+		pVideo->Render_Finish();
+		delete m_layer;
+	}
 }
 
 void cHud_Manager :: Load( void )
@@ -211,6 +371,8 @@ void cHud_Manager :: Update_Text( void )
 		pHud_Itembox->Set_Pos( game_res_w * 0.49f, 10.0f );
 		pHud_Itembox->Update();
 	}
+
+	Invalidate_Layer();
 }
 
 void cHud_Manager :: Update( void )
@@ -224,6 +386,21 @@ void cHud_Manager :: Update( void )
 
 void cHud_Manager :: Draw( void )
 {
+	if( pPreferences->m_video_hud_layer )
+	{
+		if( Draw_Layer() )
+		{
+			return;
+		}
+	}
+	// not used anymore
+	else if( m_layer )
+	{
+		pVideo->Render_Finish();
+		delete m_layer;
+		m_layer = NULL;
+	}
+
 	// draw HUD objects
 	for( HudSpriteList::iterator itr = objects.begin(); itr != objects.end(); ++itr )
 	{
@@ -231,6 +408,57 @@ void cHud_Manager :: Draw( void )
 	}
 }
 
+void cHud_Manager :: Invalidate_Layer( void )
+{
+	m_layer_changed = 1;
+}
+
+bool cHud_Manager :: Draw_Layer( void )
+{
+	if( !m_layer )
+	{
+		m_layer = new cRender_Layer();
+		m_layer_changed = 1;
+	}
+
+	if( !m_layer->Is_Available() )
+	{
+		return 0;
+	}
+
+	// the objects check these when drawing
+	if( m_layer_game_mode != Game_Mode || m_layer_editor_enabled != editor_enabled || m_layer_texture_generation != pImage_Manager->m_texture_generation || m_layer->Needs_Update() )
+	{
+		m_layer_changed = 1;
+	}
+
+	if( m_layer_changed )
+	{
+		m_layer->Begin_Update();
+
+		for( HudSpriteList::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+		{
+			(*itr)->Draw_Static();
+		}
+
+		m_layer->End_Update();
+
+		m_layer_changed = 0;
+		m_layer_game_mode = Game_Mode;
+		m_layer_editor_enabled = editor_enabled;
+		m_layer_texture_generation = pImage_Manager->m_texture_generation;
+	}
+
+	m_layer->Add_Request();
+
+	for( HudSpriteList::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	{
+		(*itr)->Draw_Animated();
+	}
+
+	return 1;
+}
+
 void cHud_Manager :: Set_Sprite_Manager( cSprite_Manager *sprite_manager )
 {
 	m_sprite_manager = sprite_manager;
@@ -246,6 +474,9 @@ void cHud_Manager :: Set_Sprite_Manager( cSprite_Manager *sprite_manager )
 
 cHud_Manager *pHud_Manager = NULL;
 
+// points texts are created with every hit
+static cMemory_Pool points_text_pool( "Points Text", sizeof( PointsText ), 10, 60, &sprite_memory );
+
 /* *** *** *** *** *** *** PointsText *** *** *** *** *** *** *** *** *** *** *** */
 
 PointsText :: PointsText( cSprite_Manager *sprite_manager )
@@ -260,6 +491,16 @@ PointsText :: ~PointsText( void )
 	//
 }
 
+void *PointsText :: operator new( size_t size )
+{
+	return points_text_pool.Get( size );
+}
+
+void PointsText :: operator delete( void *ptr, size_t size )
+{
+	points_text_pool.Release( ptr, size );
+}
+
 /* *** *** *** *** *** *** cMenuBackground *** *** *** *** *** *** *** *** *** *** *** */
 
 cMenuBackground :: cMenuBackground( cSprite_Manager *sprite_manager )
@@ -351,13 +592,27 @@ cPlayerPoints :: ~cPlayerPoints( void )
 }
 
 void cPlayerPoints :: Draw( cSurface_Request *request /* = NULL */ )
+{
+	Draw_Static();
+	Draw_Animated();
+}
+
+void cPlayerPoints :: Draw_Static( void )
+{
+	if( editor_enabled || Game_Mode == MODE_MENU )
+	{
+		return;
+	}
+
+	cHudSprite::Draw();
+}
+
+void cPlayerPoints :: Draw_Animated( void )
 {
 	if( editor_enabled || Game_Mode == MODE_MENU )
 	{
 		return;
 	}
-	
-	cHudSprite::Draw( request );
 
 	// draw small points
 	for( PointsTextList::iterator itr = m_points_objects.begin(); itr != m_points_objects.end(); )
@@ -366,7 +621,7 @@ void cPlayerPoints :: Draw( cSurface_Request *request /* = NULL */ )
 		PointsText *obj = (*itr);
 		
 		// if finished
-		if( !obj->m_image )
+		if( obj->m_font_text.empty() )
 		{
 			itr = m_points_objects.erase( itr );
 			delete obj;
@@ -380,7 +635,7 @@ void cPlayerPoints :: Draw( cSurface_Request *request /* = NULL */ )
 			// disable
 			if( obj->m_vely > -1.0f )
 			{
-				obj->Set_Image( NULL );
+				obj->Set_Font_Text( NULL, "", white );
 				continue;
 			}
 			// fade out
@@ -414,20 +669,14 @@ void cPlayerPoints :: Draw( cSurface_Request *request /* = NULL */ )
 				y = game_res_h - obj->m_col_rect.m_h - 3.0f;
 			}
 
-			// create request
-			cSurface_Request *request = new cSurface_Request();
-			obj->m_image->Blit( x, y, m_pos_z, request );
-
 			// shadow
-			request->m_shadow_color = black;
-			request->m_shadow_color.alpha = obj->m_color.alpha;
-			request->m_shadow_pos = 1;
+			Color shadow_color = black;
+			shadow_color.alpha = obj->m_color.alpha;
+			obj->Set_Shadow( shadow_color, 1 );
+			obj->m_pos_z = m_pos_z;
 
 			// color
-			request->m_color = Color( static_cast<Uint8>( 255 - ( obj->m_points / 150 ) ), static_cast<Uint8>( 255 - ( obj->m_points / 150 ) ), static_cast<Uint8>( 255 - ( obj->m_points / 30 ) ), obj->m_color.alpha );
-
-			// add request
-			pRenderer->Add( request );
+			obj->Draw_Font_Text( x, y, Color( static_cast<Uint8>( 255 - ( obj->m_points / 150 ) ), static_cast<Uint8>( 255 - ( obj->m_points / 150 ) ), static_cast<Uint8>( 255 - ( obj->m_points / 30 ) ), obj->m_color.alpha ) );
 
 			++itr;
 		}
@@ -440,11 +689,22 @@ void cPlayerPoints :: Set_Points( long points )
 
 	char text[70];
 	sprintf( text, _("Points %08d"), static_cast<int>(pLevel_Player->m_points) );
-	Set_Image( pFont->Render_Text( pFont->m_font_normal, text, white ), 0, 1 );
+	Set_Font_Text( pFont->m_font_normal, text, white );
+
+	if( pHud_Manager )
+	{
+		pHud_Manager->Invalidate_Layer();
+	}
 }
 
 void cPlayerPoints :: Add_Points( unsigned int points, float x /* = 0.0f */, float y /* = 0.0f */, std::string strtext /* = "" */, const Color &color /* = static_cast<Uint8>(255) */, bool allow_multiplier /* = 0 */ )
 {
+	// added after the parallel update
+	if( pUpdate_Workers && pUpdate_Workers->Defer( boost::bind( &cPlayerPoints::Add_Points, this, points, x, y, strtext, color, allow_multiplier ) ) )
+	{
+		return;
+	}
+
 	if( allow_multiplier )
 	{
 		points = static_cast<unsigned int>( pLevel_Player->m_kill_multiplier * static_cast<float>(points) );
@@ -464,7 +724,7 @@ void cPlayerPoints :: Add_Points( unsigned int points, float x /* = 0.0f */, flo
 	}
 
 	PointsText *new_obj = new PointsText( m_sprite_manager );
-	new_obj->Set_Image( pFont->Render_Text( pFont->m_font_small, strtext, color ), 1, 1 );
+	new_obj->Set_Font_Text( pFont->m_font_small, strtext, color );
 
 	new_obj->Set_Pos( x, y );
 	new_obj->m_vely = -1.4f;
@@ -537,7 +797,12 @@ void cGoldDisplay :: Set_Gold( int gold )
 
 	Color color = Color( static_cast<Uint8>(255), 255, 255 - ( gold * 2 ) );
 
-	Set_Image( pFont->Render_Text( pFont->m_font_normal, text, color ), 0, 1 );
+	Set_Font_Text( pFont->m_font_normal, text, color );
+
+	if( pHud_Manager )
+	{
+		pHud_Manager->Invalidate_Layer();
+	}
 }
 
 void cGoldDisplay :: Add_Gold( int gold )
@@ -555,7 +820,7 @@ cLiveDisplay :: cLiveDisplay( cSprite_Manager *sprite_manager )
 
 	Set_Lives( pLevel_Player->m_lives );
 
-	Set_Image( NULL );
+	Set_Font_Text( NULL, "", white );
 }
 
 cLiveDisplay :: ~cLiveDisplay( void )
@@ -594,7 +859,7 @@ void cLiveDisplay :: Set_Lives( int lives )
 		text = _("Lives : ") + int_to_string( pLevel_Player->m_lives );
 	}
 
-	Set_Image( pFont->Render_Text( pFont->m_font_normal, text, green ), 0, 1 );
+	Set_Font_Text( pFont->m_font_normal, text, green );
 
 	// set position
 	int w, h;
@@ -603,6 +868,11 @@ void cLiveDisplay :: Set_Lives( int lives )
 	{
 		Set_Pos_X( (game_res_w * 0.94f) - w );
 	}
+
+	if( pHud_Manager )
+	{
+		pHud_Manager->Invalidate_Layer();
+	}
 }
 
 void cLiveDisplay :: Add_Lives( int lives )
@@ -655,7 +925,12 @@ void cTimeDisplay :: Update( void )
 
 	// Set new time
 	sprintf( m_text, _("Time %02d:%02d"), minutes, seconds - ( minutes * 60 ) );
-	Set_Image( pFont->Render_Text( pFont->m_font_normal, m_text, white ), 0, 1 );
+	Set_Font_Text( pFont->m_font_normal, m_text, white );
+
+	if( pHud_Manager )
+	{
+		pHud_Manager->Invalidate_Layer();
+	}
 }
 
 void cTimeDisplay :: Draw( cSurface_Request *request /* = NULL */ )
@@ -767,20 +1042,21 @@ void cItemBox :: Update( void )
 }
 
 void cItemBox :: Draw( cSurface_Request *request /* = NULL */ )
+{
+	Draw_Animated();
+	Draw_Static();
+}
+
+void cItemBox :: Draw_Static( void )
 {
 	if( editor_enabled || Game_Mode == MODE_OVERWORLD || Game_Mode == MODE_MENU )
 	{
 		return;
 	}
 
-	if( m_item_id && m_item->m_image )
+	// stored item
+	if( m_item_id && m_item->m_image && !m_item_counter )
 	{
-		// with alpha
-		if( m_item_counter )
-		{
-			m_item->Set_Color( 255, 255, 255, 100 + static_cast<Uint8>(m_item_counter) );
-		}
-		
 		m_item->Draw();
 	}
 
@@ -788,6 +1064,21 @@ void cItemBox :: Draw( cSurface_Request *request /* = NULL */ )
 	cHudSprite::Draw();
 }
 
+void cItemBox :: Draw_Animated( void )
+{
+	if( editor_enabled || Game_Mode == MODE_OVERWORLD || Game_Mode == MODE_MENU )
+	{
+		return;
+	}
+
+	// falling item with alpha
+	if( m_item_id && m_item->m_image && m_item_counter )
+	{
+		m_item->Set_Color( 255, 255, 255, 100 + static_cast<Uint8>(m_item_counter) );
+		m_item->Draw();
+	}
+}
+
 void cItemBox :: Set_Item( SpriteType item_type, bool sound /* = 1 */ )
 {
 	// play sound
@@ -826,6 +1117,7 @@ void cItemBox :: Set_Item( SpriteType item_type, bool sound /* = 1 */ )
 	}
 
 	m_item_id = item_type;
+	pHud_Manager->Invalidate_Layer();
 }
 
 void cItemBox :: Request_Item( void )
@@ -841,6 +1133,8 @@ void cItemBox :: Request_Item( void )
 	// draw item with camera
 	m_item->Set_Ignore_Camera( 0 );
 	m_item->Set_Pos( m_item->m_pos_x + pActive_Camera->m_x, m_item->m_pos_y + pActive_Camera->m_y );
+	// drawn directly while falling
+	pHud_Manager->Invalidate_Layer();
 }
 
 void cItemBox :: Push_back( void )
@@ -852,6 +1146,7 @@ void cItemBox :: Push_back( void )
 	m_item->Set_Ignore_Camera( 1 );
 	m_item->Set_Pos( m_item->m_start_pos_x, m_item->m_start_pos_y );
 	m_item->Set_Color( white );
+	pHud_Manager->Invalidate_Layer();
 }
 
 void cItemBox :: Reset( void )
@@ -861,6 +1156,11 @@ void cItemBox :: Reset( void )
 	m_item_counter = 0.0f;
 	m_item_counter_mod = 0;
 	m_box_color = white;
+
+	if( pHud_Manager )
+	{
+		pHud_Manager->Invalidate_Layer();
+	}
 }
 
 /* *** *** *** *** *** *** cDebugDisplay *** *** *** *** *** *** *** *** *** *** *** */
@@ -924,10 +1224,15 @@ cDebugDisplay :: cDebugDisplay( cSprite_Manager *sprite_manager )
 	m_sprites[2]->Set_Pos( 480.0f, 5.0f, 1 );
 
 	// Debug type text
-	m_sprites[4]->Set_Image( pFont->Render_Text( pFont->m_font_small, _("Level"), lightblue ), 0, 1 );
-	m_sprites[16]->Set_Image( pFont->Render_Text( pFont->m_font_small, _("Player"), lightblue ), 0, 1 );
+	m_sprites[4]->Set_Font_Text( pFont->m_font_small, _("Level"), lightblue );
+	m_sprites[16]->Set_Font_Text( pFont->m_font_small, _("Player"), lightblue );
 
 	m_counter = 0.0f;
+
+	m_fps_update_ticks = 0;
+	m_fps_frames = 0;
+	m_fps_frame_min = 0;
+	m_fps_frame_max = 0;
 }
 
 cDebugDisplay :: ~cDebugDisplay( void )
@@ -997,11 +1302,30 @@ void cDebugDisplay :: Update( void )
 
 void cDebugDisplay :: Draw( cSurface_Request *request /* = NULL */ )
 {
+	// only the framerate
+	if( pPreferences->m_video_fps_display && !game_debug && !game_debug_performance )
+	{
+		Draw_fps();
+		m_sprites[0]->Draw();
+		m_sprites[1]->Draw();
+		m_sprites[2]->Draw();
+	}
+
 	// debug mod info
 	Draw_Debug_Mode();
 	Draw_Performance_Debug_Mode();
 }
 
+void cDebugDisplay :: Draw_Static( void )
+{
+	// drawn every frame
+}
+
+void cDebugDisplay :: Draw_Animated( void )
+{
+	Draw();
+}
+
 void cDebugDisplay :: Set_Text( const std::string &ntext, float display_time /* = speedfactor_fps * 2.0f */ )
 {
 	m_text = ntext;
@@ -1020,12 +1344,49 @@ void cDebugDisplay :: Set_Text( const std::string &ntext, float display_time /*
 
 void cDebugDisplay :: Draw_fps( void )
 {
+	// frame times since the last update
+	if( !m_fps_frames || pFramerate->m_elapsed_ticks < m_fps_frame_min )
+	{
+		m_fps_frame_min = pFramerate->m_elapsed_ticks;
+	}
+	if( !m_fps_frames || pFramerate->m_elapsed_ticks > m_fps_frame_max )
+	{
+		m_fps_frame_max = pFramerate->m_elapsed_ticks;
+	}
+
+	m_fps_frames++;
+
+	const Uint32 elapsed = pFramerate->m_last_ticks - m_fps_update_ticks;
+
+	// the text is still up to date
+	if( elapsed < pPreferences->m_video_fps_display_interval && !m_sprites[0]->m_font_text.empty() )
+	{
+		return;
+	}
+
+	// frames per second since the last update
+	float fps = pFramerate->m_fps;
+
+	if( elapsed > 0 && m_fps_update_ticks )
+	{
+		fps = ( m_fps_frames * 1000.0f ) / elapsed;
+	}
+
+	// formatted into a fixed buffer and drawn from the glyph atlas
+	char text[256];
+
 	// ### Frames per Second
-	m_sprites[0]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, _("FPS : best ") + int_to_string( static_cast<int>(pFramerate->m_fps_best) ) + _(", worst ") + int_to_string( static_cast<int>(pFramerate->m_fps_worst) ) + _(", current ") + int_to_string( static_cast<int>(pFramerate->m_fps) ), white ), 0, 1 );
-	// average
-	m_sprites[1]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, _("average ") + int_to_string( static_cast<int>(pFramerate->m_fps_average) ), white ), 0, 1 );
+	sprintf( text, "%s%d%s%d%s%d", C_("FPS : best ").c_str(), static_cast<int>(pFramerate->m_fps_best), C_(", worst ").c_str(), static_cast<int>(pFramerate->m_fps_worst), C_(", current ").c_str(), static_cast<int>(fps) );
+	m_sprites[0]->Set_Font_Text( pFont->m_font_very_small, text, white );
+	// average and frame times
+	sprintf( text, "%s%d%s%u - %u ms", C_("average ").c_str(), static_cast<int>(pFramerate->m_fps_average), C_(", frame ").c_str(), m_fps_frame_min, m_fps_frame_max );
+	m_sprites[1]->Set_Font_Text( pFont->m_font_very_small, text, white );
 	// speed factor
-	m_sprites[2]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, _("Speed factor ") + float_to_string( pFramerate->m_speed_factor, 4 ), white ), 0, 1 );
+	sprintf( text, "%s%.4f", C_("Speed factor ").c_str(), pFramerate->m_speed_factor );
+	m_sprites[2]->Set_Font_Text( pFont->m_font_very_small, text, white );
+
+	m_fps_update_ticks = pFramerate->m_last_ticks;
+	m_fps_frames = 0;
 }
 
 void cDebugDisplay :: Draw_Debug_Mode( void )
@@ -1053,18 +1414,20 @@ void cDebugDisplay :: Draw_Debug_Mode( void )
 	Draw_fps();
 
 	std::string temp_text;
+	// the texts which change every frame are formatted into a fixed buffer
+	char text[256];
 
 	// Camera position
-	temp_text = _("Camera : X ") + int_to_string( static_cast<int>(pActive_Camera->m_x) ) + ", Y " + int_to_string( static_cast<int>(pActive_Camera->m_y) );
-	m_sprites[3]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+	sprintf( text, "%s%d, Y %d", C_("Camera : X ").c_str(), static_cast<int>(pActive_Camera->m_x), static_cast<int>(pActive_Camera->m_y) );
+	m_sprites[3]->Set_Font_Text( pFont->m_font_very_small, text, white );
 
 	// Level information
 	if( pActive_Level->m_level_filename.compare( m_level_old ) != 0 ) 
 	{
-		std::string lvl_text = _("Name : ") + Trim_Filename( pActive_Level->m_level_filename, 0, 0 );
+		std::string lvl_text = C_("Name : ") + Trim_Filename( pActive_Level->m_level_filename, 0, 0 );
 		m_level_old = pActive_Level->m_level_filename;
 
-		m_sprites[5]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, lvl_text, white ), 0, 1 );
+		m_sprites[5]->Set_Font_Text( pFont->m_font_very_small, lvl_text, white );
 	}
 
 	// Level objects
@@ -1072,40 +1435,40 @@ void cDebugDisplay :: Draw_Debug_Mode( void )
 	{
 		m_obj_counter = m_sprite_manager->size();
 
-		temp_text = _("Objects : ") + int_to_string( m_obj_counter );
-		m_sprites[6]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+		temp_text = C_("Objects : ") + int_to_string( m_obj_counter );
+		m_sprites[6]->Set_Font_Text( pFont->m_font_very_small, temp_text, white );
 	}
 	// Passive
 	if( m_pass_counter != static_cast<int>(m_sprite_manager->Get_Size_Array( ARRAY_PASSIVE )) )
 	{
 		m_pass_counter = m_sprite_manager->Get_Size_Array( ARRAY_PASSIVE );
 
-		temp_text = _("Passive : ") + int_to_string( m_pass_counter );
-		m_sprites[7]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+		temp_text = C_("Passive : ") + int_to_string( m_pass_counter );
+		m_sprites[7]->Set_Font_Text( pFont->m_font_very_small, temp_text, white );
 	}
 	// Massive
 	if( m_mass_counter != static_cast<int>(m_sprite_manager->Get_Size_Array( ARRAY_MASSIVE )) )
 	{
 		m_mass_counter = m_sprite_manager->Get_Size_Array( ARRAY_MASSIVE );
 
-		temp_text = _("Massive : ") + int_to_string( m_mass_counter );
-		m_sprites[8]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+		temp_text = C_("Massive : ") + int_to_string( m_mass_counter );
+		m_sprites[8]->Set_Font_Text( pFont->m_font_very_small, temp_text, white );
 	}
 	// Enemy
 	if( m_enemy_counter != static_cast<int>(m_sprite_manager->Get_Size_Array( ARRAY_ENEMY )) ) 
 	{
 		m_enemy_counter = m_sprite_manager->Get_Size_Array( ARRAY_ENEMY );
 
-		temp_text = _("Enemy : ") + int_to_string( m_enemy_counter );
-		m_sprites[9]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+		temp_text = C_("Enemy : ") + int_to_string( m_enemy_counter );
+		m_sprites[9]->Set_Font_Text( pFont->m_font_very_small, temp_text, white );
 	}
 	// Active
 	if( m_active_counter != static_cast<int>(m_sprite_manager->Get_Size_Array( ARRAY_ACTIVE )) )
 	{
 		m_active_counter = m_sprite_manager->Get_Size_Array( ARRAY_ACTIVE );
 
-		temp_text = _("Active : ") + int_to_string( m_active_counter );
-		m_sprites[10]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+		temp_text = C_("Active : ") + int_to_string( m_active_counter );
+		m_sprites[10]->Set_Font_Text( pFont->m_font_very_small, temp_text, white );
 
 		// Halfmassive
 		unsigned int halfmassive = 0;
@@ -1121,8 +1484,8 @@ void cDebugDisplay :: Draw_Debug_Mode( void )
 			}
 		}
 
-		temp_text = _("Halfmassive : ") + int_to_string( halfmassive );
-		m_sprites[11]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+		temp_text = C_("Halfmassive : ") + int_to_string( halfmassive );
+		m_sprites[11]->Set_Font_Text( pFont->m_font_very_small, temp_text, white );
 
 		// Moving Platform
 		unsigned int moving_platform = 0;
@@ -1138,8 +1501,8 @@ void cDebugDisplay :: Draw_Debug_Mode( void )
 			}
 		}
 
-		temp_text = _("Moving Platform : ") + int_to_string( moving_platform );
-		m_sprites[12]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+		temp_text = C_("Moving Platform : ") + int_to_string( moving_platform );
+		m_sprites[12]->Set_Font_Text( pFont->m_font_very_small, temp_text, white );
 
 		// Goldbox
 		unsigned int goldbox = 0;
@@ -1160,8 +1523,8 @@ void cDebugDisplay :: Draw_Debug_Mode( void )
 			}
 		}
 
-		temp_text = _("Goldbox : ") + int_to_string( goldbox );
-		m_sprites[13]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+		temp_text = C_("Goldbox : ") + int_to_string( goldbox );
+		m_sprites[13]->Set_Font_Text( pFont->m_font_very_small, temp_text, white );
 
 		// Bonusbox
 		unsigned int bonusbox_count = 0;
@@ -1182,41 +1545,44 @@ void cDebugDisplay :: Draw_Debug_Mode( void )
 			}
 		}
 
-		temp_text = _("Bonusbox : ") + int_to_string( bonusbox_count );
-		m_sprites[14]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+		temp_text = C_("Bonusbox : ") + int_to_string( bonusbox_count );
+		m_sprites[14]->Set_Font_Text( pFont->m_font_very_small, temp_text, white );
 
 		// Other
 		unsigned int active_other = m_active_counter - halfmassive - moving_platform - goldbox - bonusbox_count;
 
-		temp_text = _("Other : ") + int_to_string( active_other );
-		m_sprites[15]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+		temp_text = C_("Other : ") + int_to_string( active_other );
+		m_sprites[15]->Set_Font_Text( pFont->m_font_very_small, temp_text, white );
 	}
 
 	// Player information
 	// position x
-	temp_text = "X1 " + float_to_string( pActive_Player->m_pos_x, 4 ) + "  X2 " + float_to_string( pLevel_Player->m_col_rect.m_x + pLevel_Player->m_col_rect.m_w, 4 );
-	m_sprites[17]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+	sprintf( text, "X1 %.4f  X2 %.4f", pActive_Player->m_pos_x, pLevel_Player->m_col_rect.m_x + pLevel_Player->m_col_rect.m_w );
+	m_sprites[17]->Set_Font_Text( pFont->m_font_very_small, text, white );
 	// position y
-	temp_text = "Y1 " + float_to_string( pActive_Player->m_pos_y, 4 ) + "  Y2 " + float_to_string( pLevel_Player->m_col_rect.m_y + pLevel_Player->m_col_rect.m_h, 4 );
-	m_sprites[18]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+	sprintf( text, "Y1 %.4f  Y2 %.4f", pActive_Player->m_pos_y, pLevel_Player->m_col_rect.m_y + pLevel_Player->m_col_rect.m_h );
+	m_sprites[18]->Set_Font_Text( pFont->m_font_very_small, text, white );
 	// velocity
-	temp_text = _("Velocity X ") + float_to_string( pLevel_Player->m_velx, 2 ) + " ,Y " + float_to_string( pLevel_Player->m_vely, 2 );
-	m_sprites[19]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+	sprintf( text, "%s%.2f ,Y %.2f", C_("Velocity X ").c_str(), pLevel_Player->m_velx, pLevel_Player->m_vely );
+	m_sprites[19]->Set_Font_Text( pFont->m_font_very_small, text, white );
 	// moving state
-	temp_text = _("Moving State ") + int_to_string( static_cast<int>(pLevel_Player->m_state) );
-	m_sprites[20]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
+	sprintf( text, "%s%d", C_("Moving State ").c_str(), static_cast<int>(pLevel_Player->m_state) );
+	m_sprites[20]->Set_Font_Text( pFont->m_font_very_small, text, white );
 	// ground type
-	std::string ground_type;
 	if( pLevel_Player->m_ground_object )
 	{
-		ground_type = int_to_string( pLevel_Player->m_ground_object->m_massive_type ) + " (" + Get_Massive_Type_Name( pLevel_Player->m_ground_object->m_massive_type ) + ")";
+		const MassiveType massive_type = pLevel_Player->m_ground_object->m_massive_type;
+		sprintf( text, "%s%d (%s)", C_("Ground ").c_str(), static_cast<int>(massive_type), Get_Massive_Type_Name( massive_type ).c_str() );
+		m_sprites[21]->Set_Font_Text( pFont->m_font_very_small, text, white );
+	}
+	else
+	{
+		m_sprites[21]->Set_Font_Text( pFont->m_font_very_small, C_("Ground "), white );
 	}
-	temp_text = _("Ground ") + ground_type;
-	m_sprites[21]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, temp_text, white ), 0, 1 );
 	// game mode
 	if( Game_Mode != m_game_mode_last )
 	{
-		m_sprites[22]->Set_Image( pFont->Render_Text( pFont->m_font_very_small, _("Game Mode : ") + int_to_string( Game_Mode ), white ), 0, 1 );
+		m_sprites[22]->Set_Font_Text( pFont->m_font_very_small, C_("Game Mode : ") + int_to_string( Game_Mode ), white );
 	}
 
 	// draw text
@@ -1234,11 +1600,8 @@ void cDebugDisplay :: Draw_Performance_Debug_Mode( void )
 	}
 
 	std::string temp_text;
-	float ypos = game_res_h * 0.08f;
-
-	// black background
-	Color color = blackalpha128;
-	pVideo->Draw_Rect( 15, ypos, 190, 390, m_pos_z - 0.00001f, &color );
+	const float start_ypos = game_res_h * 0.08f;
+	float ypos = start_ypos;
 
 	// don't draw it twice
 	if( !game_debug )
@@ -1251,146 +1614,192 @@ void cDebugDisplay :: Draw_Performance_Debug_Mode( void )
 	}
 
 	vector<std::string> text_strings;
-	// draw
-	text_strings.push_back( _("Draw") );
-	// overworld
-	if( Game_Mode == MODE_OVERWORLD )
-	{
-		text_strings.push_back( _("World : ") + int_to_string( pFramerate->m_perf_timer[PERF_DRAW_OVERWORLD]->ms ) );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-	}
-	// menu
-	else if( Game_Mode == MODE_MENU )
-	{
-		text_strings.push_back( _("Menu : ") + int_to_string( pFramerate->m_perf_timer[PERF_DRAW_MENU]->ms ) );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-	}
-	// level settings
-	else if( Game_Mode == MODE_LEVEL_SETTINGS )
-	{
-		text_strings.push_back( _("Level Settings : ") + int_to_string( pFramerate->m_perf_timer[PERF_DRAW_LEVEL_SETTINGS]->ms ) );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-	}
-	// level (default)
-	else
+	// if the line starts a group
+	vector<bool> text_headers;
+	// indentation of the line
+	vector<unsigned int> text_indents;
+
+	// profiler sections of the main and worker threads
+	const cProfiler::Section_List &sections = pProfiler->Get_Sections();
+
+	for( int root = cProfiler::m_main_root; root <= cProfiler::m_worker_root; root++ )
 	{
-		text_strings.push_back( _("Level Layer 1 : ") + int_to_string( pFramerate->m_perf_timer[PERF_DRAW_LEVEL_LAYER1]->ms ) );
-		text_strings.push_back( _("Level Player : ") + int_to_string( pFramerate->m_perf_timer[PERF_DRAW_LEVEL_PLAYER]->ms ) );
-		text_strings.push_back( _("Level Layer 2 : ") + int_to_string( pFramerate->m_perf_timer[PERF_DRAW_LEVEL_LAYER2]->ms ) );
-		text_strings.push_back( _("Level Hud : ") + int_to_string( pFramerate->m_perf_timer[PERF_DRAW_LEVEL_HUD]->ms ) );
-		text_strings.push_back( _("Level Editor : ") + int_to_string( pFramerate->m_perf_timer[PERF_DRAW_LEVEL_EDITOR]->ms ) );
-	}
-	text_strings.push_back( _("Mouse : ") + int_to_string( pFramerate->m_perf_timer[PERF_DRAW_MOUSE]->ms ) );
-	// update
-	text_strings.push_back( _("Update") );
-	// overworld
-	if( Game_Mode == MODE_OVERWORLD )
-	{
-		text_strings.push_back( _("World : ") + int_to_string( pFramerate->m_perf_timer[PERF_UPDATE_OVERWORLD]->ms ) );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-	}
-	// menu
-	else if( Game_Mode == MODE_MENU )
-	{
-		text_strings.push_back( _("Menu : ") + int_to_string( pFramerate->m_perf_timer[PERF_UPDATE_MENU]->ms ) );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-	}
-	// level settings
-	else if( Game_Mode == MODE_LEVEL_SETTINGS )
-	{
-		text_strings.push_back( _("Level Settings : ") + int_to_string( pFramerate->m_perf_timer[PERF_UPDATE_LEVEL_SETTINGS]->ms ) );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-		text_strings.push_back( "- " );
-	}
-	// level (default)
-	else
+		if( !sections[root].m_active )
+		{
+			continue;
+		}
+
+		Add_Debug_Header( text_strings, text_headers, text_indents, sections[root].m_name );
+
+		// children in depth-first order
+		vector<int> stack;
+		stack.push_back( sections[root].m_child );
+
+		while( !stack.empty() )
+		{
+			const int section = stack.back();
+			stack.pop_back();
+
+			if( section < 0 )
+			{
+				continue;
+			}
+
+			const cProfiler::Section &obj = sections[section];
+			// next sibling after the children
+			stack.push_back( obj.m_sibling );
+
+			if( !obj.m_active )
+			{
+				continue;
+			}
+
+			text_strings.push_back( std::string( obj.m_name ) + " : " + Get_Profiler_Text( &obj.m_timer ) );
+			text_headers.push_back( 0 );
+			text_indents.push_back( obj.m_depth );
+
+			stack.push_back( obj.m_child );
+		}
+	}
+
+	// most expensive object classes and sprite types
+	if( pObject_Profiler->Is_Enabled() )
 	{
-		text_strings.push_back( _("process input : ") + int_to_string( pFramerate->m_perf_timer[PERF_UPDATE_PROCESS_INPUT]->ms ) );
-		text_strings.push_back( _("level : ") + int_to_string( pFramerate->m_perf_timer[PERF_UPDATE_LEVEL]->ms ) );
-		text_strings.push_back( _("level editor : ") + int_to_string( pFramerate->m_perf_timer[PERF_UPDATE_LEVEL_EDITOR]->ms ) );
-		text_strings.push_back( _("hud : ") + int_to_string( pFramerate->m_perf_timer[PERF_UPDATE_HUD]->ms ) );
-		text_strings.push_back( _("player : ") + int_to_string( pFramerate->m_perf_timer[PERF_UPDATE_PLAYER]->ms ) );
-		text_strings.push_back( _("player collisions : ") + int_to_string( pFramerate->m_perf_timer[PERF_UPDATE_PLAYER_COLLISIONS]->ms ) );
-		text_strings.push_back( _("level late : ") + int_to_string( pFramerate->m_perf_timer[PERF_UPDATE_LATE_LEVEL]->ms ) );
-		text_strings.push_back( _("level collisions : ") + int_to_string( pFramerate->m_perf_timer[PERF_UPDATE_LEVEL_COLLISIONS]->ms ) );
-		text_strings.push_back( _("camera : ") + int_to_string( pFramerate->m_perf_timer[PERF_UPDATE_CAMERA]->ms ) );
+		Add_Object_Costs( text_strings, text_headers, text_indents, 1, C_("Object classes : ms per frame  update / late / draw / collision  candidates / collisions") );
+		Add_Object_Costs( text_strings, text_headers, text_indents, 0, C_("Object types : ms per frame  update / late / draw / collision  candidates / collisions") );
 	}
 
 	// render
-	text_strings.push_back( _("Render") );
-	text_strings.push_back( _("Game : ") + int_to_string( pFramerate->m_perf_timer[PERF_RENDER_GAME]->ms ) );
-	text_strings.push_back( _("Gui : ") + int_to_string( pFramerate->m_perf_timer[PERF_RENDER_GUI]->ms ) );
-	text_strings.push_back( _("Buffer : ") + int_to_string( pFramerate->m_perf_timer[PERF_RENDER_BUFFER]->ms ) );
+	Add_Debug_Header( text_strings, text_headers, text_indents, C_("Render") );
+	text_strings.push_back( C_("Requests : ") + int_to_string( pRender_Stats->Get_Request_Count() ) + C_(" kept ") + int_to_string( pRender_Stats->m_last.m_carried_over ) );
+	text_strings.push_back( C_("Culled : ") + int_to_string( pRender_Stats->m_last.m_culled ) );
+	text_strings.push_back( C_("Draw calls : ") + int_to_string( pRender_Stats->m_last.m_draw_calls ) + C_(" vertices ") + int_to_string( pRender_Stats->m_last.m_vertices ) );
+	text_strings.push_back( C_("Texture binds : ") + int_to_string( pRender_Stats->m_last.m_texture_binds ) );
+	text_strings.push_back( C_("GL States : ") + int_to_string( pRender_Stats->m_last.m_state_changes ) + C_(" avoided ") + int_to_string( pRender_Stats->m_last.m_avoided_state_changes ) );
+	text_strings.push_back( C_("Textures : ") + int_to_string( pImage_Manager->m_resident_bytes / 1048576 ) + C_(" MB unloaded ") + int_to_string( pImage_Manager->m_unloaded_bytes / 1048576 ) + C_(" MB") );
+
+	text_strings.push_back( C_("Audio : ") + float_to_string( pAudio->m_latency, 1 ) + C_(" ms buffer ") + int_to_string( pAudio->m_audio_buffer ) + C_(" underruns ") + int_to_string( pAudio->m_latency_check_underruns ) );
+	text_strings.push_back( C_("Particles : ") + int_to_string( pParticle_Budget->m_last_count ) + " / " + int_to_string( pParticle_Budget->Get_Budget() ) + C_(" emitted ") + int_to_string( static_cast<int>( pParticle_Budget->m_visible_scale * 100.0f ) ) + "% / " + int_to_string( static_cast<int>( pParticle_Budget->m_hidden_scale * 100.0f ) ) + "%" );
+
+	// memory counters
+	Add_Debug_Header( text_strings, text_headers, text_indents, C_("Memory : KB live / peak / allocations") );
+	Update_Memory_Counters();
 
-	unsigned int pos = 0;
+	const Memory_Counter_List &counters = Get_Memory_Counters();
 
-	for( vector<std::string>::const_iterator itr = text_strings.begin(); itr != text_strings.end(); ++itr )
+	for( Memory_Counter_List::const_iterator itr = counters.begin(); itr != counters.end(); ++itr )
+	{
+		const cMemory_Counter *counter = (*itr);
+
+		text_strings.push_back( counter->m_name + " : " + int_to_string( static_cast<int>( counter->m_bytes / 1024 ) ) + " / " + int_to_string( static_cast<int>( counter->m_peak / 1024 ) ) + " / " + int_to_string( counter->m_last_frame_allocations ) );
+	}
+
+	// memory pools
+	Add_Debug_Header( text_strings, text_headers, text_indents, C_("Pools : hit rate / allocated") );
+
+	const Memory_Pool_List &pools = Get_Memory_Pools();
+
+	for( Memory_Pool_List::const_iterator itr = pools.begin(); itr != pools.end(); ++itr )
+	{
+		const cMemory_Pool *pool = (*itr);
+
+		// not used yet
+		if( !pool->m_hits && !pool->m_misses )
+		{
+			continue;
+		}
+
+		text_strings.push_back( pool->m_name + " : " + float_to_string( pool->Get_Hit_Rate(), 1 ) + "% / " + int_to_string( pool->m_misses ) );
+	}
+
+	// frame
+	const cPerformance_Timer &frame_timer = pFramerate->m_frame_timer;
+	Add_Debug_Header( text_strings, text_headers, text_indents, C_("Frame") );
+	text_strings.push_back( C_("Sections : ms per 100 frames  p50 / p95 / p99 / max") );
+	text_strings.push_back( C_("Frame : ") + Get_Performance_Text( &frame_timer ) );
+
+	// frame start after the due time of the frame limit
+	const cPerformance_Timer &jitter_timer = pFramerate->m_pacer.m_jitter_timer;
+
+	if( jitter_timer.m_history_count )
+	{
+		text_strings.push_back( C_("Pacing : ") + Get_Profiler_Text( &jitter_timer ) );
+	}
+
+	// input sampling to the finished buffer swap
+	const cPerformance_Timer &input_latency_timer = pFramerate->m_input_latency_timer;
+
+	if( input_latency_timer.m_history_count )
+	{
+		text_strings.push_back( C_("Input latency : ") + Get_Profiler_Text( &input_latency_timer ) );
+	}
+
+	// deferrable jobs run with the frame time left
+	text_strings.push_back( C_("Deferred jobs : ") + int_to_string( pFrame_Scheduler->m_last_run ) + C_(" run ") + int_to_string( pFrame_Scheduler->m_last_forced ) + C_(" forced ") + int_to_string( pFrame_Scheduler->m_last_deferred ) + C_(" queued ") + float_to_string( pFrame_Scheduler->m_last_left / 1000.0f, 1 ) + C_(" ms left") );
+
+	// gpu time of the render phases to compare with the render sections
+	if( pVideo->m_gpu_timer )
+	{
+		Add_Debug_Header( text_strings, text_headers, text_indents, C_("GPU : ms per 100 frames  p50 / p95 / p99 / max") );
+
+		for( unsigned int phase = 0; phase < GPU_PHASE_COUNT; phase++ )
+		{
+			text_strings.push_back( std::string( cGPU_Timer::Get_Phase_Name( static_cast<GPU_Phase>(phase) ) ) + " : " + Get_Profiler_Text( &pVideo->m_gpu_timer->m_timers[phase] ) );
+		}
+	}
+
+	for( unsigned int pos = 0; pos < text_strings.size(); pos++ )
 	{
 		// sections
 		float xpos = 20;
 		ypos += 12;
 
-		// move non header a bit to the right right
-		if( pos != 0 && pos != 7 && pos != 17 )
-		{
-			xpos += 10;
-		}
+		// lines added without a header flag and indentation are in the group
+		const bool header = pos < text_headers.size() && text_headers[pos];
+		const unsigned int indent = pos < text_indents.size() ? text_indents[pos] : 1;
+
+		// move non header a bit to the right
+		xpos += 10 * indent;
 		// if new group starts move a bit more down
-		if( pos == 7 || pos == 17 )
+		if( header && pos != 0 )
 		{
 			ypos += 10;
 		}
 
-		const std::string current_text = (*itr);
-
-		cGL_Surface *surface_temp = pFont->Render_Text( pFont->m_font_small, current_text, white );
+		const std::string &current_text = text_strings[pos];
 
-		// create request
-		cSurface_Request *request = new cSurface_Request();
-		surface_temp->Blit( xpos, ypos, m_pos_z, request );
-		request->m_delete_texture = 1;
+		cSurface_Request request;
+		request.m_pos_x = xpos;
+		request.m_pos_y = ypos;
+		request.m_pos_z = m_pos_z;
+		request.m_no_camera = 1;
+		request.m_color = white;
 
 		// shadow
-		request->m_shadow_pos = 1;
-		request->m_shadow_color = black;
+		request.m_shadow_pos = 1;
+		request.m_shadow_color = black;
 
-		// add request
-		pRenderer->Add( request );
+		pFont->Draw_Text( pFont->m_font_small, current_text, request );
+	}
 
-		surface_temp->m_auto_del_img = 0;
-		delete surface_temp;
-		
-		pos++;
+	// frame time graph with the newest frame on the right
+	ypos += 70;
+	const unsigned int graph_frames = frame_timer.m_history_count < 280 ? frame_timer.m_history_count : 280;
+
+	for( unsigned int i = 0; i < graph_frames; i++ )
+	{
+		const Uint32 frame_ms = frame_timer.Get_History( i );
+		// 2 milliseconds per pixel
+		const float height = frame_ms < 100 ? frame_ms * 0.5f : 50.0f;
+		// spikes over the 95th percentile
+		const Color *bar_color = frame_ms > frame_timer.m_p95 ? &red : &lightgrey;
+
+		pVideo->Draw_Rect( 300.0f - static_cast<float>(i), ypos - height, 1.0f, height, m_pos_z, bar_color );
 	}
+
+	// black background
+	Color color = blackalpha128;
+	pVideo->Draw_Rect( 15, start_ypos, 290, ypos - start_ypos + 10, m_pos_z - 0.00001f, &color );
 }
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
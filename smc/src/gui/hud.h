@@ -18,10 +18,13 @@
 
 #include "../objects/movingsprite.h"
 #include "../core/obj_manager.h"
+#include "../video/font.h"
 
 namespace SMC
 {
 
+class cRender_Layer;
+
 /* *** *** *** *** *** *** *** cHudSprite *** *** *** *** *** *** *** *** *** *** */
 
 class cHudSprite : public cSprite
@@ -32,6 +35,36 @@ public:
 	
 	// copy this sprite
 	virtual cHudSprite *Copy( void ) const;
+
+	/* Set the text drawn from the glyph atlas of the font instead of the image
+	 * an empty text disables it
+	 * the text storage is reused if the text fits into it
+	*/
+	void Set_Font_Text( TTF_Font *font, const char *text, const Color &color );
+	inline void Set_Font_Text( TTF_Font *font, const std::string &text, const Color &color )
+	{
+		Set_Font_Text( font, text.c_str(), color );
+	}
+	// Draw the text at the given position with the color multiplied by the text color
+	void Draw_Font_Text( float x, float y, const Color &color ) const;
+
+	// draw
+	virtual void Draw( cSurface_Request *request = NULL );
+	/* Draw the parts which rarely change into the HUD layer
+	 * the default draws everything
+	*/
+	virtual void Draw_Static( void );
+	/* Draw the parts which change every frame if the HUD layer is used
+	 * the default draws nothing
+	*/
+	virtual void Draw_Animated( void );
+
+	// text font
+	TTF_Font *m_text_font;
+	// text or empty if the image is used
+	std::string m_font_text;
+	// text color
+	Color m_font_text_color;
 };
 
 /* *** *** *** *** *** *** *** cHud_Manager *** *** *** *** *** *** *** *** *** *** */
@@ -53,6 +86,8 @@ public:
 	void Update( void );
 	// Draw the objects
 	void Draw( void );
+	// Draw the HUD layer again with the next drawing
+	void Invalidate_Layer( void );
 
 	// Set the parent sprite manager
 	void Set_Sprite_Manager( cSprite_Manager *sprite_manager );
@@ -64,6 +99,21 @@ public:
 
 	// true if loaded
 	bool m_loaded;
+
+private:
+	/* Draw the static parts from the HUD layer and the animated parts directly
+	 * returns false if the layer is not available
+	*/
+	bool Draw_Layer( void );
+
+	// offscreen texture of the static parts or NULL if not used
+	cRender_Layer *m_layer;
+	// if set the layer is drawn again
+	bool m_layer_changed;
+	// state of the last layer update
+	GameMode m_layer_game_mode;
+	bool m_layer_editor_enabled;
+	unsigned int m_layer_texture_generation;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
@@ -79,6 +129,10 @@ public:
 	PointsText( cSprite_Manager *sprite_manager );
 	virtual ~PointsText( void );
 
+	// memory is reused from deleted points texts
+	static void *operator new( size_t size );
+	static void operator delete( void *ptr, size_t size );
+
 	float m_vely;
 	unsigned int m_points;
 };
@@ -126,6 +180,10 @@ public:
 	void Clear( void );
 
 	virtual void Draw( cSurface_Request *request = NULL );
+	// the points
+	virtual void Draw_Static( void );
+	// the moving point texts
+	virtual void Draw_Animated( void );
 
 	typedef vector<PointsText *> PointsTextList;
 	PointsTextList m_points_objects;
@@ -198,6 +256,10 @@ public:
 	virtual void Update( void );
 	// draw
 	virtual void Draw( cSurface_Request *request = NULL );
+	// the box and the stored item
+	virtual void Draw_Static( void );
+	// the item falling down to the player
+	virtual void Draw_Animated( void );
 
 	/* Set the item
 	* sound : if set the box sound is played
@@ -239,7 +301,12 @@ public:
 	virtual void Update( void );
 	// draw
 	virtual void Draw( cSurface_Request *request = NULL );
-	// draw the frames per second info
+	// nothing as everything can change every frame
+	virtual void Draw_Static( void );
+	virtual void Draw_Animated( void );
+	/* draw the frames per second info
+	 * the text is only formatted again after the update interval
+	*/
 	void Draw_fps( void );
 	// draw the debug mode info
 	void Draw_Debug_Mode( void );
@@ -266,6 +333,13 @@ public:
 	// sprites
 	typedef vector<cHudSprite *> HudSpriteList;
 	HudSpriteList m_sprites;
+
+	// ticks of the last framerate text update
+	Uint32 m_fps_update_ticks;
+	// frames since the last framerate text update
+	unsigned int m_fps_frames;
+	// shortest and longest frame since the last framerate text update
+	Uint32 m_fps_frame_min, m_fps_frame_max;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
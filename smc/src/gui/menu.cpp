@@ -18,6 +18,7 @@
 #include "../gui/menu_data.h"
 #include "../core/game_core.h"
 #include "../core/framerate.h"
+#include "../core/profiler.h"
 #include "../input/mouse.h"
 #include "../audio/audio.h"
 #include "../level/level_player.h"
@@ -26,6 +27,8 @@
 #include "../overworld/overworld.h"
 #include "../user/preferences.h"
 #include "../input/keyboard.h"
+#include "../level/level_background.h"
+#include "../video/animation.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -250,9 +253,42 @@ void cMenuHandler :: Draw( bool with_background /* = 1 */ )
 	}
 }
 
+bool cMenuHandler :: Is_Level_Animated( void ) const
+{
+	// particles
+	if( !m_level->m_animation_manager->objects.empty() )
+	{
+		return 1;
+	}
+
+	// moving backgrounds
+	for( vector<cBackground *>::const_iterator itr = m_level->m_background_manager->objects.begin(); itr != m_level->m_background_manager->objects.end(); ++itr )
+	{
+		const cBackground *obj = (*itr);
+
+		if( !Is_Float_Equal( obj->m_const_vel_x, 0.0f ) || !Is_Float_Equal( obj->m_const_vel_y, 0.0f ) )
+		{
+			return 1;
+		}
+	}
+
+	// only basic sprites are never moved or animated
+	for( cSprite_List::const_iterator itr = m_level->m_sprite_manager->objects.begin(); itr != m_level->m_sprite_manager->objects.end(); ++itr )
+	{
+		const cSprite *obj = (*itr);
+
+		if( obj->m_active && !obj->Is_Basic_Sprite() )
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
 cMenu_Item *cMenuHandler :: Get_Active_Item( void )
 {
-	if( m_active < 0 || static_cast<unsigned int>(m_active) > m_items.size() )
+	if( m_active < 0 || static_cast<unsigned int>(m_active) >= m_items.size() )
 	{
 		return NULL;
 	}
@@ -709,16 +745,16 @@ void cMenuCore :: Update( void )
 		return;
 	}
 
+	cProfiler_Scope profile_scope( "menu update" );
+
 	// if not in a level/world
 	if( m_menu_data->m_exit_to_gamemode == MODE_NOTHING )
 	{
+		cProfiler_Scope profile_handler( "menu level" );
 		m_handler->Update();
 	}
 
 	m_menu_data->Update();
-
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_UPDATE_MENU]->Update();
 }
 
 void cMenuCore :: Draw( void ) 
@@ -728,10 +764,30 @@ void cMenuCore :: Draw( void )
 		return;
 	}
 
+	cProfiler_Scope profile_scope( "menu draw" );
+
 	m_menu_data->Draw();
+}
+
+bool cMenuCore :: Is_Animated( void ) const
+{
+	if( !m_menu_data )
+	{
+		return 0;
+	}
+
+	return m_menu_data->Is_Animated();
+}
+
+bool cMenuCore :: Is_Item_Pulsing( void ) const
+{
+	if( !m_menu_data )
+	{
+		return 0;
+	}
 
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_DRAW_MENU]->Update();
+	// the active item is always pulsing
+	return m_handler->Get_Active_Item() != NULL;
 }
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
@@ -83,6 +83,9 @@ public:
 	// Draw
 	void Draw( bool with_background = 1 );
 
+	// Returns true if the menu level has moving or animated objects
+	bool Is_Level_Animated( void ) const;
+
 	// Returns the currently active Menu Item
 	cMenu_Item *Get_Active_Item( void );
 	// Returns the number of loaded Menus
@@ -159,6 +162,10 @@ public:
 	void Update( void );
 	// Draw current Menu
 	void Draw( void );
+	// Returns true if the current Menu changes without input besides the item pulse
+	bool Is_Animated( void ) const;
+	// Returns true if the current Menu has a pulsing active item
+	bool Is_Item_Pulsing( void ) const;
 
 	// current menu id
 	MenuID m_menu_id;
@@ -18,6 +18,7 @@
 #include "../audio/audio.h"
 #include "../core/game_core.h"
 #include "../gui/generic.h"
+#include "../gui/resource_provider.h"
 #include "../video/font.h"
 #include "../overworld/overworld.h"
 #include "../core/campaign_manager.h"
@@ -30,6 +31,8 @@
 #include "../level/level.h"
 #include "../input/keyboard.h"
 #include "../level/level_editor.h"
+#include "../level/level_index.h"
+#include "../level/level_preview.h"
 #include "../core/math/utilities.h"
 #include "../core/i18n.h"
 #include "../core/math/size.h"
@@ -173,6 +176,28 @@ void cMenu_Base :: Draw_End( void )
 	pHud_Manager->Draw();
 }
 
+bool cMenu_Base :: Is_Animated( void ) const
+{
+	// timed debug text
+	if( pHud_Debug->m_counter > 0.0f )
+	{
+		return 1;
+	}
+
+	// the menu level and animations are only updated if not entered from a level or world
+	if( m_exit_to_gamemode == MODE_LEVEL || m_exit_to_gamemode == MODE_OVERWORLD )
+	{
+		return 0;
+	}
+
+	if( !pMenuCore->m_animation_manager->objects.empty() )
+	{
+		return 1;
+	}
+
+	return pMenuCore->m_handler->Is_Level_Animated();
+}
+
 void cMenu_Base :: Set_Exit_To_Game_Mode( GameMode gamemode )
 {
 	m_exit_to_gamemode = gamemode;
@@ -260,6 +285,9 @@ void cMenu_Main :: Init_GUI( void )
 		CEGUI::Window *text_website = CEGUI::WindowManager::getSingleton().getWindow( "text_website" );
 		text_website->hide();
 	}
+
+	// the other layouts are read while the player is in the menu
+	pGuiResourceProvider->Prefetch();
 }
 
 void cMenu_Main :: Exit( void )
@@ -338,15 +366,119 @@ void cMenu_Main :: Draw( void )
 
 /* *** *** *** *** *** *** *** *** cMenu_Start *** *** *** *** *** *** *** *** *** */
 
+/* *** *** *** *** *** *** *** cMenu_List_Item *** *** *** *** *** *** *** *** *** *** */
+
+cMenu_List_Item :: cMenu_List_Item( const std::string &text )
+: CEGUI::ListboxTextItem( reinterpret_cast<const CEGUI::utf8*>(text.c_str()) )
+{
+	m_pixel_size_valid = 0;
+}
+
+cMenu_List_Item :: ~cMenu_List_Item( void )
+{
+	//
+}
+
+CEGUI::Size cMenu_List_Item :: getPixelSize( void ) const
+{
+	if( !m_pixel_size_valid )
+	{
+		m_pixel_size = CEGUI::ListboxTextItem::getPixelSize();
+		m_pixel_size_valid = 1;
+	}
+
+	return m_pixel_size;
+}
+
+/* *** *** *** *** *** *** *** cMenu_Preview *** *** *** *** *** *** *** *** *** *** */
+
+cMenu_Preview :: cMenu_Preview( const std::string &window_name )
+{
+	m_window_name = window_name;
+	m_image = NULL;
+	m_imageset = NULL;
+}
+
+cMenu_Preview :: ~cMenu_Preview( void )
+{
+	Clear();
+}
+
+void cMenu_Preview :: Set( const std::string &filename )
+{
+	Clear();
+
+	if( filename.empty() )
+	{
+		return;
+	}
+
+	// from the cache without loading the level
+	m_image = cLevel_Preview::Load( filename );
+
+	if( !m_image )
+	{
+		return;
+	}
+
+	const CEGUI::Size texture_size( static_cast<float>(m_image->m_tex_w), static_cast<float>(m_image->m_tex_h) );
+
+	// create CEGUI link
+	cEditor_CEGUI_Texture *texture = new cEditor_CEGUI_Texture( *pGuiRenderer, m_image->m_image, texture_size );
+	m_imageset = &CEGUI::ImagesetManager::getSingleton().create( "menu_preview_" + m_window_name, *texture );
+	// image area in the texture
+	m_imageset->defineImage( "default", CEGUI::Point( m_image->m_tex_x1 * texture_size.d_width, m_image->m_tex_y1 * texture_size.d_height ), CEGUI::Size( ( m_image->m_tex_x2 - m_image->m_tex_x1 ) * texture_size.d_width, ( m_image->m_tex_y2 - m_image->m_tex_y1 ) * texture_size.d_height ), CEGUI::Point( 0, 0 ) );
+
+	CEGUI::Window *window = CEGUI::WindowManager::getSingleton().getWindow( m_window_name );
+	window->setProperty( "Image", "set:" + m_imageset->getName() + " image:default" );
+	window->setVisible( 1 );
+}
+
+void cMenu_Preview :: Clear( void )
+{
+	CEGUI::WindowManager &wmgr = CEGUI::WindowManager::getSingleton();
+
+	if( wmgr.isWindowPresent( m_window_name ) )
+	{
+		CEGUI::Window *window = wmgr.getWindow( m_window_name );
+		window->setProperty( "Image", "" );
+		window->setVisible( 0 );
+	}
+
+	if( m_imageset )
+	{
+		delete m_imageset->getTexture();
+		CEGUI::ImagesetManager::getSingleton().destroy( *m_imageset );
+		m_imageset = NULL;
+	}
+
+	if( m_image )
+	{
+		delete m_image;
+		m_image = NULL;
+	}
+}
+
+/* *** *** *** *** *** *** *** cMenu_Start *** *** *** *** *** *** *** *** *** *** */
+
 cMenu_Start :: cMenu_Start( void )
 : cMenu_Base()
 {
-
+	m_world_preview = NULL;
+	m_level_preview = NULL;
 }
 
 cMenu_Start :: ~cMenu_Start( void )
 {
+	if( m_world_preview )
+	{
+		delete m_world_preview;
+	}
 
+	if( m_level_preview )
+	{
+		delete m_level_preview;
+	}
 }
 
 void cMenu_Start :: Init( void )
@@ -424,6 +556,10 @@ void cMenu_Start :: Init_GUI( void )
 		listbox_campaigns->setItemSelectState( static_cast<size_t>(0), 1 );
 	}
 
+	// previews shown when selected
+	m_world_preview = new cMenu_Preview( "image_world_preview" );
+	m_level_preview = new cMenu_Preview( "image_level_preview" );
+
 	// ### World ###
 	CEGUI::Listbox *listbox_worlds = static_cast<CEGUI::Listbox *>(CEGUI::WindowManager::getSingleton().getWindow( "listbox_worlds" ));
 
@@ -479,10 +615,16 @@ void cMenu_Start :: Init_GUI( void )
 	CEGUI::Listbox *listbox_levels = static_cast<CEGUI::Listbox *>(CEGUI::WindowManager::getSingleton().getWindow( "listbox_levels" ));
 	listbox_levels->setSortingEnabled( 1 );
 
+	Level_Item_Map level_items;
 	// get game level
-	Get_Levels( DATA_DIR "/" GAME_LEVEL_DIR, CEGUI::colour( 1, 0.8f, 0.6f ) );
+	Get_Levels( DATA_DIR "/" GAME_LEVEL_DIR, CEGUI::colour( 1, 0.8f, 0.6f ), level_items );
 	// get user level
-	Get_Levels( pResource_Manager->user_data_dir + USER_LEVEL_DIR, CEGUI::colour( 0.8f, 1, 0.6f ) );
+	Get_Levels( pResource_Manager->user_data_dir + USER_LEVEL_DIR, CEGUI::colour( 0.8f, 1, 0.6f ), level_items );
+	// keep new level settings even if the game crashes
+	pLevel_Index->Save_Index();
+
+	// shown again if no level is selected
+	m_level_info_text = CEGUI::WindowManager::getSingleton().getWindow( "text_level_info" )->getText();
 
 	// events
 	listbox_levels->subscribeEvent( CEGUI::Listbox::EventSelectionChanged, CEGUI::Event::Subscriber( &cMenu_Start::Level_Select, this ) );
@@ -555,49 +697,45 @@ void cMenu_Start :: Draw( void )
 	Draw_End();
 }
 
-void cMenu_Start :: Get_Levels( std::string dir, CEGUI::colour color )
+void cMenu_Start :: Get_Levels( const std::string &dir, const CEGUI::colour &color, Level_Item_Map &items )
 {
 	// Level Listbox
 	CEGUI::Listbox *listbox_levels = static_cast<CEGUI::Listbox *>(CEGUI::WindowManager::getSingleton().getWindow( "listbox_levels" ));
 
 	// get directory length for erasing
 	int dir_length = dir.length() + 1;
-	// get all files
-	vector<std::string> lvl_files = Get_Directory_Files( dir, "smclvl", 0, 0 );
+	// get all levels from the index which only reads new or changed files
+	Level_Info_List levels;
+	pLevel_Index->Update( dir, levels );
 
 	// list all available levels
-	for( vector<std::string>::iterator itr = lvl_files.begin(); itr != lvl_files.end(); ++itr )
+	for( Level_Info_List::const_iterator itr = levels.begin(); itr != levels.end(); ++itr )
 	{
 		// get filename
-		std::string lvl_name = (*itr);
+		std::string lvl_name = (*itr)->m_filename;
 		// remove base directory
 		lvl_name.erase( 0, dir_length );
-
-		// erase file type only if smclvl
-		if( lvl_name.rfind( ".smclvl" ) != std::string::npos )
-		{
-			lvl_name.erase( lvl_name.rfind( ".smclvl" ) );
-		}
-
-		// create listbox item
-		CEGUI::ListboxTextItem *item = new CEGUI::ListboxTextItem( reinterpret_cast<const CEGUI::utf8*>(lvl_name.c_str()) );
-		item->setTextColours( color );
+		// erase file type which includes the compressed file type
+		lvl_name.erase( lvl_name.rfind( ".smclvl" ) );
 
 		// check if item with the same name already exists
-		CEGUI::ListboxTextItem *item_old = static_cast<CEGUI::ListboxTextItem *>(listbox_levels->findItemWithText( lvl_name, NULL ));
-		
-		if( item_old )
+		Level_Item_Map::iterator item_itr = items.find( lvl_name );
+
+		if( item_itr != items.end() )
 		{
+			CEGUI::ListboxTextItem *item_old = item_itr->second;
 			// mix colors
-			item->setTextColours( item->getTextColours().d_top_left, item->getTextColours().d_top_right, item_old->getTextColours().d_bottom_left, item_old->getTextColours().d_bottom_right );
-			// remove old item
-			listbox_levels->removeItem( item_old );
+			item_old->setTextColours( color, color, item_old->getTextColours().d_bottom_left, item_old->getTextColours().d_bottom_right );
+			continue;
 		}
 
-
+		// create listbox item
+		CEGUI::ListboxTextItem *item = new cMenu_List_Item( lvl_name );
+		item->setTextColours( color );
 		item->setSelectionColours( CEGUI::colour( 0.33f, 0.33f, 0.33f ) );
 		item->setSelectionBrushImage( "TaharezLook", "ListboxSelectionBrush" );
 		listbox_levels->addItem( item );
+		items[lvl_name] = item;
 	}
 }
 
@@ -1039,12 +1177,26 @@ bool cMenu_Start :: World_Select( const CEGUI::EventArgs &event )
 	if( item )
 	{
 		// todo : should be from the path not name (more unique)
-		editbox_world_description->setText( reinterpret_cast<const CEGUI::utf8*>(pOverworld_Manager->Get_from_Name( item->getText().c_str() )->m_description->m_comment.c_str()) );
+		const cOverworld_description *description = pOverworld_Manager->Get_from_Name( item->getText().c_str() )->m_description;
+		editbox_world_description->setText( reinterpret_cast<const CEGUI::utf8*>(description->m_comment.c_str()) );
+
+		std::string world_filename = description->Get_Full_Path() + "/world.xml";
+
+		// or compressed
+		if( Find_File( world_filename ) )
+		{
+			m_world_preview->Set( world_filename );
+		}
+		else
+		{
+			m_world_preview->Clear();
+		}
 	}
 	// clear
 	else
 	{
 		editbox_world_description->setText( "" );
+		m_world_preview->Clear();
 	}
 
 	return 1;
@@ -1069,15 +1221,39 @@ bool cMenu_Start :: Level_Select( const CEGUI::EventArgs &event )
 	const CEGUI::WindowEventArgs &windowEventArgs = static_cast<const CEGUI::WindowEventArgs&>( event );
 	CEGUI::ListboxItem *item = static_cast<CEGUI::Listbox *>( windowEventArgs.window )->getFirstSelectedItem();
 
-	// set level something
+	// level info
+	CEGUI::Window *text_level_info = CEGUI::WindowManager::getSingleton().getWindow( "text_level_info" );
+
+	std::string filename;
+	const cLevel_Info *info = NULL;
+
 	if( item )
 	{
-		// todo : needs level manager
+		filename = item->getText().c_str();
+
+		if( pLevel_Manager->Get_Path( filename ) )
+		{
+			info = pLevel_Index->Get( filename );
+		}
+	}
+
+	// set level settings
+	if( info )
+	{
+		std::string text = _("Author : ") + info->m_author + "\n";
+		text += _("Version : ") + info->m_version + "\n";
+		text += _("Difficulty : ") + Get_Difficulty_Name( info->m_difficulty ) + "\n";
+		text += _("Land type : ") + Get_Level_Land_Type_Name( info->m_land_type ) + "\n\n";
+		text += info->m_description;
+
+		text_level_info->setText( reinterpret_cast<const CEGUI::utf8*>(text.c_str()) );
+		m_level_preview->Set( filename );
 	}
 	// clear
 	else
 	{
-		// todo : needs level manager
+		text_level_info->setText( m_level_info_text );
+		m_level_preview->Clear();
 	}
 
 	return 1;
@@ -1556,6 +1732,32 @@ void cMenu_Options :: Init_GUI_Audio( void )
 
 	m_audio_combo_hz->subscribeEvent( CEGUI::Combobox::EventListSelectionAccepted, CEGUI::Event::Subscriber( &cMenu_Options::Audio_Hz_Select, this ) );
 
+	// Latency
+	CEGUI::Window *text_latency = static_cast<CEGUI::Window *>(wmgr.getWindow( "audio_text_latency" ));
+	text_latency->setText( UTF8_("Latency") );
+	text_latency->setTooltipText( UTF8_("Low plays sounds sooner but needs a fast system. It falls back to a larger buffer if the audio is scratchy.") );
+
+	m_audio_combo_latency = static_cast<CEGUI::Combobox *>(wmgr.getWindow( "audio_combo_latency" ));
+
+	item = new CEGUI::ListboxTextItem( UTF8_("Normal") );
+	item->setTextColours( CEGUI::colour( 0, 0, 1 ) );
+	m_audio_combo_latency->addItem( item );
+	item = new CEGUI::ListboxTextItem( UTF8_("Low") );
+	item->setTextColours( CEGUI::colour( 0, 1, 0 ) );
+	m_audio_combo_latency->addItem( item );
+
+	// Set current value
+	if( pPreferences->m_audio_low_latency )
+	{
+		m_audio_combo_latency->setText( UTF8_("Low") );
+	}
+	else
+	{
+		m_audio_combo_latency->setText( UTF8_("Normal") );
+	}
+
+	m_audio_combo_latency->subscribeEvent( CEGUI::Combobox::EventListSelectionAccepted, CEGUI::Event::Subscriber( &cMenu_Options::Audio_Latency_Select, this ) );
+
 
 	// Music
 	CEGUI::Window *text_music = static_cast<CEGUI::Window *>(wmgr.getWindow( "audio_text_music" ));
@@ -2578,6 +2780,7 @@ bool cMenu_Options :: Video_Button_Apply_Clicked( const CEGUI::EventArgs &event
 	// draw reinitialization text
 	Draw_Static_Text( _("Reinitialization"), &green, NULL, 0 );
 
+	pVideo->Render_Finish();
 	pGuiSystem->renderGUI();
 	pRenderer->Render();
 	SDL_GL_SwapBuffers();
@@ -2600,14 +2803,11 @@ bool cMenu_Options :: Video_Button_Recreate_Cache_Clicked( const CEGUI::EventArg
 {
 	Loading_Screen_Init();
 
-	// save textures for reloading from file
-	pImage_Manager->Grab_Textures( 1, 1 );
-
 	// recreate cache
 	pVideo->Init_Image_Cache( 1, 1 );
 
-	// restore textures
-	pImage_Manager->Restore_Textures( 1 );
+	// the textures are loaded again from the new cache when used
+	pImage_Manager->Unload_File_Textures();
 
 	Loading_Screen_Exit();
 
@@ -2633,6 +2833,38 @@ bool cMenu_Options :: Audio_Hz_Select( const CEGUI::EventArgs &event )
 	return 1;
 }
 
+bool cMenu_Options :: Audio_Latency_Select( const CEGUI::EventArgs &event )
+{
+	const CEGUI::WindowEventArgs &windowEventArgs = static_cast<const CEGUI::WindowEventArgs&>( event );
+	CEGUI::ListboxItem *item = static_cast<CEGUI::Combobox *>( windowEventArgs.window )->getSelectedItem();
+
+	bool low_latency = 0;
+
+	if( item->getText().compare( UTF8_("Low") ) == 0 )
+	{
+		low_latency = 1;
+	}
+
+	if( pPreferences->m_audio_low_latency == low_latency )
+	{
+		return 1;
+	}
+
+	pPreferences->m_audio_low_latency = low_latency;
+	// try the configured buffer again
+	pAudio->m_audio_buffer_fallback = 0;
+
+	// draw reloading text
+	Draw_Static_Text( _("Reloading"), &green, NULL, 0 );
+	// reload
+	pAudio->Close();
+	pSound_Manager->Delete_All();
+	pAudio->Init();
+	Preload_Sounds();
+
+	return 1;
+}
+
 bool cMenu_Options :: Audio_Music_Select( const CEGUI::EventArgs &event )
 {
 	const CEGUI::WindowEventArgs &windowEventArgs = static_cast<const CEGUI::WindowEventArgs&>( event );
@@ -3107,9 +3339,14 @@ void cMenu_Savegames :: Update_Load( void )
 	// reset before loading the level to keep the level in the manager
 	pLevel_Player->Reset_Save();
 
-	cSave *savegame = pSavegame->Load( save_num );
-	std::string level_name = savegame->Get_Active_Level();
-	delete savegame;
+	// only the information is needed
+	cSave_Info info;
+	std::string level_name;
+
+	if( pSavegame->Load_Info( save_num, info ) && !info.m_active_level.empty() && pLevel_Manager->Get_Path( info.m_active_level ) )
+	{
+		level_name = info.m_active_level;
+	}
 
 	if( !level_name.empty() )
 	{
@@ -3582,6 +3819,12 @@ void cMenu_Credits :: Draw( void )
 	Draw_End();
 }
 
+bool cMenu_Credits :: Is_Animated( void ) const
+{
+	// scrolling text
+	return 1;
+}
+
 void cMenu_Credits :: Add_Credits_Line( const std::string &text, float posx, float posy, const Color &shadow_color /* = black */, float shadow_pos /* = 0.0f */ )
 {
 	cHudSprite *temp = new cHudSprite( pMenuCore->m_handler->m_level->m_sprite_manager );
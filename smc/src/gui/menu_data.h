@@ -19,6 +19,8 @@
 #include "../core/global_basic.h"
 #include "../gui/menu.h"
 #include "../gui/hud.h"
+// std
+#include <map>
 
 namespace SMC
 {
@@ -42,6 +44,8 @@ public:
 	virtual void Update( void );
 	virtual void Draw( void );
 	void Draw_End( void );
+	// Returns true if the menu changes without input
+	virtual bool Is_Animated( void ) const;
 
 	// Set the game mode to return on exit
 	void Set_Exit_To_Game_Mode( GameMode gamemode );
@@ -83,6 +87,52 @@ public:
 	virtual void Draw( void );
 };
 
+/* *** *** *** *** *** *** *** cMenu_List_Item *** *** *** *** *** *** *** *** *** *** */
+
+/* Listbox text entry which measures its text only once
+ * the listbox asks all entries for their size whenever an entry is added or the list changes
+ * and only draws the visible entries
+ * which keeps filling and scrolling lists with thousands of levels fast
+*/
+class cMenu_List_Item : public CEGUI::ListboxTextItem
+{
+public:
+	cMenu_List_Item( const std::string &text );
+	virtual ~cMenu_List_Item( void );
+
+	// overridden from base class
+	virtual CEGUI::Size getPixelSize( void ) const;
+
+private:
+	// measured size
+	mutable CEGUI::Size m_pixel_size;
+	mutable bool m_pixel_size_valid;
+};
+
+/* *** *** *** *** *** *** *** cMenu_Preview *** *** *** *** *** *** *** *** *** *** */
+
+// Shows the cached preview image of a level or world in a static image window
+class cMenu_Preview
+{
+public:
+	cMenu_Preview( const std::string &window_name );
+	~cMenu_Preview( void );
+
+	/* Show the preview of the level or world file
+	 * the window is hidden if no preview is cached
+	*/
+	void Set( const std::string &filename );
+	// Hide the window and delete the preview
+	void Clear( void );
+
+	// static image window name
+	std::string m_window_name;
+	// preview image
+	cGL_Surface *m_image;
+	// CEGUI link of the image
+	CEGUI::Imageset *m_imageset;
+};
+
 /* *** *** *** *** *** *** *** cMenu_Start *** *** *** *** *** *** *** *** *** *** */
 
 class cMenu_Start : public cMenu_Base
@@ -97,8 +147,13 @@ public:
 	virtual void Update( void );
 	virtual void Draw( void );
 
-	// Get all levels from the given directory
-	void Get_Levels( std::string dir, CEGUI::colour color );
+	// listed level items by name
+	typedef std::map<std::string, CEGUI::ListboxTextItem *> Level_Item_Map;
+
+	/* Get all levels from the given directory
+	 * items : the already listed levels which get the colors mixed if listed again
+	*/
+	void Get_Levels( const std::string &dir, const CEGUI::colour &color, Level_Item_Map &items );
 
 	/* Highlight the given level
 	 * and activates level tab if needed
@@ -161,6 +216,11 @@ public:
 	CEGUI::String m_listbox_search_buffer;
 	// counter until buffer is cleared
 	float m_listbox_search_buffer_counter;
+	// level info text shown if no level is selected
+	CEGUI::String m_level_info_text;
+	// preview of the selected world and level
+	cMenu_Preview *m_world_preview;
+	cMenu_Preview *m_level_preview;
 };
 
 /* *** *** *** *** *** *** *** cMenu_Options *** *** *** *** *** *** *** *** *** *** */
@@ -226,6 +286,7 @@ public:
 	bool Video_Button_Recreate_Cache_Clicked( const CEGUI::EventArgs &event );
 	// audio
 	bool Audio_Hz_Select( const CEGUI::EventArgs &event );
+	bool Audio_Latency_Select( const CEGUI::EventArgs &event );
 	bool Audio_Music_Select( const CEGUI::EventArgs &event );
 	bool Audio_Music_Volume_Changed( const CEGUI::EventArgs &event );
 	bool Audio_Sound_Select( const CEGUI::EventArgs &event );
@@ -279,6 +340,7 @@ public:
 	float m_vid_texture_detail;
 	// audio
 	CEGUI::Combobox *m_audio_combo_hz;
+	CEGUI::Combobox *m_audio_combo_latency;
 	CEGUI::Combobox *m_audio_combo_music;
 	CEGUI::Slider *m_audio_slider_music;
 	CEGUI::Combobox *m_audio_combo_sounds;
@@ -345,6 +407,7 @@ public:
 	virtual void Exit( void );
 	virtual void Update( void );
 	virtual void Draw( void );
+	virtual bool Is_Animated( void ) const;
 
 
 	// Add a line to the credits text
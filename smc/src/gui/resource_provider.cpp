@@ -0,0 +1,153 @@
+/***************************************************************************
+ * resource_provider.cpp  -  CEGUI resource provider with background reading
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../gui/resource_provider.h"
+#include "../core/game_core.h"
+#include "../core/filesystem/filesystem.h"
+#include "../core/filesystem/resource_archive.h"
+#include "../core/task_pool.h"
+#include <cstdio>
+#include <cstring>
+// boost
+#include <boost/bind.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cGui_Resource_Provider *** *** *** *** *** *** *** *** *** *** */
+
+cGui_Resource_Provider :: cGui_Resource_Provider( void )
+: CEGUI::DefaultResourceProvider()
+{
+	m_started = 0;
+	m_task_group = pTask_Pool->Create_Group();
+}
+
+cGui_Resource_Provider :: ~cGui_Resource_Provider( void )
+{
+	pTask_Pool->Cancel( m_task_group );
+}
+
+void cGui_Resource_Provider :: loadRawDataContainer( const CEGUI::String &filename, CEGUI::RawDataContainer &output, const CEGUI::String &resourceGroup )
+{
+	const std::string final_filename = getFinalFilename( filename, resourceGroup ).c_str();
+
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+
+		Data_Map::iterator itr = m_data.find( final_filename );
+
+		if( itr != m_data.end() )
+		{
+			const std::string &data = itr->second;
+
+			// released by CEGUI with delete[]
+			CEGUI::uint8 *buffer = new CEGUI::uint8[data.size()];
+			memcpy( buffer, data.data(), data.size() );
+
+			output.setData( buffer );
+			output.setSize( data.size() );
+
+			m_data.erase( itr );
+			return;
+		}
+	}
+
+	const char *data;
+	size_t size;
+
+	// packed data file
+	if( pResource_Archive && pResource_Archive->Get_File( final_filename, data, size ) )
+	{
+		CEGUI::uint8 *buffer = new CEGUI::uint8[size];
+		memcpy( buffer, data, size );
+
+		output.setData( buffer );
+		output.setSize( size );
+		return;
+	}
+
+	CEGUI::DefaultResourceProvider::loadRawDataContainer( filename, output, resourceGroup );
+}
+
+void cGui_Resource_Provider :: Prefetch( void )
+{
+	if( m_started )
+	{
+		return;
+	}
+
+	m_started = 1;
+
+	// packed layouts are already mapped
+	if( pResource_Archive )
+	{
+		return;
+	}
+
+	// already shown layouts are taken the next time they are loaded
+	m_files = Get_Directory_Files( DATA_DIR "/" GUI_LAYOUT_DIR, ".layout" );
+
+	pTask_Pool->Add( boost::bind( &cGui_Resource_Provider::Prefetch_Task, this ), TASK_PRIORITY_BACKGROUND, m_task_group, "gui prefetch" );
+}
+
+void cGui_Resource_Provider :: Prefetch_Task( void )
+{
+	for( vector<std::string>::iterator itr = m_files.begin(); itr != m_files.end(); ++itr )
+	{
+		const std::string &filename = (*itr);
+
+		if( pTask_Pool->Is_Cancelled( m_task_group ) )
+		{
+			return;
+		}
+
+	#ifdef _WIN32
+		FILE *fp = _wfopen( utf8_to_ucs2( filename ).c_str(), L"rb" );
+	#else
+		FILE *fp = fopen( filename.c_str(), "rb" );
+	#endif
+
+		if( !fp )
+		{
+			continue;
+		}
+
+		std::string data;
+		char buffer[4096];
+		size_t count;
+
+		while( ( count = fread( buffer, 1, sizeof(buffer), fp ) ) > 0 )
+		{
+			data.append( buffer, count );
+		}
+
+		fclose( fp );
+
+		if( data.empty() )
+		{
+			continue;
+		}
+
+		boost::mutex::scoped_lock lock( m_mutex );
+		m_data[filename] = data;
+	}
+}
+
+cGui_Resource_Provider *pGuiResourceProvider = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
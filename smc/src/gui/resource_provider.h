@@ -0,0 +1,76 @@
+/***************************************************************************
+ * resource_provider.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_RESOURCE_PROVIDER_H
+#define SMC_RESOURCE_PROVIDER_H
+
+#include "../core/global_basic.h"
+// CEGUI
+#include "CEGUIDefaultResourceProvider.h"
+// boost thread
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cGui_Resource_Provider *** *** *** *** *** *** *** *** *** *** */
+
+/* CEGUI resource provider which can read files in the background
+ * the layouts are only loaded when their window is shown the first time
+ * and Prefetch reads the files of the not yet shown windows as task pool background task
+ * a prefetched file is handed to CEGUI once and then freed
+ * files not read yet are loaded from disk as usual so it never waits
+*/
+class cGui_Resource_Provider : public CEGUI::DefaultResourceProvider
+{
+public:
+	cGui_Resource_Provider( void );
+	virtual ~cGui_Resource_Provider( void );
+
+	// CEGUI resource provider interface
+	virtual void loadRawDataContainer( const CEGUI::String &filename, CEGUI::RawDataContainer &output, const CEGUI::String &resourceGroup );
+
+	/* Read the layouts in the background
+	 * only starts once and should be called when the game is idle
+	*/
+	void Prefetch( void );
+
+private:
+	// Read the files until done or cancelled
+	void Prefetch_Task( void );
+
+	// files to read in the order they are read
+	vector<std::string> m_files;
+	// read file data not yet taken by CEGUI
+	typedef boost::unordered_map<std::string, std::string> Data_Map;
+	Data_Map m_data;
+
+	// task pool group of the prefetch
+	unsigned int m_task_group;
+	// protects the read file data
+	boost::mutex m_mutex;
+	// if the prefetch was started
+	bool m_started;
+};
+
+// GUI resource provider
+extern cGui_Resource_Provider *pGuiResourceProvider;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
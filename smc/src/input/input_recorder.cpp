@@ -0,0 +1,428 @@
+/***************************************************************************
+ * input_recorder.cpp  -  records and replays the input events
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../input/input_recorder.h"
+#include "../core/game_core.h"
+#include "../core/main.h"
+#include "../core/framerate.h"
+#include "../core/math/random.h"
+#include "../core/property_helper.h"
+#include "../level/level.h"
+#include "../level/level_manager.h"
+#include <cstring>
+
+namespace SMC
+{
+
+// file identification "SMCR" and format version
+static const Uint32 input_recording_magic = 0x52434D53;
+static const Uint32 input_recording_version = 1;
+// values stored for each event
+static const unsigned int input_recording_event_values = 5;
+
+/* *** *** *** *** *** *** *** cInput_Recorder *** *** *** *** *** *** *** *** *** *** */
+
+cInput_Recorder :: cInput_Recorder( void )
+{
+	m_file = NULL;
+	m_frame_events = 0;
+	m_replay_reader = NULL;
+	m_mouse_x = 0;
+	m_mouse_y = 0;
+	m_frame = 0;
+}
+
+cInput_Recorder :: ~cInput_Recorder( void )
+{
+	Stop();
+}
+
+bool cInput_Recorder :: Start_Recording( const std::string &filename, const std::string &level )
+{
+	Stop();
+
+#ifdef _WIN32
+	m_file = _wfopen( utf8_to_ucs2( filename ).c_str(), L"wb" );
+#else
+	m_file = fopen( filename.c_str(), "wb" );
+#endif
+
+	if( !m_file )
+	{
+		printf( "Error : Couldn't create input recording %s\n", filename.c_str() );
+		return 0;
+	}
+
+	// the same random numbers in the replay
+	if( !level_random_seed )
+	{
+		level_random_seed = Get_Random_Seed();
+	}
+
+	srand( level_random_seed );
+
+	Uint64 level_hash = 0;
+
+	if( !level.empty() )
+	{
+		std::string level_filename = level;
+
+		if( pLevel_Manager->Get_Path( level_filename ) )
+		{
+			level_hash = Get_File_Hash( level_filename );
+		}
+	}
+
+	m_level = level;
+	m_frame = 0;
+
+	cIndex_Writer header;
+	header.Write_Uint32( input_recording_magic );
+	header.Write_Uint32( input_recording_version );
+	header.Write_String( m_level );
+	header.Write_Uint64( level_hash );
+	header.Write_Uint32( level_random_seed );
+
+	fwrite( header.m_data.data(), header.m_data.size(), 1, m_file );
+
+	return 1;
+}
+
+bool cInput_Recorder :: Start_Replay( const std::string &filename )
+{
+	Stop();
+
+#ifdef _WIN32
+	FILE *fp = _wfopen( utf8_to_ucs2( filename ).c_str(), L"rb" );
+#else
+	FILE *fp = fopen( filename.c_str(), "rb" );
+#endif
+
+	if( !fp )
+	{
+		printf( "Error : Couldn't open input recording %s\n", filename.c_str() );
+		return 0;
+	}
+
+	char buffer[4096];
+	size_t count;
+
+	while( ( count = fread( buffer, 1, sizeof(buffer), fp ) ) > 0 )
+	{
+		m_replay_data.append( buffer, count );
+	}
+
+	fclose( fp );
+
+	m_replay_reader = new cIndex_Reader( m_replay_data.data(), m_replay_data.size() );
+
+	if( m_replay_reader->Read_Uint32() != input_recording_magic || m_replay_reader->Read_Uint32() != input_recording_version )
+	{
+		printf( "Error : Invalid input recording %s\n", filename.c_str() );
+		Stop();
+		return 0;
+	}
+
+	m_level = m_replay_reader->Read_String();
+	const Uint64 level_hash = m_replay_reader->Read_Uint64();
+	level_random_seed = m_replay_reader->Read_Uint32();
+
+	if( !m_replay_reader->m_valid )
+	{
+		printf( "Error : Invalid input recording %s\n", filename.c_str() );
+		Stop();
+		return 0;
+	}
+
+	srand( level_random_seed );
+
+	// a changed level can play differently
+	if( !m_level.empty() )
+	{
+		std::string level_filename = m_level;
+
+		if( !pLevel_Manager->Get_Path( level_filename ) || Get_File_Hash( level_filename ) != level_hash )
+		{
+			printf( "Warning : Level %s was changed since the input was recorded\n", m_level.c_str() );
+		}
+	}
+
+	m_frame = 0;
+
+	return 1;
+}
+
+void cInput_Recorder :: Stop( void )
+{
+	if( m_file )
+	{
+		Write_Frame();
+		fclose( m_file );
+		m_file = NULL;
+	}
+
+	if( m_replay_reader )
+	{
+		delete m_replay_reader;
+		m_replay_reader = NULL;
+	}
+
+	m_replay_data.clear();
+	m_frame_data.m_data.clear();
+	m_events.m_data.clear();
+	m_frame_events = 0;
+	m_level.clear();
+}
+
+void cInput_Recorder :: Update( void )
+{
+	if( m_file )
+	{
+		Write_Frame();
+
+		int mouse_x, mouse_y;
+		SDL_GetMouseState( &mouse_x, &mouse_y );
+
+		Uint32 speed_factor;
+		memcpy( &speed_factor, &pFramerate->m_speed_factor, sizeof(speed_factor) );
+
+		m_frame_data.Write_Uint32( speed_factor );
+		m_frame_data.Write_Uint32( static_cast<Uint32>(mouse_x) );
+		m_frame_data.Write_Uint32( static_cast<Uint32>(mouse_y) );
+		m_frame++;
+	}
+	else if( m_replay_reader )
+	{
+		Uint32 speed_factor = m_replay_reader->Read_Uint32();
+		m_mouse_x = static_cast<int>(m_replay_reader->Read_Uint32());
+		m_mouse_y = static_cast<int>(m_replay_reader->Read_Uint32());
+		const Uint32 event_count = m_replay_reader->Read_Uint32();
+
+		// finished
+		if( !m_replay_reader->m_valid )
+		{
+			printf( "Input replay finished after %u frames\n", m_frame );
+			Stop();
+			game_exit = 1;
+			return;
+		}
+
+		memcpy( &pFramerate->m_speed_factor, &speed_factor, sizeof(speed_factor) );
+
+		for( Uint32 i = 0; i < event_count && m_replay_reader->m_valid; i++ )
+		{
+			SDL_Event ev;
+			memset( &ev, 0, sizeof(ev) );
+			ev.type = static_cast<Uint8>(m_replay_reader->Read_Uint32());
+
+			Uint32 values[input_recording_event_values];
+
+			for( unsigned int value = 0; value < input_recording_event_values; value++ )
+			{
+				values[value] = m_replay_reader->Read_Uint32();
+			}
+
+			switch( ev.type )
+			{
+				case SDL_KEYDOWN:
+				case SDL_KEYUP:
+				{
+					ev.key.state = ev.type == SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED;
+					ev.key.keysym.sym = static_cast<SDLKey>(values[0]);
+					ev.key.keysym.mod = static_cast<SDLMod>(values[1]);
+					ev.key.keysym.unicode = static_cast<Uint16>(values[2]);
+					break;
+				}
+				case SDL_JOYAXISMOTION:
+				{
+					ev.jaxis.which = static_cast<Uint8>(values[0]);
+					ev.jaxis.axis = static_cast<Uint8>(values[1]);
+					ev.jaxis.value = static_cast<Sint16>(values[2]);
+					break;
+				}
+				case SDL_JOYHATMOTION:
+				{
+					ev.jhat.which = static_cast<Uint8>(values[0]);
+					ev.jhat.hat = static_cast<Uint8>(values[1]);
+					ev.jhat.value = static_cast<Uint8>(values[2]);
+					break;
+				}
+				case SDL_JOYBUTTONDOWN:
+				case SDL_JOYBUTTONUP:
+				{
+					ev.jbutton.which = static_cast<Uint8>(values[0]);
+					ev.jbutton.button = static_cast<Uint8>(values[1]);
+					ev.jbutton.state = static_cast<Uint8>(values[2]);
+					break;
+				}
+				case SDL_MOUSEMOTION:
+				{
+					ev.motion.state = static_cast<Uint8>(values[0]);
+					ev.motion.x = static_cast<Uint16>(values[1]);
+					ev.motion.y = static_cast<Uint16>(values[2]);
+					ev.motion.xrel = static_cast<Sint16>(values[3]);
+					ev.motion.yrel = static_cast<Sint16>(values[4]);
+					break;
+				}
+				case SDL_MOUSEBUTTONDOWN:
+				case SDL_MOUSEBUTTONUP:
+				{
+					ev.button.button = static_cast<Uint8>(values[0]);
+					ev.button.state = static_cast<Uint8>(values[1]);
+					ev.button.x = static_cast<Uint16>(values[2]);
+					ev.button.y = static_cast<Uint16>(values[3]);
+					break;
+				}
+				default:
+				{
+					continue;
+				}
+			}
+
+			Handle_Input_Global( &ev );
+		}
+
+		m_frame++;
+	}
+}
+
+void cInput_Recorder :: Record_Event( const SDL_Event *ev )
+{
+	if( !m_file || !Is_Input_Event( ev ) )
+	{
+		return;
+	}
+
+	Uint32 values[input_recording_event_values] = { 0, 0, 0, 0, 0 };
+
+	switch( ev->type )
+	{
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+		{
+			values[0] = ev->key.keysym.sym;
+			values[1] = ev->key.keysym.mod;
+			values[2] = ev->key.keysym.unicode;
+			break;
+		}
+		case SDL_JOYAXISMOTION:
+		{
+			values[0] = ev->jaxis.which;
+			values[1] = ev->jaxis.axis;
+			values[2] = static_cast<Uint32>(static_cast<Sint32>(ev->jaxis.value));
+			break;
+		}
+		case SDL_JOYHATMOTION:
+		{
+			values[0] = ev->jhat.which;
+			values[1] = ev->jhat.hat;
+			values[2] = ev->jhat.value;
+			break;
+		}
+		case SDL_JOYBUTTONDOWN:
+		case SDL_JOYBUTTONUP:
+		{
+			values[0] = ev->jbutton.which;
+			values[1] = ev->jbutton.button;
+			values[2] = ev->jbutton.state;
+			break;
+		}
+		case SDL_MOUSEMOTION:
+		{
+			values[0] = ev->motion.state;
+			values[1] = ev->motion.x;
+			values[2] = ev->motion.y;
+			values[3] = static_cast<Uint32>(static_cast<Sint32>(ev->motion.xrel));
+			values[4] = static_cast<Uint32>(static_cast<Sint32>(ev->motion.yrel));
+			break;
+		}
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+		{
+			values[0] = ev->button.button;
+			values[1] = ev->button.state;
+			values[2] = ev->button.x;
+			values[3] = ev->button.y;
+			break;
+		}
+	}
+
+	m_frame_events++;
+	m_events.Write_Uint32( ev->type );
+
+	for( unsigned int i = 0; i < input_recording_event_values; i++ )
+	{
+		m_events.Write_Uint32( values[i] );
+	}
+}
+
+bool cInput_Recorder :: Get_Mouse_Position( int &x, int &y ) const
+{
+	if( !m_replay_reader )
+	{
+		return 0;
+	}
+
+	x = m_mouse_x;
+	y = m_mouse_y;
+	return 1;
+}
+
+bool cInput_Recorder :: Is_Input_Event( const SDL_Event *ev )
+{
+	switch( ev->type )
+	{
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+		case SDL_JOYAXISMOTION:
+		case SDL_JOYHATMOTION:
+		case SDL_JOYBUTTONDOWN:
+		case SDL_JOYBUTTONUP:
+		case SDL_MOUSEMOTION:
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+		{
+			return 1;
+		}
+		default:
+		{
+			return 0;
+		}
+	}
+}
+
+void cInput_Recorder :: Write_Frame( void )
+{
+	// no frame started
+	if( m_frame_data.m_data.empty() )
+	{
+		return;
+	}
+
+	m_frame_data.Write_Uint32( m_frame_events );
+	m_frame_data.m_data += m_events.m_data;
+
+	fwrite( m_frame_data.m_data.data(), m_frame_data.m_data.size(), 1, m_file );
+
+	m_frame_data.m_data.clear();
+	m_events.m_data.clear();
+	m_frame_events = 0;
+}
+
+cInput_Recorder *pInput_Recorder = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
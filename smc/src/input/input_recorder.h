@@ -0,0 +1,120 @@
+/***************************************************************************
+ * input_recorder.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_INPUT_RECORDER_H
+#define SMC_INPUT_RECORDER_H
+
+#include "../core/global_basic.h"
+#include "../core/filesystem/filesystem.h"
+// SDL
+#include "SDL.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cInput_Recorder *** *** *** *** *** *** *** *** *** *** */
+
+/* Records the input events of each frame to a file and replays them
+ * every frame stores its speed factor, the mouse position and the keyboard, joystick and mouse events
+ * the file header stores the level started from the command line with its file hash and the random seed
+ * a replay feeds the recorded events to the input handlers instead of the real input
+ * and uses the recorded speed factor
+*/
+class cInput_Recorder
+{
+public:
+	cInput_Recorder( void );
+	~cInput_Recorder( void );
+
+	/* Start recording to the file
+	 * level : level started from the command line or empty
+	 * sets a random seed if none is set
+	 * returns false if the file could not be created
+	*/
+	bool Start_Recording( const std::string &filename, const std::string &level );
+	/* Start replaying the file
+	 * sets the recorded random seed
+	 * returns false if the file is invalid
+	*/
+	bool Start_Replay( const std::string &filename );
+	// Stop recording or replaying
+	void Stop( void );
+
+	// Returns true if recording
+	inline bool Is_Recording( void ) const
+	{
+		return m_file != NULL;
+	}
+	// Returns true if replaying
+	inline bool Is_Replaying( void ) const
+	{
+		return m_replay_reader != NULL;
+	}
+	// Returns the recorded level of the replay or an empty string
+	inline const std::string &Get_Level( void ) const
+	{
+		return m_level;
+	}
+
+	/* Start the input of the next frame
+	 * if recording saves the last frame and the current speed factor and mouse position
+	 * if replaying sets the recorded speed factor and handles the recorded events of the frame
+	 * stops the replay after the last frame
+	*/
+	void Update( void );
+	// Record the input event if recording
+	void Record_Event( const SDL_Event *ev );
+
+	/* Get the recorded mouse position of the replayed frame
+	 * returns false if not replaying
+	*/
+	bool Get_Mouse_Position( int &x, int &y ) const;
+
+	// Returns true if the event is a recorded keyboard, joystick or mouse event
+	static bool Is_Input_Event( const SDL_Event *ev );
+
+private:
+	// Write the events of the current frame
+	void Write_Frame( void );
+
+	// recording file
+	FILE *m_file;
+	// speed factor and mouse position of the current recorded frame
+	cIndex_Writer m_frame_data;
+	// events of the current recorded frame
+	cIndex_Writer m_events;
+	unsigned int m_frame_events;
+
+	// replay data
+	std::string m_replay_data;
+	cIndex_Reader *m_replay_reader;
+	// mouse position of the replayed frame
+	int m_mouse_x;
+	int m_mouse_y;
+
+	// recorded level
+	std::string m_level;
+	// current frame
+	unsigned int m_frame;
+};
+
+// Input recorder
+extern cInput_Recorder *pInput_Recorder;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -39,6 +39,7 @@ cJoystick :: cJoystick( void )
 	m_num_buttons = 0;
 	m_num_axes = 0;
 	m_num_balls = 0;
+	m_hat_value = SDL_HAT_CENTERED;
 
 	m_debug = 0;
 
@@ -135,6 +136,8 @@ bool cJoystick :: Stick_Open( unsigned int index )
 
 	// setup available buttons
 	m_buttons.assign( m_num_buttons, 0 );
+	m_axis_directions.assign( m_num_axes, 0 );
+	m_hat_value = SDL_HAT_CENTERED;
 
 	if( m_debug )
 	{
@@ -167,6 +170,7 @@ void cJoystick :: Stick_Close( void )
 	m_num_balls = 0;
 
 	m_buttons.clear();
+	m_axis_directions.clear();
 	m_joystick_open = 0;
 
 	if( m_debug )
@@ -186,6 +190,57 @@ void cJoystick :: Reset_keys( void )
 	m_right = 0;
 	m_up = 0;
 	m_down = 0;
+
+	// the next event sets the directions again
+	std::fill( m_axis_directions.begin(), m_axis_directions.end(), static_cast<Sint8>(0) );
+	m_hat_value = SDL_HAT_CENTERED;
+}
+
+bool cJoystick :: Is_Unchanged_Event( const SDL_Event *ev )
+{
+	if( ev->type == SDL_JOYAXISMOTION )
+	{
+		// only the direction axes are used
+		if( ev->jaxis.axis != pPreferences->m_joy_axis_hor && ev->jaxis.axis != pPreferences->m_joy_axis_ver )
+		{
+			return 1;
+		}
+
+		if( ev->jaxis.axis >= m_axis_directions.size() )
+		{
+			return 0;
+		}
+
+		// the threshold is the dead zone
+		Sint8 direction = 0;
+
+		if( ev->jaxis.value < -pPreferences->m_joy_axis_threshold )
+		{
+			direction = -1;
+		}
+		else if( ev->jaxis.value > pPreferences->m_joy_axis_threshold )
+		{
+			direction = 1;
+		}
+
+		if( m_axis_directions[ev->jaxis.axis] == direction )
+		{
+			return 1;
+		}
+
+		m_axis_directions[ev->jaxis.axis] = direction;
+	}
+	else if( ev->type == SDL_JOYHATMOTION )
+	{
+		if( m_hat_value == ev->jhat.value )
+		{
+			return 1;
+		}
+
+		m_hat_value = ev->jhat.value;
+	}
+
+	return 0;
 }
 
 void cJoystick :: Handle_Hat( SDL_Event *ev )
@@ -44,6 +44,12 @@ public:
 	// Resets all Buttons and modifiers
 	void Reset_keys( void );
 
+	/* Returns true if the axis or hat event does not change any direction
+	 * noisy analog sticks send axis events constantly
+	 * and these are dropped before they are recorded or handled
+	*/
+	bool Is_Unchanged_Event( const SDL_Event *ev );
+
 	// Handle the Hat
 	void Handle_Hat( SDL_Event *ev );
 	// Handles the Joystick motion
@@ -87,6 +93,11 @@ public:
 	// if true the current joystick is available/loaded
 	bool m_joystick_open;
 	
+	// last direction of each axis as -1, 0 or 1
+	vector<Sint8> m_axis_directions;
+	// last hat position
+	Uint8 m_hat_value;
+
 	// available buttons
 	unsigned int m_num_buttons;
 	// available axes
@@ -22,6 +22,7 @@
 #include "../gui/menu.h"
 #include "../overworld/overworld.h"
 #include "../core/framerate.h"
+#include "../core/profiler.h"
 #include "../audio/audio.h"
 #include "../level/level.h"
 #include "../user/preferences.h"
@@ -302,6 +303,33 @@ bool cKeyboard :: Key_Down( SDLKey key )
 
 		game_debug_performance = !game_debug_performance;
 	}
+	// overdraw heatmap
+	else if( key == SDLK_h && pKeyboard->Is_Ctrl_Down() )
+	{
+		if( game_debug_overdraw )
+		{
+			pHud_Debug->Set_Text( "Overdraw debug mode disabled" );
+		}
+		else
+		{
+			pHud_Debug->Set_Text( "Overdraw debug mode enabled" );
+		}
+
+		game_debug_overdraw = !game_debug_overdraw;
+	}
+	// capture a trace of the next frames
+	else if( key == SDLK_t && pKeyboard->Is_Ctrl_Down() )
+	{
+		if( pProfiler->Is_Capturing() )
+		{
+			pHud_Debug->Set_Text( "Trace capture already running" );
+		}
+		else
+		{
+			pProfiler->Start_Capture( 300 );
+			pHud_Debug->Set_Text( "Trace capture of 300 frames started" );
+		}
+	}
 
 	return 0;
 }
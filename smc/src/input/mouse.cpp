@@ -15,6 +15,7 @@
 
 #include "../core/global_basic.h"
 #include "../input/mouse.h"
+#include "../input/input_recorder.h"
 #include "../input/keyboard.h"
 #include "../core/game_core.h"
 #include "../level/level_editor.h"
@@ -31,6 +32,8 @@
 #include "../video/font.h"
 #include "../video/renderer.h"
 #include "../core/i18n.h"
+#include "../core/editor_history.h"
+#include <algorithm>
 
 namespace SMC
 {
@@ -90,6 +93,9 @@ cMouseCursor :: cMouseCursor( cSprite_Manager *sprite_manager )
 	m_mover_mode = 0;
 	m_last_clicked_object = NULL;
 
+	m_history = new cEditor_History();
+	m_history->Set_Sprite_Manager( sprite_manager );
+
 	Reset_Keys();
 	Update_Position();
 	// disable mouse initially
@@ -101,6 +107,13 @@ cMouseCursor :: ~cMouseCursor( void )
 	Clear_Copy_Objects();
 	Clear_Selected_Objects();
 	delete m_hovering_object;
+	delete m_history;
+}
+
+void cMouseCursor :: Set_Sprite_Manager( cSprite_Manager *sprite_manager )
+{
+	cMovingSprite::Set_Sprite_Manager( sprite_manager );
+	m_history->Set_Sprite_Manager( sprite_manager );
 }
 
 void cMouseCursor :: Set_Active( bool enabled )
@@ -119,6 +132,8 @@ void cMouseCursor :: Reset( bool clear_copy_buffer /* = 1 */ )
 	Clear_Selected_Objects();
 	Clear_Hovered_Object();
 	Clear_Active_Object();
+	// objects can change outside of the editor
+	m_history->Clear();
 
 	// change to default cursor
 	if( m_mover_mode )
@@ -269,6 +284,8 @@ bool cMouseCursor :: Handle_Mouse_Up( Uint8 button )
 		case SDL_BUTTON_LEFT:
 		{
 			m_left = 0;
+			// the dragged objects are moved
+			m_history->End_Move();
 			if( CEGUI::System::getSingleton().injectMouseButtonUp( CEGUI::LeftButton ) )
 			{
 				return 1;
@@ -376,11 +393,15 @@ cObjectCollision *cMouseCursor :: Get_First_Editor_Collsion( float px /* = 0.0f
 
 cObjectCollision *cMouseCursor :: Get_First_Mouse_Collision( const GL_rect &mouse_rect )
 {
-	cSprite_List sprite_objects;
-	m_sprite_manager->Get_Objects_sorted( sprite_objects, 1, 1 );
+	cSprite_List editor_objects;
+	m_sprite_manager->Get_Editor_Objects( editor_objects, mouse_rect );
 
-	// check objects
-	for( cSprite_List::reverse_iterator itr = sprite_objects.rbegin(); itr != sprite_objects.rend(); ++itr )
+	const cSprite_Manager::editor_zpos_sort zpos_sort = cSprite_Manager::editor_zpos_sort();
+	// front object
+	cSprite *first = NULL;
+
+	// the last one in array order is in front if the z position is the same
+	for( cSprite_List::const_iterator itr = editor_objects.begin(); itr != editor_objects.end(); ++itr )
 	{
 		cSprite *obj = (*itr);
 
@@ -390,13 +411,31 @@ cObjectCollision *cMouseCursor :: Get_First_Mouse_Collision( const GL_rect &mous
 			continue;
 		}
 
-		if( mouse_rect.Intersects( obj->m_start_rect ) )
+		if( !mouse_rect.Intersects( obj->m_start_rect ) )
+		{
+			continue;
+		}
+
+		if( !first || !zpos_sort( obj, first ) )
 		{
-			return Create_Collision_Object( this, obj, COL_VTYPE_INTERNAL );
+			first = obj;
 		}
 	}
 
-	return NULL;
+	// the player is not in the objects and is in front of objects with the same z position
+	cSprite *player = pActive_Player;
+
+	if( player && !player->m_spawned && !player->m_auto_destroy && mouse_rect.Intersects( player->m_start_rect ) && ( !first || !zpos_sort( player, first ) ) )
+	{
+		first = player;
+	}
+
+	if( !first )
+	{
+		return NULL;
+	}
+
+	return Create_Collision_Object( this, first, COL_VTYPE_INTERNAL );
 }
 
 void cMouseCursor :: Update( void )
@@ -435,7 +474,11 @@ void cMouseCursor :: Update_Position( void )
 {
 	if( !m_mover_mode )
 	{
-		SDL_GetMouseState( &m_x, &m_y );
+		// replayed position
+		if( !pInput_Recorder->Get_Mouse_Position( m_x, m_y ) )
+		{
+			SDL_GetMouseState( &m_x, &m_y );
+		}
 		// scale to the virtual game size
 		m_x = static_cast<int>( static_cast<float>(m_x) * global_downscalex );
 		m_y = static_cast<int>( static_cast<float>(m_y) * global_downscaley );
@@ -727,6 +770,8 @@ void cMouseCursor :: Paste_Copy_Objects( float px, float py )
 
 	cSprite_List new_objects;
 
+	m_history->Begin_Step();
+
 	for( CopyObjectList::iterator itr = m_copy_objects.begin(); itr != m_copy_objects.end(); ++itr )
 	{
 		cCopyObject *copy_obj = (*itr);
@@ -735,7 +780,7 @@ void cMouseCursor :: Paste_Copy_Objects( float px, float py )
 		GL_Vector base_vec = Get_Copy_Object_Base( copy_obj->m_obj->m_pos_x, copy_obj->m_obj->m_pos_y );
 
 		// copy
-		cSprite* new_object = Copy( copy_obj->m_obj, px + base_vec.x, py + base_vec.y );
+		cSprite* new_object = Copy( copy_obj->m_obj, px + base_vec.x, py + base_vec.y, 0 );
 
 		if( new_object )
 		{
@@ -743,6 +788,16 @@ void cMouseCursor :: Paste_Copy_Objects( float px, float py )
 		}
 	}
 
+	// added at once
+	m_sprite_manager->Add_Objects( new_objects );
+
+	for( cSprite_List::iterator itr = new_objects.begin(); itr != new_objects.end(); ++itr )
+	{
+		m_history->Add_Create( *itr );
+	}
+
+	m_history->End_Step();
+
 	if( !m_copy_objects.empty() )
 	{
 		m_hovering_object->m_mouse_offset_y = static_cast<int>( m_copy_objects[0]->m_obj->m_col_rect.m_h / 2 );
@@ -784,6 +839,7 @@ bool cMouseCursor :: Add_Selected_Object( cSprite *sprite, bool from_user /* = 0
 	selected_object->m_obj = sprite;
 	selected_object->m_user = from_user;
 	m_selected_objects.push_back( selected_object );
+	m_selected_sprites.insert( sprite );
 
 	Update_Selected_Object_Offset( selected_object );
 
@@ -826,6 +882,7 @@ bool cMouseCursor :: Remove_Selected_Object( const cSprite *sprite, bool no_user
 			}
 
 			m_selected_objects.erase( itr );
+			m_selected_sprites.erase( sprite );
 			delete sel_obj;
 			
 			return 1;
@@ -901,6 +958,7 @@ void cMouseCursor :: Clear_Selected_Objects( void )
 	}
 
 	m_selected_objects.clear();
+	m_selected_sprites.clear();
 }
 
 void cMouseCursor :: Update_Selected_Objects( void )
@@ -927,16 +985,21 @@ void cMouseCursor :: Update_Selected_Objects( void )
 		return;
 	}
 
-	for( SelectedObjectList::iterator itr = m_selected_objects.begin(); itr != m_selected_objects.end(); ++itr )
+	// left mouse is pressed
+	if( !m_left )
 	{
-		cSelectedObject *sel_obj = (*itr);
+		return;
+	}
 
-		// left mouse is pressed
-		if( m_left )
-		{
-			Set_Object_Position( sel_obj );
-		}
+	// the grids are updated once after moving all objects
+	m_sprite_manager->Begin_Batch_Update();
+
+	for( SelectedObjectList::iterator itr = m_selected_objects.begin(); itr != m_selected_objects.end(); ++itr )
+	{
+		Set_Object_Position( *itr );
 	}
+
+	m_sprite_manager->End_Batch_Update();
 }
 
 void cMouseCursor :: Update_Selected_Object_Offset( cSelectedObject *obj )
@@ -964,6 +1027,16 @@ bool cMouseCursor :: Is_Selected_Object( const cSprite *sprite, bool only_user /
 		return 0;
 	}
 
+	if( !m_selected_sprites.count( sprite ) )
+	{
+		return 0;
+	}
+
+	if( !only_user )
+	{
+		return 1;
+	}
+
 	for( SelectedObjectList::iterator itr = m_selected_objects.begin(); itr != m_selected_objects.end(); ++itr )
 	{
 		cSelectedObject *sel_obj = (*itr);
@@ -986,12 +1059,25 @@ bool cMouseCursor :: Is_Selected_Object( const cSprite *sprite, bool only_user /
 
 void cMouseCursor :: Delete_Selected_Objects( void )
 {
+	m_history->Begin_Step();
+
+	cSprite_List objects;
+	objects.reserve( m_selected_objects.size() );
+
 	for( int i = m_selected_objects.size() - 1; i >= 0; i-- )
 	{
-		Delete( m_selected_objects[i]->m_obj );
+		objects.push_back( m_selected_objects[i]->m_obj );
 	}
 
+	// cleared first so the deleted objects are not searched in the selection one by one
 	Clear_Selected_Objects();
+
+	for( cSprite_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	{
+		Delete( *itr );
+	}
+
+	m_history->End_Step();
 }
 
 bool cMouseCursor :: Get_Snap_Pos( GL_point &new_pos, int snap, cSelectedObject *src_obj )
@@ -1031,13 +1117,21 @@ bool cMouseCursor :: Get_Snap_Pos( GL_point &new_pos, int snap, cSelectedObject
 	int num_snap_obj = 0;
 	cSprite *snap_obj = NULL;
 
+	// selected objects sorted for searching
+	cSprite_List selected_objects = Get_Selected_Objects();
+	std::sort( selected_objects.begin(), selected_objects.end() );
+
+	// objects near the snap rect
+	cSprite_List snap_objects;
+	m_sprite_manager->Get_Editor_Objects( snap_objects, full_snap_rect );
+
 	// check objects for overlap
-	for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+	for( cSprite_List::iterator itr = snap_objects.begin(); itr != snap_objects.end(); ++itr )
 	{
 		cSprite *obj = (*itr);
 
 		// don't check selected objects
-		if( Is_Selected_Object( obj, 0 ) )
+		if( std::binary_search( selected_objects.begin(), selected_objects.end(), obj ) )
 		{
 			continue;
 		}
@@ -1282,6 +1376,7 @@ void cMouseCursor :: Set_Active_Object( cSprite *sprite )
 	{
 		m_active_object = sprite;
 		m_active_object->Editor_Activate();
+		m_history->Begin_Property( m_active_object );
 	}
 }
 
@@ -1292,11 +1387,12 @@ void cMouseCursor :: Clear_Active_Object( void )
 		return;
 	}
 
+	m_history->End_Property( m_active_object );
 	m_active_object->Editor_Deactivate();
 	m_active_object = NULL;
 }
 
-cSprite *cMouseCursor :: Copy( const cSprite *copy_object, float px, float py ) const
+cSprite *cMouseCursor :: Copy( const cSprite *copy_object, float px, float py, bool add /* = 1 */ ) const
 {
 	if( !copy_object )
 	{
@@ -1332,7 +1428,10 @@ cSprite *cMouseCursor :: Copy( const cSprite *copy_object, float px, float py )
 	// set position
 	new_sprite->Set_Pos( px, py, 1 );
 	// add it
-	m_sprite_manager->Add( new_sprite );
+	if( add )
+	{
+		m_sprite_manager->Add( new_sprite );
+	}
 
 	return new_sprite;
 }
@@ -1367,29 +1466,50 @@ void cMouseCursor :: Delete( cSprite *sprite )
 	Remove_Selected_Object( sprite );
 	// remove copy object
 	Remove_Copy_Object( sprite );
+	// it gets deleted at the end of the frame
+	if( m_hovering_object->m_obj == sprite )
+	{
+		Clear_Hovered_Object();
+	}
 
 	// delete object
 	if( editor_enabled )
 	{
+		m_history->Add_Delete( sprite );
 		sprite->Destroy();
 	}
 }
 
 void cMouseCursor :: Set_Object_Position( cSelectedObject *sel_obj )
 {
+	cSprite *obj = sel_obj->m_obj;
+	GL_point new_pos;
+
 	// if in snap mode and snap available
 	if( m_snap_to_object_mode && m_snap_pos_available )
 	{
-		sel_obj->m_obj->Set_Pos( m_snap_pos.m_x - sel_obj->m_mouse_offset_x, m_snap_pos.m_y - sel_obj->m_mouse_offset_y, 1 );
+		new_pos.m_x = m_snap_pos.m_x - sel_obj->m_mouse_offset_x;
+		new_pos.m_y = m_snap_pos.m_y - sel_obj->m_mouse_offset_y;
 	}
 	else
 	{
-		// set new position
-		sel_obj->m_obj->Set_Pos( static_cast<float>( static_cast<int>(m_pos_x) - sel_obj->m_mouse_offset_x ), static_cast<float>( static_cast<int>(m_pos_y) - sel_obj->m_mouse_offset_y ), 1 );
+		new_pos.m_x = static_cast<float>( static_cast<int>(m_pos_x) - sel_obj->m_mouse_offset_x );
+		new_pos.m_y = static_cast<float>( static_cast<int>(m_pos_y) - sel_obj->m_mouse_offset_y );
 	}
 
+	// not moved since the last frame
+	if( Is_Float_Equal( obj->m_start_pos_x, new_pos.m_x ) && Is_Float_Equal( obj->m_start_pos_y, new_pos.m_y ) && Is_Float_Equal( obj->m_pos_x, new_pos.m_x ) && Is_Float_Equal( obj->m_pos_y, new_pos.m_y ) )
+	{
+		return;
+	}
+
+	// added as move with the left mouse release
+	m_history->Begin_Move( obj );
+	// set new position
+	obj->Set_Pos( new_pos.m_x, new_pos.m_y, 1 );
+
 	// update object settings position
-	if( m_active_object && m_active_object == sel_obj->m_obj )
+	if( m_active_object && m_active_object == obj )
 	{
 		m_active_object->Editor_Position_Update();
 	}
@@ -1397,10 +1517,18 @@ void cMouseCursor :: Set_Object_Position( cSelectedObject *sel_obj )
 
 void cMouseCursor :: Draw_Object_Rects( void )
 {
+	/* all overlays of a frame are drawn with one stream per line style and one for the fills
+	 * the stipple pattern is set per stream
+	*/
+	cLine_Stream_Request *solid_lines = new cLine_Stream_Request();
+	cLine_Stream_Request *selected_lines = new cLine_Stream_Request();
+	// with stipple
+	selected_lines->m_stipple_pattern = 0xAAAA;
+	cQuad_Stream_Request *fills = new cQuad_Stream_Request();
+	fills->m_no_camera = 1;
+
 	// current hover rect
 	GL_rect hover_rect;
-	// current object color
-	Color obj_color = white;
 
 	if( !m_left && m_hovering_object->m_obj )
 	{
@@ -1410,36 +1538,56 @@ void cMouseCursor :: Draw_Object_Rects( void )
 		hover_rect.m_h = m_hovering_object->m_obj->m_start_rect.m_h;
 
 		// get object color
-		obj_color = Get_Massive_Type_Color( m_hovering_object->m_obj->m_massive_type );
-
-		// create request
-		cRect_Request *request = new cRect_Request();
-		pVideo->Draw_Rect( &hover_rect, 0.6f, &obj_color, request );
+		Color obj_color = Get_Massive_Type_Color( m_hovering_object->m_obj->m_massive_type );
 
 		if( m_fastcopy_mode )
 		{
-			request->m_color.alpha = 64;
+			obj_color.alpha = 64;
+			fills->Add_Rect( hover_rect, 0.6f, obj_color );
 		}
 		// not fastcopy
 		else
 		{
-			// not filled
-			request->m_filled = 0;
+			solid_lines->Add_Rect( hover_rect, 0.6f, obj_color );
 		}
-
-		// add request
-		pRenderer->Add( request );
 	}
 
 
 	// draw selected objects if not left mouse is pressed, shift selection or mouse selection
 	if( !m_left || ( pKeyboard->Is_Shift_Down() && !pKeyboard->Is_Ctrl_Down() ) || m_selection_mode )
 	{
-		obj_color = white;
+		cSprite_List visible_objects;
 
-		for( SelectedObjectList::iterator itr = m_selected_objects.begin(); itr != m_selected_objects.end(); ++itr )
+		// a large selection only checks the objects in the camera view
+		if( m_selected_objects.size() > m_max_checked_selected_objects )
 		{
-			cSprite *object = (*itr)->m_obj;
+			m_sprite_manager->Get_Editor_Objects( visible_objects, GL_rect( pActive_Camera->m_x, pActive_Camera->m_y, static_cast<float>(game_res_w), static_cast<float>(game_res_h) ) );
+
+			for( cSprite_List::iterator itr = visible_objects.begin(); itr != visible_objects.end(); )
+			{
+				if( !m_selected_sprites.count( *itr ) )
+				{
+					itr = visible_objects.erase( itr );
+				}
+				else
+				{
+					++itr;
+				}
+			}
+		}
+		else
+		{
+			for( SelectedObjectList::iterator itr = m_selected_objects.begin(); itr != m_selected_objects.end(); ++itr )
+			{
+				visible_objects.push_back( (*itr)->m_obj );
+			}
+		}
+
+		selected_lines->Reserve( static_cast<unsigned int>(visible_objects.size()) * 4 );
+
+		for( cSprite_List::iterator itr = visible_objects.begin(); itr != visible_objects.end(); ++itr )
+		{
+			cSprite *object = (*itr);
 
 			// check if visible on screen or mouse object
 			if( !object->Is_Visible_On_Screen() || object == m_hovering_object->m_obj )
@@ -1452,9 +1600,6 @@ void cMouseCursor :: Draw_Object_Rects( void )
 			hover_rect.m_w = object->m_start_rect.m_w;
 			hover_rect.m_h = object->m_start_rect.m_h;
 
-			// object color
-			obj_color = Get_Massive_Type_Color( object->m_massive_type );
-
 			// z position
 			float pos_z = 0.5f;
 
@@ -1472,33 +1617,44 @@ void cMouseCursor :: Draw_Object_Rects( void )
 				pos_z += 0.003f;
 			}
 
-			// create request
-			cRect_Request *rect_request = new cRect_Request();
-			pVideo->Draw_Rect( &hover_rect, pos_z, &obj_color, rect_request );
-
-			// not filled
-			rect_request->m_filled = 0;
-			// with stipple
-			rect_request->m_stipple_pattern = 0xAAAA;
-
-			// add request
-			pRenderer->Add( rect_request );
+			selected_lines->Add_Rect( hover_rect, pos_z, Get_Massive_Type_Color( object->m_massive_type ) );
 		}
 	}
 
 	// draw bounding box if multiple objects snapped at once
 	if( m_left && m_snap_to_object_mode && m_selected_objects.size() > 1 )
 	{
-		// create request
-		cRect_Request *rect_request = new cRect_Request();
 		GL_rect sel_rect = Get_Selected_Objects_Rect();
-		pVideo->Draw_Rect( sel_rect.m_x - pActive_Camera->m_x, sel_rect.m_y - pActive_Camera->m_y, sel_rect.m_w, sel_rect.m_h, 0.51f, &lightgrey, rect_request );
+		sel_rect.m_x -= pActive_Camera->m_x;
+		sel_rect.m_y -= pActive_Camera->m_y;
 
-		// not filled
-		rect_request->m_filled = 0;
+		solid_lines->Add_Rect( sel_rect, 0.51f, lightgrey );
+	}
 
-		// add request
-		pRenderer->Add( rect_request );
+	// add requests
+	if( solid_lines->m_line_count )
+	{
+		pRenderer->Add( solid_lines );
+	}
+	else
+	{
+		delete solid_lines;
+	}
+	if( selected_lines->m_line_count )
+	{
+		pRenderer->Add( selected_lines );
+	}
+	else
+	{
+		delete selected_lines;
+	}
+	if( fills->m_quad_count )
+	{
+		pRenderer->Add( fills );
+	}
+	else
+	{
+		delete fills;
 	}
 }
 
@@ -1565,8 +1721,11 @@ void cMouseCursor :: Update_Selection( void )
 		Clear_Selected_Objects();
 	}
 
+	cSprite_List editor_objects;
+	m_sprite_manager->Get_Editor_Objects( editor_objects, rect );
+
 	// add selected objects
-	for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+	for( cSprite_List::iterator itr = editor_objects.begin(); itr != editor_objects.end(); ++itr )
 	{
 		cSprite *obj = (*itr);
 
@@ -1772,14 +1931,13 @@ void cMouseCursor :: Editor_Update( void )
 			info.insert( 0, "Start " );
 		}
 
-		// create text surface
-		cGL_Surface *position_info = pFont->Render_Text( pFont->m_font_small, info, white );
+		// get text surface
+		cGL_Surface *position_info = pFont->Get_Text( pFont->m_font_small, info, white );
 
 
 		// create request
 		cSurface_Request *request = new cSurface_Request();
 		position_info->Blit( static_cast<float>( m_x + 20 ), static_cast<float>( m_y + 35 ), 0.52f, request );
-		request->m_delete_texture = 1;
 
 		// shadow
 		request->m_shadow_pos = 1.0f;
@@ -1788,9 +1946,7 @@ void cMouseCursor :: Editor_Update( void )
 		// add request
 		pRenderer->Add( request );
 
-		// cSurface_Request deletes it
-		position_info->m_auto_del_img = 0;
-		delete position_info;
+		pFont->Release_Text( position_info );
 
 		// if in debug mode draw current position X, Y, Z and if available editor Z
 		if( game_debug )
@@ -1803,13 +1959,12 @@ void cMouseCursor :: Editor_Update( void )
 				info.insert( info.length(), _("  Editor Z : ") + float_to_string( m_hovering_object->m_obj->m_editor_pos_z, 6 ) );
 			}
 
-			// create text surface
-			position_info = pFont->Render_Text( pFont->m_font_small, info, white );
+			// get text surface
+			position_info = pFont->Get_Text( pFont->m_font_small, info, white );
 			
 			// create request
 			request = new cSurface_Request();
 			position_info->Blit( static_cast<float>( m_x + 20 ), static_cast<float>( m_y + 55 ), 0.52f, request );
-			request->m_delete_texture = 1;
 
 			// shadow
 			request->m_shadow_pos = 1.0f;
@@ -1818,9 +1973,7 @@ void cMouseCursor :: Editor_Update( void )
 			// add request
 			pRenderer->Add( request );
 
-			// cSurface_Request deletes it
-			position_info->m_auto_del_img = 0;
-			delete position_info;
+			pFont->Release_Text( position_info );
 		}
 	}
 
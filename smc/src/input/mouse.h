@@ -20,6 +20,8 @@
 #include "../objects/movingsprite.h"
 #include "../core/math/rect.h"
 #include "../core/math/vector.h"
+// STL
+#include <set>
 
 namespace SMC
 {
@@ -68,6 +70,8 @@ public:
 
 	// Set active/visible
 	virtual void Set_Active( bool enabled );
+	// Set the parent sprite manager and clear the editor history if it changed
+	virtual void Set_Sprite_Manager( cSprite_Manager *sprite_manager );
 	// resets editor features
 	void Reset( bool clear_copy_buffer = 1 );
 	// only reset buttons
@@ -197,10 +201,10 @@ public:
 	void Clear_Active_Object( void );
 
 	/* Copies the given object to the given position
-	 * object is automatically added to the object manager
+	 * object is automatically added to the object manager if add is set
 	 * returns the new object
 	*/
-	cSprite *Copy( const cSprite *copy_object, float px, float py ) const;
+	cSprite *Copy( const cSprite *copy_object, float px, float py, bool add = 1 ) const;
 	// Deletes the given Object
 	void Delete( cSprite *sprite );
 	// Set the mouse position to the given object
@@ -237,6 +241,9 @@ public:
 	// fast copy mode
 	bool m_fastcopy_mode;
 
+	// selected objects over this count are looked up in the editor grid of the camera view
+	static const unsigned int m_max_checked_selected_objects = 64;
+
 	// if activated the selected object(s) snap to the nearest object
 	bool m_snap_to_object_mode;
 	// if a snap position was found
@@ -248,12 +255,16 @@ public:
 	 * the mouse object is also always a selected object
 	*/
 	SelectedObjectList m_selected_objects;
+	// sprites of the selected objects for fast lookups
+	std::set<const cSprite *> m_selected_sprites;
 	// currently colliding object with the mouse
 	cSelectedObject *m_hovering_object;
 	// objects selected for copying
 	CopyObjectList m_copy_objects;
 	// settings activated object
 	cSprite *m_active_object;
+	// editor undo and redo of the object changes
+	cEditor_History *m_history;
 
 	// buttons pressed state
 	bool m_left;
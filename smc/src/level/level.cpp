@@ -16,10 +16,17 @@
 #include "../level/level.h"
 #include "../level/level_editor.h"
 #include "../core/game_core.h"
+#include "../core/xml_reader.h"
 #include "../gui/menu.h"
 #include "../user/preferences.h"
 #include "../audio/audio.h"
 #include "../level/level_player.h"
+#include "../level/level_prefetch.h"
+#include "../level/level_binary.h"
+#include "../level/level_stream.h"
+#include "../level/level_saver.h"
+#include "../level/level_manifest.h"
+#include "../level/level_preview.h"
 #include "../objects/goldpiece.h"
 #include "../objects/level_exit.h"
 #include "../video/font.h"
@@ -49,15 +56,20 @@
 #include "../objects/text_box.h"
 #include "../objects/moving_platform.h"
 #include "../video/renderer.h"
+#include "../video/screen_transition.h"
 #include "../core/math/utilities.h"
+#include "../core/benchmark.h"
 #include "../core/i18n.h"
 #include "../objects/path.h"
 #include "../core/filesystem/filesystem.h"
 #include "../core/filesystem/resource_manager.h"
+#include "../core/memory_pool.h"
+#include "../core/engine_context.h"
 #include "../overworld/world_editor.h"
 // CEGUI
 #include "CEGUIXMLParser.h"
 #include "CEGUIExceptions.h"
+#include <sstream>
 
 namespace SMC
 {
@@ -70,8 +82,14 @@ cLevel :: cLevel( void )
 	Reset_Settings();
 
 	m_delayed_unload = 0;
+	m_random_seed = 0;
+	m_stream = NULL;
+	m_object_count = 0;
+	m_manifest = new cLevel_Manifest();
+	m_arena = new cMemory_Arena();
 
 	m_sprite_manager = new cSprite_Manager();
+	m_sprite_manager->Set_Static_Chunks( 1 );
 	m_background_manager = new cBackground_Manager();
 	m_animation_manager = new cAnimation_Manager();
 
@@ -90,6 +108,15 @@ cLevel :: ~cLevel( void )
 	delete m_background_manager;
 	delete m_animation_manager;
 	delete m_sprite_manager;
+	delete m_manifest;
+
+	if( pSprite_Arena == m_arena )
+	{
+		pSprite_Arena = NULL;
+	}
+
+	// deleted with the last sprite if any is still used
+	m_arena->Close();
 }
 
 bool cLevel :: New( std::string filename )
@@ -165,6 +192,9 @@ bool cLevel :: Load( std::string filename )
 {
 	m_next_level_filename.clear();
 
+	// a level saved in the background could be loaded
+	pLevel_Saver->Wait();
+
 	if( !pLevel_Manager->Get_Path( filename ) )
 	{
 		// show error without directory and file type
@@ -174,25 +204,136 @@ bool cLevel :: Load( std::string filename )
 
 	Unload();
 
+	// the objects get their random generator seeds while loading
+	m_random_seed = level_random_seed ? level_random_seed : Get_Random_Seed();
+	game_random.Seed( m_random_seed );
+
 	// new level format
 	if( filename.rfind( ".smclvl" ) != std::string::npos )
 	{
+		// decode the images in the background while the objects get created
+		cLevel_Prefetch prefetch;
+		// compiled level from the cache which skips the XML parsing
+		cLevel_Binary *binary = new cLevel_Binary();
+		// compiled level loaded in the background with its images already decoding
+		cLevel_Binary *preloaded = NULL;
+		// compiled level kept from the last load of this level for restarting it
+		cLevel_Binary *snapshot = NULL;
+		bool binary_loaded = 0;
+		// files used the last time and recording of the files used while loading
+		cLevel_Manifest *previous_recording = cLevel_Manifest::m_recording;
+		// the objects are allocated from the level arena
+		cMemory_Arena *previous_arena = pSprite_Arena;
+		pSprite_Arena = m_arena;
+
+		{
+			cLoad_Profiler_Scope profile_scope( "file read" );
+
+			m_manifest->Load( filename );
+			cLevel_Manifest::m_recording = m_manifest;
+
+			preloaded = pLevel_Preloader->Take( filename );
+
+			if( !preloaded )
+			{
+				snapshot = pLevel_Manager->Get_Snapshot( filename );
+			}
+
+			if( !preloaded && !snapshot )
+			{
+				binary_loaded = binary->Load( filename );
+			}
+		}
+
 		try
 		{
-		// fixme : Workaround for std::string to CEGUI::String utf8 conversion. Check again if CEGUI 0.8 works with std::string utf8
-		#ifdef _WIN32
-			CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, (const CEGUI::utf8*)filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/Level.xsd", "" );
-		#else
-			CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/Level.xsd", "" );
-		#endif
+			// the images of a restarted level are mostly still loaded
+			if( preloaded || snapshot )
+			{
+				const cLevel_Binary *compiled = preloaded ? preloaded : snapshot;
+
+				cLoad_Profiler_Scope profile_scope( "level parse" );
+
+				if( compiled->Get_Element_Count() >= level_stream_min_elements && !editor_level_enabled )
+				{
+					m_stream = new cLevel_Stream( this );
+				}
+
+				for( unsigned int i = 0; i < compiled->Get_Element_Count(); i++ )
+				{
+					compiled->Get_Attributes( i, m_xml_attributes );
+					elementEnd( reinterpret_cast<const CEGUI::utf8 *>(compiled->Get_Element_Name( i )) );
+				}
+			}
+			else if( binary_loaded )
+			{
+				{
+					cLoad_Profiler_Scope profile_scope( "image prefetch" );
+					prefetch.Start( *binary, m_manifest );
+				}
+
+				cLoad_Profiler_Scope profile_scope( "level parse" );
+
+				if( binary->Get_Element_Count() >= level_stream_min_elements && !editor_level_enabled )
+				{
+					m_stream = new cLevel_Stream( this );
+				}
+
+				for( unsigned int i = 0; i < binary->Get_Element_Count(); i++ )
+				{
+					binary->Get_Attributes( i, m_xml_attributes );
+					elementEnd( reinterpret_cast<const CEGUI::utf8 *>(binary->Get_Element_Name( i )) );
+				}
+			}
+			// the parser shows the errors
+			else
+			{
+				{
+					cLoad_Profiler_Scope profile_scope( "image prefetch" );
+					prefetch.Start( filename, m_manifest );
+				}
+
+				cLoad_Profiler_Scope profile_scope( "xml parse" );
+
+				Parse_XML_File( *this, filename, "Level.xsd" );
+			}
 		}
 		// catch CEGUI Exceptions
 		catch( CEGUI::Exception &ex )
 		{
 			printf( "Loading Level %s CEGUI Exception %s\n", filename.c_str(), ex.getMessage().c_str() );
 			pHud_Debug->Set_Text( _("Loading Level failed : ") + (const std::string)ex.getMessage().c_str() );
+			pLevel_Preloader->Clear();
+			pLevel_Manager->Clear_Snapshot( filename );
+			cLevel_Manifest::m_recording = previous_recording;
+			pSprite_Arena = previous_arena;
+			delete binary;
 			return 0;
 		}
+
+		{
+			cLoad_Profiler_Scope profile_scope( "manifest preload" );
+			m_manifest->Preload();
+		}
+
+		cLevel_Manifest::m_recording = previous_recording;
+		pSprite_Arena = previous_arena;
+
+		// delete the unused images
+		prefetch.Stop();
+
+		// keep the compiled level for restarting
+		if( preloaded )
+		{
+			pLevel_Manager->Set_Snapshot( filename, pLevel_Preloader->Release( filename ) );
+		}
+		else if( binary_loaded )
+		{
+			pLevel_Manager->Set_Snapshot( filename, binary );
+			binary = NULL;
+		}
+
+		delete binary;
 	}
 	// old level format
 	else
@@ -204,11 +345,22 @@ bool cLevel :: Load( std::string filename )
 	/* late initialization
 	 * needed to create links to other objects
 	*/
-	for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
 	{
-		cSprite *obj = (*itr);
+		cLoad_Profiler_Scope profile_scope( "object links" );
+
+		for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+		{
+			cSprite *obj = (*itr);
+
+			obj->Init_Links();
+		}
+	}
 
-		obj->Init_Links();
+	m_pristine_objects.assign( m_object_count, NULL );
+
+	for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+	{
+		Set_Pristine( *itr );
 	}
 
 	m_level_filename = filename;
@@ -219,6 +371,13 @@ bool cLevel :: Load( std::string filename )
 		m_engine_version = 0;
 	}
 
+	// streamed levels don't have all objects loaded
+	if( !m_stream )
+	{
+		cLoad_Profiler_Scope profile_scope( "preview" );
+		cLevel_Preview::Update( m_level_filename, m_sprite_manager, Get_Background_Color() );
+	}
+
 	return 1;
 }
 
@@ -263,15 +422,38 @@ void cLevel :: Unload( bool delayed /* = 0 */ )
 
 	Reset_Settings();
 
+	// save the used files
+	m_manifest->Leave();
+	m_manifest->Clear();
+
+	if( m_stream )
+	{
+		delete m_stream;
+		m_stream = NULL;
+	}
+
+	for( vector<cSave_Level_Object *>::iterator itr = m_pristine_objects.begin(); itr != m_pristine_objects.end(); ++itr )
+	{
+		delete *itr;
+	}
+
+	m_pristine_objects.clear();
+	m_object_count = 0;
+
 	/* delete sprites
 	 * do this at last
 	*/
 	m_sprite_manager->Delete_All();
+	// free the sprite memory at once
+	m_arena->Release_Unused();
 }
 
-void cLevel :: Save( void )
+void cLevel :: Save( bool with_sound /* = 1 */ )
 {
-	pAudio->Play_Sound( "editor/save.ogg" );
+	if( with_sound )
+	{
+		pAudio->Play_Sound( "editor/save.ogg" );
+	}
 
 	// use user level dir
 	if( m_level_filename.find( pResource_Manager->user_data_dir + USER_LEVEL_DIR + "/" ) == std::string::npos )
@@ -282,28 +464,26 @@ void cLevel :: Save( void )
 		m_level_filename.insert( 0, pResource_Manager->user_data_dir + USER_LEVEL_DIR + "/" );
 	}
 
-// fixme : Check if there is a more portable way f.e. with imbue()
-#ifdef _WIN32
-	ofstream file( utf8_to_ucs2( m_level_filename ).c_str(), ios::out | ios::trunc );
-#else
-	ofstream file( m_level_filename.c_str(), ios::out | ios::trunc );
-#endif
+	// the uncompressed file is replaced
+	std::string old_filename;
 
-
-	if( !file )
+	if( pPreferences->m_editor_save_compressed && !Is_Compressed_File( m_level_filename ) )
 	{
-		printf( "Error : Couldn't open level file for saving. Is the file read-only ?" );
-		pHud_Debug->Set_Text( _("Couldn't save level ") + m_level_filename, speedfactor_fps * 5.0f );
-		return;
+		old_filename = m_level_filename;
+		m_level_filename.insert( m_level_filename.length(), COMPRESSED_FILE_TYPE );
 	}
 
-	CEGUI::XMLSerializer stream( file );
+	// the compiled levels kept for loading again can be outdated
+	pLevel_Manager->Clear_Snapshots();
+
+	// serialized here and written in the background
+	cXml_Writer stream;
 
 	// begin
-	stream.openTag( "level" );
+	stream.Open_Tag( "level" );
 
 	// begin
-	stream.openTag( "information" );
+	stream.Open_Tag( "information" );
 		// game version
 		Write_Property( stream, "game_version", int_to_string(SMC_VERSION_MAJOR) + "." + int_to_string(SMC_VERSION_MINOR) + "." + int_to_string(SMC_VERSION_PATCH) );
 		// engine version
@@ -311,10 +491,10 @@ void cLevel :: Save( void )
 		// time ( seconds since 1970 )
 		Write_Property( stream, "save_time", static_cast<Uint64>( time( NULL ) ) );
 	// end information
-	stream.closeTag();
+	stream.Close_Tag();
 
 	// begin
-	stream.openTag( "settings" );
+	stream.Open_Tag( "settings" );
 		// level author
 		Write_Property( stream, "lvl_author", m_author );
 		// level version
@@ -335,7 +515,7 @@ void cLevel :: Save( void )
 		// fixed camera horizontal velocity
 		Write_Property( stream, "cam_fixed_hor_vel", m_fixed_camera_hor_vel );
 	// end settings
-	stream.closeTag();
+	stream.Close_Tag();
 
 	// backgrounds
 	for( vector<cBackground *>::iterator itr = m_background_manager->objects.begin(); itr != m_background_manager->objects.end(); ++itr )
@@ -344,14 +524,14 @@ void cLevel :: Save( void )
 	}
 
 	// begin
-	stream.openTag( "player" );
+	stream.Open_Tag( "player" );
 		// position
 		Write_Property( stream, "posx", static_cast<int>(pLevel_Player->m_start_pos_x) );
 		Write_Property( stream, "posy", static_cast<int>(pLevel_Player->m_start_pos_y) );
 		// direction
 		Write_Property( stream, "direction", Get_Direction_Name( pLevel_Player->m_start_direction ) );
 	// end player
-	stream.closeTag();
+	stream.Close_Tag();
 
 	// objects
 	for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
@@ -369,14 +549,26 @@ void cLevel :: Save( void )
 	}
 
 	// end level
-	stream.closeTag();
+	stream.Close_Tag();
+
+	std::string level_data;
+	level_data.swap( stream.Get_Data() );
+
+	// saved with the level for the menu
+	cLevel_Preview *preview = new cLevel_Preview();
+
+	if( !preview->Create( m_sprite_manager, Get_Background_Color() ) )
+	{
+		delete preview;
+		preview = NULL;
+	}
 
-	file.close();
-	pHud_Debug->Set_Text( _("Level ") + Trim_Filename( m_level_filename, 0, 0 ) + _(" saved") );
+	pLevel_Saver->Start( m_level_filename, level_data, old_filename, preview );
 }
 
 void cLevel :: Delete( void )
 {
+	pLevel_Saver->Wait();
 	Delete_File( m_level_filename );
 	Unload();
 }
@@ -406,6 +598,18 @@ void cLevel :: Reset_Settings( void )
 	m_fixed_camera_hor_vel = 0.0f;
 }
 
+void cLevel :: Stop_Streaming( void )
+{
+	if( !m_stream )
+	{
+		return;
+	}
+
+	m_stream->Load_All();
+	delete m_stream;
+	m_stream = NULL;
+}
+
 void cLevel :: Init( void )
 {
 	// if not loaded
@@ -414,6 +618,8 @@ void cLevel :: Init( void )
 		return;
 	}
 
+	cLoad_Profiler_Scope profile_scope( "init" );
+
 	// player position
 	pLevel_Player->Set_Pos( m_player_start_pos_x, m_player_start_pos_y, 1 );
 	// player direction
@@ -421,16 +627,19 @@ void cLevel :: Init( void )
 	// player reset
 	pLevel_Player->Reset();
 
-	// pre-update animations
-	for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+	// create the objects around the player
+	if( m_stream )
 	{
-		cSprite *obj = (*itr);
+		m_stream->Load_Range( GL_rect( m_player_start_pos_x - ( game_res_w * 0.5f ), m_player_start_pos_y - ( game_res_h * 0.5f ), static_cast<float>(game_res_w), static_cast<float>(game_res_h) ) );
+	}
 
-		if( obj->m_type == TYPE_PARTICLE_EMITTER )
-		{
-			cParticle_Emitter *emitter = static_cast<cParticle_Emitter *>(obj);
-			emitter->Pre_Update();
-		}
+	// pre-update animations
+	const cSprite_List &emitters = m_sprite_manager->Get_Type_Objects( TYPE_PARTICLE_EMITTER );
+
+	for( cSprite_List::const_iterator itr = emitters.begin(); itr != emitters.end(); ++itr )
+	{
+		cParticle_Emitter *emitter = static_cast<cParticle_Emitter *>(*itr);
+		emitter->Pre_Update();
 	}
 }
 
@@ -457,12 +666,16 @@ void cLevel :: Enter( const GameMode old_mode /* = MODE_NOTHING */ )
 	}
 
 	Set_Sprite_Manager();
+	// record the used files and unload the textures of the last level
+	m_manifest->Enter();
 	// set active camera
 	pActive_Camera = pLevel_Manager->m_camera;
 	// set active player
 	pActive_Player = pLevel_Player;
 	// set animation manager
 	pActive_Animation_Manager = m_animation_manager;
+	// new objects are allocated from the level arena
+	pSprite_Arena = m_arena;
 
 	// disable world editor
 	pWorld_Editor->Disable();
@@ -489,6 +702,33 @@ void cLevel :: Enter( const GameMode old_mode /* = MODE_NOTHING */ )
 		pLevel_Manager->m_camera->Center();
 	}
 
+	// load the following levels in the background
+	if( !pLevel_Editor->m_enabled )
+	{
+		vector<std::string> levels;
+
+		// sub levels
+		const cSprite_List &level_exits = m_sprite_manager->Get_Type_Objects( TYPE_LEVEL_EXIT );
+
+		for( cSprite_List::const_iterator itr = level_exits.begin(); itr != level_exits.end(); ++itr )
+		{
+			const cLevel_Exit *level_exit = static_cast<cLevel_Exit *>(*itr);
+
+			if( !level_exit->m_dest_level.empty() )
+			{
+				levels.push_back( level_exit->m_dest_level );
+			}
+		}
+
+		// levels after this one in the campaign world
+		if( Game_Mode_Type == MODE_TYPE_DEFAULT && pActive_Overworld )
+		{
+			pActive_Overworld->Get_Next_Levels( levels, pPreferences->m_level_preload_count );
+		}
+
+		pLevel_Preloader->Set_Next( levels );
+	}
+
 	// play music
 	if( m_valid_music )
 	{
@@ -517,6 +757,14 @@ void cLevel :: Leave( const GameMode next_mode /* = MODE_NOTHING */ )
 		return;
 	}
 
+	// stop recording the used files
+	m_manifest->Leave();
+
+	if( pSprite_Arena == m_arena )
+	{
+		pSprite_Arena = NULL;
+	}
+
 	// reset camera limits
 	pLevel_Manager->m_camera->Reset_Limits();
 	pLevel_Manager->m_camera->m_fixed_hor_vel = 0.0f;
@@ -564,6 +812,20 @@ void cLevel :: Update( void )
 	// if level-editor is not active
 	if( !editor_level_enabled )
 	{
+		if( m_stream )
+		{
+			m_stream->Update();
+		}
+
+		// images used later the last time
+		m_manifest->Stream();
+
+		// textures of the objects the camera is moving to
+		if( pActive_Camera->m_velx || pActive_Camera->m_vely || pActive_Camera->m_fixed_hor_vel )
+		{
+			m_sprite_manager->Warm_Up( pActive_Camera->Get_Predicted_Rect() );
+		}
+
 		// backgrounds
 		for( vector<cBackground *>::iterator itr = m_background_manager->objects.begin(); itr != m_background_manager->objects.end(); ++itr )
 		{
@@ -574,19 +836,21 @@ void cLevel :: Update( void )
 		m_sprite_manager->Update_Items();
 		// animations
 		m_animation_manager->Update();
+		// sounds of the updated objects heard from the camera center
+		pAudio->Update_Sound_Emitters( pActive_Camera->m_x + ( game_res_w * 0.5f ), pActive_Camera->m_y + ( game_res_h * 0.5f ) );
 	}
 	// if level-editor enabled
 	else
 	{
+		// the editor needs every object
+		Stop_Streaming();
+
 		// only update particle emitters
-		for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
-		{
-			cSprite *obj = (*itr);
+		const cSprite_List &emitters = m_sprite_manager->Get_Type_Objects( TYPE_PARTICLE_EMITTER );
 
-			if( obj->m_type == TYPE_PARTICLE_EMITTER )
-			{
-				obj->Update();
-			}
+		for( unsigned int i = 0; i < emitters.size(); i++ )
+		{
+			emitters[i]->Update();
 		}
 	}
 }
@@ -632,8 +896,10 @@ void cLevel :: Draw_Layer_2( LevelDrawType type /* = LVL_DRAW */ )
 		return;
 	}
 
+	const cLevel_Player *level_player = m_sprite_manager->m_context->Get_Level_Player();
+
 	// ghost
-	if( pLevel_Player->m_maryo_type == MARYO_GHOST )
+	if( level_player->m_maryo_type == MARYO_GHOST )
 	{
 		// create request
 		cRect_Request *request = new cRect_Request();
@@ -641,14 +907,14 @@ void cLevel :: Draw_Layer_2( LevelDrawType type /* = LVL_DRAW */ )
 		Color color = Color( 0.5f, 0.5f, 0.5f, 0.3f );
 
 		// fade alpha in
-		if( pLevel_Player->m_ghost_time > 220 )
+		if( level_player->m_ghost_time > 220 )
 		{
-			color.alpha = static_cast<Uint8>(color.alpha * ( ( -pLevel_Player->m_ghost_time + 320 ) * 0.01f ));
+			color.alpha = static_cast<Uint8>(color.alpha * ( ( -level_player->m_ghost_time + 320 ) * 0.01f ));
 		}
 		// fade alpha out
-		else if( pLevel_Player->m_ghost_time < 100 )
+		else if( level_player->m_ghost_time < 100 )
 		{
-			color.alpha = static_cast<Uint8>(color.alpha * ( pLevel_Player->m_ghost_time * 0.01f ));
+			color.alpha = static_cast<Uint8>(color.alpha * ( level_player->m_ghost_time * 0.01f ));
 		}
 
 		pVideo->Draw_Rect( 0, 0, static_cast<float>(game_res_w), static_cast<float>(game_res_h), 0.12f, &color, request );
@@ -703,8 +969,8 @@ bool cLevel :: Key_Down( const SDLKey key )
 	// special key F4
 	else if( key == SDLK_F4 )
 	{
-		Draw_Effect_Out( EFFECT_OUT_FIXED_COLORBOX );
-		Draw_Effect_In();
+		pScreen_Transition->Start_Out( EFFECT_OUT_FIXED_COLORBOX );
+		pScreen_Transition->Start_In();
 	}
 	// Toggle leveleditor
 	else if( key == SDLK_F8 )
@@ -962,6 +1228,21 @@ std::string cLevel :: Get_Music_Filename( int with_dir /* = 2 */, bool with_end
 	return filename;
 }
 
+Color cLevel :: Get_Background_Color( void ) const
+{
+	for( vector<cBackground *>::const_iterator itr = m_background_manager->objects.begin(); itr != m_background_manager->objects.end(); ++itr )
+	{
+		const cBackground *background = (*itr);
+
+		if( background->m_type == BG_GR_VER || background->m_type == BG_GR_HOR )
+		{
+			return background->m_color_1;
+		}
+	}
+
+	return black;
+}
+
 void cLevel :: Set_Music( std::string filename )
 {
 	if( filename.length() < 4 )
@@ -990,6 +1271,9 @@ void cLevel :: Set_Music( std::string filename )
 
 void cLevel :: Set_Filename( std::string filename, bool rename_old /* = 1 */ )
 {
+	// the level file could be renamed
+	pLevel_Saver->Wait();
+
 	Convert_Path_Separators( filename );
 
 	// erase file type and directory
@@ -1007,6 +1291,12 @@ void cLevel :: Set_Filename( std::string filename, bool rename_old /* = 1 */ )
 		filename.insert( filename.length(), ".smclvl" );
 	}
 
+	// keep compressed
+	if( Is_Compressed_File( m_level_filename ) && !Is_Compressed_File( filename ) )
+	{
+		filename.insert( filename.length(), COMPRESSED_FILE_TYPE );
+	}
+
 	// add level dir
 	if( filename.find( pResource_Manager->user_data_dir + USER_LEVEL_DIR + "/" ) == std::string::npos )
 	{
@@ -1060,26 +1350,60 @@ cLevel_Entry *cLevel :: Get_Entry( const std::string &name )
 		return NULL;
 	}
 
-	// Search for entry
-	for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+	return static_cast<cLevel_Entry *>(m_sprite_manager->Get_Named_Object( TYPE_LEVEL_ENTRY, name ));
+}
+
+void cLevel :: Set_Pristine( cSprite *sprite )
+{
+	// not from the level file
+	if( sprite->m_level_num < 0 || static_cast<unsigned int>(sprite->m_level_num) >= m_pristine_objects.size() )
 	{
-		cSprite *obj = (*itr);
+		return;
+	}
 
-		if( obj->m_type != TYPE_LEVEL_ENTRY || obj->m_auto_destroy )
-		{
-			continue;
-		}
+	cSave_Level_Object *&pristine = m_pristine_objects[sprite->m_level_num];
+
+	// the same for every creation
+	if( pristine )
+	{
+		return;
+	}
+
+	pristine = sprite->Save_To_Savegame();
+}
+
+bool cLevel :: Remove_Pristine( cSave_Level_Object *save_object ) const
+{
+	if( save_object->m_level_num < 0 || static_cast<unsigned int>(save_object->m_level_num) >= m_pristine_objects.size() )
+	{
+		return 0;
+	}
+
+	const cSave_Level_Object *pristine = m_pristine_objects[save_object->m_level_num];
+
+	if( !pristine )
+	{
+		return 0;
+	}
 
-		cLevel_Entry *level_entry = static_cast<cLevel_Entry *>(obj);
+	Save_Level_Object_ProprtyList &properties = save_object->m_properties;
+	Save_Level_Object_ProprtyList::iterator kept_itr = properties.begin();
 
-		// found
-		if( level_entry->m_entry_name.compare( name ) == 0 )
+	for( Save_Level_Object_ProprtyList::iterator itr = properties.begin(); itr != properties.end(); ++itr )
+	{
+		// not changed
+		if( pristine->exists( itr->m_name ) && pristine->Get_Value( itr->m_name ) == itr->m_value )
 		{
-			return level_entry;
+			continue;
 		}
+
+		*kept_itr = *itr;
+		++kept_itr;
 	}
 
-	return NULL;
+	properties.erase( kept_itr, properties.end() );
+
+	return properties.empty();
 }
 
 bool cLevel :: Is_Loaded( void ) const
@@ -1145,6 +1469,8 @@ void cLevel :: elementEnd( const CEGUI::String &element )
 	}
 	else if( element == "background" )
 	{
+		cLoad_Profiler_Scope profile_scope( "background setup" );
+
 		BackgroundType bg_type = static_cast<BackgroundType>(m_xml_attributes.getValueAsInteger( "type" ));
 
 		// use gradient background
@@ -1193,12 +1519,23 @@ void cLevel :: elementEnd( const CEGUI::String &element )
 	}
 	else if( Is_Level_Object_Element( element ) )
 	{
+		// numbered in the file order
+		const unsigned int level_num = m_object_count++;
+
+		// created when near the camera
+		if( m_stream && m_stream->Add( element, m_xml_attributes, m_engine_version, level_num ) )
+		{
+			m_xml_attributes = CEGUI::XMLAttributes();
+			return;
+		}
+
 		// create sprite
 		cSprite *object = Create_Level_Object_From_XML( element, m_xml_attributes, m_engine_version, m_sprite_manager );
 		
 		// valid
 		if( object )
 		{
+			object->m_level_num = level_num;
 			m_sprite_manager->Add( object );
 		}
 	}
@@ -1215,765 +1552,886 @@ void cLevel :: elementEnd( const CEGUI::String &element )
 	m_xml_attributes = CEGUI::XMLAttributes();
 }
 
-cSprite *Create_Level_Object_From_XML( const CEGUI::String &xml_element, CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+/* *** *** *** *** *** *** *** Level objects *** *** *** *** *** *** *** *** *** *** */
+
+// Create a sprite
+static cSprite *Level_Create_Sprite( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
 {
-	// element content could change
-	CEGUI::String element = xml_element;
-
-	if( element == "sprite" )
-	{
-		// if V.1.4 and lower : change some image paths
-		if( engine_version < 25 )
-		{
-			// change stone8 to metal stone 2 violet
-			Relocate_Image( attributes, "game/box/stone8.png", "blocks/metal/stone_2_violet.png" );
-			// move jungle_1 trees into a directory
-			Relocate_Image( attributes, "ground/jungle_1/tree_type_1.png", "ground/jungle_1/tree/1.png" );
-			Relocate_Image( attributes, "ground/jungle_1/tree_type_1_front.png", "ground/jungle_1/tree/1_front.png" );
-			Relocate_Image( attributes, "ground/jungle_1/tree_type_2.png", "ground/jungle_1/tree/2.png" );
-			// move yoshi_1 extra to jungle_2 hedge
-			Relocate_Image( attributes, "ground/yoshi_1/extra_1_blue.png", "ground/jungle_2/hedge/1_blue.png" );
-			Relocate_Image( attributes, "ground/yoshi_1/extra_1_green.png", "ground/jungle_2/hedge/1_green.png" );
-			Relocate_Image( attributes, "ground/yoshi_1/extra_1_red.png", "ground/jungle_2/hedge/1_red.png" );
-			Relocate_Image( attributes, "ground/yoshi_1/extra_1_yellow.png", "ground/jungle_2/hedge/1_yellow.png" );
-			// move yoshi_1 rope to jungle_2
-			Relocate_Image( attributes, "ground/yoshi_1/rope_1_leftright.png", "ground/jungle_2/rope_1_hor.png" );
-		}
-		// if V.1.5 and lower : change pipe connection image paths
-		if( engine_version < 28 )
-		{
-			Relocate_Image( attributes, "blocks/pipe/connection_left_down.png", "blocks/pipe/connection/plastic_1/orange/right_up.png" );
-			Relocate_Image( attributes, "blocks/pipe/connection_left_up.png", "blocks/pipe/connection/plastic_1/orange/right_down.png" );
-			Relocate_Image( attributes, "blocks/pipe/connection_right_down.png", "blocks/pipe/connection/plastic_1/orange/left_up.png" );
-			Relocate_Image( attributes, "blocks/pipe/connection_right_up.png", "blocks/pipe/connection/plastic_1/orange/left_down.png" );
-			Relocate_Image( attributes, "blocks/pipe/metal_connector.png", "blocks/pipe/connection/metal_1/grey/middle.png" );
-		}
-		// if V.1.7 and lower : change yoshi_1 hill_up to jungle_1 slider image paths
-		if( engine_version < 31 )
+	// if V.1.4 and lower : change some image paths
+	if( engine_version < 25 )
+	{
+		// change stone8 to metal stone 2 violet
+		Relocate_Image( attributes, "game/box/stone8.png", "blocks/metal/stone_2_violet.png" );
+		// move jungle_1 trees into a directory
+		Relocate_Image( attributes, "ground/jungle_1/tree_type_1.png", "ground/jungle_1/tree/1.png" );
+		Relocate_Image( attributes, "ground/jungle_1/tree_type_1_front.png", "ground/jungle_1/tree/1_front.png" );
+		Relocate_Image( attributes, "ground/jungle_1/tree_type_2.png", "ground/jungle_1/tree/2.png" );
+		// move yoshi_1 extra to jungle_2 hedge
+		Relocate_Image( attributes, "ground/yoshi_1/extra_1_blue.png", "ground/jungle_2/hedge/1_blue.png" );
+		Relocate_Image( attributes, "ground/yoshi_1/extra_1_green.png", "ground/jungle_2/hedge/1_green.png" );
+		Relocate_Image( attributes, "ground/yoshi_1/extra_1_red.png", "ground/jungle_2/hedge/1_red.png" );
+		Relocate_Image( attributes, "ground/yoshi_1/extra_1_yellow.png", "ground/jungle_2/hedge/1_yellow.png" );
+		// move yoshi_1 rope to jungle_2
+		Relocate_Image( attributes, "ground/yoshi_1/rope_1_leftright.png", "ground/jungle_2/rope_1_hor.png" );
+	}
+	// if V.1.5 and lower : change pipe connection image paths
+	if( engine_version < 28 )
+	{
+		Relocate_Image( attributes, "blocks/pipe/connection_left_down.png", "blocks/pipe/connection/plastic_1/orange/right_up.png" );
+		Relocate_Image( attributes, "blocks/pipe/connection_left_up.png", "blocks/pipe/connection/plastic_1/orange/right_down.png" );
+		Relocate_Image( attributes, "blocks/pipe/connection_right_down.png", "blocks/pipe/connection/plastic_1/orange/left_up.png" );
+		Relocate_Image( attributes, "blocks/pipe/connection_right_up.png", "blocks/pipe/connection/plastic_1/orange/left_down.png" );
+		Relocate_Image( attributes, "blocks/pipe/metal_connector.png", "blocks/pipe/connection/metal_1/grey/middle.png" );
+	}
+	// if V.1.7 and lower : change yoshi_1 hill_up to jungle_1 slider image paths
+	if( engine_version < 31 )
+	{
+		Relocate_Image( attributes, "ground/yoshi_1/hill_up_1.png", "ground/jungle_1/slider/2_green_left.png" );
+		Relocate_Image( attributes, "ground/yoshi_1/hill_up_2.png", "ground/jungle_1/slider/2_blue_left.png" );
+		Relocate_Image( attributes, "ground/yoshi_1/hill_up_3.png", "ground/jungle_1/slider/2_brown_left.png" );
+	}
+	// if V.1.7 and lower : change slider grey_1 to green_1 brown slider image paths
+	if( engine_version < 32 )
+	{
+		Relocate_Image( attributes, "slider/grey_1/slider_left.png", "ground/green_1/slider/1/brown/left.png" );
+		Relocate_Image( attributes, "slider/grey_1/slider_middle.png", "ground/green_1/slider/1/brown/middle.png" );
+		Relocate_Image( attributes, "slider/grey_1/slider_right.png", "ground/green_1/slider/1/brown/right.png" );
+	}
+	// if V.1.7 and lower : change green_1 ground to green_3 ground image paths
+	if( engine_version < 34 )
+	{
+		// normal
+		Relocate_Image( attributes, "ground/green_1/ground/left_up.png", "ground/green_3/ground/top/left.png" );
+		Relocate_Image( attributes, "ground/green_1/ground/left_down.png", "ground/green_3/ground/bottom/left.png" );
+		Relocate_Image( attributes, "ground/green_1/ground/right_up.png", "ground/green_3/ground/top/right.png" );
+		Relocate_Image( attributes, "ground/green_1/ground/right_down.png", "ground/green_3/ground/bottom/right.png" );
+		Relocate_Image( attributes, "ground/green_1/ground/up.png", "ground/green_3/ground/top/1.png" );
+		Relocate_Image( attributes, "ground/green_1/ground/down.png", "ground/green_3/ground/bottom/1.png" );
+		Relocate_Image( attributes, "ground/green_1/ground/right.png", "ground/green_3/ground/middle/right.png" );
+		Relocate_Image( attributes, "ground/green_1/ground/left.png", "ground/green_3/ground/middle/left.png" );
+		Relocate_Image( attributes, "ground/green_1/ground/middle.png", "ground/green_3/ground/middle/1.png" );
+
+		// hill (not available)
+		//Relocate_Image( attributes, "ground/green_1/ground/hill_left_up.png", "ground/green_3/ground/" );
+		//Relocate_Image( attributes, "ground/green_1/ground/hill_right_up.png", "ground/green_3/ground/" );
+		//Relocate_Image( attributes, "ground/green_1/ground/hill_right.png", "ground/green_3/ground/" );
+		//Relocate_Image( attributes, "ground/green_1/ground/hill_left.png", "ground/green_3/ground/" );
+	}
+	// if V.1.9 and lower : move y coordinate bottom to 0
+	if( engine_version < 35 )
+	{
+		if( attributes.exists( "posy" ) )
 		{
-			Relocate_Image( attributes, "ground/yoshi_1/hill_up_1.png", "ground/jungle_1/slider/2_green_left.png" );
-			Relocate_Image( attributes, "ground/yoshi_1/hill_up_2.png", "ground/jungle_1/slider/2_blue_left.png" );
-			Relocate_Image( attributes, "ground/yoshi_1/hill_up_3.png", "ground/jungle_1/slider/2_brown_left.png" );
+			attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
 		}
-		// if V.1.7 and lower : change slider grey_1 to green_1 brown slider image paths
-		if( engine_version < 32 )
+	}
+	// if V.1.9 and lower : change fire_1 animation to particles
+	if( engine_version < 37 )
+	{
+		Relocate_Image( attributes, "animation/fire_1/1.png", "animation/particles/fire_1.png" );
+		Relocate_Image( attributes, "animation/fire_1/2.png", "animation/particles/fire_2.png" );
+		Relocate_Image( attributes, "animation/fire_1/3.png", "animation/particles/fire_3.png" );
+		Relocate_Image( attributes, "animation/fire_1/4.png", "animation/particles/fire_4.png" );
+	}
+	// always : fix sprite with undefined massive-type
+	if( attributes.exists( "type" ) && attributes.getValueAsString( "type" ) == "undefined" )
+	{
+		// change to passive
+		attributes.add( "type", "passive" );
+	}
+
+	cSprite *sprite = new cSprite( attributes, sprite_manager );
+
+	// if image not available display its filename
+	if( !sprite->m_start_image )
+	{
+		std::string text = attributes.getValueAsString( "image" ).c_str();
+
+		if( text.empty() )
 		{
-			Relocate_Image( attributes, "slider/grey_1/slider_left.png", "ground/green_1/slider/1/brown/left.png" );
-			Relocate_Image( attributes, "slider/grey_1/slider_middle.png", "ground/green_1/slider/1/brown/middle.png" );
-			Relocate_Image( attributes, "slider/grey_1/slider_right.png", "ground/green_1/slider/1/brown/right.png" );
-		}
-		// if V.1.7 and lower : change green_1 ground to green_3 ground image paths
-		if( engine_version < 34 )
-		{
-			// normal
-			Relocate_Image( attributes, "ground/green_1/ground/left_up.png", "ground/green_3/ground/top/left.png" );
-			Relocate_Image( attributes, "ground/green_1/ground/left_down.png", "ground/green_3/ground/bottom/left.png" );
-			Relocate_Image( attributes, "ground/green_1/ground/right_up.png", "ground/green_3/ground/top/right.png" );
-			Relocate_Image( attributes, "ground/green_1/ground/right_down.png", "ground/green_3/ground/bottom/right.png" );
-			Relocate_Image( attributes, "ground/green_1/ground/up.png", "ground/green_3/ground/top/1.png" );
-			Relocate_Image( attributes, "ground/green_1/ground/down.png", "ground/green_3/ground/bottom/1.png" );
-			Relocate_Image( attributes, "ground/green_1/ground/right.png", "ground/green_3/ground/middle/right.png" );
-			Relocate_Image( attributes, "ground/green_1/ground/left.png", "ground/green_3/ground/middle/left.png" );
-			Relocate_Image( attributes, "ground/green_1/ground/middle.png", "ground/green_3/ground/middle/1.png" );
-
-			// hill (not available)
-			//Relocate_Image( attributes, "ground/green_1/ground/hill_left_up.png", "ground/green_3/ground/" );
-			//Relocate_Image( attributes, "ground/green_1/ground/hill_right_up.png", "ground/green_3/ground/" );
-			//Relocate_Image( attributes, "ground/green_1/ground/hill_right.png", "ground/green_3/ground/" );
-			//Relocate_Image( attributes, "ground/green_1/ground/hill_left.png", "ground/green_3/ground/" );
+			text = "Invalid image here";
 		}
-		// if V.1.9 and lower : move y coordinate bottom to 0
-		if( engine_version < 35 )
+
+		cGL_Surface *text_image = pFont->Render_Text( pFont->m_font_small, text );
+		text_image->m_filename = text;
+		// set text image
+		sprite->Set_Image( text_image, 1, 1 );
+		// display it as front passive
+		sprite->Set_Sprite_Type( TYPE_FRONT_PASSIVE );
+		// only display it in the editor
+		sprite->Set_Active( 0 );
+	}
+
+	// needs image
+	if( sprite->m_image )
+	{
+		// if V.1.2 and lower : change pipe position
+		if( engine_version < 22 )
 		{
-			if( attributes.exists( "posy" ) )
+			if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/green/up.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/green/ver.png" ) == 0 || 
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/green/down.png" ) == 0 || 
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/blue/up.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/blue/ver.png" ) == 0 || 
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/blue/down.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/yellow/up.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/yellow/ver.png" ) == 0 || 
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/yellow/down.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/grey/up.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/grey/ver.png" ) == 0 || 
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/grey/down.png" ) == 0 )
 			{
-				attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
+				sprite->Move( -6, 0, 1 );
+				sprite->m_start_pos_x = sprite->m_pos_x;
+			}
+			else if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/green/right.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/green/hor.png" ) == 0 || 
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/green/left.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/blue/right.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/blue/hor.png" ) == 0 || 
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/blue/left.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/yellow/right.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/yellow/hor.png" ) == 0 || 
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/yellow/left.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/grey/right.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/grey/hor.png" ) == 0 || 
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/grey/left.png" ) == 0 )
+			{
+				sprite->Move( 0, -6, 1 );
+				sprite->m_start_pos_y = sprite->m_pos_y;
 			}
 		}
-		// if V.1.9 and lower : change fire_1 animation to particles
-		if( engine_version < 37 )
-		{
-			Relocate_Image( attributes, "animation/fire_1/1.png", "animation/particles/fire_1.png" );
-			Relocate_Image( attributes, "animation/fire_1/2.png", "animation/particles/fire_2.png" );
-			Relocate_Image( attributes, "animation/fire_1/3.png", "animation/particles/fire_3.png" );
-			Relocate_Image( attributes, "animation/fire_1/4.png", "animation/particles/fire_4.png" );
-		}
-		// always : fix sprite with undefined massive-type
-		if( attributes.exists( "type" ) && attributes.getValueAsString( "type" ) == "undefined" )
-		{
-			// change to passive
-			attributes.add( "type", "passive" );
-		}
-
-		cSprite *sprite = new cSprite( attributes, sprite_manager );
-
-		// if image not available display its filename
-		if( !sprite->m_start_image )
+		// if V.1.2 and lower : change some hill positions
+		if( engine_version < 23 )
 		{
-			std::string text = attributes.getValueAsString( "image" ).c_str();
-
-			if( text.empty() )
+			if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "hills/green_1/head.png" ) == 0 ||
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "hills/light_blue_1/head.png" ) == 0 )
 			{
-				text = "Invalid image here";
+				sprite->Move( 0, -6, 1 );
+				sprite->m_start_pos_y = sprite->m_pos_y;
 			}
-
-			cGL_Surface *text_image = pFont->Render_Text( pFont->m_font_small, text );
-			text_image->m_filename = text;
-			// set text image
-			sprite->Set_Image( text_image, 1, 1 );
-			// display it as front passive
-			sprite->Set_Sprite_Type( TYPE_FRONT_PASSIVE );
-			// only display it in the editor
-			sprite->Set_Active( 0 );
 		}
-
-		// needs image
-		if( sprite->m_image )
+		// if V.1.7 and lower : change yoshi_1 hill_up to jungle_1 slider image paths
+		if( engine_version < 31 )
 		{
-			// if V.1.2 and lower : change pipe position
-			if( engine_version < 22 )
+			// image filename is already changed but we need to add the middle and right tiles
+			if( sprite_manager && ( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/jungle_1/slider/2_green_left.png" ) == 0 || 
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/jungle_1/slider/2_blue_left.png" ) == 0 || 
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/jungle_1/slider/2_brown_left.png" ) == 0 ) )
 			{
-				if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/green/up.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/green/ver.png" ) == 0 || 
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/green/down.png" ) == 0 || 
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/blue/up.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/blue/ver.png" ) == 0 || 
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/blue/down.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/yellow/up.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/yellow/ver.png" ) == 0 || 
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/yellow/down.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/grey/up.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/grey/ver.png" ) == 0 || 
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/grey/down.png" ) == 0 )
+				std::string color;
+
+				// green
+				if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/jungle_1/slider/2_green_left.png" ) == 0 )
 				{
-					sprite->Move( -6, 0, 1 );
-					sprite->m_start_pos_x = sprite->m_pos_x;
+					color = "green";
 				}
-				else if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/green/right.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/green/hor.png" ) == 0 || 
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/green/left.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/blue/right.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/blue/hor.png" ) == 0 || 
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/blue/left.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/yellow/right.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/yellow/hor.png" ) == 0 || 
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/yellow/left.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/grey/right.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/grey/hor.png" ) == 0 || 
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "pipes/grey/left.png" ) == 0 )
+				// blue
+				else if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/jungle_1/slider/2_blue_left.png" ) == 0 )
 				{
-					sprite->Move( 0, -6, 1 );
-					sprite->m_start_pos_y = sprite->m_pos_y;
+					color = "blue";
 				}
-			}
-			// if V.1.2 and lower : change some hill positions
-			if( engine_version < 23 )
-			{
-				if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "hills/green_1/head.png" ) == 0 ||
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "hills/light_blue_1/head.png" ) == 0 )
+				// brown
+				else
 				{
-					sprite->Move( 0, -6, 1 );
-					sprite->m_start_pos_y = sprite->m_pos_y;
+					color = "brown";
 				}
-			}
-			// if V.1.7 and lower : change yoshi_1 hill_up to jungle_1 slider image paths
-			if( engine_version < 31 )
-			{
-				// image filename is already changed but we need to add the middle and right tiles
-				if( sprite_manager && ( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/jungle_1/slider/2_green_left.png" ) == 0 || 
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/jungle_1/slider/2_blue_left.png" ) == 0 || 
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/jungle_1/slider/2_brown_left.png" ) == 0 ) )
+
+				cSprite *copy = sprite;
+
+				// add middle tiles
+				for( unsigned int i = 0; i < 4; i++ )
 				{
-					std::string color;
-
-					// green
-					if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/jungle_1/slider/2_green_left.png" ) == 0 )
-					{
-						color = "green";
-					}
-					// blue
-					else if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/jungle_1/slider/2_blue_left.png" ) == 0 )
-					{
-						color = "blue";
-					}
-					// brown
-					else
-					{
-						color = "brown";
-					}
-
-					cSprite *copy = sprite;
-
-					// add middle tiles
-					for( unsigned int i = 0; i < 4; i++ )
-					{
-						copy = copy->Copy();
-						copy->Set_Image( pVideo->Get_Surface( "ground/jungle_1/slider/2_" + color + "_middle.png" ), 1 );
-						copy->Set_Pos_X( copy->m_start_pos_x + 22, 1 );
-						sprite_manager->Add( copy );
-					}
-
-					// add end tile
 					copy = copy->Copy();
-					copy->Set_Image( pVideo->Get_Surface( "ground/jungle_1/slider/2_" + color + "_right.png" ), 1 );
+					copy->Set_Image( pVideo->Get_Surface( "ground/jungle_1/slider/2_" + color + "_middle.png" ), 1 );
 					copy->Set_Pos_X( copy->m_start_pos_x + 22, 1 );
 					sprite_manager->Add( copy );
 				}
+
+				// add end tile
+				copy = copy->Copy();
+				copy->Set_Image( pVideo->Get_Surface( "ground/jungle_1/slider/2_" + color + "_right.png" ), 1 );
+				copy->Set_Pos_X( copy->m_start_pos_x + 22, 1 );
+				sprite_manager->Add( copy );
 			}
-			// if V.1.7 and lower : change slider grey_1 to green_1 brown slider image paths
-			if( engine_version < 32 )
+		}
+		// if V.1.7 and lower : change slider grey_1 to green_1 brown slider image paths
+		if( engine_version < 32 )
+		{
+			// image filename is already changed but we need to add an additional middle tile for left and right
+			if( sprite_manager && ( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/left.png" ) == 0 || 
+				sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/right.png" ) == 0 ) )
 			{
-				// image filename is already changed but we need to add an additional middle tile for left and right
-				if( sprite_manager && ( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/left.png" ) == 0 || 
-					sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/right.png" ) == 0 ) )
-				{
-					// add middle tile
-					cSprite *copy = sprite->Copy();
-					copy->Set_Image( pVideo->Get_Surface( "ground/green_1/slider/1/brown/middle.png" ), 1 );
-					// if from left tile it must be moved
-					if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/left.png" ) == 0 )
-					{
-						copy->Set_Pos_X( copy->m_start_pos_x + 18, 1 );
-					}
-					sprite_manager->Add( copy );
-				}
-				// move right tile
-				if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/right.png" ) == 0 )
+				// add middle tile
+				cSprite *copy = sprite->Copy();
+				copy->Set_Image( pVideo->Get_Surface( "ground/green_1/slider/1/brown/middle.png" ), 1 );
+				// if from left tile it must be moved
+				if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/left.png" ) == 0 )
 				{
-					sprite->Move( 18, 0, 1 );
-					sprite->m_start_pos_x = sprite->m_pos_x;
+					copy->Set_Pos_X( copy->m_start_pos_x + 18, 1 );
 				}
+				sprite_manager->Add( copy );
 			}
-		}
-
-		return sprite;
-	}
-	else if( element == "enemystopper" )
-	{
-		// if V.1.9 and lower : move y coordinate bottom to 0
-		if( engine_version < 35 )
-		{
-			if( attributes.exists( "posy" ) )
+			// move right tile
+			if( sprite->m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/right.png" ) == 0 )
 			{
-				attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
+				sprite->Move( 18, 0, 1 );
+				sprite->m_start_pos_x = sprite->m_pos_x;
 			}
 		}
-
-		return new cEnemyStopper( attributes, sprite_manager );
 	}
-	else if( element == "levelexit" )
-	{
-		// if V.1.9 and lower : move y coordinate bottom to 0
-		if( engine_version < 35 )
+
+	return sprite;
+}
+
+// Create an enemy stopper
+static cSprite *Level_Create_Enemy_Stopper( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	// if V.1.9 and lower : move y coordinate bottom to 0
+	if( engine_version < 35 )
+	{
+		if( attributes.exists( "posy" ) )
 		{
-			if( attributes.exists( "posy" ) )
-			{
-				attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
-			}
+			attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
 		}
+	}
+
+	return new cEnemyStopper( attributes, sprite_manager );
+}
 
-		// if V.1.9 and lower : change "motion" to "camera_motion"
-		if( engine_version < 36 )
+// Create a level exit
+static cSprite *Level_Create_Level_Exit( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	// if V.1.9 and lower : move y coordinate bottom to 0
+	if( engine_version < 35 )
+	{
+		if( attributes.exists( "posy" ) )
 		{
-			if( attributes.exists( "motion" ) )
-			{
-				attributes.add( "camera_motion", CEGUI::PropertyHelper::intToString( attributes.getValueAsInteger( "motion" ) + 1 ) );
-				attributes.remove( "motion" );
-			}
+			attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
 		}
-
-		return new cLevel_Exit( attributes, sprite_manager );
 	}
-	else if( element == "level_entry" )
+
+	// if V.1.9 and lower : change "motion" to "camera_motion"
+	if( engine_version < 36 )
 	{
-		// if V.1.9 and lower : move y coordinate bottom to 0
-		if( engine_version < 35 )
+		if( attributes.exists( "motion" ) )
 		{
-			if( attributes.exists( "posy" ) )
-			{
-				attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
-			}
+			attributes.add( "camera_motion", CEGUI::PropertyHelper::intToString( attributes.getValueAsInteger( "motion" ) + 1 ) );
+			attributes.remove( "motion" );
 		}
-
-		return new cLevel_Entry( attributes, sprite_manager );
 	}
-	else if( element == "box" )
+
+	return new cLevel_Exit( attributes, sprite_manager );
+}
+
+// Create a level entry
+static cSprite *Level_Create_Level_Entry( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	// if V.1.9 and lower : move y coordinate bottom to 0
+	if( engine_version < 35 )
 	{
-		// if V.1.9 and lower : move y coordinate bottom to 0
-		if( engine_version < 35 )
+		if( attributes.exists( "posy" ) )
 		{
-			if( attributes.exists( "posy" ) )
-			{
-				attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
-			}
+			attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
 		}
+	}
+
+	return new cLevel_Entry( attributes, sprite_manager );
+}
 
-		CEGUI::String str_type = attributes.getValueAsString( "type" );
+// Create a moving platform
+static cSprite *Level_Create_Moving_Platform( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	// if V.1.7 and lower : change slider grey_1 to green_1 brown slider image paths
+	if( engine_version < 32 )
+	{
+		Relocate_Image( attributes, "slider/grey_1/slider_left.png", "ground/green_1/slider/1/brown/left.png", "image_top_left" );
+		Relocate_Image( attributes, "slider/grey_1/slider_middle.png", "ground/green_1/slider/1/brown/middle.png", "image_top_middle" );
+		Relocate_Image( attributes, "slider/grey_1/slider_right.png", "ground/green_1/slider/1/brown/right.png", "image_top_right" );
+	}
 
-		if( str_type == "bonus" )
+	// if V.1.9 and lower : move y coordinate bottom to 0
+	if( engine_version < 35 )
+	{
+		if( attributes.exists( "posy" ) )
 		{
-			return new cBonusBox( attributes, sprite_manager );
+			attributes.add( "posy", CEGUI::PropertyHelper::floatToString(  attributes.getValueAsFloat( "posy" ) - 600.0f ) );
 		}
-		// gold is somewhere pre V.0.99.5
-		else if( str_type == "gold" )
-		{
-			// update old values
-			attributes.add( "type", "bonus" );
-			attributes.add( "animation", "Default" );
-			attributes.add( "item", int_to_string( TYPE_GOLDPIECE ) );
-			// renamed color to gold_color
-			if( attributes.exists( "color" ) )
-			{
-				attributes.add( "gold_color", attributes.getValue( "color" ) );
-				attributes.remove( "color" );
-			}
+	}
 
-			return new cBonusBox( attributes, sprite_manager );
-		}
-		else if( str_type == "spin" )
+	cMoving_Platform *moving_platform = new cMoving_Platform( attributes, sprite_manager );
+
+	// if V.1.7 and lower : change new slider middle count because start and end image is now half the width
+	if( engine_version < 32 )
+	{
+		if( moving_platform->m_images[0].m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/left.png" ) == 0 )
 		{
-			return new cSpinBox( attributes, sprite_manager );
+			moving_platform->Set_Middle_Count( moving_platform->m_middle_count + 1 );
 		}
-		else if( str_type == "text" )
+		if( moving_platform->m_images[0].m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/right.png" ) == 0 )
 		{
-			return new cText_Box( attributes, sprite_manager );
+			moving_platform->Set_Middle_Count( moving_platform->m_middle_count + 1 );
 		}
-		// pre V.0.99.4
-		else if ( str_type == "empty" )
-		{
-			// update old values
-			attributes.add( "type", "bonus" );
-			attributes.add( "item", "0" );
+	}
 
-			return new cBonusBox( attributes, sprite_manager );
-		}
-		// pre V.0.99.4
-		else if ( str_type == "invisible" )
-		{
-			// update old values
-			attributes.add( "type", "bonus" );
-			attributes.add( "item", "0" );
-			attributes.add( "invisible", "1" );
+	return moving_platform;
+}
 
-			return new cBonusBox( attributes, sprite_manager );
-		}
-		else
-		{
-			printf( "Warning : Unknown Level Box type : %s\n", str_type.c_str() );
-		}
+// Create a moving platform from a falling platform which is pre V.1.5
+static cSprite *Level_Create_Falling_Platform( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	// it's not moving
+	attributes.add( "speed", "0" );
+	// renamed time_fall to touch_time and change to the new value
+	if( attributes.exists( "time_fall" ) )
+	{
+		attributes.add( "touch_time", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "time_fall" ) * speedfactor_fps ) );
+		attributes.remove( "time_fall" );
 	}
-	// powerup is pre V.0.99.5
-	else if( element == "item" || element == "powerup" )
+	else
 	{
-		// if V.1.9 and lower : move y coordinate bottom to 0
-		if( engine_version < 35 )
-		{
-			if( attributes.exists( "posy" ) )
-			{
-				attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
-			}
-		}
+		attributes.add( "touch_time", "48" );
+	}
+	// enable falling
+	attributes.add( "shake_time", "12" );
 
-		CEGUI::String str_type = attributes.getValueAsString( "type" );
+	// if V.1.7 and lower : change slider grey_1 to green_1 brown slider image paths
+	if( engine_version < 32 )
+	{
+		Relocate_Image( attributes, "slider/grey_1/slider_left.png", "ground/green_1/slider/1/brown/left.png", "image_top_left" );
+		Relocate_Image( attributes, "slider/grey_1/slider_middle.png", "ground/green_1/slider/1/brown/middle.png", "image_top_middle" );
+		Relocate_Image( attributes, "slider/grey_1/slider_right.png", "ground/green_1/slider/1/brown/right.png", "image_top_right" );
+	}
 
-		if( str_type == "goldpiece" )
-		{
-			return new cGoldpiece( attributes, sprite_manager );
-		}
-		else if( str_type == "mushroom" )
-		{
-			return new cMushroom( attributes, sprite_manager );
-		}
-		else if( str_type == "fireplant" )
-		{
-			return new cFirePlant( attributes, sprite_manager );
-		}
-		else if( str_type == "jstar" )
+	// if V.1.9 and lower : move y coordinate bottom to 0
+	if( engine_version < 35 )
+	{
+		if( attributes.exists( "posy" ) )
 		{
-			return new cjStar( attributes, sprite_manager );
+			attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
 		}
-		else if( str_type == "moon" )
+	}
+
+	cMoving_Platform *moving_platform = new cMoving_Platform( attributes, sprite_manager );
+
+	// if V.1.7 and lower : change new slider middle count because start and end image is now half the width
+	if( engine_version < 32 )
+	{
+		if( moving_platform->m_images[0].m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/left.png" ) == 0 )
 		{
-			return new cMoon( attributes, sprite_manager );
+			moving_platform->Set_Middle_Count( moving_platform->m_middle_count + 1 );
 		}
-		else
+		if( moving_platform->m_images[0].m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/right.png" ) == 0 )
 		{
-			printf( "Warning : Unknown Level Item type : %s\n", str_type.c_str() );
+			moving_platform->Set_Middle_Count( moving_platform->m_middle_count + 1 );
 		}
 	}
-	else if( element == "moving_platform" )
+
+	return moving_platform;
+}
+
+// Create a random sound
+static cSprite *Level_Create_Sound( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	// if V.1.9 and lower : move y coordinate bottom to 0
+	if( engine_version < 35 )
 	{
-		// if V.1.7 and lower : change slider grey_1 to green_1 brown slider image paths
-		if( engine_version < 32 )
+		if( attributes.exists( "pos_y" ) )
 		{
-			Relocate_Image( attributes, "slider/grey_1/slider_left.png", "ground/green_1/slider/1/brown/left.png", "image_top_left" );
-			Relocate_Image( attributes, "slider/grey_1/slider_middle.png", "ground/green_1/slider/1/brown/middle.png", "image_top_middle" );
-			Relocate_Image( attributes, "slider/grey_1/slider_right.png", "ground/green_1/slider/1/brown/right.png", "image_top_right" );
+			attributes.add( "pos_y", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "pos_y" ) - 600.0f ) );
 		}
+	}
 
-		// if V.1.9 and lower : move y coordinate bottom to 0
-		if( engine_version < 35 )
-		{
-			if( attributes.exists( "posy" ) )
-			{
-				attributes.add( "posy", CEGUI::PropertyHelper::floatToString(  attributes.getValueAsFloat( "posy" ) - 600.0f ) );
-			}
-		}
+	return new cRandom_Sound( attributes, sprite_manager );
+}
 
-		cMoving_Platform *moving_platform = new cMoving_Platform( attributes, sprite_manager );
+// Create a particle emitter
+static cSprite *Level_Create_Particle_Emitter( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	// Note : If you relocate images don't forget the global effect
 
-		// if V.1.7 and lower : change new slider middle count because start and end image is now half the width
-		if( engine_version < 32 )
+	// if V.1.9 and lower : move y coordinate bottom to 0
+	if( engine_version < 35 )
+	{
+		if( attributes.exists( "pos_y" ) )
 		{
-			if( moving_platform->m_images[0].m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/left.png" ) == 0 )
-			{
-				moving_platform->Set_Middle_Count( moving_platform->m_middle_count + 1 );
-			}
-			if( moving_platform->m_images[0].m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/right.png" ) == 0 )
-			{
-				moving_platform->Set_Middle_Count( moving_platform->m_middle_count + 1 );
-			}
+			attributes.add( "pos_y", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "pos_y" ) - 600.0f ) );
 		}
+	}
 
-		return moving_platform;
+	// if V.1.9 and lower : change fire_1 animation to particles
+	if( engine_version < 37 )
+	{
+		Relocate_Image( attributes, "animation/fire_1/1.png", "animation/particles/fire_1.png", "file" );
+		Relocate_Image( attributes, "animation/fire_1/2.png", "animation/particles/fire_2.png", "file" );
+		Relocate_Image( attributes, "animation/fire_1/3.png", "animation/particles/fire_3.png", "file" );
+		Relocate_Image( attributes, "animation/fire_1/4.png", "animation/particles/fire_4.png", "file" );
 	}
-	// falling platform is pre V.1.5
-	else if( element == "falling_platform" )
+
+	// if V.1.9 and lower : change file to image
+	if( engine_version < 38 )
 	{
-		// it's not moving
-		attributes.add( "speed", "0" );
-		// renamed time_fall to touch_time and change to the new value
-		if( attributes.exists( "time_fall" ) )
+		if( attributes.exists( "file" ) )
 		{
-			attributes.add( "touch_time", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "time_fall" ) * speedfactor_fps ) );
-			attributes.remove( "time_fall" );
+			attributes.add( "image", attributes.getValueAsString( "file" ) );
+			attributes.remove( "file" );
 		}
-		else
+	}
+
+	cParticle_Emitter *particle_emitter = new cParticle_Emitter( attributes, sprite_manager );
+	// set to not spawned
+	particle_emitter->Set_Spawned( 0 );
+
+	return particle_emitter;
+}
+
+// Create a path
+static cSprite *Level_Create_Path( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	// if V.1.9 and lower : move y coordinate bottom to 0
+	if( engine_version < 35 )
+	{
+		if( attributes.exists( "posy" ) )
 		{
-			attributes.add( "touch_time", "48" );
+			attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
 		}
-		// enable falling
-		attributes.add( "shake_time", "12" );
+	}
 
-		// if V.1.7 and lower : change slider grey_1 to green_1 brown slider image paths
-		if( engine_version < 32 )
+	return new cPath( attributes, sprite_manager );
+}
+
+// Create an advanced particle emitter from a global effect which is V.1.9 and lower
+static cSprite *Level_Create_Global_Effect( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	// if V.0.99.4 and lower : change lieftime mod to time to live
+	if( engine_version < 21 )
+	{
+		if( !attributes.exists( "time_to_live" ) )
 		{
-			Relocate_Image( attributes, "slider/grey_1/slider_left.png", "ground/green_1/slider/1/brown/left.png", "image_top_left" );
-			Relocate_Image( attributes, "slider/grey_1/slider_middle.png", "ground/green_1/slider/1/brown/middle.png", "image_top_middle" );
-			Relocate_Image( attributes, "slider/grey_1/slider_right.png", "ground/green_1/slider/1/brown/right.png", "image_top_right" );
+			attributes.add( "time_to_live", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "lifetime_mod", 20 ) * 0.3f ) );
+			attributes.remove( "lifetime_mod" );
 		}
+	}
 
-		// if V.1.9 and lower : move y coordinate bottom to 0
-		if( engine_version < 35 )
+	// if V.0.99.7 and lower : change creation speed to emitter iteration interval
+	if( engine_version < 22 )
+	{
+		if( !attributes.exists( "emitter_iteration_interval" ) )
 		{
-			if( attributes.exists( "posy" ) )
-			{
-				attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
-			}
+			attributes.add( "emitter_iteration_interval", CEGUI::PropertyHelper::floatToString( ( 1.0f / attributes.getValueAsFloat( "creation_speed", 0.3f ) ) * 0.032f ) );
+			attributes.remove( "creation_speed" );
 		}
+	}
 
-		cMoving_Platform *moving_platform = new cMoving_Platform( attributes, sprite_manager );
+	// if V.1.9 and lower : change fire_1 animation to particles
+	if( engine_version < 37 )
+	{
+		Relocate_Image( attributes, "animation/fire_1/1.png", "animation/particles/fire_1.png", "image" );
+		Relocate_Image( attributes, "animation/fire_1/2.png", "animation/particles/fire_2.png", "image" );
+		Relocate_Image( attributes, "animation/fire_1/3.png", "animation/particles/fire_3.png", "image" );
+		Relocate_Image( attributes, "animation/fire_1/4.png", "animation/particles/fire_4.png", "image" );
+	}
 
-		// if V.1.7 and lower : change new slider middle count because start and end image is now half the width
-		if( engine_version < 32 )
+	// change disabled type to quota 0
+	if( attributes.exists( "type" ) )
+	{
+		// if disabled
+		if( attributes.getValueAsInteger( "type" ) == 0 )
 		{
-			if( moving_platform->m_images[0].m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/left.png" ) == 0 )
-			{
-				moving_platform->Set_Middle_Count( moving_platform->m_middle_count + 1 );
-			}
-			if( moving_platform->m_images[0].m_image->m_filename.compare( DATA_DIR "/" GAME_PIXMAPS_DIR "/" "ground/green_1/slider/1/brown/right.png" ) == 0 )
-			{
-				moving_platform->Set_Middle_Count( moving_platform->m_middle_count + 1 );
-			}
+			attributes.add( "quota", "0" );
+			attributes.remove( "type" );
 		}
-
-		return moving_platform;
 	}
-	else if( element == "enemy" )
+
+	// rename attributes
+	attributes.add( "pos_x", CEGUI::PropertyHelper::intToString( attributes.getValueAsInteger( "rect_x", 0 ) ) );
+	attributes.add( "pos_y", CEGUI::PropertyHelper::intToString( attributes.getValueAsInteger( "rect_y", 0 ) - 600 ) );
+	attributes.add( "size_x", CEGUI::PropertyHelper::intToString( attributes.getValueAsInteger( "rect_w", game_res_w ) ) );
+	attributes.add( "size_y", CEGUI::PropertyHelper::intToString( attributes.getValueAsInteger( "rect_h", 0 ) ) );
+	attributes.add( "emitter_time_to_live", CEGUI::PropertyHelper::floatToString( -1.0f ) );
+	attributes.add( "pos_z", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "z", 0.12f ) ) );
+	attributes.add( "pos_z_rand", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "z_rand", 0.0f ) ) );
+	if( !attributes.exists( "time_to_live" ) )
 	{
-		CEGUI::String str_type = attributes.getValueAsString( "type" );
+		attributes.add( "time_to_live", CEGUI::PropertyHelper::floatToString( 7.0f ) );
+	}
+	attributes.add( "emitter_interval", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "emitter_iteration_interval", 0.3f ) ) );
+	attributes.add( "size_scale", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "scale", 0.2f ) ) );
+	attributes.add( "size_scale_rand", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "scale_rand", 0.2f ) ) );
+	attributes.add( "vel", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "speed", 2.0f ) ) );
+	attributes.add( "vel_rand", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "speed_rand", 8.0f ) ) );
+	attributes.add( "angle_start", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "dir_range_start", 0.0f ) ) );
+	attributes.add( "angle_range", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "dir_range_size", 90.0f ) ) );
+	attributes.add( "const_rot_z", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "const_rotz", -5.0f ) ) );
+	attributes.add( "const_rot_z_rand", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "const_rotz_rand", 10.0f ) ) );
 
-		// if V.1.5 and lower
-		if( engine_version < 26 )
-		{
-			// change gumba to furball
-			if( str_type == "gumba" )
-			{
-				// change type
-				str_type = "furball";
-				attributes.add( "type", "furball" );
-				// fix color : red was used in pre 1.0 but later became blue
-				if( attributes.exists( "color" ) && attributes.getValueAsString( "color" ) == "red" )
-				{
-					attributes.add( "color", "blue" );
-				}
-			}
-			// change rex to krush
-			else if( str_type == "rex" )
-			{
-				// change type
-				str_type = "krush";
-				attributes.add( "type", "krush" );
-			}
-		}
 
-		// if V.1.7 and lower
-		if( engine_version < 29 )
-		{
-			// change jpiranha to flyon
-			if( str_type == "jpiranha" )
-			{
-				// change type
-				str_type = "flyon";
-				attributes.add( "type", "flyon" );
+	cParticle_Emitter *emitter = new cParticle_Emitter( attributes, sprite_manager );
+	emitter->Set_Spawned( 0 );
 
-				// change image dir
-				if( attributes.exists( "image_dir" ) )
-				{
-					std::string img_dir = attributes.getValueAsString( "image_dir" ).c_str();
-					std::string::size_type pos = img_dir.find( "jpiranha" );
-
-					// change if found
-					if( pos != std::string::npos )
-					{
-						img_dir.replace( pos, 8, "flyon" );
-						attributes.add( "image_dir", img_dir );
-					}
-				}
-			}
-		}
+	// clip to the camera
+	emitter->Set_Clip_Rect( GL_rect( 0.0f, 0.0f, static_cast<float>(game_res_w), static_cast<float>(game_res_h) + ( attributes.getValueAsInteger( "rect_y", 0 ) * -1 ) ) );
+	emitter->Set_Based_On_Camera_Pos( 1 );
 
-		// if V.1.9 and lower : move y coordinate bottom to 0
-		if( engine_version < 35 )
-		{
-			if( attributes.exists( "posy" ) )
-			{
-				attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
-			}
-		}
+	return emitter;
+}
 
-		if( str_type == "eato" )
+// Create a ball
+static cSprite *Level_Create_Ball( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	return new cBall( attributes, sprite_manager );
+}
+
+// Convert the box attributes before the type is used
+static void Level_Convert_Box( CEGUI::XMLAttributes &attributes, int engine_version )
+{
+	// if V.1.9 and lower : move y coordinate bottom to 0
+	if( engine_version < 35 )
+	{
+		if( attributes.exists( "posy" ) )
 		{
-			return new cEato( attributes, sprite_manager );
+			attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
 		}
-		else if( str_type == "furball" )
+	}
+
+	CEGUI::String str_type = attributes.getValueAsString( "type" );
+
+	// gold is somewhere pre V.0.99.5
+	if( str_type == "gold" )
+	{
+		// update old values
+		attributes.add( "type", "bonus" );
+		attributes.add( "animation", "Default" );
+		attributes.add( "item", int_to_string( TYPE_GOLDPIECE ) );
+		// renamed color to gold_color
+		if( attributes.exists( "color" ) )
 		{
-			return new cFurball( attributes, sprite_manager );
+			attributes.add( "gold_color", attributes.getValue( "color" ) );
+			attributes.remove( "color" );
 		}
-		else if( str_type == "turtle" )
+	}
+	// pre V.0.99.4
+	else if ( str_type == "empty" )
+	{
+		// update old values
+		attributes.add( "type", "bonus" );
+		attributes.add( "item", "0" );
+	}
+	// pre V.0.99.4
+	else if ( str_type == "invisible" )
+	{
+		// update old values
+		attributes.add( "type", "bonus" );
+		attributes.add( "item", "0" );
+		attributes.add( "invisible", "1" );
+	}
+}
+
+// Convert the item attributes before the type is used
+static void Level_Convert_Item( CEGUI::XMLAttributes &attributes, int engine_version )
+{
+	// if V.1.9 and lower : move y coordinate bottom to 0
+	if( engine_version < 35 )
+	{
+		if( attributes.exists( "posy" ) )
 		{
-			return new cTurtle( attributes, sprite_manager );
+			attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
 		}
-		else if( str_type == "turtleboss" )
+	}
+}
+
+// Convert the enemy attributes before the type is used
+static void Level_Convert_Enemy( CEGUI::XMLAttributes &attributes, int engine_version )
+{
+	CEGUI::String str_type = attributes.getValueAsString( "type" );
+
+	// if V.1.5 and lower
+	if( engine_version < 26 )
+	{
+		// change gumba to furball
+		if( str_type == "gumba" )
 		{
-			// if V.1.5 and lower : max_downgrade_time changed to shell_time
-			if( engine_version < 27 )
+			// change type
+			str_type = "furball";
+			attributes.add( "type", "furball" );
+			// fix color : red was used in pre 1.0 but later became blue
+			if( attributes.exists( "color" ) && attributes.getValueAsString( "color" ) == "red" )
 			{
-				if( attributes.exists( "max_downgrade_time" ) )
-				{
-					attributes.add( "shell_time", attributes.getValueAsString( "max_downgrade_time" ) );
-					attributes.remove( "max_downgrade_time" );
-				}
+				attributes.add( "color", "blue" );
 			}
-
-			return new cTurtleBoss( attributes, sprite_manager );
 		}
-		else if( str_type == "flyon" )
+		// change rex to krush
+		else if( str_type == "rex" )
 		{
-			return new cFlyon( attributes, sprite_manager );
+			// change type
+			str_type = "krush";
+			attributes.add( "type", "krush" );
 		}
-		else if( str_type == "thromp" )
+	}
+
+	// if V.1.7 and lower
+	if( engine_version < 29 )
+	{
+		// change jpiranha to flyon
+		if( str_type == "jpiranha" )
 		{
-			cThromp *thromp = new cThromp( attributes, sprite_manager );
+			// change type
+			str_type = "flyon";
+			attributes.add( "type", "flyon" );
 
-			// if V.1.4 and lower : fix thromp distance was smaller
-			if( engine_version < 25 )
+			// change image dir
+			if( attributes.exists( "image_dir" ) )
 			{
-				thromp->Set_Max_Distance( thromp->m_max_distance + 36 );
-			}
+				std::string img_dir = attributes.getValueAsString( "image_dir" ).c_str();
+				std::string::size_type pos = img_dir.find( "jpiranha" );
 
-			return thromp;
-		}
-		else if( str_type == "rokko" )
-		{
-			return new cRokko( attributes, sprite_manager );
-		}
-		else if( str_type == "krush" )
-		{
-			return new cKrush( attributes, sprite_manager );
-		}
-		else if( str_type == "gee" )
-		{
-			return new cGee( attributes, sprite_manager );
-		}
-		else if( str_type == "spika" )
-		{
-			return new cSpika( attributes, sprite_manager );
-		}
-		else if( str_type == "static" )
-		{
-			return new cStaticEnemy( attributes, sprite_manager );
-		}
-		else if( str_type == "spikeball" )
-		{
-			return new cSpikeball( attributes, sprite_manager );
+				// change if found
+				if( pos != std::string::npos )
+				{
+					img_dir.replace( pos, 8, "flyon" );
+					attributes.add( "image_dir", img_dir );
+				}
+			}
 		}
-		else
+	}
+
+	// if V.1.9 and lower : move y coordinate bottom to 0
+	if( engine_version < 35 )
+	{
+		if( attributes.exists( "posy" ) )
 		{
-			printf( "Warning : Unknown Level Enemy type : %s\n", str_type.c_str() );
+			attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
 		}
 	}
-	else if( element == "sound" )
+}
+
+// Create a turtle boss
+static cSprite *Level_Create_Turtle_Boss( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	// if V.1.5 and lower : max_downgrade_time changed to shell_time
+	if( engine_version < 27 )
 	{
-		// if V.1.9 and lower : move y coordinate bottom to 0
-		if( engine_version < 35 )
+		if( attributes.exists( "max_downgrade_time" ) )
 		{
-			if( attributes.exists( "pos_y" ) )
-			{
-				attributes.add( "pos_y", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "pos_y" ) - 600.0f ) );
-			}
+			attributes.add( "shell_time", attributes.getValueAsString( "max_downgrade_time" ) );
+			attributes.remove( "max_downgrade_time" );
 		}
+	}
+
+	return new cTurtleBoss( attributes, sprite_manager );
+}
+
+// Create a thromp
+static cSprite *Level_Create_Thromp( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	cThromp *thromp = new cThromp( attributes, sprite_manager );
 
-		return new cRandom_Sound( attributes, sprite_manager );
+	// if V.1.4 and lower : fix thromp distance was smaller
+	if( engine_version < 25 )
+	{
+		thromp->Set_Max_Distance( thromp->m_max_distance + 36 );
 	}
-	else if( element == "particle_emitter" )
+
+	return thromp;
+}
+
+// Create the object class which needs no conversion
+template<class T>
+static cSprite *Level_Create_Object( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	return new T( attributes, sprite_manager );
+}
+
+/* *** *** *** *** *** *** *** cLevel_Object_Factory *** *** *** *** *** *** *** *** *** *** */
+
+cLevel_Object_Factory :: cLevel_Object_Factory( void )
+{
+	// number 0 is no name
+	m_name_list.push_back( Name() );
+
+	// keep in synch with cLevel::Is_Level_Object_Element()
+	Register( "sprite", "", &Level_Create_Sprite );
+	Register( "enemystopper", "", &Level_Create_Enemy_Stopper );
+	Register( "levelexit", "", &Level_Create_Level_Exit );
+	Register( "level_entry", "", &Level_Create_Level_Entry );
+
+	Register_Convert( "box", &Level_Convert_Box );
+	Register( "box", "bonus", &Level_Create_Object<cBonusBox> );
+	Register( "box", "spin", &Level_Create_Object<cSpinBox> );
+	Register( "box", "text", &Level_Create_Object<cText_Box> );
+
+	// powerup is pre V.0.99.5
+	const char *item_elements[] = { "item", "powerup" };
+
+	for( unsigned int i = 0; i < 2; i++ )
 	{
-		// Note : If you relocate images don't forget the global effect
+		Register_Convert( item_elements[i], &Level_Convert_Item );
+		Register( item_elements[i], "goldpiece", &Level_Create_Object<cGoldpiece> );
+		Register( item_elements[i], "mushroom", &Level_Create_Object<cMushroom> );
+		Register( item_elements[i], "fireplant", &Level_Create_Object<cFirePlant> );
+		Register( item_elements[i], "jstar", &Level_Create_Object<cjStar> );
+		Register( item_elements[i], "moon", &Level_Create_Object<cMoon> );
+	}
 
-		// if V.1.9 and lower : move y coordinate bottom to 0
-		if( engine_version < 35 )
-		{
-			if( attributes.exists( "pos_y" ) )
-			{
-				attributes.add( "pos_y", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "pos_y" ) - 600.0f ) );
-			}
-		}
+	Register( "moving_platform", "", &Level_Create_Moving_Platform );
+	// falling platform is pre V.1.5
+	Register( "falling_platform", "", &Level_Create_Falling_Platform );
+
+	Register_Convert( "enemy", &Level_Convert_Enemy );
+	Register( "enemy", "eato", &Level_Create_Object<cEato> );
+	Register( "enemy", "furball", &Level_Create_Object<cFurball> );
+	Register( "enemy", "turtle", &Level_Create_Object<cTurtle> );
+	Register( "enemy", "turtleboss", &Level_Create_Turtle_Boss );
+	Register( "enemy", "flyon", &Level_Create_Object<cFlyon> );
+	Register( "enemy", "thromp", &Level_Create_Thromp );
+	Register( "enemy", "rokko", &Level_Create_Object<cRokko> );
+	Register( "enemy", "krush", &Level_Create_Object<cKrush> );
+	Register( "enemy", "gee", &Level_Create_Object<cGee> );
+	Register( "enemy", "spika", &Level_Create_Object<cSpika> );
+	Register( "enemy", "static", &Level_Create_Object<cStaticEnemy> );
+	Register( "enemy", "spikeball", &Level_Create_Object<cSpikeball> );
+
+	Register( "sound", "", &Level_Create_Sound );
+	Register( "particle_emitter", "", &Level_Create_Particle_Emitter );
+	Register( "path", "", &Level_Create_Path );
+	// if V.1.9 and lower : convert global effect to an advanced particle emitter
+	Register( "global_effect", "", &Level_Create_Global_Effect );
+	Register( "ball", "", &Level_Create_Ball );
+}
 
-		// if V.1.9 and lower : change fire_1 animation to particles
-		if( engine_version < 37 )
-		{
-			Relocate_Image( attributes, "animation/fire_1/1.png", "animation/particles/fire_1.png", "file" );
-			Relocate_Image( attributes, "animation/fire_1/2.png", "animation/particles/fire_2.png", "file" );
-			Relocate_Image( attributes, "animation/fire_1/3.png", "animation/particles/fire_3.png", "file" );
-			Relocate_Image( attributes, "animation/fire_1/4.png", "animation/particles/fire_4.png", "file" );
-		}
+void cLevel_Object_Factory :: Register( const std::string &element, const std::string &type, Create_Func create_func )
+{
+	const unsigned int element_id = Add_Name( element );
+	unsigned int type_id = 0;
 
-		// if V.1.9 and lower : change file to image
-		if( engine_version < 38 )
-		{
-			if( attributes.exists( "file" ) )
-			{
-				attributes.add( "image", attributes.getValueAsString( "file" ) );
-				attributes.remove( "file" );
-			}
-		}
+	if( !type.empty() )
+	{
+		type_id = Add_Name( type );
+		m_name_list[element_id].m_typed = 1;
+	}
+
+	m_creators[Get_Key( element_id, type_id )] = create_func;
+}
 
-		cParticle_Emitter *particle_emitter = new cParticle_Emitter( attributes, sprite_manager );
-		// set to not spawned
-		particle_emitter->Set_Spawned( 0 );
+void cLevel_Object_Factory :: Register_Convert( const std::string &element, Convert_Func convert_func )
+{
+	m_name_list[Add_Name( element )].m_convert = convert_func;
+}
+
+unsigned int cLevel_Object_Factory :: Get_Name_Id( const std::string &name ) const
+{
+	Name_Map::const_iterator itr = m_names.find( name );
 
-		return particle_emitter;
+	if( itr == m_names.end() )
+	{
+		return 0;
 	}
-	else if( element == "path" )
+
+	return itr->second;
+}
+
+cSprite *cLevel_Object_Factory :: Create( unsigned int element_id, unsigned int type_id, CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager ) const
+{
+	Create_Map::const_iterator itr = m_creators.find( Get_Key( element_id, type_id ) );
+
+	// creator for every type of the element
+	if( itr == m_creators.end() && type_id )
 	{
-		// if V.1.9 and lower : move y coordinate bottom to 0
-		if( engine_version < 35 )
-		{
-			if( attributes.exists( "posy" ) )
-			{
-				attributes.add( "posy", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "posy" ) - 600.0f ) );
-			}
-		}
+		itr = m_creators.find( Get_Key( element_id, 0 ) );
+	}
 
-		return new cPath( attributes, sprite_manager );
+	if( itr == m_creators.end() )
+	{
+		return NULL;
 	}
-	// if V.1.9 and lower : convert global effect to an advanced particle emitter
-	else if( element == "global_effect" )
+
+	return itr->second( attributes, engine_version, sprite_manager );
+}
+
+cSprite *cLevel_Object_Factory :: Create( const std::string &element, CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager ) const
+{
+	const unsigned int element_id = Get_Name_Id( element );
+
+	if( !element_id )
 	{
-		// if V.0.99.4 and lower : change lieftime mod to time to live
-		if( engine_version < 21 )
-		{
-			if( !attributes.exists( "time_to_live" ) )
-			{
-				attributes.add( "time_to_live", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "lifetime_mod", 20 ) * 0.3f ) );
-				attributes.remove( "lifetime_mod" );
-			}
-		}
+		return NULL;
+	}
 
-		// if V.0.99.7 and lower : change creation speed to emitter iteration interval
-		if( engine_version < 22 )
-		{
-			if( !attributes.exists( "emitter_iteration_interval" ) )
-			{
-				attributes.add( "emitter_iteration_interval", CEGUI::PropertyHelper::floatToString( ( 1.0f / attributes.getValueAsFloat( "creation_speed", 0.3f ) ) * 0.032f ) );
-				attributes.remove( "creation_speed" );
-			}
-		}
+	const Name &element_name = m_name_list[element_id];
 
-		// if V.1.9 and lower : change fire_1 animation to particles
-		if( engine_version < 37 )
-		{
-			Relocate_Image( attributes, "animation/fire_1/1.png", "animation/particles/fire_1.png", "image" );
-			Relocate_Image( attributes, "animation/fire_1/2.png", "animation/particles/fire_2.png", "image" );
-			Relocate_Image( attributes, "animation/fire_1/3.png", "animation/particles/fire_3.png", "image" );
-			Relocate_Image( attributes, "animation/fire_1/4.png", "animation/particles/fire_4.png", "image" );
-		}
+	// the conversion can change the type
+	if( element_name.m_convert )
+	{
+		element_name.m_convert( attributes, engine_version );
+	}
 
-		// change disabled type to quota 0
-		if( attributes.exists( "type" ) )
-		{
-			// if disabled
-			if( attributes.getValueAsInteger( "type" ) == 0 )
-			{
-				attributes.add( "quota", "0" );
-				attributes.remove( "type" );
-			}
-		}
+	if( !element_name.m_typed )
+	{
+		return Create( element_id, 0, attributes, engine_version, sprite_manager );
+	}
 
-		// rename attributes
-		attributes.add( "pos_x", CEGUI::PropertyHelper::intToString( attributes.getValueAsInteger( "rect_x", 0 ) ) );
-		attributes.add( "pos_y", CEGUI::PropertyHelper::intToString( attributes.getValueAsInteger( "rect_y", 0 ) - 600 ) );
-		attributes.add( "size_x", CEGUI::PropertyHelper::intToString( attributes.getValueAsInteger( "rect_w", game_res_w ) ) );
-		attributes.add( "size_y", CEGUI::PropertyHelper::intToString( attributes.getValueAsInteger( "rect_h", 0 ) ) );
-		attributes.add( "emitter_time_to_live", CEGUI::PropertyHelper::floatToString( -1.0f ) );
-		attributes.add( "pos_z", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "z", 0.12f ) ) );
-		attributes.add( "pos_z_rand", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "z_rand", 0.0f ) ) );
-		if( !attributes.exists( "time_to_live" ) )
-		{
-			attributes.add( "time_to_live", CEGUI::PropertyHelper::floatToString( 7.0f ) );
-		}
-		attributes.add( "emitter_interval", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "emitter_iteration_interval", 0.3f ) ) );
-		attributes.add( "size_scale", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "scale", 0.2f ) ) );
-		attributes.add( "size_scale_rand", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "scale_rand", 0.2f ) ) );
-		attributes.add( "vel", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "speed", 2.0f ) ) );
-		attributes.add( "vel_rand", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "speed_rand", 8.0f ) ) );
-		attributes.add( "angle_start", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "dir_range_start", 0.0f ) ) );
-		attributes.add( "angle_range", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "dir_range_size", 90.0f ) ) );
-		attributes.add( "const_rot_z", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "const_rotz", -5.0f ) ) );
-		attributes.add( "const_rot_z_rand", CEGUI::PropertyHelper::floatToString( attributes.getValueAsFloat( "const_rotz_rand", 10.0f ) ) );
+	const std::string type = attributes.getValueAsString( "type" ).c_str();
+	const unsigned int type_id = Get_Name_Id( type );
+	cSprite *object = NULL;
 
+	if( type_id )
+	{
+		object = Create( element_id, type_id, attributes, engine_version, sprite_manager );
+	}
+
+	if( !object )
+	{
+		printf( "Warning : Unknown Level %s type : %s\n", element.c_str(), type.c_str() );
+	}
 
-		cParticle_Emitter *emitter = new cParticle_Emitter( attributes, sprite_manager );
-		emitter->Set_Spawned( 0 );
+	return object;
+}
 
-		// clip to the camera
-		emitter->Set_Clip_Rect( GL_rect( 0.0f, 0.0f, static_cast<float>(game_res_w), static_cast<float>(game_res_h) + ( attributes.getValueAsInteger( "rect_y", 0 ) * -1 ) ) );
-		emitter->Set_Based_On_Camera_Pos( 1 );
+unsigned int cLevel_Object_Factory :: Add_Name( const std::string &name )
+{
+	const unsigned int id = Get_Name_Id( name );
 
-		return emitter;
+	if( id )
+	{
+		return id;
 	}
-	else if( element == "ball" )
+
+	Name new_name;
+	new_name.m_name = name;
+	m_name_list.push_back( new_name );
+	m_names[name] = m_name_list.size() - 1;
+
+	return m_name_list.size() - 1;
+}
+
+cLevel_Object_Factory *pLevel_Object_Factory = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+cSprite *Create_Level_Object_From_XML( const CEGUI::String &xml_element, CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager )
+{
+	// creation time by element and type
+	cLoad_Profiler_Scope profile_scope;
+
+	if( pLoad_Profiler )
 	{
-		return new cBall( attributes, sprite_manager );
+		std::string phase = "object " + std::string( xml_element.c_str() );
+
+		if( attributes.exists( "type" ) )
+		{
+			phase += " " + std::string( attributes.getValueAsString( "type" ).c_str() );
+		}
+
+		profile_scope.Start( phase );
 	}
-	// keep in synch with cLevel::Is_Level_Object_Element()
 
-	return NULL;
+	return pLevel_Object_Factory->Create( xml_element.c_str(), attributes, engine_version, sprite_manager );
 }
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 cLevel *pActive_Level = NULL;
+Uint32 level_random_seed = 0;
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
@@ -25,10 +25,17 @@
 // CEGUI
 #include "CEGUIXMLHandler.h"
 #include "CEGUIXMLAttributes.h"
+// boost
+#include <boost/unordered_map.hpp>
 
 namespace SMC
 {
 
+class cLevel_Stream;
+class cSave_Level_Object;
+class cLevel_Manifest;
+class cMemory_Arena;
+
 /* *** *** *** *** *** cLevel *** *** *** *** *** *** *** *** *** *** *** *** */
 
 class cLevel : public CEGUI::XMLHandler
@@ -47,12 +54,16 @@ public:
 	 * if delayed is given unloads the on the next update
 	*/
 	void Unload( bool delayed = 0 );
-	// Save the Level
-	void Save( void );
+	/* Save the Level
+	 * with_sound : play the save sound
+	*/
+	void Save( bool with_sound = 1 );
 	// Delete and unload
 	void Delete( void );
 	// Reset settings data
 	void Reset_Settings( void );
+	// Create all streamed objects and stop streaming
+	void Stop_Streaming( void );
 
 	// Init
 	void Init( void );
@@ -109,6 +120,8 @@ public:
 	 * if set to 2 the full directory will be returned
 	*/
 	std::string Get_Music_Filename( int with_dir = 2, bool with_end = 1 ) const;
+	// Returns the top color of the first gradient background or black
+	Color Get_Background_Color( void ) const;
 	// Set the Music filename
 	void Set_Music( std::string filename );
 	/* Set the filename
@@ -129,6 +142,15 @@ public:
 	// Get entry with the given name
 	cLevel_Entry *Get_Entry( const std::string &name );
 
+	/* Keep the savegame data of the level object as it is when created
+	 * the savegames only store the differences to it
+	*/
+	void Set_Pristine( cSprite *sprite );
+	/* Remove the properties which have the same value as when the object was created
+	 * returns true if no property is left and the object does not need to be saved
+	*/
+	bool Remove_Pristine( cSave_Level_Object *save_object ) const;
+
 	// Return true if a level is loaded
 	bool Is_Loaded( void ) const;
 
@@ -148,6 +170,8 @@ public:
 
 	// level filename
 	std::string m_level_filename;
+	// seed of the game random generator when the level objects were loaded
+	Uint32 m_random_seed;
 	// if a new level should be loaded this is the next level filename
 	std::string m_next_level_filename;
 
@@ -160,6 +184,16 @@ public:
 	cAnimation_Manager *m_animation_manager;
 	// sprite manager
 	cSprite_Manager *m_sprite_manager;
+	// creates the objects near the camera if the level is huge or NULL
+	cLevel_Stream *m_stream;
+	// number of objects in the level file which are numbered in the file order
+	unsigned int m_object_count;
+	// savegame data of the objects when created by their number or NULL
+	vector<cSave_Level_Object *> m_pristine_objects;
+	// images and sounds used by the level
+	cLevel_Manifest *m_manifest;
+	// memory of the level sprites
+	cMemory_Arena *m_arena;
 
 	/* *** *** *** Settings *** *** *** *** */
 
@@ -200,6 +234,76 @@ private:
 	CEGUI::XMLAttributes m_xml_attributes;
 };
 
+/* *** *** *** *** *** *** *** cLevel_Object_Factory *** *** *** *** *** *** *** *** *** *** */
+
+/* Creates the level objects from their XML element and type
+ * the element and type names are numbered once and the creators are found in a hash table
+ * the numbers can be used instead of the names to create objects
+*/
+class cLevel_Object_Factory
+{
+public:
+	// Returns the object created from the attributes or NULL
+	typedef cSprite *(*Create_Func)( CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager );
+	// Converts the attributes of an older engine version before the type is used
+	typedef void (*Convert_Func)( CEGUI::XMLAttributes &attributes, int engine_version );
+
+	// registers the level objects
+	cLevel_Object_Factory( void );
+
+	/* Register the object creator of the element and type
+	 * type : if empty it is used for every type of the element
+	*/
+	void Register( const std::string &element, const std::string &type, Create_Func create_func );
+	// Register the conversion of the element attributes
+	void Register_Convert( const std::string &element, Convert_Func convert_func );
+
+	// Returns the number of the element or type name or 0 if not registered
+	unsigned int Get_Name_Id( const std::string &name ) const;
+
+	/* Create the object with the element and type number
+	 * the attributes are not converted
+	 * type_id : 0 if the element has no type
+	*/
+	cSprite *Create( unsigned int element_id, unsigned int type_id, CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager ) const;
+	// Create the object with the element name and the type attribute after converting the attributes
+	cSprite *Create( const std::string &element, CEGUI::XMLAttributes &attributes, int engine_version, cSprite_Manager *sprite_manager ) const;
+
+private:
+	// Returns the number of the name and adds it if not available
+	unsigned int Add_Name( const std::string &name );
+
+	// Returns the creator key
+	static inline Uint32 Get_Key( unsigned int element_id, unsigned int type_id )
+	{
+		return ( element_id << 16 ) | type_id;
+	}
+
+	// element or type name
+	struct Name
+	{
+		Name( void )
+		: m_convert( NULL ), m_typed( 0 ) {}
+
+		std::string m_name;
+		// element attributes conversion
+		Convert_Func m_convert;
+		// if the element has creators for its types
+		bool m_typed;
+	};
+
+	typedef boost::unordered_map<std::string, unsigned int> Name_Map;
+	Name_Map m_names;
+	// names by number
+	vector<Name> m_name_list;
+
+	typedef boost::unordered_map<Uint32, Create_Func> Create_Map;
+	Create_Map m_creators;
+};
+
+// Level object factory
+extern cLevel_Object_Factory *pLevel_Object_Factory;
+
 /* Return the Level Object if element name is available else NULL
  * engine_version : engine version of the data and if it's below the current version it converts it
  * sprite_manager : needed if the engine version is below the current version and data conversion creates multiple objects
@@ -211,6 +315,11 @@ cSprite *Create_Level_Object_From_XML( const CEGUI::String &xml_element, CEGUI::
 // The Level
 extern cLevel *pActive_Level;
 
+/* Seed of the game random generator for loading every level
+ * 0 uses a new seed with every load
+*/
+extern Uint32 level_random_seed;
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 } // namespace SMC
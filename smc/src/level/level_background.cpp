@@ -17,6 +17,7 @@
 #include "../user/preferences.h"
 #include "../core/game_core.h"
 #include "../video/gl_surface.h"
+#include "../video/renderer.h"
 #include "../core/framerate.h"
 
 namespace SMC
@@ -85,7 +86,7 @@ void cBackground :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	}
 }
 
-void cBackground :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cBackground :: Save_To_XML( cXml_Writer &stream )
 {
 	if( m_type == BG_NONE )
 	{
@@ -93,7 +94,7 @@ void cBackground :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	}
 
 	// begin
-	stream.openTag( "background" );
+	stream.Open_Tag( "background" );
 
 	// type
 	Write_Property( stream, "type", m_type );
@@ -133,7 +134,7 @@ void cBackground :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	}
 
 	// end background
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cBackground :: Set_Sprite_Manager( cSprite_Manager *sprite_manager )
@@ -305,6 +306,12 @@ void cBackground :: Draw( void )
 			}
 		}
 
+		// one quad
+		if( Draw_Repeated( posx_final, posy_final ) )
+		{
+			return;
+		}
+
 		// draw until width is filled
 		while( posx_final < game_res_w )
 		{
@@ -370,6 +377,65 @@ void cBackground :: Draw_Gradient( void )
 	}
 }
 
+bool cBackground :: Draw_Repeated( float posx, float posy ) const
+{
+	// the texture has to be the complete image
+	if( m_image_1->Is_In_Atlas() || m_image_1->Is_Tiled() || m_image_1->m_tex_x1 != 0.0f || m_image_1->m_tex_y1 != 0.0f || m_image_1->m_tex_x2 != 1.0f || m_image_1->m_tex_y2 != 1.0f )
+	{
+		return 0;
+	}
+
+	// the image must be drawn without a gap or overlap to the next one
+	if( m_image_1->m_w != m_image_1->m_start_w || m_image_1->m_h != m_image_1->m_start_h || m_image_1->m_int_x != 0.0f || m_image_1->m_int_y != 0.0f )
+	{
+		return 0;
+	}
+
+	// rotation
+	if( m_image_1->m_base_rot_x != 0.0f || m_image_1->m_base_rot_y != 0.0f || m_image_1->m_base_rot_z != 0.0f )
+	{
+		return 0;
+	}
+
+	if( m_image_1->m_w <= 0.0f || m_image_1->m_h <= 0.0f )
+	{
+		return 0;
+	}
+
+	// create request
+	cSurface_Request *request = new cSurface_Request();
+	m_image_1->Blit_Data( request );
+
+	// screen wide
+	request->m_pos_x = 0.0f;
+	request->m_w = static_cast<float>(game_res_w);
+	request->m_tex_x1 = -posx / m_image_1->m_w;
+	request->m_tex_x2 = request->m_tex_x1 + ( request->m_w / m_image_1->m_w );
+	request->m_repeat_x = 1;
+
+	// screen high
+	if( m_type == BG_IMG_ALL )
+	{
+		request->m_pos_y = 0.0f;
+		request->m_h = static_cast<float>(game_res_h);
+		request->m_tex_y1 = -posy / m_image_1->m_h;
+		request->m_tex_y2 = request->m_tex_y1 + ( request->m_h / m_image_1->m_h );
+		request->m_repeat_y = 1;
+	}
+	// one image high
+	else
+	{
+		request->m_pos_y = posy;
+	}
+
+	request->m_pos_z = m_pos_z;
+
+	// add request
+	pRenderer->Add( request );
+
+	return 1;
+}
+
 std::string cBackground :: Get_Type_Name( void ) const
 {
 	return Get_Type_Name( m_type );
@@ -19,8 +19,9 @@
 #include "../core/global_basic.h"
 #include "../video/video.h"
 #include "../core/obj_manager.h"
+#include "../core/xml_writer.h"
 // CEGUI
-#include "CEGUIXMLSerializer.h"
+#include "CEGUIXMLAttributes.h"
 
 namespace SMC
 {
@@ -55,7 +56,7 @@ public:
 	// load from stream
 	void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	void Save_To_XML( CEGUI::XMLSerializer &stream );
+	void Save_To_XML( cXml_Writer &stream );
 
 	// Set the parent sprite manager
 	void Set_Sprite_Manager( cSprite_Manager *sprite_manager );
@@ -87,6 +88,11 @@ public:
 	void Draw( void );
 	// draw gradient
 	void Draw_Gradient( void );
+	/* draw the image as one screen wide quad with a repeated texture
+	 * posx, posy : aligned position of the first image
+	 * returns false if the image can not be repeated by the texture
+	*/
+	bool Draw_Repeated( float posx, float posy ) const;
 
 	// Returns the name of the current type
 	std::string Get_Type_Name( void ) const;
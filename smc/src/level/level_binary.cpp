@@ -0,0 +1,473 @@
+/***************************************************************************
+ * level_binary.cpp  -  compiled level format
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../level/level_binary.h"
+#include "../core/game_core.h"
+#include "../core/xml_reader.h"
+#include "../core/filesystem/resource_manager.h"
+#include "../core/xml_writer.h"
+// CEGUI
+#include "CEGUIXMLHandler.h"
+#include "CEGUIXMLParser.h"
+#include "CEGUIExceptions.h"
+#include "CEGUISystem.h"
+#include <cstring>
+#include <cstdio>
+#include <map>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** File *** *** *** *** *** *** *** *** *** *** */
+
+// file identification and version
+static const char level_binary_magic[4] = { 'S', 'M', 'C', 'L' };
+static const Uint32 level_binary_version = 1;
+
+/* file header
+ * followed by the element table, the property table, the string offsets and the string data
+ * the values are in the byte order of the system as the file is only cached
+*/
+struct Level_Binary_Header
+{
+	char m_magic[4];
+	Uint32 m_version;
+	// hash of the XML level file
+	Uint64 m_source_hash;
+	Uint32 m_element_count;
+	Uint32 m_property_count;
+	Uint32 m_string_count;
+	// string data size in bytes
+	Uint32 m_string_size;
+};
+
+/* *** *** *** *** *** *** *** cLevel_Binary_Compiler *** *** *** *** *** *** *** *** *** *** */
+
+/* Collects the elements and properties of a XML level file
+ * the properties belong to the next ending element like in the level loading
+*/
+class cLevel_Binary_Compiler : public CEGUI::XMLHandler
+{
+public:
+	cLevel_Binary_Compiler( void )
+	{
+		m_first_property = 0;
+	}
+
+	virtual ~cLevel_Binary_Compiler( void ) {}
+
+	// Write the compiled level into the buffer
+	void Write( vector<char> &buffer, Uint64 source_hash ) const
+	{
+		Level_Binary_Header header;
+		memcpy( header.m_magic, level_binary_magic, 4 );
+		header.m_version = level_binary_version;
+		header.m_source_hash = source_hash;
+		header.m_element_count = static_cast<Uint32>(m_elements.size() / 3);
+		header.m_property_count = static_cast<Uint32>(m_properties.size() / 2);
+		header.m_string_count = static_cast<Uint32>(m_string_offsets.size());
+		header.m_string_size = static_cast<Uint32>(m_strings.size());
+
+		const size_t tables_size = ( m_elements.size() + m_properties.size() + m_string_offsets.size() ) * sizeof( Uint32 );
+		buffer.resize( sizeof( Level_Binary_Header ) + tables_size + m_strings.size() );
+
+		char *pos = &buffer[0];
+		memcpy( pos, &header, sizeof( Level_Binary_Header ) );
+		pos += sizeof( Level_Binary_Header );
+
+		if( !m_elements.empty() )
+		{
+			memcpy( pos, &m_elements[0], m_elements.size() * sizeof( Uint32 ) );
+			pos += m_elements.size() * sizeof( Uint32 );
+		}
+		if( !m_properties.empty() )
+		{
+			memcpy( pos, &m_properties[0], m_properties.size() * sizeof( Uint32 ) );
+			pos += m_properties.size() * sizeof( Uint32 );
+		}
+		if( !m_string_offsets.empty() )
+		{
+			memcpy( pos, &m_string_offsets[0], m_string_offsets.size() * sizeof( Uint32 ) );
+			pos += m_string_offsets.size() * sizeof( Uint32 );
+		}
+		if( !m_strings.empty() )
+		{
+			memcpy( pos, m_strings.data(), m_strings.size() );
+		}
+	}
+
+private:
+	// XML element start
+	virtual void elementStart( const CEGUI::String &element, const CEGUI::XMLAttributes &attributes )
+	{
+		if( element == "property" || element == "Property" )
+		{
+			m_properties.push_back( Add_String( attributes.getValueAsString( "name" ) ) );
+			m_properties.push_back( Add_String( attributes.getValueAsString( "value" ) ) );
+		}
+	}
+
+	// XML element end
+	virtual void elementEnd( const CEGUI::String &element )
+	{
+		if( element == "property" || element == "Property" )
+		{
+			return;
+		}
+
+		const Uint32 property_end = static_cast<Uint32>(m_properties.size() / 2);
+
+		// the root element is written by the XML saving
+		if( element != "level" )
+		{
+			m_elements.push_back( Add_String( element ) );
+			m_elements.push_back( m_first_property );
+			m_elements.push_back( property_end - m_first_property );
+		}
+
+		m_first_property = property_end;
+	}
+
+	// Returns the number of the string and adds it if new
+	Uint32 Add_String( const CEGUI::String &str )
+	{
+		const std::string value = str.c_str();
+		String_Map::const_iterator itr = m_string_map.find( value );
+
+		if( itr != m_string_map.end() )
+		{
+			return itr->second;
+		}
+
+		const Uint32 num = static_cast<Uint32>(m_string_offsets.size());
+		m_string_offsets.push_back( static_cast<Uint32>(m_strings.size()) );
+		m_strings.append( value.c_str(), value.length() + 1 );
+		m_string_map[value] = num;
+
+		return num;
+	}
+
+	// name string and first property and property count for every element
+	vector<Uint32> m_elements;
+	// name and value string for every property
+	vector<Uint32> m_properties;
+	// first property of the next element
+	Uint32 m_first_property;
+
+	// string start in the string data
+	vector<Uint32> m_string_offsets;
+	// zero terminated strings
+	std::string m_strings;
+
+	typedef std::map<std::string, Uint32> String_Map;
+	String_Map m_string_map;
+};
+
+/* *** *** *** *** *** *** *** cLevel_Binary *** *** *** *** *** *** *** *** *** *** */
+
+cLevel_Binary :: cLevel_Binary( void )
+{
+	m_data = NULL;
+	m_size = 0;
+	m_elements = NULL;
+	m_properties = NULL;
+	m_string_offsets = NULL;
+	m_strings = NULL;
+}
+
+cLevel_Binary :: ~cLevel_Binary( void )
+{
+	Clear();
+}
+
+bool cLevel_Binary :: Load( const std::string &filename )
+{
+	Clear();
+
+	const Uint64 source_hash = Get_File_Hash( filename );
+
+	if( !source_hash )
+	{
+		return 0;
+	}
+
+	const std::string cache_filename = Get_Cache_Filename( filename );
+
+	// up to date
+	if( Load_Compiled( cache_filename, source_hash ) )
+	{
+		return 1;
+	}
+
+	if( !Compile( filename ) )
+	{
+		return 0;
+	}
+
+	// used from memory if it can not be cached
+	Save( cache_filename );
+
+	return 1;
+}
+
+bool cLevel_Binary :: Load_Compiled( const std::string &filename, Uint64 source_hash /* = 0 */ )
+{
+	Clear();
+
+	if( !m_file.Open( filename ) )
+	{
+		return 0;
+	}
+
+	if( !Set_Data( m_file.Get_Data(), m_file.Get_Size(), source_hash ) )
+	{
+		debug_print( "Warning : cLevel_Binary : %s is not valid\n", filename.c_str() );
+		Clear();
+		return 0;
+	}
+
+	return 1;
+}
+
+bool cLevel_Binary :: Compile( const std::string &filename )
+{
+	Clear();
+
+	const Uint64 source_hash = Get_File_Hash( filename );
+
+	if( !source_hash )
+	{
+		return 0;
+	}
+
+	cLevel_Binary_Compiler compiler;
+
+	try
+	{
+		Parse_XML_File( compiler, filename, "Level.xsd" );
+	}
+	// the level loading shows the error
+	catch( CEGUI::Exception &ex )
+	{
+		debug_print( "Warning : cLevel_Binary : could not compile %s : %s\n", filename.c_str(), ex.getMessage().c_str() );
+		return 0;
+	}
+
+	compiler.Write( m_buffer, source_hash );
+
+	if( !Set_Data( &m_buffer[0], m_buffer.size(), source_hash ) )
+	{
+		Clear();
+		return 0;
+	}
+
+	return 1;
+}
+
+bool cLevel_Binary :: Save( const std::string &filename ) const
+{
+	if( !m_data )
+	{
+		return 0;
+	}
+
+#ifdef _WIN32
+	FILE *fp = _wfopen( utf8_to_ucs2( filename ).c_str(), L"wb" );
+#else
+	FILE *fp = fopen( filename.c_str(), "wb" );
+#endif
+
+	if( !fp )
+	{
+		debug_print( "Warning : cLevel_Binary : could not create %s\n", filename.c_str() );
+		return 0;
+	}
+
+	const bool success = fwrite( m_data, m_size, 1, fp ) == 1;
+	fclose( fp );
+
+	// don't keep a partial file
+	if( !success )
+	{
+		Delete_File( filename );
+		return 0;
+	}
+
+	return 1;
+}
+
+bool cLevel_Binary :: Save_XML( const std::string &filename ) const
+{
+	if( !m_data )
+	{
+		return 0;
+	}
+
+	cXml_Writer stream;
+
+	// begin
+	stream.Open_Tag( "level" );
+
+	for( unsigned int i = 0; i < Get_Element_Count(); i++ )
+	{
+		const Uint32 *element = m_elements + i * 3;
+
+		stream.Open_Tag( Get_String( element[0] ) );
+
+		for( Uint32 property_num = element[1]; property_num < element[1] + element[2]; property_num++ )
+		{
+			const Uint32 *property = m_properties + property_num * 2;
+
+			Write_Property( stream, Get_String( property[0] ), Get_String( property[1] ) );
+		}
+
+		stream.Close_Tag();
+	}
+
+	// end level
+	stream.Close_Tag();
+
+	if( !stream.Save( filename ) )
+	{
+		printf( "Error : Couldn't write level file %s\n", filename.c_str() );
+		return 0;
+	}
+
+	return 1;
+}
+
+void cLevel_Binary :: Clear( void )
+{
+	m_file.Close();
+	m_buffer.clear();
+
+	m_data = NULL;
+	m_size = 0;
+	m_elements = NULL;
+	m_properties = NULL;
+	m_string_offsets = NULL;
+	m_strings = NULL;
+}
+
+unsigned int cLevel_Binary :: Get_Element_Count( void ) const
+{
+	if( !m_data )
+	{
+		return 0;
+	}
+
+	return reinterpret_cast<const Level_Binary_Header *>(m_data)->m_element_count;
+}
+
+const char *cLevel_Binary :: Get_Element_Name( unsigned int num ) const
+{
+	return Get_String( m_elements[num * 3] );
+}
+
+void cLevel_Binary :: Get_Attributes( unsigned int num, CEGUI::XMLAttributes &attributes ) const
+{
+	const Uint32 *element = m_elements + num * 3;
+
+	for( Uint32 property_num = element[1]; property_num < element[1] + element[2]; property_num++ )
+	{
+		const Uint32 *property = m_properties + property_num * 2;
+
+		attributes.add( reinterpret_cast<const CEGUI::utf8 *>(Get_String( property[0] )), reinterpret_cast<const CEGUI::utf8 *>(Get_String( property[1] )) );
+	}
+}
+
+std::string cLevel_Binary :: Get_Cache_Filename( const std::string &filename )
+{
+	// levels with the same name in different directories
+	const Uint64 path_hash = Get_Data_Hash( filename.c_str(), filename.length() );
+
+	char hash_str[20];
+	sprintf( hash_str, "%08x%08x", static_cast<unsigned int>(path_hash >> 32), static_cast<unsigned int>(path_hash & 0xFFFFFFFF) );
+
+	return pResource_Manager->user_data_dir + USER_LEVEL_CACHE_DIR "/" + Trim_Filename( filename, 0, 0 ) + "_" + hash_str + ".smclvlb";
+}
+
+bool cLevel_Binary :: Set_Data( const char *data, size_t size, Uint64 source_hash )
+{
+	if( size < sizeof( Level_Binary_Header ) )
+	{
+		return 0;
+	}
+
+	const Level_Binary_Header *header = reinterpret_cast<const Level_Binary_Header *>(data);
+
+	if( memcmp( header->m_magic, level_binary_magic, 4 ) != 0 || header->m_version != level_binary_version || ( source_hash && header->m_source_hash != source_hash ) )
+	{
+		return 0;
+	}
+
+	// the size must match exactly
+	const Uint64 tables_size = ( static_cast<Uint64>(header->m_element_count) * 3 + static_cast<Uint64>(header->m_property_count) * 2 + header->m_string_count ) * sizeof( Uint32 );
+
+	if( sizeof( Level_Binary_Header ) + tables_size + header->m_string_size != size )
+	{
+		return 0;
+	}
+
+	const Uint32 *elements = reinterpret_cast<const Uint32 *>(data + sizeof( Level_Binary_Header ));
+	const Uint32 *properties = elements + header->m_element_count * 3;
+	const Uint32 *string_offsets = properties + header->m_property_count * 2;
+	const char *strings = reinterpret_cast<const char *>(string_offsets + header->m_string_count);
+
+	// every string must be terminated
+	if( header->m_string_count && ( !header->m_string_size || strings[header->m_string_size - 1] != 0 ) )
+	{
+		return 0;
+	}
+
+	for( Uint32 i = 0; i < header->m_string_count; i++ )
+	{
+		if( string_offsets[i] >= header->m_string_size )
+		{
+			return 0;
+		}
+	}
+
+	for( Uint32 i = 0; i < header->m_element_count; i++ )
+	{
+		const Uint32 *element = elements + i * 3;
+
+		if( element[0] >= header->m_string_count || static_cast<Uint64>(element[1]) + element[2] > header->m_property_count )
+		{
+			return 0;
+		}
+	}
+
+	for( Uint32 i = 0; i < header->m_property_count * 2; i++ )
+	{
+		if( properties[i] >= header->m_string_count )
+		{
+			return 0;
+		}
+	}
+
+	m_data = data;
+	m_size = size;
+	m_elements = elements;
+	m_properties = properties;
+	m_string_offsets = string_offsets;
+	m_strings = strings;
+
+	return 1;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
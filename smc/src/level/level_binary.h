@@ -0,0 +1,117 @@
+/***************************************************************************
+ * level_binary.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_LEVEL_BINARY_H
+#define SMC_LEVEL_BINARY_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../core/filesystem/filesystem.h"
+// SDL
+#include "SDL.h"
+// CEGUI
+#include "CEGUIXMLAttributes.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Binary *** *** *** *** *** *** *** *** *** *** */
+
+/* Compiled level with the elements and properties of a XML level file
+ * every string is stored once and the elements reference them by number
+ * the compiled file is memory mapped which skips the XML parsing and schema validation
+ * it is kept in the user cache directory and recreated if the hash of the level file changes
+ * the XML level file stays the format for the editor and can be recreated from the compiled level
+*/
+class cLevel_Binary
+{
+public:
+	cLevel_Binary( void );
+	~cLevel_Binary( void );
+
+	/* Load the compiled level from the cache or compile and cache it if the level changed
+	 * returns false if the level could not be parsed
+	*/
+	bool Load( const std::string &filename );
+	/* Map a compiled level file
+	 * source_hash : if not 0 the file must be compiled from a level with this hash
+	*/
+	bool Load_Compiled( const std::string &filename, Uint64 source_hash = 0 );
+	/* Parse and validate the XML level file and compile it
+	 * returns false if the level is not valid
+	*/
+	bool Compile( const std::string &filename );
+	// Save the compiled level
+	bool Save( const std::string &filename ) const;
+	// Save the compiled level as XML level file
+	bool Save_XML( const std::string &filename ) const;
+	// Unload the compiled level
+	void Clear( void );
+
+	// Returns true if a compiled level is loaded
+	inline bool Is_Loaded( void ) const
+	{
+		return m_data != NULL;
+	}
+	// Returns the size of the compiled level data
+	inline size_t Get_Size( void ) const
+	{
+		return m_size;
+	}
+
+	// Returns the number of elements with their properties
+	unsigned int Get_Element_Count( void ) const;
+	// Returns the element name as UTF-8
+	const char *Get_Element_Name( unsigned int num ) const;
+	// Add the element properties to the attributes
+	void Get_Attributes( unsigned int num, CEGUI::XMLAttributes &attributes ) const;
+
+	// Returns the cache filename for the full level filename
+	static std::string Get_Cache_Filename( const std::string &filename );
+
+private:
+	/* Use the data if the header and the tables are valid
+	 * source_hash : if not 0 the data must be compiled from a level with this hash
+	*/
+	bool Set_Data( const char *data, size_t size, Uint64 source_hash );
+	// Returns the string with the given number
+	inline const char *Get_String( Uint32 num ) const
+	{
+		return m_strings + m_string_offsets[num];
+	}
+
+	// mapped compiled level file
+	cMapped_File m_file;
+	// compiled level if not mapped
+	vector<char> m_buffer;
+
+	// compiled level data
+	const char *m_data;
+	size_t m_size;
+	// name string and first property and property count for every element
+	const Uint32 *m_elements;
+	// name and value string for every property
+	const Uint32 *m_properties;
+	// string start in the string data
+	const Uint32 *m_string_offsets;
+	// zero terminated strings
+	const char *m_strings;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -26,6 +26,11 @@
 #include "../core/i18n.h"
 #include "../level/level_player.h"
 #include "../core/filesystem/filesystem.h"
+#include "../core/filesystem/resource_manager.h"
+#include "../core/property_helper.h"
+#include "../level/level_saver.h"
+#include "../level/level_lint.h"
+#include <sstream>
 
 namespace SMC
 {
@@ -42,11 +47,13 @@ cEditor_Level :: cEditor_Level( cSprite_Manager *sprite_manager, cLevel *level )
 
 	m_level = level;
 	m_settings_screen = new cLevel_Settings( sprite_manager, m_level );
+	m_lint = new cLevel_Lint();
 }
 
 cEditor_Level :: ~cEditor_Level( void )
 {
 	delete m_settings_screen;
+	delete m_lint;
 }
 
 void cEditor_Level :: Init( void )
@@ -77,6 +84,12 @@ void cEditor_Level :: Enable( void )
 		editor_enabled = 1;
 	}
 
+	// the editor needs every object
+	if( m_level )
+	{
+		m_level->Stop_Streaming();
+	}
+
 	// reset ground object
 	// player
 	pLevel_Player->Reset_On_Ground();
@@ -125,6 +138,16 @@ void cEditor_Level :: Disable( bool native_mode /* = 0 */ )
 	cEditor::Disable( native_mode );
 }
 
+void cEditor_Level :: Draw( void )
+{
+	cEditor::Draw();
+
+	if( m_enabled )
+	{
+		m_lint->Draw();
+	}
+}
+
 bool cEditor_Level :: Key_Down( SDLKey key )
 {
 	if( !m_enabled )
@@ -144,7 +167,9 @@ bool cEditor_Level :: Key_Down( SDLKey key )
 		float new_camera_posx = 0.0f;
 		float new_camera_posy = 0.0f;
 
-		for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+		const cSprite_List &level_exits = m_sprite_manager->Get_Type_Objects( TYPE_LEVEL_EXIT );
+
+		for( cSprite_List::const_iterator itr = level_exits.begin(); itr != level_exits.end(); ++itr )
 		{
 			cSprite *obj = (*itr);
 
@@ -153,7 +178,7 @@ bool cEditor_Level :: Key_Down( SDLKey key )
 				continue;
 			}
 
-			if( obj->m_type == TYPE_LEVEL_EXIT && new_camera_posx < obj->m_pos_x )
+			if( new_camera_posx < obj->m_pos_x )
 			{
 				new_camera_posx = obj->m_pos_x;
 				new_camera_posy = obj->m_pos_y;
@@ -192,6 +217,7 @@ bool cEditor_Level :: Key_Down( SDLKey key )
 						obj->m_type = mouse_obj->m_type;
 						obj->m_sprite_array = mouse_obj->m_sprite_array;
 						obj->m_can_be_ground = mouse_obj->m_can_be_ground;
+						m_sprite_manager->Update_Type( obj );
 					}
 					// special objects
 					else if( obj->m_type == TYPE_MOVING_PLATFORM )
@@ -230,6 +256,8 @@ void cEditor_Level :: Set_Level( cLevel *level )
 {
 	m_level = level;
 	m_settings_screen->Set_Level( level );
+	// hot spots of the last level
+	m_lint->Clear();
 }
 
 void cEditor_Level :: Set_Sprite_Manager( cSprite_Manager *sprite_manager )
@@ -271,6 +299,10 @@ void cEditor_Level :: Activate_Menu_Item( cEditor_Menu_Object *entry )
 		{
 			Function_Settings();
 		}
+		else if( entry->tags.compare( "performance" ) == 0 )
+		{
+			Function_Performance();
+		}
 		// unknown level function
 		else
 		{
@@ -504,6 +536,93 @@ void cEditor_Level :: Function_Settings( void )
 	Game_Action_Data_End.add( "screen_fadein_speed", "3" );
 }
 
+void cEditor_Level :: Function_Performance( void )
+{
+	// hide the hot spots
+	if( m_lint->Is_Analyzed() )
+	{
+		m_lint->Clear();
+		pHud_Debug->Set_Text( _("Performance analysis disabled") );
+		return;
+	}
+
+	m_lint->Analyze( m_level );
+	m_lint->Print_Report();
+	pHud_Debug->Set_Text( m_lint->Get_Summary(), speedfactor_fps * 8.0f );
+}
+
+std::string cEditor_Level :: Get_Autosave_Filename( void ) const
+{
+	// not loaded
+	if( !pActive_Level->Is_Loaded() )
+	{
+		return "";
+	}
+
+	// the same journal for the compressed and uncompressed level
+	std::string filename = Trim_Filename( pActive_Level->m_level_filename, 0, 1 );
+
+	if( Is_Compressed_File( filename ) )
+	{
+		filename.erase( filename.length() - strlen( COMPRESSED_FILE_TYPE ) );
+	}
+
+	return pResource_Manager->user_data_dir + USER_LEVEL_DIR + "/" + filename + ".journal";
+}
+
+std::string cEditor_Level :: Get_Autosave_Base_Filename( void ) const
+{
+	// a level from the game directory is saved to the user directory
+	if( pActive_Level->m_level_filename.find( pResource_Manager->user_data_dir + USER_LEVEL_DIR + "/" ) == std::string::npos || !File_Exists( pActive_Level->m_level_filename ) )
+	{
+		return "";
+	}
+
+	return pActive_Level->m_level_filename;
+}
+
+void cEditor_Level :: Autosave_Save( void )
+{
+	pActive_Level->Save( 0 );
+}
+
+bool cEditor_Level :: Is_Autosave_Saving( void ) const
+{
+	return pLevel_Saver->Is_Saving();
+}
+
+bool cEditor_Level :: Autosave_Reload( void )
+{
+	if( !pActive_Level->Load( Trim_Filename( pActive_Level->m_level_filename, 0 ) ) )
+	{
+		return 0;
+	}
+
+	pActive_Level->Init();
+	return 1;
+}
+
+std::string cEditor_Level :: Get_Autosave_Player_Data( void ) const
+{
+	return int_to_string( static_cast<int>(pLevel_Player->m_start_pos_x) ) + " " + int_to_string( static_cast<int>(pLevel_Player->m_start_pos_y) ) + " " + Get_Direction_Name( pLevel_Player->m_start_direction );
+}
+
+void cEditor_Level :: Set_Autosave_Player_Data( const std::string &data )
+{
+	std::istringstream stream( data );
+	int pos_x = 0;
+	int pos_y = 0;
+	std::string direction;
+
+	if( !( stream >> pos_x >> pos_y >> direction ) )
+	{
+		return;
+	}
+
+	pLevel_Player->Set_Pos( static_cast<float>(pos_x), static_cast<float>(pos_y), 1 );
+	pLevel_Player->Set_Direction( Get_Direction_Id( direction ), 1 );
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 cEditor_Level *pLevel_Editor = NULL;
@@ -40,6 +40,8 @@ public:
  	*/
 	virtual void Disable( bool native_mode = 0 );
 
+	// Draw the Editor Menus and the performance hot spots
+	virtual void Draw( void );
 
 	/* handle key down event
 	 * returns true if the key was processed
@@ -70,11 +72,24 @@ public:
 	virtual void Function_Delete( void );
 	virtual void Function_Reload( void );
 	virtual void Function_Settings( void );
+	// Toggle the performance analysis of the level
+	void Function_Performance( void );
+
+	// Autosave functions
+	virtual std::string Get_Autosave_Filename( void ) const;
+	virtual std::string Get_Autosave_Base_Filename( void ) const;
+	virtual void Autosave_Save( void );
+	virtual bool Is_Autosave_Saving( void ) const;
+	virtual bool Autosave_Reload( void );
+	virtual std::string Get_Autosave_Player_Data( void ) const;
+	virtual void Set_Autosave_Player_Data( const std::string &data );
 
 	// parent level
 	cLevel *m_level;
 	// Level Settings
 	cLevel_Settings *m_settings_screen;
+	// performance analysis
+	cLevel_Lint *m_lint;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
@@ -0,0 +1,311 @@
+/***************************************************************************
+ * level_generator.cpp  -  generates levels for scaling tests
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../level/level_generator.h"
+#include "../level/level.h"
+#include "../level/level_player.h"
+#include "../level/level_saver.h"
+#include "../core/game_core.h"
+#include "../core/sprite_manager.h"
+#include "../core/property_helper.h"
+#include "../core/filesystem/filesystem.h"
+#include "../core/filesystem/resource_manager.h"
+
+namespace SMC
+{
+
+// massive tiles in each ground floor
+static const unsigned int stress_level_floor_tiles = 500;
+// width of the ground tile image
+static const int stress_level_tile_w = 64;
+// vertical distance of the ground floors
+static const int stress_level_floor_h = 600;
+
+/* *** *** *** *** *** *** *** cStress_Level_Mix *** *** *** *** *** *** *** *** *** *** */
+
+cStress_Level_Mix :: cStress_Level_Mix( void )
+{
+	m_massive = 60;
+	m_enemies = 20;
+	m_platforms = 10;
+	m_emitters = 5;
+	m_boxes = 5;
+}
+
+bool cStress_Level_Mix :: Parse( const std::string &text )
+{
+	std::string::size_type start = 0;
+
+	while( start < text.length() )
+	{
+		std::string::size_type end = text.find( ',', start );
+
+		if( end == std::string::npos )
+		{
+			end = text.length();
+		}
+
+		const std::string entry = text.substr( start, end - start );
+		start = end + 1;
+
+		if( entry.empty() )
+		{
+			continue;
+		}
+
+		const std::string::size_type separator = entry.find( '=' );
+
+		if( separator == std::string::npos )
+		{
+			printf( "Warning : Stress level mix entry %s has no amount\n", entry.c_str() );
+			return 0;
+		}
+
+		const std::string kind = entry.substr( 0, separator );
+		const int amount = string_to_int( entry.substr( separator + 1 ) );
+		const unsigned int value = amount > 0 ? static_cast<unsigned int>(amount) : 0;
+
+		if( kind == "massive" )
+		{
+			m_massive = value;
+		}
+		else if( kind == "enemies" )
+		{
+			m_enemies = value;
+		}
+		else if( kind == "platforms" )
+		{
+			m_platforms = value;
+		}
+		else if( kind == "emitters" )
+		{
+			m_emitters = value;
+		}
+		else if( kind == "boxes" )
+		{
+			m_boxes = value;
+		}
+		else
+		{
+			printf( "Warning : Unknown stress level object kind %s\n", kind.c_str() );
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+unsigned int cStress_Level_Mix :: Get_Total( void ) const
+{
+	return m_massive + m_enemies + m_platforms + m_emitters + m_boxes;
+}
+
+/* *** *** *** *** *** *** *** Stress Level *** *** *** *** *** *** *** *** *** *** */
+
+// Returns the next number from 0 to max - 1 of the generator state
+static unsigned int Stress_Level_Random( Uint32 &state, unsigned int max )
+{
+	// linear congruential generator independent of the game random numbers
+	state = state * 1664525 + 1013904223;
+
+	return max ? ( state >> 8 ) % max : 0;
+}
+
+// Create the object from the attributes and add it to the list
+static void Stress_Level_Add( const std::string &element, CEGUI::XMLAttributes &attributes, cSprite_Manager *sprite_manager, cSprite_List &objects )
+{
+	cSprite *obj = pLevel_Object_Factory->Create( element, attributes, level_engine_version, sprite_manager );
+
+	if( !obj )
+	{
+		printf( "Warning : Stress level could not create %s\n", element.c_str() );
+		return;
+	}
+
+	objects.push_back( obj );
+}
+
+bool Generate_Stress_Level( const std::string &name, unsigned int object_count, const cStress_Level_Mix &mix )
+{
+	const unsigned int total = mix.Get_Total();
+
+	if( !object_count || !total )
+	{
+		printf( "Warning : Stress level %s has no objects\n", name.c_str() );
+		return 0;
+	}
+
+	// replace the old level
+	const std::string filename = pResource_Manager->user_data_dir + USER_LEVEL_DIR + "/" + name + ".smclvl";
+	pLevel_Saver->Wait();
+
+	if( File_Exists( filename ) )
+	{
+		Delete_File( filename );
+	}
+	if( File_Exists( filename + COMPRESSED_FILE_TYPE ) )
+	{
+		Delete_File( filename + COMPRESSED_FILE_TYPE );
+	}
+
+	cLevel *level = new cLevel();
+
+	if( !level->New( name ) )
+	{
+		delete level;
+		return 0;
+	}
+
+	// objects of each kind and a platform also has its path
+	const unsigned int platform_count = ( object_count * mix.m_platforms ) / total / 2;
+	const unsigned int enemy_count = ( object_count * mix.m_enemies ) / total;
+	const unsigned int emitter_count = ( object_count * mix.m_emitters ) / total;
+	const unsigned int box_count = ( object_count * mix.m_boxes ) / total;
+	const unsigned int other_count = platform_count * 2 + enemy_count + emitter_count + box_count;
+	// the remaining objects
+	const unsigned int tile_count = object_count > other_count ? object_count - other_count : 0;
+	// at least one floor to place the other objects
+	const unsigned int floor_count = tile_count ? ( tile_count + stress_level_floor_tiles - 1 ) / stress_level_floor_tiles : 1;
+	const int level_w = stress_level_floor_tiles * stress_level_tile_w;
+
+	Uint32 random_state = object_count;
+	cSprite_List objects;
+	objects.reserve( object_count );
+
+	// ground floors
+	for( unsigned int i = 0; i < tile_count; i++ )
+	{
+		CEGUI::XMLAttributes attributes;
+		attributes.add( "posx", int_to_string( ( i % stress_level_floor_tiles ) * stress_level_tile_w ) );
+		attributes.add( "posy", int_to_string( -static_cast<int>( i / stress_level_floor_tiles ) * stress_level_floor_h ) );
+		attributes.add( "image", "ground/green_1/slider/1/brown/middle.png" );
+		attributes.add( "type", "massive" );
+		Stress_Level_Add( "sprite", attributes, level->m_sprite_manager, objects );
+	}
+
+	// walking enemies
+	for( unsigned int i = 0; i < enemy_count; i++ )
+	{
+		const int floor_y = -static_cast<int>( i % floor_count ) * stress_level_floor_h;
+
+		CEGUI::XMLAttributes attributes;
+		attributes.add( "type", "furball" );
+		attributes.add( "posx", int_to_string( Stress_Level_Random( random_state, level_w - 100 ) + 50 ) );
+		attributes.add( "posy", int_to_string( floor_y - 60 ) );
+		attributes.add( "color", "brown" );
+		attributes.add( "direction", i % 2 ? "left" : "right" );
+		Stress_Level_Add( "enemy", attributes, level->m_sprite_manager, objects );
+	}
+
+	// boxes above the ground
+	for( unsigned int i = 0; i < box_count; i++ )
+	{
+		const int floor_y = -static_cast<int>( i % floor_count ) * stress_level_floor_h;
+
+		CEGUI::XMLAttributes attributes;
+		attributes.add( "type", "spin" );
+		attributes.add( "posx", int_to_string( Stress_Level_Random( random_state, level_w - 100 ) + 50 ) );
+		attributes.add( "posy", int_to_string( floor_y - 200 ) );
+		Stress_Level_Add( "box", attributes, level->m_sprite_manager, objects );
+	}
+
+	// particle emitters
+	for( unsigned int i = 0; i < emitter_count; i++ )
+	{
+		const int floor_y = -static_cast<int>( i % floor_count ) * stress_level_floor_h;
+
+		CEGUI::XMLAttributes attributes;
+		attributes.add( "image", "animation/particles/snowflake_1.png" );
+		attributes.add( "pos_x", int_to_string( Stress_Level_Random( random_state, level_w - 100 ) + 50 ) );
+		attributes.add( "pos_y", int_to_string( floor_y - 400 ) );
+		attributes.add( "pos_z", "0.12" );
+		attributes.add( "size_x", "40" );
+		attributes.add( "size_y", "10" );
+		attributes.add( "emitter_time_to_live", "-1" );
+		attributes.add( "emitter_interval", "0.5" );
+		attributes.add( "quota", "2" );
+		attributes.add( "time_to_live", "2" );
+		attributes.add( "vel", "1" );
+		attributes.add( "angle_start", "80" );
+		attributes.add( "angle_range", "20" );
+		Stress_Level_Add( "particle_emitter", attributes, level->m_sprite_manager, objects );
+	}
+
+	// platforms moving on their path
+	for( unsigned int i = 0; i < platform_count; i++ )
+	{
+		const int floor_y = -static_cast<int>( i % floor_count ) * stress_level_floor_h;
+		const std::string pos_x = int_to_string( Stress_Level_Random( random_state, level_w - 500 ) + 50 );
+		const std::string pos_y = int_to_string( floor_y - 300 );
+		const std::string identifier = "stress_path_" + int_to_string( i );
+
+		CEGUI::XMLAttributes path_attributes;
+		path_attributes.add( "posx", pos_x );
+		path_attributes.add( "posy", pos_y );
+		path_attributes.add( "identifier", identifier );
+		path_attributes.add( "rewind", "1" );
+		path_attributes.add( "segment_0_x1", "0" );
+		path_attributes.add( "segment_0_y1", "0" );
+		path_attributes.add( "segment_0_x2", "300" );
+		path_attributes.add( "segment_0_y2", "0" );
+		Stress_Level_Add( "path", path_attributes, level->m_sprite_manager, objects );
+
+		CEGUI::XMLAttributes attributes;
+		attributes.add( "posx", pos_x );
+		attributes.add( "posy", pos_y );
+		attributes.add( "move_type", "2" );
+		attributes.add( "massive_type", "halfmassive" );
+		attributes.add( "path_identifier", identifier );
+		attributes.add( "speed", "3" );
+		attributes.add( "middle_img_count", "2" );
+		attributes.add( "image_top_left", "ground/green_1/slider/1/brown/left.png" );
+		attributes.add( "image_top_middle", "ground/green_1/slider/1/brown/middle.png" );
+		attributes.add( "image_top_right", "ground/green_1/slider/1/brown/right.png" );
+		Stress_Level_Add( "moving_platform", attributes, level->m_sprite_manager, objects );
+	}
+
+	level->m_sprite_manager->Add_Objects( objects );
+
+	// every floor is reachable by the camera
+	level->m_camera_limits = GL_rect( 0.0f, 0.0f, static_cast<float>(level_w), -static_cast<float>( floor_count * stress_level_floor_h + 1000 ) );
+
+	// the saved player start is taken from the player
+	const float start_pos_x = pLevel_Player->m_start_pos_x;
+	const float start_pos_y = pLevel_Player->m_start_pos_y;
+	pLevel_Player->m_start_pos_x = 100.0f;
+	pLevel_Player->m_start_pos_y = -200.0f;
+
+	level->Save( 0 );
+	pLevel_Saver->Wait();
+
+	pLevel_Player->m_start_pos_x = start_pos_x;
+	pLevel_Player->m_start_pos_y = start_pos_y;
+
+	const std::string saved_filename = level->m_level_filename;
+	const bool success = File_Exists( saved_filename );
+
+	if( success )
+	{
+		printf( "Generated stress level %s with %u objects\n", saved_filename.c_str(), static_cast<unsigned int>(objects.size()) );
+	}
+
+	delete level;
+
+	return success;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,71 @@
+/***************************************************************************
+ * level_generator.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_LEVEL_GENERATOR_H
+#define SMC_LEVEL_GENERATOR_H
+
+#include "../core/global_basic.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cStress_Level_Mix *** *** *** *** *** *** *** *** *** *** */
+
+// Relative amount of each object kind in a generated stress level
+class cStress_Level_Mix
+{
+public:
+	// default mix of mostly ground tiles
+	cStress_Level_Mix( void );
+
+	/* Set the amounts from a comma separated list like "massive=60,enemies=20,platforms=10,emitters=5,boxes=5"
+	 * kinds not in the list keep their amount
+	 * returns false if a kind is unknown
+	*/
+	bool Parse( const std::string &text );
+
+	// Returns the sum of all amounts
+	unsigned int Get_Total( void ) const;
+
+	// massive ground tiles
+	unsigned int m_massive;
+	// walking enemies
+	unsigned int m_enemies;
+	// moving platforms with their path
+	unsigned int m_platforms;
+	// particle emitters
+	unsigned int m_emitters;
+	// boxes
+	unsigned int m_boxes;
+};
+
+/* *** *** *** *** *** *** *** Stress Level *** *** *** *** *** *** *** *** *** *** */
+
+/* Generate a level with the given number of objects for scaling tests
+ * the objects are created from their XML attributes with the level object factory
+ * and saved as a valid level file in the user level directory like the editor does
+ * ground floors are placed above each other and the other objects are spread over the floors
+ * the same count and mix always generate the same level
+ * an existing user level with the name is replaced
+ * name : level name without directory and file type
+ * returns false if the level could not be written
+*/
+bool Generate_Stress_Level( const std::string &name, unsigned int object_count, const cStress_Level_Mix &mix );
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -0,0 +1,269 @@
+/***************************************************************************
+ * level_index.cpp  -  settings of all known level files
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../level/level_index.h"
+#include "../level/level_binary.h"
+#include "../core/game_core.h"
+#include "../core/property_helper.h"
+#include "../core/math/utilities.h"
+#include "../core/filesystem/filesystem.h"
+#include <boost/unordered_set.hpp>
+#include <cstdio>
+#include <cstring>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Info *** *** *** *** *** *** *** *** *** *** */
+
+cLevel_Info :: cLevel_Info( void )
+{
+	m_modified = 0;
+	m_size = 0;
+	m_difficulty = 0;
+	m_land_type = LLT_UNDEFINED;
+}
+
+bool cLevel_Info :: Load( const std::string &filename )
+{
+	m_filename = filename;
+	m_modified = Get_File_Modification_Time( filename );
+	m_size = Get_File_Size( filename );
+	m_author.clear();
+	m_version.clear();
+	m_description.clear();
+	m_difficulty = 0;
+	m_land_type = LLT_UNDEFINED;
+
+	// also caches the compiled level for playing it
+	cLevel_Binary binary;
+
+	if( !binary.Load( filename ) )
+	{
+		return 0;
+	}
+
+	for( unsigned int i = 0; i < binary.Get_Element_Count(); i++ )
+	{
+		if( strcmp( binary.Get_Element_Name( i ), "settings" ) != 0 )
+		{
+			continue;
+		}
+
+		CEGUI::XMLAttributes attributes;
+		binary.Get_Attributes( i, attributes );
+
+		m_author = xml_string_to_string( attributes.getValueAsString( "lvl_author" ).c_str() );
+		m_version = xml_string_to_string( attributes.getValueAsString( "lvl_version" ).c_str() );
+		m_description = xml_string_to_string( attributes.getValueAsString( "lvl_description" ).c_str() );
+		m_difficulty = static_cast<Uint8>(Clamp( attributes.getValueAsInteger( "lvl_difficulty" ), 0, 100 ));
+		m_land_type = Get_Level_Land_Type_Id( attributes.getValueAsString( "lvl_land_type", "undefined" ).c_str() );
+		break;
+	}
+
+	return 1;
+}
+
+/* *** *** *** *** *** *** *** cLevel_Index *** *** *** *** *** *** *** *** *** *** */
+
+// index file identification "SMCX" and version
+static const Uint32 level_index_magic = 0x58434D53;
+static const Uint32 level_index_version = 1;
+
+cLevel_Index :: cLevel_Index( void )
+{
+	m_modified = 0;
+}
+
+cLevel_Index :: ~cLevel_Index( void )
+{
+	//
+}
+
+void cLevel_Index :: Update( const std::string &dir, Level_Info_List &levels )
+{
+	const vector<std::string> lvl_files = Get_Directory_Files( dir, ".smclvl", 0, 0 );
+	boost::unordered_set<std::string> found;
+
+	for( vector<std::string>::const_iterator itr = lvl_files.begin(); itr != lvl_files.end(); ++itr )
+	{
+		const std::string &filename = (*itr);
+		const size_t type_pos = filename.rfind( ".smclvl" );
+
+		// skip other files like the temporary files of a save
+		if( type_pos + strlen( ".smclvl" ) != filename.length() && !Is_Compressed_File( filename ) )
+		{
+			continue;
+		}
+
+		found.insert( filename );
+
+		Info_Map::iterator info_itr = m_levels.find( filename );
+
+		// read new or changed levels
+		if( info_itr == m_levels.end() || info_itr->second.m_modified != Get_File_Modification_Time( filename ) || info_itr->second.m_size != Get_File_Size( filename ) )
+		{
+			cLevel_Info &info = m_levels[filename];
+
+			if( !info.Load( filename ) )
+			{
+				printf( "Warning : Could not read the settings of level %s\n", filename.c_str() );
+			}
+
+			m_modified = 1;
+			levels.push_back( &info );
+			continue;
+		}
+
+		levels.push_back( &info_itr->second );
+	}
+
+	// remove deleted levels
+	const std::string dir_prefix = dir + "/";
+
+	for( Info_Map::iterator itr = m_levels.begin(); itr != m_levels.end(); )
+	{
+		if( itr->first.compare( 0, dir_prefix.length(), dir_prefix ) != 0 || found.find( itr->first ) != found.end() )
+		{
+			++itr;
+			continue;
+		}
+
+		itr = m_levels.erase( itr );
+		m_modified = 1;
+	}
+}
+
+const cLevel_Info *cLevel_Index :: Get( const std::string &filename ) const
+{
+	Info_Map::const_iterator itr = m_levels.find( filename );
+
+	if( itr == m_levels.end() )
+	{
+		return NULL;
+	}
+
+	return &itr->second;
+}
+
+bool cLevel_Index :: Load_Index( const std::string &filename )
+{
+	m_index_filename = filename;
+	// saved again if not loaded
+	m_modified = 1;
+
+	cMapped_File file;
+
+	if( !file.Open( filename ) )
+	{
+		return 0;
+	}
+
+	cIndex_Reader reader( file.Get_Data(), file.Get_Size() );
+
+	// check identification and version
+	if( reader.Read_Uint32() != level_index_magic || reader.Read_Uint32() != level_index_version )
+	{
+		debug_print( "Info : level index %s is outdated\n", filename.c_str() );
+		return 0;
+	}
+
+	const Uint32 count = reader.Read_Uint32();
+	Info_Map levels;
+
+	for( Uint32 i = 0; i < count && reader.m_valid; i++ )
+	{
+		const std::string key = reader.Read_String();
+		cLevel_Info &info = levels[key];
+
+		info.m_filename = key;
+		info.m_modified = static_cast<time_t>(reader.Read_Uint64());
+		info.m_size = static_cast<size_t>(reader.Read_Uint64());
+		info.m_author = reader.Read_String();
+		info.m_version = reader.Read_String();
+		info.m_description = reader.Read_String();
+		info.m_difficulty = static_cast<Uint8>(reader.Read_Uint32());
+		info.m_land_type = static_cast<LevelLandType>(reader.Read_Uint32());
+	}
+
+	if( !reader.m_valid )
+	{
+		printf( "Warning : level index %s is invalid\n", filename.c_str() );
+		return 0;
+	}
+
+	// entries read before are newer
+	for( Info_Map::iterator itr = levels.begin(); itr != levels.end(); ++itr )
+	{
+		m_levels.insert( *itr );
+	}
+
+	m_modified = 0;
+	return 1;
+}
+
+bool cLevel_Index :: Save_Index( void )
+{
+	if( m_index_filename.empty() || !m_modified )
+	{
+		return 1;
+	}
+
+	cIndex_Writer writer;
+	writer.Write_Uint32( level_index_magic );
+	writer.Write_Uint32( level_index_version );
+	writer.Write_Uint32( m_levels.size() );
+
+	for( Info_Map::const_iterator itr = m_levels.begin(); itr != m_levels.end(); ++itr )
+	{
+		const cLevel_Info &info = itr->second;
+
+		writer.Write_String( itr->first );
+		writer.Write_Uint64( static_cast<Uint64>(info.m_modified) );
+		writer.Write_Uint64( static_cast<Uint64>(info.m_size) );
+		writer.Write_String( info.m_author );
+		writer.Write_String( info.m_version );
+		writer.Write_String( info.m_description );
+		writer.Write_Uint32( info.m_difficulty );
+		writer.Write_Uint32( info.m_land_type );
+	}
+
+	FILE *fp = fopen( m_index_filename.c_str(), "wb" );
+
+	if( !fp )
+	{
+		printf( "Warning : could not save level index %s\n", m_index_filename.c_str() );
+		return 0;
+	}
+
+	const bool written = fwrite( writer.m_data.data(), writer.m_data.size(), 1, fp ) == 1;
+	fclose( fp );
+
+	if( !written )
+	{
+		printf( "Warning : could not save level index %s\n", m_index_filename.c_str() );
+		Delete_File( m_index_filename );
+		return 0;
+	}
+
+	m_modified = 0;
+	return 1;
+}
+
+cLevel_Index *pLevel_Index = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
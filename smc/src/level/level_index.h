@@ -0,0 +1,103 @@
+/***************************************************************************
+ * level_index.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_LEVEL_INDEX_H
+#define SMC_LEVEL_INDEX_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+// SDL
+#include "SDL.h"
+// boost
+#include <boost/unordered_map.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Info *** *** *** *** *** *** *** *** *** *** */
+
+// Settings of a level file shown in the level lists
+class cLevel_Info
+{
+public:
+	cLevel_Info( void );
+
+	/* Read the settings from the level file
+	 * returns false if the level could not be parsed
+	*/
+	bool Load( const std::string &filename );
+
+	// full level filename
+	std::string m_filename;
+	// modification time and size of the level file when it was read
+	time_t m_modified;
+	size_t m_size;
+
+	std::string m_author;
+	std::string m_version;
+	std::string m_description;
+	Uint8 m_difficulty;
+	LevelLandType m_land_type;
+};
+
+typedef vector<const cLevel_Info *> Level_Info_List;
+
+/* *** *** *** *** *** *** *** cLevel_Index *** *** *** *** *** *** *** *** *** *** */
+
+/* Settings of all known level files
+ * kept in the user cache directory and only read again from a level file if its modification time or size changed
+ * which allows listing thousands of levels without parsing them
+*/
+class cLevel_Index
+{
+public:
+	cLevel_Index( void );
+	~cLevel_Index( void );
+
+	/* Update the entries of the levels in the directory and add them to the list
+	 * new or changed levels are read and the entries of removed levels are deleted
+	*/
+	void Update( const std::string &dir, Level_Info_List &levels );
+	// Returns the entry of the full level filename or NULL if not indexed
+	const cLevel_Info *Get( const std::string &filename ) const;
+
+	/* Add the entries from the index file
+	 * the file is used for saving afterwards even if it could not be loaded
+	 * returns false if it could not be loaded
+	*/
+	bool Load_Index( const std::string &filename );
+	/* Save all entries to the index file if changed since loading
+	 * returns false if it could not be saved
+	*/
+	bool Save_Index( void );
+
+private:
+	typedef boost::unordered_map<std::string, cLevel_Info> Info_Map;
+	Info_Map m_levels;
+
+	// index file or empty if not used
+	std::string m_index_filename;
+	// if entries changed since the index was loaded
+	bool m_modified;
+};
+
+// Level index
+extern cLevel_Index *pLevel_Index;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
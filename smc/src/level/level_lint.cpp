@@ -0,0 +1,517 @@
+/***************************************************************************
+ * level_lint.cpp  -  performance analysis of a level for the editor
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../level/level_lint.h"
+#include "../level/level.h"
+#include "../level/level_background.h"
+#include "../core/sprite_manager.h"
+#include "../core/object_profiler.h"
+#include "../core/property_helper.h"
+#include "../core/camera.h"
+#include "../core/game_core.h"
+#include "../core/i18n.h"
+#include "../core/filesystem/filesystem.h"
+#include "../objects/sprite.h"
+#include "../video/animation.h"
+#include "../video/gl_surface.h"
+#include "../video/video.h"
+#include "../video/font.h"
+#include "../video/renderer.h"
+// STL
+#include <algorithm>
+#include <set>
+#include <cmath>
+#include <cstdio>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Lint *** *** *** *** *** *** *** *** *** *** */
+
+// object types shown in the report
+static const unsigned int lint_report_types = 15;
+
+// Returns the cell key of the cell position
+static inline Uint64 Lint_Cell_Key( int x, int y )
+{
+	return ( static_cast<Uint64>(static_cast<Uint32>(x)) << 32 ) | static_cast<Uint32>(y);
+}
+
+// Returns the texture memory saved compared to 32 bit rgba
+static inline Uint64 Get_Texture_Memory_Saved( const cGL_Surface *image )
+{
+	if( image->Is_In_Atlas() )
+	{
+		return 0;
+	}
+
+	return static_cast<Uint64>(image->m_tex_w) * image->m_tex_h * 4 - image->Get_Texture_Memory();
+}
+
+// sorts objects by the drawing order
+struct lint_z_sort
+{
+	bool operator()( const cSprite *a, const cSprite *b ) const
+	{
+		return a->m_pos_z < b->m_pos_z;
+	}
+};
+
+// sorts type counts by the most objects first
+struct lint_type_count_sort
+{
+	template<class T> bool operator()( const T &a, const T &b ) const
+	{
+		return a.m_count > b.m_count;
+	}
+};
+
+cLevel_Lint::Cell :: Cell( void )
+{
+	m_collision_objects = 0;
+	m_tiny_tiles = 0;
+	m_particles = 0.0f;
+	m_sounds = 0;
+	m_cost = 0.0f;
+}
+
+cLevel_Lint :: cLevel_Lint( void )
+{
+	m_analyzed = 0;
+	Clear();
+}
+
+cLevel_Lint :: ~cLevel_Lint( void )
+{
+	Clear();
+}
+
+void cLevel_Lint :: Analyze( cLevel *level )
+{
+	Clear();
+
+	if( !level || !level->Is_Loaded() )
+	{
+		return;
+	}
+
+	m_filename = Trim_Filename( level->m_level_filename, 0, 0 );
+
+	const cSprite_List &objects = level->m_sprite_manager->objects;
+	// objects with the type counts
+	vector<unsigned int> type_counts;
+	vector<std::string> type_names;
+	// used textures
+	std::set<GLuint> textures;
+
+	for( cSprite_List::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	{
+		const cSprite *obj = (*itr);
+
+		// spawned objects are created again when played
+		if( obj->m_auto_destroy || obj->m_spawned )
+		{
+			continue;
+		}
+
+		m_objects++;
+
+		const unsigned int type = static_cast<unsigned int>(obj->m_type);
+
+		if( type >= type_counts.size() )
+		{
+			type_counts.resize( type + 1, 0 );
+			type_names.resize( type + 1 );
+		}
+
+		type_counts[type]++;
+		type_names[type] = obj->m_type_name;
+
+		Cell &cell = Get_Cell( obj->m_col_rect.m_x + obj->m_col_rect.m_w * 0.5f, obj->m_col_rect.m_y + obj->m_col_rect.m_h * 0.5f );
+
+		// collision candidates of the grid
+		if( obj->m_massive_type != MASS_PASSIVE || obj->m_sprite_array == ARRAY_ENEMY || obj->m_sprite_array == ARRAY_ACTIVE )
+		{
+			cell.m_collision_objects++;
+			m_collision_objects++;
+
+			if( obj->m_massive_type == MASS_MASSIVE && obj->m_col_rect.m_w < m_tiny_tile_size && obj->m_col_rect.m_h < m_tiny_tile_size )
+			{
+				cell.m_tiny_tiles++;
+				m_tiny_tiles++;
+			}
+		}
+
+		if( obj->m_type == TYPE_PARTICLE_EMITTER )
+		{
+			const cParticle_Emitter *emitter = static_cast<const cParticle_Emitter *>(obj);
+			// every iteration emits the quota and they live for their time
+			const float interval = std::max( emitter->m_emitter_iteration_interval, 0.001f );
+			const float particles = emitter->m_emitter_quota * ( emitter->m_time_to_live + emitter->m_time_to_live_rand * 0.5f ) / interval;
+
+			cell.m_particles += particles;
+			m_particles += particles;
+			m_emitters++;
+		}
+		else if( obj->m_type == TYPE_SOUND )
+		{
+			cell.m_sounds++;
+			m_sounds++;
+		}
+
+		// texture memory
+		if( obj->m_image && textures.insert( obj->m_image->m_image ).second )
+		{
+			if( obj->m_image->m_atlas_size )
+			{
+				m_texture_memory += obj->m_image->m_atlas_size * obj->m_image->m_atlas_size * 4;
+			}
+			else
+			{
+				m_texture_memory += obj->m_image->Get_Texture_Memory();
+				m_texture_memory_saved += Get_Texture_Memory_Saved( obj->m_image );
+			}
+		}
+
+		// measured costs
+		float time = 0.0f;
+
+		if( pObject_Profiler && pObject_Profiler->Get_Object_Time( obj->m_type, time ) )
+		{
+			cell.m_cost += time;
+			m_cost += time;
+			m_cost_measured = 1;
+		}
+	}
+
+	// backgrounds
+	for( vector<cBackground *>::const_iterator itr = level->m_background_manager->objects.begin(); itr != level->m_background_manager->objects.end(); ++itr )
+	{
+		const cBackground *background = (*itr);
+
+		if( !background->m_image_1 )
+		{
+			continue;
+		}
+
+		if( textures.insert( background->m_image_1->m_image ).second )
+		{
+			m_texture_memory += background->m_image_1->Get_Texture_Memory();
+			m_texture_memory_saved += Get_Texture_Memory_Saved( background->m_image_1 );
+		}
+
+		// was scaled down to the maximum or uses all of it
+		if( static_cast<GLint>(background->m_image_1->m_tex_w) >= pVideo->m_max_texture_size || static_cast<GLint>(background->m_image_1->m_tex_h) >= pVideo->m_max_texture_size )
+		{
+			m_large_backgrounds++;
+			printf( "Level lint : background %s is at the maximum texture size %d\n", background->m_image_1_filename.c_str(), pVideo->m_max_texture_size );
+		}
+	}
+
+	m_textures = textures.size();
+
+	for( unsigned int i = 0; i < type_counts.size(); i++ )
+	{
+		if( !type_counts[i] )
+		{
+			continue;
+		}
+
+		Type_Count count;
+		count.m_name = type_names[i];
+		count.m_count = type_counts[i];
+		m_type_counts.push_back( count );
+	}
+
+	std::sort( m_type_counts.begin(), m_type_counts.end(), lint_type_count_sort() );
+
+	// cells over the limits
+	for( Cell_Map::const_iterator itr = m_cells.begin(); itr != m_cells.end(); ++itr )
+	{
+		const Cell &cell = itr->second;
+		const int cell_x = static_cast<int>(static_cast<Uint32>(itr->first >> 32));
+		const int cell_y = static_cast<int>(static_cast<Uint32>(itr->first & 0xFFFFFFFF));
+
+		m_max_cell_collisions = std::max( m_max_cell_collisions, cell.m_collision_objects );
+
+		std::string text;
+
+		if( cell.m_collision_objects >= m_max_cell_collision_objects )
+		{
+			text += int_to_string( cell.m_collision_objects ) + " " + _("collision objects");
+
+			if( cell.m_tiny_tiles )
+			{
+				text += " (" + int_to_string( cell.m_tiny_tiles ) + " " + _("tiny tiles") + ")";
+			}
+		}
+		if( cell.m_particles >= m_max_cell_particles )
+		{
+			if( !text.empty() )
+			{
+				text += ", ";
+			}
+
+			text += int_to_string( static_cast<int>(cell.m_particles) ) + " " + _("particles");
+		}
+		if( cell.m_sounds >= m_max_cell_sounds )
+		{
+			if( !text.empty() )
+			{
+				text += ", ";
+			}
+
+			text += int_to_string( cell.m_sounds ) + " " + _("sounds");
+		}
+
+		if( text.empty() )
+		{
+			continue;
+		}
+
+		if( cell.m_cost > 0.0f )
+		{
+			text += ", " + float_to_string( cell.m_cost, 1 ) + " us";
+		}
+
+		Add_Hot_Spot( GL_rect( static_cast<float>(cell_x * static_cast<int>(m_cell_size)), static_cast<float>(cell_y * static_cast<int>(m_cell_size)), static_cast<float>(m_cell_size), static_cast<float>(m_cell_size) ), text );
+	}
+
+	Analyze_Draw_Calls( objects );
+
+	m_analyzed = 1;
+}
+
+void cLevel_Lint :: Clear( void )
+{
+	for( Hot_Spot_List::iterator itr = m_hot_spots.begin(); itr != m_hot_spots.end(); ++itr )
+	{
+		if( (*itr).m_label )
+		{
+			delete (*itr).m_label;
+		}
+	}
+
+	m_hot_spots.clear();
+	m_cells.clear();
+	m_type_counts.clear();
+	m_filename.clear();
+
+	m_analyzed = 0;
+	m_objects = 0;
+	m_collision_objects = 0;
+	m_max_cell_collisions = 0;
+	m_tiny_tiles = 0;
+	m_particles = 0.0f;
+	m_emitters = 0;
+	m_sounds = 0;
+	m_texture_memory = 0;
+	m_texture_memory_saved = 0;
+	m_textures = 0;
+	m_large_backgrounds = 0;
+	m_max_draw_calls = 0;
+	m_screens = 0;
+	m_cost = 0.0f;
+	m_cost_measured = 0;
+}
+
+std::string cLevel_Lint :: Get_Summary( void ) const
+{
+	if( !m_analyzed )
+	{
+		return _("Level not analyzed");
+	}
+
+	std::string text = int_to_string( m_hot_spots.size() ) + " " + _("hot spots") + ", " + int_to_string( m_objects ) + " " + _("objects") + ", "
+		+ int_to_string( static_cast<int>(m_particles) ) + " " + _("particles") + ", " + float_to_string( m_texture_memory / 1048576.0f, 1 ) + " MB, "
+		+ int_to_string( m_max_draw_calls ) + " " + _("draw calls");
+
+	if( m_cost_measured )
+	{
+		text += ", " + float_to_string( m_cost / 1000.0f, 2 ) + " ms";
+	}
+
+	return text;
+}
+
+void cLevel_Lint :: Print_Report( void ) const
+{
+	if( !m_analyzed )
+	{
+		return;
+	}
+
+	printf( "Level lint : %s\n", m_filename.c_str() );
+	printf( "  objects : %u\n", m_objects );
+
+	for( unsigned int i = 0; i < m_type_counts.size() && i < lint_report_types; i++ )
+	{
+		printf( "    %-24s %u\n", m_type_counts[i].m_name.c_str(), m_type_counts[i].m_count );
+	}
+
+	const unsigned int used_cells = m_cells.size();
+
+	printf( "  collision objects : %u, %.1f per used %ux%u cell, at most %u\n", m_collision_objects, used_cells ? static_cast<float>(m_collision_objects) / used_cells : 0.0f, m_cell_size, m_cell_size, m_max_cell_collisions );
+	printf( "  tiny massive tiles : %u\n", m_tiny_tiles );
+	printf( "  particle emitters : %u with about %d living particles\n", m_emitters, static_cast<int>(m_particles) );
+	printf( "  random sounds : %u\n", m_sounds );
+	printf( "  textures : %u using about %.1f MB, %.1f MB saved by the texture formats, %u backgrounds at the maximum size\n", m_textures, m_texture_memory / 1048576.0f, m_texture_memory_saved / 1048576.0f, m_large_backgrounds );
+	printf( "  draw calls : at most %u of %u screens\n", m_max_draw_calls, m_screens );
+
+	if( m_cost_measured )
+	{
+		printf( "  measured update cost : %.2f ms a frame\n", m_cost / 1000.0f );
+	}
+	else
+	{
+		printf( "  measured update cost : play the level with the performance debug mode to measure it\n" );
+	}
+
+	for( Hot_Spot_List::const_iterator itr = m_hot_spots.begin(); itr != m_hot_spots.end(); ++itr )
+	{
+		printf( "  hot spot %.0f,%.0f : %s\n", (*itr).m_rect.m_x, (*itr).m_rect.m_y, (*itr).m_text.c_str() );
+	}
+}
+
+void cLevel_Lint :: Draw( void ) const
+{
+	if( !m_analyzed )
+	{
+		return;
+	}
+
+	const GL_rect camera_rect( pActive_Camera->m_x, pActive_Camera->m_y, static_cast<float>(game_res_w), static_cast<float>(game_res_h) );
+	const Color color = Color( static_cast<Uint8>(200), 0, 0, 64 );
+	const Color border_color = Color( static_cast<Uint8>(255), 40, 40, 192 );
+
+	for( Hot_Spot_List::const_iterator itr = m_hot_spots.begin(); itr != m_hot_spots.end(); ++itr )
+	{
+		const Hot_Spot &hot_spot = (*itr);
+
+		if( !hot_spot.m_rect.Intersects( camera_rect ) )
+		{
+			continue;
+		}
+
+		const float x = hot_spot.m_rect.m_x - pActive_Camera->m_x;
+		const float y = hot_spot.m_rect.m_y - pActive_Camera->m_y;
+
+		pVideo->Draw_Rect( x, y, hot_spot.m_rect.m_w, hot_spot.m_rect.m_h, 0.123f, &color );
+		// border
+		pVideo->Draw_Line( x, y, x + hot_spot.m_rect.m_w, y, 0.1231f, &border_color );
+		pVideo->Draw_Line( x, y + hot_spot.m_rect.m_h, x + hot_spot.m_rect.m_w, y + hot_spot.m_rect.m_h, 0.1231f, &border_color );
+		pVideo->Draw_Line( x, y, x, y + hot_spot.m_rect.m_h, 0.1231f, &border_color );
+		pVideo->Draw_Line( x + hot_spot.m_rect.m_w, y, x + hot_spot.m_rect.m_w, y + hot_spot.m_rect.m_h, 0.1231f, &border_color );
+
+		if( hot_spot.m_label )
+		{
+			hot_spot.m_label->Blit( x + 4.0f, y + 4.0f, 0.1232f );
+		}
+	}
+}
+
+cLevel_Lint::Cell &cLevel_Lint :: Get_Cell( float x, float y )
+{
+	const int cell_x = static_cast<int>(std::floor( x / m_cell_size ));
+	const int cell_y = static_cast<int>(std::floor( y / m_cell_size ));
+
+	return m_cells[Lint_Cell_Key( cell_x, cell_y )];
+}
+
+void cLevel_Lint :: Analyze_Draw_Calls( const vector<cSprite *> &objects )
+{
+	// objects of every screen
+	typedef std::map<Uint64, cSprite_List> Screen_Map;
+	Screen_Map screens;
+
+	for( cSprite_List::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	{
+		cSprite *obj = (*itr);
+
+		if( obj->m_auto_destroy || obj->m_spawned || !obj->m_image )
+		{
+			continue;
+		}
+
+		const int x1 = static_cast<int>(std::floor( obj->m_rect.m_x / game_res_w ));
+		const int y1 = static_cast<int>(std::floor( obj->m_rect.m_y / game_res_h ));
+		const int x2 = static_cast<int>(std::floor( ( obj->m_rect.m_x + obj->m_rect.m_w ) / game_res_w ));
+		const int y2 = static_cast<int>(std::floor( ( obj->m_rect.m_y + obj->m_rect.m_h ) / game_res_h ));
+
+		// huge objects are drawn in every screen anyway
+		if( x2 - x1 > 4 || y2 - y1 > 4 )
+		{
+			continue;
+		}
+
+		for( int y = y1; y <= y2; y++ )
+		{
+			for( int x = x1; x <= x2; x++ )
+			{
+				screens[Lint_Cell_Key( x, y )].push_back( obj );
+			}
+		}
+	}
+
+	m_screens = screens.size();
+
+	for( Screen_Map::iterator itr = screens.begin(); itr != screens.end(); ++itr )
+	{
+		cSprite_List &screen_objects = itr->second;
+
+		// the renderer draws by depth and starts a new batch with every texture change
+		std::sort( screen_objects.begin(), screen_objects.end(), lint_z_sort() );
+
+		unsigned int draw_calls = 0;
+		GLuint last_texture = 0;
+
+		for( cSprite_List::const_iterator obj_itr = screen_objects.begin(); obj_itr != screen_objects.end(); ++obj_itr )
+		{
+			const GLuint texture = (*obj_itr)->m_image->m_image;
+
+			if( !draw_calls || texture != last_texture )
+			{
+				draw_calls++;
+				last_texture = texture;
+			}
+		}
+
+		m_max_draw_calls = std::max( m_max_draw_calls, draw_calls );
+
+		if( draw_calls < m_max_screen_draw_calls )
+		{
+			continue;
+		}
+
+		const int screen_x = static_cast<int>(static_cast<Uint32>(itr->first >> 32));
+		const int screen_y = static_cast<int>(static_cast<Uint32>(itr->first & 0xFFFFFFFF));
+
+		Add_Hot_Spot( GL_rect( static_cast<float>(screen_x * game_res_w), static_cast<float>(screen_y * game_res_h), static_cast<float>(game_res_w), static_cast<float>(game_res_h) ), int_to_string( draw_calls ) + " " + _("draw calls") );
+	}
+}
+
+void cLevel_Lint :: Add_Hot_Spot( const GL_rect &rect, const std::string &text )
+{
+	Hot_Spot hot_spot;
+	hot_spot.m_rect = rect;
+	hot_spot.m_text = text;
+	hot_spot.m_label = pFont->Render_Text( pFont->m_font_small, text, white );
+
+	m_hot_spots.push_back( hot_spot );
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,156 @@
+/***************************************************************************
+ * level_lint.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_LEVEL_LINT_H
+#define SMC_LEVEL_LINT_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../core/math/rect.h"
+// SDL
+#include "SDL.h"
+// STL
+#include <map>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Lint *** *** *** *** *** *** *** *** *** *** */
+
+/* Performance analysis of a level for the editor
+ * counts the objects by type and estimates the collision candidates of the grid cells,
+ * the living particles, the texture memory and the draw calls of every screen
+ * areas over the limits are shown as hot spots on the map
+ * with the measured object update costs if the level was played with the object profiler
+*/
+class cLevel_Lint
+{
+public:
+	cLevel_Lint( void );
+	~cLevel_Lint( void );
+
+	// Analyze the level objects and backgrounds
+	void Analyze( cLevel *level );
+	// Delete the results
+	void Clear( void );
+
+	// Returns a short summary for the debug text
+	std::string Get_Summary( void ) const;
+	// Print the full report
+	void Print_Report( void ) const;
+
+	// Draw the hot spots in the visible area
+	void Draw( void ) const;
+
+	// Returns true if analyzed
+	inline bool Is_Analyzed( void ) const
+	{
+		return m_analyzed;
+	}
+
+	// size of the analyzed cells
+	static const unsigned int m_cell_size = 256;
+	// collision objects in a cell to be a hot spot
+	static const unsigned int m_max_cell_collision_objects = 48;
+	// massive objects smaller than this in both dimensions are counted as tiny tiles
+	static const unsigned int m_tiny_tile_size = 16;
+	// estimated living particles in a cell to be a hot spot
+	static const unsigned int m_max_cell_particles = 1500;
+	// random sounds in a cell to be a hot spot
+	static const unsigned int m_max_cell_sounds = 4;
+	// estimated draw calls of a screen to be a hot spot
+	static const unsigned int m_max_screen_draw_calls = 150;
+
+private:
+	// analyzed area
+	struct Cell
+	{
+		Cell( void );
+
+		// objects which can collide
+		unsigned int m_collision_objects;
+		// tiny massive objects
+		unsigned int m_tiny_tiles;
+		// estimated living particles
+		float m_particles;
+		// random sound objects
+		unsigned int m_sounds;
+		// measured update microseconds of the objects in a frame
+		float m_cost;
+	};
+
+	typedef std::map<Uint64, Cell> Cell_Map;
+
+	// object count of a sprite type
+	struct Type_Count
+	{
+		std::string m_name;
+		unsigned int m_count;
+	};
+
+	// area over the limits
+	struct Hot_Spot
+	{
+		GL_rect m_rect;
+		std::string m_text;
+		// rendered text
+		cGL_Surface *m_label;
+	};
+
+	typedef vector<Hot_Spot> Hot_Spot_List;
+
+	// Returns the cell of the position
+	Cell &Get_Cell( float x, float y );
+	// Estimate the draw calls of every screen and add the hot spots
+	void Analyze_Draw_Calls( const vector<cSprite *> &objects );
+	// Add a hot spot with the text
+	void Add_Hot_Spot( const GL_rect &rect, const std::string &text );
+
+	bool m_analyzed;
+	// level filename
+	std::string m_filename;
+
+	Cell_Map m_cells;
+	Hot_Spot_List m_hot_spots;
+	// object count of every sprite type used
+	vector<Type_Count> m_type_counts;
+
+	unsigned int m_objects;
+	unsigned int m_collision_objects;
+	unsigned int m_max_cell_collisions;
+	unsigned int m_tiny_tiles;
+	float m_particles;
+	unsigned int m_emitters;
+	unsigned int m_sounds;
+	// estimated bytes of the used textures
+	Uint64 m_texture_memory;
+	// texture memory saved by the smaller texture formats
+	Uint64 m_texture_memory_saved;
+	unsigned int m_textures;
+	// background images at the maximum texture size
+	unsigned int m_large_backgrounds;
+	// estimated draw calls of the most expensive screen
+	unsigned int m_max_draw_calls;
+	unsigned int m_screens;
+	// measured update microseconds of all objects in a frame
+	float m_cost;
+	bool m_cost_measured;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -14,11 +14,14 @@
 */
 
 #include "../level/level_manager.h"
+#include "../level/level_binary.h"
 #include "../core/main.h"
 #include "../core/game_core.h"
 #include "../core/filesystem/filesystem.h"
 #include "../overworld/overworld.h"
 #include "../core/framerate.h"
+#include "../core/profiler.h"
+#include "../core/engine_context.h"
 #include "../objects/path.h"
 #include "../audio/audio.h"
 #include "../level/level_editor.h"
@@ -28,6 +31,9 @@
 namespace SMC
 {
 
+// memory used by the kept compiled levels before the least recently used are deleted
+static const size_t level_snapshots_max_size = 16 * 1024 * 1024;
+
 /* *** *** *** *** *** cLevel_Manager *** *** *** *** *** *** *** *** *** *** *** *** */
 
 cLevel_Manager :: cLevel_Manager( void )
@@ -46,12 +52,23 @@ cLevel_Manager :: cLevel_Manager( void )
 	Add( pActive_Level );
 
 	m_camera->Set_Sprite_Manager( pActive_Level->m_sprite_manager );
+
+	m_tick_camera_x = 0.0f;
+	m_tick_camera_y = 0.0f;
+	m_last_camera_x = 0.0f;
+	m_last_camera_y = 0.0f;
+	m_draw_camera_x = 0.0f;
+	m_draw_camera_y = 0.0f;
+	m_draw_camera = 0;
+
+	m_snapshots_size = 0;
 }
 
 cLevel_Manager :: ~cLevel_Manager( void )
 {
 	Delete_All();
 	delete m_camera;
+	Clear_Snapshots();
 }
 
 void cLevel_Manager :: Init( void )
@@ -122,6 +139,7 @@ cLevel *cLevel_Manager :: Load( std::string filename )
 	}
 	
 	// load
+	cProfiler_Scope profile_scope( "level load" );
 	level = new cLevel();
 	level->Load( filename );
 	Add( level );
@@ -164,7 +182,8 @@ bool cLevel_Manager :: Get_Path( std::string &filename, bool check_only_user_dir
 	// use new file type as default
 	filename.insert( filename.length(), ".smclvl" );
 
-	if( File_Exists( filename ) )
+	// or compressed
+	if( pResource_Manager->Find_File( filename ) )
 	{
 		// found
 		return 1;
@@ -174,7 +193,7 @@ bool cLevel_Manager :: Get_Path( std::string &filename, bool check_only_user_dir
 	filename.erase( filename.rfind( "." ) );
 	filename.insert( filename.length(), ".txt" );
 
-	if( File_Exists( filename ) )
+	if( pResource_Manager->File_Exists( filename ) )
 	{
 		// found
 		return 1;
@@ -195,7 +214,8 @@ bool cLevel_Manager :: Get_Path( std::string &filename, bool check_only_user_dir
 			filename.insert( 0, DATA_DIR "/" GAME_LEVEL_DIR "/" );
 		}
 
-		if( File_Exists( filename ) )
+		// or compressed
+		if( pResource_Manager->Find_File( filename ) )
 		{
 			// found
 			return 1;
@@ -205,7 +225,7 @@ bool cLevel_Manager :: Get_Path( std::string &filename, bool check_only_user_dir
 		filename.erase( filename.rfind( "." ) );
 		filename.insert( filename.length(), ".txt" );
 
-		if( File_Exists( filename ) )
+		if( pResource_Manager->File_Exists( filename ) )
 		{
 			// found
 			return 1;
@@ -221,103 +241,177 @@ bool cLevel_Manager :: Get_Path( std::string &filename, bool check_only_user_dir
 
 void cLevel_Manager :: Update( void )
 {
-	// input
-	pActive_Level->Process_Input();
-	pLevel_Editor->Process_Input();
+	cProfiler_Scope profile_scope( "level update" );
 
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_UPDATE_PROCESS_INPUT]->Update();
+	// the player, hud and camera of the active level
+	cEngine_Context *context = pActive_Level->m_sprite_manager->m_context;
+	cLevel_Player *level_player = context->Get_Level_Player();
 
-	// update
-	pActive_Level->Update();
+	// input
+	{
+		cProfiler_Scope profile_input( "process input" );
+		pActive_Level->Process_Input();
+		pLevel_Editor->Process_Input();
+	}
 
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_UPDATE_LEVEL]->Update();
+	// update
+	{
+		cProfiler_Scope profile_level( "level" );
+		pActive_Level->Update();
+	}
 
 	// editor
-	pLevel_Editor->Update();
-
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_UPDATE_LEVEL_EDITOR]->Update();
+	{
+		cProfiler_Scope profile_editor( "level editor" );
+		pLevel_Editor->Update();
+	}
 
 	// hud
-	pHud_Manager->Update();
-
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_UPDATE_HUD]->Update();
+	{
+		cProfiler_Scope profile_hud( "hud" );
+		context->Get_Hud_Manager()->Update();
+	}
 
 	// player
-	pLevel_Player->Update();
-
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_UPDATE_PLAYER]->Update();
+	{
+		cProfiler_Scope profile_player( "player" );
+		level_player->Update();
+	}
 
 	// player collisions
 	if( !editor_enabled )
 	{
-		pLevel_Player->Collide_Move();
-		pLevel_Player->Handle_Collisions();
+		cProfiler_Scope profile_player_collisions( "player collisions" );
+		level_player->Collide_Move();
+		level_player->Handle_Collisions();
 	}
 
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_UPDATE_PLAYER_COLLISIONS]->Update();
-
 	// late update for level objects
-	pActive_Level->Update_Late();
+	{
+		cProfiler_Scope profile_late( "level late" );
+		pActive_Level->Update_Late();
+	}
 
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_UPDATE_LATE_LEVEL]->Update();
+	{
+		cProfiler_Scope profile_collisions( "level collisions" );
 
-	// level collisions
-	if( !editor_enabled )
+		// level collisions
+		if( !editor_enabled )
+		{
+			pActive_Level->m_sprite_manager->Handle_Collision_Items();
+		}
+
+		// delete the objects destroyed in this frame
+		pActive_Level->m_sprite_manager->Delete_Destroyed();
+	}
+
+	// Camera ( update after new player position was set )
+	{
+		cProfiler_Scope profile_camera( "camera" );
+		context->Get_Camera()->Update();
+	}
+}
+
+void cLevel_Manager :: Update_Fixed_Timestep( void )
+{
+	// continue from the updated camera position if it was not moved since drawing
+	if( m_draw_camera && pActive_Camera->m_x == m_draw_camera_x && pActive_Camera->m_y == m_draw_camera_y )
 	{
-		pActive_Level->m_sprite_manager->Handle_Collision_Items();
+		pActive_Camera->m_x = m_last_camera_x;
+		pActive_Camera->m_y = m_last_camera_y;
 	}
 
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_UPDATE_LEVEL_COLLISIONS]->Update();
+	m_draw_camera = 0;
 
-	// Camera ( update after new player position was set )
-	pActive_Camera->Update();
+	const unsigned int ticks = pFramerate->Update_Fixed_Ticks();
+	// the speed factor of the frame is used again after the ticks
+	const float frame_speed_factor = pFramerate->m_speed_factor;
+	pFramerate->m_speed_factor = pFramerate->Get_Fixed_Tick_Speed_Factor();
+
+	for( unsigned int i = 0; i < ticks; i++ )
+	{
+		pFramerate->m_fixed_tick++;
+
+		m_tick_camera_x = pActive_Camera->m_x;
+		m_tick_camera_y = pActive_Camera->m_y;
+		pActive_Level->m_sprite_manager->Save_Tick_Positions( pFramerate->m_fixed_tick );
+
+		cLevel_Player *level_player = pActive_Level->m_sprite_manager->m_context->Get_Level_Player();
+		level_player->m_tick_pos_x = level_player->m_pos_x;
+		level_player->m_tick_pos_y = level_player->m_pos_y;
+		level_player->m_tick = pFramerate->m_fixed_tick;
+
+		Update();
+
+		m_last_camera_x = pActive_Camera->m_x;
+		m_last_camera_y = pActive_Camera->m_y;
+
+		// the level or game mode changes
+		if( Game_Action != GA_NONE )
+		{
+			pFramerate->m_interpolation = 1.0f;
+			break;
+		}
+	}
+
+	pFramerate->m_speed_factor = frame_speed_factor;
+
+	// no ticks updated yet or the editor shows the real positions
+	if( !pFramerate->m_fixed_tick || editor_level_enabled || pFramerate->m_interpolation >= 1.0f )
+	{
+		pFramerate->m_interpolation = 1.0f;
+		return;
+	}
+
+	// camera between the last ticks if it was not moved outside of them
+	if( pActive_Camera->m_x == m_last_camera_x && pActive_Camera->m_y == m_last_camera_y )
+	{
+		const float back = 1.0f - pFramerate->m_interpolation;
 
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_UPDATE_CAMERA]->Update();
+		m_draw_camera_x = m_last_camera_x + ( m_tick_camera_x - m_last_camera_x ) * back;
+		m_draw_camera_y = m_last_camera_y + ( m_tick_camera_y - m_last_camera_y ) * back;
+		pActive_Camera->m_x = m_draw_camera_x;
+		pActive_Camera->m_y = m_draw_camera_y;
+		m_draw_camera = 1;
+	}
 }
 
 void cLevel_Manager :: Draw( void )
 {
+	cProfiler_Scope profile_scope( "level draw" );
+
 	// clear
 	pVideo->Clear_Screen();
 
 	// draw level layer 1
-	pActive_Level->Draw_Layer_1();
-
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_DRAW_LEVEL_LAYER1]->Update();
+	{
+		cProfiler_Scope profile_layer_1( "layer 1" );
+		pActive_Level->Draw_Layer_1();
+	}
 
 	// player draw
-	pLevel_Player->Draw();
-
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_DRAW_LEVEL_PLAYER]->Update();
+	{
+		cProfiler_Scope profile_player( "player" );
+		pActive_Level->m_sprite_manager->m_context->Get_Level_Player()->Draw();
+	}
 
 	// draw level layer 2
-	pActive_Level->Draw_Layer_2();
-
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_DRAW_LEVEL_LAYER2]->Update();
+	{
+		cProfiler_Scope profile_layer_2( "layer 2" );
+		pActive_Level->Draw_Layer_2();
+	}
 
 	// hud
-	pHud_Manager->Draw();
-
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_DRAW_LEVEL_HUD]->Update();
+	{
+		cProfiler_Scope profile_hud( "hud" );
+		pHud_Manager->Draw();
+	}
 
 	// level editor
-	pLevel_Editor->Draw();
-
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_DRAW_LEVEL_EDITOR]->Update();
+	{
+		cProfiler_Scope profile_editor( "level editor" );
+		pLevel_Editor->Draw();
+	}
 }
 
 void cLevel_Manager :: Finish_Level( bool win_music /* = 0 */ )
@@ -439,15 +533,12 @@ void cLevel_Manager :: Goto_Sub_Level( std::string str_level, const std::string
 							pActive_Camera->Set_Pos( start_path_pos_x + path_state.m_pos_x, start_path_pos_y + path_state.m_pos_y );
 
 							// keep particles on screen
-							for( cSprite_List::iterator itr = pActive_Level->m_sprite_manager->objects.begin(); itr != pActive_Level->m_sprite_manager->objects.end(); ++itr )
-							{
-								cSprite *obj = (*itr);
+							const cSprite_List &emitters = pActive_Level->m_sprite_manager->Get_Type_Objects( TYPE_PARTICLE_EMITTER );
 
-								if( obj->m_type == TYPE_PARTICLE_EMITTER )
-								{
-									cParticle_Emitter *emitter = static_cast<cParticle_Emitter *>(obj);
-									emitter->Update_Position();
-								}
+							for( cSprite_List::const_iterator itr = emitters.begin(); itr != emitters.end(); ++itr )
+							{
+								cParticle_Emitter *emitter = static_cast<cParticle_Emitter *>(*itr);
+								emitter->Update_Position();
 							}
 
 							// draw
@@ -511,6 +602,99 @@ void cLevel_Manager :: Goto_Sub_Level( std::string str_level, const std::string
 	}
 }
 
+cLevel_Binary *cLevel_Manager :: Get_Snapshot( const std::string &filename )
+{
+	for( unsigned int i = 0; i < m_snapshots.size(); i++ )
+	{
+		if( m_snapshots[i].m_filename.compare( filename ) != 0 )
+		{
+			continue;
+		}
+
+		// changed in the editor or outside of the game
+		if( Get_File_Size( filename ) != m_snapshots[i].m_size || Get_File_Modification_Time( filename ) != m_snapshots[i].m_modified )
+		{
+			Delete_Snapshot( i );
+			return NULL;
+		}
+
+		// most recently used
+		if( i > 0 )
+		{
+			const Level_Snapshot snapshot = m_snapshots[i];
+			m_snapshots.erase( m_snapshots.begin() + i );
+			m_snapshots.insert( m_snapshots.begin(), snapshot );
+		}
+
+		return m_snapshots.front().m_binary;
+	}
+
+	return NULL;
+}
+
+void cLevel_Manager :: Set_Snapshot( const std::string &filename, cLevel_Binary *binary )
+{
+	// already kept
+	if( binary && !m_snapshots.empty() && m_snapshots.front().m_binary == binary )
+	{
+		return;
+	}
+
+	Clear_Snapshot( filename );
+
+	if( !binary )
+	{
+		return;
+	}
+
+	Level_Snapshot snapshot;
+	snapshot.m_binary = binary;
+	snapshot.m_filename = filename;
+	snapshot.m_size = Get_File_Size( filename );
+	snapshot.m_modified = Get_File_Modification_Time( filename );
+
+	m_snapshots.insert( m_snapshots.begin(), snapshot );
+	m_snapshots_size += binary->Get_Size();
+
+	// the newest is always kept
+	while( m_snapshots.size() > 1 && m_snapshots_size > level_snapshots_max_size )
+	{
+		Delete_Snapshot( m_snapshots.size() - 1 );
+	}
+}
+
+void cLevel_Manager :: Clear_Snapshot( const std::string &filename )
+{
+	for( unsigned int i = 0; i < m_snapshots.size(); i++ )
+	{
+		if( m_snapshots[i].m_filename.compare( filename ) == 0 )
+		{
+			Delete_Snapshot( i );
+			return;
+		}
+	}
+}
+
+void cLevel_Manager :: Clear_Snapshots( void )
+{
+	for( vector<Level_Snapshot>::iterator itr = m_snapshots.begin(); itr != m_snapshots.end(); ++itr )
+	{
+		delete (*itr).m_binary;
+	}
+
+	m_snapshots.clear();
+	m_snapshots_size = 0;
+}
+
+void cLevel_Manager :: Delete_Snapshot( unsigned int num )
+{
+	cLevel_Binary *binary = m_snapshots[num].m_binary;
+
+	m_snapshots_size -= binary->Get_Size();
+	m_snapshots.erase( m_snapshots.begin() + num );
+	delete binary;
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 // Level information handler
@@ -60,6 +60,10 @@ public:
 	bool Get_Path( std::string &filename, bool check_only_user_dir = 0 ) const;
 	// update
 	void Update( void );
+	/* Update with the fixed timestep ticks of the frame
+	 * and set the camera between the last two ticks for drawing
+	*/
+	void Update_Fixed_Timestep( void );
 	// draw
 	void Draw( void );
 
@@ -75,9 +79,51 @@ public:
 	*/
 	void Goto_Sub_Level( std::string str_level, const std::string &str_entry, Camera_movement move_camera = CAMERA_MOVE_FLY, const std::string &path_identifier = "" );
 
+	/* Returns the compiled level kept from a recent load of the full level filename or NULL
+	 * it is deleted if the level file changed since
+	*/
+	cLevel_Binary *Get_Snapshot( const std::string &filename );
+	/* Keep the compiled level to load the level again without reading and validating it
+	 * the least recently used levels are deleted if the kept levels are too large
+	 * the given one is deleted by the level manager
+	*/
+	void Set_Snapshot( const std::string &filename, cLevel_Binary *binary );
+	// Delete the kept compiled level of the full level filename
+	void Clear_Snapshot( const std::string &filename );
+	// Delete all kept compiled levels
+	void Clear_Snapshots( void );
 
 	// level camera
 	cCamera *m_camera;
+
+private:
+	// camera position before and after the last fixed timestep tick
+	float m_tick_camera_x;
+	float m_tick_camera_y;
+	float m_last_camera_x;
+	float m_last_camera_y;
+	// camera position set for drawing between the ticks
+	float m_draw_camera_x;
+	float m_draw_camera_y;
+	bool m_draw_camera;
+
+	// compiled level kept for loading it again
+	struct Level_Snapshot
+	{
+		cLevel_Binary *m_binary;
+		// full level filename with the size and modification time of the level file
+		std::string m_filename;
+		size_t m_size;
+		time_t m_modified;
+	};
+
+	// Delete the kept compiled level with the given number
+	void Delete_Snapshot( unsigned int num );
+
+	// recently loaded compiled levels with the most recently used first
+	vector<Level_Snapshot> m_snapshots;
+	// size of their compiled data
+	size_t m_snapshots_size;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
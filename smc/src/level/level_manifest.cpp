@@ -0,0 +1,415 @@
+/***************************************************************************
+ * level_manifest.cpp  -  images and sounds used by a level
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../level/level_manifest.h"
+#include "../level/level_binary.h"
+#include "../core/game_core.h"
+#include "../core/property_helper.h"
+#include "../core/filesystem/filesystem.h"
+#include "../video/video.h"
+#include "../video/gl_surface.h"
+#include "../video/img_manager.h"
+#include "../audio/audio.h"
+#include <fstream>
+#include <algorithm>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Manifest *** *** *** *** *** *** *** *** *** *** */
+
+// first line of the manifest file
+// the first use times were added in version 2 and older manifests are recorded again
+static const char level_manifest_header[] = "SMC level manifest 2";
+// end of the time range which includes all files
+static const Uint32 level_manifest_time_end = 0xFFFFFFFF;
+
+// Removes the directory from the filename if it starts with it
+static std::string Level_Manifest_Trim_Dir( const std::string &filename, const char *dir )
+{
+	const size_t pos = filename.find( dir );
+
+	if( pos == std::string::npos )
+	{
+		return filename;
+	}
+
+	return filename.substr( pos + strlen( dir ) );
+}
+
+/* Get the filenames first used from min_time until before max_time sorted by their first use
+ * files with the same time are sorted by name to keep the order of each load
+*/
+static void Level_Manifest_Sort( const cLevel_Manifest::File_Map &files, Uint32 min_time, Uint32 max_time, cLevel_Manifest::File_List &sorted )
+{
+	typedef vector<std::pair<Uint32, std::string> > Use_List;
+	Use_List uses;
+
+	for( cLevel_Manifest::File_Map::const_iterator itr = files.begin(); itr != files.end(); ++itr )
+	{
+		if( itr->second >= min_time && itr->second < max_time )
+		{
+			uses.push_back( std::make_pair( itr->second, itr->first ) );
+		}
+	}
+
+	std::sort( uses.begin(), uses.end() );
+
+	sorted.clear();
+	sorted.reserve( uses.size() );
+
+	for( Use_List::const_iterator itr = uses.begin(); itr != uses.end(); ++itr )
+	{
+		sorted.push_back( itr->second );
+	}
+}
+
+// Adds the file or sets its time if it was used earlier
+static bool Level_Manifest_Add( cLevel_Manifest::File_Map &files, const std::string &filename, Uint32 time )
+{
+	std::pair<cLevel_Manifest::File_Map::iterator, bool> result = files.insert( std::make_pair( filename, time ) );
+
+	if( result.second )
+	{
+		return 1;
+	}
+
+	if( time < result.first->second )
+	{
+		result.first->second = time;
+		return 1;
+	}
+
+	return 0;
+}
+
+cLevel_Manifest *cLevel_Manifest :: m_recording = NULL;
+cLevel_Manifest *cLevel_Manifest :: m_entered = NULL;
+
+cLevel_Manifest :: cLevel_Manifest( void )
+{
+	m_changed = 0;
+	m_play_time = 0;
+	m_enter_ticks = 0;
+	m_stream_pos = 0;
+}
+
+cLevel_Manifest :: ~cLevel_Manifest( void )
+{
+	Clear();
+
+	if( m_recording == this )
+	{
+		m_recording = NULL;
+	}
+	if( m_entered == this )
+	{
+		m_entered = NULL;
+	}
+}
+
+bool cLevel_Manifest :: Load( const std::string &level_filename )
+{
+	Clear();
+
+	m_filename = Get_Cache_Filename( level_filename );
+
+#ifdef _WIN32
+	ifstream file( utf8_to_ucs2( m_filename ).c_str(), ios::in );
+#else
+	ifstream file( m_filename.c_str(), ios::in );
+#endif
+
+	if( !file )
+	{
+		return 0;
+	}
+
+	std::string line;
+
+	if( !std::getline( file, line ) || line.compare( level_manifest_header ) != 0 )
+	{
+		debug_print( "Warning : Unknown level manifest %s\n", m_filename.c_str() );
+		return 0;
+	}
+
+	// type, first use time and filename
+	while( std::getline( file, line ) )
+	{
+		const std::string::size_type pos = line.find( ' ', 6 );
+
+		if( pos == std::string::npos )
+		{
+			continue;
+		}
+
+		const int time = string_to_int( line.substr( 6, pos - 6 ) );
+		const Uint32 use_time = time > 0 ? static_cast<Uint32>(time) : 0;
+
+		if( line.compare( 0, 6, "image " ) == 0 )
+		{
+			Level_Manifest_Add( m_images, line.substr( pos + 1 ), use_time );
+		}
+		else if( line.compare( 0, 6, "sound " ) == 0 )
+		{
+			Level_Manifest_Add( m_sounds, line.substr( pos + 1 ), use_time );
+		}
+	}
+
+	return 1;
+}
+
+bool cLevel_Manifest :: Save( void )
+{
+	if( !m_changed || m_filename.empty() )
+	{
+		return 0;
+	}
+
+	m_changed = 0;
+
+#ifdef _WIN32
+	ofstream file( utf8_to_ucs2( m_filename ).c_str(), ios::out | ios::trunc );
+#else
+	ofstream file( m_filename.c_str(), ios::out | ios::trunc );
+#endif
+
+	if( !file )
+	{
+		debug_print( "Warning : Could not save level manifest %s\n", m_filename.c_str() );
+		return 0;
+	}
+
+	file << level_manifest_header << '\n';
+
+	for( File_Map::const_iterator itr = m_images.begin(); itr != m_images.end(); ++itr )
+	{
+		file << "image " << itr->second << ' ' << itr->first << '\n';
+	}
+
+	for( File_Map::const_iterator itr = m_sounds.begin(); itr != m_sounds.end(); ++itr )
+	{
+		file << "sound " << itr->second << ' ' << itr->first << '\n';
+	}
+
+	return file.good();
+}
+
+void cLevel_Manifest :: Clear( void )
+{
+	Save();
+
+	m_filename.clear();
+	m_images.clear();
+	m_sounds.clear();
+	m_changed = 0;
+	m_play_time = 0;
+	m_enter_ticks = 0;
+	m_stream_images.clear();
+	m_stream_pos = 0;
+}
+
+void cLevel_Manifest :: Preload( void )
+{
+	// preloading is not a use
+	cLevel_Manifest *recording = m_recording;
+	m_recording = NULL;
+
+	File_List files;
+	Get_Sorted_Images( files, 1 );
+
+	// decoded in the background if the level prefetch has it
+	for( File_List::const_iterator itr = files.begin(); itr != files.end(); ++itr )
+	{
+		const std::string filename = DATA_DIR "/" GAME_PIXMAPS_DIR "/" + (*itr);
+
+		if( pImage_Manager->Get_Pointer( filename ) )
+		{
+			continue;
+		}
+
+		// no error as the level could have stopped using it
+		pVideo->Get_Surface( filename, 0 );
+	}
+
+	Get_Sorted_Sounds( files );
+
+	for( File_List::const_iterator itr = files.begin(); itr != files.end(); ++itr )
+	{
+		// decoded in the background and played when ready
+		pAudio->Preload_Sound( (*itr) );
+	}
+
+	Get_Sorted_Images( m_stream_images, 0 );
+	m_stream_pos = 0;
+
+	m_recording = recording;
+}
+
+void cLevel_Manifest :: Stream( void )
+{
+	while( m_stream_pos < m_stream_images.size() )
+	{
+		const std::string filename = DATA_DIR "/" GAME_PIXMAPS_DIR "/" + m_stream_images[m_stream_pos];
+		m_stream_pos++;
+
+		// already used
+		if( pImage_Manager->Get_Pointer( filename ) )
+		{
+			continue;
+		}
+
+		cLevel_Manifest *recording = m_recording;
+		m_recording = NULL;
+		pVideo->Get_Surface( filename, 0 );
+		m_recording = recording;
+		// one image each frame
+		return;
+	}
+
+	if( !m_stream_images.empty() )
+	{
+		m_stream_images.clear();
+		m_stream_pos = 0;
+	}
+}
+
+void cLevel_Manifest :: Enter( void )
+{
+	m_recording = this;
+
+	if( !m_enter_ticks )
+	{
+		m_enter_ticks = SDL_GetTicks();
+	}
+
+	if( m_entered == this )
+	{
+		return;
+	}
+
+	// the textures of the previous level are loaded again if used
+	if( m_entered )
+	{
+		for( File_Map::const_iterator itr = m_entered->m_images.begin(); itr != m_entered->m_images.end(); ++itr )
+		{
+			if( m_images.find( itr->first ) != m_images.end() )
+			{
+				continue;
+			}
+
+			cGL_Surface *surface = pImage_Manager->Get_Pointer( DATA_DIR "/" GAME_PIXMAPS_DIR "/" + itr->first );
+
+			if( surface && !surface->Is_Texture_Use_Multiple() )
+			{
+				surface->Unload_Texture();
+			}
+		}
+	}
+
+	m_entered = this;
+}
+
+void cLevel_Manifest :: Leave( void )
+{
+	if( m_recording == this )
+	{
+		m_recording = NULL;
+	}
+
+	// menus are not play time
+	if( m_enter_ticks )
+	{
+		m_play_time += SDL_GetTicks() - m_enter_ticks;
+		m_enter_ticks = 0;
+	}
+}
+
+Uint32 cLevel_Manifest :: Get_Play_Time( void ) const
+{
+	if( !m_enter_ticks )
+	{
+		return m_play_time;
+	}
+
+	return m_play_time + ( SDL_GetTicks() - m_enter_ticks );
+}
+
+void cLevel_Manifest :: Add_Image( const std::string &filename, Uint32 time )
+{
+	if( Level_Manifest_Add( m_images, Level_Manifest_Trim_Dir( filename, DATA_DIR "/" GAME_PIXMAPS_DIR "/" ), time ) )
+	{
+		m_changed = 1;
+	}
+}
+
+void cLevel_Manifest :: Add_Sound( const std::string &filename, Uint32 time )
+{
+	if( Level_Manifest_Add( m_sounds, Level_Manifest_Trim_Dir( filename, DATA_DIR "/" GAME_SOUNDS_DIR "/" ), time ) )
+	{
+		m_changed = 1;
+	}
+}
+
+void cLevel_Manifest :: Get_Sorted_Images( File_List &images, bool warm ) const
+{
+	if( warm )
+	{
+		Level_Manifest_Sort( m_images, 0, m_warm_time, images );
+	}
+	else
+	{
+		Level_Manifest_Sort( m_images, m_warm_time, level_manifest_time_end, images );
+	}
+}
+
+void cLevel_Manifest :: Get_Sorted_Sounds( File_List &sounds ) const
+{
+	Level_Manifest_Sort( m_sounds, 0, level_manifest_time_end, sounds );
+}
+
+void cLevel_Manifest :: Record_Image( const std::string &filename )
+{
+	// the editor loads every image
+	if( !m_recording || editor_enabled )
+	{
+		return;
+	}
+
+	m_recording->Add_Image( filename, m_recording->Get_Play_Time() );
+}
+
+void cLevel_Manifest :: Record_Sound( const std::string &filename )
+{
+	if( !m_recording || editor_enabled )
+	{
+		return;
+	}
+
+	m_recording->Add_Sound( filename, m_recording->Get_Play_Time() );
+}
+
+std::string cLevel_Manifest :: Get_Cache_Filename( const std::string &level_filename )
+{
+	std::string filename = cLevel_Binary::Get_Cache_Filename( level_filename );
+	filename.erase( filename.rfind( "." ) + 1 );
+	filename.insert( filename.length(), "manifest" );
+
+	return filename;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,134 @@
+/***************************************************************************
+ * level_manifest.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_LEVEL_MANIFEST_H
+#define SMC_LEVEL_MANIFEST_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL.h"
+// boost
+#include <boost/unordered_map.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Manifest *** *** *** *** *** *** *** *** *** *** */
+
+/* The images and sounds a level used with the level play time of their first use
+ * recorded while the level objects are created and while the level is played
+ * which includes the files of spawned objects
+ * it is kept in the user cache directory and extended every time the level is played
+ * and the earliest use of all plays is kept
+ * when the level is loaded again the files used in the warm time are preloaded in the order of their first use
+ * and the other images are streamed while the level is played
+*/
+class cLevel_Manifest
+{
+public:
+	cLevel_Manifest( void );
+	~cLevel_Manifest( void );
+
+	// filename and the play time in milliseconds of its first use
+	typedef boost::unordered_map<std::string, Uint32> File_Map;
+	typedef vector<std::string> File_List;
+
+	/* Load the cached manifest of the full level filename
+	 * returns false if the level has no manifest yet
+	*/
+	bool Load( const std::string &level_filename );
+	// Save the manifest into the cache if new files were recorded
+	bool Save( void );
+	// Save and clear the files
+	void Clear( void );
+
+	/* Load the images used in the warm time which are not loaded yet in the order of their first use
+	 * start decoding all sounds in the order of their first use
+	 * and queue the other images for streaming
+	*/
+	void Preload( void );
+	// Load the next queued image which is not loaded yet
+	void Stream( void );
+	/* Record the files used from now on into this manifest
+	 * and unload the textures of the previously entered manifest which this one does not use
+	*/
+	void Enter( void );
+	// Stop recording into this manifest
+	void Leave( void );
+
+	// Returns the level play time in milliseconds
+	Uint32 Get_Play_Time( void ) const;
+
+	// Add an image with the full filename and the time of its use
+	void Add_Image( const std::string &filename, Uint32 time );
+	// Add a sound with the full filename and the time of its use
+	void Add_Sound( const std::string &filename, Uint32 time );
+
+	// Returns the images
+	inline const File_Map &Get_Images( void ) const
+	{
+		return m_images;
+	}
+	// Returns the sounds
+	inline const File_Map &Get_Sounds( void ) const
+	{
+		return m_sounds;
+	}
+	/* Get the images sorted by their first use
+	 * warm : if set only the images used in the warm time else only the later used ones
+	*/
+	void Get_Sorted_Images( File_List &images, bool warm ) const;
+	// Get all sounds sorted by their first use
+	void Get_Sorted_Sounds( File_List &sounds ) const;
+
+	// Returns the cache filename for the full level filename
+	static std::string Get_Cache_Filename( const std::string &level_filename );
+
+	// Record the image if a manifest is recording and the editor is not used
+	static void Record_Image( const std::string &filename );
+	// Record the sound if a manifest is recording and the editor is not used
+	static void Record_Sound( const std::string &filename );
+
+	// manifest which records the used files or NULL
+	static cLevel_Manifest *m_recording;
+	// files first used in this level play time in milliseconds are preloaded
+	static const Uint32 m_warm_time = 5000;
+
+private:
+	// manifest cache filename
+	std::string m_filename;
+	File_Map m_images;
+	File_Map m_sounds;
+	// if files were added since loading
+	bool m_changed;
+	// play time of the previous times the level was entered
+	Uint32 m_play_time;
+	// ticks when the level was entered or 0 if not entered
+	Uint32 m_enter_ticks;
+
+	// images to stream
+	File_List m_stream_images;
+	// next image to stream
+	File_List::size_type m_stream_pos;
+
+	// the last entered manifest
+	static cLevel_Manifest *m_entered;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
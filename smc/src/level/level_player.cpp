@@ -22,6 +22,7 @@
 #include "../input/joystick.h"
 #include "../core/sprite_manager.h"
 #include "../core/framerate.h"
+#include "../core/engine_context.h"
 #include "../audio/audio.h"
 #include "../enemies/turtle.h"
 #include "../overworld/overworld.h"
@@ -49,6 +50,323 @@ const int power_jump_delta = 1000;
 const float cLevel_Player::m_default_pos_x = 200.0f;
 const float cLevel_Player::m_default_pos_y = -300.0f;
 
+// sounds which are played often
+static const cSound_Handle level_player_sound_jump_small( "player/jump_small.ogg" );
+static const cSound_Handle level_player_sound_jump_small_power( "player/jump_small_power.ogg" );
+static const cSound_Handle level_player_sound_jump_big( "player/jump_big.ogg" );
+static const cSound_Handle level_player_sound_jump_big_power( "player/jump_big_power.ogg" );
+static const cSound_Handle level_player_sound_jump_ghost( "player/jump_ghost.ogg" );
+static const cSound_Handle level_player_sound_run_stop( "player/run_stop.ogg" );
+static const cSound_Handle level_player_sound_wall_hit( "wall_hit.wav" );
+static const cSound_Handle level_player_sound_fireball( "item/fireball.ogg" );
+static const cSound_Handle level_player_sound_iceball( "item/iceball.wav" );
+
+/* *** *** *** *** *** *** *** *** Player image sets *** *** *** *** *** *** *** *** *** */
+
+/* The images of a maryo type in the order of the image array positions
+ * resolved once as the surfaces stay in the image manager
+*/
+struct Player_Image_Set
+{
+	Player_Image_Set( void )
+	{
+		m_count = 0;
+		m_resolved = 0;
+	}
+
+	inline void Add( cGL_Surface *image )
+	{
+		if( m_count >= MARYO_IMG_COUNT )
+		{
+			printf( "Warning : Player image set bigger as %d\n", MARYO_IMG_COUNT );
+			return;
+		}
+
+		m_images[m_count] = image;
+		m_count++;
+	}
+
+	cGL_Surface *m_images[MARYO_IMG_COUNT];
+	unsigned int m_count;
+	bool m_resolved;
+};
+
+// image sets by maryo type and if holding an item
+static Player_Image_Set player_image_sets[MARYO_TYPE_COUNT][2];
+
+static void Resolve_Player_Image_Set( Player_Image_Set &set, Maryo_type type, bool holding )
+{
+	// special maryo images state
+	std::string special_state;
+	// if holding item
+	if( holding )
+	{
+		special_state = "_holding";
+	}
+
+	if( type == MARYO_SMALL )
+	{
+		/********************* Small **************************/
+		// standing
+		set.Add( pVideo->Get_Surface( "maryo/small/stand_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/stand_right" + special_state + ".png" ) );
+		// walking
+		set.Add( pVideo->Get_Surface( "maryo/small/walk_left_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/walk_right_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/walk_left_2" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/walk_right_2" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/walk_left_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/walk_right_1" + special_state + ".png" ) );
+		// running
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		// falling
+		set.Add( pVideo->Get_Surface( "maryo/small/fall_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/fall_right" + special_state + ".png" ) );
+		// jumping
+		set.Add( pVideo->Get_Surface( "maryo/small/jump_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/jump_right" + special_state + ".png" ) );
+		// dead
+		set.Add( pVideo->Get_Surface( "maryo/small/dead_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/dead_right.png" ) );
+		// ducked
+		set.Add( pVideo->Get_Surface( "maryo/small/duck_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/duck_right.png" ) );
+		// climbing
+		set.Add( pVideo->Get_Surface( "maryo/small/climb_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/climb_right.png" ) );
+		/****************************************************/
+	}
+	else if( type == MARYO_BIG )
+	{
+		/********************* Big ****************************/
+		// standing
+		set.Add( pVideo->Get_Surface( "maryo/big/stand_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/big/stand_right" + special_state + ".png" ) );
+		// walking
+		set.Add( pVideo->Get_Surface( "maryo/big/walk_left_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/big/walk_right_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/big/walk_left_2" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/big/walk_right_2" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/big/walk_left_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/big/walk_right_1" + special_state + ".png" ) );
+		// running
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		// falling
+		set.Add( pVideo->Get_Surface( "maryo/big/fall_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/big/fall_right" + special_state + ".png" ) );
+		// jumping
+		set.Add( pVideo->Get_Surface( "maryo/big/jump_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/big/jump_right" + special_state + ".png" ) );
+		// dead
+		set.Add( pVideo->Get_Surface( "maryo/small/dead_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/dead_right.png" ) );
+		// ducked
+		set.Add( pVideo->Get_Surface( "maryo/big/duck_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/big/duck_right.png" ) );
+		// climbing
+		set.Add( pVideo->Get_Surface( "maryo/big/climb_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/big/climb_right.png" ) );
+		// throwing
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		/****************************************************/
+	}
+	else if( type == MARYO_FIRE )
+	{
+		/********************* Fire **************************/
+		// standing
+		set.Add( pVideo->Get_Surface( "maryo/fire/stand_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/fire/stand_right" + special_state + ".png" ) );
+		// walking
+		set.Add( pVideo->Get_Surface( "maryo/fire/walk_left_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/fire/walk_right_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/fire/walk_left_2" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/fire/walk_right_2" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/fire/walk_left_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/fire/walk_right_1" + special_state + ".png" ) );
+		// running
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		// falling
+		set.Add( pVideo->Get_Surface( "maryo/fire/fall_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/fire/fall_right" + special_state + ".png" ) );
+		// jumping
+		set.Add( pVideo->Get_Surface( "maryo/fire/jump_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/fire/fall_right" + special_state + ".png" ) );
+		// dead
+		set.Add( pVideo->Get_Surface( "maryo/small/dead_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/dead_right.png" ) );
+		// ducked
+		set.Add( pVideo->Get_Surface( "maryo/fire/duck_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/fire/duck_right.png" ) );
+		// climbing
+		set.Add( pVideo->Get_Surface( "maryo/fire/climb_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/fire/climb_right.png" ) );
+		// throwing
+		set.Add( pVideo->Get_Surface( "maryo/fire/throw_left_1.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/fire/throw_right_1.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/fire/throw_left_2.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/fire/throw_right_2.png" ) );
+		/****************************************************/
+	}
+	else if( type == MARYO_ICE )
+	{
+		/********************* Ice **************************/
+		// standing
+		set.Add( pVideo->Get_Surface( "maryo/ice/stand_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ice/stand_right" + special_state + ".png" ) );
+		// walking
+		set.Add( pVideo->Get_Surface( "maryo/ice/walk_left_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ice/walk_right_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ice/walk_left_2" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ice/walk_right_2" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ice/walk_left_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ice/walk_right_1" + special_state + ".png" ) );
+		// running
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		// falling
+		set.Add( pVideo->Get_Surface( "maryo/ice/fall_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ice/fall_right" + special_state + ".png" ) );
+		// jumping
+		set.Add( pVideo->Get_Surface( "maryo/ice/jump_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ice/fall_right" + special_state + ".png" ) );
+		// dead
+		set.Add( pVideo->Get_Surface( "maryo/small/dead_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/dead_right.png" ) );
+		// ducked
+		set.Add( pVideo->Get_Surface( "maryo/ice/duck_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ice/duck_right.png" ) );
+		// climbing
+		set.Add( pVideo->Get_Surface( "maryo/ice/climb_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ice/climb_right.png" ) );
+		// throwing
+		set.Add( pVideo->Get_Surface( "maryo/ice/throw_left_1.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ice/throw_right_1.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ice/throw_left_2.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ice/throw_right_2.png" ) );
+		/****************************************************/
+	}
+	else if( type == MARYO_CAPE )
+	{
+		/********************* Cape **************************/
+		// standing
+		set.Add( pVideo->Get_Surface( "maryo/flying/left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/right" + special_state + ".png" ) );
+		// walking
+		set.Add( pVideo->Get_Surface( "maryo/flying/walk_left_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/walk_right_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/walk_left_2" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/walk_right_2" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/walk_left_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/walk_right_1" + special_state + ".png" ) );
+		// running
+		set.Add( pVideo->Get_Surface( "maryo/flying/run_left_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/run_right_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/run_left_2" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/run_right_2" + special_state + ".png" ) );
+		// falling
+		set.Add( pVideo->Get_Surface( "maryo/flying/fall_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/fall_right" + special_state + ".png" ) );
+		// jumping
+		set.Add( pVideo->Get_Surface( "maryo/flying/jump_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/fall_right" + special_state + ".png" ) );
+		// dead
+		set.Add( pVideo->Get_Surface( "maryo/small/dead_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/dead_right.png" ) );
+		// ducked
+		set.Add( pVideo->Get_Surface( "maryo/flying/duck_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/duck_right.png" ) );
+		// climbing
+		set.Add( pVideo->Get_Surface( "maryo/flying/climb_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/climb_right.png" ) );
+		// throwing
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		// flying
+		set.Add( pVideo->Get_Surface( "maryo/flying/fly_left_1.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/fly_right_1.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/fly_left_2.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/fly_right_2.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/fly_left_3.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/fly_right_3.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/fly_left_4.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/fly_right_4.png" ) );
+		// slow fall/parachute
+		set.Add( pVideo->Get_Surface( "maryo/flying/slow_fall_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/flying/slow_fall_right.png" ) );
+		/****************************************************/
+	}
+	else if( type == MARYO_GHOST )
+	{
+		/********************* Ghost **************************/
+		// standing
+		set.Add( pVideo->Get_Surface( "maryo/ghost/stand_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ghost/stand_right" + special_state + ".png" ) );
+		// walking
+		set.Add( pVideo->Get_Surface( "maryo/ghost/walk_left_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ghost/walk_right_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ghost/walk_left_2" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ghost/walk_right_2" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ghost/walk_left_1" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ghost/walk_right_1" + special_state + ".png" ) );
+		// running
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		// falling
+		set.Add( pVideo->Get_Surface( "maryo/ghost/fall_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ghost/fall_right" + special_state + ".png" ) );
+		// jumping
+		set.Add( pVideo->Get_Surface( "maryo/ghost/jump_left" + special_state + ".png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ghost/fall_right" + special_state + ".png" ) );
+		// dead
+		set.Add( pVideo->Get_Surface( "maryo/small/dead_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/small/dead_right.png" ) );
+		// ducked
+		set.Add( pVideo->Get_Surface( "maryo/ghost/duck_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ghost/duck_right.png" ) );
+		// climbing
+		set.Add( pVideo->Get_Surface( "maryo/ghost/climb_left.png" ) );
+		set.Add( pVideo->Get_Surface( "maryo/ghost/climb_right.png" ) );
+		// throwing
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		set.Add( NULL );
+		/****************************************************/
+	}
+
+}
+
+static const Player_Image_Set &Get_Player_Image_Set( Maryo_type type, bool holding )
+{
+	Player_Image_Set &set = player_image_sets[type][holding];
+
+	if( !set.m_resolved )
+	{
+		Resolve_Player_Image_Set( set, type, holding );
+		set.m_resolved = 1;
+	}
+
+	return set;
+}
+
 /* *** *** *** *** *** *** *** *** cLevel_Player *** *** *** *** *** *** *** *** *** */
 
 cLevel_Player :: cLevel_Player( cSprite_Manager *sprite_manager )
@@ -57,6 +375,7 @@ cLevel_Player :: cLevel_Player( cSprite_Manager *sprite_manager )
 	m_sprite_array = ARRAY_PLAYER;
 	m_type = TYPE_PLAYER;
 	m_massive_type = MASS_MASSIVE;
+	m_col_valid_massive = COL_MASK_ALL;
 	m_state = STA_FALL;
 
 	m_maryo_type = MARYO_SMALL;
@@ -65,7 +384,7 @@ cLevel_Player :: cLevel_Player( cSprite_Manager *sprite_manager )
 
 	m_pos_z = 0.0999f;
 	m_gravity_max = 25.0f;
-	m_images.reserve( 20 );
+	m_images.reserve( MARYO_IMG_COUNT );
 	m_ducked_counter = 0;
 	m_ducked_animation_counter = 0.0f;
 	m_parachute = 0;
@@ -442,7 +761,7 @@ animation_end:
 	{
 		Game_Action = GA_ENTER_MENU;
 		Game_Action_Data_Middle.add( "load_menu", int_to_string( MENU_START ) );
-		Game_Action_Data_Middle.add( "menu_start_current_level", Trim_Filename( pActive_Level->m_level_filename, 0, 0 ) );
+		Game_Action_Data_Middle.add( "menu_start_current_level", Trim_Filename( Get_Context()->Get_Level()->m_level_filename, 0, 0 ) );
 		// reset saved data
 		Game_Action_Data_Middle.add( "reset_save", "1" );
 	}
@@ -1297,28 +1616,28 @@ void cLevel_Player :: Start_Jump( float deaccel /* = 0.08f */ )
 		{
 			if( m_force_jump )
 			{
-				pAudio->Play_Sound( "player/jump_small_power.ogg", RID_MARYO_JUMP );
+				pAudio->Play_Sound( level_player_sound_jump_small_power, RID_MARYO_JUMP );
 			}
 			else
 			{
-				pAudio->Play_Sound( "player/jump_small.ogg", RID_MARYO_JUMP );
+				pAudio->Play_Sound( level_player_sound_jump_small, RID_MARYO_JUMP );
 			}
 		}
 		// ghost
 		else if( m_maryo_type == MARYO_GHOST )
 		{
-			pAudio->Play_Sound( "player/jump_ghost.ogg", RID_MARYO_JUMP );
+			pAudio->Play_Sound( level_player_sound_jump_ghost, RID_MARYO_JUMP );
 		}
 		// big
 		else
 		{
 			if( m_force_jump )
 			{
-				pAudio->Play_Sound( "player/jump_big_power.ogg", RID_MARYO_JUMP );
+				pAudio->Play_Sound( level_player_sound_jump_big_power, RID_MARYO_JUMP );
 			}
 			else
 			{
-				pAudio->Play_Sound( "player/jump_big.ogg", RID_MARYO_JUMP );
+				pAudio->Play_Sound( level_player_sound_jump_big, RID_MARYO_JUMP );
 			}
 		}
 	}
@@ -2796,268 +3115,31 @@ void cLevel_Player :: Load_Images( void )
 		return;
 	}
 
-	Clear_Images();
+	// special maryo images state if holding item
+	const Player_Image_Set &set = Get_Player_Image_Set( m_maryo_type, m_active_object != NULL );
 
-	// special maryo images state
-	std::string special_state;
-	// if holding item
-	if( m_active_object )
-	{
-		special_state = "_holding";
-	}
+	Clear_Images();
 
-	if( m_maryo_type == MARYO_SMALL )
-	{
-		/********************* Small **************************/
-		// standing
-		Add_Image( pVideo->Get_Surface( "maryo/small/stand_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/stand_right" + special_state + ".png" ) );
-		// walking
-		Add_Image( pVideo->Get_Surface( "maryo/small/walk_left_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/walk_right_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/walk_left_2" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/walk_right_2" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/walk_left_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/walk_right_1" + special_state + ".png" ) );
-		// running
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		// falling
-		Add_Image( pVideo->Get_Surface( "maryo/small/fall_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/fall_right" + special_state + ".png" ) );
-		// jumping
-		Add_Image( pVideo->Get_Surface( "maryo/small/jump_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/jump_right" + special_state + ".png" ) );
-		// dead
-		Add_Image( pVideo->Get_Surface( "maryo/small/dead_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/dead_right.png" ) );
-		// ducked
-		Add_Image( pVideo->Get_Surface( "maryo/small/duck_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/duck_right.png" ) );
-		// climbing
-		Add_Image( pVideo->Get_Surface( "maryo/small/climb_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/climb_right.png" ) );
-		/****************************************************/
-	}
-	else if( m_maryo_type == MARYO_BIG )
-	{
-		/********************* Big ****************************/
-		// standing
-		Add_Image( pVideo->Get_Surface( "maryo/big/stand_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/big/stand_right" + special_state + ".png" ) );
-		// walking
-		Add_Image( pVideo->Get_Surface( "maryo/big/walk_left_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/big/walk_right_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/big/walk_left_2" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/big/walk_right_2" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/big/walk_left_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/big/walk_right_1" + special_state + ".png" ) );
-		// running
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		// falling
-		Add_Image( pVideo->Get_Surface( "maryo/big/fall_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/big/fall_right" + special_state + ".png" ) );
-		// jumping
-		Add_Image( pVideo->Get_Surface( "maryo/big/jump_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/big/jump_right" + special_state + ".png" ) );
-		// dead
-		Add_Image( pVideo->Get_Surface( "maryo/small/dead_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/dead_right.png" ) );
-		// ducked
-		Add_Image( pVideo->Get_Surface( "maryo/big/duck_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/big/duck_right.png" ) );
-		// climbing
-		Add_Image( pVideo->Get_Surface( "maryo/big/climb_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/big/climb_right.png" ) );
-		// throwing
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		/****************************************************/
-	}
-	else if( m_maryo_type == MARYO_FIRE )
-	{
-		/********************* Fire **************************/
-		// standing
-		Add_Image( pVideo->Get_Surface( "maryo/fire/stand_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/fire/stand_right" + special_state + ".png" ) );
-		// walking
-		Add_Image( pVideo->Get_Surface( "maryo/fire/walk_left_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/fire/walk_right_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/fire/walk_left_2" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/fire/walk_right_2" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/fire/walk_left_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/fire/walk_right_1" + special_state + ".png" ) );
-		// running
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		// falling
-		Add_Image( pVideo->Get_Surface( "maryo/fire/fall_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/fire/fall_right" + special_state + ".png" ) );
-		// jumping
-		Add_Image( pVideo->Get_Surface( "maryo/fire/jump_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/fire/fall_right" + special_state + ".png" ) );
-		// dead
-		Add_Image( pVideo->Get_Surface( "maryo/small/dead_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/dead_right.png" ) );
-		// ducked
-		Add_Image( pVideo->Get_Surface( "maryo/fire/duck_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/fire/duck_right.png" ) );
-		// climbing
-		Add_Image( pVideo->Get_Surface( "maryo/fire/climb_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/fire/climb_right.png" ) );
-		// throwing
-		Add_Image( pVideo->Get_Surface( "maryo/fire/throw_left_1.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/fire/throw_right_1.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/fire/throw_left_2.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/fire/throw_right_2.png" ) );
-		/****************************************************/
-	}
-	else if( m_maryo_type == MARYO_ICE )
-	{
-		/********************* Ice **************************/
-		// standing
-		Add_Image( pVideo->Get_Surface( "maryo/ice/stand_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ice/stand_right" + special_state + ".png" ) );
-		// walking
-		Add_Image( pVideo->Get_Surface( "maryo/ice/walk_left_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ice/walk_right_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ice/walk_left_2" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ice/walk_right_2" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ice/walk_left_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ice/walk_right_1" + special_state + ".png" ) );
-		// running
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		// falling
-		Add_Image( pVideo->Get_Surface( "maryo/ice/fall_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ice/fall_right" + special_state + ".png" ) );
-		// jumping
-		Add_Image( pVideo->Get_Surface( "maryo/ice/jump_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ice/fall_right" + special_state + ".png" ) );
-		// dead
-		Add_Image( pVideo->Get_Surface( "maryo/small/dead_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/dead_right.png" ) );
-		// ducked
-		Add_Image( pVideo->Get_Surface( "maryo/ice/duck_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ice/duck_right.png" ) );
-		// climbing
-		Add_Image( pVideo->Get_Surface( "maryo/ice/climb_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ice/climb_right.png" ) );
-		// throwing
-		Add_Image( pVideo->Get_Surface( "maryo/ice/throw_left_1.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ice/throw_right_1.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ice/throw_left_2.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ice/throw_right_2.png" ) );
-		/****************************************************/
-	}
-	else if( m_maryo_type == MARYO_CAPE )
+	for( unsigned int i = 0; i < set.m_count; i++ )
 	{
-		/********************* Cape **************************/
-		// standing
-		Add_Image( pVideo->Get_Surface( "maryo/flying/left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/right" + special_state + ".png" ) );
-		// walking
-		Add_Image( pVideo->Get_Surface( "maryo/flying/walk_left_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/walk_right_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/walk_left_2" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/walk_right_2" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/walk_left_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/walk_right_1" + special_state + ".png" ) );
-		// running
-		Add_Image( pVideo->Get_Surface( "maryo/flying/run_left_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/run_right_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/run_left_2" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/run_right_2" + special_state + ".png" ) );
-		// falling
-		Add_Image( pVideo->Get_Surface( "maryo/flying/fall_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/fall_right" + special_state + ".png" ) );
-		// jumping
-		Add_Image( pVideo->Get_Surface( "maryo/flying/jump_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/fall_right" + special_state + ".png" ) );
-		// dead
-		Add_Image( pVideo->Get_Surface( "maryo/small/dead_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/dead_right.png" ) );
-		// ducked
-		Add_Image( pVideo->Get_Surface( "maryo/flying/duck_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/duck_right.png" ) );
-		// climbing
-		Add_Image( pVideo->Get_Surface( "maryo/flying/climb_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/climb_right.png" ) );
-		// throwing
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		// flying
-		Add_Image( pVideo->Get_Surface( "maryo/flying/fly_left_1.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/fly_right_1.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/fly_left_2.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/fly_right_2.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/fly_left_3.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/fly_right_3.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/fly_left_4.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/fly_right_4.png" ) );
-		// slow fall/parachute
-		Add_Image( pVideo->Get_Surface( "maryo/flying/slow_fall_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/flying/slow_fall_right.png" ) );
-		/****************************************************/
-	}
-	else if( m_maryo_type == MARYO_GHOST )
-	{
-		/********************* Ghost **************************/
-		// standing
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/stand_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/stand_right" + special_state + ".png" ) );
-		// walking
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/walk_left_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/walk_right_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/walk_left_2" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/walk_right_2" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/walk_left_1" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/walk_right_1" + special_state + ".png" ) );
-		// running
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		// falling
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/fall_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/fall_right" + special_state + ".png" ) );
-		// jumping
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/jump_left" + special_state + ".png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/fall_right" + special_state + ".png" ) );
-		// dead
-		Add_Image( pVideo->Get_Surface( "maryo/small/dead_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/small/dead_right.png" ) );
-		// ducked
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/duck_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/duck_right.png" ) );
-		// climbing
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/climb_left.png" ) );
-		Add_Image( pVideo->Get_Surface( "maryo/ghost/climb_right.png" ) );
-		// throwing
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		Add_Image( NULL );
-		/****************************************************/
+		Add_Image( set.m_images[i] );
 	}
 
 	// set image
 	Set_Image_Num( Get_Image() + m_direction );
 }
 
+void cLevel_Player :: Build_Image_Sets( void )
+{
+	const Maryo_type preloaded_types[] = { MARYO_SMALL, MARYO_BIG, MARYO_FIRE, MARYO_ICE, MARYO_GHOST };
+
+	for( unsigned int i = 0; i < sizeof(preloaded_types) / sizeof(preloaded_types[0]); i++ )
+	{
+		Get_Player_Image_Set( preloaded_types[i], 0 );
+		Get_Player_Image_Set( preloaded_types[i], 1 );
+	}
+}
+
 void cLevel_Player :: Get_Item( SpriteType item_type, bool force /* = 0 */, cMovingSprite *base /* = NULL */ )
 {
 	Maryo_type current_maryo_type;
@@ -3233,7 +3315,7 @@ void cLevel_Player :: Get_Item( SpriteType item_type, bool force /* = 0 */, cMov
 	{
 		// todo : check if music is already playing
 		pAudio->Play_Music( "game/star.ogg", 0, 1, 500 );
-		pAudio->Play_Music( pActive_Level->m_musicfile, -1, 0 );
+		pAudio->Play_Music( Get_Context()->Get_Level()->m_musicfile, -1, 0 );
 		pHud_Points->Add_Points( 1000, m_pos_x + ( m_col_rect.m_w / 2 ), m_pos_y + 2 );
 		m_invincible = speedfactor_fps * 16.0f;
 		m_invincible_star = speedfactor_fps * 15.0f;
@@ -3323,7 +3405,10 @@ void cLevel_Player :: Action_Interact( input_identifier key_type )
 	if( key_type == INP_UP )
 	{
 		// Search for colliding level exit objects
-		for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+		cSprite_List near_objects;
+		m_sprite_manager->Get_Grid_Objects( near_objects, m_col_rect );
+
+		for( cSprite_List::iterator itr = near_objects.begin(); itr != near_objects.end(); ++itr )
 		{
 			cSprite *obj = (*itr);
 
@@ -3385,7 +3470,10 @@ void cLevel_Player :: Action_Interact( input_identifier key_type )
 	else if( key_type == INP_DOWN )
 	{
 		// Search for colliding level exit objects
-		for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+		cSprite_List near_objects;
+		m_sprite_manager->Get_Grid_Objects( near_objects, m_col_rect );
+
+		for( cSprite_List::iterator itr = near_objects.begin(); itr != near_objects.end(); ++itr )
 		{
 			cSprite *obj = (*itr);
 
@@ -3448,7 +3536,10 @@ void cLevel_Player :: Action_Interact( input_identifier key_type )
 	else if( key_type == INP_LEFT )
 	{
 		// Search for colliding level exit objects
-		for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+		cSprite_List near_objects;
+		m_sprite_manager->Get_Grid_Objects( near_objects, m_col_rect );
+
+		for( cSprite_List::iterator itr = near_objects.begin(); itr != near_objects.end(); ++itr )
 		{
 			cSprite *obj = (*itr);
 
@@ -3497,7 +3588,7 @@ void cLevel_Player :: Action_Interact( input_identifier key_type )
 				// play stop sound if already running
 				if( m_velx > 12.0f && m_ground_object )
 				{
-					pAudio->Play_Sound( "player/run_stop.ogg", RID_MARYO_STOP );
+					pAudio->Play_Sound( level_player_sound_run_stop, RID_MARYO_STOP );
 				}
 
 				m_direction = DIR_LEFT;
@@ -3508,7 +3599,10 @@ void cLevel_Player :: Action_Interact( input_identifier key_type )
 	else if( key_type == INP_RIGHT )
 	{
 		// Search for colliding level exit objects
-		for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+		cSprite_List near_objects;
+		m_sprite_manager->Get_Grid_Objects( near_objects, m_col_rect );
+
+		for( cSprite_List::iterator itr = near_objects.begin(); itr != near_objects.end(); ++itr )
 		{
 			cSprite *obj = (*itr);
 
@@ -3557,7 +3651,7 @@ void cLevel_Player :: Action_Interact( input_identifier key_type )
 				// play stop sound if already running
 				if( m_velx < -12.0f && m_ground_object )
 				{
-					pAudio->Play_Sound( "player/run_stop.ogg", RID_MARYO_STOP );
+					pAudio->Play_Sound( level_player_sound_run_stop, RID_MARYO_STOP );
 				}
 
 				m_direction = DIR_RIGHT;
@@ -3588,7 +3682,7 @@ void cLevel_Player :: Action_Interact( input_identifier key_type )
 		if( Game_Mode_Type == MODE_TYPE_LEVEL_CUSTOM )
 		{
 			Game_Action_Data_Middle.add( "load_menu", int_to_string( MENU_START ) );
-			Game_Action_Data_Middle.add( "menu_start_current_level", Trim_Filename( pActive_Level->m_level_filename, 0, 0 ) );
+			Game_Action_Data_Middle.add( "menu_start_current_level", Trim_Filename( Get_Context()->Get_Level()->m_level_filename, 0, 0 ) );
 		}
 		else
 		{
@@ -3716,13 +3810,13 @@ bool cLevel_Player :: Ball_Add( ball_effect effect_type /* = FIREBALL_DEFAULT */
 			ball_vel_x = 12;
 
 			// sound
-			pAudio->Play_Sound( "item/iceball.wav", RID_MARYO_BALL );
+			pAudio->Play_Sound( level_player_sound_iceball, RID_MARYO_BALL );
 		}
 		// fireball
 		else
 		{
 			// sound
-			pAudio->Play_Sound( "item/fireball.ogg", RID_MARYO_BALL );
+			pAudio->Play_Sound( level_player_sound_fireball, RID_MARYO_BALL );
 		}
 
 		if( m_direction == DIR_LEFT )
@@ -3804,9 +3898,7 @@ bool cLevel_Player :: Ball_Add( ball_effect effect_type /* = FIREBALL_DEFAULT */
 		// explosion animation and sound
 		if( effect_type == FIREBALL_EXPLOSION )
 		{
-			cAnimation_Fireball *anim = new cAnimation_Fireball( m_sprite_manager, m_pos_x + ( m_col_rect.m_w / 2 ), m_pos_y + ( m_col_rect.m_h / 3 ), 10 );
-			anim->Set_Fading_Speed( 0.3f );
-			pActive_Animation_Manager->Add( anim );
+			pActive_Animation_Manager->Add_Fireball( m_pos_x + ( m_col_rect.m_w / 2 ), m_pos_y + ( m_col_rect.m_h / 3 ), 10, 0.3f );
 
 			pAudio->Play_Sound( "item/fireball_explosion.wav", RID_MARYO_BALL );
 		}
@@ -3840,20 +3932,17 @@ bool cLevel_Player :: Ball_Add( ball_effect effect_type /* = FIREBALL_DEFAULT */
 
 void cLevel_Player :: Ball_Clear( void ) const
 {
+	const cSprite_List &balls = m_sprite_manager->Get_Type_Objects( TYPE_BALL );
+
 	// destroy all fireballs from the player
-	for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+	for( cSprite_List::const_iterator itr = balls.begin(); itr != balls.end(); ++itr )
 	{
-		cSprite *obj = (*itr);
+		cBall *ball = static_cast<cBall *>(*itr);
 
-		if( obj->m_type == TYPE_BALL )
+		// if from player
+		if( ball->m_origin_type == TYPE_PLAYER )
 		{
-			cBall *ball = static_cast<cBall *>(obj);
-
-			// if from player
-			if( ball->m_origin_type == TYPE_PLAYER )
-			{
-				obj->Destroy();
-			}
+			ball->Destroy();
 		}
 	}
 }
@@ -4369,7 +4458,7 @@ void cLevel_Player :: Handle_Collision_Massive( cObjectCollision *collision )
 
 				if( collision->m_array == ARRAY_MASSIVE )
 				{
-					pAudio->Play_Sound( "wall_hit.wav", RID_MARYO_WALL_HIT );
+					pAudio->Play_Sound( level_player_sound_wall_hit, RID_MARYO_WALL_HIT );
 
 					// create animation
 					cParticle_Emitter *anim = new cParticle_Emitter( m_sprite_manager );
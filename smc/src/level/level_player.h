@@ -51,9 +51,14 @@ enum Maryo_imgpos
 	MARYO_IMG_CLIMB = 20,
 	MARYO_IMG_THROW = 22,
 	MARYO_IMG_FLY = 26,
-	MARYO_IMG_SPECIAL_1 = 34
+	MARYO_IMG_SPECIAL_1 = 34,
+	// size of the largest image set
+	MARYO_IMG_COUNT = 36
 };
 
+// number of maryo types including dead
+const unsigned int MARYO_TYPE_COUNT = MARYO_GHOST + 1;
+
 /* *** *** *** *** *** *** *** Level player *** *** *** *** *** *** *** *** *** *** */
 
 class cLevel_Player : public cAnimated_Sprite
@@ -168,6 +173,10 @@ public:
 
 	// Loads the images depending on maryo_type
 	void Load_Images( void );
+	/* Resolve the image sets of the preloaded types for the powerup changes
+	 * the other types are resolved on their first use
+	*/
+	static void Build_Image_Sets( void );
 
 	/* Sets the best position to advance in size
 	 * if only_check is set position is unchanged
@@ -0,0 +1,680 @@
+/***************************************************************************
+ * level_prefetch.cpp  -  background image decoding for level loading
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../level/level_prefetch.h"
+#include "../level/level_player.h"
+#include "../level/level_binary.h"
+#include "../core/xml_reader.h"
+#include "../video/image_loader.h"
+#include "../video/img_manager.h"
+#include "../core/filesystem/filesystem.h"
+#include "../level/level_manager.h"
+#include "../audio/audio.h"
+#include "../user/preferences.h"
+#include "../core/task_pool.h"
+// CEGUI
+#include "CEGUIXMLParser.h"
+#include "CEGUIExceptions.h"
+#include "CEGUISystem.h"
+// boost
+#include <boost/bind.hpp>
+#include <algorithm>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Prefetch *** *** *** *** *** *** *** *** *** *** */
+
+cLevel_Prefetch :: cLevel_Prefetch( void )
+{
+	m_player_pos_x = cLevel_Player::m_default_pos_x;
+	m_player_pos_y = cLevel_Player::m_default_pos_y;
+	m_loader = NULL;
+}
+
+cLevel_Prefetch :: ~cLevel_Prefetch( void )
+{
+	Stop();
+}
+
+bool cLevel_Prefetch :: Start( const std::string &filename, const cLevel_Manifest *manifest /* = NULL */ )
+{
+	Stop();
+
+	// compressed cache images are not decoded
+	if( pVideo->m_compressed_cache )
+	{
+		return 0;
+	}
+
+	try
+	{
+		Parse_XML_File( *this, filename, "Level.xsd" );
+	}
+	// the level loading shows the error
+	catch( CEGUI::Exception &ex )
+	{
+		m_requests.clear();
+		return 0;
+	}
+
+	return Start_Loader( manifest );
+}
+
+bool cLevel_Prefetch :: Start( const cLevel_Binary &binary, const cLevel_Manifest *manifest /* = NULL */ )
+{
+	Stop();
+
+	// compressed cache images are not decoded
+	if( pVideo->m_compressed_cache )
+	{
+		return 0;
+	}
+
+	for( unsigned int i = 0; i < binary.Get_Element_Count(); i++ )
+	{
+		binary.Get_Attributes( i, m_xml_attributes );
+		elementEnd( reinterpret_cast<const CEGUI::utf8 *>(binary.Get_Element_Name( i )) );
+	}
+
+	return Start_Loader( manifest );
+}
+
+bool cLevel_Prefetch :: Start_Loader( const cLevel_Manifest *manifest )
+{
+	if( m_requests.empty() && ( !manifest || manifest->Get_Images().empty() ) )
+	{
+		return 0;
+	}
+
+	// nearest first
+	for( Image_Request_List::iterator itr = m_requests.begin(); itr != m_requests.end(); ++itr )
+	{
+		Image_Request &request = (*itr);
+
+		const float dist_x = request.m_pos_x - m_player_pos_x;
+		const float dist_y = request.m_pos_y - m_player_pos_y;
+		request.m_distance = dist_x * dist_x + dist_y * dist_y;
+	}
+
+	std::stable_sort( m_requests.begin(), m_requests.end(), distance_sort() );
+
+	m_loader = new cImage_Loader( cImage_Loader::JOB_LOAD );
+
+	for( Image_Request_List::iterator itr = m_requests.begin(); itr != m_requests.end(); ++itr )
+	{
+		m_loader->Add( (*itr).m_filename );
+	}
+
+	m_requests.clear();
+
+	/* images of spawned objects and others which were used the last time
+	 * the ones used first are preloaded and the later used ones are streamed
+	*/
+	if( manifest )
+	{
+		cLevel_Manifest::File_List images;
+		manifest->Get_Sorted_Images( images, 1 );
+		cLevel_Manifest::File_List stream_images;
+		manifest->Get_Sorted_Images( stream_images, 0 );
+		images.insert( images.end(), stream_images.begin(), stream_images.end() );
+
+		for( cLevel_Manifest::File_List::const_iterator itr = images.begin(); itr != images.end(); ++itr )
+		{
+			const std::string filename = DATA_DIR "/" GAME_PIXMAPS_DIR "/" + (*itr);
+
+			if( !pImage_Manager->Get_Pointer( filename ) )
+			{
+				m_loader->Add( filename );
+			}
+		}
+	}
+
+	m_loader->Start();
+	pVideo->m_image_loader = m_loader;
+
+	return 1;
+}
+
+void cLevel_Prefetch :: Stop( void )
+{
+	if( !m_loader )
+	{
+		return;
+	}
+
+	if( pVideo->m_image_loader == m_loader )
+	{
+		pVideo->m_image_loader = NULL;
+	}
+
+	delete m_loader;
+	m_loader = NULL;
+}
+
+void cLevel_Prefetch :: elementStart( const CEGUI::String &element, const CEGUI::XMLAttributes &attributes )
+{
+	if( element == "property" || element == "Property" )
+	{
+		m_xml_attributes.add( attributes.getValueAsString( "name" ), attributes.getValueAsString( "value" ) );
+	}
+}
+
+void cLevel_Prefetch :: elementEnd( const CEGUI::String &element )
+{
+	if( element == "property" || element == "Property" )
+	{
+		return;
+	}
+
+	if( element == "player" )
+	{
+		m_player_pos_x = static_cast<float>(m_xml_attributes.getValueAsInteger( "posx", static_cast<int>(cLevel_Player::m_default_pos_x) ));
+		m_player_pos_y = static_cast<float>(m_xml_attributes.getValueAsInteger( "posy", static_cast<int>(cLevel_Player::m_default_pos_y) ));
+	}
+	else if( ( element == "sprite" || element == "background" ) && m_xml_attributes.exists( "image" ) )
+	{
+		std::string filename = m_xml_attributes.getValueAsString( "image" ).c_str();
+
+		// .settings file type can't be used directly
+		if( filename.find( ".settings" ) != std::string::npos )
+		{
+			filename.erase( filename.find( ".settings" ) );
+			filename.insert( filename.length(), ".png" );
+		}
+
+		// pixmaps dir must be given
+		if( filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/" ) == std::string::npos )
+		{
+			filename.insert( 0, DATA_DIR "/" GAME_PIXMAPS_DIR "/" );
+		}
+
+		std::string settings_file = filename;
+		settings_file.erase( settings_file.rfind( "." ) + 1 );
+		settings_file.insert( settings_file.length(), "settings" );
+
+		// skip loaded and old images which get relocated
+		if( !pImage_Manager->Get_Pointer( filename ) && ( File_Exists( filename ) || File_Exists( settings_file ) ) )
+		{
+			Image_Request request;
+			request.m_filename = filename;
+			request.m_pos_x = m_xml_attributes.getValueAsFloat( "posx" );
+			request.m_pos_y = m_xml_attributes.getValueAsFloat( "posy" );
+			request.m_distance = 0.0f;
+
+			m_requests.push_back( request );
+		}
+	}
+
+	// clear
+	m_xml_attributes = CEGUI::XMLAttributes();
+}
+
+/* *** *** *** *** *** *** *** cLevel_Preloader *** *** *** *** *** *** *** *** *** *** */
+
+cLevel_Preloader :: cLevel_Preloader( void )
+{
+	m_first_started = 0;
+	m_loading = NULL;
+	m_next_load_time = 0;
+	m_task_finished = 1;
+	m_task_group = pTask_Pool->Create_Group();
+}
+
+cLevel_Preloader :: ~cLevel_Preloader( void )
+{
+	Clear();
+}
+
+void cLevel_Preloader :: Start( std::string levelname )
+{
+	const std::string filename = Get_Level_Filename( levelname );
+
+	if( filename.empty() )
+	{
+		return;
+	}
+
+	const int index = Get_Index( filename );
+
+	// already preloaded first
+	if( index == 0 )
+	{
+		m_first_started = 1;
+		return;
+	}
+
+	Preloaded_Level level;
+
+	// preloaded as following level
+	if( index > 0 )
+	{
+		level = m_levels[index];
+		m_levels.erase( m_levels.begin() + index );
+	}
+	else
+	{
+		level.m_filename = filename;
+		level.m_binary = new cLevel_Binary();
+		level.m_loaded = 0;
+	}
+
+	m_levels.insert( m_levels.begin(), level );
+	m_first_started = 1;
+	// the player is about to enter it
+	m_next_load_time = 0;
+
+	Remove_Over_Limit( pPreferences->m_level_preload_count + 1 );
+	Update();
+}
+
+void cLevel_Preloader :: Set_Next( const vector<std::string> &levelnames )
+{
+	Preloaded_Level_List levels;
+	unsigned int max_count = pPreferences->m_level_preload_count;
+
+	// keep the level the player is about to enter
+	if( m_first_started && !m_levels.empty() )
+	{
+		levels.push_back( m_levels[0] );
+		m_levels.erase( m_levels.begin() );
+		max_count++;
+	}
+
+	for( vector<std::string>::const_iterator itr = levelnames.begin(); itr != levelnames.end() && levels.size() < max_count; ++itr )
+	{
+		const std::string filename = Get_Level_Filename( (*itr) );
+
+		if( filename.empty() )
+		{
+			continue;
+		}
+
+		bool found = 0;
+
+		for( Preloaded_Level_List::const_iterator level_itr = levels.begin(); level_itr != levels.end(); ++level_itr )
+		{
+			if( (*level_itr).m_filename.compare( filename ) == 0 )
+			{
+				found = 1;
+				break;
+			}
+		}
+
+		if( found )
+		{
+			continue;
+		}
+
+		const int index = Get_Index( filename );
+
+		// already preloaded
+		if( index >= 0 )
+		{
+			levels.push_back( m_levels[index] );
+			m_levels.erase( m_levels.begin() + index );
+			continue;
+		}
+
+		Preloaded_Level level;
+		level.m_filename = filename;
+		level.m_binary = new cLevel_Binary();
+		level.m_loaded = 0;
+		levels.push_back( level );
+	}
+
+	// delete the levels which are not needed anymore
+	while( !m_levels.empty() )
+	{
+		Remove_Index( m_levels.size() - 1 );
+	}
+
+	m_levels = levels;
+	Update();
+}
+
+void cLevel_Preloader :: Update( void )
+{
+	Update_Task();
+
+	// read the next level if no task is reading
+	if( !m_loading && SDL_GetTicks() >= m_next_load_time )
+	{
+		for( Preloaded_Level_List::iterator itr = m_levels.begin(); itr != m_levels.end(); ++itr )
+		{
+			Preloaded_Level &level = (*itr);
+
+			if( level.m_loaded )
+			{
+				continue;
+			}
+
+			m_loading = level.m_binary;
+			m_task_finished = 0;
+			pTask_Pool->Add( boost::bind( &cLevel_Preloader::Load_Task, this, level.m_filename, level.m_binary ), TASK_PRIORITY_BACKGROUND, m_task_group, "level preload" );
+			break;
+		}
+	}
+
+	// only the images and sounds of the first level are decoded
+	if( !m_levels.empty() && m_levels[0].m_loaded && m_prefetch_filename.compare( m_levels[0].m_filename ) != 0 )
+	{
+		Start_Prefetch();
+	}
+}
+
+cLevel_Binary *cLevel_Preloader :: Take( const std::string &filename )
+{
+	int index = Get_Index( filename );
+
+	// the level decodes its own images
+	if( index < 0 )
+	{
+		m_prefetch.Stop();
+		m_manifest.Clear();
+		m_prefetch_filename.clear();
+		return NULL;
+	}
+
+	// wait for the task
+	if( m_loading == m_levels[index].m_binary )
+	{
+		pTask_Pool->Wait( m_task_group );
+		Update_Task();
+
+		index = Get_Index( filename );
+
+		if( index < 0 )
+		{
+			return NULL;
+		}
+	}
+
+	// not read yet
+	if( !m_levels[index].m_loaded )
+	{
+		return NULL;
+	}
+
+	if( index > 0 )
+	{
+		const Preloaded_Level level = m_levels[index];
+		m_levels.erase( m_levels.begin() + index );
+		m_levels.insert( m_levels.begin(), level );
+	}
+
+	if( m_prefetch_filename.compare( filename ) != 0 )
+	{
+		Start_Prefetch();
+	}
+
+	return m_levels[0].m_binary;
+}
+
+bool cLevel_Preloader :: Is_Reading( const std::string &levelname )
+{
+	Update_Task();
+
+	const std::string filename = Get_Level_Filename( levelname );
+
+	if( filename.empty() )
+	{
+		return 0;
+	}
+
+	const int index = Get_Index( filename );
+
+	return index >= 0 && !m_levels[index].m_loaded;
+}
+
+void cLevel_Preloader :: Remove( const std::string &filename )
+{
+	const int index = Get_Index( filename );
+
+	if( index >= 0 )
+	{
+		Remove_Index( index );
+	}
+}
+
+cLevel_Binary *cLevel_Preloader :: Release( const std::string &filename )
+{
+	const int index = Get_Index( filename );
+
+	if( index < 0 )
+	{
+		return NULL;
+	}
+
+	cLevel_Binary *binary = NULL;
+
+	// not deleted with the list entry
+	if( m_levels[index].m_loaded )
+	{
+		binary = m_levels[index].m_binary;
+		m_levels[index].m_binary = NULL;
+	}
+
+	Remove_Index( index );
+
+	return binary;
+}
+
+void cLevel_Preloader :: Clear( void )
+{
+	while( !m_levels.empty() )
+	{
+		Remove_Index( m_levels.size() - 1 );
+	}
+
+	m_prefetch.Stop();
+	m_manifest.Clear();
+	m_prefetch_filename.clear();
+}
+
+std::string cLevel_Preloader :: Get_Level_Filename( const std::string &levelname ) const
+{
+	// loaded levels are used directly
+	if( levelname.empty() || pLevel_Manager->Get( Trim_Filename( levelname, 0, 0 ) ) )
+	{
+		return "";
+	}
+
+	std::string filename = levelname;
+
+	if( !pLevel_Manager->Get_Path( filename ) || filename.rfind( ".smclvl" ) == std::string::npos )
+	{
+		return "";
+	}
+
+	return filename;
+}
+
+int cLevel_Preloader :: Get_Index( const std::string &filename ) const
+{
+	for( unsigned int i = 0; i < m_levels.size(); i++ )
+	{
+		if( m_levels[i].m_filename.compare( filename ) == 0 )
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+void cLevel_Preloader :: Remove_Index( unsigned int index )
+{
+	Preloaded_Level &level = m_levels[index];
+
+	if( level.m_binary && m_loading == level.m_binary )
+	{
+		pTask_Pool->Wait( m_task_group );
+		m_loading = NULL;
+	}
+
+	// delete the images which were not used
+	if( m_prefetch_filename.compare( level.m_filename ) == 0 )
+	{
+		m_prefetch.Stop();
+		m_manifest.Clear();
+		m_prefetch_filename.clear();
+	}
+
+	delete level.m_binary;
+	m_levels.erase( m_levels.begin() + index );
+
+	if( index == 0 )
+	{
+		m_first_started = 0;
+	}
+}
+
+void cLevel_Preloader :: Remove_Over_Limit( unsigned int max_count )
+{
+	// the first level is always kept
+	while( m_levels.size() > 1 )
+	{
+		size_t size = 0;
+
+		for( Preloaded_Level_List::const_iterator itr = m_levels.begin(); itr != m_levels.end(); ++itr )
+		{
+			size += (*itr).m_binary->Get_Size();
+		}
+
+		if( m_levels.size() <= max_count && size <= m_max_size )
+		{
+			break;
+		}
+
+		Remove_Index( m_levels.size() - 1 );
+	}
+}
+
+void cLevel_Preloader :: Update_Task( void )
+{
+	if( !m_loading || !Is_Task_Finished() )
+	{
+		return;
+	}
+
+	pTask_Pool->Wait( m_task_group );
+
+	cLevel_Binary *binary = m_loading;
+	m_loading = NULL;
+	// keep the worker time low while playing
+	m_next_load_time = SDL_GetTicks() + m_load_delay;
+
+	for( unsigned int i = 0; i < m_levels.size(); i++ )
+	{
+		if( m_levels[i].m_binary != binary )
+		{
+			continue;
+		}
+
+		// not trusted and not compiled
+		if( !binary->Is_Loaded() )
+		{
+			Remove_Index( i );
+			return;
+		}
+
+		m_levels[i].m_loaded = 1;
+		break;
+	}
+
+	Remove_Over_Limit( m_levels.size() );
+}
+
+void cLevel_Preloader :: Load_Task( const std::string filename, cLevel_Binary *binary )
+{
+	/* only levels which need no schema validation are loaded
+	 * as the CEGUI parser is only used from the main thread
+	*/
+	if( Is_XML_File_Trusted( filename, "Level.xsd" ) )
+	{
+		binary->Load( filename );
+	}
+	// an up to date compiled level is valid
+	else
+	{
+		const Uint64 source_hash = Get_File_Hash( filename );
+
+		if( source_hash )
+		{
+			binary->Load_Compiled( cLevel_Binary::Get_Cache_Filename( filename ), source_hash );
+		}
+	}
+
+	boost::mutex::scoped_lock lock( m_mutex );
+	m_task_finished = 1;
+}
+
+bool cLevel_Preloader :: Is_Task_Finished( void )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+	return m_task_finished;
+}
+
+void cLevel_Preloader :: Start_Prefetch( void )
+{
+	m_prefetch.Stop();
+	m_manifest.Clear();
+
+	const Preloaded_Level &level = m_levels[0];
+	m_prefetch_filename = level.m_filename;
+
+	if( !level.m_binary->Is_Loaded() )
+	{
+		return;
+	}
+
+	m_manifest.Load( level.m_filename );
+	m_prefetch.Start( *level.m_binary, &m_manifest );
+
+	// sounds used the last time in the order of their first use
+	cLevel_Manifest::File_List sounds;
+	m_manifest.Get_Sorted_Sounds( sounds );
+
+	for( cLevel_Manifest::File_List::const_iterator itr = sounds.begin(); itr != sounds.end(); ++itr )
+	{
+		pAudio->Preload_Sound( (*itr) );
+	}
+
+	// sounds of the level
+	for( unsigned int i = 0; i < level.m_binary->Get_Element_Count(); i++ )
+	{
+		if( strcmp( level.m_binary->Get_Element_Name( i ), "sound" ) != 0 )
+		{
+			continue;
+		}
+
+		CEGUI::XMLAttributes attributes;
+		level.m_binary->Get_Attributes( i, attributes );
+
+		const std::string filename = attributes.getValueAsString( "file" ).c_str();
+
+		if( !filename.empty() )
+		{
+			pAudio->Preload_Sound( filename );
+		}
+	}
+}
+
+cLevel_Preloader *pLevel_Preloader = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
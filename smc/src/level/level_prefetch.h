@@ -0,0 +1,207 @@
+/***************************************************************************
+ * level_prefetch.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_LEVEL_PREFETCH_H
+#define SMC_LEVEL_PREFETCH_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../level/level_manifest.h"
+// SDL
+#include "SDL.h"
+// CEGUI
+#include "CEGUIXMLHandler.h"
+#include "CEGUIXMLAttributes.h"
+// boost thread
+#include <boost/thread/mutex.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Prefetch *** *** *** *** *** *** *** *** *** *** */
+
+/* Reads the image filenames of a level and decodes them in the background
+ * while the level objects are created
+ * the images near the player start position are decoded first
+*/
+class cLevel_Prefetch : public CEGUI::XMLHandler
+{
+public:
+	cLevel_Prefetch( void );
+	virtual ~cLevel_Prefetch( void );
+
+	/* Read the level file and start decoding the images
+	 * the decoded images are used by cVideo::Get_Surface until Stop is called
+	 * manifest : if set its images are decoded after the level images
+	 * returns false if nothing gets decoded
+	*/
+	bool Start( const std::string &filename, const cLevel_Manifest *manifest = NULL );
+	// Start decoding the images of the compiled level
+	bool Start( const cLevel_Binary &binary, const cLevel_Manifest *manifest = NULL );
+	// Stop decoding and delete the images which were not used
+	void Stop( void );
+
+private:
+	// Sort the image requests and start decoding them with the manifest images
+	bool Start_Loader( const cLevel_Manifest *manifest );
+
+	// XML element start
+	virtual void elementStart( const CEGUI::String &element, const CEGUI::XMLAttributes &attributes );
+	// XML element end
+	virtual void elementEnd( const CEGUI::String &element );
+
+	// an image with the position where it is used
+	struct Image_Request
+	{
+		std::string m_filename;
+		float m_pos_x;
+		float m_pos_y;
+		// distance to the player start position
+		float m_distance;
+	};
+
+	// sorts by distance to the player start position
+	struct distance_sort
+	{
+		bool operator()( const Image_Request &a, const Image_Request &b ) const
+		{
+			return a.m_distance < b.m_distance;
+		}
+	};
+
+	typedef vector<Image_Request> Image_Request_List;
+	Image_Request_List m_requests;
+
+	// XML element Item Tag list
+	CEGUI::XMLAttributes m_xml_attributes;
+	// player start position
+	float m_player_pos_x;
+	float m_player_pos_y;
+
+	// background decoding or NULL if not started
+	cImage_Loader *m_loader;
+};
+
+/* *** *** *** *** *** *** *** cLevel_Preloader *** *** *** *** *** *** *** *** *** *** */
+
+/* Loads the next levels in the background before the player gets there
+ * the compiled levels are loaded one after another as task pool background tasks
+ * and afterwards the images and sounds of the first level are decoded while the game continues
+ * only the objects are created when the level gets loaded
+*/
+class cLevel_Preloader
+{
+public:
+	cLevel_Preloader( void );
+	~cLevel_Preloader( void );
+
+	/* Start preloading the level before the other levels
+	 * does nothing if it is already loaded or preloaded first
+	*/
+	void Start( std::string levelname );
+	/* Preload the following levels of the campaign in the given order
+	 * levels not in the list are deleted except the first level if set with Start
+	 * the list is cut to the preload count preference
+	*/
+	void Set_Next( const vector<std::string> &levelnames );
+	// Continue preloading if a level was read
+	void Update( void );
+	/* Returns the compiled level if the full level filename was preloaded or NULL
+	 * it stays valid until Remove or Clear is called
+	*/
+	cLevel_Binary *Take( const std::string &filename );
+	/* Returns true if the level is preloaded but not read yet
+	 * so it can be waited for without blocking
+	*/
+	bool Is_Reading( const std::string &levelname );
+	// Delete the preloaded level with the full level filename
+	void Remove( const std::string &filename );
+	/* Remove the preloaded level with the full level filename
+	 * and return the compiled level if it was read or NULL
+	 * the caller deletes it
+	*/
+	cLevel_Binary *Release( const std::string &filename );
+	// Stop preloading and delete the preloaded data
+	void Clear( void );
+
+	// minimum time between loading levels in milliseconds
+	static const Uint32 m_load_delay = 250;
+	// maximum size of all compiled levels
+	static const size_t m_max_size = 16 * 1024 * 1024;
+
+private:
+	// a preloaded level
+	struct Preloaded_Level
+	{
+		// full level filename
+		std::string m_filename;
+		// compiled level
+		cLevel_Binary *m_binary;
+		// if the task finished reading it
+		bool m_loaded;
+	};
+
+	typedef vector<Preloaded_Level> Preloaded_Level_List;
+
+	/* Returns the full level filename if the level can be preloaded
+	 * or an empty string if not found or already loaded
+	*/
+	std::string Get_Level_Filename( const std::string &levelname ) const;
+	// Returns the list index of the full level filename or -1 if not found
+	int Get_Index( const std::string &filename ) const;
+	// Delete the preloaded level at the list index
+	void Remove_Index( unsigned int index );
+	// Delete the last levels until the list size and the compiled size fit in the limits
+	void Remove_Over_Limit( unsigned int max_count );
+	// Mark the level as loaded if the task finished
+	void Update_Task( void );
+	// Load the compiled level as task
+	void Load_Task( const std::string filename, cLevel_Binary *binary );
+	// Returns true if the task is finished
+	bool Is_Task_Finished( void );
+	// Start decoding the images and sounds of the first level
+	void Start_Prefetch( void );
+
+	// first is the level the player is going to enter next
+	Preloaded_Level_List m_levels;
+	// if the first level was set with Start
+	bool m_first_started;
+	// compiled level the task is reading or NULL
+	cLevel_Binary *m_loading;
+	// time the next level can be read
+	Uint32 m_next_load_time;
+
+	// decodes the level images
+	cLevel_Prefetch m_prefetch;
+	// full filename of the level the images and sounds were started for
+	std::string m_prefetch_filename;
+	// images and sounds used the last time
+	cLevel_Manifest m_manifest;
+
+	// task pool group of the level reading
+	unsigned int m_task_group;
+	boost::mutex m_mutex;
+	// if the task is finished
+	bool m_task_finished;
+};
+
+// Level preloader
+extern cLevel_Preloader *pLevel_Preloader;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -0,0 +1,250 @@
+/***************************************************************************
+ * level_preview.cpp  -  overview images of levels and worlds
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../level/level_preview.h"
+#include "../core/game_core.h"
+#include "../core/sprite_manager.h"
+#include "../core/task_pool.h"
+#include "../core/filesystem/filesystem.h"
+#include "../core/filesystem/resource_manager.h"
+#include "../objects/sprite.h"
+#include "../video/video.h"
+#include "../video/renderer.h"
+#include "../video/render_target.h"
+#include "../video/gl_surface.h"
+// SDL
+#include "SDL_image.h"
+// boost
+#include <boost/bind.hpp>
+#include <cstdio>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Preview *** *** *** *** *** *** *** *** *** *** */
+
+// Task function which saves and deletes the preview
+static void Save_Preview_Task( cLevel_Preview *preview, const std::string filename )
+{
+	preview->Save( filename );
+	delete preview;
+}
+
+cLevel_Preview :: cLevel_Preview( void )
+{
+	//
+}
+
+cLevel_Preview :: ~cLevel_Preview( void )
+{
+	//
+}
+
+bool cLevel_Preview :: Create( cSprite_Manager *sprite_manager, const Color &background )
+{
+	m_pixels.clear();
+
+	// area of all drawn sprites
+	GL_rect area;
+	bool found = 0;
+
+	for( cSprite_List::const_iterator itr = sprite_manager->objects.begin(); itr != sprite_manager->objects.end(); ++itr )
+	{
+		const cSprite *obj = (*itr);
+
+		if( !obj->m_image || obj->m_spawned || obj->m_auto_destroy )
+		{
+			continue;
+		}
+
+		if( !found )
+		{
+			area = obj->m_rect;
+			found = 1;
+			continue;
+		}
+
+		const float x2 = std::max( area.m_x + area.m_w, obj->m_rect.m_x + obj->m_rect.m_w );
+		const float y2 = std::max( area.m_y + area.m_h, obj->m_rect.m_y + obj->m_rect.m_h );
+
+		area.m_x = std::min( area.m_x, obj->m_rect.m_x );
+		area.m_y = std::min( area.m_y, obj->m_rect.m_y );
+		area.m_w = x2 - area.m_x;
+		area.m_h = y2 - area.m_y;
+	}
+
+	if( !found || area.m_w <= 0.0f || area.m_h <= 0.0f )
+	{
+		return 0;
+	}
+
+	// keep the aspect ratio of the image and center the area
+	const float aspect = static_cast<float>(m_width) / static_cast<float>(m_height);
+
+	if( area.m_w / area.m_h > aspect )
+	{
+		const float h = area.m_w / aspect;
+		area.m_y -= ( h - area.m_h ) * 0.5f;
+		area.m_h = h;
+	}
+	else
+	{
+		const float w = area.m_h * aspect;
+		area.m_x -= ( w - area.m_w ) * 0.5f;
+		area.m_w = w;
+	}
+
+	const unsigned int width = m_width * m_supersampling;
+	const unsigned int height = m_height * m_supersampling;
+
+	pVideo->Render_Finish();
+
+	cRender_Target target;
+
+	if( !target.Init( width, height ) || !target.Bind() )
+	{
+		printf( "Warning : cLevel_Preview : offscreen drawing not available\n" );
+		return 0;
+	}
+
+	// the requests are in screen coordinates
+	glMatrixMode( GL_PROJECTION );
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho( area.m_x * global_upscalex, ( area.m_x + area.m_w ) * global_upscalex, ( area.m_y + area.m_h ) * global_upscaley, area.m_y * global_upscaley, -1, 1 );
+	glMatrixMode( GL_MODELVIEW );
+
+	glClearColor( background.red / 255.0f, background.green / 255.0f, background.blue / 255.0f, 1.0f );
+	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+	glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
+
+	// the whole area is drawn at once
+	cRenderQueue queue( sprite_manager->size() );
+	queue.m_culling = 0;
+	queue.m_camera_x = 0.0f;
+	queue.m_camera_y = 0.0f;
+	queue.m_camera_saved = 1;
+
+	cRenderQueue *renderer = pRenderer;
+	pRenderer = &queue;
+
+	for( cSprite_List::iterator itr = sprite_manager->objects.begin(); itr != sprite_manager->objects.end(); ++itr )
+	{
+		cSprite *obj = (*itr);
+
+		if( !obj->m_image || obj->m_spawned || obj->m_auto_destroy )
+		{
+			continue;
+		}
+
+		// sprites outside of the screen are not valid for drawing
+		const bool valid_draw = obj->m_valid_draw;
+		obj->m_valid_draw = 1;
+		obj->Draw_Image();
+		obj->m_valid_draw = valid_draw;
+	}
+
+	pRenderer = renderer;
+	queue.Render();
+
+	vector<unsigned char> pixels( width * height * 4 );
+	glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+	glReadPixels( 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0] );
+
+	glMatrixMode( GL_PROJECTION );
+	glPopMatrix();
+	glMatrixMode( GL_MODELVIEW );
+	target.Unbind();
+
+	m_pixels.resize( m_width * m_height * 4 );
+	pVideo->Downscale_Image( &pixels[0], width, height, 4, &m_pixels[0], m_supersampling, m_supersampling );
+
+	// the blending changed the alpha of the framebuffer
+	for( unsigned int i = 3; i < m_pixels.size(); i += 4 )
+	{
+		m_pixels[i] = 255;
+	}
+
+	return 1;
+}
+
+void cLevel_Preview :: Save( const std::string &filename ) const
+{
+	if( m_pixels.empty() )
+	{
+		return;
+	}
+
+	pVideo->Save_Surface( Get_Cache_Filename( filename ), &m_pixels[0], m_width, m_height, 4, 1 );
+}
+
+void cLevel_Preview :: Update( const std::string &filename, cSprite_Manager *sprite_manager, const Color &background )
+{
+	if( Is_Cached( filename ) )
+	{
+		return;
+	}
+
+	cLevel_Preview *preview = new cLevel_Preview();
+
+	if( !preview->Create( sprite_manager, background ) )
+	{
+		delete preview;
+		return;
+	}
+
+	pTask_Pool->Add( boost::bind( &Save_Preview_Task, preview, filename ), TASK_PRIORITY_BACKGROUND, 0, "level preview" );
+}
+
+cGL_Surface *cLevel_Preview :: Load( const std::string &filename )
+{
+	if( !Is_Cached( filename ) )
+	{
+		return NULL;
+	}
+
+	const std::string cache_filename = Get_Cache_Filename( filename );
+	SDL_Surface *surface = IMG_Load_RW( Open_File_RW( cache_filename ), 1 );
+
+	if( !surface )
+	{
+		printf( "Warning : Could not load level preview %s\n", cache_filename.c_str() );
+		return NULL;
+	}
+
+	return pVideo->Create_Texture( surface );
+}
+
+bool cLevel_Preview :: Is_Cached( const std::string &filename )
+{
+	const std::string cache_filename = Get_Cache_Filename( filename );
+
+	return File_Exists( cache_filename ) && Get_File_Modification_Time( cache_filename ) >= Get_File_Modification_Time( filename );
+}
+
+std::string cLevel_Preview :: Get_Cache_Filename( const std::string &filename )
+{
+	// files with the same name in different directories
+	const Uint64 path_hash = Get_Data_Hash( filename.c_str(), filename.length() );
+
+	char hash_str[20];
+	sprintf( hash_str, "%08x%08x", static_cast<unsigned int>(path_hash >> 32), static_cast<unsigned int>(path_hash & 0xFFFFFFFF) );
+
+	return pResource_Manager->user_data_dir + USER_PREVIEW_CACHE_DIR "/" + Trim_Filename( filename, 0, 0 ) + "_" + hash_str + ".png";
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
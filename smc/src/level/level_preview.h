@@ -0,0 +1,79 @@
+/***************************************************************************
+ * level_preview.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_LEVEL_PREVIEW_H
+#define SMC_LEVEL_PREVIEW_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../video/color.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Preview *** *** *** *** *** *** *** *** *** *** */
+
+/* Small overview image of a level or world shown in the start menu
+ * the loaded sprites are drawn scaled down into an offscreen framebuffer
+ * when the level or world is saved or loaded without an up to date preview
+ * and the image is kept in the user cache directory next to the level index
+ * so the menu can show it without loading the level
+*/
+class cLevel_Preview
+{
+public:
+	cLevel_Preview( void );
+	~cLevel_Preview( void );
+
+	/* Draw the sprites scaled down to fit into the image
+	 * must be called from the main thread
+	 * background : clear color of the image
+	 * returns false if no sprite has an image or offscreen drawing is not available
+	*/
+	bool Create( cSprite_Manager *sprite_manager, const Color &background );
+	/* Save the image as the cached preview of the level or world file
+	 * can be used from any thread
+	*/
+	void Save( const std::string &filename ) const;
+
+	/* Create the preview if the cached one is missing or older than the level or world file
+	 * the image is saved in the background
+	*/
+	static void Update( const std::string &filename, cSprite_Manager *sprite_manager, const Color &background );
+	/* Load the cached preview of the level or world file
+	 * returns NULL if not cached or outdated
+	 * the returned image should be deleted if not used anymore
+	*/
+	static cGL_Surface *Load( const std::string &filename );
+	// Returns true if the cached preview exists and is not older than the level or world file
+	static bool Is_Cached( const std::string &filename );
+	// Returns the cached preview image filename of the level or world file
+	static std::string Get_Cache_Filename( const std::string &filename );
+
+	// image size
+	static const unsigned int m_width = 256;
+	static const unsigned int m_height = 144;
+	// the sprites are drawn at this multiple of the size and scaled down for smooth edges
+	static const unsigned int m_supersampling = 4;
+
+	// rgba pixels with the bottom row first
+	vector<unsigned char> m_pixels;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -0,0 +1,176 @@
+/***************************************************************************
+ * level_saver.cpp  -  background writing of saved levels
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../level/level_saver.h"
+#include "../core/game_core.h"
+#include "../core/i18n.h"
+#include "../core/property_helper.h"
+#include "../core/filesystem/filesystem.h"
+#include "../core/task_pool.h"
+#include "../gui/hud.h"
+#include "../level/level_preview.h"
+#include <cstdio>
+// boost
+#include <boost/bind.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Saver *** *** *** *** *** *** *** *** *** *** */
+
+cLevel_Saver :: cLevel_Saver( void )
+{
+	m_saving = 0;
+	m_success = 0;
+	m_task_finished = 1;
+	m_preview = NULL;
+	m_task_group = pTask_Pool->Create_Group();
+}
+
+cLevel_Saver :: ~cLevel_Saver( void )
+{
+	// never lose a save
+	pTask_Pool->Wait( m_task_group );
+
+	if( m_preview )
+	{
+		delete m_preview;
+	}
+}
+
+void cLevel_Saver :: Start( const std::string &filename, std::string &data, const std::string &old_filename /* = "" */, cLevel_Preview *preview /* = NULL */ )
+{
+	Wait();
+
+	m_filename = filename;
+	m_old_filename = old_filename;
+	m_data.swap( data );
+	m_preview = preview;
+	m_success = 0;
+	m_saving = 1;
+	m_task_finished = 0;
+	pTask_Pool->Add( boost::bind( &cLevel_Saver::Save_Task, this ), TASK_PRIORITY_BACKGROUND, m_task_group, "level save" );
+}
+
+void cLevel_Saver :: Update( void )
+{
+	if( !m_saving || !Is_Task_Finished() )
+	{
+		return;
+	}
+
+	Finish();
+}
+
+void cLevel_Saver :: Wait( void )
+{
+	if( !m_saving )
+	{
+		return;
+	}
+
+	Finish();
+}
+
+void cLevel_Saver :: Save_Task( void )
+{
+	// the level file is only replaced if the new one is complete
+	const std::string temp_filename = m_filename + ".tmp";
+
+#ifdef _WIN32
+	FILE *fp = _wfopen( utf8_to_ucs2( temp_filename ).c_str(), L"wb" );
+#else
+	FILE *fp = fopen( temp_filename.c_str(), "wb" );
+#endif
+
+	bool success = 0;
+
+	if( fp )
+	{
+		vector<char> compressed;
+
+		if( !Is_Compressed_File( m_filename ) )
+		{
+			success = fwrite( m_data.data(), m_data.size(), 1, fp ) == 1;
+		}
+		else if( Compress_Data( m_data.data(), m_data.size(), compressed ) )
+		{
+			success = fwrite( &compressed[0], compressed.size(), 1, fp ) == 1;
+		}
+
+		success = fflush( fp ) == 0 && success;
+		success = fclose( fp ) == 0 && success;
+
+		if( success )
+		{
+			success = Rename_File( temp_filename, m_filename );
+		}
+
+		// the file in the other format would be used instead
+		if( success && !m_old_filename.empty() )
+		{
+			Delete_File( m_old_filename );
+		}
+
+		if( !success )
+		{
+			Delete_File( temp_filename );
+		}
+	}
+
+	// written after the level file to be newer than it
+	if( success && m_preview )
+	{
+		m_preview->Save( m_filename );
+	}
+
+	boost::mutex::scoped_lock lock( m_mutex );
+	m_success = success;
+	m_task_finished = 1;
+}
+
+bool cLevel_Saver :: Is_Task_Finished( void )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+	return m_task_finished;
+}
+
+void cLevel_Saver :: Finish( void )
+{
+	pTask_Pool->Wait( m_task_group );
+	m_saving = 0;
+	m_data.clear();
+
+	if( m_preview )
+	{
+		delete m_preview;
+		m_preview = NULL;
+	}
+
+	if( !m_success )
+	{
+		printf( "Error : Couldn't write level file %s. Is the file read-only ?\n", m_filename.c_str() );
+		pHud_Debug->Set_Text( _("Couldn't save level ") + m_filename, speedfactor_fps * 5.0f );
+		return;
+	}
+
+	pHud_Debug->Set_Text( _("Level ") + Trim_Filename( m_filename, 0, 0 ) + _(" saved") );
+}
+
+cLevel_Saver *pLevel_Saver = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
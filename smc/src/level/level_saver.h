@@ -0,0 +1,95 @@
+/***************************************************************************
+ * level_saver.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_LEVEL_SAVER_H
+#define SMC_LEVEL_SAVER_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+// boost thread
+#include <boost/thread/mutex.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Saver *** *** *** *** *** *** *** *** *** *** */
+
+/* Writes saved levels in the background
+ * the level is serialized into memory on the main thread
+ * and written to a temporary file which replaces the level file when complete
+ * the data is compressed first for a compressed level file
+ * the result is shown on the HUD with the next update
+*/
+class cLevel_Saver
+{
+public:
+	cLevel_Saver( void );
+	~cLevel_Saver( void );
+
+	/* Start writing the level data to the file
+	 * waits for the previous save to finish
+	 * the data gets compressed if the filename has the compressed file type
+	 * data : serialized level which is taken by swapping
+	 * old_filename : if set this file is deleted after the save as it is replaced by the new file
+	 * preview : if set it is saved after the level file and deleted
+	*/
+	void Start( const std::string &filename, std::string &data, const std::string &old_filename = "", cLevel_Preview *preview = NULL );
+	// Show the result if the save finished
+	void Update( void );
+	// Wait until the save finished and show the result
+	void Wait( void );
+
+	// Returns true if a save is not yet finished
+	inline bool Is_Saving( void ) const
+	{
+		return m_saving;
+	}
+
+private:
+	// Write the data as task pool background task
+	void Save_Task( void );
+	// Returns true if the task is finished
+	bool Is_Task_Finished( void );
+	// Show the result on the HUD
+	void Finish( void );
+
+	// full level filename
+	std::string m_filename;
+	// replaced level filename
+	std::string m_old_filename;
+	// serialized level
+	std::string m_data;
+	// preview image or NULL
+	cLevel_Preview *m_preview;
+	// if a save was started and the result is not yet shown
+	bool m_saving;
+	// if the file was replaced
+	bool m_success;
+
+	// task pool group of the save
+	unsigned int m_task_group;
+	boost::mutex m_mutex;
+	// if the task is finished
+	bool m_task_finished;
+};
+
+// Level saver
+extern cLevel_Saver *pLevel_Saver;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
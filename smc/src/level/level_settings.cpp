@@ -21,7 +21,7 @@
 #include "../video/font.h"
 #include "../video/renderer.h"
 #include "../core/filesystem/filesystem.h"
-#include "../core/framerate.h"
+#include "../core/profiler.h"
 #include "../audio/audio.h"
 #include "../gui/generic.h"
 #include "../core/i18n.h"
@@ -302,19 +302,17 @@ void cLevel_Settings :: Unload( void )
 
 void cLevel_Settings :: Update( void )
 {
-	// uhm...
+	cProfiler_Scope profile_scope( "level settings update" );
 
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_UPDATE_LEVEL_SETTINGS]->Update();
+	// uhm...
 }
 
 void cLevel_Settings :: Draw( void )
 {
+	cProfiler_Scope profile_scope( "level settings draw" );
+
 	pVideo->Clear_Screen();
 	pVideo->Draw_Rect( NULL, 0.00001f, &black );
-
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_DRAW_LEVEL_SETTINGS]->Update();
 }
 
 bool cLevel_Settings :: Key_Down( SDLKey key )
@@ -0,0 +1,408 @@
+/***************************************************************************
+ * level_stream.cpp  -  creates the objects of huge levels near the camera
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../level/level_stream.h"
+#include "../level/level.h"
+#include "../core/game_core.h"
+#include "../core/sprite_manager.h"
+#include "../core/camera.h"
+#include "../core/framerate.h"
+#include <cmath>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cLevel_Stream *** *** *** *** *** *** *** *** *** *** */
+
+// chunk width and height
+static const float level_stream_chunk_size = 1024.0f;
+// distance to the camera in which chunks get created
+static const float level_stream_load_distance = 2048.0f;
+// distance to the camera after which chunks get stored
+static const float level_stream_store_distance = 3072.0f;
+// frames between checking for far chunks
+static const float level_stream_store_interval = 30.0f;
+
+cLevel_Stream :: cLevel_Stream( cLevel *level )
+{
+	m_level = level;
+	m_sprite_manager = level->m_sprite_manager;
+	m_engine_version = level_engine_version;
+	m_store_counter = level_stream_store_interval;
+}
+
+cLevel_Stream :: ~cLevel_Stream( void )
+{
+	for( vector<Object>::iterator itr = m_objects.begin(); itr != m_objects.end(); ++itr )
+	{
+		delete itr->m_state;
+	}
+}
+
+bool cLevel_Stream :: Add( const CEGUI::String &element, const CEGUI::XMLAttributes &attributes, int engine_version, unsigned int level_num )
+{
+	// older levels get positions and objects changed when created
+	if( engine_version < 35 )
+	{
+		return 0;
+	}
+
+	// only objects without links to other objects
+	if( element != "sprite" && element != "box" && element != "item" && element != "powerup" && element != "enemy" )
+	{
+		return 0;
+	}
+
+	if( attributes.exists( "identifier" ) || attributes.exists( "path_identifier" ) )
+	{
+		return 0;
+	}
+
+	if( element == "enemy" )
+	{
+		const CEGUI::String type = attributes.getValueAsString( "type" );
+
+		if( type == "turtleboss" || type == "static" )
+		{
+			return 0;
+		}
+	}
+
+	m_engine_version = engine_version;
+
+	const int chunk_x = Get_Chunk_Pos( attributes.getValueAsFloat( "posx" ) );
+	const int chunk_y = Get_Chunk_Pos( attributes.getValueAsFloat( "posy" ) );
+	const Uint32 key = Get_Chunk_Key( chunk_x, chunk_y );
+
+	unsigned int chunk_num;
+	Chunk_Map::const_iterator chunk_itr = m_chunk_map.find( key );
+
+	if( chunk_itr != m_chunk_map.end() )
+	{
+		chunk_num = chunk_itr->second;
+	}
+	else
+	{
+		chunk_num = m_chunks.size();
+
+		Chunk chunk;
+		chunk.m_x = chunk_x;
+		chunk.m_y = chunk_y;
+		chunk.m_loaded = 0;
+		chunk.m_store = 0;
+		m_chunks.push_back( chunk );
+		m_chunk_map[key] = chunk_num;
+	}
+
+	Object obj;
+	obj.m_chunk = chunk_num;
+	obj.m_level_num = level_num;
+	obj.m_state = NULL;
+	obj.m_destroyed = 0;
+
+	obj.m_data.append( element.c_str() );
+	obj.m_data.push_back( '\0' );
+
+	for( unsigned int i = 0; i < attributes.getCount(); i++ )
+	{
+		obj.m_data.append( attributes.getName( i ).c_str() );
+		obj.m_data.push_back( '\0' );
+		obj.m_data.append( attributes.getValue( i ).c_str() );
+		obj.m_data.push_back( '\0' );
+	}
+
+	m_chunks[chunk_num].m_objects.push_back( m_objects.size() );
+	m_objects.push_back( obj );
+
+	return 1;
+}
+
+void cLevel_Stream :: Update( void )
+{
+	Load_Range( pActive_Camera->Get_Rect() );
+	// where the camera is moving to
+	Load_Range( pActive_Camera->Get_Predicted_Rect() );
+
+	m_store_counter -= pFramerate->m_speed_factor;
+
+	if( m_store_counter > 0.0f )
+	{
+		return;
+	}
+
+	m_store_counter = level_stream_store_interval;
+	Store_Far_Chunks();
+}
+
+void cLevel_Stream :: Load_Range( const GL_rect &rect )
+{
+	const int start_x = Get_Chunk_Pos( rect.m_x - level_stream_load_distance );
+	const int end_x = Get_Chunk_Pos( rect.m_x + rect.m_w + level_stream_load_distance );
+	const int start_y = Get_Chunk_Pos( rect.m_y - level_stream_load_distance );
+	const int end_y = Get_Chunk_Pos( rect.m_y + rect.m_h + level_stream_load_distance );
+
+	for( int y = start_y; y <= end_y; y++ )
+	{
+		for( int x = start_x; x <= end_x; x++ )
+		{
+			Chunk_Map::const_iterator itr = m_chunk_map.find( Get_Chunk_Key( x, y ) );
+
+			if( itr == m_chunk_map.end() || m_chunks[itr->second].m_loaded )
+			{
+				continue;
+			}
+
+			Load_Chunk( itr->second );
+		}
+	}
+}
+
+void cLevel_Stream :: Load_All( void )
+{
+	for( unsigned int i = 0; i < m_chunks.size(); i++ )
+	{
+		if( m_chunks[i].m_loaded )
+		{
+			continue;
+		}
+
+		Load_Chunk( i );
+	}
+}
+
+bool cLevel_Stream :: Load_Chunk_At( float pos_x, float pos_y )
+{
+	Chunk_Map::const_iterator itr = m_chunk_map.find( Get_Chunk_Key( Get_Chunk_Pos( pos_x ), Get_Chunk_Pos( pos_y ) ) );
+
+	if( itr == m_chunk_map.end() || m_chunks[itr->second].m_loaded )
+	{
+		return 0;
+	}
+
+	Load_Chunk( itr->second );
+	return 1;
+}
+
+void cLevel_Stream :: Save_To_Savegame( Save_Level_ObjectList &save_objects ) const
+{
+	for( vector<Object>::const_iterator itr = m_objects.begin(); itr != m_objects.end(); ++itr )
+	{
+		const Object &obj = (*itr);
+
+		// created objects are saved by the level
+		if( !obj.m_state || m_chunks[obj.m_chunk].m_loaded )
+		{
+			continue;
+		}
+
+		cSave_Level_Object *save_object = new cSave_Level_Object( *obj.m_state );
+		save_object->m_level_num = obj.m_level_num;
+		save_objects.push_back( save_object );
+	}
+}
+
+int cLevel_Stream :: Get_Chunk_Pos( float pos )
+{
+	return static_cast<int>(floor( pos / level_stream_chunk_size ));
+}
+
+void cLevel_Stream :: Load_Chunk( unsigned int chunk_num )
+{
+	Chunk &chunk = m_chunks[chunk_num];
+
+	chunk.m_loaded = 1;
+	chunk.m_store = 0;
+	m_loaded_chunks.push_back( chunk_num );
+
+	cSprite_List sprites;
+	sprites.reserve( chunk.m_objects.size() );
+
+	for( vector<unsigned int>::const_iterator itr = chunk.m_objects.begin(); itr != chunk.m_objects.end(); ++itr )
+	{
+		Object &obj = m_objects[*itr];
+
+		// destroyed in the game
+		if( obj.m_destroyed )
+		{
+			continue;
+		}
+
+		// element name followed by the attributes
+		const char *data = obj.m_data.c_str();
+		const char *data_end = data + obj.m_data.size();
+
+		const CEGUI::String element = reinterpret_cast<const CEGUI::utf8 *>(data);
+		data += strlen( data ) + 1;
+
+		CEGUI::XMLAttributes attributes;
+
+		while( data < data_end )
+		{
+			const char *name = data;
+			data += strlen( data ) + 1;
+			const char *value = data;
+			data += strlen( data ) + 1;
+
+			attributes.add( reinterpret_cast<const CEGUI::utf8 *>(name), reinterpret_cast<const CEGUI::utf8 *>(value) );
+		}
+
+		cSprite *sprite = Create_Level_Object_From_XML( element, attributes, m_engine_version, m_sprite_manager );
+
+		if( !sprite )
+		{
+			continue;
+		}
+
+		sprite->m_stream_num = *itr;
+		sprite->m_level_num = obj.m_level_num;
+		sprites.push_back( sprite );
+	}
+
+	// added at once
+	m_sprite_manager->Add_Objects( sprites );
+
+	for( cSprite_List::iterator itr = sprites.begin(); itr != sprites.end(); ++itr )
+	{
+		cSprite *sprite = (*itr);
+		Object &obj = m_objects[sprite->m_stream_num];
+
+		sprite->Init_Links();
+		m_level->Set_Pristine( sprite );
+
+		// restore the state from the last storing
+		if( obj.m_state )
+		{
+			sprite->Load_From_Savegame( obj.m_state );
+			delete obj.m_state;
+			obj.m_state = NULL;
+		}
+	}
+}
+
+void cLevel_Stream :: Store_Far_Chunks( void )
+{
+	const GL_rect camera_rect( pActive_Camera->m_x, pActive_Camera->m_y, static_cast<float>(game_res_w), static_cast<float>(game_res_h) );
+	const GL_rect store_rect( camera_rect.m_x - level_stream_store_distance, camera_rect.m_y - level_stream_store_distance, camera_rect.m_w + ( level_stream_store_distance * 2 ), camera_rect.m_h + ( level_stream_store_distance * 2 ) );
+	// objects in this area keep their chunk created
+	const GL_rect keep_rect( camera_rect.m_x - level_stream_load_distance, camera_rect.m_y - level_stream_load_distance, camera_rect.m_w + ( level_stream_load_distance * 2 ), camera_rect.m_h + ( level_stream_load_distance * 2 ) );
+
+	bool store = 0;
+
+	for( vector<unsigned int>::const_iterator itr = m_loaded_chunks.begin(); itr != m_loaded_chunks.end(); ++itr )
+	{
+		Chunk &chunk = m_chunks[*itr];
+		const GL_rect chunk_rect( chunk.m_x * level_stream_chunk_size, chunk.m_y * level_stream_chunk_size, level_stream_chunk_size, level_stream_chunk_size );
+
+		if( store_rect.Intersects( chunk_rect ) )
+		{
+			continue;
+		}
+
+		chunk.m_store = 1;
+		store = 1;
+	}
+
+	if( !store )
+	{
+		return;
+	}
+
+	// keep the chunks with objects which moved near the camera
+	for( cSprite_List::const_iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+	{
+		const cSprite *sprite = (*itr);
+
+		if( sprite->m_stream_num < 0 || sprite->m_auto_destroy )
+		{
+			continue;
+		}
+
+		Chunk &chunk = m_chunks[m_objects[sprite->m_stream_num].m_chunk];
+
+		if( !chunk.m_store )
+		{
+			continue;
+		}
+
+		if( sprite->m_disallow_managed_delete || keep_rect.Intersects( sprite->m_rect ) )
+		{
+			chunk.m_store = 0;
+		}
+	}
+
+	// objects not found anymore were destroyed in the game
+	for( vector<unsigned int>::const_iterator itr = m_loaded_chunks.begin(); itr != m_loaded_chunks.end(); ++itr )
+	{
+		const Chunk &chunk = m_chunks[*itr];
+
+		if( !chunk.m_store )
+		{
+			continue;
+		}
+
+		for( vector<unsigned int>::const_iterator obj_itr = chunk.m_objects.begin(); obj_itr != chunk.m_objects.end(); ++obj_itr )
+		{
+			m_objects[*obj_itr].m_destroyed = 1;
+		}
+	}
+
+	for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+	{
+		cSprite *sprite = (*itr);
+
+		if( sprite->m_stream_num < 0 || sprite->m_auto_destroy )
+		{
+			continue;
+		}
+
+		Object &obj = m_objects[sprite->m_stream_num];
+
+		if( !m_chunks[obj.m_chunk].m_store )
+		{
+			continue;
+		}
+
+		obj.m_destroyed = 0;
+		delete obj.m_state;
+		obj.m_state = sprite->Save_To_Savegame();
+
+		// deleted at the end of the frame without the destroy effects
+		sprite->m_stream_num = -1;
+		sprite->cSprite::Destroy();
+	}
+
+	vector<unsigned int>::iterator kept_itr = m_loaded_chunks.begin();
+
+	for( vector<unsigned int>::iterator itr = m_loaded_chunks.begin(); itr != m_loaded_chunks.end(); ++itr )
+	{
+		Chunk &chunk = m_chunks[*itr];
+
+		if( chunk.m_store )
+		{
+			chunk.m_store = 0;
+			chunk.m_loaded = 0;
+			continue;
+		}
+
+		*kept_itr = *itr;
+		++kept_itr;
+	}
+
+	m_loaded_chunks.erase( kept_itr, m_loaded_chunks.end() );
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
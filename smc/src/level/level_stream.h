@@ -0,0 +1,138 @@
+/***************************************************************************
+ * level_stream.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_LEVEL_STREAM_H
+#define SMC_LEVEL_STREAM_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../core/math/rect.h"
+#include "../user/savegame.h"
+// SDL
+#include "SDL.h"
+// CEGUI
+#include "CEGUIXMLAttributes.h"
+// boost
+#include <boost/unordered_map.hpp>
+
+namespace SMC
+{
+
+// minimum number of level elements to stream the level objects
+static const unsigned int level_stream_min_elements = 4000;
+
+/* *** *** *** *** *** *** *** cLevel_Stream *** *** *** *** *** *** *** *** *** *** */
+
+/* Keeps only the level objects near the camera created
+ * the objects are sorted into chunks by their start position when the level loads
+ * a chunk is created when it gets near the camera
+ * and stored again as its XML attributes when it and its objects are far away
+ * the object state is kept with the savegame data of the object
+ * objects with links to other objects are not streamed
+*/
+class cLevel_Stream
+{
+public:
+	cLevel_Stream( cLevel *level );
+	~cLevel_Stream( void );
+
+	/* Add the level object to its chunk instead of creating it
+	 * returns false if the object can not be streamed and needs to be created
+	*/
+	bool Add( const CEGUI::String &element, const CEGUI::XMLAttributes &attributes, int engine_version, unsigned int level_num );
+
+	// Create the chunks near the camera and store the far ones
+	void Update( void );
+	// Create the chunks near the rectangle
+	void Load_Range( const GL_rect &rect );
+	// Create every chunk
+	void Load_All( void );
+	/* Create the chunk of the start position
+	 * returns false if no chunk is there or it is already created
+	*/
+	bool Load_Chunk_At( float pos_x, float pos_y );
+
+	// Add the savegame data of the objects in the stored chunks
+	void Save_To_Savegame( Save_Level_ObjectList &save_objects ) const;
+
+	// Returns the number of stored objects
+	inline unsigned int Get_Object_Count( void ) const
+	{
+		return m_objects.size();
+	}
+
+private:
+	// stored level object
+	struct Object
+	{
+		// element name and the attribute names and values separated by zeros
+		std::string m_data;
+		// chunk number
+		unsigned int m_chunk;
+		// object number in the level file
+		unsigned int m_level_num;
+		// object state from the last storing or NULL
+		cSave_Level_Object *m_state;
+		// if it was destroyed while created
+		bool m_destroyed;
+	};
+
+	// objects in a square of the level
+	struct Chunk
+	{
+		int m_x;
+		int m_y;
+		// object numbers
+		vector<unsigned int> m_objects;
+		// if the objects are created
+		bool m_loaded;
+		// if it gets stored
+		bool m_store;
+	};
+
+	// Returns the chunk position of the level position
+	static int Get_Chunk_Pos( float pos );
+	// Returns the chunk key of the chunk position
+	static inline Uint32 Get_Chunk_Key( int x, int y )
+	{
+		return static_cast<Uint32>(static_cast<Uint16>(x)) | ( static_cast<Uint32>(static_cast<Uint16>(y)) << 16 );
+	}
+
+	// Create the objects of the chunk
+	void Load_Chunk( unsigned int chunk_num );
+	// Save the state of the objects in the far chunks and destroy them
+	void Store_Far_Chunks( void );
+
+	cLevel *m_level;
+	cSprite_Manager *m_sprite_manager;
+	// engine version of the level attributes
+	int m_engine_version;
+
+	vector<Object> m_objects;
+	vector<Chunk> m_chunks;
+	// chunk number by chunk key
+	typedef boost::unordered_map<Uint32, unsigned int> Chunk_Map;
+	Chunk_Map m_chunk_map;
+	// created chunks
+	vector<unsigned int> m_loaded_chunks;
+	// time until the far chunks are checked
+	float m_store_counter;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
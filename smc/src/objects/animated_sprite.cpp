@@ -46,6 +46,7 @@ cAnimated_Sprite :: cAnimated_Sprite( cSprite_Manager *sprite_manager, std::stri
 	m_anim_time_default = 1000;
 	m_anim_counter = 0;
 	m_anim_mod = 1.0f;
+	m_anim_shared = 0;
 }
 
 cAnimated_Sprite :: ~cAnimated_Sprite( void )
@@ -109,8 +110,8 @@ void cAnimated_Sprite :: Clear_Images( void )
 
 void cAnimated_Sprite :: Update_Animation( void )
 {
-	// if not valid
-	if( !m_anim_enabled || m_anim_img_end == 0 )
+	// if not valid or set when drawn
+	if( !m_anim_enabled || m_anim_img_end == 0 || m_anim_shared )
 	{
 		return;
 	}
@@ -141,6 +142,45 @@ void cAnimated_Sprite :: Update_Animation( void )
 	}
 }
 
+void cAnimated_Sprite :: Update_Shared_Animation( void )
+{
+	// if not valid
+	if( !m_anim_enabled || m_anim_img_end == 0 || !m_sprite_manager )
+	{
+		return;
+	}
+
+	// out of range
+	if( m_anim_img_start < 0 || m_anim_img_end >= static_cast<int>(m_images.size()) || m_anim_img_start > m_anim_img_end )
+	{
+		return;
+	}
+
+	Uint32 cycle_time = 0;
+
+	for( int i = m_anim_img_start; i <= m_anim_img_end; i++ )
+	{
+		cycle_time += m_images[i].m_time;
+	}
+
+	if( !cycle_time )
+	{
+		return;
+	}
+
+	// position in the animation cycle
+	Uint32 time = static_cast<Uint32>(m_sprite_manager->m_animation_time * m_anim_mod) % cycle_time;
+	int num = m_anim_img_start;
+
+	while( time >= m_images[num].m_time )
+	{
+		time -= m_images[num].m_time;
+		num++;
+	}
+
+	Set_Image_Num( num );
+}
+
 void cAnimated_Sprite :: Set_Time_All( const Uint32 time, const bool default_time /* = 0 */ )
 {
 	for( cAnimation_Surface_List::iterator itr = m_images.begin(); itr != m_images.end(); ++itr )
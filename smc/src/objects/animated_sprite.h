@@ -77,9 +77,22 @@ public:
 		m_anim_counter = 0;
 	};
 
-	// update animation
+	/* update animation
+	 * does nothing if the shared animation time is used
+	*/
 	void Update_Animation( void );
 
+	/* Set if the animation uses the shared animation time of the sprite manager
+	 * sprites with the same images and times then animate in lockstep
+	 * and their image is only set when drawn with Update_Shared_Animation
+	*/
+	inline void Set_Animation_Shared( const bool enabled = 1 )
+	{
+		m_anim_shared = enabled;
+	};
+	// Set the image for the shared animation time
+	void Update_Shared_Animation( void );
+
 	// Set default image display time
 	inline void Set_Default_Time( const Uint32 time = 1000 )
 	{
@@ -116,6 +129,8 @@ public:
 	Uint32 m_anim_counter;
 	// animation speed modifier
 	float m_anim_mod;
+	// if the shared animation time is used
+	bool m_anim_shared;
 
 	// Surface list
 	typedef vector<cAnimation_Surface> cAnimation_Surface_List;
@@ -25,10 +25,15 @@
 #include "../gui/hud.h"
 #include "../core/sprite_manager.h"
 #include "../user/savegame.h"
+#include "../core/memory_pool.h"
+#include "../core/engine_context.h"
 
 namespace SMC
 {
 
+// fireballs and iceballs are often thrown
+static cMemory_Pool ball_pool( "Ball", sizeof( cBall ), 10, 50, &sprite_memory );
+
 /* *** *** *** *** *** *** cBall *** *** *** *** *** *** *** *** *** *** *** */
 
 cBall :: cBall( cSprite_Manager *sprite_manager )
@@ -53,10 +58,23 @@ cBall :: ~cBall( void )
 	}
 }
 
+void *cBall :: operator new( size_t size )
+{
+	return ball_pool.Get( size );
+}
+
+void cBall :: operator delete( void *ptr, size_t size )
+{
+	ball_pool.Release( ptr, size );
+}
+
 void cBall :: Init( void )
 {
 	m_sprite_array = ARRAY_ACTIVE;
 	m_type = TYPE_BALL;
+	m_col_valid_massive = COL_MASK_MASSIVE | COL_MASK_HALFMASSIVE;
+	// items are passive and other balls are ignored
+	m_col_layer_mask = COL_LAYER_SOLID | COL_LAYER_ACTIVE | COL_LAYER_ENEMY | COL_LAYER_PLAYER;
 	m_pos_z = 0.095f;
 	m_gravity_max = 20.0f;
 
@@ -94,10 +112,10 @@ void cBall :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Ball_Type( static_cast<ball_effect>(attributes.getValueAsInteger( "ball_type" )) );
 }
 
-void cBall :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cBall :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// position
 	Write_Property( stream, "posx", static_cast<int>( m_start_pos_x ) );
@@ -111,7 +129,7 @@ void cBall :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "ball_type", m_ball_type );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cBall :: Load_From_Savegame( cSave_Level_Object *save_object )
@@ -153,8 +171,8 @@ cSave_Level_Object *cBall :: Save_To_Savegame( void )
 
 	// default values
 	save_object->m_type = m_type;
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posx", int_to_string( static_cast<int>(m_start_pos_x) ) ) );
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posy", int_to_string( static_cast<int>(m_start_pos_y) ) ) );
+	save_object->m_posx = static_cast<int>(m_start_pos_x);
+	save_object->m_posy = static_cast<int>(m_start_pos_y);
 
 	// new position
 	save_object->m_properties.push_back( cSave_Level_Object_Property( "new_posx", int_to_string( static_cast<int>(m_pos_x) ) ) );
@@ -219,7 +237,7 @@ void cBall :: Destroy( void )
 
 	if( m_ball_type == FIREBALL_DEFAULT )
 	{
-		pActive_Animation_Manager->Add( new cAnimation_Fireball( m_sprite_manager, m_pos_x + m_col_rect.m_w / 2, m_pos_y + m_col_rect.m_h / 2 ) );
+		pActive_Animation_Manager->Add_Fireball( m_pos_x + m_col_rect.m_w / 2, m_pos_y + m_col_rect.m_h / 2 );
 	}
 	else if( m_ball_type == ICEBALL_DEFAULT )
 	{
@@ -448,33 +466,35 @@ void cBall :: Handle_Collision( cObjectCollision *collision )
 
 void cBall :: Handle_Collision_Player( cObjectCollision *collision )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	// velocity hit
 	if( collision->m_direction == DIR_LEFT )
 	{
-		if( pLevel_Player->m_velx > 0.0f )
+		if( level_player->m_velx > 0.0f )
 		{
-			pLevel_Player->m_velx *= 0.3f;
+			level_player->m_velx *= 0.3f;
 		}
 	}
 	else if( collision->m_direction == DIR_RIGHT )
 	{
-		if( pLevel_Player->m_velx < 0.0f )
+		if( level_player->m_velx < 0.0f )
 		{
-			pLevel_Player->m_velx *= 0.3f;
+			level_player->m_velx *= 0.3f;
 		}
 	}
 	else if( collision->m_direction == DIR_UP )
 	{
-		if( pLevel_Player->m_vely > 0.0f )
+		if( level_player->m_vely > 0.0f )
 		{
-			pLevel_Player->m_vely *= 0.2f;
+			level_player->m_vely *= 0.2f;
 		}
 	}
 	else if( collision->m_direction == DIR_DOWN )
 	{
-		if( pLevel_Player->m_vely < 0.0f )
+		if( level_player->m_vely < 0.0f )
 		{
-			pLevel_Player->m_vely *= 0.4f;
+			level_player->m_vely *= 0.4f;
 		}
 	}
 
@@ -546,7 +566,7 @@ void cBall :: Handle_Collision_Enemy( cObjectCollision *collision )
 
 			enemy->Set_Active( 0 );
 			enemy->DownGrade( 1 );
-			pLevel_Player->Add_Kill_Multiplier();
+			Get_Context()->Get_Level_Player()->Add_Kill_Multiplier();
 		}
 		else if( m_ball_type == ICEBALL_DEFAULT )
 		{
@@ -573,9 +593,7 @@ void cBall :: Handle_Collision_Massive( cObjectCollision *collision )
 			m_vely = -10.0f;	
 			
 			// create animation
-			cAnimation_Fireball *anim = new cAnimation_Fireball( m_sprite_manager, m_pos_x + m_col_rect.m_w / 2, m_pos_y + m_col_rect.m_h / 2 );
-			anim->Set_Fading_Speed( 3.0f );
-			pActive_Animation_Manager->Add( anim );
+			pActive_Animation_Manager->Add_Fireball( m_pos_x + m_col_rect.m_w / 2, m_pos_y + m_col_rect.m_h / 2, 5, 3.0f );
 		}
 		else if( m_ball_type == ICEBALL_DEFAULT )
 		{
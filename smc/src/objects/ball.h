@@ -34,6 +34,10 @@ public:
 	// destructor
 	virtual ~cBall( void );
 
+	// memory is reused from deleted balls
+	static void *operator new( size_t size );
+	static void operator delete( void *ptr, size_t size );
+
 	// init defaults
 	void Init( void );
 	// copy
@@ -41,7 +45,7 @@ public:
 	// load from stream
 	virtual void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream );
+	virtual void Save_To_XML( cXml_Writer &stream );
 
 	// load from savegame
 	virtual void Load_From_Savegame( cSave_Level_Object *save_object );
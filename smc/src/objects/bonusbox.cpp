@@ -25,6 +25,7 @@
 #include "../objects/goldpiece.h"
 #include "../core/sprite_manager.h"
 #include "../core/i18n.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -101,10 +102,10 @@ void cBonusBox :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	}
 }
 
-void cBonusBox :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cBonusBox :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	cBaseBox::Save_To_XML( stream );
 
@@ -117,7 +118,7 @@ void cBonusBox :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	}
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cBonusBox :: Set_Useable_Count( int count, bool new_startcount /* = 0 */ )
@@ -259,6 +260,8 @@ void cBonusBox :: Set_Goldcolor( DefaultColor new_color )
 
 void cBonusBox :: Activate( void )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	bool random = 0;
 
 	// random
@@ -293,14 +296,14 @@ void cBonusBox :: Activate( void )
 	Maryo_type current_maryo_type;
 
 	// use original type
-	if( pLevel_Player->m_maryo_type == MARYO_GHOST )
+	if( level_player->m_maryo_type == MARYO_GHOST )
 	{
-		current_maryo_type = pLevel_Player->m_maryo_type_temp_power;
+		current_maryo_type = level_player->m_maryo_type_temp_power;
 	}
 	// already using original type
 	else
 	{
-		current_maryo_type = pLevel_Player->m_maryo_type;
+		current_maryo_type = level_player->m_maryo_type;
 	}
 
 	// the item from this box
@@ -25,6 +25,7 @@
 #include "../core/sprite_manager.h"
 #include "../core/math/utilities.h"
 #include "../core/i18n.h"
+#include "../core/engine_context.h"
 #include "../enemies/turtle.h"
 #include "../enemies/bosses/turtle_boss.h"
 #include "../gui/hud.h"
@@ -46,6 +47,7 @@ cBaseBox :: cBaseBox( cSprite_Manager *sprite_manager )
 	m_type = TYPE_ACTIVE_SPRITE;
 	m_sprite_array = ARRAY_ACTIVE;
 	m_massive_type = MASS_MASSIVE;
+	m_col_valid_massive = COL_MASK_ALL;
 	m_can_be_ground = 1;
 	Set_Scale_Directions( 1, 1, 1, 1 );
 
@@ -85,7 +87,7 @@ void cBaseBox :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Useable_Count( attributes.getValueAsInteger( "useable_count", m_start_useable_count ), 1 );
 }
 
-void cBaseBox :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cBaseBox :: Save_To_XML( cXml_Writer &stream )
 {
 	// position
 	Write_Property( stream, "posx", static_cast<int>( m_start_pos_x ) );
@@ -132,8 +134,8 @@ cSave_Level_Object *cBaseBox :: Save_To_Savegame( void )
 
 	// default values
 	save_object->m_type = m_type;
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posx", int_to_string( static_cast<int>(m_start_pos_x) ) ) );
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posy", int_to_string( static_cast<int>(m_start_pos_y) ) ) );
+	save_object->m_posx = static_cast<int>(m_start_pos_x);
+	save_object->m_posy = static_cast<int>(m_start_pos_y);
 
 	// Useable Count
 	save_object->m_properties.push_back( cSave_Level_Object_Property( "useable_count", int_to_string( m_useable_count ) ) );
@@ -282,6 +284,7 @@ void cBaseBox :: Set_Invisible( Box_Invisible_Type type )
 
 	// create name again
 	Create_Name();
+	Update_Valid_Draw();
 }
 
 void cBaseBox :: Activate_Collision( ObjectDirection col_direction )
@@ -457,7 +460,7 @@ void cBaseBox :: Col_Enemy( cSprite *obj )
 		cEnemy *enemy = static_cast<cEnemy *>(obj);
 		pAudio->Play_Sound( enemy->m_kill_sound );
 		pHud_Points->Add_Points( enemy->m_kill_points, enemy->m_pos_x, enemy->m_pos_y - 5.0f, "", static_cast<Uint8>(255), 1 );
-		pLevel_Player->Add_Kill_Multiplier();
+		Get_Context()->Get_Level_Player()->Add_Kill_Multiplier();
 		enemy->DownGrade( 1 );
 	}
 }
@@ -470,7 +473,7 @@ void cBaseBox :: Activate( void )
 void cBaseBox :: Update( void )
 {
 	// animate only a visible box or an activated invisible box
-	if( m_box_invisible == BOX_VISIBLE || ( m_box_invisible == BOX_GHOST && pLevel_Player->m_maryo_type == MARYO_GHOST ) || m_useable_count != m_start_useable_count )
+	if( m_box_invisible == BOX_VISIBLE || ( m_box_invisible == BOX_GHOST && Get_Context()->Get_Level_Player()->m_maryo_type == MARYO_GHOST ) || m_useable_count != m_start_useable_count )
 	{
 		// Spinbox animation handling
 		if( ( m_type == TYPE_SPIN_BOX || m_useable_count != 0 ) && m_anim_enabled )
@@ -499,7 +502,7 @@ void cBaseBox :: Draw( cSurface_Request *request /* = NULL */ )
 	if( !editor_level_enabled )
 	{
 		// visible box or activated invisible box
-		if( m_box_invisible == BOX_VISIBLE || ( m_box_invisible == BOX_GHOST && pLevel_Player->m_maryo_type == MARYO_GHOST ) || m_useable_count != m_start_useable_count )
+		if( m_box_invisible == BOX_VISIBLE || ( m_box_invisible == BOX_GHOST && Get_Context()->Get_Level_Player()->m_maryo_type == MARYO_GHOST ) || m_useable_count != m_start_useable_count )
 		{
 			cAnimated_Sprite::Draw( request );
 		}
@@ -675,7 +678,7 @@ bool cBaseBox :: Is_Draw_Valid( void )
 		if( m_box_invisible == BOX_GHOST )
 		{
 			// maryo is not ghost
-			if( pLevel_Player->m_maryo_type != MARYO_GHOST )
+			if( Get_Context()->Get_Level_Player()->m_maryo_type != MARYO_GHOST )
 			{
 				return 0;
 			}
@@ -744,7 +747,7 @@ Col_Valid_Type cBaseBox :: Validate_Collision( cSprite *obj )
 void cBaseBox :: Handle_Collision_Player( cObjectCollision *collision )
 {
 	// if player jumps from below or flies against it
-	if( collision->m_direction == DIR_BOTTOM && pLevel_Player->m_state != STA_FLY )
+	if( collision->m_direction == DIR_BOTTOM && Get_Context()->Get_Level_Player()->m_state != STA_FLY )
 	{
 		if( m_useable_count != 0 )
 		{
@@ -73,17 +73,17 @@ void cEnemyStopper :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Pos( static_cast<float>(attributes.getValueAsInteger( "posx" )), static_cast<float>(attributes.getValueAsInteger( "posy" )), 1 );
 }
 
-void cEnemyStopper :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cEnemyStopper :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// position
 	Write_Property( stream, "posx", static_cast<int>( m_start_pos_x ) );
 	Write_Property( stream, "posy", static_cast<int>( m_start_pos_y ) );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cEnemyStopper :: Draw( cSurface_Request *request /* = NULL */ )
@@ -29,6 +29,10 @@ namespace SMC
 
 /* *** *** *** *** *** *** cGoldpiece *** *** *** *** *** *** *** *** *** *** *** */
 
+// collect sounds which are played often
+static const cSound_Handle goldpiece_sound_red( "item/goldpiece_red.wav" );
+static const cSound_Handle goldpiece_sound_yellow( "item/goldpiece_1.ogg" );
+
 cGoldpiece :: cGoldpiece( cSprite_Manager *sprite_manager )
 : cAnimated_Sprite( sprite_manager, "item" )
 {
@@ -54,6 +58,8 @@ void cGoldpiece :: Init( void )
 	m_type = TYPE_GOLDPIECE;
 	m_pos_z = 0.041f;
 	m_can_be_on_ground = 0;
+	// all goldpieces animate in lockstep
+	Set_Animation_Shared( 1 );
 
 	Set_Gold_Color( COL_YELLOW );
 }
@@ -74,10 +80,10 @@ void cGoldpiece :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Gold_Color( Get_Color_Id( attributes.getValueAsString( "color", Get_Color_Name( m_color_type ) ).c_str() ) );
 }
 
-void cGoldpiece :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cGoldpiece :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// type
 	Write_Property( stream, "type", "goldpiece" );
@@ -88,7 +94,7 @@ void cGoldpiece :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "color", Get_Color_Name( m_color_type ) );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cGoldpiece :: Load_From_Savegame( cSave_Level_Object *save_object )
@@ -118,8 +124,8 @@ cSave_Level_Object *cGoldpiece :: Save_To_Savegame( void )
 
 	// default values
 	save_object->m_type = m_type;
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posx", int_to_string( static_cast<int>(m_start_pos_x) ) ) );
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posy", int_to_string( static_cast<int>(m_start_pos_y) ) ) );
+	save_object->m_posx = static_cast<int>(m_start_pos_x);
+	save_object->m_posy = static_cast<int>(m_start_pos_y);
 
 	// new position ( only save if needed )
 	if( !Is_Float_Equal( m_start_pos_x, m_pos_x ) || !Is_Float_Equal( m_start_pos_y, m_pos_y ) )
@@ -237,7 +243,7 @@ void cGoldpiece :: Activate( void )
 	}
 
 	// animation
-	cAnimation_Goldpiece *anim = new cAnimation_Goldpiece( m_sprite_manager, m_pos_x + ( m_col_rect.m_w / 10 ), m_pos_y + ( m_col_rect.m_h / 10 ) );
+	pActive_Animation_Manager->Add_Goldpiece( m_pos_x + ( m_col_rect.m_w / 10 ), m_pos_y + ( m_col_rect.m_h / 10 ) );
 
 	// gold
 	unsigned int points = 0;
@@ -246,8 +252,6 @@ void cGoldpiece :: Activate( void )
 	{
 		pHud_Goldpieces->Add_Gold( 5 );
 		points = 100;
-
-		anim->Set_Scale( 1.2f, 1 );
 	}
 	else
 	{
@@ -255,8 +259,6 @@ void cGoldpiece :: Activate( void )
 		points = 5;
 	}
 
-	pActive_Animation_Manager->Add( anim );
-
 	// if jumping double the points
 	if( m_type == TYPE_JUMPING_GOLDPIECE )
 	{
@@ -266,11 +268,11 @@ void cGoldpiece :: Activate( void )
 	{
 		if( m_color_type == COL_RED )
 		{
-			pAudio->Play_Sound( "item/goldpiece_red.wav" );
+			pAudio->Play_Sound( goldpiece_sound_red );
 		}
 		else
 		{
-			pAudio->Play_Sound( "item/goldpiece_1.ogg" );
+			pAudio->Play_Sound( goldpiece_sound_yellow );
 		}
 	}
 
@@ -311,6 +313,8 @@ void cGoldpiece :: Draw( cSurface_Request *request /* = NULL */ )
 		return;
 	}
 
+	Update_Shared_Animation();
+
 	cAnimated_Sprite::Draw( request );
 }
 
@@ -325,6 +329,24 @@ bool cGoldpiece :: Is_Update_Valid( void )
 	return 1;
 }
 
+bool cGoldpiece :: Is_Sleep_Valid( void ) const
+{
+	// jumping and falling goldpieces move
+	if( m_type != TYPE_GOLDPIECE )
+	{
+		return cAnimated_Sprite::Is_Sleep_Valid();
+	}
+
+	// collisions need to be handled
+	if( !m_collisions.empty() )
+	{
+		return 0;
+	}
+
+	// the animation is set when drawn
+	return m_anim_shared;
+}
+
 void cGoldpiece :: Handle_Collision_Player( cObjectCollision *collision )
 {
 	// invalid
@@ -342,6 +364,8 @@ cJGoldpiece :: cJGoldpiece( cSprite_Manager *sprite_manager )
 : cGoldpiece( sprite_manager )
 {
 	m_type = TYPE_JUMPING_GOLDPIECE;
+	m_col_valid_massive = COL_MASK_NONE;
+	m_col_layer_mask = COL_LAYER_NONE;
 	Set_Spawned( 1 );
 
 	cJGoldpiece::Set_Gold_Color( COL_YELLOW );
@@ -386,6 +410,9 @@ cFGoldpiece :: cFGoldpiece( cSprite_Manager *sprite_manager, ObjectDirection dir
 : cGoldpiece( sprite_manager )
 {
 	m_type = TYPE_FALLING_GOLDPIECE;
+	m_col_valid_massive = COL_MASK_MASSIVE | COL_MASK_HALFMASSIVE;
+	// enemies and balls are ignored
+	m_col_layer_mask = COL_LAYER_SOLID | COL_LAYER_ACTIVE | COL_LAYER_PLAYER;
 	m_camera_range = 2000;
 	m_gravity_max = 25.0f;
 	m_can_be_on_ground = 1;
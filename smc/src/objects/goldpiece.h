@@ -39,7 +39,7 @@ public:
 	// load from stream
 	virtual void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream );
+	virtual void Save_To_XML( cXml_Writer &stream );
 
 	// copy
 	virtual cGoldpiece *Copy( void ) const;
@@ -62,6 +62,8 @@ public:
 
 	// if update is valid for the current state
 	virtual bool Is_Update_Valid( void );
+	// if the update would do nothing
+	virtual bool Is_Sleep_Valid( void ) const;
 
 	// collision from player
 	virtual void Handle_Collision_Player( cObjectCollision *collision );
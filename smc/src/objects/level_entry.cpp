@@ -25,6 +25,7 @@
 #include "../level/level.h"
 #include "../core/i18n.h"
 #include "../core/sprite_manager.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -54,7 +55,7 @@ cLevel_Entry :: ~cLevel_Entry( void )
 {
 	if( m_editor_entry_name )
 	{
-		delete m_editor_entry_name;
+		pFont->Release_Text( m_editor_entry_name );
 		m_editor_entry_name = NULL;
 	}
 }
@@ -106,10 +107,10 @@ void cLevel_Entry :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Direction( Get_Direction_Id( attributes.getValueAsString( "direction", Get_Direction_Name( m_start_direction ) ).c_str() ) );
 }
 
-void cLevel_Entry :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cLevel_Entry :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// position
 	Write_Property( stream, "posx", static_cast<int>( m_start_pos_x ) );
@@ -128,7 +129,7 @@ void cLevel_Entry :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	}
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cLevel_Entry :: Set_Direction( const ObjectDirection dir )
@@ -201,80 +202,82 @@ void cLevel_Entry :: Draw( cSurface_Request *request /* = NULL */ )
 
 void cLevel_Entry :: Activate( void )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	// warp player in
 	if( m_entry_type == LEVEL_ENTRY_WARP )
 	{
 		pAudio->Play_Sound( "leave_pipe.ogg" );
 
 		// set state to linked to stop checking for on ground objects which sometimes changes the position
-		Moving_state player_state = pLevel_Player->m_state;
-		pLevel_Player->m_state = STA_OBJ_LINKED;
+		Moving_state player_state = level_player->m_state;
+		level_player->m_state = STA_OBJ_LINKED;
 
-		pLevel_Player->Stop_Ducking();
-		pLevel_Player->Reset_On_Ground();
+		level_player->Stop_Ducking();
+		level_player->Reset_On_Ground();
 
 		// set position
-		pLevel_Player->Set_Pos( Get_Player_Pos_X(), Get_Player_Pos_Y() );
+		level_player->Set_Pos( Get_Player_Pos_X(), Get_Player_Pos_Y() );
 
 		// set image
 		if( m_direction == DIR_UP || m_direction == DIR_DOWN )
 		{
-			pLevel_Player->Set_Image_Num( MARYO_IMG_FALL + pLevel_Player->m_direction );
+			level_player->Set_Image_Num( MARYO_IMG_FALL + level_player->m_direction );
 		}
 		else if( m_direction == DIR_LEFT || m_direction == DIR_RIGHT )
 		{
-			pLevel_Player->Set_Image_Num( pLevel_Player->m_direction );
+			level_player->Set_Image_Num( level_player->m_direction );
 
 			// set rotation
 			if( m_direction == DIR_RIGHT )
 			{
-				pLevel_Player->Set_Rotation_Z( 90 );
+				level_player->Set_Rotation_Z( 90 );
 			}
 			else if( m_direction == DIR_LEFT )
 			{
-				pLevel_Player->Set_Rotation_Z( 270 );
+				level_player->Set_Rotation_Z( 270 );
 			}
 		}
 
 		// change position z to be behind massive for the animation
-		float player_posz = pLevel_Player->m_pos_z;
-		pLevel_Player->m_pos_z = 0.0799f;
+		float player_posz = level_player->m_pos_z;
+		level_player->m_pos_z = 0.0799f;
 
 		// move slowly out
 		while( 1 )
 		{
 			if( m_direction == DIR_DOWN )
 			{
-				pLevel_Player->Move( 0.0f, 2.8f );
+				level_player->Move( 0.0f, 2.8f );
 
-				if( pLevel_Player->m_pos_y > m_rect.m_y + m_rect.m_h )
+				if( level_player->m_pos_y > m_rect.m_y + m_rect.m_h )
 				{
 					break;
 				}
 			}
 			else if( m_direction == DIR_UP )
 			{
-				pLevel_Player->Move( 0.0f, -2.8f );
+				level_player->Move( 0.0f, -2.8f );
 
-				if( pLevel_Player->m_col_rect.m_y + pLevel_Player->m_col_rect.m_h < m_rect.m_y )
+				if( level_player->m_col_rect.m_y + level_player->m_col_rect.m_h < m_rect.m_y )
 				{
 					break;
 				}
 			}
 			else if( m_direction == DIR_RIGHT )
 			{
-				pLevel_Player->Move( 2.0f, 0.0f );
+				level_player->Move( 2.0f, 0.0f );
 
-				if( pLevel_Player->m_pos_x > m_rect.m_x + m_rect.m_w )
+				if( level_player->m_pos_x > m_rect.m_x + m_rect.m_w )
 				{
 					break;
 				}
 			}
 			else if( m_direction == DIR_LEFT )
 			{
-				pLevel_Player->Move( -2.0f, 0.0f );
+				level_player->Move( -2.0f, 0.0f );
 
-				if( pLevel_Player->m_col_rect.m_x + pLevel_Player->m_col_rect.m_w < m_rect.m_x )
+				if( level_player->m_col_rect.m_x + level_player->m_col_rect.m_w < m_rect.m_x )
 				{
 					break;
 				}
@@ -289,15 +292,12 @@ void cLevel_Entry :: Activate( void )
 			// center camera
 			pActive_Camera->Center();
 			// keep particles on screen
-			for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
-			{
-				cSprite *obj = (*itr);
+			const cSprite_List &emitters = m_sprite_manager->Get_Type_Objects( TYPE_PARTICLE_EMITTER );
 
-				if( obj->m_type == TYPE_PARTICLE_EMITTER )
-				{
-					cParticle_Emitter *emitter = static_cast<cParticle_Emitter *>(obj);
-					emitter->Update_Position();
-				}
+			for( cSprite_List::const_iterator itr = emitters.begin(); itr != emitters.end(); ++itr )
+			{
+				cParticle_Emitter *emitter = static_cast<cParticle_Emitter *>(*itr);
+				emitter->Update_Position();
 			}
 			// draw
 			Draw_Game();
@@ -307,23 +307,23 @@ void cLevel_Entry :: Activate( void )
 		}
 
 		// set position z back
-		pLevel_Player->m_pos_z = player_posz;
+		level_player->m_pos_z = player_posz;
 		// set state back
-		pLevel_Player->m_state = player_state;
+		level_player->m_state = player_state;
 
 		if( m_direction == DIR_RIGHT || m_direction == DIR_LEFT )
 		{
-			pLevel_Player->Set_Rotation_Z( 0 );
+			level_player->Set_Rotation_Z( 0 );
 		}
 	}
 	// beam player in
 	else if( m_entry_type == LEVEL_ENTRY_BEAM )
 	{
 		// set position
-		pLevel_Player->Set_Pos( Get_Player_Pos_X(), Get_Player_Pos_Y() );
+		level_player->Set_Pos( Get_Player_Pos_X(), Get_Player_Pos_Y() );
 	}
 
-	pLevel_Player->Clear_Collisions();
+	level_player->Clear_Collisions();
 }
 
 void cLevel_Entry :: Set_Type( Level_Entry_type new_type )
@@ -335,25 +335,27 @@ void cLevel_Entry :: Set_Type( Level_Entry_type new_type )
 
 float cLevel_Entry :: Get_Player_Pos_X( void ) const
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	if( m_entry_type == LEVEL_ENTRY_WARP )
 	{
 		// left
 		if( m_direction == DIR_LEFT )
 		{
-			return m_col_rect.m_x - pLevel_Player->m_col_pos.m_y + m_col_rect.m_w;
+			return m_col_rect.m_x - level_player->m_col_pos.m_y + m_col_rect.m_w;
 		}
 		// right
 		else if( m_direction == DIR_RIGHT )
 		{
-			return m_col_rect.m_x - pLevel_Player->m_col_pos.m_y - m_col_rect.m_w - pLevel_Player->m_col_rect.m_w;
+			return m_col_rect.m_x - level_player->m_col_pos.m_y - m_col_rect.m_w - level_player->m_col_rect.m_w;
 		}
 
 		// up/down
-		return m_col_rect.m_x - pLevel_Player->m_col_pos.m_x + ( m_col_rect.m_w * 0.5f ) - ( pLevel_Player->m_col_rect.m_w * 0.5f );
+		return m_col_rect.m_x - level_player->m_col_pos.m_x + ( m_col_rect.m_w * 0.5f ) - ( level_player->m_col_rect.m_w * 0.5f );
 	}
 	else if( m_entry_type == LEVEL_ENTRY_BEAM )
 	{
-		return m_col_rect.m_x + ( m_col_rect.m_w * 0.5f ) - pLevel_Player->m_col_pos.m_y - ( pLevel_Player->m_col_rect.m_w * 0.5f );
+		return m_col_rect.m_x + ( m_col_rect.m_w * 0.5f ) - level_player->m_col_pos.m_y - ( level_player->m_col_rect.m_w * 0.5f );
 	}
 
 	return 0;
@@ -361,25 +363,27 @@ float cLevel_Entry :: Get_Player_Pos_X( void ) const
 
 float cLevel_Entry :: Get_Player_Pos_Y( void ) const
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	if( m_entry_type == LEVEL_ENTRY_WARP )
 	{
 		// up
 		if( m_direction == DIR_UP )
 		{
-			return m_col_rect.m_y - pLevel_Player->m_col_pos.m_y + m_col_rect.m_h;
+			return m_col_rect.m_y - level_player->m_col_pos.m_y + m_col_rect.m_h;
 		}
 		// down
 		else if( m_direction == DIR_DOWN )
 		{
-			return m_col_rect.m_y - pLevel_Player->m_col_pos.m_y - 5 - pLevel_Player->m_rect.m_h;
+			return m_col_rect.m_y - level_player->m_col_pos.m_y - 5 - level_player->m_rect.m_h;
 		}
 
 		// left/right
-		return m_col_rect.m_y - pLevel_Player->m_col_pos.m_y + ( m_col_rect.m_h * 0.5f ) - ( pLevel_Player->m_col_rect.m_h * 0.5f );
+		return m_col_rect.m_y - level_player->m_col_pos.m_y + ( m_col_rect.m_h * 0.5f ) - ( level_player->m_col_rect.m_h * 0.5f );
 	}
 	else if( m_entry_type == LEVEL_ENTRY_BEAM )
 	{
-		return m_col_rect.m_y + m_col_rect.m_h - pLevel_Player->m_col_pos.m_y - pLevel_Player->m_col_rect.m_h;
+		return m_col_rect.m_y + m_col_rect.m_h - level_player->m_col_pos.m_y - level_player->m_col_rect.m_h;
 	}
 
 	return 0;
@@ -390,20 +394,25 @@ void cLevel_Entry :: Set_Name( const std::string &str_name )
 	// delete editor image
 	if( m_editor_entry_name )
 	{
-		delete m_editor_entry_name;
+		pFont->Release_Text( m_editor_entry_name );
 		m_editor_entry_name = NULL;
 	}
 
 	// Set new name
 	m_entry_name = str_name;
 
+	if( m_sprite_manager )
+	{
+		m_sprite_manager->Update_Identifier( this );
+	}
+
 	// if empty don't create editor image
 	if( m_entry_name.empty() )
 	{
 		return;
 	}
 
-	m_editor_entry_name = pFont->Render_Text( pFont->m_font_small, m_entry_name, white );
+	m_editor_entry_name = pFont->Get_Text( pFont->m_font_small, m_entry_name, white );
 }
 
 bool cLevel_Entry :: Is_Draw_Valid( void )
@@ -423,6 +432,11 @@ bool cLevel_Entry :: Is_Draw_Valid( void )
 	return 1;
 }
 
+std::string cLevel_Entry :: Get_Identifier( void ) const
+{
+	return m_entry_name;
+}
+
 void cLevel_Entry :: Editor_Activate( void )
 {
 	// get window manager
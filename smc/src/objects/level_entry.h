@@ -53,7 +53,7 @@ public:
 	// load from stream
 	virtual void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream );
+	virtual void Save_To_XML( cXml_Writer &stream );
 	// Set direction
 	void Set_Direction( const ObjectDirection dir );
 
@@ -75,6 +75,8 @@ public:
 
 	// if draw is valid for the current state and position
 	virtual bool Is_Draw_Valid( void );
+	// Returns the entry name
+	virtual std::string Get_Identifier( void ) const;
 
 	// editor activation
 	virtual void Editor_Activate( void );
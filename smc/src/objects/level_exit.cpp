@@ -24,8 +24,10 @@
 #include "../video/font.h"
 #include "../video/renderer.h"
 #include "../level/level.h"
+#include "../level/level_prefetch.h"
 #include "../core/i18n.h"
 #include "../core/filesystem/filesystem.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -55,7 +57,7 @@ cLevel_Exit :: ~cLevel_Exit( void )
 {
 	if( m_editor_entry_name )
 	{
-		delete m_editor_entry_name;
+		pFont->Release_Text( m_editor_entry_name );
 		m_editor_entry_name = NULL;
 	}
 }
@@ -78,6 +80,7 @@ void cLevel_Exit :: Init( void )
 
 	m_exit_type = LEVEL_EXIT_BEAM;
 	m_exit_motion = CAMERA_MOVE_FLY;
+	m_preload_started = 0;
 
 	Set_Direction( DIR_DOWN );
 
@@ -124,10 +127,10 @@ void cLevel_Exit :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	}
 }
 
-void cLevel_Exit :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cLevel_Exit :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// position
 	Write_Property( stream, "posx", static_cast<int>( m_start_pos_x ) );
@@ -166,7 +169,7 @@ void cLevel_Exit :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	}
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cLevel_Exit :: Set_Direction( const ObjectDirection dir )
@@ -213,6 +216,31 @@ void cLevel_Exit :: Create_Name( void )
 	}
 }
 
+void cLevel_Exit :: Update( void )
+{
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
+	cAnimated_Sprite::Update();
+
+	if( !m_valid_update || m_preload_started || m_dest_level.empty() || editor_level_enabled )
+	{
+		return;
+	}
+
+	// player is near
+	const float dist_x = ( m_col_rect.m_x + ( m_col_rect.m_w * 0.5f ) ) - ( level_player->m_col_rect.m_x + ( level_player->m_col_rect.m_w * 0.5f ) );
+	const float dist_y = ( m_col_rect.m_y + ( m_col_rect.m_h * 0.5f ) ) - ( level_player->m_col_rect.m_y + ( level_player->m_col_rect.m_h * 0.5f ) );
+
+	if( dist_x * dist_x + dist_y * dist_y > 500.0f * 500.0f )
+	{
+		return;
+	}
+
+	m_preload_started = 1;
+	// load the destination level in the background
+	pLevel_Preloader->Start( m_dest_level );
+}
+
 void cLevel_Exit :: Draw( cSurface_Request *request /* = NULL */ )
 {
 	if( !m_valid_draw )
@@ -239,39 +267,41 @@ void cLevel_Exit :: Draw( cSurface_Request *request /* = NULL */ )
 
 void cLevel_Exit :: Activate( void )
 {
+	cLevel_Player *level_player = Get_Context()->Get_Level_Player();
+
 	// warp player out
 	if( m_exit_type == LEVEL_EXIT_WARP )
 	{
 		pAudio->Play_Sound( "enter_pipe.ogg" );
 
-		pLevel_Player->Set_Moving_State( STA_FALL );
-		pLevel_Player->Set_Image_Num( pLevel_Player->Get_Image() + pLevel_Player->m_direction );
-		pLevel_Player->Stop_Ducking();
-		pLevel_Player->Reset_On_Ground();
+		level_player->Set_Moving_State( STA_FALL );
+		level_player->Set_Image_Num( level_player->Get_Image() + level_player->m_direction );
+		level_player->Stop_Ducking();
+		level_player->Reset_On_Ground();
 
 		// set position and image
 		if( m_direction == DIR_UP || m_direction == DIR_DOWN )
 		{
-			pLevel_Player->Set_Pos_X( m_col_rect.m_x - pLevel_Player->m_col_pos.m_x + ( m_col_rect.m_w * 0.5f ) - ( pLevel_Player->m_col_rect.m_w * 0.5f ) );
+			level_player->Set_Pos_X( m_col_rect.m_x - level_player->m_col_pos.m_x + ( m_col_rect.m_w * 0.5f ) - ( level_player->m_col_rect.m_w * 0.5f ) );
 		}
 		else if( m_direction == DIR_LEFT || m_direction == DIR_RIGHT )
 		{
-			pLevel_Player->Set_Pos_Y( m_col_rect.m_y - pLevel_Player->m_col_pos.m_y + ( m_col_rect.m_h * 0.5f ) - ( pLevel_Player->m_col_rect.m_h * 0.5f ) );
+			level_player->Set_Pos_Y( m_col_rect.m_y - level_player->m_col_pos.m_y + ( m_col_rect.m_h * 0.5f ) - ( level_player->m_col_rect.m_h * 0.5f ) );
 
 			// set rotation
 			if( m_direction == DIR_RIGHT )
 			{
-				pLevel_Player->Set_Rotation_Z( 90.0f );
+				level_player->Set_Rotation_Z( 90.0f );
 			}
 			else if( m_direction == DIR_LEFT )
 			{
-				pLevel_Player->Set_Rotation_Z( 270.0f );
+				level_player->Set_Rotation_Z( 270.0f );
 			}
 		}
 
-		float player_posz = pLevel_Player->m_pos_z;
+		float player_posz = level_player->m_pos_z;
 		// change position z to be behind massive for the animation
-		pLevel_Player->m_pos_z = 0.0799f;
+		level_player->m_pos_z = 0.0799f;
 
 		// set the speed
 		float speedx = 0.0f;
@@ -295,12 +325,12 @@ void cLevel_Exit :: Activate( void )
 		}
 
 		// size moved is the height
-		float maryo_size = pLevel_Player->m_col_rect.m_h;
+		float maryo_size = level_player->m_col_rect.m_h;
 
 		// move slowly in
 		while( maryo_size > 0.0f )
 		{
-			pLevel_Player->Move( speedx, speedy );
+			level_player->Move( speedx, speedy );
 
 			// reduce size
 			if( speedx > 0.0f )
@@ -334,17 +364,17 @@ void cLevel_Exit :: Activate( void )
 		}
 
 		// set position z back
-		pLevel_Player->m_pos_z = player_posz;
+		level_player->m_pos_z = player_posz;
 		// set invisible
-		pLevel_Player->Set_Active( 0 );
+		level_player->Set_Active( 0 );
 
 		if( m_direction == DIR_RIGHT || m_direction == DIR_LEFT )
 		{
-			pLevel_Player->Set_Rotation_Z( 0 );
+			level_player->Set_Rotation_Z( 0 );
 		}
 	}
 
-	pLevel_Player->Clear_Collisions();
+	level_player->Clear_Collisions();
 
 	// exit level
 	if( m_dest_level.empty() && m_dest_entry.empty() )
@@ -404,7 +434,7 @@ void cLevel_Exit :: Set_Entry( const std::string &entry_name )
 {
 	if( m_editor_entry_name )
 	{
-		delete m_editor_entry_name;
+		pFont->Release_Text( m_editor_entry_name );
 		m_editor_entry_name = NULL;
 	}
 
@@ -417,7 +447,7 @@ void cLevel_Exit :: Set_Entry( const std::string &entry_name )
 		return;
 	}
 
-	m_editor_entry_name = pFont->Render_Text( pFont->m_font_small, m_dest_entry, white );
+	m_editor_entry_name = pFont->Get_Text( pFont->m_font_small, m_dest_entry, white );
 }
 
 void cLevel_Exit :: Set_Path_Identifier( const std::string &identifier )
@@ -54,10 +54,12 @@ public:
 	// load from stream
 	virtual void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream );
+	virtual void Save_To_XML( cXml_Writer &stream );
 	// Set direction
 	void Set_Direction( const ObjectDirection dir );
 
+	// update
+	virtual void Update( void );
 	// draw
 	virtual void Draw( cSurface_Request *request = NULL );
 
@@ -109,6 +111,8 @@ public:
 	std::string m_dest_entry;
 	// string identifier of the linked path
 	std::string m_path_identifier;
+	// if the destination level preloading was started
+	bool m_preload_started;
 
 	// editor type color
 	Color m_editor_color;
@@ -52,13 +52,20 @@ cMoving_Platform :: cMoving_Platform( CEGUI::XMLAttributes &attributes, cSprite_
 
 cMoving_Platform :: ~cMoving_Platform( void )
 {
-	//
+	vector<cMovingSprite *> riders;
+	riders.swap( m_riders );
+
+	for( vector<cMovingSprite *>::iterator itr = riders.begin(); itr != riders.end(); ++itr )
+	{
+		(*itr)->Reset_On_Ground();
+	}
 }
 
 void cMoving_Platform :: Init( void )
 {
 	m_sprite_array = ARRAY_ACTIVE;
 	m_type = TYPE_MOVING_PLATFORM;
+	m_col_valid_massive = COL_MASK_ALL;
 	m_pos_z = 0.085f;
 	m_gravity_max = 25.0f;
 	m_can_be_on_ground = 0;
@@ -164,10 +171,10 @@ void cMoving_Platform :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Image_Top_Right( pVideo->Get_Surface( attributes.getValueAsString( "image_top_right", m_images[2].m_image->Get_Filename() ).c_str() ) );
 }
 
-void cMoving_Platform :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cMoving_Platform :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// position
 	Write_Property( stream, "posx", static_cast<int>( m_start_pos_x ) );
@@ -211,7 +218,7 @@ void cMoving_Platform :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "image_top_right", m_images[2].m_image->Get_Filename( 1 ) );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cMoving_Platform :: Set_Sprite_Manager( cSprite_Manager *sprite_manager )
@@ -274,8 +281,8 @@ cSave_Level_Object *cMoving_Platform :: Save_To_Savegame( void )
 
 	// default values
 	save_object->m_type = m_type;
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posx", int_to_string( static_cast<int>(m_start_pos_x) ) ) );
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posy", int_to_string( static_cast<int>(m_start_pos_y) ) ) );
+	save_object->m_posx = static_cast<int>(m_start_pos_x);
+	save_object->m_posy = static_cast<int>(m_start_pos_y);
 
 	// direction
 	save_object->m_properties.push_back( cSave_Level_Object_Property( "direction", int_to_string( m_direction ) ) );
@@ -930,6 +937,8 @@ void cMoving_Platform :: Update_Rect( void )
 	// set width
 	m_col_rect.m_w = m_rect.m_w;
 	m_start_rect.m_w = m_rect.m_w;
+
+	Update_Grid();
 }
 
 void cMoving_Platform :: Update_Velocity( void )
@@ -989,6 +998,55 @@ bool cMoving_Platform :: Is_Update_Valid( void )
 	return 1;
 }
 
+void cMoving_Platform :: Add_Rider( cMovingSprite *obj )
+{
+	m_riders.push_back( obj );
+}
+
+void cMoving_Platform :: Remove_Rider( cMovingSprite *obj )
+{
+	vector<cMovingSprite *>::iterator itr = std::find( m_riders.begin(), m_riders.end(), obj );
+
+	if( itr != m_riders.end() )
+	{
+		m_riders.erase( itr );
+	}
+}
+
+void cMoving_Platform :: Collide_Move( void )
+{
+	// riders are moved first as the platform is still under them
+	if( !m_riders.empty() && ( !Is_Float_Equal( m_velx, 0.0f ) || !Is_Float_Equal( m_vely, 0.0f ) ) )
+	{
+		// riders can leave while moving
+		vector<cMovingSprite *> riders = m_riders;
+
+		for( vector<cMovingSprite *>::iterator itr = riders.begin(); itr != riders.end(); ++itr )
+		{
+			cMovingSprite *obj = (*itr);
+
+			// not moved this frame
+			if( obj->m_auto_destroy || obj->m_sleeping || !obj->m_valid_update || !obj->Is_In_Range() )
+			{
+				continue;
+			}
+
+			// on ground check without a search while still touching
+			obj->Check_on_Ground();
+
+			// walked off or jumped
+			if( obj->m_ground_platform != this )
+			{
+				continue;
+			}
+
+			obj->Move_With( this );
+		}
+	}
+
+	cAnimated_Sprite::Collide_Move();
+}
+
 bool cMoving_Platform :: Is_Draw_Valid( void )
 {
 	bool valid = cAnimated_Sprite::Is_Draw_Valid();
@@ -71,7 +71,7 @@ public:
 	// load from stream
 	virtual void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream );
+	virtual void Save_To_XML( cXml_Writer &stream );
 
 	// Set the parent sprite manager
 	virtual void Set_Sprite_Manager( cSprite_Manager *sprite_manager );
@@ -124,6 +124,14 @@ public:
 	// Update velocity
 	void Update_Velocity( void );
 
+	/* Add or remove an object standing on the platform
+	 * only used by cMovingSprite :: Set_Ground_Object
+	*/
+	void Add_Rider( cMovingSprite *obj );
+	void Remove_Rider( cMovingSprite *obj );
+	// default collision and movement handling which also moves the riders
+	virtual void Collide_Move( void );
+
 	// if update is valid for the current state
 	virtual bool Is_Update_Valid( void );
 	// if draw is valid for the current state and position
@@ -198,6 +206,10 @@ private:
 	float m_max_distance_slow_down_pos;
 	// lowest possible speed when moving
 	float m_lowest_speed;
+	/* objects standing on the platform
+	 * they stay until they walk off or jump and are moved with the platform in one pass
+	*/
+	vector<cMovingSprite *> m_riders;
 	// editor color
 	Color m_editor_color;
 };
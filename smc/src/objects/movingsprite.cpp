@@ -26,6 +26,8 @@
 #include "../video/renderer.h"
 #include "../video/gl_surface.h"
 #include "../core/sprite_manager.h"
+#include "../core/engine_context.h"
+#include "../objects/moving_platform.h"
 
 namespace SMC
 {
@@ -45,9 +47,18 @@ cMovingSprite :: cMovingSprite( CEGUI::XMLAttributes &attributes, cSprite_Manage
 	cMovingSprite::Load_From_XML( attributes );
 }
 
+cMovingSprite :: cMovingSprite( const cMovingSprite &sprite )
+: cSprite( sprite )
+{
+	cMovingSprite::Init();
+
+	m_can_be_on_ground = sprite.m_can_be_on_ground;
+}
+
 cMovingSprite :: ~cMovingSprite( void )
 {
-	//
+	// leave the moving platform
+	Reset_On_Ground();
 }
 
 void cMovingSprite :: Init( void )
@@ -62,6 +73,12 @@ void cMovingSprite :: Init( void )
 	m_start_direction = DIR_UNDEFINED;
 	m_can_be_on_ground = 1;
 	m_ground_object = NULL;
+	m_ground_platform = NULL;
+	m_col_valid_massive = COL_MASK_MASSIVE | COL_MASK_HALFMASSIVE;
+	m_col_layer_mask = COL_LAYER_OBJECTS;
+	m_col_cache_manager = NULL;
+	m_col_cache_version = 0;
+	m_col_cache_layer_mask = COL_LAYER_NONE;
 
 	m_ice_resistance = 0.0f;
 	m_freeze_counter = 0.0f;
@@ -69,17 +86,8 @@ void cMovingSprite :: Init( void )
 
 cMovingSprite *cMovingSprite :: Copy( void ) const
 {
-	cMovingSprite *moving_sprite = new cMovingSprite( m_sprite_manager );
-	moving_sprite->Set_Image( m_start_image, 1 );
-	moving_sprite->Set_Pos( m_start_pos_x, m_start_pos_y, 1 );
-	moving_sprite->m_type = m_type;
-	moving_sprite->m_sprite_array = m_sprite_array;
-	moving_sprite->Set_Massive_Type( m_massive_type );
-	moving_sprite->m_can_be_ground = m_can_be_ground;
-	moving_sprite->m_can_be_on_ground = m_can_be_on_ground;
-	moving_sprite->Set_Ignore_Camera( m_no_camera );
-	moving_sprite->Set_Shadow_Pos( m_shadow_pos );
-	moving_sprite->Set_Shadow_Color( m_shadow_color );
+	cMovingSprite *moving_sprite = new cMovingSprite( *this );
+	moving_sprite->Finish_Copy();
 	return moving_sprite;
 }
 
@@ -158,7 +166,7 @@ void cMovingSprite :: Move( float move_x, float move_y, bool real /* = 0 */ )
 	Check_And_Handle_Out_Of_Level( move_x, move_y );
 }
 
-cObjectCollisionType *cMovingSprite :: Col_Move_in_Steps( float move_x, float move_y, float step_size_x, float step_size_y, float final_pos_x, float final_pos_y, cSprite_List sprite_list, bool stop_on_internal /* = 0 */ )
+cObjectCollisionType *cMovingSprite :: Col_Move_in_Steps( float move_x, float move_y, float step_size_x, float step_size_y, float final_pos_x, float final_pos_y, cSprite_List &sprite_list, bool stop_on_internal /* = 0 */ )
 {
 	if( sprite_list.empty() )
 	{
@@ -172,6 +180,11 @@ cObjectCollisionType *cMovingSprite :: Col_Move_in_Steps( float move_x, float mo
 	bool move_x_valid = 1;
 	bool move_y_valid = 1;
 
+	// steps which can not touch an object and are moved without checking
+	unsigned int free_steps_x = 0;
+	unsigned int free_steps_y = 0;
+	bool update_free_steps = !game_debug_collision_steps;
+
 	/* Checks in both directions simultaneously
 	 * if a collision occurs it saves the direction
 	*/
@@ -186,66 +199,83 @@ cObjectCollisionType *cMovingSprite :: Col_Move_in_Steps( float move_x, float mo
 				continue;
 			}
 
-			// collision check
-			cObjectCollisionType *col_list_temp = Collision_Check_Relative( step_size_x, 0.0f, 0.0f, 0.0f, COLLIDE_COMPLETE, &sprite_list );
-			
+			if( update_free_steps )
+			{
+				free_steps_x = free_steps_y = Col_Get_Free_Steps( step_size_x, move_y_valid ? step_size_y : 0.0f, final_pos_x, final_pos_y, sprite_list );
+				update_free_steps = 0;
+			}
+
 			bool collision_found = 0;
 
-			// stop on everything
-			if( stop_on_internal )
+			// can not touch an object
+			if( free_steps_x )
 			{
-				if( col_list_temp->size() )
-				{
-					collision_found = 1;
-				}
+				free_steps_x--;
 			}
-			// stop only on blocking
 			else
 			{
-				if( col_list_temp->Is_Included( COL_VTYPE_BLOCKING ) )
+				// collision check
+				cObjectCollisionType *col_list_temp = Collision_Check_Relative( step_size_x, 0.0f, 0.0f, 0.0f, COLLIDE_COMPLETE, &sprite_list );
+
+				// stop on everything
+				if( stop_on_internal )
 				{
-					collision_found = 1;
+					if( col_list_temp->size() )
+					{
+						collision_found = 1;
+					}
 				}
-				// remove internal collision from further checks
-				else if( col_list_temp->objects.size() )
+				// stop only on blocking
+				else
 				{
-					for( cObjectCollision_List::iterator itr = col_list_temp->objects.begin(); itr != col_list_temp->objects.end(); ++itr )
+					if( col_list_temp->Is_Included( COL_VTYPE_BLOCKING ) )
 					{
-						cObjectCollision *col = (*itr);
-
-						if( col->m_valid_type != COL_VTYPE_INTERNAL )
+						collision_found = 1;
+					}
+					// remove internal collision from further checks
+					else if( col_list_temp->objects.size() )
+					{
+						for( cObjectCollision_List::iterator itr = col_list_temp->objects.begin(); itr != col_list_temp->objects.end(); ++itr )
 						{
-							continue;
-						}
+							cObjectCollision *col = (*itr);
 
-						// find in sprite list
-						cSprite_List::iterator sprite_itr = std::find( sprite_list.begin(), sprite_list.end(), col->m_obj );
+							if( col->m_valid_type != COL_VTYPE_INTERNAL )
+							{
+								continue;
+							}
 
-						// not found
-						if( sprite_itr == sprite_list.end() )
-						{
-							continue;
-						}
+							// find in sprite list
+							cSprite_List::iterator sprite_itr = std::find( sprite_list.begin(), sprite_list.end(), col->m_obj );
 
-						sprite_list.erase( sprite_itr );
-					}
+							// not found
+							if( sprite_itr == sprite_list.end() )
+							{
+								continue;
+							}
 
-					// if no objects left
-					if( sprite_list.empty() )
-					{
-						// move to final position
-						m_pos_x = final_pos_x;
+							sprite_list.erase( sprite_itr );
+						}
+
+						// if no objects left
+						if( sprite_list.empty() )
+						{
+							// move to final position
+							m_pos_x = final_pos_x;
+						}
 					}
 				}
-			}
 			
-			if( col_list_temp->size() )
-			{
-				col_list->objects.insert( col_list->objects.end(), col_list_temp->objects.begin(), col_list_temp->objects.end() );
-				col_list_temp->objects.clear();
-			}
+				if( col_list_temp->size() )
+				{
+					col_list->objects.insert( col_list->objects.end(), col_list_temp->objects.begin(), col_list_temp->objects.end() );
+					col_list_temp->objects.clear();
+				}
 
-			delete col_list_temp;
+				delete col_list_temp;
+
+				// the sprite list or the position changed
+				update_free_steps = !game_debug_collision_steps;
+			}
 
 			if( !collision_found )
 			{
@@ -278,66 +308,83 @@ cObjectCollisionType *cMovingSprite :: Col_Move_in_Steps( float move_x, float mo
 				continue;
 			}
 
-			// collision check
-			cObjectCollisionType *col_list_temp = Collision_Check_Relative( 0.0f, step_size_y, 0.0f, 0.0f, COLLIDE_COMPLETE, &sprite_list );
+			if( update_free_steps )
+			{
+				free_steps_x = free_steps_y = Col_Get_Free_Steps( move_x_valid ? step_size_x : 0.0f, step_size_y, final_pos_x, final_pos_y, sprite_list );
+				update_free_steps = 0;
+			}
 
 			bool collision_found = 0;
 
-			// stop on everything
-			if( stop_on_internal )
+			// can not touch an object
+			if( free_steps_y )
 			{
-				if( col_list_temp->size() )
-				{
-					collision_found = 1;
-				}
+				free_steps_y--;
 			}
-			// stop only on blocking
 			else
 			{
-				if( col_list_temp->Is_Included( COL_VTYPE_BLOCKING ) )
+				// collision check
+				cObjectCollisionType *col_list_temp = Collision_Check_Relative( 0.0f, step_size_y, 0.0f, 0.0f, COLLIDE_COMPLETE, &sprite_list );
+
+				// stop on everything
+				if( stop_on_internal )
 				{
-					collision_found = 1;
+					if( col_list_temp->size() )
+					{
+						collision_found = 1;
+					}
 				}
-				// remove internal collision from further checks
-				else if( col_list_temp->objects.size() )
+				// stop only on blocking
+				else
 				{
-					for( cObjectCollision_List::iterator itr = col_list_temp->objects.begin(); itr != col_list_temp->objects.end(); ++itr )
+					if( col_list_temp->Is_Included( COL_VTYPE_BLOCKING ) )
 					{
-						cObjectCollision *col = (*itr);
-
-						if( col->m_valid_type != COL_VTYPE_INTERNAL )
-						{
-							continue;
-						}
-
-						// find in sprite list
-						cSprite_List::iterator sprite_itr = std::find( sprite_list.begin(), sprite_list.end(), col->m_obj );
-
-						// not found
-						if( sprite_itr == sprite_list.end() )
-						{
-							continue;
-						}
-
-						sprite_list.erase( sprite_itr );
-
-						// if no objects left
-						if( sprite_list.empty() )
+						collision_found = 1;
+					}
+					// remove internal collision from further checks
+					else if( col_list_temp->objects.size() )
+					{
+						for( cObjectCollision_List::iterator itr = col_list_temp->objects.begin(); itr != col_list_temp->objects.end(); ++itr )
 						{
-							// move to final position
-							m_pos_y = final_pos_y;
+							cObjectCollision *col = (*itr);
+
+							if( col->m_valid_type != COL_VTYPE_INTERNAL )
+							{
+								continue;
+							}
+
+							// find in sprite list
+							cSprite_List::iterator sprite_itr = std::find( sprite_list.begin(), sprite_list.end(), col->m_obj );
+
+							// not found
+							if( sprite_itr == sprite_list.end() )
+							{
+								continue;
+							}
+
+							sprite_list.erase( sprite_itr );
+
+							// if no objects left
+							if( sprite_list.empty() )
+							{
+								// move to final position
+								m_pos_y = final_pos_y;
+							}
 						}
 					}
 				}
-			}
 			
-			if( col_list_temp->size() )
-			{
-				col_list->objects.insert( col_list->objects.end(), col_list_temp->objects.begin(), col_list_temp->objects.end() );
-				col_list_temp->objects.clear();
-			}
+				if( col_list_temp->size() )
+				{
+					col_list->objects.insert( col_list->objects.end(), col_list_temp->objects.begin(), col_list_temp->objects.end() );
+					col_list_temp->objects.clear();
+				}
 
-			delete col_list_temp;
+				delete col_list_temp;
+
+				// the sprite list or the position changed
+				update_free_steps = !game_debug_collision_steps;
+			}
 
 			if( !collision_found )
 			{
@@ -365,6 +412,162 @@ cObjectCollisionType *cMovingSprite :: Col_Move_in_Steps( float move_x, float mo
 	return col_list;
 }
 
+// distance added to the sweep against float rounding
+static const float col_sweep_margin = 1.0f;
+/* distance the collision candidates are gathered around the checked rect
+ * covers the following ground, wall and activation checks of the frame
+ * and the movement of other objects in the same frame
+*/
+static const float col_cache_padding = 32.0f;
+
+/* Returns the last step of a movement in one direction
+ * pos : current position
+ * step : step size which can not be 0
+ * final_pos : final position
+ * returns 0 if the final position is not in the step direction
+*/
+static unsigned int Col_Get_Last_Step( const float pos, const float step, const float final_pos )
+{
+	const float distance = final_pos - pos;
+
+	if( ( step > 0.0f && distance <= 0.0f ) || ( step < 0.0f && distance >= 0.0f ) )
+	{
+		return 0;
+	}
+
+	// one more against float rounding in the step addition
+	return static_cast<unsigned int>(ceil( distance / step )) + 1;
+}
+
+/* Returns the first step in which the moving range can touch the object range
+ * pos, size : moving range
+ * col_pos, col_size : object range
+ * step : step size or 0 if not moving
+ * last_step : last step of the movement
+ * returns 0 if it is never touched
+*/
+static unsigned int Col_Get_First_Step( const float pos, const float size, const float col_pos, const float col_size, const float step, const unsigned int last_step )
+{
+	// not moving
+	if( Is_Float_Equal( step, 0.0f ) )
+	{
+		if( pos + size + col_sweep_margin >= col_pos && pos - col_sweep_margin <= col_pos + col_size )
+		{
+			return 1;
+		}
+
+		return 0;
+	}
+
+	float entry;
+
+	if( step > 0.0f )
+	{
+		// behind
+		if( col_pos + col_size + col_sweep_margin < pos )
+		{
+			return 0;
+		}
+
+		entry = col_pos - ( pos + size );
+	}
+	else
+	{
+		// behind
+		if( col_pos - col_sweep_margin > pos + size )
+		{
+			return 0;
+		}
+
+		entry = pos - ( col_pos + col_size );
+	}
+
+	entry -= col_sweep_margin;
+
+	const float step_size = fabs( step );
+
+	if( entry <= step_size )
+	{
+		return 1;
+	}
+
+	const float first_step = ceil( entry / step_size );
+
+	// not reached
+	if( first_step > static_cast<float>(last_step) )
+	{
+		return 0;
+	}
+
+	return static_cast<unsigned int>(first_step);
+}
+
+unsigned int cMovingSprite :: Col_Get_Free_Steps( float step_size_x, float step_size_y, float final_pos_x, float final_pos_y, const cSprite_List &sprite_list ) const
+{
+	unsigned int last_step_x = 0;
+	unsigned int last_step_y = 0;
+
+	if( !Is_Float_Equal( step_size_x, 0.0f ) )
+	{
+		last_step_x = Col_Get_Last_Step( m_pos_x, step_size_x, final_pos_x );
+
+		// check every step
+		if( !last_step_x )
+		{
+			return 0;
+		}
+	}
+
+	if( !Is_Float_Equal( step_size_y, 0.0f ) )
+	{
+		last_step_y = Col_Get_Last_Step( m_pos_y, step_size_y, final_pos_y );
+
+		// check every step
+		if( !last_step_y )
+		{
+			return 0;
+		}
+	}
+
+	// the step in both directions is counted together
+	unsigned int free_steps = ( last_step_x > last_step_y ) ? (last_step_x) : (last_step_y);
+
+	for( cSprite_List::const_iterator itr = sprite_list.begin(); itr != sprite_list.end(); ++itr )
+	{
+		const GL_rect &col_rect = (*itr)->m_col_rect;
+
+		const unsigned int first_step_x = Col_Get_First_Step( m_col_rect.m_x, m_col_rect.m_w, col_rect.m_x, col_rect.m_w, step_size_x, last_step_x );
+
+		if( !first_step_x )
+		{
+			continue;
+		}
+
+		const unsigned int first_step_y = Col_Get_First_Step( m_col_rect.m_y, m_col_rect.m_h, col_rect.m_y, col_rect.m_h, step_size_y, last_step_y );
+
+		if( !first_step_y )
+		{
+			continue;
+		}
+
+		// both directions must touch
+		const unsigned int first_step = ( first_step_x > first_step_y ) ? (first_step_x) : (first_step_y);
+
+		if( first_step - 1 < free_steps )
+		{
+			free_steps = first_step - 1;
+
+			// check the next step
+			if( !free_steps )
+			{
+				break;
+			}
+		}
+	}
+
+	return free_steps;
+}
+
 void cMovingSprite :: Col_Move( float move_x, float move_y, bool real /* = 0 */, bool force /* = 0 */, bool check_on_ground /* = 1 */ )
 {
 	// no need to move
@@ -382,8 +585,9 @@ void cMovingSprite :: Col_Move( float move_x, float move_y, bool real /* = 0 */,
 	// use speedfactor
 	if( !real )
 	{
-		move_x *= pFramerate->m_speed_factor;
-		move_y *= pFramerate->m_speed_factor;
+		const float speed_factor = Get_Context()->Get_Framerate()->m_speed_factor;
+		move_x *= speed_factor;
+		move_y *= speed_factor;
 	}
  
 	// check for collisions
@@ -413,7 +617,12 @@ void cMovingSprite :: Col_Move( float move_x, float move_y, bool real /* = 0 */,
 		}
 
 		cSprite_List sprite_list;
-		m_sprite_manager->Get_Colliding_Objects( sprite_list, complete_rect, 1, this );
+		m_sprite_manager->Get_Colliding_Objects( sprite_list, complete_rect, 1, this, m_col_layer_mask );
+
+		if( pObject_Profiler && pObject_Profiler->Is_Enabled() )
+		{
+			pObject_Profiler->Add_Candidates( sprite_list.size() );
+		}
 
 		// step size
 		float step_size_x = move_x;
@@ -504,8 +713,9 @@ void cMovingSprite :: Add_Velocity( const float x, const float y, const bool rea
 	}
 	else
 	{
-		m_velx += x * pFramerate->m_speed_factor;
-		m_vely += y * pFramerate->m_speed_factor;
+		const float speed_factor = Get_Context()->Get_Framerate()->m_speed_factor;
+		m_velx += x * speed_factor;
+		m_vely += y * speed_factor;
 	}
 }
 
@@ -517,7 +727,7 @@ void cMovingSprite :: Add_Velocity_X( const float x, const bool real /* = 0 */ )
 	}
 	else
 	{
-		m_velx += x * pFramerate->m_speed_factor;
+		m_velx += x * Get_Context()->Get_Framerate()->m_speed_factor;
 	}
 }
 
@@ -529,7 +739,7 @@ void cMovingSprite :: Add_Velocity_Y( const float y, const bool real /* = 0 */ )
 	}
 	else
 	{
-		m_vely += y * pFramerate->m_speed_factor;
+		m_vely += y * Get_Context()->Get_Framerate()->m_speed_factor;
 	}
 }
 
@@ -563,7 +773,7 @@ void cMovingSprite :: Update( void )
 {
 	if( m_freeze_counter > 0.0f )
 	{
-		m_freeze_counter -= pFramerate->m_speed_factor;
+		m_freeze_counter -= Get_Context()->Get_Framerate()->m_speed_factor;
 
 		if( m_freeze_counter <= 0.0f )
 		{
@@ -574,6 +784,24 @@ void cMovingSprite :: Update( void )
 	}
 }
 
+bool cMovingSprite :: Is_Sleep_Valid( void ) const
+{
+	// collisions need to be handled
+	if( !m_collisions.empty() )
+	{
+		return 0;
+	}
+
+	// if destroyed
+	if( m_auto_destroy )
+	{
+		return 1;
+	}
+
+	// the subclass updates are not known
+	return 0;
+}
+
 void cMovingSprite :: Draw( cSurface_Request *request /* = NULL */ )
 {
 	if( !m_valid_draw )
@@ -615,7 +843,7 @@ void cMovingSprite :: Draw( cSurface_Request *request /* = NULL */ )
 	if( create_request )
 	{
 		// add request
-		pRenderer->Add( request );
+		Get_Context()->Get_Renderer()->Add( request );
 	}
 }
 
@@ -678,7 +906,7 @@ cObjectCollisionType *cMovingSprite :: Collision_Check_Absolute( const float x,
 
 
 		// add request
-		pRenderer->Add( request );
+		Get_Context()->Get_Renderer()->Add( request );
 	}
 
 	// return collisions list
@@ -696,16 +924,26 @@ cObjectCollisionType *cMovingSprite :: Collision_Check( const GL_rect &new_rect,
 		return col_list;
 	}
 
+	// objects near the rect if no object list is given
+	const cSprite_List *check_objects = objects;
+
 	// if no object list is given get all objects available
-	if( !objects )
+	if( !check_objects )
 	{
-		objects = &m_sprite_manager->objects;
+		check_objects = &Get_Collision_Candidates( new_rect );
+
+		if( pObject_Profiler && pObject_Profiler->Is_Enabled() )
+		{
+			pObject_Profiler->Add_Candidates( check_objects->size() );
+		}
+
+		cSprite *player = Get_Context()->Get_Player();
 
 		// Player
-		if( m_type != TYPE_PLAYER && new_rect.Intersects( pActive_Player->m_col_rect ) )
+		if( m_type != TYPE_PLAYER && ( m_col_layer_mask & COL_LAYER_PLAYER ) && new_rect.Intersects( player->m_col_rect ) )
 		{
 			// validate
-			Col_Valid_Type col_valid = Validate_Collision( pActive_Player );
+			Col_Valid_Type col_valid = Validate_Collision( player );
 
 			// ignore internal collisions
 			if( check_type == COLLIDE_ONLY_BLOCKING )
@@ -728,13 +966,13 @@ cObjectCollisionType *cMovingSprite :: Collision_Check( const GL_rect &new_rect,
 			if( col_valid != COL_VTYPE_NOT_VALID )
 			{
 				// add to list
-				col_list->Add( Create_Collision_Object( this, pActive_Player, col_valid ) );
+				col_list->Add( Create_Collision_Object( this, player, col_valid ) );
 			}
 		}
 	}
 
 	// Check objects
-	for( cSprite_List::iterator itr = objects->begin(); itr != objects->end(); ++itr )
+	for( cSprite_List::const_iterator itr = check_objects->begin(); itr != check_objects->end(); ++itr )
 	{
 		// get object pointer
 		cSprite *level_object = (*itr);
@@ -763,6 +1001,12 @@ cObjectCollisionType *cMovingSprite :: Collision_Check( const GL_rect &new_rect,
 			continue;
 		}
 
+		// can never be valid
+		if( !Is_Collision_Possible( level_object ) )
+		{
+			continue;
+		}
+
 		// validate
 		Col_Valid_Type col_valid = Validate_Collision( level_object );
 
@@ -796,6 +1040,34 @@ cObjectCollisionType *cMovingSprite :: Collision_Check( const GL_rect &new_rect,
 	return col_list;
 }
 
+const cSprite_List &cMovingSprite :: Get_Collision_Candidates( const GL_rect &rect )
+{
+	// the rect size could be negative
+	const float x1 = std::min( rect.m_x, rect.m_x + rect.m_w );
+	const float y1 = std::min( rect.m_y, rect.m_y + rect.m_h );
+	const float x2 = std::max( rect.m_x, rect.m_x + rect.m_w );
+	const float y2 = std::max( rect.m_y, rect.m_y + rect.m_h );
+
+	const Uint64 version = m_sprite_manager->Get_Query_Version();
+
+	// still valid and inside the gathered rect
+	if( m_col_cache_manager == m_sprite_manager && m_col_cache_version == version && m_col_cache_layer_mask == m_col_layer_mask &&
+		x1 >= m_col_cache_rect.m_x && y1 >= m_col_cache_rect.m_y && x2 <= m_col_cache_rect.m_x + m_col_cache_rect.m_w && y2 <= m_col_cache_rect.m_y + m_col_cache_rect.m_h )
+	{
+		return m_col_cache_objects;
+	}
+
+	m_col_cache_rect = GL_rect( x1 - col_cache_padding, y1 - col_cache_padding, x2 - x1 + ( col_cache_padding * 2.0f ), y2 - y1 + ( col_cache_padding * 2.0f ) );
+	m_col_cache_manager = m_sprite_manager;
+	m_col_cache_version = version;
+	m_col_cache_layer_mask = m_col_layer_mask;
+
+	m_col_cache_objects.clear();
+	m_sprite_manager->Get_Grid_Objects( m_col_cache_objects, m_col_cache_rect, m_col_layer_mask );
+
+	return m_col_cache_objects;
+}
+
 void cMovingSprite :: Check_And_Handle_Out_Of_Level( const float move_x, const float move_y )
 {
 	if( Is_Out_Of_Level_Left( move_x ) )
@@ -819,7 +1091,9 @@ void cMovingSprite :: Check_And_Handle_Out_Of_Level( const float move_x, const f
 
 bool cMovingSprite :: Is_Out_Of_Level_Left( const float move_x ) const
 {
-	if( m_col_rect.m_x < pActive_Camera->m_limit_rect.m_x && m_col_rect.m_x - ( move_x - 0.00001f ) >= pActive_Camera->m_limit_rect.m_x  )
+	const GL_rect &limit_rect = Get_Context()->Get_Camera()->m_limit_rect;
+
+	if( m_col_rect.m_x < limit_rect.m_x && m_col_rect.m_x - ( move_x - 0.00001f ) >= limit_rect.m_x  )
 	{
 		return 1;
 	}
@@ -829,7 +1103,9 @@ bool cMovingSprite :: Is_Out_Of_Level_Left( const float move_x ) const
 
 bool cMovingSprite :: Is_Out_Of_Level_Right( const float move_x ) const
 {
-	if( m_col_rect.m_x + m_col_rect.m_w > pActive_Camera->m_limit_rect.m_x + pActive_Camera->m_limit_rect.m_w && m_col_rect.m_x + m_col_rect.m_w - ( move_x + 0.00001f ) <= pActive_Camera->m_limit_rect.m_x + pActive_Camera->m_limit_rect.m_w )
+	const GL_rect &limit_rect = Get_Context()->Get_Camera()->m_limit_rect;
+
+	if( m_col_rect.m_x + m_col_rect.m_w > limit_rect.m_x + limit_rect.m_w && m_col_rect.m_x + m_col_rect.m_w - ( move_x + 0.00001f ) <= limit_rect.m_x + limit_rect.m_w )
 	{
 		return 1;
 	}
@@ -839,7 +1115,9 @@ bool cMovingSprite :: Is_Out_Of_Level_Right( const float move_x ) const
 
 bool cMovingSprite :: Is_Out_Of_Level_Top( const float move_y ) const
 {
-	if( m_col_rect.m_y < pActive_Camera->m_limit_rect.m_y + pActive_Camera->m_limit_rect.m_h && m_col_rect.m_y - ( move_y - 0.00001f ) >= pActive_Camera->m_limit_rect.m_h + pActive_Camera->m_limit_rect.m_y )
+	const GL_rect &limit_rect = Get_Context()->Get_Camera()->m_limit_rect;
+
+	if( m_col_rect.m_y < limit_rect.m_y + limit_rect.m_h && m_col_rect.m_y - ( move_y - 0.00001f ) >= limit_rect.m_h + limit_rect.m_y )
 	{
 		return 1;
 	}
@@ -849,7 +1127,9 @@ bool cMovingSprite :: Is_Out_Of_Level_Top( const float move_y ) const
 
 bool cMovingSprite :: Is_Out_Of_Level_Bottom( const float move_y ) const
 {
-	if( m_col_rect.m_y + m_col_rect.m_h > pActive_Camera->m_limit_rect.m_y && m_col_rect.m_y + m_col_rect.m_h - ( move_y + 0.00001f ) <= pActive_Camera->m_limit_rect.m_y )
+	const GL_rect &limit_rect = Get_Context()->Get_Camera()->m_limit_rect;
+
+	if( m_col_rect.m_y + m_col_rect.m_h > limit_rect.m_y && m_col_rect.m_y + m_col_rect.m_h - ( move_y + 0.00001f ) <= limit_rect.m_y )
 	{
 		return 1;
 	}
@@ -872,7 +1152,7 @@ bool cMovingSprite :: Set_On_Ground( cSprite *obj, bool set_on_top /* = 1 */ )
 	}
 
 	// set groundobject
-	m_ground_object = obj;
+	Set_Ground_Object( obj );
 	// set on top
 	if( set_on_top )
 	{
@@ -938,6 +1218,37 @@ void cMovingSprite :: Check_on_Ground( void )
 	delete col_list;
 }
 
+void cMovingSprite :: Set_Ground_Object( cSprite *obj )
+{
+	m_ground_object = obj;
+
+	// the player moves itself as last
+	cMoving_Platform *platform = NULL;
+
+	if( obj && obj->m_type == TYPE_MOVING_PLATFORM && m_type != TYPE_PLAYER )
+	{
+		platform = static_cast<cMoving_Platform *>(obj);
+	}
+
+	// same platform
+	if( platform == m_ground_platform )
+	{
+		return;
+	}
+
+	if( m_ground_platform )
+	{
+		m_ground_platform->Remove_Rider( this );
+	}
+
+	m_ground_platform = platform;
+
+	if( m_ground_platform )
+	{
+		m_ground_platform->Add_Rider( this );
+	}
+}
+
 void cMovingSprite :: Update_Anti_Stuck( void )
 {
 	// collision count
@@ -990,8 +1301,43 @@ void cMovingSprite :: Collide_Move( void )
 	Move_With_Ground();
 }
 
+bool cMovingSprite :: Get_Collide_Move_Rect( GL_rect &rect ) const
+{
+	if( !m_valid_update || !Is_In_Range() )
+	{
+		return 0;
+	}
+
+	const float speed_factor = Get_Context()->Get_Framerate()->m_speed_factor;
+	const float move_x = m_velx * speed_factor;
+	const float move_y = m_vely * speed_factor;
+
+	// no need to move
+	if( Is_Float_Equal( move_x, 0.0f ) && Is_Float_Equal( move_y, 0.0f ) )
+	{
+		return 0;
+	}
+
+	// space for velocity changes
+	const float space = 16.0f;
+
+	rect = m_col_rect;
+	rect.m_x += ( ( move_x < 0.0f ) ? (move_x) : (0.0f) ) - space;
+	rect.m_y += ( ( move_y < 0.0f ) ? (move_y) : (0.0f) ) - space;
+	rect.m_w += fabs( move_x ) + ( space * 2.0f );
+	rect.m_h += fabs( move_y ) + ( space * 2.0f );
+
+	return 1;
+}
+
 void cMovingSprite :: Move_With_Ground( void )
 {
+	// moved by the platform
+	if( m_ground_platform )
+	{
+		return;
+	}
+
 	if( !m_ground_object || ( m_ground_object->m_sprite_array != ARRAY_ACTIVE && m_ground_object->m_sprite_array != ARRAY_ENEMY ) ) // || m_ground_object->sprite_array == ARRAY_MASSIVE
 	{
 		return;
@@ -1013,6 +1359,12 @@ void cMovingSprite :: Move_With_Ground( void )
 
 	// check ground first because of the moving object velocity
 	Check_on_Ground();
+
+	Move_With( moving_ground_object );
+}
+
+void cMovingSprite :: Move_With( cMovingSprite *moving_ground_object )
+{
 	// save posx for possible can not move test
 	float posy_orig = m_pos_y;
 	/* stop object from getting stopped of the moving object which did not yet move itself
@@ -1155,7 +1507,7 @@ void cMovingSprite :: Handle_Move_Object_Collision( const cObjectCollision *coll
 	}
 	else if( collision->m_array == ARRAY_PLAYER )
 	{
-		obj = static_cast<cMovingSprite *>(pLevel_Player);
+		obj = static_cast<cMovingSprite *>(Get_Context()->Get_Level_Player());
 	}
 	// not a valid type
 	else
@@ -1228,7 +1580,7 @@ Col_Valid_Type cMovingSprite :: Validate_Collision_Ghost( cSprite *obj )
 			}
 
 			// maryo is not ghost
-			if( pLevel_Player->m_maryo_type != MARYO_GHOST )
+			if( Get_Context()->Get_Level_Player()->m_maryo_type != MARYO_GHOST )
 			{
 				return COL_VTYPE_NOT_VALID;
 			}
@@ -1272,7 +1624,7 @@ Col_Valid_Type cMovingSprite :: Validate_Collision_Object_On_Top( cMovingSprite
 			// always pick up
 			if( moving_sprite->m_ground_object != this )
 			{
-				moving_sprite->m_ground_object = this;
+				moving_sprite->Set_Ground_Object( this );
 				return COL_VTYPE_NOT_VALID;
 			}
 		}
@@ -1329,7 +1681,7 @@ void cMovingSprite :: Send_Collision( const cObjectCollision *collision, bool ha
 
 	if( collision->m_array == ARRAY_PLAYER )
 	{
-		target_obj = pActive_Player;
+		target_obj = Get_Context()->Get_Player();
 	}
 	else
 	{
@@ -1349,6 +1701,7 @@ void cMovingSprite :: Send_Collision( const cObjectCollision *collision, bool ha
 
 	// set object
 	new_collision->m_obj = this;
+	new_collision->m_obj_handle = m_handle;
 	// set object manager id
 	new_collision->m_number = my_number;
 
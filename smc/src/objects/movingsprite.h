@@ -54,6 +54,8 @@ enum ColCheckType
 	COLLIDE_COMPLETE = 3
 };
 
+class cMoving_Platform;
+
 /* *** *** *** *** *** *** *** cMovingSprite *** *** *** *** *** *** *** *** *** *** */
 
 class cMovingSprite : public cSprite
@@ -63,6 +65,8 @@ public:
 	cMovingSprite( cSprite_Manager *sprite_manager, std::string type_name = "sprite" );
 	// create from stream
 	cMovingSprite( CEGUI::XMLAttributes &attributes, cSprite_Manager *sprite_manager, std::string type_name = "sprite" );
+	// create a clone of the given sprite for Copy
+	cMovingSprite( const cMovingSprite &sprite );
 	// destructor
 	virtual ~cMovingSprite( void );
 	
@@ -97,9 +101,13 @@ public:
 	virtual void Col_Move( float move_x, float move_y, bool real = 0, bool force = 0, bool check_on_ground = 1 );
 
 	/* if the ground object moves then move us with it
-	 * massive moving ground can crunch us
+	 * not used for a moving platform which moves its riders itself
 	*/
 	void Move_With_Ground( void );
+	/* move with the given moving ground object
+	 * massive moving ground can crunch us
+	*/
+	void Move_With( cMovingSprite *moving_ground_object );
 
 	// Set velocity
 	inline void Set_Velocity( const float x, const float y )
@@ -176,6 +184,8 @@ public:
 
 	// update
 	virtual void Update( void );
+	// if the update and collision handling would do nothing
+	virtual bool Is_Sleep_Valid( void ) const;
 	/* draw
 	* if request is NULL automatically creates the request
 	*/
@@ -219,13 +229,22 @@ public:
 	// object looses onground state
 	inline void Reset_On_Ground( void )
 	{
-		m_ground_object = NULL;
+		Set_Ground_Object( NULL );
 	};
+	/* Set the ground object without any checks
+	 * registers us as rider if it is a moving platform
+	*/
+	void Set_Ground_Object( cSprite *obj );
 	// Corrects the position if the object got stuck
 	void Update_Anti_Stuck( void );
 
 	// default collision and movement handling
 	virtual void Collide_Move( void );
+	/* Returns the rect the default collision and movement handling checks for collisions
+	 * with some space around it for velocity changes
+	 * returns false if it does not move
+	*/
+	bool Get_Collide_Move_Rect( GL_rect &rect ) const;
 
 	/* Freeze for the given time
 	*/
@@ -252,6 +271,25 @@ public:
 	 * returns 2 if the given object collides with this object (blocking)
 	*/
 	virtual Col_Valid_Type Validate_Collision( cSprite *obj );
+	/* Returns false if Validate_Collision can never accept the given object
+	 * uses the massive type mask of this class and rejects decoration
+	 * without calling the validation
+	*/
+	inline bool Is_Collision_Possible( const cSprite *obj ) const
+	{
+		if( !( m_col_valid_massive & ( 1 << obj->m_massive_type ) ) )
+		{
+			return 0;
+		}
+
+		// passive decoration
+		if( obj->m_massive_type == MASS_PASSIVE && ( obj->m_type == TYPE_PASSIVE || obj->m_type == TYPE_FRONT_PASSIVE ) )
+		{
+			return 0;
+		}
+
+		return 1;
+	}
 	/* Check if colliding with ghost objects
 	 * returns normal validation type if it can be handled else 3
 	 */
@@ -284,6 +322,17 @@ public:
 	bool m_can_be_on_ground;
 	// colliding ground object
 	cSprite *m_ground_object;
+	// moving platform we are registered on as rider
+	cMoving_Platform *m_ground_platform;
+	/* massive types of objects Validate_Collision can accept
+	 * set by every class overriding the validation
+	*/
+	Uint8 m_col_valid_massive;
+	/* collision layers of the objects Validate_Collision can accept
+	 * only these layers are queried from the collision grid
+	 * set by classes which never collide with some layers
+	*/
+	Uint32 m_col_layer_mask;
 
 	/* the different states
 	 * look at the definitions
@@ -298,10 +347,28 @@ public:
 private:
 	/* moves in steps and checks in both directions simultaneous
 	 * returns the found collisions
-	 * sprite_list : objects to check
+	 * sprite_list : objects to check and internal collisions are removed from it if not stop_on_internal
 	 * stop_on_internal : if set stops moving if internal collision was found
 	*/
-	cObjectCollisionType *Col_Move_in_Steps( float move_x, float move_y, float step_size_x, float step_size_y, float final_pos_x, float final_pos_y, cSprite_List sprite_list, bool stop_on_internal = 0 );
+	cObjectCollisionType *Col_Move_in_Steps( float move_x, float move_y, float step_size_x, float step_size_y, float final_pos_x, float final_pos_y, cSprite_List &sprite_list, bool stop_on_internal = 0 );
+	/* Returns the number of steps in each direction which can not touch any object of the list
+	 * sweeps the collision rect over the steps to the final position
+	 * a step size of 0 is no movement in that direction
+	*/
+	unsigned int Col_Get_Free_Steps( float step_size_x, float step_size_y, float final_pos_x, float final_pos_y, const cSprite_List &sprite_list ) const;
+	/* Returns the grid objects which could touch the rect
+	 * the grid is queried once with a padded rect and the following checks of the same frame
+	 * inside that rect reuse the objects until the sprite manager query version changes
+	*/
+	const cSprite_List &Get_Collision_Candidates( const GL_rect &rect );
+
+	// grid objects of the padded rect
+	cSprite_List m_col_cache_objects;
+	GL_rect m_col_cache_rect;
+	// sprite manager, query version and layer mask the objects were gathered with
+	const cSprite_Manager *m_col_cache_manager;
+	Uint64 m_col_cache_version;
+	Uint32 m_col_cache_layer_mask;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
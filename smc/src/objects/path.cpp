@@ -21,8 +21,6 @@
 #include "../user/savegame.h"
 #include "../level/level.h"
 #include "../core/sprite_manager.h"
-#include "../enemies/static.h"
-#include "../objects/moving_platform.h"
 // CEGUI
 #include "CEGUIWindowManager.h"
 #include "elements/CEGUIEditbox.h"
@@ -54,6 +52,10 @@ cPath_State :: ~cPath_State( void )
 	{
 		m_path->Remove_Link( this );
 	}
+	else if( m_sprite_manager )
+	{
+		m_sprite_manager->Remove_Waiting_Path_State( this );
+	}
 }
 
 void cPath_State :: Load_From_Savegame( cSave_Level_Object *save_object )
@@ -100,7 +102,13 @@ void cPath_State :: Save_To_Savegame( cSave_Level_Object *save_object )
 
 void cPath_State :: Set_Sprite_Manager( cSprite_Manager *sprite_manager )
 {
+	if( !m_path && m_sprite_manager )
+	{
+		m_sprite_manager->Remove_Waiting_Path_State( this );
+	}
+
 	m_sprite_manager = sprite_manager;
+	Wait_For_Path();
 }
 
 void cPath_State :: Draw( void )
@@ -120,26 +128,7 @@ cPath *cPath_State :: Get_Path_Object( const std::string &identifier )
 		return NULL;
 	}
 
-	// Search for path
-	for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
-	{
-		cSprite *obj = (*itr);
-
-		if( obj->m_type != TYPE_PATH || obj->m_auto_destroy )
-		{
-			continue;
-		}
-
-		cPath *path = static_cast<cPath *>(obj);
-
-		// found
-		if( path->m_identifier.compare( identifier ) == 0 )
-		{
-			return path;
-		}
-	}
-
-	return NULL;
+	return static_cast<cPath *>(m_sprite_manager->Get_Named_Object( TYPE_PATH, identifier ));
 }
 
 void cPath_State :: Set_Path_Identifier( const std::string &path )
@@ -149,6 +138,10 @@ void cPath_State :: Set_Path_Identifier( const std::string &path )
 	{
 		m_path->Remove_Link( this );
 	}
+	else if( m_sprite_manager )
+	{
+		m_sprite_manager->Remove_Waiting_Path_State( this );
+	}
 
 	// set path
 	m_path_identifier = path;
@@ -157,6 +150,7 @@ void cPath_State :: Set_Path_Identifier( const std::string &path )
 	// not found
 	if( !m_path )
 	{
+		Wait_For_Path();
 		return;
 	}
 	
@@ -170,6 +164,7 @@ void cPath_State :: Set_Path_Identifier( const std::string &path )
 void cPath_State :: Path_Destroyed_Event( void )
 {
 	m_path = NULL;
+	Wait_For_Path();
 }
 
 void cPath_State :: Move_Toggle( void )
@@ -266,106 +261,88 @@ bool cPath_State :: Path_Move( float distance )
 		return 0;
 	}
 
-	// get current segment object
-	cPath_Segment obj = m_path->m_segments[m_current_segment];
+	// distance from the path start
+	float path_pos = m_path->m_segment_starts[m_current_segment] + m_current_segment_pos;
 
-	// walk forward
 	if( m_forward )
 	{
-		while( 1 )
-		{
-			// how much is left
-			float remaining = obj.m_distance - m_current_segment_pos;
+		path_pos += distance;
+	}
+	else
+	{
+		path_pos -= distance;
+	}
 
-			if( distance > remaining )
-			{
-				m_pos_x = obj.m_x2;
-				m_pos_y = obj.m_y2;
-
-				// finished
-				if( m_current_segment + 1 >= m_path->m_segments.size() )
-				{
-					// rewind
-					if( m_path->m_rewind )
-					{
-						m_current_segment = 0;
-						m_current_segment_pos = 0;
-						return 0;
-					}
-					// mirror
-					else
-					{
-						return 0;
-					}
-				}
-
-				// set current segment object
-				m_current_segment++;
-				obj = m_path->m_segments[m_current_segment];
-
-				m_current_segment_pos = 0;
-				distance -= remaining;
-			}
-			else
-			{
-				m_current_segment_pos += distance;
-				m_pos_x = obj.m_x1 + obj.m_ux * m_current_segment_pos;
-				m_pos_y = obj.m_y1 + obj.m_uy * m_current_segment_pos;
+	// finished at the end
+	if( path_pos > m_path->m_length )
+	{
+		const cPath_Segment &last = m_path->m_segments.back();
+		m_pos_x = last.m_x2;
+		m_pos_y = last.m_y2;
 
-				return 1;
-			}
+		// rewind
+		if( m_path->m_rewind )
+		{
+			m_current_segment = 0;
+			m_current_segment_pos = 0;
 		}
+		// mirror
+		else
+		{
+			m_current_segment = m_path->m_segments.size() - 1;
+			m_current_segment_pos = last.m_distance;
+		}
+
+		return 0;
 	}
-	// walk backward
-	else
+	// finished at the start
+	else if( path_pos < 0.0f )
 	{
-		while( 1 )
+		const cPath_Segment &first = m_path->m_segments.front();
+		m_pos_x = first.m_x1;
+		m_pos_y = first.m_y1;
+
+		// rewind
+		if( m_path->m_rewind )
+		{
+			m_current_segment = m_path->m_segments.size() - 1;
+			m_current_segment_pos = m_path->m_segments.back().m_distance;
+		}
+		// mirror
+		else
 		{
-			// how much is left
-			float remaining = m_current_segment_pos;
+			m_current_segment = 0;
+			m_current_segment_pos = 0;
+		}
 
-			if( distance > remaining )
-			{
-				m_pos_x = obj.m_x1;
-				m_pos_y = obj.m_y1;
-
-				// finished
-				if( m_current_segment == 0 )
-				{
-					// rewind
-					if( m_path->m_rewind )
-					{
-						m_current_segment = m_path->m_segments.size() - 1;
-						obj = m_path->m_segments[m_current_segment];
-						m_current_segment_pos = obj.m_distance;
-						return 0;
-					}
-					// mirror
-					else
-					{
-						return 0;
-					}
-				}
-
-				// set current segment object
-				m_current_segment--;
-				obj = m_path->m_segments[m_current_segment];
-
-				m_current_segment_pos = obj.m_distance;
-				distance -= remaining;
-			}
-			else
-			{
-				m_current_segment_pos -= distance;
-				m_pos_x = obj.m_x1 + obj.m_ux * m_current_segment_pos;
-				m_pos_y = obj.m_y1 + obj.m_uy * m_current_segment_pos;
+		return 0;
+	}
 
-				return 1;
-			}
-		}
+	// search only if it left the current segment
+	const float segment_start = m_path->m_segment_starts[m_current_segment];
+
+	if( path_pos < segment_start || path_pos > segment_start + m_path->m_segments[m_current_segment].m_distance )
+	{
+		m_current_segment = m_path->Get_Segment( path_pos );
+	}
+
+	const cPath_Segment &obj = m_path->m_segments[m_current_segment];
+
+	m_current_segment_pos = path_pos - m_path->m_segment_starts[m_current_segment];
+	m_pos_x = obj.m_x1 + obj.m_ux * m_current_segment_pos;
+	m_pos_y = obj.m_y1 + obj.m_uy * m_current_segment_pos;
+
+	return 1;
+}
+
+void cPath_State :: Wait_For_Path( void )
+{
+	if( m_path || !m_sprite_manager )
+	{
+		return;
 	}
 
-	return 0;
+	m_sprite_manager->Add_Waiting_Path_State( this );
 }
 
 /* *** *** *** *** *** *** cPath_Segment *** *** *** *** *** *** *** *** *** *** *** */
@@ -494,6 +471,7 @@ void cPath :: Init( void )
 	m_start_rect.m_h = m_rect.m_h;
 
 	m_rewind = 0;
+	m_length = 0.0f;
 	m_editor_color = Color( static_cast<Uint8>(100), 150, 200, 128 );
 	m_editor_selected_segment = 0;
 }
@@ -503,6 +481,7 @@ cPath *cPath :: Copy( void ) const
 	cPath *path = new cPath( m_sprite_manager );
 	path->Set_Pos( m_start_pos_x, m_start_pos_y, 1 );
 	path->m_segments = m_segments;
+	path->Update_Length();
 	path->Set_Identifier( m_identifier );
 	path->Set_Rewind( m_rewind );
 	return path;
@@ -541,12 +520,14 @@ void cPath :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 
 		count++;
 	}
+
+	Update_Length();
 }
 
-void cPath :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cPath :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// position
 	Write_Property( stream, "posx", static_cast<int>( m_start_pos_x ) );
@@ -565,14 +546,14 @@ void cPath :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	{
 		std::string str_pos = int_to_string( pos );
 
-		Write_Property( stream, "segment_" + str_pos + "_x1", m_segments[pos].m_x1 );
-		Write_Property( stream, "segment_" + str_pos + "_y1", m_segments[pos].m_y1 );
-		Write_Property( stream, "segment_" + str_pos + "_x2", m_segments[pos].m_x2 );
-		Write_Property( stream, "segment_" + str_pos + "_y2", m_segments[pos].m_y2 );
+		Write_Property( stream, ( "segment_" + str_pos + "_x1" ).c_str(), m_segments[pos].m_x1 );
+		Write_Property( stream, ( "segment_" + str_pos + "_y1" ).c_str(), m_segments[pos].m_y1 );
+		Write_Property( stream, ( "segment_" + str_pos + "_x2" ).c_str(), m_segments[pos].m_x2 );
+		Write_Property( stream, ( "segment_" + str_pos + "_y2" ).c_str(), m_segments[pos].m_y2 );
 	}
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cPath :: Load_From_Savegame( cSave_Level_Object *save_object )
@@ -586,8 +567,8 @@ cSave_Level_Object *cPath :: Save_To_Savegame( void )
 
 	// default values
 	save_object->m_type = m_type;
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posx", int_to_string( static_cast<int>(m_start_pos_x) ) ) );
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posy", int_to_string( static_cast<int>(m_start_pos_y) ) ) );
+	save_object->m_posx = static_cast<int>(m_start_pos_x);
+	save_object->m_posy = static_cast<int>(m_start_pos_y);
 
 	return save_object;
 }
@@ -596,56 +577,36 @@ void cPath :: Set_Identifier( const std::string &identifier )
 {
 	m_identifier = identifier;
 
+	if( m_sprite_manager )
+	{
+		m_sprite_manager->Update_Identifier( this );
+	}
+
 	// remove linked objects
 	Remove_Links();
 	
-	if( m_identifier.empty() )
+	if( m_identifier.empty() || !m_sprite_manager )
 	{
 		return;
 	}
 
-	/* search for linked objects
-	 * needed to update the links
-	*/
-	for( cSprite_List::iterator itr = pActive_Level->m_sprite_manager->objects.begin(); itr != pActive_Level->m_sprite_manager->objects.end(); ++itr )
-	{
-		cSprite *obj = (*itr);
+	// link the objects waiting for the identifier
+	vector<cPath_State *> path_states;
+	m_sprite_manager->Get_Waiting_Path_States( m_identifier, path_states );
 
-		if( obj->m_auto_destroy )
-		{
-			continue;
-		}
-
-		if( obj->m_type == TYPE_STATIC_ENEMY )
-		{
-			cStaticEnemy *static_enemy = static_cast<cStaticEnemy *>(obj);
-
-			// found
-			if( static_enemy->m_path_state.m_path_identifier.compare( m_identifier ) == 0 )
-			{
-				// link to me
-				static_enemy->Init_Links();
-				//static_enemy->m_path_state.Set_Path_Identifier( m_identifier );
-			}
-		}
-		else if( obj->m_type == TYPE_MOVING_PLATFORM )
-		{
-			cMoving_Platform *moving_platform = static_cast<cMoving_Platform *>(obj);
+	for( vector<cPath_State *>::iterator itr = path_states.begin(); itr != path_states.end(); ++itr )
+	{
+		cPath_State *obj = (*itr);
 
-			// found
-			if( moving_platform->m_path_state.m_path_identifier.compare( m_identifier ) == 0 )
-			{
-				// link to me
-				moving_platform->Init_Links();
-				//moving_platform->m_path_state.Set_Path_Identifier( m_identifier );
-			}
-		}
+		obj->Set_Path_Identifier( obj->m_path_identifier );
 	}
 }
 
 void cPath :: Set_Show_Line( bool show )
 {
 	m_show_line = show;
+
+	Update_Valid_Draw();
 }
 
 void cPath :: Set_Rewind( bool rewind )
@@ -700,7 +661,10 @@ void cPath :: Remove_Link( cPath_State *path_state )
 
 void cPath :: Remove_Links( void )
 {
-	for( PathStateList::iterator itr = m_linked_path_states.begin(); itr != m_linked_path_states.end(); ++itr )
+	PathStateList linked_path_states;
+	linked_path_states.swap( m_linked_path_states );
+
+	for( PathStateList::iterator itr = linked_path_states.begin(); itr != linked_path_states.end(); ++itr )
 	{
 		cPath_State *obj = (*itr);
 
@@ -708,6 +672,36 @@ void cPath :: Remove_Links( void )
 	}
 }
 
+void cPath :: Update_Length( void )
+{
+	m_segment_starts.resize( m_segments.size() );
+	m_length = 0.0f;
+
+	for( unsigned int i = 0; i < m_segments.size(); i++ )
+	{
+		m_segment_starts[i] = m_length;
+		m_length += m_segments[i].m_distance;
+	}
+}
+
+unsigned int cPath :: Get_Segment( float distance ) const
+{
+	if( m_segment_starts.empty() )
+	{
+		return 0;
+	}
+
+	// the last segment starting before the distance
+	vector<float>::const_iterator itr = std::upper_bound( m_segment_starts.begin(), m_segment_starts.end(), distance );
+
+	if( itr == m_segment_starts.begin() )
+	{
+		return 0;
+	}
+
+	return static_cast<unsigned int>( itr - m_segment_starts.begin() ) - 1;
+}
+
 void cPath :: Update( void )
 {
 	if( !m_valid_update )
@@ -771,6 +765,11 @@ bool cPath :: Is_Draw_Valid( void )
 	return 1;
 }
 
+std::string cPath :: Get_Identifier( void ) const
+{
+	return m_identifier;
+}
+
 void cPath :: Editor_Activate( void )
 {
 	CEGUI::WindowManager &wmgr = CEGUI::WindowManager::getSingleton();
@@ -983,6 +982,7 @@ bool cPath :: Editor_Button_Add_Segment_Clicked( const CEGUI::EventArgs &event )
 	cPath_Segment new_segment = m_segments[m_editor_selected_segment];
 	new_segment.Set_Pos( new_segment.m_x2, new_segment.m_y2, new_segment.m_x2 + 20, new_segment.m_y2 - 20 );
 	m_segments.insert( m_segments.begin() + m_editor_selected_segment + 1, new_segment );
+	Update_Length();
 
 	m_editor_selected_segment++;
 	Editor_State_Update();
@@ -999,6 +999,7 @@ bool cPath :: Editor_Button_Delete_Segment_Clicked( const CEGUI::EventArgs &even
 	}
 
 	m_segments.erase( m_segments.begin() + m_editor_selected_segment );
+	Update_Length();
 
 	for( PathStateList::iterator itr = m_linked_path_states.begin(); itr != m_linked_path_states.end(); ++itr )
 	{
@@ -1071,6 +1072,8 @@ bool cPath :: Editor_Pos_Y2_Text_Changed( const CEGUI::EventArgs &event )
 
 void cPath :: Editor_Segment_Pos_Changed( void )
 {
+	Update_Length();
+
 	for( PathStateList::iterator itr = m_linked_path_states.begin(); itr != m_linked_path_states.end(); ++itr )
 	{
 		cPath_State *obj = (*itr);
@@ -91,6 +91,10 @@ public:
 	float m_current_segment_pos;
 	// current segment
 	unsigned int m_current_segment;
+
+private:
+	// Wait in the sprite manager for a path with the identifier if not linked
+	void Wait_For_Path( void );
 };
 
 /* *** *** *** *** *** *** *** cPath_Segment *** *** *** *** *** *** *** *** *** *** */
@@ -154,7 +158,7 @@ public:
 	// load from stream
 	virtual void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream );
+	virtual void Save_To_XML( cXml_Writer &stream );
 
 	// load from savegame
 	virtual void Load_From_Savegame( cSave_Level_Object *save_object );
@@ -175,6 +179,13 @@ public:
 	// Remove all links
 	void Remove_Links( void );
 
+	/* Update the distances of the segment starts from the path start
+	 * must be called if the segments changed
+	*/
+	void Update_Length( void );
+	// Returns the segment at the given distance from the path start
+	unsigned int Get_Segment( float distance ) const;
+
 	// update
 	virtual void Update( void );
 	// draw
@@ -182,6 +193,8 @@ public:
 
 	// if draw is valid for the current state and position
 	virtual bool Is_Draw_Valid( void );
+	// Returns the identifier
+	virtual std::string Get_Identifier( void ) const;
 
 	// level editor activation
 	virtual void Editor_Activate( void );
@@ -220,6 +233,10 @@ public:
 	// line segments
 	typedef vector<cPath_Segment> PathList;
 	PathList m_segments;
+	// distance of each segment start from the path start
+	vector<float> m_segment_starts;
+	// total distance
+	float m_length;
 
 	// linked path states
 	typedef vector<cPath_State *> PathStateList;
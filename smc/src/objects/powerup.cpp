@@ -23,6 +23,8 @@
 #include "../user/savegame.h"
 #include "../core/math/utilities.h"
 #include "../core/i18n.h"
+#include "../core/sprite_manager.h"
+#include "../core/engine_context.h"
 
 namespace SMC
 {
@@ -35,6 +37,9 @@ cPowerUp :: cPowerUp( cSprite_Manager *sprite_manager )
 	m_sprite_array = ARRAY_ACTIVE;
 	m_massive_type = MASS_PASSIVE;
 	m_type = TYPE_POWERUP;
+	m_col_valid_massive = COL_MASK_MASSIVE | COL_MASK_HALFMASSIVE;
+	// enemies and balls are ignored
+	m_col_layer_mask = COL_LAYER_SOLID | COL_LAYER_ACTIVE | COL_LAYER_PLAYER;
 	m_pos_z = 0.05f;
 	m_gravity_max = 25.0f;
 
@@ -91,8 +96,8 @@ cSave_Level_Object *cPowerUp :: Save_To_Savegame( void )
 
 	// default values
 	save_object->m_type = m_type;
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posx", int_to_string( static_cast<int>(m_start_pos_x) ) ) );
-	save_object->m_properties.push_back( cSave_Level_Object_Property( "posy", int_to_string( static_cast<int>(m_start_pos_y) ) ) );
+	save_object->m_posx = static_cast<int>(m_start_pos_x);
+	save_object->m_posy = static_cast<int>(m_start_pos_y);
 
 	// new position ( only save if needed )
 	if( !Is_Float_Equal( m_start_pos_x, m_pos_x ) || !Is_Float_Equal( m_start_pos_y, m_pos_y ) )
@@ -254,10 +259,10 @@ void cMushroom :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Type( static_cast<SpriteType>(attributes.getValueAsInteger( "mushroom_type", TYPE_MUSHROOM_DEFAULT )) );
 }
 
-void cMushroom :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cMushroom :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// type
 	Write_Property( stream, "type", "mushroom" );
@@ -268,7 +273,7 @@ void cMushroom :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "posy", static_cast<int>( m_start_pos_y ) );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cMushroom :: Set_Type( SpriteType new_type )
@@ -314,6 +319,11 @@ void cMushroom :: Set_Type( SpriteType new_type )
 	}
 	
 	m_type = new_type;
+
+	if( m_sprite_manager )
+	{
+		m_sprite_manager->Update_Type( this );
+	}
 	
 	Set_Image_Num( 0, 1, 0 );
 }
@@ -325,7 +335,7 @@ void cMushroom :: Activate( void )
 		return;
 	}
 
-	pLevel_Player->Get_Item( m_type );
+	Get_Context()->Get_Level_Player()->Get_Item( m_type );
 
 	if( m_type == TYPE_MUSHROOM_DEFAULT )
 	{
@@ -570,10 +580,10 @@ void cFirePlant :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Pos( static_cast<float>(attributes.getValueAsInteger( "posx" )), static_cast<float>(attributes.getValueAsInteger( "posy" )), 1 );
 }
 
-void cFirePlant :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cFirePlant :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// type
 	Write_Property( stream, "type", "fireplant" );
@@ -582,7 +592,7 @@ void cFirePlant :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "posy", static_cast<int>( m_start_pos_y ) );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cFirePlant :: Activate( void )
@@ -592,7 +602,7 @@ void cFirePlant :: Activate( void )
 		return;
 	}
 
-	pLevel_Player->Get_Item( TYPE_FIREPLANT );
+	Get_Context()->Get_Level_Player()->Get_Item( TYPE_FIREPLANT );
 
 	pHud_Points->Add_Points( 700, m_pos_x + m_image->m_w / 2, m_pos_y );
 	
@@ -730,10 +740,10 @@ void cMoon :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Pos( static_cast<float>(attributes.getValueAsInteger( "posx" )), static_cast<float>(attributes.getValueAsInteger( "posy" )) );
 }
 
-void cMoon :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cMoon :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// type
 	Write_Property( stream, "type", "moon" );
@@ -742,7 +752,7 @@ void cMoon :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "posy", static_cast<int>( m_start_pos_y ) );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cMoon :: Activate( void )
@@ -752,7 +762,7 @@ void cMoon :: Activate( void )
 		return;
 	}
 
-	pLevel_Player->Get_Item( TYPE_MOON );
+	Get_Context()->Get_Level_Player()->Get_Item( TYPE_MOON );
 
 	pHud_Points->Add_Points( 4000, m_pos_x + m_image->m_w / 2, m_pos_y );
 
@@ -75,15 +75,15 @@ void cSpinBox :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	cBaseBox::Load_From_XML( attributes );
 }
 
-void cSpinBox :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cSpinBox :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	cBaseBox::Save_To_XML( stream );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cSpinBox :: Activate( void )
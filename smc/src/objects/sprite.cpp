@@ -23,18 +23,33 @@
 #include "../video/gl_surface.h"
 #include "../video/renderer.h"
 #include "../core/sprite_manager.h"
+#include "../core/engine_context.h"
 #include "../core/editor.h"
 #include "../core/i18n.h"
+#include "../core/update_workers.h"
+#include "../core/string_table.h"
 // CEGUI
 #include "CEGUIWindowManager.h"
 #include "CEGUIFontManager.h"
 #include "elements/CEGUIEditbox.h"
 #include "elements/CEGUICombobox.h"
 #include "elements/CEGUIComboDropList.h"
+#include <typeinfo>
 
 namespace SMC
 {
 
+// handles of all sprites
+static cObject_Handle_Table<cSprite> sprite_handles;
+
+cMemory_Counter sprite_memory( "Sprites" );
+cMemory_Arena *pSprite_Arena = NULL;
+
+cSprite *Get_Sprite( const cObject_Handle &handle )
+{
+	return sprite_handles.Get( handle );
+}
+
 /* *** *** *** *** *** *** *** *** cCollidingSprite *** *** *** *** *** *** *** *** *** */
 
 cCollidingSprite :: cCollidingSprite( cSprite_Manager *sprite_manager )
@@ -52,6 +67,16 @@ void cCollidingSprite :: Set_Sprite_Manager( cSprite_Manager *sprite_manager )
 	m_sprite_manager = sprite_manager;
 }
 
+cEngine_Context *cCollidingSprite :: Get_Context( void ) const
+{
+	if( m_sprite_manager )
+	{
+		return m_sprite_manager->m_context;
+	}
+
+	return pDefault_Engine_Context;
+}
+
 void cCollidingSprite :: Handle_Collisions( void )
 {
 	// get collision list
@@ -61,6 +86,13 @@ void cCollidingSprite :: Handle_Collisions( void )
 	// parse the given collisions
 	for( cObjectCollision_List::iterator itr = col_list.begin(); itr != col_list.end(); ++itr )
 	{
+		// the colliding object was deleted
+		if( (*itr)->m_obj && !(*itr)->Get_Object() )
+		{
+			debug_print( "Collision with a deleted object\n" );
+			continue;
+		}
+
 		// handle it
 		Handle_Collision( (*itr) );
 	}
@@ -90,6 +122,7 @@ cObjectCollision *cCollidingSprite :: Create_Collision_Object( const cSprite *ba
 	{
 		// object
 		collision->m_obj = col;
+		collision->m_obj_handle = col->m_handle;
 		// identifier
 		if( col->m_sprite_array != ARRAY_PLAYER )
 		{
@@ -128,6 +161,13 @@ bool cCollidingSprite :: Add_Collision( cObjectCollision *collision, bool add_if
 
 	m_collisions.push_back( collision );
 
+	// handle it with the next collision handling
+	if( m_sprite_manager )
+	{
+		// always a sprite
+		m_sprite_manager->Wake_Up( static_cast<cSprite *>(this) );
+	}
+
 	return 1;
 }
 
@@ -166,6 +206,24 @@ void cCollidingSprite :: Delete_Collision( cObjectCollision *collision )
 	delete collision;
 }
 
+void cCollidingSprite :: Delete_Invalid_Collisions( void )
+{
+	for( cObjectCollision_List::iterator itr = m_collisions.begin(); itr != m_collisions.end(); )
+	{
+		cObjectCollision *collision = (*itr);
+
+		// object still available
+		if( !collision->m_obj || collision->Get_Object() )
+		{
+			++itr;
+			continue;
+		}
+
+		itr = m_collisions.erase( itr );
+		delete collision;
+	}
+}
+
 void cCollidingSprite :: Delete_Last_Collision( void )
 {
 	if( m_collisions.empty() )
@@ -302,25 +360,89 @@ const float cSprite::m_pos_z_front_passive_start = 0.1f;
 const float cSprite::m_pos_z_halfmassive_start = 0.04f;
 
 cSprite :: cSprite( cSprite_Manager *sprite_manager, const std::string type_name /* = "sprite" */ )
-: cCollidingSprite( sprite_manager ), m_type_name( type_name )
+: cCollidingSprite( sprite_manager ), m_type_name( Get_String_Table().Intern( type_name ) )
 {
+	m_handle = sprite_handles.Acquire( this );
 	cSprite::Init();
 }
 
 cSprite :: cSprite( CEGUI::XMLAttributes &attributes, cSprite_Manager *sprite_manager, const std::string type_name /* = "sprite" */ )
-: cCollidingSprite( sprite_manager ), m_type_name( type_name )
+: cCollidingSprite( sprite_manager ), m_type_name( Get_String_Table().Intern( type_name ) )
 {
+	m_handle = sprite_handles.Acquire( this );
 	cSprite::Init();
 	cSprite::Load_From_XML( attributes );
 }
 
+cSprite :: cSprite( const cSprite &sprite )
+: cCollidingSprite( sprite.m_sprite_manager ), m_type_name( sprite.m_type_name )
+{
+	m_handle = sprite_handles.Acquire( this );
+	cSprite::Init();
+
+	m_type = sprite.m_type;
+	m_sprite_array = sprite.m_sprite_array;
+	m_massive_type = sprite.m_massive_type;
+	m_can_be_ground = sprite.m_can_be_ground;
+	m_rotation_affects_rect = sprite.m_rotation_affects_rect;
+	m_scale_affects_rect = sprite.m_scale_affects_rect;
+	m_scale_up = sprite.m_scale_up;
+	m_scale_down = sprite.m_scale_down;
+	m_scale_left = sprite.m_scale_left;
+	m_scale_right = sprite.m_scale_right;
+	m_no_camera = sprite.m_no_camera;
+	m_shadow_pos = sprite.m_shadow_pos;
+	m_shadow_color = sprite.m_shadow_color;
+	m_spawned = sprite.m_spawned;
+	// the image is not owned by the clone
+	m_start_image = sprite.m_start_image;
+	m_start_pos_x = sprite.m_start_pos_x;
+	m_start_pos_y = sprite.m_start_pos_y;
+}
+
 cSprite :: ~cSprite( void )
 {
+	sprite_handles.Release( m_handle );
+
+	if( m_grid )
+	{
+		m_grid->Remove( this );
+	}
+
+	if( m_editor_grid )
+	{
+		m_editor_grid->Remove( this );
+	}
+
 	if( m_delete_image && m_image )
 	{
 		delete m_image;
 		m_image = NULL;
 	}
+
+	if( m_editor_state )
+	{
+		delete m_editor_state;
+		m_editor_state = NULL;
+	}
+}
+
+void *cSprite :: operator new( size_t size )
+{
+	sprite_memory.Add( size );
+
+	return cMemory_Arena::Get( pSprite_Arena, size );
+}
+
+void cSprite :: operator delete( void *ptr, size_t size )
+{
+	if( !ptr )
+	{
+		return;
+	}
+
+	sprite_memory.Remove( size );
+	cMemory_Arena::Release( ptr );
 }
 
 void cSprite :: Init( void )
@@ -345,6 +467,9 @@ void cSprite :: Init( void )
 
 	m_start_pos_x = 0.0f;
 	m_start_pos_y = 0.0f;
+	m_tick_pos_x = 0.0f;
+	m_tick_pos_y = 0.0f;
+	m_tick = 0;
 
 	m_start_image = NULL;
 	m_image = NULL;
@@ -393,30 +518,67 @@ void cSprite :: Init( void )
 	m_scale_y = 1.0f;
 
 	m_valid_draw = 1;
+	m_draw_dirty = 0;
+	m_draw_listed = 0;
 	m_valid_update = 1;
-
-	m_editor_window_name_width = 0.0f;
+	m_static_chunk = 0;
+	m_array_num = -1;
+	m_grid = NULL;
+	m_editor_grid = NULL;
+	m_grid_x1 = 0;
+	m_grid_y1 = 0;
+	m_grid_x2 = 0;
+	m_grid_y2 = 0;
+	m_grid_large = 0;
+	m_grid_static = 0;
+	m_grid_query = 0;
+	m_grid_layer = COL_LAYER_NONE;
+	m_sleeping = 0;
+	m_static_gather_num = -1;
+	m_index_type = TYPE_UNDEFINED;
+	m_index_array = ARRAY_UNDEFINED;
+	m_type_num = -1;
+	m_array_type_num = -1;
+	m_awake_num = -1;
+	m_zpos_num = -1;
+	m_editor_zpos_num = -1;
+	m_draw_dirty_num = -1;
+	m_visible_num = -1;
+	m_index_name_id = 0;
+	m_stream_num = -1;
+	m_level_num = -1;
+
+	m_editor_state = NULL;
 }
 
 cSprite *cSprite :: Copy( void ) const
 {
-	cSprite *basic_sprite = new cSprite( m_sprite_manager );
-	basic_sprite->Set_Image( m_start_image, 1 );
-	basic_sprite->Set_Pos( m_start_pos_x, m_start_pos_y, 1 );
-	basic_sprite->m_type = m_type;
-	basic_sprite->m_sprite_array = m_sprite_array;
-	basic_sprite->Set_Massive_Type( m_massive_type );
-	basic_sprite->m_can_be_ground = m_can_be_ground;
-	basic_sprite->Set_Rotation_Affects_Rect( m_rotation_affects_rect );
-	basic_sprite->Set_Scale_Affects_Rect( m_scale_affects_rect );
-	basic_sprite->Set_Scale_Directions( m_scale_up, m_scale_down, m_scale_left, m_scale_right );
-	basic_sprite->Set_Ignore_Camera( m_no_camera );
-	basic_sprite->Set_Shadow_Pos( m_shadow_pos );
-	basic_sprite->Set_Shadow_Color( m_shadow_color );
-	basic_sprite->Set_Spawned( m_spawned );
+	cSprite *basic_sprite = new cSprite( *this );
+	basic_sprite->Finish_Copy();
 	return basic_sprite;
 }
 
+void cSprite :: Finish_Copy( void )
+{
+	m_image = m_start_image;
+	m_pos_x = m_start_pos_x;
+	m_pos_y = m_start_pos_y;
+
+	Update_Image_Rect();
+
+	if( m_start_image )
+	{
+		m_start_rect.m_w = m_start_image->m_w;
+		m_start_rect.m_h = m_start_image->m_h;
+		m_name = m_start_image->m_name;
+		m_editor_tags = m_start_image->m_editor_tags;
+	}
+
+	// set the massive type z position
+	Set_Massive_Type( m_massive_type );
+	Update_Position_Rect();
+}
+
 void cSprite :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 {
 	// position
@@ -427,10 +589,10 @@ void cSprite :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Sprite_Type( Get_Sprite_Type_Id( attributes.getValueAsString( "type" ).c_str() ) );
 }
 
-void cSprite :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cSprite :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// position
 	Write_Property( stream, "posx", static_cast<int>( m_start_pos_x ) );
@@ -461,7 +623,7 @@ void cSprite :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "type", Get_Sprite_Type_String() );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cSprite :: Set_Image( cGL_Surface *new_image, bool new_start_image /* = 0 */, bool del_img /* = 0 */ )
@@ -485,34 +647,10 @@ void cSprite :: Set_Image( cGL_Surface *new_image, bool new_start_image /* = 0 *
 
 	m_image = new_image;
 
+	Update_Image_Rect();
+
 	if( m_image )
 	{
-		// collision data
-		m_col_pos = m_image->m_col_pos;
-		// scale affects the rect
-		if( m_scale_affects_rect )
-		{
-			m_col_rect.m_w = m_image->m_col_w * m_scale_x;
-			m_col_rect.m_h = m_image->m_col_h * m_scale_y;
-			// image data
-			m_rect.m_w = m_image->m_w * m_scale_x;
-			m_rect.m_h = m_image->m_h * m_scale_y;
-		}
-		// scale does not affect the rect
-		else
-		{
-			m_col_rect.m_w = m_image->m_col_w;
-			m_col_rect.m_h = m_image->m_col_h;
-			// image data
-			m_rect.m_w = m_image->m_w;
-			m_rect.m_h = m_image->m_h;
-		}
-		// rotation affects the rect
-		if( m_rotation_affects_rect )
-		{
-			Update_Rect_Rotation();
-		}
-
 		m_delete_image = del_img;
 
 		// if no name is set use the first image name
@@ -526,16 +664,6 @@ void cSprite :: Set_Image( cGL_Surface *new_image, bool new_start_image /* = 0 *
 			m_editor_tags = m_image->m_editor_tags;
 		}
 	}
-	else
-	{
-		// clear image data
-		m_col_pos.m_x = 0.0f;
-		m_col_pos.m_y = 0.0f;
-		m_col_rect.m_w = 0.0f;
-		m_col_rect.m_h = 0.0f;
-		m_rect.m_w = 0.0f;
-		m_rect.m_h = 0.0f;
-	}
 
 	if( !m_start_image || new_start_image )
 	{
@@ -563,11 +691,58 @@ void cSprite :: Set_Image( cGL_Surface *new_image, bool new_start_image /* = 0 *
 	Update_Position_Rect();
 }
 
+void cSprite :: Update_Image_Rect( void )
+{
+	if( !m_image )
+	{
+		// clear image data
+		m_col_pos.m_x = 0.0f;
+		m_col_pos.m_y = 0.0f;
+		m_col_rect.m_w = 0.0f;
+		m_col_rect.m_h = 0.0f;
+		m_rect.m_w = 0.0f;
+		m_rect.m_h = 0.0f;
+		return;
+	}
+
+	// collision data
+	m_col_pos = m_image->m_col_pos;
+	// scale affects the rect
+	if( m_scale_affects_rect )
+	{
+		m_col_rect.m_w = m_image->m_col_w * m_scale_x;
+		m_col_rect.m_h = m_image->m_col_h * m_scale_y;
+		// image data
+		m_rect.m_w = m_image->m_w * m_scale_x;
+		m_rect.m_h = m_image->m_h * m_scale_y;
+	}
+	// scale does not affect the rect
+	else
+	{
+		m_col_rect.m_w = m_image->m_col_w;
+		m_col_rect.m_h = m_image->m_col_h;
+		// image data
+		m_rect.m_w = m_image->m_w;
+		m_rect.m_h = m_image->m_h;
+	}
+	// rotation affects the rect
+	if( m_rotation_affects_rect )
+	{
+		Update_Rect_Rotation();
+	}
+}
+
 void cSprite :: Set_Sprite_Type( SpriteType type )
 {
 	// set first because of massive-type z calculation
 	m_type = type;
 
+	// check again if sleeping is valid
+	if( m_sprite_manager )
+	{
+		m_sprite_manager->Wake_Up( this );
+	}
+
 	if( m_type == TYPE_MASSIVE )
 	{
 		m_sprite_array = ARRAY_MASSIVE;
@@ -598,6 +773,11 @@ void cSprite :: Set_Sprite_Type( SpriteType type )
 		Set_Massive_Type( MASS_CLIMBABLE );
 		m_can_be_ground = 0;
 	}
+
+	if( m_sprite_manager )
+	{
+		m_sprite_manager->Update_Type( this );
+	}
 }
 
 std::string cSprite :: Get_Sprite_Type_String( void ) const
@@ -714,6 +894,12 @@ void cSprite :: Set_Active( bool enabled )
 
 	Update_Valid_Draw();
 	Update_Valid_Update();
+
+	// drawn from a static chunk
+	if( m_static_chunk )
+	{
+		m_sprite_manager->Invalidate_Static_Chunks();
+	}
 }
 
 void cSprite :: Set_Color_Combine( const float red, const float green, const float blue, const GLint com_type )
@@ -810,6 +996,8 @@ void cSprite :: Set_Rotation_Z( float rot, bool new_start_rot /* = 0 */ )
 	if( m_rotation_affects_rect )
 	{
 		Update_Rect_Rotation_Z();
+		Update_Valid_Draw();
+		Update_Grid();
 	}
 }
 void cSprite :: Set_Scale_X( const float scale, const bool new_startscale /* = 0 */ )
@@ -840,6 +1028,9 @@ void cSprite :: Set_Scale_X( const float scale, const bool new_startscale /* = 0
 	{
 		m_start_scale_x = m_scale_x;
 	}
+
+	Update_Valid_Draw();
+	Update_Grid();
 }
 
 void cSprite :: Set_Scale_Y( const float scale, const bool new_startscale /* = 0 */ )
@@ -870,6 +1061,9 @@ void cSprite :: Set_Scale_Y( const float scale, const bool new_startscale /* = 0
 	{
 		m_start_scale_y = m_scale_y;
 	}
+
+	Update_Valid_Draw();
+	Update_Grid();
 }
 void cSprite :: Set_On_Top( const cSprite *sprite, bool optimize_hor_pos /* = 1 */ )
 {
@@ -894,8 +1088,9 @@ void cSprite :: Move( float move_x, float move_y, const bool real /* = 0 */ )
 
 	if( !real )
 	{
-		move_x *= pFramerate->m_speed_factor;
-		move_y *= pFramerate->m_speed_factor;
+		const float speed_factor = Get_Context()->Get_Framerate()->m_speed_factor;
+		move_x *= speed_factor;
+		move_y *= speed_factor;
 	}
 
 	m_pos_x += move_x;
@@ -931,10 +1126,54 @@ void cSprite :: Update_Position_Rect( void )
 	}
 
 	Update_Valid_Draw();
+	Update_Grid();
+
+	// drawn from a static chunk
+	if( m_static_chunk )
+	{
+		m_sprite_manager->Invalidate_Static_Chunks();
+	}
+}
+
+void cSprite :: Update_Grid( void )
+{
+	// updated after the parallel update
+	if( pUpdate_Workers && pUpdate_Workers->Defer_Sync( this ) )
+	{
+		return;
+	}
+
+	// updated once after moving many objects
+	if( m_sprite_manager && m_sprite_manager->Defer_Grid_Update( this ) )
+	{
+		return;
+	}
+
+	if( m_grid )
+	{
+		m_grid->Update( this );
+	}
+
+	if( m_editor_grid )
+	{
+		m_editor_grid->Update( this );
+	}
 }
 
 void cSprite :: Update_Valid_Draw( void )
 {
+	// updated after the parallel update
+	if( pUpdate_Workers && pUpdate_Workers->Defer_Sync( this ) )
+	{
+		return;
+	}
+
+	// updated at once by the sprite manager before drawing
+	if( m_sprite_manager && m_sprite_manager->Set_Draw_Dirty( this ) )
+	{
+		return;
+	}
+
 	m_valid_draw = Is_Draw_Valid();
 }
 
@@ -992,7 +1231,7 @@ void cSprite :: Draw( cSurface_Request *request /* = NULL */ )
 			}
 		}
 		// add request
-		pRenderer->Add( rect_request );
+		Get_Context()->Get_Renderer()->Add( rect_request );
 
 		// - collision rect
 		// create request
@@ -1006,7 +1245,7 @@ void cSprite :: Draw( cSurface_Request *request /* = NULL */ )
 		rect_request->m_blend_dfactor = GL_DST_ALPHA;
 
 		// add request
-		pRenderer->Add( rect_request );
+		Get_Context()->Get_Renderer()->Add( rect_request );
 	}
 
 	// show obsolete images in editor
@@ -1023,7 +1262,7 @@ void cSprite :: Draw( cSurface_Request *request /* = NULL */ )
 		rect_request->m_blend_dfactor = GL_DST_ALPHA;
 
 		// add request
-		pRenderer->Add( rect_request );
+		Get_Context()->Get_Renderer()->Add( rect_request );
 	}
 }
 
@@ -1057,14 +1296,23 @@ void cSprite :: Draw_Image( cSurface_Request *request /* = NULL */ ) const
 	if( create_request )
 	{
 		// add request
-		pRenderer->Add( request );
+		Get_Context()->Get_Renderer()->Add( request );
 	}
 }
 
 void cSprite :: Draw_Image_Normal( cSurface_Request *request /* = NULL */ ) const
 {
+	m_image->Use();
+
 	// texture id
 	request->m_texture_id = m_image->m_image;
+	// texture coordinates
+	request->m_tex_x1 = m_image->m_tex_x1;
+	request->m_tex_y1 = m_image->m_tex_y1;
+	request->m_tex_x2 = m_image->m_tex_x2;
+	request->m_tex_y2 = m_image->m_tex_y2;
+	// tiles of a large image
+	request->m_tiles = m_image->m_tiles;
 
 	// size
 	request->m_w = m_image->m_start_w;
@@ -1142,6 +1390,16 @@ void cSprite :: Draw_Image_Normal( cSurface_Request *request /* = NULL */ ) cons
 		request->m_pos_y = m_pos_y + m_image->m_int_y;
 	}
 
+	// position between the last fixed timestep ticks
+	const cFramerate *framerate = Get_Context()->Get_Framerate();
+
+	if( m_tick && m_tick == framerate->m_fixed_tick && framerate->m_interpolation < 1.0f )
+	{
+		const float back = 1.0f - framerate->m_interpolation;
+		request->m_pos_x += ( m_tick_pos_x - m_pos_x ) * back;
+		request->m_pos_y += ( m_tick_pos_y - m_pos_y ) * back;
+	}
+
 	// position z
 	request->m_pos_z = m_pos_z;
 
@@ -1169,8 +1427,17 @@ void cSprite :: Draw_Image_Normal( cSurface_Request *request /* = NULL */ ) cons
 
 void cSprite :: Draw_Image_Editor( cSurface_Request *request /* = NULL */ ) const
 {
+	m_start_image->Use();
+
 	// texture id
 	request->m_texture_id = m_start_image->m_image;
+	// texture coordinates
+	request->m_tex_x1 = m_start_image->m_tex_x1;
+	request->m_tex_y1 = m_start_image->m_tex_y1;
+	request->m_tex_x2 = m_start_image->m_tex_x2;
+	request->m_tex_y2 = m_start_image->m_tex_y2;
+	// tiles of a large image
+	request->m_tiles = m_start_image->m_tiles;
 
 	// size
 	request->m_w = m_start_image->m_start_w;
@@ -1306,8 +1573,86 @@ void cSprite :: Set_Massive_Type( MassiveType type )
 		m_pos_z = m_pos_z_halfmassive_start;
 	}
 
-	// make it the latest sprite
-	m_sprite_manager->Move_To_Back( this );
+	// make it the latest sprite if already added
+	if( m_array_num >= 0 )
+	{
+		m_sprite_manager->Move_To_Back( this );
+	}
+
+	// could be in another collision layer
+	if( m_grid )
+	{
+		m_grid->Update( this );
+	}
+}
+
+Col_Layer cSprite :: Get_Col_Layer( void ) const
+{
+	switch( m_sprite_array )
+	{
+		case ARRAY_PLAYER:
+		{
+			return COL_LAYER_PLAYER;
+		}
+		case ARRAY_ENEMY:
+		{
+			return COL_LAYER_ENEMY;
+		}
+		case ARRAY_MASSIVE:
+		case ARRAY_PASSIVE:
+		case ARRAY_ACTIVE:
+		{
+			break;
+		}
+		default:
+		{
+			return COL_LAYER_NONE;
+		}
+	}
+
+	switch( m_type )
+	{
+		case TYPE_BALL:
+		{
+			return COL_LAYER_PROJECTILE;
+		}
+		case TYPE_POWERUP:
+		case TYPE_MUSHROOM_DEFAULT:
+		case TYPE_MUSHROOM_LIVE_1:
+		case TYPE_MUSHROOM_POISON:
+		case TYPE_MUSHROOM_BLUE:
+		case TYPE_MUSHROOM_GHOST:
+		case TYPE_FIREPLANT:
+		case TYPE_JUMPING_GOLDPIECE:
+		case TYPE_FALLING_GOLDPIECE:
+		case TYPE_GOLDPIECE:
+		case TYPE_MOON:
+		case TYPE_STAR:
+		{
+			return COL_LAYER_ITEM;
+		}
+		case TYPE_PASSIVE:
+		case TYPE_FRONT_PASSIVE:
+		{
+			if( m_massive_type == MASS_PASSIVE )
+			{
+				return COL_LAYER_DECORATION;
+			}
+
+			return COL_LAYER_SOLID;
+		}
+		default:
+		{
+			break;
+		}
+	}
+
+	if( m_sprite_array == ARRAY_ACTIVE )
+	{
+		return COL_LAYER_ACTIVE;
+	}
+
+	return COL_LAYER_SOLID;
 }
 
 bool cSprite :: Is_On_Top( const cSprite *obj ) const
@@ -1336,8 +1681,9 @@ bool cSprite :: Is_Visible_On_Screen( void ) const
 
 	if( !m_no_camera )
 	{
-		cam_x = pActive_Camera->m_x;
-		cam_y = pActive_Camera->m_y;
+		const cCamera *camera = Get_Context()->Get_Camera();
+		cam_x = camera->m_x;
+		cam_y = camera->m_y;
 	}
 
 	// not visible left
@@ -1372,11 +1718,13 @@ bool cSprite :: Is_In_Range( void ) const
 		return Is_Visible_On_Screen();
 	}
 
+	const cCamera *camera = Get_Context()->Get_Camera();
+
 	// check if not in range
-	if( m_rect.m_x + ( m_rect.m_w * 0.5f ) < pActive_Camera->m_x + (game_res_w / 2) - m_camera_range ||
-		m_rect.m_y + ( m_rect.m_h * 0.5f ) < pActive_Camera->m_y + (game_res_h / 2) - m_camera_range ||
-		m_rect.m_x + ( m_rect.m_w * 0.5f ) > pActive_Camera->m_x + (game_res_w / 2) + m_camera_range ||
-		m_rect.m_y + ( m_rect.m_h * 0.5f ) > pActive_Camera->m_y + (game_res_h / 2) + m_camera_range )
+	if( m_rect.m_x + ( m_rect.m_w * 0.5f ) < camera->m_x + (game_res_w / 2) - m_camera_range ||
+		m_rect.m_y + ( m_rect.m_h * 0.5f ) < camera->m_y + (game_res_h / 2) - m_camera_range ||
+		m_rect.m_x + ( m_rect.m_w * 0.5f ) > camera->m_x + (game_res_w / 2) + m_camera_range ||
+		m_rect.m_y + ( m_rect.m_h * 0.5f ) > camera->m_y + (game_res_h / 2) + m_camera_range )
 	{
 		return 0;
 	}
@@ -1396,6 +1744,58 @@ bool cSprite :: Is_Update_Valid( void )
 	return 1;
 }
 
+bool cSprite :: Is_Sleep_Valid( void ) const
+{
+	// collisions need to be handled
+	if( !m_collisions.empty() )
+	{
+		return 0;
+	}
+
+	// if destroyed
+	if( m_auto_destroy )
+	{
+		return 1;
+	}
+
+	// basic sprites do not update
+	if( Is_Basic_Sprite() )
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+std::string cSprite :: Get_Identifier( void ) const
+{
+	return "";
+}
+
+bool cSprite :: Is_Update_Parallel( void ) const
+{
+	return 0;
+}
+
+bool cSprite :: Is_Draw_Parallel( void ) const
+{
+	// derived sprites can draw more than the image
+	if( typeid(*this) != typeid(cSprite) || game_debug )
+	{
+		return 0;
+	}
+
+	const cGL_Surface *image = editor_enabled ? m_start_image : m_image;
+
+	// loading the texture again needs opengl
+	if( !image || image->m_unloaded )
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
 bool cSprite :: Is_Draw_Valid( void )
 {
 	// if editor not enabled
@@ -1453,6 +1853,12 @@ void cSprite :: Destroy( void )
 	m_valid_draw = 0;
 	m_valid_update = 0;
 	Set_Image( NULL, 1 );
+
+	// deleted at the end of the frame
+	if( m_sprite_manager )
+	{
+		m_sprite_manager->Set_Has_Destroyed( this );
+	}
 }
 
 void cSprite :: Editor_Add( const CEGUI::String &name, const CEGUI::String &tooltip, CEGUI::Window *window_setting, float obj_width, float obj_height /* = 28 */, bool advance_row /* = 1 */ )
@@ -1474,10 +1880,15 @@ void cSprite :: Editor_Add( const CEGUI::String &name, const CEGUI::String &tool
 	// get text width
 	CEGUI::Font *font = &CEGUI::FontManager::getSingleton().get( "bluebold_medium" );
 	float text_width = 12.0f + font->getTextExtent( name ) * global_downscalex;
+	if( !m_editor_state )
+	{
+		m_editor_state = new cSprite_Editor_State();
+	}
+
 	// all names should have the same width
-	if( text_width > m_editor_window_name_width )
+	if( text_width > m_editor_state->m_window_name_width )
 	{
-		m_editor_window_name_width = text_width;
+		m_editor_state->m_window_name_width = text_width;
 	}
 	// set size
 	window_name->setWidth( CEGUI::UDim( 0, text_width * global_upscalex ) );
@@ -1494,7 +1905,7 @@ void cSprite :: Editor_Add( const CEGUI::String &name, const CEGUI::String &tool
 	settings_item->window_setting = window_setting;
 	settings_item->advance_row = advance_row;
 
-	m_editor_windows.push_back( settings_item );
+	m_editor_state->m_windows.push_back( settings_item );
 
 	// add to main window
 	guisheet->addChildWindow( window_name );
@@ -1525,15 +1936,21 @@ void cSprite :: Editor_Activate( void )
 
 void cSprite :: Editor_Deactivate( void )
 {
+	if( !m_editor_state )
+	{
+		return;
+	}
+
 	// remove editor controls
-	for( Editor_Object_Settings_List::iterator itr = m_editor_windows.begin(); itr != m_editor_windows.end(); ++itr )
+	for( Editor_Object_Settings_List::iterator itr = m_editor_state->m_windows.begin(); itr != m_editor_state->m_windows.end(); ++itr )
 	{
 		cEditor_Object_Settings_Item *obj = (*itr);
 
 		delete obj;
 	}
 
-	m_editor_windows.clear();
+	delete m_editor_state;
+	m_editor_state = NULL;
 }
 
 void cSprite :: Editor_Init( void )
@@ -1541,8 +1958,13 @@ void cSprite :: Editor_Init( void )
 	// set state
 	Editor_State_Update();
 
+	if( !m_editor_state )
+	{
+		return;
+	}
+
 	// init
-	for( Editor_Object_Settings_List::iterator itr = m_editor_windows.begin(); itr != m_editor_windows.end(); ++itr )
+	for( Editor_Object_Settings_List::iterator itr = m_editor_state->m_windows.begin(); itr != m_editor_state->m_windows.end(); ++itr )
 	{
 		cEditor_Object_Settings_Item *obj = (*itr);
 		CEGUI::Window *window_name = obj->window_name;
@@ -1550,7 +1972,7 @@ void cSprite :: Editor_Init( void )
 		// set first row width
 		if( obj->advance_row )
 		{
-			window_name->setWidth( CEGUI::UDim( 0, m_editor_window_name_width * global_upscalex ) );
+			window_name->setWidth( CEGUI::UDim( 0, m_editor_state->m_window_name_width * global_upscalex ) );
 		}
 	}
 
@@ -1564,8 +1986,13 @@ void cSprite :: Editor_Position_Update( void )
 	float obj_posy = 0.0f;
 	float row_height = 0.0f;
 
+	if( !m_editor_state )
+	{
+		return;
+	}
+
 	// set all positions
-	for( Editor_Object_Settings_List::iterator itr = m_editor_windows.begin(); itr != m_editor_windows.end(); ++itr )
+	for( Editor_Object_Settings_List::iterator itr = m_editor_state->m_windows.begin(); itr != m_editor_state->m_windows.end(); ++itr )
 	{
 		cEditor_Object_Settings_Item *obj = (*itr);
 		CEGUI::Window *window_name = obj->window_name;
@@ -20,8 +20,10 @@
 #include "../core/math/rect.h"
 #include "../video/video.h"
 #include "../core/collision.h"
+#include "../core/memory_pool.h"
+#include "../core/xml_writer.h"
 // CEGUI
-#include "CEGUIXMLSerializer.h"
+#include "CEGUIXMLAttributes.h"
 
 namespace SMC
 {
@@ -36,6 +38,10 @@ public:
 
 	// Set the parent sprite manager
 	virtual void Set_Sprite_Manager( cSprite_Manager *sprite_manager );
+	/* Returns the engine context of the parent sprite manager
+	 * or the default context if not set
+	*/
+	cEngine_Context *Get_Context( void ) const;
 
 	// Handle collision data
 	void Handle_Collisions( void );
@@ -59,6 +65,8 @@ public:
 	void Delete_Collision( cObjectCollision *collision );
 	// Delete the last collision
 	void Delete_Last_Collision( void );
+	// Delete the collisions with objects which were deleted
+	void Delete_Invalid_Collisions( void );
 	/* Check if a collision is active in the given direction 
 	 * and returns the collision object number else -1
 	 */
@@ -95,6 +103,10 @@ public:
 	virtual void Handle_Collision_Passive( cObjectCollision *collision ) {};
 	// collision from a box
 	virtual void Handle_Collision_Box( ObjectDirection cdirection, GL_rect *r2 ) {};
+	// player entered the detection rect set with cSprite_Manager::Set_Trigger
+	virtual void Handle_Trigger_Enter( void ) {};
+	// player left the detection rect set with cSprite_Manager::Set_Trigger
+	virtual void Handle_Trigger_Leave( void ) {};
 
 	// the parent sprite manager
 	cSprite_Manager *m_sprite_manager;
@@ -102,6 +114,23 @@ public:
 	cObjectCollision_List m_collisions;
 };
 
+/* *** *** *** *** *** *** *** cSprite_Editor_State *** *** *** *** *** *** *** *** *** *** */
+
+/* Editor settings windows of a sprite
+ * allocated while the settings are shown in the editor
+*/
+struct cSprite_Editor_State
+{
+	cSprite_Editor_State( void )
+	: m_window_name_width( 0.0f ) {}
+
+	// editor active window list
+	typedef vector<cEditor_Object_Settings_Item *> Editor_Object_Settings_List;
+	Editor_Object_Settings_List m_windows;
+	// width for all name windows based on largest name text width
+	float m_window_name_width;
+};
+
 /* *** *** *** *** *** *** *** cSprite *** *** *** *** *** *** *** *** *** *** */
 
 class cSprite : public cCollidingSprite
@@ -111,9 +140,18 @@ public:
 	cSprite( cSprite_Manager *sprite_manager, const std::string type_name = "sprite" );
 	// create from stream
 	cSprite( CEGUI::XMLAttributes &attributes, cSprite_Manager *sprite_manager, const std::string type_name = "sprite" );
+	/* create a clone of the given sprite for Copy
+	 * copies the start settings directly without the setters
+	 * Finish_Copy must be called once after all settings are copied
+	*/
+	cSprite( const cSprite &sprite );
 	// destructor
 	virtual ~cSprite( void );
 
+	// memory is counted in the sprite memory
+	static void *operator new( size_t size );
+	static void operator delete( void *ptr, size_t size );
+
 	// initialize defaults
 	virtual void Init( void );
 	/* late initialization
@@ -122,11 +160,15 @@ public:
 	virtual void Init_Links( void ) {};
 	// copy this sprite
 	virtual cSprite *Copy( void ) const;
+	/* Set the start image and position of a clone as current
+	 * and update the rects and the drawing validation once
+	*/
+	void Finish_Copy( void );
 
 	// load from stream
 	virtual void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream );
+	virtual void Save_To_XML( cXml_Writer &stream );
 
 	// load from savegame
 	virtual void Load_From_Savegame( cSave_Level_Object *save_object ) {};
@@ -141,6 +183,8 @@ public:
 	 * if del_img is set the given image will be deleted
 	*/
 	virtual void Set_Image( cGL_Surface *new_image, bool new_start_image = 0, bool del_img = 0 );
+	// Update the image and collision rect size from the image
+	void Update_Image_Rect( void );
 
 	// Set the sprite type
 	void Set_Sprite_Type( SpriteType type );
@@ -343,6 +387,8 @@ public:
 
 	// Update the position rect values
 	void Update_Position_Rect( void );
+	// Update the collision and editor grid cells after a rect changed
+	void Update_Grid( void );
 	// default update
 	virtual void Update( void ) {};
 	/* late update
@@ -380,6 +426,10 @@ public:
 
 	// Check if this sprite is on top of the given object
 	bool Is_On_Top( const cSprite *obj ) const;
+	/* Returns the collision layer from the array, type and massive type
+	 * the collision grid must be updated if it changed
+	*/
+	Col_Layer Get_Col_Layer( void ) const;
 
 	// if the sprite is visible on the screen
 	bool Is_Visible_On_Screen( void ) const;
@@ -389,6 +439,23 @@ public:
 	virtual bool Is_Update_Valid( void );
 	// if draw is valid for the current state and position
 	virtual bool Is_Draw_Valid( void );
+	/* if the update and collision handling would do nothing for the current state and position
+	 * the sprite manager then skips it until this changes or a collision is added
+	*/
+	virtual bool Is_Sleep_Valid( void ) const;
+	/* if the update can run in parallel with the other sprites returning true
+	 * the update must only read other objects and only change this sprite
+	 * and other changes must be done after the update with pUpdate_Workers->Defer
+	*/
+	virtual bool Is_Update_Parallel( void ) const;
+	/* if the drawing can run in parallel with the other sprites returning true
+	 * the drawing must only add requests and not use opengl
+	*/
+	virtual bool Is_Draw_Parallel( void ) const;
+	/* Returns the name other objects use to find it or an empty string
+	 * the sprite manager keeps all named objects in a registry
+	*/
+	virtual std::string Get_Identifier( void ) const;
 
 	// returns true if this is a basic sprite type
 	inline bool Is_Basic_Sprite( void ) const
@@ -432,24 +499,91 @@ public:
 	// editor image text changed event
 	bool Editor_Image_Text_Changed( const CEGUI::EventArgs &event );
 
-	// current image used for drawing
-	cGL_Surface *m_image;
-	// editor and first image
-	cGL_Surface *m_start_image;
+	/* the members used every frame by the update, collision and drawing loops come first
+	 * to share as few cache lines as possible
+	 * the start, editor and rarely changed settings follow them
+	*/
 
-	// complete image rect
-	GL_rect m_rect;
-	// editor and first image rect
-	GL_rect m_start_rect;
+	// sprite type
+	SpriteType m_type;
+	// sprite array type
+	ArrayType m_sprite_array;
+	// massive collision type
+	MassiveType m_massive_type;
 	// collision rect
 	GL_rect m_col_rect;
-	// collision start point
-	GL_point m_col_pos;
-
+	// complete image rect
+	GL_rect m_rect;
 	// current position
 	float m_pos_x;
 	float m_pos_y;
 	float m_pos_z;
+	// collision start point
+	GL_point m_col_pos;
+	// current image used for drawing
+	cGL_Surface *m_image;
+
+	// if true we are active and can be updated and drawn
+	bool m_active;
+	/* if true this sprite is not used anywhere anymore
+	 * and is ready to be replaced with a new sprite
+	 * should not be used for objects needed by the editor
+	 * should be used for not active spawned objects
+	*/
+	bool m_auto_destroy;
+	// if updating is valid
+	bool m_valid_update;
+	// if drawing is valid
+	bool m_valid_draw;
+	// if set it is not updated by the sprite manager
+	bool m_sleeping;
+	// can be used as ground object
+	bool m_can_be_ground;
+	// true if not using the camera position
+	bool m_no_camera;
+	// if set the sprite manager updates the drawing validation before drawing
+	bool m_draw_dirty;
+	// if set it is in the visible objects of the sprite manager
+	bool m_draw_listed;
+	// if set the sprite is drawn from a static chunk of the sprite manager
+	bool m_static_chunk;
+	// if set it touches too many cells and is not in them
+	bool m_grid_large;
+	// if set it is in the static sprites of the grid and not in the cells
+	bool m_grid_static;
+	// maximum distance to the camera to get updated
+	unsigned int m_camera_range;
+	// position in the sprite manager objects or -1 if not in it
+	int m_array_num;
+	// last collision grid query which returned it
+	unsigned int m_grid_query;
+	// collision layer when it was added to the collision grid cells
+	Col_Layer m_grid_layer;
+	// collision grid cells
+	int m_grid_x1;
+	int m_grid_y1;
+	int m_grid_x2;
+	int m_grid_y2;
+	// static objects gathered by the sprite manager for the collision handling or -1
+	int m_static_gather_num;
+	// collision grid of the sprite manager or NULL if not in it
+	cSprite_Grid *m_grid;
+	// position before the fixed timestep tick with the number for the interpolated drawing
+	float m_tick_pos_x;
+	float m_tick_pos_y;
+	Uint32 m_tick;
+	// rotation
+	float m_rot_x;
+	float m_rot_y;
+	float m_rot_z;
+	// scale
+	float m_scale_x;
+	float m_scale_y;
+
+	// editor and first image
+	cGL_Surface *m_start_image;
+	// editor and first image rect
+	GL_rect m_start_rect;
 	// start position
 	float m_start_pos_x;
 	float m_start_pos_y;
@@ -464,10 +598,6 @@ public:
 	float m_start_rot_x;
 	float m_start_rot_y;
 	float m_start_rot_z;
-	// rotation
-	float m_rot_x;
-	float m_rot_y;
-	float m_rot_z;
 	// if set scale not only affects the image but also the rectangle
 	bool m_scale_affects_rect;
 	/* which parts of the image get scaled
@@ -480,9 +610,6 @@ public:
 	// editor and start scale
 	float m_start_scale_x;
 	float m_start_scale_y;
-	// scale
-	float m_scale_x;
-	float m_scale_y;
 
 	// color
 	Color m_color;
@@ -491,55 +618,53 @@ public:
 	// combine color
 	float m_combine_color[3];
 
-	// sprite type
-	SpriteType m_type;
-	// internal type name
-	const std::string m_type_name;
-	// sprite array type
-	ArrayType m_sprite_array;
-	// massive collision type
-	MassiveType m_massive_type;
+	// internal type name stored once in the string table
+	const std::string &m_type_name;
 	// visible name for the user
 	std::string m_name;
 	// sprite editor tags
 	std::string m_editor_tags;
 
-	// true if not using the camera position
-	bool m_no_camera;
-	// if true we are active and can be updated and drawn
-	bool m_active;
 	// if spawned
 	bool m_spawned;
-	// maximum distance to the camera to get updated
-	unsigned int m_camera_range;
-	// can be used as ground object
-	bool m_can_be_ground;
-
 	// delete the given image when it gets unloaded
 	bool m_delete_image;
 	// if this can not be auto-deleted because the object is controlled from elsewhere
 	bool m_disallow_managed_delete;
-	/* if true this sprite is not used anywhere anymore
-	 * and is ready to be replaced with a new sprite
-	 * should not be used for objects needed by the editor
-	 * should be used for not active spawned objects
-	*/
-	bool m_auto_destroy;
 	// shadow position
 	float m_shadow_pos;
 	// shadow color
 	Color m_shadow_color;
 
-	// if drawing is valid
-	bool m_valid_draw;
-	// if updating is valid
-	bool m_valid_update;
+	// editor grid of the sprite manager or NULL if not in it
+	cEditor_Grid *m_editor_grid;
+	// type and array the sprite manager lists it under
+	SpriteType m_index_type;
+	ArrayType m_index_array;
+	// position in the type and array lists of the sprite manager or -1 if not in them
+	int m_type_num;
+	int m_array_type_num;
+	/* position in the awake or sleeping, z position, editor z position, drawing validation and visible objects of the sprite manager
+	 * only valid if the sprite is at it in the list
+	*/
+	int m_awake_num;
+	int m_zpos_num;
+	int m_editor_zpos_num;
+	int m_draw_dirty_num;
+	int m_visible_num;
+	// string table number of the identifier the sprite manager registered it with or 0
+	unsigned int m_index_name_id;
+	// invalid after the sprite is deleted
+	cObject_Handle m_handle;
+	// object number in the level stream or -1 if not streamed
+	int m_stream_num;
+	// object number in the level file or -1 if not loaded from it
+	int m_level_num;
 
 	// editor active window list
-	typedef vector<cEditor_Object_Settings_Item *> Editor_Object_Settings_List;
-	Editor_Object_Settings_List m_editor_windows;
-	// width for all name windows based on largest name text width
-	float m_editor_window_name_width;
+	typedef cSprite_Editor_State::Editor_Object_Settings_List Editor_Object_Settings_List;
+	// editor settings windows or NULL if not shown
+	cSprite_Editor_State *m_editor_state;
 
 	// default z positions
 	static const float m_pos_z_passive_start;
@@ -550,6 +675,18 @@ public:
 
 typedef vector<cSprite *> cSprite_List;
 
+/* Return the sprite of the handle
+ * if the sprite was deleted returns NULL
+*/
+cSprite *Get_Sprite( const cObject_Handle &handle );
+
+// memory of all sprites
+extern cMemory_Counter sprite_memory;
+/* arena new sprites are allocated from
+ * set to the level which creates objects or NULL to use the heap
+*/
+extern cMemory_Arena *pSprite_Arena;
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 } // namespace SMC
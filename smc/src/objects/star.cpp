@@ -19,6 +19,7 @@
 #include "../video/animation.h"
 #include "../core/i18n.h"
 #include "../core/game_core.h"
+#include "../core/engine_context.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 
@@ -76,10 +77,10 @@ void cjStar :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Pos( static_cast<float>(attributes.getValueAsInteger( "posx" )), static_cast<float>(attributes.getValueAsInteger( "posy" )), 1 );
 }
 
-void cjStar :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cjStar :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// type
 	Write_Property( stream, "type", "jstar" );
@@ -88,7 +89,7 @@ void cjStar :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "posy", static_cast<int>( m_start_pos_y ) );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cjStar :: Activate( void )
@@ -102,7 +103,7 @@ void cjStar :: Activate( void )
 	Generate_Particles( m_pos_x + m_col_rect.m_w * 0.5f, m_pos_y + m_col_rect.m_h * 0.5f, 1, 20 );
 
 	// activate star
-	pLevel_Player->Get_Item( TYPE_STAR );
+	Get_Context()->Get_Level_Player()->Get_Item( TYPE_STAR );
 
 	// if spawned destroy
 	if( m_spawned )
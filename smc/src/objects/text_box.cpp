@@ -36,6 +36,37 @@ namespace SMC
 static unsigned int text_box_window_width = 300;
 static unsigned int text_box_window_height = 200;
 
+/* the text display window is created once and kept hidden between activations
+ * the text is only set again if it changed because setting it formats all lines again
+*/
+static const char *text_box_display_name = "text_box_display";
+// text the display window was formatted with
+static std::string text_box_display_text;
+
+/* Returns the text display window shared by all text boxes
+ * it is created if not available
+*/
+static CEGUI::MultiLineEditbox *Text_Box_Get_Display_Window( void )
+{
+	CEGUI::WindowManager &wmgr = CEGUI::WindowManager::getSingleton();
+
+	if( wmgr.isWindowPresent( text_box_display_name ) )
+	{
+		return static_cast<CEGUI::MultiLineEditbox *>(wmgr.getWindow( text_box_display_name ));
+	}
+
+	CEGUI::MultiLineEditbox *editbox = static_cast<CEGUI::MultiLineEditbox *>(wmgr.createWindow( "TaharezLook/MultiLineEditbox", text_box_display_name ));
+	text_box_display_text.clear();
+
+	// add to main window
+	pGuiSystem->getGUISheet()->addChildWindow( editbox );
+	// set on top
+	editbox->setAlwaysOnTop( 1 );
+	editbox->hide();
+
+	return editbox;
+}
+
 cText_Box :: cText_Box( cSprite_Manager *sprite_manager )
 : cBaseBox( sprite_manager )
 {
@@ -88,10 +119,10 @@ void cText_Box :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Text( xml_string_to_string( attributes.getValueAsString( "text" ).c_str() ) );
 }
 
-void cText_Box :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cText_Box :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	cBaseBox::Save_To_XML( stream );
 
@@ -99,20 +130,13 @@ void cText_Box :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "text", m_text );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cText_Box :: Activate( void )
 {
-	CEGUI::WindowManager &wmgr = CEGUI::WindowManager::getSingleton();
-	CEGUI::MultiLineEditbox *editbox = static_cast<CEGUI::MultiLineEditbox *>(wmgr.createWindow( "TaharezLook/MultiLineEditbox", "text_box_text" ));
-
-	// add to main window
-	pGuiSystem->getGUISheet()->addChildWindow( editbox );
+	CEGUI::MultiLineEditbox *editbox = Text_Box_Get_Display_Window();
 
-
-	// set on top
-	editbox->setAlwaysOnTop( 1 );
 	// set position
 	float text_pos_x = m_pos_x - ( text_box_window_width * 0.5f ) + ( m_rect.m_w * 0.5f );
 	float text_pos_y = m_pos_y - 5 - text_box_window_height;
@@ -132,14 +156,22 @@ void cText_Box :: Activate( void )
 
 	editbox->setXPosition( CEGUI::UDim( 0, ( text_pos_x - pActive_Camera->m_x ) * global_upscalex ) );
 	editbox->setYPosition( CEGUI::UDim( 0, ( text_pos_y - pActive_Camera->m_y ) * global_upscaley ) );
-	// set size
+	// set size which only formats the lines again if the resolution changed
 	editbox->setWidth( CEGUI::UDim( 0, text_box_window_width * global_upscalex ) );
 	editbox->setHeight( CEGUI::UDim( 0, text_box_window_height * global_upscaley ) );
 
-	// set text
-	editbox->setText( reinterpret_cast<const CEGUI::utf8*>(m_text.c_str()) );
+	// set text if changed
+	if( text_box_display_text != m_text )
+	{
+		editbox->setText( reinterpret_cast<const CEGUI::utf8*>(m_text.c_str()) );
+		text_box_display_text = m_text;
+	}
+
+	// start at the top
+	editbox->getVertScrollbar()->setScrollPosition( 0 );
 	// always hide horizontal scrollbar
 	editbox->getHorzScrollbar()->hide();
+	editbox->show();
 
 	bool display = 1;
 
@@ -243,7 +275,7 @@ void cText_Box :: Activate( void )
 		pFramerate->Update();
 	}
 
-	wmgr.destroyWindow( editbox );
+	editbox->hide();
 }
 
 void cText_Box :: Update( void )
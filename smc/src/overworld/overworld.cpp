@@ -17,9 +17,11 @@
 #include "../overworld/overworld.h"
 #include "../audio/audio.h"
 #include "../core/game_core.h"
+#include "../core/xml_reader.h"
 #include "../level/level_editor.h"
 #include "../overworld/world_editor.h"
 #include "../core/framerate.h"
+#include "../core/profiler.h"
 #include "../gui/menu.h"
 #include "../user/preferences.h"
 #include "../video/font.h"
@@ -27,6 +29,8 @@
 #include "../input/joystick.h"
 #include "../input/keyboard.h"
 #include "../level/level.h"
+#include "../level/level_preview.h"
+#include "../level/level_prefetch.h"
 #include "../core/i18n.h"
 #include "../core/filesystem/filesystem.h"
 #include "../core/filesystem/resource_manager.h"
@@ -67,12 +71,7 @@ void cOverworld_description :: Load( void )
 	}
 
 	// Load Description
-// fixme : Workaround for std::string to CEGUI::String utf8 conversion. Check again if CEGUI 0.8 works with std::string utf8
-#ifdef _WIN32
-	CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, (const CEGUI::utf8*)filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/World/Description.xsd", "" );
-#else
-	CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/World/Description.xsd", "" );
-#endif
+	Parse_XML_File( *this, filename, "World/Description.xsd" );
 }
 
 void cOverworld_description :: Save( void )
@@ -80,39 +79,29 @@ void cOverworld_description :: Save( void )
 	std::string save_dir = pResource_Manager->user_data_dir + USER_WORLD_DIR + "/" + m_path;
 	std::string filename = save_dir + "/description.xml";
 
-// fixme : Check if there is a more portable way f.e. with imbue()
-#ifdef _WIN32
-	ofstream file( utf8_to_ucs2( filename ).c_str(), ios::out | ios::trunc );
-#else
-	ofstream file( filename.c_str(), ios::out | ios::trunc );
-#endif
-
-
-	if( !file )
-	{
-		pHud_Debug->Set_Text( _("Couldn't save world description ") + filename, speedfactor_fps * 5.0f );
-		return;
-	}
-
-	CEGUI::XMLSerializer stream( file );
+	cXml_Writer stream;
 
 	// begin 
-	stream.openTag( "description" );
+	stream.Open_Tag( "description" );
 
 	// begin
-	stream.openTag( "world" );
+	stream.Open_Tag( "world" );
 		// name
 		Write_Property( stream, "name", m_name );
 		// visible
 		Write_Property( stream, "visible", m_visible );
 	// end world
-	stream.closeTag();
+	stream.Close_Tag();
 
 
 	// end description
-	stream.closeTag();
+	stream.Close_Tag();
 
-	file.close();
+	if( !stream.Save( filename ) )
+	{
+		pHud_Debug->Set_Text( _("Couldn't save world description ") + filename, speedfactor_fps * 5.0f );
+		return;
+	}
 }
 
 std::string cOverworld_description :: Get_Full_Path( void ) const
@@ -174,9 +163,12 @@ void cOverworld_description :: handle_world( const CEGUI::XMLAttributes &attribu
 cOverworld :: cOverworld( void )
 {
 	m_sprite_manager = new cWorld_Sprite_Manager( this );
+	// the decorations are drawn from static chunks
+	m_sprite_manager->Set_Static_Chunks( 1 );
 	m_animation_manager = new cAnimation_Manager();
 	m_description = new cOverworld_description();
 	m_layer = new cLayer( this );
+	m_path_graph = new cWorld_Path_Graph( this );
 
 	m_engine_version = -1;
 	m_last_saved = 0;
@@ -190,6 +182,8 @@ cOverworld :: cOverworld( void )
 	m_hud_level_name->Set_Shadow( black, 1.5f );
 
 	m_next_level = 0;
+	m_edited = 0;
+	m_last_used = 0;
 
 	m_player_start_waypoint = 0;
 	m_player_moving_state = STA_STAY;
@@ -202,6 +196,7 @@ cOverworld :: ~cOverworld( void )
 	delete m_sprite_manager;
 	delete m_animation_manager;
 	delete m_description;
+	delete m_path_graph;
 	delete m_layer;
 	delete m_hud_level_name;
 	delete m_hud_world_name;
@@ -223,6 +218,8 @@ bool cOverworld :: New( std::string name )
 
 	m_background_color = Color( 0.2f, 0.5f, 0.1f );
 	m_engine_version = world_engine_version;
+	// only exists in memory until saved
+	m_edited = 1;
 
 	return 1;
 }
@@ -237,7 +234,8 @@ bool cOverworld :: Load( void )
 	// world
 	std::string world_filename = m_description->Get_Full_Path() + "/world.xml";
 
-	if( !File_Exists( world_filename ) )
+	// or compressed
+	if( !Find_File( world_filename ) )
 	{
 		printf( "Couldn't find World file : %s from %s\n", world_filename.c_str(), m_description->m_path.c_str() );
 		return 0;
@@ -246,12 +244,7 @@ bool cOverworld :: Load( void )
 	try
 	{
 		// parse overworld
-	// fixme : Workaround for std::string to CEGUI::String utf8 conversion. Check again if CEGUI 0.8 works with std::string utf8
-	#ifdef _WIN32
-		CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, (const CEGUI::utf8*)world_filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/World/World.xsd", "" );
-	#else
-		CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, world_filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/World/World.xsd", "" );	
-	#endif
+		Parse_XML_File( *this, world_filename, "World/World.xsd" );
 	}
 	// catch CEGUI Exceptions
 	catch( CEGUI::Exception &ex )
@@ -269,7 +262,8 @@ bool cOverworld :: Load( void )
 	// layer
 	std::string layer_filename = m_description->Get_Full_Path() + "/layer.xml";
 
-	if( !File_Exists( layer_filename ) )
+	// or compressed
+	if( !Find_File( layer_filename ) )
 	{
 		printf( "Couldn't find World Layer file : %s from %s\n", layer_filename.c_str(), m_description->m_path.c_str() );
 		return 0;
@@ -277,9 +271,27 @@ bool cOverworld :: Load( void )
 
 	m_layer->Load( layer_filename );
 
+	// restore the progress kept while unloaded
+	for( WaypointAccessMap::const_iterator itr = m_waypoint_access.begin(); itr != m_waypoint_access.end(); ++itr )
+	{
+		cWaypoint *waypoint = Get_Waypoint( Get_Waypoint_Num( itr->first ) );
+
+		if( waypoint )
+		{
+			waypoint->Set_Access( itr->second );
+		}
+	}
+
+	m_waypoint_access.clear();
+
+	// connect the waypoints
+	m_path_graph->Build();
+
 	// set name
 	m_hud_world_name->Set_Image( pFont->Render_Text( pFont->m_font_normal, m_description->m_name, yellow ), 1, 1 );
 
+	cLevel_Preview::Update( world_filename, m_sprite_manager, m_background_color );
+
 	return 1;
 }
 
@@ -297,6 +309,8 @@ void cOverworld :: Unload( void )
 	m_waypoints.clear();
 	// Layer
 	m_layer->Delete_All();
+	// paths
+	m_path_graph->Clear();
 	// animations
 	m_animation_manager->Delete_All();
 
@@ -305,9 +319,12 @@ void cOverworld :: Unload( void )
 	m_last_saved = 0;
 }
 
-void cOverworld :: Save( void )
+void cOverworld :: Save( bool with_sound /* = 1 */ )
 {
-	pAudio->Play_Sound( "editor/save.ogg" );
+	if( with_sound )
+	{
+		pAudio->Play_Sound( "editor/save.ogg" );
+	}
 
 	std::string save_dir = pResource_Manager->user_data_dir + USER_WORLD_DIR + "/" + m_description->m_path;
 	// Create directory if new world
@@ -318,29 +335,13 @@ void cOverworld :: Save( void )
 
 	std::string filename = save_dir + "/world.xml";
 
-// fixme : Check if there is a more portable way f.e. with imbue()
-#ifdef _WIN32
-	ofstream file( utf8_to_ucs2( filename ).c_str(), ios::out | ios::trunc );
-#else
-	ofstream file( filename.c_str(), ios::out | ios::trunc );
-#endif
-
-
-	if( !file )
-	{
-		printf( "Error : Couldn't open world file for saving. Is the file read-only ?" );
-		pHud_Debug->Set_Text( _("Couldn't save world ") + filename, speedfactor_fps * 5.0f );
-		return;
-	}
-
-	CEGUI::XMLSerializer stream( file );
-
+	cXml_Writer stream;
 
 	// begin
-	stream.openTag( "overworld" );
+	stream.Open_Tag( "overworld" );
 
 	// begin
-	stream.openTag( "information" );
+	stream.Open_Tag( "information" );
 		// game version
 		Write_Property( stream, "game_version", int_to_string(SMC_VERSION_MAJOR) + "." + int_to_string(SMC_VERSION_MINOR) + "." + int_to_string(SMC_VERSION_PATCH) );
 		// engine version
@@ -348,32 +349,32 @@ void cOverworld :: Save( void )
 		// time ( seconds since 1970 )
 		Write_Property( stream, "save_time", static_cast<Uint64>( time( NULL ) ) );
 	// end information
-	stream.closeTag();
+	stream.Close_Tag();
 
 	// begin
-	stream.openTag( "settings" );
+	stream.Open_Tag( "settings" );
 		// music
 		Write_Property( stream, "music", m_musicfile );
 	// end settings
-	stream.closeTag();
+	stream.Close_Tag();
 
 	// begin
-	stream.openTag( "background" );
+	stream.Open_Tag( "background" );
 		// color
 		Write_Property( stream, "color_red", static_cast<int>(m_background_color.red) );
 		Write_Property( stream, "color_green", static_cast<int>(m_background_color.green) );
 		Write_Property( stream, "color_blue", static_cast<int>(m_background_color.blue) );
 	// end background
-	stream.closeTag();
+	stream.Close_Tag();
 
 	// begin
-	stream.openTag( "player" );
+	stream.Open_Tag( "player" );
 		// start waypoint
 		Write_Property( stream, "waypoint", m_player_start_waypoint );
 		// moving state
 		Write_Property( stream, "moving_state", static_cast<int>(m_player_moving_state) );
 	// end player
-	stream.closeTag();
+	stream.Close_Tag();
 
 	// objects
 	for( cSprite_List::iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
@@ -391,15 +392,28 @@ void cOverworld :: Save( void )
 	}
 
 	// end overworld
-	stream.closeTag();
+	stream.Close_Tag();
 
-	file.close();
+	if( !stream.Save( filename ) )
+	{
+		printf( "Error : Couldn't open world file for saving. Is the file read-only ?" );
+		pHud_Debug->Set_Text( _("Couldn't save world ") + filename, speedfactor_fps * 5.0f );
+		return;
+	}
 
 	// save layer
 	m_layer->Save( save_dir + "/layer.xml" );
 	// save description
 	m_description->Save();
 
+	// for the menu
+	cLevel_Preview preview;
+
+	if( preview.Create( m_sprite_manager, m_background_color ) )
+	{
+		preview.Save( filename );
+	}
+
 	// show info
 	pHud_Debug->Set_Text( _("World ") + m_description->m_name + _(" saved") );
 }
@@ -457,6 +471,14 @@ void cOverworld :: Enter( const GameMode old_mode /* = MODE_NOTHING */ )
 		pOverworld_Manager->m_camera->Set_Limit_Y( 0 );
 	}
 
+	// load the level of the Waypoint and the following levels in the background
+	if( !editor_world_enabled )
+	{
+		vector<std::string> levels;
+		Get_Next_Levels( levels, pPreferences->m_level_preload_count + 1, 1 );
+		pLevel_Preloader->Set_Next( levels );
+	}
+
 	Update_Camera();
 
 	// play music
@@ -536,6 +558,8 @@ void cOverworld :: Leave( const GameMode next_mode /* = MODE_NOTHING */ )
 
 void cOverworld :: Draw( void )
 {
+	cProfiler_Scope profile_scope( "world draw" );
+
 	// Background
 	pVideo->Clear_Screen();
 	Draw_Layer_1();
@@ -547,9 +571,6 @@ void cOverworld :: Draw( void )
 
 	// Editor
 	pWorld_Editor->Draw();
-
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_DRAW_OVERWORLD]->Update();
 }
 
 void cOverworld :: Draw_Layer_1( void )
@@ -558,6 +579,8 @@ void cOverworld :: Draw_Layer_1( void )
 
 	// sprites
 	m_sprite_manager->Draw_Items();
+	// layer lines
+	m_layer->Draw();
 	// animations
 	m_animation_manager->Draw();
 }
@@ -585,6 +608,8 @@ void cOverworld :: Draw_HUD( void )
 
 void cOverworld :: Update( void )
 {
+	cProfiler_Scope profile_scope( "world update" );
+
 	// editor
 	pWorld_Editor->Process_Input();
 
@@ -618,9 +643,6 @@ void cOverworld :: Update( void )
 	pHud_Manager->Update();
 	// Editor
 	pWorld_Editor->Update();
-
-	// update performance timer
-	pFramerate->m_perf_timer[PERF_UPDATE_OVERWORLD]->Update();
 }
 
 void cOverworld :: Update_Camera( void )
@@ -718,6 +740,16 @@ bool cOverworld :: Key_Down( SDLKey key )
 	{
 		Goto_Next_Level();
 	}
+	else if( key == SDLK_j && ( pOverworld_Manager->m_debug_mode || editor_world_enabled ) )
+	{
+		// jump to the waypoint below the mouse
+		int waypoint_num = Get_Waypoint_Collision( GL_rect( pMouseCursor->m_pos_x, pMouseCursor->m_pos_y, 1, 1 ) );
+
+		if( waypoint_num >= 0 )
+		{
+			pOverworld_Player->Jump_To_Waypoint( waypoint_num );
+		}
+	}
 	// Exit
 	else if( key == SDLK_ESCAPE || key == SDLK_BACKSPACE )
 	{
@@ -1003,16 +1035,27 @@ bool cOverworld :: Goto_Next_Level( void )
 		return 0;
 	}
 
-	// Get Layer Line in front
-	cLayer_Line_Point_Start *front_line = pOverworld_Player->Get_Front_Line( current_waypoint->m_direction_forward );
+	cWaypoint *next_waypoint = NULL;
+
+	// Get forward Waypoint
+	const cWorld_Path *path = m_path_graph->Get_Path( m_path_graph->Get_Path_Num( pOverworld_Player->m_current_waypoint, current_waypoint->m_direction_forward ) );
 
-	if( !front_line )
+	if( path )
 	{
-		return 0;
+		next_waypoint = m_waypoints[path->m_end];
 	}
+	else
+	{
+		// Get Layer Line in front
+		cLayer_Line_Point_Start *front_line = pOverworld_Player->Get_Front_Line( current_waypoint->m_direction_forward );
 
-	// Get forward Waypoint
-	cWaypoint *next_waypoint = front_line->Get_End_Waypoint();
+		if( !front_line )
+		{
+			return 0;
+		}
+
+		next_waypoint = front_line->Get_End_Waypoint();
+	}
 
 	// if no next waypoint available
 	if( !next_waypoint )
@@ -1057,6 +1100,44 @@ bool cOverworld :: Goto_Next_Level( void )
 	return  1;
 }
 
+void cOverworld :: Get_Next_Levels( vector<std::string> &levels, unsigned int count, bool with_current /* = 0 */ ) const
+{
+	int waypoint_num = pOverworld_Player->m_current_waypoint;
+	unsigned int added = 0;
+
+	// every Waypoint is visited once at most
+	for( unsigned int i = 0; i < m_waypoints.size() && added < count; i++ )
+	{
+		if( waypoint_num < 0 || waypoint_num >= static_cast<int>(m_waypoints.size()) )
+		{
+			break;
+		}
+
+		const cWaypoint *waypoint = m_waypoints[waypoint_num];
+
+		if( ( i > 0 || with_current ) && waypoint->m_waypoint_type == WAYPOINT_NORMAL )
+		{
+			levels.push_back( waypoint->Get_Destination() );
+			added++;
+		}
+
+		// Waypoint forward direction is invalid/unset
+		if( waypoint->m_direction_forward == DIR_UNDEFINED )
+		{
+			break;
+		}
+
+		const cWorld_Path *path = m_path_graph->Get_Path( m_path_graph->Get_Path_Num( waypoint_num, waypoint->m_direction_forward ) );
+
+		if( !path )
+		{
+			break;
+		}
+
+		waypoint_num = path->m_end;
+	}
+}
+
 void cOverworld :: Reset_Waypoints( void )
 {
 	for( WaypointList::iterator itr = m_waypoints.begin(); itr != m_waypoints.end(); ++itr )
@@ -1065,6 +1146,51 @@ void cOverworld :: Reset_Waypoints( void )
 
 		obj->Set_Access( obj->m_access_default );
 	}
+
+	// loads with the default access
+	m_waypoint_access.clear();
+}
+
+bool cOverworld :: Set_Waypoint_Access( const std::string &destination, bool access )
+{
+	if( !Is_Loaded() )
+	{
+		m_waypoint_access[destination] = access;
+		return 1;
+	}
+
+	cWaypoint *waypoint = Get_Waypoint( Get_Waypoint_Num( destination ) );
+
+	if( !waypoint )
+	{
+		return 0;
+	}
+
+	waypoint->Set_Access( access );
+	return 1;
+}
+
+void cOverworld :: Unload_Keep_Progress( void )
+{
+	if( !Is_Loaded() )
+	{
+		return;
+	}
+
+	m_waypoint_access.clear();
+
+	for( WaypointList::iterator itr = m_waypoints.begin(); itr != m_waypoints.end(); ++itr )
+	{
+		cWaypoint *obj = (*itr);
+
+		// only the changed access
+		if( obj->m_access != obj->m_access_default )
+		{
+			m_waypoint_access[obj->Get_Destination()] = obj->m_access;
+		}
+	}
+
+	Unload();
 }
 
 bool cOverworld :: Is_Loaded( void ) const
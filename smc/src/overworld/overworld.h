@@ -21,11 +21,14 @@
 #include "../overworld/world_layer.h"
 #include "../overworld/world_player.h"
 #include "../overworld/world_sprite_manager.h"
+#include "../overworld/world_path.h"
 #include "../gui/hud.h"
 #include "../audio/random_sound.h"
 // CEGUI
 #include "CEGUIXMLHandler.h"
 #include "CEGUIXMLAttributes.h"
+// std
+#include <map>
 
 namespace SMC
 {
@@ -79,6 +82,8 @@ private:
 class cAnimation_Manager;
 
 typedef vector<cWaypoint *> WaypointList;
+// waypoint access by destination
+typedef std::map<std::string, bool> WaypointAccessMap;
 
 class cOverworld : public CEGUI::XMLHandler
 {
@@ -92,8 +97,10 @@ public:
 	bool Load( void );
 	// Unload
 	void Unload( void );
-	// Save
-	void Save( void );
+	/* Save
+	 * with_sound : play the save sound
+	*/
+	void Save( bool with_sound = 1 );
 	// Enter
 	void Enter( const GameMode old_mode = MODE_NOTHING );
 	// Leave
@@ -166,8 +173,22 @@ public:
 
 	// Enable the next Level and walk into the forward direction
 	bool Goto_Next_Level( void );
+	/* Add the levels of the following Waypoints in the forward direction from the player Waypoint
+	 * count : maximum number of levels to add
+	 * with_current : if set the level of the player Waypoint is added first
+	*/
+	void Get_Next_Levels( vector<std::string> &levels, unsigned int count, bool with_current = 0 ) const;
 	// Resets the Waypoint access to the default
 	void Reset_Waypoints( void );
+	/* Set the access of the Waypoint with the given destination
+	 * if not loaded it is set when loaded
+	 * returns false if the Waypoint is not found
+	*/
+	bool Set_Waypoint_Access( const std::string &destination, bool access );
+	/* Keeps the Waypoint access and unloads the world
+	 * the access is restored when loaded again
+	*/
+	void Unload_Keep_Progress( void );
 
 	// Return true if a world is loaded
 	bool Is_Loaded( void ) const;
@@ -182,6 +203,8 @@ public:
 	cOverworld_description *m_description;
 	// current Layer for collision checking
 	cLayer *m_layer;
+	// Waypoint connections
+	cWorld_Path_Graph *m_path_graph;
 
 	/* *** *** *** Settings *** *** *** *** */
 
@@ -203,6 +226,12 @@ public:
 
 	// goto next level on overworld enter
 	bool m_next_level;
+	// changed in the editor and not unloaded to keep the changes
+	bool m_edited;
+	// manager use count when last activated
+	unsigned int m_last_used;
+	// Waypoint access kept while unloaded
+	WaypointAccessMap m_waypoint_access;
 
 	// HUD world name
 	cHudSprite *m_hud_world_name;
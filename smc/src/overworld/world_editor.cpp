@@ -21,6 +21,7 @@
 #include "../audio/audio.h"
 #include "../core/i18n.h"
 #include "../core/filesystem/filesystem.h"
+#include "../core/filesystem/resource_manager.h"
 
 namespace SMC
 {
@@ -67,6 +68,12 @@ void cEditor_World :: Enable( void )
 	editor_world_enabled = 1;
 	pOverworld_Manager->m_draw_layer = 1;
 
+	// keep the changes loaded
+	if( m_overworld )
+	{
+		m_overworld->m_edited = 1;
+	}
+
 	if( Game_Mode == MODE_OVERWORLD )
 	{
 		editor_enabled = 1;
@@ -89,6 +96,12 @@ void cEditor_World :: Disable( bool native_mode /* = 0 */ )
 	pOverworld_Manager->m_draw_layer = 0;
 	pOverworld_Manager->m_camera_mode = 0;
 
+	// reconnect the changed waypoints
+	if( m_overworld && m_overworld->Is_Loaded() )
+	{
+		m_overworld->m_path_graph->Build();
+	}
+
 	if( Game_Mode == MODE_OVERWORLD )
 	{
 		native_mode = 1;
@@ -124,6 +137,11 @@ bool cEditor_World :: Key_Down( SDLKey key )
 void cEditor_World :: Set_Overworld( cOverworld *overworld )
 {
 	m_overworld = overworld;
+
+	if( m_enabled && m_overworld )
+	{
+		m_overworld->m_edited = 1;
+	}
 }
 
 void cEditor_World :: Activate_Menu_Item( cEditor_Menu_Object *entry )
@@ -261,6 +279,39 @@ void cEditor_World :: Function_Reload( void )
 	m_overworld->Load();
 }
 
+std::string cEditor_World :: Get_Autosave_Filename( void ) const
+{
+	if( !m_overworld || m_overworld->m_description->m_path.empty() )
+	{
+		return "";
+	}
+
+	return pResource_Manager->user_data_dir + USER_WORLD_DIR + "/" + m_overworld->m_description->m_path + ".journal";
+}
+
+std::string cEditor_World :: Get_Autosave_Base_Filename( void ) const
+{
+	// a world from the game directory is saved to the user directory
+	std::string filename = pResource_Manager->user_data_dir + USER_WORLD_DIR + "/" + m_overworld->m_description->m_path + "/world.xml";
+
+	if( !Find_File( filename ) )
+	{
+		return "";
+	}
+
+	return filename;
+}
+
+void cEditor_World :: Autosave_Save( void )
+{
+	m_overworld->Save( 0 );
+}
+
+bool cEditor_World :: Autosave_Reload( void )
+{
+	return m_overworld->Load();
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 cEditor_World *pWorld_Editor = NULL;
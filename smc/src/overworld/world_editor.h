@@ -59,6 +59,12 @@ public:
 	virtual void Function_Reload( void );
 	//void Function_Settings( void );
 
+	// Autosave functions
+	virtual std::string Get_Autosave_Filename( void ) const;
+	virtual std::string Get_Autosave_Base_Filename( void ) const;
+	virtual void Autosave_Save( void );
+	virtual bool Autosave_Reload( void );
+
 	// parent overworld
 	cOverworld *m_overworld;
 };
@@ -16,6 +16,7 @@
 #include "../overworld/world_layer.h"
 #include "../video/renderer.h"
 #include "../core/game_core.h"
+#include "../core/xml_reader.h"
 #include "../overworld/overworld.h"
 #include "../core/i18n.h"
 #include "../overworld/world_editor.h"
@@ -78,13 +79,7 @@ cLayer_Line_Point :: ~cLayer_Line_Point( void )
 
 void cLayer_Line_Point :: Draw( cSurface_Request *request /* = NULL */ )
 {
-	if( m_auto_destroy || !pOverworld_Manager->m_draw_layer )
-	{
-		return;
-	}
-
-	// point rect
-	pVideo->Draw_Rect( m_col_rect.m_x - pActive_Camera->m_x, m_col_rect.m_y - pActive_Camera->m_y, m_col_rect.m_w, m_col_rect.m_h, m_pos_z, &m_color );
+	// drawn with all other points by cLayer::Draw
 }
 
 void cLayer_Line_Point :: Destroy( void )
@@ -191,32 +186,7 @@ void cLayer_Line_Point_Start :: Set_Sprite_Manager( cSprite_Manager *sprite_mana
 
 void cLayer_Line_Point_Start :: Draw( cSurface_Request *request /* = NULL */ )
 {
-	// not a valid draw
-	if( m_auto_destroy || m_linked_point->m_auto_destroy || !pOverworld_Manager->m_draw_layer )
-	{
-		return;
-	}
-
-	// create request
-	cLine_Request *line_request = new cLine_Request();
-
-	// drawing color
-	Color color = darkgreen;
-
-	// if active
-	if( pOverworld_Player->m_current_line >= 0 && m_overworld->m_layer->objects[pOverworld_Player->m_current_line] == this )
-	{
-		color = lightblue;
-	}
-
-	pVideo->Draw_Line( Get_Line_Pos_X() - pActive_Camera->m_x, Get_Line_Pos_Y() - pActive_Camera->m_y, m_linked_point->Get_Line_Pos_X() - pActive_Camera->m_x, m_linked_point->Get_Line_Pos_Y() - pActive_Camera->m_y, 0.085f, &color, line_request );
-	line_request->m_line_width = 6;
-
-	// add request
-	pRenderer->Add( line_request );
-
-	// draw point rect
-	cLayer_Line_Point::Draw( request );
+	// drawn with all other lines by cLayer::Draw
 }
 
 GL_line cLayer_Line_Point_Start :: Get_Line( void ) const
@@ -284,9 +254,21 @@ cLine_collision :: cLine_collision( void )
 
 /* *** *** *** *** *** *** *** *** Layer *** *** *** *** *** *** *** *** *** */
 
+// line grid cell size
+static const float layer_index_cell_size = 128.0f;
+// maximum line grid cells
+static const unsigned int layer_index_cells_max = 65536;
+
 cLayer :: cLayer( cOverworld *origin )
 {
 	m_overworld = origin;
+
+	m_index_dirty = 1;
+	m_index_x = 0;
+	m_index_y = 0;
+	m_index_cell_size = layer_index_cell_size;
+	m_index_cols = 0;
+	m_index_rows = 0;
 }
 
 cLayer :: ~cLayer( void )
@@ -309,6 +291,7 @@ void cLayer :: Add( cLayer_Line_Point_Start *line_point )
 	}
 
 	cObject_Manager<cLayer_Line_Point_Start>::Add( line_point );
+	m_index_dirty = 1;
 
 	// check if in sprite manager
 	if( m_overworld->m_sprite_manager->Get_Array_Num( line_point ) == -1 )
@@ -331,12 +314,7 @@ void cLayer :: Load( const std::string &filename )
 	try
 	{
 		// parse layer
-	// fixme : Workaround for std::string to CEGUI::String utf8 conversion. Check again if CEGUI 0.8 works with std::string utf8
-	#ifdef _WIN32
-		CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, (const CEGUI::utf8*)filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/World/Lines.xsd", "" );
-	#else
-		CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/World/Lines.xsd", "" );
-	#endif
+		Parse_XML_File( *this, filename, "World/Lines.xsd" );
 	}
 	// catch CEGUI Exceptions
 	catch( CEGUI::Exception &ex )
@@ -348,24 +326,10 @@ void cLayer :: Load( const std::string &filename )
 
 bool cLayer :: Save( const std::string &filename )
 {
-// fixme : Check if there is a more portable way f.e. with imbue()
-#ifdef _WIN32
-	ofstream file( utf8_to_ucs2( filename ).c_str(), ios::out | ios::trunc );
-#else
-	ofstream file( filename.c_str(), ios::out | ios::trunc );
-#endif
-
-
-	if( !file )
-	{
-		pHud_Debug->Set_Text( _("Couldn't save world layer ") + filename );
-		return 0;
-	}
-
-	CEGUI::XMLSerializer stream( file );
+	cXml_Writer stream;
 
 	// begin layer
-	stream.openTag( "layer" );
+	stream.Open_Tag( "layer" );
 
 	// lines
 	for( LayerLineList::iterator itr = objects.begin(); itr != objects.end(); ++itr )
@@ -373,7 +337,7 @@ bool cLayer :: Save( const std::string &filename )
 		cLayer_Line_Point_Start *line = (*itr);
 
 		// begin
-		stream.openTag( "line" );
+		stream.Open_Tag( "line" );
 			// start
 			Write_Property( stream, "X1", static_cast<int>(line->Get_Line_Pos_X()) );
 			Write_Property( stream, "Y1", static_cast<int>(line->Get_Line_Pos_Y()) );
@@ -383,38 +347,78 @@ bool cLayer :: Save( const std::string &filename )
 			// origin
 			Write_Property( stream, "origin", line->m_origin );
 		// end line
-		stream.closeTag();
+		stream.Close_Tag();
 	}
 
 	// end layer
-	stream.closeTag();
+	stream.Close_Tag();
 
-	file.close();
+	if( !stream.Save( filename ) )
+	{
+		pHud_Debug->Set_Text( _("Couldn't save world layer ") + filename );
+		return 0;
+	}
 
 	return 1;
 }
 
+bool cLayer :: Delete( size_t array_num, bool delete_data /* = 1 */ )
+{
+	m_index_dirty = 1;
+	return cObject_Manager<cLayer_Line_Point_Start>::Delete( array_num, delete_data );
+}
+
+bool cLayer :: Delete( cLayer_Line_Point_Start *obj, bool delete_data /* = 1 */ )
+{
+	m_index_dirty = 1;
+	return cObject_Manager<cLayer_Line_Point_Start>::Delete( obj, delete_data );
+}
+
 void cLayer :: Delete_All( void )
 {
 	// only clear array
 	objects.clear();
+	m_index_dirty = 1;
 }
 
 cLayer_Line_Point_Start *cLayer :: Get_Line_Collision_Start( const GL_rect &line_rect )
 {
-	for( LayerLineList::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	Update_Index();
+
+	if( m_index_cells.empty() )
 	{
-		// get pointer
-		cLayer_Line_Point_Start *layer_line = (*itr);
+		return NULL;
+	}
 
-		// check line 1
-		if( line_rect.Intersects( layer_line->m_col_rect ) )
+	unsigned int col_start, row_start, col_end, row_end;
+	Get_Index_Cells( line_rect, col_start, row_start, col_end, row_end );
+
+	// the first line in array order
+	unsigned int found = objects.size();
+
+	for( unsigned int row = row_start; row <= row_end; row++ )
+	{
+		for( unsigned int col = col_start; col <= col_end; col++ )
 		{
-			return layer_line;
+			const vector<unsigned int> &cell = m_index_cells[( row * m_index_cols ) + col];
+
+			for( vector<unsigned int>::const_iterator itr = cell.begin(); itr != cell.end(); ++itr )
+			{
+				// check line start
+				if( *itr < found && line_rect.Intersects( objects[*itr]->m_col_rect ) )
+				{
+					found = *itr;
+				}
+			}
 		}
 	}
 
-	return NULL;
+	if( found == objects.size() )
+	{
+		return NULL;
+	}
+
+	return objects[found];
 }
 
 cLine_collision cLayer :: Get_Line_Collision_Direction( float x, float y, ObjectDirection dir, float dir_size /* = 10 */, unsigned int check_size /* = 10 */ ) const
@@ -451,107 +455,401 @@ cLine_collision cLayer :: Get_Line_Collision_Direction( float x, float y, Object
 
 cLine_collision cLayer :: Get_Nearest( float x, float y, ObjectDirection dir /* = DIR_HORIZONTAL */, unsigned int check_size /* = 15 */, int only_origin_id /* = -1 */ ) const
 {
-	for( LayerLineList::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	Update_Index();
+	Draw_Check_Lines( x, y, dir, check_size );
+
+	if( m_index_cells.empty() )
 	{
-		// get pointer
-		cLayer_Line_Point_Start *layer_line = (*itr);
+		return cLine_collision();
+	}
 
-		// line is not from waypoint
-		if( only_origin_id >= 0 && only_origin_id != layer_line->m_origin )
-		{
-			continue;
-		}
+	// area of both direction checking lines
+	GL_rect check_rect( x, y, 0, 0 );
+
+	if( dir == DIR_HORIZONTAL )
+	{
+		check_rect.m_x -= check_size;
+		check_rect.m_w = static_cast<float>(check_size * 2);
+	}
+	else // vertical
+	{
+		check_rect.m_y -= check_size;
+		check_rect.m_h = static_cast<float>(check_size * 2);
+	}
 
-		cLine_collision col = Get_Nearest_Line( layer_line, x, y, dir, check_size );
+	unsigned int col_start, row_start, col_end, row_end;
+	Get_Index_Cells( check_rect, col_start, row_start, col_end, row_end );
 
-		// found
-		if( col.m_line )
+	// the first line in array order
+	unsigned int found = objects.size();
+	float found_difference = 0;
+
+	for( unsigned int row = row_start; row <= row_end; row++ )
+	{
+		for( unsigned int col = col_start; col <= col_end; col++ )
 		{
-			return col;
+			const vector<unsigned int> &cell = m_index_cells[( row * m_index_cols ) + col];
+
+			for( vector<unsigned int>::const_iterator itr = cell.begin(); itr != cell.end(); ++itr )
+			{
+				const unsigned int line_num = *itr;
+
+				if( line_num >= found )
+				{
+					continue;
+				}
+
+				// line is not from waypoint
+				if( only_origin_id >= 0 && only_origin_id != static_cast<int>(objects[line_num]->m_origin) )
+				{
+					continue;
+				}
+
+				float difference;
+
+				if( Get_Line_Difference( m_index_lines[line_num], x, y, dir, check_size, difference ) )
+				{
+					found = line_num;
+					found_difference = difference;
+				}
+			}
 		}
 	}
 
 	// none found
-	return cLine_collision();
+	if( found == objects.size() )
+	{
+		return cLine_collision();
+	}
+
+	cLine_collision col = cLine_collision();
+
+	col.m_line = objects[found];
+	col.m_line_number = found;
+	col.m_difference = found_difference;
+
+	return col;
 }
 
 cLine_collision cLayer :: Get_Nearest_Line( cLayer_Line_Point_Start *map_layer_line, float x, float y, ObjectDirection dir /* = DIR_HORIZONTAL */, unsigned int check_size /* = 15  */ ) const
 {
-	GL_line line_1, line_2;
+	Draw_Check_Lines( x, y, dir, check_size );
+
+	float difference;
+
+	// not found
+	if( !Get_Line_Difference( map_layer_line->Get_Line(), x, y, dir, check_size, difference ) )
+	{
+		return cLine_collision();
+	}
+
+	cLine_collision col = cLine_collision();
+
+	col.m_line = map_layer_line;
+	col.m_line_number = Get_Array_Num( map_layer_line );
+	col.m_difference = difference;
+
+	return col;
+}
+
+bool cLayer :: Get_Line_Difference( const GL_line &map_line, float x, float y, ObjectDirection dir, unsigned int check_size, float &difference )
+{
+	// position along the checking lines and the position crossing them
+	float pos, cross;
+	float line_pos_1, line_pos_2, line_cross_1, line_cross_2;
 
-	// create map line
-	GL_line map_line = map_layer_line->Get_Line();
+	if( dir == DIR_HORIZONTAL )
+	{
+		pos = x;
+		cross = y;
+		line_pos_1 = map_line.m_x1;
+		line_pos_2 = map_line.m_x2;
+		line_cross_1 = map_line.m_y1;
+		line_cross_2 = map_line.m_y2;
+	}
+	else // vertical
+	{
+		pos = y;
+		cross = x;
+		line_pos_1 = map_line.m_y1;
+		line_pos_2 = map_line.m_y2;
+		line_cross_1 = map_line.m_x1;
+		line_cross_2 = map_line.m_x2;
+	}
 
-	// check into both directions from inside
-	for( float csize = 0; csize < check_size; csize++ )
+	// parallel
+	if( line_cross_1 == line_cross_2 )
 	{
-		line_1.m_x1 = x;
-		line_1.m_y1 = y;
-		line_1.m_x2 = x;
-		line_1.m_y2 = y;
-		line_2 = line_1;
+		return 0;
+	}
 
-		// set line size
-		if( dir == DIR_HORIZONTAL )
+	// crossing position on the map line
+	const float s = ( cross - line_cross_1 ) / ( line_cross_2 - line_cross_1 );
+
+	// like GL_line::Intersects the end with the higher y is excluded
+	if( map_line.m_y1 < map_line.m_y2 )
+	{
+		if( s < 0.0f || s >= 1.0f )
 		{
-			line_1.m_x1 += csize;
-			line_2.m_x2 -= csize;
+			return 0;
 		}
-		else // vertical
+	}
+	else if( s <= 0.0f || s > 1.0f )
+	{
+		return 0;
+	}
+
+	const float distance = line_pos_1 + ( s * ( line_pos_2 - line_pos_1 ) ) - pos;
+
+	// the checking lines grow in steps of 1 from 1 to below check_size
+	float size = ceil( fabs( distance ) );
+
+	if( size < 1.0f )
+	{
+		size = 1.0f;
+	}
+
+	if( size >= check_size )
+	{
+		return 0;
+	}
+
+	difference = distance >= 0.0f ? size : -size;
+	return 1;
+}
+
+void cLayer :: Draw( void ) const
+{
+	if( !pOverworld_Manager->m_draw_layer || objects.empty() )
+	{
+		return;
+	}
+
+	const GL_rect camera_rect = pActive_Camera->Get_Rect();
+
+	// the active line of the player
+	const cLayer_Line_Point_Start *active_line = NULL;
+
+	if( pOverworld_Player->m_current_line >= 0 && static_cast<unsigned int>(pOverworld_Player->m_current_line) < objects.size() )
+	{
+		active_line = objects[pOverworld_Player->m_current_line];
+	}
+
+	cLine_Stream_Request *lines = new cLine_Stream_Request();
+	lines->m_line_width = 6;
+	lines->Reserve( objects.size() );
+
+	cQuad_Stream_Request *points = new cQuad_Stream_Request();
+	points->m_no_camera = 1;
+	points->Reserve( objects.size() * 2 );
+
+	for( LayerLineList::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	{
+		const cLayer_Line_Point_Start *line_start = (*itr);
+		const cLayer_Line_Point *line_end = line_start->m_linked_point;
+
+		if( line_start->m_auto_destroy || !line_end || line_end->m_auto_destroy )
 		{
-			line_1.m_y1 += csize;
-			line_2.m_y2 -= csize;
+			continue;
 		}
 
-		// debug drawing
-		if( pOverworld_Manager->m_debug_mode && pOverworld_Manager->m_draw_layer )
+		const float x1 = line_start->Get_Line_Pos_X();
+		const float y1 = line_start->Get_Line_Pos_Y();
+		const float x2 = line_end->Get_Line_Pos_X();
+		const float y2 = line_end->Get_Line_Pos_Y();
+
+		// line
+		const GL_rect line_rect( x1 < x2 ? x1 : x2, y1 < y2 ? y1 : y2, fabs( x2 - x1 ) + 1, fabs( y2 - y1 ) + 1 );
+
+		if( camera_rect.Intersects( line_rect ) )
 		{
-			// create request
-			cLine_Request *line_request = new cLine_Request();
-			pVideo->Draw_Line( line_1.m_x1 - pActive_Camera->m_x, line_1.m_y1 - pActive_Camera->m_y, line_1.m_x2 - pActive_Camera->m_x, line_1.m_y2 - pActive_Camera->m_y, map_layer_line->m_pos_z + 0.001f, &white, line_request );
-			line_request->m_line_width = 2;
-			line_request->m_render_count = 50;
-			// add request
-			pRenderer->Add( line_request );
-
-			// create request
-			line_request = new cLine_Request();
-			pVideo->Draw_Line( line_2.m_x1 - pActive_Camera->m_x, line_2.m_y1 - pActive_Camera->m_y, line_2.m_x2 - pActive_Camera->m_x, line_2.m_y2 - pActive_Camera->m_y, map_layer_line->m_pos_z + 0.001f, &black, line_request );
-			line_request->m_line_width = 2;
-			line_request->m_render_count = 50;
-			// add request
-			pRenderer->Add( line_request );
+			lines->Add_Line( x1 - pActive_Camera->m_x, y1 - pActive_Camera->m_y, x2 - pActive_Camera->m_x, y2 - pActive_Camera->m_y, 0.085f, line_start == active_line ? lightblue : darkgreen );
 		}
 
-		// check direction line 1
-		if( line_1.Intersects( &map_line ) )
+		// points
+		const cLayer_Line_Point *line_points[2] = { line_start, line_end };
+
+		for( unsigned int i = 0; i < 2; i++ )
 		{
-			cLine_collision col = cLine_collision();
+			const cLayer_Line_Point *point = line_points[i];
 
-			col.m_line = map_layer_line;
-			col.m_line_number = Get_Array_Num( map_layer_line );
-			col.m_difference = csize;
+			if( !camera_rect.Intersects( point->m_col_rect ) )
+			{
+				continue;
+			}
 
-			// found
-			return col;
+			GL_rect rect = point->m_col_rect;
+			rect.m_x -= pActive_Camera->m_x;
+			rect.m_y -= pActive_Camera->m_y;
+			points->Add_Rect( rect, point->m_pos_z, point->m_color );
 		}
+	}
+
+	// add requests
+	if( lines->m_line_count )
+	{
+		pRenderer->Add( lines );
+	}
+	else
+	{
+		delete lines;
+	}
+
+	if( points->m_quad_count )
+	{
+		pRenderer->Add( points );
+	}
+	else
+	{
+		delete points;
+	}
+}
 
-		// check direction line 2
-		if( line_2.Intersects( &map_line ) )
+void cLayer :: Draw_Check_Lines( float x, float y, ObjectDirection dir, unsigned int check_size ) const
+{
+	if( !pOverworld_Manager->m_debug_mode || !pOverworld_Manager->m_draw_layer )
+	{
+		return;
+	}
+
+	GL_line line_1( x, y, x, y );
+	GL_line line_2 = line_1;
+
+	// set line size
+	if( dir == DIR_HORIZONTAL )
+	{
+		line_1.m_x1 += check_size;
+		line_2.m_x2 -= check_size;
+	}
+	else // vertical
+	{
+		line_1.m_y1 += check_size;
+		line_2.m_y2 -= check_size;
+	}
+
+	// create request
+	cLine_Request *line_request = new cLine_Request();
+	pVideo->Draw_Line( line_1.m_x1 - pActive_Camera->m_x, line_1.m_y1 - pActive_Camera->m_y, line_1.m_x2 - pActive_Camera->m_x, line_1.m_y2 - pActive_Camera->m_y, 0.089f, &white, line_request );
+	line_request->m_line_width = 2;
+	line_request->m_render_count = 50;
+	// add request
+	pRenderer->Add( line_request );
+
+	// create request
+	line_request = new cLine_Request();
+	pVideo->Draw_Line( line_2.m_x1 - pActive_Camera->m_x, line_2.m_y1 - pActive_Camera->m_y, line_2.m_x2 - pActive_Camera->m_x, line_2.m_y2 - pActive_Camera->m_y, 0.089f, &black, line_request );
+	line_request->m_line_width = 2;
+	line_request->m_render_count = 50;
+	// add request
+	pRenderer->Add( line_request );
+}
+
+void cLayer :: Update_Index( void ) const
+{
+	// the editor can move the line points
+	if( editor_world_enabled )
+	{
+		m_index_dirty = 1;
+	}
+
+	if( !m_index_dirty )
+	{
+		return;
+	}
+
+	m_index_dirty = 0;
+	m_index_lines.clear();
+	m_index_cells.clear();
+	m_index_cols = 0;
+	m_index_rows = 0;
+
+	if( objects.empty() )
+	{
+		return;
+	}
+
+	vector<GL_rect> line_rects;
+	line_rects.reserve( objects.size() );
+	m_index_lines.reserve( objects.size() );
+
+	float x_min = 0, y_min = 0, x_max = 0, y_max = 0;
+
+	for( LayerLineList::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	{
+		const cLayer_Line_Point_Start *layer_line = (*itr);
+		const GL_line line = layer_line->Get_Line();
+		m_index_lines.push_back( line );
+
+		// line and start point
+		GL_rect rect = layer_line->m_col_rect;
+		const float rect_x_max = std::max( rect.m_x + rect.m_w, std::max( line.m_x1, line.m_x2 ) );
+		const float rect_y_max = std::max( rect.m_y + rect.m_h, std::max( line.m_y1, line.m_y2 ) );
+		rect.m_x = std::min( rect.m_x, std::min( line.m_x1, line.m_x2 ) );
+		rect.m_y = std::min( rect.m_y, std::min( line.m_y1, line.m_y2 ) );
+		rect.m_w = rect_x_max - rect.m_x;
+		rect.m_h = rect_y_max - rect.m_y;
+		line_rects.push_back( rect );
+
+		if( itr == objects.begin() )
 		{
-			cLine_collision col = cLine_collision();
+			x_min = rect.m_x;
+			y_min = rect.m_y;
+			x_max = rect_x_max;
+			y_max = rect_y_max;
+		}
+		else
+		{
+			x_min = std::min( x_min, rect.m_x );
+			y_min = std::min( y_min, rect.m_y );
+			x_max = std::max( x_max, rect_x_max );
+			y_max = std::max( y_max, rect_y_max );
+		}
+	}
 
-			col.m_line = map_layer_line;
-			col.m_line_number = Get_Array_Num( map_layer_line );
-			col.m_difference = -csize;
+	m_index_x = x_min;
+	m_index_y = y_min;
+	m_index_cell_size = layer_index_cell_size;
 
-			// found
-			return col;
+	// limit the cell count on very large worlds
+	while( 1 )
+	{
+		m_index_cols = static_cast<unsigned int>( ( x_max - x_min ) / m_index_cell_size ) + 1;
+		m_index_rows = static_cast<unsigned int>( ( y_max - y_min ) / m_index_cell_size ) + 1;
+
+		if( m_index_cols * m_index_rows <= layer_index_cells_max )
+		{
+			break;
 		}
+
+		m_index_cell_size *= 2.0f;
 	}
 
-	// not found
-	return cLine_collision();
+	m_index_cells.resize( m_index_cols * m_index_rows );
+
+	for( unsigned int i = 0; i < line_rects.size(); i++ )
+	{
+		unsigned int col_start, row_start, col_end, row_end;
+		Get_Index_Cells( line_rects[i], col_start, row_start, col_end, row_end );
+
+		for( unsigned int row = row_start; row <= row_end; row++ )
+		{
+			for( unsigned int col = col_start; col <= col_end; col++ )
+			{
+				m_index_cells[( row * m_index_cols ) + col].push_back( i );
+			}
+		}
+	}
+}
+
+void cLayer :: Get_Index_Cells( const GL_rect &rect, unsigned int &col_start, unsigned int &row_start, unsigned int &col_end, unsigned int &row_end ) const
+{
+	const int cols = static_cast<int>(m_index_cols);
+	const int rows = static_cast<int>(m_index_rows);
+
+	col_start = Clamp( static_cast<int>(floor( ( rect.m_x - m_index_x ) / m_index_cell_size )), 0, cols - 1 );
+	row_start = Clamp( static_cast<int>(floor( ( rect.m_y - m_index_y ) / m_index_cell_size )), 0, rows - 1 );
+	col_end = Clamp( static_cast<int>(floor( ( rect.m_x + rect.m_w - m_index_x ) / m_index_cell_size )), 0, cols - 1 );
+	row_end = Clamp( static_cast<int>(floor( ( rect.m_y + rect.m_h - m_index_y ) / m_index_cell_size )), 0, rows - 1 );
 }
 
 void cLayer :: elementStart( const CEGUI::String &element, const CEGUI::XMLAttributes &attributes )
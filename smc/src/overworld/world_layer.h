@@ -40,7 +40,7 @@ public:
 	virtual ~cLayer_Line_Point( void );
 
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream ) {};
+	virtual void Save_To_XML( cXml_Writer &stream ) {};
 
 	// draw
 	virtual void Draw( cSurface_Request *request = NULL );
@@ -136,6 +136,10 @@ public:
 
 	// Add a layer line
 	virtual void Add( cLayer_Line_Point_Start *line_point );
+	// Delete the layer line from given array number
+	virtual bool Delete( size_t array_num, bool delete_data = 1 );
+	// Delete the given layer line
+	virtual bool Delete( cLayer_Line_Point_Start *obj, bool delete_data = 1 );
 
 	// Load from file
 	void Load( const std::string &filename );
@@ -146,7 +150,7 @@ public:
 	// Delete all objects
 	virtual void Delete_All( void );
 
-	/* Returns the colliding Line start point
+	/* Returns the first colliding Line start point
 	 * if not found returns NULL
 	*/
 	cLayer_Line_Point_Start *Get_Line_Collision_Start( const GL_rect &line_rect );
@@ -155,7 +159,7 @@ public:
 	*/
 	cLine_collision Get_Line_Collision_Direction( float x, float y, ObjectDirection dir, float dir_size = 15, unsigned int check_size = 10 ) const;
 
-	/* Return the collision data between the nearest line and the given position
+	/* Return the collision data between the first line crossing the direction checking lines and the given position
 	 * check_size is maximum size for both direction checking lines
 	 * if only_origin_id is set only checks lines with the given id
 	*/
@@ -163,6 +167,11 @@ public:
 	// Return the collision data between the given line and position
 	cLine_collision Get_Nearest_Line( cLayer_Line_Point_Start *map_layer_line, float x, float y, ObjectDirection dir = DIR_HORIZONTAL, unsigned int check_size = 15 ) const;
 
+	/* Draw the visible lines and points if the layer is shown
+	 * all lines are drawn with one line stream and all points with one rect stream
+	*/
+	void Draw( void ) const;
+
 	// parent overworld
 	cOverworld *m_overworld;
 
@@ -172,8 +181,36 @@ private:
 	// XML element end
 	virtual void elementEnd( const CEGUI::String &element );
 
+	/* Returns true if the given line crosses the direction checking lines
+	 * difference is set to the rounded up position difference
+	*/
+	static bool Get_Line_Difference( const GL_line &map_line, float x, float y, ObjectDirection dir, unsigned int check_size, float &difference );
+	// Draw the direction checking lines if in debug mode
+	void Draw_Check_Lines( float x, float y, ObjectDirection dir, unsigned int check_size ) const;
+	// Rebuild the line grid if lines changed
+	void Update_Index( void ) const;
+	// Get the grid cell range of the rect
+	void Get_Index_Cells( const GL_rect &rect, unsigned int &col_start, unsigned int &row_start, unsigned int &col_end, unsigned int &row_end ) const;
+
 	// XML element property list
 	CEGUI::XMLAttributes m_xml_attributes;
+
+	/* line grid
+	 * the queries rebuild it if lines were added or deleted
+	 * and always if the editor can move the line points
+	*/
+	mutable bool m_index_dirty;
+	// lines in array order
+	mutable vector<GL_line> m_index_lines;
+	// line array numbers in each cell by row
+	mutable vector<vector<unsigned int> > m_index_cells;
+	// grid position
+	mutable float m_index_x;
+	mutable float m_index_y;
+	// cell size and count
+	mutable float m_index_cell_size;
+	mutable unsigned int m_index_cols;
+	mutable unsigned int m_index_rows;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
@@ -29,6 +29,9 @@ namespace SMC
 
 /* *** *** *** *** *** *** *** *** cOverworld_Manager *** *** *** *** *** *** *** *** *** */
 
+// maximum loaded overworlds including the active one
+static const unsigned int overworld_loaded_max = 3;
+
 cOverworld_Manager :: cOverworld_Manager( cSprite_Manager *sprite_manager )
 : cObject_Manager<cOverworld>()
 {
@@ -37,6 +40,7 @@ cOverworld_Manager :: cOverworld_Manager( cSprite_Manager *sprite_manager )
 	m_camera_mode = 0;
 
 	m_camera = new cCamera( sprite_manager );
+	m_use_count = 0;
 
 	Init();
 }
@@ -121,7 +125,8 @@ void cOverworld_Manager :: Load_Dir( const std::string &dir, bool user_dir /* =
 
 				objects.push_back( overworld );
 
-				overworld->Load();
+				// the world is loaded when activated
+				overworld->m_description->Load();
 			}
 		}
 		catch( const std::exception &ex )
@@ -143,7 +148,20 @@ bool cOverworld_Manager :: Set_Active( cOverworld *world )
 		return 0;
 	}
 
+	if( !world->Is_Loaded() )
+	{
+		world->Load();
+
+		if( !world->Is_Loaded() )
+		{
+			printf( "Warning : Couldn't load Overworld %s\n", world->m_description->m_path.c_str() );
+			return 0;
+		}
+	}
+
 	pActive_Overworld = world;
+	world->m_last_used = ++m_use_count;
+	Unload_Unused();
 
 	pWorld_Editor->Set_Sprite_Manager( world->m_sprite_manager );
 	pWorld_Editor->Set_Overworld( world );
@@ -167,6 +185,45 @@ bool cOverworld_Manager :: Set_Active( cOverworld *world )
 	return 1;
 }
 
+void cOverworld_Manager :: Unload_Unused( void )
+{
+	while( 1 )
+	{
+		unsigned int loaded_count = 0;
+		cOverworld *oldest = NULL;
+
+		for( vector<cOverworld *>::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+		{
+			cOverworld *obj = (*itr);
+
+			if( !obj->Is_Loaded() )
+			{
+				continue;
+			}
+
+			loaded_count++;
+
+			// keep the active and the edited worlds
+			if( obj == pActive_Overworld || obj->m_edited )
+			{
+				continue;
+			}
+
+			if( !oldest || obj->m_last_used < oldest->m_last_used )
+			{
+				oldest = obj;
+			}
+		}
+
+		if( loaded_count <= overworld_loaded_max || !oldest )
+		{
+			return;
+		}
+
+		oldest->Unload_Keep_Progress();
+	}
+}
+
 void cOverworld_Manager :: Reset( void )
 {
 	// default Overworld
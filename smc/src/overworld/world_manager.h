@@ -41,18 +41,21 @@ public:
 	*/
 	bool New( std::string name );
 
-	// Load all overworlds
-	// todo : should only load overworld info
+	/* Load the description of all overworlds
+	 * an overworld is loaded when activated
+	*/
 	void Init( void );
-	/* Load overworlds from the given directory
+	/* Load overworld descriptions from the given directory
 	 * user_dir : if set overrides game worlds
 	*/
 	void Load_Dir( const std::string &dir, bool user_dir = 0 );
 
 	// Set active Overworld from name or path
 	bool Set_Active( const std::string &str );
-	// Set active Overworld
+	// Set active Overworld and load it if needed
 	bool Set_Active( cOverworld *world );
+	// Unload the least recently used overworlds above the loaded limit
+	void Unload_Unused( void );
 
 	// Reset to default world first Waypoint
 	void Reset( void );
@@ -76,6 +79,9 @@ public:
 
 	// world camera
 	cCamera *m_camera;
+
+	// increased when an overworld is activated
+	unsigned int m_use_count;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
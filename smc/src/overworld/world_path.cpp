@@ -0,0 +1,350 @@
+/***************************************************************************
+ * world_path.cpp  -  Overworld Waypoint connections
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../overworld/world_path.h"
+#include "../overworld/overworld.h"
+#include "../core/game_core.h"
+#include <algorithm>
+#include <deque>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cWorld_Path *** *** *** *** *** *** *** *** *** *** */
+
+cWorld_Path :: cWorld_Path( void )
+{
+	m_start = -1;
+	m_end = -1;
+	m_direction = DIR_UNDEFINED;
+	m_forward = 0;
+	m_line_origin = 0;
+	m_length = 0.0f;
+}
+
+void cWorld_Path :: Add_Point( float x, float y )
+{
+	if( m_points.empty() )
+	{
+		m_points.push_back( GL_point( x, y ) );
+		m_distances.push_back( 0.0f );
+		return;
+	}
+
+	const GL_point &last = m_points.back();
+	const float length = sqrt( ( ( x - last.m_x ) * ( x - last.m_x ) ) + ( ( y - last.m_y ) * ( y - last.m_y ) ) );
+
+	// same position
+	if( length < 0.5f )
+	{
+		return;
+	}
+
+	m_length += length;
+	m_points.push_back( GL_point( x, y ) );
+	m_distances.push_back( m_length );
+}
+
+GL_point cWorld_Path :: Get_Pos( float distance ) const
+{
+	if( m_points.empty() )
+	{
+		return GL_point();
+	}
+
+	if( distance <= 0.0f )
+	{
+		return m_points.front();
+	}
+
+	if( distance >= m_length )
+	{
+		return m_points.back();
+	}
+
+	// first point after the distance
+	const unsigned int num = std::upper_bound( m_distances.begin(), m_distances.end(), distance ) - m_distances.begin();
+
+	const GL_point &p1 = m_points[num - 1];
+	const GL_point &p2 = m_points[num];
+	const float pos = ( distance - m_distances[num - 1] ) / ( m_distances[num] - m_distances[num - 1] );
+
+	return GL_point( p1.m_x + ( ( p2.m_x - p1.m_x ) * pos ), p1.m_y + ( ( p2.m_y - p1.m_y ) * pos ) );
+}
+
+ObjectDirection cWorld_Path :: Get_Direction( float distance, bool back /* = 0 */ ) const
+{
+	if( m_points.size() < 2 )
+	{
+		return m_direction;
+	}
+
+	unsigned int num = std::upper_bound( m_distances.begin(), m_distances.end(), distance ) - m_distances.begin();
+
+	// on the last point the last segment is used
+	if( num >= m_points.size() )
+	{
+		num = m_points.size() - 1;
+	}
+	// on the first point the first segment is used
+	else if( num == 0 )
+	{
+		num = 1;
+	}
+
+	float x = m_points[num].m_x - m_points[num - 1].m_x;
+	float y = m_points[num].m_y - m_points[num - 1].m_y;
+
+	if( back )
+	{
+		x = -x;
+		y = -y;
+	}
+
+	if( fabs( x ) >= fabs( y ) )
+	{
+		return x < 0.0f ? DIR_LEFT : DIR_RIGHT;
+	}
+
+	return y < 0.0f ? DIR_UP : DIR_DOWN;
+}
+
+/* *** *** *** *** *** *** *** cWorld_Path_Graph *** *** *** *** *** *** *** *** *** *** */
+
+cWorld_Path_Graph :: cWorld_Path_Graph( cOverworld *overworld )
+{
+	m_overworld = overworld;
+	m_generation = 0;
+}
+
+cWorld_Path_Graph :: ~cWorld_Path_Graph( void )
+{
+	Clear();
+}
+
+void cWorld_Path_Graph :: Build( void )
+{
+	Clear();
+
+	const WaypointList &waypoints = m_overworld->m_waypoints;
+	m_waypoint_paths.resize( waypoints.size() );
+
+	// forward path number of each Waypoint
+	vector<int> forward_paths( waypoints.size(), -1 );
+
+	for( unsigned int i = 0; i < waypoints.size(); i++ )
+	{
+		const cWaypoint *waypoint = waypoints[i];
+
+		if( waypoint->m_direction_forward == DIR_UNDEFINED )
+		{
+			continue;
+		}
+
+		cWorld_Path *path = new cWorld_Path();
+
+		if( !Follow_Lines( i, waypoint->m_direction_forward, path ) )
+		{
+			delete path;
+			continue;
+		}
+
+		path->m_forward = 1;
+		forward_paths[i] = m_paths.size();
+		Add( path );
+	}
+
+	// backward paths walk a forward path back
+	for( unsigned int i = 0; i < waypoints.size(); i++ )
+	{
+		const cWaypoint *waypoint = waypoints[i];
+
+		if( waypoint->m_direction_backward == DIR_UNDEFINED )
+		{
+			continue;
+		}
+
+		const cLayer_Line_Point_Start *line = m_overworld->m_layer->Get_Line_Collision_Direction( waypoint->m_rect.m_x + ( waypoint->m_rect.m_w * 0.5f ), waypoint->m_rect.m_y + ( waypoint->m_rect.m_h * 0.5f ), waypoint->m_direction_backward ).m_line;
+
+		if( !line || line->m_origin >= waypoints.size() || forward_paths[line->m_origin] < 0 )
+		{
+			continue;
+		}
+
+		const cWorld_Path *forward_path = m_paths[forward_paths[line->m_origin]];
+
+		// does not lead here
+		if( forward_path->m_end != static_cast<int>(i) )
+		{
+			continue;
+		}
+
+		cWorld_Path *path = new cWorld_Path();
+		path->m_start = i;
+		path->m_end = forward_path->m_start;
+		path->m_direction = waypoint->m_direction_backward;
+		path->m_line_origin = line->m_origin;
+
+		for( vector<GL_point>::const_reverse_iterator itr = forward_path->m_points.rbegin(); itr != forward_path->m_points.rend(); ++itr )
+		{
+			path->Add_Point( itr->m_x, itr->m_y );
+		}
+
+		Add( path );
+	}
+}
+
+void cWorld_Path_Graph :: Clear( void )
+{
+	for( vector<cWorld_Path *>::iterator itr = m_paths.begin(); itr != m_paths.end(); ++itr )
+	{
+		delete *itr;
+	}
+
+	m_paths.clear();
+	m_waypoint_paths.clear();
+	m_generation++;
+}
+
+int cWorld_Path_Graph :: Get_Path_Num( int waypoint, ObjectDirection dir ) const
+{
+	if( waypoint < 0 || waypoint >= static_cast<int>(m_waypoint_paths.size()) )
+	{
+		return -1;
+	}
+
+	const vector<unsigned int> &paths = m_waypoint_paths[waypoint];
+
+	for( vector<unsigned int>::const_iterator itr = paths.begin(); itr != paths.end(); ++itr )
+	{
+		if( m_paths[*itr]->m_direction == dir )
+		{
+			return *itr;
+		}
+	}
+
+	return -1;
+}
+
+const cWorld_Path *cWorld_Path_Graph :: Get_Path( int path_num ) const
+{
+	if( path_num < 0 || path_num >= static_cast<int>(m_paths.size()) )
+	{
+		return NULL;
+	}
+
+	return m_paths[path_num];
+}
+
+bool cWorld_Path_Graph :: Is_Connected( int start, int end ) const
+{
+	const int count = m_waypoint_paths.size();
+
+	if( start < 0 || end < 0 || start >= count || end >= count )
+	{
+		return 0;
+	}
+
+	vector<bool> visited( count, 0 );
+	std::deque<int> open;
+	visited[start] = 1;
+	open.push_back( start );
+
+	while( !open.empty() )
+	{
+		const int waypoint = open.front();
+		open.pop_front();
+
+		if( waypoint == end )
+		{
+			return 1;
+		}
+
+		const vector<unsigned int> &paths = m_waypoint_paths[waypoint];
+
+		for( vector<unsigned int>::const_iterator itr = paths.begin(); itr != paths.end(); ++itr )
+		{
+			const int next = m_paths[*itr]->m_end;
+
+			if( !visited[next] )
+			{
+				visited[next] = 1;
+				open.push_back( next );
+			}
+		}
+	}
+
+	return 0;
+}
+
+bool cWorld_Path_Graph :: Follow_Lines( int waypoint, ObjectDirection dir, cWorld_Path *path ) const
+{
+	const cWaypoint *start = m_overworld->m_waypoints[waypoint];
+	const float x = start->m_rect.m_x + ( start->m_rect.m_w * 0.5f );
+	const float y = start->m_rect.m_y + ( start->m_rect.m_h * 0.5f );
+
+	// like the player uses the line in front
+	cLayer_Line_Point_Start *line = m_overworld->m_layer->Get_Line_Collision_Direction( x, y, dir ).m_line;
+
+	if( !line )
+	{
+		return 0;
+	}
+
+	path->m_start = waypoint;
+	path->m_direction = dir;
+	path->m_line_origin = line->m_origin;
+	path->Add_Point( x, y );
+
+	// stop on lines linked in a circle
+	for( unsigned int i = 0; line && i < m_overworld->m_layer->size(); i++ )
+	{
+		const GL_line map_line = line->Get_Line();
+		path->Add_Point( map_line.m_x1, map_line.m_y1 );
+		path->Add_Point( map_line.m_x2, map_line.m_y2 );
+
+		const int end = m_overworld->Get_Waypoint_Collision( line->m_linked_point->m_col_rect );
+
+		if( end >= 0 )
+		{
+			// leads back
+			if( end == waypoint )
+			{
+				return 0;
+			}
+
+			const cWaypoint *end_waypoint = m_overworld->m_waypoints[end];
+			path->Add_Point( end_waypoint->m_rect.m_x + ( end_waypoint->m_rect.m_w * 0.5f ), end_waypoint->m_rect.m_y + ( end_waypoint->m_rect.m_h * 0.5f ) );
+			path->m_end = end;
+
+			return 1;
+		}
+
+		// continues on the next line
+		line = m_overworld->m_layer->Get_Line_Collision_Start( line->m_linked_point->m_col_rect );
+	}
+
+	return 0;
+}
+
+void cWorld_Path_Graph :: Add( cWorld_Path *path )
+{
+	m_waypoint_paths[path->m_start].push_back( m_paths.size() );
+	m_paths.push_back( path );
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,112 @@
+/***************************************************************************
+ * world_path.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_WORLD_PATH_H
+#define SMC_WORLD_PATH_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../core/math/point.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cWorld_Path *** *** *** *** *** *** *** *** *** *** */
+
+/* Walkable connection between two Waypoints
+ * follows the layer lines from the start to the end Waypoint center
+*/
+class cWorld_Path
+{
+public:
+	cWorld_Path( void );
+
+	// Add the next point if not at the last point
+	void Add_Point( float x, float y );
+
+	// Returns the position at the given distance from the start
+	GL_point Get_Pos( float distance ) const;
+	/* Returns the walking direction at the given distance from the start
+	 * back : if set walking to the start
+	*/
+	ObjectDirection Get_Direction( float distance, bool back = 0 ) const;
+
+	// start Waypoint number
+	int m_start;
+	// end Waypoint number
+	int m_end;
+	// direction to walk from the start Waypoint
+	ObjectDirection m_direction;
+	// if set the end Waypoint needs access
+	bool m_forward;
+	// origin identifier of the layer lines
+	unsigned int m_line_origin;
+
+	// points from the start to the end
+	vector<GL_point> m_points;
+	// distance from the start at each point
+	vector<float> m_distances;
+	// path length
+	float m_length;
+};
+
+/* *** *** *** *** *** *** *** cWorld_Path_Graph *** *** *** *** *** *** *** *** *** *** */
+
+/* Waypoint connections of an overworld
+ * built from the layer lines and the Waypoint directions
+*/
+class cWorld_Path_Graph
+{
+public:
+	cWorld_Path_Graph( cOverworld *overworld );
+	~cWorld_Path_Graph( void );
+
+	// Build all paths
+	void Build( void );
+	// Delete all paths
+	void Clear( void );
+
+	/* Returns the path number from the Waypoint into the direction
+	 * if not found returns -1
+	*/
+	int Get_Path_Num( int waypoint, ObjectDirection dir ) const;
+	// Returns the path or NULL if not available
+	const cWorld_Path *Get_Path( int path_num ) const;
+	// Returns true if the end Waypoint can be reached from the start Waypoint
+	bool Is_Connected( int start, int end ) const;
+
+	// parent overworld
+	cOverworld *m_overworld;
+	// all paths
+	vector<cWorld_Path *> m_paths;
+	// path numbers starting on each Waypoint
+	vector<vector<unsigned int> > m_waypoint_paths;
+	// increased when built or cleared
+	unsigned int m_generation;
+
+private:
+	/* Follow the layer lines from the Waypoint into the direction
+	 * returns false if they do not end on another Waypoint
+	*/
+	bool Follow_Lines( int waypoint, ObjectDirection dir, cWorld_Path *path ) const;
+	// Add the path
+	void Add( cWorld_Path *path );
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -18,6 +18,7 @@
 #include "../core/framerate.h"
 #include "../overworld/overworld.h"
 #include "../level/level.h"
+#include "../level/level_prefetch.h"
 #include "../video/font.h"
 #include "../audio/audio.h"
 #include "../gui/menu.h"
@@ -44,6 +45,10 @@ cOverworld_Player :: cOverworld_Player( cSprite_Manager *sprite_manager, cOverwo
 	m_current_line = -2;
 
 	m_fixed_walking = 0;
+	m_path = -1;
+	m_path_generation = 0;
+	m_path_distance = 0.0f;
+	m_path_back = 0;
 
 	m_line_hor = cLine_collision();
 	m_line_ver = cLine_collision();
@@ -116,6 +121,7 @@ void cOverworld_Player :: Unload_Images( void )
 void cOverworld_Player :: Set_Overworld( cOverworld *overworld )
 {
 	m_overworld = overworld;
+	m_path = -1;
 }
 
 void cOverworld_Player :: Set_Direction( const ObjectDirection dir, bool new_start_direction /* = 0 */ )
@@ -182,8 +188,13 @@ void cOverworld_Player :: Update( void )
 		return;
 	}
 
+	// path walking
+	if( Is_Path_Walking() )
+	{
+		Update_Path_Walk();
+	}
 	// default walking
-	if( !m_fixed_walking )
+	else if( !m_fixed_walking )
 	{
 		Update_Walk();
 	} 
@@ -278,6 +289,7 @@ void cOverworld_Player :: Reset( void )
 	m_current_line = -2;
 
 	m_fixed_walking = 0;
+	m_path = -1;
 	Set_Direction( DIR_UNDEFINED );
 }
 
@@ -423,6 +435,20 @@ bool cOverworld_Player :: Start_Walk( ObjectDirection new_direction )
 		return 0;
 	}
 
+	// walking on a path
+	if( Is_Path_Walking() )
+	{
+		// turn around if not on a waypoint
+		if( m_direction == Get_Opposite_Direction( new_direction ) && m_overworld->Get_Waypoint_Collision( m_col_rect ) < 0 )
+		{
+			m_path_back = !m_path_back;
+			Set_Direction( new_direction );
+			return 1;
+		}
+
+		return 0;
+	}
+
 	// print debug info
 	if( pOverworld_Manager->m_debug_mode )
 	{
@@ -437,6 +463,14 @@ bool cOverworld_Player :: Start_Walk( ObjectDirection new_direction )
 	// a start from waypoint
 	if( m_current_waypoint >= 0 && m_direction == DIR_UNDEFINED )
 	{
+		const int path_num = m_overworld->m_path_graph->Get_Path_Num( m_current_waypoint, new_direction );
+
+		// use the connection
+		if( path_num >= 0 )
+		{
+			return Start_Path_Walk( path_num );
+		}
+
 		// Get Layer Line in front
 		cLayer_Line_Point_Start *front_line = Get_Front_Line( new_direction );
 
@@ -645,6 +679,131 @@ void cOverworld_Player :: Update_Waypoint_Walk( void )
 	}
 }
 
+bool cOverworld_Player :: Start_Path_Walk( int path_num )
+{
+	const cWorld_Path *path = m_overworld->m_path_graph->Get_Path( path_num );
+
+	if( !path )
+	{
+		return 0;
+	}
+
+	// next waypoint is not accessible
+	if( path->m_forward && !m_overworld->m_waypoints[path->m_end]->m_access )
+	{
+		if( pOverworld_Manager->m_debug_mode )
+		{
+			printf( "No access to next waypoint\n" );
+		}
+
+		return 0;
+	}
+
+	if( pOverworld_Manager->m_debug_mode )
+	{
+		printf( "Walking path %d from waypoint %d to %d\n", path_num, path->m_start, path->m_end );
+	}
+
+	m_path = path_num;
+	m_path_generation = m_overworld->m_path_graph->m_generation;
+	m_path_distance = 0.0f;
+	m_path_back = 0;
+	// used if the path gets invalid
+	m_line_waypoint = path->m_line_origin;
+
+	Set_Direction( path->Get_Direction( 0.0f ) );
+
+	return 1;
+}
+
+void cOverworld_Player :: Update_Path_Walk( void )
+{
+	const cWorld_Path *path = m_overworld->m_path_graph->Get_Path( m_path );
+	const float distance = 3.0f * pFramerate->m_speed_factor;
+
+	int reached_waypoint = -1;
+
+	if( m_path_back )
+	{
+		m_path_distance -= distance;
+
+		if( m_path_distance <= 0.0f )
+		{
+			m_path_distance = 0.0f;
+			reached_waypoint = path->m_start;
+		}
+	}
+	else
+	{
+		m_path_distance += distance;
+
+		if( m_path_distance >= path->m_length )
+		{
+			m_path_distance = path->m_length;
+			reached_waypoint = path->m_end;
+		}
+	}
+
+	const GL_point pos = path->Get_Pos( m_path_distance );
+	Set_Pos( pos.m_x - m_col_pos.m_x - ( m_col_rect.m_w * 0.5f ), pos.m_y - m_col_pos.m_y - ( m_col_rect.m_h * 0.5f ) );
+
+	if( reached_waypoint >= 0 )
+	{
+		m_path = -1;
+
+		Set_Direction( DIR_UNDEFINED );
+		Set_Waypoint( reached_waypoint );
+
+		pAudio->Play_Sound( "waypoint_reached.ogg" );
+		return;
+	}
+
+	Set_Direction( path->Get_Direction( m_path_distance, m_path_back ) );
+
+	// left the start waypoint
+	if( m_current_waypoint >= 0 && !m_col_rect.Intersects( Get_Waypoint()->m_rect ) )
+	{
+		m_current_waypoint = -1;
+	}
+}
+
+bool cOverworld_Player :: Is_Path_Walking( void ) const
+{
+	return m_path >= 0 && m_path_generation == m_overworld->m_path_graph->m_generation;
+}
+
+bool cOverworld_Player :: Jump_To_Waypoint( int waypoint )
+{
+	if( !pOverworld_Manager->m_debug_mode && !editor_world_enabled )
+	{
+		return 0;
+	}
+
+	if( waypoint < 0 || waypoint >= static_cast<int>(m_overworld->m_waypoints.size()) || waypoint == m_current_waypoint )
+	{
+		return 0;
+	}
+
+	// the editor can change the connections
+	if( editor_world_enabled )
+	{
+		m_overworld->m_path_graph->Build();
+	}
+
+	// only if walking there is possible
+	if( m_current_waypoint >= 0 && !m_overworld->m_path_graph->Is_Connected( m_current_waypoint, waypoint ) )
+	{
+		printf( "Waypoint %d is not connected to waypoint %d\n", waypoint, m_current_waypoint );
+		return 0;
+	}
+
+	m_path = -1;
+	m_fixed_walking = 0;
+	Set_Direction( DIR_UNDEFINED );
+
+	return Set_Waypoint( waypoint );
+}
+
 bool cOverworld_Player :: Set_Waypoint( int waypoint, bool new_startpos /* = 0 */ )
 {
 	if( waypoint < 0 || waypoint >= static_cast<int>(m_overworld->m_waypoints.size()) ) 
@@ -657,6 +816,12 @@ bool cOverworld_Player :: Set_Waypoint( int waypoint, bool new_startpos /* = 0 *
 	Set_Pos( wp->m_rect.m_x - m_col_pos.m_x + ( ( wp->m_rect.m_w - m_col_rect.m_w ) * 0.5f ), wp->m_rect.m_y - m_col_pos.m_y + ( ( wp->m_rect.m_h - m_col_rect.m_h ) * 0.5f ), new_startpos );
 	m_current_waypoint = waypoint;
 
+	// load the level in the background
+	if( wp->m_waypoint_type == WAYPOINT_NORMAL && !editor_world_enabled )
+	{
+		pLevel_Preloader->Start( wp->Get_Destination() );
+	}
+
 	// Update Camera
 	pActive_Camera->Update();
 	// Update Waypoint text
@@ -83,6 +83,18 @@ public:
 	 * moves maryo smoothly into the found Waypoint
 	*/
 	void Update_Waypoint_Walk( void );
+	/* Start walking on the path from the current Waypoint
+	 * returns 0 if the end Waypoint is not accessible
+	*/
+	bool Start_Path_Walk( int path_num );
+	// Moves along the path and stops on its end Waypoint
+	void Update_Path_Walk( void );
+	// Returns true if walking on a valid path
+	bool Is_Path_Walking( void ) const;
+	/* Set Maryo to a connected Waypoint without walking
+	 * only in debug mode or if the world editor is enabled
+	*/
+	bool Jump_To_Waypoint( int waypoint );
 
 	// Set Maryo to the given Waypoint position
 	bool Set_Waypoint( int waypoint, bool new_startpos = 0 );
@@ -119,6 +131,15 @@ public:
 	// if touched a Waypoint use fixed walking
 	bool m_fixed_walking;
 
+	// current path number or -1 if following the lines
+	int m_path;
+	// path graph generation of the path
+	unsigned int m_path_generation;
+	// walked distance on the path
+	float m_path_distance;
+	// if set walking back to the path start
+	bool m_path_back;
+
 	// valid path detection lines
 	cLine_collision m_line_hor;
 	cLine_collision m_line_ver;
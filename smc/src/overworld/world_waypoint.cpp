@@ -128,10 +128,10 @@ void cWaypoint :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Access( attributes.getValueAsBool( "access", 1 ), 1 );
 }
 
-void cWaypoint :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cWaypoint :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// position
 	Write_Property( stream, "x", static_cast<int>(m_start_pos_x) );
@@ -161,7 +161,7 @@ void cWaypoint :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "access", m_access_default );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cWaypoint :: Update( void )
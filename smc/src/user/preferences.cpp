@@ -37,6 +37,7 @@ const bool cPreferences::m_always_run_default = 0;
 const std::string cPreferences::m_menu_level_default = "menu_green_1";
 const float cPreferences::m_camera_hor_speed_default = 0.3f;
 const float cPreferences::m_camera_ver_speed_default = 0.2f;
+const bool cPreferences::m_fixed_timestep_default = 0;
 // Video
 #ifdef _DEBUG
 const bool cPreferences::m_video_fullscreen_default = 0;
@@ -51,6 +52,28 @@ const Uint8 cPreferences::m_video_screen_bpp_default = 32;
 */
 const bool cPreferences::m_video_vsync_default = 0;
 const Uint16 cPreferences::m_video_fps_limit_default = 240;
+const bool cPreferences::m_video_fps_display_default = 0;
+const Uint16 cPreferences::m_video_fps_display_interval_default = 500;
+// disabled by default because it needs a driver which supports a context in another thread
+const bool cPreferences::m_video_render_thread_default = 0;
+// static menus are only drawn again if something changed
+const bool cPreferences::m_video_menu_idle_default = 1;
+// waiting for the GPU lowers the framerate
+const bool cPreferences::m_video_low_latency_default = 0;
+// needs framebuffer object support
+const bool cPreferences::m_video_dynamic_resolution_default = 0;
+const float cPreferences::m_video_dynamic_resolution_min_default = 0.5f;
+const Uint16 cPreferences::m_video_dynamic_resolution_fps_default = 60;
+// no limit
+const Uint16 cPreferences::m_video_texture_budget_default = 0;
+// only limits extreme particle effects
+const Uint16 cPreferences::m_video_particle_budget_default = 20000;
+const Uint16 cPreferences::m_video_particle_fps_default = 0;
+// falls back to the cpu if opengl 2.0 is not available
+const bool cPreferences::m_video_particle_shader_default = 1;
+// needs framebuffer object support
+const bool cPreferences::m_video_hud_layer_default = 0;
+const bool cPreferences::m_video_sprite_shader_default = 1;
 // default geometry detail is medium
 const float cPreferences::m_geometry_quality_default = 0.5f;
 // default texture detail is high
@@ -59,6 +82,8 @@ const float cPreferences::m_texture_quality_default = 0.75f;
 const bool cPreferences::m_audio_music_default = 1;
 const bool cPreferences::m_audio_sound_default = 1;
 const unsigned int cPreferences::m_audio_hz_default = 44100;
+const bool cPreferences::m_audio_low_latency_default = 0;
+const unsigned int cPreferences::m_audio_latency_buffer_default = 512;
 const Uint8 cPreferences::m_sound_volume_default = 100;
 const Uint8 cPreferences::m_music_volume_default = 80;
 // Keyboard
@@ -95,6 +120,10 @@ const Uint8 cPreferences::m_joy_button_exit_default = 4;
 const bool cPreferences::m_editor_mouse_auto_hide_default = 0;
 const bool cPreferences::m_editor_show_item_images_default = 1;
 const unsigned int cPreferences::m_editor_item_image_size_default = 50;
+const bool cPreferences::m_editor_save_compressed_default = 0;
+const bool cPreferences::m_editor_autosave_default = 0;
+const bool cPreferences::m_hot_reload_default = 0;
+const bool cPreferences::m_hot_reload_level_default = 1;
 
 cPreferences :: cPreferences( void )
 {
@@ -167,23 +196,10 @@ void cPreferences :: Save( void )
 {
 	Update();
 
-// fixme : Check if there is a more portable way f.e. with imbue()
-#ifdef _WIN32
-	ofstream file( utf8_to_ucs2( m_config_filename ).c_str(), ios::out | ios::trunc );
-#else
-	ofstream file( m_config_filename.c_str(), ios::out | ios::trunc );
-#endif
-
-	if( !file.is_open() )
-	{
-		printf( "Error : couldn't open config %s for saving. Is the file read-only ?\n", m_config_filename.c_str() );
-		return;
-	}
-
-	CEGUI::XMLSerializer stream( file );
+	cXml_Writer stream;
 
 	// begin
-	stream.openTag( "config" );
+	stream.Open_Tag( "config" );
 	// Game
 	Write_Property( stream, "game_version", int_to_string(SMC_VERSION_MAJOR) + "." + int_to_string(SMC_VERSION_MINOR) + "." + int_to_string(SMC_VERSION_PATCH) );
 	Write_Property( stream, "game_language", m_language );
@@ -192,6 +208,7 @@ void cPreferences :: Save( void )
 	Write_Property( stream, "game_user_data_dir", m_force_user_data_dir );
 	Write_Property( stream, "game_camera_hor_speed", m_camera_hor_speed );
 	Write_Property( stream, "game_camera_ver_speed", m_camera_ver_speed );
+	Write_Property( stream, "game_fixed_timestep", m_fixed_timestep );
 	// Video
 	Write_Property( stream, "video_fullscreen", m_video_fullscreen );
 	Write_Property( stream, "video_screen_w", m_video_screen_w );
@@ -199,6 +216,20 @@ void cPreferences :: Save( void )
 	Write_Property( stream, "video_screen_bpp", static_cast<int>(m_video_screen_bpp) );
 	Write_Property( stream, "video_vsync", m_video_vsync );
 	Write_Property( stream, "video_fps_limit", m_video_fps_limit );
+	Write_Property( stream, "video_fps_display", m_video_fps_display );
+	Write_Property( stream, "video_fps_display_interval", m_video_fps_display_interval );
+	Write_Property( stream, "video_render_thread", m_video_render_thread );
+	Write_Property( stream, "video_menu_idle", m_video_menu_idle );
+	Write_Property( stream, "video_low_latency", m_video_low_latency );
+	Write_Property( stream, "video_dynamic_resolution", m_video_dynamic_resolution );
+	Write_Property( stream, "video_dynamic_resolution_min", m_video_dynamic_resolution_min );
+	Write_Property( stream, "video_dynamic_resolution_fps", m_video_dynamic_resolution_fps );
+	Write_Property( stream, "video_texture_budget", m_video_texture_budget );
+	Write_Property( stream, "video_particle_budget", m_video_particle_budget );
+	Write_Property( stream, "video_particle_fps", m_video_particle_fps );
+	Write_Property( stream, "video_particle_shader", m_video_particle_shader );
+	Write_Property( stream, "video_hud_layer", m_video_hud_layer );
+	Write_Property( stream, "video_sprite_shader", m_video_sprite_shader );
 	Write_Property( stream, "video_geometry_quality", pVideo->m_geometry_quality );
 	Write_Property( stream, "video_texture_quality", pVideo->m_texture_quality );
 	// Audio
@@ -207,6 +238,8 @@ void cPreferences :: Save( void )
 	Write_Property( stream, "audio_sound_volume", static_cast<int>(pAudio->m_sound_volume) );
 	Write_Property( stream, "audio_music_volume", static_cast<int>(pAudio->m_music_volume) );
 	Write_Property( stream, "audio_hz", m_audio_hz );
+	Write_Property( stream, "audio_low_latency", m_audio_low_latency );
+	Write_Property( stream, "audio_latency_buffer", m_audio_latency_buffer );
 	// Keyboard
 	Write_Property( stream, "keyboard_key_up", m_key_up );
 	Write_Property( stream, "keyboard_key_down", m_key_down );
@@ -241,14 +274,24 @@ void cPreferences :: Save( void )
 	// Special
 	Write_Property( stream, "level_background_images", m_level_background_images );
 	Write_Property( stream, "image_cache_enabled", m_image_cache_enabled );
+	Write_Property( stream, "image_cache_compressed", m_image_cache_compressed );
+	Write_Property( stream, "level_preload_count", m_level_preload_count );
 	// Editor
 	Write_Property( stream, "editor_mouse_auto_hide", m_editor_mouse_auto_hide );
 	Write_Property( stream, "editor_show_item_images", m_editor_show_item_images );
 	Write_Property( stream, "editor_item_image_size", m_editor_item_image_size );
+	Write_Property( stream, "editor_save_compressed", m_editor_save_compressed );
+	Write_Property( stream, "editor_autosave", m_editor_autosave );
+	Write_Property( stream, "hot_reload", m_hot_reload );
+	Write_Property( stream, "hot_reload_level", m_hot_reload_level );
 	// end config
-	stream.closeTag();
+	stream.Close_Tag();
 
-	file.close();
+	if( !stream.Save( m_config_filename ) )
+	{
+		printf( "Error : couldn't open config %s for saving. Is the file read-only ?\n", m_config_filename.c_str() );
+		return;
+	}
 }
 
 void cPreferences :: Reset_All( void )
@@ -267,6 +310,9 @@ void cPreferences :: Reset_All( void )
 	// Special
 	m_level_background_images = 1;
 	m_image_cache_enabled = 1;
+	// lossy and needs texture compression support
+	m_image_cache_compressed = 0;
+	m_level_preload_count = 2;
 
 	// filename
 	m_config_filename = "config.xml";
@@ -279,6 +325,7 @@ void cPreferences :: Reset_Game( void )
 	m_menu_level = m_menu_level_default;
 	m_camera_hor_speed = m_camera_hor_speed_default;
 	m_camera_ver_speed = m_camera_ver_speed_default;
+	m_fixed_timestep = m_fixed_timestep_default;
 }
 
 void cPreferences :: Reset_Video( void )
@@ -289,6 +336,20 @@ void cPreferences :: Reset_Video( void )
 	m_video_screen_bpp = m_video_screen_bpp_default;
 	m_video_vsync = m_video_vsync_default;
 	m_video_fps_limit = m_video_fps_limit_default;
+	m_video_fps_display = m_video_fps_display_default;
+	m_video_fps_display_interval = m_video_fps_display_interval_default;
+	m_video_render_thread = m_video_render_thread_default;
+	m_video_menu_idle = m_video_menu_idle_default;
+	m_video_low_latency = m_video_low_latency_default;
+	m_video_dynamic_resolution = m_video_dynamic_resolution_default;
+	m_video_dynamic_resolution_min = m_video_dynamic_resolution_min_default;
+	m_video_dynamic_resolution_fps = m_video_dynamic_resolution_fps_default;
+	m_video_texture_budget = m_video_texture_budget_default;
+	m_video_particle_budget = m_video_particle_budget_default;
+	m_video_particle_fps = m_video_particle_fps_default;
+	m_video_particle_shader = m_video_particle_shader_default;
+	m_video_hud_layer = m_video_hud_layer_default;
+	m_video_sprite_shader = m_video_sprite_shader_default;
 	m_video_fullscreen = m_video_fullscreen_default;
 	pVideo->m_geometry_quality = m_geometry_quality_default;
 	pVideo->m_texture_quality = m_texture_quality_default;
@@ -300,6 +361,8 @@ void cPreferences :: Reset_Audio( void )
 	m_audio_music = m_audio_music_default;
 	m_audio_sound = m_audio_sound_default;
 	m_audio_hz = m_audio_hz_default;
+	m_audio_low_latency = m_audio_low_latency_default;
+	m_audio_latency_buffer = m_audio_latency_buffer_default;
 	pAudio->m_sound_volume = m_sound_volume_default;
 	pAudio->m_music_volume = m_music_volume_default;
 }
@@ -349,6 +412,10 @@ void cPreferences :: Reset_Editor( void )
 	m_editor_mouse_auto_hide = m_editor_mouse_auto_hide_default;
 	m_editor_show_item_images = m_editor_show_item_images_default;
 	m_editor_item_image_size = m_editor_item_image_size_default;
+	m_editor_save_compressed = m_editor_save_compressed_default;
+	m_editor_autosave = m_editor_autosave_default;
+	m_hot_reload = m_hot_reload_default;
+	m_hot_reload_level = m_hot_reload_level_default;
 }
 
 void cPreferences :: Update( void )
@@ -507,6 +574,10 @@ void cPreferences :: handle_item( CEGUI::XMLAttributes attributes )
 	{
 		m_camera_ver_speed = attributes.getValueAsFloat( "value" );
 	}
+	else if( name.compare( "game_fixed_timestep" ) == 0 )
+	{
+		m_fixed_timestep = attributes.getValueAsBool( "value" );
+	}
 	// Video
 	else if( name.compare( "video_screen_h" ) == 0 )
 	{
@@ -561,6 +632,77 @@ void cPreferences :: handle_item( CEGUI::XMLAttributes attributes )
 	{
 		m_video_fps_limit = attributes.getValueAsInteger( "value" );
 	}
+	else if( name.compare( "video_fps_display" ) == 0 )
+	{
+		m_video_fps_display = attributes.getValueAsBool( "value" );
+	}
+	else if( name.compare( "video_fps_display_interval" ) == 0 )
+	{
+		m_video_fps_display_interval = attributes.getValueAsInteger( "value" );
+	}
+	else if( name.compare( "video_render_thread" ) == 0 )
+	{
+		m_video_render_thread = attributes.getValueAsBool( "value" );
+	}
+	else if( name.compare( "video_menu_idle" ) == 0 )
+	{
+		m_video_menu_idle = attributes.getValueAsBool( "value" );
+	}
+	else if( name.compare( "video_low_latency" ) == 0 )
+	{
+		m_video_low_latency = attributes.getValueAsBool( "value" );
+	}
+	else if( name.compare( "video_dynamic_resolution" ) == 0 )
+	{
+		m_video_dynamic_resolution = attributes.getValueAsBool( "value" );
+	}
+	else if( name.compare( "video_dynamic_resolution_min" ) == 0 )
+	{
+		float val = attributes.getValueAsFloat( "value" );
+
+		if( val >= 0.1f && val <= 1.0f )
+		{
+			m_video_dynamic_resolution_min = val;
+		}
+	}
+	else if( name.compare( "video_dynamic_resolution_fps" ) == 0 )
+	{
+		m_video_dynamic_resolution_fps = attributes.getValueAsInteger( "value" );
+	}
+	else if( name.compare( "video_texture_budget" ) == 0 )
+	{
+		m_video_texture_budget = attributes.getValueAsInteger( "value" );
+	}
+	else if( name.compare( "video_particle_budget" ) == 0 )
+	{
+		int val = attributes.getValueAsInteger( "value" );
+
+		if( val >= 0 && val <= 65535 )
+		{
+			m_video_particle_budget = val;
+		}
+	}
+	else if( name.compare( "video_particle_fps" ) == 0 )
+	{
+		int val = attributes.getValueAsInteger( "value" );
+
+		if( val >= 0 && val <= 1000 )
+		{
+			m_video_particle_fps = val;
+		}
+	}
+	else if( name.compare( "video_particle_shader" ) == 0 )
+	{
+		m_video_particle_shader = attributes.getValueAsBool( "value" );
+	}
+	else if( name.compare( "video_hud_layer" ) == 0 )
+	{
+		m_video_hud_layer = attributes.getValueAsBool( "value" );
+	}
+	else if( name.compare( "video_sprite_shader" ) == 0 )
+	{
+		m_video_sprite_shader = attributes.getValueAsBool( "value" );
+	}
 	else if( name.compare( "video_fullscreen" ) == 0 )
 	{
 		m_video_fullscreen = attributes.getValueAsBool( "value" );
@@ -609,6 +751,19 @@ void cPreferences :: handle_item( CEGUI::XMLAttributes attributes )
 			m_audio_hz = val;
 		}
 	}
+	else if( name.compare( "audio_low_latency" ) == 0 )
+	{
+		m_audio_low_latency = attributes.getValueAsBool( "value" );
+	}
+	else if( name.compare( "audio_latency_buffer" ) == 0 )
+	{
+		int val = attributes.getValueAsInteger( "value" );
+
+		if( val >= 128 && val <= 8192 )
+		{
+			m_audio_latency_buffer = val;
+		}
+	}
 	// Keyboard
 	else if( name.compare( "keyboard_key_up" ) == 0 )
 	{
@@ -861,6 +1016,14 @@ void cPreferences :: handle_item( CEGUI::XMLAttributes attributes )
 	{
 		m_image_cache_enabled = attributes.getValueAsBool( "value" );
 	}
+	else if( name.compare( "image_cache_compressed" ) == 0 )
+	{
+		m_image_cache_compressed = attributes.getValueAsBool( "value" );
+	}
+	else if( name.compare( "level_preload_count" ) == 0 )
+	{
+		m_level_preload_count = attributes.getValueAsInteger( "value" );
+	}
 	// Editor
 	else if( name.compare( "editor_mouse_auto_hide" ) == 0 )
 	{
@@ -874,6 +1037,22 @@ void cPreferences :: handle_item( CEGUI::XMLAttributes attributes )
 	{
 		m_editor_item_image_size = attributes.getValueAsInteger( "value" );
 	}
+	else if( name.compare( "editor_save_compressed" ) == 0 )
+	{
+		m_editor_save_compressed = attributes.getValueAsBool( "value" );
+	}
+	else if( name.compare( "editor_autosave" ) == 0 )
+	{
+		m_editor_autosave = attributes.getValueAsBool( "value" );
+	}
+	else if( name.compare( "hot_reload" ) == 0 )
+	{
+		m_hot_reload = attributes.getValueAsBool( "value" );
+	}
+	else if( name.compare( "hot_reload_level" ) == 0 )
+	{
+		m_hot_reload_level = attributes.getValueAsBool( "value" );
+	}
 }
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
@@ -72,11 +72,17 @@ public:
 	// smart camera speed
 	float m_camera_hor_speed;
 	float m_camera_ver_speed;
+	// update the level with a fixed timestep and interpolate the drawing
+	bool m_fixed_timestep;
 
 	// Audio
 	bool m_audio_music;
 	bool m_audio_sound;
 	unsigned int m_audio_hz;
+	// use a small mixer buffer for less delay
+	bool m_audio_low_latency;
+	// mixer buffer size in samples for the low latency mode
+	unsigned int m_audio_latency_buffer;
 
 	// Video
 	bool m_video_fullscreen;
@@ -85,6 +91,34 @@ public:
 	Uint8 m_video_screen_bpp;
 	bool m_video_vsync;
 	Uint16 m_video_fps_limit;
+	// always show the framerate line of the debug display
+	bool m_video_fps_display;
+	// milliseconds between updates of the framerate line
+	Uint16 m_video_fps_display_interval;
+	// render in a separate thread
+	bool m_video_render_thread;
+	// don't draw static menus again if nothing changed
+	bool m_video_menu_idle;
+	// sample the input late and wait for the GPU after each frame
+	bool m_video_low_latency;
+	// draw the game into an offscreen target with a resolution based on the frame time
+	bool m_video_dynamic_resolution;
+	// lowest resolution scale of the dynamic resolution
+	float m_video_dynamic_resolution_min;
+	// target fps of the dynamic resolution
+	Uint16 m_video_dynamic_resolution_fps;
+	// texture memory in megabytes before unused textures are unloaded or 0 for no limit
+	Uint16 m_video_texture_budget;
+	// particles of all emitters before new particles are reduced or 0 for no limit
+	Uint16 m_video_particle_budget;
+	// target fps which lowers the particle budget if not reached or 0 to disable
+	Uint16 m_video_particle_fps;
+	// simulate the particles of emitters in a vertex shader
+	bool m_video_particle_shader;
+	// draw the HUD into an offscreen texture which is only redrawn if it changed
+	bool m_video_hud_layer;
+	// draw batched sprites with a shader which applies color combine, shadow and rotation per vertex
+	bool m_video_sprite_shader;
 
 	// Keyboard
 	// key definitions
@@ -132,12 +166,26 @@ public:
 	bool m_editor_show_item_images;
 	// size of the item images
 	unsigned int m_editor_item_image_size;
+	// save levels gzip compressed
+	bool m_editor_save_compressed;
+	// journal the editor changes and save them in the background
+	bool m_editor_autosave;
+	// reload changed images, image settings and sounds while running
+	bool m_hot_reload;
+	// also reload the active level if its file changed
+	bool m_hot_reload_level;
 
 	// Special
 	// level background images enabled
 	bool m_level_background_images;
 	// image cache enabled
 	bool m_image_cache_enabled;
+	// image cache stores compressed textures if supported
+	bool m_image_cache_compressed;
+	/* number of following campaign levels loaded in the background
+	 * 0 only loads the level the player is about to enter
+	*/
+	unsigned int m_level_preload_count;
 
 	/* *** *** *** *** *** *** *** */
 
@@ -150,10 +198,13 @@ public:
 	static const std::string m_menu_level_default;
 	static const float m_camera_hor_speed_default;
 	static const float m_camera_ver_speed_default;
+	static const bool m_fixed_timestep_default;
 	// Audio
 	static const bool m_audio_music_default;
 	static const bool m_audio_sound_default;
 	static const unsigned int m_audio_hz_default;
+	static const bool m_audio_low_latency_default;
+	static const unsigned int m_audio_latency_buffer_default;
 	static const Uint8 m_sound_volume_default;
 	static const Uint8 m_music_volume_default;
 	// Video
@@ -163,6 +214,20 @@ public:
 	static const Uint8 m_video_screen_bpp_default;
 	static const bool m_video_vsync_default;
 	static const Uint16 m_video_fps_limit_default;
+	static const bool m_video_fps_display_default;
+	static const Uint16 m_video_fps_display_interval_default;
+	static const bool m_video_render_thread_default;
+	static const bool m_video_menu_idle_default;
+	static const bool m_video_low_latency_default;
+	static const bool m_video_dynamic_resolution_default;
+	static const float m_video_dynamic_resolution_min_default;
+	static const Uint16 m_video_dynamic_resolution_fps_default;
+	static const Uint16 m_video_texture_budget_default;
+	static const Uint16 m_video_particle_budget_default;
+	static const Uint16 m_video_particle_fps_default;
+	static const bool m_video_particle_shader_default;
+	static const bool m_video_hud_layer_default;
+	static const bool m_video_sprite_shader_default;
 	static const float m_geometry_quality_default;
 	static const float m_texture_quality_default;
 	// Keyboard
@@ -199,6 +264,10 @@ public:
 	static const bool m_editor_mouse_auto_hide_default;
 	static const bool m_editor_show_item_images_default;
 	static const unsigned int m_editor_item_image_size_default;
+	static const bool m_editor_save_compressed_default;
+	static const bool m_editor_autosave_default;
+	static const bool m_hot_reload_default;
+	static const bool m_hot_reload_level_default;
 
 private:
 	// XML element start
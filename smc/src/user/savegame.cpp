@@ -14,19 +14,27 @@
 */
 
 #include "../user/savegame.h"
+#include "../user/savegame_binary.h"
+#include "../user/savegame_writer.h"
 #include "../user/preferences.h"
 #include "../core/game_core.h"
+#include "../core/xml_reader.h"
 #include "../core/obj_manager.h"
 #include "../level/level.h"
+#include "../level/level_stream.h"
 #include "../overworld/world_manager.h"
 #include "../level/level_player.h"
 #include "../overworld/overworld.h"
 #include "../core/i18n.h"
 #include "../core/filesystem/filesystem.h"
 #include "../core/filesystem/resource_manager.h"
+#include "../core/xml_writer.h"
 // CEGUI
 #include "CEGUIXMLParser.h"
 #include "CEGUIExceptions.h"
+#include <sstream>
+// boost
+#include <boost/unordered_map.hpp>
 
 namespace SMC
 {
@@ -73,6 +81,9 @@ cSave_Level_Object_Property :: cSave_Level_Object_Property( const std::string &n
 cSave_Level_Object :: cSave_Level_Object( void )
 {
 	m_type = TYPE_UNDEFINED;
+	m_posx = 0;
+	m_posy = 0;
+	m_level_num = -1;
 }
 
 cSave_Level_Object :: ~cSave_Level_Object( void )
@@ -80,11 +91,11 @@ cSave_Level_Object :: ~cSave_Level_Object( void )
 	m_properties.clear();
 }
 
-bool cSave_Level_Object :: exists( const std::string &val_name )
+bool cSave_Level_Object :: exists( const std::string &val_name ) const
 {
-	for( Save_Level_Object_ProprtyList::iterator itr = m_properties.begin(); itr != m_properties.end(); ++itr )
+	for( Save_Level_Object_ProprtyList::const_iterator itr = m_properties.begin(); itr != m_properties.end(); ++itr )
 	{
-		cSave_Level_Object_Property obj = (*itr);
+		const cSave_Level_Object_Property &obj = (*itr);
 
 		if( obj.m_name.compare( val_name ) == 0 )
 		{
@@ -97,11 +108,11 @@ bool cSave_Level_Object :: exists( const std::string &val_name )
 	return 0;
 }
 
-std::string cSave_Level_Object :: Get_Value( const std::string &val_name )
+std::string cSave_Level_Object :: Get_Value( const std::string &val_name ) const
 {
-	for( Save_Level_Object_ProprtyList::iterator itr = m_properties.begin(); itr != m_properties.end(); ++itr )
+	for( Save_Level_Object_ProprtyList::const_iterator itr = m_properties.begin(); itr != m_properties.end(); ++itr )
 	{
-		cSave_Level_Object_Property obj = (*itr);
+		const cSave_Level_Object_Property &obj = (*itr);
 
 		if( obj.m_name.compare( val_name ) == 0 )
 		{
@@ -121,6 +132,7 @@ cSave_Level :: cSave_Level( void )
 	// level
 	m_level_pos_x = 0.0f;
 	m_level_pos_y = 0.0f;
+	m_object_count = 0;
 }
 
 cSave_Level :: ~cSave_Level( void )
@@ -138,6 +150,13 @@ cSave_Level :: ~cSave_Level( void )
 	}
 
 	m_spawned_objects.clear();
+
+	for( Save_Level_Spawned_ObjectList::iterator itr = m_spawned_object_data.begin(); itr != m_spawned_object_data.end(); ++itr )
+	{
+		delete *itr;
+	}
+
+	m_spawned_object_data.clear();
 }
 
 /* *** *** *** *** *** *** *** cSave *** *** *** *** *** *** *** *** *** *** */
@@ -213,16 +232,215 @@ std::string cSave :: Get_Active_Level( void )
 	return "";
 }
 
+/* *** *** *** *** *** *** *** cSave_Info *** *** *** *** *** *** *** *** *** *** */
+
+cSave_Info :: cSave_Info( void )
+{
+	m_version = 0;
+	m_save_time = 0;
+	m_level_count = 0;
+}
+
+void cSave_Info :: Set( const cSave *savegame )
+{
+	m_version = savegame->m_version;
+	m_save_time = savegame->m_save_time;
+	m_description = savegame->m_description;
+	m_overworld_active = savegame->m_overworld_active;
+	m_level_count = savegame->m_levels.size();
+	m_active_level.clear();
+
+	for( Save_LevelList::const_iterator itr = savegame->m_levels.begin(); itr != savegame->m_levels.end(); ++itr )
+	{
+		const cSave_Level *level = (*itr);
+
+		// if active level
+		if( !Is_Float_Equal( level->m_level_pos_x, 0.0f ) && !Is_Float_Equal( level->m_level_pos_y, 0.0f ) )
+		{
+			m_active_level = level->m_name;
+			break;
+		}
+	}
+}
+
+/* *** *** *** *** *** *** *** Spawned objects *** *** *** *** *** *** *** *** *** *** */
+
+// Collects the element and properties of a saved spawned object
+class cSavegame_Spawned_Object_Reader : public cXML_Reader::Handler
+{
+public:
+	cSavegame_Spawned_Object_Reader( cSave_Level_Spawned_Object *obj )
+	{
+		m_obj = obj;
+	}
+
+	virtual void Element_Start( const cXML_Reader::View &name, const cXML_Reader::Attribute_List &attributes )
+	{
+		if( !name.Is( "property" ) )
+		{
+			// the object element
+			if( m_obj->m_element.empty() )
+			{
+				m_obj->m_element.assign( name.m_data, name.m_length );
+			}
+
+			return;
+		}
+
+		cSave_Level_Object_Property property;
+
+		for( cXML_Reader::Attribute_List::const_iterator itr = attributes.begin(); itr != attributes.end(); ++itr )
+		{
+			if( itr->m_name.Is( "name" ) )
+			{
+				property.m_name = itr->Get_String();
+			}
+			else if( itr->m_name.Is( "value" ) )
+			{
+				property.m_value = itr->Get_String();
+			}
+		}
+
+		m_obj->m_properties.push_back( property );
+	}
+
+	virtual void Element_End( const cXML_Reader::View &name ) {}
+
+private:
+	// filled object
+	cSave_Level_Spawned_Object *m_obj;
+};
+
+/* Returns the save data of the spawned object
+ * it is serialized like in the level to keep it independent of the object
+ * returns NULL if it could not be serialized
+*/
+static cSave_Level_Spawned_Object *Savegame_Spawned_Object( cSprite *obj )
+{
+	cXml_Writer stream;
+	obj->Save_To_XML( stream );
+
+	const std::string &str = stream.Get_Data();
+	cSave_Level_Spawned_Object *save_obj = new cSave_Level_Spawned_Object();
+	cSavegame_Spawned_Object_Reader handler( save_obj );
+	cXML_Reader reader;
+
+	if( !reader.Parse( str.data(), str.length(), "spawned object", handler ) || save_obj->m_element.empty() )
+	{
+		delete save_obj;
+		return NULL;
+	}
+
+	return save_obj;
+}
+
+/* *** *** *** *** *** *** *** cSavegame_Object_Index *** *** *** *** *** *** *** *** *** *** */
+
+/* Level objects by their level file number and start position for restoring the saved objects
+ * the start position finds the same object as cSprite_Manager::Get_from_Position with the position check
+*/
+class cSavegame_Object_Index
+{
+public:
+	cSavegame_Object_Index( cSprite_Manager *sprite_manager )
+	{
+		m_sprite_manager = sprite_manager;
+		Build();
+	}
+
+	// Index all objects
+	void Build( void )
+	{
+		m_objects.clear();
+		m_numbered_objects.clear();
+
+		for( cSprite_List::const_iterator itr = m_sprite_manager->objects.begin(); itr != m_sprite_manager->objects.end(); ++itr )
+		{
+			cSprite *obj = (*itr);
+
+			m_objects[Get_Key( static_cast<int>(obj->m_start_pos_x), static_cast<int>(obj->m_start_pos_y) )].push_back( obj );
+
+			// destroyed objects can still be in the array
+			if( obj->m_level_num < 0 || obj->m_auto_destroy )
+			{
+				continue;
+			}
+
+			if( static_cast<unsigned int>(obj->m_level_num) >= m_numbered_objects.size() )
+			{
+				m_numbered_objects.resize( obj->m_level_num + 1, NULL );
+			}
+
+			m_numbered_objects[obj->m_level_num] = obj;
+		}
+	}
+
+	// Returns the object with the level file number or NULL if not created
+	cSprite *Get( int level_num, SpriteType type ) const
+	{
+		if( level_num < 0 || static_cast<unsigned int>(level_num) >= m_numbered_objects.size() )
+		{
+			return NULL;
+		}
+
+		cSprite *obj = m_numbered_objects[level_num];
+
+		if( !obj || obj->m_type != type )
+		{
+			return NULL;
+		}
+
+		return obj;
+	}
+
+	// Returns the first object of the type at the start position which is still there
+	cSprite *Get( int start_pos_x, int start_pos_y, SpriteType type ) const
+	{
+		Object_Map::const_iterator map_itr = m_objects.find( Get_Key( start_pos_x, start_pos_y ) );
+
+		if( map_itr == m_objects.end() )
+		{
+			return NULL;
+		}
+
+		for( cSprite_List::const_iterator itr = map_itr->second.begin(); itr != map_itr->second.end(); ++itr )
+		{
+			cSprite *obj = (*itr);
+
+			if( obj->m_type == type && static_cast<int>(obj->m_pos_x) == start_pos_x && static_cast<int>(obj->m_pos_y) == start_pos_y )
+			{
+				return obj;
+			}
+		}
+
+		return NULL;
+	}
+
+private:
+	static Uint64 Get_Key( int start_pos_x, int start_pos_y )
+	{
+		return ( static_cast<Uint64>(static_cast<Uint32>(start_pos_x)) << 32 ) | static_cast<Uint32>(start_pos_y);
+	}
+
+	cSprite_Manager *m_sprite_manager;
+	// objects in the manager order for every start position
+	typedef boost::unordered_map<Uint64, cSprite_List> Object_Map;
+	Object_Map m_objects;
+	// objects by their level file number
+	cSprite_List m_numbered_objects;
+};
+
 /* *** *** *** *** *** *** *** cSavegame *** *** *** *** *** *** *** *** *** *** */
 
 cSavegame :: cSavegame( void )
 {
 	m_savegame_dir = pResource_Manager->user_data_dir + USER_SAVEGAME_DIR;
+	m_writer = new cSavegame_Writer();
 }
 
 cSavegame :: ~cSavegame( void )
 {
-	//
+	delete m_writer;
 }
 
 int cSavegame :: Load_Game( unsigned int save_slot )
@@ -265,23 +483,19 @@ int cSavegame :: Load_Game( unsigned int save_slot )
 				continue;
 			}
 
+			// not loaded overworlds only save the changed access
+			overworld->Reset_Waypoints();
+
 			for( Save_Overworld_WaypointList::iterator wp_itr = save_overworld->m_waypoints.begin(); wp_itr != save_overworld->m_waypoints.end(); ++wp_itr )
 			{
 				// get savegame waypoint pointer
 				cSave_Overworld_Waypoint *save_waypoint = (*wp_itr);
 
-				// get overworld waypoint
-				cWaypoint *waypoint = overworld->Get_Waypoint( overworld->Get_Waypoint_Num( save_waypoint->m_destination ) );
-
-				// not found
-				if( !waypoint )
+				// set access
+				if( !overworld->Set_Waypoint_Access( save_waypoint->m_destination, save_waypoint->m_access ) )
 				{
 					printf( "Warning : Savegame %d : Overworld %s Waypoint %s not found\n", save_slot, save_overworld->m_name.c_str(), save_waypoint->m_destination.c_str() );
-					continue;
 				}
-
-				// set access
-				waypoint->Set_Access( save_waypoint->m_access );
 			}
 		}
 	}
@@ -368,22 +582,35 @@ int cSavegame :: Load_Game( unsigned int save_slot )
 
 				sprite->Set_Sprite_Manager( level->m_sprite_manager );
 				sprite->Set_Spawned( 1 );
-				level->m_sprite_manager->Add( sprite );
 			}
 
+			level->m_sprite_manager->Add_Objects( save_level->m_spawned_objects );
 			save_level->m_spawned_objects.clear();
 
+			// indexed once instead of searching all objects for every saved object
+			cSavegame_Object_Index object_index( level->m_sprite_manager );
+			// if the level file changed the numbers are not the same
+			const bool numbered = save_level->m_object_count && save_level->m_object_count == level->m_object_count;
+
 			// objects data
 			for( Save_Level_ObjectList::iterator itr = save_level->m_level_objects.begin(); itr != save_level->m_level_objects.end(); ++itr )
 			{
 				cSave_Level_Object *save_object = (*itr);
 
-				// get position
-				int posx = string_to_int( save_object->Get_Value( "posx" ) );
-				int posy = string_to_int( save_object->Get_Value( "posy" ) );
+				const int posx = save_object->m_posx;
+				const int posy = save_object->m_posy;
+				const bool use_num = numbered && save_object->m_level_num >= 0;
 
 				// get level object
-				cSprite *level_object = level->m_sprite_manager->Get_from_Position( posx, posy, save_object->m_type, 1 );
+				cSprite *level_object = use_num ? object_index.Get( save_object->m_level_num, save_object->m_type ) : object_index.Get( posx, posy, save_object->m_type );
+
+				// create it if streamed
+				if( !level_object && level->m_stream && level->m_stream->Load_Chunk_At( static_cast<float>(posx), static_cast<float>(posy) ) )
+				{
+					// the chunk objects can replace destroyed objects
+					object_index.Build();
+					level_object = use_num ? object_index.Get( save_object->m_level_num, save_object->m_type ) : object_index.Get( posx, posy, save_object->m_type );
+				}
 
 				// if not anymore available
 				if( !level_object )
@@ -464,8 +691,15 @@ bool cSavegame :: Save_Game( unsigned int save_slot, std::string description )
 					continue;
 				}
 
+				cSave_Level_Spawned_Object *save_obj = Savegame_Spawned_Object( obj );
+
+				if( !save_obj )
+				{
+					continue;
+				}
+
 				// add
-				save_level->m_spawned_objects.push_back( obj->Copy() );
+				save_level->m_spawned_object_data.push_back( save_obj );
 			}
 
 			// save object status
@@ -482,10 +716,36 @@ bool cSavegame :: Save_Game( unsigned int save_slot, std::string description )
 					continue;
 				}
 
+				save_obj->m_level_num = obj->m_level_num;
 				// add
 				save_level->m_level_objects.push_back( save_obj );
 			}
 
+			// the streamed objects which are not created
+			if( level->m_stream )
+			{
+				level->m_stream->Save_To_Savegame( save_level->m_level_objects );
+			}
+
+			// only the differences to the level start are saved
+			save_level->m_object_count = level->m_object_count;
+			Save_Level_ObjectList::iterator kept_itr = save_level->m_level_objects.begin();
+
+			for( Save_Level_ObjectList::iterator obj_itr = save_level->m_level_objects.begin(); obj_itr != save_level->m_level_objects.end(); ++obj_itr )
+			{
+				// not changed
+				if( level->Remove_Pristine( *obj_itr ) )
+				{
+					delete *obj_itr;
+					continue;
+				}
+
+				*kept_itr = *obj_itr;
+				++kept_itr;
+			}
+
+			save_level->m_level_objects.erase( kept_itr, save_level->m_level_objects.end() );
+
 			savegame->m_levels.push_back( save_level );
 		}
 	}
@@ -505,6 +765,22 @@ bool cSavegame :: Save_Game( unsigned int save_slot, std::string description )
 		// create Overworld
 		cSave_Overworld *save_overworld = new cSave_Overworld();
 		save_overworld->m_name = overworld->m_description->m_name;
+
+		// not loaded
+		if( !overworld->Is_Loaded() )
+		{
+			// the access kept while unloaded
+			for( WaypointAccessMap::const_iterator wp_itr = overworld->m_waypoint_access.begin(); wp_itr != overworld->m_waypoint_access.end(); ++wp_itr )
+			{
+				cSave_Overworld_Waypoint *save_waypoint = new cSave_Overworld_Waypoint();
+				save_waypoint->m_destination = wp_itr->first;
+				save_waypoint->m_access = wp_itr->second;
+				save_overworld->m_waypoints.push_back( save_waypoint );
+			}
+
+			savegame->m_overworlds.push_back( save_overworld );
+			continue;
+		}
 		
 		// Waypoints
 		for( cSprite_List::iterator wp_itr = overworld->m_sprite_manager->objects.begin(); wp_itr != overworld->m_sprite_manager->objects.end(); ++wp_itr )
@@ -548,6 +824,7 @@ bool cSavegame :: Save_Game( unsigned int save_slot, std::string description )
 		}
 	}
 
+	// written in the background
 	Save( save_slot, savegame );
 
 	if( pHud_Debug )
@@ -555,13 +832,14 @@ bool cSavegame :: Save_Game( unsigned int save_slot, std::string description )
 		pHud_Debug->Set_Text( _("Saved to Slot ") + int_to_string( save_slot ) );
 	}
 
-	delete savegame;
-
 	return 1;
 }
 
 cSave *cSavegame :: Load( unsigned int save_slot )
 {
+	// the file could be replaced
+	Wait();
+
 	std::string filename = m_savegame_dir + "/" + int_to_string( save_slot ) + ".smcsav";
 
 	// if not new format try the old
@@ -576,6 +854,60 @@ cSave *cSavegame :: Load( unsigned int save_slot )
 		return NULL;
 	}
 
+	cMapped_File file;
+
+	// binary format
+	if( file.Open( filename ) && Is_Savegame_Binary( file.Get_Data(), file.Get_Size() ) )
+	{
+		cSave *savegame = Savegame_Decode_Binary( file.Get_Data(), file.Get_Size() );
+		file.Close();
+
+		if( !savegame )
+		{
+			printf( "Error : cSavegame::Load : Savegame %s is not valid\n", filename.c_str() );
+			pHud_Debug->Set_Text( _("Savegame Loading failed : ") + filename );
+			return NULL;
+		}
+
+		// create the spawned objects like the XML format
+		for( Save_LevelList::iterator itr = savegame->m_levels.begin(); itr != savegame->m_levels.end(); ++itr )
+		{
+			cSave_Level *save_level = (*itr);
+
+			for( Save_Level_Spawned_ObjectList::iterator obj_itr = save_level->m_spawned_object_data.begin(); obj_itr != save_level->m_spawned_object_data.end(); ++obj_itr )
+			{
+				cSave_Level_Spawned_Object *save_obj = (*obj_itr);
+				CEGUI::XMLAttributes attributes;
+
+				for( Save_Level_Object_ProprtyList::iterator prop_itr = save_obj->m_properties.begin(); prop_itr != save_obj->m_properties.end(); ++prop_itr )
+				{
+					attributes.add( prop_itr->m_name, prop_itr->m_value );
+				}
+
+				cSprite *sprite = Create_Level_Object_From_XML( save_obj->m_element, attributes, savegame->m_level_engine_version, pActive_Level->m_sprite_manager );
+
+				if( sprite )
+				{
+					save_level->m_spawned_objects.push_back( sprite );
+				}
+
+				delete save_obj;
+			}
+
+			save_level->m_spawned_object_data.clear();
+		}
+
+		// if no description is set
+		if( savegame->m_description.empty() )
+		{
+			savegame->m_description = _("No Description");
+		}
+
+		return savegame;
+	}
+
+	file.Close();
+
 	cSavegame_XML_Handler *loader = new cSavegame_XML_Handler( filename );
 	cSave *savegame = loader->Acquire_Savegame();
 	delete loader;
@@ -583,43 +915,91 @@ cSave *cSavegame :: Load( unsigned int save_slot )
 	return savegame;
 }
 
-int cSavegame :: Save( unsigned int save_slot, cSave *savegame )
+bool cSavegame :: Load_Info( unsigned int save_slot, cSave_Info &info )
 {
+	// the file could be replaced
+	Wait();
+
 	const std::string filename = m_savegame_dir + "/" + int_to_string( save_slot ) + ".smcsav";
-	// remove old format savegame
-	Delete_File( m_savegame_dir + "/" + int_to_string( save_slot ) + ".save" );
+	cMapped_File file;
 
-// fixme : Check if there is a more portable way f.e. with imbue()
-#ifdef _WIN32
-	ofstream file( utf8_to_ucs2( filename ).c_str(), ios::out | ios::trunc );
-#else
-	ofstream file( filename.c_str(), ios::out | ios::trunc );
-#endif
+	// only the header of the binary format is read
+	if( file.Open( filename ) && Is_Savegame_Binary( file.Get_Data(), file.Get_Size() ) )
+	{
+		if( !Savegame_Decode_Binary_Info( file.Get_Data(), file.Get_Size(), info ) )
+		{
+			return 0;
+		}
+	}
+	// the XML format needs to be parsed completely
+	else
+	{
+		file.Close();
+		cSave *savegame = Load( save_slot );
 
-	
-	if( !file.is_open() )
+		if( !savegame )
+		{
+			return 0;
+		}
+
+		info.Set( savegame );
+		delete savegame;
+	}
+
+	// if no description is set
+	if( info.m_description.empty() )
 	{
-		printf( "Error : Couldn't open savegame file for saving. Is the file read-only ?" );
-		pHud_Debug->Set_Text( _("Couldn't save savegame ") + filename, speedfactor_fps * 5.0f );
-		return 0;
+		info.m_description = _("No Description");
+	}
+
+	return 1;
+}
+
+int cSavegame :: Save( unsigned int save_slot, cSave *savegame )
+{
+	const std::string filename = m_savegame_dir + "/" + int_to_string( save_slot ) + ".smcsav";
+	std::string xml_filename;
+
+	// readable export for debugging
+	if( game_debug )
+	{
+		xml_filename = filename + ".xml";
 	}
 
-	CEGUI::XMLSerializer stream( file );
+	// the old format savegame is removed when replaced
+	m_writer->Start( filename, savegame, m_savegame_dir + "/" + int_to_string( save_slot ) + ".save", xml_filename );
+
+	debug_print( "Saving savegame %s\n", filename.c_str() );
+
+	return 1;
+}
 
+void cSavegame :: Update( void )
+{
+	m_writer->Update();
+}
+
+void cSavegame :: Wait( void ) const
+{
+	m_writer->Wait();
+}
+
+void cSavegame :: Save_XML( cXml_Writer &stream, cSave *savegame )
+{
 	// begin
-	stream.openTag( "savegame" );
+	stream.Open_Tag( "savegame" );
 
 	// begin
-	stream.openTag( "information" );
+	stream.Open_Tag( "information" );
 		Write_Property( stream, "version", savegame->m_version );
 		Write_Property( stream, "level_engine_version", savegame->m_level_engine_version );
 		Write_Property( stream, "save_time", static_cast<Uint64>(savegame->m_save_time) );
 		Write_Property( stream, "description", savegame->m_description );
 	// end information
-	stream.closeTag();
+	stream.Close_Tag();
 
 	// begin
-	stream.openTag( "player" );
+	stream.Open_Tag( "player" );
 		Write_Property( stream, "lives", savegame->m_lives );
 		Write_Property( stream, "points", savegame->m_points );
 		Write_Property( stream, "goldpieces", savegame->m_goldpieces );
@@ -634,7 +1014,7 @@ int cSavegame :: Save( unsigned int save_slot, cSave *savegame )
 		Write_Property( stream, "overworld_active", savegame->m_overworld_active );
 		Write_Property( stream, "overworld_current_waypoint", savegame->m_overworld_current_waypoint );
 	// end player
-	stream.closeTag();
+	stream.Close_Tag();
 
 	// levels
 	for( Save_LevelList::iterator itr = savegame->m_levels.begin(); itr != savegame->m_levels.end(); ++itr )
@@ -642,7 +1022,7 @@ int cSavegame :: Save( unsigned int save_slot, cSave *savegame )
 		cSave_Level *level = (*itr);
 
 		// begin
-		stream.openTag( "level" );
+		stream.Open_Tag( "level" );
 
 		// name
 		Write_Property( stream, "level_name", level->m_name );
@@ -652,48 +1032,71 @@ int cSavegame :: Save( unsigned int save_slot, cSave *savegame )
 			Write_Property( stream, "player_posx", level->m_level_pos_x );
 			Write_Property( stream, "player_posy", level->m_level_pos_y );
 		}
+		// level file object count
+		if( level->m_object_count )
+		{
+			Write_Property( stream, "object_count", level->m_object_count );
+		}
 
 		// begin
-		stream.openTag( "spawned_objects" );
+		stream.Open_Tag( "spawned_objects" );
 
-		for( cSprite_List::iterator itr = level->m_spawned_objects.begin(); itr != level->m_spawned_objects.end(); ++itr )
+		for( Save_Level_Spawned_ObjectList::iterator itr = level->m_spawned_object_data.begin(); itr != level->m_spawned_object_data.end(); ++itr )
 		{
-			cSprite *obj = (*itr);
-			obj->Save_To_XML( stream );
+			cSave_Level_Spawned_Object *obj = (*itr);
+
+			// begin
+			stream.Open_Tag( obj->m_element );
+
+			for( Save_Level_Object_ProprtyList::iterator prop_itr = obj->m_properties.begin(); prop_itr != obj->m_properties.end(); ++prop_itr )
+			{
+				Write_Property( stream, prop_itr->m_name.c_str(), prop_itr->m_value );
+			}
+
+			// end object
+			stream.Close_Tag();
 		}
 
 		// end spawned_objects
-		stream.closeTag();
+		stream.Close_Tag();
 
 		// begin
-		stream.openTag( "objects_data" );
+		stream.Open_Tag( "objects_data" );
 
 		for( Save_Level_ObjectList::iterator itr = level->m_level_objects.begin(); itr != level->m_level_objects.end(); ++itr )
 		{
 			cSave_Level_Object *obj = (*itr);
 
 			// begin
-			stream.openTag( "object" );
+			stream.Open_Tag( "object" );
 
 			// type
 			Write_Property( stream, "type", obj->m_type );
+			// start position
+			Write_Property( stream, "posx", obj->m_posx );
+			Write_Property( stream, "posy", obj->m_posy );
+			// level file number
+			if( obj->m_level_num >= 0 )
+			{
+				Write_Property( stream, "level_num", obj->m_level_num );
+			}
 
 			// Properties
 			for( Save_Level_Object_ProprtyList::iterator prop_itr = obj->m_properties.begin(); prop_itr != obj->m_properties.end(); ++prop_itr )
 			{
 				cSave_Level_Object_Property Property = (*prop_itr);
-				Write_Property( stream, Property.m_name, Property.m_value );
+				Write_Property( stream, Property.m_name.c_str(), Property.m_value );
 			}
 
 			// end object
-			stream.closeTag();
+			stream.Close_Tag();
 		}
 
 		// end object_data
-		stream.closeTag();
+		stream.Close_Tag();
 
 		// end level
-		stream.closeTag();
+		stream.Close_Tag();
 	}
 
 	// Overworlds
@@ -702,7 +1105,7 @@ int cSavegame :: Save( unsigned int save_slot, cSave *savegame )
 		cSave_Overworld *overworld = (*itr);
 
 		// begin
-		stream.openTag( "overworld" );
+		stream.Open_Tag( "overworld" );
 
 		// name
 		Write_Property( stream, "name", overworld->m_name );
@@ -718,27 +1121,21 @@ int cSavegame :: Save( unsigned int save_slot, cSave *savegame )
 			}
 
 			// begin
-			stream.openTag( "waypoint" );
+			stream.Open_Tag( "waypoint" );
 
 			Write_Property( stream, "destination", overworld_waypoint->m_destination );
 			Write_Property( stream, "access", overworld_waypoint->m_access );
 
 			// end waypoint
-			stream.closeTag();
+			stream.Close_Tag();
 		}
 
 		// end overworld
-		stream.closeTag();
+		stream.Close_Tag();
 	}
 
 	// end savegame
-	stream.closeTag();
-
-	file.close();
-	
-	debug_print( "Saved savegame %s\n", filename.c_str() );
-	
-	return 1;
+	stream.Close_Tag();
 }
 
 std::string cSavegame :: Get_Description( unsigned int save_slot, bool only_description /* = 0 */ )
@@ -751,9 +1148,9 @@ std::string cSavegame :: Get_Description( unsigned int save_slot, bool only_desc
 		return str_description;
 	}
 	
-	cSave *savegame = Load( save_slot );
+	cSave_Info info;
 
-	if( !savegame )
+	if( !Load_Info( save_slot, info ) )
 	{
 		return "Savegame loading failed";
 	}
@@ -761,49 +1158,37 @@ std::string cSavegame :: Get_Description( unsigned int save_slot, bool only_desc
 	// complete description
 	if( !only_description )
 	{
-		str_description = int_to_string( save_slot ) + ". " + savegame->m_description;
+		str_description = int_to_string( save_slot ) + ". " + info.m_description;
 
-		if( savegame->m_levels.empty() )
+		if( !info.m_level_count )
+		{
+			str_description += " - " + info.m_overworld_active;
+		}
+		else if( !info.m_active_level.empty() )
 		{
-			str_description += " - " + savegame->m_overworld_active;
+			str_description += _(" -  Level ") + info.m_active_level;
 		}
 		else
 		{
-			bool found_active = 0;
-
-			for( Save_LevelList::iterator itr = savegame->m_levels.begin(); itr != savegame->m_levels.end(); ++itr )
-			{
-				cSave_Level *level = (*itr);
-
-				// if active level
-				if( !Is_Float_Equal( level->m_level_pos_x, 0.0f ) && !Is_Float_Equal( level->m_level_pos_y, 0.0f ) )
-				{
-					str_description += _(" -  Level ") + level->m_name;
-					found_active = 1;
-					break;
-				}
-			}
-			
-			if( !found_active )
-			{
-				str_description += _(" -  Unknown");
-			}
+			str_description += _(" -  Unknown");
 		}
 
-		str_description += _(" - Date ") + Time_to_String( savegame->m_save_time, "%Y-%m-%d  %H:%M:%S" );
+		str_description += _(" - Date ") + Time_to_String( info.m_save_time, "%Y-%m-%d  %H:%M:%S" );
 	}
 	// only the user description
 	else
 	{
-		str_description = savegame->m_description;
+		str_description = info.m_description;
 	}
 
-	delete savegame;
 	return str_description;
 }
 
 bool cSavegame :: Is_Valid( unsigned int save_slot ) const
 {
+	// a new file is created when the save finished
+	Wait();
+
 	return ( File_Exists( m_savegame_dir + "/" + int_to_string( save_slot ) + ".smcsav" ) || File_Exists( m_savegame_dir + "/" + int_to_string( save_slot ) + ".save" ) );
 }
 
@@ -835,12 +1220,7 @@ cSavegame_XML_Handler :: cSavegame_XML_Handler( const std::string &filename )
 
 	try
 	{
-	// fixme : Workaround for std::string to CEGUI::String utf8 conversion. Check again if CEGUI 0.8 works with std::string utf8
-	#ifdef _WIN32
-		CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, (const CEGUI::utf8*)filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/" + xsd_name, "" );
-	#else
-		CEGUI::System::getSingleton().getXMLParser()->parseXMLFile( *this, filename.c_str(), DATA_DIR "/" GAME_SCHEMA_DIR "/" + xsd_name, "" );
-	#endif
+		Parse_XML_File( *this, filename, xsd_name );
 	}
 	// catch CEGUI Exceptions
 	catch( CEGUI::Exception &ex )
@@ -960,6 +1340,7 @@ void cSavegame_XML_Handler :: Handle_Level( const CEGUI::XMLAttributes &attribut
 	save_level->m_name = m_xml_attributes.getValueAsString( "level_name" ).c_str();
 	save_level->m_level_pos_x = m_xml_attributes.getValueAsFloat( "player_posx" );
 	save_level->m_level_pos_y = m_xml_attributes.getValueAsFloat( "player_posy" );
+	save_level->m_object_count = m_xml_attributes.getValueAsInteger( "object_count", 0 );
 	// set level objects
 	save_level->m_level_objects.swap( m_level_objects );
 	// set level spawned objects
@@ -984,6 +1365,14 @@ void cSavegame_XML_Handler :: Handle_Level_Object( const CEGUI::XMLAttributes &a
 	// type
 	object->m_type = static_cast<SpriteType>(type);
 	m_xml_attributes.remove( "type" );
+	// start position
+	object->m_posx = m_xml_attributes.getValueAsInteger( "posx" );
+	object->m_posy = m_xml_attributes.getValueAsInteger( "posy" );
+	m_xml_attributes.remove( "posx" );
+	m_xml_attributes.remove( "posy" );
+	// level file number
+	object->m_level_num = m_xml_attributes.getValueAsInteger( "level_num", -1 );
+	m_xml_attributes.remove( "level_num" );
 
 
 	// Get properties
@@ -993,7 +1382,7 @@ void cSavegame_XML_Handler :: Handle_Level_Object( const CEGUI::XMLAttributes &a
 		std::string property_name = m_xml_attributes.getName( i ).c_str();
 
 		// ignore level attributes
-		if( property_name.compare( "level_name" ) == 0 || property_name.compare( "player_posx" ) == 0 || property_name.compare( "player_posy" ) == 0 )
+		if( property_name.compare( "level_name" ) == 0 || property_name.compare( "player_posx" ) == 0 || property_name.compare( "player_posy" ) == 0 || property_name.compare( "object_count" ) == 0 )
 		{
 			continue;
 		}
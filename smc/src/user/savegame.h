@@ -20,6 +20,7 @@
 // CEGUI
 #include "CEGUIXMLHandler.h"
 #include "CEGUIXMLAttributes.h"
+#include <ostream>
 
 namespace SMC
 {
@@ -82,18 +83,41 @@ public:
 	~cSave_Level_Object( void );
 
 	// Check if property exists
-	bool exists( const std::string &val_name );
+	bool exists( const std::string &val_name ) const;
 
 	// Returns the value
-	std::string Get_Value( const std::string &val_name );
+	std::string Get_Value( const std::string &val_name ) const;
 
 	SpriteType m_type;
+	// start position used to find the object if the level file changed
+	int m_posx;
+	int m_posy;
+	// object number in the level file or -1 if unknown
+	int m_level_num;
+
+	/* object properties
+	 * the properties with the value from the level start are not saved
+	*/
+	Save_Level_Object_ProprtyList m_properties;
+};
+
+typedef vector<cSave_Level_Object *> Save_Level_ObjectList;
+
+/* *** *** *** *** *** *** *** cSave_Level_Spawned_Object *** *** *** *** *** *** *** *** *** *** */
+/* Spawned level object save data
+ * the XML element and properties to recreate the object
+*/
+class cSave_Level_Spawned_Object
+{
+public:
+	// XML element name
+	std::string m_element;
 
 	// object properties
 	Save_Level_Object_ProprtyList m_properties;
 };
 
-typedef vector<cSave_Level_Object *> Save_Level_ObjectList;
+typedef vector<cSave_Level_Spawned_Object *> Save_Level_Spawned_ObjectList;
 
 /* *** *** *** *** *** *** *** cSave_Level *** *** *** *** *** *** *** *** *** *** */
 // Level save data
@@ -107,11 +131,17 @@ public:
 	// player position is only set if level is the active one
 	float m_level_pos_x;
 	float m_level_pos_y;
+	/* number of objects in the level file
+	 * if it changed the objects are found by their start position instead of their number
+	*/
+	unsigned int m_object_count;
 
 	// objects data
 	Save_Level_ObjectList m_level_objects;
 	// spawned objects
 	cSprite_List m_spawned_objects;
+	// spawned objects data for writing and from the binary format
+	Save_Level_Spawned_ObjectList m_spawned_object_data;
 };
 
 typedef vector<cSave_Level *> Save_LevelList;
@@ -167,6 +197,32 @@ public:
 	Save_OverworldList m_overworlds;
 };
 
+/* *** *** *** *** *** *** *** cSave_Info *** *** *** *** *** *** *** *** *** *** */
+/* Save information shown in the menus
+ * the binary format stores it at the start to read it without the savegame data
+*/
+class cSave_Info
+{
+public:
+	cSave_Info( void );
+
+	// Set the information of the Save
+	void Set( const cSave *savegame );
+
+	// savegame version
+	int m_version;
+	// time ( seconds since 1970 )
+	time_t m_save_time;
+	// description
+	std::string m_description;
+	// number of saved levels
+	unsigned int m_level_count;
+	// level with the player position or empty if not found
+	std::string m_active_level;
+	// active overworld
+	std::string m_overworld_active;
+};
+
 /* *** *** *** *** *** *** *** cSavegame *** *** *** *** *** *** *** *** *** *** */
 
 class cSavegame
@@ -190,8 +246,22 @@ public:
 	* The returned object should be deleted if not used anymore
 	*/
 	cSave *Load( unsigned int save_slot );
-	// Save a Save
+	/* Load only the Save information
+	* Returns false if failed
+	*/
+	bool Load_Info( unsigned int save_slot, cSave_Info &info );
+	/* Save a Save
+	* It is written in the binary format in the background and deleted afterwards
+	* In debug mode it is also exported as XML
+	*/
 	int Save( unsigned int save_slot, cSave *savegame );
+	// Show the result if the background save finished
+	void Update( void );
+	// Wait until the background save finished
+	void Wait( void ) const;
+
+	// Write the Save as XML
+	static void Save_XML( cXml_Writer &stream, cSave *savegame );
 
 	// Returns only the Savegame description
 	std::string Get_Description( unsigned int save_slot, bool only_description = 0 );
@@ -201,6 +271,10 @@ public:
 
 	// savegame directory
 	std::string m_savegame_dir;
+
+private:
+	// background writing
+	cSavegame_Writer *m_writer;
 };
 
 /* *** *** *** *** *** *** *** cSavegame_XML_Handler *** *** *** *** *** *** *** *** *** *** */
@@ -0,0 +1,560 @@
+/***************************************************************************
+ * savegame_binary.cpp  -  binary savegame format
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../user/savegame_binary.h"
+#include "../user/savegame.h"
+#include "../core/property_helper.h"
+#include <cstring>
+#include <cstdio>
+#include <map>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** File *** *** *** *** *** *** *** *** *** *** */
+
+// file identification and format version
+static const char savegame_binary_magic[4] = { 'S', 'M', 'C', 'S' };
+static const Uint32 savegame_binary_version = 4;
+
+/* *** *** *** *** *** *** *** cSavegame_Binary_Writer *** *** *** *** *** *** *** *** *** *** */
+
+// Writes the savegame data and collects the used strings
+class cSavegame_Binary_Writer
+{
+public:
+	void Write_Uint8( Uint8 val )
+	{
+		m_data.push_back( static_cast<char>(val) );
+	}
+
+	void Write_Uint32( Uint32 val )
+	{
+		for( unsigned int i = 0; i < 4; i++ )
+		{
+			Write_Uint8( static_cast<Uint8>( val >> ( i * 8 ) ) );
+		}
+	}
+
+	void Write_Uint64( Uint64 val )
+	{
+		Write_Uint32( static_cast<Uint32>(val) );
+		Write_Uint32( static_cast<Uint32>( val >> 32 ) );
+	}
+
+	void Write_Float( float val )
+	{
+		Uint32 bits;
+		memcpy( &bits, &val, sizeof( Uint32 ) );
+		Write_Uint32( bits );
+	}
+
+	// Write the string length and data
+	void Write_String_Data( const std::string &str )
+	{
+		Write_Uint32( static_cast<Uint32>(str.length()) );
+		m_data.append( str );
+	}
+
+	// Write the string number
+	void Write_String( const std::string &str )
+	{
+		std::map<std::string, Uint32>::iterator itr = m_string_numbers.find( str );
+
+		if( itr == m_string_numbers.end() )
+		{
+			itr = m_string_numbers.insert( std::make_pair( str, static_cast<Uint32>(m_strings.size()) ) ).first;
+			m_strings.push_back( &itr->first );
+		}
+
+		Write_Uint32( itr->second );
+	}
+
+	void Write_Properties( const Save_Level_Object_ProprtyList &properties )
+	{
+		Write_Uint32( static_cast<Uint32>(properties.size()) );
+
+		for( Save_Level_Object_ProprtyList::const_iterator itr = properties.begin(); itr != properties.end(); ++itr )
+		{
+			Write_String( itr->m_name );
+			Write_String( itr->m_value );
+		}
+	}
+
+	/* Returns the header and the string table followed by the written data
+	 * info : the information written after the header
+	*/
+	void Finish( std::string &file_data, const cSavegame_Binary_Writer &info )
+	{
+		cSavegame_Binary_Writer header;
+		header.m_data.append( savegame_binary_magic, 4 );
+		header.Write_Uint32( savegame_binary_version );
+		header.Write_Uint32( static_cast<Uint32>(info.m_data.size()) );
+		header.m_data.append( info.m_data );
+		header.Write_Uint32( static_cast<Uint32>(m_strings.size()) );
+
+		for( vector<const std::string *>::const_iterator itr = m_strings.begin(); itr != m_strings.end(); ++itr )
+		{
+			header.Write_String_Data( **itr );
+		}
+
+		file_data.swap( header.m_data );
+		file_data.append( m_data );
+	}
+
+	// written data
+	std::string m_data;
+	// number of every written string
+	std::map<std::string, Uint32> m_string_numbers;
+	// strings in the number order
+	vector<const std::string *> m_strings;
+};
+
+/* *** *** *** *** *** *** *** cSavegame_Binary_Reader *** *** *** *** *** *** *** *** *** *** */
+
+// Reads the savegame data and stops at the first invalid value
+class cSavegame_Binary_Reader
+{
+public:
+	cSavegame_Binary_Reader( const char *data, size_t size )
+	{
+		m_pos = reinterpret_cast<const Uint8 *>(data);
+		m_end = m_pos + size;
+		m_valid = 1;
+	}
+
+	Uint8 Read_Uint8( void )
+	{
+		if( !m_valid || m_pos >= m_end )
+		{
+			m_valid = 0;
+			return 0;
+		}
+
+		return *m_pos++;
+	}
+
+	Uint32 Read_Uint32( void )
+	{
+		if( !m_valid || m_end - m_pos < 4 )
+		{
+			m_valid = 0;
+			return 0;
+		}
+
+		const Uint32 val = m_pos[0] | ( m_pos[1] << 8 ) | ( m_pos[2] << 16 ) | ( static_cast<Uint32>(m_pos[3]) << 24 );
+		m_pos += 4;
+
+		return val;
+	}
+
+	Uint64 Read_Uint64( void )
+	{
+		const Uint64 low = Read_Uint32();
+		const Uint64 high = Read_Uint32();
+
+		return low | ( high << 32 );
+	}
+
+	float Read_Float( void )
+	{
+		const Uint32 bits = Read_Uint32();
+		float val;
+		memcpy( &val, &bits, sizeof( float ) );
+
+		return val;
+	}
+
+	/* Read an entry count
+	 * every entry uses at least one number which limits the count to the remaining data
+	*/
+	Uint32 Read_Count( void )
+	{
+		const Uint32 count = Read_Uint32();
+
+		if( count > static_cast<size_t>( m_end - m_pos ) / 4 )
+		{
+			m_valid = 0;
+			return 0;
+		}
+
+		return count;
+	}
+
+	// Read the string length and data
+	std::string Read_String_Data( void )
+	{
+		const Uint32 length = Read_Uint32();
+
+		if( !m_valid || length > static_cast<size_t>( m_end - m_pos ) )
+		{
+			m_valid = 0;
+			return "";
+		}
+
+		const char *str = reinterpret_cast<const char *>(m_pos);
+		m_pos += length;
+
+		return std::string( str, length );
+	}
+
+	// Skip the data
+	void Skip( Uint32 size )
+	{
+		if( !m_valid || size > static_cast<size_t>( m_end - m_pos ) )
+		{
+			m_valid = 0;
+			return;
+		}
+
+		m_pos += size;
+	}
+
+	// Read the string table
+	void Read_Strings( void )
+	{
+		const Uint32 count = Read_Count();
+		m_strings.resize( count );
+
+		for( Uint32 i = 0; i < count && m_valid; i++ )
+		{
+			m_strings[i] = Read_String_Data();
+		}
+	}
+
+	// Read a string number
+	const std::string &Read_String( void )
+	{
+		static const std::string empty_string;
+		const Uint32 num = Read_Uint32();
+
+		if( !m_valid || num >= m_strings.size() )
+		{
+			m_valid = 0;
+			return empty_string;
+		}
+
+		return m_strings[num];
+	}
+
+	void Read_Properties( Save_Level_Object_ProprtyList &properties )
+	{
+		const Uint32 count = Read_Count();
+
+		for( Uint32 i = 0; i < count && m_valid; i++ )
+		{
+			const std::string &name = Read_String();
+			properties.push_back( cSave_Level_Object_Property( name, Read_String() ) );
+		}
+	}
+
+	const Uint8 *m_pos;
+	const Uint8 *m_end;
+	// if no value was invalid
+	bool m_valid;
+	// string table
+	vector<std::string> m_strings;
+};
+
+/* *** *** *** *** *** *** *** Binary Savegame *** *** *** *** *** *** *** *** *** *** */
+
+bool Is_Savegame_Binary( const char *data, size_t size )
+{
+	return size >= 4 && memcmp( data, savegame_binary_magic, 4 ) == 0;
+}
+
+void Savegame_Encode_Binary( const cSave *savegame, std::string &data )
+{
+	// information for the menus
+	cSave_Info save_info;
+	save_info.Set( savegame );
+
+	cSavegame_Binary_Writer info;
+	info.Write_Uint32( save_info.m_version );
+	info.Write_Uint64( static_cast<Uint64>(save_info.m_save_time) );
+	info.Write_Uint32( save_info.m_level_count );
+	info.Write_String_Data( save_info.m_description );
+	info.Write_String_Data( save_info.m_active_level );
+	info.Write_String_Data( save_info.m_overworld_active );
+
+	cSavegame_Binary_Writer writer;
+
+	// information
+	writer.Write_Uint32( savegame->m_version );
+	writer.Write_Uint32( savegame->m_level_engine_version );
+	writer.Write_Uint64( static_cast<Uint64>(savegame->m_save_time) );
+	writer.Write_String( savegame->m_description );
+
+	// player
+	writer.Write_Uint32( savegame->m_lives );
+	writer.Write_Uint64( static_cast<Uint64>(savegame->m_points) );
+	writer.Write_Uint32( savegame->m_goldpieces );
+	writer.Write_Uint32( savegame->m_player_type );
+	writer.Write_Uint32( savegame->m_player_state );
+	writer.Write_Uint32( savegame->m_itembox_item );
+	writer.Write_Uint32( savegame->m_level_time );
+	writer.Write_String( savegame->m_overworld_active );
+	writer.Write_Uint32( savegame->m_overworld_current_waypoint );
+
+	// levels
+	writer.Write_Uint32( static_cast<Uint32>(savegame->m_levels.size()) );
+
+	for( Save_LevelList::const_iterator itr = savegame->m_levels.begin(); itr != savegame->m_levels.end(); ++itr )
+	{
+		const cSave_Level *level = (*itr);
+
+		writer.Write_String( level->m_name );
+		writer.Write_Float( level->m_level_pos_x );
+		writer.Write_Float( level->m_level_pos_y );
+		writer.Write_Uint32( level->m_object_count );
+
+		writer.Write_Uint32( static_cast<Uint32>(level->m_spawned_object_data.size()) );
+
+		for( Save_Level_Spawned_ObjectList::const_iterator obj_itr = level->m_spawned_object_data.begin(); obj_itr != level->m_spawned_object_data.end(); ++obj_itr )
+		{
+			writer.Write_String( (*obj_itr)->m_element );
+			writer.Write_Properties( (*obj_itr)->m_properties );
+		}
+
+		writer.Write_Uint32( static_cast<Uint32>(level->m_level_objects.size()) );
+
+		for( Save_Level_ObjectList::const_iterator obj_itr = level->m_level_objects.begin(); obj_itr != level->m_level_objects.end(); ++obj_itr )
+		{
+			writer.Write_Uint32( (*obj_itr)->m_type );
+			writer.Write_Uint32( static_cast<Uint32>((*obj_itr)->m_posx) );
+			writer.Write_Uint32( static_cast<Uint32>((*obj_itr)->m_posy) );
+			writer.Write_Uint32( static_cast<Uint32>((*obj_itr)->m_level_num) );
+			writer.Write_Properties( (*obj_itr)->m_properties );
+		}
+	}
+
+	// overworlds
+	writer.Write_Uint32( static_cast<Uint32>(savegame->m_overworlds.size()) );
+
+	for( Save_OverworldList::const_iterator itr = savegame->m_overworlds.begin(); itr != savegame->m_overworlds.end(); ++itr )
+	{
+		const cSave_Overworld *overworld = (*itr);
+
+		writer.Write_String( overworld->m_name );
+		writer.Write_Uint32( static_cast<Uint32>(overworld->m_waypoints.size()) );
+
+		for( Save_Overworld_WaypointList::const_iterator wp_itr = overworld->m_waypoints.begin(); wp_itr != overworld->m_waypoints.end(); ++wp_itr )
+		{
+			writer.Write_String( (*wp_itr)->m_destination );
+			writer.Write_Uint8( (*wp_itr)->m_access );
+		}
+	}
+
+	writer.Finish( data, info );
+}
+
+bool Savegame_Decode_Binary_Info( const char *data, size_t size, cSave_Info &info )
+{
+	if( !Is_Savegame_Binary( data, size ) )
+	{
+		return 0;
+	}
+
+	cSavegame_Binary_Reader reader( data + 4, size - 4 );
+
+	const Uint32 version = reader.Read_Uint32();
+
+	// no information before version 3
+	if( version < 3 )
+	{
+		cSave *savegame = Savegame_Decode_Binary( data, size );
+
+		if( !savegame )
+		{
+			return 0;
+		}
+
+		info.Set( savegame );
+		delete savegame;
+
+		return 1;
+	}
+
+	if( version > savegame_binary_version )
+	{
+		printf( "Warning : Binary savegame format version %d is not supported\n", version );
+		return 0;
+	}
+
+	reader.Read_Uint32();
+
+	info.m_version = reader.Read_Uint32();
+	info.m_save_time = static_cast<time_t>(reader.Read_Uint64());
+	info.m_level_count = reader.Read_Uint32();
+	info.m_description = reader.Read_String_Data();
+	info.m_active_level = reader.Read_String_Data();
+	info.m_overworld_active = reader.Read_String_Data();
+
+	return reader.m_valid;
+}
+
+cSave *Savegame_Decode_Binary( const char *data, size_t size )
+{
+	if( !Is_Savegame_Binary( data, size ) )
+	{
+		return NULL;
+	}
+
+	cSavegame_Binary_Reader reader( data + 4, size - 4 );
+
+	const Uint32 version = reader.Read_Uint32();
+
+	// version 1 has the object position in the properties
+	if( version < 1 || version > savegame_binary_version )
+	{
+		printf( "Warning : Binary savegame format version %d is not supported\n", version );
+		return NULL;
+	}
+
+	// information
+	if( version >= 3 )
+	{
+		reader.Skip( reader.Read_Uint32() );
+	}
+
+	reader.Read_Strings();
+
+	cSave *savegame = new cSave();
+
+	// information
+	savegame->m_version = reader.Read_Uint32();
+	savegame->m_level_engine_version = reader.Read_Uint32();
+	savegame->m_save_time = static_cast<time_t>(reader.Read_Uint64());
+	savegame->m_description = reader.Read_String();
+
+	// player
+	savegame->m_lives = reader.Read_Uint32();
+	savegame->m_points = static_cast<long>(reader.Read_Uint64());
+	savegame->m_goldpieces = reader.Read_Uint32();
+	savegame->m_player_type = reader.Read_Uint32();
+	savegame->m_player_state = reader.Read_Uint32();
+	savegame->m_itembox_item = reader.Read_Uint32();
+	savegame->m_level_time = reader.Read_Uint32();
+	savegame->m_overworld_active = reader.Read_String();
+	savegame->m_overworld_current_waypoint = reader.Read_Uint32();
+
+	// levels
+	const Uint32 level_count = reader.Read_Count();
+
+	for( Uint32 i = 0; i < level_count && reader.m_valid; i++ )
+	{
+		cSave_Level *level = new cSave_Level();
+		savegame->m_levels.push_back( level );
+
+		level->m_name = reader.Read_String();
+		level->m_level_pos_x = reader.Read_Float();
+		level->m_level_pos_y = reader.Read_Float();
+
+		// version 4 saves only the changes to the level start
+		if( version >= 4 )
+		{
+			level->m_object_count = reader.Read_Uint32();
+		}
+
+		const Uint32 spawned_count = reader.Read_Count();
+
+		for( Uint32 j = 0; j < spawned_count && reader.m_valid; j++ )
+		{
+			cSave_Level_Spawned_Object *obj = new cSave_Level_Spawned_Object();
+			level->m_spawned_object_data.push_back( obj );
+
+			obj->m_element = reader.Read_String();
+			reader.Read_Properties( obj->m_properties );
+		}
+
+		const Uint32 object_count = reader.Read_Count();
+
+		for( Uint32 j = 0; j < object_count && reader.m_valid; j++ )
+		{
+			cSave_Level_Object *obj = new cSave_Level_Object();
+			level->m_level_objects.push_back( obj );
+
+			obj->m_type = static_cast<SpriteType>(reader.Read_Uint32());
+
+			if( version >= 2 )
+			{
+				obj->m_posx = static_cast<int>(reader.Read_Uint32());
+				obj->m_posy = static_cast<int>(reader.Read_Uint32());
+
+				if( version >= 4 )
+				{
+					obj->m_level_num = static_cast<int>(reader.Read_Uint32());
+				}
+
+				reader.Read_Properties( obj->m_properties );
+				continue;
+			}
+
+			Save_Level_Object_ProprtyList properties;
+			reader.Read_Properties( properties );
+
+			for( Save_Level_Object_ProprtyList::const_iterator prop_itr = properties.begin(); prop_itr != properties.end(); ++prop_itr )
+			{
+				if( prop_itr->m_name == "posx" )
+				{
+					obj->m_posx = string_to_int( prop_itr->m_value );
+				}
+				else if( prop_itr->m_name == "posy" )
+				{
+					obj->m_posy = string_to_int( prop_itr->m_value );
+				}
+				else
+				{
+					obj->m_properties.push_back( *prop_itr );
+				}
+			}
+		}
+	}
+
+	// overworlds
+	const Uint32 overworld_count = reader.Read_Count();
+
+	for( Uint32 i = 0; i < overworld_count && reader.m_valid; i++ )
+	{
+		cSave_Overworld *overworld = new cSave_Overworld();
+		savegame->m_overworlds.push_back( overworld );
+
+		overworld->m_name = reader.Read_String();
+
+		const Uint32 waypoint_count = reader.Read_Count();
+
+		for( Uint32 j = 0; j < waypoint_count && reader.m_valid; j++ )
+		{
+			cSave_Overworld_Waypoint *waypoint = new cSave_Overworld_Waypoint();
+			overworld->m_waypoints.push_back( waypoint );
+
+			waypoint->m_destination = reader.Read_String();
+			waypoint->m_access = reader.Read_Uint8() != 0;
+		}
+	}
+
+	if( !reader.m_valid )
+	{
+		printf( "Warning : Binary savegame data is not valid\n" );
+		delete savegame;
+		return NULL;
+	}
+
+	return savegame;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,53 @@
+/***************************************************************************
+ * savegame_binary.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_SAVEGAME_BINARY_H
+#define SMC_SAVEGAME_BINARY_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** Binary Savegame *** *** *** *** *** *** *** *** *** *** */
+
+/* The binary savegame starts with an identification and format version header
+ * and the Save information for the menus
+ * followed by a table of every used string and the savegame data referencing them by number
+ * the values are little endian to keep savegames portable between systems
+*/
+
+// Returns true if the data starts with the binary savegame header
+bool Is_Savegame_Binary( const char *data, size_t size );
+/* Encode the Save into the binary format
+ * thread safe as it only reads the Save
+*/
+void Savegame_Encode_Binary( const cSave *savegame, std::string &data );
+/* Decode a binary savegame
+ * the spawned objects are only set as data
+ * returns NULL if the data is not valid
+*/
+cSave *Savegame_Decode_Binary( const char *data, size_t size );
+/* Decode only the Save information of a binary savegame
+ * returns false if the data is not valid
+*/
+bool Savegame_Decode_Binary_Info( const char *data, size_t size, cSave_Info &info );
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -0,0 +1,178 @@
+/***************************************************************************
+ * savegame_writer.cpp  -  background writing of savegames
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../user/savegame_writer.h"
+#include "../user/savegame.h"
+#include "../user/savegame_binary.h"
+#include "../core/game_core.h"
+#include "../core/i18n.h"
+#include "../core/filesystem/filesystem.h"
+#include "../gui/hud.h"
+#include "../core/task_pool.h"
+// boost
+#include <boost/bind.hpp>
+#include <cstdio>
+#include <sstream>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** Savegame file *** *** *** *** *** *** *** *** *** *** */
+
+/* Write the data to a temporary file which replaces the file when complete
+ * returns false if the file was not replaced
+*/
+static bool Savegame_Write_File( const std::string &filename, const std::string &data )
+{
+	const std::string temp_filename = filename + ".tmp";
+
+#ifdef _WIN32
+	FILE *fp = _wfopen( utf8_to_ucs2( temp_filename ).c_str(), L"wb" );
+#else
+	FILE *fp = fopen( temp_filename.c_str(), "wb" );
+#endif
+
+	if( !fp )
+	{
+		return 0;
+	}
+
+	bool success = data.empty() || fwrite( data.data(), data.size(), 1, fp ) == 1;
+	success = fflush( fp ) == 0 && success;
+	success = fclose( fp ) == 0 && success;
+
+	if( success )
+	{
+		success = Rename_File( temp_filename, filename );
+	}
+
+	if( !success )
+	{
+		Delete_File( temp_filename );
+	}
+
+	return success;
+}
+
+/* *** *** *** *** *** *** *** cSavegame_Writer *** *** *** *** *** *** *** *** *** *** */
+
+cSavegame_Writer :: cSavegame_Writer( void )
+{
+	m_savegame = NULL;
+	m_saving = 0;
+	m_success = 0;
+	m_thread_finished = 1;
+	m_task_group = pTask_Pool->Create_Group();
+}
+
+cSavegame_Writer :: ~cSavegame_Writer( void )
+{
+	// never lose a save
+	pTask_Pool->Wait( m_task_group );
+
+	if( m_savegame )
+	{
+		delete m_savegame;
+	}
+}
+
+void cSavegame_Writer :: Start( const std::string &filename, cSave *savegame, const std::string &old_filename /* = "" */, const std::string &xml_filename /* = "" */ )
+{
+	Wait();
+
+	m_filename = filename;
+	m_old_filename = old_filename;
+	m_xml_filename = xml_filename;
+	m_savegame = savegame;
+	m_success = 0;
+	m_saving = 1;
+	m_thread_finished = 0;
+	pTask_Pool->Add( boost::bind( &cSavegame_Writer::Save_Thread, this ), TASK_PRIORITY_BACKGROUND, m_task_group, "savegame write" );
+}
+
+void cSavegame_Writer :: Update( void )
+{
+	if( !m_saving || !Is_Thread_Finished() )
+	{
+		return;
+	}
+
+	Finish();
+}
+
+void cSavegame_Writer :: Wait( void )
+{
+	if( !m_saving )
+	{
+		return;
+	}
+
+	Finish();
+}
+
+void cSavegame_Writer :: Save_Thread( void )
+{
+	std::string data;
+	Savegame_Encode_Binary( m_savegame, data );
+
+	bool success = Savegame_Write_File( m_filename, data );
+
+	// the file in the other format would be used instead
+	if( success && !m_old_filename.empty() )
+	{
+		Delete_File( m_old_filename );
+	}
+
+	// only for debugging
+	if( success && !m_xml_filename.empty() )
+	{
+		cXml_Writer xml_data;
+		cSavegame::Save_XML( xml_data, m_savegame );
+
+		if( !Savegame_Write_File( m_xml_filename, xml_data.Get_Data() ) )
+		{
+			printf( "Warning : Couldn't export savegame %s\n", m_xml_filename.c_str() );
+		}
+	}
+
+	boost::mutex::scoped_lock lock( m_mutex );
+	m_success = success;
+	m_thread_finished = 1;
+}
+
+bool cSavegame_Writer :: Is_Thread_Finished( void )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+	return m_thread_finished;
+}
+
+void cSavegame_Writer :: Finish( void )
+{
+	pTask_Pool->Wait( m_task_group );
+	m_saving = 0;
+
+	delete m_savegame;
+	m_savegame = NULL;
+
+	if( !m_success )
+	{
+		printf( "Error : Couldn't write savegame file %s. Is the file read-only ?\n", m_filename.c_str() );
+		pHud_Debug->Set_Text( _("Couldn't save savegame ") + m_filename, speedfactor_fps * 5.0f );
+	}
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,90 @@
+/***************************************************************************
+ * savegame_writer.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_SAVEGAME_WRITER_H
+#define SMC_SAVEGAME_WRITER_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+// boost thread
+#include <boost/thread/mutex.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cSavegame_Writer *** *** *** *** *** *** *** *** *** *** */
+
+/* Writes savegames in the background
+ * the Save is created on the main thread and encoded with a task of the task pool
+ * into a temporary file which replaces the savegame file when complete
+ * a failure is shown on the HUD with the next update
+*/
+class cSavegame_Writer
+{
+public:
+	cSavegame_Writer( void );
+	~cSavegame_Writer( void );
+
+	/* Start writing the Save in the binary format
+	 * waits for the previous save to finish
+	 * savegame : taken and deleted when written
+	 * old_filename : if set this file is deleted after the save as it is replaced by the new file
+	 * xml_filename : if set the Save is also exported as XML to this file
+	*/
+	void Start( const std::string &filename, cSave *savegame, const std::string &old_filename = "", const std::string &xml_filename = "" );
+	// Show the result if the save finished
+	void Update( void );
+	// Wait until the save finished and show the result
+	void Wait( void );
+
+	// Returns true if a save is not yet finished
+	inline bool Is_Saving( void ) const
+	{
+		return m_saving;
+	}
+
+private:
+	// Encode and write the Save with the task
+	void Save_Thread( void );
+	// Returns true if the task is finished
+	bool Is_Thread_Finished( void );
+	// Show the result on the HUD
+	void Finish( void );
+
+	// full savegame filename
+	std::string m_filename;
+	// replaced savegame filename
+	std::string m_old_filename;
+	// XML export filename
+	std::string m_xml_filename;
+	// written Save
+	cSave *m_savegame;
+	// if a save was started and the result is not yet shown
+	bool m_saving;
+	// if the file was replaced
+	bool m_success;
+
+	// task pool group of the save task
+	unsigned int m_task_group;
+	boost::mutex m_mutex;
+	// if the task is finished
+	bool m_thread_finished;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -18,10 +18,13 @@
 #include "../core/game_core.h"
 #include "../video/gl_surface.h"
 #include "../video/renderer.h"
+#include "../video/particle_shader.h"
 #include "../core/math/utilities.h"
 #include "../core/i18n.h"
 #include "../core/filesystem/filesystem.h"
 #include "../input/mouse.h"
+#include "../core/update_workers.h"
+#include "../user/preferences.h"
 // CEGUI
 #include "CEGUIXMLAttributes.h"
 #include "CEGUIWindowManager.h"
@@ -29,6 +32,18 @@
 #include "elements/CEGUICheckbox.h"
 #include "elements/CEGUICombobox.h"
 #include "elements/CEGUIListboxTextItem.h"
+// boost
+#include <boost/bind.hpp>
+// for std::fill
+#include <algorithm>
+
+#if defined(__SSE__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 1 )
+	#define SMC_PARTICLE_SSE
+	#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+	#define SMC_PARTICLE_NEON
+	#include <arm_neon.h>
+#endif
 
 namespace SMC
 {
@@ -94,427 +109,518 @@ void cAnimation :: Set_Pos_Z( float pos, float pos_rand /* = 0.0f */ )
 	m_pos_z_rand = pos_rand;
 }
 
-/* *** *** *** *** *** *** *** cAnimation_Goldpiece *** *** *** *** *** *** *** *** *** *** */
+/* *** *** *** *** *** *** *** cAnimation_Effect_Store *** *** *** *** *** *** *** *** *** *** */
 
-cAnimation_Goldpiece :: cAnimation_Goldpiece( cSprite_Manager *sprite_manager, float posx, float posy, float height /* = 40.0f */, float width /* = 20.0f */ )
-: cAnimation( sprite_manager )
+// image of every blinking point pattern in the 4 time steps of 3 frames
+static const Uint8 blink_pattern_images[4][4] =
 {
-	Add_Image( pVideo->Get_Surface( "animation/light_1/1.png" ) );
-	Add_Image( pVideo->Get_Surface( "animation/light_1/2.png" ) );
-	Add_Image( pVideo->Get_Surface( "animation/light_1/3.png" ) );
-
-	Set_Pos( posx, posy, 1 );
-	m_rect.m_w = width;
-	m_rect.m_h = height;
+	{ 0, 0, 1, 0 },
+	{ 0, 1, 2, 1 },
+	{ 1, 2, 0, 0 },
+	{ 0, 1, 0, 0 }
+};
 
-	for( unsigned int i = 0; i < 4; i++ )
+// Add a quad from the top left position with the scaled image size
+static inline void Effect_Add_Quad( cQuad_Stream_Request *request, const cGL_Surface *image, float x, float y, float z, float scale )
+{
+	const float w = image->m_start_w * scale;
+	const float h = image->m_start_h * scale;
+	const GLfloat corners[12] =
 	{
-		cSprite *obj = new cSprite( m_sprite_manager );
-		obj->Set_Image( m_images[0].m_image );
-		obj->Set_Pos( m_pos_x + Get_Random_Float( 0.0f, m_rect.m_w ), m_pos_y + Get_Random_Float( 0.0f, m_rect.m_h ) );
-		obj->m_pos_z = m_pos_z;
-		obj->Set_Scale_X( m_scale_x, 1 );
-		obj->Set_Scale_Y( m_scale_y, 1 );
-		obj->Set_Color( m_color );
-		obj->Set_Color_Combine( m_combine_color[0], m_combine_color[1], m_combine_color[2], m_combine_type );
+		x, y, z,
+		x + w, y, z,
+		x + w, y + h, z,
+		x, y + h, z
+	};
 
-		m_objects.push_back( obj );
-	}
+	request->Add_Quad( corners, white );
 }
 
-cAnimation_Goldpiece :: ~cAnimation_Goldpiece( void )
+// Create a request for the effects using the image
+static cQuad_Stream_Request *Effect_Create_Request( const cGL_Surface *image, unsigned int reserve )
 {
-	// clear
-	for( BlinkPointList::iterator itr = m_objects.begin(); itr != m_objects.end(); ++itr )
-	{
-		delete *itr;
-	}
+	image->Use();
+
+	cQuad_Stream_Request *request = new cQuad_Stream_Request();
+	request->Reserve( reserve );
 
-	m_objects.clear();
+	request->m_texture_id = image->m_image;
+	request->m_tex_x1 = image->m_tex_x1;
+	request->m_tex_y1 = image->m_tex_y1;
+	request->m_tex_x2 = image->m_tex_x2;
+	request->m_tex_y2 = image->m_tex_y2;
+
+	return request;
 }
 
-void cAnimation_Goldpiece :: Update( void )
+cAnimation_Effect_Store :: cAnimation_Effect_Store( void )
 {
-	if( !m_active || editor_enabled )
+	m_blink_count = 0;
+	m_fire_count = 0;
+
+	for( unsigned int i = 0; i < 3; i++ )
 	{
-		return;
+		m_blink_images[i] = NULL;
+	}
+
+	for( unsigned int i = 0; i < 4; i++ )
+	{
+		m_fire_images[i] = NULL;
 	}
+}
+
+cAnimation_Effect_Store :: ~cAnimation_Effect_Store( void )
+{
+	//
+}
 
-	m_time_to_live += pFramerate->m_speed_factor * m_fading_speed;
+void cAnimation_Effect_Store :: Add_Goldpiece( float pos_x, float pos_y, float width /* = 20.0f */, float height /* = 40.0f */ )
+{
+	Load_Images();
 
-	unsigned int count = 0;
+	const unsigned int first = m_blink_count;
+	m_blink_count += 4;
 
-	// update the fixed points
-	for( BlinkPointList::iterator itr = m_objects.begin(); itr != m_objects.end(); ++itr )
+	// memory of removed points is reused
+	if( m_blink_pos_x.size() < m_blink_count )
 	{
-		// get object
-		cSprite *obj = (*itr);
+		m_blink_pos_x.resize( m_blink_count );
+		m_blink_pos_y.resize( m_blink_count );
+		m_blink_pos_z.resize( m_blink_count );
+		m_blink_time.resize( m_blink_count );
+		m_blink_fading_speed.resize( m_blink_count );
+		m_blink_pattern.resize( m_blink_count );
+	}
 
-		switch( count ) 
-		{
-		case 0:
-		{
-			if( m_time_to_live < 3.0f )
-			{
-				obj->Set_Image( m_images[0].m_image );
-			}
-			else if( m_time_to_live < 6.0f )
-			{
-				obj->Set_Image( m_images[0].m_image );
-			}
-			else if( m_time_to_live < 9.0f )
-			{
-				obj->Set_Image( m_images[1].m_image );
-			}
-			else if( m_time_to_live < 12.0f )
-			{
-				obj->Set_Image( m_images[0].m_image );
-			}
-			break;
-		}
-		case 1:
-		{
-			if( m_time_to_live < 3.0f )
-			{
-				obj->Set_Image( m_images[0].m_image );
-			}
-			else if( m_time_to_live < 6.0f )
-			{
-				obj->Set_Image( m_images[1].m_image );
-			}
-			else if( m_time_to_live < 9.0f )
-			{
-				obj->Set_Image( m_images[2].m_image );
-			}
-			else if( m_time_to_live < 12.0f )
-			{
-				obj->Set_Image( m_images[1].m_image );
-			}
-			break;
-		}
-		case 2:
-		{
-			if( m_time_to_live < 3.0f )
-			{
-				obj->Set_Image( m_images[1].m_image );
-			}
-			else if( m_time_to_live < 6.0f )
-			{
-				obj->Set_Image( m_images[2].m_image );
-			}
-			else if( m_time_to_live < 9.0f )
-			{
-				obj->Set_Image( m_images[0].m_image );
-			}
-			else if( m_time_to_live < 12.0f )
-			{
-				obj->Set_Image( m_images[0].m_image );
-			}
-			break;			
-		}
-		case 3:
-		{
-			if( m_time_to_live < 3.0f )
-			{
-				obj->Set_Image( m_images[0].m_image );
-			}
-			else if( m_time_to_live < 6.0f )
-			{
-				obj->Set_Image( m_images[1].m_image );
-			}
-			else if( m_time_to_live < 9.0f )
-			{
-				obj->Set_Image( m_images[0].m_image );
-			}
-			else if( m_time_to_live < 12.0f )
-			{
-				obj->Set_Image( m_images[0].m_image );
-			}
-			break;
-		}
-		default:
-		{
-			break;
-		}
-		}
+	for( unsigned int i = 0; i < 4; i++ )
+	{
+		const unsigned int num = first + i;
 
-		obj->Set_Scale( 1.1f - ( m_time_to_live / 12 ) );
-		count++;
+		m_blink_pos_x[num] = pos_x + Get_Random_Float( 0.0f, width );
+		m_blink_pos_y[num] = pos_y + Get_Random_Float( 0.0f, height );
+		m_blink_pos_z[num] = 0.07f;
+		m_blink_time[num] = 0.0f;
+		m_blink_fading_speed[num] = 1.0f;
+		m_blink_pattern[num] = static_cast<Uint8>(i);
 	}
 }
 
-void cAnimation_Goldpiece :: Draw( cSurface_Request *request /* = NULL */ )
+void cAnimation_Effect_Store :: Add_Fireball( float pos_x, float pos_y, float pos_z, unsigned int power /* = 5 */, float fading_speed /* = 1.0f */ )
 {
-	if( !m_active )
+	if( fading_speed <= 0.0f )
 	{
-		return;
+		fading_speed = 0.1f;
 	}
 
-	// draw the fixed points
-	for( BlinkPointList::iterator itr = m_objects.begin(); itr != m_objects.end(); ++itr )
-	{
-		// get object
-		cSprite *obj = (*itr);
+	Load_Images();
 
-		obj->Draw();
+	const unsigned int first = m_fire_count;
+	m_fire_count += power;
+
+	// memory of removed items is reused
+	if( m_fire_pos_x.size() < m_fire_count )
+	{
+		m_fire_pos_x.resize( m_fire_count );
+		m_fire_pos_y.resize( m_fire_count );
+		m_fire_pos_z.resize( m_fire_count );
+		m_fire_vel_x.resize( m_fire_count );
+		m_fire_vel_y.resize( m_fire_count );
+		m_fire_time.resize( m_fire_count );
+		m_fire_fading_speed.resize( m_fire_count );
+		m_fire_counter.resize( m_fire_count );
+		m_fire_image.resize( m_fire_count );
 	}
-	
-	if( m_time_to_live > 11.0f || m_time_to_live < 0.0f )
+
+	for( unsigned int num = first; num < m_fire_count; num++ )
 	{
-		Set_Active( 0 );
+		m_fire_pos_x[num] = pos_x;
+		m_fire_pos_y[num] = pos_y;
+		m_fire_pos_z[num] = pos_z;
+		m_fire_vel_x[num] = Get_Random_Float( -2.5f, 5 );
+		m_fire_vel_y[num] = Get_Random_Float( -2.5f, 5 );
+		m_fire_time[num] = 0.0f;
+		m_fire_fading_speed[num] = fading_speed;
+		m_fire_counter[num] = Get_Random_Float( 8, 13 );
+		m_fire_image[num] = 0;
 	}
 }
 
-/* *** *** *** *** *** *** *** cAnimation_Fireball *** *** *** *** *** *** *** *** *** *** */
+void cAnimation_Effect_Store :: Clear( void )
+{
+	m_blink_count = 0;
+	m_fire_count = 0;
+}
 
-cAnimation_Fireball :: cAnimation_Fireball( cSprite_Manager *sprite_manager, float posx, float posy, unsigned int power /* = 5 */ )
-: cAnimation( sprite_manager )
+void cAnimation_Effect_Store :: Update( float speed_factor )
 {
-	Set_Pos( posx, posy, 1 );
+	// blinking points
+	unsigned int kept = 0;
 
-	// create objects
-	for( unsigned int i = 0; i < power; i++ )
+	for( unsigned int i = 0; i < m_blink_count; i++ )
 	{
-		cAnimation_Fireball_Item *obj = new cAnimation_Fireball_Item( sprite_manager );
-
-		// images
-		obj->Add_Image( pVideo->Get_Surface( "animation/particles/fire_4.png" ) );
-		obj->Add_Image( pVideo->Get_Surface( "animation/particles/fire_3.png" ) );
-		obj->Add_Image( pVideo->Get_Surface( "animation/particles/fire_2.png" ) );
-		obj->Add_Image( pVideo->Get_Surface( "animation/particles/fire_1.png" ) );
-		obj->Set_Image_Num( 0 );
-
-		// velocity
-		obj->m_velx = Get_Random_Float( -2.5f, 5 );
-		obj->m_vely = Get_Random_Float( -2.5f, 5 );
-
-		// Z position
-		obj->m_pos_z = m_pos_z;
-		if( m_pos_z_rand > 0 )
+		// finished after it was drawn the last time
+		if( m_blink_time[i] > 11.0f || m_blink_time[i] < 0.0f )
 		{
-			obj->m_pos_z += Get_Random_Float( 0, m_pos_z_rand );
+			continue;
 		}
 
-		// lifetime
-		obj->m_counter = Get_Random_Float( 8, 13 );
+		if( kept != i )
+		{
+			m_blink_pos_x[kept] = m_blink_pos_x[i];
+			m_blink_pos_y[kept] = m_blink_pos_y[i];
+			m_blink_pos_z[kept] = m_blink_pos_z[i];
+			m_blink_time[kept] = m_blink_time[i];
+			m_blink_fading_speed[kept] = m_blink_fading_speed[i];
+			m_blink_pattern[kept] = m_blink_pattern[i];
+		}
 
-		m_objects.push_back( obj );
+		m_blink_time[kept] += speed_factor * m_blink_fading_speed[kept];
+		kept++;
 	}
-}
 
-cAnimation_Fireball :: ~cAnimation_Fireball( void )
-{
-	// clear
-	for( FireAnimList::iterator itr = m_objects.begin(); itr != m_objects.end(); ++itr )
-	{
-		delete *itr;
-	}
+	m_blink_count = kept;
 
-	m_objects.clear();
-}
+	// fire items
+	kept = 0;
 
-void cAnimation_Fireball :: Update( void )
-{
-	if( !m_active || editor_enabled )
+	for( unsigned int i = 0; i < m_fire_count; i++ )
 	{
-		return;
-	}
+		const float time = m_fire_time[i] + speed_factor * m_fire_fading_speed[i];
 
-	m_time_to_live += pFramerate->m_speed_factor * m_fading_speed;
+		// finished
+		if( time > 12.0f || time < 0.0f )
+		{
+			continue;
+		}
 
-	// update objects
-	for( FireAnimList::iterator itr = m_objects.begin(); itr != m_objects.end(); ++itr )
-	{
-		cAnimation_Fireball_Item *obj = (*itr);
+		const float counter = m_fire_counter[i];
 
-		if( obj->m_counter > 8 )
+		if( counter > 8 )
 		{
-			obj->Set_Image_Num( 0 );
+			m_fire_image[kept] = 0;
 		}
-		else if( obj->m_counter > 5 )
+		else if( counter > 5 )
 		{
-			obj->Set_Image_Num( 1 );
+			m_fire_image[kept] = 1;
 		}
-		else if( obj->m_counter > 3 )
+		else if( counter > 3 )
 		{
-			obj->Set_Image_Num( 2 );
+			m_fire_image[kept] = 2;
 		}
 		else
 		{
-			obj->Set_Image_Num( 3 );
+			m_fire_image[kept] = 3;
 		}
 
-		obj->m_counter -= pFramerate->m_speed_factor * m_fading_speed;
-
-		obj->Set_Scale( obj->m_counter / 10 );
-		obj->Move( obj->m_velx, obj->m_vely );
+		m_fire_pos_x[kept] = m_fire_pos_x[i] + m_fire_vel_x[i] * speed_factor;
+		m_fire_pos_y[kept] = m_fire_pos_y[i] + m_fire_vel_y[i] * speed_factor;
+		m_fire_pos_z[kept] = m_fire_pos_z[i];
+		m_fire_vel_x[kept] = m_fire_vel_x[i];
+		m_fire_vel_y[kept] = m_fire_vel_y[i];
+		m_fire_time[kept] = time;
+		m_fire_fading_speed[kept] = m_fire_fading_speed[i];
+		m_fire_counter[kept] = counter - speed_factor * m_fire_fading_speed[i];
+		kept++;
 	}
 
-	if( m_time_to_live > 12.0f || m_time_to_live < 0.0f )
-	{
-		Set_Active( 0 );
-	}
+	m_fire_count = kept;
 }
 
-void cAnimation_Fireball :: Draw( cSurface_Request *request /* = NULL */ )
+void cAnimation_Effect_Store :: Draw( void )
 {
-	if( !m_active )
+	// blinking points
+	if( m_blink_count )
 	{
-		return;
-	}
+		cQuad_Stream_Request *requests[3] = { NULL, NULL, NULL };
 
-	// draw objects
-	for( FireAnimList::iterator itr = m_objects.begin(); itr != m_objects.end(); ++itr )
-	{
-		cAnimation_Fireball_Item *obj = (*itr);
-
-		// create request
-		cSurface_Request *request = new cSurface_Request();
-		obj->m_image->Blit( obj->m_pos_x - ( pActive_Camera->m_x - m_pos_x ), obj->m_pos_y - ( pActive_Camera->m_y - m_pos_y ), obj->m_pos_z, request );
+		for( unsigned int i = 0; i < m_blink_count; i++ )
+		{
+			const float time = m_blink_time[i];
+			// the image stays after the last time step
+			const unsigned int step = time < 12.0f ? static_cast<unsigned int>( time / 3.0f ) : 3;
+			const unsigned int image_num = blink_pattern_images[m_blink_pattern[i]][step];
+			const cGL_Surface *image = m_blink_images[image_num];
 
-		// scale
-		request->m_scale_x = obj->m_scale_x;
-		request->m_scale_y = obj->m_scale_y;
+			if( !requests[image_num] )
+			{
+				requests[image_num] = Effect_Create_Request( image, m_blink_count );
+			}
 
-		// color
-		request->m_color = m_color;
+			// scaled to the right and down like a sprite
+			const float scale = 1.1f - ( time / 12 );
+			Effect_Add_Quad( requests[image_num], image, m_blink_pos_x[i] + ( image->m_int_x * scale ), m_blink_pos_y[i] + ( image->m_int_y * scale ), m_blink_pos_z[i], scale );
+		}
 
-		// add request
-		pRenderer->Add( request );
+		for( unsigned int i = 0; i < 3; i++ )
+		{
+			if( requests[i] )
+			{
+				pRenderer->Add( requests[i] );
+			}
+		}
 	}
-}
 
-/* *** *** *** *** *** *** *** cParticle *** *** *** *** *** *** *** *** *** *** */
+	// fire items
+	if( m_fire_count )
+	{
+		cQuad_Stream_Request *requests[4] = { NULL, NULL, NULL, NULL };
 
-cParticle :: cParticle( cParticle_Emitter *parent )
-: cMovingSprite( parent->m_sprite_manager )
-{
-	m_can_be_on_ground = 0;
-	// scale centered
-	Set_Scale_Directions( 1, 1, 1, 1 );
+		for( unsigned int i = 0; i < m_fire_count; i++ )
+		{
+			const unsigned int image_num = m_fire_image[i];
+			const cGL_Surface *image = m_fire_images[image_num];
 
-	m_time_to_live = 0.0f;
-	m_const_rot_x = 0.0f;
-	m_const_rot_y = 0.0f;
-	m_const_rot_z = 0.0f;
-	m_gravity_x = 0.0f;
-	m_gravity_y = 0.0f;
+			if( !requests[image_num] )
+			{
+				requests[image_num] = Effect_Create_Request( image, m_fire_count );
+			}
 
-	m_fade_pos = 1.0f;
+			// the internal position is not scaled like a blitted surface
+			Effect_Add_Quad( requests[image_num], image, m_fire_pos_x[i] + image->m_int_x, m_fire_pos_y[i] + image->m_int_y, m_fire_pos_z[i], m_fire_counter[i] / 10 );
+		}
 
-	m_parent = parent;
+		for( unsigned int i = 0; i < 4; i++ )
+		{
+			if( requests[i] )
+			{
+				pRenderer->Add( requests[i] );
+			}
+		}
+	}
 }
 
-cParticle :: ~cParticle( void )
+void cAnimation_Effect_Store :: Load_Images( void )
 {
+	if( m_blink_images[0] )
+	{
+		return;
+	}
 
+	m_blink_images[0] = pVideo->Get_Surface( "animation/light_1/1.png" );
+	m_blink_images[1] = pVideo->Get_Surface( "animation/light_1/2.png" );
+	m_blink_images[2] = pVideo->Get_Surface( "animation/light_1/3.png" );
+
+	m_fire_images[0] = pVideo->Get_Surface( "animation/particles/fire_4.png" );
+	m_fire_images[1] = pVideo->Get_Surface( "animation/particles/fire_3.png" );
+	m_fire_images[2] = pVideo->Get_Surface( "animation/particles/fire_2.png" );
+	m_fire_images[3] = pVideo->Get_Surface( "animation/particles/fire_1.png" );
 }
 
-void cParticle :: Update( void )
-{
-	// update fade modifier
-	m_fade_pos -= ( ( static_cast<float>(speedfactor_fps) * 0.001f ) * pFramerate->m_speed_factor ) / m_time_to_live;
+/* *** *** *** *** *** *** *** cParticle_List *** *** *** *** *** *** *** *** *** *** */
 
-	// finished fading
-	if( m_fade_pos <= 0.0f )
+// Add the source values multiplied with the factor to the 4 destination values
+static inline void Particle_Add_Scaled_4( float *dest, const float *src, const float factor )
+{
+#if defined(SMC_PARTICLE_SSE)
+	_mm_storeu_ps( dest, _mm_add_ps( _mm_loadu_ps( dest ), _mm_mul_ps( _mm_loadu_ps( src ), _mm_set1_ps( factor ) ) ) );
+#elif defined(SMC_PARTICLE_NEON)
+	vst1q_f32( dest, vmlaq_f32( vld1q_f32( dest ), vld1q_f32( src ), vdupq_n_f32( factor ) ) );
+#else
+	for( unsigned int i = 0; i < 4; i++ )
 	{
-		m_fade_pos = 0.0f;
-		Set_Active( 0 );
-		return;
+		dest[i] += src[i] * factor;
 	}
+#endif
+}
 
-	// with size fading
-	if( m_parent->m_fade_size )
+/* Add the constant rotation multiplied with the factor to the 4 rotations
+ * keeps them between -360 and 360 like the sprite rotation
+*/
+static inline void Particle_Rotate_4( float *rot, const float *const_rot, const float factor )
+{
+#if defined(SMC_PARTICLE_SSE)
+	const __m128 full = _mm_set1_ps( 360.0f );
+	__m128 value = _mm_add_ps( _mm_loadu_ps( rot ), _mm_mul_ps( _mm_loadu_ps( const_rot ), _mm_set1_ps( factor ) ) );
+	value = _mm_sub_ps( value, _mm_and_ps( _mm_cmpge_ps( value, full ), full ) );
+	value = _mm_add_ps( value, _mm_and_ps( _mm_cmple_ps( value, _mm_set1_ps( -360.0f ) ), full ) );
+	_mm_storeu_ps( rot, value );
+#elif defined(SMC_PARTICLE_NEON)
+	const float32x4_t full = vdupq_n_f32( 360.0f );
+	float32x4_t value = vmlaq_f32( vld1q_f32( rot ), vld1q_f32( const_rot ), vdupq_n_f32( factor ) );
+	value = vsubq_f32( value, vreinterpretq_f32_u32( vandq_u32( vcgeq_f32( value, full ), vreinterpretq_u32_f32( full ) ) ) );
+	value = vaddq_f32( value, vreinterpretq_f32_u32( vandq_u32( vcleq_f32( value, vdupq_n_f32( -360.0f ) ), vreinterpretq_u32_f32( full ) ) ) );
+	vst1q_f32( rot, value );
+#else
+	for( unsigned int i = 0; i < 4; i++ )
 	{
-		Set_Scale( m_start_scale_x * m_fade_pos );
+		rot[i] += const_rot[i] * factor;
+
+		if( rot[i] >= 360.0f )
+		{
+			rot[i] -= 360.0f;
+		}
+		else if( rot[i] <= -360.0f )
+		{
+			rot[i] += 360.0f;
+		}
 	}
+#endif
+}
 
-	// move
-	Move( m_velx, m_vely );
-	// todo : gravity maximum
-	Add_Velocity( m_gravity_x, m_gravity_y );
+cParticle_List :: cParticle_List( void )
+{
+	m_count = 0;
+}
+
+cParticle_List :: ~cParticle_List( void )
+{
 
-	// constant rotation
-	if( !Is_Float_Equal( m_const_rot_x, 0.0f ) )
-	{
-		Add_Rotation_X( m_const_rot_x * pFramerate->m_speed_factor );
-	}
-	if( !Is_Float_Equal( m_const_rot_y, 0.0f ) )
-	{
-		Add_Rotation_Y( m_const_rot_y * pFramerate->m_speed_factor );
-	}
-	if( !Is_Float_Equal( m_const_rot_z, 0.0f ) )
-	{
-		Add_Rotation_Z( m_const_rot_z * pFramerate->m_speed_factor );
-	}
 }
 
-void cParticle :: Draw( cSurface_Request *request /* = NULL */ )
+unsigned int cParticle_List :: Add( unsigned int count /* = 1 */ )
 {
-	if( !m_image )
+	if( m_count + count > m_pos_x.size() )
 	{
-		return;
-	}
+		unsigned int size = m_pos_x.empty() ? 16 : m_pos_x.size();
 
-	bool create_request = 0;
+		while( size < m_count + count )
+		{
+			size *= 2;
+		}
 
-	if( !request )
-	{
-		create_request = 1;
-		// create request
-		request = new cSurface_Request();
+		Resize( size );
 	}
 
-	Draw_Image_Normal( request );
+	const unsigned int index = m_count;
+	m_count += count;
 
-	// based on emitter position
-	if( m_parent->m_particle_based_on_emitter_pos > 0.0f )
-	{
-		request->m_pos_x += (m_parent->m_pos_x * m_parent->m_particle_based_on_emitter_pos);
-		request->m_pos_y += (m_parent->m_pos_y * m_parent->m_particle_based_on_emitter_pos);
-	}
-	
-	// blending
-	if( m_parent->m_blending == BLEND_ADD )
-	{
-		request->m_blend_sfactor = GL_SRC_ALPHA;
-		request->m_blend_dfactor = GL_ONE;
-	}
-	else if( m_parent->m_blending == BLEND_DRIVE )
-	{
-		request->m_blend_sfactor = GL_SRC_COLOR;
-		request->m_blend_dfactor = GL_DST_ALPHA;
-	}
+	return index;
+}
 
-	// color fading
-	if( m_parent->m_fade_color )
-	{
-		request->m_color.red = static_cast<Uint8>(m_color.red * m_fade_pos);
-		request->m_color.green = static_cast<Uint8>(m_color.green * m_fade_pos);
-		request->m_color.blue = static_cast<Uint8>(m_color.blue * m_fade_pos);
-	}
+void cParticle_List :: Remove_Finished( void )
+{
+	unsigned int keep = 0;
 
-	// alpha fading
-	if( m_parent->m_fade_alpha )
+	for( unsigned int i = 0; i < m_count; i++ )
 	{
-		request->m_color.alpha = static_cast<Uint8>(request->m_color.alpha * m_fade_pos);
+		// finished
+		if( m_fade_pos[i] <= 0.0f )
+		{
+			continue;
+		}
+
+		// move to the first free position
+		if( keep != i )
+		{
+			m_pos_x[keep] = m_pos_x[i];
+			m_pos_y[keep] = m_pos_y[i];
+			m_pos_z[keep] = m_pos_z[i];
+			m_vel_x[keep] = m_vel_x[i];
+			m_vel_y[keep] = m_vel_y[i];
+			m_gravity_x[keep] = m_gravity_x[i];
+			m_gravity_y[keep] = m_gravity_y[i];
+			m_rot_x[keep] = m_rot_x[i];
+			m_rot_y[keep] = m_rot_y[i];
+			m_rot_z[keep] = m_rot_z[i];
+			m_const_rot_x[keep] = m_const_rot_x[i];
+			m_const_rot_y[keep] = m_const_rot_y[i];
+			m_const_rot_z[keep] = m_const_rot_z[i];
+			m_scale[keep] = m_scale[i];
+			m_fade_pos[keep] = m_fade_pos[i];
+			m_fade_speed[keep] = m_fade_speed[i];
+			m_color[keep] = m_color[i];
+		}
+
+		keep++;
 	}
 
-	if( create_request )
+	m_count = keep;
+}
+
+void cParticle_List :: Clear( void )
+{
+	// the memory is kept for the next particles
+	m_count = 0;
+}
+
+void cParticle_List :: Update( float speed_factor )
+{
+	// the unused values after the last particle are also updated as block
+	const unsigned int count = ( m_count + 3 ) & ~3;
+
+	for( unsigned int i = 0; i < count; i += 4 )
 	{
-		// add request
-		pRenderer->Add( request );
+		// fading
+		Particle_Add_Scaled_4( &m_fade_pos[i], &m_fade_speed[i], -speed_factor );
+		// move
+		Particle_Add_Scaled_4( &m_pos_x[i], &m_vel_x[i], speed_factor );
+		Particle_Add_Scaled_4( &m_pos_y[i], &m_vel_y[i], speed_factor );
+		// todo : gravity maximum
+		Particle_Add_Scaled_4( &m_vel_x[i], &m_gravity_x[i], speed_factor );
+		Particle_Add_Scaled_4( &m_vel_y[i], &m_gravity_y[i], speed_factor );
+		// constant rotation
+		Particle_Rotate_4( &m_rot_x[i], &m_const_rot_x[i], speed_factor );
+		Particle_Rotate_4( &m_rot_y[i], &m_const_rot_y[i], speed_factor );
+		Particle_Rotate_4( &m_rot_z[i], &m_const_rot_z[i], speed_factor );
 	}
 }
 
-void cParticle :: Set_Gravity( float x, float y )
+void cParticle_List :: Fast_Forward( const float *ages )
 {
-	m_gravity_x = x;
-	m_gravity_y = y;
+	for( unsigned int i = 0; i < m_count; i++ )
+	{
+		const float age = ages[i];
+
+		if( age <= 0.0f )
+		{
+			continue;
+		}
+
+		// the position is moved before the gravity is added to the velocity
+		const float gravity_age = age * ( age - 1.0f ) * 0.5f;
+
+		// fading
+		m_fade_pos[i] -= m_fade_speed[i] * age;
+		// move
+		m_pos_x[i] += ( m_vel_x[i] * age ) + ( m_gravity_x[i] * gravity_age );
+		m_pos_y[i] += ( m_vel_y[i] * age ) + ( m_gravity_y[i] * gravity_age );
+		m_vel_x[i] += m_gravity_x[i] * age;
+		m_vel_y[i] += m_gravity_y[i] * age;
+		// constant rotation
+		m_rot_x[i] = fmod( m_rot_x[i] + ( m_const_rot_x[i] * age ), 360.0f );
+		m_rot_y[i] = fmod( m_rot_y[i] + ( m_const_rot_y[i] * age ), 360.0f );
+		m_rot_z[i] = fmod( m_rot_z[i] + ( m_const_rot_z[i] * age ), 360.0f );
+	}
+}
+
+void cParticle_List :: Resize( unsigned int size )
+{
+	m_pos_x.resize( size, 0.0f );
+	m_pos_y.resize( size, 0.0f );
+	m_pos_z.resize( size, 0.0f );
+	m_vel_x.resize( size, 0.0f );
+	m_vel_y.resize( size, 0.0f );
+	m_gravity_x.resize( size, 0.0f );
+	m_gravity_y.resize( size, 0.0f );
+	m_rot_x.resize( size, 0.0f );
+	m_rot_y.resize( size, 0.0f );
+	m_rot_z.resize( size, 0.0f );
+	m_const_rot_x.resize( size, 0.0f );
+	m_const_rot_y.resize( size, 0.0f );
+	m_const_rot_z.resize( size, 0.0f );
+	m_scale.resize( size, 1.0f );
+	m_fade_pos.resize( size, 0.0f );
+	m_fade_speed.resize( size, 0.0f );
+	m_color.resize( size, white );
 }
 
 /* *** *** *** *** *** *** *** cParticle_Emitter *** *** *** *** *** *** *** *** *** *** */
 
+/* Returns the distance which moves a particle outside of a clip side into the clip rect again
+ * outside : distance to the clip side
+ * move : distance which moves it to the other side
+ * normally it is only a single move but it can be more after Pre_Update
+*/
+static inline float Particle_Clip_Move_Distance( float outside, float move )
+{
+	if( move <= 0.0f )
+	{
+		return move;
+	}
+
+	return ( floor( outside / move ) + 1.0f ) * move;
+}
+
 cParticle_Emitter :: cParticle_Emitter( cSprite_Manager *sprite_manager )
 : cAnimation( sprite_manager, "particle_emitter" )
 {
@@ -531,6 +637,7 @@ cParticle_Emitter :: cParticle_Emitter( CEGUI::XMLAttributes &attributes, cSprit
 cParticle_Emitter :: ~cParticle_Emitter( void )
 {
 	cParticle_Emitter::Clear();
+	Release_Seeds();
 }
 
 void cParticle_Emitter :: Init( void )
@@ -594,6 +701,12 @@ void cParticle_Emitter :: Init( void )
 	// animation data
 	m_emit_counter = 0.0f;
 	m_emitter_living_time = 0.0f;
+	// rounds the reduced emission to the nearest count
+	m_emit_rest = 0.5f;
+	// own random numbers
+	m_random.Seed( Get_Random_Seed() );
+	// created with the first update
+	m_seeds = NULL;
 }
 
 cParticle_Emitter *cParticle_Emitter :: Copy( void ) const
@@ -671,10 +784,10 @@ void cParticle_Emitter :: Load_From_XML( CEGUI::XMLAttributes &attributes )
 	Set_Clip_Mode( static_cast<ParticleClipMode>(attributes.getValueAsInteger( "clip_mode", m_clip_mode )) );
 }
 
-void cParticle_Emitter :: Save_To_XML( CEGUI::XMLSerializer &stream )
+void cParticle_Emitter :: Save_To_XML( cXml_Writer &stream )
 {
 	// begin
-	stream.openTag( m_type_name );
+	stream.Open_Tag( m_type_name );
 
 	// filename
 	Write_Property( stream, "image", m_image_filename );
@@ -737,7 +850,7 @@ void cParticle_Emitter :: Save_To_XML( CEGUI::XMLSerializer &stream )
 	Write_Property( stream, "clip_mode", m_clip_mode );
 
 	// end
-	stream.closeTag();
+	stream.Close_Tag();
 }
 
 void cParticle_Emitter :: Pre_Update( void )
@@ -767,15 +880,67 @@ void cParticle_Emitter :: Pre_Update( void )
 		ttl = m_time_to_live * speedfactor_fps;
 	}
 
-	for( float i = 0.0f; i < ttl; i++ )
+	// the shader needs the emission times and these clip modes change the particles with every update
+	if( Is_Shader_Simulated() || ( m_clip_mode != PCM_MOVE && m_clip_rect.m_w > 0.0f && m_clip_rect.m_h > 0.0f ) )
+	{
+		for( float i = 0.0f; i < ttl; i++ )
+		{
+			Update_Particles();
+			Update_Position();
+		}
+	}
+	else
 	{
-		Update_Particles();
-		Update_Position();
+		Pre_Update_Fast( static_cast<unsigned int>(ceil( ttl )) );
 	}
 
 	pFramerate->m_speed_factor = old_speedfactor;
 }
 
+void cParticle_Emitter :: Pre_Update_Fast( unsigned int steps )
+{
+	Update_Position();
+
+	// not able to emit
+	if( m_emitter_living_time >= m_emitter_time_to_live && !Is_Float_Equal( m_emitter_time_to_live, -1.0f ) )
+	{
+		if( !m_particles.m_count )
+		{
+			Set_Active( 0 );
+		}
+
+		return;
+	}
+
+	// updates of every particle until the last step
+	vector<float> ages;
+
+	for( unsigned int step = 0; step < steps; step++ )
+	{
+		// same schedule as Update_Particles
+		while( m_emit_counter > m_emitter_iteration_interval )
+		{
+			Emit();
+			m_emit_counter -= m_emitter_iteration_interval;
+		}
+
+		ages.resize( m_particles.m_count, static_cast<float>(steps - 1 - step) );
+		m_emit_counter += pFramerate->m_speed_factor * ( static_cast<float>(speedfactor_fps) * 0.001f );
+	}
+
+	if( !m_particles.m_count )
+	{
+		return;
+	}
+
+	m_particles.Fast_Forward( &ages[0] );
+	m_particles.Remove_Finished();
+
+	// a particle can be outside of both clip sides
+	Update_Position();
+	Update_Position();
+}
+
 void cParticle_Emitter :: Emit( void )
 {
 	if( !m_image )
@@ -783,142 +948,149 @@ void cParticle_Emitter :: Emit( void )
 		return;
 	}
 
-	for( unsigned int i = 0; i < m_emitter_quota; i++ )
+	unsigned int quota = m_emitter_quota;
+
+	// reduced by the particle budget
+	if( pParticle_Budget )
 	{
-		cParticle *particle = new cParticle( this );
+		const float scale = pParticle_Budget->Get_Emit_Scale( GL_rect( m_pos_x, m_pos_y, m_rect.m_w, m_rect.m_h ) );
 
-		// X Position
-		float x = m_pos_x - ( m_image->m_w * 0.5f );
-		if( m_rect.m_w > 0.0f )
-		{
-			x += Get_Random_Float( 0.0f, m_rect.m_w );
-		}
-		// Y Position
-		float y = m_pos_y - ( m_image->m_h * 0.5f );
-		if( m_rect.m_h > 0.0f )
+		if( scale < 1.0f )
 		{
-			y += Get_Random_Float( 0.0f, m_rect.m_h );
+			m_emit_rest += static_cast<float>(m_emitter_quota) * scale;
+			quota = static_cast<unsigned int>(m_emit_rest);
+			m_emit_rest -= static_cast<float>(quota);
 		}
-		// Set Position
-		particle->Set_Pos( x, y, 1 );
+	}
 
-		// Image
-		particle->Set_Image( m_image, 1 );
+	if( !quota )
+	{
+		return;
+	}
 
-		// Z position
-		particle->m_pos_z = m_pos_z;
-		if( m_pos_z_rand > 0.0f )
-		{
-			particle->m_pos_z += Get_Random_Float( 0.0f, m_pos_z_rand );
-		}
+	const unsigned int start = m_particles.Add( quota );
 
-		// angle range
-		float dir_angle = m_angle_start;
-		// start angle
-		if( m_angle_range > 0.0f )
-		{
-			dir_angle += Get_Random_Float( 0.0f, m_angle_range );
-		}
+	// Position
+	Set_Random_Values( &m_particles.m_pos_x[start], quota, m_pos_x - ( m_image->m_w * 0.5f ), m_rect.m_w );
+	Set_Random_Values( &m_particles.m_pos_y[start], quota, m_pos_y - ( m_image->m_h * 0.5f ), m_rect.m_h );
+	// Z position
+	Set_Random_Values( &m_particles.m_pos_z[start], quota, m_pos_z, m_pos_z_rand );
 
-		// Velocity
-		float speed = m_vel;
-		if( m_vel_rand > 0.0f )
-		{
-			speed += Get_Random_Float( 0.0f, m_vel_rand );
-		}
-		// Set Velocity
-		particle->Set_Velocity_From_Angle( dir_angle, speed, 1 );
+	// direction angle and speed are stored in the velocity until converted
+	float *angles = &m_particles.m_vel_x[start];
+	float *speeds = &m_particles.m_vel_y[start];
+	Set_Random_Values( angles, quota, m_angle_start, m_angle_range );
+	Set_Random_Values( speeds, quota, m_vel, m_vel_rand );
 
-		// Start rotation
-		particle->m_rot_x = m_start_rot_x;
-		particle->m_rot_y = m_start_rot_y;
-		particle->m_rot_z = m_start_rot_z;
+	// Start rotation
+	Set_Random_Values( &m_particles.m_rot_x[start], quota, m_start_rot_x, 0.0f );
+	Set_Random_Values( &m_particles.m_rot_y[start], quota, m_start_rot_y, 0.0f );
+	Set_Random_Values( &m_particles.m_rot_z[start], quota, m_start_rot_z, 0.0f );
 
-		// Start direction is added to the z rotation
-		if( m_start_rot_z_uses_direction )
-		{
-			particle->m_rot_z += dir_angle;
-		}
+	// Start direction is added to the z rotation
+	if( m_start_rot_z_uses_direction )
+	{
+		float *rot_z = &m_particles.m_rot_z[start];
 
-		// Constant rotation
-		particle->m_const_rot_x = m_const_rot_x;
-		particle->m_const_rot_y = m_const_rot_y;
-		particle->m_const_rot_z = m_const_rot_z;
-		if( m_const_rot_x_rand > 0.0f )
-		{
-			particle->m_const_rot_x += Get_Random_Float( 0.0f, m_const_rot_x_rand );
-		}
-		if( m_const_rot_y_rand > 0.0f )
+		for( unsigned int i = 0; i < quota; i++ )
 		{
-			particle->m_const_rot_y += Get_Random_Float( 0.0f, m_const_rot_y_rand );
-		}
-		if( m_const_rot_z_rand > 0.0f )
-		{
-			particle->m_const_rot_z += Get_Random_Float( 0.0f, m_const_rot_z_rand );
+			rot_z[i] += angles[i];
 		}
+	}
 
-		// Scale
-		float scale = m_size_scale;
-		if( m_size_scale_rand > 0.0f )
-		{
-			scale += Get_Random_Float( 0.0f, m_size_scale_rand );
-		}
-		particle->Set_Scale( scale, 1 );
+	// Velocity
+	for( unsigned int i = 0; i < quota; i++ )
+	{
+		const float angle = angles[i] * deg_to_rad;
+		const float speed = speeds[i];
 
-		// Gravity
-		float grav_x = m_gravity_x;
-		if( m_gravity_x_rand > 0.0f )
-		{
-			grav_x += Get_Random_Float( 0.0f, m_gravity_x_rand );
-		}
-		float grav_y = m_gravity_y;
-		if( m_gravity_y_rand > 0.0f )
+		angles[i] = cos( angle ) * speed;
+		speeds[i] = sin( angle ) * speed;
+	}
+
+	// Constant rotation
+	Set_Random_Values( &m_particles.m_const_rot_x[start], quota, m_const_rot_x, m_const_rot_x_rand );
+	Set_Random_Values( &m_particles.m_const_rot_y[start], quota, m_const_rot_y, m_const_rot_y_rand );
+	Set_Random_Values( &m_particles.m_const_rot_z[start], quota, m_const_rot_z, m_const_rot_z_rand );
+
+	// Scale
+	float *scales = &m_particles.m_scale[start];
+	Set_Random_Values( scales, quota, m_size_scale, m_size_scale_rand );
+
+	for( unsigned int i = 0; i < quota; i++ )
+	{
+		// invalid scale
+		if( Is_Float_Equal( scales[i], 0.0f ) )
 		{
-			grav_y += Get_Random_Float( 0.0f, m_gravity_y_rand );
+			scales[i] = 1.0f;
 		}
-		// set Gravity
-		particle->Set_Gravity( grav_x, grav_y );
+	}
+
+	// Gravity
+	Set_Random_Values( &m_particles.m_gravity_x[start], quota, m_gravity_x, m_gravity_x_rand );
+	Set_Random_Values( &m_particles.m_gravity_y[start], quota, m_gravity_y, m_gravity_y_rand );
+
+	// Time to life is converted to the fading speed
+	float *fade_speeds = &m_particles.m_fade_speed[start];
+	Set_Random_Values( fade_speeds, quota, m_time_to_live, m_time_to_live_rand );
+
+	const float fade_factor = static_cast<float>(speedfactor_fps) * 0.001f;
+
+	for( unsigned int i = 0; i < quota; i++ )
+	{
+		fade_speeds[i] = fade_factor / fade_speeds[i];
+		m_particles.m_fade_pos[start + i] = 1.0f;
+	}
+
+	// Color
+	for( unsigned int i = 0; i < quota; i++ )
+	{
+		Color color = m_color;
 
-		// Color
-		particle->Set_Color( m_color );
 		if( m_color_rand.red > 0 )
 		{
-			particle->m_color.red += rand() % m_color_rand.red;
+			color.red += m_random.Get_Int( m_color_rand.red );
 		}
 		if( m_color_rand.green > 0 )
 		{
-			particle->m_color.green += rand() % m_color_rand.green;
+			color.green += m_random.Get_Int( m_color_rand.green );
 		}
 		if( m_color_rand.blue > 0 )
 		{
-			particle->m_color.blue += rand() % m_color_rand.blue;
+			color.blue += m_random.Get_Int( m_color_rand.blue );
 		}
 		if( m_color_rand.alpha > 0 )
 		{
-			particle->m_color.alpha += rand() % m_color_rand.alpha;
+			color.alpha += m_random.Get_Int( m_color_rand.alpha );
 		}
 
-		// Time to life
-		particle->m_time_to_live = m_time_to_live;
-		if( m_time_to_live_rand > 0.0f )
-		{
-			particle->m_time_to_live += Get_Random_Float( 0.0f, m_time_to_live_rand );
-		}
+		m_particles.m_color[start + i] = color;
+	}
+}
 
-		m_objects.push_back( particle );
+void cParticle_Emitter :: Set_Random_Values( float *values, unsigned int count, float base, float range )
+{
+	// from the base to base + range
+	if( range > 0.0f )
+	{
+		m_random.Get_Floats( values, count, base, base + range );
+	}
+	else
+	{
+		std::fill( values, values + count, base );
 	}
 }
 
 void cParticle_Emitter :: Clear( bool reset /* = 1 */ )
 {
 	// clear particles
-	for( ParticleList::iterator itr = m_objects.begin(); itr != m_objects.end(); ++itr )
+	m_particles.Clear();
+
+	if( m_seeds )
 	{
-		delete *itr;
+		m_seeds->Clear();
 	}
 
-	m_objects.clear();
-
 	// clear animation data
 	m_emit_counter = 0.0f;
 
@@ -928,178 +1100,432 @@ void cParticle_Emitter :: Clear( bool reset /* = 1 */ )
 	}
 }
 
-void cParticle_Emitter :: Update( void )
+void cParticle_Emitter :: Update( void )
+{
+	Update_Valid_Update();
+
+	if( !m_valid_update )
+	{
+		return;
+	}
+
+	Update_Position();
+	
+	m_emitter_living_time += pFramerate->m_speed_factor * ( static_cast<float>(speedfactor_fps) * 0.001f );
+
+	Update_Particles();
+
+	if( pParticle_Budget )
+	{
+		pParticle_Budget->Add_Particles( m_particles.m_count );
+	}
+}
+
+void cParticle_Emitter :: Update_Particles( void )
+{
+	const bool shader_simulated = Is_Shader_Simulated();
+
+	if( shader_simulated )
+	{
+		if( !m_seeds )
+		{
+			m_seeds = new cParticle_Seed_Buffer();
+			// particles simulated on the cpu are not continued
+			m_particles.Clear();
+		}
+
+		m_seeds->Update( pFramerate->m_speed_factor );
+	}
+	else
+	{
+		Release_Seeds();
+
+		// update objects
+		m_particles.Update( pFramerate->m_speed_factor );
+		// remove the finished
+		m_particles.Remove_Finished();
+	}
+
+	// if able to emit or endless emitter
+	if( m_emitter_living_time < m_emitter_time_to_live || Is_Float_Equal( m_emitter_time_to_live, -1.0f ) )
+	{
+		// emit
+		while( m_emit_counter > m_emitter_iteration_interval )
+		{
+			Emit();
+			m_emit_counter -= m_emitter_iteration_interval;
+		}
+
+		m_emit_counter += pFramerate->m_speed_factor * ( static_cast<float>(speedfactor_fps) * 0.001f );
+	}
+	// no particles are active
+	else if( shader_simulated ? m_seeds->Is_Finished() : !m_particles.m_count )
+	{
+		Set_Active( 0 );
+	}
+
+	// the shader only needs the emission values
+	if( shader_simulated && m_particles.m_count )
+	{
+		m_seeds->Add( m_particles );
+		m_particles.Clear();
+	}
+}
+
+void cParticle_Emitter :: Update_Position( void )
+{
+	if( m_emitter_based_on_camera_pos && !editor_enabled )
+	{
+		Set_Pos( m_start_pos_x + pActive_Camera->m_x, m_start_pos_y + ( pActive_Camera->m_y + game_res_h ) );
+	}
+
+	GL_rect clip_rect_final;
+
+	// if clip rect is set
+	if( Get_Final_Clip_Rect( clip_rect_final ) )
+	{
+		Keep_Particles_In_Rect( clip_rect_final, m_clip_mode );
+	}
+}
+
+bool cParticle_Emitter :: Get_Final_Clip_Rect( GL_rect &rect ) const
+{
+	if( m_clip_rect.m_w <= 0.0f || m_clip_rect.m_h <= 0.0f )
+	{
+		return 0;
+	}
+
+	rect.m_x = m_start_pos_x + m_clip_rect.m_x;
+	rect.m_y = m_start_pos_y + m_clip_rect.m_y;
+
+	if( !editor_enabled )
+	{
+		if( m_emitter_based_on_camera_pos )
+		{
+			rect.m_x += pActive_Camera->m_x;
+			rect.m_y += pActive_Camera->m_y + game_res_h;
+		}
+		
+		if( m_particle_based_on_emitter_pos > 0.0f )
+		{
+			rect.m_x -= m_pos_x * m_particle_based_on_emitter_pos;
+			rect.m_y -= m_pos_y * m_particle_based_on_emitter_pos;
+		}
+	}
+	
+	rect.m_w = m_clip_rect.m_w;
+	rect.m_h = m_clip_rect.m_h;
+
+	return 1;
+}
+
+void cParticle_Emitter :: Draw( cSurface_Request *request /* = NULL */ )
+{
+	if( !m_valid_draw )
+	{
+		return;
+	}
+
+	Draw_Particles();
+
+	if( editor_enabled )
+	{
+		if( !m_spawned )
+		{
+			// draw emitter rect
+			GL_rect color_rect = GL_rect( m_start_pos_x - pActive_Camera->m_x, m_start_pos_y - pActive_Camera->m_y, m_col_rect.m_w, m_col_rect.m_h );
+
+			cRect_Request *rect_request = new cRect_Request();
+			pVideo->Draw_Rect( &color_rect, m_editor_pos_z, &darkgreen, rect_request );
+			rect_request->m_filled = 0;
+			pRenderer->Add( rect_request );
+
+			// if active mouse object
+			if( pMouseCursor->m_active_object == this )
+			{
+				// draw clip rect
+				if( m_clip_rect.m_w > 0.0f && m_clip_rect.m_h > 0.0f )
+				{
+					color_rect = GL_rect( m_start_pos_x + m_clip_rect.m_x - pActive_Camera->m_x, m_start_pos_y + m_clip_rect.m_y - pActive_Camera->m_y, m_clip_rect.m_w, m_clip_rect.m_h );
+
+					rect_request = new cRect_Request();
+					pVideo->Draw_Rect( &color_rect, m_editor_pos_z, &lightgrey, rect_request );
+					rect_request->m_filled = 0;
+					rect_request->m_line_width = 2.0f;
+					pRenderer->Add( rect_request );
+				}
+			}
+		}
+	}
+}
+
+void cParticle_Emitter :: Draw_Particles( void )
+{
+	if( m_seeds )
+	{
+		Draw_Seeds();
+		return;
+	}
+
+	if( !m_image || !m_particles.m_count )
+	{
+		return;
+	}
+
+	m_image->Use();
+
+	// create request
+	cQuad_Stream_Request *request = new cQuad_Stream_Request();
+	request->Reserve( m_particles.m_count );
+
+	// texture
+	request->m_texture_id = m_image->m_image;
+	request->m_tex_x1 = m_image->m_tex_x1;
+	request->m_tex_y1 = m_image->m_tex_y1;
+	request->m_tex_x2 = m_image->m_tex_x2;
+	request->m_tex_y2 = m_image->m_tex_y2;
+
+	// blending
+	Set_Request_Blending( request );
+
+	// particles are scaled to all directions from the center
+	const float half_w = m_image->m_start_w * 0.5f;
+	const float half_h = m_image->m_start_h * 0.5f;
+	const float scale_offset_x = m_image->m_w * 0.5f;
+	const float scale_offset_y = m_image->m_h * 0.5f;
+
+	// based on emitter position
+	float offset_x = 0.0f;
+	float offset_y = 0.0f;
+
+	if( m_particle_based_on_emitter_pos > 0.0f )
+	{
+		offset_x += m_pos_x * m_particle_based_on_emitter_pos;
+		offset_y += m_pos_y * m_particle_based_on_emitter_pos;
+	}
+
+	GLfloat corners[12];
+
+	for( unsigned int i = 0; i < m_particles.m_count; i++ )
+	{
+		const float fade_pos = m_particles.m_fade_pos[i];
+
+		// finished
+		if( fade_pos <= 0.0f )
+		{
+			continue;
+		}
+
+		float scale = m_particles.m_scale[i];
+
+		// size fading
+		if( m_fade_size )
+		{
+			scale *= fade_pos;
+		}
+
+		// center position
+		const float x = m_particles.m_pos_x[i] + offset_x + ( m_image->m_int_x * scale ) - ( scale_offset_x * ( scale - 1.0f ) ) + ( half_w * scale );
+		const float y = m_particles.m_pos_y[i] + offset_y + ( m_image->m_int_y * scale ) - ( scale_offset_y * ( scale - 1.0f ) ) + ( half_h * scale );
+		const float z = m_particles.m_pos_z[i];
+
+		const float rot_x = m_particles.m_rot_x[i] + m_image->m_base_rot_x;
+		const float rot_y = m_particles.m_rot_y[i] + m_image->m_base_rot_y;
+		const float rot_z = m_particles.m_rot_z[i] + m_image->m_base_rot_z;
+
+		// not rotated
+		if( rot_x == 0.0f && rot_y == 0.0f && rot_z == 0.0f )
+		{
+			const float scaled_w = half_w * scale;
+			const float scaled_h = half_h * scale;
+
+			// top left
+			corners[0] = x - scaled_w;
+			corners[1] = y - scaled_h;
+			corners[2] = z;
+			// top right
+			corners[3] = x + scaled_w;
+			corners[4] = y - scaled_h;
+			corners[5] = z;
+			// bottom right
+			corners[6] = x + scaled_w;
+			corners[7] = y + scaled_h;
+			corners[8] = z;
+			// bottom left
+			corners[9] = x - scaled_w;
+			corners[10] = y + scaled_h;
+			corners[11] = z;
+		}
+		// rotated in the same order as a surface request
+		else
+		{
+			Get_Rotated_Quad( half_w, half_h, rot_x, rot_y, rot_z, corners );
+
+			for( unsigned int c = 0; c < 4; c++ )
+			{
+				// the depth is not scaled
+				corners[c * 3] = x + corners[c * 3] * scale;
+				corners[c * 3 + 1] = y + corners[c * 3 + 1] * scale;
+				corners[c * 3 + 2] += z;
+			}
+		}
+
+		Color color = m_particles.m_color[i];
+
+		// color fading
+		if( m_fade_color )
+		{
+			color.red = static_cast<Uint8>(color.red * fade_pos);
+			color.green = static_cast<Uint8>(color.green * fade_pos);
+			color.blue = static_cast<Uint8>(color.blue * fade_pos);
+		}
+
+		// alpha fading
+		if( m_fade_alpha )
+		{
+			color.alpha = static_cast<Uint8>(color.alpha * fade_pos);
+		}
+
+		request->Add_Quad( corners, color );
+	}
+
+	// add request
+	pRenderer->Add( request );
+}
+
+void cParticle_Emitter :: Draw_Seeds( void )
 {
-	Update_Valid_Update();
-
-	if( !m_valid_update )
+	if( !m_image || m_seeds->Is_Finished() )
 	{
 		return;
 	}
 
-	Update_Position();
-	
-	m_emitter_living_time += pFramerate->m_speed_factor * ( static_cast<float>(speedfactor_fps) * 0.001f );
+	m_image->Use();
 
-	Update_Particles();
-}
+	// create request
+	cParticle_Seed_Request *request = new cParticle_Seed_Request();
+	m_seeds->Fill_Request( request );
 
-void cParticle_Emitter :: Update_Particles( void )
-{
-	// update objects
-	for( ParticleList::iterator itr = m_objects.begin(); itr != m_objects.end(); )
-	{
-		// get object pointer
-		cParticle *obj = (*itr);
+	// sorted with the lowest z position
+	request->m_pos_z = m_pos_z;
 
-		// update
-		obj->Update();
+	// texture
+	request->m_texture_id = m_image->m_image;
+	request->m_tex_x1 = m_image->m_tex_x1;
+	request->m_tex_y1 = m_image->m_tex_y1;
+	request->m_tex_x2 = m_image->m_tex_x2;
+	request->m_tex_y2 = m_image->m_tex_y2;
 
-		// if finished
-		if( !obj->m_active )
-		{
-			itr = m_objects.erase( itr );
-			delete obj;
-		}
-		// increment
-		else
-		{
-			++itr;
-		}
-	}
+	// blending
+	Set_Request_Blending( request );
 
-	// if able to emit or endless emitter
-	if( m_emitter_living_time < m_emitter_time_to_live || Is_Float_Equal( m_emitter_time_to_live, -1.0f ) )
+	// particles are scaled to all directions from the center
+	request->m_half_w = m_image->m_start_w * 0.5f;
+	request->m_half_h = m_image->m_start_h * 0.5f;
+	request->m_scale_offset_x = m_image->m_w * 0.5f;
+	request->m_scale_offset_y = m_image->m_h * 0.5f;
+	request->m_image_x = m_image->m_int_x;
+	request->m_image_y = m_image->m_int_y;
+
+	// based on emitter position
+	if( m_particle_based_on_emitter_pos > 0.0f )
 	{
-		// emit
-		while( m_emit_counter > m_emitter_iteration_interval )
-		{
-			Emit();
-			m_emit_counter -= m_emitter_iteration_interval;
-		}
+		request->m_offset_x = m_pos_x * m_particle_based_on_emitter_pos;
+		request->m_offset_y = m_pos_y * m_particle_based_on_emitter_pos;
+	}
 
-		m_emit_counter += pFramerate->m_speed_factor * ( static_cast<float>(speedfactor_fps) * 0.001f );
+	request->m_base_rot_x = m_image->m_base_rot_x;
+	request->m_base_rot_y = m_image->m_base_rot_y;
+	request->m_base_rot_z = m_image->m_base_rot_z;
+
+	// fading
+	request->m_fade_size = m_fade_size;
+	request->m_fade_alpha = m_fade_alpha;
+	request->m_fade_color = m_fade_color;
+
+	// only moving to the other side is simulated
+	Get_Final_Clip_Rect( request->m_clip_rect );
+
+	// add request
+	pRenderer->Add( request );
+}
+
+void cParticle_Emitter :: Set_Request_Blending( cRender_Request_Advanced *request ) const
+{
+	if( m_blending == BLEND_ADD )
+	{
+		request->m_blend_sfactor = GL_SRC_ALPHA;
+		request->m_blend_dfactor = GL_ONE;
 	}
-	// no particles are active
-	else if( m_objects.empty() )
+	else if( m_blending == BLEND_DRIVE )
 	{
-		Set_Active( 0 );
+		request->m_blend_sfactor = GL_SRC_COLOR;
+		request->m_blend_dfactor = GL_DST_ALPHA;
 	}
 }
 
-void cParticle_Emitter :: Update_Position( void )
+bool cParticle_Emitter :: Is_Shader_Simulated( void ) const
 {
-	if( m_emitter_based_on_camera_pos && !editor_enabled )
+	if( !pVideo->m_particle_shader )
 	{
-		Set_Pos( m_start_pos_x + pActive_Camera->m_x, m_start_pos_y + ( pActive_Camera->m_y + game_res_h ) );
+		return 0;
 	}
 
-	// if clip rect is set
-	if( m_clip_rect.m_w > 0.0f && m_clip_rect.m_h > 0.0f )
+	// reversing and deleting change single particles
+	if( m_clip_mode != PCM_MOVE && m_clip_rect.m_w > 0.0f && m_clip_rect.m_h > 0.0f )
 	{
-		GL_rect clip_rect_final;
-
-		clip_rect_final.m_x = m_start_pos_x + m_clip_rect.m_x;
-		clip_rect_final.m_y = m_start_pos_y + m_clip_rect.m_y;
-
-		if( !editor_enabled )
-		{
-			if( m_emitter_based_on_camera_pos )
-			{
-				clip_rect_final.m_x += pActive_Camera->m_x;
-				clip_rect_final.m_y += pActive_Camera->m_y + game_res_h;
-			}
-			
-			if( m_particle_based_on_emitter_pos > 0.0f )
-			{
-				clip_rect_final.m_x -= m_pos_x * m_particle_based_on_emitter_pos;
-				clip_rect_final.m_y -= m_pos_y * m_particle_based_on_emitter_pos;
-			}
-		}
-		
-		clip_rect_final.m_w = m_clip_rect.m_w;
-		clip_rect_final.m_h = m_clip_rect.m_h;
-
-		Keep_Particles_In_Rect( clip_rect_final, m_clip_mode );
+		return 0;
 	}
+
+	return 1;
 }
 
-void cParticle_Emitter :: Draw( cSurface_Request *request /* = NULL */ )
+void cParticle_Emitter :: Release_Seeds( void )
 {
-	if( !m_valid_draw )
+	if( !m_seeds )
 	{
 		return;
 	}
 
-	for( ParticleList::iterator itr = m_objects.begin(); itr != m_objects.end(); ++itr )
+	// could still be drawn by the render thread
+	if( pVideo && pVideo->m_particle_shader )
 	{
-		(*itr)->Draw();
+		pVideo->m_particle_shader->Retire( m_seeds );
 	}
-
-	if( editor_enabled )
+	else
 	{
-		if( !m_spawned )
-		{
-			// draw emitter rect
-			GL_rect color_rect = GL_rect( m_start_pos_x - pActive_Camera->m_x, m_start_pos_y - pActive_Camera->m_y, m_col_rect.m_w, m_col_rect.m_h );
-
-			cRect_Request *rect_request = new cRect_Request();
-			pVideo->Draw_Rect( &color_rect, m_editor_pos_z, &darkgreen, rect_request );
-			rect_request->m_filled = 0;
-			pRenderer->Add( rect_request );
-
-			// if active mouse object
-			if( pMouseCursor->m_active_object == this )
-			{
-				// draw clip rect
-				if( m_clip_rect.m_w > 0.0f && m_clip_rect.m_h > 0.0f )
-				{
-					color_rect = GL_rect( m_start_pos_x + m_clip_rect.m_x - pActive_Camera->m_x, m_start_pos_y + m_clip_rect.m_y - pActive_Camera->m_y, m_clip_rect.m_w, m_clip_rect.m_h );
-
-					rect_request = new cRect_Request();
-					pVideo->Draw_Rect( &color_rect, m_editor_pos_z, &lightgrey, rect_request );
-					rect_request->m_filled = 0;
-					rect_request->m_line_width = 2.0f;
-					pRenderer->Add( rect_request );
-				}
-			}
-		}
+		delete m_seeds;
 	}
+
+	m_seeds = NULL;
 }
 
 void cParticle_Emitter :: Keep_Particles_In_Rect( const GL_rect &clip_rect, ParticleClipMode mode /* = PCM_MOVE */ )
 {
+	if( !m_image )
+	{
+		return;
+	}
+
 	// temporary obj rect
 	GL_rect obj_rect;
 
 	// find particles that are not visible and move them to the opposite screen side
-	for( ParticleList::iterator itr = m_objects.begin(); itr != m_objects.end(); ++itr )
+	for( unsigned int i = 0; i < m_particles.m_count; i++ )
 	{
-		// get animation particle pointer
-		cParticle *obj = static_cast<cParticle *>(*itr);
+		float scale = m_particles.m_scale[i];
 
-		// set rectangle
-		if( obj->m_scale_x != 1.0f )
+		// size fading
+		if( m_fade_size )
 		{
-			obj_rect.m_x = obj->m_pos_x - ( ( obj->m_image->m_w * 0.5f ) * ( obj->m_scale_x - 1.0f ) );
-			obj_rect.m_w = obj->m_rect.m_w * obj->m_scale_x;
-		}
-		else
-		{
-			obj_rect.m_x = obj->m_pos_x;
-			obj_rect.m_w = obj->m_rect.m_w;
+			scale *= m_particles.m_fade_pos[i];
 		}
 
-		if( obj->m_scale_y != 1.0f )
-		{
-			obj_rect.m_y = obj->m_pos_y - ( ( obj->m_image->m_h * 0.5f ) * ( obj->m_scale_y - 1.0f ) );
-			obj_rect.m_h = obj->m_rect.m_h * obj->m_scale_y;
-		}
-		else
-		{
-			obj_rect.m_y = obj->m_pos_y;
-			obj_rect.m_h = obj->m_rect.m_h;
-		}
+		// set rectangle
+		obj_rect.m_x = m_particles.m_pos_x[i] - ( ( m_image->m_w * 0.5f ) * ( scale - 1.0f ) );
+		obj_rect.m_w = m_image->m_w * scale;
+		obj_rect.m_y = m_particles.m_pos_y[i] - ( ( m_image->m_h * 0.5f ) * ( scale - 1.0f ) );
+		obj_rect.m_h = m_image->m_h * scale;
 
 		// out in left
 		if( obj_rect.m_x + obj_rect.m_w < clip_rect.m_x )
@@ -1107,18 +1533,18 @@ void cParticle_Emitter :: Keep_Particles_In_Rect( const GL_rect &clip_rect, Part
 			// move to right
 			if( mode == PCM_MOVE )
 			{
-				obj->Move( clip_rect.m_w + obj_rect.m_w - 1.0f, 0, 1 );
+				m_particles.m_pos_x[i] += Particle_Clip_Move_Distance( clip_rect.m_x - ( obj_rect.m_x + obj_rect.m_w ), clip_rect.m_w + obj_rect.m_w - 1.0f );
 			}
 			else if( mode == PCM_REVERSE )
 			{
-				if( obj->m_velx < 0.0f )
+				if( m_particles.m_vel_x[i] < 0.0f )
 				{
-					obj->Set_Velocity( -obj->m_velx, obj->m_vely );
+					m_particles.m_vel_x[i] = -m_particles.m_vel_x[i];
 				}
 			}
 			else if( mode == PCM_DELETE )
 			{
-				obj->Set_Active( 0 );
+				m_particles.m_fade_pos[i] = 0.0f;
 			}
 		}
 		// out in right
@@ -1127,18 +1553,18 @@ void cParticle_Emitter :: Keep_Particles_In_Rect( const GL_rect &clip_rect, Part
 			// move to left
 			if( mode == PCM_MOVE )
 			{
-				obj->Move( -clip_rect.m_w - obj_rect.m_w + 1.0f, 0, 1 );
+				m_particles.m_pos_x[i] -= Particle_Clip_Move_Distance( obj_rect.m_x - ( clip_rect.m_x + clip_rect.m_w ), clip_rect.m_w + obj_rect.m_w - 1.0f );
 			}
 			else if( mode == PCM_REVERSE )
 			{
-				if( obj->m_velx > 0.0f )
+				if( m_particles.m_vel_x[i] > 0.0f )
 				{
-					obj->Set_Velocity( -obj->m_velx, obj->m_vely );
+					m_particles.m_vel_x[i] = -m_particles.m_vel_x[i];
 				}
 			}
 			else if( mode == PCM_DELETE )
 			{
-				obj->Set_Active( 0 );
+				m_particles.m_fade_pos[i] = 0.0f;
 			}
 		}
 		// out on top
@@ -1147,18 +1573,18 @@ void cParticle_Emitter :: Keep_Particles_In_Rect( const GL_rect &clip_rect, Part
 			// move to bottom
 			if( mode == PCM_MOVE )
 			{
-				obj->Move( 0, clip_rect.m_h + obj_rect.m_h - 1.0f, 1 );
+				m_particles.m_pos_y[i] += Particle_Clip_Move_Distance( clip_rect.m_y - ( obj_rect.m_y + obj_rect.m_h ), clip_rect.m_h + obj_rect.m_h - 1.0f );
 			}
 			else if( mode == PCM_REVERSE )
 			{
-				if( obj->m_vely < 0.0f )
+				if( m_particles.m_vel_y[i] < 0.0f )
 				{
-					obj->Set_Velocity( obj->m_velx, -obj->m_vely );
+					m_particles.m_vel_y[i] = -m_particles.m_vel_y[i];
 				}
 			}
 			else if( mode == PCM_DELETE )
 			{
-				obj->Set_Active( 0 );
+				m_particles.m_fade_pos[i] = 0.0f;
 			}
 		}
 		// out on bottom
@@ -1167,18 +1593,18 @@ void cParticle_Emitter :: Keep_Particles_In_Rect( const GL_rect &clip_rect, Part
 			// move to top
 			if( mode == PCM_MOVE )
 			{
-				obj->Move( 0, -clip_rect.m_h - obj_rect.m_h + 1.0f, 1 );
+				m_particles.m_pos_y[i] -= Particle_Clip_Move_Distance( obj_rect.m_y - ( clip_rect.m_y + clip_rect.m_h ), clip_rect.m_h + obj_rect.m_h - 1.0f );
 			}
 			else if( mode == PCM_REVERSE )
 			{
-				if( obj->m_vely > 0.0f )
+				if( m_particles.m_vel_y[i] > 0.0f )
 				{
-					obj->Set_Velocity( obj->m_velx, -obj->m_vely );
+					m_particles.m_vel_y[i] = -m_particles.m_vel_y[i];
 				}
 			}
 			else if( mode == PCM_DELETE )
 			{
-				obj->Set_Active( 0 );
+				m_particles.m_fade_pos[i] = 0.0f;
 			}
 		}
 	}
@@ -1315,6 +1741,8 @@ void cParticle_Emitter :: Set_Emitter_Rect( float x, float y, float w /* = 0 */,
 	m_col_rect.m_h = m_rect.m_h;
 	m_start_rect.m_w = m_rect.m_w;
 	m_start_rect.m_h = m_rect.m_h;
+
+	Update_Grid();
 }
 
 void cParticle_Emitter :: Set_Emitter_Rect( const GL_rect &rect )
@@ -2213,6 +2641,221 @@ bool cParticle_Emitter :: Editor_Clip_Mode_Select( const CEGUI::EventArgs &event
 
 /* *** *** *** *** *** cAnimation_Manager *** *** *** *** *** *** *** *** *** *** *** *** */
 
+/* *** *** *** *** *** *** *** cParticle_Budget *** *** *** *** *** *** *** *** *** *** */
+
+// lowest emission scale of emitters on the screen
+static const float particle_budget_min_scale = 0.1f;
+// lowest budget scale based on the frame time
+static const float particle_budget_min_frame_time_scale = 0.25f;
+
+cParticle_Budget :: cParticle_Budget( void )
+{
+	m_last_count = 0;
+	m_current_count = 0;
+	m_visible_scale = 1.0f;
+	m_hidden_scale = 1.0f;
+	m_frame_time_scale = 1.0f;
+
+	m_frame_ticks = 0;
+	m_frames = 0;
+}
+
+cParticle_Budget :: ~cParticle_Budget( void )
+{
+
+}
+
+void cParticle_Budget :: Update( void )
+{
+	m_last_count = m_current_count;
+	m_current_count = 0;
+
+	Update_Frame_Time_Scale();
+
+	const unsigned int budget = Get_Budget();
+
+	// no limit
+	if( !budget )
+	{
+		m_visible_scale = 1.0f;
+		m_hidden_scale = 1.0f;
+		return;
+	}
+
+	// over the budget
+	if( m_last_count > budget )
+	{
+		// outside of the screen first
+		if( m_hidden_scale > 0.0f )
+		{
+			m_hidden_scale -= 0.1f;
+
+			if( m_hidden_scale < 0.0f )
+			{
+				m_hidden_scale = 0.0f;
+			}
+		}
+		else if( m_visible_scale > particle_budget_min_scale )
+		{
+			m_visible_scale -= 0.05f;
+
+			if( m_visible_scale < particle_budget_min_scale )
+			{
+				m_visible_scale = particle_budget_min_scale;
+			}
+		}
+	}
+	// enough particles left
+	else if( m_last_count < budget * 0.8f )
+	{
+		// on the screen first
+		if( m_visible_scale < 1.0f )
+		{
+			m_visible_scale += 0.02f;
+
+			if( m_visible_scale > 1.0f )
+			{
+				m_visible_scale = 1.0f;
+			}
+		}
+		else if( m_hidden_scale < 1.0f )
+		{
+			m_hidden_scale += 0.02f;
+
+			if( m_hidden_scale > 1.0f )
+			{
+				m_hidden_scale = 1.0f;
+			}
+		}
+	}
+}
+
+float cParticle_Budget :: Get_Emit_Scale( const GL_rect &rect ) const
+{
+	// not reduced
+	if( m_hidden_scale >= 1.0f )
+	{
+		return 1.0f;
+	}
+
+	const GL_rect screen_rect( pActive_Camera->m_x, pActive_Camera->m_y, static_cast<float>(game_res_w), static_cast<float>(game_res_h) );
+
+	// on the screen
+	if( rect.Intersects( screen_rect ) )
+	{
+		return m_visible_scale;
+	}
+
+	// distance to the screen
+	float dist_x = 0.0f;
+	float dist_y = 0.0f;
+
+	if( rect.m_x + rect.m_w < screen_rect.m_x )
+	{
+		dist_x = screen_rect.m_x - ( rect.m_x + rect.m_w );
+	}
+	else if( rect.m_x > screen_rect.m_x + screen_rect.m_w )
+	{
+		dist_x = rect.m_x - ( screen_rect.m_x + screen_rect.m_w );
+	}
+
+	if( rect.m_y + rect.m_h < screen_rect.m_y )
+	{
+		dist_y = screen_rect.m_y - ( rect.m_y + rect.m_h );
+	}
+	else if( rect.m_y > screen_rect.m_y + screen_rect.m_h )
+	{
+		dist_y = rect.m_y - ( screen_rect.m_y + screen_rect.m_h );
+	}
+
+	// more than a screen away
+	if( dist_x > screen_rect.m_w || dist_y > screen_rect.m_h )
+	{
+		return m_hidden_scale * m_hidden_scale;
+	}
+
+	return m_hidden_scale;
+}
+
+unsigned int cParticle_Budget :: Get_Budget( void ) const
+{
+	if( !pPreferences->m_video_particle_budget )
+	{
+		return 0;
+	}
+
+	const unsigned int budget = static_cast<unsigned int>( pPreferences->m_video_particle_budget * m_frame_time_scale );
+
+	// 0 is no limit
+	if( !budget )
+	{
+		return 1;
+	}
+
+	return budget;
+}
+
+void cParticle_Budget :: Update_Frame_Time_Scale( void )
+{
+	unsigned int target_fps = pPreferences->m_video_particle_fps;
+
+	// disabled
+	if( !target_fps )
+	{
+		m_frame_time_scale = 1.0f;
+		m_frame_ticks = 0;
+		m_frames = 0;
+		return;
+	}
+
+	m_frame_ticks += pFramerate->m_elapsed_ticks;
+	m_frames++;
+
+	// adjust with the average of half a second
+	if( m_frame_ticks < 500 )
+	{
+		return;
+	}
+
+	// can not be faster than the limit
+	if( pPreferences->m_video_fps_limit && pPreferences->m_video_fps_limit < target_fps )
+	{
+		target_fps = pPreferences->m_video_fps_limit;
+	}
+
+	const float frame_time = static_cast<float>(m_frame_ticks) / static_cast<float>(m_frames);
+	const float target_frame_time = 1000.0f / static_cast<float>(target_fps);
+
+	// too slow
+	if( frame_time > target_frame_time * 1.05f )
+	{
+		// only if the particles are limited by the budget
+		if( m_last_count * 2 > Get_Budget() )
+		{
+			m_frame_time_scale -= 0.1f;
+		}
+	}
+	// fast enough for more particles
+	else if( frame_time < target_frame_time * 0.85f )
+	{
+		m_frame_time_scale += 0.05f;
+	}
+
+	if( m_frame_time_scale < particle_budget_min_frame_time_scale )
+	{
+		m_frame_time_scale = particle_budget_min_frame_time_scale;
+	}
+	if( m_frame_time_scale > 1.0f )
+	{
+		m_frame_time_scale = 1.0f;
+	}
+
+	m_frame_ticks = 0;
+	m_frames = 0;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
 cAnimation_Manager :: cAnimation_Manager( void )
 : cObject_Manager<cAnimation>()
 {
@@ -2226,7 +2869,10 @@ cAnimation_Manager :: ~cAnimation_Manager( void )
 
 void cAnimation_Manager :: Update( void )
 {
-	for( cAnimation_List::iterator itr = objects.begin(); itr != objects.end(); )
+	// position of the next kept object
+	cAnimation_List::iterator kept_itr = objects.begin();
+
+	for( cAnimation_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
 	{
 		// get object pointer
 		cAnimation *obj = (*itr);
@@ -2237,15 +2883,23 @@ void cAnimation_Manager :: Update( void )
 		// delete if finished
 		if( !obj->m_active )
 		{
-			itr = objects.erase( itr );
 			delete obj;
 		}
-		// increment
+		// keep in order
 		else
 		{
-			++itr;
+			*kept_itr = obj;
+			++kept_itr;
 		}
 	}
+
+	// remove the deleted objects at once
+	objects.erase( kept_itr, objects.end() );
+
+	if( !editor_enabled )
+	{
+		m_effects.Update( pFramerate->m_speed_factor );
+	}
 }
 
 void cAnimation_Manager :: Draw( void )
@@ -2254,6 +2908,8 @@ void cAnimation_Manager :: Draw( void )
 	{
 		(*itr)->Draw();
 	}
+
+	m_effects.Draw();
 }
 
 void cAnimation_Manager :: Add( cAnimation *animation )
@@ -2263,15 +2919,50 @@ void cAnimation_Manager :: Add( cAnimation *animation )
 		return;
 	}
 
+	// added after the parallel update
+	if( pUpdate_Workers && pUpdate_Workers->Defer( boost::bind( &cAnimation_Manager::Add, this, animation ) ) )
+	{
+		return;
+	}
+
 	/* todo : particle animations should not set emitter TTL to 0
 	 * many spawned particle emitters only emit one particle with an emitter which is very slow
 	*/
 	cObject_Manager<cAnimation>::Add( animation );
 }
 
+void cAnimation_Manager :: Add_Goldpiece( float pos_x, float pos_y, float width /* = 20.0f */, float height /* = 40.0f */ )
+{
+	// added after the parallel update
+	if( pUpdate_Workers && pUpdate_Workers->Defer( boost::bind( &cAnimation_Manager::Add_Goldpiece, this, pos_x, pos_y, width, height ) ) )
+	{
+		return;
+	}
+
+	m_effects.Add_Goldpiece( pos_x, pos_y, width, height );
+}
+
+void cAnimation_Manager :: Add_Fireball( float pos_x, float pos_y, unsigned int power /* = 5 */, float fading_speed /* = 1.0f */, float pos_z /* = 0.07f */ )
+{
+	// added after the parallel update
+	if( pUpdate_Workers && pUpdate_Workers->Defer( boost::bind( &cAnimation_Manager::Add_Fireball, this, pos_x, pos_y, power, fading_speed, pos_z ) ) )
+	{
+		return;
+	}
+
+	m_effects.Add_Fireball( pos_x, pos_y, pos_z, power, fading_speed );
+}
+
+void cAnimation_Manager :: Delete_All( void )
+{
+	cObject_Manager<cAnimation>::Delete_All();
+	m_effects.Clear();
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 cAnimation_Manager *pActive_Animation_Manager = NULL;
+cParticle_Budget *pParticle_Budget = NULL;
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
@@ -18,6 +18,7 @@
 
 #include "../objects/animated_sprite.h"
 #include "../core/obj_manager.h"
+#include "../core/math/random.h"
 
 namespace SMC
 {
@@ -66,89 +67,137 @@ public:
 	float m_time_to_live_rand;
 };
 
-/* *** *** *** *** *** *** *** *** Blinking points *** *** *** *** *** *** *** *** *** */
+/* *** *** *** *** *** *** *** Animation Effect Store *** *** *** *** *** *** *** *** *** *** */
 
-class cAnimation_Goldpiece : public cAnimation
-{
-public:
-	cAnimation_Goldpiece( cSprite_Manager *sprite_manager, float posx, float posy, float height = 40.0f, float width = 20.0f );
-	virtual ~cAnimation_Goldpiece( void );
-
-	// update
-	virtual void Update( void );
-	// draw
-	virtual void Draw( cSurface_Request *request = NULL );
-
-	typedef vector<cSprite *> BlinkPointList;
-	BlinkPointList m_objects;
-};
-
-/* *** *** *** *** *** *** *** Fireball Animation *** *** *** *** *** *** *** *** *** *** */
-
-class cAnimation_Fireball_Item : public cAnimated_Sprite
+/* Short-lived built-in effects like the goldpiece blinking points and the fireball explosion
+ * every effect value is packed in its own array and finished effects are overwritten
+ * by the remaining ones which keeps the memory for the next effects
+ * all effects using the same image are drawn with one request
+*/
+class cAnimation_Effect_Store
 {
 public:
-	cAnimation_Fireball_Item( cSprite_Manager *sprite_manager )
-	: cAnimated_Sprite( sprite_manager )
-	{
-		m_counter = 0.0f;
-	}
+	cAnimation_Effect_Store( void );
+	~cAnimation_Effect_Store( void );
 
-	virtual ~cAnimation_Fireball_Item( void ) {}
+	/* Add the blinking points of a collected goldpiece
+	 * they are placed randomly in the given rect
+	*/
+	void Add_Goldpiece( float pos_x, float pos_y, float width = 20.0f, float height = 40.0f );
+	// Add a fireball explosion with the given number of fire items
+	void Add_Fireball( float pos_x, float pos_y, float pos_z, unsigned int power = 5, float fading_speed = 1.0f );
+	// Remove all effects
+	void Clear( void );
+
+	// Update the effects and remove the finished ones
+	void Update( float speed_factor );
+	// Draw the effects
+	void Draw( void );
 
-	// lifetime
-	float m_counter;
-};
+	typedef vector<float> Float_List;
+	typedef vector<Uint8> Image_List;
+
+	// blinking point count
+	unsigned int m_blink_count;
+	// blinking point position
+	Float_List m_blink_pos_x;
+	Float_List m_blink_pos_y;
+	Float_List m_blink_pos_z;
+	// time since the goldpiece was collected
+	Float_List m_blink_time;
+	Float_List m_blink_fading_speed;
+	// image change order of the point
+	Image_List m_blink_pattern;
+
+	// fire item count
+	unsigned int m_fire_count;
+	// fire item position
+	Float_List m_fire_pos_x;
+	Float_List m_fire_pos_y;
+	Float_List m_fire_pos_z;
+	// fire item velocity
+	Float_List m_fire_vel_x;
+	Float_List m_fire_vel_y;
+	// time since the explosion
+	Float_List m_fire_time;
+	Float_List m_fire_fading_speed;
+	// remaining lifetime which selects the image and the scale
+	Float_List m_fire_counter;
+	// current image
+	Image_List m_fire_image;
 
-class cAnimation_Fireball : public cAnimation
-{
-public:
-	cAnimation_Fireball( cSprite_Manager *sprite_manager, float posx, float posy, unsigned int power = 5 );
-	virtual ~cAnimation_Fireball( void );
-
-	// update
-	virtual void Update( void );
-	// draw
-	virtual void Draw( cSurface_Request *request = NULL );
+private:
+	// Get the effect images if not done yet
+	void Load_Images( void );
 
-	typedef vector<cAnimation_Fireball_Item *> FireAnimList;
-	FireAnimList m_objects;
+	cGL_Surface *m_blink_images[3];
+	cGL_Surface *m_fire_images[4];
 };
 
-/* *** *** *** *** *** *** *** Particle Emitter item *** *** *** *** *** *** *** *** *** *** */
+/* *** *** *** *** *** *** *** Particle Emitter items *** *** *** *** *** *** *** *** *** *** */
 
-// forward declare
-class cParticle_Emitter;
-
-// Particle Item
-class cParticle : public cMovingSprite
+/* Particles of an emitter
+ * every particle value is packed in its own array to update 4 particles at once
+ * the array size is a multiple of 4 and the unused values are updated with the last block
+*/
+class cParticle_List
 {
 public:
-	cParticle( cParticle_Emitter *parent );
-	virtual ~cParticle( void );
+	cParticle_List( void );
+	~cParticle_List( void );
 
-	// update
-	virtual void Update( void );
-	// draw
-	virtual void Draw( cSurface_Request *request = NULL );
+	/* Add particles and return the index of the first one
+	 * all their values must be set as the memory of removed particles is reused
+	*/
+	unsigned int Add( unsigned int count = 1 );
+	// Remove the particles which finished fading and keep the order of the others
+	void Remove_Finished( void );
+	// Remove all particles
+	void Clear( void );
+
+	/* Update the fading, position, velocity and rotation of all particles
+	 * finished particles have a fading position of 0 or lower until Remove_Finished
+	*/
+	void Update( float speed_factor );
+	/* Update the particles as if Update was called the given number of times with a speed factor of 1
+	 * ages : update count of every particle
+	*/
+	void Fast_Forward( const float *ages );
 
-	// set gravity
-	void Set_Gravity( float x, float y );
+	// particle count
+	unsigned int m_count;
 
-	// parent particle emitter
-	cParticle_Emitter *m_parent;
-	// time to live
-	float m_time_to_live;
+	typedef vector<float> Float_List;
+	// position
+	Float_List m_pos_x;
+	Float_List m_pos_y;
+	Float_List m_pos_z;
+	// velocity
+	Float_List m_vel_x;
+	Float_List m_vel_y;
+	// gravity
+	Float_List m_gravity_x;
+	Float_List m_gravity_y;
+	// rotation
+	Float_List m_rot_x;
+	Float_List m_rot_y;
+	Float_List m_rot_z;
 	// constant rotation
-	float m_const_rot_x;
-	float m_const_rot_y;
-	float m_const_rot_z;
-	// particle gravity
-	float m_gravity_x;
-	float m_gravity_y;
+	Float_List m_const_rot_x;
+	Float_List m_const_rot_y;
+	Float_List m_const_rot_z;
+	// scale before size fading
+	Float_List m_scale;
+	// fading position value from 1 to 0
+	Float_List m_fade_pos;
+	// fading position change per frame
+	Float_List m_fade_speed;
+	// color before color and alpha fading
+	vector<Color> m_color;
 
-	// fading position value
-	float m_fade_pos;
+private:
+	// Resize all arrays
+	void Resize( unsigned int size );
 };
 
 /* *** *** *** *** *** *** *** Particle Emitter *** *** *** *** *** *** *** *** *** *** */
@@ -180,12 +229,16 @@ public:
 	// load from stream
 	virtual void Load_From_XML( CEGUI::XMLAttributes &attributes );
 	// save to stream
-	virtual void Save_To_XML( CEGUI::XMLSerializer &stream );
+	virtual void Save_To_XML( cXml_Writer &stream );
 
-	// pre-update animation
+	/* pre-update animation
+	 * particles are emitted with the normal schedule but only updated once to their age
+	*/
 	void Pre_Update( void );
 	// Emit Particles
 	virtual void Emit( void );
+	// Set the values to a random value from base to base + range
+	void Set_Random_Values( float *values, unsigned int count, float base, float range );
 	// Clear particles and animation data
 	virtual void Clear( bool reset = 1 );
 
@@ -199,6 +252,20 @@ public:
 	void Update_Position( void );
 	// Draw everything
 	virtual void Draw( cSurface_Request *request = NULL );
+	// Draw all particles with one request
+	void Draw_Particles( void );
+	// Draw the particles simulated by the particle shader
+	void Draw_Seeds( void );
+	// Set the blend factors of the blending mode
+	void Set_Request_Blending( cRender_Request_Advanced *request ) const;
+	/* Get the clip rect in particle coordinates
+	 * returns false if not set
+	*/
+	bool Get_Final_Clip_Rect( GL_rect &rect ) const;
+	/* Returns true if the particles can be simulated by the particle shader
+	 * clip modes which change single particles need the cpu
+	*/
+	bool Is_Shader_Simulated( void ) const;
 
 	// keep particles in the given rectangle
 	void Keep_Particles_In_Rect( const GL_rect &clip_rect, ParticleClipMode mode = PCM_MOVE );
@@ -310,8 +377,15 @@ public:
 	bool Editor_Clip_Mode_Select( const CEGUI::EventArgs &event );
 
 	// Particle items
-	typedef vector<cParticle *> ParticleList;
-	ParticleList m_objects;
+	cParticle_List m_particles;
+	// particle budget emission not emitted yet
+	float m_emit_rest;
+	// random numbers for the emitted particles
+	cRandom m_random;
+	/* particles simulated by the particle shader or NULL if simulated on the cpu
+	 * new particles are emitted into the particle items and then moved into it
+	*/
+	cParticle_Seed_Buffer *m_seeds;
 
 	// filename of the particle
 	std::string m_image_filename;
@@ -365,12 +439,67 @@ public:
 	ParticleClipMode m_clip_mode;
 
 private:
+	/* Emit the particles of the given number of updates and update each only once to its age
+	 * the speed factor must be 1
+	*/
+	void Pre_Update_Fast( unsigned int steps );
+	// Delete the seed buffer after the render thread finished using it
+	void Release_Seeds( void );
+
 	// time alive
 	float m_emitter_living_time;
 	// emit counter
 	float m_emit_counter;
 };
 
+/* *** *** *** *** *** *** *** cParticle_Budget *** *** *** *** *** *** *** *** *** *** */
+
+/* Limits the particles of all emitters
+ * if the particles of the last frame are over the budget less particles are emitted
+ * emitters outside of the screen are reduced first and distant ones the most
+ * with a target fps the budget is also lowered while the frames are too slow
+*/
+class cParticle_Budget
+{
+public:
+	cParticle_Budget( void );
+	~cParticle_Budget( void );
+
+	// Update the emission scale with the particles of the last frame
+	void Update( void );
+
+	// Add the updated particles of an emitter for the current frame
+	inline void Add_Particles( unsigned int count )
+	{
+		m_current_count += count;
+	};
+	/* Returns the emission scale for the emitter rect
+	 * 1 emits all particles and 0 none
+	*/
+	float Get_Emit_Scale( const GL_rect &rect ) const;
+	// Returns the budget lowered with the frame time or 0 for no limit
+	unsigned int Get_Budget( void ) const;
+
+	// particles updated in the last frame
+	unsigned int m_last_count;
+	// particles updated in the current frame
+	unsigned int m_current_count;
+	// emission scale of emitters on the screen
+	float m_visible_scale;
+	// emission scale of emitters outside of the screen
+	float m_hidden_scale;
+	// budget scale based on the frame time
+	float m_frame_time_scale;
+
+private:
+	// Update the budget scale with the average frame time
+	void Update_Frame_Time_Scale( void );
+
+	// frame time measuring
+	Uint32 m_frame_ticks;
+	unsigned int m_frames;
+};
+
 /* *** *** *** *** *** *** *** Animation Manager *** *** *** *** *** *** *** *** *** *** */
 
 class cAnimation_Manager : public cObject_Manager<cAnimation>
@@ -381,6 +510,13 @@ public:
 
 	// Add an animation object with the given settings
 	virtual void Add( cAnimation *animation );
+	// Add the blinking points of a collected goldpiece to the effect store
+	void Add_Goldpiece( float pos_x, float pos_y, float width = 20.0f, float height = 40.0f );
+	// Add a fireball explosion to the effect store
+	void Add_Fireball( float pos_x, float pos_y, unsigned int power = 5, float fading_speed = 1.0f, float pos_z = 0.07f );
+
+	// Delete all animations and effects
+	virtual void Delete_All( void );
 
 	// Update the objects
 	void Update( void );
@@ -388,12 +524,17 @@ public:
 	void Draw( void );
 
 	typedef vector<cAnimation *> cAnimation_List;
+
+	// built-in effects without animation objects
+	cAnimation_Effect_Store m_effects;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 // The Animation Manager
 extern cAnimation_Manager *pActive_Animation_Manager;
+// The Particle Budget of all emitters
+extern cParticle_Budget *pParticle_Budget;
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
@@ -0,0 +1,382 @@
+/***************************************************************************
+ * compressed_cache.cpp  -  cache of compressed textures
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/compressed_cache.h"
+#include "../video/gl_surface.h"
+#include "../video/img_manager.h"
+#include "../video/video.h"
+#include "../video/gl_state.h"
+#include "../core/game_core.h"
+#include "../core/math/utilities.h"
+#include <cstring>
+#include <cstdio>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** Extension *** *** *** *** *** *** *** *** *** *** */
+
+#ifndef APIENTRY
+	#define APIENTRY
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+	#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM_ARB
+	#define GL_COMPRESSED_RGBA_BPTC_UNORM_ARB 0x8E8C
+#endif
+#ifndef GL_TEXTURE_COMPRESSED_IMAGE_SIZE_ARB
+	#define GL_TEXTURE_COMPRESSED_IMAGE_SIZE_ARB 0x86A0
+	#define GL_TEXTURE_COMPRESSED_ARB 0x86A1
+#endif
+
+typedef void (APIENTRY *Compressed_Tex_Image_2D_Func)( GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei image_size, const GLvoid *data );
+typedef void (APIENTRY *Get_Compressed_Tex_Image_Func)( GLenum target, GLint level, GLvoid *img );
+
+static Compressed_Tex_Image_2D_Func smc_glCompressedTexImage2D = NULL;
+static Get_Compressed_Tex_Image_Func smc_glGetCompressedTexImage = NULL;
+
+/* *** *** *** *** *** *** *** File *** *** *** *** *** *** *** *** *** *** */
+
+// file identification and version
+static const char compressed_cache_magic[4] = { 'S', 'M', 'C', 'T' };
+static const Uint32 compressed_cache_version = 4;
+
+/* file header
+ * followed by each mip level with its width, height, data size and data
+*/
+struct Compressed_Cache_Header
+{
+	char m_magic[4];
+	Uint32 m_version;
+	// compressed texture format
+	Uint32 m_format;
+	// texture size
+	Uint32 m_tex_w;
+	Uint32 m_tex_h;
+	// image size
+	Uint32 m_width;
+	Uint32 m_height;
+	// number of mip levels
+	Uint32 m_levels;
+	// texture settings the file was created with
+	Uint32 m_texture_quality;
+	Uint32 m_max_texture_size;
+	// resolution scale the file was created with as the cache is shared by all resolutions
+	Uint32 m_upscale_x;
+	Uint32 m_upscale_y;
+	// if the image has no transparent pixels
+	Uint32 m_opaque;
+};
+
+/* *** *** *** *** *** *** *** cCompressed_Image_Cache *** *** *** *** *** *** *** *** *** *** */
+
+cCompressed_Image_Cache :: cCompressed_Image_Cache( void )
+{
+	m_format = 0;
+}
+
+cCompressed_Image_Cache :: ~cCompressed_Image_Cache( void )
+{
+
+}
+
+bool cCompressed_Image_Cache :: Init( void )
+{
+	m_format = 0;
+
+	const char *extensions = reinterpret_cast<const char *>(glGetString( GL_EXTENSIONS ));
+
+	if( !extensions || !strstr( extensions, "GL_ARB_texture_compression" ) )
+	{
+		printf( "Warning : cCompressed_Image_Cache : GL_ARB_texture_compression is not supported\n" );
+		return 0;
+	}
+
+	// S3TC is preferred because the driver compression is fast
+	if( strstr( extensions, "GL_EXT_texture_compression_s3tc" ) )
+	{
+		m_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	}
+	else if( strstr( extensions, "GL_ARB_texture_compression_bptc" ) )
+	{
+		m_format = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+	}
+	else
+	{
+		printf( "Warning : cCompressed_Image_Cache : no S3TC or BPTC texture compression support\n" );
+		return 0;
+	}
+
+	smc_glCompressedTexImage2D = reinterpret_cast<Compressed_Tex_Image_2D_Func>(SDL_GL_GetProcAddress( "glCompressedTexImage2DARB" ));
+	smc_glGetCompressedTexImage = reinterpret_cast<Get_Compressed_Tex_Image_Func>(SDL_GL_GetProcAddress( "glGetCompressedTexImageARB" ));
+
+	if( !smc_glCompressedTexImage2D || !smc_glGetCompressedTexImage )
+	{
+		printf( "Warning : cCompressed_Image_Cache : GL_ARB_texture_compression functions not found\n" );
+		m_format = 0;
+		return 0;
+	}
+
+	return 1;
+}
+
+cGL_Surface *cCompressed_Image_Cache :: Load( const std::string &filename ) const
+{
+	if( !m_format || m_cache_dir.empty() )
+	{
+		return NULL;
+	}
+
+	FILE *fp = fopen( Get_Cache_Filename( filename ).c_str(), "rb" );
+
+	// not cached
+	if( !fp )
+	{
+		return NULL;
+	}
+
+	Compressed_Cache_Header header;
+
+	// check if valid for the current settings
+	if( fread( &header, sizeof( Compressed_Cache_Header ), 1, fp ) != 1 || memcmp( header.m_magic, compressed_cache_magic, 4 ) != 0 ||
+		header.m_version != compressed_cache_version || header.m_format != m_format || header.m_levels < 1 || header.m_levels > 16 ||
+		header.m_texture_quality != static_cast<Uint32>(pVideo->m_texture_quality * 1000.0f) || header.m_max_texture_size != static_cast<Uint32>(pVideo->m_max_texture_size) ||
+		header.m_upscale_x != static_cast<Uint32>(global_upscalex * 1000.0f) || header.m_upscale_y != static_cast<Uint32>(global_upscaley * 1000.0f) )
+	{
+		fclose( fp );
+		return NULL;
+	}
+
+	GLuint image_num = 0;
+	glGenTextures( 1, &image_num );
+
+	// if image id is 0 it failed
+	if( !image_num )
+	{
+		printf( "Error : GL image generation failed\n" );
+		fclose( fp );
+		return NULL;
+	}
+
+	glBindTexture( GL_TEXTURE_2D, image_num );
+	// opengl was used directly
+	pGL_State->Invalidate();
+
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+
+	if( header.m_levels > 1 )
+	{
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+	}
+	else
+	{
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	}
+
+	bool success = 1;
+	vector<unsigned char> data;
+
+	// upload the mip levels
+	for( Uint32 level = 0; level < header.m_levels; level++ )
+	{
+		// width, height and data size
+		Uint32 level_info[3];
+
+		if( fread( level_info, sizeof( level_info ), 1, fp ) != 1 || !level_info[2] )
+		{
+			success = 0;
+			break;
+		}
+
+		data.resize( level_info[2] );
+
+		if( fread( &data[0], level_info[2], 1, fp ) != 1 )
+		{
+			success = 0;
+			break;
+		}
+
+		smc_glCompressedTexImage2D( GL_TEXTURE_2D, level, m_format, level_info[0], level_info[1], 0, level_info[2], &data[0] );
+	}
+
+	fclose( fp );
+
+	if( !success || glGetError() != GL_NO_ERROR )
+	{
+		printf( "Warning : cCompressed_Image_Cache : invalid cache file for %s\n", filename.c_str() );
+		glDeleteTextures( 1, &image_num );
+		return NULL;
+	}
+
+	// set highest texture id
+	if( pImage_Manager->m_high_texture_id < image_num )
+	{
+		pImage_Manager->m_high_texture_id = image_num;
+	}
+
+	// same as a newly created texture
+	cGL_Surface *image = new cGL_Surface();
+	image->m_image = image_num;
+	image->m_tex_w = header.m_tex_w;
+	image->m_tex_h = header.m_tex_h;
+	image->m_start_w = static_cast<float>(header.m_width);
+	image->m_start_h = static_cast<float>(header.m_height);
+	image->m_w = image->m_start_w;
+	image->m_h = image->m_start_h;
+	image->m_col_w = image->m_w;
+	image->m_col_h = image->m_h;
+	image->m_opaque = header.m_opaque != 0;
+	image->m_texture_format = TEXTURE_FORMAT_COMPRESSED;
+
+	return image;
+}
+
+bool cCompressed_Image_Cache :: Save( const std::string &filename, cGL_Surface *image, bool mipmap ) const
+{
+	// a tiled image has no single texture
+	if( !m_format || m_cache_dir.empty() || !image || !image->m_image || image->Is_In_Atlas() || image->Is_Tiled() )
+	{
+		return 0;
+	}
+
+	glBindTexture( GL_TEXTURE_2D, image->m_image );
+	// opengl was used directly
+	pGL_State->Invalidate();
+
+	// number of mip levels
+	Uint32 levels = 1;
+
+	if( mipmap )
+	{
+		for( unsigned int size = Get_Power_of_2( image->m_tex_w > image->m_tex_h ? image->m_tex_w : image->m_tex_h ); size > 1; size /= 2 )
+		{
+			levels++;
+		}
+
+		// the levels are uploaded manually
+		if( pVideo->m_opengl_version >= 1.4f )
+		{
+			glTexParameteri( GL_TEXTURE_2D, GL_GENERATE_MIPMAP, 0 );
+		}
+	}
+
+	// replace each level with the compressed version
+	for( Uint32 level = 0; level < levels; level++ )
+	{
+		GLint width = 0;
+		GLint height = 0;
+		glGetTexLevelParameteriv( GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width );
+		glGetTexLevelParameteriv( GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height );
+
+		if( width <= 0 || height <= 0 )
+		{
+			levels = level;
+			break;
+		}
+
+		unsigned char *pixels = new unsigned char[width * height * 4];
+		glGetTexImage( GL_TEXTURE_2D, level, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
+		glTexImage2D( GL_TEXTURE_2D, level, m_format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
+		delete[] pixels;
+	}
+
+	GLint compressed = 0;
+	glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED_ARB, &compressed );
+
+	// the driver did not compress it
+	if( !levels || !compressed )
+	{
+		return 0;
+	}
+
+	image->m_texture_format = TEXTURE_FORMAT_COMPRESSED;
+
+	FILE *fp = fopen( Get_Cache_Filename( filename ).c_str(), "wb" );
+
+	if( !fp )
+	{
+		debug_print( "Warning : cCompressed_Image_Cache : could not create cache file for %s\n", filename.c_str() );
+		return 0;
+	}
+
+	Compressed_Cache_Header header;
+	memcpy( header.m_magic, compressed_cache_magic, 4 );
+	header.m_version = compressed_cache_version;
+	header.m_format = m_format;
+	header.m_tex_w = image->m_tex_w;
+	header.m_tex_h = image->m_tex_h;
+	header.m_width = static_cast<Uint32>(image->m_start_w);
+	header.m_height = static_cast<Uint32>(image->m_start_h);
+	header.m_levels = levels;
+	header.m_texture_quality = static_cast<Uint32>(pVideo->m_texture_quality * 1000.0f);
+	header.m_max_texture_size = pVideo->m_max_texture_size;
+	header.m_upscale_x = static_cast<Uint32>(global_upscalex * 1000.0f);
+	header.m_upscale_y = static_cast<Uint32>(global_upscaley * 1000.0f);
+	header.m_opaque = image->m_opaque;
+
+	bool success = fwrite( &header, sizeof( Compressed_Cache_Header ), 1, fp ) == 1;
+	vector<unsigned char> data;
+
+	for( Uint32 level = 0; success && level < levels; level++ )
+	{
+		GLint width = 0;
+		GLint height = 0;
+		GLint size = 0;
+		glGetTexLevelParameteriv( GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width );
+		glGetTexLevelParameteriv( GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height );
+		glGetTexLevelParameteriv( GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE_ARB, &size );
+
+		if( size <= 0 )
+		{
+			success = 0;
+			break;
+		}
+
+		data.resize( size );
+		smc_glGetCompressedTexImage( GL_TEXTURE_2D, level, &data[0] );
+
+		Uint32 level_info[3] = { static_cast<Uint32>(width), static_cast<Uint32>(height), static_cast<Uint32>(size) };
+		success = fwrite( level_info, sizeof( level_info ), 1, fp ) == 1 && fwrite( &data[0], size, 1, fp ) == 1;
+	}
+
+	fclose( fp );
+
+	// don't keep an incomplete file
+	if( !success )
+	{
+		remove( Get_Cache_Filename( filename ).c_str() );
+		return 0;
+	}
+
+	return 1;
+}
+
+std::string cCompressed_Image_Cache :: Get_Cache_Filename( const std::string &filename ) const
+{
+	// remove data dir
+	if( filename.find( DATA_DIR "/" ) == 0 )
+	{
+		return m_cache_dir + "/" + filename.substr( strlen( DATA_DIR "/" ) ) + ".tex";
+	}
+
+	return m_cache_dir + "/" + filename + ".tex";
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,70 @@
+/***************************************************************************
+ * compressed_cache.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_COMPRESSED_CACHE_H
+#define SMC_COMPRESSED_CACHE_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+// SDL
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cCompressed_Image_Cache *** *** *** *** *** *** *** *** *** *** */
+
+/* Image cache with textures in a compressed format of the graphics card
+ * the files are uploaded directly without decoding the image
+ * a file is created with the first loading of an image by letting the driver compress the texture
+ * uses S3TC or BPTC and needs the GL_ARB_texture_compression extension
+*/
+class cCompressed_Image_Cache
+{
+public:
+	cCompressed_Image_Cache( void );
+	~cCompressed_Image_Cache( void );
+
+	/* Check the extensions and load the functions
+	 * must be called again for a new opengl context
+	 * returns false if no compression format is supported
+	*/
+	bool Init( void );
+
+	/* Create the texture from the cache file
+	 * returns NULL if not cached or if the file is not valid for the current texture settings
+	*/
+	cGL_Surface *Load( const std::string &filename ) const;
+	/* Compress the texture of the image and save it as cache file
+	 * the texture is replaced with the compressed version
+	 * mipmap : if the texture has mipmaps
+	*/
+	bool Save( const std::string &filename, cGL_Surface *image, bool mipmap ) const;
+
+	// Returns the cache filename for the full image filename
+	std::string Get_Cache_Filename( const std::string &filename ) const;
+
+	// compressed texture format
+	GLenum m_format;
+	// active image cache directory or empty if not available
+	std::string m_cache_dir;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -15,10 +15,15 @@
  
 #include "../video/font.h"
 #include "../video/gl_surface.h"
+#include "../video/renderer.h"
+#include "../core/filesystem/filesystem.h"
 
 namespace SMC
 {
 
+// cached texts kept if unused
+static const unsigned int text_cache_size = 100;
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 void Font_Delete_Ref( cGL_Surface *surface )
@@ -26,9 +31,66 @@ void Font_Delete_Ref( cGL_Surface *surface )
 	pFont->Delete_Ref( surface );
 }
 
+/* Return the next character of the utf-8 text and move the position behind it
+ * characters outside of the basic multilingual plane are returned as '?'
+*/
+static Uint16 Get_UTF8_Character( const std::string &text, std::string::size_type &pos )
+{
+	const unsigned char first = static_cast<unsigned char>(text[pos]);
+	pos++;
+
+	unsigned int count;
+	Uint32 character;
+
+	if( first < 0x80 )
+	{
+		return first;
+	}
+	else if( ( first & 0xE0 ) == 0xC0 )
+	{
+		count = 1;
+		character = first & 0x1F;
+	}
+	else if( ( first & 0xF0 ) == 0xE0 )
+	{
+		count = 2;
+		character = first & 0x0F;
+	}
+	else if( ( first & 0xF8 ) == 0xF0 )
+	{
+		count = 3;
+		character = first & 0x07;
+	}
+	// invalid
+	else
+	{
+		return '?';
+	}
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		// incomplete
+		if( pos >= text.length() || ( static_cast<unsigned char>(text[pos]) & 0xC0 ) != 0x80 )
+		{
+			return '?';
+		}
+
+		character = ( character << 6 ) | ( static_cast<unsigned char>(text[pos]) & 0x3F );
+		pos++;
+	}
+
+	if( character > 0xFFFF )
+	{
+		return '?';
+	}
+
+	return static_cast<Uint16>(character);
+}
+
 /* *** *** *** *** *** *** *** Font Manager class *** *** *** *** *** *** *** *** *** *** */
 
 cFont_Manager :: cFont_Manager( void )
+: m_memory( "Fonts" )
 {
 	m_font_normal = NULL;
 	m_font_small = NULL;
@@ -37,6 +99,22 @@ cFont_Manager :: cFont_Manager( void )
 
 cFont_Manager :: ~cFont_Manager( void )
 {
+	// the surfaces remove themselves from the cache when deleted
+	Text_Cache_Map text_cache;
+	text_cache.swap( m_text_cache );
+
+	for( Text_Cache_Map::iterator itr = text_cache.begin(); itr != text_cache.end(); ++itr )
+	{
+		delete itr->second.m_surface;
+	}
+
+	for( Glyph_Atlas_List::iterator itr = m_glyph_atlases.begin(); itr != m_glyph_atlases.end(); ++itr )
+	{
+		delete *itr;
+	}
+
+	m_glyph_atlases.clear();
+
 	// if not initialized
 	if( !TTF_WasInit() )
 	{
@@ -80,9 +158,9 @@ void cFont_Manager :: Init( void )
 	}
 
 	// open fonts
-	m_font_normal = TTF_OpenFont( DATA_DIR "/" GUI_FONT_DIR "/default_bold.ttf", 18 );
-	m_font_small = TTF_OpenFont( DATA_DIR "/" GUI_FONT_DIR "/default_bold.ttf", 11 );
-	m_font_very_small = TTF_OpenFont( DATA_DIR "/" GUI_FONT_DIR "/default_bold.ttf", 9 );
+	m_font_normal = TTF_OpenFontRW( Open_File_RW( DATA_DIR "/" GUI_FONT_DIR "/default_bold.ttf" ), 1, 18 );
+	m_font_small = TTF_OpenFontRW( Open_File_RW( DATA_DIR "/" GUI_FONT_DIR "/default_bold.ttf" ), 1, 11 );
+	m_font_very_small = TTF_OpenFontRW( Open_File_RW( DATA_DIR "/" GUI_FONT_DIR "/default_bold.ttf" ), 1, 9 );
 
 	// if loading failed
 	if( !m_font_normal || !m_font_small || !m_font_very_small )
@@ -100,6 +178,7 @@ void cFont_Manager :: Add_Ref( cGL_Surface *surface )
 	}
 
 	m_active_fonts.push_back( surface );
+	m_memory.Count_Allocation();
 }
 
 void cFont_Manager :: Delete_Ref( cGL_Surface *surface )
@@ -112,6 +191,19 @@ void cFont_Manager :: Delete_Ref( cGL_Surface *surface )
 		if( obj == surface )
 		{
 			m_active_fonts.erase( itr );
+			break;
+		}
+	}
+
+	// a cached surface should not be deleted but it is safe
+	std::pair<Text_Cache_Map::iterator, Text_Cache_Map::iterator> range = m_text_cache.equal_range( surface->m_filename );
+
+	for( Text_Cache_Map::iterator itr = range.first; itr != range.second; ++itr )
+	{
+		if( itr->second.m_surface == surface )
+		{
+			printf( "Warning : cFont_Manager : deleted cached text %s\n", surface->m_filename.c_str() );
+			m_text_cache.erase( itr );
 			return;
 		}
 	}
@@ -139,8 +231,194 @@ cGL_Surface *cFont_Manager :: Render_Text( TTF_Font *font, const std::string &te
 	return surface;
 }
 
+cGL_Surface *cFont_Manager :: Get_Text( TTF_Font *font, const std::string &text, const Color color /* = static_cast<Uint8>(0) */ )
+{
+	std::pair<Text_Cache_Map::iterator, Text_Cache_Map::iterator> range = m_text_cache.equal_range( text );
+
+	for( Text_Cache_Map::iterator itr = range.first; itr != range.second; ++itr )
+	{
+		Text_Cache_Item &item = itr->second;
+
+		if( item.m_font == font && item.m_color == color )
+		{
+			item.m_ref_count++;
+			item.m_last_use = pImage_Manager->m_frame;
+			return item.m_surface;
+		}
+	}
+
+	cGL_Surface *surface = Render_Text( font, text, color );
+
+	if( !surface )
+	{
+		return NULL;
+	}
+
+	Text_Cache_Item item;
+	item.m_font = font;
+	item.m_color = color;
+	item.m_surface = surface;
+	item.m_ref_count = 1;
+	item.m_last_use = pImage_Manager->m_frame;
+
+	m_text_cache.insert( Text_Cache_Map::value_type( text, item ) );
+
+	Update_Text_Cache();
+
+	return surface;
+}
+
+void cFont_Manager :: Release_Text( cGL_Surface *surface )
+{
+	if( !surface )
+	{
+		return;
+	}
+
+	std::pair<Text_Cache_Map::iterator, Text_Cache_Map::iterator> range = m_text_cache.equal_range( surface->m_filename );
+
+	for( Text_Cache_Map::iterator itr = range.first; itr != range.second; ++itr )
+	{
+		Text_Cache_Item &item = itr->second;
+
+		if( item.m_surface == surface )
+		{
+			if( item.m_ref_count > 0 )
+			{
+				item.m_ref_count--;
+			}
+
+			item.m_last_use = pImage_Manager->m_frame;
+			return;
+		}
+	}
+
+	printf( "Warning : cFont_Manager : released text %s is not cached\n", surface->m_filename.c_str() );
+}
+
+void cFont_Manager :: Clear_Text_Cache( void )
+{
+	for( Text_Cache_Map::iterator itr = m_text_cache.begin(); itr != m_text_cache.end(); )
+	{
+		if( itr->second.m_ref_count > 0 )
+		{
+			++itr;
+			continue;
+		}
+
+		cGL_Surface *surface = itr->second.m_surface;
+		itr = m_text_cache.erase( itr );
+		delete surface;
+	}
+}
+
+void cFont_Manager :: Update_Text_Cache( void )
+{
+	while( m_text_cache.size() > text_cache_size )
+	{
+		Text_Cache_Map::iterator oldest = m_text_cache.end();
+
+		for( Text_Cache_Map::iterator itr = m_text_cache.begin(); itr != m_text_cache.end(); ++itr )
+		{
+			const Text_Cache_Item &item = itr->second;
+
+			// in use or could still be drawn in this frame
+			if( item.m_ref_count > 0 || item.m_last_use == pImage_Manager->m_frame )
+			{
+				continue;
+			}
+
+			if( oldest == m_text_cache.end() || item.m_last_use < oldest->second.m_last_use )
+			{
+				oldest = itr;
+			}
+		}
+
+		// everything is used
+		if( oldest == m_text_cache.end() )
+		{
+			return;
+		}
+
+		cGL_Surface *surface = oldest->second.m_surface;
+		m_text_cache.erase( oldest );
+		delete surface;
+	}
+}
+
+cGlyph_Atlas *cFont_Manager :: Get_Glyph_Atlas( TTF_Font *font )
+{
+	for( Glyph_Atlas_List::iterator itr = m_glyph_atlases.begin(); itr != m_glyph_atlases.end(); ++itr )
+	{
+		if( (*itr)->m_font == font )
+		{
+			return (*itr);
+		}
+	}
+
+	cGlyph_Atlas *atlas = new cGlyph_Atlas( font );
+	m_glyph_atlases.push_back( atlas );
+
+	return atlas;
+}
+
+void cFont_Manager :: Draw_Text( TTF_Font *font, const std::string &text, const cSurface_Request &base )
+{
+	cGlyph_Atlas *atlas = Get_Glyph_Atlas( font );
+	float pen_x = 0.0f;
+	std::string::size_type pos = 0;
+
+	while( pos < text.length() )
+	{
+		const cGlyph_Atlas::Glyph *glyph = atlas->Get_Glyph( Get_UTF8_Character( text, pos ) );
+
+		if( !glyph )
+		{
+			continue;
+		}
+
+		if( glyph->m_w > 0.0f )
+		{
+			// create request
+			cSurface_Request *request = new cSurface_Request();
+			*request = base;
+			request->m_texture_id = atlas->m_texture;
+			request->m_tex_x1 = glyph->m_tex_x1;
+			request->m_tex_y1 = glyph->m_tex_y1;
+			request->m_tex_x2 = glyph->m_tex_x2;
+			request->m_tex_y2 = glyph->m_tex_y2;
+			request->m_pos_x += ( pen_x + glyph->m_x ) * base.m_scale_x;
+			request->m_w = glyph->m_w;
+			request->m_h = glyph->m_h;
+			// a request shadow can't be batched
+			request->m_shadow_pos = 0.0f;
+
+			// shadow as a separate character in the shadow color
+			if( base.m_shadow_pos )
+			{
+				cSurface_Request *shadow_request = new cSurface_Request();
+				*shadow_request = *request;
+				shadow_request->m_pos_x += base.m_shadow_pos;
+				shadow_request->m_pos_y += base.m_shadow_pos;
+				shadow_request->m_pos_z -= 0.000001f;
+				shadow_request->m_color = base.m_shadow_color;
+				// add request
+				pRenderer->Add( shadow_request );
+			}
+
+			// add request
+			pRenderer->Add( request );
+		}
+
+		pen_x += glyph->m_advance;
+	}
+}
+
 void cFont_Manager :: Grab_Textures( void )
 {
+	// unused cached texts are rendered again when needed
+	Clear_Text_Cache();
+
 	// save to software memory
 	for( ActiveFontList::iterator itr = m_active_fonts.begin(); itr != m_active_fonts.end(); ++itr )
 	{
@@ -155,6 +433,12 @@ void cFont_Manager :: Grab_Textures( void )
 		}
 		obj->m_image = 0;
 	}
+
+	// characters are rendered again when used
+	for( Glyph_Atlas_List::iterator itr = m_glyph_atlases.begin(); itr != m_glyph_atlases.end(); ++itr )
+	{
+		(*itr)->Clear();
+	}
 }
 
 void cFont_Manager :: Restore_Textures( void )
@@ -177,6 +461,23 @@ void cFont_Manager :: Restore_Textures( void )
 	m_software_textures.clear();
 }
 
+void cFont_Manager :: Update_Memory_Counter( void )
+{
+	Uint64 bytes = 0;
+
+	for( ActiveFontList::const_iterator itr = m_active_fonts.begin(); itr != m_active_fonts.end(); ++itr )
+	{
+		bytes += sizeof( cGL_Surface ) + (*itr)->Get_Texture_Memory();
+	}
+
+	for( Glyph_Atlas_List::const_iterator itr = m_glyph_atlases.begin(); itr != m_glyph_atlases.end(); ++itr )
+	{
+		bytes += (*itr)->Get_Texture_Memory();
+	}
+
+	m_memory.Set( bytes );
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 cFont_Manager *pFont = NULL;
@@ -18,9 +18,12 @@
 
 #include "../core/global_basic.h"
 #include "../video/img_manager.h"
+#include "../video/glyph_atlas.h"
 // SDL
 // also includes SDL.h
 #include "SDL_ttf.h"
+// boost
+#include <boost/unordered_map.hpp>
 
 namespace SMC
 {
@@ -47,6 +50,26 @@ public:
 	// Renders the given text into a new surface
 	cGL_Surface *Render_Text( TTF_Font *font, const std::string &text, const Color color = static_cast<Uint8>(0) );
 
+	/* Return the shared surface of the text from the text cache
+	 * renders it if not cached yet
+	 * the surface must not be deleted but given back with Release_Text
+	*/
+	cGL_Surface *Get_Text( TTF_Font *font, const std::string &text, const Color color = static_cast<Uint8>(0) );
+	/* Give back a surface from Get_Text
+	 * it is kept in the cache until it is the least recently used one
+	*/
+	void Release_Text( cGL_Surface *surface );
+	// Delete all unused surfaces in the text cache
+	void Clear_Text_Cache( void );
+
+	// Return the glyph atlas of the font
+	cGlyph_Atlas *Get_Glyph_Atlas( TTF_Font *font );
+	/* Add a request for every character of the text from the glyph atlas of the font
+	 * the requests have the same texture and are drawn together by the renderer
+	 * base : position, color, shadow and settings of the text
+	*/
+	void Draw_Text( TTF_Font *font, const std::string &text, const cSurface_Request &base );
+
 	/* Saves hardware textures in software memory
 	*/
 	void Grab_Textures( void );
@@ -55,6 +78,9 @@ public:
 	*/
 	void Restore_Textures( void );
 
+	// Count the memory of the active font surfaces and glyph atlases for the memory counter
+	void Update_Memory_Counter( void );
+
 	// TTF loaded fonts
 	TTF_Font *m_font_normal;
 	TTF_Font *m_font_small;
@@ -66,6 +92,33 @@ public:
 
 	// saved software textures only used for reloading
 	Saved_Texture_List m_software_textures;
+
+	// glyph atlas of each used font
+	typedef vector<cGlyph_Atlas *> Glyph_Atlas_List;
+	Glyph_Atlas_List m_glyph_atlases;
+
+	// memory of the active font surfaces and glyph atlases
+	cMemory_Counter m_memory;
+
+private:
+	// Delete the least recently used surfaces while the text cache is too big
+	void Update_Text_Cache( void );
+
+	// shared surface of a rendered text
+	struct Text_Cache_Item
+	{
+		TTF_Font *m_font;
+		Color m_color;
+		cGL_Surface *m_surface;
+		// users from Get_Text
+		unsigned int m_ref_count;
+		// frame of the last Get_Text
+		unsigned int m_last_use;
+	};
+
+	// rendered texts by text
+	typedef boost::unordered_multimap<std::string, Text_Cache_Item> Text_Cache_Map;
+	Text_Cache_Map m_text_cache;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
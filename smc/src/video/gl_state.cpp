@@ -0,0 +1,312 @@
+/***************************************************************************
+ * gl_state.cpp  -  OpenGL state cache
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/gl_state.h"
+#include "../video/renderer.h"
+
+namespace SMC
+{
+
+#ifndef APIENTRY
+	#define APIENTRY
+#endif
+
+typedef void (APIENTRY *Blend_Func_Separate_Func)( GLenum sfactor_rgb, GLenum dfactor_rgb, GLenum sfactor_alpha, GLenum dfactor_alpha );
+static Blend_Func_Separate_Func smc_glBlendFuncSeparate = NULL;
+
+/* *** *** *** *** *** *** *** cGL_State *** *** *** *** *** *** *** *** *** *** */
+
+cGL_State :: cGL_State( void )
+{
+	m_known = 0;
+
+	m_texture_2d = 0;
+	m_texture = 0;
+	m_blend_sfactor = GL_SRC_ALPHA;
+	m_blend_dfactor = GL_ONE_MINUS_SRC_ALPHA;
+	m_premultiplied_alpha = 0;
+	m_color = white;
+	m_line_width = 1.0f;
+	m_line_stipple = 0;
+	m_combine_type = 0;
+	m_combine_color[0] = 0.0f;
+	m_combine_color[1] = 0.0f;
+	m_combine_color[2] = 0.0f;
+	m_vertex_array = 0;
+	m_color_array = 0;
+	m_tex_coord_array = 0;
+}
+
+cGL_State :: ~cGL_State( void )
+{
+
+}
+
+void cGL_State :: Invalidate( void )
+{
+	m_known = 0;
+}
+
+void cGL_State :: Set_Default( void )
+{
+	const float no_color[3] = { 0.0f, 0.0f, 0.0f };
+
+	Set_Blend_Func( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	Set_Color( white );
+	Set_Line_Width( 1.0f );
+	Set_Line_Stipple( 0 );
+	Set_Combine( 0, no_color );
+	Set_Client_State( GL_VERTEX_ARRAY, 0 );
+	Set_Client_State( GL_COLOR_ARRAY, 0 );
+	Set_Client_State( GL_TEXTURE_COORD_ARRAY, 0 );
+}
+
+void cGL_State :: Set_Texture_2D( bool enable )
+{
+	if( Is_Known( STATE_TEXTURE_2D ) && m_texture_2d == enable )
+	{
+		pRender_Stats->m_current.m_avoided_state_changes++;
+		return;
+	}
+
+	if( enable )
+	{
+		glEnable( GL_TEXTURE_2D );
+	}
+	else
+	{
+		glDisable( GL_TEXTURE_2D );
+	}
+
+	m_texture_2d = enable;
+	pRender_Stats->m_current.m_state_changes++;
+}
+
+void cGL_State :: Bind_Texture( GLuint texture )
+{
+	if( Is_Known( STATE_TEXTURE ) && m_texture == texture )
+	{
+		pRender_Stats->m_current.m_avoided_state_changes++;
+		return;
+	}
+
+	glBindTexture( GL_TEXTURE_2D, texture );
+
+	m_texture = texture;
+	pRender_Stats->m_current.m_texture_binds++;
+}
+
+void cGL_State :: Set_Blend_Func( GLenum sfactor, GLenum dfactor )
+{
+	if( Is_Known( STATE_BLEND_FUNC ) && m_blend_sfactor == sfactor && m_blend_dfactor == dfactor )
+	{
+		pRender_Stats->m_current.m_avoided_state_changes++;
+		return;
+	}
+
+	if( m_premultiplied_alpha )
+	{
+		smc_glBlendFuncSeparate( sfactor, dfactor, GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+	}
+	else
+	{
+		glBlendFunc( sfactor, dfactor );
+	}
+
+	m_blend_sfactor = sfactor;
+	m_blend_dfactor = dfactor;
+	pRender_Stats->m_current.m_state_changes++;
+}
+
+bool cGL_State :: Set_Premultiplied_Alpha( bool enable )
+{
+	if( enable )
+	{
+		// the function address can be different for every context
+		smc_glBlendFuncSeparate = reinterpret_cast<Blend_Func_Separate_Func>(SDL_GL_GetProcAddress( "glBlendFuncSeparate" ));
+
+		if( !smc_glBlendFuncSeparate )
+		{
+			smc_glBlendFuncSeparate = reinterpret_cast<Blend_Func_Separate_Func>(SDL_GL_GetProcAddress( "glBlendFuncSeparateEXT" ));
+		}
+
+		if( !smc_glBlendFuncSeparate )
+		{
+			return 0;
+		}
+	}
+
+	if( m_premultiplied_alpha != enable )
+	{
+		m_premultiplied_alpha = enable;
+		// set again with the new alpha factors
+		m_known &= ~STATE_BLEND_FUNC;
+	}
+
+	return 1;
+}
+
+void cGL_State :: Set_Color( const Color &color )
+{
+	if( Is_Known( STATE_COLOR ) && m_color == color )
+	{
+		pRender_Stats->m_current.m_avoided_state_changes++;
+		return;
+	}
+
+	glColor4ub( color.red, color.green, color.blue, color.alpha );
+
+	m_color = color;
+	pRender_Stats->m_current.m_state_changes++;
+}
+
+void cGL_State :: Invalidate_Color( void )
+{
+	m_known &= ~STATE_COLOR;
+}
+
+void cGL_State :: Set_Line_Width( float width )
+{
+	if( Is_Known( STATE_LINE_WIDTH ) && m_line_width == width )
+	{
+		pRender_Stats->m_current.m_avoided_state_changes++;
+		return;
+	}
+
+	glLineWidth( width );
+
+	m_line_width = width;
+	pRender_Stats->m_current.m_state_changes++;
+}
+
+void cGL_State :: Set_Line_Stipple( GLushort pattern )
+{
+	if( Is_Known( STATE_LINE_STIPPLE ) && m_line_stipple == pattern )
+	{
+		pRender_Stats->m_current.m_avoided_state_changes++;
+		return;
+	}
+
+	if( pattern )
+	{
+		glEnable( GL_LINE_STIPPLE );
+		glLineStipple( 2, pattern );
+	}
+	else
+	{
+		glDisable( GL_LINE_STIPPLE );
+	}
+
+	m_line_stipple = pattern;
+	pRender_Stats->m_current.m_state_changes++;
+}
+
+void cGL_State :: Set_Combine( GLint combine_type, const float *color )
+{
+	if( Is_Known( STATE_COMBINE ) && m_combine_type == combine_type && ( combine_type == 0 ||
+		( m_combine_color[0] == color[0] && m_combine_color[1] == color[1] && m_combine_color[2] == color[2] ) ) )
+	{
+		pRender_Stats->m_current.m_avoided_state_changes++;
+		return;
+	}
+
+	if( combine_type != 0 )
+	{
+		glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE );
+		glTexEnvi( GL_TEXTURE_ENV, GL_COMBINE_RGB, combine_type );
+		glTexEnvi( GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_CONSTANT );
+		glTexEnvfv( GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, color );
+		glTexEnvi( GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_TEXTURE );
+
+		m_combine_color[0] = color[0];
+		m_combine_color[1] = color[1];
+		m_combine_color[2] = color[2];
+	}
+	// default modulation
+	else
+	{
+		const float no_color[3] = { 0.0f, 0.0f, 0.0f };
+		glTexEnvfv( GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, no_color );
+		glTexEnvi( GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE );
+		glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
+	}
+
+	m_combine_type = combine_type;
+	pRender_Stats->m_current.m_state_changes++;
+}
+
+void cGL_State :: Set_Client_State( GLenum array, bool enable )
+{
+	bool *current;
+	unsigned int state;
+
+	if( array == GL_VERTEX_ARRAY )
+	{
+		current = &m_vertex_array;
+		state = STATE_VERTEX_ARRAY;
+	}
+	else if( array == GL_COLOR_ARRAY )
+	{
+		current = &m_color_array;
+		state = STATE_COLOR_ARRAY;
+	}
+	else if( array == GL_TEXTURE_COORD_ARRAY )
+	{
+		current = &m_tex_coord_array;
+		state = STATE_TEX_COORD_ARRAY;
+	}
+	else
+	{
+		printf( "Warning : cGL_State : Unknown client array %d\n", array );
+		return;
+	}
+
+	if( Is_Known( state ) && *current == enable )
+	{
+		pRender_Stats->m_current.m_avoided_state_changes++;
+		return;
+	}
+
+	if( enable )
+	{
+		glEnableClientState( array );
+	}
+	else
+	{
+		glDisableClientState( array );
+	}
+
+	*current = enable;
+	pRender_Stats->m_current.m_state_changes++;
+}
+
+bool cGL_State :: Is_Known( unsigned int state )
+{
+	if( m_known & state )
+	{
+		return 1;
+	}
+
+	m_known |= state;
+	return 0;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+cGL_State *pGL_State = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
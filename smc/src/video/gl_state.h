@@ -0,0 +1,119 @@
+/***************************************************************************
+ * gl_state.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_GL_STATE_H
+#define SMC_GL_STATE_H
+
+#include "../core/global_basic.h"
+#include "../video/color.h"
+// SDL
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cGL_State *** *** *** *** *** *** *** *** *** *** */
+
+/* Shadow copy of the opengl state used by the renderer
+ * opengl calls are only made if the state changes
+ * if opengl is used directly the state must be invalidated
+ * made and avoided calls are counted in the render statistics
+*/
+class cGL_State
+{
+public:
+	cGL_State( void );
+	~cGL_State( void );
+
+	// Forget the known state
+	void Invalidate( void );
+	// Set the default state
+	void Set_Default( void );
+
+	// Enable or disable GL_TEXTURE_2D
+	void Set_Texture_2D( bool enable );
+	// Bind a 2D texture
+	void Bind_Texture( GLuint texture );
+	// Set the blend function
+	void Set_Blend_Func( GLenum sfactor, GLenum dfactor );
+	/* Blend the alpha with GL_ONE and GL_ONE_MINUS_SRC_ALPHA while enabled
+	 * which creates premultiplied alpha when drawing into a transparent render target
+	 * returns false if glBlendFuncSeparate is not available
+	*/
+	bool Set_Premultiplied_Alpha( bool enable );
+	// Set the current color
+	void Set_Color( const Color &color );
+	// The current color is undefined after using a color array
+	void Invalidate_Color( void );
+	// Set the line width
+	void Set_Line_Width( float width );
+	/* Set the line stipple pattern
+	 * 0 disables it
+	*/
+	void Set_Line_Stipple( GLushort pattern );
+	/* Set the texture color combine type and constant color
+	 * 0 is the default modulation
+	*/
+	void Set_Combine( GLint combine_type, const float *color );
+	// Enable or disable a client array
+	void Set_Client_State( GLenum array, bool enable );
+
+private:
+	// Returns true if the state is known and sets it as known
+	bool Is_Known( unsigned int state );
+
+	// known states
+	enum Known_State
+	{
+		STATE_TEXTURE_2D = 1 << 0,
+		STATE_TEXTURE = 1 << 1,
+		STATE_BLEND_FUNC = 1 << 2,
+		STATE_COLOR = 1 << 3,
+		STATE_LINE_WIDTH = 1 << 4,
+		STATE_LINE_STIPPLE = 1 << 5,
+		STATE_COMBINE = 1 << 6,
+		STATE_VERTEX_ARRAY = 1 << 7,
+		STATE_COLOR_ARRAY = 1 << 8,
+		STATE_TEX_COORD_ARRAY = 1 << 9
+	};
+
+	unsigned int m_known;
+
+	bool m_texture_2d;
+	GLuint m_texture;
+	GLenum m_blend_sfactor;
+	GLenum m_blend_dfactor;
+	bool m_premultiplied_alpha;
+	Color m_color;
+	float m_line_width;
+	GLushort m_line_stipple;
+	GLint m_combine_type;
+	float m_combine_color[3];
+	bool m_vertex_array;
+	bool m_color_array;
+	bool m_tex_coord_array;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+// Renderer opengl state
+extern cGL_State *pGL_State;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
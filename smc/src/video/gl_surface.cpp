@@ -27,6 +27,11 @@ namespace SMC
 cGL_Surface :: cGL_Surface( void )
 {
 	m_image = 0;
+	m_tex_x1 = 0.0f;
+	m_tex_y1 = 0.0f;
+	m_tex_x2 = 1.0f;
+	m_tex_y2 = 1.0f;
+	m_atlas_size = 0;
 
 	m_int_x = 0;
 	m_int_y = 0;
@@ -36,6 +41,8 @@ cGL_Surface :: cGL_Surface( void )
 	m_h = 0;
 	m_tex_w = 0;
 	m_tex_h = 0;
+	m_opaque = 0;
+	m_texture_format = TEXTURE_FORMAT_RGBA8;
 
 	// internal rotation data
 	m_base_rot_x = 0;
@@ -51,6 +58,8 @@ cGL_Surface :: cGL_Surface( void )
 	m_auto_del_img = 1;
 	m_managed = 0;
 	m_obsolete = 0;
+	m_last_use = 0;
+	m_unloaded = 0;
 
 	// default type is passive
 	m_type = TYPE_PASSIVE;
@@ -62,10 +71,21 @@ cGL_Surface :: cGL_Surface( void )
 
 cGL_Surface :: ~cGL_Surface( void )
 {
-	// don't delete a managed OpenGL image if still in use by another managed cGL_Surface
-	if( m_auto_del_img && glIsTexture( m_image ) && ( !m_managed || !Is_Texture_Use_Multiple() ) )
+	/* don't delete a managed OpenGL image if still in use by another managed cGL_Surface
+	 * atlas pages are deleted by the texture atlas
+	*/
+	if( m_auto_del_img && !Is_In_Atlas() && m_image )
 	{
-		glDeleteTextures( 1, &m_image );
+		// the context could be used by the render thread
+		if( pVideo )
+		{
+			pVideo->Render_Finish();
+		}
+
+		if( !m_managed || !Is_Texture_Use_Multiple() )
+		{
+			Delete_Textures();
+		}
 	}
 
 	if( destruction_function )
@@ -81,6 +101,12 @@ cGL_Surface *cGL_Surface :: Copy( void ) const
 
 	// data
 	new_surface->m_image = m_image;
+	new_surface->m_tiles = m_tiles;
+	new_surface->m_tex_x1 = m_tex_x1;
+	new_surface->m_tex_y1 = m_tex_y1;
+	new_surface->m_tex_x2 = m_tex_x2;
+	new_surface->m_tex_y2 = m_tex_y2;
+	new_surface->m_atlas_size = m_atlas_size;
 	new_surface->m_int_x = m_int_x;
 	new_surface->m_int_y = m_int_y;
 	new_surface->m_start_w = m_start_w;
@@ -89,6 +115,8 @@ cGL_Surface *cGL_Surface :: Copy( void ) const
 	new_surface->m_h = m_h;
 	new_surface->m_tex_h = m_tex_h;
 	new_surface->m_tex_w = m_tex_w;
+	new_surface->m_opaque = m_opaque;
+	new_surface->m_texture_format = m_texture_format;
 	new_surface->m_base_rot_x = m_base_rot_x;
 	new_surface->m_base_rot_y = m_base_rot_y;
 	new_surface->m_base_rot_z = m_base_rot_z;
@@ -134,8 +162,9 @@ void cGL_Surface :: Blit( float x, float y, float z, cSurface_Request *request /
 
 void cGL_Surface :: Blit_Data( cSurface_Request *request ) const
 {
-	// texture id
-	request->m_texture_id = m_image;
+	Use();
+
+	Set_Request_Texture( request );
 
 	// position
 	request->m_pos_x += m_int_x;
@@ -151,8 +180,24 @@ void cGL_Surface :: Blit_Data( cSurface_Request *request ) const
 	request->m_rot_z += m_base_rot_z;
 }
 
+void cGL_Surface :: Set_Request_Texture( cSurface_Request *request ) const
+{
+	// texture id
+	request->m_texture_id = m_image;
+	request->m_opaque = m_opaque;
+	// texture coordinates
+	request->m_tex_x1 = m_tex_x1;
+	request->m_tex_y1 = m_tex_y1;
+	request->m_tex_x2 = m_tex_x2;
+	request->m_tex_y2 = m_tex_y2;
+	// tiles
+	request->m_tiles = m_tiles;
+}
+
 void cGL_Surface :: Save( const std::string &filename )
 {
+	Use();
+
 	if( !m_image )
 	{
 		printf( "Couldn't save cGL_Surface : No Image Texture ID set\n" );
@@ -164,8 +209,61 @@ void cGL_Surface :: Save( const std::string &filename )
 
 	// create image data
 	GLubyte *data = new GLubyte[m_tex_w * m_tex_h * 4];
+
+	// copy every tile into its image area
+	if( Is_Tiled() )
+	{
+		// skipped tiles are transparent
+		memset( data, 0, m_tex_w * m_tex_h * 4 );
+
+		for( GL_Texture_Tile_List::const_iterator itr = m_tiles.begin(); itr != m_tiles.end(); ++itr )
+		{
+			const cGL_Texture_Tile &tile = (*itr);
+
+			GLint tile_w = 0;
+			GLint tile_h = 0;
+			glBindTexture( GL_TEXTURE_2D, tile.m_texture_id );
+			glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &tile_w );
+			glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &tile_h );
+
+			GLubyte *tile_data = new GLubyte[tile_w * tile_h * 4];
+			glGetTexImage( GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, static_cast<GLvoid *>(tile_data) );
+
+			const unsigned int start_x = static_cast<unsigned int>( tile.m_x1 * m_tex_w + 0.5f );
+			const unsigned int start_y = static_cast<unsigned int>( tile.m_y1 * m_tex_h + 0.5f );
+			// used area of the tile texture
+			const unsigned int part_w = static_cast<unsigned int>( tile.m_tex_x2 * tile_w + 0.5f );
+			const unsigned int part_h = static_cast<unsigned int>( tile.m_tex_y2 * tile_h + 0.5f );
+
+			for( unsigned int row = 0; row < part_h; row++ )
+			{
+				memcpy( data + ( ( start_y + row ) * m_tex_w + start_x ) * 4, tile_data + row * tile_w * 4, part_w * 4 );
+			}
+
+			delete[] tile_data;
+		}
+	}
+	// copy the image area out of the atlas page
+	else if( Is_In_Atlas() )
+	{
+		GLubyte *page_data = new GLubyte[m_atlas_size * m_atlas_size * 4];
+		glGetTexImage( GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, static_cast<GLvoid *>(page_data) );
+
+		const unsigned int start_x = static_cast<unsigned int>( m_tex_x1 * m_atlas_size + 0.5f );
+		const unsigned int start_y = static_cast<unsigned int>( m_tex_y1 * m_atlas_size + 0.5f );
+
+		for( unsigned int row = 0; row < m_tex_h; row++ )
+		{
+			memcpy( data + row * m_tex_w * 4, page_data + ( ( start_y + row ) * m_atlas_size + start_x ) * 4, m_tex_w * 4 );
+		}
+
+		delete[] page_data;
+	}
 	// read texture
-	glGetTexImage( GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, static_cast<GLvoid *>(data) );
+	else
+	{
+		glGetTexImage( GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, static_cast<GLvoid *>(data) );
+	}
 	// save
 	pVideo->Save_Surface( filename, data, m_tex_w, m_tex_h );
 	// clear data
@@ -201,6 +299,12 @@ cSaved_Texture *cGL_Surface :: Get_Software_Texture( bool only_filename /* = 0 *
 {
 	cSaved_Texture *soft_tex = new cSaved_Texture();
 
+	// atlas and tiled images are always loaded again from file
+	if( Is_In_Atlas() || Is_Tiled() )
+	{
+		only_filename = 1;
+	}
+
 	// hardware texture to software texture
 	if( !only_filename )
 	{
@@ -219,6 +323,15 @@ cSaved_Texture *cGL_Surface :: Get_Software_Texture( bool only_filename /* = 0 *
 
 		unsigned int bpp;
 
+		GLint compressed = 0;
+		glGetTexLevelParameteriv( GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED_ARB, &compressed );
+
+		// compressed and converted textures are read back as rgba
+		if( compressed || m_texture_format != TEXTURE_FORMAT_RGBA8 )
+		{
+			soft_tex->m_format = GL_RGBA;
+		}
+
 		if( soft_tex->m_format == GL_RGBA )
 		{
 			bpp = 4;
@@ -275,9 +388,17 @@ void cGL_Surface :: Load_Software_Texture( cSaved_Texture *soft_tex )
 		}
 
 		// Create Hardware Texture
-		pVideo->Create_GL_Texture( soft_tex->m_width, soft_tex->m_height, soft_tex->m_pixels, mipmaps );
+		// the compressed texture is restored uncompressed
+		if( m_texture_format == TEXTURE_FORMAT_COMPRESSED )
+		{
+			m_texture_format = TEXTURE_FORMAT_RGBA8;
+		}
+
+		pVideo->Create_GL_Texture( soft_tex->m_width, soft_tex->m_height, soft_tex->m_pixels, mipmaps, NULL, m_texture_format );
 
 		m_image = tex_id;
+		m_tiles.clear();
+		m_unloaded = 0;
 	}
 	// load from file
 	else
@@ -292,8 +413,16 @@ void cGL_Surface :: Load_Software_Texture( cSaved_Texture *soft_tex )
 
 		// get image
 		m_image = surface_copy->m_image;
+		m_tiles = surface_copy->m_tiles;
+		m_tex_x1 = surface_copy->m_tex_x1;
+		m_tex_y1 = surface_copy->m_tex_y1;
+		m_tex_x2 = surface_copy->m_tex_x2;
+		m_tex_y2 = surface_copy->m_tex_y2;
+		m_atlas_size = surface_copy->m_atlas_size;
 		m_tex_w = surface_copy->m_tex_w;
 		m_tex_h = surface_copy->m_tex_h;
+		m_opaque = surface_copy->m_opaque;
+		m_unloaded = 0;
 		// keep hardware texture
 		surface_copy->m_auto_del_img = 0;
 		// delete copy
@@ -301,6 +430,142 @@ void cGL_Surface :: Load_Software_Texture( cSaved_Texture *soft_tex )
 	}
 }
 
+void cGL_Surface :: Use( void ) const
+{
+	m_last_use = pImage_Manager->m_frame;
+
+	if( !m_unloaded )
+	{
+		return;
+	}
+
+	cGL_Surface *surface = const_cast<cGL_Surface *>(this);
+
+	// load from file
+	cSaved_Texture soft_tex;
+	surface->Load_Software_Texture( &soft_tex );
+
+	// don't try again every frame if loading failed
+	surface->m_unloaded = 0;
+}
+
+bool cGL_Surface :: Unload_Texture( void )
+{
+	// can't be loaded again
+	if( m_unloaded || !m_image || !m_auto_del_img || Is_In_Atlas() || m_filename.empty() )
+	{
+		return 0;
+	}
+
+	// the context could be used by the render thread
+	pVideo->Render_Finish();
+
+	Delete_Textures();
+
+	m_image = 0;
+	m_unloaded = 1;
+
+	return 1;
+}
+
+bool cGL_Surface :: Release_Texture( bool delete_texture /* = 1 */ )
+{
+	// can't be loaded again
+	if( !m_auto_del_img || m_filename.empty() )
+	{
+		return 0;
+	}
+
+	if( m_unloaded )
+	{
+		return 1;
+	}
+
+	// atlas pages are deleted by the texture atlas
+	if( delete_texture && m_image && !Is_In_Atlas() && ( !m_managed || !Is_Texture_Use_Multiple() ) )
+	{
+		Delete_Textures();
+	}
+
+	m_image = 0;
+	m_unloaded = 1;
+
+	return 1;
+}
+
+bool cGL_Surface :: Reload( void )
+{
+	if( !m_auto_del_img || m_filename.empty() )
+	{
+		return 0;
+	}
+
+	cGL_Surface *surface_copy = pVideo->Load_GL_Surface( m_filename );
+
+	if( !surface_copy )
+	{
+		printf( "Warning: cGL_Surface :: Reload %s loading failed\n", m_filename.c_str() );
+		return 0;
+	}
+
+	// the context could be used by the render thread
+	pVideo->Render_Finish();
+
+	// atlas pages are deleted by the texture atlas
+	if( !m_unloaded && m_image && !Is_In_Atlas() && ( !m_managed || !Is_Texture_Use_Multiple() ) )
+	{
+		Delete_Textures();
+	}
+
+	// texture
+	m_image = surface_copy->m_image;
+	m_tiles = surface_copy->m_tiles;
+	m_tex_x1 = surface_copy->m_tex_x1;
+	m_tex_y1 = surface_copy->m_tex_y1;
+	m_tex_x2 = surface_copy->m_tex_x2;
+	m_tex_y2 = surface_copy->m_tex_y2;
+	m_atlas_size = surface_copy->m_atlas_size;
+	m_tex_w = surface_copy->m_tex_w;
+	m_tex_h = surface_copy->m_tex_h;
+	m_opaque = surface_copy->m_opaque;
+	m_unloaded = 0;
+	// settings
+	m_int_x = surface_copy->m_int_x;
+	m_int_y = surface_copy->m_int_y;
+	m_start_w = surface_copy->m_start_w;
+	m_start_h = surface_copy->m_start_h;
+	m_w = surface_copy->m_w;
+	m_h = surface_copy->m_h;
+	m_base_rot_x = surface_copy->m_base_rot_x;
+	m_base_rot_y = surface_copy->m_base_rot_y;
+	m_base_rot_z = surface_copy->m_base_rot_z;
+	m_col_pos = surface_copy->m_col_pos;
+	m_col_w = surface_copy->m_col_w;
+	m_col_h = surface_copy->m_col_h;
+	m_obsolete = surface_copy->m_obsolete;
+	m_editor_tags = surface_copy->m_editor_tags;
+	m_name = surface_copy->m_name;
+	m_type = surface_copy->m_type;
+	m_ground_type = surface_copy->m_ground_type;
+	// keep hardware texture
+	surface_copy->m_auto_del_img = 0;
+	// delete copy
+	delete surface_copy;
+
+	return 1;
+}
+
+unsigned int cGL_Surface :: Get_Texture_Memory( void ) const
+{
+	// atlas pages are not owned by an image
+	if( Is_In_Atlas() )
+	{
+		return 0;
+	}
+
+	return m_tex_w * m_tex_h * Get_Texture_Format_Size( m_texture_format );
+}
+
 std::string cGL_Surface :: Get_Filename( int with_dir /* = 2 */, bool with_end /* = 1 */ ) const
 {
 	std::string name = m_filename;
@@ -330,6 +595,120 @@ void cGL_Surface :: Set_Destruction_Function( void ( *nfunction )( cGL_Surface *
 	destruction_function = nfunction;
 }
 
+void cGL_Surface :: Delete_Textures( void )
+{
+	// every tile has its own texture
+	if( Is_Tiled() )
+	{
+		for( GL_Texture_Tile_List::iterator itr = m_tiles.begin(); itr != m_tiles.end(); ++itr )
+		{
+			if( glIsTexture( (*itr).m_texture_id ) )
+			{
+				glDeleteTextures( 1, &(*itr).m_texture_id );
+			}
+		}
+
+		m_tiles.clear();
+	}
+	else if( glIsTexture( m_image ) )
+	{
+		glDeleteTextures( 1, &m_image );
+	}
+}
+
+/* *** *** *** *** *** *** *** *** Texture Format *** *** *** *** *** *** *** *** *** */
+
+Texture_Format Get_Texture_Format_Id( const std::string &name )
+{
+	if( name.compare( "rgba8" ) == 0 )
+	{
+		return TEXTURE_FORMAT_RGBA8;
+	}
+	else if( name.compare( "rgb8" ) == 0 )
+	{
+		return TEXTURE_FORMAT_RGB8;
+	}
+	else if( name.compare( "rgb565" ) == 0 )
+	{
+		return TEXTURE_FORMAT_RGB565;
+	}
+	else if( name.compare( "la8" ) == 0 )
+	{
+		return TEXTURE_FORMAT_LA8;
+	}
+	else if( name.compare( "rgba4" ) == 0 )
+	{
+		return TEXTURE_FORMAT_RGBA4;
+	}
+	else if( name.compare( "rgb5_a1" ) == 0 )
+	{
+		return TEXTURE_FORMAT_RGB5_A1;
+	}
+
+	return TEXTURE_FORMAT_AUTO;
+}
+
+std::string Get_Texture_Format_Name( Texture_Format format )
+{
+	switch( format )
+	{
+		case TEXTURE_FORMAT_RGBA8:
+			return "rgba8";
+		case TEXTURE_FORMAT_RGB8:
+			return "rgb8";
+		case TEXTURE_FORMAT_RGB565:
+			return "rgb565";
+		case TEXTURE_FORMAT_LA8:
+			return "la8";
+		case TEXTURE_FORMAT_RGBA4:
+			return "rgba4";
+		case TEXTURE_FORMAT_RGB5_A1:
+			return "rgb5_a1";
+		case TEXTURE_FORMAT_COMPRESSED:
+			return "compressed";
+		default:
+			return "auto";
+	}
+}
+
+GLint Get_Texture_Internal_Format( Texture_Format format )
+{
+	switch( format )
+	{
+		case TEXTURE_FORMAT_RGB8:
+			return GL_RGB8;
+		// GL_RGB565 is not available before OpenGL 4.1 but drivers use it for GL_RGB5
+		case TEXTURE_FORMAT_RGB565:
+			return GL_RGB5;
+		case TEXTURE_FORMAT_LA8:
+			return GL_LUMINANCE8_ALPHA8;
+		case TEXTURE_FORMAT_RGBA4:
+			return GL_RGBA4;
+		case TEXTURE_FORMAT_RGB5_A1:
+			return GL_RGB5_A1;
+		default:
+			return GL_RGBA;
+	}
+}
+
+unsigned int Get_Texture_Format_Size( Texture_Format format )
+{
+	switch( format )
+	{
+		case TEXTURE_FORMAT_RGB565:
+		case TEXTURE_FORMAT_LA8:
+		case TEXTURE_FORMAT_RGBA4:
+		case TEXTURE_FORMAT_RGB5_A1:
+			return 2;
+		// S3TC DXT5 and BPTC
+		case TEXTURE_FORMAT_COMPRESSED:
+			return 1;
+		// rgb8 is usually padded to 32 bit
+		default:
+			return 4;
+	}
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 } // namespace SMC
@@ -25,6 +25,55 @@
 namespace SMC
 {
 
+/* *** *** *** *** *** *** *** *** Texture Tile *** *** *** *** *** *** *** *** *** */
+
+/* Part of an image too large for a single texture
+ * the used texture area starts at the texture coordinates 0
+*/
+class cGL_Texture_Tile
+{
+public:
+	// GL texture number
+	GLuint m_texture_id;
+	// part of the image from 0 to 1
+	float m_x1;
+	float m_y1;
+	float m_x2;
+	float m_y2;
+	// texture coordinates of the used area end
+	float m_tex_x2;
+	float m_tex_y2;
+};
+
+typedef vector<cGL_Texture_Tile> GL_Texture_Tile_List;
+
+/* *** *** *** *** *** *** *** *** Texture Format *** *** *** *** *** *** *** *** *** */
+
+// Graphics card storage format of a texture
+enum Texture_Format
+{
+	// chosen from the image pixels
+	TEXTURE_FORMAT_AUTO = 0,
+	TEXTURE_FORMAT_RGBA8 = 1,
+	TEXTURE_FORMAT_RGB8 = 2,
+	TEXTURE_FORMAT_RGB565 = 3,
+	// greyscale with alpha
+	TEXTURE_FORMAT_LA8 = 4,
+	TEXTURE_FORMAT_RGBA4 = 5,
+	TEXTURE_FORMAT_RGB5_A1 = 6,
+	// replaced by the compressed image cache
+	TEXTURE_FORMAT_COMPRESSED = 7
+};
+
+// Returns the format from the image settings name or TEXTURE_FORMAT_AUTO if unknown
+Texture_Format Get_Texture_Format_Id( const std::string &name );
+// Returns the image settings name of the format
+std::string Get_Texture_Format_Name( Texture_Format format );
+// Returns the OpenGL internal format for glTexImage2D
+GLint Get_Texture_Internal_Format( Texture_Format format );
+// Returns the estimated graphics card bytes per pixel
+unsigned int Get_Texture_Format_Size( Texture_Format format );
+
 /* *** *** *** *** *** *** *** *** OpenGL Surface *** *** *** *** *** *** *** *** *** */
 
 class cGL_Surface
@@ -39,6 +88,8 @@ public:
 	void Blit( float x, float y, float z, cSurface_Request *request = NULL ) const;
 	// Blit only the surface data on the given request
 	void Blit_Data( cSurface_Request *request ) const;
+	// Set the texture, texture coordinates and tiles on the given request
+	void Set_Request_Texture( cSurface_Request *request ) const;
 
 	// Copy cGL_Surface and return it
 	cGL_Surface *Copy( void ) const;
@@ -51,6 +102,16 @@ public:
 
 	// Check if the OpenGL texture is used by another cGL_Surface
 	bool Is_Texture_Use_Multiple( void ) const;
+	// Check if the image is a part of a texture atlas page
+	inline bool Is_In_Atlas( void ) const
+	{
+		return m_atlas_size > 0;
+	}
+	// Check if the image is split into several textures
+	inline bool Is_Tiled( void ) const
+	{
+		return !m_tiles.empty();
+	}
 
 	/* Return a software texture copy
 	 * only_filename: if set doesn't save the software texture but only the filename
@@ -59,13 +120,44 @@ public:
 	// Load a software texture
 	void Load_Software_Texture( cSaved_Texture *soft_tex );
 
+	// Set as used in the current frame and load the texture again from file if it was unloaded
+	void Use( void ) const;
+	/* Delete the hardware texture to free texture memory
+	 * it is loaded again from file with the next use
+	 * returns true if unloaded
+	*/
+	bool Unload_Texture( void );
+	/* Delete the hardware texture for a new opengl context or new texture settings
+	 * it is loaded again from file with the next use even if it is in a texture atlas
+	 * delete_texture : if not set the texture was already lost with the opengl context
+	 * returns false if it can not be loaded again from file
+	*/
+	bool Release_Texture( bool delete_texture = 1 );
+	/* Load the texture and the image settings again from file
+	 * the surface keeps its address so every user gets the changed image
+	 * an image in a texture atlas gets a new place in it
+	 * returns false if it was not created from a file or could not be loaded
+	*/
+	bool Reload( void );
+	// Return the estimated texture memory size without mipmaps
+	unsigned int Get_Texture_Memory( void ) const;
+
 	// Return the filename
 	std::string Get_Filename( int with_dir = 2, bool with_end = 1 ) const;
 	// Set a function called on destruction
 	void Set_Destruction_Function( void ( *nfunction )( cGL_Surface * ) );
 
-	// GL texture number
+	// GL texture number or the texture of the first tile
 	GLuint m_image;
+	// textures of an image larger than the maximum texture size
+	GL_Texture_Tile_List m_tiles;
+	// texture coordinates of the image in the texture
+	float m_tex_x1;
+	float m_tex_y1;
+	float m_tex_x2;
+	float m_tex_y2;
+	// atlas page size if the texture is a texture atlas page
+	unsigned int m_atlas_size;
 	// internal drawing offset
 	float m_int_x;
 	float m_int_y;
@@ -78,6 +170,10 @@ public:
 	// texture dimension
 	unsigned int m_tex_w;
 	unsigned int m_tex_h;
+	// if the texture has no transparent pixels
+	bool m_opaque;
+	// texture storage format
+	Texture_Format m_texture_format;
 	// internal rotation
 	float m_base_rot_x;
 	float m_base_rot_y;
@@ -95,6 +191,10 @@ public:
 	bool m_managed;
 	// if the image is tagged as obsolete 
 	bool m_obsolete;
+	// image manager frame of the last use
+	mutable unsigned int m_last_use;
+	// if the hardware texture was unloaded
+	bool m_unloaded;
 
 	// editor tags
 	std::string m_editor_tags;
@@ -105,6 +205,9 @@ public:
 	// ground type
 	GroundType m_ground_type;
 private:
+	// Delete the hardware texture or the textures of all tiles
+	void Delete_Textures( void );
+
 	// function called on destruction
 	void ( *destruction_function )( cGL_Surface * );
 };
@@ -0,0 +1,215 @@
+/***************************************************************************
+ * glyph_atlas.cpp  -  texture with the rendered characters of a font
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/glyph_atlas.h"
+#include "../video/video.h"
+#include "../video/img_manager.h"
+
+namespace SMC
+{
+
+// texture size
+static const unsigned int glyph_atlas_size = 512;
+// empty pixels around each glyph against filtering artifacts
+static const unsigned int glyph_atlas_padding = 1;
+
+/* *** *** *** *** *** *** *** cGlyph_Atlas *** *** *** *** *** *** *** *** *** *** */
+
+cGlyph_Atlas :: cGlyph_Atlas( TTF_Font *font )
+{
+	m_font = font;
+	m_texture = 0;
+
+	m_pen_x = glyph_atlas_padding;
+	m_pen_y = glyph_atlas_padding;
+	m_row_h = 0;
+	m_full = 0;
+}
+
+cGlyph_Atlas :: ~cGlyph_Atlas( void )
+{
+	Clear();
+}
+
+const cGlyph_Atlas::Glyph *cGlyph_Atlas :: Get_Glyph( Uint16 character )
+{
+	Glyph_Map::const_iterator itr = m_glyphs.find( character );
+
+	// already rendered
+	if( itr != m_glyphs.end() )
+	{
+		return &itr->second;
+	}
+
+	int min_x, max_x, min_y, max_y, advance;
+
+	// not in the font
+	if( TTF_GlyphMetrics( m_font, character, &min_x, &max_x, &min_y, &max_y, &advance ) != 0 )
+	{
+		return NULL;
+	}
+
+	Glyph glyph;
+	glyph.m_tex_x1 = 0.0f;
+	glyph.m_tex_y1 = 0.0f;
+	glyph.m_tex_x2 = 0.0f;
+	glyph.m_tex_y2 = 0.0f;
+	// the text rendering moves the first character right if it starts left of the pen
+	glyph.m_x = min_x < 0 ? static_cast<float>(min_x) : 0.0f;
+	glyph.m_w = 0.0f;
+	glyph.m_h = 0.0f;
+	glyph.m_advance = static_cast<float>(advance);
+
+	// render as text to get the same vertical position as the text rendering
+	const Uint16 text[2] = { character, 0 };
+	const SDL_Color white_color = { 255, 255, 255, 0 };
+	SDL_Surface *surface = TTF_RenderUNICODE_Blended( m_font, text, white_color );
+
+	// nothing visible like a space
+	if( !surface )
+	{
+		return &m_glyphs.insert( Glyph_Map::value_type( character, glyph ) ).first->second;
+	}
+
+	const unsigned int width = surface->w;
+	const unsigned int height = surface->h;
+
+	// start a new row
+	if( m_pen_x + width + glyph_atlas_padding > glyph_atlas_size )
+	{
+		m_pen_x = glyph_atlas_padding;
+		m_pen_y += m_row_h + glyph_atlas_padding;
+		m_row_h = 0;
+	}
+
+	// no space left
+	if( m_full || width + glyph_atlas_padding * 2 > glyph_atlas_size || m_pen_y + height + glyph_atlas_padding > glyph_atlas_size )
+	{
+		if( !m_full )
+		{
+			printf( "Warning : cGlyph_Atlas : texture is full\n" );
+			m_full = 1;
+		}
+
+		SDL_FreeSurface( surface );
+		return NULL;
+	}
+
+	if( !m_texture && !Create_Texture() )
+	{
+		SDL_FreeSurface( surface );
+		return NULL;
+	}
+
+	// 32 bit rgba
+	surface = pVideo->Convert_To_Final_Software_Image( surface );
+
+	// uses opengl directly
+	pVideo->Render_Finish();
+
+	glBindTexture( GL_TEXTURE_2D, m_texture );
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, surface->pitch / 4 );
+	glTexSubImage2D( GL_TEXTURE_2D, 0, m_pen_x, m_pen_y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, surface->pixels );
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+
+	SDL_FreeSurface( surface );
+
+	glyph.m_tex_x1 = static_cast<float>(m_pen_x) / glyph_atlas_size;
+	glyph.m_tex_y1 = static_cast<float>(m_pen_y) / glyph_atlas_size;
+	glyph.m_tex_x2 = static_cast<float>(m_pen_x + width) / glyph_atlas_size;
+	glyph.m_tex_y2 = static_cast<float>(m_pen_y + height) / glyph_atlas_size;
+	glyph.m_w = static_cast<float>(width);
+	glyph.m_h = static_cast<float>(height);
+
+	m_pen_x += width + glyph_atlas_padding;
+
+	if( height > m_row_h )
+	{
+		m_row_h = height;
+	}
+
+	return &m_glyphs.insert( Glyph_Map::value_type( character, glyph ) ).first->second;
+}
+
+unsigned int cGlyph_Atlas :: Get_Texture_Memory( void ) const
+{
+	if( !m_texture )
+	{
+		return 0;
+	}
+
+	return glyph_atlas_size * glyph_atlas_size * 4;
+}
+
+void cGlyph_Atlas :: Clear( void )
+{
+	if( m_texture )
+	{
+		// the context could be used by the render thread
+		if( pVideo )
+		{
+			pVideo->Render_Finish();
+		}
+
+		if( glIsTexture( m_texture ) )
+		{
+			glDeleteTextures( 1, &m_texture );
+		}
+
+		m_texture = 0;
+	}
+
+	m_glyphs.clear();
+	m_pen_x = glyph_atlas_padding;
+	m_pen_y = glyph_atlas_padding;
+	m_row_h = 0;
+	m_full = 0;
+}
+
+bool cGlyph_Atlas :: Create_Texture( void )
+{
+	// uses opengl directly
+	pVideo->Render_Finish();
+
+	glGenTextures( 1, &m_texture );
+
+	if( !m_texture )
+	{
+		printf( "Error : cGlyph_Atlas : GL image generation failed\n" );
+		return 0;
+	}
+
+	// set highest texture id
+	if( pImage_Manager->m_high_texture_id < m_texture )
+	{
+		pImage_Manager->m_high_texture_id = m_texture;
+	}
+
+	// transparent
+	vector<GLubyte> pixels( glyph_atlas_size * glyph_atlas_size * 4, 0 );
+
+	glBindTexture( GL_TEXTURE_2D, m_texture );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, glyph_atlas_size, glyph_atlas_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0] );
+
+	return 1;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,96 @@
+/***************************************************************************
+ * glyph_atlas.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_GLYPH_ATLAS_H
+#define SMC_GLYPH_ATLAS_H
+
+#include "../core/global_basic.h"
+// SDL
+// also includes SDL.h
+#include "SDL_ttf.h"
+#include "SDL_opengl.h"
+// boost
+#include <boost/unordered_map.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cGlyph_Atlas *** *** *** *** *** *** *** *** *** *** */
+
+/* Texture with the rendered characters of a font
+ * a character is rendered in white with its first use and stays in the texture
+ * the text color is set with the request color
+*/
+class cGlyph_Atlas
+{
+public:
+	cGlyph_Atlas( TTF_Font *font );
+	~cGlyph_Atlas( void );
+
+	// character image in the texture
+	struct Glyph
+	{
+		// texture coordinates
+		float m_tex_x1;
+		float m_tex_y1;
+		float m_tex_x2;
+		float m_tex_y2;
+		// drawing offset from the pen position
+		float m_x;
+		// size or 0 if nothing is drawn
+		float m_w;
+		float m_h;
+		// pen movement
+		float m_advance;
+	};
+
+	/* Return the glyph of the character
+	 * renders it into the texture with the first use
+	 * returns NULL if the font has no such character or the texture is full
+	*/
+	const Glyph *Get_Glyph( Uint16 character );
+
+	// Delete the texture and forget all glyphs
+	void Clear( void );
+
+	// Returns the texture memory in bytes
+	unsigned int Get_Texture_Memory( void ) const;
+
+	// font
+	TTF_Font *m_font;
+	// texture or 0 if not created yet
+	GLuint m_texture;
+
+private:
+	// Create the empty texture
+	bool Create_Texture( void );
+
+	typedef boost::unordered_map<Uint16, Glyph> Glyph_Map;
+	Glyph_Map m_glyphs;
+
+	// next free position in the current row
+	unsigned int m_pen_x;
+	unsigned int m_pen_y;
+	// height of the current row
+	unsigned int m_row_h;
+	// if set the texture is full
+	bool m_full;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
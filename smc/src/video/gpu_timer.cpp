@@ -0,0 +1,290 @@
+/***************************************************************************
+ * gpu_timer.cpp  -  GPU time measurement of the render phases
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/gpu_timer.h"
+#include "../core/profiler.h"
+#include <cstring>
+#include <cstdio>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** Extension *** *** *** *** *** *** *** *** *** *** */
+
+#ifndef APIENTRY
+	#define APIENTRY
+#endif
+#ifndef GL_TIME_ELAPSED
+	#define GL_TIME_ELAPSED 0x88BF
+#endif
+#ifndef GL_QUERY_RESULT
+	#define GL_QUERY_RESULT 0x8866
+	#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+
+typedef void (APIENTRY *Gen_Queries_Func)( GLsizei n, GLuint *ids );
+typedef void (APIENTRY *Delete_Queries_Func)( GLsizei n, const GLuint *ids );
+typedef void (APIENTRY *Begin_Query_Func)( GLenum target, GLuint id );
+typedef void (APIENTRY *End_Query_Func)( GLenum target );
+typedef void (APIENTRY *Get_Query_Object_Func)( GLuint id, GLenum pname, GLint *params );
+typedef void (APIENTRY *Get_Query_Object_64_Func)( GLuint id, GLenum pname, Uint64 *params );
+
+static Gen_Queries_Func smc_glGenQueries = NULL;
+static Delete_Queries_Func smc_glDeleteQueries = NULL;
+static Begin_Query_Func smc_glBeginQuery = NULL;
+static End_Query_Func smc_glEndQuery = NULL;
+static Get_Query_Object_Func smc_glGetQueryObjectiv = NULL;
+static Get_Query_Object_64_Func smc_glGetQueryObjectui64v = NULL;
+
+// Returns the function with the name or with the ARB suffix
+static void *Get_Query_Function( const char *name )
+{
+	void *func = SDL_GL_GetProcAddress( name );
+
+	if( !func )
+	{
+		func = SDL_GL_GetProcAddress( ( std::string( name ) + "ARB" ).c_str() );
+	}
+
+	return func;
+}
+
+/* phase boundaries as z positions
+ * the level starts with the passive sprites, the player is at 0.0999
+ * the front passive sprites start at 0.1 and the hud at 0.1299
+*/
+static const float gpu_phase_level_z = 0.01f;
+static const float gpu_phase_player_z = 0.0999f;
+static const float gpu_phase_level_front_z = 0.1f;
+static const float gpu_phase_hud_z = 0.1299f;
+
+/* *** *** *** *** *** *** *** cGPU_Timer *** *** *** *** *** *** *** *** *** *** */
+
+cGPU_Timer :: cGPU_Timer( void )
+{
+	memset( m_queries, 0, sizeof(m_queries) );
+	memset( m_used, 0, sizeof(m_used) );
+	memset( m_last_times, 0, sizeof(m_last_times) );
+	m_frame = 0;
+	m_phase = GPU_PHASE_COUNT;
+	m_active = 0;
+	m_running = 0;
+	m_initialized = 0;
+}
+
+cGPU_Timer :: ~cGPU_Timer( void )
+{
+	Exit();
+}
+
+bool cGPU_Timer :: Init( void )
+{
+	Exit();
+
+	const char *extensions = reinterpret_cast<const char *>(glGetString( GL_EXTENSIONS ));
+
+	if( !extensions )
+	{
+		return 0;
+	}
+
+	if( strstr( extensions, "GL_ARB_timer_query" ) )
+	{
+		smc_glGetQueryObjectui64v = reinterpret_cast<Get_Query_Object_64_Func>(SDL_GL_GetProcAddress( "glGetQueryObjectui64v" ));
+	}
+	else if( strstr( extensions, "GL_EXT_timer_query" ) )
+	{
+		smc_glGetQueryObjectui64v = reinterpret_cast<Get_Query_Object_64_Func>(SDL_GL_GetProcAddress( "glGetQueryObjectui64vEXT" ));
+	}
+	else
+	{
+		printf( "Warning : cGPU_Timer : GL_ARB_timer_query is not supported\n" );
+		return 0;
+	}
+
+	smc_glGenQueries = reinterpret_cast<Gen_Queries_Func>(Get_Query_Function( "glGenQueries" ));
+	smc_glDeleteQueries = reinterpret_cast<Delete_Queries_Func>(Get_Query_Function( "glDeleteQueries" ));
+	smc_glBeginQuery = reinterpret_cast<Begin_Query_Func>(Get_Query_Function( "glBeginQuery" ));
+	smc_glEndQuery = reinterpret_cast<End_Query_Func>(Get_Query_Function( "glEndQuery" ));
+	smc_glGetQueryObjectiv = reinterpret_cast<Get_Query_Object_Func>(Get_Query_Function( "glGetQueryObjectiv" ));
+
+	if( !smc_glGenQueries || !smc_glDeleteQueries || !smc_glBeginQuery || !smc_glEndQuery || !smc_glGetQueryObjectiv || !smc_glGetQueryObjectui64v )
+	{
+		printf( "Warning : cGPU_Timer : query functions not found\n" );
+		return 0;
+	}
+
+	smc_glGenQueries( GPU_PHASE_COUNT * 2, &m_queries[0][0] );
+	m_initialized = 1;
+
+	return 1;
+}
+
+void cGPU_Timer :: Exit( void )
+{
+	if( !m_initialized )
+	{
+		return;
+	}
+
+	End();
+	smc_glDeleteQueries( GPU_PHASE_COUNT * 2, &m_queries[0][0] );
+
+	memset( m_queries, 0, sizeof(m_queries) );
+	memset( m_used, 0, sizeof(m_used) );
+	m_active = 0;
+	m_initialized = 0;
+}
+
+void cGPU_Timer :: Frame_Begin( void )
+{
+	m_active = m_initialized && pProfiler && pProfiler->Is_Enabled();
+}
+
+void cGPU_Timer :: Begin( GPU_Phase phase )
+{
+	if( !m_active || phase == m_phase )
+	{
+		return;
+	}
+
+	End();
+	m_phase = phase;
+
+	// a query can only be used once per frame
+	if( m_used[m_frame][phase] )
+	{
+		return;
+	}
+
+	smc_glBeginQuery( GL_TIME_ELAPSED, m_queries[m_frame][phase] );
+	m_used[m_frame][phase] = 1;
+	m_running = 1;
+}
+
+void cGPU_Timer :: End( void )
+{
+	m_phase = GPU_PHASE_COUNT;
+
+	if( !m_running )
+	{
+		return;
+	}
+
+	smc_glEndQuery( GL_TIME_ELAPSED );
+	m_running = 0;
+}
+
+void cGPU_Timer :: Frame_End( void )
+{
+	if( !m_initialized )
+	{
+		return;
+	}
+
+	End();
+
+	// the previous frame should be finished by now
+	const unsigned int previous = m_frame ^ 1;
+
+	for( unsigned int phase = 0; phase < GPU_PHASE_COUNT; phase++ )
+	{
+		if( !m_used[previous][phase] )
+		{
+			continue;
+		}
+
+		m_used[previous][phase] = 0;
+
+		GLint available = 0;
+		smc_glGetQueryObjectiv( m_queries[previous][phase], GL_QUERY_RESULT_AVAILABLE, &available );
+
+		// never wait
+		if( !available )
+		{
+			continue;
+		}
+
+		Uint64 time = 0;
+		smc_glGetQueryObjectui64v( m_queries[previous][phase], GL_QUERY_RESULT, &time );
+
+		m_last_times[phase] = static_cast<Uint32>(time / 1000);
+		m_timers[phase].Add_Time( m_last_times[phase] );
+	}
+
+	m_frame = previous;
+	m_active = 0;
+}
+
+GPU_Phase cGPU_Timer :: Get_Phase( float pos_z )
+{
+	if( pos_z < gpu_phase_level_z )
+	{
+		return GPU_PHASE_BACKGROUND;
+	}
+	if( pos_z < gpu_phase_player_z )
+	{
+		return GPU_PHASE_LEVEL;
+	}
+	if( pos_z < gpu_phase_level_front_z )
+	{
+		return GPU_PHASE_PLAYER;
+	}
+	if( pos_z < gpu_phase_hud_z )
+	{
+		return GPU_PHASE_LEVEL_FRONT;
+	}
+
+	return GPU_PHASE_HUD;
+}
+
+const char *cGPU_Timer :: Get_Phase_Name( GPU_Phase phase )
+{
+	switch( phase )
+	{
+		case GPU_PHASE_BACKGROUND:
+		{
+			return "Background";
+		}
+		case GPU_PHASE_LEVEL:
+		{
+			return "Level";
+		}
+		case GPU_PHASE_PLAYER:
+		{
+			return "Player";
+		}
+		case GPU_PHASE_LEVEL_FRONT:
+		{
+			return "Level front";
+		}
+		case GPU_PHASE_HUD:
+		{
+			return "Hud";
+		}
+		case GPU_PHASE_GUI:
+		{
+			return "Gui";
+		}
+		default:
+		{
+			return "";
+		}
+	}
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
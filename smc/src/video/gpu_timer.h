@@ -0,0 +1,118 @@
+/***************************************************************************
+ * gpu_timer.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_GPU_TIMER_H
+#define SMC_GPU_TIMER_H
+
+#include "../core/global_basic.h"
+#include "../core/framerate.h"
+// SDL
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** GPU_Phase *** *** *** *** *** *** *** *** *** *** */
+
+// measured render phases in drawing order
+enum GPU_Phase
+{
+	GPU_PHASE_BACKGROUND = 0,
+	GPU_PHASE_LEVEL = 1,
+	GPU_PHASE_PLAYER = 2,
+	GPU_PHASE_LEVEL_FRONT = 3,
+	GPU_PHASE_HUD = 4,
+	GPU_PHASE_GUI = 5,
+	GPU_PHASE_COUNT = 6
+};
+
+/* *** *** *** *** *** *** *** cGPU_Timer *** *** *** *** *** *** *** *** *** *** */
+
+/* Measures the GPU time of the render phases with timer queries
+ * the queries of a frame are read back after the next frame
+ * and only if their results are available so it never waits for the GPU
+ * only measures if the profiler is enabled
+ * needs the GL_ARB_timer_query or GL_EXT_timer_query extension
+*/
+class cGPU_Timer
+{
+public:
+	cGPU_Timer( void );
+	~cGPU_Timer( void );
+
+	/* Check the extensions and load the functions
+	 * must be called again for a new opengl context
+	 * returns false if timer queries are not supported
+	*/
+	bool Init( void );
+	// Delete the queries
+	void Exit( void );
+
+	// Start measuring the phases of a frame
+	void Frame_Begin( void );
+	/* End the current phase and start measuring the phase
+	 * does nothing if the frame was not begun
+	*/
+	void Begin( GPU_Phase phase );
+	// End the current phase
+	void End( void );
+	// Returns true if the current frame is measured
+	inline bool Is_Active( void ) const
+	{
+		return m_active;
+	}
+	// Returns the current phase or GPU_PHASE_COUNT if none
+	inline GPU_Phase Get_Current_Phase( void ) const
+	{
+		return m_phase;
+	}
+	/* End the frame and add the available results of the previous frame to the timers
+	 * must be called after the buffer swap
+	*/
+	void Frame_End( void );
+
+	// Returns the phase of a render request z position
+	static GPU_Phase Get_Phase( float pos_z );
+	// Returns the name of the phase
+	static const char *Get_Phase_Name( GPU_Phase phase );
+
+	// microseconds of each phase
+	cPerformance_Timer m_timers[GPU_PHASE_COUNT];
+	// microseconds of each phase in the last read back frame
+	Uint32 m_last_times[GPU_PHASE_COUNT];
+
+private:
+	// queries of the two frames
+	GLuint m_queries[2][GPU_PHASE_COUNT];
+	// if the query was used in the frame
+	bool m_used[2][GPU_PHASE_COUNT];
+	// query set of the current frame
+	unsigned int m_frame;
+	// current phase or GPU_PHASE_COUNT if none
+	GPU_Phase m_phase;
+	// if the current frame is measured
+	bool m_active;
+	// if a query is running
+	bool m_running;
+	// if the queries are created
+	bool m_initialized;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
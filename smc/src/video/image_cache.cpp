@@ -0,0 +1,406 @@
+/***************************************************************************
+ * image_cache.cpp  -  incremental image cache updates
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/image_cache.h"
+#include "../video/video.h"
+#include "../video/image_loader.h"
+#include "../video/img_settings.h"
+#include "../video/compressed_cache.h"
+#include "../core/task_pool.h"
+#include "../core/filesystem/filesystem.h"
+// boost
+#include <boost/bind.hpp>
+#include <boost/unordered_set.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace SMC
+{
+
+// manifest file identification "SMCM" and version
+static const Uint32 image_cache_magic = 0x4D434D53;
+/* increased if the cached images change
+ * which makes all images cached again
+*/
+static const Uint32 image_cache_version = 4;
+
+/* *** *** *** *** *** *** *** cImage_Cache_Updater *** *** *** *** *** *** *** *** *** *** */
+
+cImage_Cache_Updater :: cImage_Cache_Updater( void )
+{
+	m_modified = 0;
+	m_task_group = pTask_Pool->Create_Group();
+}
+
+cImage_Cache_Updater :: ~cImage_Cache_Updater( void )
+{
+	Cancel();
+}
+
+void cImage_Cache_Updater :: Start( const std::string &cache_dir )
+{
+	Cancel();
+
+	m_cache_dir = cache_dir;
+	Load();
+
+	// get all files
+	vector<std::string> image_files = Get_Directory_Files( DATA_DIR "/" GAME_PIXMAPS_DIR, ".settings", 1 );
+
+	boost::unordered_set<std::string> sources;
+	vector<std::string> outdated;
+
+	for( vector<std::string>::iterator itr = image_files.begin(); itr != image_files.end(); ++itr )
+	{
+		const std::string &filename = (*itr);
+
+		// if directory
+		if( filename.rfind( "." ) == std::string::npos )
+		{
+			// remove data dir
+			const std::string cache_filename = m_cache_dir + "/" + filename.substr( strlen( DATA_DIR "/" ) );
+
+			if( !Dir_Exists( cache_filename ) )
+			{
+				Create_Directory( cache_filename );
+			}
+
+			continue;
+		}
+
+		sources.insert( filename );
+
+		if( Is_Valid( filename ) )
+		{
+			continue;
+		}
+
+		// the original image is used until it is cached again
+		Remove_Cache_Files( filename );
+		m_entries.erase( filename );
+		m_modified = 1;
+
+		outdated.push_back( filename );
+	}
+
+	// removed images
+	for( Entry_Map::iterator itr = m_entries.begin(); itr != m_entries.end(); )
+	{
+		if( sources.find( itr->first ) != sources.end() )
+		{
+			++itr;
+			continue;
+		}
+
+		Remove_Cache_Files( itr->first );
+		itr = m_entries.erase( itr );
+		m_modified = 1;
+	}
+
+	if( outdated.empty() )
+	{
+		Save();
+		return;
+	}
+
+	debug_print( "Info : caching %d changed images\n", static_cast<int>(outdated.size()) );
+
+	pTask_Pool->Add( boost::bind( &cImage_Cache_Updater::Update_Task, this, outdated ), TASK_PRIORITY_BACKGROUND, m_task_group, "image cache" );
+}
+
+void cImage_Cache_Updater :: Cancel( void )
+{
+	pTask_Pool->Cancel( m_task_group );
+}
+
+vector<std::string> cImage_Cache_Updater :: Invalidate( const std::string &source_filename )
+{
+	vector<std::string> outdated;
+
+	// not started
+	if( m_cache_dir.empty() )
+	{
+		return outdated;
+	}
+
+	// the entries are changed by the caching task
+	Cancel();
+
+	for( Entry_Map::iterator itr = m_entries.begin(); itr != m_entries.end(); )
+	{
+		const vector<std::string> &files = itr->second.m_files;
+
+		if( std::find( files.begin(), files.end(), source_filename ) == files.end() )
+		{
+			++itr;
+			continue;
+		}
+
+		// the original image is used until it is cached again
+		Remove_Cache_Files( itr->first );
+		outdated.push_back( itr->first );
+		itr = m_entries.erase( itr );
+		m_modified = 1;
+	}
+
+	if( outdated.empty() )
+	{
+		Save();
+		return outdated;
+	}
+
+	pTask_Pool->Add( boost::bind( &cImage_Cache_Updater::Update_Task, this, outdated ), TASK_PRIORITY_BACKGROUND, m_task_group, "image cache" );
+
+	return outdated;
+}
+
+bool cImage_Cache_Updater :: Load( void )
+{
+	m_entries.clear();
+	// saved again if not loaded
+	m_modified = 1;
+
+	const std::string filename = m_cache_dir + "/" USER_IMGCACHE_MANIFEST;
+
+	FILE *fp = fopen( filename.c_str(), "rb" );
+
+	if( !fp )
+	{
+		return 0;
+	}
+
+	// read the whole file at once
+	fseek( fp, 0, SEEK_END );
+	const long size = ftell( fp );
+	fseek( fp, 0, SEEK_SET );
+
+	if( size <= 0 )
+	{
+		fclose( fp );
+		return 0;
+	}
+
+	vector<char> data( size );
+	const bool read = fread( &data[0], size, 1, fp ) == 1;
+	fclose( fp );
+
+	if( !read )
+	{
+		return 0;
+	}
+
+	cIndex_Reader reader( &data[0], data.size() );
+
+	// check identification and version
+	if( reader.Read_Uint32() != image_cache_magic || reader.Read_Uint32() != image_cache_version )
+	{
+		debug_print( "Info : image cache manifest %s is outdated\n", filename.c_str() );
+		return 0;
+	}
+
+	const Uint32 count = reader.Read_Uint32();
+
+	for( Uint32 i = 0; i < count && reader.m_valid; i++ )
+	{
+		Entry &entry = m_entries[reader.Read_String()];
+
+		const Uint32 file_count = reader.Read_Uint32();
+
+		for( Uint32 j = 0; j < file_count && reader.m_valid; j++ )
+		{
+			entry.m_files.push_back( reader.Read_String() );
+			entry.m_times.push_back( static_cast<time_t>(reader.Read_Uint64()) );
+		}
+	}
+
+	if( !reader.m_valid )
+	{
+		printf( "Warning : image cache manifest %s is invalid\n", filename.c_str() );
+		m_entries.clear();
+		return 0;
+	}
+
+	m_modified = 0;
+	return 1;
+}
+
+bool cImage_Cache_Updater :: Save( void )
+{
+	if( !m_modified )
+	{
+		return 1;
+	}
+
+	cIndex_Writer writer;
+	writer.Write_Uint32( image_cache_magic );
+	writer.Write_Uint32( image_cache_version );
+	writer.Write_Uint32( m_entries.size() );
+
+	for( Entry_Map::const_iterator itr = m_entries.begin(); itr != m_entries.end(); ++itr )
+	{
+		const Entry &entry = itr->second;
+
+		writer.Write_String( itr->first );
+		writer.Write_Uint32( entry.m_files.size() );
+
+		for( unsigned int i = 0; i < entry.m_files.size(); i++ )
+		{
+			writer.Write_String( entry.m_files[i] );
+			writer.Write_Uint64( static_cast<Uint64>(entry.m_times[i]) );
+		}
+	}
+
+	const std::string filename = m_cache_dir + "/" USER_IMGCACHE_MANIFEST;
+
+	FILE *fp = fopen( filename.c_str(), "wb" );
+
+	if( !fp )
+	{
+		printf( "Warning : could not save image cache manifest %s\n", filename.c_str() );
+		return 0;
+	}
+
+	const bool written = fwrite( writer.m_data.data(), writer.m_data.size(), 1, fp ) == 1;
+	fclose( fp );
+
+	if( !written )
+	{
+		printf( "Warning : could not save image cache manifest %s\n", filename.c_str() );
+		Delete_File( filename );
+		return 0;
+	}
+
+	m_modified = 0;
+	return 1;
+}
+
+bool cImage_Cache_Updater :: Is_Valid( const std::string &filename ) const
+{
+	Entry_Map::const_iterator itr = m_entries.find( filename );
+
+	if( itr == m_entries.end() )
+	{
+		return 0;
+	}
+
+	const Entry &entry = itr->second;
+
+	// check for modifications
+	for( unsigned int i = 0; i < entry.m_files.size(); i++ )
+	{
+		if( Get_File_Modification_Time( entry.m_files[i] ) != entry.m_times[i] )
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+void cImage_Cache_Updater :: Set_Valid( const std::string &filename )
+{
+	Entry entry;
+	std::string image_filename = filename.substr( 0, filename.rfind( ".settings" ) ) + ".png";
+
+	// the settings file and its base settings files
+	cImage_Settings_Data *settings = pImage_Settings_Cache->Get( filename, &entry.m_files );
+
+	if( settings )
+	{
+		if( !settings->m_base.empty() )
+		{
+			image_filename = pVideo->Get_Base_Image_Filename( image_filename, settings->m_base );
+		}
+
+		delete settings;
+	}
+	else
+	{
+		entry.m_files.assign( 1, filename );
+	}
+
+	entry.m_files.push_back( image_filename );
+
+	for( vector<std::string>::const_iterator itr = entry.m_files.begin(); itr != entry.m_files.end(); ++itr )
+	{
+		entry.m_times.push_back( Get_File_Modification_Time( *itr ) );
+	}
+
+	m_entries[filename] = entry;
+	m_modified = 1;
+}
+
+void cImage_Cache_Updater :: Remove_Cache_Files( const std::string &filename ) const
+{
+	// remove data dir
+	const std::string cache_filename = m_cache_dir + "/" + filename.substr( strlen( DATA_DIR "/" ) );
+
+	if( File_Exists( cache_filename + ".rgba" ) )
+	{
+		Delete_File( cache_filename + ".rgba" );
+	}
+
+	if( !pVideo->m_compressed_cache )
+	{
+		return;
+	}
+
+	// the compressed textures are created from the settings or the image filename
+	const std::string compressed_filenames[2] = {
+		pVideo->m_compressed_cache->Get_Cache_Filename( filename ),
+		pVideo->m_compressed_cache->Get_Cache_Filename( filename.substr( 0, filename.rfind( ".settings" ) ) + ".png" ) };
+
+	for( unsigned int i = 0; i < 2; i++ )
+	{
+		if( File_Exists( compressed_filenames[i] ) )
+		{
+			Delete_File( compressed_filenames[i] );
+		}
+	}
+}
+
+void cImage_Cache_Updater :: Update_Task( vector<std::string> files )
+{
+	cImage_Loader loader( cImage_Loader::JOB_CACHE, m_cache_dir );
+
+	for( vector<std::string>::iterator itr = files.begin(); itr != files.end(); ++itr )
+	{
+		loader.Add( *itr );
+	}
+
+	loader.Start();
+
+	for( unsigned int i = 0; i < loader.Get_Count(); i++ )
+	{
+		// the finished images are kept
+		if( pTask_Pool->Is_Cancelled( m_task_group ) )
+		{
+			break;
+		}
+
+		loader.Wait( i );
+		Set_Valid( loader.Get_Filename( i ) );
+	}
+
+	Save();
+
+	// save the resolved image settings
+	pImage_Settings_Cache->Save_Index();
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
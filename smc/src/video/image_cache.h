@@ -0,0 +1,100 @@
+/***************************************************************************
+ * image_cache.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_IMAGE_CACHE_H
+#define SMC_IMAGE_CACHE_H
+
+#include "../core/global_basic.h"
+// boost
+#include <boost/unordered_map.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cImage_Cache_Updater *** *** *** *** *** *** *** *** *** *** */
+
+/* Keeps the image cache up to date
+ * a manifest in the cache directory stores the source files of every cached image
+ * with their modification time and only images with changed sources are cached again
+ * the cache does not depend on the resolution or texture settings as every image has all mip levels
+ * the outdated cache files are removed first so the original images are used
+ * until the caching on the task pool is finished
+*/
+class cImage_Cache_Updater
+{
+public:
+	cImage_Cache_Updater( void );
+	// Stops the caching
+	~cImage_Cache_Updater( void );
+
+	/* Remove the outdated cache files and start caching the changed images
+	 * cache_dir : active image cache directory
+	*/
+	void Start( const std::string &cache_dir );
+	/* Stop the caching and wait until it stopped
+	 * the already cached images are kept in the manifest
+	*/
+	void Cancel( void );
+
+	/* Remove the cache files of the images using the changed source file
+	 * and start caching them again
+	 * the caching of other images which was not finished is stopped
+	 * source_filename : changed image or settings file
+	 * returns the settings files of the removed images
+	*/
+	vector<std::string> Invalidate( const std::string &source_filename );
+
+private:
+	/* Load the manifest of the cache directory
+	 * returns false if it does not exist or is outdated
+	*/
+	bool Load( void );
+	// Save the manifest if changed
+	bool Save( void );
+
+	// Returns true if the cache files of the settings file are up to date
+	bool Is_Valid( const std::string &filename ) const;
+	// Set the current source files of the cached settings file
+	void Set_Valid( const std::string &filename );
+	// Delete the cache files of the settings file
+	void Remove_Cache_Files( const std::string &filename ) const;
+
+	// Task function which caches the images
+	void Update_Task( vector<std::string> files );
+
+	struct Entry
+	{
+		vector<std::string> m_files;
+		// modification time of each file
+		vector<time_t> m_times;
+	};
+
+	// source files by settings filename
+	typedef boost::unordered_map<std::string, Entry> Entry_Map;
+	Entry_Map m_entries;
+	// if changed since loading
+	bool m_modified;
+
+	// active image cache directory
+	std::string m_cache_dir;
+	// task pool group of the caching
+	unsigned int m_task_group;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
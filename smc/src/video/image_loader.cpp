@@ -0,0 +1,219 @@
+/***************************************************************************
+ * image_loader.cpp  -  threaded image decoding
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/image_loader.h"
+#include "../video/img_settings.h"
+#include "../core/task_pool.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cImage_Loader *** *** *** *** *** *** *** *** *** *** */
+
+cImage_Loader :: cImage_Loader( Job_Type type, const std::string &cache_dir /* = "" */ )
+{
+	m_type = type;
+	m_cache_dir = cache_dir;
+	m_next_job = 0;
+	m_task_group = pTask_Pool->Create_Group();
+}
+
+cImage_Loader :: ~cImage_Loader( void )
+{
+	pTask_Pool->Cancel( m_task_group );
+
+	// delete the images which were not taken
+	for( Job_List::iterator itr = m_jobs.begin(); itr != m_jobs.end(); ++itr )
+	{
+		Job &job = (*itr);
+
+		if( job.m_taken || !job.m_done )
+		{
+			continue;
+		}
+
+		if( job.m_image.m_sdl_surface )
+		{
+			SDL_FreeSurface( job.m_image.m_sdl_surface );
+		}
+		if( job.m_image.m_settings )
+		{
+			delete job.m_image.m_settings;
+		}
+	}
+}
+
+void cImage_Loader :: Add( const std::string &filename )
+{
+	// already added
+	if( m_job_index.find( filename ) != m_job_index.end() )
+	{
+		return;
+	}
+
+	m_job_index[filename] = m_jobs.size();
+
+	Job job;
+	job.m_filename = filename;
+	job.m_done = 0;
+	job.m_taken = 0;
+
+	m_jobs.push_back( job );
+}
+
+void cImage_Loader :: Start( void )
+{
+	if( m_jobs.empty() )
+	{
+		return;
+	}
+
+	// every task runs jobs until none is left
+	unsigned int task_count = pTask_Pool->Get_Thread_Count();
+
+	if( task_count > m_jobs.size() )
+	{
+		task_count = m_jobs.size();
+	}
+
+	for( unsigned int i = 0; i < task_count; i++ )
+	{
+		pTask_Pool->Add( boost::bind( &cImage_Loader::Load_Task, this ), TASK_PRIORITY_BACKGROUND, m_task_group, "image load" );
+	}
+}
+
+unsigned int cImage_Loader :: Get_Count( void ) const
+{
+	return m_jobs.size();
+}
+
+const std::string &cImage_Loader :: Get_Filename( unsigned int num ) const
+{
+	return m_jobs[num].m_filename;
+}
+
+int cImage_Loader :: Find( const std::string &filename ) const
+{
+	Job_Map::const_iterator itr = m_job_index.find( filename );
+
+	if( itr == m_job_index.end() )
+	{
+		return -1;
+	}
+
+	return itr->second;
+}
+
+cVideo::cSoftware_Image cImage_Loader :: Wait( unsigned int num )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	Job &job = m_jobs[num];
+
+	while( !job.m_done )
+	{
+		// help as the caller can be a task itself which blocks a worker thread
+		if( m_next_job < m_jobs.size() )
+		{
+			const unsigned int next = m_next_job;
+			m_next_job++;
+			lock.unlock();
+
+			cImage_Settings_Parser settings_parser;
+			Run_Job( next, &settings_parser );
+
+			lock.lock();
+			continue;
+		}
+
+		m_condition.wait( lock );
+	}
+
+	// only one owner
+	if( job.m_taken )
+	{
+		return cVideo::cSoftware_Image();
+	}
+
+	job.m_taken = 1;
+	return job.m_image;
+}
+
+bool cImage_Loader :: Wait_Done( unsigned int num, unsigned int milliseconds )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	const Job &job = m_jobs[num];
+
+	if( !job.m_done )
+	{
+		m_condition.timed_wait( lock, boost::posix_time::milliseconds( milliseconds ) );
+	}
+
+	return job.m_done;
+}
+
+void cImage_Loader :: Load_Task( void )
+{
+	// the settings parser is not shared as it keeps the parsed data
+	cImage_Settings_Parser settings_parser;
+
+	while( 1 )
+	{
+		unsigned int num;
+
+		// get the next job
+		{
+			boost::mutex::scoped_lock lock( m_mutex );
+
+			if( m_next_job >= m_jobs.size() || pTask_Pool->Is_Cancelled( m_task_group ) )
+			{
+				return;
+			}
+
+			num = m_next_job;
+			m_next_job++;
+		}
+
+		Run_Job( num, &settings_parser );
+	}
+}
+
+void cImage_Loader :: Run_Job( unsigned int num, cImage_Settings_Parser *settings_parser )
+{
+	// the job is only used by this thread until it is done
+	const std::string &filename = m_jobs[num].m_filename;
+	cVideo::cSoftware_Image image;
+
+	if( m_type == JOB_LOAD )
+	{
+		image = pVideo->Load_Image( filename, 1, 1, settings_parser );
+		pVideo->Prepare_Software_Image( image );
+	}
+	else if( m_type == JOB_CACHE )
+	{
+		// the texture pixels of all resolutions to load without decoding
+		pVideo->Cache_Raw_Image( filename, m_cache_dir, settings_parser );
+	}
+
+	boost::mutex::scoped_lock lock( m_mutex );
+	m_jobs[num].m_image = image;
+	m_jobs[num].m_done = 1;
+	m_condition.notify_all();
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
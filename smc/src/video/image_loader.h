@@ -0,0 +1,116 @@
+/***************************************************************************
+ * image_loader.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_IMAGE_LOADER_H
+#define SMC_IMAGE_LOADER_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+#include "../video/video.h"
+// boost thread
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/bind.hpp>
+#include <boost/unordered_map.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cImage_Loader *** *** *** *** *** *** *** *** *** *** */
+
+/* Decodes images with several task pool background tasks
+ * the tasks only use software images and never opengl
+ * the results are taken in the order the files were added
+*/
+class cImage_Loader
+{
+public:
+	enum Job_Type
+	{
+		// load the software image and prepare it for the texture creation
+		JOB_LOAD = 0,
+		// save the scaled down image into the image cache
+		JOB_CACHE = 1
+	};
+
+	/* type : what the workers do with each file
+	 * cache_dir : image cache directory for the cache jobs
+	*/
+	cImage_Loader( Job_Type type, const std::string &cache_dir = "" );
+	~cImage_Loader( void );
+
+	// Add a file before starting if not already added
+	void Add( const std::string &filename );
+	// Start the tasks
+	void Start( void );
+
+	// Returns the number of added files
+	unsigned int Get_Count( void ) const;
+	// Returns the filename of the given job
+	const std::string &Get_Filename( unsigned int num ) const;
+	// Returns the job number of the filename or -1 if not added
+	int Find( const std::string &filename ) const;
+
+	/* Wait until the given job is finished and return its software image
+	 * runs the jobs not yet started on the calling thread while waiting
+	 * the image is owned by the caller afterwards
+	 * cache jobs and already taken images return an empty image
+	*/
+	cVideo::cSoftware_Image Wait( unsigned int num );
+	/* Wait at most the given milliseconds until the given job is finished
+	 * returns true if it is finished
+	*/
+	bool Wait_Done( unsigned int num, unsigned int milliseconds );
+
+private:
+	// Run the next jobs until none is left or cancelled
+	void Load_Task( void );
+	// Load or cache the file of the job and mark it as done
+	void Run_Job( unsigned int num, cImage_Settings_Parser *settings_parser );
+
+	struct Job
+	{
+		std::string m_filename;
+		cVideo::cSoftware_Image m_image;
+		bool m_done;
+		// if set the image was taken by Wait
+		bool m_taken;
+	};
+
+	typedef vector<Job> Job_List;
+	// jobs are not resized after starting
+	Job_List m_jobs;
+	// job number for each filename
+	typedef boost::unordered_map<std::string, unsigned int> Job_Map;
+	Job_Map m_job_index;
+
+	Job_Type m_type;
+	std::string m_cache_dir;
+
+	// task pool group of the jobs
+	unsigned int m_task_group;
+	// protects the jobs state and the next job number
+	boost::mutex m_mutex;
+	// notified if a job is finished
+	boost::condition_variable m_condition;
+	// next job for the tasks
+	unsigned int m_next_job;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -15,7 +15,9 @@
 
 #include "../video/img_manager.h"
 #include "../video/renderer.h"
+#include "../video/texture_atlas.h"
 #include "../core/i18n.h"
+#include "../user/preferences.h"
 // CEGUI
 #include "CEGUIWindowManager.h"
 #include "elements/CEGUIProgressBar.h"
@@ -23,6 +25,9 @@
 namespace SMC
 {
 
+// frames a texture must be unused before it can be unloaded
+static const unsigned int texture_unload_frames = 600;
+
 /* *** *** *** *** *** cSaved_Texture *** *** *** *** *** *** *** *** *** *** *** *** */
 
 cSaved_Texture :: cSaved_Texture( void )
@@ -51,9 +56,14 @@ cSaved_Texture :: ~cSaved_Texture( void )
 /* *** *** *** *** *** *** cImage_Manager *** *** *** *** *** *** *** *** *** *** *** */
 
 cImage_Manager :: cImage_Manager( void )
-: cObject_Manager<cGL_Surface>()
+: cObject_Manager<cGL_Surface>(), m_cpu_memory( "Images" ), m_vram_memory( "Image Textures" )
 {
 	m_high_texture_id = 0;
+	m_texture_generation = 0;
+	m_frame = 0;
+	m_resident_bytes = 0;
+	m_unloaded_bytes = 0;
+	m_budget_check_time = 0;
 }
 
 cImage_Manager :: ~cImage_Manager( void )
@@ -70,56 +80,87 @@ void cImage_Manager :: Add( cGL_Surface *obj )
 
 	// it is now managed
 	obj->m_managed = 1;
+	m_cpu_memory.Count_Allocation();
 
 	// Add
 	cObject_Manager<cGL_Surface>::Add( obj );
+
+	// keeps an already added surface with the same path
+	m_path_index.insert( GL_Surface_Map::value_type( obj->m_filename, obj ) );
 }
 
-cGL_Surface *cImage_Manager :: Get_Pointer( const std::string &path ) const
+bool cImage_Manager :: Delete( size_t array_num, bool delete_data /* = 1 */ )
 {
-	for( GL_Surface_List::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	return Delete( cObject_Manager<cGL_Surface>::Get_Pointer( array_num ), delete_data );
+}
+
+bool cImage_Manager :: Delete( cGL_Surface *obj, bool delete_data /* = 1 */ )
+{
+	if( !obj )
 	{
-		cGL_Surface *obj = (*itr);
+		return 0;
+	}
+
+	GL_Surface_Map::iterator index_itr = m_path_index.find( obj->m_filename );
+
+	// remove from the index
+	if( index_itr != m_path_index.end() && index_itr->second == obj )
+	{
+		m_path_index.erase( index_itr );
 
-		// return first match
-		if( obj->m_filename.compare( path ) == 0 )
+		// the next surface with the same path gets indexed
+		for( GL_Surface_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
 		{
-			return obj;
+			cGL_Surface *other = (*itr);
+
+			if( other != obj && other->m_filename.compare( obj->m_filename ) == 0 )
+			{
+				m_path_index.insert( GL_Surface_Map::value_type( other->m_filename, other ) );
+				break;
+			}
 		}
 	}
 
+	return cObject_Manager<cGL_Surface>::Delete( obj, delete_data );
+}
+
+cGL_Surface *cImage_Manager :: Get_Pointer( const std::string &path ) const
+{
+	GL_Surface_Map::const_iterator itr = m_path_index.find( path );
+
 	// not found
-	return NULL;
+	if( itr == m_path_index.end() )
+	{
+		return NULL;
+	}
+
+	return itr->second;
 }
 
 cGL_Surface *cImage_Manager :: Copy( const std::string &path )
 {
-	for( GL_Surface_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
-	{
-		// get object
-		cGL_Surface *obj = (*itr);
+	cGL_Surface *obj = Get_Pointer( path );
 
-		// first match
-		if( obj->m_filename.compare( path ) == 0 )
-		{
-			return obj->Copy();
-		}
+	// not found
+	if( !obj )
+	{
+		return NULL;
 	}
 
-	// not found
-	return NULL;
+	return obj->Copy();
 }
 
-void cImage_Manager :: Grab_Textures( bool from_file /* = 0 */, bool draw_gui /* = 0 */ )
+void cImage_Manager :: Grab_Textures( bool draw_gui /* = 0 */ )
 {
-	// progress bar
-	CEGUI::ProgressBar *progress_bar = NULL;
+	// uses opengl directly
+	if( pVideo )
+	{
+		pVideo->Render_Finish();
+	}
 
 	if( draw_gui )
 	{
-		// get progress bar
-		progress_bar = static_cast<CEGUI::ProgressBar *>(CEGUI::WindowManager::getSingleton().getWindow( "progress_bar" ));
-		progress_bar->setProgress( 0 );
+		Loading_Screen_Set_Progress( 0, 0 );
 		// set loading screen text
 		Loading_Screen_Draw_Text( _("Saving Textures") );
 	}
@@ -133,16 +174,16 @@ void cImage_Manager :: Grab_Textures( bool from_file /* = 0 */, bool draw_gui /*
 		// get surface
 		cGL_Surface *obj = (*itr);
 
-		// skip surfaces with an already deleted texture
-		if( !glIsTexture( obj->m_image ) )
+		// skip surfaces with an already deleted texture and surfaces which are loaded again from file
+		if( !glIsTexture( obj->m_image ) || ( obj->m_auto_del_img && !obj->m_filename.empty() ) )
 		{
 			continue;
 		}
 
 		// get software texture and save it to software memory
-		m_saved_textures.push_back( obj->Get_Software_Texture( from_file ) );
+		m_saved_textures.push_back( obj->Get_Software_Texture() );
 		// delete hardware texture
-		if( glIsTexture( obj->m_image ) )
+		if( !obj->Is_In_Atlas() && glIsTexture( obj->m_image ) )
 		{
 			glDeleteTextures( 1, &obj->m_image );
 		}
@@ -154,23 +195,26 @@ void cImage_Manager :: Grab_Textures( bool from_file /* = 0 */, bool draw_gui /*
 		if( draw_gui )
 		{
 			// update progress
-			progress_bar->setProgress( static_cast<float>(loaded_files) / static_cast<float>(file_count) );
-
+			Loading_Screen_Set_Progress( loaded_files, file_count );
 			Loading_Screen_Draw();
 		}
 	}
+
+	// without reading them back
+	Unload_File_Textures();
 }
 
 void cImage_Manager :: Restore_Textures( bool draw_gui /* = 0 */ )
 {
-	// progress bar
-	CEGUI::ProgressBar *progress_bar = NULL;
+	// uses opengl directly
+	if( pVideo )
+	{
+		pVideo->Render_Finish();
+	}
 
 	if( draw_gui )
 	{
-		// get progress bar
-		progress_bar = static_cast<CEGUI::ProgressBar *>(CEGUI::WindowManager::getSingleton().getWindow( "progress_bar" ));
-		progress_bar->setProgress( 0 );
+		Loading_Screen_Set_Progress( 0, 0 );
 		// set loading screen text
 		Loading_Screen_Draw_Text( _("Restoring Textures") );
 	}
@@ -196,31 +240,72 @@ void cImage_Manager :: Restore_Textures( bool draw_gui /* = 0 */ )
 		if( draw_gui )
 		{
 			// update progress
-			progress_bar->setProgress( static_cast<float>(loaded_files) / static_cast<float>(file_count) );
-
+			Loading_Screen_Set_Progress( loaded_files, file_count );
 			Loading_Screen_Draw();
 		}
 	}
 
 	m_saved_textures.clear();
+	// texture ids and coordinates may have changed
+	m_texture_generation++;
+}
+
+void cImage_Manager :: Unload_File_Textures( bool delete_textures /* = 1 */ )
+{
+	// uses opengl directly
+	if( pVideo )
+	{
+		pVideo->Render_Finish();
+	}
+
+	for( GL_Surface_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	{
+		(*itr)->Release_Texture( delete_textures );
+	}
+
+	// atlas images are added again when loaded from file
+	if( pTexture_Atlas )
+	{
+		pTexture_Atlas->Clear();
+	}
+
+	// texture ids and coordinates changed
+	m_texture_generation++;
 }
 
 void cImage_Manager :: Delete_Image_Textures( void )
 {
+	// uses opengl directly
+	if( pVideo )
+	{
+		pVideo->Render_Finish();
+	}
+
 	for( GL_Surface_List::iterator itr = objects.begin(); itr != objects.end(); ++itr ) 
 	{
 		// get object
 		cGL_Surface *obj = (*itr);
 
-		if( obj->m_auto_del_img && glIsTexture( obj->m_image ) )
+		if( obj->m_auto_del_img && !obj->Is_In_Atlas() && glIsTexture( obj->m_image ) )
 		{
 			glDeleteTextures( 1, &obj->m_image );
 		}
 	}
+
+	if( pTexture_Atlas )
+	{
+		pTexture_Atlas->Clear();
+	}
 }
 
 void cImage_Manager :: Delete_Hardware_Textures( void )
 {
+	// uses opengl directly
+	if( pVideo )
+	{
+		pVideo->Render_Finish();
+	}
+
 	// delete all hardware surfaces
 	for( GLuint i = 0; i < m_high_texture_id; i++ )
 	{
@@ -231,6 +316,12 @@ void cImage_Manager :: Delete_Hardware_Textures( void )
 		}
 	}
 
+	// pages are already deleted
+	if( pTexture_Atlas )
+	{
+		pTexture_Atlas->Clear();
+	}
+
 	m_high_texture_id = 0;
 }
 
@@ -239,6 +330,116 @@ void cImage_Manager :: Delete_All( void )
 	// stops cGL_Surface destructor from checking if GL texture id still in use
 	Delete_Image_Textures();
 	cObject_Manager<cGL_Surface>::Delete_All();
+	m_path_index.clear();
+}
+
+void cImage_Manager :: Update_Texture_Budget( void )
+{
+	m_frame++;
+
+	// check every second
+	if( SDL_GetTicks() - m_budget_check_time < 1000 )
+	{
+		return;
+	}
+
+	m_budget_check_time = SDL_GetTicks();
+	m_resident_bytes = 0;
+	m_unloaded_bytes = 0;
+
+	GL_Surface_List unused;
+
+	for( GL_Surface_List::iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	{
+		cGL_Surface *obj = (*itr);
+
+		if( obj->m_unloaded )
+		{
+			m_unloaded_bytes += obj->Get_Texture_Memory();
+			continue;
+		}
+
+		if( !obj->m_image )
+		{
+			continue;
+		}
+
+		m_resident_bytes += obj->Get_Texture_Memory();
+
+		if( m_frame - obj->m_last_use > texture_unload_frames )
+		{
+			unused.push_back( obj );
+		}
+	}
+
+	const unsigned int budget = pPreferences->m_video_texture_budget * 1024 * 1024;
+
+	// no limit or enough memory
+	if( !budget || m_resident_bytes <= budget )
+	{
+		return;
+	}
+
+	// least recently used first
+	std::sort( unused.begin(), unused.end(), last_use_sort() );
+
+	for( GL_Surface_List::iterator itr = unused.begin(); itr != unused.end() && m_resident_bytes > budget; ++itr )
+	{
+		cGL_Surface *obj = (*itr);
+
+		// the texture is still used by another surface
+		if( obj->Is_Texture_Use_Multiple() )
+		{
+			continue;
+		}
+
+		const unsigned int bytes = obj->Get_Texture_Memory();
+
+		if( obj->Unload_Texture() )
+		{
+			m_resident_bytes -= bytes;
+			m_unloaded_bytes += bytes;
+		}
+	}
+}
+
+void cImage_Manager :: Update_Memory_Counters( void )
+{
+	Uint64 cpu_bytes = 0;
+	Uint64 vram_bytes = 0;
+
+	for( GL_Surface_List::const_iterator itr = objects.begin(); itr != objects.end(); ++itr )
+	{
+		const cGL_Surface *obj = (*itr);
+
+		cpu_bytes += sizeof( cGL_Surface );
+
+		if( obj->m_image && !obj->m_unloaded )
+		{
+			vram_bytes += obj->Get_Texture_Memory();
+		}
+	}
+
+	for( Saved_Texture_List::const_iterator itr = m_saved_textures.begin(); itr != m_saved_textures.end(); ++itr )
+	{
+		const cSaved_Texture *obj = (*itr);
+
+		if( obj->m_pixels )
+		{
+			cpu_bytes += obj->m_width * obj->m_height * 4;
+		}
+	}
+
+	if( pTexture_Atlas )
+	{
+		for( Texture_Atlas_Page_List::const_iterator itr = pTexture_Atlas->m_pages.begin(); itr != pTexture_Atlas->m_pages.end(); ++itr )
+		{
+			vram_bytes += (*itr)->m_size * (*itr)->m_size * 4;
+		}
+	}
+
+	m_cpu_memory.Set( cpu_bytes );
+	m_vram_memory.Set( vram_bytes );
 }
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
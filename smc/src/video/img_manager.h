@@ -19,7 +19,10 @@
 #include "../core/global_basic.h"
 #include "../video/video.h"
 #include "../core/obj_manager.h"
+#include "../core/memory_pool.h"
 #include "../video/gl_surface.h"
+// boost
+#include <boost/unordered_map.hpp>
 
 namespace SMC
 {
@@ -54,6 +57,7 @@ public:
 
 typedef vector<cSaved_Texture *> Saved_Texture_List;
 typedef vector<cGL_Surface *> GL_Surface_List;
+typedef boost::unordered_map<std::string, cGL_Surface *> GL_Surface_Map;
 
 /* *** *** *** *** *** *** cImage_Manager *** *** *** *** *** *** *** *** *** *** *** */
 
@@ -71,6 +75,11 @@ public:
 	// Add a surface
 	virtual void Add( cGL_Surface *obj );
 
+	// Delete the surface from the given array number
+	virtual bool Delete( size_t array_num, bool delete_data = 1 );
+	// Delete the given surface
+	virtual bool Delete( cGL_Surface *obj, bool delete_data = 1 );
+
 	// Return the surface by path
 	cGL_Surface *Get_Pointer( const std::string &path ) const;
 
@@ -87,18 +96,23 @@ public:
 		return Get_Pointer( path );
 	}
 
-	/* Save hardware textures in software memory
-	 * from_file: if set don't store in software memory but load again from file
+	/* Save the hardware textures which can not be loaded again from file in software memory
+	 * the other textures are deleted and loaded again from file when used
 	 * draw_gui : if set use the loading screen gui for drawing
 	*/
-	void Grab_Textures( bool from_file = 0, bool draw_gui = 0  );
+	void Grab_Textures( bool draw_gui = 0 );
 
-	/* Load the saved software textures back into hardware textures or
-	 * load textures from file if set
+	/* Load the saved software textures back into hardware textures
 	 * draw_gui : if set use the loading screen gui for drawing
 	*/
 	void Restore_Textures( bool draw_gui = 0 );
 
+	/* Delete the textures which can be loaded again from file
+	 * they are loaded again from the image cache when used the next time
+	 * delete_textures : if not set the textures were already lost with the opengl context
+	*/
+	void Unload_File_Textures( bool delete_textures = 1 );
+
 	// Delete all surface textures, but keep object vector entries
 	void Delete_Image_Textures( void );
 
@@ -108,12 +122,47 @@ public:
 	// Delete all Surfaces
 	virtual void Delete_All( void );
 
+	/* Count the frame and unload the least recently used textures
+	 * if the texture memory is over the budget from the preferences
+	 * should be called once before drawing
+	*/
+	void Update_Texture_Budget( void );
+
+	// Count the memory of the surfaces, saved textures and atlas pages for the memory counters
+	void Update_Memory_Counters( void );
+
 	// highest opengl texture id found
 	GLuint m_high_texture_id;
+	// increased every time the textures are restored
+	unsigned int m_texture_generation;
+	// drawn frames for the texture use
+	unsigned int m_frame;
+	// loaded and unloaded texture memory in bytes of the last budget check
+	unsigned int m_resident_bytes;
+	unsigned int m_unloaded_bytes;
+
+	// software memory of the surfaces and saved textures
+	cMemory_Counter m_cpu_memory;
+	// texture memory
+	cMemory_Counter m_vram_memory;
 
 private:
+	// time of the last budget check
+	Uint32 m_budget_check_time;
+
 	// saved textures for reloading
 	Saved_Texture_List m_saved_textures;
+	// first added surface of each path
+	GL_Surface_Map m_path_index;
+
+	// sorts surfaces by the last use
+	struct last_use_sort
+	{
+		bool operator()( const cGL_Surface *a, const cGL_Surface *b ) const
+		{
+			return a->m_last_use < b->m_last_use;
+		}
+	};
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
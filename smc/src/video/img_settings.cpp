@@ -18,6 +18,7 @@
 #include "../core/math/utilities.h"
 #include "../core/math/size.h"
 #include "../core/filesystem/filesystem.h"
+#include <cstdio>
 
 namespace SMC
 {
@@ -37,6 +38,7 @@ cImage_Settings_Data :: cImage_Settings_Data( void )
 	m_rotation_y = 0;
 	m_rotation_z = 0;
 	m_mipmap = 0;
+	m_texture_format = TEXTURE_FORMAT_AUTO;
 
 	m_type = -1;
 	m_ground_type = GROUND_NORMAL;
@@ -48,16 +50,21 @@ cImage_Settings_Data :: ~cImage_Settings_Data( void )
 
 }
 
-cSize_Int cImage_Settings_Data :: Get_Surface_Size( const SDL_Surface *sdl_surface ) const
+cSize_Int cImage_Settings_Data :: Get_Surface_Size( const SDL_Surface *sdl_surface, bool use_texture_quality /* = 1 */ ) const
 {
 	if( !sdl_surface )
 	{
 		return cSize_Int();
 	}
 
+	return Get_Surface_Size( sdl_surface->w, sdl_surface->h, use_texture_quality );
+}
+
+cSize_Int cImage_Settings_Data :: Get_Surface_Size( int width, int height, bool use_texture_quality /* = 1 */ ) const
+{
 	// check if texture needs to get downscaled
-	float new_w = static_cast<float>(Get_Power_of_2( sdl_surface->w ));
-	float new_h = static_cast<float>(Get_Power_of_2( sdl_surface->h ));
+	float new_w = static_cast<float>(Get_Power_of_2( width ));
+	float new_h = static_cast<float>(Get_Power_of_2( height ));
 	
 	// if image settings dimension
 	if( m_width > 0 && m_height > 0 )
@@ -72,7 +79,7 @@ cSize_Int cImage_Settings_Data :: Get_Surface_Size( const SDL_Surface *sdl_surfa
 		}
 
 		// if texture detail below low
-		if( pVideo->m_texture_quality < 0.25f )
+		if( use_texture_quality && pVideo->m_texture_quality < 0.25f )
 		{
 			// half size only if texture size is high
 			if( new_w * 0.8f > m_width * global_upscalex && new_h * 0.8f > m_height * global_upscaley )
@@ -240,6 +247,7 @@ void cImage_Settings_Data :: Apply_Base( const cImage_Settings_Data *base_settin
 	m_rotation_y = base_settings_data->m_rotation_y;
 	m_rotation_z = base_settings_data->m_rotation_z;
 	m_mipmap = base_settings_data->m_mipmap;
+	m_texture_format = base_settings_data->m_texture_format;
 	m_editor_tags = base_settings_data->m_editor_tags;
 	m_name = base_settings_data->m_name;
 	m_type = base_settings_data->m_type;
@@ -269,37 +277,56 @@ cImage_Settings_Parser :: ~cImage_Settings_Parser( void )
 
 cImage_Settings_Data *cImage_Settings_Parser :: Get( const std::string &filename, bool load_base_settings /* = 1 */ )
 {
+	// already resolved
+	if( load_base_settings && pImage_Settings_Cache )
+	{
+		cImage_Settings_Data *settings = pImage_Settings_Cache->Get( filename, &m_files );
+
+		if( settings )
+		{
+			return settings;
+		}
+	}
+
 	m_load_base = load_base_settings;
+	m_files.clear();
+	m_files.push_back( filename );
 	m_settings_temp = new cImage_Settings_Data();
 
-	Parse( filename );
+	const bool parsed = Parse( filename );
 	cImage_Settings_Data *settings = m_settings_temp;
 	m_settings_temp = NULL;
+
+	if( parsed && load_base_settings && pImage_Settings_Cache )
+	{
+		pImage_Settings_Cache->Add( filename, settings, m_files );
+	}
+
 	return settings;
 }
 
-bool cImage_Settings_Parser :: HandleMessage( const std::string *parts, unsigned int count, unsigned int line )
+bool cImage_Settings_Parser :: Handle_Tokens( const cFile_Token *tokens, unsigned int count, unsigned int line )
 {
-	if( parts[0].compare( "base" ) == 0 )
+	if( tokens[0].Equals( "base" ) )
 	{
 		if( count < 2 || count > 3 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 2-3 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2-3 parameters" );
 			return 0;
 		}
 
-		if( !Is_Valid_Number( parts[2] ) )
+		if( !tokens[2].Is_Number() )
 		{
 			printf( "%s : line %d Error : ", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "%s is not a valid integer value\n", parts[1].c_str() );
+			printf( "%s is not a valid integer value\n", tokens[1].To_String().c_str() );
 			return 0;
 		}
 
-		m_settings_temp->m_base = data_file.substr( 0, data_file.rfind( "/" ) + 1 ) + parts[1];
+		m_settings_temp->m_base = data_file.substr( 0, data_file.rfind( "/" ) + 1 ) + tokens[1].To_String();
 
 		// with settings option
-		if( count == 3 && string_to_int( parts[2] ) )
+		if( count == 3 && tokens[2].To_Int() )
 		{
 			m_settings_temp->m_base_settings = 1;
 
@@ -307,280 +334,279 @@ bool cImage_Settings_Parser :: HandleMessage( const std::string *parts, unsigned
 			{
 				std::string settings_file = m_settings_temp->m_base;
 
+				// if not already image settings based
+				if( settings_file.rfind( ".settings" ) == std::string::npos )
+				{
+					settings_file.erase( settings_file.rfind( "." ) + 1 );
+					settings_file.insert( settings_file.rfind( "." ) + 1, "settings" );
+				}
+
 				// if settings file exists
-				while( !settings_file.empty() )
+				if( File_Exists( settings_file ) )
 				{
-					// if not already image settings based
-					if( settings_file.rfind( ".settings" ) == std::string::npos )
-					{
-						settings_file.erase( settings_file.rfind( "." ) + 1 );
-						settings_file.insert( settings_file.rfind( "." ) + 1, "settings" );
-					}
-
-					// not found
-					if( !File_Exists( settings_file ) )
-					{
-						break;
-					}
-
-					// create new temporary parser
-					cImage_Settings_Parser *temp_parser = new cImage_Settings_Parser();
-					cImage_Settings_Data *base_settings = temp_parser->Get( settings_file );
-					// finished loading base settings
-					delete temp_parser;
-					settings_file.clear();
-
-					// handle
-					if( base_settings )
-					{
-						// todo : apply settings in reverse order ( deepest settings should override first )
-						m_settings_temp->Apply_Base( base_settings );
-						
-						// if also based on settings
-						if( !base_settings->m_base.empty() && base_settings->m_base_settings )
-						{
-							settings_file = base_settings->m_base;
-						}
-						
-						delete base_settings;
-					}
+					// the base settings are already resolved with their own base settings
+					cImage_Settings_Parser temp_parser;
+					cImage_Settings_Data *base_settings = temp_parser.Get( settings_file );
+
+					m_settings_temp->Apply_Base( base_settings );
+					m_files.insert( m_files.end(), temp_parser.m_files.begin(), temp_parser.m_files.end() );
+
+					delete base_settings;
 				}
 			}
 		}
 	}
-	else if( parts[0].compare( "int_x" ) == 0 )
+	else if( tokens[0].Equals( "int_x" ) )
 	{
 		if( count != 2 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 2 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2 parameters" );
 			return 0;
 		}
 
-		if( !Is_Valid_Number( parts[1] ) )
+		if( !tokens[1].Is_Number() )
 		{
 			printf( "%s : line %d Error : ", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "%s is not a valid integer value\n", parts[1].c_str() );
+			printf( "%s is not a valid integer value\n", tokens[1].To_String().c_str() );
 			return 0;
 		}
 
-		m_settings_temp->m_int_x = string_to_int( parts[1] );
+		m_settings_temp->m_int_x = tokens[1].To_Int();
 	}
-	else if( parts[0].compare( "int_y" ) == 0 )
+	else if( tokens[0].Equals( "int_y" ) )
 	{
 		if( count != 2 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 2 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2 parameters" );
 			return 0;
 		}
 
-		if( !Is_Valid_Number( parts[1] ) )
+		if( !tokens[1].Is_Number() )
 		{
 			printf( "%s : line %d Error : ", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "%s is not a valid integer value\n", parts[1].c_str() );
+			printf( "%s is not a valid integer value\n", tokens[1].To_String().c_str() );
 			return 0;
 		}
 
-		m_settings_temp->m_int_y = string_to_int( parts[1] );
+		m_settings_temp->m_int_y = tokens[1].To_Int();
 	}
-	else if( parts[0].compare( "col_rect" ) == 0 )
+	else if( tokens[0].Equals( "col_rect" ) )
 	{
 		if( count != 5 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 5 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 5 parameters" );
 			return 0;
 		}
 
 		for( unsigned int i = 1; i < 5; i++ )
 		{
-			if( !Is_Valid_Number( parts[i] ) )
+			if( !tokens[i].Is_Number() )
 			{
 				printf( "%s : line %d Error : ", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-				printf( "%s is not a valid integer value\n", parts[1].c_str() );
+				printf( "%s is not a valid integer value\n", tokens[1].To_String().c_str() );
 				return 0;
 			}
 		}
 
 		// position and dimension
-		m_settings_temp->m_col_rect = GL_rect( static_cast<float>(string_to_int( parts[1] )), static_cast<float>(string_to_int( parts[2] )), static_cast<float>(string_to_int( parts[3] )), static_cast<float>(string_to_int( parts[4] )) );
+		m_settings_temp->m_col_rect = GL_rect( static_cast<float>(tokens[1].To_Int()), static_cast<float>(tokens[2].To_Int()), static_cast<float>(tokens[3].To_Int()), static_cast<float>(tokens[4].To_Int()) );
 	}
-	else if( parts[0].compare( "width" ) == 0 )
+	else if( tokens[0].Equals( "width" ) )
 	{
 		if( count != 2 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 2 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2 parameters" );
 			return 0;
 		}
 
-		if( !Is_Valid_Number( parts[1] ) )
+		if( !tokens[1].Is_Number() )
 		{
 			printf( "%s : line %d Error : ", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "%s is not a valid integer value\n", parts[1].c_str() );
+			printf( "%s is not a valid integer value\n", tokens[1].To_String().c_str() );
 			return 0;
 		}
 
-		m_settings_temp->m_width = string_to_int( parts[1] );
+		m_settings_temp->m_width = tokens[1].To_Int();
 	}
-	else if( parts[0].compare( "height" ) == 0 )
+	else if( tokens[0].Equals( "height" ) )
 	{
 		if( count != 2 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 2 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2 parameters" );
 			return 0;
 		}
 
-		if( !Is_Valid_Number( parts[1] ) )
+		if( !tokens[1].Is_Number() )
 		{
 			printf( "%s : line %d Error : ", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "%s is not a valid integer value\n", parts[1].c_str() );
+			printf( "%s is not a valid integer value\n", tokens[1].To_String().c_str() );
 			return 0;
 		}
 
-		m_settings_temp->m_height = string_to_int( parts[1] );
+		m_settings_temp->m_height = tokens[1].To_Int();
 	}
-	else if( parts[0].compare( "rotation" ) == 0 )
+	else if( tokens[0].Equals( "rotation" ) )
 	{
 		if( count < 2 || count > 5 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 2-5 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2-5 parameters" );
 			return 0;
 		}
 
-		if( !Is_Valid_Number( parts[1] ) )
+		if( !tokens[1].Is_Number() )
 		{
 			printf( "%s : line %d Error : ", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "%s is not a valid integer value\n", parts[1].c_str() );
+			printf( "%s is not a valid integer value\n", tokens[1].To_String().c_str() );
 			return 0;
 		}
 
 		// x
-		m_settings_temp->m_rotation_x = string_to_int( parts[1] );
+		m_settings_temp->m_rotation_x = tokens[1].To_Int();
 
 		// y
 		if( count > 2 )
 		{
-			if( !Is_Valid_Number( parts[2] ) )
+			if( !tokens[2].Is_Number() )
 			{
 				printf( "%s : line %d Error : ", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-				printf( "%s is not a valid integer value\n", parts[2].c_str() );
+				printf( "%s is not a valid integer value\n", tokens[2].To_String().c_str() );
 				return 0; // error
 			}
 
-			m_settings_temp->m_rotation_y = string_to_int( parts[2] );
+			m_settings_temp->m_rotation_y = tokens[2].To_Int();
 		}
 		// z
 		if( count > 3 )
 		{
-			if( !Is_Valid_Number( parts[3] ) )
+			if( !tokens[3].Is_Number() )
 			{
 				printf( "%s : line %d Error : ", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-				printf( "%s is not a valid integer value\n", parts[3].c_str() );
+				printf( "%s is not a valid integer value\n", tokens[3].To_String().c_str() );
 				return 0;
 			}
 
-			m_settings_temp->m_rotation_z = string_to_int( parts[3] );
+			m_settings_temp->m_rotation_z = tokens[3].To_Int();
 		}
 	}
-	else if( parts[0].compare( "mipmap" ) == 0 )
+	else if( tokens[0].Equals( "mipmap" ) )
 	{
 		if( count != 2 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 2 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2 parameters" );
 			return 0;
 		}
 
-		if( !Is_Valid_Number( parts[1] ) )
+		if( !tokens[1].Is_Number() )
 		{
 			printf( "%s : line %d Error : ", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "%s is not a valid integer value\n", parts[1].c_str() );
+			printf( "%s is not a valid integer value\n", tokens[1].To_String().c_str() );
 			return 0;
 		}
 
 		// if mipmaps enabled
-		if( string_to_int( parts[1] ) )
+		if( tokens[1].To_Int() )
 		{
 			m_settings_temp->m_mipmap = 1;
 		}
 	}
-	else if( parts[0].compare( "editor_tags" ) == 0 )
+	else if( tokens[0].Equals( "texture_format" ) )
+	{
+		if( count != 2 )
+		{
+			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2 parameters" );
+			return 0;
+		}
+
+		m_settings_temp->m_texture_format = Get_Texture_Format_Id( tokens[1].To_String() );
+
+		if( m_settings_temp->m_texture_format == TEXTURE_FORMAT_AUTO && !tokens[1].Equals( "auto" ) )
+		{
+			printf( "%s : line %d Error : ", Trim_Filename( data_file, 0, 0 ).c_str(), line );
+			printf( "%s is not a valid texture format\n", tokens[1].To_String().c_str() );
+			return 0;
+		}
+	}
+	else if( tokens[0].Equals( "editor_tags" ) )
 	{
 		if( count != 2 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 2 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2 parameters" );
 			return 0;
 		}
 
-		m_settings_temp->m_editor_tags = parts[1];
+		m_settings_temp->m_editor_tags = tokens[1].To_String();
 	}
-	else if( parts[0].compare( "name" ) == 0 )
+	else if( tokens[0].Equals( "name" ) )
 	{
 		if( count != 2 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 2 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2 parameters" );
 			return 0;
 		}
 
-		m_settings_temp->m_name = parts[1];
+		m_settings_temp->m_name = tokens[1].To_String();
 	}
-	else if( parts[0].compare( "type" ) == 0 )
+	else if( tokens[0].Equals( "type" ) )
 	{
 		if( count != 2 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 2 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2 parameters" );
 			return 0;
 		}
 
-		m_settings_temp->m_type = Get_Sprite_Type_Id( parts[1] );
+		m_settings_temp->m_type = Get_Sprite_Type_Id( tokens[1].m_data, tokens[1].m_length );
 	}
-	else if( parts[0].compare( "ground_type" ) == 0 )
+	else if( tokens[0].Equals( "ground_type" ) )
 	{
 		if( count != 2 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 2 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2 parameters" );
 			return 0;
 		}
 
-		m_settings_temp->m_ground_type = Get_Ground_Type_Id( parts[1] );
+		m_settings_temp->m_ground_type = Get_Ground_Type_Id( tokens[1].m_data, tokens[1].m_length );
 	}
-	else if( parts[0].compare( "author" ) == 0 )
+	else if( tokens[0].Equals( "author" ) )
 	{
 		if( count != 2 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 2 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2 parameters" );
 			return 0;
 		}
 
-		m_settings_temp->m_author = parts[1];
+		m_settings_temp->m_author = tokens[1].To_String();
 	}
-	else if( parts[0].compare( "obsolete" ) == 0 )
+	else if( tokens[0].Equals( "obsolete" ) )
 	{
 		if( count != 2 )
 		{
 			printf( "%s : line %d Error :\n", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "Error : %s %s\n", parts[0].c_str(), "needs 2 parameters" );
+			printf( "Error : %s %s\n", tokens[0].To_String().c_str(), "needs 2 parameters" );
 			return 0;
 		}
 
-		if( !Is_Valid_Number( parts[1] ) )
+		if( !tokens[1].Is_Number() )
 		{
 			printf( "%s : line %d Error : ", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-			printf( "%s is not a valid integer value\n", parts[1].c_str() );
+			printf( "%s is not a valid integer value\n", tokens[1].To_String().c_str() );
 			return 0; // error
 		}
 
 		// if tagged obsolete
-		if( string_to_int( parts[1] ) )
+		if( tokens[1].To_Int() )
 		{
 			m_settings_temp->m_obsolete = 1;
 		}
@@ -588,16 +614,262 @@ bool cImage_Settings_Parser :: HandleMessage( const std::string *parts, unsigned
 	else
 	{
 		printf( "%s : line %d Error : ", Trim_Filename( data_file, 0, 0 ).c_str(), line );
-		printf( "Unknown Command : %s\n", parts[0].c_str() );
+		printf( "Unknown Command : %s\n", tokens[0].To_String().c_str() );
+		return 0;
+	}
+
+	return 1;
+}
+
+/* *** *** *** *** *** *** Settings Index *** *** *** *** *** *** *** *** *** *** *** */
+
+// index file identification "SMCI" and version
+static const Uint32 settings_index_magic = 0x49434D53;
+static const Uint32 settings_index_version = 2;
+
+/* *** *** *** *** *** *** cImage_Settings_Cache *** *** *** *** *** *** *** *** *** *** *** */
+
+cImage_Settings_Cache :: cImage_Settings_Cache( void )
+{
+	m_modified = 0;
+}
+
+cImage_Settings_Cache :: ~cImage_Settings_Cache( void )
+{
+	Clear();
+}
+
+cImage_Settings_Data *cImage_Settings_Cache :: Get( const std::string &filename, vector<std::string> *files /* = NULL */ )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	Entry_Map::iterator itr = m_entries.find( filename );
+
+	// not cached
+	if( itr == m_entries.end() )
+	{
+		return NULL;
+	}
+
+	const Entry &entry = itr->second;
+
+	// check for modifications
+	for( unsigned int i = 0; i < entry.m_files.size(); i++ )
+	{
+		if( Get_File_Modification_Time( entry.m_files[i] ) != entry.m_times[i] )
+		{
+			m_entries.erase( itr );
+			return NULL;
+		}
+	}
+
+	if( files )
+	{
+		*files = entry.m_files;
+	}
+
+	return new cImage_Settings_Data( entry.m_settings );
+}
+
+void cImage_Settings_Cache :: Add( const std::string &filename, const cImage_Settings_Data *settings, const vector<std::string> &files )
+{
+	Entry entry;
+	entry.m_settings = *settings;
+	entry.m_files = files;
+
+	for( vector<std::string>::const_iterator itr = files.begin(); itr != files.end(); ++itr )
+	{
+		entry.m_times.push_back( Get_File_Modification_Time( *itr ) );
+	}
+
+	boost::mutex::scoped_lock lock( m_mutex );
+	m_entries[filename] = entry;
+	m_modified = 1;
+}
+
+void cImage_Settings_Cache :: Clear( void )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+	m_entries.clear();
+}
+
+bool cImage_Settings_Cache :: Load_Index( const std::string &filename )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	m_index_filename = filename;
+	// saved again if not loaded
+	m_modified = 1;
+
+	FILE *fp = fopen( filename.c_str(), "rb" );
+
+	if( !fp )
+	{
+		return 0;
+	}
+
+	// read the whole file at once
+	fseek( fp, 0, SEEK_END );
+	const long size = ftell( fp );
+	fseek( fp, 0, SEEK_SET );
+
+	if( size <= 0 )
+	{
+		fclose( fp );
+		return 0;
+	}
+
+	vector<char> data( size );
+	const bool read = fread( &data[0], size, 1, fp ) == 1;
+	fclose( fp );
+
+	if( !read )
+	{
+		return 0;
+	}
+
+	cIndex_Reader reader( &data[0], data.size() );
+
+	// check identification and version
+	if( reader.Read_Uint32() != settings_index_magic || reader.Read_Uint32() != settings_index_version )
+	{
+		debug_print( "Info : image settings index %s is outdated\n", filename.c_str() );
+		return 0;
+	}
+
+	const Uint32 count = reader.Read_Uint32();
+	Entry_Map entries;
+
+	for( Uint32 i = 0; i < count && reader.m_valid; i++ )
+	{
+		const std::string key = reader.Read_String();
+		Entry &entry = entries[key];
+
+		const Uint32 file_count = reader.Read_Uint32();
+
+		for( Uint32 j = 0; j < file_count && reader.m_valid; j++ )
+		{
+			entry.m_files.push_back( reader.Read_String() );
+			entry.m_times.push_back( static_cast<time_t>(reader.Read_Uint64()) );
+		}
+
+		cImage_Settings_Data &settings = entry.m_settings;
+		settings.m_base = reader.Read_String();
+		settings.m_base_settings = reader.Read_Uint32() != 0;
+		settings.m_int_x = static_cast<int>(reader.Read_Uint32());
+		settings.m_int_y = static_cast<int>(reader.Read_Uint32());
+		settings.m_col_rect.m_x = static_cast<float>(static_cast<int>(reader.Read_Uint32()));
+		settings.m_col_rect.m_y = static_cast<float>(static_cast<int>(reader.Read_Uint32()));
+		settings.m_col_rect.m_w = static_cast<float>(static_cast<int>(reader.Read_Uint32()));
+		settings.m_col_rect.m_h = static_cast<float>(static_cast<int>(reader.Read_Uint32()));
+		settings.m_width = static_cast<int>(reader.Read_Uint32());
+		settings.m_height = static_cast<int>(reader.Read_Uint32());
+		settings.m_rotation_x = static_cast<int>(reader.Read_Uint32());
+		settings.m_rotation_y = static_cast<int>(reader.Read_Uint32());
+		settings.m_rotation_z = static_cast<int>(reader.Read_Uint32());
+		settings.m_mipmap = reader.Read_Uint32() != 0;
+		settings.m_texture_format = static_cast<Texture_Format>(reader.Read_Uint32());
+		settings.m_editor_tags = reader.Read_String();
+		settings.m_name = reader.Read_String();
+		settings.m_type = static_cast<int>(reader.Read_Uint32());
+		settings.m_ground_type = static_cast<GroundType>(reader.Read_Uint32());
+		settings.m_author = reader.Read_String();
+		settings.m_obsolete = reader.Read_Uint32() != 0;
+	}
+
+	if( !reader.m_valid )
+	{
+		printf( "Warning : image settings index %s is invalid\n", filename.c_str() );
+		return 0;
+	}
+
+	// entries parsed before are newer
+	for( Entry_Map::iterator itr = entries.begin(); itr != entries.end(); ++itr )
+	{
+		m_entries.insert( *itr );
+	}
+
+	m_modified = 0;
+	return 1;
+}
+
+bool cImage_Settings_Cache :: Save_Index( void )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	if( m_index_filename.empty() || !m_modified )
+	{
+		return 1;
+	}
+
+	cIndex_Writer writer;
+	writer.Write_Uint32( settings_index_magic );
+	writer.Write_Uint32( settings_index_version );
+	writer.Write_Uint32( m_entries.size() );
+
+	for( Entry_Map::const_iterator itr = m_entries.begin(); itr != m_entries.end(); ++itr )
+	{
+		const Entry &entry = itr->second;
+		const cImage_Settings_Data &settings = entry.m_settings;
+
+		writer.Write_String( itr->first );
+		writer.Write_Uint32( entry.m_files.size() );
+
+		for( unsigned int i = 0; i < entry.m_files.size(); i++ )
+		{
+			writer.Write_String( entry.m_files[i] );
+			writer.Write_Uint64( static_cast<Uint64>(entry.m_times[i]) );
+		}
+
+		writer.Write_String( settings.m_base );
+		writer.Write_Uint32( settings.m_base_settings );
+		writer.Write_Uint32( settings.m_int_x );
+		writer.Write_Uint32( settings.m_int_y );
+		writer.Write_Uint32( static_cast<int>(settings.m_col_rect.m_x) );
+		writer.Write_Uint32( static_cast<int>(settings.m_col_rect.m_y) );
+		writer.Write_Uint32( static_cast<int>(settings.m_col_rect.m_w) );
+		writer.Write_Uint32( static_cast<int>(settings.m_col_rect.m_h) );
+		writer.Write_Uint32( settings.m_width );
+		writer.Write_Uint32( settings.m_height );
+		writer.Write_Uint32( settings.m_rotation_x );
+		writer.Write_Uint32( settings.m_rotation_y );
+		writer.Write_Uint32( settings.m_rotation_z );
+		writer.Write_Uint32( settings.m_mipmap );
+		writer.Write_Uint32( settings.m_texture_format );
+		writer.Write_String( settings.m_editor_tags );
+		writer.Write_String( settings.m_name );
+		writer.Write_Uint32( settings.m_type );
+		writer.Write_Uint32( settings.m_ground_type );
+		writer.Write_String( settings.m_author );
+		writer.Write_Uint32( settings.m_obsolete );
+	}
+
+	FILE *fp = fopen( m_index_filename.c_str(), "wb" );
+
+	if( !fp )
+	{
+		printf( "Warning : could not save image settings index %s\n", m_index_filename.c_str() );
+		return 0;
+	}
+
+	const bool written = fwrite( writer.m_data.data(), writer.m_data.size(), 1, fp ) == 1;
+	fclose( fp );
+
+	if( !written )
+	{
+		printf( "Warning : could not save image settings index %s\n", m_index_filename.c_str() );
+		Delete_File( m_index_filename );
 		return 0;
 	}
 
+	m_modified = 0;
 	return 1;
 }
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 cImage_Settings_Parser *pSettingsParser = NULL;
+cImage_Settings_Cache *pImage_Settings_Cache = NULL;
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
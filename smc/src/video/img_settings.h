@@ -20,6 +20,9 @@
 #include "../core/file_parser.h"
 #include "../video/gl_surface.h"
 #include "../core/math/rect.h"
+// boost
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
 
 namespace SMC
 {
@@ -32,8 +35,12 @@ public:
 	cImage_Settings_Data( void );
 	~cImage_Settings_Data( void );
 
-	// returns the best surface size for the current resolution
-	cSize_Int Get_Surface_Size( const SDL_Surface *sdl_surface ) const;
+	/* returns the best surface size for the current resolution
+	 * use_texture_quality : if set a low texture quality halves big images
+	*/
+	cSize_Int Get_Surface_Size( const SDL_Surface *sdl_surface, bool use_texture_quality = 1 ) const;
+	// returns the best surface size for the current resolution from the image size
+	cSize_Int Get_Surface_Size( int width, int height, bool use_texture_quality = 1 ) const;
 	// Apply settings to an image
 	void Apply( cGL_Surface *image ) const;
 	// Apply base settings
@@ -57,6 +64,8 @@ public:
 	int m_rotation_x, m_rotation_y, m_rotation_z;
 	// texture mipmapping
 	bool m_mipmap;
+	// texture storage format
+	Texture_Format m_texture_format;
 
 	// editor tags
 	std::string m_editor_tags;
@@ -86,19 +95,78 @@ public:
 	*/
 	cImage_Settings_Data *Get( const std::string &filename, bool load_base_settings = 1 );
 
-	// Handle one tokenized line
-	virtual bool HandleMessage( const std::string *parts, unsigned int count, unsigned int line );
+	// Handle one tokenized line without creating strings
+	virtual bool Handle_Tokens( const cFile_Token *tokens, unsigned int count, unsigned int line );
 
 	// temp settings used for loading
 	cImage_Settings_Data *m_settings_temp;
 	// load base settings
 	bool m_load_base;
+	// settings file and base settings files of the last loading
+	vector<std::string> m_files;
+};
+
+/* *** *** *** *** *** *** cImage_Settings_Cache *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Resolved settings of each settings file including all base settings
+ * an entry is reloaded if the file or one of its base files was modified
+ * can be used from several threads
+*/
+class cImage_Settings_Cache
+{
+public:
+	cImage_Settings_Cache( void );
+	~cImage_Settings_Cache( void );
+
+	/* Returns a copy of the resolved settings of the file
+	 * or NULL if not cached or modified
+	 * files : if set receives the settings file and all its base settings files
+	 * The returned settings data should be deleted if not used anymore
+	*/
+	cImage_Settings_Data *Get( const std::string &filename, vector<std::string> *files = NULL );
+	/* Add the resolved settings of the file
+	 * files : the settings file and all its base settings files
+	*/
+	void Add( const std::string &filename, const cImage_Settings_Data *settings, const vector<std::string> &files );
+	// Delete all entries
+	void Clear( void );
+
+	/* Add the entries from the binary index file
+	 * the file is used for saving afterwards even if it could not be loaded
+	 * returns false if it could not be loaded
+	*/
+	bool Load_Index( const std::string &filename );
+	/* Save all entries to the index file if changed since loading
+	 * returns false if it could not be saved
+	*/
+	bool Save_Index( void );
+
+private:
+	struct Entry
+	{
+		cImage_Settings_Data m_settings;
+		vector<std::string> m_files;
+		// modification time of each file
+		vector<time_t> m_times;
+	};
+
+	typedef boost::unordered_map<std::string, Entry> Entry_Map;
+	Entry_Map m_entries;
+	// protects the entries
+	boost::mutex m_mutex;
+
+	// index file or empty if not used
+	std::string m_index_filename;
+	// if entries were added since the index was loaded
+	bool m_modified;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 // Image settings parser
 extern cImage_Settings_Parser *pSettingsParser;
+// Resolved image settings
+extern cImage_Settings_Cache *pImage_Settings_Cache;
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
@@ -0,0 +1,709 @@
+/***************************************************************************
+ * particle_shader.cpp  -  particle simulation in a vertex shader
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/particle_shader.h"
+#include "../video/animation.h"
+#include "../video/renderer.h"
+#include "../video/gl_state.h"
+#include "../video/video.h"
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** Extension *** *** *** *** *** *** *** *** *** *** */
+
+#ifndef APIENTRY
+	#define APIENTRY
+#endif
+#ifndef GL_ARRAY_BUFFER
+	#define GL_ARRAY_BUFFER 0x8892
+#endif
+#ifndef GL_DYNAMIC_DRAW
+	#define GL_DYNAMIC_DRAW 0x88E8
+#endif
+#ifndef GL_VERTEX_SHADER
+	#define GL_VERTEX_SHADER 0x8B31
+	#define GL_COMPILE_STATUS 0x8B81
+	#define GL_LINK_STATUS 0x8B82
+	#define GL_INFO_LOG_LENGTH 0x8B84
+#endif
+
+typedef void (APIENTRY *Gen_Buffers_Func)( GLsizei n, GLuint *buffers );
+typedef void (APIENTRY *Delete_Buffers_Func)( GLsizei n, const GLuint *buffers );
+typedef void (APIENTRY *Bind_Buffer_Func)( GLenum target, GLuint buffer );
+typedef void (APIENTRY *Buffer_Data_Func)( GLenum target, ptrdiff_t size, const GLvoid *data, GLenum usage );
+typedef void (APIENTRY *Buffer_Sub_Data_Func)( GLenum target, ptrdiff_t offset, ptrdiff_t size, const GLvoid *data );
+typedef GLuint (APIENTRY *Create_Shader_Func)( GLenum type );
+typedef void (APIENTRY *Delete_Shader_Func)( GLuint shader );
+typedef void (APIENTRY *Shader_Source_Func)( GLuint shader, GLsizei count, const char **string, const GLint *length );
+typedef void (APIENTRY *Compile_Shader_Func)( GLuint shader );
+typedef void (APIENTRY *Get_Shader_Iv_Func)( GLuint shader, GLenum pname, GLint *params );
+typedef void (APIENTRY *Get_Shader_Info_Log_Func)( GLuint shader, GLsizei max_length, GLsizei *length, char *info_log );
+typedef GLuint (APIENTRY *Create_Program_Func)( void );
+typedef void (APIENTRY *Delete_Program_Func)( GLuint program );
+typedef void (APIENTRY *Attach_Shader_Func)( GLuint program, GLuint shader );
+typedef void (APIENTRY *Bind_Attrib_Location_Func)( GLuint program, GLuint index, const char *name );
+typedef void (APIENTRY *Link_Program_Func)( GLuint program );
+typedef void (APIENTRY *Get_Program_Iv_Func)( GLuint program, GLenum pname, GLint *params );
+typedef void (APIENTRY *Get_Program_Info_Log_Func)( GLuint program, GLsizei max_length, GLsizei *length, char *info_log );
+typedef void (APIENTRY *Use_Program_Func)( GLuint program );
+typedef GLint (APIENTRY *Get_Uniform_Location_Func)( GLuint program, const char *name );
+typedef void (APIENTRY *Uniform_1f_Func)( GLint location, GLfloat v0 );
+typedef void (APIENTRY *Uniform_3f_Func)( GLint location, GLfloat v0, GLfloat v1, GLfloat v2 );
+typedef void (APIENTRY *Uniform_4f_Func)( GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3 );
+typedef void (APIENTRY *Vertex_Attrib_Pointer_Func)( GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid *pointer );
+typedef void (APIENTRY *Vertex_Attrib_Array_Func)( GLuint index );
+
+static Gen_Buffers_Func smc_glGenBuffers = NULL;
+static Delete_Buffers_Func smc_glDeleteBuffers = NULL;
+static Bind_Buffer_Func smc_glBindBuffer = NULL;
+static Buffer_Data_Func smc_glBufferData = NULL;
+static Buffer_Sub_Data_Func smc_glBufferSubData = NULL;
+static Create_Shader_Func smc_glCreateShader = NULL;
+static Delete_Shader_Func smc_glDeleteShader = NULL;
+static Shader_Source_Func smc_glShaderSource = NULL;
+static Compile_Shader_Func smc_glCompileShader = NULL;
+static Get_Shader_Iv_Func smc_glGetShaderiv = NULL;
+static Get_Shader_Info_Log_Func smc_glGetShaderInfoLog = NULL;
+static Create_Program_Func smc_glCreateProgram = NULL;
+static Delete_Program_Func smc_glDeleteProgram = NULL;
+static Attach_Shader_Func smc_glAttachShader = NULL;
+static Bind_Attrib_Location_Func smc_glBindAttribLocation = NULL;
+static Link_Program_Func smc_glLinkProgram = NULL;
+static Get_Program_Iv_Func smc_glGetProgramiv = NULL;
+static Get_Program_Info_Log_Func smc_glGetProgramInfoLog = NULL;
+static Use_Program_Func smc_glUseProgram = NULL;
+static Get_Uniform_Location_Func smc_glGetUniformLocation = NULL;
+static Uniform_1f_Func smc_glUniform1f = NULL;
+static Uniform_3f_Func smc_glUniform3f = NULL;
+static Uniform_4f_Func smc_glUniform4f = NULL;
+static Vertex_Attrib_Pointer_Func smc_glVertexAttribPointer = NULL;
+static Vertex_Attrib_Array_Func smc_glEnableVertexAttribArray = NULL;
+static Vertex_Attrib_Array_Func smc_glDisableVertexAttribArray = NULL;
+
+// increased for every created shader
+static unsigned int particle_shader_context = 0;
+
+// simulation time in speed factor units after which all times are rebased to keep the float precision
+static const float particle_seed_time_rebase = 65536.0f;
+// emission time of unused particles which never shows them
+static const float particle_seed_unused_time = 1.0e30f;
+
+/* The particle movement of cParticle_List::Update and the quad of cParticle_Emitter::Draw_Particles
+ * gravity is integrated exactly instead of per frame
+*/
+static const char *particle_vertex_shader =
+	"#version 110\n"
+	"uniform float time;\n"
+	// half image start size and half image size
+	"uniform vec4 size;\n"
+	// position offset and image internal offset
+	"uniform vec4 offset;\n"
+	"uniform vec3 base_rot;\n"
+	// size, alpha and color fading
+	"uniform vec3 fade;\n"
+	"uniform vec4 clip;\n"
+	"uniform vec4 tex;\n"
+	"attribute vec4 start;\n"
+	"attribute vec4 move;\n"
+	"attribute vec4 rot;\n"
+	"attribute vec4 const_rot;\n"
+	"void main()\n"
+	"{\n"
+	"	float t = time - start.w;\n"
+	"	float fade_pos = 1.0 - rot.w * t;\n"
+	// not emitted yet or finished
+	"	if( t < 0.0 || fade_pos <= 0.0 )\n"
+	"	{\n"
+	"		gl_Position = vec4( 0.0, 0.0, 2.0, 1.0 );\n"
+	"		return;\n"
+	"	}\n"
+	"	float scale = const_rot.w;\n"
+	"	if( fade.x > 0.5 )\n"
+	"	{\n"
+	"		scale *= fade_pos;\n"
+	"	}\n"
+	"	vec2 pos = start.xy + move.xy * t + move.zw * ( 0.5 * t * t );\n"
+	// moved to the other side if it left the clip rect
+	"	if( clip.z > 0.0 )\n"
+	"	{\n"
+	"		vec2 obj_size = size.zw * ( 2.0 * scale );\n"
+	"		vec2 obj_pos = pos - size.zw * ( scale - 1.0 );\n"
+	"		vec2 low = clip.xy - obj_size;\n"
+	"		pos += low + mod( obj_pos - low, clip.zw + obj_size ) - obj_pos;\n"
+	"	}\n"
+	"	vec2 center = pos + offset.xy + offset.zw * scale - size.zw * ( scale - 1.0 ) + size.xy * scale;\n"
+	"	vec3 angle = radians( rot.xyz + const_rot.xyz * t + base_rot );\n"
+	"	vec3 c = cos( angle );\n"
+	"	vec3 s = sin( angle );\n"
+	"	vec2 corner = gl_Vertex.xy * size.xy;\n"
+	// z axis
+	"	float x1 = corner.x * c.z - corner.y * s.z;\n"
+	"	float y1 = corner.x * s.z + corner.y * c.z;\n"
+	// y axis
+	"	float x2 = x1 * c.y;\n"
+	"	float z2 = -x1 * s.y;\n"
+	// x axis
+	"	float y3 = y1 * c.x - z2 * s.x;\n"
+	"	float z3 = y1 * s.x + z2 * c.x;\n"
+	// the depth is not scaled
+	"	gl_Position = gl_ModelViewProjectionMatrix * vec4( center.x + x2 * scale, center.y + y3 * scale, start.z + z3, 1.0 );\n"
+	"	gl_TexCoord[0] = vec4( mix( tex.xy, tex.zw, gl_Vertex.xy * 0.5 + 0.5 ), 0.0, 1.0 );\n"
+	"	vec4 color = gl_Color;\n"
+	"	if( fade.z > 0.5 )\n"
+	"	{\n"
+	"		color.rgb *= fade_pos;\n"
+	"	}\n"
+	"	if( fade.y > 0.5 )\n"
+	"	{\n"
+	"		color.a *= fade_pos;\n"
+	"	}\n"
+	"	gl_FrontColor = color;\n"
+	"}\n";
+
+/* *** *** *** *** *** *** *** cParticle_Shader *** *** *** *** *** *** *** *** *** *** */
+
+cParticle_Shader :: cParticle_Shader( void )
+{
+	m_program = 0;
+	m_vertex_shader = 0;
+	m_context = 0;
+
+	m_uniform_time = -1;
+	m_uniform_size = -1;
+	m_uniform_offset = -1;
+	m_uniform_base_rot = -1;
+	m_uniform_fade = -1;
+	m_uniform_clip = -1;
+	m_uniform_tex = -1;
+}
+
+cParticle_Shader :: ~cParticle_Shader( void )
+{
+	Exit();
+}
+
+bool cParticle_Shader :: Init( void )
+{
+	Exit();
+
+	const char *version = reinterpret_cast<const char *>(glGetString( GL_VERSION ));
+
+	if( !version || version[0] < '2' || version[0] > '9' )
+	{
+		printf( "Warning : cParticle_Shader : OpenGL 2.0 is not supported\n" );
+		return 0;
+	}
+
+	smc_glGenBuffers = reinterpret_cast<Gen_Buffers_Func>(SDL_GL_GetProcAddress( "glGenBuffers" ));
+	smc_glDeleteBuffers = reinterpret_cast<Delete_Buffers_Func>(SDL_GL_GetProcAddress( "glDeleteBuffers" ));
+	smc_glBindBuffer = reinterpret_cast<Bind_Buffer_Func>(SDL_GL_GetProcAddress( "glBindBuffer" ));
+	smc_glBufferData = reinterpret_cast<Buffer_Data_Func>(SDL_GL_GetProcAddress( "glBufferData" ));
+	smc_glBufferSubData = reinterpret_cast<Buffer_Sub_Data_Func>(SDL_GL_GetProcAddress( "glBufferSubData" ));
+	smc_glCreateShader = reinterpret_cast<Create_Shader_Func>(SDL_GL_GetProcAddress( "glCreateShader" ));
+	smc_glDeleteShader = reinterpret_cast<Delete_Shader_Func>(SDL_GL_GetProcAddress( "glDeleteShader" ));
+	smc_glShaderSource = reinterpret_cast<Shader_Source_Func>(SDL_GL_GetProcAddress( "glShaderSource" ));
+	smc_glCompileShader = reinterpret_cast<Compile_Shader_Func>(SDL_GL_GetProcAddress( "glCompileShader" ));
+	smc_glGetShaderiv = reinterpret_cast<Get_Shader_Iv_Func>(SDL_GL_GetProcAddress( "glGetShaderiv" ));
+	smc_glGetShaderInfoLog = reinterpret_cast<Get_Shader_Info_Log_Func>(SDL_GL_GetProcAddress( "glGetShaderInfoLog" ));
+	smc_glCreateProgram = reinterpret_cast<Create_Program_Func>(SDL_GL_GetProcAddress( "glCreateProgram" ));
+	smc_glDeleteProgram = reinterpret_cast<Delete_Program_Func>(SDL_GL_GetProcAddress( "glDeleteProgram" ));
+	smc_glAttachShader = reinterpret_cast<Attach_Shader_Func>(SDL_GL_GetProcAddress( "glAttachShader" ));
+	smc_glBindAttribLocation = reinterpret_cast<Bind_Attrib_Location_Func>(SDL_GL_GetProcAddress( "glBindAttribLocation" ));
+	smc_glLinkProgram = reinterpret_cast<Link_Program_Func>(SDL_GL_GetProcAddress( "glLinkProgram" ));
+	smc_glGetProgramiv = reinterpret_cast<Get_Program_Iv_Func>(SDL_GL_GetProcAddress( "glGetProgramiv" ));
+	smc_glGetProgramInfoLog = reinterpret_cast<Get_Program_Info_Log_Func>(SDL_GL_GetProcAddress( "glGetProgramInfoLog" ));
+	smc_glUseProgram = reinterpret_cast<Use_Program_Func>(SDL_GL_GetProcAddress( "glUseProgram" ));
+	smc_glGetUniformLocation = reinterpret_cast<Get_Uniform_Location_Func>(SDL_GL_GetProcAddress( "glGetUniformLocation" ));
+	smc_glUniform1f = reinterpret_cast<Uniform_1f_Func>(SDL_GL_GetProcAddress( "glUniform1f" ));
+	smc_glUniform3f = reinterpret_cast<Uniform_3f_Func>(SDL_GL_GetProcAddress( "glUniform3f" ));
+	smc_glUniform4f = reinterpret_cast<Uniform_4f_Func>(SDL_GL_GetProcAddress( "glUniform4f" ));
+	smc_glVertexAttribPointer = reinterpret_cast<Vertex_Attrib_Pointer_Func>(SDL_GL_GetProcAddress( "glVertexAttribPointer" ));
+	smc_glEnableVertexAttribArray = reinterpret_cast<Vertex_Attrib_Array_Func>(SDL_GL_GetProcAddress( "glEnableVertexAttribArray" ));
+	smc_glDisableVertexAttribArray = reinterpret_cast<Vertex_Attrib_Array_Func>(SDL_GL_GetProcAddress( "glDisableVertexAttribArray" ));
+
+	if( !smc_glGenBuffers || !smc_glDeleteBuffers || !smc_glBindBuffer || !smc_glBufferData || !smc_glBufferSubData ||
+		!smc_glCreateShader || !smc_glDeleteShader || !smc_glShaderSource || !smc_glCompileShader || !smc_glGetShaderiv || !smc_glGetShaderInfoLog ||
+		!smc_glCreateProgram || !smc_glDeleteProgram || !smc_glAttachShader || !smc_glBindAttribLocation || !smc_glLinkProgram ||
+		!smc_glGetProgramiv || !smc_glGetProgramInfoLog || !smc_glUseProgram || !smc_glGetUniformLocation ||
+		!smc_glUniform1f || !smc_glUniform3f || !smc_glUniform4f ||
+		!smc_glVertexAttribPointer || !smc_glEnableVertexAttribArray || !smc_glDisableVertexAttribArray )
+	{
+		printf( "Warning : cParticle_Shader : shader functions not found\n" );
+		return 0;
+	}
+
+	if( !Create_Program() )
+	{
+		Exit();
+		return 0;
+	}
+
+	particle_shader_context++;
+	m_context = particle_shader_context;
+
+	return 1;
+}
+
+void cParticle_Shader :: Exit( void )
+{
+	// the render thread is not running
+	Update_Retired();
+	Update_Retired();
+
+	if( m_program )
+	{
+		Delete_Buffers();
+		smc_glDeleteProgram( m_program );
+		m_program = 0;
+	}
+	else
+	{
+		m_deleted_buffers.clear();
+	}
+
+	if( m_vertex_shader )
+	{
+		smc_glDeleteShader( m_vertex_shader );
+		m_vertex_shader = 0;
+	}
+
+	m_context = 0;
+}
+
+void cParticle_Shader :: Retire( cParticle_Seed_Buffer *buffer )
+{
+	m_retired.push_back( buffer );
+}
+
+void cParticle_Shader :: Update_Retired( void )
+{
+	// the render thread finished using these
+	for( Seed_Buffer_List::iterator itr = m_retired_old.begin(); itr != m_retired_old.end(); ++itr )
+	{
+		cParticle_Seed_Buffer *buffer = (*itr);
+
+		// buffers of an old context are already gone
+		if( buffer->m_buffer && buffer->m_buffer_context == m_context )
+		{
+			boost::mutex::scoped_lock lock( m_deleted_mutex );
+			m_deleted_buffers.push_back( buffer->m_buffer );
+		}
+
+		delete buffer;
+	}
+
+	m_retired_old.clear();
+	m_retired_old.swap( m_retired );
+}
+
+void cParticle_Shader :: Use( const cParticle_Seed_Request *request )
+{
+	Delete_Buffers();
+
+	smc_glUseProgram( m_program );
+
+	smc_glUniform1f( m_uniform_time, request->m_time );
+	smc_glUniform4f( m_uniform_size, request->m_half_w, request->m_half_h, request->m_scale_offset_x, request->m_scale_offset_y );
+	smc_glUniform4f( m_uniform_offset, request->m_offset_x, request->m_offset_y, request->m_image_x, request->m_image_y );
+	smc_glUniform3f( m_uniform_base_rot, request->m_base_rot_x, request->m_base_rot_y, request->m_base_rot_z );
+	smc_glUniform3f( m_uniform_fade, request->m_fade_size ? 1.0f : 0.0f, request->m_fade_alpha ? 1.0f : 0.0f, request->m_fade_color ? 1.0f : 0.0f );
+	smc_glUniform4f( m_uniform_clip, request->m_clip_rect.m_x, request->m_clip_rect.m_y, request->m_clip_rect.m_w, request->m_clip_rect.m_h );
+	smc_glUniform4f( m_uniform_tex, request->m_tex_x1, request->m_tex_y1, request->m_tex_x2, request->m_tex_y2 );
+}
+
+void cParticle_Shader :: Unuse( void ) const
+{
+	smc_glUseProgram( 0 );
+}
+
+bool cParticle_Shader :: Create_Program( void )
+{
+	m_vertex_shader = smc_glCreateShader( GL_VERTEX_SHADER );
+
+	if( !m_vertex_shader )
+	{
+		printf( "Warning : cParticle_Shader : shader creation failed\n" );
+		return 0;
+	}
+
+	smc_glShaderSource( m_vertex_shader, 1, &particle_vertex_shader, NULL );
+	smc_glCompileShader( m_vertex_shader );
+
+	GLint status = 0;
+	smc_glGetShaderiv( m_vertex_shader, GL_COMPILE_STATUS, &status );
+
+	if( !status )
+	{
+		char info_log[1024];
+		info_log[0] = '\0';
+		smc_glGetShaderInfoLog( m_vertex_shader, sizeof(info_log), NULL, info_log );
+
+		printf( "Warning : cParticle_Shader : compiling failed : %s\n", info_log );
+		return 0;
+	}
+
+	m_program = smc_glCreateProgram();
+
+	if( !m_program )
+	{
+		printf( "Warning : cParticle_Shader : program creation failed\n" );
+		return 0;
+	}
+
+	smc_glAttachShader( m_program, m_vertex_shader );
+
+	// must be set before linking
+	smc_glBindAttribLocation( m_program, ATTRIB_START, "start" );
+	smc_glBindAttribLocation( m_program, ATTRIB_MOVE, "move" );
+	smc_glBindAttribLocation( m_program, ATTRIB_ROT, "rot" );
+	smc_glBindAttribLocation( m_program, ATTRIB_CONST_ROT, "const_rot" );
+
+	smc_glLinkProgram( m_program );
+	smc_glGetProgramiv( m_program, GL_LINK_STATUS, &status );
+
+	if( !status )
+	{
+		char info_log[1024];
+		info_log[0] = '\0';
+		smc_glGetProgramInfoLog( m_program, sizeof(info_log), NULL, info_log );
+
+		printf( "Warning : cParticle_Shader : linking failed : %s\n", info_log );
+		return 0;
+	}
+
+	m_uniform_time = smc_glGetUniformLocation( m_program, "time" );
+	m_uniform_size = smc_glGetUniformLocation( m_program, "size" );
+	m_uniform_offset = smc_glGetUniformLocation( m_program, "offset" );
+	m_uniform_base_rot = smc_glGetUniformLocation( m_program, "base_rot" );
+	m_uniform_fade = smc_glGetUniformLocation( m_program, "fade" );
+	m_uniform_clip = smc_glGetUniformLocation( m_program, "clip" );
+	m_uniform_tex = smc_glGetUniformLocation( m_program, "tex" );
+
+	return 1;
+}
+
+void cParticle_Shader :: Delete_Buffers( void )
+{
+	boost::mutex::scoped_lock lock( m_deleted_mutex );
+
+	if( m_deleted_buffers.empty() )
+	{
+		return;
+	}
+
+	smc_glDeleteBuffers( m_deleted_buffers.size(), &m_deleted_buffers[0] );
+	m_deleted_buffers.clear();
+}
+
+/* *** *** *** *** *** *** *** cParticle_Seed_Buffer *** *** *** *** *** *** *** *** *** *** */
+
+cParticle_Seed_Buffer :: cParticle_Seed_Buffer( void )
+{
+	m_time = 0.0f;
+
+	m_buffer = 0;
+	m_buffer_size = 0;
+	m_buffer_context = 0;
+
+	m_end_time = 0.0f;
+	m_next = 0;
+
+	m_changed_first = 1;
+	m_changed_last = 0;
+	m_recreate = 1;
+	m_context = 0;
+}
+
+cParticle_Seed_Buffer :: ~cParticle_Seed_Buffer( void )
+{
+
+}
+
+void cParticle_Seed_Buffer :: Add( const cParticle_List &particles )
+{
+	for( unsigned int i = 0; i < particles.m_count; i++ )
+	{
+		// grow if the oldest particle is still visible
+		if( m_particle_end_time.empty() || m_particle_end_time[m_next] > m_time )
+		{
+			Resize( m_particle_end_time.empty() ? 16 : m_particle_end_time.size() * 2 );
+		}
+
+		const unsigned int num = m_next;
+
+		m_next++;
+
+		if( m_next >= m_particle_end_time.size() )
+		{
+			m_next = 0;
+		}
+
+		const float end_time = m_time + ( particles.m_fade_speed[i] > 0.0f ? 1.0f / particles.m_fade_speed[i] : particle_seed_unused_time );
+		m_particle_end_time[num] = end_time;
+
+		if( end_time > m_end_time )
+		{
+			m_end_time = end_time;
+		}
+
+		const Color &color = particles.m_color[i];
+
+		for( unsigned int c = 0; c < 4; c++ )
+		{
+			Seed_Vertex &vertex = m_vertices[num * 4 + c];
+
+			vertex.m_color[0] = color.red;
+			vertex.m_color[1] = color.green;
+			vertex.m_color[2] = color.blue;
+			vertex.m_color[3] = color.alpha;
+			vertex.m_start[0] = particles.m_pos_x[i];
+			vertex.m_start[1] = particles.m_pos_y[i];
+			vertex.m_start[2] = particles.m_pos_z[i];
+			vertex.m_start[3] = m_time;
+			vertex.m_move[0] = particles.m_vel_x[i];
+			vertex.m_move[1] = particles.m_vel_y[i];
+			vertex.m_move[2] = particles.m_gravity_x[i];
+			vertex.m_move[3] = particles.m_gravity_y[i];
+			vertex.m_rot[0] = particles.m_rot_x[i];
+			vertex.m_rot[1] = particles.m_rot_y[i];
+			vertex.m_rot[2] = particles.m_rot_z[i];
+			vertex.m_rot[3] = particles.m_fade_speed[i];
+			vertex.m_const_rot[0] = particles.m_const_rot_x[i];
+			vertex.m_const_rot[1] = particles.m_const_rot_y[i];
+			vertex.m_const_rot[2] = particles.m_const_rot_z[i];
+			vertex.m_const_rot[3] = particles.m_scale[i];
+		}
+
+		// update the changed range
+		if( m_changed_first > m_changed_last )
+		{
+			m_changed_first = num;
+			m_changed_last = num;
+		}
+		else if( num < m_changed_first )
+		{
+			m_changed_first = num;
+		}
+		else if( num > m_changed_last )
+		{
+			m_changed_last = num;
+		}
+	}
+}
+
+void cParticle_Seed_Buffer :: Update( float speed_factor )
+{
+	m_time += speed_factor;
+
+	if( m_time > particle_seed_time_rebase )
+	{
+		Rebase_Time();
+	}
+}
+
+void cParticle_Seed_Buffer :: Clear( void )
+{
+	for( unsigned int i = 0; i < m_particle_end_time.size(); i++ )
+	{
+		Set_Unused( i );
+	}
+
+	m_end_time = m_time;
+	m_next = 0;
+
+	if( !m_particle_end_time.empty() )
+	{
+		m_changed_first = 0;
+		m_changed_last = m_particle_end_time.size() - 1;
+	}
+}
+
+void cParticle_Seed_Buffer :: Fill_Request( cParticle_Seed_Request *request )
+{
+	request->m_buffer = this;
+	request->m_time = m_time;
+	request->m_size = m_particle_end_time.size();
+
+	// a new context needs a new storage
+	const unsigned int context = pVideo->m_particle_shader ? pVideo->m_particle_shader->Get_Context() : 0;
+
+	if( m_context != context )
+	{
+		m_context = context;
+		m_recreate = 1;
+	}
+
+	if( m_recreate )
+	{
+		request->m_recreate = 1;
+		request->m_upload_first = 0;
+		request->m_vertices = m_vertices;
+	}
+	else if( m_changed_first <= m_changed_last )
+	{
+		request->m_upload_first = m_changed_first;
+		request->m_vertices.assign( m_vertices.begin() + m_changed_first * 4, m_vertices.begin() + ( m_changed_last + 1 ) * 4 );
+	}
+
+	m_recreate = 0;
+	m_changed_first = 1;
+	m_changed_last = 0;
+}
+
+void cParticle_Seed_Buffer :: Draw( const cParticle_Seed_Request *request )
+{
+	cParticle_Shader *shader = pVideo->m_particle_shader;
+
+	if( !shader || !request->m_size )
+	{
+		return;
+	}
+
+	// the buffer of an old context is already gone
+	if( m_buffer && m_buffer_context != shader->Get_Context() )
+	{
+		m_buffer = 0;
+	}
+
+	if( !m_buffer )
+	{
+		smc_glGenBuffers( 1, &m_buffer );
+		m_buffer_context = shader->Get_Context();
+		m_buffer_size = 0;
+
+		if( !m_buffer )
+		{
+			return;
+		}
+	}
+
+	smc_glBindBuffer( GL_ARRAY_BUFFER, m_buffer );
+
+	// the particles of a lost storage can only be recovered with a full upload
+	if( request->m_recreate || m_buffer_size != request->m_size )
+	{
+		smc_glBufferData( GL_ARRAY_BUFFER, request->m_size * 4 * sizeof(Seed_Vertex), NULL, GL_DYNAMIC_DRAW );
+		m_buffer_size = request->m_size;
+	}
+
+	if( !request->m_vertices.empty() )
+	{
+		smc_glBufferSubData( GL_ARRAY_BUFFER, request->m_upload_first * 4 * sizeof(Seed_Vertex), request->m_vertices.size() * sizeof(Seed_Vertex), &request->m_vertices[0] );
+	}
+
+	shader->Use( request );
+
+	const GLsizei stride = sizeof(Seed_Vertex);
+
+	// with a bound buffer the pointers are offsets
+	pGL_State->Set_Client_State( GL_VERTEX_ARRAY, 1 );
+	glVertexPointer( 2, GL_FLOAT, stride, reinterpret_cast<const GLvoid *>(offsetof( Seed_Vertex, m_corner )) );
+	pGL_State->Set_Client_State( GL_COLOR_ARRAY, 1 );
+	glColorPointer( 4, GL_UNSIGNED_BYTE, stride, reinterpret_cast<const GLvoid *>(offsetof( Seed_Vertex, m_color )) );
+	// calculated in the shader
+	pGL_State->Set_Client_State( GL_TEXTURE_COORD_ARRAY, 0 );
+
+	smc_glEnableVertexAttribArray( cParticle_Shader::ATTRIB_START );
+	smc_glVertexAttribPointer( cParticle_Shader::ATTRIB_START, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const GLvoid *>(offsetof( Seed_Vertex, m_start )) );
+	smc_glEnableVertexAttribArray( cParticle_Shader::ATTRIB_MOVE );
+	smc_glVertexAttribPointer( cParticle_Shader::ATTRIB_MOVE, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const GLvoid *>(offsetof( Seed_Vertex, m_move )) );
+	smc_glEnableVertexAttribArray( cParticle_Shader::ATTRIB_ROT );
+	smc_glVertexAttribPointer( cParticle_Shader::ATTRIB_ROT, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const GLvoid *>(offsetof( Seed_Vertex, m_rot )) );
+	smc_glEnableVertexAttribArray( cParticle_Shader::ATTRIB_CONST_ROT );
+	smc_glVertexAttribPointer( cParticle_Shader::ATTRIB_CONST_ROT, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const GLvoid *>(offsetof( Seed_Vertex, m_const_rot )) );
+
+	glDrawArrays( GL_QUADS, 0, request->m_size * 4 );
+	pRender_Stats->Add_Draw_Call( request->m_size * 4 );
+
+	smc_glDisableVertexAttribArray( cParticle_Shader::ATTRIB_START );
+	smc_glDisableVertexAttribArray( cParticle_Shader::ATTRIB_MOVE );
+	smc_glDisableVertexAttribArray( cParticle_Shader::ATTRIB_ROT );
+	smc_glDisableVertexAttribArray( cParticle_Shader::ATTRIB_CONST_ROT );
+
+	// other requests use client memory
+	smc_glBindBuffer( GL_ARRAY_BUFFER, 0 );
+	shader->Unuse();
+}
+
+void cParticle_Seed_Buffer :: Resize( unsigned int size )
+{
+	const unsigned int old_size = m_particle_end_time.size();
+
+	Seed_Vertex_List vertices( size * 4 );
+	vector<float> particle_end_time( size );
+
+	// keep the order from the oldest particle
+	for( unsigned int i = 0; i < old_size; i++ )
+	{
+		const unsigned int num = ( m_next + i ) % old_size;
+
+		std::copy( m_vertices.begin() + num * 4, m_vertices.begin() + ( num + 1 ) * 4, vertices.begin() + i * 4 );
+		particle_end_time[i] = m_particle_end_time[num];
+	}
+
+	m_vertices.swap( vertices );
+	m_particle_end_time.swap( particle_end_time );
+
+	for( unsigned int i = old_size; i < size; i++ )
+	{
+		Set_Unused( i );
+	}
+
+	m_next = old_size;
+	m_recreate = 1;
+}
+
+void cParticle_Seed_Buffer :: Set_Unused( unsigned int num )
+{
+	// the corners are kept if the particle is replaced
+	static const GLfloat corners[8] = { -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f };
+
+	for( unsigned int c = 0; c < 4; c++ )
+	{
+		Seed_Vertex &vertex = m_vertices[num * 4 + c];
+
+		memset( &vertex, 0, sizeof(Seed_Vertex) );
+		vertex.m_corner[0] = corners[c * 2];
+		vertex.m_corner[1] = corners[c * 2 + 1];
+		vertex.m_start[3] = particle_seed_unused_time;
+	}
+
+	m_particle_end_time[num] = m_time;
+}
+
+void cParticle_Seed_Buffer :: Rebase_Time( void )
+{
+	for( Seed_Vertex_List::iterator itr = m_vertices.begin(); itr != m_vertices.end(); ++itr )
+	{
+		(*itr).m_start[3] -= m_time;
+	}
+
+	for( vector<float>::iterator itr = m_particle_end_time.begin(); itr != m_particle_end_time.end(); ++itr )
+	{
+		(*itr) -= m_time;
+	}
+
+	m_end_time -= m_time;
+	m_time = 0.0f;
+	m_recreate = 1;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
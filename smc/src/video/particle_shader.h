@@ -0,0 +1,206 @@
+/***************************************************************************
+ * particle_shader.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_PARTICLE_SHADER_H
+#define SMC_PARTICLE_SHADER_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL.h"
+#include "SDL_opengl.h"
+// Boost
+#include <boost/thread/mutex.hpp>
+
+namespace SMC
+{
+
+class cParticle_List;
+class cParticle_Seed_Buffer;
+class cParticle_Seed_Request;
+
+/* *** *** *** *** *** *** *** cParticle_Shader *** *** *** *** *** *** *** *** *** *** */
+
+/* Vertex shader which moves, rotates, scales and fades particles from their emission values
+ * the fragment processing stays fixed function to keep the texture combine modes
+ * needs opengl 2.0
+*/
+class cParticle_Shader
+{
+public:
+	cParticle_Shader( void );
+	~cParticle_Shader( void );
+
+	/* Check the version, load the functions and compile the shader
+	 * must be called again for a new opengl context
+	 * returns false if shaders are not supported
+	*/
+	bool Init( void );
+	// Delete the shader program, the retired seed buffers and their opengl buffers
+	void Exit( void );
+
+	// Returns the number of the opengl context the shader was created for
+	inline unsigned int Get_Context( void ) const
+	{
+		return m_context;
+	}
+
+	/* Delete the seed buffer after the render thread finished using it
+	 * its opengl buffer is deleted with the next use of the shader
+	*/
+	void Retire( cParticle_Seed_Buffer *buffer );
+	/* Delete the seed buffers retired before the last rendering
+	 * must be called after the render thread finished the last frame
+	*/
+	void Update_Retired( void );
+
+	// Use the program with the values of the request
+	void Use( const cParticle_Seed_Request *request );
+	// Use the fixed function pipeline again
+	void Unuse( void ) const;
+
+	// generic vertex attribute locations
+	enum Attribute
+	{
+		ATTRIB_START = 1,
+		ATTRIB_MOVE = 2,
+		ATTRIB_ROT = 3,
+		ATTRIB_CONST_ROT = 4
+	};
+
+private:
+	// Compile the shader and link the program
+	bool Create_Program( void );
+	// Delete the opengl buffers of deleted seed buffers
+	void Delete_Buffers( void );
+
+	GLuint m_program;
+	GLuint m_vertex_shader;
+	// changes with every Init
+	unsigned int m_context;
+
+	// uniform locations
+	GLint m_uniform_time;
+	GLint m_uniform_size;
+	GLint m_uniform_offset;
+	GLint m_uniform_base_rot;
+	GLint m_uniform_fade;
+	GLint m_uniform_clip;
+	GLint m_uniform_tex;
+
+	typedef vector<cParticle_Seed_Buffer *> Seed_Buffer_List;
+	/* retired seed buffers which could still be used by the render thread
+	 * they get deleted after two more renderings
+	*/
+	Seed_Buffer_List m_retired;
+	Seed_Buffer_List m_retired_old;
+
+	// opengl buffers to delete in the render thread
+	vector<GLuint> m_deleted_buffers;
+	boost::mutex m_deleted_mutex;
+};
+
+/* *** *** *** *** *** *** *** cParticle_Seed_Buffer *** *** *** *** *** *** *** *** *** *** */
+
+/* Emission values of the particles of an emitter which are simulated by the particle shader
+ * a particle uses 4 vertices with the same values and its corner
+ * the particles are kept in a ring in which a new particle replaces the oldest one
+ * and the ring grows if the oldest particle is not finished yet
+ * only the particles added since the last request are uploaded
+*/
+class cParticle_Seed_Buffer
+{
+public:
+	cParticle_Seed_Buffer( void );
+	~cParticle_Seed_Buffer( void );
+
+	// vertex of a particle corner
+	struct Seed_Vertex
+	{
+		// corner from -1 to 1
+		GLfloat m_corner[2];
+		// color before fading
+		GLubyte m_color[4];
+		// position and emission time
+		GLfloat m_start[4];
+		// velocity and gravity
+		GLfloat m_move[4];
+		// start rotation and fading speed
+		GLfloat m_rot[4];
+		// constant rotation and scale
+		GLfloat m_const_rot[4];
+	};
+
+	typedef vector<Seed_Vertex> Seed_Vertex_List;
+
+	// Add the particles emitted at the current time
+	void Add( const cParticle_List &particles );
+	// Advance the simulation time
+	void Update( float speed_factor );
+	// Remove all particles
+	void Clear( void );
+	// Returns true if all particles are finished
+	inline bool Is_Finished( void ) const
+	{
+		return m_time >= m_end_time;
+	}
+
+	/* Set the time and move the changed particles into the request
+	 * the request must be drawn before the buffer is deleted
+	*/
+	void Fill_Request( cParticle_Seed_Request *request );
+	// Upload the request particles and draw all particles
+	void Draw( const cParticle_Seed_Request *request );
+
+	// simulation time in speed factor units
+	float m_time;
+
+	// only used by the renderer
+	GLuint m_buffer;
+	// particles in the buffer storage
+	unsigned int m_buffer_size;
+	// opengl context of the buffer storage
+	unsigned int m_buffer_context;
+
+private:
+	// Resize the ring and keep the particles
+	void Resize( unsigned int size );
+	// Hide the particle in the ring
+	void Set_Unused( unsigned int num );
+	// Subtract the simulation time from all times
+	void Rebase_Time( void );
+
+	// corner vertices of all particles in the ring
+	Seed_Vertex_List m_vertices;
+	// time every particle finishes
+	vector<float> m_particle_end_time;
+	// time the last particle finishes
+	float m_end_time;
+	// next particle to replace
+	unsigned int m_next;
+
+	// changed particle range or first is over last if nothing changed
+	unsigned int m_changed_first;
+	unsigned int m_changed_last;
+	// if set all particles are uploaded into a new storage
+	bool m_recreate;
+	// opengl context of the last request from the shader
+	unsigned int m_context;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
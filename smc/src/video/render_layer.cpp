@@ -0,0 +1,230 @@
+/***************************************************************************
+ * render_layer.cpp  -  cached drawing of rarely changing requests
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/render_layer.h"
+#include "../video/gl_state.h"
+#include "../user/preferences.h"
+#include <algorithm>
+
+namespace SMC
+{
+
+// sorts the requests by z position and keeps the adding order
+struct render_layer_z_sort
+{
+	bool operator()( const cRender_Request *a, const cRender_Request *b ) const
+	{
+		return a->m_pos_z < b->m_pos_z;
+	}
+};
+
+/* *** *** *** *** *** *** *** cRender_Layer *** *** *** *** *** *** *** *** *** *** */
+
+cRender_Layer :: cRender_Layer( void )
+{
+	m_queue = new cRenderQueue( 50 );
+	// the requests are taken from the render data
+	m_queue->m_command_stream = 0;
+	m_renderer = NULL;
+	m_update = 0;
+	m_update_num = 0;
+	m_pos_z = 0.0f;
+	m_width = 0;
+	m_height = 0;
+
+	m_drawn_update_num = 0;
+	// drawn with the first update
+	m_lost = 1;
+	m_failed = 0;
+}
+
+cRender_Layer :: ~cRender_Layer( void )
+{
+	for( RenderList::iterator itr = m_update_requests.begin(); itr != m_update_requests.end(); ++itr )
+	{
+		delete (*itr);
+	}
+
+	// only collected requests
+	delete m_queue;
+}
+
+void cRender_Layer :: Begin_Update( void )
+{
+	// replaced by the new update
+	for( RenderList::iterator itr = m_update_requests.begin(); itr != m_update_requests.end(); ++itr )
+	{
+		delete (*itr);
+	}
+
+	m_update_requests.clear();
+
+	// the requests are created for and added to the active renderer
+	m_renderer = pRenderer;
+	pRenderer = m_queue;
+}
+
+void cRender_Layer :: End_Update( void )
+{
+	pRenderer = m_renderer;
+	m_renderer = NULL;
+
+	m_update_requests.swap( m_queue->m_render_data );
+	std::stable_sort( m_update_requests.begin(), m_update_requests.end(), render_layer_z_sort() );
+
+	m_update = 1;
+	m_update_num++;
+	m_width = pPreferences->m_video_screen_w;
+	m_height = pPreferences->m_video_screen_h;
+
+	if( !m_update_requests.empty() )
+	{
+		m_pos_z = m_update_requests.front()->m_pos_z;
+	}
+
+	boost::mutex::scoped_lock lock( m_mutex );
+	m_lost = 0;
+}
+
+void cRender_Layer :: Add_Request( void )
+{
+	cRender_Layer_Request *request = new cRender_Layer_Request();
+	request->m_layer = this;
+	request->m_pos_z = m_pos_z;
+	request->m_width = m_width;
+	request->m_height = m_height;
+	request->m_update_num = m_update_num;
+
+	if( m_update )
+	{
+		request->m_requests.swap( m_update_requests );
+		request->m_update = 1;
+		m_update = 0;
+	}
+
+	pRenderer->Add( request );
+}
+
+bool cRender_Layer :: Needs_Update( void )
+{
+	if( m_width != pPreferences->m_video_screen_w || m_height != pPreferences->m_video_screen_h )
+	{
+		return 1;
+	}
+
+	boost::mutex::scoped_lock lock( m_mutex );
+	return m_lost;
+}
+
+bool cRender_Layer :: Is_Available( void )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+	return !m_failed;
+}
+
+void cRender_Layer :: Draw( cRender_Layer_Request *request )
+{
+	const unsigned int width = request->m_width;
+	const unsigned int height = request->m_height;
+
+	if( request->m_update )
+	{
+		// create for the screen size
+		if( !m_target.m_framebuffer || m_target.m_width != width || m_target.m_height != height )
+		{
+			m_target.Init( width, height );
+		}
+
+		if( !m_target.Bind() || !pGL_State->Set_Premultiplied_Alpha( 1 ) )
+		{
+			m_target.Unbind();
+			printf( "Warning : cRender_Layer : not available\n" );
+
+			boost::mutex::scoped_lock lock( m_mutex );
+			m_failed = 1;
+			return;
+		}
+
+		glClearColor( 0.0f, 0.0f, 0.0f, 0.0f );
+		glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+		glClearColor( 0.0f, 0.0f, 0.0f, 1.0f );
+
+		for( RenderList::iterator itr = request->m_requests.begin(); itr != request->m_requests.end(); ++itr )
+		{
+			cRender_Request *obj = (*itr);
+
+			pRender_Stats->Add_Request( obj->m_type );
+			obj->Draw();
+		}
+
+		pGL_State->Set_Premultiplied_Alpha( 0 );
+		m_target.Unbind();
+
+		boost::mutex::scoped_lock lock( m_mutex );
+		m_drawn_update_num = request->m_update_num;
+	}
+	else
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+
+		/* the update was not rendered or
+		 * the texture was deleted with all hardware textures or has the wrong size
+		*/
+		if( m_drawn_update_num != request->m_update_num || !m_target.m_framebuffer || !glIsTexture( m_target.m_texture ) || m_target.m_width != width || m_target.m_height != height )
+		{
+			m_lost = 1;
+			return;
+		}
+	}
+
+	m_target.Draw( 1 );
+}
+
+/* *** *** *** *** *** *** *** cRender_Layer_Request *** *** *** *** *** *** *** *** *** *** */
+
+cRender_Layer_Request :: cRender_Layer_Request( void )
+: cRender_Request()
+{
+	m_type = REND_LAYER;
+	m_layer = NULL;
+	m_update = 0;
+	m_update_num = 0;
+	m_width = 0;
+	m_height = 0;
+}
+
+cRender_Layer_Request :: ~cRender_Layer_Request( void )
+{
+	for( RenderList::iterator itr = m_requests.begin(); itr != m_requests.end(); ++itr )
+	{
+		delete (*itr);
+	}
+}
+
+void cRender_Layer_Request :: Draw( void )
+{
+	if( !m_layer )
+	{
+		return;
+	}
+
+	m_layer->Draw( this );
+	// a second rendering only draws the texture
+	m_update = 0;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,127 @@
+/***************************************************************************
+ * render_layer.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_RENDER_LAYER_H
+#define SMC_RENDER_LAYER_H
+
+#include "../core/global_basic.h"
+#include "../video/renderer.h"
+#include "../video/render_target.h"
+// boost thread
+#include <boost/thread/mutex.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cRender_Layer *** *** *** *** *** *** *** *** *** *** */
+
+/* Requests drawn into an offscreen texture which is drawn over the screen with one quad
+ * the requests are only drawn again if the layer is updated
+ * the texture has premultiplied alpha to keep the blending of the requests
+ * needs the GL_EXT_framebuffer_object extension and glBlendFuncSeparate
+*/
+class cRender_Layer_Request;
+
+class cRender_Layer
+{
+public:
+	cRender_Layer( void );
+	// the opengl context must not be used by the render thread
+	~cRender_Layer( void );
+
+	/* Start collecting the requests of an update
+	 * the requests added to pRenderer until End_Update are drawn into the layer
+	*/
+	void Begin_Update( void );
+	// Stop collecting the requests
+	void End_Update( void );
+
+	/* Add the request which draws the layer
+	 * the requests of an update are drawn into the layer first
+	*/
+	void Add_Request( void );
+
+	// Returns true if the layer must be updated before it can be drawn
+	bool Needs_Update( void );
+	/* Returns false if the layer could not be created
+	 * the requests must then be drawn normally
+	*/
+	bool Is_Available( void );
+
+	/* Draw the requests into the texture if updated and draw the texture
+	 * called by the request in the render thread
+	*/
+	void Draw( cRender_Layer_Request *request );
+
+private:
+	// collects the requests of an update
+	cRenderQueue *m_queue;
+	// renderer while collecting
+	cRenderQueue *m_renderer;
+	// sorted requests of the last update until the request is added
+	RenderList m_update_requests;
+	// if an update is waiting for its request
+	bool m_update;
+	// number of the last update
+	unsigned int m_update_num;
+	// z position of the lowest request of the last update
+	float m_pos_z;
+	// screen size of the last update
+	unsigned int m_width;
+	unsigned int m_height;
+
+	// offscreen texture used by the render thread
+	cRender_Target m_target;
+
+	// protects the state set by the render thread
+	boost::mutex m_mutex;
+	// number of the update in the texture
+	unsigned int m_drawn_update_num;
+	// if set the texture contents are not valid
+	bool m_lost;
+	// if set the layer can not be used
+	bool m_failed;
+};
+
+/* *** *** *** *** *** *** *** cRender_Layer_Request *** *** *** *** *** *** *** *** *** *** */
+
+class cRender_Layer_Request : public cRender_Request
+{
+public:
+	cRender_Layer_Request( void );
+	// deletes the update requests
+	virtual ~cRender_Layer_Request( void );
+
+	// Draw
+	virtual void Draw( void );
+
+	// layer to draw
+	cRender_Layer *m_layer;
+	// requests drawn into the layer if updated
+	RenderList m_requests;
+	// if set the layer is updated
+	bool m_update;
+	// number of the layer update to draw
+	unsigned int m_update_num;
+	// screen size of the layer
+	unsigned int m_width;
+	unsigned int m_height;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -0,0 +1,332 @@
+/***************************************************************************
+ * render_target.cpp  -  Offscreen framebuffer
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/render_target.h"
+#include "../video/gl_state.h"
+#include "../video/renderer.h"
+#include "../video/video.h"
+#include "../core/math/utilities.h"
+#include <cstring>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** Extension *** *** *** *** *** *** *** *** *** *** */
+
+#ifndef APIENTRY
+	#define APIENTRY
+#endif
+#ifndef GL_FRAMEBUFFER_EXT
+	#define GL_FRAMEBUFFER_EXT 0x8D40
+	#define GL_RENDERBUFFER_EXT 0x8D41
+	#define GL_COLOR_ATTACHMENT0_EXT 0x8CE0
+	#define GL_DEPTH_ATTACHMENT_EXT 0x8D00
+	#define GL_FRAMEBUFFER_COMPLETE_EXT 0x8CD5
+	#define GL_FRAMEBUFFER_BINDING_EXT 0x8CA6
+#endif
+#ifndef GL_DEPTH_COMPONENT24
+	#define GL_DEPTH_COMPONENT24 0x81A6
+#endif
+
+typedef void (APIENTRY *Gen_Objects_Func)( GLsizei n, GLuint *ids );
+typedef void (APIENTRY *Delete_Objects_Func)( GLsizei n, const GLuint *ids );
+typedef void (APIENTRY *Bind_Object_Func)( GLenum target, GLuint id );
+typedef void (APIENTRY *Renderbuffer_Storage_Func)( GLenum target, GLenum internalformat, GLsizei width, GLsizei height );
+typedef void (APIENTRY *Framebuffer_Texture_2D_Func)( GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level );
+typedef void (APIENTRY *Framebuffer_Renderbuffer_Func)( GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer );
+typedef GLenum (APIENTRY *Check_Framebuffer_Status_Func)( GLenum target );
+
+static Gen_Objects_Func smc_glGenFramebuffers = NULL;
+static Delete_Objects_Func smc_glDeleteFramebuffers = NULL;
+static Bind_Object_Func smc_glBindFramebuffer = NULL;
+static Gen_Objects_Func smc_glGenRenderbuffers = NULL;
+static Delete_Objects_Func smc_glDeleteRenderbuffers = NULL;
+static Bind_Object_Func smc_glBindRenderbuffer = NULL;
+static Renderbuffer_Storage_Func smc_glRenderbufferStorage = NULL;
+static Framebuffer_Texture_2D_Func smc_glFramebufferTexture2D = NULL;
+static Framebuffer_Renderbuffer_Func smc_glFramebufferRenderbuffer = NULL;
+static Check_Framebuffer_Status_Func smc_glCheckFramebufferStatus = NULL;
+
+/* *** *** *** *** *** *** *** cRender_Target *** *** *** *** *** *** *** *** *** *** */
+
+cRender_Target :: cRender_Target( void )
+{
+	m_width = 0;
+	m_height = 0;
+	m_tex_width = 0;
+	m_tex_height = 0;
+	m_used_width = 0;
+	m_used_height = 0;
+
+	m_framebuffer = 0;
+	m_texture = 0;
+	m_depth_buffer = 0;
+
+	m_previous_framebuffer = 0;
+	memset( m_previous_viewport, 0, sizeof( m_previous_viewport ) );
+}
+
+cRender_Target :: ~cRender_Target( void )
+{
+	Clear();
+}
+
+bool cRender_Target :: Init( unsigned int width, unsigned int height )
+{
+	Clear();
+
+	// the function addresses can be different for every context
+	if( !Load_Extension() )
+	{
+		return 0;
+	}
+
+	m_width = width;
+	m_height = height;
+	m_tex_width = Get_Power_of_2( width );
+	m_tex_height = Get_Power_of_2( height );
+	m_used_width = width;
+	m_used_height = height;
+
+	if( m_tex_width > static_cast<unsigned int>(pVideo->m_max_texture_size) || m_tex_height > static_cast<unsigned int>(pVideo->m_max_texture_size) )
+	{
+		printf( "Warning : cRender_Target : size %dx%d is bigger than the maximum texture size\n", m_tex_width, m_tex_height );
+		return 0;
+	}
+
+	// color texture
+	glGenTextures( 1, &m_texture );
+	glBindTexture( GL_TEXTURE_2D, m_texture );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, m_tex_width, m_tex_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+	// opengl was used directly
+	pGL_State->Invalidate();
+
+	// depth buffer
+	smc_glGenRenderbuffers( 1, &m_depth_buffer );
+	smc_glBindRenderbuffer( GL_RENDERBUFFER_EXT, m_depth_buffer );
+	smc_glRenderbufferStorage( GL_RENDERBUFFER_EXT, GL_DEPTH_COMPONENT24, m_tex_width, m_tex_height );
+	smc_glBindRenderbuffer( GL_RENDERBUFFER_EXT, 0 );
+
+	// framebuffer
+	smc_glGenFramebuffers( 1, &m_framebuffer );
+	smc_glBindFramebuffer( GL_FRAMEBUFFER_EXT, m_framebuffer );
+	smc_glFramebufferTexture2D( GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, GL_TEXTURE_2D, m_texture, 0 );
+	smc_glFramebufferRenderbuffer( GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT, GL_RENDERBUFFER_EXT, m_depth_buffer );
+
+	const GLenum status = smc_glCheckFramebufferStatus( GL_FRAMEBUFFER_EXT );
+	smc_glBindFramebuffer( GL_FRAMEBUFFER_EXT, 0 );
+
+	if( status != GL_FRAMEBUFFER_COMPLETE_EXT )
+	{
+		printf( "Warning : cRender_Target : framebuffer is not complete (status 0x%x)\n", status );
+		Clear();
+		return 0;
+	}
+
+	debug_print( "Info : cRender_Target : created framebuffer with size %dx%d\n", m_tex_width, m_tex_height );
+	return 1;
+}
+
+void cRender_Target :: Clear( void )
+{
+	if( m_framebuffer && smc_glDeleteFramebuffers )
+	{
+		smc_glDeleteFramebuffers( 1, &m_framebuffer );
+	}
+	if( m_depth_buffer && smc_glDeleteRenderbuffers )
+	{
+		smc_glDeleteRenderbuffers( 1, &m_depth_buffer );
+	}
+	// could be deleted with all hardware textures
+	if( m_texture && glIsTexture( m_texture ) )
+	{
+		glDeleteTextures( 1, &m_texture );
+	}
+
+	m_framebuffer = 0;
+	m_depth_buffer = 0;
+	m_texture = 0;
+}
+
+void cRender_Target :: Begin( float scale )
+{
+	// recreate if the texture was deleted with all hardware textures
+	if( m_texture && !glIsTexture( m_texture ) )
+	{
+		Init( m_width, m_height );
+	}
+
+	if( !m_framebuffer )
+	{
+		return;
+	}
+
+	if( scale > 1.0f )
+	{
+		scale = 1.0f;
+	}
+	else if( scale < 0.1f )
+	{
+		scale = 0.1f;
+	}
+
+	m_used_width = static_cast<unsigned int>(ceil( m_width * scale ));
+	m_used_height = static_cast<unsigned int>(ceil( m_height * scale ));
+
+	smc_glBindFramebuffer( GL_FRAMEBUFFER_EXT, m_framebuffer );
+	// the projection stays the same so the drawing is scaled into the smaller area
+	glViewport( 0, 0, m_used_width, m_used_height );
+}
+
+void cRender_Target :: End( void )
+{
+	if( !m_framebuffer )
+	{
+		return;
+	}
+
+	smc_glBindFramebuffer( GL_FRAMEBUFFER_EXT, 0 );
+	glViewport( 0, 0, m_width, m_height );
+
+	// covers the whole screen
+	glClear( GL_DEPTH_BUFFER_BIT );
+	Draw();
+}
+
+bool cRender_Target :: Bind( void )
+{
+	// recreate if the texture was deleted with all hardware textures
+	if( m_texture && !glIsTexture( m_texture ) )
+	{
+		Init( m_width, m_height );
+	}
+
+	if( !m_framebuffer )
+	{
+		return 0;
+	}
+
+	// could be drawn while the game is drawn into another target
+	glGetIntegerv( GL_FRAMEBUFFER_BINDING_EXT, &m_previous_framebuffer );
+	glGetIntegerv( GL_VIEWPORT, m_previous_viewport );
+
+	m_used_width = m_width;
+	m_used_height = m_height;
+
+	smc_glBindFramebuffer( GL_FRAMEBUFFER_EXT, m_framebuffer );
+	glViewport( 0, 0, m_width, m_height );
+
+	return 1;
+}
+
+void cRender_Target :: Unbind( void )
+{
+	if( !m_framebuffer )
+	{
+		return;
+	}
+
+	smc_glBindFramebuffer( GL_FRAMEBUFFER_EXT, m_previous_framebuffer );
+	glViewport( m_previous_viewport[0], m_previous_viewport[1], m_previous_viewport[2], m_previous_viewport[3] );
+}
+
+void cRender_Target :: Draw( bool premultiplied /* = 0 */ ) const
+{
+	glDisable( GL_DEPTH_TEST );
+	glDisable( GL_ALPHA_TEST );
+
+	pGL_State->Set_Texture_2D( 1 );
+	pGL_State->Bind_Texture( m_texture );
+	pGL_State->Set_Color( white );
+
+	if( premultiplied )
+	{
+		pGL_State->Set_Blend_Func( GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+	}
+	else
+	{
+		pGL_State->Set_Blend_Func( GL_ONE, GL_ZERO );
+	}
+
+	const float tex_x = static_cast<float>(m_used_width) / static_cast<float>(m_tex_width);
+	const float tex_y = static_cast<float>(m_used_height) / static_cast<float>(m_tex_height);
+	const float width = static_cast<float>(m_width);
+	const float height = static_cast<float>(m_height);
+
+	glPushMatrix();
+	glLoadIdentity();
+
+	// the texture starts at the bottom
+	glBegin( GL_QUADS );
+		// top left
+		glTexCoord2f( 0.0f, tex_y );
+		glVertex2f( 0.0f, 0.0f );
+		// top right
+		glTexCoord2f( tex_x, tex_y );
+		glVertex2f( width, 0.0f );
+		// bottom right
+		glTexCoord2f( tex_x, 0.0f );
+		glVertex2f( width, height );
+		// bottom left
+		glTexCoord2f( 0.0f, 0.0f );
+		glVertex2f( 0.0f, height );
+	glEnd();
+	pRender_Stats->Add_Draw_Call( 4 );
+
+	glPopMatrix();
+
+	pGL_State->Set_Blend_Func( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+	glEnable( GL_ALPHA_TEST );
+	glEnable( GL_DEPTH_TEST );
+}
+
+bool cRender_Target :: Load_Extension( void )
+{
+	const char *extensions = reinterpret_cast<const char *>(glGetString( GL_EXTENSIONS ));
+
+	if( !extensions || !strstr( extensions, "GL_EXT_framebuffer_object" ) )
+	{
+		printf( "Warning : cRender_Target : GL_EXT_framebuffer_object is not supported\n" );
+		return 0;
+	}
+
+	smc_glGenFramebuffers = reinterpret_cast<Gen_Objects_Func>(SDL_GL_GetProcAddress( "glGenFramebuffersEXT" ));
+	smc_glDeleteFramebuffers = reinterpret_cast<Delete_Objects_Func>(SDL_GL_GetProcAddress( "glDeleteFramebuffersEXT" ));
+	smc_glBindFramebuffer = reinterpret_cast<Bind_Object_Func>(SDL_GL_GetProcAddress( "glBindFramebufferEXT" ));
+	smc_glGenRenderbuffers = reinterpret_cast<Gen_Objects_Func>(SDL_GL_GetProcAddress( "glGenRenderbuffersEXT" ));
+	smc_glDeleteRenderbuffers = reinterpret_cast<Delete_Objects_Func>(SDL_GL_GetProcAddress( "glDeleteRenderbuffersEXT" ));
+	smc_glBindRenderbuffer = reinterpret_cast<Bind_Object_Func>(SDL_GL_GetProcAddress( "glBindRenderbufferEXT" ));
+	smc_glRenderbufferStorage = reinterpret_cast<Renderbuffer_Storage_Func>(SDL_GL_GetProcAddress( "glRenderbufferStorageEXT" ));
+	smc_glFramebufferTexture2D = reinterpret_cast<Framebuffer_Texture_2D_Func>(SDL_GL_GetProcAddress( "glFramebufferTexture2DEXT" ));
+	smc_glFramebufferRenderbuffer = reinterpret_cast<Framebuffer_Renderbuffer_Func>(SDL_GL_GetProcAddress( "glFramebufferRenderbufferEXT" ));
+	smc_glCheckFramebufferStatus = reinterpret_cast<Check_Framebuffer_Status_Func>(SDL_GL_GetProcAddress( "glCheckFramebufferStatusEXT" ));
+
+	if( !smc_glGenFramebuffers || !smc_glDeleteFramebuffers || !smc_glBindFramebuffer || !smc_glGenRenderbuffers || !smc_glDeleteRenderbuffers ||
+		!smc_glBindRenderbuffer || !smc_glRenderbufferStorage || !smc_glFramebufferTexture2D || !smc_glFramebufferRenderbuffer || !smc_glCheckFramebufferStatus )
+	{
+		printf( "Warning : cRender_Target : GL_EXT_framebuffer_object functions not found\n" );
+		return 0;
+	}
+
+	return 1;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,94 @@
+/***************************************************************************
+ * render_target.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_RENDER_TARGET_H
+#define SMC_RENDER_TARGET_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cRender_Target *** *** *** *** *** *** *** *** *** *** */
+
+/* Offscreen framebuffer for drawing at a lower resolution
+ * the projection is not changed so the drawing is done in screen coordinates
+ * and only the used framebuffer area gets smaller with the scale
+ * needs the GL_EXT_framebuffer_object extension
+*/
+class cRender_Target
+{
+public:
+	cRender_Target( void );
+	~cRender_Target( void );
+
+	/* Create the framebuffer for the given screen size
+	 * returns false if not supported or failed
+	*/
+	bool Init( unsigned int width, unsigned int height );
+	// Delete the framebuffer
+	void Clear( void );
+
+	/* Draw into the framebuffer until End is called
+	 * scale : used resolution of the screen size from 0.1 to 1.0
+	*/
+	void Begin( float scale );
+	// Draw to the screen again and draw the used framebuffer area scaled up
+	void End( void );
+
+	/* Draw into the whole framebuffer until Unbind is called
+	 * returns false if the framebuffer is not available
+	*/
+	bool Bind( void );
+	// Draw into the framebuffer and viewport used before Bind again
+	void Unbind( void );
+	/* Draw the used framebuffer area over the whole screen
+	 * premultiplied : if set the framebuffer has premultiplied alpha and is blended over the screen
+	 * otherwise it replaces the screen
+	*/
+	void Draw( bool premultiplied = 0 ) const;
+
+	// screen size
+	unsigned int m_width;
+	unsigned int m_height;
+	// texture size
+	unsigned int m_tex_width;
+	unsigned int m_tex_height;
+	// framebuffer area size of the current drawing
+	unsigned int m_used_width;
+	unsigned int m_used_height;
+
+	// opengl objects
+	GLuint m_framebuffer;
+	GLuint m_texture;
+	GLuint m_depth_buffer;
+
+	// framebuffer and viewport before Bind
+	GLint m_previous_framebuffer;
+	GLint m_previous_viewport[4];
+
+private:
+	// Load the extension functions and return true if available
+	static bool Load_Extension( void );
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
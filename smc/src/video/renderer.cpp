@@ -14,7 +14,13 @@
 */
 
 #include "../video/renderer.h"
+#include "../video/gl_state.h"
+#include "../video/gpu_timer.h"
+#include "../video/sprite_shader.h"
 #include "../core/game_core.h"
+#include "../core/memory_pool.h"
+#include "../core/math/utilities.h"
+#include "../user/preferences.h"
 #include <algorithm>
 // SDL
 #include "SDL.h"
@@ -28,7 +34,95 @@ namespace SMC
 #endif
 
 const float doubled_pi = static_cast<float>(M_PI * 2.0f);
-static GLuint last_bind_texture = 0;
+// camera position of the rendered queue
+static float render_camera_x = 0.0f;
+static float render_camera_y = 0.0f;
+// requests searched backwards for the same state when grouping
+static const unsigned int render_group_window = 64;
+
+// returns the float as unsigned integer with the same order
+static inline Uint32 Float_To_Sort_Key( float value )
+{
+	union
+	{
+		float f;
+		Uint32 u;
+	} data;
+
+	data.f = value;
+
+	// negative values are reversed
+	if( data.u & 0x80000000 )
+	{
+		return ~data.u;
+	}
+
+	return data.u | 0x80000000;
+}
+
+// returns true if the rects share an area (touching edges are not overlapping)
+static inline bool Is_Rect_Overlapping( const GL_rect &a, const GL_rect &b )
+{
+	return ( a.m_x < b.m_x + b.m_w && b.m_x < a.m_x + a.m_w && a.m_y < b.m_y + b.m_h && b.m_y < a.m_y + a.m_h );
+}
+
+// makes the size positive for flipped rects
+static inline void Make_Rect_Positive( GL_rect &rect )
+{
+	if( rect.m_w < 0.0f )
+	{
+		rect.m_x += rect.m_w;
+		rect.m_w = -rect.m_w;
+	}
+	if( rect.m_h < 0.0f )
+	{
+		rect.m_y += rect.m_h;
+		rect.m_h = -rect.m_h;
+	}
+}
+
+// returns true if the final rect in screen pixels is visible
+static inline bool Is_Rect_On_Screen( GL_rect rect )
+{
+	Make_Rect_Positive( rect );
+
+	return Is_Rect_Overlapping( rect, GL_rect( 0.0f, 0.0f, static_cast<float>(pPreferences->m_video_screen_w), static_cast<float>(pPreferences->m_video_screen_h) ) );
+}
+
+// returns the command corners as rect with a positive size
+static inline GL_rect Get_Command_Rect( const Render_Command &command )
+{
+	const float x = command.m_x1 < command.m_x2 ? command.m_x1 : command.m_x2;
+	const float y = command.m_y1 < command.m_y2 ? command.m_y1 : command.m_y2;
+
+	return GL_rect( x, y, fabs( command.m_x2 - command.m_x1 ), fabs( command.m_y2 - command.m_y1 ) );
+}
+
+/* Draw a run of quad commands with the batch
+ * the texture state is only checked for textured quads
+*/
+template<bool textured>
+static void Render_Quad_Commands( cRender_Batch &batch, const Render_Command *itr, const Render_Command *end )
+{
+	pRender_Stats->Add_Request( textured ? REND_SURFACE : REND_RECT, static_cast<unsigned int>(end - itr) );
+
+	for( ; itr != end; ++itr )
+	{
+		const Render_Quad_Command &quad = itr->m_quad;
+		const Color color( quad.m_color[0], quad.m_color[1], quad.m_color[2], quad.m_color[3] );
+
+		batch.Begin( textured ? quad.m_texture_id : 0, quad.m_blend_sfactor, quad.m_blend_dfactor, quad.m_combine_type, quad.m_combine_color );
+
+		if( textured )
+		{
+			batch.Add_Quad( itr->m_x1, itr->m_y1, itr->m_x2, itr->m_y2, itr->m_pos_z, color, quad.m_tex_x1, quad.m_tex_y1, quad.m_tex_x2, quad.m_tex_y2 );
+		}
+		else
+		{
+			batch.Add_Quad( itr->m_x1, itr->m_y1, itr->m_x2, itr->m_y2, itr->m_pos_z, color );
+		}
+	}
+}
 
 /* *** *** *** *** *** *** cRender_Request *** *** *** *** *** *** *** *** *** *** *** */
 
@@ -44,11 +138,68 @@ cRender_Request :: ~cRender_Request( void )
 
 }
 
+void *cRender_Request :: operator new( size_t size )
+{
+	// the pool is only used by the main thread
+	if( cRender_Capture::Get_Current() )
+	{
+		return cRender_Request_Pool::Allocate( size );
+	}
+
+	// requests are only created for the renderer which gets filled
+	if( pRenderer )
+	{
+		return pRenderer->m_pool.Get( size );
+	}
+
+	return cRender_Request_Pool::Allocate( size );
+}
+
+void cRender_Request :: operator delete( void *ptr )
+{
+	cRender_Request_Pool::Free( ptr );
+}
+
 void cRender_Request :: Draw( void )
 {
 	// virtual
 }
 
+bool cRender_Request :: Is_Batchable( bool shader /* = 0 */ ) const
+{
+	return 0;
+}
+
+bool cRender_Request :: Is_Batchable_Rotated( void ) const
+{
+	return 0;
+}
+
+void cRender_Request :: Add_To_Batch( cRender_Batch &batch ) const
+{
+	// virtual
+}
+
+bool cRender_Request :: Get_Bounds( GL_rect &rect ) const
+{
+	return 0;
+}
+
+Uint32 cRender_Request :: Get_State_Key( void ) const
+{
+	return 0;
+}
+
+bool cRender_Request :: Is_Opaque( void ) const
+{
+	return 0;
+}
+
+bool cRender_Request :: Get_Command( Render_Command &command ) const
+{
+	return 0;
+}
+
 /* *** *** *** *** *** *** cClear_Request *** *** *** *** *** *** *** *** *** *** *** */
 
 cClear_Request :: cClear_Request( void )
@@ -112,19 +263,12 @@ void cRender_Request_Advanced :: Render_Basic( void )
 	}
 
 	// blend factor
-	if( m_blend_sfactor != GL_SRC_ALPHA || m_blend_dfactor != GL_ONE_MINUS_SRC_ALPHA )
-	{
-		glBlendFunc( m_blend_sfactor, m_blend_dfactor );
-	}
+	pGL_State->Set_Blend_Func( m_blend_sfactor, m_blend_dfactor );
 }
 
 void cRender_Request_Advanced :: Render_Basic_Clear( void ) const
 {
-	// clear blend factor
-	if( m_blend_sfactor != GL_SRC_ALPHA || m_blend_dfactor != GL_ONE_MINUS_SRC_ALPHA )
-	{
-		glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-	}
+	// the state is not restored as every request sets the state it needs
 
 	// if debug build check for errors
 #ifdef _DEBUG
@@ -155,26 +299,152 @@ void cRender_Request_Advanced :: Render_Advanced( void )
 	}
 
 	// Color Combine
-	if( m_combine_type != 0 )
+	pGL_State->Set_Combine( m_combine_type, m_combine_color );
+}
+
+bool cRender_Request_Advanced :: Is_Batchable_Basic( bool shader /* = 0 */ ) const
+{
+	// the sprite shader handles rotation and shadow per vertex
+	if( shader )
+	{
+		return cSprite_Shader::Get_Combine_Mode( m_combine_type ) >= 0.0f;
+	}
+
+	// rotation needs the matrix
+	if( m_rot_x != 0.0f || m_rot_y != 0.0f || m_rot_z != 0.0f )
+	{
+		return 0;
+	}
+
+	// shadow is drawn as additional request
+	if( m_shadow_pos )
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+void cRender_Request_Advanced :: Get_Final_Rect( float x, float y, float w, float h, float scale_x, float scale_y, GL_rect &rect ) const
+{
+	// get the scaled half size
+	const float half_w = ( w / 2 ) * scale_x;
+	const float half_h = ( h / 2 ) * scale_y;
+	// position
+	float final_pos_x = x + half_w;
+	float final_pos_y = y + half_h;
+
+	// set camera position
+	if( !m_no_camera )
+	{
+		final_pos_x -= render_camera_x;
+		final_pos_y -= render_camera_y;
+	}
+
+	float x1 = final_pos_x - half_w;
+	float y1 = final_pos_y - half_h;
+	float x2 = final_pos_x + half_w;
+	float y2 = final_pos_y + half_h;
+
+	// global scale
+	if( m_global_scale )
+	{
+		x1 *= global_upscalex;
+		y1 *= global_upscaley;
+		x2 *= global_upscalex;
+		y2 *= global_upscaley;
+	}
+
+	rect.m_x = x1;
+	rect.m_y = y1;
+	rect.m_w = x2 - x1;
+	rect.m_h = y2 - y1;
+}
+
+Uint32 cRender_Request_Advanced :: Get_State_Key( void ) const
+{
+	Uint32 key = m_blend_sfactor;
+	key = key * 31 + m_blend_dfactor;
+
+	// the sprite shader does not need the same combine state
+	if( m_combine_type && !pVideo->m_sprite_shader )
 	{
-		glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE );
-		glTexEnvi( GL_TEXTURE_ENV, GL_COMBINE_RGB, m_combine_type );
-		glTexEnvi( GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_CONSTANT );
-		glTexEnvfv( GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, m_combine_color );
-		glTexEnvi( GL_TEXTURE_ENV, GL_SOURCE1_RGB, GL_TEXTURE );
+		key = key * 31 + m_combine_type;
+		key = key * 31 + static_cast<Uint32>( m_combine_color[0] * 255 );
+		key = key * 31 + static_cast<Uint32>( m_combine_color[1] * 255 );
+		key = key * 31 + static_cast<Uint32>( m_combine_color[2] * 255 );
 	}
+
+	// the lowest 8 bits are used
+	return ( key ^ ( key >> 8 ) ^ ( key >> 16 ) ^ ( key >> 24 ) ) & 0xFF;
+}
+
+bool cRender_Request_Advanced :: Is_Opaque_Basic( void ) const
+{
+	// other blending like additive changes the pixels behind
+	if( m_blend_sfactor != GL_SRC_ALPHA || m_blend_dfactor != GL_ONE_MINUS_SRC_ALPHA )
+	{
+		return 0;
+	}
+
+	// the shadow is transparent
+	if( m_shadow_pos )
+	{
+		return 0;
+	}
+
+	return 1;
 }
 
-void cRender_Request_Advanced :: Render_Advanced_Clear( void ) const
+bool cRender_Request_Advanced :: Get_Quad_Command( Render_Command &command, GLuint texture_id, float x, float y, float w, float h, float scale_x, float scale_y, const Color &color ) const
 {
-	// clear color modifications
-	if( m_combine_type != 0 )
+	// drawn the same with and without the sprite shader
+	if( !Is_Batchable_Basic() || cSprite_Shader::Get_Combine_Mode( m_combine_type ) < 0.0f )
+	{
+		return 0;
+	}
+
+	command.m_key = ( static_cast<Uint64>(Float_To_Sort_Key( m_pos_z )) << 32 ) | Get_State_Key();
+	command.m_pos_z = m_pos_z;
+	command.m_x1 = x;
+	command.m_y1 = y;
+	command.m_x2 = x + w * scale_x;
+	command.m_y2 = y + h * scale_y;
+	command.m_type = texture_id ? COMMAND_TEXTURE_QUAD : COMMAND_COLOR_QUAD;
+	command.m_render_type = static_cast<Uint8>(m_type);
+	command.m_flags = COMMAND_FLAG_BOUNDS;
+
+	if( Is_Opaque() )
+	{
+		command.m_flags |= COMMAND_FLAG_OPAQUE;
+	}
+	if( m_no_camera )
+	{
+		command.m_flags |= COMMAND_FLAG_NO_CAMERA;
+	}
+	if( m_global_scale )
 	{
-		float col[3] = { 0.0f, 0.0f, 0.0f };
-		glTexEnvfv( GL_TEXTURE_ENV, GL_TEXTURE_ENV_COLOR, col );
-		glTexEnvi( GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE );
-		glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
+		command.m_flags |= COMMAND_FLAG_GLOBAL_SCALE;
 	}
+
+	Render_Quad_Command &quad = command.m_quad;
+	quad.m_texture_id = texture_id;
+	quad.m_tex_x1 = 0.0f;
+	quad.m_tex_y1 = 0.0f;
+	quad.m_tex_x2 = 1.0f;
+	quad.m_tex_y2 = 1.0f;
+	quad.m_color[0] = color.red;
+	quad.m_color[1] = color.green;
+	quad.m_color[2] = color.blue;
+	quad.m_color[3] = color.alpha;
+	quad.m_blend_sfactor = m_blend_sfactor;
+	quad.m_blend_dfactor = m_blend_dfactor;
+	quad.m_combine_type = m_combine_type;
+	quad.m_combine_color[0] = m_combine_color[0];
+	quad.m_combine_color[1] = m_combine_color[1];
+	quad.m_combine_color[2] = m_combine_color[2];
+
+	return 1;
 }
 
 /* *** *** *** *** *** *** cLine_Request *** *** *** *** *** *** *** *** *** *** *** */
@@ -201,7 +471,7 @@ void cLine_Request :: Draw( void )
 	// set camera position
 	if( !m_no_camera )
 	{
-		glTranslatef( -pActive_Camera->m_x, -pActive_Camera->m_y, m_pos_z );
+		glTranslatef( -render_camera_x, -render_camera_y, m_pos_z );
 	}
 	else
 	{
@@ -212,51 +482,21 @@ void cLine_Request :: Draw( void )
 	Render_Advanced();
 
 	// color
-	if( m_color.red != 255 || m_color.green != 255 || m_color.blue != 255 || m_color.alpha != 255 )
-	{
-		glColor4ub( m_color.red, m_color.green, m_color.blue, m_color.alpha );
-	}
+	pGL_State->Set_Color( m_color );
 
-	if( glIsEnabled( GL_TEXTURE_2D ) )
-	{
-		glDisable( GL_TEXTURE_2D );
-	}
+	pGL_State->Set_Texture_2D( 0 );
 
-	// change width
-	if( m_line_width != 1.0f )
-	{
-		glLineWidth( m_line_width );
-	}
-	// enable stipple pattern
-	if( m_stipple_pattern != 0 )
-	{
-		glEnable( GL_LINE_STIPPLE );
-		glLineStipple( 2, m_stipple_pattern );
-	}
+	// width
+	pGL_State->Set_Line_Width( m_line_width );
+	// stipple pattern
+	pGL_State->Set_Line_Stipple( m_stipple_pattern );
 
 	glBegin( GL_LINES );
 		glVertex2f( m_line.m_x1, m_line.m_y1 );
 		glVertex2f( m_line.m_x2, m_line.m_y2 );
 	glEnd();
+	pRender_Stats->Add_Draw_Call( 2 );
 
-	// clear stipple pattern
-	if( m_stipple_pattern != 0 )
-	{
-		glDisable( GL_LINE_STIPPLE );
-	}
-	// clear line width
-	if( m_line_width != 1.0f )
-	{
-		glLineWidth( 1.0f );
-	}
-
-	// clear color
-	if( m_color.red != 255 || m_color.green != 255 || m_color.blue != 255 || m_color.alpha != 255 )
-	{
-		glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
-	}
-
-	Render_Advanced_Clear();
 	Render_Basic_Clear();
 }
 
@@ -297,8 +537,8 @@ void cRect_Request :: Draw( void )
 	// set camera position
 	if( !m_no_camera )
 	{
-		final_pos_x -= pActive_Camera->m_x;
-		final_pos_y -= pActive_Camera->m_y;
+		final_pos_x -= render_camera_x;
+		final_pos_y -= render_camera_y;
 	}
 
 	glTranslatef( final_pos_x, final_pos_y, m_pos_z );
@@ -312,15 +552,9 @@ void cRect_Request :: Draw( void )
 	Render_Advanced();
 
 	// color
-	if( m_color.red != 255 || m_color.green != 255 || m_color.blue != 255 || m_color.alpha != 255 )
-	{
-		glColor4ub( m_color.red, m_color.green, m_color.blue, m_color.alpha );
-	}
+	pGL_State->Set_Color( m_color );
 
-	if( glIsEnabled( GL_TEXTURE_2D ) )
-	{
-		glDisable( GL_TEXTURE_2D );
-	}
+	pGL_State->Set_Texture_2D( 0 );
 
 	if( m_filled )
 	{
@@ -328,17 +562,10 @@ void cRect_Request :: Draw( void )
 	}
 	else
 	{
-		// change width
-		if( m_line_width != 1.0f )
-		{
-			glLineWidth( m_line_width );
-		}
-		// enable stipple pattern
-		if( m_stipple_pattern != 0 )
-		{
-			glEnable( GL_LINE_STIPPLE );
-			glLineStipple( 2, m_stipple_pattern );
-		}
+		// width
+		pGL_State->Set_Line_Width( m_line_width );
+		// stipple pattern
+		pGL_State->Set_Line_Stipple( m_stipple_pattern );
 
 		glBegin( GL_LINE_LOOP );
 	}
@@ -351,26 +578,62 @@ void cRect_Request :: Draw( void )
 		// bottom left
 		glVertex2f( -half_w, half_h );
 	glEnd();
+	pRender_Stats->Add_Draw_Call( 4 );
+
+	Render_Basic_Clear();
+}
+
+bool cRect_Request :: Is_Batchable( bool shader /* = 0 */ ) const
+{
+	if( !m_filled )
+	{
+		return 0;
+	}
+
+	return Is_Batchable_Basic( shader );
+}
+
+void cRect_Request :: Add_To_Batch( cRender_Batch &batch ) const
+{
+	batch.Begin( this, 0 );
 
-	// clear stipple pattern
-	if( m_stipple_pattern != 0 )
+	// rects are drawn without shadow
+	if( batch.m_shader )
 	{
-		glDisable( GL_LINE_STIPPLE );
+		batch.Add_Sprite( this, m_rect.m_x, m_rect.m_y, m_rect.m_w, m_rect.m_h, m_scale_x, m_scale_y, m_pos_z, m_color, 0 );
+		return;
 	}
-	// clear line width
-	if( m_line_width != 1.0f )
+
+	GL_rect rect;
+	Get_Final_Rect( m_rect.m_x, m_rect.m_y, m_rect.m_w, m_rect.m_h, m_scale_x, m_scale_y, rect );
+
+	batch.Add_Quad( rect.m_x, rect.m_y, rect.m_x + rect.m_w, rect.m_y + rect.m_h, m_pos_z, m_color );
+}
+
+bool cRect_Request :: Get_Bounds( GL_rect &rect ) const
+{
+	if( !Is_Batchable() )
 	{
-		glLineWidth( 1.0f );
+		return 0;
 	}
 
-	// clear color
-	if( m_color.red != 255 || m_color.green != 255 || m_color.blue != 255 || m_color.alpha != 255 )
+	Get_Final_Rect( m_rect.m_x, m_rect.m_y, m_rect.m_w, m_rect.m_h, m_scale_x, m_scale_y, rect );
+	return 1;
+}
+
+bool cRect_Request :: Is_Opaque( void ) const
+{
+	return m_filled && m_color.alpha == 255 && Is_Opaque_Basic();
+}
+
+bool cRect_Request :: Get_Command( Render_Command &command ) const
+{
+	if( !m_filled )
 	{
-		glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
+		return 0;
 	}
 
-	Render_Advanced_Clear();
-	Render_Basic_Clear();
+	return Get_Quad_Command( command, 0, m_rect.m_x, m_rect.m_y, m_rect.m_w, m_rect.m_h, m_scale_x, m_scale_y, m_color );
 }
 
 /* *** *** *** *** *** *** cGradient_Request *** *** *** *** *** *** *** *** *** *** *** */
@@ -397,7 +660,7 @@ void cGradient_Request :: Draw( void )
 	// set camera position
 	if( !m_no_camera )
 	{
-		glTranslatef( m_rect.m_x - pActive_Camera->m_x, m_rect.m_y - pActive_Camera->m_y, m_pos_z );
+		glTranslatef( m_rect.m_x - render_camera_x, m_rect.m_y - render_camera_y, m_pos_z );
 	}
 	// ignore camera position
 	else
@@ -405,44 +668,48 @@ void cGradient_Request :: Draw( void )
 		glTranslatef( m_rect.m_x, m_rect.m_y, m_pos_z );
 	}
 
-	if( glIsEnabled( GL_TEXTURE_2D ) )
-	{
-		glDisable( GL_TEXTURE_2D );
-	}
+	pGL_State->Set_Texture_2D( 0 );
 
 	Render_Advanced();
 
 	if( m_dir == DIR_VERTICAL )
 	{
 		glBegin( GL_POLYGON );
-			glColor4ub( m_color_1.red, m_color_1.green, m_color_1.blue, m_color_1.alpha );
+			pGL_State->Set_Color( m_color_1 );
 			glVertex2f( 0.0f, 0.0f );
 			glVertex2f( m_rect.m_w, 0.0f );
-			glColor4ub( m_color_2.red, m_color_2.green, m_color_2.blue, m_color_2.alpha );
+			pGL_State->Set_Color( m_color_2 );
 			glVertex2f( m_rect.m_w, m_rect.m_h );
 			glVertex2f( 0.0f, m_rect.m_h );
 		glEnd();
-
+		pRender_Stats->Add_Draw_Call( 4 );
 	}
 	else if( m_dir == DIR_HORIZONTAL )
 	{
 		glBegin( GL_POLYGON );
-			glColor4ub( m_color_1.red, m_color_1.green, m_color_1.blue, m_color_1.alpha );
+			pGL_State->Set_Color( m_color_1 );
 			glVertex2f( 0.0f, m_rect.m_h );
 			glVertex2f( 0.0f, 0.0f );
-			glColor4ub( m_color_2.red, m_color_2.green, m_color_2.blue, m_color_2.alpha );
+			pGL_State->Set_Color( m_color_2 );
 			glVertex2f( m_rect.m_w, 0.0f );
 			glVertex2f( m_rect.m_w, m_rect.m_h );
 		glEnd();
+		pRender_Stats->Add_Draw_Call( 4 );
 	}
 
-	// clear color
-	glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
-
-	Render_Advanced_Clear();
 	Render_Basic_Clear();
 }
 
+bool cGradient_Request :: Is_Opaque( void ) const
+{
+	if( m_dir != DIR_VERTICAL && m_dir != DIR_HORIZONTAL )
+	{
+		return 0;
+	}
+
+	return m_color_1.alpha == 255 && m_color_2.alpha == 255 && Is_Opaque_Basic();
+}
+
 /* *** *** *** *** *** *** cCircle_Request *** *** *** *** *** *** *** *** *** *** *** */
 
 cCircle_Request :: cCircle_Request( void )
@@ -468,7 +735,7 @@ void cCircle_Request :: Draw( void )
 	// set camera position
 	if( !m_no_camera )
 	{
-		glTranslatef( m_pos.m_x - pActive_Camera->m_x, m_pos.m_y - pActive_Camera->m_y, m_pos_z );
+		glTranslatef( m_pos.m_x - render_camera_x, m_pos.m_y - render_camera_y, m_pos_z );
 	}
 	// ignore camera position
 	else
@@ -479,21 +746,17 @@ void cCircle_Request :: Draw( void )
 	Render_Advanced();
 
 	// color
-	if( m_color.red != 255 || m_color.green != 255 || m_color.blue != 255 || m_color.alpha != 255 )
-	{
-		glColor4ub( m_color.red, m_color.green, m_color.blue, m_color.alpha );
-	}
+	pGL_State->Set_Color( m_color );
 
-	if( glIsEnabled( GL_TEXTURE_2D ) )
-	{
-		glDisable( GL_TEXTURE_2D );
-	}
+	pGL_State->Set_Texture_2D( 0 );
+
+	unsigned int vertices = 0;
 
 	// not filled
 	if( m_line_width )
 	{
 		// set line width
-		glLineWidth( m_line_width );
+		pGL_State->Set_Line_Width( m_line_width );
 
 		glBegin( GL_LINE_STRIP );
 	}
@@ -504,6 +767,7 @@ void cCircle_Request :: Draw( void )
 
 		// start with center
 		glVertex2f( 0.0f, 0.0f );
+		vertices++;
 	}
 
 	// set step size based on radius
@@ -521,27 +785,17 @@ void cCircle_Request :: Draw( void )
 	{
 		glVertex2f( m_radius * sin( angle ), m_radius * cos( angle ) );
 		angle += step_size;
+		vertices++;
 	}
 
 	// draw to end
 	angle = doubled_pi;
 	glVertex2f( m_radius * sin( angle ), m_radius * cos( angle ) );
+	vertices++;
 
 	glEnd();
+	pRender_Stats->Add_Draw_Call( vertices );
 
-	// clear line width
-	if( m_line_width != 1 )
-	{
-		glLineWidth( 1.0f );
-	}
-
-	// clear color
-	if( m_color.red != 255 || m_color.green != 255 || m_color.blue != 255 || m_color.alpha != 255 )
-	{
-		glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
-	}
-
-	Render_Advanced_Clear();
 	Render_Basic_Clear();
 }
 
@@ -552,6 +806,10 @@ cSurface_Request :: cSurface_Request( void )
 {
 	m_type = REND_SURFACE;
 	m_texture_id = 0;
+	m_tex_x1 = 0.0f;
+	m_tex_y1 = 0.0f;
+	m_tex_x2 = 1.0f;
+	m_tex_y2 = 1.0f;
 
 	m_pos_x = 0.0f;
 	m_pos_y = 0.0f;
@@ -565,7 +823,11 @@ cSurface_Request :: cSurface_Request( void )
 
 	m_color = static_cast<Uint8>(255);
 
+	m_repeat_x = 0;
+	m_repeat_y = 0;
+
 	m_delete_texture = 0;
+	m_opaque = 0;
 }
 
 cSurface_Request :: ~cSurface_Request( void )
@@ -633,8 +895,8 @@ void cSurface_Request :: Draw( void )
 	// set camera position
 	if( !m_no_camera )
 	{
-		final_pos_x -= pActive_Camera->m_x;
-		final_pos_y -= pActive_Camera->m_y;
+		final_pos_x -= render_camera_x;
+		final_pos_y -= render_camera_y;
 	}
 
 	glTranslatef( final_pos_x, final_pos_y, m_pos_z );
@@ -648,21 +910,75 @@ void cSurface_Request :: Draw( void )
 	Render_Advanced();
 
 	// color
-	if( m_color.red != 255 || m_color.green != 255 || m_color.blue != 255 || m_color.alpha != 255 )
+	pGL_State->Set_Color( m_color );
+
+	pGL_State->Set_Texture_2D( 1 );
+
+	// every tile is drawn as its own quad
+	if( !m_tiles.empty() )
 	{
-		glColor4ub( m_color.red, m_color.green, m_color.blue, m_color.alpha );
+		// the screen rect of unrotated surfaces is known to skip invisible tiles
+		const bool cull = m_rot_x == 0.0f && m_rot_y == 0.0f && m_rot_z == 0.0f;
+		GL_rect rect;
+
+		if( cull )
+		{
+			Get_Final_Rect( m_pos_x, m_pos_y, m_w, m_h, m_scale_x, m_scale_y, rect );
+		}
+
+		const GL_rect surface_rect( -half_w, -half_h, m_w, m_h );
+
+		for( GL_Texture_Tile_List::const_iterator itr = m_tiles.begin(); itr != m_tiles.end(); ++itr )
+		{
+			const cGL_Texture_Tile &tile = (*itr);
+
+			if( cull )
+			{
+				GL_rect screen_rect;
+				Get_Tile_Rect( tile, rect, screen_rect );
+
+				if( !Is_Rect_On_Screen( screen_rect ) )
+				{
+					continue;
+				}
+			}
+
+			GL_rect tile_rect;
+			Get_Tile_Rect( tile, surface_rect, tile_rect );
+
+			pGL_State->Bind_Texture( tile.m_texture_id );
+
+			glBegin( GL_QUADS );
+				// top left
+				glTexCoord2f( 0.0f, 0.0f );
+				glVertex2f( tile_rect.m_x, tile_rect.m_y );
+				// top right
+				glTexCoord2f( tile.m_tex_x2, 0.0f );
+				glVertex2f( tile_rect.m_x + tile_rect.m_w, tile_rect.m_y );
+				// bottom right
+				glTexCoord2f( tile.m_tex_x2, tile.m_tex_y2 );
+				glVertex2f( tile_rect.m_x + tile_rect.m_w, tile_rect.m_y + tile_rect.m_h );
+				// bottom left
+				glTexCoord2f( 0.0f, tile.m_tex_y2 );
+				glVertex2f( tile_rect.m_x, tile_rect.m_y + tile_rect.m_h );
+			glEnd();
+			pRender_Stats->Add_Draw_Call( 4 );
+		}
+
+		Render_Basic_Clear();
+		return;
 	}
 
-	if( !glIsEnabled( GL_TEXTURE_2D ) )
+	pGL_State->Bind_Texture( m_texture_id );
+
+	// wrap mode is a texture parameter
+	if( m_repeat_x )
 	{
-		glEnable( GL_TEXTURE_2D );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
 	}
-
-	// only bind if not the same texture
-	if( last_bind_texture != m_texture_id )
+	if( m_repeat_y )
 	{
-		glBindTexture( GL_TEXTURE_2D, m_texture_id );
-		last_bind_texture = m_texture_id;
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
 	}
 
 	/* vertex arrays should not be used to draw simple primitives as it
@@ -671,82 +987,1721 @@ void cSurface_Request :: Draw( void )
 	// rectangle
 	glBegin( GL_QUADS );
 		// top left
-		glTexCoord2f( 0.0f, 0.0f );
+		glTexCoord2f( m_tex_x1, m_tex_y1 );
 		glVertex2f( -half_w, -half_h );
 		// top right
-		glTexCoord2f( 1.0f, 0.0f );
+		glTexCoord2f( m_tex_x2, m_tex_y1 );
 		glVertex2f( half_w, -half_h );
 		// bottom right
-		glTexCoord2f( 1.0f, 1.0f );
+		glTexCoord2f( m_tex_x2, m_tex_y2 );
 		glVertex2f( half_w, half_h );
 		// bottom left
-		glTexCoord2f( 0.0f, 1.0f );
+		glTexCoord2f( m_tex_x1, m_tex_y2 );
 		glVertex2f( -half_w, half_h );
 	glEnd();
+	pRender_Stats->Add_Draw_Call( 4 );
 
-	// clear color
-	if( m_color.red != 255 || m_color.green != 255 || m_color.blue != 255 || m_color.alpha != 255 )
+	// restore the default wrap mode
+	if( m_repeat_x )
+	{
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+	}
+	if( m_repeat_y )
 	{
-		/* alpha is automatically 1 for glColor3f
-		 * update : not on the shitty intel drivers :(
-		*/
-		glColor4f( 1.0f, 1.0f, 1.0f, 1.0f );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
 	}
 
-	Render_Advanced_Clear();
 	Render_Basic_Clear();
 }
 
-/* *** *** *** *** *** *** cRenderQueue *** *** *** *** *** *** *** *** *** *** *** */
-
-cRenderQueue :: cRenderQueue( unsigned int reserve_items )
+bool cSurface_Request :: Is_Batchable( bool shader /* = 0 */ ) const
 {
-	m_render_data.reserve( reserve_items );
+	// needs the texture wrap mode
+	if( m_repeat_x || m_repeat_y )
+	{
+		return 0;
+	}
+
+	// tiles are added as pre-transformed quads
+	if( !m_tiles.empty() )
+	{
+		return Is_Batchable_Basic( 0 );
+	}
+
+	return Is_Batchable_Basic( shader );
 }
 
-cRenderQueue :: ~cRenderQueue( void )
+bool cSurface_Request :: Is_Batchable_Rotated( void ) const
 {
-	Clear();
+	return !m_repeat_x && !m_repeat_y && m_tiles.empty() && !m_shadow_pos;
 }
 
-void cRenderQueue :: Add( cRender_Request *obj )
+void cSurface_Request :: Add_To_Batch( cRender_Batch &batch ) const
 {
-	if( !obj )
+	if( !m_tiles.empty() )
 	{
+		GL_rect rect;
+		Get_Final_Rect( m_pos_x, m_pos_y, m_w, m_h, m_scale_x, m_scale_y, rect );
+
+		for( GL_Texture_Tile_List::const_iterator itr = m_tiles.begin(); itr != m_tiles.end(); ++itr )
+		{
+			GL_rect tile_rect;
+			Get_Tile_Rect( *itr, rect, tile_rect );
+
+			// not visible
+			if( !Is_Rect_On_Screen( tile_rect ) )
+			{
+				continue;
+			}
+
+			batch.Begin( this, (*itr).m_texture_id );
+			batch.Add_Quad( tile_rect.m_x, tile_rect.m_y, tile_rect.m_x + tile_rect.m_w, tile_rect.m_y + tile_rect.m_h, m_pos_z, m_color, 0.0f, 0.0f, (*itr).m_tex_x2, (*itr).m_tex_y2 );
+		}
+
 		return;
 	}
 
-	// if no type
-	if( obj->m_type == REND_NOTHING )
+	batch.Begin( this, m_texture_id );
+
+	if( batch.m_shader )
 	{
-		delete obj;
+		// the shadow is drawn first
+		if( m_shadow_pos )
+		{
+			batch.Add_Sprite( this, m_pos_x, m_pos_y, m_w, m_h, m_scale_x, m_scale_y, m_pos_z, m_color, 1, m_tex_x1, m_tex_y1, m_tex_x2, m_tex_y2 );
+		}
+
+		batch.Add_Sprite( this, m_pos_x, m_pos_y, m_w, m_h, m_scale_x, m_scale_y, m_pos_z, m_color, 0, m_tex_x1, m_tex_y1, m_tex_x2, m_tex_y2 );
 		return;
 	}
 
-	m_render_data.push_back( obj );
+	if( m_rot_x != 0.0f || m_rot_y != 0.0f || m_rot_z != 0.0f )
+	{
+		batch.Add_Rotated_Quad( this, m_pos_x, m_pos_y, m_w, m_h, m_scale_x, m_scale_y, m_scale_z, m_pos_z, m_color, m_tex_x1, m_tex_y1, m_tex_x2, m_tex_y2 );
+		return;
+	}
+
+	GL_rect rect;
+	Get_Final_Rect( m_pos_x, m_pos_y, m_w, m_h, m_scale_x, m_scale_y, rect );
+
+	batch.Add_Quad( rect.m_x, rect.m_y, rect.m_x + rect.m_w, rect.m_y + rect.m_h, m_pos_z, m_color, m_tex_x1, m_tex_y1, m_tex_x2, m_tex_y2 );
 }
 
-void cRenderQueue :: Render( bool clear /* = 1 */ )
+bool cSurface_Request :: Get_Bounds( GL_rect &rect ) const
 {
-	// z position sort
-	std::sort( m_render_data.begin(), m_render_data.end(), zpos_sort() );
-	// reset last texture
-	last_bind_texture = 0;
-
-	for( RenderList::iterator itr = m_render_data.begin(); itr != m_render_data.end(); ++itr )
+	if( !Is_Batchable() )
 	{
-		cRender_Request *obj = (*itr);
-
-		obj->Draw();
-		obj->m_render_count--;
+		return 0;
 	}
 
+	Get_Final_Rect( m_pos_x, m_pos_y, m_w, m_h, m_scale_x, m_scale_y, rect );
+	return 1;
+}
+
+Uint32 cSurface_Request :: Get_State_Key( void ) const
+{
+	// texture in the upper and blending in the lowest 8 bits
+	return ( static_cast<Uint32>(m_texture_id) << 8 ) | cRender_Request_Advanced::Get_State_Key();
+}
+
+bool cSurface_Request :: Is_Opaque( void ) const
+{
+	return m_opaque && m_texture_id && m_color.alpha == 255 && Is_Opaque_Basic();
+}
+
+bool cSurface_Request :: Get_Command( Render_Command &command ) const
+{
+	// the texture must stay until drawn
+	if( !m_texture_id || m_repeat_x || m_repeat_y || m_delete_texture || !m_tiles.empty() )
+	{
+		return 0;
+	}
+
+	if( !Get_Quad_Command( command, m_texture_id, m_pos_x, m_pos_y, m_w, m_h, m_scale_x, m_scale_y, m_color ) )
+	{
+		return 0;
+	}
+
+	Render_Quad_Command &quad = command.m_quad;
+	quad.m_tex_x1 = m_tex_x1;
+	quad.m_tex_y1 = m_tex_y1;
+	quad.m_tex_x2 = m_tex_x2;
+	quad.m_tex_y2 = m_tex_y2;
+
+	return 1;
+}
+
+void cSurface_Request :: Get_Tile_Rect( const cGL_Texture_Tile &tile, const GL_rect &rect, GL_rect &tile_rect )
+{
+	tile_rect.m_x = rect.m_x + ( rect.m_w * tile.m_x1 );
+	tile_rect.m_y = rect.m_y + ( rect.m_h * tile.m_y1 );
+	tile_rect.m_w = rect.m_w * ( tile.m_x2 - tile.m_x1 );
+	tile_rect.m_h = rect.m_h * ( tile.m_y2 - tile.m_y1 );
+}
+
+/* *** *** *** *** *** *** cStatic_Geometry_Request *** *** *** *** *** *** *** *** *** *** *** */
+
+cStatic_Geometry_Request :: cStatic_Geometry_Request( void )
+: cRender_Request()
+{
+	m_type = REND_STATIC;
+	m_geometry = NULL;
+}
+
+cStatic_Geometry_Request :: ~cStatic_Geometry_Request( void )
+{
+
+}
+
+void cStatic_Geometry_Request :: Draw( void )
+{
+	if( !m_geometry )
+	{
+		return;
+	}
+
+	m_geometry->Draw();
+}
+
+bool cStatic_Geometry_Request :: Get_Bounds( GL_rect &rect ) const
+{
+	if( !m_geometry || !m_geometry->m_quad_count )
+	{
+		return 0;
+	}
+
+	const GL_rect &geometry_rect = m_geometry->m_rect;
+
+	rect.m_x = ( geometry_rect.m_x - render_camera_x ) * global_upscalex;
+	rect.m_y = ( geometry_rect.m_y - render_camera_y ) * global_upscaley;
+	rect.m_w = geometry_rect.m_w * global_upscalex;
+	rect.m_h = geometry_rect.m_h * global_upscaley;
+	return 1;
+}
+
+Uint32 cStatic_Geometry_Request :: Get_State_Key( void ) const
+{
+	if( !m_geometry || m_geometry->m_parts.empty() )
+	{
+		return 0;
+	}
+
+	return static_cast<Uint32>(m_geometry->m_parts[0].m_texture_id) << 8;
+}
+
+/* *** *** *** *** *** *** cQuad_Stream_Request *** *** *** *** *** *** *** *** *** *** *** */
+
+cQuad_Stream_Request :: cQuad_Stream_Request( void )
+: cRender_Request_Advanced()
+{
+	m_type = REND_QUAD_STREAM;
+	m_no_camera = 0;
+
+	m_texture_id = 0;
+	m_tex_x1 = 0.0f;
+	m_tex_y1 = 0.0f;
+	m_tex_x2 = 1.0f;
+	m_tex_y2 = 1.0f;
+
+	m_quad_count = 0;
+
+	m_min_x = 0.0f;
+	m_min_y = 0.0f;
+	m_max_x = 0.0f;
+	m_max_y = 0.0f;
+}
+
+cQuad_Stream_Request :: ~cQuad_Stream_Request( void )
+{
+
+}
+
+void cQuad_Stream_Request :: Draw( void )
+{
+	if( !m_quad_count )
+	{
+		return;
+	}
+
+	Render_Basic();
+
+	// set camera position
+	if( !m_no_camera )
+	{
+		glTranslatef( -render_camera_x, -render_camera_y, 0.0f );
+	}
+
+	// Color Combine
+	pGL_State->Set_Combine( m_combine_type, m_combine_color );
+
+	pGL_State->Set_Client_State( GL_VERTEX_ARRAY, 1 );
+	glVertexPointer( 3, GL_FLOAT, 0, &m_vertices[0] );
+	pGL_State->Set_Client_State( GL_COLOR_ARRAY, 1 );
+	glColorPointer( 4, GL_UNSIGNED_BYTE, 0, &m_colors[0] );
+
+	if( m_texture_id )
+	{
+		pGL_State->Set_Client_State( GL_TEXTURE_COORD_ARRAY, 1 );
+		glTexCoordPointer( 2, GL_FLOAT, 0, &m_tex_coords[0] );
+
+		pGL_State->Set_Texture_2D( 1 );
+		pGL_State->Bind_Texture( m_texture_id );
+	}
+	// untextured
+	else
+	{
+		pGL_State->Set_Client_State( GL_TEXTURE_COORD_ARRAY, 0 );
+		pGL_State->Set_Texture_2D( 0 );
+	}
+
+	glDrawArrays( GL_QUADS, 0, m_quad_count * 4 );
+	pRender_Stats->Add_Draw_Call( m_quad_count * 4 );
+
+	// the current color is undefined after using a color array
+	pGL_State->Invalidate_Color();
+
+	Render_Basic_Clear();
+}
+
+bool cQuad_Stream_Request :: Get_Bounds( GL_rect &rect ) const
+{
+	if( !m_quad_count )
+	{
+		return 0;
+	}
+
+	rect.m_x = m_min_x;
+	rect.m_y = m_min_y;
+	rect.m_w = m_max_x - m_min_x;
+	rect.m_h = m_max_y - m_min_y;
+
+	// set camera position
+	if( !m_no_camera )
+	{
+		rect.m_x -= render_camera_x;
+		rect.m_y -= render_camera_y;
+	}
+
+	// global scale
+	if( m_global_scale )
+	{
+		rect.m_x *= global_upscalex;
+		rect.m_y *= global_upscaley;
+		rect.m_w *= global_upscalex;
+		rect.m_h *= global_upscaley;
+	}
+
+	return 1;
+}
+
+Uint32 cQuad_Stream_Request :: Get_State_Key( void ) const
+{
+	// texture in the upper and blending in the lowest 8 bits
+	return ( static_cast<Uint32>(m_texture_id) << 8 ) | cRender_Request_Advanced::Get_State_Key();
+}
+
+void cQuad_Stream_Request :: Reserve( unsigned int count )
+{
+	m_vertices.reserve( count * 12 );
+	m_tex_coords.reserve( count * 8 );
+	m_colors.reserve( count * 16 );
+}
+
+void cQuad_Stream_Request :: Add_Quad( const GLfloat corners[12], const Color &color )
+{
+	m_vertices.insert( m_vertices.end(), corners, corners + 12 );
+
+	m_tex_coords.push_back( m_tex_x1 );
+	m_tex_coords.push_back( m_tex_y1 );
+	m_tex_coords.push_back( m_tex_x2 );
+	m_tex_coords.push_back( m_tex_y1 );
+	m_tex_coords.push_back( m_tex_x2 );
+	m_tex_coords.push_back( m_tex_y2 );
+	m_tex_coords.push_back( m_tex_x1 );
+	m_tex_coords.push_back( m_tex_y2 );
+
+	for( unsigned int i = 0; i < 4; i++ )
+	{
+		m_colors.push_back( color.red );
+		m_colors.push_back( color.green );
+		m_colors.push_back( color.blue );
+		m_colors.push_back( color.alpha );
+
+		const GLfloat x = corners[i * 3];
+		const GLfloat y = corners[i * 3 + 1];
+		const GLfloat z = corners[i * 3 + 2];
+
+		// update the rect
+		if( !m_quad_count && i == 0 )
+		{
+			m_min_x = x;
+			m_min_y = y;
+			m_max_x = x;
+			m_max_y = y;
+			m_pos_z = z;
+			continue;
+		}
+
+		if( x < m_min_x )
+		{
+			m_min_x = x;
+		}
+		else if( x > m_max_x )
+		{
+			m_max_x = x;
+		}
+
+		if( y < m_min_y )
+		{
+			m_min_y = y;
+		}
+		else if( y > m_max_y )
+		{
+			m_max_y = y;
+		}
+
+		// sorted with the lowest z position
+		if( z < m_pos_z )
+		{
+			m_pos_z = z;
+		}
+	}
+
+	m_quad_count++;
+}
+
+void cQuad_Stream_Request :: Add_Rect( const GL_rect &rect, float z, const Color &color )
+{
+	const GLfloat corners[12] =
+	{
+		rect.m_x, rect.m_y, z,
+		rect.m_x + rect.m_w, rect.m_y, z,
+		rect.m_x + rect.m_w, rect.m_y + rect.m_h, z,
+		rect.m_x, rect.m_y + rect.m_h, z
+	};
+
+	Add_Quad( corners, color );
+}
+
+/* *** *** *** *** *** *** cLine_Stream_Request *** *** *** *** *** *** *** *** *** *** *** */
+
+cLine_Stream_Request :: cLine_Stream_Request( void )
+: cRender_Request_Advanced()
+{
+	m_type = REND_LINE_STREAM;
+
+	m_line_width = 1.0f;
+	m_stipple_pattern = 0;
+
+	m_line_count = 0;
+
+	m_min_x = 0.0f;
+	m_min_y = 0.0f;
+	m_max_x = 0.0f;
+	m_max_y = 0.0f;
+}
+
+cLine_Stream_Request :: ~cLine_Stream_Request( void )
+{
+
+}
+
+void cLine_Stream_Request :: Draw( void )
+{
+	if( !m_line_count )
+	{
+		return;
+	}
+
+	Render_Basic();
+
+	// set camera position
+	if( !m_no_camera )
+	{
+		glTranslatef( -render_camera_x, -render_camera_y, 0.0f );
+	}
+
+	Render_Advanced();
+
+	pGL_State->Set_Texture_2D( 0 );
+
+	// width
+	pGL_State->Set_Line_Width( m_line_width );
+	// stipple pattern
+	pGL_State->Set_Line_Stipple( m_stipple_pattern );
+
+	pGL_State->Set_Client_State( GL_VERTEX_ARRAY, 1 );
+	glVertexPointer( 3, GL_FLOAT, 0, &m_vertices[0] );
+	pGL_State->Set_Client_State( GL_COLOR_ARRAY, 1 );
+	glColorPointer( 4, GL_UNSIGNED_BYTE, 0, &m_colors[0] );
+	pGL_State->Set_Client_State( GL_TEXTURE_COORD_ARRAY, 0 );
+
+	glDrawArrays( GL_LINES, 0, m_line_count * 2 );
+	pRender_Stats->Add_Draw_Call( m_line_count * 2 );
+
+	// the current color is undefined after using a color array
+	pGL_State->Invalidate_Color();
+
+	Render_Basic_Clear();
+}
+
+bool cLine_Stream_Request :: Get_Bounds( GL_rect &rect ) const
+{
+	if( !m_line_count )
+	{
+		return 0;
+	}
+
+	rect.m_x = m_min_x;
+	rect.m_y = m_min_y;
+	rect.m_w = m_max_x - m_min_x;
+	rect.m_h = m_max_y - m_min_y;
+
+	// set camera position
+	if( !m_no_camera )
+	{
+		rect.m_x -= render_camera_x;
+		rect.m_y -= render_camera_y;
+	}
+
+	// global scale
+	if( m_global_scale )
+	{
+		rect.m_x *= global_upscalex;
+		rect.m_y *= global_upscaley;
+		rect.m_w *= global_upscalex;
+		rect.m_h *= global_upscaley;
+	}
+
+	return 1;
+}
+
+void cLine_Stream_Request :: Reserve( unsigned int count )
+{
+	m_vertices.reserve( count * 6 );
+	m_colors.reserve( count * 8 );
+}
+
+void cLine_Stream_Request :: Add_Line( float x1, float y1, float x2, float y2, float z, const Color &color )
+{
+	m_vertices.push_back( x1 );
+	m_vertices.push_back( y1 );
+	m_vertices.push_back( z );
+	m_vertices.push_back( x2 );
+	m_vertices.push_back( y2 );
+	m_vertices.push_back( z );
+
+	for( unsigned int i = 0; i < 2; i++ )
+	{
+		m_colors.push_back( color.red );
+		m_colors.push_back( color.green );
+		m_colors.push_back( color.blue );
+		m_colors.push_back( color.alpha );
+	}
+
+	const float min_x = x1 < x2 ? x1 : x2;
+	const float max_x = x1 < x2 ? x2 : x1;
+	const float min_y = y1 < y2 ? y1 : y2;
+	const float max_y = y1 < y2 ? y2 : y1;
+
+	// update the rect
+	if( !m_line_count )
+	{
+		m_min_x = min_x;
+		m_min_y = min_y;
+		m_max_x = max_x;
+		m_max_y = max_y;
+		m_pos_z = z;
+	}
+	else
+	{
+		if( min_x < m_min_x )
+		{
+			m_min_x = min_x;
+		}
+		if( max_x > m_max_x )
+		{
+			m_max_x = max_x;
+		}
+		if( min_y < m_min_y )
+		{
+			m_min_y = min_y;
+		}
+		if( max_y > m_max_y )
+		{
+			m_max_y = max_y;
+		}
+
+		// sorted with the lowest z position
+		if( z < m_pos_z )
+		{
+			m_pos_z = z;
+		}
+	}
+
+	m_line_count++;
+}
+
+void cLine_Stream_Request :: Add_Rect( const GL_rect &rect, float z, const Color &color )
+{
+	const float x2 = rect.m_x + rect.m_w;
+	const float y2 = rect.m_y + rect.m_h;
+
+	Add_Line( rect.m_x, rect.m_y, x2, rect.m_y, z, color );
+	Add_Line( x2, rect.m_y, x2, y2, z, color );
+	Add_Line( x2, y2, rect.m_x, y2, z, color );
+	Add_Line( rect.m_x, y2, rect.m_x, rect.m_y, z, color );
+}
+
+/* *** *** *** *** *** *** cParticle_Seed_Request *** *** *** *** *** *** *** *** *** *** *** */
+
+cParticle_Seed_Request :: cParticle_Seed_Request( void )
+: cRender_Request_Advanced()
+{
+	m_type = REND_PARTICLE_SEED;
+	m_no_camera = 0;
+
+	m_buffer = NULL;
+	m_size = 0;
+	m_recreate = 0;
+	m_upload_first = 0;
+
+	m_time = 0.0f;
+
+	m_texture_id = 0;
+	m_tex_x1 = 0.0f;
+	m_tex_y1 = 0.0f;
+	m_tex_x2 = 1.0f;
+	m_tex_y2 = 1.0f;
+
+	m_half_w = 0.0f;
+	m_half_h = 0.0f;
+	m_scale_offset_x = 0.0f;
+	m_scale_offset_y = 0.0f;
+	m_image_x = 0.0f;
+	m_image_y = 0.0f;
+	m_offset_x = 0.0f;
+	m_offset_y = 0.0f;
+	m_base_rot_x = 0.0f;
+	m_base_rot_y = 0.0f;
+	m_base_rot_z = 0.0f;
+
+	m_fade_size = 0;
+	m_fade_alpha = 0;
+	m_fade_color = 0;
+}
+
+cParticle_Seed_Request :: ~cParticle_Seed_Request( void )
+{
+
+}
+
+void cParticle_Seed_Request :: Draw( void )
+{
+	if( !m_buffer )
+	{
+		return;
+	}
+
+	Render_Basic();
+
+	// set camera position
+	if( !m_no_camera )
+	{
+		glTranslatef( -render_camera_x, -render_camera_y, 0.0f );
+	}
+
+	// Color Combine
+	pGL_State->Set_Combine( m_combine_type, m_combine_color );
+
+	pGL_State->Set_Texture_2D( 1 );
+	pGL_State->Bind_Texture( m_texture_id );
+
+	m_buffer->Draw( this );
+
+	// the current color is undefined after using a color array
+	pGL_State->Invalidate_Color();
+
+	Render_Basic_Clear();
+}
+
+Uint32 cParticle_Seed_Request :: Get_State_Key( void ) const
+{
+	// texture in the upper and blending in the lowest 8 bits
+	return ( static_cast<Uint32>(m_texture_id) << 8 ) | cRender_Request_Advanced::Get_State_Key();
+}
+
+/* *** *** *** *** *** *** cRender_Batch *** *** *** *** *** *** *** *** *** *** *** */
+
+cRender_Batch :: cRender_Batch( void )
+{
+	m_quad_count = 0;
+	m_shader = NULL;
+
+	m_texture_id = 0;
+	m_blend_sfactor = GL_SRC_ALPHA;
+	m_blend_dfactor = GL_ONE_MINUS_SRC_ALPHA;
+	m_combine_type = 0;
+	m_combine_color[0] = 0.0f;
+	m_combine_color[1] = 0.0f;
+	m_combine_color[2] = 0.0f;
+}
+
+cRender_Batch :: ~cRender_Batch( void )
+{
+
+}
+
+void cRender_Batch :: Begin( const cRender_Request_Advanced *obj, GLuint texture_id )
+{
+	Begin( texture_id, obj->m_blend_sfactor, obj->m_blend_dfactor, obj->m_combine_type, obj->m_combine_color );
+}
+
+void cRender_Batch :: Begin( GLuint texture_id, GLenum blend_sfactor, GLenum blend_dfactor, GLint combine_type, const float combine_color[3] )
+{
+	// the sprite shader sets the combine state per vertex
+	const bool same_combine = m_shader || ( m_combine_type == combine_type && ( m_combine_type == 0 || ( m_combine_color[0] == combine_color[0] &&
+		m_combine_color[1] == combine_color[1] && m_combine_color[2] == combine_color[2] ) ) );
+
+	// different state
+	if( !m_quad_count || m_texture_id != texture_id || m_blend_sfactor != blend_sfactor || m_blend_dfactor != blend_dfactor || !same_combine )
+	{
+		// draw the previous state
+		Flush();
+
+		m_texture_id = texture_id;
+		m_blend_sfactor = blend_sfactor;
+		m_blend_dfactor = blend_dfactor;
+	}
+
+	m_combine_type = combine_type;
+	m_combine_color[0] = combine_color[0];
+	m_combine_color[1] = combine_color[1];
+	m_combine_color[2] = combine_color[2];
+}
+
+void cRender_Batch :: Add_Quad( float x1, float y1, float x2, float y2, float z, const Color &color, float tex_x1 /* = 0.0f */, float tex_y1 /* = 0.0f */, float tex_x2 /* = 1.0f */, float tex_y2 /* = 1.0f */ )
+{
+	const GLfloat corners[12] =
+	{
+		// top left
+		x1, y1, z,
+		// top right
+		x2, y1, z,
+		// bottom right
+		x2, y2, z,
+		// bottom left
+		x1, y2, z
+	};
+
+	Add_Quad( corners, color, tex_x1, tex_y1, tex_x2, tex_y2 );
+}
+
+void cRender_Batch :: Add_Quad( const GLfloat corners[12], const Color &color, float tex_x1 /* = 0.0f */, float tex_y1 /* = 0.0f */, float tex_x2 /* = 1.0f */, float tex_y2 /* = 1.0f */ )
+{
+	m_vertices.insert( m_vertices.end(), corners, corners + 12 );
+
+	if( m_texture_id )
+	{
+		m_tex_coords.push_back( tex_x1 );
+		m_tex_coords.push_back( tex_y1 );
+		m_tex_coords.push_back( tex_x2 );
+		m_tex_coords.push_back( tex_y1 );
+		m_tex_coords.push_back( tex_x2 );
+		m_tex_coords.push_back( tex_y2 );
+		m_tex_coords.push_back( tex_x1 );
+		m_tex_coords.push_back( tex_y2 );
+	}
+
+	for( unsigned int i = 0; i < 4; i++ )
+	{
+		m_colors.push_back( color.red );
+		m_colors.push_back( color.green );
+		m_colors.push_back( color.blue );
+		m_colors.push_back( color.alpha );
+	}
+
+	// already transformed with the current combine state
+	if( m_shader )
+	{
+		const float combine_mode = cSprite_Shader::Get_Combine_Mode( m_combine_type );
+
+		for( unsigned int i = 0; i < 4; i++ )
+		{
+			m_corners.insert( m_corners.end(), 4, 0.0f );
+			m_rotations.insert( m_rotations.end(), 3, 0.0f );
+			m_combine.push_back( m_combine_color[0] );
+			m_combine.push_back( m_combine_color[1] );
+			m_combine.push_back( m_combine_color[2] );
+			m_combine.push_back( combine_mode );
+		}
+	}
+
+	m_quad_count++;
+}
+
+void cRender_Batch :: Add_Rotated_Quad( const cRender_Request_Advanced *obj, float x, float y, float w, float h, float scale_x, float scale_y, float scale_z, float z, const Color &color,
+	float tex_x1 /* = 0.0f */, float tex_y1 /* = 0.0f */, float tex_x2 /* = 1.0f */, float tex_y2 /* = 1.0f */ )
+{
+	// center in final screen coordinates
+	GL_rect rect;
+	obj->Get_Final_Rect( x, y, w, h, scale_x, scale_y, rect );
+	const float center_x = rect.m_x + ( rect.m_w / 2 );
+	const float center_y = rect.m_y + ( rect.m_h / 2 );
+
+	// the global scale is applied after the request scale as in cSurface_Request::Draw
+	if( obj->m_global_scale )
+	{
+		scale_x *= global_upscalex;
+		scale_y *= global_upscaley;
+	}
+
+	GLfloat corners[12];
+	Get_Rotated_Quad( w / 2, h / 2, obj->m_rot_x, obj->m_rot_y, obj->m_rot_z, corners );
+
+	for( unsigned int c = 0; c < 4; c++ )
+	{
+		corners[c * 3] = center_x + corners[c * 3] * scale_x;
+		corners[c * 3 + 1] = center_y + corners[c * 3 + 1] * scale_y;
+		corners[c * 3 + 2] = z + corners[c * 3 + 2] * scale_z;
+	}
+
+	Add_Quad( corners, color, tex_x1, tex_y1, tex_x2, tex_y2 );
+}
+
+void cRender_Batch :: Add_Sprite( const cRender_Request_Advanced *obj, float x, float y, float w, float h, float scale_x, float scale_y, float z, const Color &color, bool shadow,
+	float tex_x1 /* = 0.0f */, float tex_y1 /* = 0.0f */, float tex_x2 /* = 1.0f */, float tex_y2 /* = 1.0f */ )
+{
+	// get half the size
+	const float half_w = w / 2;
+	const float half_h = h / 2;
+	// position
+	float final_pos_x = x + ( half_w * scale_x );
+	float final_pos_y = y + ( half_h * scale_y );
+
+	Color final_color = color;
+	float combine[4] = { obj->m_combine_color[0], obj->m_combine_color[1], obj->m_combine_color[2], cSprite_Shader::Get_Combine_Mode( obj->m_combine_type ) };
+
+	// same as the shadow of cSurface_Request::Draw
+	if( shadow )
+	{
+		final_pos_x += obj->m_shadow_pos;
+		final_pos_y += obj->m_shadow_pos;
+		z -= 0.000001f;
+
+		// keep m_shadow_color alpha
+		final_color = black;
+		final_color.alpha = obj->m_shadow_color.alpha;
+
+		combine[0] = static_cast<float>(obj->m_shadow_color.red) / 260;
+		combine[1] = static_cast<float>(obj->m_shadow_color.green) / 260;
+		combine[2] = static_cast<float>(obj->m_shadow_color.blue) / 260;
+		combine[3] = cSprite_Shader::Get_Combine_Mode( GL_REPLACE );
+	}
+
+	// set camera position
+	if( !obj->m_no_camera )
+	{
+		final_pos_x -= render_camera_x;
+		final_pos_y -= render_camera_y;
+	}
+
+	// global scale
+	if( obj->m_global_scale )
+	{
+		final_pos_x *= global_upscalex;
+		final_pos_y *= global_upscaley;
+		scale_x *= global_upscalex;
+		scale_y *= global_upscaley;
+	}
+
+	// top left, top right, bottom right and bottom left
+	const float corners[8] = { -half_w, -half_h, half_w, -half_h, half_w, half_h, -half_w, half_h };
+
+	for( unsigned int i = 0; i < 4; i++ )
+	{
+		m_vertices.push_back( final_pos_x );
+		m_vertices.push_back( final_pos_y );
+		m_vertices.push_back( z );
+
+		m_corners.push_back( corners[i * 2] );
+		m_corners.push_back( corners[i * 2 + 1] );
+		m_corners.push_back( scale_x );
+		m_corners.push_back( scale_y );
+
+		m_rotations.push_back( obj->m_rot_x );
+		m_rotations.push_back( obj->m_rot_y );
+		m_rotations.push_back( obj->m_rot_z );
+
+		m_combine.insert( m_combine.end(), combine, combine + 4 );
+
+		m_colors.push_back( final_color.red );
+		m_colors.push_back( final_color.green );
+		m_colors.push_back( final_color.blue );
+		m_colors.push_back( final_color.alpha );
+	}
+
+	if( m_texture_id )
+	{
+		m_tex_coords.push_back( tex_x1 );
+		m_tex_coords.push_back( tex_y1 );
+		m_tex_coords.push_back( tex_x2 );
+		m_tex_coords.push_back( tex_y1 );
+		m_tex_coords.push_back( tex_x2 );
+		m_tex_coords.push_back( tex_y2 );
+		m_tex_coords.push_back( tex_x1 );
+		m_tex_coords.push_back( tex_y2 );
+	}
+
+	m_quad_count++;
+}
+
+void cRender_Batch :: Flush( void )
+{
+	if( !m_quad_count )
+	{
+		return;
+	}
+
+	// vertices are already transformed
+	glLoadIdentity();
+
+	// blend factor
+	pGL_State->Set_Blend_Func( m_blend_sfactor, m_blend_dfactor );
+
+	// the fragment shader replaces the texture combine
+	if( m_shader )
+	{
+		m_shader->Use( m_texture_id != 0, &m_corners[0], &m_rotations[0], &m_combine[0] );
+	}
+	// Color Combine
+	else
+	{
+		pGL_State->Set_Combine( m_combine_type, m_combine_color );
+	}
+
+	pGL_State->Set_Client_State( GL_VERTEX_ARRAY, 1 );
+	glVertexPointer( 3, GL_FLOAT, 0, &m_vertices[0] );
+	pGL_State->Set_Client_State( GL_COLOR_ARRAY, 1 );
+	glColorPointer( 4, GL_UNSIGNED_BYTE, 0, &m_colors[0] );
+
+	if( m_texture_id )
+	{
+		pGL_State->Set_Texture_2D( 1 );
+		pGL_State->Bind_Texture( m_texture_id );
+
+		pGL_State->Set_Client_State( GL_TEXTURE_COORD_ARRAY, 1 );
+		glTexCoordPointer( 2, GL_FLOAT, 0, &m_tex_coords[0] );
+	}
+	else
+	{
+		pGL_State->Set_Texture_2D( 0 );
+		pGL_State->Set_Client_State( GL_TEXTURE_COORD_ARRAY, 0 );
+	}
+
+	glDrawArrays( GL_QUADS, 0, m_quad_count * 4 );
+	pRender_Stats->Add_Draw_Call( m_quad_count * 4 );
+
+	if( m_shader )
+	{
+		m_shader->Unuse();
+	}
+
+	// the current color is undefined after using a color array
+	pGL_State->Invalidate_Color();
+
+	// keep the allocated memory for the next batch
+	m_vertices.clear();
+	m_tex_coords.clear();
+	m_colors.clear();
+	m_corners.clear();
+	m_rotations.clear();
+	m_combine.clear();
+	m_quad_count = 0;
+}
+
+/* *** *** *** *** *** *** cStatic_Geometry *** *** *** *** *** *** *** *** *** *** *** */
+
+cStatic_Geometry :: cStatic_Geometry( void )
+{
+	m_quad_count = 0;
+	m_pos_z = 0.0f;
+}
+
+cStatic_Geometry :: ~cStatic_Geometry( void )
+{
+
+}
+
+void cStatic_Geometry :: Add( const cSurface_Request *obj )
+{
+	// camera and global scale are not set
+	GL_rect rect;
+	obj->Get_Final_Rect( obj->m_pos_x, obj->m_pos_y, obj->m_w, obj->m_h, obj->m_scale_x, obj->m_scale_y, rect );
+
+	if( obj->m_tiles.empty() )
+	{
+		Add_Quad( obj, obj->m_texture_id, rect, obj->m_tex_x1, obj->m_tex_y1, obj->m_tex_x2, obj->m_tex_y2 );
+		return;
+	}
+
+	for( GL_Texture_Tile_List::const_iterator itr = obj->m_tiles.begin(); itr != obj->m_tiles.end(); ++itr )
+	{
+		GL_rect tile_rect;
+		cSurface_Request::Get_Tile_Rect( *itr, rect, tile_rect );
+
+		Add_Quad( obj, (*itr).m_texture_id, tile_rect, 0.0f, 0.0f, (*itr).m_tex_x2, (*itr).m_tex_y2 );
+	}
+}
+
+void cStatic_Geometry :: Add_Quad( const cSurface_Request *obj, GLuint texture_id, const GL_rect &rect, float tex_x1, float tex_y1, float tex_x2, float tex_y2 )
+{
+	// new part if the state differs from the last one
+	if( m_parts.empty() || m_parts.back().m_texture_id != texture_id || m_parts.back().m_blend_sfactor != obj->m_blend_sfactor ||
+		m_parts.back().m_blend_dfactor != obj->m_blend_dfactor || m_parts.back().m_combine_type != obj->m_combine_type ||
+		( obj->m_combine_type != 0 && ( m_parts.back().m_combine_color[0] != obj->m_combine_color[0] ||
+		m_parts.back().m_combine_color[1] != obj->m_combine_color[1] || m_parts.back().m_combine_color[2] != obj->m_combine_color[2] ) ) )
+	{
+		Part part;
+		part.m_texture_id = texture_id;
+		part.m_blend_sfactor = obj->m_blend_sfactor;
+		part.m_blend_dfactor = obj->m_blend_dfactor;
+		part.m_combine_type = obj->m_combine_type;
+		part.m_combine_color[0] = obj->m_combine_color[0];
+		part.m_combine_color[1] = obj->m_combine_color[1];
+		part.m_combine_color[2] = obj->m_combine_color[2];
+		part.m_start = m_quad_count;
+		part.m_count = 0;
+
+		m_parts.push_back( part );
+	}
+
+	m_parts.back().m_count++;
+
+	const float x1 = rect.m_x;
+	const float y1 = rect.m_y;
+	const float x2 = rect.m_x + rect.m_w;
+	const float y2 = rect.m_y + rect.m_h;
+	const float z = obj->m_pos_z;
+
+	// top left
+	m_vertices.push_back( x1 );
+	m_vertices.push_back( y1 );
+	m_vertices.push_back( z );
+	// top right
+	m_vertices.push_back( x2 );
+	m_vertices.push_back( y1 );
+	m_vertices.push_back( z );
+	// bottom right
+	m_vertices.push_back( x2 );
+	m_vertices.push_back( y2 );
+	m_vertices.push_back( z );
+	// bottom left
+	m_vertices.push_back( x1 );
+	m_vertices.push_back( y2 );
+	m_vertices.push_back( z );
+
+	m_tex_coords.push_back( tex_x1 );
+	m_tex_coords.push_back( tex_y1 );
+	m_tex_coords.push_back( tex_x2 );
+	m_tex_coords.push_back( tex_y1 );
+	m_tex_coords.push_back( tex_x2 );
+	m_tex_coords.push_back( tex_y2 );
+	m_tex_coords.push_back( tex_x1 );
+	m_tex_coords.push_back( tex_y2 );
+
+	for( unsigned int i = 0; i < 4; i++ )
+	{
+		m_colors.push_back( obj->m_color.red );
+		m_colors.push_back( obj->m_color.green );
+		m_colors.push_back( obj->m_color.blue );
+		m_colors.push_back( obj->m_color.alpha );
+	}
+
+	// update the rect
+	if( !m_quad_count )
+	{
+		m_rect = rect;
+		m_pos_z = z;
+	}
+	else
+	{
+		const float rect_x2 = m_rect.m_x + m_rect.m_w > x2 ? m_rect.m_x + m_rect.m_w : x2;
+		const float rect_y2 = m_rect.m_y + m_rect.m_h > y2 ? m_rect.m_y + m_rect.m_h : y2;
+
+		if( x1 < m_rect.m_x )
+		{
+			m_rect.m_x = x1;
+		}
+		if( y1 < m_rect.m_y )
+		{
+			m_rect.m_y = y1;
+		}
+
+		m_rect.m_w = rect_x2 - m_rect.m_x;
+		m_rect.m_h = rect_y2 - m_rect.m_y;
+
+		if( z < m_pos_z )
+		{
+			m_pos_z = z;
+		}
+	}
+
+	m_quad_count++;
+}
+
+void cStatic_Geometry :: Draw( void ) const
+{
+	if( !m_quad_count )
+	{
+		return;
+	}
+
+	// world coordinates
+	glLoadIdentity();
+	glScalef( global_upscalex, global_upscaley, 1.0f );
+	glTranslatef( -render_camera_x, -render_camera_y, 0.0f );
+
+	pGL_State->Set_Client_State( GL_VERTEX_ARRAY, 1 );
+	glVertexPointer( 3, GL_FLOAT, 0, &m_vertices[0] );
+	pGL_State->Set_Client_State( GL_COLOR_ARRAY, 1 );
+	glColorPointer( 4, GL_UNSIGNED_BYTE, 0, &m_colors[0] );
+	pGL_State->Set_Client_State( GL_TEXTURE_COORD_ARRAY, 1 );
+	glTexCoordPointer( 2, GL_FLOAT, 0, &m_tex_coords[0] );
+
+	pGL_State->Set_Texture_2D( 1 );
+
+	for( Part_List::const_iterator itr = m_parts.begin(); itr != m_parts.end(); ++itr )
+	{
+		const Part &part = (*itr);
+
+		pGL_State->Set_Blend_Func( part.m_blend_sfactor, part.m_blend_dfactor );
+		pGL_State->Set_Combine( part.m_combine_type, part.m_combine_color );
+		pGL_State->Bind_Texture( part.m_texture_id );
+
+		glDrawArrays( GL_QUADS, part.m_start * 4, part.m_count * 4 );
+		pRender_Stats->Add_Draw_Call( part.m_count * 4 );
+	}
+
+	// the current color is undefined after using a color array
+	pGL_State->Invalidate_Color();
+}
+
+/* *** *** *** *** *** *** cRender_Request_Pool *** *** *** *** *** *** *** *** *** *** *** */
+
+/* size header in front of every block
+ * uses the size of a double to keep the alignment
+*/
+static const size_t pool_header_size = sizeof(double) > sizeof(size_t) ? sizeof(double) : sizeof(size_t);
+// memory of all requests including the free lists
+static cMemory_Counter render_request_memory( "Render Requests" );
+
+cRender_Request_Pool :: cRender_Request_Pool( void )
+{
+	m_reused_count = 0;
+	m_allocated_count = 0;
+}
+
+cRender_Request_Pool :: ~cRender_Request_Pool( void )
+{
+	Clear();
+}
+
+void *cRender_Request_Pool :: Get( size_t size )
+{
+	for( Free_List_List::iterator itr = m_free_lists.begin(); itr != m_free_lists.end(); ++itr )
+	{
+		Free_List &free_list = (*itr);
+
+		if( free_list.m_size != size )
+		{
+			continue;
+		}
+
+		if( free_list.m_blocks.empty() )
+		{
+			break;
+		}
+
+		void *ptr = free_list.m_blocks.back();
+		free_list.m_blocks.pop_back();
+		m_reused_count++;
+		return ptr;
+	}
+
+	m_allocated_count++;
+	return Allocate( size );
+}
+
+void cRender_Request_Pool :: Recycle( cRender_Request *obj )
+{
+	const size_t size = *reinterpret_cast<size_t *>(reinterpret_cast<char *>(obj) - pool_header_size);
+
+	// destroy but keep the memory
+	obj->~cRender_Request();
+
+	for( Free_List_List::iterator itr = m_free_lists.begin(); itr != m_free_lists.end(); ++itr )
+	{
+		Free_List &free_list = (*itr);
+
+		if( free_list.m_size == size )
+		{
+			free_list.m_blocks.push_back( obj );
+			return;
+		}
+	}
+
+	// first block of this size
+	Free_List free_list;
+	free_list.m_size = size;
+	free_list.m_blocks.push_back( obj );
+	m_free_lists.push_back( free_list );
+}
+
+void cRender_Request_Pool :: Clear( void )
+{
+	for( Free_List_List::iterator itr = m_free_lists.begin(); itr != m_free_lists.end(); ++itr )
+	{
+		Free_List &free_list = (*itr);
+
+		for( vector<void *>::iterator block_itr = free_list.m_blocks.begin(); block_itr != free_list.m_blocks.end(); ++block_itr )
+		{
+			Free( *block_itr );
+		}
+	}
+
+	m_free_lists.clear();
+}
+
+void *cRender_Request_Pool :: Allocate( size_t size )
+{
+	render_request_memory.Add( size + pool_header_size );
+
+	char *block = static_cast<char *>(::operator new( size + pool_header_size ));
+	*reinterpret_cast<size_t *>(block) = size;
+
+	return block + pool_header_size;
+}
+
+void cRender_Request_Pool :: Free( void *ptr )
+{
+	if( !ptr )
+	{
+		return;
+	}
+
+	char *block = static_cast<char *>(ptr) - pool_header_size;
+	render_request_memory.Remove( *reinterpret_cast<size_t *>(block) + pool_header_size );
+
+	::operator delete( block );
+}
+
+/* *** *** *** *** *** *** cRender_Stats *** *** *** *** *** *** *** *** *** *** *** */
+
+void Render_Counts :: Clear( void )
+{
+	for( unsigned int i = 0; i < RENDER_TYPE_COUNT; i++ )
+	{
+		m_requests[i] = 0;
+	}
+
+	m_culled = 0;
+	m_draw_calls = 0;
+	m_vertices = 0;
+	m_texture_binds = 0;
+	m_state_changes = 0;
+	m_avoided_state_changes = 0;
+	m_carried_over = 0;
+}
+
+cRender_Stats :: cRender_Stats( void )
+{
+	m_current.Clear();
+	m_last.Clear();
+}
+
+cRender_Stats :: ~cRender_Stats( void )
+{
+
+}
+
+void cRender_Stats :: Add_Request( RenderType type, unsigned int count /* = 1 */ )
+{
+	if( static_cast<unsigned int>(type) >= RENDER_TYPE_COUNT )
+	{
+		return;
+	}
+
+	m_current.m_requests[type] += count;
+}
+
+void cRender_Stats :: Frame_Finished( void )
+{
+	m_last = m_current;
+	m_current.Clear();
+}
+
+unsigned int cRender_Stats :: Get_Request_Count( void ) const
+{
+	unsigned int count = 0;
+
+	for( unsigned int i = 0; i < RENDER_TYPE_COUNT; i++ )
+	{
+		count += m_last.m_requests[i];
+	}
+
+	return count;
+}
+
+unsigned int cRender_Stats :: Get_Request_Count( RenderType type ) const
+{
+	if( static_cast<unsigned int>(type) >= RENDER_TYPE_COUNT )
+	{
+		return 0;
+	}
+
+	return m_last.m_requests[type];
+}
+
+/* *** *** *** *** *** *** cRenderQueue *** *** *** *** *** *** *** *** *** *** *** */
+
+cRenderQueue :: cRenderQueue( unsigned int reserve_items )
+{
+	m_render_data.reserve( reserve_items );
+	m_retained.reserve( 64 );
+	m_commands.reserve( reserve_items );
+	m_commands_temp.reserve( reserve_items );
+	m_sort_data.reserve( reserve_items );
+	m_sort_temp.reserve( reserve_items );
+	m_command_requests = 0;
+	m_command_stream = 1;
+	m_batching = 1;
+	m_grouping = 1;
+	m_culling = 1;
+	m_opaque_pass = 1;
+
+	m_camera_x = 0.0f;
+	m_camera_y = 0.0f;
+	m_camera_saved = 0;
+}
+
+cRenderQueue :: ~cRenderQueue( void )
+{
+	Clear();
+	m_pool.Clear();
+}
+
+void cRenderQueue :: Add( cRender_Request *obj )
+{
+	if( !obj )
+	{
+		return;
+	}
+
+	cRender_Capture *capture = cRender_Capture::Get_Current();
+
+	// added by another thread
+	if( capture && capture->m_queue == this )
+	{
+		capture->Add( obj );
+		return;
+	}
+
+	// if no type
+	if( obj->m_type == REND_NOTHING )
+	{
+		delete obj;
+		return;
+	}
+
+	Render_Command command;
+
+	// the request is only needed to build the command
+	if( m_command_stream && obj->m_render_count == 1 && obj->Get_Command( command ) )
+	{
+		m_commands.push_back( command );
+		m_pool.Recycle( obj );
+		return;
+	}
+
+	// the sort data is read when prepared
+	if( m_command_stream )
+	{
+		command.m_type = COMMAND_REQUEST;
+		command.m_request = obj;
+		m_commands.push_back( command );
+		m_command_requests++;
+	}
+
+	m_render_data.push_back( obj );
+}
+
+void cRenderQueue :: Add_Commands( const Render_Command *itr, const Render_Command *end )
+{
+	for( ; itr != end; ++itr )
+	{
+		if( itr->m_type == COMMAND_REQUEST )
+		{
+			m_render_data.push_back( itr->m_request );
+
+			// the sort data is read when prepared
+			if( !m_command_stream )
+			{
+				continue;
+			}
+
+			m_command_requests++;
+		}
+
+		m_commands.push_back( *itr );
+	}
+}
+
+void cRenderQueue :: Save_Camera( void )
+{
+	m_camera_x = pActive_Camera->m_x;
+	m_camera_y = pActive_Camera->m_y;
+	m_camera_saved = 1;
+}
+
+void cRenderQueue :: Prepare_Commands( void )
+{
+	// requests kept by a rendering without clearing or added without the command stream
+	const unsigned int missing = m_render_data.size() - m_command_requests;
+	Render_Command command;
+	command.m_type = COMMAND_REQUEST;
+
+	// appended as the sort sets the order
+	for( unsigned int i = 0; i < missing; i++ )
+	{
+		command.m_request = m_render_data[i];
+		m_commands.push_back( command );
+	}
+
+	for( RenderList::const_iterator itr = m_retained.begin(); itr != m_retained.end(); ++itr )
+	{
+		command.m_request = (*itr);
+		m_commands.push_back( command );
+	}
+
+	m_command_requests = m_render_data.size();
+
+	for( Render_Command_List::iterator itr = m_commands.begin(); itr != m_commands.end(); ++itr )
+	{
+		Render_Command &command = (*itr);
+
+		if( command.m_type == COMMAND_REQUEST )
+		{
+			const cRender_Request *obj = command.m_request;
+
+			command.m_key = ( static_cast<Uint64>(Float_To_Sort_Key( obj->m_pos_z )) << 32 ) | obj->Get_State_Key();
+			command.m_pos_z = obj->m_pos_z;
+			command.m_render_type = static_cast<Uint8>(obj->m_type);
+			command.m_flags = 0;
+
+			GL_rect rect;
+
+			if( obj->Get_Bounds( rect ) )
+			{
+				command.m_flags |= COMMAND_FLAG_BOUNDS;
+				command.m_x1 = rect.m_x;
+				command.m_y1 = rect.m_y;
+				command.m_x2 = rect.m_x + rect.m_w;
+				command.m_y2 = rect.m_y + rect.m_h;
+			}
+
+			if( obj->Is_Opaque() )
+			{
+				command.m_flags |= COMMAND_FLAG_OPAQUE;
+			}
+
+			continue;
+		}
+
+		// same as cRender_Request_Advanced::Get_Final_Rect
+		if( !( command.m_flags & COMMAND_FLAG_NO_CAMERA ) )
+		{
+			command.m_x1 -= render_camera_x;
+			command.m_y1 -= render_camera_y;
+			command.m_x2 -= render_camera_x;
+			command.m_y2 -= render_camera_y;
+		}
+
+		if( command.m_flags & COMMAND_FLAG_GLOBAL_SCALE )
+		{
+			command.m_x1 *= global_upscalex;
+			command.m_y1 *= global_upscaley;
+			command.m_x2 *= global_upscalex;
+			command.m_y2 *= global_upscaley;
+		}
+	}
+}
+
+void cRenderQueue :: Render( bool clear /* = 1 */ )
+{
+	// use the current camera if not saved
+	if( !m_camera_saved )
+	{
+		Save_Camera();
+	}
+
+	render_camera_x = m_camera_x;
+	render_camera_y = m_camera_y;
+	m_camera_saved = 0;
+
+	// the shader can only change while the render thread is idle
+	m_batch.m_shader = pVideo->m_sprite_shader;
+
+	Prepare_Commands();
+
+	// remove the commands outside of the screen
+	if( m_culling )
+	{
+		Cull();
+	}
+
+	// z position and state sort
+	Sort();
+	// opengl could have been used directly since the last rendering
+	pGL_State->Invalidate();
+
+	const bool overdraw = game_debug_overdraw && Begin_Overdraw();
+
+	if( m_opaque_pass )
+	{
+		Render_Opaque();
+	}
+
+	// measure the phases in the z order
+	cGPU_Timer *gpu_timer = pVideo->m_gpu_timer && pVideo->m_gpu_timer->Is_Active() ? pVideo->m_gpu_timer : NULL;
+
+	if( !m_commands.empty() )
+	{
+		Render_Commands( &m_commands[0], &m_commands[0] + m_commands.size(), gpu_timer );
+	}
+
+	// draw the remaining batch
+	m_batch.Flush();
+
+	if( gpu_timer )
+	{
+		gpu_timer->End();
+	}
+
+	if( overdraw )
+	{
+		Draw_Overdraw();
+	}
+
+	// leave the default state for direct opengl usage like the gui
+	pGL_State->Set_Default();
+
+	// the kept requests get new commands with the next rendering
+	m_commands.clear();
+	m_command_requests = 0;
+
 	if( clear )
 	{
 		Clear( 0 );
 	}
 }
 
+void cRenderQueue :: Render_Commands( const Render_Command *itr, const Render_Command *end, cGPU_Timer *gpu_timer /* = NULL */ )
+{
+	while( itr != end )
+	{
+		const Uint8 type = itr->m_type;
+		GPU_Phase phase = GPU_PHASE_COUNT;
+
+		if( gpu_timer )
+		{
+			phase = cGPU_Timer::Get_Phase( itr->m_pos_z );
+
+			// the batch belongs to the previous phase
+			if( phase != gpu_timer->Get_Current_Phase() )
+			{
+				m_batch.Flush();
+				gpu_timer->Begin( phase );
+			}
+		}
+
+		// commands of the same type in the same phase
+		const Render_Command *run_end = itr + 1;
+
+		while( run_end != end && run_end->m_type == type && ( !gpu_timer || cGPU_Timer::Get_Phase( run_end->m_pos_z ) == phase ) )
+		{
+			++run_end;
+		}
+
+		if( type == COMMAND_TEXTURE_QUAD )
+		{
+			Render_Quad_Commands<1>( m_batch, itr, run_end );
+		}
+		else if( type == COMMAND_COLOR_QUAD )
+		{
+			Render_Quad_Commands<0>( m_batch, itr, run_end );
+		}
+		else
+		{
+			for( ; itr != run_end; ++itr )
+			{
+				Render_Request( itr->m_request );
+			}
+		}
+
+		itr = run_end;
+	}
+}
+
+void cRenderQueue :: Render_Request( cRender_Request *obj )
+{
+	pRender_Stats->Add_Request( obj->m_type );
+
+	// collect into the batch
+	if( m_batching && ( obj->Is_Batchable( m_batch.m_shader != NULL ) || ( !m_batch.m_shader && obj->Is_Batchable_Rotated() ) ) )
+	{
+		obj->Add_To_Batch( m_batch );
+	}
+	// draw directly
+	else
+	{
+		// keep the order
+		m_batch.Flush();
+		obj->Draw();
+	}
+
+	obj->m_render_count--;
+
+	// rendered again with the next frame
+	if( obj->m_render_count > 0 )
+	{
+		pRender_Stats->m_current.m_carried_over++;
+	}
+}
+
+void cRenderQueue :: Render_Opaque( void )
+{
+	const unsigned int count = m_commands.size();
+	// commands up to the last clear are drawn first as the clear would remove the opaque pass
+	unsigned int start = 0;
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		if( m_commands[i].m_render_type == REND_CLEAR )
+		{
+			start = i + 1;
+		}
+	}
+
+	if( start )
+	{
+		Render_Commands( &m_commands[0], &m_commands[0] + start );
+	}
+
+	// move the opaque commands
+	m_commands_temp.clear();
+	unsigned int keep = 0;
+
+	for( unsigned int i = start; i < count; i++ )
+	{
+		const Render_Command &command = m_commands[i];
+
+		if( command.m_flags & COMMAND_FLAG_OPAQUE )
+		{
+			m_commands_temp.push_back( command );
+			continue;
+		}
+
+		m_commands[keep] = command;
+		keep++;
+	}
+
+	m_commands.resize( keep );
+
+	if( m_commands_temp.empty() )
+	{
+		return;
+	}
+
+	m_batch.Flush();
+	// fully opaque pixels are the same without blending
+	glDisable( GL_BLEND );
+
+	// front to back
+	std::reverse( m_commands_temp.begin(), m_commands_temp.end() );
+	Render_Commands( &m_commands_temp[0], &m_commands_temp[0] + m_commands_temp.size() );
+
+	m_batch.Flush();
+	glEnable( GL_BLEND );
+
+	m_commands_temp.clear();
+}
+
+bool cRenderQueue :: Begin_Overdraw( void ) const
+{
+	// a render target can be without stencil buffer
+	GLint stencil_bits = 0;
+	glGetIntegerv( GL_STENCIL_BITS, &stencil_bits );
+
+	if( stencil_bits <= 0 )
+	{
+		return 0;
+	}
+
+	glClearStencil( 0 );
+	glClear( GL_STENCIL_BUFFER_BIT );
+
+	// count every fragment which passed the alpha and depth test
+	glEnable( GL_STENCIL_TEST );
+	glStencilFunc( GL_ALWAYS, 0, 0xFF );
+	glStencilOp( GL_KEEP, GL_KEEP, GL_INCR );
+
+	return 1;
+}
+
+void cRenderQueue :: Draw_Overdraw( void ) const
+{
+	// heatmap colors from not drawn to drawn 8 or more times
+	static const Color overdraw_colors[] = {
+		Color( static_cast<Uint8>(0), 0, 0 ),
+		Color( static_cast<Uint8>(0), 0, 128 ),
+		Color( static_cast<Uint8>(0), 0, 255 ),
+		Color( static_cast<Uint8>(0), 160, 0 ),
+		Color( static_cast<Uint8>(160), 220, 0 ),
+		Color( static_cast<Uint8>(255), 255, 0 ),
+		Color( static_cast<Uint8>(255), 128, 0 ),
+		Color( static_cast<Uint8>(255), 0, 0 ),
+		Color( static_cast<Uint8>(255), 255, 255 ) };
+	const unsigned int color_count = sizeof( overdraw_colors ) / sizeof( overdraw_colors[0] );
+
+	const float width = static_cast<float>(pPreferences->m_video_screen_w);
+	const float height = static_cast<float>(pPreferences->m_video_screen_h);
+
+	glStencilOp( GL_KEEP, GL_KEEP, GL_KEEP );
+	glDisable( GL_DEPTH_TEST );
+	glLoadIdentity();
+
+	pGL_State->Set_Texture_2D( 0 );
+
+	for( unsigned int i = 0; i < color_count; i++ )
+	{
+		// the last color is used for all higher counts
+		glStencilFunc( i + 1 < color_count ? GL_EQUAL : GL_LEQUAL, i, 0xFF );
+		pGL_State->Set_Color( overdraw_colors[i] );
+
+		glBegin( GL_QUADS );
+			glVertex2f( 0.0f, 0.0f );
+			glVertex2f( width, 0.0f );
+			glVertex2f( width, height );
+			glVertex2f( 0.0f, height );
+		glEnd();
+		pRender_Stats->Add_Draw_Call( 4 );
+	}
+
+	glEnable( GL_DEPTH_TEST );
+	glDisable( GL_STENCIL_TEST );
+}
+
 void cRenderQueue :: Fake_Render( unsigned int amount /* = 1 */, bool clear /* = 1 */ )
 {
 	for( RenderList::iterator itr = m_render_data.begin(); itr != m_render_data.end(); ++itr )
@@ -755,36 +2710,327 @@ void cRenderQueue :: Fake_Render( unsigned int amount /* = 1 */, bool clear /* =
 		obj->m_render_count -= amount;
 	}
 
+	for( RenderList::iterator itr = m_retained.begin(); itr != m_retained.end(); ++itr )
+	{
+		cRender_Request *obj = (*itr);
+		obj->m_render_count -= amount;
+	}
+
+	// the quads are only rendered once
+	m_commands.clear();
+	m_command_requests = 0;
+
 	if( clear )
 	{
 		Clear( 0 );
 	}
 }
 
+void cRenderQueue :: Cull( void )
+{
+	// the final request coordinates are in screen pixels
+	const GL_rect screen_rect( 0.0f, 0.0f, static_cast<float>(pPreferences->m_video_screen_w), static_cast<float>(pPreferences->m_video_screen_h) );
+
+	const unsigned int count = m_commands.size();
+	unsigned int keep = 0;
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		const Render_Command &command = m_commands[i];
+
+		// commands without bounds are always drawn
+		if( ( command.m_flags & COMMAND_FLAG_BOUNDS ) && !Is_Rect_Overlapping( Get_Command_Rect( command ), screen_rect ) )
+		{
+			// culled requests count as rendered
+			if( command.m_type == COMMAND_REQUEST )
+			{
+				cRender_Request *obj = command.m_request;
+				obj->m_render_count--;
+
+				// rendered again with the next frame
+				if( obj->m_render_count > 0 )
+				{
+					pRender_Stats->m_current.m_carried_over++;
+				}
+			}
+
+			continue;
+		}
+
+		if( keep != i )
+		{
+			m_commands[keep] = command;
+		}
+
+		keep++;
+	}
+
+	m_commands.resize( keep );
+	pRender_Stats->m_current.m_culled += count - keep;
+}
+
+void cRenderQueue :: Sort( void )
+{
+	const unsigned int count = m_commands.size();
+
+	if( count < 2 )
+	{
+		return;
+	}
+
+	m_sort_data.resize( count );
+	m_sort_temp.resize( count );
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		Sort_Entry &entry = m_sort_data[i];
+
+		entry.m_key = m_commands[i].m_key;
+		entry.m_index = i;
+	}
+
+	/* stable radix sort with 8 bits per pass
+	 * a pass is skipped if all keys have the same byte
+	*/
+	for( unsigned int shift = 0; shift < 64; shift += 8 )
+	{
+		unsigned int histogram[256] = { 0 };
+
+		for( unsigned int i = 0; i < count; i++ )
+		{
+			histogram[( m_sort_data[i].m_key >> shift ) & 0xFF]++;
+		}
+
+		// all in the same bucket
+		if( histogram[( m_sort_data[0].m_key >> shift ) & 0xFF] == count )
+		{
+			continue;
+		}
+
+		unsigned int offset = 0;
+
+		for( unsigned int i = 0; i < 256; i++ )
+		{
+			const unsigned int bucket_count = histogram[i];
+			histogram[i] = offset;
+			offset += bucket_count;
+		}
+
+		for( unsigned int i = 0; i < count; i++ )
+		{
+			m_sort_temp[histogram[( m_sort_data[i].m_key >> shift ) & 0xFF]++] = m_sort_data[i];
+		}
+
+		m_sort_data.swap( m_sort_temp );
+	}
+
+	/* group by state
+	 * a command is moved back to the last command with the same state in its z layer
+	 * if it does not overlap any command in between
+	*/
+	if( m_grouping )
+	{
+		m_sort_temp.clear();
+
+		for( unsigned int i = 0; i < count; i++ )
+		{
+			Sort_Entry entry = m_sort_data[i];
+			const Render_Command &command = m_commands[entry.m_index];
+
+			entry.m_layer = static_cast<int>(floor( command.m_pos_z * 100.0f ));
+
+			unsigned int insert_pos = m_sort_temp.size();
+
+			if( command.m_flags & COMMAND_FLAG_BOUNDS )
+			{
+				const GL_rect rect = Get_Command_Rect( command );
+				const Uint32 state = static_cast<Uint32>(entry.m_key);
+				unsigned int pos = m_sort_temp.size();
+
+				for( unsigned int steps = 0; pos > 0 && steps < render_group_window; steps++, pos-- )
+				{
+					const Sort_Entry &prev = m_sort_temp[pos - 1];
+
+					// only inside the same layer
+					if( prev.m_layer != entry.m_layer )
+					{
+						break;
+					}
+					// found
+					if( static_cast<Uint32>(prev.m_key) == state )
+					{
+						insert_pos = pos;
+						break;
+					}
+
+					const Render_Command &prev_command = m_commands[prev.m_index];
+
+					// can not be passed
+					if( !( prev_command.m_flags & COMMAND_FLAG_BOUNDS ) || Is_Rect_Overlapping( Get_Command_Rect( prev_command ), rect ) )
+					{
+						break;
+					}
+				}
+			}
+
+			m_sort_temp.insert( m_sort_temp.begin() + insert_pos, entry );
+		}
+
+		m_sort_data.swap( m_sort_temp );
+	}
+
+	// move the commands into the sorted order
+	m_commands_temp.resize( count );
+
+	for( unsigned int i = 0; i < count; i++ )
+	{
+		m_commands_temp[i] = m_commands[m_sort_data[i].m_index];
+	}
+
+	m_commands.swap( m_commands_temp );
+	m_commands_temp.clear();
+}
+
 void cRenderQueue :: Clear( bool force /* = 1 */ )
 {
-	for( RenderList::iterator itr = m_render_data.begin(); itr != m_render_data.end(); )
+	// the quads are finished and the kept requests get new commands
+	m_commands.clear();
+	m_command_requests = 0;
+
+	// remove the finished retained requests in one pass
+	RenderList::iterator itr_keep = m_retained.begin();
+
+	for( RenderList::iterator itr = m_retained.begin(); itr != m_retained.end(); ++itr )
+	{
+		cRender_Request *obj = (*itr);
+
+		// if forced or finished rendering
+		if( force || obj->m_render_count <= 0 )
+		{
+			m_pool.Recycle( obj );
+		}
+		// keep
+		else
+		{
+			*itr_keep = obj;
+			++itr_keep;
+		}
+	}
+
+	m_retained.erase( itr_keep, m_retained.end() );
+
+	// requests which should render again are retained
+	for( RenderList::iterator itr = m_render_data.begin(); itr != m_render_data.end(); ++itr )
 	{
 		cRender_Request *obj = (*itr);
 
 		// if forced or finished rendering
 		if( force || obj->m_render_count <= 0 )
 		{
-			itr = m_render_data.erase( itr );
-			delete obj;
+			m_pool.Recycle( obj );
 		}
-		// increment
 		else
 		{
-			++itr;
+			m_retained.push_back( obj );
+		}
+	}
+
+	m_render_data.clear();
+}
+
+void cRenderQueue :: Move_Retained( cRenderQueue *queue )
+{
+	if( queue->m_retained.empty() )
+	{
+		return;
+	}
+
+	if( m_retained.empty() )
+	{
+		m_retained.swap( queue->m_retained );
+		return;
+	}
+
+	m_retained.insert( m_retained.end(), queue->m_retained.begin(), queue->m_retained.end() );
+	queue->m_retained.clear();
+}
+
+/* *** *** *** *** *** *** cRender_Capture *** *** *** *** *** *** *** *** *** *** *** */
+
+boost::thread_specific_ptr<cRender_Capture> cRender_Capture :: m_current( &cRender_Capture::No_Cleanup );
+
+cRender_Capture :: cRender_Capture( void )
+{
+	m_queue = NULL;
+}
+
+cRender_Capture :: ~cRender_Capture( void )
+{
+	// not submitted requests
+	for( Render_Command_List::iterator itr = m_commands.begin(); itr != m_commands.end(); ++itr )
+	{
+		if( (*itr).m_type == COMMAND_REQUEST )
+		{
+			delete (*itr).m_request;
 		}
 	}
 }
 
+void cRender_Capture :: Begin( cRenderQueue *queue )
+{
+	m_queue = queue;
+	m_current.reset( this );
+}
+
+void cRender_Capture :: End( void )
+{
+	m_current.reset();
+}
+
+void cRender_Capture :: Add( cRender_Request *obj )
+{
+	// if no type
+	if( obj->m_type == REND_NOTHING )
+	{
+		delete obj;
+		return;
+	}
+
+	Render_Command command;
+
+	// the request is only needed to build the command
+	if( m_queue->m_command_stream && obj->m_render_count == 1 && obj->Get_Command( command ) )
+	{
+		m_commands.push_back( command );
+		// not recycled as the pool is only used by the main thread
+		delete obj;
+		return;
+	}
+
+	command.m_type = COMMAND_REQUEST;
+	command.m_request = obj;
+	m_commands.push_back( command );
+}
+
+void cRender_Capture :: Submit( void )
+{
+	if( !m_commands.empty() )
+	{
+		m_queue->Add_Commands( &m_commands[0], &m_commands[0] + m_commands.size() );
+		m_commands.clear();
+	}
+}
+
+void cRender_Capture :: No_Cleanup( cRender_Capture *capture )
+{
+	// the capture is owned by its creator
+}
+
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
 cRenderQueue *pRenderer = NULL;
 cRenderQueue *pRenderer_current = NULL;
+cRender_Stats *pRender_Stats = NULL;
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
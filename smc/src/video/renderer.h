@@ -17,8 +17,12 @@
 #define SMC_RENDERER_H
 
 #include "../video/video.h"
+#include "../video/gl_surface.h"
 #include "../core/math/line.h"
 #include "../core/math/rect.h"
+#include "../video/particle_shader.h"
+// boost
+#include <boost/thread/tss.hpp>
 
 namespace SMC
 {
@@ -34,9 +38,99 @@ enum RenderType
 	REND_SURFACE = 4,
 	REND_TEXT = 5, // todo
 	REND_LINE = 6,
-	REND_CIRCLE = 7
+	REND_CIRCLE = 7,
+	REND_STATIC = 8,
+	REND_QUAD_STREAM = 9,
+	REND_PARTICLE_SEED = 10,
+	REND_LAYER = 11,
+	REND_LINE_STREAM = 12
 };
 
+class cRender_Batch;
+class cStatic_Geometry;
+class cRender_Request;
+
+/* *** *** *** *** *** *** Render_Command *** *** *** *** *** *** *** *** *** *** *** */
+
+enum Render_Command_Type
+{
+	// request drawn with its virtual functions
+	COMMAND_REQUEST = 0,
+	// untextured quad copied from a rect request
+	COMMAND_COLOR_QUAD = 1,
+	// textured quad copied from a surface request
+	COMMAND_TEXTURE_QUAD = 2
+};
+
+enum Render_Command_Flags
+{
+	// the corners are the drawn area
+	COMMAND_FLAG_BOUNDS = 1,
+	// can be drawn in the opaque pass
+	COMMAND_FLAG_OPAQUE = 2,
+	// the camera position is not subtracted
+	COMMAND_FLAG_NO_CAMERA = 4,
+	// the global scale is applied
+	COMMAND_FLAG_GLOBAL_SCALE = 8
+};
+
+// quad without rotation and shadow which is always batchable
+struct Render_Quad_Command
+{
+	// texture id or 0
+	GLuint m_texture_id;
+	// texture coordinates
+	float m_tex_x1;
+	float m_tex_y1;
+	float m_tex_x2;
+	float m_tex_y2;
+	// color (r, g, b, a)
+	Uint8 m_color[4];
+	// blending
+	GLenum m_blend_sfactor;
+	GLenum m_blend_dfactor;
+	// combine type and color
+	GLint m_combine_type;
+	float m_combine_color[3];
+};
+
+/* Render data in a plain array entry with its sort key
+ * plain quads are copied in when added and their request is recycled at once
+ * other requests are referenced and asked for their sort data once per rendering
+ * so culling, sorting and drawing walk contiguous memory
+*/
+struct Render_Command
+{
+	// z position in the high and state in the low 32 bits
+	Uint64 m_key;
+	// z position
+	float m_pos_z;
+	/* corners of the quad or the bounds of the request
+	 * quads are in request coordinates until prepared and then in final screen coordinates
+	 * flipped quads have the higher coordinate first
+	*/
+	float m_x1;
+	float m_y1;
+	float m_x2;
+	float m_y2;
+	// Render_Command_Type
+	Uint8 m_type;
+	// RenderType of the request for the statistics
+	Uint8 m_render_type;
+	// Render_Command_Flags
+	Uint8 m_flags;
+
+	union
+	{
+		// COMMAND_REQUEST
+		cRender_Request *m_request;
+		// COMMAND_COLOR_QUAD and COMMAND_TEXTURE_QUAD
+		Render_Quad_Command m_quad;
+	};
+};
+
+typedef vector<Render_Command> Render_Command_List;
+
 /* *** *** *** *** *** *** cRender_Request *** *** *** *** *** *** *** *** *** *** *** */
 
 class cRender_Request
@@ -45,9 +139,39 @@ public:
 	cRender_Request( void );
 	virtual ~cRender_Request( void );
 
+	// allocate from the free list of the renderer
+	static void *operator new( size_t size );
+	// free without using the renderer free list
+	static void operator delete( void *ptr );
+
 	// draw
 	virtual void Draw( void );
 
+	/* if set the request can be drawn with Add_To_Batch instead of Draw
+	 * shader : if the batch uses the sprite shader which also handles rotation and shadow
+	*/
+	virtual bool Is_Batchable( bool shader = 0 ) const;
+	/* if set the rotated request can be drawn with Add_To_Batch without the sprite shader
+	 * the batch rotates its vertices instead of the matrix
+	*/
+	virtual bool Is_Batchable_Rotated( void ) const;
+	// add the pre-transformed request data to the batch
+	virtual void Add_To_Batch( cRender_Batch &batch ) const;
+	/* Get the drawn area in final screen coordinates
+	 * returns false if the area is unknown
+	*/
+	virtual bool Get_Bounds( GL_rect &rect ) const;
+	// returns the texture and blend state used for sorting
+	virtual Uint32 Get_State_Key( void ) const;
+	/* if set every drawn pixel is fully opaque with the default blending
+	 * and the request can be drawn front to back without blending
+	*/
+	virtual bool Is_Opaque( void ) const;
+	/* Copy the request into the command if it can be drawn as plain quad
+	 * returns false if the request must be kept
+	*/
+	virtual bool Get_Command( Render_Command &command ) const;
+
 	// render type
 	RenderType m_type;
 	// Z position
@@ -85,8 +209,25 @@ public:
 
 	// render advanced state
 	void Render_Advanced( void );
-	// clear advanced render state
-	void Render_Advanced_Clear( void ) const;
+
+	/* returns true if no rotation and shadow is set
+	 * shader : if set only the combine type must be supported by the sprite shader
+	*/
+	bool Is_Batchable_Basic( bool shader = 0 ) const;
+	/* Set the rect in final screen coordinates
+	 * the size is scaled and the camera and global scale are applied
+	*/
+	void Get_Final_Rect( float x, float y, float w, float h, float scale_x, float scale_y, GL_rect &rect ) const;
+	// returns the blend and combine state
+	virtual Uint32 Get_State_Key( void ) const;
+	// returns true if the default blending is used and no shadow is set
+	bool Is_Opaque_Basic( void ) const;
+	/* Copy the basic state into a quad command
+	 * returns false if rotation, shadow or a combine type the sprite shader does not support is set
+	 * x, y : top left position before scaling
+	 * w, h : size before scaling
+	*/
+	bool Get_Quad_Command( Render_Command &command, GLuint texture_id, float x, float y, float w, float h, float scale_x, float scale_y, const Color &color ) const;
 
 	// global scale
 	bool m_global_scale;
@@ -142,6 +283,18 @@ public:
 
 	// draw
 	virtual void Draw( void );
+
+	// only filled rects without rotation or with the sprite shader can be batched
+	virtual bool Is_Batchable( bool shader = 0 ) const;
+	// add the rect as pre-transformed quad
+	virtual void Add_To_Batch( cRender_Batch &batch ) const;
+	// returns the scaled rect if batchable
+	virtual bool Get_Bounds( GL_rect &rect ) const;
+	// filled rects with an opaque color are opaque
+	virtual bool Is_Opaque( void ) const;
+	// filled rects without rotation and shadow are plain quads
+	virtual bool Get_Command( Render_Command &command ) const;
+
 	// color
 	Color m_color;
 	// rect
@@ -169,6 +322,9 @@ public:
 	// draw
 	virtual void Draw( void );
 
+	// gradients with opaque colors are opaque
+	virtual bool Is_Opaque( void ) const;
+
 	// rect
 	GL_rect m_rect;
 	// direction
@@ -209,8 +365,37 @@ public:
 	// Draw
 	virtual void Draw( void );
 
+	/* surfaces without rotation and shadow or with the sprite shader can be batched
+	 * tiled surfaces only without rotation and shadow
+	*/
+	virtual bool Is_Batchable( bool shader = 0 ) const;
+	// rotated surfaces without shadow, repeat and tiles
+	virtual bool Is_Batchable_Rotated( void ) const;
+	// add the surface or its visible tiles as pre-transformed textured quads
+	virtual void Add_To_Batch( cRender_Batch &batch ) const;
+	// returns the scaled surface rect if batchable
+	virtual bool Get_Bounds( GL_rect &rect ) const;
+	// returns the texture with the blend and combine state
+	virtual Uint32 Get_State_Key( void ) const;
+	// surfaces of opaque textures with an opaque color are opaque
+	virtual bool Is_Opaque( void ) const;
+	// surfaces without rotation, shadow, repeat, tiles and texture deletion are plain quads
+	virtual bool Get_Command( Render_Command &command ) const;
+
+	// Returns the tile rect from the surface rect
+	static void Get_Tile_Rect( const cGL_Texture_Tile &tile, const GL_rect &rect, GL_rect &tile_rect );
+
 	// texture id
 	GLuint m_texture_id;
+	/* textures of an image larger than the maximum texture size
+	 * if set they are drawn instead of the texture id
+	*/
+	GL_Texture_Tile_List m_tiles;
+	// texture coordinates
+	float m_tex_x1;
+	float m_tex_y1;
+	float m_tex_x2;
+	float m_tex_y2;
 	// position
 	float m_pos_x;
 	float m_pos_y;
@@ -225,8 +410,429 @@ public:
 	// color
 	Color m_color;
 
+	/* repeat the texture for coordinates outside of 0 to 1
+	 * the texture must not be in an atlas page
+	*/
+	bool m_repeat_x;
+	bool m_repeat_y;
+
 	// delete texture after request finished
 	bool m_delete_texture;
+	// if the texture has no transparent pixels
+	bool m_opaque;
+};
+
+/* *** *** *** *** *** *** cStatic_Geometry_Request *** *** *** *** *** *** *** *** *** *** *** */
+
+class cStatic_Geometry_Request : public cRender_Request
+{
+public:
+	cStatic_Geometry_Request( void );
+	virtual ~cStatic_Geometry_Request( void );
+
+	// Draw
+	virtual void Draw( void );
+
+	// returns the geometry rect in screen coordinates
+	virtual bool Get_Bounds( GL_rect &rect ) const;
+	// returns the texture of the first part
+	virtual Uint32 Get_State_Key( void ) const;
+
+	/* geometry to draw
+	 * must stay valid until the request is rendered
+	*/
+	const cStatic_Geometry *m_geometry;
+};
+
+/* *** *** *** *** *** *** cQuad_Stream_Request *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Quads with the same texture and blending drawn with one call
+ * the corners are already rotated and scaled
+ * and in world coordinates if the camera position is subtracted
+*/
+class cQuad_Stream_Request : public cRender_Request_Advanced
+{
+public:
+	cQuad_Stream_Request( void );
+	virtual ~cQuad_Stream_Request( void );
+
+	// Draw
+	virtual void Draw( void );
+
+	// returns the rect of all quads in screen coordinates
+	virtual bool Get_Bounds( GL_rect &rect ) const;
+	// returns the texture with the blend and combine state
+	virtual Uint32 Get_State_Key( void ) const;
+
+	// Reserve the memory for the given number of quads
+	void Reserve( unsigned int count );
+	/* Add a quad with the texture coordinates of the request
+	 * corners : x, y and z of the top left, top right, bottom right and bottom left corner
+	*/
+	void Add_Quad( const GLfloat corners[12], const Color &color );
+	// Add an unrotated rect as quad
+	void Add_Rect( const GL_rect &rect, float z, const Color &color );
+
+	// texture id or 0 to draw untextured quads
+	GLuint m_texture_id;
+	// texture coordinates for every quad
+	float m_tex_x1;
+	float m_tex_y1;
+	float m_tex_x2;
+	float m_tex_y2;
+
+	// quad count
+	unsigned int m_quad_count;
+	// vertex positions (x, y, z)
+	vector<GLfloat> m_vertices;
+	// texture coordinates (s, t)
+	vector<GLfloat> m_tex_coords;
+	// colors (r, g, b, a)
+	vector<GLubyte> m_colors;
+
+	// rect of all quads
+	float m_min_x;
+	float m_min_y;
+	float m_max_x;
+	float m_max_y;
+};
+
+/* *** *** *** *** *** *** cLine_Stream_Request *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Lines with the same width and stipple pattern drawn with one call
+ * every line has its own color and z position
+ * the positions are in screen coordinates if no camera is set
+*/
+class cLine_Stream_Request : public cRender_Request_Advanced
+{
+public:
+	cLine_Stream_Request( void );
+	virtual ~cLine_Stream_Request( void );
+
+	// Draw
+	virtual void Draw( void );
+
+	// returns the rect of all lines in screen coordinates
+	virtual bool Get_Bounds( GL_rect &rect ) const;
+
+	// Reserve the memory for the given number of lines
+	void Reserve( unsigned int count );
+	// Add a line
+	void Add_Line( float x1, float y1, float x2, float y2, float z, const Color &color );
+	// Add the outline of a rect as four lines
+	void Add_Rect( const GL_rect &rect, float z, const Color &color );
+
+	// width
+	float m_line_width;
+	// stipple pattern
+	GLushort m_stipple_pattern;
+
+	// line count
+	unsigned int m_line_count;
+	// vertex positions (x, y, z)
+	vector<GLfloat> m_vertices;
+	// colors (r, g, b, a)
+	vector<GLubyte> m_colors;
+
+	// rect of all lines
+	float m_min_x;
+	float m_min_y;
+	float m_max_x;
+	float m_max_y;
+};
+
+/* *** *** *** *** *** *** cParticle_Seed_Request *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Particles of a seed buffer which are simulated by the particle shader
+ * carries the particles added since the last request which are uploaded before drawing
+ * has no bounds as it must always be drawn to upload them
+*/
+class cParticle_Seed_Request : public cRender_Request_Advanced
+{
+public:
+	cParticle_Seed_Request( void );
+	virtual ~cParticle_Seed_Request( void );
+
+	// Draw
+	virtual void Draw( void );
+
+	// returns the texture with the blend and combine state
+	virtual Uint32 Get_State_Key( void ) const;
+
+	/* particles to draw
+	 * must stay valid until the request is rendered
+	*/
+	cParticle_Seed_Buffer *m_buffer;
+	// particle count of the buffer
+	unsigned int m_size;
+	// if set the buffer storage is created again
+	bool m_recreate;
+	// vertices to upload starting with the given particle
+	cParticle_Seed_Buffer::Seed_Vertex_List m_vertices;
+	unsigned int m_upload_first;
+
+	// simulation time
+	float m_time;
+
+	// texture id
+	GLuint m_texture_id;
+	// texture coordinates for every particle
+	float m_tex_x1;
+	float m_tex_y1;
+	float m_tex_x2;
+	float m_tex_y2;
+
+	// half image start size
+	float m_half_w;
+	float m_half_h;
+	// half image size
+	float m_scale_offset_x;
+	float m_scale_offset_y;
+	// image internal drawing offset
+	float m_image_x;
+	float m_image_y;
+	// added to every particle position
+	float m_offset_x;
+	float m_offset_y;
+	// image base rotation
+	float m_base_rot_x;
+	float m_base_rot_y;
+	float m_base_rot_z;
+
+	// fading types
+	bool m_fade_size;
+	bool m_fade_alpha;
+	bool m_fade_color;
+
+	// if set particles leaving it are moved to its other side
+	GL_rect m_clip_rect;
+};
+
+/* *** *** *** *** *** *** cRender_Batch *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Collects pre-transformed quads of consecutive requests with the same
+ * texture, blending and combine state and draws them with one call
+ * with the sprite shader the combine state, rotation and shadow are vertex attributes
+ * and only the texture and blending split the batch
+*/
+class cRender_Batch
+{
+public:
+	cRender_Batch( void );
+	~cRender_Batch( void );
+
+	/* Set the state for the following quads
+	 * if it differs from the current state the collected data is drawn first
+	 * texture_id : 0 for untextured quads
+	*/
+	void Begin( const cRender_Request_Advanced *obj, GLuint texture_id );
+	// Set the state for the following quads from the given values
+	void Begin( GLuint texture_id, GLenum blend_sfactor, GLenum blend_dfactor, GLint combine_type, const float combine_color[3] );
+	/* Add a quad in final screen coordinates
+	 * the corners are given as top left and bottom right
+	 * tex_x1, tex_y1, tex_x2, tex_y2 : texture coordinates of the corners
+	*/
+	void Add_Quad( float x1, float y1, float x2, float y2, float z, const Color &color, float tex_x1 = 0.0f, float tex_y1 = 0.0f, float tex_x2 = 1.0f, float tex_y2 = 1.0f );
+	/* Add a quad in final screen coordinates
+	 * corners : x, y and z of the top left, top right, bottom right and bottom left corner
+	*/
+	void Add_Quad( const GLfloat corners[12], const Color &color, float tex_x1 = 0.0f, float tex_y1 = 0.0f, float tex_x2 = 1.0f, float tex_y2 = 1.0f );
+	/* Add a quad with the rotation, camera and global scale of the request as pre-transformed quad
+	 * x, y : top left position before scaling
+	 * w, h : size before scaling
+	*/
+	void Add_Rotated_Quad( const cRender_Request_Advanced *obj, float x, float y, float w, float h, float scale_x, float scale_y, float scale_z, float z, const Color &color,
+		float tex_x1 = 0.0f, float tex_y1 = 0.0f, float tex_x2 = 1.0f, float tex_y2 = 1.0f );
+	/* Add a quad with the rotation, camera, global scale and combine state of the request
+	 * only available with the sprite shader
+	 * x, y : top left position before scaling
+	 * w, h : size before scaling
+	 * shadow : add the shadow of the request instead
+	*/
+	void Add_Sprite( const cRender_Request_Advanced *obj, float x, float y, float w, float h, float scale_x, float scale_y, float z, const Color &color, bool shadow,
+		float tex_x1 = 0.0f, float tex_y1 = 0.0f, float tex_x2 = 1.0f, float tex_y2 = 1.0f );
+	// draw and clear the collected data
+	void Flush( void );
+
+	// collected quads
+	unsigned int m_quad_count;
+	// vertex positions (x, y, z)
+	vector<GLfloat> m_vertices;
+	// texture coordinates (s, t)
+	vector<GLfloat> m_tex_coords;
+	// colors (r, g, b, a)
+	vector<GLubyte> m_colors;
+	// sprite shader corner offsets and scale (x, y, scale x, scale y)
+	vector<GLfloat> m_corners;
+	// sprite shader rotations (x, y, z)
+	vector<GLfloat> m_rotations;
+	// sprite shader combine colors and modes (r, g, b, mode)
+	vector<GLfloat> m_combine;
+
+	// sprite shader or NULL if the fixed function pipeline is used
+	cSprite_Shader *m_shader;
+
+	// current state
+	GLuint m_texture_id;
+	GLenum m_blend_sfactor;
+	GLenum m_blend_dfactor;
+	GLint m_combine_type;
+	float m_combine_color[3];
+};
+
+/* *** *** *** *** *** *** cStatic_Geometry *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Quads of non-moving sprites built once in world coordinates
+ * the camera and global scale are applied when drawing
+ * quads are drawn in the order they were added
+*/
+class cStatic_Geometry
+{
+public:
+	cStatic_Geometry( void );
+	~cStatic_Geometry( void );
+
+	/* Add the surface as quad or a quad for every tile
+	 * the request position must be in world coordinates and it must be batchable
+	*/
+	void Add( const cSurface_Request *obj );
+	// draw all quads
+	void Draw( void ) const;
+
+	// quads with the same state
+	struct Part
+	{
+		GLuint m_texture_id;
+		GLenum m_blend_sfactor;
+		GLenum m_blend_dfactor;
+		GLint m_combine_type;
+		float m_combine_color[3];
+		// first quad
+		unsigned int m_start;
+		unsigned int m_count;
+	};
+
+	typedef vector<Part> Part_List;
+	Part_List m_parts;
+
+	// vertex positions (x, y, z)
+	vector<GLfloat> m_vertices;
+	// texture coordinates (s, t)
+	vector<GLfloat> m_tex_coords;
+	// colors (r, g, b, a)
+	vector<GLubyte> m_colors;
+
+	// quad count
+	unsigned int m_quad_count;
+	// rect of all quads in world coordinates
+	GL_rect m_rect;
+	// lowest quad z position
+	float m_pos_z;
+
+private:
+	// Add a quad of the texture with the request state
+	void Add_Quad( const cSurface_Request *obj, GLuint texture_id, const GL_rect &rect, float tex_x1, float tex_y1, float tex_x2, float tex_y2 );
+};
+
+/* *** *** *** *** *** *** cRender_Request_Pool *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Keeps the memory of finished requests for reuse
+ * every request type has a fixed size so each size has its own free list
+*/
+class cRender_Request_Pool
+{
+public:
+	cRender_Request_Pool( void );
+	~cRender_Request_Pool( void );
+
+	// Return memory for the given size from the free list or allocate new memory
+	void *Get( size_t size );
+	// Destroy the request and keep its memory for reuse
+	void Recycle( cRender_Request *obj );
+	// Free all unused memory
+	void Clear( void );
+
+	// Allocate memory with the size header
+	static void *Allocate( size_t size );
+	// Free memory allocated with Allocate
+	static void Free( void *ptr );
+
+	// free memory blocks of the same size
+	struct Free_List
+	{
+		size_t m_size;
+		vector<void *> m_blocks;
+	};
+
+	typedef vector<Free_List> Free_List_List;
+	Free_List_List m_free_lists;
+
+	// blocks taken from the free lists
+	unsigned int m_reused_count;
+	// blocks newly allocated
+	unsigned int m_allocated_count;
+};
+
+/* *** *** *** *** *** *** cRender_Stats *** *** *** *** *** *** *** *** *** *** *** */
+
+// number of render types for the statistics
+const unsigned int RENDER_TYPE_COUNT = REND_LINE_STREAM + 1;
+
+// render counts of a frame
+struct Render_Counts
+{
+	// Set all counts to zero
+	void Clear( void );
+
+	// requests by render type
+	unsigned int m_requests[RENDER_TYPE_COUNT];
+	// requests outside of the screen which were not drawn
+	unsigned int m_culled;
+	// opengl draw calls
+	unsigned int m_draw_calls;
+	// submitted vertices
+	unsigned int m_vertices;
+	// texture bind calls
+	unsigned int m_texture_binds;
+	// other opengl state calls
+	unsigned int m_state_changes;
+	// state calls avoided by the state cache
+	unsigned int m_avoided_state_changes;
+	// requests kept for the next frame
+	unsigned int m_carried_over;
+};
+
+/* Per frame render statistics
+ * counted while rendering and saved as the last frame after the buffer swap
+*/
+class cRender_Stats
+{
+public:
+	cRender_Stats( void );
+	~cRender_Stats( void );
+
+	// Count a draw call with its vertices
+	inline void Add_Draw_Call( unsigned int vertices )
+	{
+		m_current.m_draw_calls++;
+		m_current.m_vertices += vertices;
+	};
+
+	// Count rendered requests
+	void Add_Request( RenderType type, unsigned int count = 1 );
+
+	// Save the current counts as the last frame and reset them
+	void Frame_Finished( void );
+
+	// Returns the requests of all types from the last frame
+	unsigned int Get_Request_Count( void ) const;
+	// Returns the requests of the given type from the last frame
+	unsigned int Get_Request_Count( RenderType type ) const;
+
+	// counts of the frame being rendered
+	Render_Counts m_current;
+	// counts of the last finished frame
+	Render_Counts m_last;
 };
 
 /* *** *** *** *** *** *** cRenderQueue *** *** *** *** *** *** *** *** *** *** *** */
@@ -238,10 +844,17 @@ public:
 	~cRenderQueue( void );
 
 	/* Add a Render Request
+	 * plain quads rendered once are copied into a command and the request is recycled
 	*/
 	void Add( cRender_Request *obj );
 
+	/* Save the active camera position for the next rendering
+	 * needed if the camera changes before rendering in another thread
+	*/
+	void Save_Camera( void );
+
 	/* Render current data
+	 * uses the saved camera position or the active camera if not saved
 	 * clear: if set clear the finished data after rendering
 	*/
 	void Render( bool clear = 1 );
@@ -253,21 +866,151 @@ public:
 	void Fake_Render( unsigned int amount = 1, bool clear = 1 );
 
 	/* clear the render data
+	 * unfinished requests are moved to the retained requests
 	 * if force is given all objects will be removed
 	*/
 	void Clear( bool force = 1 );
+	// Move the retained requests of the given queue to this queue
+	void Move_Retained( cRenderQueue *queue );
+	/* Add the commands captured by another thread
+	 * the referenced requests are owned by the queue afterwards
+	*/
+	void Add_Commands( const Render_Command *itr, const Render_Command *end );
 
-	// render data array
+	/* requests of the next rendering owned by the queue in the order they were added
+	 * requests without a command are in front
+	*/
 	RenderList m_render_data;
+	/* requests with a render count left after a rendering
+	 * owned by the queue until the render count is used up
+	*/
+	RenderList m_retained;
+
+	/* commands of the next rendering
+	 * the retained requests get their command when prepared
+	*/
+	Render_Command_List m_commands;
+	// requests of the render data with a command
+	unsigned int m_command_requests;
+	// if set plain quads are copied into commands when added
+	bool m_command_stream;
+
+	/* Add the commands of the kept requests and get the sort data of all requests
+	 * moves the quads into final screen coordinates with the saved camera
+	*/
+	void Prepare_Commands( void );
+
+	// saved camera position
+	float m_camera_x;
+	float m_camera_y;
+	// if set the saved camera position is used for the next rendering
+	bool m_camera_saved;
+
+	/* Draw the commands
+	 * runs of commands with the same type are drawn by the loop of the type
+	 * gpu_timer : if set the batch is flushed when the z position enters another phase
+	*/
+	void Render_Commands( const Render_Command *itr, const Render_Command *end, cGPU_Timer *gpu_timer = NULL );
+	// Draw the request or add it to the batch and count it as rendered
+	void Render_Request( cRender_Request *obj );
 
-	// Z position sort
-	struct zpos_sort
+	/* Draw the opaque commands front to back without blending
+	 * the hidden pixels of the following commands are rejected by the depth test
+	 * the drawn commands are removed
+	*/
+	void Render_Opaque( void );
+
+	// if set opaque requests are drawn in an extra pass before the blended requests
+	bool m_opaque_pass;
+
+	/* Count the drawn fragments of every pixel in the stencil buffer
+	 * returns false if no stencil buffer is available
+	*/
+	bool Begin_Overdraw( void ) const;
+	// Show the counted fragments as heatmap
+	void Draw_Overdraw( void ) const;
+
+	// if set batchable requests are drawn with the batch renderer
+	bool m_batching;
+	// batch renderer
+	cRender_Batch m_batch;
+	// memory of finished requests
+	cRender_Request_Pool m_pool;
+
+	/* Remove the commands with bounds outside of the screen
+	 * culled requests count as rendered
+	*/
+	void Cull( void );
+
+	// if set requests outside of the screen are not drawn
+	bool m_culling;
+
+	/* Sort the commands by z position and state
+	 * commands in the same z layer without overlapping are grouped by state
+	*/
+	void Sort( void );
+
+	// if set non-overlapping requests in the same z layer are grouped by state
+	bool m_grouping;
+
+	// sort data of a command
+	struct Sort_Entry
 	{
-		bool operator()( const cRender_Request *a, const cRender_Request *b ) const
-		{
-			return a->m_pos_z < b->m_pos_z;
-		}
+		// z position in the high and state in the low 32 bits
+		Uint64 m_key;
+		// command
+		unsigned int m_index;
+		// quantized z layer
+		int m_layer;
 	};
+
+	typedef vector<Sort_Entry> Sort_List;
+	// sort buffers kept to avoid allocations
+	Sort_List m_sort_data;
+	Sort_List m_sort_temp;
+	// commands in the sorted order or the opaque pass
+	Render_Command_List m_commands_temp;
+};
+
+/* *** *** *** *** *** *** cRender_Capture *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Keeps the requests a thread adds to the render queue
+ * lets other threads than the main thread create the requests of a frame
+ * the requests are built into commands like the queue does and added to it with Submit
+ * in the order they were added so the rendering is the same as adding them directly
+*/
+class cRender_Capture
+{
+public:
+	cRender_Capture( void );
+	~cRender_Capture( void );
+
+	// Capture the requests of the current thread for the queue until End
+	void Begin( cRenderQueue *queue );
+	void End( void );
+
+	// Build the command of the request like the queue does
+	void Add( cRender_Request *obj );
+	// Add the captured commands to the queue and clear them
+	void Submit( void );
+
+	// Returns the capture of the current thread or NULL if not capturing
+	static inline cRender_Capture *Get_Current( void )
+	{
+		return m_current.get();
+	}
+
+	// queue the requests are captured for
+	cRenderQueue *m_queue;
+	// captured commands with the requests of commands not built
+	Render_Command_List m_commands;
+
+private:
+	// does nothing as the captures are not owned by the threads
+	static void No_Cleanup( cRender_Capture *capture );
+
+	// capture of the current thread
+	static boost::thread_specific_ptr<cRender_Capture> m_current;
 };
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
@@ -275,6 +1018,8 @@ public:
 // Renderer class
 extern cRenderQueue *pRenderer;
 extern cRenderQueue *pRenderer_current;
+// Render statistics
+extern cRender_Stats *pRender_Stats;
 
 /* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
 
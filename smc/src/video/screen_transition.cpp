@@ -0,0 +1,532 @@
+/***************************************************************************
+ * screen_transition.cpp  -  screen fade out and fade in effects
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/screen_transition.h"
+#include "../video/renderer.h"
+#include "../video/gl_surface.h"
+#include "../core/game_core.h"
+#include "../core/framerate.h"
+#include "../core/camera.h"
+#include "../core/math/utilities.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cScreen_Transition *** *** *** *** *** *** *** *** *** *** */
+
+// depth of the effect requests over the game
+static const float screen_transition_pos_z = 0.9f;
+
+cScreen_Transition :: cScreen_Transition( void )
+{
+	m_state = STATE_NONE;
+	m_effect_out = EFFECT_OUT_BLACK;
+	m_effect_in = EFFECT_IN_BLACK;
+	m_speed = 1.0f;
+	m_next_effect_in = EFFECT_IN_AMOUNT;
+	m_next_speed = 1.0f;
+	m_progress = 0.0f;
+
+	m_horizontal = 0;
+	m_pos = 0.0f;
+	m_pos_end = 0.0f;
+	m_alpha = 0.0f;
+	m_item_image = NULL;
+	m_item_scale = 0.0f;
+	m_rect_size = 0.0f;
+	m_color_mod = 0.0f;
+	m_pos_x = 0.0f;
+	m_pos_y = 0.0f;
+	m_selected_tile_x = 0;
+	m_selected_tile_y = 0;
+	m_activated_tiles = 0;
+}
+
+cScreen_Transition :: ~cScreen_Transition( void )
+{
+	//
+}
+
+void cScreen_Transition :: Start_Out( Effect_Fadeout effect /* = EFFECT_OUT_RANDOM */, float speed /* = 1.0f */ )
+{
+	if( effect == EFFECT_OUT_RANDOM )
+	{
+		effect = static_cast<Effect_Fadeout>( ( rand() % (EFFECT_OUT_AMOUNT - 1) ) + 1 );
+	}
+
+	m_state = STATE_OUT;
+	m_effect_out = effect;
+	m_speed = speed;
+	m_next_effect_in = EFFECT_IN_AMOUNT;
+	m_progress = 0.0f;
+
+	if( effect == EFFECT_OUT_HORIZONTAL_VERTICAL )
+	{
+		m_horizontal = ( rand() % 2 ) != 0;
+		m_pos = static_cast<float>( m_horizontal ? game_res_w : game_res_h );
+		m_pos_end = 0.0f;
+		m_alpha = 10.0f;
+	}
+	else if( effect == EFFECT_OUT_BIG_ITEM )
+	{
+		m_item_scale = 0.1f;
+
+		// item based on the camera x position
+		if( pActive_Camera->m_x < 2000 )
+		{
+			m_item_image = pVideo->Get_Surface( "game/items/mushroom_red.png" );
+		}
+		else if( pActive_Camera->m_x < 5000 )
+		{
+			m_item_image = pVideo->Get_Surface( "game/items/fireplant.png" );
+		}
+		else if( pActive_Camera->m_x < 10000 )
+		{
+			m_item_image = pVideo->Get_Surface( "game/items/mushroom_green.png" );
+		}
+		else if( pActive_Camera->m_x < 20000 )
+		{
+			m_item_image = pVideo->Get_Surface( "game/items/star.png" );
+		}
+		else
+		{
+			m_item_image = pVideo->Get_Surface( "game/items/moon_1.png" );
+		}
+	}
+	else if( effect == EFFECT_OUT_RANDOM_COLOR_BOOST )
+	{
+		const unsigned int rand_color_num = ( rand() % 4 );
+
+		// red
+		if( rand_color_num == 0 )
+		{
+			m_start_color = Color( static_cast<Uint8>( 1 ), 20, 20, 4 );
+		}
+		// green
+		else if( rand_color_num == 1 )
+		{
+			m_start_color = Color( static_cast<Uint8>( 20 ), 1, 20, 4 );
+		}
+		// blue
+		else if( rand_color_num == 2 )
+		{
+			m_start_color = Color( static_cast<Uint8>( 20 ), 20, 1, 4 );
+		}
+		// yellow
+		else
+		{
+			m_start_color = Color( static_cast<Uint8>( 1 ), 1, 40, 4 );
+		}
+
+		m_rect_size = 1.0f;
+	}
+	else if( effect == EFFECT_OUT_BLACK_TILED_RECTS )
+	{
+		for( unsigned int y = 0; y < m_tiles_ver; y++ )
+		{
+			for( unsigned int x = 0; x < m_tiles_hor; x++ )
+			{
+				m_tiles[y][x] = 0.0f;
+			}
+		}
+
+		m_selected_tile_x = 0;
+		m_selected_tile_y = 0;
+		m_activated_tiles = 0;
+	}
+	else if( effect == EFFECT_OUT_FIXED_COLORBOX )
+	{
+		// green
+		if( rand() % 2 == 0 )
+		{
+			m_start_color = Color( static_cast<Uint8>(10), 55, 10, 250 );
+		}
+		// blue
+		else
+		{
+			m_start_color = Color( static_cast<Uint8>(10), 10, 55, 250 );
+		}
+
+		m_color_mod = 1.0f;
+		m_pos_x = 0.0f;
+		m_pos_y = 0.0f;
+		m_rect_size = 20.0f;
+	}
+}
+
+void cScreen_Transition :: Start_In( Effect_Fadein effect /* = EFFECT_IN_RANDOM */, float speed /* = 1.0f */ )
+{
+	if( effect == EFFECT_IN_RANDOM )
+	{
+		effect = static_cast<Effect_Fadein>( ( rand() % (EFFECT_IN_AMOUNT - 1) ) + 1 );
+	}
+
+	// after the screen is covered
+	if( m_state == STATE_OUT )
+	{
+		m_next_effect_in = effect;
+		m_next_speed = speed;
+		return;
+	}
+
+	m_state = STATE_IN;
+	m_effect_in = effect;
+	m_speed = speed;
+	m_next_effect_in = EFFECT_IN_AMOUNT;
+	m_progress = 0.0f;
+}
+
+void cScreen_Transition :: Clear( void )
+{
+	m_state = STATE_NONE;
+	m_next_effect_in = EFFECT_IN_AMOUNT;
+}
+
+void cScreen_Transition :: Update( void )
+{
+	if( m_state == STATE_OUT )
+	{
+		if( Update_Out() )
+		{
+			m_state = STATE_COVERED;
+
+			if( m_next_effect_in != EFFECT_IN_AMOUNT )
+			{
+				Start_In( m_next_effect_in, m_next_speed );
+			}
+		}
+	}
+	else if( m_state == STATE_IN )
+	{
+		if( Update_In() )
+		{
+			m_state = STATE_NONE;
+		}
+	}
+}
+
+void cScreen_Transition :: Draw( void )
+{
+	if( m_state == STATE_OUT )
+	{
+		Draw_Out();
+	}
+	else if( m_state == STATE_COVERED )
+	{
+		Draw_Screen_Rect( black );
+	}
+	else if( m_state == STATE_IN )
+	{
+		Draw_In();
+	}
+}
+
+bool cScreen_Transition :: Update_Out( void )
+{
+	const float speed_factor = pFramerate->m_speed_factor;
+
+	switch( m_effect_out )
+	{
+	case EFFECT_OUT_HORIZONTAL_VERTICAL:
+	{
+		// fade alpha in
+		m_alpha += 10.0f * speed_factor;
+
+		if( m_alpha > 255.0f )
+		{
+			m_alpha = 255.0f;
+		}
+
+		// horizontal
+		if( m_horizontal )
+		{
+			m_pos -= 20.0f * speed_factor;
+			m_pos_end = static_cast<float>(game_res_w) - m_pos;
+		}
+		// vertical
+		else
+		{
+			m_pos -= 15.0f * speed_factor;
+			m_pos_end = static_cast<float>(game_res_h) - m_pos;
+		}
+
+		return m_pos <= m_pos_end * 0.5f;
+	}
+	case EFFECT_OUT_BIG_ITEM:
+	{
+		m_item_scale += 0.9f * speed_factor * m_speed * ( m_item_scale / 7.0f );
+		return m_item_scale >= 50.0f;
+	}
+	case EFFECT_OUT_RANDOM_COLOR_BOOST:
+	{
+		m_rect_size += 4.0f * speed_factor;
+		m_progress = m_rect_size / 200.0f;
+		return m_rect_size >= 200.0f;
+	}
+	case EFFECT_OUT_BLACK_TILED_RECTS:
+	{
+		const unsigned int tiles_num = m_tiles_hor * m_tiles_ver;
+
+		// if not all activated
+		if( m_activated_tiles < tiles_num )
+		{
+			// find an unused rect
+			while( m_tiles[m_selected_tile_y][m_selected_tile_x] > 0.1f )
+			{
+				const unsigned int temp = rand() % tiles_num;
+
+				m_selected_tile_y = temp / m_tiles_hor;
+				m_selected_tile_x = temp % m_tiles_hor;
+			}
+
+			// activate it
+			m_tiles[m_selected_tile_y][m_selected_tile_x] = 0.2f;
+			m_activated_tiles++;
+		}
+
+		// fade in all activated tiles
+		for( unsigned int y = 0; y < m_tiles_ver; y++ )
+		{
+			for( unsigned int x = 0; x < m_tiles_hor; x++ )
+			{
+				if( m_tiles[y][x] < 0.1f || m_tiles[y][x] >= 120.0f )
+				{
+					continue;
+				}
+
+				m_tiles[y][x] += speed_factor;
+
+				if( m_tiles[y][x] > 120.0f )
+				{
+					m_tiles[y][x] = 120.0f;
+				}
+			}
+		}
+
+		// until the latest tile did fade in
+		return m_activated_tiles == tiles_num && m_tiles[m_selected_tile_y][m_selected_tile_x] >= 60.0f;
+	}
+	case EFFECT_OUT_FIXED_COLORBOX:
+	{
+		m_rect_size += 0.3f * speed_factor;
+
+		// change color modification
+		if( m_color_mod > 0.0f )
+		{
+			m_color_mod -= 0.04f * speed_factor;
+
+			if( m_color_mod < 0.0f )
+			{
+				m_color_mod = 0.0f;
+			}
+		}
+
+		// continuous random position advance
+		const float random = Get_Random_Float( 2.0f, 3.0f ) * speed_factor;
+		m_pos_x -= random;
+		m_pos_y -= random + Get_Random_Float( 0.1f, 0.1f );
+
+		m_progress = ( m_rect_size - 20.0f ) / 15.0f;
+		return m_rect_size >= 35.0f;
+	}
+	default:
+	{
+		m_progress += ( m_speed / 30.0f ) * speed_factor;
+		return m_progress >= 1.0f;
+	}
+	}
+}
+
+bool cScreen_Transition :: Update_In( void )
+{
+	m_progress += ( m_speed / 30.0f ) * pFramerate->m_speed_factor;
+	return m_progress >= 1.0f;
+}
+
+void cScreen_Transition :: Draw_Out( void )
+{
+	switch( m_effect_out )
+	{
+	case EFFECT_OUT_HORIZONTAL_VERTICAL:
+	{
+		const Color color = Color( static_cast<Uint8>( 0 ), 0, 0, static_cast<Uint8>(m_alpha) );
+
+		cGradient_Request *gradient_request = new cGradient_Request();
+
+		// left
+		if( m_horizontal )
+		{
+			pVideo->Draw_Gradient( 0, 0, m_pos_end, static_cast<float>(game_res_h), screen_transition_pos_z, &color, &black, DIR_HORIZONTAL, gradient_request );
+		}
+		// top
+		else
+		{
+			pVideo->Draw_Gradient( 0, 0, static_cast<float>(game_res_w), m_pos_end, screen_transition_pos_z, &color, &black, DIR_VERTICAL, gradient_request );
+		}
+
+		pRenderer->Add( gradient_request );
+
+		gradient_request = new cGradient_Request();
+
+		// right
+		if( m_horizontal )
+		{
+			pVideo->Draw_Gradient( static_cast<float>(game_res_w) - m_pos_end, 0, m_pos_end, static_cast<float>(game_res_h), screen_transition_pos_z, &color, &black, DIR_HORIZONTAL, gradient_request );
+		}
+		// down
+		else
+		{
+			pVideo->Draw_Gradient( 0, static_cast<float>(game_res_h) - m_pos_end, static_cast<float>(game_res_w), m_pos_end, screen_transition_pos_z, &color, &black, DIR_VERTICAL, gradient_request );
+		}
+
+		pRenderer->Add( gradient_request );
+		break;
+	}
+	case EFFECT_OUT_BIG_ITEM:
+	{
+		const float f = m_item_scale;
+
+		// item
+		if( m_item_image )
+		{
+			cSurface_Request *request = new cSurface_Request();
+			m_item_image->Blit( ( game_res_w * 0.5f ) - ( ( m_item_image->m_w * f ) / 2 ), game_res_h * 0.5f - ( ( m_item_image->m_h * f ) / 2 ), screen_transition_pos_z, request );
+
+			request->m_blend_sfactor = GL_SRC_ALPHA;
+			request->m_blend_dfactor = GL_ONE;
+			request->m_color = Color( static_cast<Uint8>( 255 - ( f * 4 ) ), 255 - static_cast<Uint8>( f * 4 ), 255 - static_cast<Uint8>( f * 4 ), 200 - static_cast<Uint8>( f * 4 ) );
+			request->m_scale_x = f;
+			request->m_scale_y = f;
+
+			pRenderer->Add( request );
+		}
+
+		// additional black fadeout
+		const Color color = Color( 0, 0, 0, static_cast<Uint8>( 50 + ( f * 4 ) ) );
+
+		cRect_Request *rect_request = new cRect_Request();
+		pVideo->Draw_Rect( NULL, screen_transition_pos_z + 0.001f, &color, rect_request );
+		pRenderer->Add( rect_request );
+		break;
+	}
+	case EFFECT_OUT_RANDOM_COLOR_BOOST:
+	{
+		for( unsigned int g = 0; g < 50; g++ )
+		{
+			cRect_Request *request = new cRect_Request();
+			pVideo->Draw_Rect( Get_Random_Float( -m_rect_size * 0.5f, game_res_w - m_rect_size * 0.5f ), Get_Random_Float( -m_rect_size * 0.5f, game_res_h - m_rect_size * 0.5f ), m_rect_size, m_rect_size, screen_transition_pos_z, &m_start_color, request );
+
+			request->m_blend_sfactor = GL_SRC_ALPHA;
+			request->m_blend_dfactor = GL_ONE_MINUS_SRC_COLOR;
+
+			pRenderer->Add( request );
+		}
+
+		// the rects are not added up over the frames
+		Draw_Screen_Rect( Color( static_cast<Uint8>(0), 0, 0, static_cast<Uint8>( 255 * Clamp( m_progress, 0.0f, 1.0f ) ) ) );
+		break;
+	}
+	case EFFECT_OUT_BLACK_TILED_RECTS:
+	{
+		GL_rect dest( 0, 0, static_cast<float>(game_res_w) / m_tiles_hor, static_cast<float>(game_res_h) / m_tiles_ver );
+		Color color = black;
+
+		for( unsigned int y = 0; y < m_tiles_ver; y++ )
+		{
+			for( unsigned int x = 0; x < m_tiles_hor; x++ )
+			{
+				const float tile = m_tiles[y][x];
+
+				// not activated
+				if( tile < 0.1f )
+				{
+					continue;
+				}
+
+				dest.m_x = x * dest.m_w;
+				dest.m_y = y * dest.m_h;
+				// covered when the tile did fade in
+				color.alpha = static_cast<Uint8>( 255 * Clamp( tile / 60.0f, 0.0f, 1.0f ) );
+
+				cRect_Request *request = new cRect_Request();
+				pVideo->Draw_Rect( &dest, screen_transition_pos_z, &color, request );
+
+				// rotation
+				request->m_rot_z = tile * 5.0f;
+				// scale
+				request->m_scale_x = 0.1f + ( tile * 0.02f );
+				request->m_scale_y = request->m_scale_x;
+				request->m_rect.m_x -= ( dest.m_w * 0.5f ) * ( request->m_scale_x - 1.0f );
+				request->m_rect.m_y -= ( dest.m_h * 0.5f ) * ( request->m_scale_y - 1.0f );
+
+				pRenderer->Add( request );
+			}
+		}
+		break;
+	}
+	case EFFECT_OUT_FIXED_COLORBOX:
+	{
+		// darken color
+		Color color = m_start_color;
+		color.red = static_cast<Uint8>(m_start_color.red * m_color_mod);
+		color.green = static_cast<Uint8>(m_start_color.green * m_color_mod);
+		color.blue = static_cast<Uint8>(m_start_color.blue * m_color_mod);
+		color.alpha = static_cast<Uint8>(m_rect_size * 0.3f);
+
+		// draw rects as a net
+		GL_rect rect;
+
+		for( rect.m_x = m_pos_x; rect.m_x < game_res_w; rect.m_x += 20 + ( m_rect_size * m_color_mod ) )
+		{
+			for( rect.m_y = m_pos_y; rect.m_y < game_res_h; rect.m_y += 20 + ( m_rect_size * m_color_mod ) )
+			{
+				rect.m_w = Get_Random_Float( 1.0f, 0.2f + ( m_rect_size * 1.5f ) );
+				rect.m_h = Get_Random_Float( 1.0f, 0.2f + ( m_rect_size * 1.5f ) );
+
+				cRect_Request *request = new cRect_Request();
+				pVideo->Draw_Rect( &rect, screen_transition_pos_z, &color, request );
+				pRenderer->Add( request );
+			}
+		}
+
+		// the darkening is not added up over the frames
+		Draw_Screen_Rect( Color( static_cast<Uint8>(0), 0, 0, static_cast<Uint8>( 255 * Clamp( m_progress, 0.0f, 1.0f ) ) ) );
+		break;
+	}
+	default:
+	{
+		Draw_Screen_Rect( Color( static_cast<Uint8>(0), 0, 0, static_cast<Uint8>( 255 * Clamp( m_progress, 0.0f, 1.0f ) ) ) );
+		break;
+	}
+	}
+}
+
+void cScreen_Transition :: Draw_In( void )
+{
+	Draw_Screen_Rect( Color( static_cast<Uint8>(0), 0, 0, static_cast<Uint8>( 255 * Clamp( 1.0f - m_progress, 0.0f, 1.0f ) ) ) );
+}
+
+void cScreen_Transition :: Draw_Screen_Rect( const Color &color ) const
+{
+	cRect_Request *request = new cRect_Request();
+	pVideo->Draw_Rect( NULL, screen_transition_pos_z + 0.002f, &color, request );
+	pRenderer->Add( request );
+}
+
+cScreen_Transition *pScreen_Transition = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
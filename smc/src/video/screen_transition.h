@@ -0,0 +1,133 @@
+/***************************************************************************
+ * screen_transition.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_SCREEN_TRANSITION_H
+#define SMC_SCREEN_TRANSITION_H
+
+#include "../core/global_basic.h"
+#include "../video/video.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cScreen_Transition *** *** *** *** *** *** *** *** *** *** */
+
+/* Screen fade out and fade in effect advanced by the game loop
+ * every frame the effect is updated once and drawn over the game
+ * after fading out the screen stays covered until the fade in starts or it is cleared
+ * so the game loop can wait for the next level without blocking
+*/
+class cScreen_Transition
+{
+public:
+	cScreen_Transition( void );
+	~cScreen_Transition( void );
+
+	/* Start fading the screen out
+	 * if effect is EFFECT_OUT_RANDOM a random effect is selected
+	*/
+	void Start_Out( Effect_Fadeout effect = EFFECT_OUT_RANDOM, float speed = 1.0f );
+	/* Start fading the screen in
+	 * if fading out it starts when the screen is covered
+	 * if effect is EFFECT_IN_RANDOM a random effect is selected
+	*/
+	void Start_In( Effect_Fadein effect = EFFECT_IN_RANDOM, float speed = 1.0f );
+	// Stop the effect and show the screen
+	void Clear( void );
+
+	// Advance the effect with the speed factor
+	void Update( void );
+	// Add the effect requests over the game
+	void Draw( void );
+
+	// Returns true if an effect is shown
+	inline bool Is_Active( void ) const
+	{
+		return m_state != STATE_NONE;
+	}
+	// Returns true if fading out or the screen is covered
+	inline bool Is_Fading_Out( void ) const
+	{
+		return m_state == STATE_OUT || m_state == STATE_COVERED;
+	}
+	// Returns true if fading out is finished and the screen is covered
+	inline bool Is_Covered( void ) const
+	{
+		return m_state == STATE_COVERED;
+	}
+
+private:
+	enum State
+	{
+		STATE_NONE,
+		STATE_OUT,
+		STATE_COVERED,
+		STATE_IN
+	};
+
+	// Update the fade out effect and return true if finished
+	bool Update_Out( void );
+	// Update the fade in effect and return true if finished
+	bool Update_In( void );
+	// Add the fade out requests
+	void Draw_Out( void );
+	// Add the fade in requests
+	void Draw_In( void );
+	// Add a rect over the whole screen
+	void Draw_Screen_Rect( const Color &color ) const;
+
+	State m_state;
+	Effect_Fadeout m_effect_out;
+	Effect_Fadein m_effect_in;
+	float m_speed;
+	// fade in started after the fade out or EFFECT_IN_AMOUNT if none
+	Effect_Fadein m_next_effect_in;
+	float m_next_speed;
+
+	// from 0 to 1 with the effects which advance linearly
+	float m_progress;
+
+	// horizontal vertical
+	bool m_horizontal;
+	float m_pos;
+	float m_pos_end;
+	float m_alpha;
+	// big item
+	cGL_Surface *m_item_image;
+	float m_item_scale;
+	// random color boost and fixed color box
+	Color m_start_color;
+	float m_rect_size;
+	// fixed color box
+	float m_color_mod;
+	float m_pos_x;
+	float m_pos_y;
+	// black tiled rects
+	static const unsigned int m_tiles_hor = 8;
+	static const unsigned int m_tiles_ver = 6;
+	float m_tiles[m_tiles_ver][m_tiles_hor];
+	unsigned int m_selected_tile_x;
+	unsigned int m_selected_tile_y;
+	unsigned int m_activated_tiles;
+};
+
+// Screen transition effect
+extern cScreen_Transition *pScreen_Transition;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
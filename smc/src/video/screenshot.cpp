@@ -0,0 +1,355 @@
+/***************************************************************************
+ * screenshot.cpp  -  screenshots saved in the background
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/screenshot.h"
+#include "../video/video.h"
+#include "../gui/hud.h"
+#include "../user/preferences.h"
+#include "../core/task_pool.h"
+#include "../core/property_helper.h"
+#include "../core/i18n.h"
+#include "../core/filesystem/filesystem.h"
+#include "../core/filesystem/resource_manager.h"
+// boost
+#include <boost/bind.hpp>
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** Extension *** *** *** *** *** *** *** *** *** *** */
+
+#ifndef APIENTRY
+	#define APIENTRY
+#endif
+#ifndef GL_PIXEL_PACK_BUFFER_ARB
+	#define GL_PIXEL_PACK_BUFFER_ARB 0x88EB
+#endif
+#ifndef GL_STREAM_READ_ARB
+	#define GL_STREAM_READ_ARB 0x88E1
+#endif
+#ifndef GL_READ_ONLY_ARB
+	#define GL_READ_ONLY_ARB 0x88B8
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+	#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+	#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+	#define GL_TIMEOUT_EXPIRED 0x911B
+	#define GL_WAIT_FAILED 0x911D
+#endif
+
+// GLsync is only a handle and older headers don't have it
+typedef void *Sync_Handle;
+
+typedef void (APIENTRY *Gen_Buffers_Func)( GLsizei n, GLuint *buffers );
+typedef void (APIENTRY *Delete_Buffers_Func)( GLsizei n, const GLuint *buffers );
+typedef void (APIENTRY *Bind_Buffer_Func)( GLenum target, GLuint buffer );
+typedef void (APIENTRY *Buffer_Data_Func)( GLenum target, ptrdiff_t size, const GLvoid *data, GLenum usage );
+typedef GLvoid *(APIENTRY *Map_Buffer_Func)( GLenum target, GLenum access );
+typedef GLboolean (APIENTRY *Unmap_Buffer_Func)( GLenum target );
+typedef Sync_Handle (APIENTRY *Fence_Sync_Func)( GLenum condition, GLbitfield flags );
+typedef GLenum (APIENTRY *Client_Wait_Sync_Func)( Sync_Handle sync, GLbitfield flags, Uint64 timeout );
+typedef void (APIENTRY *Delete_Sync_Func)( Sync_Handle sync );
+
+static Gen_Buffers_Func smc_glGenBuffers = NULL;
+static Delete_Buffers_Func smc_glDeleteBuffers = NULL;
+static Bind_Buffer_Func smc_glBindBuffer = NULL;
+static Buffer_Data_Func smc_glBufferData = NULL;
+static Map_Buffer_Func smc_glMapBuffer = NULL;
+static Unmap_Buffer_Func smc_glUnmapBuffer = NULL;
+static Fence_Sync_Func smc_glFenceSync = NULL;
+static Client_Wait_Sync_Func smc_glClientWaitSync = NULL;
+static Delete_Sync_Func smc_glDeleteSync = NULL;
+
+// highest screenshot number
+static const unsigned int screenshot_max_index = 999;
+// frames to wait for the fence before the buffer is mapped anyway
+static const unsigned int screenshot_max_wait_frames = 4;
+
+/* *** *** *** *** *** *** *** cScreenshot_Writer *** *** *** *** *** *** *** *** *** *** */
+
+cScreenshot_Writer :: cScreenshot_Writer( void )
+{
+	m_next_index = 0;
+
+	m_buffer = 0;
+	m_buffer_size = 0;
+	m_fence = NULL;
+	m_read_index = 0;
+	m_read_width = 0;
+	m_read_height = 0;
+	m_read_frames = 0;
+	m_sync = 0;
+
+	m_task_group = pTask_Pool->Create_Group();
+}
+
+cScreenshot_Writer :: ~cScreenshot_Writer( void )
+{
+	Exit();
+
+	// the saved messages are not shown anymore
+	pTask_Pool->Wait( m_task_group );
+	pTask_Pool->Cancel( m_task_group );
+}
+
+bool cScreenshot_Writer :: Init( void )
+{
+	Exit();
+
+	const char *extensions = reinterpret_cast<const char *>(glGetString( GL_EXTENSIONS ));
+
+	if( !extensions || !strstr( extensions, "GL_ARB_pixel_buffer_object" ) )
+	{
+		return 0;
+	}
+
+	smc_glGenBuffers = reinterpret_cast<Gen_Buffers_Func>(SDL_GL_GetProcAddress( "glGenBuffersARB" ));
+	smc_glDeleteBuffers = reinterpret_cast<Delete_Buffers_Func>(SDL_GL_GetProcAddress( "glDeleteBuffersARB" ));
+	smc_glBindBuffer = reinterpret_cast<Bind_Buffer_Func>(SDL_GL_GetProcAddress( "glBindBufferARB" ));
+	smc_glBufferData = reinterpret_cast<Buffer_Data_Func>(SDL_GL_GetProcAddress( "glBufferDataARB" ));
+	smc_glMapBuffer = reinterpret_cast<Map_Buffer_Func>(SDL_GL_GetProcAddress( "glMapBufferARB" ));
+	smc_glUnmapBuffer = reinterpret_cast<Unmap_Buffer_Func>(SDL_GL_GetProcAddress( "glUnmapBufferARB" ));
+
+	if( !smc_glGenBuffers || !smc_glDeleteBuffers || !smc_glBindBuffer || !smc_glBufferData || !smc_glMapBuffer || !smc_glUnmapBuffer )
+	{
+		printf( "Warning : cScreenshot_Writer : buffer object functions not found\n" );
+		return 0;
+	}
+
+	// without fences the buffer is mapped the next frame
+	if( strstr( extensions, "GL_ARB_sync" ) )
+	{
+		smc_glFenceSync = reinterpret_cast<Fence_Sync_Func>(SDL_GL_GetProcAddress( "glFenceSync" ));
+		smc_glClientWaitSync = reinterpret_cast<Client_Wait_Sync_Func>(SDL_GL_GetProcAddress( "glClientWaitSync" ));
+		smc_glDeleteSync = reinterpret_cast<Delete_Sync_Func>(SDL_GL_GetProcAddress( "glDeleteSync" ));
+
+		m_sync = smc_glFenceSync && smc_glClientWaitSync && smc_glDeleteSync;
+	}
+
+	smc_glGenBuffers( 1, &m_buffer );
+
+	if( !m_buffer )
+	{
+		printf( "Warning : cScreenshot_Writer : buffer generation failed\n" );
+		Exit();
+		return 0;
+	}
+
+	return 1;
+}
+
+void cScreenshot_Writer :: Exit( void )
+{
+	// a read back of the old context is lost
+	if( m_read_index )
+	{
+		printf( "Warning : Screenshot %d could not be saved\n", m_read_index );
+		m_read_index = 0;
+	}
+
+	if( m_fence )
+	{
+		smc_glDeleteSync( m_fence );
+		m_fence = NULL;
+	}
+
+	if( m_buffer )
+	{
+		smc_glDeleteBuffers( 1, &m_buffer );
+		m_buffer = 0;
+	}
+
+	m_buffer_size = 0;
+	m_sync = 0;
+}
+
+void cScreenshot_Writer :: Request( void )
+{
+	boost::mutex::scoped_lock lock( m_mutex );
+
+	// only searched once as the numbers are used in order
+	if( !m_next_index )
+	{
+		m_next_index = 1;
+
+		while( m_next_index <= screenshot_max_index && File_Exists( pResource_Manager->user_data_dir + USER_SCREENSHOT_DIR "/" + int_to_string( m_next_index ) + ".png" ) )
+		{
+			m_next_index++;
+		}
+	}
+
+	if( m_next_index > screenshot_max_index )
+	{
+		printf( "Warning : No free screenshot filename\n" );
+		return;
+	}
+
+	m_requests.push_back( m_next_index );
+	m_next_index++;
+}
+
+void cScreenshot_Writer :: Frame_End( void )
+{
+	if( m_read_index )
+	{
+		Finish_Read();
+
+		// only one frame is read back at a time
+		if( m_read_index )
+		{
+			return;
+		}
+	}
+
+	unsigned int index = 0;
+
+	{
+		boost::mutex::scoped_lock lock( m_mutex );
+
+		if( m_requests.empty() )
+		{
+			return;
+		}
+
+		index = m_requests.front();
+		m_requests.erase( m_requests.begin() );
+	}
+
+	Read_Frame( index );
+}
+
+void cScreenshot_Writer :: Read_Frame( unsigned int index )
+{
+	const unsigned int width = pPreferences->m_video_screen_w;
+	const unsigned int height = pPreferences->m_video_screen_h;
+	const unsigned int size = width * height * 3;
+
+	// the rows are not padded
+	glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+
+	if( !m_buffer )
+	{
+		unsigned char *data = new unsigned char[size];
+		glReadPixels( 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, static_cast<GLvoid *>(data) );
+		glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+
+		Write( index, data, width, height );
+		return;
+	}
+
+	smc_glBindBuffer( GL_PIXEL_PACK_BUFFER_ARB, m_buffer );
+
+	if( m_buffer_size < size )
+	{
+		smc_glBufferData( GL_PIXEL_PACK_BUFFER_ARB, size, NULL, GL_STREAM_READ_ARB );
+		m_buffer_size = size;
+	}
+
+	// the pixels pointer is an offset into the bound buffer and this returns without waiting
+	glReadPixels( 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, NULL );
+
+	// client memory pointers are used again
+	smc_glBindBuffer( GL_PIXEL_PACK_BUFFER_ARB, 0 );
+	glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+
+	if( m_sync )
+	{
+		m_fence = smc_glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+	}
+
+	m_read_index = index;
+	m_read_width = width;
+	m_read_height = height;
+	m_read_frames = 0;
+}
+
+void cScreenshot_Writer :: Finish_Read( void )
+{
+	m_read_frames++;
+
+	if( m_fence )
+	{
+		const GLenum result = smc_glClientWaitSync( m_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0 );
+
+		// try again the next frame
+		if( result == GL_TIMEOUT_EXPIRED && m_read_frames < screenshot_max_wait_frames )
+		{
+			return;
+		}
+
+		smc_glDeleteSync( m_fence );
+		m_fence = NULL;
+	}
+
+	const unsigned int index = m_read_index;
+	const unsigned int size = m_read_width * m_read_height * 3;
+	m_read_index = 0;
+
+	smc_glBindBuffer( GL_PIXEL_PACK_BUFFER_ARB, m_buffer );
+
+	unsigned char *data = NULL;
+	const GLvoid *pixels = smc_glMapBuffer( GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB );
+
+	if( pixels )
+	{
+		data = new unsigned char[size];
+		memcpy( data, pixels, size );
+
+		// the buffer data can be lost because of a mode change
+		if( !smc_glUnmapBuffer( GL_PIXEL_PACK_BUFFER_ARB ) )
+		{
+			delete[] data;
+			data = NULL;
+		}
+	}
+
+	smc_glBindBuffer( GL_PIXEL_PACK_BUFFER_ARB, 0 );
+
+	if( !data )
+	{
+		printf( "Warning : Screenshot %d could not be read\n", index );
+		return;
+	}
+
+	Write( index, data, m_read_width, m_read_height );
+}
+
+void cScreenshot_Writer :: Write( unsigned int index, unsigned char *data, unsigned int width, unsigned int height )
+{
+	const std::string filename = pResource_Manager->user_data_dir + USER_SCREENSHOT_DIR "/" + int_to_string( index ) + ".png";
+
+	pTask_Pool->Add( boost::bind( &cScreenshot_Writer::Write_Task, filename, index, data, width, height, m_task_group ), TASK_PRIORITY_BACKGROUND, m_task_group, "screenshot" );
+}
+
+void cScreenshot_Writer :: Write_Task( std::string filename, unsigned int index, unsigned char *data, unsigned int width, unsigned int height, unsigned int group )
+{
+	pVideo->Save_Surface( filename, data, width, height, 3, 1 );
+	delete[] data;
+
+	// the HUD is only changed by the main thread
+	pTask_Pool->Add_Main_Thread( boost::bind( &cScreenshot_Writer::Show_Saved, index ), group );
+}
+
+void cScreenshot_Writer :: Show_Saved( unsigned int index )
+{
+	pHud_Debug->Set_Text( "Screenshot " + int_to_string( index ) + _(" saved"), speedfactor_fps * 2.5f );
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,109 @@
+/***************************************************************************
+ * screenshot.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_SCREENSHOT_H
+#define SMC_SCREENSHOT_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL.h"
+#include "SDL_opengl.h"
+// boost thread
+#include <boost/thread/mutex.hpp>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cScreenshot_Writer *** *** *** *** *** *** *** *** *** *** */
+
+/* Saves screenshots without stopping the game
+ * the frame is read back into a pixel buffer object before the buffer swap
+ * and taken a frame later when its fence is signaled
+ * the image is encoded and written by the task pool
+ * without GL_ARB_pixel_buffer_object the frame is read directly
+ * but still written in the background
+*/
+class cScreenshot_Writer
+{
+public:
+	cScreenshot_Writer( void );
+	// Waits until the taken screenshots are written
+	~cScreenshot_Writer( void );
+
+	/* Check the extensions and load the functions
+	 * must be called again for a new opengl context
+	 * returns false if the frame is read back directly
+	*/
+	bool Init( void );
+	// Delete the buffer and fence
+	void Exit( void );
+
+	/* Take a screenshot of the next rendered frame
+	 * can be called from the main thread while the render thread is drawing
+	*/
+	void Request( void );
+
+	/* Read back the requested frame and take the finished read back
+	 * must be called by the thread with the opengl context before the buffer swap
+	*/
+	void Frame_End( void );
+
+private:
+	// Start reading the frame for the requested screenshot
+	void Read_Frame( unsigned int index );
+	// Take the pixels if the read back is finished
+	void Finish_Read( void );
+	// Encode and write the pixels with the task pool
+	void Write( unsigned int index, unsigned char *data, unsigned int width, unsigned int height );
+
+	/* Task function which encodes and writes the image
+	 * the pixel data is deleted afterwards
+	*/
+	static void Write_Task( std::string filename, unsigned int index, unsigned char *data, unsigned int width, unsigned int height, unsigned int group );
+	// Main thread function which shows the saved message
+	static void Show_Saved( unsigned int index );
+
+	// protects the requested screenshots
+	boost::mutex m_mutex;
+	// requested screenshot numbers not yet read
+	vector<unsigned int> m_requests;
+	// next free screenshot number or 0 if not searched yet
+	unsigned int m_next_index;
+
+	// read back buffer
+	GLuint m_buffer;
+	// allocated size
+	unsigned int m_buffer_size;
+	// GLsync of the read back or NULL
+	void *m_fence;
+	// screenshot number being read back or 0 if none
+	unsigned int m_read_index;
+	// size of the frame being read back
+	unsigned int m_read_width;
+	unsigned int m_read_height;
+	// frames since the read back was started
+	unsigned int m_read_frames;
+	// if fences are available
+	bool m_sync;
+
+	// task pool group of the writes
+	unsigned int m_task_group;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -0,0 +1,371 @@
+/***************************************************************************
+ * sprite_shader.cpp  -  shader program for batched sprites
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/sprite_shader.h"
+#include <cstdio>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** Extension *** *** *** *** *** *** *** *** *** *** */
+
+#ifndef APIENTRY
+	#define APIENTRY
+#endif
+#ifndef GL_VERTEX_SHADER
+	#define GL_VERTEX_SHADER 0x8B31
+	#define GL_COMPILE_STATUS 0x8B81
+	#define GL_LINK_STATUS 0x8B82
+	#define GL_INFO_LOG_LENGTH 0x8B84
+#endif
+#ifndef GL_FRAGMENT_SHADER
+	#define GL_FRAGMENT_SHADER 0x8B30
+#endif
+
+typedef GLuint (APIENTRY *Create_Shader_Func)( GLenum type );
+typedef void (APIENTRY *Delete_Shader_Func)( GLuint shader );
+typedef void (APIENTRY *Shader_Source_Func)( GLuint shader, GLsizei count, const char **string, const GLint *length );
+typedef void (APIENTRY *Compile_Shader_Func)( GLuint shader );
+typedef void (APIENTRY *Get_Shader_Iv_Func)( GLuint shader, GLenum pname, GLint *params );
+typedef void (APIENTRY *Get_Shader_Info_Log_Func)( GLuint shader, GLsizei max_length, GLsizei *length, char *info_log );
+typedef GLuint (APIENTRY *Create_Program_Func)( void );
+typedef void (APIENTRY *Delete_Program_Func)( GLuint program );
+typedef void (APIENTRY *Attach_Shader_Func)( GLuint program, GLuint shader );
+typedef void (APIENTRY *Bind_Attrib_Location_Func)( GLuint program, GLuint index, const char *name );
+typedef void (APIENTRY *Link_Program_Func)( GLuint program );
+typedef void (APIENTRY *Get_Program_Iv_Func)( GLuint program, GLenum pname, GLint *params );
+typedef void (APIENTRY *Get_Program_Info_Log_Func)( GLuint program, GLsizei max_length, GLsizei *length, char *info_log );
+typedef void (APIENTRY *Use_Program_Func)( GLuint program );
+typedef GLint (APIENTRY *Get_Uniform_Location_Func)( GLuint program, const char *name );
+typedef void (APIENTRY *Uniform_1f_Func)( GLint location, GLfloat v0 );
+typedef void (APIENTRY *Vertex_Attrib_Pointer_Func)( GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid *pointer );
+typedef void (APIENTRY *Vertex_Attrib_Array_Func)( GLuint index );
+
+static Create_Shader_Func smc_glCreateShader = NULL;
+static Delete_Shader_Func smc_glDeleteShader = NULL;
+static Shader_Source_Func smc_glShaderSource = NULL;
+static Compile_Shader_Func smc_glCompileShader = NULL;
+static Get_Shader_Iv_Func smc_glGetShaderiv = NULL;
+static Get_Shader_Info_Log_Func smc_glGetShaderInfoLog = NULL;
+static Create_Program_Func smc_glCreateProgram = NULL;
+static Delete_Program_Func smc_glDeleteProgram = NULL;
+static Attach_Shader_Func smc_glAttachShader = NULL;
+static Bind_Attrib_Location_Func smc_glBindAttribLocation = NULL;
+static Link_Program_Func smc_glLinkProgram = NULL;
+static Get_Program_Iv_Func smc_glGetProgramiv = NULL;
+static Get_Program_Info_Log_Func smc_glGetProgramInfoLog = NULL;
+static Use_Program_Func smc_glUseProgram = NULL;
+static Get_Uniform_Location_Func smc_glGetUniformLocation = NULL;
+static Uniform_1f_Func smc_glUniform1f = NULL;
+static Vertex_Attrib_Pointer_Func smc_glVertexAttribPointer = NULL;
+static Vertex_Attrib_Array_Func smc_glEnableVertexAttribArray = NULL;
+static Vertex_Attrib_Array_Func smc_glDisableVertexAttribArray = NULL;
+
+/* The transformation of cSurface_Request::Draw
+ * the vertex is the center with the camera and global scale already applied
+ * and the corner is rotated before it is scaled like with the matrix stack
+*/
+static const char *sprite_vertex_shader =
+	"#version 110\n"
+	"attribute vec4 corner;\n"
+	"attribute vec3 rot;\n"
+	"attribute vec4 combine;\n"
+	"varying vec4 combine_color;\n"
+	"void main()\n"
+	"{\n"
+	"	vec3 angle = radians( rot );\n"
+	"	vec3 c = cos( angle );\n"
+	"	vec3 s = sin( angle );\n"
+	// z axis
+	"	float x1 = corner.x * c.z - corner.y * s.z;\n"
+	"	float y1 = corner.x * s.z + corner.y * c.z;\n"
+	// y axis
+	"	float x2 = x1 * c.y;\n"
+	"	float z2 = -x1 * s.y;\n"
+	// x axis
+	"	float y3 = y1 * c.x - z2 * s.x;\n"
+	"	float z3 = y1 * s.x + z2 * c.x;\n"
+	// the depth is not scaled
+	"	gl_Position = gl_ModelViewProjectionMatrix * vec4( gl_Vertex.x + x2 * corner.z, gl_Vertex.y + y3 * corner.w, gl_Vertex.z + z3, 1.0 );\n"
+	"	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+	"	gl_FrontColor = gl_Color;\n"
+	"	combine_color = combine;\n"
+	"}\n";
+
+/* The texture combine of cGL_State::Set_Combine
+ * the combine color is the first and the texture the second argument
+ * and the alpha is always modulated
+*/
+static const char *sprite_fragment_shader =
+	"#version 110\n"
+	"uniform sampler2D image;\n"
+	"uniform float textured;\n"
+	"varying vec4 combine_color;\n"
+	"void main()\n"
+	"{\n"
+	"	if( textured < 0.5 )\n"
+	"	{\n"
+	"		gl_FragColor = gl_Color;\n"
+	"		return;\n"
+	"	}\n"
+	"	vec4 tex = texture2D( image, gl_TexCoord[0].xy );\n"
+	"	vec3 color;\n"
+	// default modulation
+	"	if( combine_color.w < 0.5 )\n"
+	"	{\n"
+	"		color = gl_Color.rgb * tex.rgb;\n"
+	"	}\n"
+	// replace
+	"	else if( combine_color.w < 1.5 )\n"
+	"	{\n"
+	"		color = combine_color.rgb;\n"
+	"	}\n"
+	// modulate
+	"	else if( combine_color.w < 2.5 )\n"
+	"	{\n"
+	"		color = combine_color.rgb * tex.rgb;\n"
+	"	}\n"
+	// add
+	"	else\n"
+	"	{\n"
+	"		color = min( combine_color.rgb + tex.rgb, 1.0 );\n"
+	"	}\n"
+	"	gl_FragColor = vec4( color, gl_Color.a * tex.a );\n"
+	"}\n";
+
+/* *** *** *** *** *** *** *** cSprite_Shader *** *** *** *** *** *** *** *** *** *** */
+
+cSprite_Shader :: cSprite_Shader( void )
+{
+	m_program = 0;
+	m_vertex_shader = 0;
+	m_fragment_shader = 0;
+
+	m_uniform_textured = -1;
+}
+
+cSprite_Shader :: ~cSprite_Shader( void )
+{
+	Exit();
+}
+
+bool cSprite_Shader :: Init( void )
+{
+	Exit();
+
+	const char *version = reinterpret_cast<const char *>(glGetString( GL_VERSION ));
+
+	if( !version || version[0] < '2' || version[0] > '9' )
+	{
+		printf( "Warning : cSprite_Shader : OpenGL 2.0 is not supported\n" );
+		return 0;
+	}
+
+	smc_glCreateShader = reinterpret_cast<Create_Shader_Func>(SDL_GL_GetProcAddress( "glCreateShader" ));
+	smc_glDeleteShader = reinterpret_cast<Delete_Shader_Func>(SDL_GL_GetProcAddress( "glDeleteShader" ));
+	smc_glShaderSource = reinterpret_cast<Shader_Source_Func>(SDL_GL_GetProcAddress( "glShaderSource" ));
+	smc_glCompileShader = reinterpret_cast<Compile_Shader_Func>(SDL_GL_GetProcAddress( "glCompileShader" ));
+	smc_glGetShaderiv = reinterpret_cast<Get_Shader_Iv_Func>(SDL_GL_GetProcAddress( "glGetShaderiv" ));
+	smc_glGetShaderInfoLog = reinterpret_cast<Get_Shader_Info_Log_Func>(SDL_GL_GetProcAddress( "glGetShaderInfoLog" ));
+	smc_glCreateProgram = reinterpret_cast<Create_Program_Func>(SDL_GL_GetProcAddress( "glCreateProgram" ));
+	smc_glDeleteProgram = reinterpret_cast<Delete_Program_Func>(SDL_GL_GetProcAddress( "glDeleteProgram" ));
+	smc_glAttachShader = reinterpret_cast<Attach_Shader_Func>(SDL_GL_GetProcAddress( "glAttachShader" ));
+	smc_glBindAttribLocation = reinterpret_cast<Bind_Attrib_Location_Func>(SDL_GL_GetProcAddress( "glBindAttribLocation" ));
+	smc_glLinkProgram = reinterpret_cast<Link_Program_Func>(SDL_GL_GetProcAddress( "glLinkProgram" ));
+	smc_glGetProgramiv = reinterpret_cast<Get_Program_Iv_Func>(SDL_GL_GetProcAddress( "glGetProgramiv" ));
+	smc_glGetProgramInfoLog = reinterpret_cast<Get_Program_Info_Log_Func>(SDL_GL_GetProcAddress( "glGetProgramInfoLog" ));
+	smc_glUseProgram = reinterpret_cast<Use_Program_Func>(SDL_GL_GetProcAddress( "glUseProgram" ));
+	smc_glGetUniformLocation = reinterpret_cast<Get_Uniform_Location_Func>(SDL_GL_GetProcAddress( "glGetUniformLocation" ));
+	smc_glUniform1f = reinterpret_cast<Uniform_1f_Func>(SDL_GL_GetProcAddress( "glUniform1f" ));
+	smc_glVertexAttribPointer = reinterpret_cast<Vertex_Attrib_Pointer_Func>(SDL_GL_GetProcAddress( "glVertexAttribPointer" ));
+	smc_glEnableVertexAttribArray = reinterpret_cast<Vertex_Attrib_Array_Func>(SDL_GL_GetProcAddress( "glEnableVertexAttribArray" ));
+	smc_glDisableVertexAttribArray = reinterpret_cast<Vertex_Attrib_Array_Func>(SDL_GL_GetProcAddress( "glDisableVertexAttribArray" ));
+
+	if( !smc_glCreateShader || !smc_glDeleteShader || !smc_glShaderSource || !smc_glCompileShader || !smc_glGetShaderiv || !smc_glGetShaderInfoLog ||
+		!smc_glCreateProgram || !smc_glDeleteProgram || !smc_glAttachShader || !smc_glBindAttribLocation || !smc_glLinkProgram ||
+		!smc_glGetProgramiv || !smc_glGetProgramInfoLog || !smc_glUseProgram || !smc_glGetUniformLocation || !smc_glUniform1f ||
+		!smc_glVertexAttribPointer || !smc_glEnableVertexAttribArray || !smc_glDisableVertexAttribArray )
+	{
+		printf( "Warning : cSprite_Shader : shader functions not found\n" );
+		return 0;
+	}
+
+	if( !Create_Program() )
+	{
+		Exit();
+		return 0;
+	}
+
+	return 1;
+}
+
+void cSprite_Shader :: Exit( void )
+{
+	if( m_program )
+	{
+		smc_glDeleteProgram( m_program );
+		m_program = 0;
+	}
+
+	if( m_vertex_shader )
+	{
+		smc_glDeleteShader( m_vertex_shader );
+		m_vertex_shader = 0;
+	}
+
+	if( m_fragment_shader )
+	{
+		smc_glDeleteShader( m_fragment_shader );
+		m_fragment_shader = 0;
+	}
+}
+
+void cSprite_Shader :: Use( bool textured, const GLfloat *corners, const GLfloat *rotations, const GLfloat *combine ) const
+{
+	smc_glUseProgram( m_program );
+
+	// the image sampler keeps the default texture unit 0
+	smc_glUniform1f( m_uniform_textured, textured ? 1.0f : 0.0f );
+
+	smc_glEnableVertexAttribArray( ATTRIB_CORNER );
+	smc_glVertexAttribPointer( ATTRIB_CORNER, 4, GL_FLOAT, GL_FALSE, 0, corners );
+	smc_glEnableVertexAttribArray( ATTRIB_ROT );
+	smc_glVertexAttribPointer( ATTRIB_ROT, 3, GL_FLOAT, GL_FALSE, 0, rotations );
+	smc_glEnableVertexAttribArray( ATTRIB_COMBINE );
+	smc_glVertexAttribPointer( ATTRIB_COMBINE, 4, GL_FLOAT, GL_FALSE, 0, combine );
+}
+
+void cSprite_Shader :: Unuse( void ) const
+{
+	smc_glDisableVertexAttribArray( ATTRIB_CORNER );
+	smc_glDisableVertexAttribArray( ATTRIB_ROT );
+	smc_glDisableVertexAttribArray( ATTRIB_COMBINE );
+
+	smc_glUseProgram( 0 );
+}
+
+float cSprite_Shader :: Get_Combine_Mode( GLint combine_type )
+{
+	switch( combine_type )
+	{
+		case 0:
+		{
+			return 0.0f;
+		}
+		case GL_REPLACE:
+		{
+			return 1.0f;
+		}
+		case GL_MODULATE:
+		{
+			return 2.0f;
+		}
+		case GL_ADD:
+		{
+			return 3.0f;
+		}
+		default:
+		{
+			break;
+		}
+	}
+
+	return -1.0f;
+}
+
+bool cSprite_Shader :: Create_Program( void )
+{
+	m_vertex_shader = Compile_Shader( GL_VERTEX_SHADER, sprite_vertex_shader );
+
+	if( !m_vertex_shader )
+	{
+		return 0;
+	}
+
+	m_fragment_shader = Compile_Shader( GL_FRAGMENT_SHADER, sprite_fragment_shader );
+
+	if( !m_fragment_shader )
+	{
+		return 0;
+	}
+
+	m_program = smc_glCreateProgram();
+
+	if( !m_program )
+	{
+		printf( "Warning : cSprite_Shader : program creation failed\n" );
+		return 0;
+	}
+
+	smc_glAttachShader( m_program, m_vertex_shader );
+	smc_glAttachShader( m_program, m_fragment_shader );
+
+	// must be set before linking
+	smc_glBindAttribLocation( m_program, ATTRIB_CORNER, "corner" );
+	smc_glBindAttribLocation( m_program, ATTRIB_ROT, "rot" );
+	smc_glBindAttribLocation( m_program, ATTRIB_COMBINE, "combine" );
+
+	GLint status = 0;
+	smc_glLinkProgram( m_program );
+	smc_glGetProgramiv( m_program, GL_LINK_STATUS, &status );
+
+	if( !status )
+	{
+		char info_log[1024];
+		info_log[0] = '\0';
+		smc_glGetProgramInfoLog( m_program, sizeof(info_log), NULL, info_log );
+
+		printf( "Warning : cSprite_Shader : linking failed : %s\n", info_log );
+		return 0;
+	}
+
+	m_uniform_textured = smc_glGetUniformLocation( m_program, "textured" );
+
+	return 1;
+}
+
+GLuint cSprite_Shader :: Compile_Shader( GLenum type, const char *source ) const
+{
+	GLuint shader = smc_glCreateShader( type );
+
+	if( !shader )
+	{
+		printf( "Warning : cSprite_Shader : shader creation failed\n" );
+		return 0;
+	}
+
+	smc_glShaderSource( shader, 1, &source, NULL );
+	smc_glCompileShader( shader );
+
+	GLint status = 0;
+	smc_glGetShaderiv( shader, GL_COMPILE_STATUS, &status );
+
+	if( !status )
+	{
+		char info_log[1024];
+		info_log[0] = '\0';
+		smc_glGetShaderInfoLog( shader, sizeof(info_log), NULL, info_log );
+
+		printf( "Warning : cSprite_Shader : compiling failed : %s\n", info_log );
+		smc_glDeleteShader( shader );
+		return 0;
+	}
+
+	return shader;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
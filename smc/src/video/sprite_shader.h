@@ -0,0 +1,90 @@
+/***************************************************************************
+ * sprite_shader.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_SPRITE_SHADER_H
+#define SMC_SPRITE_SHADER_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cSprite_Shader *** *** *** *** *** *** *** *** *** *** */
+
+/* Shader program for the batch renderer
+ * the rotation, scale and color combine of every quad are vertex attributes
+ * which lets sprites with different effects and their shadows share a batch
+ * the fixed function texture combine is replaced by the fragment shader
+ * needs opengl 2.0
+*/
+class cSprite_Shader
+{
+public:
+	cSprite_Shader( void );
+	~cSprite_Shader( void );
+
+	/* Check the version, load the functions and compile the shaders
+	 * must be called again for a new opengl context
+	 * returns false if shaders are not supported
+	*/
+	bool Init( void );
+	// Delete the shader program
+	void Exit( void );
+
+	/* Use the program and enable the attribute arrays
+	 * textured : if unset the texture and combine color are ignored
+	 * corners : offset from the vertex position and scale (x, y, scale x, scale y) per vertex
+	 * rotations : rotation in degrees (x, y, z) per vertex
+	 * combine : combine color and mode (r, g, b, mode) per vertex
+	*/
+	void Use( bool textured, const GLfloat *corners, const GLfloat *rotations, const GLfloat *combine ) const;
+	// Disable the attribute arrays and use the fixed function pipeline again
+	void Unuse( void ) const;
+
+	/* Returns the shader mode of the texture combine type
+	 * or a negative value if the shader does not support it
+	*/
+	static float Get_Combine_Mode( GLint combine_type );
+
+	// generic vertex attribute locations
+	enum Attribute
+	{
+		ATTRIB_CORNER = 1,
+		ATTRIB_ROT = 2,
+		ATTRIB_COMBINE = 3
+	};
+
+private:
+	// Compile the shaders and link the program
+	bool Create_Program( void );
+	// Compile a shader and return it or 0 on failure
+	GLuint Compile_Shader( GLenum type, const char *source ) const;
+
+	GLuint m_program;
+	GLuint m_vertex_shader;
+	GLuint m_fragment_shader;
+
+	// uniform locations
+	GLint m_uniform_textured;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
@@ -0,0 +1,257 @@
+/***************************************************************************
+ * texture_atlas.cpp  -  Packing of small images into large textures
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/texture_atlas.h"
+#include "../video/gl_surface.h"
+#include "../video/video.h"
+#include "../video/img_manager.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** cTexture_Atlas_Page *** *** *** *** *** *** *** *** *** *** *** */
+
+cTexture_Atlas_Page :: cTexture_Atlas_Page( GLuint texture, unsigned int size )
+{
+	m_texture = texture;
+	m_size = size;
+	m_used_height = 0;
+}
+
+cTexture_Atlas_Page :: ~cTexture_Atlas_Page( void )
+{
+	if( glIsTexture( m_texture ) )
+	{
+		glDeleteTextures( 1, &m_texture );
+	}
+}
+
+bool cTexture_Atlas_Page :: Insert( unsigned int width, unsigned int height, unsigned int &x, unsigned int &y )
+{
+	if( width > m_size || height > m_size )
+	{
+		return 0;
+	}
+
+	// find the lowest shelf with enough space
+	Shelf *best = NULL;
+
+	for( Shelf_List::iterator itr = m_shelves.begin(); itr != m_shelves.end(); ++itr )
+	{
+		Shelf &shelf = (*itr);
+
+		if( shelf.m_height < height || shelf.m_used + width > m_size )
+		{
+			continue;
+		}
+
+		// don't waste more than half of the shelf height
+		if( shelf.m_height > height * 2 )
+		{
+			continue;
+		}
+
+		if( !best || shelf.m_height < best->m_height )
+		{
+			best = &shelf;
+		}
+	}
+
+	// create a new shelf
+	if( !best )
+	{
+		if( m_used_height + height > m_size )
+		{
+			return 0;
+		}
+
+		Shelf shelf;
+		shelf.m_y = m_used_height;
+		shelf.m_height = height;
+		shelf.m_used = 0;
+
+		m_used_height += height;
+		m_shelves.push_back( shelf );
+		best = &m_shelves.back();
+	}
+
+	x = best->m_used;
+	y = best->m_y;
+	best->m_used += width;
+
+	return 1;
+}
+
+/* *** *** *** *** *** *** cTexture_Atlas *** *** *** *** *** *** *** *** *** *** *** */
+
+cTexture_Atlas :: cTexture_Atlas( void )
+{
+	m_page_size = 2048;
+	m_max_image_size = 256;
+	m_image_count = 0;
+}
+
+cTexture_Atlas :: ~cTexture_Atlas( void )
+{
+	Clear();
+}
+
+bool cTexture_Atlas :: Is_Atlas_Image( const std::string &filename ) const
+{
+	// only small images which are used often
+	if( filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/ground/" ) == 0 ||
+		filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/blocks/" ) == 0 ||
+		filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/game/items/" ) == 0 ||
+		filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/pipes/" ) == 0 )
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+bool cTexture_Atlas :: Add( cGL_Surface *image, const unsigned char *pixels, unsigned int width, unsigned int height, unsigned int row_length )
+{
+	if( !image || !pixels )
+	{
+		return 0;
+	}
+
+	// the page size depends on the video card
+	unsigned int page_size = m_page_size;
+
+	if( page_size > static_cast<unsigned int>(pVideo->m_max_texture_size) )
+	{
+		page_size = pVideo->m_max_texture_size;
+	}
+
+	// too big
+	if( width > m_max_image_size || height > m_max_image_size || width * 4 > page_size || height * 4 > page_size )
+	{
+		return 0;
+	}
+
+	// one pixel border on each side against filtering with the neighbours
+	const unsigned int area_w = width + 2;
+	const unsigned int area_h = height + 2;
+
+	cTexture_Atlas_Page *page = NULL;
+	unsigned int x = 0;
+	unsigned int y = 0;
+
+	for( Texture_Atlas_Page_List::iterator itr = m_pages.begin(); itr != m_pages.end(); ++itr )
+	{
+		if( (*itr)->Insert( area_w, area_h, x, y ) )
+		{
+			page = (*itr);
+			break;
+		}
+	}
+
+	// create a new page
+	if( !page )
+	{
+		GLuint texture = 0;
+		glGenTextures( 1, &texture );
+
+		if( !texture )
+		{
+			printf( "Warning : cTexture_Atlas : GL page generation failed\n" );
+			return 0;
+		}
+
+		// set highest texture id
+		if( pImage_Manager->m_high_texture_id < texture )
+		{
+			pImage_Manager->m_high_texture_id = texture;
+		}
+
+		glBindTexture( GL_TEXTURE_2D, texture );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+		glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, page_size, page_size, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+
+		page = new cTexture_Atlas_Page( texture, page_size );
+		m_pages.push_back( page );
+
+		debug_print( "Info : cTexture_Atlas : created page %d with size %d\n", static_cast<int>(m_pages.size()), page_size );
+
+		if( !page->Insert( area_w, area_h, x, y ) )
+		{
+			return 0;
+		}
+	}
+
+	// copy with the edge pixels repeated into the border
+	vector<unsigned char> data( area_w * area_h * 4 );
+
+	for( unsigned int row = 0; row < area_h; row++ )
+	{
+		unsigned int src_row = row > 0 ? row - 1 : 0;
+
+		if( src_row >= height )
+		{
+			src_row = height - 1;
+		}
+
+		const unsigned char *src = pixels + src_row * row_length * 4;
+		unsigned char *dest = &data[row * area_w * 4];
+
+		// left border
+		memcpy( dest, src, 4 );
+		memcpy( dest + 4, src, width * 4 );
+		// right border
+		memcpy( dest + ( area_w - 1 ) * 4, src + ( width - 1 ) * 4, 4 );
+	}
+
+	glBindTexture( GL_TEXTURE_2D, page->m_texture );
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+	glTexSubImage2D( GL_TEXTURE_2D, 0, x, y, area_w, area_h, GL_RGBA, GL_UNSIGNED_BYTE, &data[0] );
+
+	// set the surface to the page area without the border
+	const float size = static_cast<float>(page->m_size);
+
+	image->m_image = page->m_texture;
+	image->m_atlas_size = page->m_size;
+	image->m_tex_x1 = static_cast<float>( x + 1 ) / size;
+	image->m_tex_y1 = static_cast<float>( y + 1 ) / size;
+	image->m_tex_x2 = static_cast<float>( x + 1 + width ) / size;
+	image->m_tex_y2 = static_cast<float>( y + 1 + height ) / size;
+
+	m_image_count++;
+
+	return 1;
+}
+
+void cTexture_Atlas :: Clear( void )
+{
+	for( Texture_Atlas_Page_List::iterator itr = m_pages.begin(); itr != m_pages.end(); ++itr )
+	{
+		delete (*itr);
+	}
+
+	m_pages.clear();
+	m_image_count = 0;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+cTexture_Atlas *pTexture_Atlas = NULL;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
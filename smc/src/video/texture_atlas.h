@@ -0,0 +1,110 @@
+/***************************************************************************
+ * texture_atlas.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_TEXTURE_ATLAS_H
+#define SMC_TEXTURE_ATLAS_H
+
+#include "../core/global_basic.h"
+#include "../core/global_game.h"
+// SDL
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** cTexture_Atlas_Page *** *** *** *** *** *** *** *** *** *** *** */
+
+/* An OpenGL texture holding many small images
+ * images are packed into rows (shelves) from top to bottom
+*/
+class cTexture_Atlas_Page
+{
+public:
+	cTexture_Atlas_Page( GLuint texture, unsigned int size );
+	~cTexture_Atlas_Page( void );
+
+	/* Find a free area for the given size
+	 * returns false if it does not fit
+	*/
+	bool Insert( unsigned int width, unsigned int height, unsigned int &x, unsigned int &y );
+
+	// OpenGL texture
+	GLuint m_texture;
+	// width and height
+	unsigned int m_size;
+
+	// a row of images
+	struct Shelf
+	{
+		unsigned int m_y;
+		unsigned int m_height;
+		// used width
+		unsigned int m_used;
+	};
+
+	typedef vector<Shelf> Shelf_List;
+	Shelf_List m_shelves;
+	// used height by all shelves
+	unsigned int m_used_height;
+};
+
+typedef vector<cTexture_Atlas_Page *> Texture_Atlas_Page_List;
+
+/* *** *** *** *** *** *** cTexture_Atlas *** *** *** *** *** *** *** *** *** *** *** */
+
+/* Packs small images of the same kind like ground tiles, blocks and items
+ * into a few large textures so they can be drawn without texture switches
+ * the space of deleted images is not reused until the atlas is cleared
+*/
+class cTexture_Atlas
+{
+public:
+	cTexture_Atlas( void );
+	~cTexture_Atlas( void );
+
+	// Returns true if the image file should be added to the atlas
+	bool Is_Atlas_Image( const std::string &filename ) const;
+
+	/* Add the image to a page and set the surface texture data
+	 * pixels : RGBA data of the given texture size
+	 * row_length : pixels per row in the data
+	 * returns false if the image does not fit and needs its own texture
+	*/
+	bool Add( cGL_Surface *image, const unsigned char *pixels, unsigned int width, unsigned int height, unsigned int row_length );
+
+	// Delete all pages
+	void Clear( void );
+
+	// pages
+	Texture_Atlas_Page_List m_pages;
+	// page width and height
+	unsigned int m_page_size;
+	// maximum image width and height
+	unsigned int m_max_image_size;
+	// images added since the last clear
+	unsigned int m_image_count;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+// Texture Atlas
+extern cTexture_Atlas *pTexture_Atlas;
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
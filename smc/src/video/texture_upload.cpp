@@ -0,0 +1,262 @@
+/***************************************************************************
+ * texture_upload.cpp  -  asynchronous texture uploads
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../video/texture_upload.h"
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** Extension *** *** *** *** *** *** *** *** *** *** */
+
+#ifndef APIENTRY
+	#define APIENTRY
+#endif
+#ifndef GL_PIXEL_UNPACK_BUFFER_ARB
+	#define GL_PIXEL_UNPACK_BUFFER_ARB 0x88EC
+#endif
+#ifndef GL_STREAM_DRAW_ARB
+	#define GL_STREAM_DRAW_ARB 0x88E0
+#endif
+#ifndef GL_WRITE_ONLY_ARB
+	#define GL_WRITE_ONLY_ARB 0x88B9
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+	#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+	#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+	#define GL_TIMEOUT_EXPIRED 0x911B
+	#define GL_WAIT_FAILED 0x911D
+#endif
+
+// GLsync is only a handle and older headers don't have it
+typedef void *Sync_Handle;
+
+typedef void (APIENTRY *Gen_Buffers_Func)( GLsizei n, GLuint *buffers );
+typedef void (APIENTRY *Delete_Buffers_Func)( GLsizei n, const GLuint *buffers );
+typedef void (APIENTRY *Bind_Buffer_Func)( GLenum target, GLuint buffer );
+typedef void (APIENTRY *Buffer_Data_Func)( GLenum target, ptrdiff_t size, const GLvoid *data, GLenum usage );
+typedef GLvoid *(APIENTRY *Map_Buffer_Func)( GLenum target, GLenum access );
+typedef GLboolean (APIENTRY *Unmap_Buffer_Func)( GLenum target );
+typedef Sync_Handle (APIENTRY *Fence_Sync_Func)( GLenum condition, GLbitfield flags );
+typedef GLenum (APIENTRY *Client_Wait_Sync_Func)( Sync_Handle sync, GLbitfield flags, Uint64 timeout );
+typedef void (APIENTRY *Delete_Sync_Func)( Sync_Handle sync );
+
+static Gen_Buffers_Func smc_glGenBuffers = NULL;
+static Delete_Buffers_Func smc_glDeleteBuffers = NULL;
+static Bind_Buffer_Func smc_glBindBuffer = NULL;
+static Buffer_Data_Func smc_glBufferData = NULL;
+static Map_Buffer_Func smc_glMapBuffer = NULL;
+static Unmap_Buffer_Func smc_glUnmapBuffer = NULL;
+static Fence_Sync_Func smc_glFenceSync = NULL;
+static Client_Wait_Sync_Func smc_glClientWaitSync = NULL;
+static Delete_Sync_Func smc_glDeleteSync = NULL;
+
+// buffers used in turns
+static const unsigned int texture_upload_buffers = 4;
+// longest wait for a buffer in nanoseconds
+static const Uint64 texture_upload_timeout = 1000000000;
+
+/* *** *** *** *** *** *** *** cTexture_Upload *** *** *** *** *** *** *** *** *** *** */
+
+cTexture_Upload :: cTexture_Upload( void )
+{
+	m_next = 0;
+	m_sync = 0;
+}
+
+cTexture_Upload :: ~cTexture_Upload( void )
+{
+	Exit();
+}
+
+bool cTexture_Upload :: Init( bool context_kept /* = 1 */ )
+{
+	if( context_kept )
+	{
+		Exit();
+	}
+	// the names are not valid in the new context
+	else
+	{
+		m_buffers.clear();
+		m_next = 0;
+		m_sync = 0;
+	}
+
+	const char *extensions = reinterpret_cast<const char *>(glGetString( GL_EXTENSIONS ));
+
+	if( !extensions || !strstr( extensions, "GL_ARB_pixel_buffer_object" ) )
+	{
+		printf( "Warning : cTexture_Upload : GL_ARB_pixel_buffer_object is not supported\n" );
+		return 0;
+	}
+
+	smc_glGenBuffers = reinterpret_cast<Gen_Buffers_Func>(SDL_GL_GetProcAddress( "glGenBuffersARB" ));
+	smc_glDeleteBuffers = reinterpret_cast<Delete_Buffers_Func>(SDL_GL_GetProcAddress( "glDeleteBuffersARB" ));
+	smc_glBindBuffer = reinterpret_cast<Bind_Buffer_Func>(SDL_GL_GetProcAddress( "glBindBufferARB" ));
+	smc_glBufferData = reinterpret_cast<Buffer_Data_Func>(SDL_GL_GetProcAddress( "glBufferDataARB" ));
+	smc_glMapBuffer = reinterpret_cast<Map_Buffer_Func>(SDL_GL_GetProcAddress( "glMapBufferARB" ));
+	smc_glUnmapBuffer = reinterpret_cast<Unmap_Buffer_Func>(SDL_GL_GetProcAddress( "glUnmapBufferARB" ));
+
+	if( !smc_glGenBuffers || !smc_glDeleteBuffers || !smc_glBindBuffer || !smc_glBufferData || !smc_glMapBuffer || !smc_glUnmapBuffer )
+	{
+		printf( "Warning : cTexture_Upload : buffer object functions not found\n" );
+		return 0;
+	}
+
+	// without fences the buffer storage is replaced with every upload
+	if( strstr( extensions, "GL_ARB_sync" ) )
+	{
+		smc_glFenceSync = reinterpret_cast<Fence_Sync_Func>(SDL_GL_GetProcAddress( "glFenceSync" ));
+		smc_glClientWaitSync = reinterpret_cast<Client_Wait_Sync_Func>(SDL_GL_GetProcAddress( "glClientWaitSync" ));
+		smc_glDeleteSync = reinterpret_cast<Delete_Sync_Func>(SDL_GL_GetProcAddress( "glDeleteSync" ));
+
+		m_sync = smc_glFenceSync && smc_glClientWaitSync && smc_glDeleteSync;
+	}
+
+	for( unsigned int i = 0; i < texture_upload_buffers; i++ )
+	{
+		Upload_Buffer buffer;
+		buffer.m_buffer = 0;
+		buffer.m_size = 0;
+		buffer.m_fence = NULL;
+
+		smc_glGenBuffers( 1, &buffer.m_buffer );
+
+		if( !buffer.m_buffer )
+		{
+			printf( "Warning : cTexture_Upload : buffer generation failed\n" );
+			Exit();
+			return 0;
+		}
+
+		m_buffers.push_back( buffer );
+	}
+
+	return 1;
+}
+
+void cTexture_Upload :: Exit( void )
+{
+	for( Upload_Buffer_List::iterator itr = m_buffers.begin(); itr != m_buffers.end(); ++itr )
+	{
+		Upload_Buffer &buffer = (*itr);
+
+		if( buffer.m_fence )
+		{
+			smc_glDeleteSync( buffer.m_fence );
+		}
+
+		smc_glDeleteBuffers( 1, &buffer.m_buffer );
+	}
+
+	m_buffers.clear();
+	m_next = 0;
+	m_sync = 0;
+}
+
+bool cTexture_Upload :: Tex_Image_2D( unsigned int width, unsigned int height, const void *pixels, GLint internal_format /* = GL_RGBA */ )
+{
+	if( m_buffers.empty() || !pixels )
+	{
+		return 0;
+	}
+
+	GLint row_length = 0;
+	glGetIntegerv( GL_UNPACK_ROW_LENGTH, &row_length );
+
+	const unsigned int size = ( row_length > 0 ? row_length : width ) * height * 4;
+
+	const int buffer_num = Get_Free_Buffer();
+
+	if( buffer_num < 0 )
+	{
+		return 0;
+	}
+
+	Upload_Buffer &buffer = m_buffers[buffer_num];
+
+	smc_glBindBuffer( GL_PIXEL_UNPACK_BUFFER_ARB, buffer.m_buffer );
+
+	// a new storage lets the driver keep the old one until its upload is finished
+	if( !m_sync || buffer.m_size < size )
+	{
+		smc_glBufferData( GL_PIXEL_UNPACK_BUFFER_ARB, size, NULL, GL_STREAM_DRAW_ARB );
+		buffer.m_size = size;
+	}
+
+	GLvoid *data = smc_glMapBuffer( GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB );
+
+	if( !data )
+	{
+		smc_glBindBuffer( GL_PIXEL_UNPACK_BUFFER_ARB, 0 );
+		return 0;
+	}
+
+	memcpy( data, pixels, size );
+
+	// the buffer data can be lost because of a mode change
+	if( !smc_glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER_ARB ) )
+	{
+		smc_glBindBuffer( GL_PIXEL_UNPACK_BUFFER_ARB, 0 );
+		return 0;
+	}
+
+	// the pixels pointer is an offset into the bound buffer
+	glTexImage2D( GL_TEXTURE_2D, 0, internal_format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL );
+
+	if( m_sync )
+	{
+		buffer.m_fence = smc_glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+	}
+
+	// client memory pointers are used again
+	smc_glBindBuffer( GL_PIXEL_UNPACK_BUFFER_ARB, 0 );
+
+	return 1;
+}
+
+int cTexture_Upload :: Get_Free_Buffer( void )
+{
+	const unsigned int buffer_num = m_next;
+	m_next = ( m_next + 1 ) % m_buffers.size();
+
+	Upload_Buffer &buffer = m_buffers[buffer_num];
+
+	if( !buffer.m_fence )
+	{
+		return buffer_num;
+	}
+
+	// usually finished long ago
+	const GLenum result = smc_glClientWaitSync( buffer.m_fence, GL_SYNC_FLUSH_COMMANDS_BIT, texture_upload_timeout );
+
+	smc_glDeleteSync( buffer.m_fence );
+	buffer.m_fence = NULL;
+
+	if( result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED )
+	{
+		printf( "Warning : cTexture_Upload : waiting for the buffer failed\n" );
+		return -1;
+	}
+
+	return buffer_num;
+}
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
@@ -0,0 +1,84 @@
+/***************************************************************************
+ * texture_upload.h
+ *
+ * Copyright (C) 2011 Florian Richter
+ ***************************************************************************/
+/*
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SMC_TEXTURE_UPLOAD_H
+#define SMC_TEXTURE_UPLOAD_H
+
+#include "../core/global_basic.h"
+// SDL
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+namespace SMC
+{
+
+/* *** *** *** *** *** *** *** cTexture_Upload *** *** *** *** *** *** *** *** *** *** */
+
+/* Uploads texture pixels over pixel buffer objects
+ * the pixels are copied into a mapped buffer and the driver fills the texture from it
+ * without blocking until the transfer is finished
+ * a few buffers are used in turns and if GL_ARB_sync is available
+ * a fence for each buffer tells when it can be filled again
+ * needs the GL_ARB_pixel_buffer_object extension
+*/
+class cTexture_Upload
+{
+public:
+	cTexture_Upload( void );
+	~cTexture_Upload( void );
+
+	/* Check the extensions and load the functions
+	 * must be called again for a new opengl context
+	 * context_kept : if not set the buffers and fences of the lost context are dropped without deleting them
+	 * returns false if pixel buffer objects are not supported
+	*/
+	bool Init( bool context_kept = 1 );
+	// Delete the buffers and fences
+	void Exit( void );
+
+	/* Upload the pixels into level 0 of the bound texture like glTexImage2D
+	 * uses the current GL_UNPACK_ROW_LENGTH for the pixel data size
+	 * internal_format : the texture storage format of the rgba pixels
+	 * returns false if failed and the pixels need to be uploaded directly
+	*/
+	bool Tex_Image_2D( unsigned int width, unsigned int height, const void *pixels, GLint internal_format = GL_RGBA );
+
+private:
+	// Returns the next buffer which can be filled or -1 if failed
+	int Get_Free_Buffer( void );
+
+	// a buffer with the fence of its last upload
+	struct Upload_Buffer
+	{
+		GLuint m_buffer;
+		// allocated size
+		unsigned int m_size;
+		// GLsync of the last upload or NULL
+		void *m_fence;
+	};
+
+	typedef vector<Upload_Buffer> Upload_Buffer_List;
+	Upload_Buffer_List m_buffers;
+	// next buffer to use
+	unsigned int m_next;
+	// if fences are available
+	bool m_sync;
+};
+
+/* *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** */
+
+} // namespace SMC
+
+#endif
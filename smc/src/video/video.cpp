@@ -17,18 +17,33 @@
 #include "../gui/hud.h"
 #include "../user/preferences.h"
 #include "../core/framerate.h"
+#include "../core/profiler.h"
 #include "../video/font.h"
 #include "../core/game_core.h"
 #include "../video/img_settings.h"
 #include "../input/mouse.h"
 #include "../video/renderer.h"
+#include "../video/texture_atlas.h"
+#include "../video/render_target.h"
+#include "../video/image_loader.h"
+#include "../video/compressed_cache.h"
+#include "../video/image_cache.h"
+#include "../video/texture_upload.h"
+#include "../video/gpu_timer.h"
+#include "../video/screenshot.h"
+#include "../video/screen_transition.h"
+#include "../video/particle_shader.h"
+#include "../video/sprite_shader.h"
 #include "../core/main.h"
 #include "../core/math/utilities.h"
 #include "../core/i18n.h"
 #include "../core/math/size.h"
 #include "../core/filesystem/filesystem.h"
 #include "../core/filesystem/resource_manager.h"
+#include "../core/benchmark.h"
+#include "../level/level_manifest.h"
 #include "../gui/spinner.h"
+#include "../gui/resource_provider.h"
 // SDL
 #include "SDL_opengl.h"
 // CEGUI
@@ -48,10 +63,227 @@
 #ifndef PNG_COLOR_TYPE_RGBA
 	#define PNG_COLOR_TYPE_RGBA PNG_COLOR_TYPE_RGB_ALPHA
 #endif
+// SIMD
+#if defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )
+	#define SMC_DOWNSCALE_SSE2
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+	#define SMC_DOWNSCALE_NEON
+	#include <arm_neon.h>
+#endif
 
 namespace SMC
 {
 
+/* *** *** *** *** *** *** *** Raw image cache *** *** *** *** *** *** *** *** *** *** */
+
+// file identification and version
+static const char raw_cache_magic[4] = { 'S', 'M', 'C', 'R' };
+static const Uint32 raw_cache_version = 4;
+
+/* file header
+ * followed by the RGBA pixels of the full size texture without row padding
+ * and all mip levels down to 1x1 in the same format
+ * the cache is shared by all resolutions and the level for the current one is selected when loading
+*/
+struct Raw_Cache_Header
+{
+	char m_magic[4];
+	Uint32 m_version;
+	// full texture size
+	Uint32 m_tex_w;
+	Uint32 m_tex_h;
+	// number of levels with the base level
+	Uint32 m_levels;
+	// texture format chosen from the full size pixels when cached
+	Uint32 m_texture_format;
+};
+
+// Returns the number of mip levels down to 1x1 with the base level
+static unsigned int Get_Mip_Level_Count( unsigned int width, unsigned int height )
+{
+	unsigned int levels = 1;
+
+	while( width > 1 || height > 1 )
+	{
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+		levels++;
+	}
+
+	return levels;
+}
+
+/* Returns the raw image cache level with the given size or -1 if no level has it
+ * offset : set to the position of the level pixels after the header
+*/
+static int Get_Raw_Cache_Level( const Raw_Cache_Header &header, unsigned int width, unsigned int height, size_t &offset )
+{
+	unsigned int level_width = header.m_tex_w;
+	unsigned int level_height = header.m_tex_h;
+	offset = 0;
+
+	for( unsigned int i = 0; i < header.m_levels; i++ )
+	{
+		if( level_width == width && level_height == height )
+		{
+			return i;
+		}
+
+		offset += static_cast<size_t>(level_width) * level_height * 4;
+		level_width = level_width > 1 ? level_width / 2 : 1;
+		level_height = level_height > 1 ? level_height / 2 : 1;
+	}
+
+	return -1;
+}
+
+/* Map the raw image cache file and read its header
+ * returns false if not cached or not valid
+*/
+static bool Open_Raw_Cache_File( const std::string &raw_filename, cMapped_File &file, Raw_Cache_Header &header )
+{
+	// not cached
+	if( !pResource_Manager->File_Exists( raw_filename ) )
+	{
+		return 0;
+	}
+
+	if( !file.Open( raw_filename ) || file.Get_Size() < sizeof( Raw_Cache_Header ) )
+	{
+		return 0;
+	}
+
+	memcpy( &header, file.Get_Data(), sizeof( Raw_Cache_Header ) );
+
+	if( memcmp( header.m_magic, raw_cache_magic, 4 ) != 0 || header.m_version != raw_cache_version ||
+		!header.m_tex_w || !header.m_tex_h || header.m_tex_w > 65536 || header.m_tex_h > 65536 ||
+		header.m_levels != Get_Mip_Level_Count( header.m_tex_w, header.m_tex_h ) || header.m_texture_format > TEXTURE_FORMAT_RGB5_A1 )
+	{
+		return 0;
+	}
+
+	// size of all levels
+	size_t pixels_size = 0;
+	Get_Raw_Cache_Level( header, 0, 0, pixels_size );
+
+	return file.Get_Size() == sizeof( Raw_Cache_Header ) + pixels_size;
+}
+
+/* *** *** *** *** *** *** *** Downscale kernels *** *** *** *** *** *** *** *** *** *** */
+
+/* Average 2x2 blocks of two rgba rows into one row
+ * rounds like the generic Downscale_Image loop
+*/
+static void Downscale_Row_2x2_RGBA( const unsigned char *row_0, const unsigned char *row_1, unsigned char *resampled, int mip_width )
+{
+	int i = 0;
+
+#if defined(SMC_DOWNSCALE_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi16( 2 );
+
+	// 2 result pixels from 4 pixels of each row
+	for( ; i + 2 <= mip_width; i += 2 )
+	{
+		const __m128i pixels_0 = _mm_loadu_si128( reinterpret_cast<const __m128i *>(row_0 + i * 8) );
+		const __m128i pixels_1 = _mm_loadu_si128( reinterpret_cast<const __m128i *>(row_1 + i * 8) );
+		// vertical sums of pixel 0 and 1 and of pixel 2 and 3
+		const __m128i sum_lo = _mm_add_epi16( _mm_unpacklo_epi8( pixels_0, zero ), _mm_unpacklo_epi8( pixels_1, zero ) );
+		const __m128i sum_hi = _mm_add_epi16( _mm_unpackhi_epi8( pixels_0, zero ), _mm_unpackhi_epi8( pixels_1, zero ) );
+		// horizontal sums in the lower half
+		const __m128i block_lo = _mm_add_epi16( sum_lo, _mm_srli_si128( sum_lo, 8 ) );
+		const __m128i block_hi = _mm_add_epi16( sum_hi, _mm_srli_si128( sum_hi, 8 ) );
+		__m128i result = _mm_unpacklo_epi64( block_lo, block_hi );
+		result = _mm_srli_epi16( _mm_add_epi16( result, round ), 2 );
+		_mm_storel_epi64( reinterpret_cast<__m128i *>(resampled + i * 4), _mm_packus_epi16( result, result ) );
+	}
+#elif defined(SMC_DOWNSCALE_NEON)
+	// 2 result pixels from 4 pixels of each row
+	for( ; i + 2 <= mip_width; i += 2 )
+	{
+		const uint8x16_t pixels_0 = vld1q_u8( row_0 + i * 8 );
+		const uint8x16_t pixels_1 = vld1q_u8( row_1 + i * 8 );
+		// vertical sums of pixel 0 and 1 and of pixel 2 and 3
+		const uint16x8_t sum_lo = vaddl_u8( vget_low_u8( pixels_0 ), vget_low_u8( pixels_1 ) );
+		const uint16x8_t sum_hi = vaddl_u8( vget_high_u8( pixels_0 ), vget_high_u8( pixels_1 ) );
+		const uint16x8_t block = vcombine_u16( vadd_u16( vget_low_u16( sum_lo ), vget_high_u16( sum_lo ) ), vadd_u16( vget_low_u16( sum_hi ), vget_high_u16( sum_hi ) ) );
+		// rounding shift
+		vst1_u8( resampled + i * 4, vrshrn_n_u16( block, 2 ) );
+	}
+#endif
+
+	for( ; i < mip_width; i++ )
+	{
+		for( int c = 0; c < 4; c++ )
+		{
+			resampled[i * 4 + c] = ( row_0[i * 8 + c] + row_0[i * 8 + 4 + c] + row_1[i * 8 + c] + row_1[i * 8 + 4 + c] + 2 ) >> 2;
+		}
+	}
+}
+
+/* Average 4x4 blocks of four rgba rows into one row
+ * rounds like the generic Downscale_Image loop
+*/
+static void Downscale_Row_4x4_RGBA( const unsigned char *const rows[4], unsigned char *resampled, int mip_width )
+{
+	int i = 0;
+
+#if defined(SMC_DOWNSCALE_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi16( 8 );
+
+	// 1 result pixel from 4 pixels of each row
+	for( ; i < mip_width; i++ )
+	{
+		__m128i sum = zero;
+
+		for( unsigned int row = 0; row < 4; row++ )
+		{
+			const __m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i *>(rows[row] + i * 16) );
+			sum = _mm_add_epi16( sum, _mm_add_epi16( _mm_unpacklo_epi8( pixels, zero ), _mm_unpackhi_epi8( pixels, zero ) ) );
+		}
+
+		// horizontal sum in the lowest pixel
+		sum = _mm_add_epi16( sum, _mm_srli_si128( sum, 8 ) );
+		sum = _mm_srli_epi16( _mm_add_epi16( sum, round ), 4 );
+		const int result = _mm_cvtsi128_si32( _mm_packus_epi16( sum, sum ) );
+		memcpy( resampled + i * 4, &result, 4 );
+	}
+#elif defined(SMC_DOWNSCALE_NEON)
+	// 1 result pixel from 4 pixels of each row
+	for( ; i < mip_width; i++ )
+	{
+		uint16x8_t sum = vdupq_n_u16( 0 );
+
+		for( unsigned int row = 0; row < 4; row++ )
+		{
+			const uint8x16_t pixels = vld1q_u8( rows[row] + i * 16 );
+			sum = vaddq_u16( sum, vaddl_u8( vget_low_u8( pixels ), vget_high_u8( pixels ) ) );
+		}
+
+		// horizontal sum and rounding shift
+		const uint16x4_t block = vadd_u16( vget_low_u16( sum ), vget_high_u16( sum ) );
+		vst1_lane_u32( reinterpret_cast<uint32_t *>(resampled + i * 4), vreinterpret_u32_u8( vrshrn_n_u16( vcombine_u16( block, block ), 4 ) ), 0 );
+	}
+#endif
+
+	for( ; i < mip_width; i++ )
+	{
+		for( int c = 0; c < 4; c++ )
+		{
+			int sum_value = 8;
+
+			for( unsigned int row = 0; row < 4; row++ )
+			{
+				sum_value += rows[row][i * 16 + c] + rows[row][i * 16 + 4 + c] + rows[row][i * 16 + 8 + c] + rows[row][i * 16 + 12 + c];
+			}
+
+			resampled[i * 4 + c] = sum_value >> 4;
+		}
+	}
+}
+
 /* *** *** *** *** *** *** *** Video class *** *** *** *** *** *** *** *** *** *** */
 
 cVideo :: cVideo( void )
@@ -77,13 +309,85 @@ cVideo :: cVideo( void )
 	glx_context = NULL;
 #endif
 	m_render_thread = boost::thread();
+	m_render_thread_active = 0;
+	m_render_thread_queue = NULL;
+	m_render_thread_busy = 0;
+	m_render_thread_input_time = 0;
+	m_render_thread_release_context = 0;
+	m_render_context_main = 1;
+	m_render_thread_exit = 0;
+	m_gui_locked = 0;
+
+	m_render_target = NULL;
+	m_render_scale = 1.0f;
+	m_render_scale_ticks = 0;
+	m_render_scale_frames = 0;
+
+	m_compressed_cache = NULL;
+	m_image_cache_updater = NULL;
+	m_texture_upload = NULL;
+	m_gpu_timer = NULL;
+	m_screenshot = NULL;
+	m_particle_shader = NULL;
+	m_sprite_shader = NULL;
+	m_image_loader = NULL;
 
 	m_initialised = 0;
+	m_context_kept = 0;
 }
 
 cVideo :: ~cVideo( void )
 {
+	Exit_Render_Thread();
+
+	// stop the background caching first as it uses the video functions
+	if( m_image_cache_updater )
+	{
+		delete m_image_cache_updater;
+		m_image_cache_updater = NULL;
+	}
+
+	if( m_render_target )
+	{
+		delete m_render_target;
+		m_render_target = NULL;
+	}
+
+	if( m_compressed_cache )
+	{
+		delete m_compressed_cache;
+		m_compressed_cache = NULL;
+	}
+
+	if( m_texture_upload )
+	{
+		delete m_texture_upload;
+		m_texture_upload = NULL;
+	}
+
+	if( m_gpu_timer )
+	{
+		delete m_gpu_timer;
+		m_gpu_timer = NULL;
+	}
 
+	if( m_screenshot )
+	{
+		delete m_screenshot;
+		m_screenshot = NULL;
+	}
+
+	if( m_particle_shader )
+	{
+		delete m_particle_shader;
+		m_particle_shader = NULL;
+	}
+
+	if( m_sprite_shader )
+	{
+		delete m_sprite_shader;
+		m_sprite_shader = NULL;
+	}
 }
 
 void cVideo :: Init_CEGUI_Fake( void ) const
@@ -135,7 +439,8 @@ void cVideo :: Init_CEGUI( void ) const
 	pGuiRenderer->enableExtraStateSettings( 1 );
 
 	// create Resource Provider
-	CEGUI::DefaultResourceProvider *rp = new CEGUI::DefaultResourceProvider();
+	pGuiResourceProvider = new cGui_Resource_Provider();
+	CEGUI::DefaultResourceProvider *rp = pGuiResourceProvider;
 
 	// set Resource Provider directories
 	rp->setResourceGroupDirectory( "schemes", DATA_DIR "/" GUI_SCHEME_DIR "/" );
@@ -219,6 +524,14 @@ void cVideo :: Init_CEGUI_Data( void ) const
 
 void cVideo :: Init_SDL( void )
 {
+#ifdef __unix__
+	// xlib is used from the render thread for swapping the buffers
+	if( pPreferences->m_video_render_thread )
+	{
+		XInitThreads();
+	}
+#endif
+
 	if( SDL_Init( SDL_INIT_VIDEO ) == -1 )
 	{
 		printf( "Error : SDL initialization failed\nReason : %s\n", SDL_GetError() );
@@ -257,7 +570,14 @@ void cVideo :: Init_SDL( void )
 
 void cVideo :: Init_Video( bool reload_textures_from_file /* = 0 */, bool use_preferences /* = 1 */ )
 {
-	Render_Finish();
+	// the opengl context gets recreated
+	Exit_Render_Thread();
+
+	// the image cache is for the old resolution
+	if( m_image_cache_updater )
+	{
+		m_image_cache_updater->Cancel();
+	}
 
 	// set the video flags
 	int flags = SDL_OPENGL | SDL_SWSURFACE;
@@ -294,7 +614,7 @@ void cVideo :: Init_Video( bool reload_textures_from_file /* = 0 */, bool use_pr
 		std::string filename_icon = DATA_DIR "/" GAME_ICON_DIR "/window_32.png";
 		if( File_Exists( filename_icon ) )
 		{
-			SDL_Surface *icon = IMG_Load( filename_icon.c_str() );
+			SDL_Surface *icon = IMG_Load_RW( Open_File_RW( filename_icon ), 1 );
 			SDL_WM_SetIcon( icon, NULL );
 			SDL_FreeSurface( icon );
 		}
@@ -381,6 +701,8 @@ void cVideo :: Init_Video( bool reload_textures_from_file /* = 0 */, bool use_pr
 	//SDL_GL_SetAttribute( SDL_GL_ALPHA_SIZE, 8 ); 
 	// not yet needed
 	//SDL_GL_SetAttribute( SDL_GL_DEPTH_SIZE, 16 );
+	// counts the overdraw in the debug view
+	SDL_GL_SetAttribute( SDL_GL_STENCIL_SIZE, 8 );
 	SDL_GL_SetAttribute( SDL_GL_DOUBLEBUFFER, 1 );
 	// if vertical synchronization is enabled
 	if( use_preferences && pPreferences->m_video_vsync )
@@ -388,29 +710,47 @@ void cVideo :: Init_Video( bool reload_textures_from_file /* = 0 */, bool use_pr
 		SDL_GL_SetAttribute( SDL_GL_SWAP_CONTROL, 1 );
 	}
 
+	// if the textures are saved for a new context
+	bool textures_grabbed = 0;
+	// texture of the old context to detect if it is kept
+	GLuint context_probe = 0;
+
 	// if reinitialization
 	if( m_initialised )
 	{
-		// check if CEGUI is initialized
-		bool cegui_initialized = pGuiSystem->getGUISheet() != NULL;
+		Render_Finish();
 
-		// show loading screen
-		if( cegui_initialized )
+		/* the platform kept the context on the last mode change
+		 * which keeps the textures in video memory
+		*/
+		if( !m_context_kept )
 		{
-			Loading_Screen_Init();
-		}
+			// check if CEGUI is initialized
+			bool cegui_initialized = pGuiSystem->getGUISheet() != NULL;
 
-		// save textures
-		pImage_Manager->Grab_Textures( reload_textures_from_file, cegui_initialized );
-		pFont->Grab_Textures();
-		pGuiRenderer->grabTextures();
-		pImage_Manager->Delete_Hardware_Textures();
+			// show loading screen
+			if( cegui_initialized )
+			{
+				Loading_Screen_Init();
+			}
 
-		// exit loading screen
-		if( cegui_initialized )
-		{
-			Loading_Screen_Exit();
+			// save textures which can not be loaded again from file
+			pImage_Manager->Grab_Textures( cegui_initialized );
+			pFont->Grab_Textures();
+			pGuiRenderer->grabTextures();
+			pImage_Manager->Delete_Hardware_Textures();
+			textures_grabbed = 1;
+
+			// exit loading screen
+			if( cegui_initialized )
+			{
+				Loading_Screen_Exit();
+			}
 		}
+
+		glGenTextures( 1, &context_probe );
+		glBindTexture( GL_TEXTURE_2D, context_probe );
+		glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL );
 	}
 
 	// Note: As of SDL 1.2.10, if width and height are both 0, SDL_SetVideoMode will use the desktop resolution.
@@ -422,6 +762,25 @@ void cVideo :: Init_Video( bool reload_textures_from_file /* = 0 */, bool use_pr
 		exit( EXIT_FAILURE );
 	}
 
+	// if reinitialization
+	if( m_initialised )
+	{
+		// a new context does not know the texture
+		m_context_kept = glIsTexture( context_probe ) == GL_TRUE;
+
+		if( m_context_kept )
+		{
+			glDeleteTextures( 1, &context_probe );
+		}
+		// the textures were not saved
+		else if( !textures_grabbed )
+		{
+			printf( "Warning : OpenGL context was not kept by the video mode change\n" );
+			// before new textures can get the old ids
+			pImage_Manager->Unload_File_Textures( 0 );
+		}
+	}
+
 	// check if fullscreen got set
 	if( use_preferences && pPreferences->m_video_fullscreen )
 	{
@@ -510,14 +869,17 @@ void cVideo :: Init_Video( bool reload_textures_from_file /* = 0 */, bool use_pr
 	// if reinitialization
 	if( m_initialised )
 	{
-		// reset highest texture id
-		pImage_Manager->m_high_texture_id = 0;
+		if( textures_grabbed )
+		{
+			// reset highest texture id
+			pImage_Manager->m_high_texture_id = 0;
 
-		/* restore GUI textures
-		 * must be the first CEGUI call after the grabTextures function
-		*/
-		pGuiRenderer->restoreTextures();
-		pFont->Restore_Textures();
+			/* restore GUI textures
+			 * must be the first CEGUI call after the grabTextures function
+			*/
+			pGuiRenderer->restoreTextures();
+			pFont->Restore_Textures();
+		}
 
 		// send new size to CEGUI
 		pGuiSystem->notifyDisplaySizeChanged( CEGUI::Size( static_cast<float>(screen_w), static_cast<float>(screen_h) ) );
@@ -538,7 +900,15 @@ void cVideo :: Init_Video( bool reload_textures_from_file /* = 0 */, bool use_pr
 		}
 
 		// restore textures
-		pImage_Manager->Restore_Textures( cegui_initialized );
+		if( textures_grabbed )
+		{
+			pImage_Manager->Restore_Textures( cegui_initialized );
+		}
+		// the kept textures are loaded again with the new settings
+		else if( reload_textures_from_file )
+		{
+			pImage_Manager->Unload_File_Textures();
+		}
 
 		// exit loading screen
 		if( cegui_initialized )
@@ -572,6 +942,8 @@ void cVideo :: Init_Video( bool reload_textures_from_file /* = 0 */, bool use_pr
 
 		m_initialised = 1;
 	}
+
+	Init_Render_Thread();
 }
 
 void cVideo :: Init_OpenGL( void )
@@ -621,6 +993,20 @@ void cVideo :: Init_OpenGL( void )
 	Init_Texture_Detail();
 	// Resolution Scale
 	Init_Resolution_Scale();
+	// offscreen drawing
+	Init_Render_Target();
+	// compressed textures
+	Init_Compressed_Cache();
+	// pixel buffer uploads
+	Init_Texture_Upload();
+	// render phase timing
+	Init_GPU_Timer();
+	// screenshot read back
+	Init_Screenshot();
+	// particle simulation
+	Init_Particle_Shader();
+	// sprite batching
+	Init_Sprite_Shader();
 
 	// clear screen
 	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
@@ -701,210 +1087,356 @@ void cVideo :: Init_Resolution_Scale( void ) const
 	global_downscaley = static_cast<float>(game_res_h) / static_cast<float>(pPreferences->m_video_screen_h);
 }
 
-void cVideo :: Init_Image_Cache( bool recreate /* = 0 */, bool draw_gui /* = 0 */ )
+void cVideo :: Init_Render_Target( void )
 {
-	m_imgcache_dir = pResource_Manager->user_data_dir + USER_IMGCACHE_DIR;
-	std::string imgcache_dir_active = m_imgcache_dir + "/" + int_to_string( pPreferences->m_video_screen_w ) + "x" + int_to_string( pPreferences->m_video_screen_h );
+	if( m_render_target )
+	{
+		delete m_render_target;
+		m_render_target = NULL;
+	}
 
-	// if cache is disabled
-	if( !pPreferences->m_image_cache_enabled )
+	m_render_scale = 1.0f;
+	m_render_scale_ticks = 0;
+	m_render_scale_frames = 0;
+
+	if( !pPreferences->m_video_dynamic_resolution )
 	{
 		return;
 	}
 
-	// if not the same game version
-	if( recreate || pPreferences->m_game_version != smc_version )
+	m_render_target = new cRender_Target();
+
+	if( !m_render_target->Init( pPreferences->m_video_screen_w, pPreferences->m_video_screen_h ) )
 	{
-		// delete all caches
-		if( Dir_Exists( m_imgcache_dir ) )
-		{
-			try
-			{
-				Delete_Dir_And_Content( m_imgcache_dir );
-			}
-			// could happen if a file is locked or we have no write rights
-			catch( const std::exception &ex )
-			{
-				printf( "%s\n", ex.what() );
+		printf( "Warning : Dynamic resolution is not available\n" );
+		delete m_render_target;
+		m_render_target = NULL;
+	}
+}
 
-				if( draw_gui )
-				{
-					// caching failed
-					Loading_Screen_Draw_Text( _("Caching Images failed : Could not remove old images") );
-					SDL_Delay( 2000 );
-				}
-			}
+void cVideo :: Init_Compressed_Cache( void )
+{
+	if( !pPreferences->m_image_cache_enabled || !pPreferences->m_image_cache_compressed )
+	{
+		if( m_compressed_cache )
+		{
+			delete m_compressed_cache;
+			m_compressed_cache = NULL;
 		}
-		
-		Create_Directory( m_imgcache_dir );
+
+		return;
 	}
 
-	// no cache available
-	if( !Dir_Exists( imgcache_dir_active ) )
+	// keeps the cache directory if reinitialized
+	if( !m_compressed_cache )
 	{
-		Create_Directories( imgcache_dir_active + "/" GAME_PIXMAPS_DIR );
+		m_compressed_cache = new cCompressed_Image_Cache();
 	}
-	// cache available
-	else
+
+	// the functions can be different for every context
+	if( !m_compressed_cache->Init() )
 	{
-		m_imgcache_dir = imgcache_dir_active;
-		return;
+		printf( "Warning : Compressed image cache is not available\n" );
+		delete m_compressed_cache;
+		m_compressed_cache = NULL;
 	}
+}
 
-	// texture detail should be maximum for caching
-	float real_texture_detail = m_texture_quality;
-	m_texture_quality = 1;
-
-	CEGUI::ProgressBar *progress_bar = NULL;
-
-	if( draw_gui )
+void cVideo :: Init_Texture_Upload( void )
+{
+	if( !m_texture_upload )
 	{
-		// get progress bar
-		progress_bar = static_cast<CEGUI::ProgressBar *>(CEGUI::WindowManager::getSingleton().getWindow( "progress_bar" ));
-		progress_bar->setProgress( 0 );
+		m_texture_upload = new cTexture_Upload();
+	}
 
-		// set loading screen text
-		Loading_Screen_Draw_Text( _("Caching Images") );
+	// the buffers and functions can be different for every context
+	if( !m_texture_upload->Init( m_context_kept ) )
+	{
+		printf( "Warning : Asynchronous texture upload is not available\n" );
+		delete m_texture_upload;
+		m_texture_upload = NULL;
 	}
+}
 
-	// get all files
-	vector<std::string> image_files = Get_Directory_Files( DATA_DIR "/" GAME_PIXMAPS_DIR, ".settings", 1 );
+void cVideo :: Init_GPU_Timer( void )
+{
+	if( !m_gpu_timer )
+	{
+		m_gpu_timer = new cGPU_Timer();
+	}
 
-	unsigned int loaded_files = 0;
-	unsigned int file_count = image_files.size();
+	// the queries can be different for every context
+	if( !m_gpu_timer->Init() )
+	{
+		delete m_gpu_timer;
+		m_gpu_timer = NULL;
+	}
+}
 
-	// create directories, load images and save to cache
-	for( vector<std::string>::iterator itr = image_files.begin(); itr != image_files.end(); ++itr )
+void cVideo :: Init_Screenshot( void )
+{
+	if( !m_screenshot )
 	{
-		// get filename
-		std::string filename = (*itr);
+		m_screenshot = new cScreenshot_Writer();
+	}
 
-		// remove data dir
-		std::string cache_filename = filename.substr( strlen( DATA_DIR "/" ) );
+	// without pixel buffers the frame is read directly
+	m_screenshot->Init();
+}
 
-		// if directory
-		if( filename.rfind( "." ) == std::string::npos )
+void cVideo :: Init_Particle_Shader( void )
+{
+	if( !pPreferences->m_video_particle_shader )
+	{
+		if( m_particle_shader )
 		{
-			if( !Dir_Exists( imgcache_dir_active + "/" + cache_filename ) )
-			{
-				Create_Directory( imgcache_dir_active + "/" + cache_filename );
-			}
-
-			loaded_files++;
-			continue;
+			delete m_particle_shader;
+			m_particle_shader = NULL;
 		}
 
-		bool settings_file = 0;
+		return;
+	}
 
-		// Don't use .settings file type directly for image loading
-		if( filename.rfind( ".settings" ) != std::string::npos )
-		{
-			settings_file = 1;
-			filename.erase( filename.rfind( ".settings" ) );
-			filename.insert( filename.length(), ".png" );
-		}
+	if( !m_particle_shader )
+	{
+		m_particle_shader = new cParticle_Shader();
+	}
 
-		// load software image
-		cSoftware_Image software_image = Load_Image( filename );
-		SDL_Surface *sdl_surface = software_image.m_sdl_surface;
-		cImage_Settings_Data *settings = software_image.m_settings;
+	// the program and functions can be different for every context
+	if( !m_particle_shader->Init() )
+	{
+		printf( "Warning : Particle shader is not available\n" );
+		delete m_particle_shader;
+		m_particle_shader = NULL;
+	}
+}
 
-		// failed to load image
-		if( !sdl_surface )
+void cVideo :: Init_Sprite_Shader( void )
+{
+	if( !pPreferences->m_video_sprite_shader )
+	{
+		if( m_sprite_shader )
 		{
-			continue;
+			delete m_sprite_shader;
+			m_sprite_shader = NULL;
 		}
 
-		/* don't cache if no image settings or images without the width and height set
-		 * as there is currently no support to get the old and real image size
-		 * and thus the scaled down (cached) image size is used which is wrong
-		*/
-		if( !settings || !settings->m_width || !settings->m_height )
-		{
-			if( settings )
-			{
-				debug_print( "Info : %s has no image settings image size set and will not get cached\n", cache_filename.c_str() );
-			}
-			else
-			{
-				debug_print( "Info : %s has no image settings and will not get cached\n", cache_filename.c_str() );
-			}
-			SDL_FreeSurface( sdl_surface );
-			continue;
-		}
+		return;
+	}
 
-		// create final image
-		sdl_surface = Convert_To_Final_Software_Image( sdl_surface );
+	if( !m_sprite_shader )
+	{
+		m_sprite_shader = new cSprite_Shader();
+	}
 
-		// get final size for this resolution
-		cSize_Int size = settings->Get_Surface_Size( sdl_surface );
-		delete settings;
-		int new_width = size.m_width;
-		int new_height = size.m_height;
+	// the program and functions can be different for every context
+	if( !m_sprite_shader->Init() )
+	{
+		printf( "Warning : Sprite shader is not available\n" );
+		delete m_sprite_shader;
+		m_sprite_shader = NULL;
+	}
+}
 
-		// apply maximum texture size
-		Apply_Max_Texture_Size( new_width, new_height );
+void cVideo :: Init_Image_Cache( bool recreate /* = 0 */, bool draw_gui /* = 0 */ )
+{
+	m_imgcache_dir = pResource_Manager->user_data_dir + USER_IMGCACHE_DIR;
+	// one cache for all resolutions as the images are saved with all mip levels
+	std::string imgcache_dir_active = m_imgcache_dir + "/" USER_IMGCACHE_IMAGES_DIR;
+	// cache of older versions for the current resolution
+	const std::string imgcache_dir_resolution = m_imgcache_dir + "/" + int_to_string( pPreferences->m_video_screen_w ) + "x" + int_to_string( pPreferences->m_video_screen_h );
 
-		// does not need to be downsampled
-		if( new_width >= sdl_surface->w && new_height >= sdl_surface->h )
-		{
-			SDL_FreeSurface( sdl_surface );
-			continue;
-		}
+	// compressed images are only used from the active cache
+	if( m_compressed_cache )
+	{
+		m_compressed_cache->m_cache_dir.clear();
+	}
 
-		// calculate block reduction
-		int reduce_block_x = sdl_surface->w / new_width;
-		int reduce_block_y = sdl_surface->h / new_height;
+	// the background caching writes into the old cache
+	if( m_image_cache_updater )
+	{
+		m_image_cache_updater->Cancel();
+	}
 
-		// create downsampled image
-		unsigned int image_bpp = sdl_surface->format->BytesPerPixel;
-		unsigned char *image_downsampled = new unsigned char[new_width * new_height * image_bpp];
-		bool downsampled = Downscale_Image( static_cast<unsigned char*>(sdl_surface->pixels), sdl_surface->w, sdl_surface->h, image_bpp, image_downsampled, reduce_block_x, reduce_block_y );
-		
-		SDL_FreeSurface( sdl_surface );
+	// if cache is disabled
+	if( !pPreferences->m_image_cache_enabled )
+	{
+		return;
+	}
 
-		// if image is available
-		if( downsampled )
+	// delete all caches
+	if( recreate && Dir_Exists( m_imgcache_dir ) )
+	{
+		try
+		{
+			Delete_Dir_And_Content( m_imgcache_dir );
+		}
+		// could happen if a file is locked or we have no write rights
+		catch( const std::exception &ex )
 		{
-			// save as png
-			if( settings_file )
+			printf( "%s\n", ex.what() );
+
+			if( draw_gui )
 			{
-				cache_filename.insert( cache_filename.length(), ".png" );
+				// caching failed
+				Loading_Screen_Draw_Text( _("Caching Images failed : Could not remove old images") );
+				Loading_Screen_Draw( 1 );
+				SDL_Delay( 2000 );
 			}
-
-			// save image
-			Save_Surface( imgcache_dir_active + "/" + cache_filename, image_downsampled, new_width, new_height, image_bpp );
 		}
 
-		delete[] image_downsampled;
-
-		// count files
-		loaded_files++;
+		Create_Directory( m_imgcache_dir );
+	}
 
-		// draw
-		if( draw_gui )
+	// not used anymore
+	if( Dir_Exists( imgcache_dir_resolution ) )
+	{
+		try
 		{
-			// update progress
-			progress_bar->setProgress( static_cast<float>(loaded_files) / static_cast<float>(file_count) );
-
-		#ifdef _DEBUG
-			// update filename
-			cGL_Surface *surface_filename = pFont->Render_Text( pFont->m_font_small, filename, white );
-			// draw filename
-			surface_filename->Blit( game_res_w * 0.2f, game_res_h * 0.8f, 0.1f );
-		#endif
-			Loading_Screen_Draw();
-		#ifdef _DEBUG
-			// delete
-			delete surface_filename;
-		#endif
+			Delete_Dir_And_Content( imgcache_dir_resolution );
 		}
+		catch( const std::exception &ex )
+		{
+			printf( "%s\n", ex.what() );
+		}
+	}
+
+	// no cache available
+	if( !Dir_Exists( imgcache_dir_active ) )
+	{
+		Create_Directories( imgcache_dir_active + "/" GAME_PIXMAPS_DIR );
 	}
 
-	// set back texture detail
-	m_texture_quality = real_texture_detail;
-	// set directory after surfaces got loaded from Load_GL_Surface()
 	m_imgcache_dir = imgcache_dir_active;
+
+	if( m_compressed_cache )
+	{
+		m_compressed_cache->m_cache_dir = imgcache_dir_active;
+	}
+
+	// resolved image settings
+	pImage_Settings_Cache->Load_Index( imgcache_dir_active + "/" USER_IMGCACHE_SETTINGS_INDEX );
+
+	if( !m_image_cache_updater )
+	{
+		m_image_cache_updater = new cImage_Cache_Updater();
+	}
+
+	// only the images with changed sources are cached again
+	m_image_cache_updater->Start( imgcache_dir_active );
+}
+
+void cVideo :: Cache_Raw_Image( const std::string &filename, const std::string &cache_dir, cImage_Settings_Parser *settings_parser /* = NULL */ ) const
+{
+	// only images with settings are cached
+	if( filename.rfind( ".settings" ) == std::string::npos )
+	{
+		return;
+	}
+
+	// the original image as the cache file is removed before
+	cSoftware_Image software_image = Load_Image( filename.substr( 0, filename.rfind( ".settings" ) ) + ".png", 1, 1, settings_parser );
+
+	if( !software_image.m_sdl_surface )
+	{
+		return;
+	}
+
+	/* don't cache images without the width and height set
+	 * as the level for the current resolution is selected with the image settings size
+	*/
+	if( !software_image.m_settings || !software_image.m_settings->m_width || !software_image.m_settings->m_height )
+	{
+		if( software_image.m_settings )
+		{
+			delete software_image.m_settings;
+		}
+
+		SDL_FreeSurface( software_image.m_sdl_surface );
+		return;
+	}
+
+	delete software_image.m_settings;
+
+	// full size with a power of 2 and 32 bits per pixel
+	SDL_Surface *sdl_surface = Convert_To_Final_Software_Image( software_image.m_sdl_surface );
+
+	const int texture_width = sdl_surface->w;
+	const int texture_height = sdl_surface->h;
+
+	if( sdl_surface->format->BytesPerPixel != 4 )
+	{
+		SDL_FreeSurface( sdl_surface );
+		return;
+	}
+
+	Raw_Cache_Header header;
+	memcpy( header.m_magic, raw_cache_magic, 4 );
+	header.m_version = raw_cache_version;
+	header.m_tex_w = texture_width;
+	header.m_tex_h = texture_height;
+	// every level can be the texture of a resolution
+	header.m_levels = Get_Mip_Level_Count( texture_width, texture_height );
+	// checked once here instead of every time the texture is created
+	header.m_texture_format = Get_Texture_Format( static_cast<const unsigned char *>(sdl_surface->pixels), texture_width, texture_height, sdl_surface->pitch / 4 );
+
+	// the game can load the file while caching in the background
+	const std::string raw_filename = cache_dir + "/" + filename.substr( strlen( DATA_DIR "/" ) ) + ".rgba";
+
+	FILE *fp = fopen( ( raw_filename + ".tmp" ).c_str(), "wb" );
+
+	if( !fp )
+	{
+		debug_print( "Warning : could not create raw image cache file %s\n", raw_filename.c_str() );
+		SDL_FreeSurface( sdl_surface );
+		return;
+	}
+
+	bool written = fwrite( &header, sizeof( Raw_Cache_Header ), 1, fp ) == 1;
+
+	// without row padding
+	unsigned char *level = new unsigned char[texture_width * texture_height * 4];
+
+	for( int y = 0; y < sdl_surface->h; y++ )
+	{
+		memcpy( level + y * texture_width * 4, static_cast<const unsigned char *>(sdl_surface->pixels) + y * sdl_surface->pitch, texture_width * 4 );
+	}
+
+	SDL_FreeSurface( sdl_surface );
+
+	int level_width = texture_width;
+	int level_height = texture_height;
+
+	for( unsigned int i = 0; written && i < header.m_levels; i++ )
+	{
+		written = fwrite( level, level_width * level_height * 4, 1, fp ) == 1;
+
+		// create the next level with the same filter as the texture downscaling
+		if( i + 1 < header.m_levels )
+		{
+			const int next_width = level_width > 1 ? level_width / 2 : 1;
+			const int next_height = level_height > 1 ? level_height / 2 : 1;
+			unsigned char *next_level = new unsigned char[next_width * next_height * 4];
+
+			Downscale_Image( level, level_width, level_height, 4, next_level, level_width > 1 ? 2 : 1, level_height > 1 ? 2 : 1 );
+
+			delete[] level;
+			level = next_level;
+			level_width = next_width;
+			level_height = next_height;
+		}
+	}
+
+	delete[] level;
+	fclose( fp );
+
+	if( !written )
+	{
+		Delete_File( raw_filename + ".tmp" );
+		return;
+	}
+
+	Rename_File( raw_filename + ".tmp", raw_filename );
 }
 
 int cVideo :: Test_Video( int width, int height, int bpp, int flags /* = 0 */ ) const
@@ -1004,34 +1536,187 @@ void cVideo :: Make_GL_Context_Inactive( void )
 	SDL_GetWMInfo( &wm_info );
 }
 
-void cVideo :: Render_From_Thread( void )
+void cVideo :: Init_Render_Thread( void )
 {
-	Make_GL_Context_Current();
+	if( m_render_thread_active || !pPreferences->m_video_render_thread )
+	{
+		return;
+	}
 
-	pRenderer_current->Render();
-	// under linux with sofware mesa 7.9 it only showed the rendered output with SDL_GL_SwapBuffers()
+#ifdef __APPLE__
+	printf( "Warning : Render thread is not supported on this system\n" );
+	return;
+#elif __unix__
+	if( !glx_context )
+	{
+		printf( "Warning : Render thread disabled : No GLX context\n" );
+		return;
+	}
+#endif
 
-	// update performance timer
-	//pFramerate->m_perf_timer[PERF_RENDER_GAME]->Update();
+	m_render_thread_queue = NULL;
+	m_render_thread_busy = 0;
+	m_render_thread_release_context = 0;
+	m_render_thread_exit = 0;
+	// the render thread takes the context with the first frame
+	m_render_context_main = 1;
 
-	Make_GL_Context_Inactive();
+	m_render_thread_active = 1;
+	m_render_thread = boost::thread( &cVideo::Render_Thread_Loop, this );
 }
 
-void cVideo :: Render( bool threaded /* = 0 */ )
+void cVideo :: Exit_Render_Thread( void )
 {
+	if( !m_render_thread_active )
+	{
+		return;
+	}
+
+	// wait for the last frame and get the context
 	Render_Finish();
 
-	if( threaded )
 	{
-		pGuiSystem->renderGUI();
+		boost::mutex::scoped_lock lock( m_render_mutex );
+		m_render_thread_exit = 1;
+		m_render_condition.notify_all();
+	}
+
+	if( m_render_thread.joinable() )
+	{
+		m_render_thread.join();
+	}
+
+	m_render_thread_active = 0;
+}
+
+void cVideo :: Render_Thread_Loop( void )
+{
+	bool has_context = 0;
+
+	boost::mutex::scoped_lock lock( m_render_mutex );
+
+	while( 1 )
+	{
+		// wait for work
+		while( !m_render_thread_queue && !m_render_thread_release_context && !m_render_thread_exit )
+		{
+			m_render_condition.wait( lock );
+		}
+
+		// render a frame
+		if( m_render_thread_queue )
+		{
+			cRenderQueue *queue = m_render_thread_queue;
+			const Uint64 input_time = m_render_thread_input_time;
+			m_render_thread_busy = 1;
+			lock.unlock();
+
+			// the main thread released it before handing over the frame
+			if( !has_context )
+			{
+				Make_GL_Context_Current();
+				has_context = 1;
+			}
+
+			{
+				cProfiler_Scope profile_scope( "render" );
+
+				{
+					cProfiler_Scope profile_game( "game" );
+					Render_Queue( queue );
+				}
+
+				// the GUI can not be changed while rendering
+				{
+					cProfiler_Scope profile_gui( "gui" );
+					boost::mutex::scoped_lock gui_lock( m_gui_mutex );
+					Render_GUI();
+				}
+
+				{
+					cProfiler_Scope profile_buffer( "buffer" );
+					// read back a requested screenshot before the frame is gone
+					if( m_screenshot )
+					{
+						m_screenshot->Frame_End();
+					}
+
+					SDL_GL_SwapBuffers();
+					pRender_Stats->Frame_Finished();
+					GPU_Timer_Frame_End();
+					Frame_Presented( input_time );
+				}
+			}
+
+			lock.lock();
+			m_render_thread_queue = NULL;
+			m_render_thread_busy = 0;
+			m_render_condition.notify_all();
+		}
+		// give the context to the main thread
+		else if( m_render_thread_release_context )
+		{
+			if( has_context )
+			{
+				Make_GL_Context_Inactive();
+				has_context = 0;
+			}
+
+			m_render_thread_release_context = 0;
+			m_render_context_main = 1;
+			m_render_condition.notify_all();
+		}
+		else if( m_render_thread_exit )
+		{
+			break;
+		}
+	}
+
+	if( has_context )
+	{
+		Make_GL_Context_Inactive();
+	}
+}
+
+void cVideo :: Render( bool threaded /* = 0 */ )
+{
+	// hand the frame to the render thread
+	if( threaded && m_render_thread_active )
+	{
+		// GUI changes must be finished
+		const bool gui_locked = m_gui_locked;
+
+		if( gui_locked )
+		{
+			Unlock_GUI();
+		}
+
+		cProfiler_Scope profile_scope( "render" );
+		boost::mutex::scoped_lock lock( m_render_mutex );
+
+		// wait for the previous frame
+		{
+			cProfiler_Scope profile_wait( "wait for the render thread" );
+
+			while( m_render_thread_queue || m_render_thread_busy )
+			{
+				m_render_condition.wait( lock );
+			}
+		}
 
-		// update performance timer
-		pFramerate->m_perf_timer[PERF_RENDER_GUI]->Update();
+		// the render thread is idle
+		Update_Render_Scale();
+		Update_Particle_Shader();
 
-		SDL_GL_SwapBuffers();
+		// the render thread takes the context
+		if( m_render_context_main )
+		{
+			Make_GL_Context_Inactive();
+			m_render_context_main = 0;
+		}
 
-		// update performance timer
-		pFramerate->m_perf_timer[PERF_RENDER_BUFFER]->Update();
+		// the camera changes while rendering
+		pRenderer->Save_Camera();
 
 		// switch active renderer
 		cRenderQueue *new_render = pRenderer;
@@ -1039,165 +1724,371 @@ void cVideo :: Render( bool threaded /* = 0 */ )
 		pRenderer_current = new_render;
 
 		// move objects that should render more than once
-		if( !pRenderer->m_render_data.empty() )
+		pRenderer_current->Move_Retained( pRenderer );
+
+		// start rendering
+		m_render_thread_queue = pRenderer_current;
+		m_render_thread_input_time = pFramerate->m_input_time;
+		m_render_condition.notify_all();
+
+		lock.unlock();
+
+		if( gui_locked )
 		{
-			pRenderer_current->m_render_data.insert( pRenderer_current->m_render_data.begin(), pRenderer->m_render_data.begin(), pRenderer->m_render_data.end() );
-			pRenderer->m_render_data.clear();
+			Lock_GUI();
 		}
-		
-		// make main thread inactive
-		Make_GL_Context_Inactive();
-		// start render thread
-		m_render_thread = boost::thread(&cVideo::Render_From_Thread, this);
 	}
 	// single thread mode
 	else
 	{
-		pRenderer->Render();
+		cProfiler_Scope profile_scope( "render" );
 
-		// update performance timer
-		pFramerate->m_perf_timer[PERF_RENDER_GAME]->Update();
+		Render_Finish();
 
-		pGuiSystem->renderGUI();
+		Update_Render_Scale();
+		Update_Particle_Shader();
+
+		{
+			cProfiler_Scope profile_game( "game" );
+			Render_Queue( pRenderer );
+		}
 
-		// update performance timer
-		pFramerate->m_perf_timer[PERF_RENDER_GUI]->Update();
+		{
+			cProfiler_Scope profile_gui( "gui" );
+			Render_GUI();
+		}
 
-		SDL_GL_SwapBuffers();
+		{
+			cProfiler_Scope profile_buffer( "buffer" );
+			// read back a requested screenshot before the frame is gone
+			if( m_screenshot )
+			{
+				m_screenshot->Frame_End();
+			}
 
-		// update performance timer
-		pFramerate->m_perf_timer[PERF_RENDER_BUFFER]->Update();
+			SDL_GL_SwapBuffers();
+			pRender_Stats->Frame_Finished();
+			GPU_Timer_Frame_End();
+			Frame_Presented( pFramerate->m_input_time );
+		}
 	}
 }
 
-void cVideo :: Render_Finish( void )
+void cVideo :: Render_Queue( cRenderQueue *queue )
 {
-#ifndef SMC_RENDER_THREAD_TEST
-	return;
-#endif
-	if( m_render_thread.joinable() )
+	if( m_gpu_timer )
 	{
-		m_render_thread.join();
+		m_gpu_timer->Frame_Begin();
+	}
+
+	if( !m_render_target )
+	{
+		queue->Render();
+		return;
 	}
 
-	// todo : use opengl in only one thread
-	Make_GL_Context_Current();
+	m_render_target->Begin( m_render_scale );
+	queue->Render();
+	m_render_target->End();
 }
 
-void cVideo :: Toggle_Fullscreen( void )
+void cVideo :: Render_GUI( void )
 {
-	Render_Finish();
-
-	// toggle fullscreen
-	pPreferences->m_video_fullscreen = !pPreferences->m_video_fullscreen;
-
-	// save clear color
-	GLclampf clear_color[4];
-	glGetFloatv( GL_COLOR_CLEAR_VALUE, clear_color );
+	if( m_gpu_timer )
+	{
+		m_gpu_timer->Begin( GPU_PHASE_GUI );
+	}
 
-#ifdef _WIN32
-	// windows needs reinitialization
-	Init_Video();
-#else
-	// works only for X11 platforms
-	SDL_WM_ToggleFullScreen( screen );
-#endif
+	pGuiSystem->renderGUI();
 
-	// set back clear color
-	glClearColor( clear_color[0], clear_color[1], clear_color[2], clear_color[3] );
+	if( m_gpu_timer )
+	{
+		m_gpu_timer->End();
+	}
 }
 
-cGL_Surface *cVideo :: Get_Surface( std::string filename, bool print_errors /* = 1 */ )
+void cVideo :: GPU_Timer_Frame_End( void )
 {
-	// .settings file type can't be used directly
-	if( filename.find( ".settings" ) != std::string::npos )
+	if( m_gpu_timer )
 	{
-		filename.erase( filename.find( ".settings" ) );
-		filename.insert( filename.length(), ".png" );
+		m_gpu_timer->Frame_End();
 	}
+}
 
-	// pixmaps dir must be given
-	if( filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/" ) == std::string::npos )
+void cVideo :: Frame_Presented( Uint64 input_time )
+{
+	// the next frame is not queued behind this one in the driver
+	if( pPreferences->m_video_low_latency )
 	{
-		filename.insert( 0, DATA_DIR "/" GAME_PIXMAPS_DIR "/" );
+		glFinish();
 	}
 
-	// check if already loaded
-	cGL_Surface *image = pImage_Manager->Get_Pointer( filename );
-	// already loaded
-	if( image )
+	if( input_time )
 	{
-		return image;
+		pFramerate->m_input_latency_timer.Add_Time( static_cast<Uint32>(Get_Microseconds() - input_time) );
 	}
+}
 
-	// load new image
-	image = Load_GL_Surface( filename, 1, print_errors );
-	// add new image
-	if( image )
+void cVideo :: Update_Render_Scale( void )
+{
+	if( !m_render_target )
 	{
-		pImage_Manager->Add( image );
+		return;
 	}
 
-	return image;
-}
+	m_render_scale_ticks += pFramerate->m_elapsed_ticks;
+	m_render_scale_frames++;
 
-cVideo::cSoftware_Image cVideo :: Load_Image( std::string filename, bool load_settings /* = 1 */, bool print_errors /* = 1 */ ) const
-{
-	// pixmaps dir must be given
-	if( filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/" ) == std::string::npos ) 
+	// adjust with the average of half a second
+	if( m_render_scale_ticks < 500 )
 	{
-		filename.insert( 0, DATA_DIR "/" GAME_PIXMAPS_DIR "/" );
+		return;
 	}
 
-	cSoftware_Image software_image = cSoftware_Image();
-	SDL_Surface *sdl_surface = NULL;
-	cImage_Settings_Data *settings = NULL;
+	unsigned int target_fps = pPreferences->m_video_dynamic_resolution_fps;
 
-	// load settings if available
-	if( load_settings )
+	// can not be faster than the limit
+	if( pPreferences->m_video_fps_limit && pPreferences->m_video_fps_limit < target_fps )
 	{
-		std::string settings_file = filename;
+		target_fps = pPreferences->m_video_fps_limit;
+	}
 
-		// if not already set
-		if( settings_file.rfind( ".settings" ) == std::string::npos )
-		{
-			settings_file.erase( settings_file.rfind( "." ) + 1 );
-			settings_file.insert( settings_file.rfind( "." ) + 1, "settings" );
-		}
+	if( !target_fps )
+	{
+		target_fps = static_cast<unsigned int>(pFramerate->m_fps_target);
+	}
 
-		// if a settings file exists
-		if( File_Exists( settings_file ) )
-		{
-			settings = pSettingsParser->Get( settings_file );
+	const float frame_time = static_cast<float>(m_render_scale_ticks) / static_cast<float>(m_render_scale_frames);
+	const float target_frame_time = 1000.0f / static_cast<float>(target_fps);
 
-			// add cache dir and remove data dir
-			std::string img_filename_cache = m_imgcache_dir + "/" + settings_file.substr( strlen( DATA_DIR "/" ) ) + ".png";
+	// too slow
+	if( frame_time > target_frame_time * 1.05f )
+	{
+		m_render_scale -= 0.1f;
+	}
+	// fast enough for a higher resolution
+	else if( frame_time < target_frame_time * 0.85f )
+	{
+		m_render_scale += 0.05f;
+	}
 
-			// check if image cache file exists
-			if( File_Exists( img_filename_cache ) )
-			{
-				sdl_surface = IMG_Load( img_filename_cache.c_str() );
-			}
-			// image given in base settings
-			else if( !settings->m_base.empty() )
-			{
-				// use current directory
-				std::string img_filename = filename.substr( 0, filename.rfind( "/" ) + 1 ) + settings->m_base;
+	if( m_render_scale < pPreferences->m_video_dynamic_resolution_min )
+	{
+		m_render_scale = pPreferences->m_video_dynamic_resolution_min;
+	}
+	if( m_render_scale > 1.0f )
+	{
+		m_render_scale = 1.0f;
+	}
 
-				// not found
-				if( !File_Exists( img_filename ) )
-				{
-					// use data dir
-					img_filename = settings->m_base;
+	m_render_scale_ticks = 0;
+	m_render_scale_frames = 0;
+}
 
-					// pixmaps dir must be given
-					if( img_filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/" ) == std::string::npos )
-					{
-						img_filename.insert( 0, DATA_DIR "/" GAME_PIXMAPS_DIR "/" );
-					}
+void cVideo :: Update_Particle_Shader( void )
+{
+	if( !m_particle_shader )
+	{
+		return;
+	}
+
+	// seed buffers retired before the last frame are not used anymore
+	m_particle_shader->Update_Retired();
+}
+
+void cVideo :: Render_Finish( void )
+{
+	if( !m_render_thread_active )
+	{
+		return;
+	}
+
+	// let the render thread finish the GUI
+	const bool gui_locked = m_gui_locked;
+
+	if( gui_locked )
+	{
+		Unlock_GUI();
+	}
+
+	{
+		boost::mutex::scoped_lock lock( m_render_mutex );
+
+		// wait for the last frame
+		while( m_render_thread_queue || m_render_thread_busy )
+		{
+			m_render_condition.wait( lock );
+		}
+
+		// get the context
+		if( !m_render_context_main )
+		{
+			m_render_thread_release_context = 1;
+			m_render_condition.notify_all();
+
+			while( !m_render_context_main )
+			{
+				m_render_condition.wait( lock );
+			}
+
+			Make_GL_Context_Current();
+		}
+	}
+
+	if( gui_locked )
+	{
+		Lock_GUI();
+	}
+}
+
+void cVideo :: Lock_GUI( void )
+{
+	if( !m_render_thread_active || m_gui_locked )
+	{
+		return;
+	}
+
+	m_gui_mutex.lock();
+	m_gui_locked = 1;
+}
+
+void cVideo :: Unlock_GUI( void )
+{
+	if( !m_gui_locked )
+	{
+		return;
+	}
+
+	m_gui_locked = 0;
+	m_gui_mutex.unlock();
+}
+
+void cVideo :: Toggle_Fullscreen( void )
+{
+	Render_Finish();
+
+	// toggle fullscreen
+	pPreferences->m_video_fullscreen = !pPreferences->m_video_fullscreen;
+
+	// save clear color
+	GLclampf clear_color[4];
+	glGetFloatv( GL_COLOR_CLEAR_VALUE, clear_color );
+
+#ifdef _WIN32
+	// windows needs reinitialization
+	Init_Video();
+#else
+	// works only for X11 platforms
+	SDL_WM_ToggleFullScreen( screen );
+#endif
+
+	// set back clear color
+	glClearColor( clear_color[0], clear_color[1], clear_color[2], clear_color[3] );
+}
+
+cGL_Surface *cVideo :: Get_Surface( std::string filename, bool print_errors /* = 1 */ )
+{
+	// .settings file type can't be used directly
+	if( filename.find( ".settings" ) != std::string::npos )
+	{
+		filename.erase( filename.find( ".settings" ) );
+		filename.insert( filename.length(), ".png" );
+	}
+
+	// pixmaps dir must be given
+	if( filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/" ) == std::string::npos )
+	{
+		filename.insert( 0, DATA_DIR "/" GAME_PIXMAPS_DIR "/" );
+	}
+
+	// preloaded the next time the level is loaded
+	cLevel_Manifest::Record_Image( filename );
+
+	// check if already loaded
+	cGL_Surface *image = pImage_Manager->Get_Pointer( filename );
+	// already loaded
+	if( image )
+	{
+		return image;
+	}
+
+	// decoded in the background
+	// the prefetch does not decode the images of the compressed image cache
+	if( m_image_loader && !m_compressed_cache )
+	{
+		const int job = m_image_loader->Find( filename );
+
+		if( job >= 0 )
+		{
+			cLoad_Profiler_Scope profile_scope( "image prefetched" );
+			cSoftware_Image software_image = m_image_loader->Wait( job );
+
+			if( software_image.m_sdl_surface )
+			{
+				image = Create_GL_Surface( filename, software_image, print_errors );
+
+				if( image )
+				{
+					pImage_Manager->Add( image );
+					return image;
 				}
+			}
+		}
+	}
 
-				sdl_surface = IMG_Load( img_filename.c_str() );
+	// load new image
+	image = Load_GL_Surface( filename, 1, print_errors );
+	// add new image
+	if( image )
+	{
+		pImage_Manager->Add( image );
+	}
+
+	return image;
+}
+
+cVideo::cSoftware_Image cVideo :: Load_Image( std::string filename, bool load_settings /* = 1 */, bool print_errors /* = 1 */, cImage_Settings_Parser *settings_parser /* = NULL */ ) const
+{
+	// pixmaps dir must be given
+	if( filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/" ) == std::string::npos ) 
+	{
+		filename.insert( 0, DATA_DIR "/" GAME_PIXMAPS_DIR "/" );
+	}
+
+	cSoftware_Image software_image = cSoftware_Image();
+	SDL_Surface *sdl_surface = NULL;
+	cImage_Settings_Data *settings = NULL;
+
+	// load settings if available
+	if( load_settings )
+	{
+		std::string settings_file = filename;
+
+		// if not already set
+		if( settings_file.rfind( ".settings" ) == std::string::npos )
+		{
+			settings_file.erase( settings_file.rfind( "." ) + 1 );
+			settings_file.insert( settings_file.rfind( "." ) + 1, "settings" );
+		}
+
+		// if a settings file exists
+		if( File_Exists( settings_file ) )
+		{
+			// use the default parser
+			if( !settings_parser )
+			{
+				settings_parser = pSettingsParser;
+			}
+
+			settings = settings_parser->Get( settings_file );
+
+			// use the level of the image cache for the current resolution
+			sdl_surface = Load_Cached_Surface( settings_file, settings, software_image.m_texture_format );
+
+			// image given in base settings
+			if( !sdl_surface && !settings->m_base.empty() )
+			{
+				sdl_surface = IMG_Load_RW( Open_File_RW( Get_Base_Image_Filename( filename, settings->m_base ) ), 1 );
 			}
 		}
 	}
@@ -1205,7 +2096,7 @@ cVideo::cSoftware_Image cVideo :: Load_Image( std::string filename, bool load_se
 	// if not set in image settings and file exists
 	if( !sdl_surface && File_Exists( filename ) && ( !settings || settings->m_base.empty() ) )
 	{
-		sdl_surface = IMG_Load( filename.c_str() );
+		sdl_surface = IMG_Load_RW( Open_File_RW( filename ), 1 );
 	}
 
 	if( !sdl_surface )
@@ -1224,23 +2115,310 @@ cVideo::cSoftware_Image cVideo :: Load_Image( std::string filename, bool load_se
 		return software_image;
 	}
 
-	software_image.m_sdl_surface = sdl_surface;
+	software_image.m_sdl_surface = sdl_surface;
+	software_image.m_settings = settings;
+	return software_image;
+}
+
+std::string cVideo :: Get_Base_Image_Filename( const std::string &filename, const std::string &base ) const
+{
+	// use current directory
+	std::string img_filename = filename.substr( 0, filename.rfind( "/" ) + 1 ) + base;
+
+	// not found
+	if( !File_Exists( img_filename ) )
+	{
+		// use data dir
+		img_filename = base;
+
+		// pixmaps dir must be given
+		if( img_filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/" ) == std::string::npos )
+		{
+			img_filename.insert( 0, DATA_DIR "/" GAME_PIXMAPS_DIR "/" );
+		}
+	}
+
+	return img_filename;
+}
+
+void cVideo :: Prepare_Software_Image( cSoftware_Image &software_image ) const
+{
+	if( !software_image.m_sdl_surface )
+	{
+		return;
+	}
+
+	// create final image
+	SDL_Surface *sdl_surface = Convert_To_Final_Software_Image( software_image.m_sdl_surface );
+
+	// get the size
+	if( software_image.m_settings )
+	{
+		cSize_Int size = software_image.m_settings->Get_Surface_Size( sdl_surface );
+		software_image.m_width = size.m_width;
+		software_image.m_height = size.m_height;
+	}
+	else
+	{
+		software_image.m_width = sdl_surface->w;
+		software_image.m_height = sdl_surface->h;
+	}
+
+	// get the texture size
+	const int texture_width = Get_Power_of_2( software_image.m_width );
+	const int texture_height = Get_Power_of_2( software_image.m_height );
+
+	// scale down to the texture size
+	if( texture_width <= sdl_surface->w && texture_height <= sdl_surface->h && ( texture_width != sdl_surface->w || texture_height != sdl_surface->h ) )
+	{
+		SDL_Surface *scaled = SDL_CreateRGBSurface( SDL_SWSURFACE, texture_width, texture_height, 32,
+		#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+				0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff );
+		#else
+				0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000 );
+		#endif
+
+		if( scaled )
+		{
+			Downscale_Image( static_cast<unsigned char*>(sdl_surface->pixels), sdl_surface->w, sdl_surface->h, sdl_surface->format->BytesPerPixel, static_cast<unsigned char*>(scaled->pixels), sdl_surface->w / texture_width, sdl_surface->h / texture_height );
+			SDL_FreeSurface( sdl_surface );
+			sdl_surface = scaled;
+		}
+	}
+
+	software_image.m_sdl_surface = sdl_surface;
+}
+
+cGL_Surface *cVideo :: Load_GL_Surface( std::string filename, bool use_settings /* = 1 */, bool print_errors /* = 1 */ )
+{
+	// pixmaps dir must be given
+	if( filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/" ) == std::string::npos ) 
+	{
+		filename.insert( 0, DATA_DIR "/" GAME_PIXMAPS_DIR "/" );
+	}
+
+	// use the compressed image cache
+	if( m_compressed_cache )
+	{
+		cLoad_Profiler_Scope profile_scope( "image cache" );
+		cGL_Surface *image = Load_Compressed_GL_Surface( filename, use_settings );
+
+		if( image )
+		{
+			return image;
+		}
+	}
+
+	// not in the compressed image cache
+	const bool save_compressed = m_compressed_cache != NULL;
+
+	// use the raw image cache
+	if( use_settings )
+	{
+		cLoad_Profiler_Scope profile_scope( "image raw cache" );
+		cGL_Surface *image = Load_Raw_GL_Surface( filename, save_compressed );
+
+		if( image )
+		{
+			return image;
+		}
+	}
+
+	cLoad_Profiler_Scope profile_scope( "image disk" );
+
+	// load software image
+	cSoftware_Image software_image = Load_Image( filename, use_settings, print_errors );
+
+	return Create_GL_Surface( filename, software_image, print_errors, save_compressed );
+}
+
+cGL_Surface *cVideo :: Load_Compressed_GL_Surface( const std::string &filename, bool use_settings /* = 1 */ )
+{
+	cImage_Settings_Data *settings = NULL;
+
+	// load settings if available
+	if( use_settings )
+	{
+		std::string settings_file = filename;
+
+		// if not already set
+		if( settings_file.rfind( ".settings" ) == std::string::npos )
+		{
+			settings_file.erase( settings_file.rfind( "." ) + 1 );
+			settings_file.insert( settings_file.rfind( "." ) + 1, "settings" );
+		}
+
+		if( File_Exists( settings_file ) )
+		{
+			settings = pSettingsParser->Get( settings_file );
+		}
+	}
+
+	// atlas images are not compressed
+	if( settings && !settings->m_mipmap && pTexture_Atlas && pTexture_Atlas->Is_Atlas_Image( filename ) )
+	{
+		delete settings;
+		return NULL;
+	}
+
+	// uses opengl directly
+	Render_Finish();
+
+	cGL_Surface *image = m_compressed_cache->Load( filename );
+
+	if( !image )
+	{
+		if( settings )
+		{
+			delete settings;
+		}
+
+		return NULL;
+	}
+
+	// apply settings
+	if( settings )
+	{
+		settings->Apply( image );
+		delete settings;
+	}
+
+	image->m_filename = filename;
+
+	return image;
+}
+
+SDL_Surface *cVideo :: Load_Cached_Surface( const std::string &settings_file, const cImage_Settings_Data *settings, Texture_Format &format ) const
+{
+	// remove data dir
+	const std::string raw_filename = m_imgcache_dir + "/" + settings_file.substr( strlen( DATA_DIR "/" ) ) + ".rgba";
+
+	cMapped_File file;
+	Raw_Cache_Header header;
+
+	if( !Open_Raw_Cache_File( raw_filename, file, header ) )
+	{
+		return NULL;
+	}
+
+	// size for the current resolution with the full texture quality
+	cSize_Int size = settings->Get_Surface_Size( header.m_tex_w, header.m_tex_h, 0 );
+
+	size_t offset = 0;
+
+	if( Get_Raw_Cache_Level( header, size.m_width, size.m_height, offset ) < 0 )
+	{
+		return NULL;
+	}
+
+	SDL_Surface *sdl_surface = SDL_CreateRGBSurface( SDL_SWSURFACE, size.m_width, size.m_height, 32,
+	#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+			0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff );
+	#else
+			0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000 );
+	#endif
+
+	if( !sdl_surface )
+	{
+		return NULL;
+	}
+
+	format = static_cast<Texture_Format>(header.m_texture_format);
+
+	// copied as the file is unmapped
+	const unsigned char *pixels = reinterpret_cast<const unsigned char *>(file.Get_Data()) + sizeof( Raw_Cache_Header ) + offset;
+
+	for( int y = 0; y < size.m_height; y++ )
+	{
+		memcpy( static_cast<unsigned char *>(sdl_surface->pixels) + y * sdl_surface->pitch, pixels + y * size.m_width * 4, size.m_width * 4 );
+	}
+
+	return sdl_surface;
+}
+
+cGL_Surface *cVideo :: Load_Raw_GL_Surface( const std::string &filename, bool save_compressed /* = 0 */ )
+{
+	std::string settings_file = filename;
+
+	if( settings_file.rfind( ".settings" ) == std::string::npos )
+	{
+		settings_file.erase( settings_file.rfind( "." ) + 1 );
+		settings_file.insert( settings_file.rfind( "." ) + 1, "settings" );
+	}
+
+	// remove data dir
+	const std::string raw_filename = m_imgcache_dir + "/" + settings_file.substr( strlen( DATA_DIR "/" ) ) + ".rgba";
+
+	cMapped_File file;
+	Raw_Cache_Header header;
+
+	if( !Open_Raw_Cache_File( raw_filename, file, header ) )
+	{
+		return NULL;
+	}
+
+	cImage_Settings_Data *settings = pSettingsParser->Get( settings_file );
+
+	if( !settings )
+	{
+		return NULL;
+	}
+
+	// size for the current resolution and texture settings as in Prepare_Software_Image
+	cSize_Int size = settings->Get_Surface_Size( header.m_tex_w, header.m_tex_h );
+
+	const int texture_width = Get_Power_of_2( size.m_width );
+	const int texture_height = Get_Power_of_2( size.m_height );
+
+	size_t offset = 0;
+	const int level = Get_Raw_Cache_Level( header, texture_width, texture_height, offset );
+
+	if( level < 0 )
+	{
+		delete settings;
+		return NULL;
+	}
+
+	const char *pixels = file.Get_Data() + sizeof( Raw_Cache_Header ) + offset;
+
+	// the surface uses the mapped pixels which are not freed with it
+	cSoftware_Image software_image;
+	software_image.m_sdl_surface = SDL_CreateRGBSurfaceFrom( const_cast<char *>(pixels), texture_width, texture_height, 32, texture_width * 4,
+	#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+			0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff );
+	#else
+			0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000 );
+	#endif
 	software_image.m_settings = settings;
-	return software_image;
-}
+	software_image.m_width = size.m_width;
+	software_image.m_height = size.m_height;
+	software_image.m_texture_format = static_cast<Texture_Format>(header.m_texture_format);
 
-cGL_Surface *cVideo :: Load_GL_Surface( std::string filename, bool use_settings /* = 1 */, bool print_errors /* = 1 */ )
-{
-	// pixmaps dir must be given
-	if( filename.find( DATA_DIR "/" GAME_PIXMAPS_DIR "/" ) == std::string::npos ) 
+	// the following levels are the mip levels
+	if( settings->m_mipmap && static_cast<unsigned int>(level) + 1 < header.m_levels )
 	{
-		filename.insert( 0, DATA_DIR "/" GAME_PIXMAPS_DIR "/" );
+		software_image.m_mip_levels = reinterpret_cast<const unsigned char *>(pixels) + texture_width * texture_height * 4;
 	}
 
-	// load software image
-	cSoftware_Image software_image = Load_Image( filename, use_settings, print_errors );
+	if( !software_image.m_sdl_surface )
+	{
+		delete settings;
+		return NULL;
+	}
+
+	// uploaded before the file is unmapped
+	return Create_GL_Surface( filename, software_image, 1, save_compressed );
+}
+
+cGL_Surface *cVideo :: Create_GL_Surface( const std::string &filename, cSoftware_Image &software_image, bool print_errors /* = 1 */, bool save_compressed /* = 0 */ )
+{
 	SDL_Surface *sdl_surface = software_image.m_sdl_surface;
 	cImage_Settings_Data *settings = software_image.m_settings;
+	const unsigned char *mip_levels = software_image.m_mip_levels;
+	const Texture_Format cached_format = software_image.m_texture_format;
+	software_image.m_sdl_surface = NULL;
+	software_image.m_settings = NULL;
+	software_image.m_mip_levels = NULL;
 
 	// final surface
 	cGL_Surface *image = NULL;
@@ -1249,10 +2427,30 @@ cGL_Surface *cVideo :: Load_GL_Surface( std::string filename, bool use_settings
 	if( settings )
 	{
 		// get the size
-		cSize_Int size = settings->Get_Surface_Size( sdl_surface );
-		Apply_Max_Texture_Size( size.m_width, size.m_height );
+		cSize_Int size;
+
+		// already prepared
+		if( software_image.m_width > 0 && software_image.m_height > 0 )
+		{
+			size.m_width = software_image.m_width;
+			size.m_height = software_image.m_height;
+		}
+		else
+		{
+			size = settings->Get_Surface_Size( sdl_surface );
+		}
+
+		// mipmaps are not available in the atlas pages
+		const bool add_to_atlas = !settings->m_mipmap && pTexture_Atlas && pTexture_Atlas->Is_Atlas_Image( filename );
+		// the atlas pages are rgba and the automatic format was chosen when cached
+		const Texture_Format format = add_to_atlas ? TEXTURE_FORMAT_RGBA8 : ( settings->m_texture_format != TEXTURE_FORMAT_AUTO ? settings->m_texture_format : cached_format );
 		// get basic settings surface
-		image = pVideo->Create_Texture( sdl_surface, settings->m_mipmap, size.m_width, size.m_height );
+		image = pVideo->Create_Texture( sdl_surface, settings->m_mipmap, size.m_width, size.m_height, add_to_atlas, mip_levels, format );
+		// save with the base size
+		if( save_compressed && m_compressed_cache )
+		{
+			m_compressed_cache->Save( filename, image, settings->m_mipmap );
+		}
 		// apply settings
 		settings->Apply( image );
 		delete settings;
@@ -1260,7 +2458,13 @@ cGL_Surface *cVideo :: Load_GL_Surface( std::string filename, bool use_settings
 	// without settings
 	else
 	{
-		image = Create_Texture( sdl_surface );
+		// keep the size if already scaled down
+		image = Create_Texture( sdl_surface, 0, software_image.m_width, software_image.m_height );
+
+		if( save_compressed && m_compressed_cache )
+		{
+			m_compressed_cache->Save( filename, image, 0 );
+		}
 	}
 	// set filename
 	if( image )
@@ -1306,13 +2510,17 @@ SDL_Surface *cVideo :: Convert_To_Final_Software_Image( SDL_Surface *surface ) c
 	return surface;
 }
 
-cGL_Surface *cVideo :: Create_Texture( SDL_Surface *surface, bool mipmap /* = 0 */, unsigned int force_width /* = 0 */, unsigned int force_height /* = 0 */ ) const
+cGL_Surface *cVideo :: Create_Texture( SDL_Surface *surface, bool mipmap /* = 0 */, unsigned int force_width /* = 0 */, unsigned int force_height /* = 0 */, bool add_to_atlas /* = 0 */, const unsigned char *mip_levels /* = NULL */, Texture_Format format /* = TEXTURE_FORMAT_AUTO */ ) const
 {
 	if( !surface )
 	{
 		return NULL;
 	}
 
+	// size without the power of two padding
+	const int used_width = surface->w;
+	const int used_height = surface->h;
+
 	// create final image
 	surface = Convert_To_Final_Software_Image( surface );
 
@@ -1321,24 +2529,6 @@ cGL_Surface *cVideo :: Create_Texture( SDL_Surface *surface, bool mipmap /* = 0
 	*/
 	pVideo->Render_Finish();
 
-	// create one texture
-	GLuint image_num = 0;
-	glGenTextures( 1, &image_num );
-
-	// if image id is 0 it failed
-	if( !image_num )
-	{
-		printf( "Error : GL image generation failed\n" );
-		SDL_FreeSurface( surface );
-		return NULL;
-	}
-	
-	// set highest texture id
-	if( pImage_Manager->m_high_texture_id < image_num )
-	{
-		pImage_Manager->m_high_texture_id = image_num;
-	}
-
 	int width = surface->w;
 	int height = surface->h;
 
@@ -1358,10 +2548,13 @@ cGL_Surface *cVideo :: Create_Texture( SDL_Surface *surface, bool mipmap /* = 0
 	}
 
 	// texture size
-	int texture_width = width;
-	int texture_height = height;
-	// check if the image size is greater than the maximum texture size
-	Apply_Max_Texture_Size( texture_width, texture_height );
+	const int texture_width = width;
+	const int texture_height = height;
+	// split into tiles instead of scaling down to the maximum texture size
+	const bool tiled = Is_Tiled_Texture_Size( texture_width, texture_height );
+
+	// pixels per row
+	unsigned int row_length = surface->pitch / surface->format->BytesPerPixel;
 
 	// scale to new size
 	if( texture_width != surface->w || texture_height != surface->h )
@@ -1374,11 +2567,76 @@ cGL_Surface *cVideo :: Create_Texture( SDL_Surface *surface, bool mipmap /* = 0
 		Downscale_Image( static_cast<unsigned char*>(surface->pixels), surface->w, surface->h, surface->format->BytesPerPixel, new_pixels, reduce_block_x, reduce_block_y );
 		SDL_free( surface->pixels );
 		surface->pixels = new_pixels;
+		row_length = texture_width;
+		// created for the old size
+		mip_levels = NULL;
+	}
+
+	// create OpenGL surface class
+	cGL_Surface *image = new cGL_Surface();
+	image->m_tex_w = texture_width;
+	image->m_tex_h = texture_height;
+	image->m_start_w = static_cast<float>(width);
+	image->m_start_h = static_cast<float>(height);
+	image->m_w = image->m_start_w;
+	image->m_h = image->m_start_h;
+	image->m_col_w = image->m_w;
+	image->m_col_h = image->m_h;
+	// used by the opaque render pass
+	image->m_opaque = Is_Opaque_Image( static_cast<unsigned char*>(surface->pixels), texture_width, texture_height, row_length );
+	// a smaller storage format is only chosen when the image is cached
+	image->m_texture_format = format != TEXTURE_FORMAT_AUTO ? format : TEXTURE_FORMAT_RGBA8;
+
+	// upload the used area of the scaled image as tiles
+	if( tiled )
+	{
+		const unsigned int tiles_width = ( used_width * texture_width + surface->w - 1 ) / surface->w;
+		const unsigned int tiles_height = ( used_height * texture_height + surface->h - 1 ) / surface->h;
+		const bool created = Create_Texture_Tiles( image, static_cast<unsigned char*>(surface->pixels), texture_width, texture_height, row_length, tiles_width, tiles_height, mipmap );
+
+		SDL_FreeSurface( surface );
+
+		if( !created )
+		{
+			delete image;
+			return NULL;
+		}
+
+		return image;
+	}
+
+	// use a texture atlas page
+	if( add_to_atlas && pTexture_Atlas->Add( image, static_cast<unsigned char*>(surface->pixels), texture_width, texture_height, row_length ) )
+	{
+		// the atlas pages are rgba
+		image->m_texture_format = TEXTURE_FORMAT_RGBA8;
+		SDL_FreeSurface( surface );
+		return image;
+	}
+
+	// create one texture
+	GLuint image_num = 0;
+	glGenTextures( 1, &image_num );
+
+	// if image id is 0 it failed
+	if( !image_num )
+	{
+		printf( "Error : GL image generation failed\n" );
+		SDL_FreeSurface( surface );
+		delete image;
+		return NULL;
+	}
+	
+	// set highest texture id
+	if( pImage_Manager->m_high_texture_id < image_num )
+	{
+		pImage_Manager->m_high_texture_id = image_num;
 	}
+
 	// set SDL_image pixel store mode
-	else
+	if( row_length != static_cast<unsigned int>(texture_width) )
 	{
-		glPixelStorei( GL_UNPACK_ROW_LENGTH, surface->pitch / surface->format->BytesPerPixel );
+		glPixelStorei( GL_UNPACK_ROW_LENGTH, row_length );
 	}
 
 	// use the generated texture
@@ -1390,24 +2648,14 @@ cGL_Surface *cVideo :: Create_Texture( SDL_Surface *surface, bool mipmap /* = 0
 	// set texture magnification function
 	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
 	// upload to OpenGL texture
-	Create_GL_Texture( texture_width, texture_height, surface->pixels, mipmap );
+	Create_GL_Texture( texture_width, texture_height, surface->pixels, mipmap, mipmap ? mip_levels : NULL, image->m_texture_format );
 
 	// unset pixel store mode
 	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
 
 	SDL_FreeSurface( surface );
 
-	// create OpenGL surface class
-	cGL_Surface *image = new cGL_Surface();
 	image->m_image = image_num;
-	image->m_tex_w = texture_width;
-	image->m_tex_h = texture_height;
-	image->m_start_w = static_cast<float>(width);
-	image->m_start_h = static_cast<float>(height);
-	image->m_w = image->m_start_w;
-	image->m_h = image->m_start_h;
-	image->m_col_w = image->m_w;
-	image->m_col_h = image->m_h;
 
 	// if debug build check for errors
 #ifdef _DEBUG
@@ -1423,11 +2671,128 @@ cGL_Surface *cVideo :: Create_Texture( SDL_Surface *surface, bool mipmap /* = 0
 	return image;
 }
 
-void cVideo :: Create_GL_Texture( unsigned int width, unsigned int height, const void *pixels, bool mipmap /* = 0 */ ) const
+bool cVideo :: Create_Texture_Tiles( cGL_Surface *image, const unsigned char *pixels, unsigned int width, unsigned int height, unsigned int row_length, unsigned int used_width, unsigned int used_height, bool mipmap ) const
+{
+	const unsigned int tile_size = Get_Texture_Tile_Size();
+	// tile pixels with the power of two padding
+	unsigned char *tile_pixels = new unsigned char[tile_size * tile_size * 4];
+
+	for( unsigned int y = 0; y < used_height; y += tile_size )
+	{
+		const unsigned int part_h = used_height - y < tile_size ? used_height - y : tile_size;
+		const unsigned int tile_h = Get_Power_of_2( part_h );
+
+		for( unsigned int x = 0; x < used_width; x += tile_size )
+		{
+			const unsigned int part_w = used_width - x < tile_size ? used_width - x : tile_size;
+			const unsigned int tile_w = Get_Power_of_2( part_w );
+			const unsigned char *part = pixels + ( ( y * row_length ) + x ) * 4;
+
+			// fully transparent parts are not drawn but the surface needs at least one texture
+			const bool last_part = x + tile_size >= used_width && y + tile_size >= used_height;
+
+			if( Is_Transparent_Image( part, part_w, part_h, row_length ) && !( last_part && image->m_tiles.empty() ) )
+			{
+				continue;
+			}
+
+			// copy the part without the image row length
+			if( part_w != tile_w || part_h != tile_h )
+			{
+				memset( tile_pixels, 0, tile_w * tile_h * 4 );
+			}
+
+			for( unsigned int row = 0; row < part_h; row++ )
+			{
+				memcpy( tile_pixels + ( row * tile_w * 4 ), part + ( row * row_length * 4 ), part_w * 4 );
+			}
+
+			GLuint tile_num = 0;
+			glGenTextures( 1, &tile_num );
+
+			// if image id is 0 it failed
+			if( !tile_num )
+			{
+				printf( "Error : GL tile image generation failed\n" );
+				delete[] tile_pixels;
+				return 0;
+			}
+
+			// set highest texture id
+			if( pImage_Manager->m_high_texture_id < tile_num )
+			{
+				pImage_Manager->m_high_texture_id = tile_num;
+			}
+
+			glBindTexture( GL_TEXTURE_2D, tile_num );
+
+			// the tile edges must not wrap to the other side
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+			Create_GL_Texture( tile_w, tile_h, tile_pixels, mipmap, NULL, image->m_texture_format );
+
+			cGL_Texture_Tile tile;
+			tile.m_texture_id = tile_num;
+			tile.m_x1 = static_cast<float>(x) / width;
+			tile.m_y1 = static_cast<float>(y) / height;
+			tile.m_x2 = static_cast<float>( x + part_w ) / width;
+			tile.m_y2 = static_cast<float>( y + part_h ) / height;
+			tile.m_tex_x2 = static_cast<float>(part_w) / tile_w;
+			tile.m_tex_y2 = static_cast<float>(part_h) / tile_h;
+
+			image->m_tiles.push_back( tile );
+			// the first tile is the surface texture
+			image->m_image = image->m_tiles.front().m_texture_id;
+		}
+	}
+
+	delete[] tile_pixels;
+
+	// if debug build check for errors
+#ifdef _DEBUG
+	// glGetError only saves one error flag
+	GLenum error = glGetError();
+
+	if( error != GL_NO_ERROR )
+	{
+		printf( "Create_Texture_Tiles : GL Error found : %s\n", gluErrorString( error ) );
+	}
+#endif
+
+	return 1;
+}
+
+void cVideo :: Create_GL_Texture( unsigned int width, unsigned int height, const void *pixels, bool mipmap /* = 0 */, const unsigned char *mip_levels /* = NULL */, Texture_Format format /* = TEXTURE_FORMAT_RGBA8 */ ) const
 {
+	cProfiler_Scope profile_scope( "texture upload" );
+
+	// the pixels are always rgba and converted by the driver
+	const GLint internal_format = Get_Texture_Internal_Format( format );
+
 	// unsigned byte is an unsigned 8-bit integer (1 byte)
+	// upload the already created mipmaps
+	if( mipmap && mip_levels )
+	{
+		// enable mipmap filter
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+
+		if( !m_texture_upload || !m_texture_upload->Tex_Image_2D( width, height, pixels, internal_format ) )
+		{
+			glTexImage2D( GL_TEXTURE_2D, 0, internal_format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
+		}
+
+		for( GLint level = 1; width > 1 || height > 1; level++ )
+		{
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+
+			glTexImage2D( GL_TEXTURE_2D, level, internal_format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, mip_levels );
+			mip_levels += width * height * 4;
+		}
+	}
 	// create mipmaps
-	if( mipmap )
+	else if( mipmap )
 	{
 		// enable mipmap filter
 		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
@@ -1438,13 +2803,16 @@ void cVideo :: Create_GL_Texture( unsigned int width, unsigned int height, const
 			// use glTexImage2D to create Mipmaps
 			glTexParameteri( GL_TEXTURE_2D, GL_GENERATE_MIPMAP, 1 );
 			// copy the software bitmap into the opengl texture
-			glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
+			if( !m_texture_upload || !m_texture_upload->Tex_Image_2D( width, height, pixels, internal_format ) )
+			{
+				glTexImage2D( GL_TEXTURE_2D, 0, internal_format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
+			}
 		}
 		// OpenGL below 1.4
 		else
 		{
 			// use glu to create Mipmaps
-			gluBuild2DMipmaps( GL_TEXTURE_2D, GL_RGBA, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
+			gluBuild2DMipmaps( GL_TEXTURE_2D, internal_format, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
 		}
 	}
 	// no mipmaps
@@ -1453,7 +2821,10 @@ void cVideo :: Create_GL_Texture( unsigned int width, unsigned int height, const
 		// default texture minifying function
 		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
 		// copy the software bitmap into the opengl texture
-		glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
+		if( !m_texture_upload || !m_texture_upload->Tex_Image_2D( width, height, pixels, internal_format ) )
+		{
+			glTexImage2D( GL_TEXTURE_2D, 0, internal_format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels );
+		}
 	}
 }
 
@@ -1677,36 +3048,28 @@ float cVideo :: Get_Scale( const cGL_Surface *image, float width, float height,
 	return 1;
 }
 
-void cVideo :: Apply_Max_Texture_Size( int &width, int &height ) const
+bool cVideo :: Is_Tiled_Texture_Size( int width, int height ) const
 {
-	if( width > m_max_texture_size )
-	{
-		// change height to keep aspect ratio
-		int scale_down = width / m_max_texture_size;
+	const int tile_size = static_cast<int>(m_texture_tile_size);
 
-		if( scale_down < 1 )
-		{
-			debug_print( "Warning : image height scale down %d is invalid\n", scale_down );
-			scale_down = 1;
-		}
-
-		height = height / scale_down;
-		width = m_max_texture_size;
-	}
-	if( height > m_max_texture_size )
+	// larger than a texture
+	if( width > m_max_texture_size || height > m_max_texture_size )
 	{
-		// change width to keep aspect ratio
-		int scale_down = height / m_max_texture_size;
+		return 1;
+	}
 
-		if( scale_down < 1 )
-		{
-			debug_print( "Warning : image width scale down %d is invalid\n", scale_down );
-			scale_down = 1;
-		}
+	// large enough to skip the padding and draw only the visible tiles
+	return width > tile_size * 2 || height > tile_size * 2;
+}
 
-		width = width / scale_down;
-		height = m_max_texture_size;
+unsigned int cVideo :: Get_Texture_Tile_Size( void ) const
+{
+	if( m_max_texture_size > 0 && static_cast<unsigned int>(m_max_texture_size) < m_texture_tile_size )
+	{
+		return m_max_texture_size;
 	}
+
+	return m_texture_tile_size;
 }
 
 /* function from Jonathan Dummer
@@ -1735,6 +3098,30 @@ bool cVideo :: Downscale_Image( const unsigned char* const orig, int width, int
 		mip_height = 1;
 	}
 
+	// the common whole blocks of rgba pixels
+	if( channels == 4 && block_size_x == block_size_y && ( block_size_x == 2 || block_size_x == 4 ) && width % block_size_x == 0 && height % block_size_y == 0 )
+	{
+		const int row_size = width * 4;
+
+		for( int j = 0; j < mip_height; ++j )
+		{
+			const unsigned char *block_row = orig + j * block_size_y * row_size;
+			unsigned char *resampled_row = resampled + j * mip_width * 4;
+
+			if( block_size_x == 2 )
+			{
+				Downscale_Row_2x2_RGBA( block_row, block_row + row_size, resampled_row, mip_width );
+			}
+			else
+			{
+				const unsigned char *const rows[4] = { block_row, block_row + row_size, block_row + 2 * row_size, block_row + 3 * row_size };
+				Downscale_Row_4x4_RGBA( rows, resampled_row, mip_width );
+			}
+		}
+
+		return 1;
+	}
+
 	int j, i, c;
 
 	for( j = 0; j < mip_height; ++j )
@@ -1755,7 +3142,7 @@ bool cVideo :: Downscale_Image( const unsigned char* const orig, int width, int
 				 */
 				if( block_size_x * (i + 1) > width )
 				{
-					u_block = width - i * block_size_y;
+					u_block = width - i * block_size_x;
 				}
 				if( block_size_y * (j + 1) > height )
 				{
@@ -1763,55 +3150,170 @@ bool cVideo :: Downscale_Image( const unsigned char* const orig, int width, int
 				}
 				block_area = u_block * v_block;
 
-				/* for this pixel, see what the average
-				 * of all the values in the block are.
-				 * note: start the sum at the rounding value, not at 0
-				 */
-				sum_value = block_area >> 1;
-				for( v = 0; v < v_block; ++v )
+				/* for this pixel, see what the average
+				 * of all the values in the block are.
+				 * note: start the sum at the rounding value, not at 0
+				 */
+				sum_value = block_area >> 1;
+				for( v = 0; v < v_block; ++v )
+				{
+					for( u = 0; u < u_block; ++u )
+					{
+						sum_value += orig[index + v * width * channels + u * channels];
+					}
+				}
+
+				resampled[j * mip_width * channels + i * channels + c] = sum_value / block_area;
+			}
+		}
+	}
+
+	return 1;
+}
+
+bool cVideo :: Is_Transparent_Image( const unsigned char *pixels, unsigned int width, unsigned int height, unsigned int row_length ) const
+{
+	for( unsigned int y = 0; y < height; y++ )
+	{
+		// the alpha is the fourth byte on every byte order
+		const unsigned char *alpha = pixels + ( y * row_length * 4 ) + 3;
+		const unsigned char *alpha_end = alpha + ( width * 4 );
+
+		for( ; alpha < alpha_end; alpha += 4 )
+		{
+			if( *alpha != 0 )
+			{
+				return 0;
+			}
+		}
+	}
+
+	return 1;
+}
+
+bool cVideo :: Is_Opaque_Image( const unsigned char *pixels, unsigned int width, unsigned int height, unsigned int row_length ) const
+{
+	for( unsigned int y = 0; y < height; y++ )
+	{
+		// the alpha is the fourth byte on every byte order
+		const unsigned char *alpha = pixels + ( y * row_length * 4 ) + 3;
+		const unsigned char *alpha_end = alpha + ( width * 4 );
+
+		for( ; alpha < alpha_end; alpha += 4 )
+		{
+			if( *alpha != 255 )
+			{
+				return 0;
+			}
+		}
+	}
+
+	return 1;
+}
+
+Texture_Format cVideo :: Get_Texture_Format( const unsigned char *pixels, unsigned int width, unsigned int height, unsigned int row_length ) const
+{
+	bool opaque = 1;
+	bool binary_alpha = 1;
+	bool greyscale = 1;
+	/* the first color of every 16 bit color with 5 and 4 bits per color channel
+	 * 0 is unused as fully transparent pixels are skipped
+	*/
+	vector<Uint32> colors_5bit( 65536, 0 );
+	vector<Uint32> colors_4bit( 65536, 0 );
+	// if different colors became the same 16 bit color
+	bool merged_5bit = 0;
+	bool merged_4bit = 0;
+
+	for( unsigned int y = 0; y < height; y++ )
+	{
+		const unsigned char *pixel = pixels + ( y * row_length * 4 );
+		const unsigned char *row_end = pixel + ( width * 4 );
+
+		for( ; pixel < row_end; pixel += 4 )
+		{
+			// fully transparent pixels are not visible
+			if( !pixel[3] )
+			{
+				opaque = 0;
+				continue;
+			}
+
+			if( pixel[3] != 255 )
+			{
+				opaque = 0;
+				binary_alpha = 0;
+			}
+
+			if( pixel[0] != pixel[1] || pixel[0] != pixel[2] )
+			{
+				greyscale = 0;
+			}
+
+			// no 16 bit format keeps the colors
+			if( merged_5bit && merged_4bit )
+			{
+				if( !greyscale )
 				{
-					for( u = 0; u < u_block; ++u )
-					{
-						sum_value += orig[index + v * width * channels + u * channels];
-					}
+					return TEXTURE_FORMAT_RGBA8;
 				}
 
-				resampled[j * mip_width * channels + i * channels + c] = sum_value / block_area;
+				continue;
+			}
+
+			const Uint32 color = pixel[0] | ( pixel[1] << 8 ) | ( pixel[2] << 16 ) | ( pixel[3] << 24 );
+			// the alpha only counts for the 4 bit format as the others have none or one bit
+			Uint32 &color_5bit = colors_5bit[( pixel[0] >> 3 ) | ( ( pixel[1] >> 3 ) << 5 ) | ( ( pixel[2] >> 3 ) << 10 ) | ( ( pixel[3] >> 7 ) << 15 )];
+			Uint32 &color_4bit = colors_4bit[( pixel[0] >> 4 ) | ( ( pixel[1] >> 4 ) << 4 ) | ( ( pixel[2] >> 4 ) << 8 ) | ( ( pixel[3] >> 4 ) << 12 )];
+
+			if( !color_5bit )
+			{
+				color_5bit = color;
+			}
+			else if( color_5bit != color )
+			{
+				merged_5bit = 1;
+			}
+
+			if( !color_4bit )
+			{
+				color_4bit = color;
+			}
+			else if( color_4bit != color )
+			{
+				merged_4bit = 1;
 			}
 		}
 	}
 
-	return 1;
-}
-
-void cVideo :: Save_Screenshot( void )
-{
-	Render_Finish();
+	// lossless
+	if( greyscale )
+	{
+		return TEXTURE_FORMAT_LA8;
+	}
 
-	std::string filename;
-	
-	for( unsigned int i = 1; i < 1000; i++ )
+	// the quality is kept if no colors are merged which would show as banding in gradients
+	if( ( opaque || binary_alpha ) && !merged_5bit )
 	{
-		filename = pResource_Manager->user_data_dir + USER_SCREENSHOT_DIR "/" + int_to_string( i ) + ".png";
+		return opaque ? TEXTURE_FORMAT_RGB565 : TEXTURE_FORMAT_RGB5_A1;
+	}
 
-		if( !File_Exists( filename ) )
-		{
-			// create image data
-			GLubyte *data = new GLubyte[pPreferences->m_video_screen_w * pPreferences->m_video_screen_h * 3];
-			// read opengl screen
-			glReadPixels( 0, 0, pPreferences->m_video_screen_w, pPreferences->m_video_screen_h, GL_RGB, GL_UNSIGNED_BYTE, static_cast<GLvoid *>(data) );
-			// save
-			Save_Surface( filename, data, pPreferences->m_video_screen_w, pPreferences->m_video_screen_h, 3, 1 );
-			// clear data
-			delete[] data;
+	if( !merged_4bit )
+	{
+		return TEXTURE_FORMAT_RGBA4;
+	}
 
-			// show info
-			pHud_Debug->Set_Text( "Screenshot " + int_to_string( i ) + _(" saved"), speedfactor_fps * 2.5f );
+	return TEXTURE_FORMAT_RGBA8;
+}
 
-			// finished
-			return;
-		}
+void cVideo :: Save_Screenshot( void )
+{
+	if( !m_screenshot )
+	{
+		return;
 	}
+
+	m_screenshot->Request();
 }
 
 void cVideo :: Save_Surface( const std::string &filename, const unsigned char *data, unsigned int width, unsigned int height, unsigned int bpp /* = 4 */, bool reverse_data /* = 0 */ ) const
@@ -1903,508 +3405,55 @@ void cVideo :: Save_Surface( const std::string &filename, const unsigned char *d
 
 void Draw_Effect_Out( Effect_Fadeout effect /* = EFFECT_OUT_RANDOM */, float speed /* = 1 */ )
 {
-	if( effect == EFFECT_OUT_RANDOM )
-	{
-		effect = static_cast<Effect_Fadeout>( ( rand() % (EFFECT_OUT_AMOUNT - 1) ) + 1 );
-	}
-
-	switch( effect )
-	{
-	case EFFECT_OUT_BLACK:
-	{
-		Color color = static_cast<Uint8>(0);
-
-		for( float i = 1; i > 0; i -= ( speed / 30 ) * pFramerate->m_speed_factor )
-		{
-			color.alpha = static_cast<Uint8>( 45 - ( 45 * i ) );
-
-			// create request
-			cRect_Request *request = new cRect_Request();
-			pVideo->Draw_Rect( NULL, 0.9f, &color, request );
-			
-			request->m_render_count = 2;
-
-			// add request
-			pRenderer->Add( request );
-
-			pVideo->Render();
-
-			pFramerate->Update();
-			// maximum fps
-			Correct_Frame_Time( 100 );
-		}
-		
-		break;
-	}
-	case EFFECT_OUT_HORIZONTAL_VERTICAL:
-	{
-		int hor = ( rand() % 2 ) - 1;
-		float pos = 0;
-		float pos_end = 0;
-
-		// horizontal
-		if( hor )
-		{
-			pos = static_cast<float>(game_res_w);
-		}
-		// vertical
-		else
-		{
-			pos = static_cast<float>(game_res_h);
-		}
-
-		Color color = Color( static_cast<Uint8>( 0 ), 0, 0, 0 );
-		float alpha = 10.0f;
-
-		while( pos > pos_end * 0.5f )
-		{
-			// fade alpha in
-			if( alpha < 255.0f )
-			{
-				alpha += 10 * pFramerate->m_speed_factor;
-
-				if( alpha > 255.0f )
-				{
-					alpha = 255.0f;
-				}
-
-				color.alpha = static_cast<Uint8>(alpha);
-			}
-
-			// draw gradient
-			cGradient_Request *gradient_request = new cGradient_Request();
-
-			// horizontal
-			if( hor )
-			{
-				pos -= 20 * pFramerate->m_speed_factor;
-				pos_end = static_cast<float>(game_res_w) - pos;
-				// left
-				pVideo->Draw_Gradient( 0, 0, pos_end, static_cast<float>(game_res_h), 0.9f, &color, &black, DIR_HORIZONTAL, gradient_request );
-			}
-			// vertical
-			else
-			{
-				pos -= 15 * pFramerate->m_speed_factor;
-				pos_end = static_cast<float>(game_res_h) - pos;
-				// top
-				pVideo->Draw_Gradient( 0, 0, static_cast<float>(game_res_w), pos_end, 0.9f, &color, &black, DIR_VERTICAL, gradient_request );
-			}
-
-			gradient_request->m_render_count = 2;
-			// add request
-			pRenderer->Add( gradient_request );
-
-			gradient_request = new cGradient_Request();
-
-			// horizontal
-			if( hor )
-			{
-				// right
-				pVideo->Draw_Gradient( static_cast<float>(game_res_w) - pos_end, 0, pos_end, static_cast<float>(game_res_h), 0.9f, &color, &black, DIR_HORIZONTAL, gradient_request );
-			}
-			// vertical
-			else
-			{
-				// down
-				pVideo->Draw_Gradient( 0, static_cast<float>(game_res_h) - pos_end, static_cast<float>(game_res_w), pos_end, 0.9f, &color, &black, DIR_VERTICAL, gradient_request );
-			}
-
-			gradient_request->m_render_count = 2;
-			// add request
-			pRenderer->Add( gradient_request );
-
-			// draw game
-			Draw_Game();
-
-			pVideo->Render();
-
-			pFramerate->Update();
-			// maximum fps
-			Correct_Frame_Time( 100 );
-		}
-		break;
-	}
-	case EFFECT_OUT_BIG_ITEM:
-	{
-		float f = 0.1f;
-		cGL_Surface *image = NULL;
-
-		// item based on the camera x position
-		if( pActive_Camera->m_x < 2000 )
-		{
-			image = pVideo->Get_Surface( "game/items/mushroom_red.png" );
-		}
-		else if( pActive_Camera->m_x < 5000 )
-		{
-			image = pVideo->Get_Surface( "game/items/fireplant.png" );
-		}
-		else if( pActive_Camera->m_x < 10000 )
-		{
-			image = pVideo->Get_Surface( "game/items/mushroom_green.png" );
-		}
-		else if( pActive_Camera->m_x < 20000 )
-		{
-			image = pVideo->Get_Surface( "game/items/star.png" );
-		}
-		else
-		{
-			image = pVideo->Get_Surface( "game/items/moon_1.png" );
-		}
-
-		Color color = white;
-
-		while( f < 50 )
-		{
-			Draw_Game();
-
-			f += 0.9f * pFramerate->m_speed_factor * speed * ( f / 7 );
-
-			color = Color( static_cast<Uint8>( 255 - ( f * 4 ) ), 255 - static_cast<Uint8>( f * 4 ), 255 - static_cast<Uint8>( f * 4 ), 200 - static_cast<Uint8>( f * 4 ) );
-
-			// ## item
-			// create request
-			cSurface_Request *request = new cSurface_Request();
-			image->Blit( ( game_res_w * 0.5f ) - ( ( image->m_w * f ) / 2 ) , game_res_h * 0.5f - ( ( image->m_h * f ) / 2 ), 0.9f, request );
-
-			request->m_blend_sfactor = GL_SRC_ALPHA;
-			request->m_blend_dfactor = GL_ONE;
-
-			request->m_color = color;
-
-			// scale
-			request->m_scale_x = f;
-			request->m_scale_y = f;
-
-			// add request
-			pRenderer->Add( request );
-			
-
-			// ## additional black fadeout
-			color = Color( 0, 0, 0, static_cast<Uint8>( 50 + ( f * 4 ) ) );
-
-			// create request
-			cRect_Request *rect_request = new cRect_Request();
-			pVideo->Draw_Rect( NULL, 0.901f, &color, rect_request );
-
-			// add request
-			pRenderer->Add( rect_request );
-
-			pVideo->Render();
-			pFramerate->Update();
-		}
-
-		break;
-	}
-	case EFFECT_OUT_RANDOM_COLOR_BOOST:
-	{
-		unsigned int rand_color_num = ( rand() % 4 );
-
-		Color rand_color;
-
-		// red
-		if( rand_color_num == 0 )
-		{
-			rand_color = Color( static_cast<Uint8>( 1 ), 20, 20, 4 );
-		}
-		// green
-		else if( rand_color_num == 1 )
-		{
-			rand_color = Color( static_cast<Uint8>( 20 ), 1, 20, 4 );
-		}
-		// blue
-		else if( rand_color_num == 2 )
-		{
-			rand_color = Color( static_cast<Uint8>( 20 ), 20, 1, 4 );
-		}
-		// yellow
-		else
-		{
-			rand_color = Color( static_cast<Uint8>( 1 ), 1, 40, 4 );
-		}
-
-		// rect size
-		float rect_size = 1.0f;
-
-		while( rect_size < 200.0f )
-		{
-			rect_size += 4.0f * pFramerate->m_speed_factor;
-
-			for( unsigned int g = 0; g < 50; g++ )
-			{
-				// create request
-				cRect_Request *request = new cRect_Request();
-				pVideo->Draw_Rect( Get_Random_Float( -rect_size * 0.5f, game_res_w - rect_size * 0.5f ), Get_Random_Float( -rect_size * 0.5f, game_res_h - rect_size * 0.5f ), rect_size, rect_size, 0.9f, &rand_color, request );
-
-				request->m_render_count = 2;
-
-				request->m_blend_sfactor = GL_SRC_ALPHA;
-				request->m_blend_dfactor = GL_ONE_MINUS_SRC_COLOR;
-
-				// add request
-				pRenderer->Add( request );
-			}
-
-			pVideo->Render();
-			pFramerate->Update();
-		}
-		break;
-	}
-	case EFFECT_OUT_BLACK_TILED_RECTS:
-	{
-		// grid settings
-		const unsigned int tiles_num_hor = 8;
-		const unsigned int tiles_num_ver = 6;
-		const unsigned int tiles_num = tiles_num_hor * tiles_num_ver;
-
-		// the grid
-		float grid[tiles_num_ver][tiles_num_hor];
-
-		// init grid
-		for( unsigned int i = 0; i < tiles_num_ver; i++ )
-		{
-			for( unsigned int j = 0; j < tiles_num_hor; j++ )
-			{
-				grid[i][j] = 0.0f;
-			}
-		}
-		
-		unsigned int selected_tile_x = 0;
-		unsigned int selected_tile_y = 0;
-
-		unsigned int activated_tiles = 0;
-
-		GL_rect dest( 0, 0, static_cast<float>(game_res_w) / tiles_num_hor, static_cast<float>(game_res_h) / tiles_num_ver );
-		Color color = black;
-
-		// update until the latest tile did fade in
-		while( grid[selected_tile_y][selected_tile_x] < 60.0f )
-		{
-			// if not all activated
-			if( activated_tiles < tiles_num )
-			{
-				// find an unused rect
-				while( grid[selected_tile_y][selected_tile_x] > 0.1f )
-				{
-					unsigned int temp = rand() % tiles_num;
+	pScreen_Transition->Start_Out( effect, speed );
 
-					selected_tile_y = temp / tiles_num_hor;
-					selected_tile_x = temp % tiles_num_hor;
-				}
-
-				// activate it
-				grid[selected_tile_y][selected_tile_x] = 0.2f;
-				activated_tiles++;
-			}
-			
-			// fade in and draw all activated tiles
-			for( unsigned int x = 0; x < tiles_num_hor; x++ )
-			{
-				for( unsigned int y = 0; y < tiles_num_ver; y++ )
-				{
-					// not activated
-					if( grid[y][x] < 0.1f )
-					{
-						continue;
-					}
-
-					// fade in
-					if( grid[y][x] < 120.0f )
-					{
-						grid[y][x] += pFramerate->m_speed_factor;
-						
-						if( grid[y][x] > 120.0f )
-						{
-							grid[y][x] = 120.0f;
-						}
-					}
-
-					// set position
-					dest.m_x = x * dest.m_w;
-					dest.m_y = y * dest.m_h;
-					// set alpha
-					color.alpha = static_cast<Uint8>(grid[y][x] * 0.4f);
-
-					// create request
-					cRect_Request *request = new cRect_Request();
-					pVideo->Draw_Rect( &dest, 0.9f, &color, request );
-
-					// rotation
-					request->m_rot_z = grid[y][x] * 5.0f;
-
-					// scale
-					request->m_scale_x = 0.1f + (grid[y][x] * 0.02f);
-					request->m_scale_y = request->m_scale_x;
-					request->m_rect.m_x -= ( dest.m_w * 0.5f ) * ( request->m_scale_x - 1.0f );
-					request->m_rect.m_y -= ( dest.m_h * 0.5f ) * ( request->m_scale_y - 1.0f );
-
-
-					request->m_render_count = 2;
-					// add request
-					pRenderer->Add( request );
-				}
-			}
-
-			pVideo->Render();
-			pFramerate->Update();
-			// correction needed
-			Correct_Frame_Time( speedfactor_fps * 2 );
-		}
-		break;
-	}
-	case EFFECT_OUT_FIXED_COLORBOX:
+	// until the screen is covered
+	while( !pScreen_Transition->Is_Covered() )
 	{
-		Color start_color;
-
-		const unsigned int rand_color = ( rand() % 2 );
-
-		// green
-		if( rand_color == 0 )
-		{
-			start_color = Color( static_cast<Uint8>(10), 55, 10, 250 );
-		}
-		// blue
-		else
-		{
-			start_color = Color( static_cast<Uint8>(10), 10, 55, 250 );
-		}
-
-		Color color = start_color;
-		float color_mod = 1.0f;
-
-		// position
-		float pos_x = 0;
-		float pos_y = 0;
-		// size
-		float rect_size = 20;
-		// rect used for grid drawing
-		GL_rect rect;
-
-		// animate until size reached the limit
-		while( rect_size < 35 )
-		{
-			// add size
-			rect_size += 0.3f * pFramerate->m_speed_factor;
+		pScreen_Transition->Update();
+		Draw_Game();
 
-			// change color modification
-			if( color_mod > 0.0f )
-			{
-				color_mod -= 0.04f * pFramerate->m_speed_factor;
-
-				if( color_mod < 0.0f )
-				{
-					color_mod = 0.0f;
-				}
-
-				// darken color
-				color.red = static_cast<Uint8>(start_color.red * color_mod);
-				color.green = static_cast<Uint8>(start_color.green * color_mod);
-				color.blue = static_cast<Uint8>(start_color.blue * color_mod);
-				color.alpha = static_cast<Uint8>(rect_size * 0.3f);
-			}
-
-			// continuous random position advance
-			float random = Get_Random_Float( 2.0f, 3.0f );
-			pos_x -= random;
-			pos_y -= random + Get_Random_Float( 0.1f, 0.1f );
-
-			// draw rects as a net
-			// horizontal
-			for( rect.m_x = pos_x; rect.m_x < game_res_w; rect.m_x += 20 + ( rect_size * color_mod ) )
-			{
-				// vertical
-				for( rect.m_y = pos_y; rect.m_y < game_res_h; rect.m_y += 20 + ( rect_size * color_mod ) )
-				{
-					rect.m_w = Get_Random_Float( 1.0f, 0.2f + ( rect_size * 1.5f ) );
-					rect.m_h = Get_Random_Float( 1.0f, 0.2f + ( rect_size * 1.5f ) );
-
-					// create request
-					cRect_Request *request = new cRect_Request();
-					pVideo->Draw_Rect( &rect, 0.9f, &color, request );
-
-					request->m_render_count = 2;
-
-					// add request
-					pRenderer->Add( request );
-				}
-			}
-
-			Color rect_color;
-			rect_color.red = static_cast<Uint8>(start_color.red * 0.1f * color_mod);
-			rect_color.green = static_cast<Uint8>(start_color.green * 0.1f * color_mod);
-			rect_color.blue = static_cast<Uint8>(start_color.blue * 0.1f * color_mod);
-			rect_color.alpha = static_cast<Uint8>(rect_size * 3);
-			// create request
-			cRect_Request *request = new cRect_Request();
-			pVideo->Draw_Rect( NULL, 0.9f, &rect_color, request );
-			
-			request->m_render_count = 2;
+		pVideo->Render();
 
-			request->m_blend_sfactor = GL_SRC_ALPHA;
-			request->m_blend_dfactor = GL_ONE_MINUS_SRC_COLOR;
-
-			// add request
-			pRenderer->Add( request );
-
-			pVideo->Render();
-			pFramerate->Update();
-			// correction needed
-			Correct_Frame_Time( speedfactor_fps * 2 );
-		}
-		break;
-	}
-	default:
-		break;  // be happy
+		pFramerate->Update();
+		// maximum fps
+		Correct_Frame_Time( 100 );
 	}
-	
-	pFramerate->Update();
 }
 
 void Draw_Effect_In( Effect_Fadein effect /* = EFFECT_IN_RANDOM */, float speed /* = 1 */ )
 {
 	// Clear render cache
+	pVideo->Render_Finish();
 	pRenderer->Clear( 1 );
 
-	if( effect == EFFECT_IN_RANDOM )
-	{
-		effect = static_cast<Effect_Fadein>( ( rand() % (EFFECT_IN_AMOUNT - 1) ) + 1 );
-	}
+	pScreen_Transition->Start_In( effect, speed );
 
-	switch( effect )
+	while( pScreen_Transition->Is_Active() )
 	{
-	case EFFECT_IN_BLACK:
-	{
-		Color color = static_cast<Uint8>(0);
-
-		for( float i = 1; i > 0; i -= ( speed / 30 ) * pFramerate->m_speed_factor )
-		{
-			color.alpha = static_cast<Uint8>( 255 * i );
-
-			// create request
-			cRect_Request *request = new cRect_Request();
-			pVideo->Draw_Rect( NULL, 0.9f, &color, request );
+		pScreen_Transition->Update();
+		Draw_Game();
 
-			// add request
-			pRenderer->Add( request );
+		pVideo->Render();
 
-			Draw_Game();
-
-			pVideo->Render();
-
-			pFramerate->Update();
-			// maximum fps
-			Correct_Frame_Time( 100 );
-		}
-		
-		break;
-	}
-	default:
-		break;  // be happy
+		pFramerate->Update();
+		// maximum fps
+		Correct_Frame_Time( 100 );
 	}
-	
-	pFramerate->Update();
 }
 
+// loading screen drawing rate
+static const unsigned int loading_screen_fps = 30;
+// loading screen state set from any thread
+static boost::mutex loading_screen_mutex;
+static std::string loading_screen_text;
+static bool loading_screen_text_changed = 0;
+static unsigned int loading_screen_done = 0;
+static unsigned int loading_screen_count = 0;
+static bool loading_screen_progress_changed = 0;
+// time of the last drawing
+static Uint32 loading_screen_draw_time = 0;
+
 void Loading_Screen_Init( void )
 {
 	if( CEGUI::WindowManager::getSingleton().isWindowPresent( "loading" ) )
@@ -2428,31 +3477,87 @@ void Loading_Screen_Init( void )
 	// set info text
 	CEGUI::Window *text_default = static_cast<CEGUI::Window *>(CEGUI::WindowManager::getSingleton().getWindow( "text_loading" ));
 	text_default->setText( _("Loading") );
+
+	boost::mutex::scoped_lock lock( loading_screen_mutex );
+	loading_screen_text_changed = 0;
+	loading_screen_done = 0;
+	loading_screen_count = 0;
+	loading_screen_progress_changed = 0;
+	// the first change is shown
+	loading_screen_draw_time = 0;
 }
 
 void Loading_Screen_Draw_Text( const std::string &str_info /* = "Loading" */ )
 {
-	// set info text
-	CEGUI::Window *text_default = static_cast<CEGUI::Window *>(CEGUI::WindowManager::getSingleton().getWindow( "text_loading" ));
-	if( !text_default )
 	{
-		printf( "Warning: Loading Screen not initialized." );
-		return;
+		boost::mutex::scoped_lock lock( loading_screen_mutex );
+		loading_screen_text = str_info;
+		loading_screen_text_changed = 1;
 	}
-	text_default->setText( reinterpret_cast<const CEGUI::utf8*>(str_info.c_str()) );
 
 	Loading_Screen_Draw();
 }
 
-void Loading_Screen_Draw( void )
+void Loading_Screen_Set_Progress( unsigned int done, unsigned int count )
+{
+	boost::mutex::scoped_lock lock( loading_screen_mutex );
+	loading_screen_done = done;
+	loading_screen_count = count;
+	loading_screen_progress_changed = 1;
+}
+
+void Loading_Screen_Add_Progress( void )
+{
+	boost::mutex::scoped_lock lock( loading_screen_mutex );
+	loading_screen_done++;
+	loading_screen_progress_changed = 1;
+}
+
+void Loading_Screen_Draw( bool force /* = 0 */ )
 {
+	// keep the window responsive
+	SDL_PumpEvents();
+
 	// limit fps or vsync will slow down the loading
-	if( !Is_Frame_Time( 60 ) )
+	if( !force && loading_screen_draw_time && SDL_GetTicks() - loading_screen_draw_time < 1000 / loading_screen_fps )
 	{
+		// uses opengl directly
+		pVideo->Render_Finish();
 		pRenderer->Fake_Render();
 		return;
 	}
 
+	CEGUI::WindowManager &wmgr = CEGUI::WindowManager::getSingleton();
+
+	if( !wmgr.isWindowPresent( "text_loading" ) )
+	{
+		printf( "Warning: Loading Screen not initialized." );
+		return;
+	}
+
+	// take the changes
+	{
+		boost::mutex::scoped_lock lock( loading_screen_mutex );
+
+		if( loading_screen_text_changed )
+		{
+			wmgr.getWindow( "text_loading" )->setText( reinterpret_cast<const CEGUI::utf8*>(loading_screen_text.c_str()) );
+			loading_screen_text_changed = 0;
+		}
+
+		if( loading_screen_progress_changed )
+		{
+			CEGUI::ProgressBar *progress_bar = static_cast<CEGUI::ProgressBar *>(wmgr.getWindow( "progress_bar" ));
+			progress_bar->setProgress( loading_screen_count ? static_cast<float>(loading_screen_done) / static_cast<float>(loading_screen_count) : 0.0f );
+			loading_screen_progress_changed = 0;
+		}
+	}
+
+	loading_screen_draw_time = SDL_GetTicks();
+
+	// uses opengl directly
+	pVideo->Render_Finish();
+
 	// clear screen
 	pVideo->Clear_Screen();
 	pVideo->Draw_Rect( NULL, 0.00001f, &black );
@@ -19,6 +19,7 @@
 #include "../core/global_basic.h"
 #include "../core/global_game.h"
 #include "../video/color.h"
+#include "../video/gl_surface.h"
 // glx
 #ifdef __unix__
 	#include <GL/glx.h>
@@ -39,6 +40,8 @@
 #include "RendererModules/OpenGL/CEGUIOpenGLRenderer.h"
 // boost thread
 #include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 namespace SMC
 {
@@ -89,7 +92,7 @@ public:
 	// Initialize all the SDL systems
 	void Init_SDL( void );
 	/* Initialize the screen surface
-	 * reload_textures_from_file: if set reloads all textures from the original file
+	 * reload_textures_from_file: if set reloads all textures from the original file when used
 	 * use_preferences: if set use user preferences settings
 	 * shows an error if failed and exits
 	*/
@@ -102,11 +105,36 @@ public:
 	void Init_Texture_Detail( void );
 	// initialize the up/down scaling value for the current resolution ( image/mouse scale )
 	void Init_Resolution_Scale( void ) const;
-	/* Initialize the image cache and recreates cache if game version changed
+	/* Initialize the image cache and cache the changed images in the background
+	 * the original images are used until their cache file is created
 	 * recreate : if set force cache recreation
 	 * draw_gui : if set use the loading screen gui for drawing
 	*/
 	void Init_Image_Cache( bool recreate = 0, bool draw_gui = 0 );
+	/* Create the offscreen render target if the dynamic resolution is enabled
+	 * falls back to drawing directly to the screen if not supported
+	*/
+	void Init_Render_Target( void );
+	/* Create the compressed image cache if enabled
+	 * falls back to the normal image cache if texture compression is not supported
+	*/
+	void Init_Compressed_Cache( void );
+	/* Create the pixel buffer texture upload if supported
+	 * falls back to uploading the textures directly
+	*/
+	void Init_Texture_Upload( void );
+	// Create the render phase timer queries if supported
+	void Init_GPU_Timer( void );
+	// Create the screenshot writer with the pixel buffer read back if supported
+	void Init_Screenshot( void );
+	/* Create the particle shader if enabled
+	 * falls back to simulating the particles on the cpu if shaders are not supported
+	*/
+	void Init_Particle_Shader( void );
+	/* Create the sprite shader if enabled
+	 * falls back to the fixed function batching if shaders are not supported
+	*/
+	void Init_Sprite_Shader( void );
 
 	/* Test if the given resolution and bits per pixel are valid
 	 * if flags aren't set they are auto set from the preferences
@@ -125,13 +153,47 @@ public:
 	// make the opengl context inactive for the current thread
 	void Make_GL_Context_Inactive( void );
 
-	// Render. Should be called from a thread
-	void Render_From_Thread( void );
-	// Render game, GUI and swap the opengl buffer
+	/* Start the render thread if enabled in the preferences
+	 * the render thread owns the opengl context while it is not needed in the main thread
+	*/
+	void Init_Render_Thread( void );
+	// Stop the render thread and make the opengl context current in the main thread
+	void Exit_Render_Thread( void );
+	// Render thread main loop
+	void Render_Thread_Loop( void );
+	/* Render game, GUI and swap the opengl buffer
+	 * threaded : if set and the render thread is running the current frame is
+	 * handed to the render thread and this returns without waiting for it
+	*/
 	void Render( bool threaded = 0 );
-	// Finish thread rendering
+	// Render the queue into the render target if used or to the screen
+	void Render_Queue( cRenderQueue *queue );
+	// Render the GUI and measure its GPU time
+	void Render_GUI( void );
+	// Read back the GPU times after the buffer swap
+	void GPU_Timer_Frame_End( void );
+	/* Wait for the GPU if the low latency mode is enabled and measure the input latency
+	 * input_time : the time the input of the frame was sampled
+	*/
+	void Frame_Presented( Uint64 input_time );
+	/* Adjust the render target resolution scale with the measured frame time
+	 * the resolution is lowered if the frames take longer than the dynamic resolution target fps
+	*/
+	void Update_Render_Scale( void );
+	// Delete the particle seed buffers which are not used by the render thread anymore
+	void Update_Particle_Shader( void );
+	/* Wait until the render thread finished and make the opengl context current in the main thread
+	 * must be called before using opengl directly in the main thread
+	*/
 	void Render_Finish( void );
 
+	/* Lock the GUI against rendering from the render thread
+	 * must be set while the main thread changes the GUI
+	*/
+	void Lock_GUI( void );
+	// Unlock the GUI for rendering from the render thread
+	void Unlock_GUI( void );
+
 	// Toggle fullscreen video mode ( new mode is set to preferences )
 	void Toggle_Fullscreen( void );
 
@@ -148,18 +210,40 @@ public:
 		{
 			m_sdl_surface = NULL;
 			m_settings = NULL;
+			m_width = 0;
+			m_height = 0;
+			m_mip_levels = NULL;
+			m_texture_format = TEXTURE_FORMAT_AUTO;
 		};
 
 		SDL_Surface *m_sdl_surface;
 		cImage_Settings_Data *m_settings;
+		// final image size if prepared
+		int m_width;
+		int m_height;
+		// the following mip levels down to 1x1 or NULL if they are generated when uploading
+		const unsigned char *m_mip_levels;
+		// format chosen when the image was cached or auto if not cached
+		Texture_Format m_texture_format;
 	};
 
 	/* Load and return the software image with the settings data
 	 * The returned sdl image should be deleted if not used anymore but not the settings data which is managed
 	 * load_settings : enable file settings if set to 1
 	 * print_errors : print errors if image couldn't be created or loaded
+	 * settings_parser : parser for the image settings or NULL to use the default parser
+	*/
+	cSoftware_Image Load_Image( std::string filename, bool load_settings = 1, bool print_errors = 1, cImage_Settings_Parser *settings_parser = NULL ) const;
+	/* Returns the image file used for the base setting of the image settings
+	 * filename : full image filename
+	 * base : image settings base path
 	*/
-	cSoftware_Image Load_Image( std::string filename, bool load_settings = 1, bool print_errors = 1 ) const;
+	std::string Get_Base_Image_Filename( const std::string &filename, const std::string &base ) const;
+
+	/* Convert the software image to the final format and scale it down to the texture size
+	 * does not use opengl and can be used from another thread
+	*/
+	void Prepare_Software_Image( cSoftware_Image &software_image ) const;
 
 	/* Load and return the hardware image
 	 * use_settings : enable file settings if set to 1
@@ -168,6 +252,49 @@ public:
 	*/
 	cGL_Surface *Load_GL_Surface( std::string filename, bool use_settings = 1, bool print_errors = 1 );
 
+	/* Load and return the hardware image from the compressed image cache
+	 * returns NULL if not cached
+	 * filename : full image filename
+	 * use_settings : enable file settings if set to 1
+	*/
+	cGL_Surface *Load_Compressed_GL_Surface( const std::string &filename, bool use_settings = 1 );
+	/* Load and return the hardware image from the raw image cache
+	 * the mapped level for the current resolution and texture settings is uploaded
+	 * with the following levels as mip levels without decoding or converting them
+	 * returns NULL if not cached or if no level has the texture size
+	 * filename : full image filename
+	 * save_compressed : save the texture into the compressed image cache
+	*/
+	cGL_Surface *Load_Raw_GL_Surface( const std::string &filename, bool save_compressed = 0 );
+	/* Returns a copy of the raw image cache level for the current resolution with the full texture quality
+	 * returns NULL if not cached or if no level has the size
+	 * does not use opengl and can be used from another thread
+	 * settings_file : full image settings filename
+	 * settings : the image settings
+	 * format : set to the texture format chosen when cached
+	*/
+	SDL_Surface *Load_Cached_Surface( const std::string &settings_file, const cImage_Settings_Data *settings, Texture_Format &format ) const;
+
+	/* Create the hardware image from the loaded software image
+	 * the software image gets deleted
+	 * filename : full image filename
+	 * print_errors : print errors if image couldn't be created
+	 * save_compressed : save the texture into the compressed image cache
+	 * which should only be done if it was not found in it as the texture is read back
+	*/
+	cGL_Surface *Create_GL_Surface( const std::string &filename, cSoftware_Image &software_image, bool print_errors = 1, bool save_compressed = 0 );
+
+	/* Save the full size texture pixels of the image with all mip levels into the raw image cache
+	 * trades disk space for loading without decoding the image
+	 * the mip levels are created with Downscale_Image and each is the texture of a resolution
+	 * the old cache file must be removed before as the original image is loaded
+	 * does not use opengl and can be used from another thread
+	 * filename : settings filename in the data directory
+	 * cache_dir : image cache directory
+	 * settings_parser : parser for the image settings or NULL to use the default parser
+	*/
+	void Cache_Raw_Image( const std::string &filename, const std::string &cache_dir, cImage_Settings_Parser *settings_parser = NULL ) const;
+
 	/* Convert to a scaled software image with a power of 2 size and 32 bits per pixel.
 	 * Conversion only happens if needed.
 	 * surface : the source image which gets converted if needed
@@ -179,13 +306,20 @@ public:
 	 * surface : the source SDL_surface which will be auto-deleted.
 	 * mipmap : create texture mipmaps
 	 * force_width/height : force the given width and height
+	 * add_to_atlas : if set try to add it to a texture atlas page instead of an own texture
+	 * mip_levels : the following mip levels if mipmap is set and they are already created
+	 * they are only used if the surface is not scaled or split into tiles
+	 * format : texture storage format or TEXTURE_FORMAT_AUTO for the format chosen when cached which is rgba8 here
+	 * images larger than two tiles or the maximum texture size are split into tiles
 	*/
-	cGL_Surface *Create_Texture( SDL_Surface *surface, bool mipmap = 0, unsigned int force_width = 0, unsigned int force_height = 0 ) const;
+	cGL_Surface *Create_Texture( SDL_Surface *surface, bool mipmap = 0, unsigned int force_width = 0, unsigned int force_height = 0, bool add_to_atlas = 0, const unsigned char *mip_levels = NULL, Texture_Format format = TEXTURE_FORMAT_AUTO ) const;
 
 	/* Copy pixels to the bound GL texture
 	 * mipmap : create texture mipmaps
+	 * mip_levels : the following rgba mip levels down to 1x1 or NULL to generate them
+	 * format : texture storage format of the rgba pixels
 	*/
-	void Create_GL_Texture( unsigned int width, unsigned int height, const void *pixels, bool mipmap = 0 ) const;
+	void Create_GL_Texture( unsigned int width, unsigned int height, const void *pixels, bool mipmap = 0, const unsigned char *mip_levels = NULL, Texture_Format format = TEXTURE_FORMAT_RGBA8 ) const;
 
 	// Get pixel color of the given position on the screen
 	Color Get_Pixel( int x, int y ) const;
@@ -213,18 +347,38 @@ public:
 	 * also upscales if only_downscale is set to 0
 	*/
 	float Get_Scale( const cGL_Surface *image, float width, float height, bool only_downscale = 1 ) const;
-	// scale the size down if the width or height is bigger than the maximum supported texture size
-	void Apply_Max_Texture_Size( int &width, int &height ) const;
+	// Returns true if an image of the size is split into tiles
+	bool Is_Tiled_Texture_Size( int width, int height ) const;
+	// Returns the size of the tiles
+	unsigned int Get_Texture_Tile_Size( void ) const;
 
 	/* Downscale an image
 	 * Can be used for creating MIPmaps
 	 * The incoming image should have a power-of-two size
 	*/
 	bool Downscale_Image( const unsigned char *const orig, int width, int height, int channels, unsigned char *resampled, int block_size_x, int block_size_y ) const;
+	/* Returns true if no pixel of the 32 bit image is transparent
+	 * row_length : pixels per row
+	*/
+	bool Is_Opaque_Image( const unsigned char *pixels, unsigned int width, unsigned int height, unsigned int row_length ) const;
+	/* Returns true if every pixel of the 32 bit image is fully transparent
+	 * row_length : pixels per row
+	*/
+	bool Is_Transparent_Image( const unsigned char *pixels, unsigned int width, unsigned int height, unsigned int row_length ) const;
+	/* Returns the smallest texture format which keeps the quality of the 32 bit image
+	 * greyscale images use la8 and images with few colors a 16 bit format
+	 * checks every pixel and is only used when the image is cached
+	 * row_length : pixels per row
+	*/
+	Texture_Format Get_Texture_Format( const unsigned char *pixels, unsigned int width, unsigned int height, unsigned int row_length ) const;
 
-	// Save an image of the current screen
+	/* Save an image of the next rendered frame
+	 * the image is read back and written in the background
+	*/
 	void Save_Screenshot( void );
-	// Save data as png image
+	/* Save data as png image
+	 * can be used from any thread
+	*/
 	void Save_Surface( const std::string &filename, const unsigned char *data, unsigned int width, unsigned int height, unsigned int bpp = 4, bool reverse_data = 0 ) const;
 
 	// available OpenGL version
@@ -240,6 +394,8 @@ public:
 	GLint m_default_buffer;
 	// max texture size
 	GLint m_max_texture_size;
+	// size of the tiles of large images if smaller than the maximum texture size
+	static const unsigned int m_texture_tile_size = 1024;
 
 	// if audio initialization failed
 	bool m_audio_init_failed;
@@ -262,28 +418,104 @@ public:
 #endif
 	// rendering thread
 	boost::thread m_render_thread;
+	// if the render thread is running
+	bool m_render_thread_active;
+	// protects the render thread state
+	boost::mutex m_render_mutex;
+	// signals a change of the render thread state
+	boost::condition_variable m_render_condition;
+	// queue to render by the render thread or NULL if none
+	cRenderQueue *m_render_thread_queue;
+	// if the render thread is rendering
+	bool m_render_thread_busy;
+	// input sampling time of the queued frame
+	Uint64 m_render_thread_input_time;
+	// if set the render thread should release the opengl context
+	bool m_render_thread_release_context;
+	// if the main thread has the opengl context
+	bool m_render_context_main;
+	// if set the render thread exits
+	bool m_render_thread_exit;
+	// protects the GUI while rendering in the render thread
+	boost::mutex m_gui_mutex;
+	// if the GUI is locked by the main thread
+	bool m_gui_locked;
+
+	// offscreen target for the game drawing or NULL if drawn directly to the screen
+	cRender_Target *m_render_target;
+	// compressed texture image cache or NULL if not used
+	cCompressed_Image_Cache *m_compressed_cache;
+	// updates the image cache in the background or NULL if not initialized
+	cImage_Cache_Updater *m_image_cache_updater;
+	// pixel buffer texture upload or NULL if not supported
+	cTexture_Upload *m_texture_upload;
+	// render phase timer queries or NULL if not supported
+	cGPU_Timer *m_gpu_timer;
+	// screenshot read back and writing
+	cScreenshot_Writer *m_screenshot;
+	// particle shader or NULL if particles are simulated on the cpu
+	cParticle_Shader *m_particle_shader;
+	// batched sprite shader or NULL if the fixed function pipeline is used
+	cSprite_Shader *m_sprite_shader;
+	// images decoded in the background which are used by Get_Surface or NULL if none
+	cImage_Loader *m_image_loader;
+	// resolution scale of the render target
+	float m_render_scale;
+	// measured frame time since the last render scale adjustment
+	Uint32 m_render_scale_ticks;
+	// measured frames since the last render scale adjustment
+	unsigned int m_render_scale_frames;
 
 private:
+	/* Upload the used area of the 32 bit image as tiles of the surface
+	 * width/height : image size
+	 * used_width/height : image area without the power of two padding
+	 * fully transparent tiles are not created
+	 * returns false if a texture could not be created
+	*/
+	bool Create_Texture_Tiles( cGL_Surface *image, const unsigned char *pixels, unsigned int width, unsigned int height, unsigned int row_length, unsigned int used_width, unsigned int used_height, bool mipmap ) const;
+
 	// if set video is initialized successfully
 	bool m_initialised;
+	/* if the opengl context was kept by the last video mode change
+	 * the textures are then not saved for the next one
+	*/
+	bool m_context_kept;
 };
 
-/* Draw an Screen Fadeout Effect
+/* Draw an Screen Fadeout Effect and wait until the screen is covered
+ * the game loop should use the screen transition instead
  * if effect is RANDOM_EFFECT a random effect is selected
 */
 void Draw_Effect_Out( Effect_Fadeout effect = EFFECT_OUT_RANDOM, float speed = 1 );
 
-/* Draw an Screen Fadein Effect
+/* Draw an Screen Fadein Effect and wait until it is finished
+ * the game loop should use the screen transition instead
  * if effect is RANDOM_EFFECT a random effect is selected
 */
 void Draw_Effect_In( Effect_Fadein effect = EFFECT_IN_RANDOM, float speed = 1 );
 
+/* The loading screen is drawn at most 30 times a second
+ * so the loading does not wait for a vertical sync with every change
+ * the text and progress can be set from any thread and are shown with the next drawing
+*/
+
 // initialize loading screen
 void Loading_Screen_Init( void );
-// set the loading screen info string and draw it
+// set the loading screen info string and draw it if due
 void Loading_Screen_Draw_Text( const std::string &str_info = "Loading" );
-// draw the loading screen
-void Loading_Screen_Draw( void );
+/* Set the progress bar to the done part of the count
+ * can be called from any thread
+*/
+void Loading_Screen_Set_Progress( unsigned int done, unsigned int count );
+// Add one done part to the progress bar from any thread
+void Loading_Screen_Add_Progress( void );
+/* Draw the loading screen if the last drawing is older than the loading screen rate
+ * handles the window events to keep it responsive
+ * force : if set always draw
+ * must be called from the main thread
+*/
+void Loading_Screen_Draw( bool force = 0 );
 // exit loading screen
 void Loading_Screen_Exit( void );
 